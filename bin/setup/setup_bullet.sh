@@ -57,12 +57,34 @@ source_conf "bullet.conf"
 # Variables
 bullet_pkg=`echo $BULLET_URL|awk -F/ '{print $NF}'`  # get the package name from the url
 
+# Confs from before BULLET_DOUBLE_PRECISION was added built double
+BULLET_DOUBLE_PRECISION=${BULLET_DOUBLE_PRECISION:-ON}
+
+# Where the precision of the build and of the install are recorded.
+# inc.CMakePrecision.txt reads the one under env/build.
+bullet_build_precision="$BULLET_BUILD_DIR/ntrt.precision"
+bullet_env_precision="$ENV_DIR/build/bullet.precision"
+
+# Check that a recorded precision is the one asked for. Builds from
+# before the precision was recorded are double.
+function check_precision()
+{
+    recorded="ON"
+    if [ -f "$1" ]; then
+        recorded=`cat "$1"`
+    fi
+    if [ "$recorded" == "$BULLET_DOUBLE_PRECISION" ]; then
+        return $TRUE
+    fi
+    return $FALSE
+}
+
 # Check to see if bullet has been built already
 function check_bullet_built()
 {
     # Check for a library that's created when bullet is built   
     fname=$(find "$BULLET_BUILD_DIR" -iname libBulletCollision.* 2>/dev/null)
-    if [ -f "$fname" ]; then
+    if [ -f "$fname" ] && check_precision "$bullet_build_precision"; then
         return $TRUE
     fi
     return $FALSE
@@ -157,7 +179,9 @@ function build_bullet()
     pushd "$BULLET_BUILD_DIR" > /dev/null
 
     # Perform the build
-    # If you turn double precision on, turn it on in inc.CMakeBullet.txt as well for the NTRT build
+    # The NTRT build picks up the precision from bullet.precision under
+    # env/build; see inc.CMakePrecision.txt
+    echo "- Double precision: $BULLET_DOUBLE_PRECISION"
     "$ENV_DIR/bin/cmake" . -G "Unix Makefiles" \
         -DBUILD_SHARED_LIBS=OFF \
         -DBUILD_EXTRAS=ON \
@@ -169,14 +193,14 @@ function build_bullet()
         -DCMAKE_EXE_LINKER_FLAGS="-fPIC" \
         -DCMAKE_MODULE_LINKER_FLAGS="-fPIC" \
         -DCMAKE_SHARED_LINKER_FLAGS="-fPIC" \
-        -DUSE_DOUBLE_PRECISION=ON \
+        -DUSE_DOUBLE_PRECISION=$BULLET_DOUBLE_PRECISION \
         -DCMAKE_INSTALL_NAME_DIR="$BULLET_INSTALL_PREFIX" || { echo "- ERROR: CMake for Bullet Physics failed."; exit 1; }
-    #If you turn this on, turn it on in inc.CMakeBullet.txt as well for the NTRT build
     # Additional bullet options: 
     # -DFRAMEWORK=ON
     # -DBUILD_DEMOS=ON
 
     make || { echo "- ERROR: Bullet build failed. Attempting to explicitly make from directory."; make_bullet_local; }
+    echo "$BULLET_DOUBLE_PRECISION" > "$bullet_build_precision"
 
     popd > /dev/null
 }
@@ -220,6 +244,13 @@ function env_link_bullet()
         create_exist_symlink "$BULLET_BUILD_DIR" bullet  # this links directly to the most recent build...
     fi
 
+    # The NTRT build checks that it is built with the same precision
+    if [ -f "$bullet_build_precision" ]; then
+        cp "$bullet_build_precision" "$bullet_env_precision"
+    else
+        echo "ON" > "$bullet_env_precision"
+    fi
+
     popd > /dev/null
 
     # Header Files
@@ -238,10 +269,13 @@ function main()
     ensure_install_prefix_writable $BULLET_INSTALL_PREFIX
 
     if check_package_installed "$BULLET_INSTALL_PREFIX/lib/libBulletDynamics*"; then
-        echo "- Bullet Physics is installed under prefix $BULLET_INSTALL_PREFIX -- skipping."
-        ensure_bullet_openglsupport
-        env_link_bullet
-        return
+        if check_precision "$bullet_env_precision"; then
+            echo "- Bullet Physics is installed under prefix $BULLET_INSTALL_PREFIX -- skipping."
+            ensure_bullet_openglsupport
+            env_link_bullet
+            return
+        fi
+        echo "- Bullet Physics under prefix $BULLET_INSTALL_PREFIX has another precision -- reinstalling."
     fi
 
     if check_bullet_built; then
@@ -52,15 +52,36 @@ class EvolutionJob(NTRTJob):
             
             # Run through a set of binary job options. Currently handles terrain switches
             for run in terrainMatrix:
-                if (len(run)) >= 5:
-                    trialLength = run[4]
-                else:
-                    trialLength = self.args['length']
                 #TODO improve error handling here
-                subprocess.check_call([self.args['executable'], "-l", self.args['filename'], "-P", self.args['path'], "-s", str(trialLength), "-b", str(run[0]), "-H", str(run[1]), "-a", str(run[2]), "-B", str(run[3])], stdout=logFile)
+                subprocess.check_call([self.args['executable'], "-s", str(self.__trialLength(run))] + self.__runArgs(run), stdout=logFile)
             sys.exit()
 
+    def serverRequests(self):
+        """
+        The same runs as startJob, as request lines for a worker started with
+        --server: the number of steps followed by the run's options.
+        """
+        terrainMatrix = self.args['terrain']
+        if len(terrainMatrix[0]) < 4:
+            raise NTRTMasterError("Not enough terrain args!")
+        return [' '.join([str(self.__trialLength(run))] + self.__runArgs(run)) for run in terrainMatrix]
+
+    def __trialLength(self, run):
+        if (len(run)) >= 5:
+            return run[4]
+        return self.args['length']
+
+    def __runArgs(self, run):
+        return ["-l", self.args['filename'], "-P", self.args['path'], "-b", str(run[0]), "-H", str(run[1]), "-a", str(run[2]), "-B", str(run[3])]
+
     def processJobOutput(self):
+        if 'paramBlock' in self.args:
+            # The controllers appended [distance, energy] rows to the block
+            self.obj = dict(self.args['paramIDs'])
+            self.obj['scores'] = [{'distance' : row[0], 'energy' : row[1]}
+                                  for row in self.args['paramBlock'].getScores(self.args['trial'])]
+            return
+
         scoresPath = self.args['resourcePrefix'] + self.args['path'] + self.args['filename']
 
         try:
@@ -1,9 +1,12 @@
 import os
 import json
 import random
+import time
 import collections
 from interfaces import NTRTJobMaster, NTRTMasterError
 from concurrent_scheduler import ConcurrentScheduler
+from worker_pool import WorkerPool
+from param_block import ParamBlock
 import collections
 #TODO: This is hackety, fix it.
 from evolution_job import EvolutionJob
@@ -452,13 +455,10 @@ class EvolutionJobMaster(NTRTJobMaster):
         except IndexError:
             print 'Not enough keys'
 
-    def getNewFile(self, jobNum):
+    def __selectControllers(self, jobNum):
         """
-        Handle the generation of a new JSON file with new parameters. Will vary based on the
-        learning method used and the config file
-        Edit this based on your parameter set
+        The controllers trial jobNum runs, keyed as in the JSON files
         """
-
         obj = {}
 
         for p in self.prefixes:
@@ -470,6 +470,17 @@ class EvolutionJobMaster(NTRTJobMaster):
             
             obj[p + "Vals"] = self.currentGeneration[p][self.getParamID(self.currentGeneration[p], paramNum)]
 
+        return obj
+
+    def getNewFile(self, jobNum):
+        """
+        Handle the generation of a new JSON file with new parameters. Will vary based on the
+        learning method used and the config file
+        Edit this based on your parameter set
+        """
+
+        obj = self.__selectControllers(jobNum)
+
 	obj["metrics"] = [] # Added to store tension and COM data. 
         
 	outFile = self.path + self.jConf['filePrefix'] + "_" + str(jobNum) + self.jConf['fileSuffix']
@@ -479,6 +490,54 @@ class EvolutionJobMaster(NTRTJobMaster):
         json.dump(obj, fout, indent=4)
 
         return self.jConf['filePrefix'] + "_" + str(jobNum) + self.jConf['fileSuffix']
+
+    def __blockName(self):
+        return self.jConf['filePrefix'] + ".blk"
+
+    def __openBlock(self, numTrials):
+        """
+        With "paramBlock" : true, one parameter block (see param_block.py) holds
+        every trial of a generation instead of a JSON file each. Lists of
+        numbers become its sections; the dictionaries of neural network
+        controllers, whose weights are in their .nnw files, go in its
+        document, per trial.
+        """
+        if self.paramBlock is not None:
+            return
+        sections = []
+        documentSpace = 4096
+        for p in self.prefixes:
+            example = self.currentGeneration[p][self.getParamID(self.currentGeneration[p], 0)]['params']
+            if isinstance(example, dict):
+                documentSpace += 2 * numTrials * len(json.dumps({p + "Vals" : {'params' : example}}))
+            else:
+                rows, columns = ParamBlock.shape(example)
+                sections.append((p + "Vals", rows, columns))
+        # Each terrain entry is a list of runs, each appending a row of scores
+        scoreRows = sum(len(runs) for runs in self.jConf['terrain'])
+        self.paramBlock = ParamBlock(self.path + self.__blockName(), sections, numTrials,
+                                     2, scoreRows, documentSpace)
+
+    def getNewBlockTrial(self, jobNum):
+        """
+        As getNewFile, writing the trial into the parameter block. Returns the
+        name that refers to it and the paramIDs its scores belong to
+        """
+        obj = self.__selectControllers(jobNum)
+        perTrial = {}
+        paramIDs = {}
+        for key in obj:
+            params = obj[key]['params']
+            paramIDs[key] = {'paramID' : obj[key]['paramID']}
+            if isinstance(params, dict):
+                perTrial[key] = {'params' : dict((k, v) for k, v in params.items() if k != 'neuralParams')}
+            else:
+                self.paramBlock.setParams(jobNum, key, params)
+        self.blockTrials[jobNum] = perTrial
+        return self.__blockName() + "#" + str(jobNum), paramIDs
+
+    def __blockDocument(self):
+        return json.dumps({'trials' : [self.blockTrials.get(i, {}) for i in range(self.paramBlock.trials)]})
     
     def getJobNum(self, paramNum, paramName):
 
@@ -488,6 +547,56 @@ class EvolutionJobMaster(NTRTJobMaster):
 
         return i
     
+    TIMING_PHASES = ['spawn', 'config', 'build', 'settle', 'control', 'teardown', 'logIO']
+
+    def __startTiming(self):
+        """
+        With "trialTiming" : true, have every NTRT process append a line per trial
+        to logs/trialTiming.jsonl (see tgTrialTiming), and summarize them per generation
+        in timingLog.txt: the generation, the trials, its wall time, then the mean seconds
+        per trial of each phase in TIMING_PHASES.
+        """
+        self.timingPath = None
+        if not self.jConf.get('trialTiming', False):
+            return
+        self.timingPath = os.path.abspath(self.path + '/logs/trialTiming.jsonl')
+        open(self.timingPath, 'w').close()
+        self.timingOffset = 0
+        # Inherited by every process started from here on, workers included
+        os.environ['NTRT_TRIAL_TIMING'] = self.timingPath
+        timingLog = open('timingLog.txt', 'w')
+        timingLog.write('generation,trials,wallTime,' + ','.join(self.TIMING_PHASES) + '\n')
+        timingLog.close()
+
+    def __logTiming(self, generation, wallTime):
+        if self.timingPath is None:
+            return
+        fin = open(self.timingPath, 'r')
+        fin.seek(self.timingOffset)
+        lines = fin.readlines()
+        # A line still being written is read next generation
+        if lines and not lines[-1].endswith('\n'):
+            lines.pop()
+        self.timingOffset += sum(len(line) for line in lines)
+        fin.close()
+
+        totals = dict((phase, 0.0) for phase in self.TIMING_PHASES)
+        trials = 0
+        for line in lines:
+            try:
+                record = json.loads(line)
+            except ValueError:
+                continue
+            trials += 1
+            for phase in self.TIMING_PHASES:
+                totals[phase] += record.get(phase, 0.0)
+
+        means = [totals[phase] / trials if trials else 0.0 for phase in self.TIMING_PHASES]
+        timingLog = open('timingLog.txt', 'a')
+        timingLog.write(','.join([str(generation), str(trials), '%.3f' % wallTime] +
+                                 ['%.6f' % m for m in means]) + '\n')
+        timingLog.close()
+
     def beginTrial(self):
         """
         Override this. It should just contain a loop where you keep constructing NTRTJobs, then calling
@@ -523,7 +632,21 @@ class EvolutionJobMaster(NTRTJobMaster):
 
         scoreDump = open('scoreDump.txt', 'w')
         scoreDump.close()
+
+        self.__startTiming()
+
+        self.paramBlock = None
+        self.blockTrials = {}
+        useBlock = self.jConf.get('paramBlock', False)
+
+        # With "server" : true, keep warm workers instead of a process per trial
+        workerPool = None
+        if self.jConf.get('server', False):
+            workerPool = WorkerPool(self.jConf['executable'], self.numProcesses, self.path + '/logs/')
+
         for n in range(numGenerations):
+            generationStart = time.time()
+
             # Create the generation'
             for p in self.prefixes:
                 self.currentGeneration[p] = self.generationGenerator(self.currentGeneration[p], p + 'Vals')
@@ -534,12 +657,18 @@ class EvolutionJobMaster(NTRTJobMaster):
             else:
                 startTrial = 0
 
+            if useBlock:
+                self.__openBlock(numTrials)
+
             # We want to write all of the trials for post processing
             for i in range(0, numTrials) :
 
                 # MonteCarlo solution. This function could be overridden with something that
                 # provides a filename for a pre-existing file
-                fileName = self.getNewFile(i)
+                if useBlock:
+                    fileName, paramIDs = self.getNewBlockTrial(i)
+                else:
+                    fileName = self.getNewFile(i)
                 
                 for j in self.jConf['terrain']:
                     # All args to be passed to subprocess must be strings
@@ -550,12 +679,22 @@ class EvolutionJobMaster(NTRTJobMaster):
                             'executable' : self.jConf['executable'],
                             'length'   : self.jConf['learningParams']['trialLength'],
                             'terrain'  : j}
+                    if useBlock:
+                        args['paramBlock'] = self.paramBlock
+                        args['trial'] = i
+                        args['paramIDs'] = paramIDs
                     if (n == 0 or i >= startTrial):
                         jobList.append(EvolutionJob(args))
 
+            if useBlock:
+                self.paramBlock.beginGeneration(self.__blockDocument())
+
             # Run the jobs
-            conSched = ConcurrentScheduler(jobList, self.numProcesses)
-            completedJobs = conSched.processJobs()
+            if workerPool is not None:
+                completedJobs = workerPool.processJobs(jobList)
+            else:
+                conSched = ConcurrentScheduler(jobList, self.numProcesses)
+                completedJobs = conSched.processJobs()
 
             # Read scores from files, write to logs
             totalScore = 0
@@ -586,3 +725,9 @@ class EvolutionJobMaster(NTRTJobMaster):
             logFile.write(str((n+1) * numTrials) + ',' + str(maxScore) + ',' + str(avgScore) +'\n')
             logFile.close()
 
+            self.__logTiming(n, time.time() - generationStart)
+
+        if workerPool is not None:
+            workerPool.close()
+        if self.paramBlock is not None:
+            self.paramBlock.close()
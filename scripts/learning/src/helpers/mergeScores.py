@@ -0,0 +1,86 @@
+#!/usr/bin/python
+
+# Copyright (c) 2012, United States Government, as represented by the
+# Administrator of the National Aeronautics and Space Administration.
+# All rights reserved.
+#
+# The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+# under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0.
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific language
+# governing permissions and limitations under the License.
+
+""" Joins ScoreLog shards into one scores.csv """
+
+# Purpose: Merge the score logs written by several learning workers.
+# Notes:   Reads any mix of .csv and .bin (ScoreLog eBinary) files and
+# writes one csv that statScores.py and splitInfile.py can read.
+# Input parameters are
+# (1) The name of the output file
+# (2...) The shards, such as logs/scores-*.bin
+
+import struct
+import sys
+
+MAGIC = "NTRTSCR1"
+
+def readBinary(inFile):
+    rows = []
+    f = open(inFile, 'rb')
+    try:
+        if f.read(len(MAGIC)) != MAGIC:
+            raise ValueError(inFile + " is not a ScoreLog binary file")
+        while True:
+            header = f.read(8)
+            if len(header) < 8:
+                break
+            numRows, numCols = struct.unpack('<II', header)
+            count = numRows * numCols
+            data = f.read(8 * count)
+            if len(data) < 8 * count:
+                # The last block of a worker that was killed mid-write
+                break
+            values = struct.unpack('<%dd' % count, data)
+            # Blocks are stored column by column
+            for i in range(numRows):
+                rows.append([values[j * numRows + i] for j in range(numCols)])
+    finally:
+        f.close()
+    return rows
+
+def readCsv(inFile):
+    rows = []
+    f = open(inFile, 'r')
+    try:
+        for line in f:
+            line = line.strip()
+            if line:
+                rows.append([float(cell) for cell in line.split(',')])
+    finally:
+        f.close()
+    return rows
+
+def mergeScores(outFile, inFiles):
+    out = open(outFile, 'w')
+    try:
+        for inFile in inFiles:
+            if inFile.endswith('.bin'):
+                rows = readBinary(inFile)
+            else:
+                rows = readCsv(inFile)
+            for row in rows:
+                out.write(','.join(repr(value) for value in row) + '\n')
+    finally:
+        out.close()
+
+if __name__=="__main__":
+    if len(sys.argv) < 3:
+        print "Usage: mergeScores.py <outFile> <shard> [<shard> ...]"
+        sys.exit(1)
+    mergeScores(sys.argv[1], sys.argv[2:])
@@ -0,0 +1,132 @@
+#!/usr/bin/python
+
+# Copyright (c) 2012, United States Government, as represented by the
+# Administrator of the National Aeronautics and Space Administration.
+# All rights reserved.
+#
+# The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+# under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0.
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific language
+# governing permissions and limitations under the License.
+
+""" Reads the trial results a ResultStore keeps """
+
+# Purpose: Find the latest and best trials of a learning campaign without
+#          re-reading every score it has logged.
+# Notes:   Reads logs/results.res and the logs/results.idx index that
+#          ResultStore (src/learning/ResultStore) writes at the end of
+#          each generation. latest() and top() read the index and seek to
+#          the records they name; records() reads on from any offset, so
+#          a script polling a campaign can keep its place.
+# Input parameters are
+# (1) The store's name without extension, such as logs/results
+# (2) Optional, how many of the best trials to print, 10 by default
+
+import struct
+import sys
+
+STORE_MAGIC = b"NTRTRES1"
+INDEX_MAGIC = b"NTRTRIX1"
+HEADER = struct.Struct('=IiQQd')
+
+class Result(object):
+    def __init__(self, fidelity, trial, parametersHash, recordedAt, scores):
+        self.fidelity = fidelity
+        self.trial = trial
+        self.parametersHash = parametersHash
+        self.recordedAt = recordedAt
+        self.scores = scores
+
+    def __repr__(self):
+        return "Result(trial=%d, fidelity=%d, hash=%016x, scores=%r)" % (
+            self.trial, self.fidelity, self.parametersHash, self.scores)
+
+class ResultStore(object):
+    def __init__(self, path):
+        self.storeFile = path + ".res"
+        self.indexFile = path + ".idx"
+        f = open(self.storeFile, 'rb')
+        try:
+            if f.read(len(STORE_MAGIC)) != STORE_MAGIC:
+                raise ValueError(self.storeFile + " is not a result store")
+        finally:
+            f.close()
+
+    def readIndex(self):
+        """ The record count, and the offsets of the latest and the best """
+        f = open(self.indexFile, 'rb')
+        try:
+            if f.read(len(INDEX_MAGIC)) != INDEX_MAGIC:
+                raise ValueError(self.indexFile + " is not a result index")
+            end, count, latest = struct.unpack('=QQQ', f.read(24))
+            numBest, = struct.unpack('=I', f.read(4))
+            best = struct.unpack('=%dQ' % numBest, f.read(8 * numBest))
+        finally:
+            f.close()
+        return count, latest, list(best)
+
+    def readAt(self, f, offset):
+        f.seek(offset)
+        header = f.read(HEADER.size)
+        if len(header) < HEADER.size:
+            return None
+        count, fidelity, trial, parametersHash, recordedAt = HEADER.unpack(header)
+        data = f.read(8 * count)
+        if len(data) < 8 * count:
+            # A record still being written
+            return None
+        scores = list(struct.unpack('=%dd' % count, data))
+        return Result(fidelity, trial, parametersHash, recordedAt, scores)
+
+    def size(self):
+        return self.readIndex()[0]
+
+    def latest(self):
+        count, latest, best = self.readIndex()
+        if count == 0:
+            return None
+        f = open(self.storeFile, 'rb')
+        try:
+            return self.readAt(f, latest)
+        finally:
+            f.close()
+
+    def top(self, k):
+        """ The best full trials by first score, best first """
+        count, latest, best = self.readIndex()
+        f = open(self.storeFile, 'rb')
+        try:
+            return [self.readAt(f, offset) for offset in best[:k]]
+        finally:
+            f.close()
+
+    def records(self, offset=len(STORE_MAGIC)):
+        """ Yields (result, next offset) for each whole record from offset """
+        f = open(self.storeFile, 'rb')
+        try:
+            while True:
+                result = self.readAt(f, offset)
+                if result is None:
+                    break
+                offset += HEADER.size + 8 * len(result.scores)
+                yield result, offset
+        finally:
+            f.close()
+
+if __name__=="__main__":
+    if len(sys.argv) < 2:
+        sys.stderr.write("Usage: resultStore.py <path without extension> [k]\n")
+        sys.exit(1)
+    store = ResultStore(sys.argv[1])
+    k = int(sys.argv[2]) if len(sys.argv) > 2 else 10
+    sys.stdout.write("%d trials\n" % store.size())
+    sys.stdout.write("Latest: %r\n" % (store.latest(),))
+    for result in store.top(k):
+        sys.stdout.write("%r\n" % (result,))
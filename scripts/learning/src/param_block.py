@@ -0,0 +1,124 @@
+import mmap
+import struct
+from interfaces import NTRTMasterError
+
+class ParamBlock:
+    """
+    The parameters and scores of a batch of trials in one memory mapped
+    file, in the layout src/helpers/tgParameterBlock.h reads. Controllers
+    given "<file>#<trial>" instead of a JSON file name read that trial's
+    parameters from the block and append their scores to it, so a
+    generation needs no JSON files written and parsed per trial.
+
+    The shape, sections and number of trials are fixed when the block is
+    created; each generation rewrites the parameters in place.
+    """
+
+    __MAGIC = b'NTRTBLK1'
+    __VERSION = 1
+    # magic, version, sections, then generation, trials, paramsPerTrial,
+    # scoreColumns, scoreRows, documentOffset, documentSize,
+    # sectionsOffset, paramsOffset, countsOffset, scoresOffset, fileSize
+    __HEADER = struct.Struct('=8sII12Q')
+    __SECTION = struct.Struct('=32sIIII')
+    __COUNT = struct.Struct('=Q')
+
+    def __init__(self, path, sections, trials, scoreColumns, scoreRows, documentSpace=0):
+        """
+        sections is a list of (name, rows, columns), documentSpace the
+        bytes to leave for the JSON document shared by the trials.
+        """
+        self.path = path
+        self.trials = trials
+        self.scoreColumns = scoreColumns
+        self.scoreRows = scoreRows
+        self.generation = 0
+
+        self.sections = {}
+        offset = 0
+        for name, rows, columns in sections:
+            if len(name.encode()) >= 32:
+                raise NTRTMasterError("Parameter block section name too long: " + name)
+            self.sections[name] = (offset, rows, columns)
+            offset += rows * columns
+        self.paramsPerTrial = offset
+
+        self.documentOffset = self.__HEADER.size
+        self.documentSpace = self.__align(documentSpace)
+        self.sectionsOffset = self.documentOffset + self.documentSpace
+        self.paramsOffset = self.__align(self.sectionsOffset + len(sections) * self.__SECTION.size)
+        self.countsOffset = self.paramsOffset + trials * self.paramsPerTrial * 8
+        self.scoresOffset = self.countsOffset + trials * 8
+        self.size = self.scoresOffset + trials * scoreRows * scoreColumns * 8
+
+        fout = open(path, 'w+b')
+        fout.truncate(self.size)
+        self.data = mmap.mmap(fout.fileno(), self.size)
+        fout.close()
+
+        self.__writeHeader(0)
+        for i, (name, rows, columns) in enumerate(sections):
+            self.__SECTION.pack_into(self.data, self.sectionsOffset + i * self.__SECTION.size,
+                                     name.encode(), self.sections[name][0], rows, columns, 0)
+
+    @staticmethod
+    def shape(params):
+        """
+        Rows and columns of a params list of numbers or of equal length lists
+        """
+        if len(params) > 0 and isinstance(params[0], list):
+            return len(params), len(params[0])
+        return len(params), 1
+
+    def __align(self, n):
+        return (n + 7) // 8 * 8
+
+    def __writeHeader(self, documentSize):
+        self.__HEADER.pack_into(self.data, 0, self.__MAGIC, self.__VERSION, len(self.sections),
+                                self.generation, self.trials, self.paramsPerTrial,
+                                self.scoreColumns, self.scoreRows,
+                                self.documentOffset, documentSize, self.sectionsOffset,
+                                self.paramsOffset, self.countsOffset, self.scoresOffset,
+                                self.size)
+
+    def beginGeneration(self, document=''):
+        """
+        Start a generation: clear the scores and move the generation on, so
+        controllers already holding this block read their parameters again.
+        Call before running the generation's trials.
+        """
+        encoded = document.encode()
+        if len(encoded) > self.documentSpace:
+            raise NTRTMasterError("Parameter block document outgrew its space")
+        self.data[self.documentOffset:self.documentOffset + len(encoded)] = encoded
+        self.data[self.countsOffset:self.scoresOffset] = b'\0' * (self.scoresOffset - self.countsOffset)
+        self.generation += 1
+        self.__writeHeader(len(encoded))
+
+    def setParams(self, trial, name, params):
+        """
+        Write one section of a trial's parameters, shaped as shape() reads it
+        """
+        offset, rows, columns = self.sections[name]
+        if self.shape(params) != (rows, columns):
+            raise NTRTMasterError("Parameters for %s are not %d x %d" % (name, rows, columns))
+        position = self.paramsOffset + (trial * self.paramsPerTrial + offset) * 8
+        values = params
+        if rows > 0 and isinstance(params[0], list):
+            values = [v for row in params for v in row]
+        struct.pack_into('=%dd' % len(values), self.data, position, *values)
+
+    def getScores(self, trial):
+        """
+        The rows of scores the trial's runs have appended this generation
+        """
+        count = self.__COUNT.unpack_from(self.data, self.countsOffset + trial * 8)[0]
+        position = self.scoresOffset + trial * self.scoreRows * self.scoreColumns * 8
+        scores = []
+        for r in range(count):
+            scores.append(list(struct.unpack_from('=%dd' % self.scoreColumns, self.data,
+                                                  position + r * self.scoreColumns * 8)))
+        return scores
+
+    def close(self):
+        self.data.close()
@@ -0,0 +1,96 @@
+import logging
+import os
+import socket
+import subprocess
+import tempfile
+import threading
+import time
+from interfaces import NTRTMasterError
+
+class WorkerPool:
+    """
+    Keeps a set of NTRT processes running in server mode (started with
+    --server <socket>) and hands jobs to them, instead of forking one
+    process per trial like ConcurrentScheduler. Jobs must provide
+    serverRequests(), returning one request line per run. All of a job's
+    runs go to the same worker in order, since they share a scores file.
+    """
+
+    # Seconds to wait for a worker to open its socket
+    __STARTUP_TIMEOUT = 30.0
+
+    def __init__(self, executable, numWorkers, logPrefix):
+        self.workers = []
+        for i in range(numWorkers):
+            socketPath = os.path.join(tempfile.gettempdir(), "ntrt_worker_%d_%d.sock" % (os.getpid(), i))
+            logFile = open(logPrefix + "worker_%d_log.txt" % i, 'wb')
+            proc = subprocess.Popen([executable, "--server", socketPath], stdout=logFile, stderr=subprocess.STDOUT)
+            self.workers.append({'proc' : proc, 'socketPath' : socketPath, 'log' : logFile})
+        for worker in self.workers:
+            worker['conn'] = self.__connect(worker)
+            worker['reader'] = worker['conn'].makefile('r')
+        logging.info("Worker pool started %d workers running %s." % (numWorkers, executable))
+
+    def __connect(self, worker):
+        deadline = time.time() + self.__STARTUP_TIMEOUT
+        while True:
+            if worker['proc'].poll() is not None:
+                raise NTRTMasterError("Worker exited before opening " + worker['socketPath'])
+            try:
+                conn = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+                conn.connect(worker['socketPath'])
+                return conn
+            except socket.error:
+                conn.close()
+                if time.time() > deadline:
+                    raise NTRTMasterError("Timed out connecting to " + worker['socketPath'])
+                time.sleep(0.1)
+
+    def processJobs(self, toProcess):
+        """
+        Run every job in toProcess, emptying the list as ConcurrentScheduler does.
+        Returns the completed jobs.
+        """
+        completed = []
+        errors = []
+        lock = threading.Lock()
+
+        def work(worker):
+            while True:
+                with lock:
+                    if len(toProcess) == 0 or len(errors) > 0:
+                        return
+                    job = toProcess.pop()
+                try:
+                    for request in job.serverRequests():
+                        worker['conn'].sendall((request + "\n").encode())
+                        reply = worker['reader'].readline().strip()
+                        if not reply.startswith("ok"):
+                            raise NTRTMasterError("Worker failed on '%s': %s" % (request, reply))
+                except Exception as e:
+                    with lock:
+                        errors.append(e)
+                    return
+                with lock:
+                    completed.append(job)
+
+        threads = [threading.Thread(target=work, args=(w,)) for w in self.workers]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        if len(errors) > 0:
+            raise errors[0]
+        return completed
+
+    def close(self):
+        for worker in self.workers:
+            try:
+                worker['conn'].sendall("quit\n".encode())
+                worker['conn'].close()
+            except socket.error:
+                pass
+            worker['proc'].wait()
+            worker['log'].close()
+        self.workers = []
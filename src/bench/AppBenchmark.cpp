@@ -0,0 +1,515 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file AppBenchmark.cpp
+ * @brief Contains the definition function main() for an application that
+ * steps a fixed set of scenes without graphics and reports their
+ * throughput, step latency, setup and reset times and peak memory as JSON
+ * $Id$
+ */
+
+// The scenes
+#include "examples/3_prism/PrismModel.h"
+#include "examples/SUPERball/T6Model.h"
+#include "examples/learningSpines/TetraSpine/TetraSpineLearningModel.h"
+#include "examples/NestedTetrahedrons/NestedStructureTestModel.h"
+#include "examples/contactCables/ContactCableDemo.h"
+#include "models/obstacles/tgBlockField.h"
+#include "yamlbuilder/TensegrityModel.h"
+// This library
+#include "core/terrain/tgBoxGround.h"
+#include "core/terrain/tgEmptyGround.h"
+#include "core/tgModel.h"
+#include "core/tgRigidStateFrame.h"
+#include "core/tgSimView.h"
+#include "core/tgSimulation.h"
+#include "core/tgWorld.h"
+#include "core/tgWorldBulletPhysicsImpl.h"
+// Bullet Physics
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// POSIX
+#include <sys/resource.h>
+#include <time.h>
+
+#ifndef NTRT_YAML_DIR
+#define NTRT_YAML_DIR "../resources/YamlStructures"
+#endif
+
+namespace
+{
+    /** What the command line chose */
+    struct Options
+    {
+        Options() :
+            steps(5000),
+            stepSize(0.001),
+            solverType(tgWorld::Config::eMLCPDantzig),
+            solverName("MLCP-Dantzig"),
+            broadphaseType(tgWorld::Config::eAxisSweep),
+            broadphaseName("AxisSweep"),
+            solverIterations(0),
+            minSolverIterations(0),
+            yamlPath(NTRT_YAML_DIR "/BigPuppy.yaml")
+        {
+        }
+
+        int steps;
+        double stepSize;
+        tgWorld::Config::SolverType solverType;
+        std::string solverName;
+        tgWorld::Config::BroadphaseType broadphaseType;
+        std::string broadphaseName;
+        /** As tgWorld::Config */
+        int solverIterations;
+        int minSolverIterations;
+        /** Only the scenes with these names; all if empty */
+        std::vector<std::string> scenes;
+        std::string yamlPath;
+        /** Where the JSON goes; standard output if empty */
+        std::string outputPath;
+    };
+
+    /** One canonical scene */
+    struct Scene
+    {
+        const char* name;
+        /** In the units of the scene's models */
+        double gravity;
+        /** A tgEmptyGround rather than the default tgBoxGround */
+        bool emptyGround;
+        /** Add the scene's models to the simulation */
+        void (*populate)(tgSimulation& simulation, const Options& options);
+    };
+
+    void populatePrism(tgSimulation& simulation, const Options&)
+    {
+        simulation.addModel(new PrismModel());
+    }
+
+    void populateT6(tgSimulation& simulation, const Options&)
+    {
+        simulation.addModel(new T6Model());
+    }
+
+    void populateTetraSpine(tgSimulation& simulation, const Options&)
+    {
+        simulation.addModel(new TetraSpineLearningModel(3));
+    }
+
+    void populateNested(tgSimulation& simulation, const Options&)
+    {
+        simulation.addModel(new NestedStructureTestModel(4));
+    }
+
+    void populateContactCables(tgSimulation& simulation, const Options&)
+    {
+        simulation.addModel(new ContactCableDemo());
+    }
+
+    void populateBigPuppy(tgSimulation& simulation, const Options& options)
+    {
+        simulation.addModel(new TensegrityModel(options.yamlPath));
+    }
+
+    void populateBlockField(tgSimulation& simulation, const Options&)
+    {
+        // A SUPERball dropped into 2000 static blocks packed around it.
+        // Added as a model rather than an obstacle so that it survives the
+        // reset.
+        tgBlockField::Config config(btVector3(0.0, 0.0, 0.0), 0.5, 0.0,
+                                    btVector3(-50.0, 0.0, -50.0),
+                                    btVector3(50.0, 0.0, 50.0),
+                                    2000, 2.0, 2.0, 2.0);
+        simulation.addModel(new tgBlockField(config));
+        simulation.addModel(new T6Model());
+    }
+
+    // The gravities are those of the scenes' own applications
+    const Scene scenes[] =
+    {
+        { "PrismModel", 981, false, populatePrism },
+        { "T6Model", 98.1, false, populateT6 },
+        { "TetraSpine", 981, false, populateTetraSpine },
+        { "NestedTetrahedrons", 981, false, populateNested },
+        { "ContactCableDemo", 0.0, true, populateContactCables },
+        { "BigPuppy", 98.1, false, populateBigPuppy },
+        { "BlockField", 98.1, false, populateBlockField }
+    };
+    const std::size_t numScenes = sizeof(scenes) / sizeof(scenes[0]);
+
+    double now()
+    {
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return t.tv_sec + t.tv_nsec * 1e-9;
+    }
+
+    /**
+     * Restart the kernel's peak resident set size count, so that each
+     * scene's peak is its own.
+     * @return false if the kernel can't, in which case the peaks only grow
+     */
+    bool resetPeakRss()
+    {
+        std::ofstream clearRefs("/proc/self/clear_refs");
+        clearRefs << "5" << std::endl;
+        return clearRefs.good();
+    }
+
+    /** The peak resident set size in kilobytes */
+    long peakRss()
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, 6, "VmHWM:") == 0)
+            {
+                return std::atol(line.c_str() + 6);
+            }
+        }
+        // Linux reports ru_maxrss in kilobytes
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    /** The p-th percentile of sorted values, by the nearest rank */
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+        {
+            return 0.0;
+        }
+        std::size_t rank = static_cast<std::size_t>(p / 100.0 * sorted.size());
+        return sorted[std::min(rank, sorted.size() - 1)];
+    }
+
+    std::string jsonString(const std::string& s)
+    {
+        std::ostringstream os;
+        os << '"';
+        for (std::size_t i = 0; i < s.size(); i++)
+        {
+            const char c = s[i];
+            if (c == '"' || c == '\\')
+            {
+                os << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                   << static_cast<int>(c) << std::dec << std::setfill(' ');
+            }
+            else
+            {
+                os << c;
+            }
+        }
+        os << '"';
+        return os.str();
+    }
+
+    /**
+     * Build, step and reset one scene.
+     * @param[out] json the scene's JSON object
+     */
+    void runScene(const Scene& scene, const Options& options,
+                  bool peakIsPerScene, std::ostream& json)
+    {
+        json << "    {\n      \"name\": " << jsonString(scene.name);
+
+        const double setupStart = now();
+        tgGround* ground = scene.emptyGround ?
+            static_cast<tgGround*>(new tgEmptyGround()) :
+            static_cast<tgGround*>(new tgBoxGround());
+        tgWorld* pWorld = NULL;
+        try
+        {
+            tgWorld::Config config(scene.gravity, 1000, false,
+                                   options.solverType,
+                                   options.solverIterations,
+                                   options.broadphaseType);
+            config.minSolverIterations = options.minSolverIterations;
+            pWorld = new tgWorld(config, ground);
+        }
+        catch (const std::exception& e)
+        {
+            delete ground;
+            json << ",\n      \"error\": " << jsonString(e.what()) << "\n    }";
+            return;
+        }
+
+        try
+        {
+            tgSimView view(*pWorld, options.stepSize);
+            tgSimulation simulation(view);
+            scene.populate(simulation, options);
+            const double setupSeconds = now() - setupStart;
+
+            std::vector<double> latencies(options.steps);
+            const double runStart = now();
+            for (int i = 0; i < options.steps; i++)
+            {
+                const double stepStart = now();
+                simulation.step(options.stepSize);
+                latencies[i] = (now() - stepStart) * 1e6;
+            }
+            const double runSeconds = now() - runStart;
+            // Every rigid body in the world, the static ones included
+            const std::size_t bodies =
+                pWorld->getRigidStates().getStates().size();
+            // Gone with the world's implementation on reset
+            const tgWorldBulletPhysicsImpl::SolverIterationStats solver =
+                static_cast<tgWorldBulletPhysicsImpl&>(
+                    pWorld->implementation()).solverIterationStats();
+
+            const double resetStart = now();
+            simulation.reset();
+            const double resetSeconds = now() - resetStart;
+
+            double sum = 0.0;
+            for (std::size_t i = 0; i < latencies.size(); i++)
+            {
+                sum += latencies[i];
+            }
+            std::sort(latencies.begin(), latencies.end());
+
+            json << std::setprecision(6)
+                 << ",\n      \"rigidBodies\": " << bodies
+                 << ",\n      \"setupSeconds\": " << setupSeconds
+                 << ",\n      \"resetSeconds\": " << resetSeconds
+                 << ",\n      \"stepsPerSecond\": "
+                 << (runSeconds > 0.0 ? options.steps / runSeconds : 0.0)
+                 << ",\n      \"stepMicroseconds\": {"
+                 << "\"mean\": "
+                 << (latencies.empty() ? 0.0 : sum / latencies.size())
+                 << ", \"p50\": " << percentile(latencies, 50)
+                 << ", \"p90\": " << percentile(latencies, 90)
+                 << ", \"p99\": " << percentile(latencies, 99)
+                 << ", \"p999\": " << percentile(latencies, 99.9)
+                 << ", \"max\": "
+                 << (latencies.empty() ? 0.0 : latencies.back())
+                 << "}"
+                 << ",\n      \"solverIterations\": {"
+                 << "\"mean\": "
+                 << (solver.steps ? double(solver.iterations) / solver.steps : 0.0)
+                 << ", \"min\": " << solver.fewestIterations
+                 << ", \"max\": " << solver.mostIterations
+                 << "}"
+                 << ",\n      \"penetration\": {"
+                 << "\"mean\": "
+                 << (solver.steps ? solver.totalPenetration / solver.steps : 0.0)
+                 << ", \"max\": " << solver.maxPenetration
+                 << "}"
+                 << ",\n      \"peakRssKilobytes\": " << peakRss()
+                 << ",\n      \"peakRssIsPerScene\": "
+                 << (peakIsPerScene ? "true" : "false");
+            // The simulation deletes the models
+        }
+        catch (const std::exception& e)
+        {
+            json << ",\n      \"error\": " << jsonString(e.what());
+        }
+        json << "\n    }";
+        // The world deletes the ground
+        delete pWorld;
+    }
+
+    bool parseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            const std::string value = argv[++i];
+            if (arg == "--steps")
+            {
+                options.steps = std::atoi(value.c_str());
+                if (options.steps <= 0)
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--solver")
+            {
+                options.solverName = value;
+                if (value == "MLCP-Dantzig")
+                {
+                    options.solverType = tgWorld::Config::eMLCPDantzig;
+                }
+                else if (value == "MLCP-PGS")
+                {
+                    options.solverType = tgWorld::Config::eMLCPProjectedGaussSeidel;
+                }
+                else if (value == "SI")
+                {
+                    options.solverType = tgWorld::Config::eSequentialImpulse;
+                }
+                else if (value == "NNCG")
+                {
+                    options.solverType = tgWorld::Config::eNNCG;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--broadphase")
+            {
+                options.broadphaseName = value;
+                if (value == "AxisSweep")
+                {
+                    options.broadphaseType = tgWorld::Config::eAxisSweep;
+                }
+                else if (value == "Dbvt")
+                {
+                    options.broadphaseType = tgWorld::Config::eDbvt;
+                }
+                else if (value == "RecenteringAxisSweep")
+                {
+                    options.broadphaseType = tgWorld::Config::eRecenteringAxisSweep;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--iterations")
+            {
+                options.solverIterations = std::atoi(value.c_str());
+                if (options.solverIterations < 0)
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--min-iterations")
+            {
+                options.minSolverIterations = std::atoi(value.c_str());
+                if (options.minSolverIterations < 0)
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--scene")
+            {
+                options.scenes.push_back(value);
+            }
+            else if (arg == "--yaml")
+            {
+                options.yamlPath = value;
+            }
+            else if (arg == "--output")
+            {
+                options.outputPath = value;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+/**
+ * The entry point.
+ * @param[in] argc the number of command-line arguments
+ * @param[in] argv argv[0] is the executable name; then any of
+ * --steps N, --solver MLCP-Dantzig|MLCP-PGS|SI|NNCG,
+ * --broadphase AxisSweep|Dbvt|RecenteringAxisSweep, --iterations N and
+ * --min-iterations N (see tgWorld::Config::minSolverIterations),
+ * --scene name (repeatable), --yaml path (the BigPuppy structure) and
+ * --output file.json
+ * @return 0, or 1 on a usage error
+ */
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--steps N]"
+                  << " [--solver MLCP-Dantzig|MLCP-PGS|SI|NNCG]"
+                  << " [--broadphase AxisSweep|Dbvt|RecenteringAxisSweep]"
+                  << " [--iterations N] [--min-iterations N] [--scene name]..."
+                  << " [--yaml BigPuppy.yaml] [--output file.json]"
+                  << std::endl;
+        return 1;
+    }
+
+    std::ostringstream json;
+    json << "{\n  \"steps\": " << options.steps
+         << ",\n  \"stepSize\": " << options.stepSize
+         << ",\n  \"solver\": " << jsonString(options.solverName)
+         << ",\n  \"broadphase\": " << jsonString(options.broadphaseName)
+         << ",\n  \"solverIterations\": " << options.solverIterations
+         << ",\n  \"minSolverIterations\": " << options.minSolverIterations
+         << ",\n  \"scenes\": [\n";
+
+    bool first = true;
+    for (std::size_t s = 0; s < numScenes; s++)
+    {
+        if (!options.scenes.empty() &&
+            std::find(options.scenes.begin(), options.scenes.end(),
+                      scenes[s].name) == options.scenes.end())
+        {
+            continue;
+        }
+        if (!first)
+        {
+            json << ",\n";
+        }
+        first = false;
+        std::cerr << "AppBenchmark: " << scenes[s].name << std::endl;
+        const bool peakIsPerScene = resetPeakRss();
+        runScene(scenes[s], options, peakIsPerScene, json);
+    }
+    json << "\n  ]\n}\n";
+
+    if (options.outputPath.empty())
+    {
+        std::cout << json.str();
+    }
+    else
+    {
+        std::ofstream out(options.outputPath.c_str());
+        out << json.str();
+        if (!out)
+        {
+            std::cerr << "Could not write " << options.outputPath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
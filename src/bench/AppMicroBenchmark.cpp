@@ -0,0 +1,824 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file AppMicroBenchmark.cpp
+ * @brief Contains the definition function main() for an application that
+ * times single kernels of the library on synthetic fixtures of growing
+ * size and reports how their cost scales, as JSON
+ * $Id$
+ */
+
+// This library
+#include "core/terrain/tgEmptyGround.h"
+#include "core/tgBasicActuator.h"
+#include "core/tgBulletSpringCable.h"
+#include "core/tgBulletSpringCableAnchor.h"
+#include "core/tgModel.h"
+#include "core/tgRod.h"
+#include "core/tgTagSearch.h"
+#include "core/tgTags.h"
+#include "core/tgWorld.h"
+#include "sensors/tgDataLogger2.h"
+#include "sensors/tgRodSensor.h"
+#include "sensors/tgRodSensorInfo.h"
+#include "tgcreator/tgBasicContactCableInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgRigidAutoCompound.h"
+#include "tgcreator/tgRigidNodeIndex.h"
+#include "tgcreator/tgRodInfo.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+#include "util/CPGEquations.h"
+// Bullet Physics
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// POSIX
+#include <dirent.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+    /** What the command line chose */
+    struct Options
+    {
+        Options() :
+            minSize(16),
+            maxSize(4096),
+            minSeconds(0.05),
+            tolerance(0.3),
+            check(false)
+        {
+        }
+
+        std::size_t minSize;
+        std::size_t maxSize;
+        /** How long to run each size for, per repetition */
+        double minSeconds;
+        /** How far a fitted exponent may exceed the expected one */
+        double tolerance;
+        /** Exit with 2 if any kernel scales worse than expected */
+        bool check;
+        /** Only the kernels with these names; all if empty */
+        std::vector<std::string> kernels;
+        /** Where the JSON goes; standard output if empty */
+        std::string outputPath;
+    };
+
+    double now()
+    {
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return t.tv_sec + t.tv_nsec * 1e-9;
+    }
+
+    std::string jsonString(const std::string& s)
+    {
+        std::ostringstream os;
+        os << '"';
+        for (std::size_t i = 0; i < s.size(); i++)
+        {
+            const char c = s[i];
+            if (c == '"' || c == '\\')
+            {
+                os << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                   << static_cast<int>(c) << std::dec << std::setfill(' ');
+            }
+            else
+            {
+                os << c;
+            }
+        }
+        os << '"';
+        return os.str();
+    }
+
+    /** Results are added here so that the compiler keeps the calls */
+    volatile double sink = 0.0;
+
+    /** A kernel's inputs at one size. run() is the call that is timed. */
+    class Fixture
+    {
+    public:
+        virtual ~Fixture() {}
+        virtual void run() = 0;
+    };
+
+    /**
+     * A row of n upright rods, 1 apart, in a world with no gravity or
+     * ground. With contact cables, each runs from the top of a rod to the
+     * bottom of the one after next, across the rod between them.
+     */
+    class RodRowFixture : public Fixture
+    {
+    public:
+        RodRowFixture(std::size_t n, bool contactCables) :
+            m_pWorld(new tgWorld(tgWorld::Config(0.0), new tgEmptyGround()))
+        {
+            tgStructure structure;
+            for (std::size_t i = 0; i < n; i++)
+            {
+                structure.addNode(i, 0.0, 0.0);
+                structure.addNode(i, 1.0, 0.0);
+                structure.addPair(2 * i, 2 * i + 1, "rod");
+            }
+            for (std::size_t i = 0; contactCables && i + 2 < n; i++)
+            {
+                structure.addPair(2 * i + 1, 2 * (i + 2), "cable");
+            }
+
+            tgBuildSpec spec;
+            spec.addBuilder("rod", new tgRodInfo(tgRod::Config(0.1)));
+            spec.addBuilder("cable", new tgBasicContactCableInfo(
+                tgBasicActuator::Config(1000.0, 10.0)));
+            tgStructureInfo structureInfo(structure, spec);
+            structureInfo.buildInto(m_model, *m_pWorld);
+            m_model.setup(*m_pWorld);
+            // The contact cables find the rods they touch from the
+            // broadphase pairs of a world step
+            m_pWorld->step(0.001);
+
+            m_rods = m_model.getDescendantsOfType<tgRod>();
+            m_actuators = m_model.getDescendantsOfType<tgBasicActuator>();
+        }
+
+        virtual ~RodRowFixture()
+        {
+            m_model.teardown();
+            // The world deletes the ground
+            delete m_pWorld;
+        }
+
+    protected:
+        tgWorld* m_pWorld;
+        tgModel m_model;
+        std::vector<tgRod*> m_rods;
+        std::vector<tgBasicActuator*> m_actuators;
+    };
+
+    /** A tgBulletSpringCable between each rod and the next */
+    class SpringCableFixture : public RodRowFixture
+    {
+    public:
+        SpringCableFixture(std::size_t n) : RodRowFixture(n, false)
+        {
+            for (std::size_t i = 0; i + 1 < m_rods.size(); i++)
+            {
+                std::vector<tgBulletSpringCableAnchor*> anchors;
+                anchors.push_back(new tgBulletSpringCableAnchor(
+                    m_rods[i]->getPRigidBody(), btVector3(i, 1.0, 0.0)));
+                anchors.push_back(new tgBulletSpringCableAnchor(
+                    m_rods[i + 1]->getPRigidBody(), btVector3(i + 1, 0.0, 0.0)));
+                // Stretched, so that there is a force to apply
+                m_cables.push_back(new tgBulletSpringCable(anchors, 1000.0, 10.0, 100.0));
+            }
+        }
+
+        virtual ~SpringCableFixture()
+        {
+            // The cables delete their anchors
+            for (std::size_t i = 0; i < m_cables.size(); i++)
+            {
+                delete m_cables[i];
+            }
+        }
+
+        virtual void run()
+        {
+            for (std::size_t i = 0; i < m_cables.size(); i++)
+            {
+                m_cables[i]->step(0.001);
+            }
+        }
+
+    private:
+        std::vector<tgBulletSpringCable*> m_cables;
+    };
+
+    /**
+     * Steps the contact cables through their actuators, which only add
+     * notifying observers and sampling the cable to
+     * tgBulletContactSpringCable::step. That updates the cable's contact
+     * manifolds, prunes its anchors and applies its forces.
+     */
+    class ContactCableFixture : public RodRowFixture
+    {
+    public:
+        ContactCableFixture(std::size_t n) : RodRowFixture(n, true) {}
+
+        virtual void run()
+        {
+            for (std::size_t i = 0; i < m_actuators.size(); i++)
+            {
+                m_actuators[i]->step(0.001);
+            }
+        }
+    };
+
+    class RodSensorFixture : public RodRowFixture
+    {
+    public:
+        RodSensorFixture(std::size_t n) : RodRowFixture(n, false)
+        {
+            for (std::size_t i = 0; i < m_rods.size(); i++)
+            {
+                m_sensors.push_back(new tgRodSensor(m_rods[i]));
+            }
+        }
+
+        virtual ~RodSensorFixture()
+        {
+            for (std::size_t i = 0; i < m_sensors.size(); i++)
+            {
+                delete m_sensors[i];
+            }
+        }
+
+        virtual void run()
+        {
+            for (std::size_t i = 0; i < m_sensors.size(); i++)
+            {
+                sink = sink + m_sensors[i]->getSensorData().size();
+            }
+        }
+
+    private:
+        std::vector<tgRodSensor*> m_sensors;
+    };
+
+    /**
+     * A tgDataLogger2 with a tgRodSensor on every rod, logging every
+     * step to a file in a directory of its own, removed afterwards.
+     */
+    class DataLoggerFixture : public RodRowFixture
+    {
+    public:
+        DataLoggerFixture(std::size_t n) :
+            RodRowFixture(n, false),
+            m_pLogger(NULL)
+        {
+            char directory[] = "/tmp/AppMicroBenchmarkXXXXXX";
+            if (!mkdtemp(directory))
+            {
+                throw std::runtime_error("Could not create a directory for the log");
+            }
+            m_directory = directory;
+            m_pLogger = new tgDataLogger2(m_directory + "/log");
+            m_pLogger->addSenseable(&m_model);
+            m_pLogger->addSensorInfo(new tgRodSensorInfo());
+            // setup names the log file on standard output, where the JSON
+            // may be going
+            std::streambuf* const pOut = std::cout.rdbuf(std::cerr.rdbuf());
+            try
+            {
+                m_pLogger->setup();
+            }
+            catch (...)
+            {
+                std::cout.rdbuf(pOut);
+                removeDirectory();
+                delete m_pLogger;
+                throw;
+            }
+            std::cout.rdbuf(pOut);
+        }
+
+        virtual ~DataLoggerFixture()
+        {
+            // The logger deletes its sensors and sensor infos
+            m_pLogger->teardown();
+            delete m_pLogger;
+            removeDirectory();
+        }
+
+        virtual void run()
+        {
+            m_pLogger->step(0.001);
+        }
+
+    private:
+        void removeDirectory()
+        {
+            DIR* const pDir = opendir(m_directory.c_str());
+            if (pDir)
+            {
+                while (dirent* pEntry = readdir(pDir))
+                {
+                    const std::string name = pEntry->d_name;
+                    if (name != "." && name != "..")
+                    {
+                        std::remove((m_directory + "/" + name).c_str());
+                    }
+                }
+                closedir(pDir);
+            }
+            rmdir(m_directory.c_str());
+        }
+
+        tgDataLogger2* m_pLogger;
+        std::string m_directory;
+    };
+
+    /** A ring of n CPG nodes, each coupled to its two neighbours */
+    class CPGFixture : public Fixture
+    {
+    public:
+        CPGFixture(std::size_t n) : m_commands(n, 1.0)
+        {
+            std::vector<double> params(7);
+            params[0] = 1.0; // Frequency Offset
+            params[1] = 0.0; // Frequency Scale
+            params[2] = 1.0; // Radius Offset
+            params[3] = 0.0; // Radius Scale
+            params[4] = 20.0; // rConst (a constant)
+            params[5] = 0.0; // dMin for descending commands
+            params[6] = 5.0; // dMax for descending commands
+            for (std::size_t i = 0; i < n; i++)
+            {
+                m_system.addNode(params);
+            }
+            for (std::size_t i = 0; i < n; i++)
+            {
+                std::vector<int> connections;
+                connections.push_back((i + n - 1) % n);
+                connections.push_back((i + 1) % n);
+                std::vector<double> weights(2, 1.0);
+                std::vector<double> phases(2, M_PI / 2.0);
+                m_system.defineConnections(i, connections, weights, phases);
+            }
+            // The same number of Runge-Kutta steps every update, however
+            // the state evolves
+            m_system.setFixedStepSize(0.001);
+        }
+
+        virtual void run()
+        {
+            m_system.update(m_commands, 0.001);
+        }
+
+    private:
+        CPGEquations m_system;
+        std::vector<double> m_commands;
+    };
+
+    /** Tags t0 to t(n-1), and a query for four of them */
+    class TagsFixture : public Fixture
+    {
+    public:
+        TagsFixture(std::size_t n) : m_query(tagName(0) + " " +
+                                             tagName(n / 3) + " " +
+                                             tagName(2 * n / 3) + " " +
+                                             tagName(n - 1))
+        {
+            for (std::size_t i = 0; i < n; i++)
+            {
+                m_tags.append(tagName(i));
+            }
+        }
+
+        virtual void run()
+        {
+            sink = sink + m_tags.contains(m_query);
+        }
+
+        static std::string tagName(std::size_t i)
+        {
+            std::ostringstream os;
+            os << "t" << i;
+            return os.str();
+        }
+
+    protected:
+        tgTags m_tags;
+        const tgTags m_query;
+    };
+
+    /** As TagsFixture, with a search that requires, excludes and chooses */
+    class TagSearchFixture : public TagsFixture
+    {
+    public:
+        TagSearchFixture(std::size_t n) :
+            TagsFixture(n),
+            m_search(tagName(0) + " -x " + tagName(n / 2) + "|y")
+        {
+        }
+
+        virtual void run()
+        {
+            sink = sink + m_search.matches(m_tags);
+        }
+
+    private:
+        const tgTagSearch m_search;
+    };
+
+    /**
+     * n nodes named n0 to n(n-1), in children of 16 nodes each, looked up
+     * in turn
+     */
+    class FindNodeFixture : public Fixture
+    {
+    public:
+        FindNodeFixture(std::size_t n) : m_next(0)
+        {
+            for (std::size_t c = 0; c * 16 < n; c++)
+            {
+                std::ostringstream childName;
+                childName << "c" << c;
+                tgStructure child(childName.str());
+                for (std::size_t i = c * 16; i < n && i < (c + 1) * 16; i++)
+                {
+                    std::ostringstream name;
+                    name << "n" << i;
+                    m_names.push_back(name.str());
+                    child.addNode(i, 0.0, 0.0, name.str());
+                }
+                m_structure.addChild(child);
+            }
+            // Spread the lookups over the tree
+            std::random_shuffle(m_names.begin(), m_names.end());
+        }
+
+        virtual void run()
+        {
+            sink = sink + m_structure.findNode(m_names[m_next]).x();
+            m_next = (m_next + 1) % m_names.size();
+        }
+
+    private:
+        tgStructure m_structure;
+        std::vector<std::string> m_names;
+        std::size_t m_next;
+    };
+
+    /**
+     * n rod infos in chains of four sharing nodes, compounded as
+     * tgStructureInfo does. Compounding tags the rods, so each run creates
+     * and deletes its own infos, which is included in the time.
+     */
+    class AutoCompoundFixture : public Fixture
+    {
+    public:
+        AutoCompoundFixture(std::size_t n) : m_rods(n) {}
+
+        virtual void run()
+        {
+            std::vector<tgRigidInfo*> rigids;
+            const tgRod::Config config(0.1);
+            for (std::size_t i = 0; i < m_rods; i++)
+            {
+                // The rods of a chain share their ends
+                const double x = (i / 4) * 10.0 + i % 4;
+                rigids.push_back(new tgRodInfo(config,
+                    tgPair(btVector3(x, 0.0, 0.0), btVector3(x + 1.0, 0.0, 0.0))));
+            }
+            const tgRigidNodeIndex index(rigids);
+            tgRigidAutoCompound compound(index);
+            const std::vector<tgRigidInfo*> compounded = compound.execute();
+
+            const std::set<tgRigidInfo*> rods(rigids.begin(), rigids.end());
+            for (std::size_t i = 0; i < compounded.size(); i++)
+            {
+                if (rods.find(compounded[i]) == rods.end())
+                {
+                    delete compounded[i];
+                }
+            }
+            for (std::size_t i = 0; i < rigids.size(); i++)
+            {
+                delete rigids[i];
+            }
+            sink = sink + compounded.size();
+        }
+
+    private:
+        const std::size_t m_rods;
+    };
+
+    template <typename T>
+    Fixture* create(std::size_t n)
+    {
+        return new T(n);
+    }
+
+    /** One kernel and how its cost should grow with the fixture's size */
+    struct Kernel
+    {
+        const char* name;
+        /** What the size counts */
+        const char* unit;
+        /**
+         * The exponent of the size in the time of a run: 1 for a kernel
+         * run once per cable or node, 0 for a lookup
+         */
+        double expectedExponent;
+        Fixture* (*create)(std::size_t n);
+    };
+
+    const Kernel kernels[] =
+    {
+        { "tgBulletSpringCable::step", "cables", 1.0, create<SpringCableFixture> },
+        { "tgBulletContactSpringCable::step", "cables", 1.0, create<ContactCableFixture> },
+        { "CPGEquations::update", "nodes", 1.0, create<CPGFixture> },
+        { "tgTags::contains", "tags", 1.0, create<TagsFixture> },
+        { "tgTagSearch::matches", "tags", 1.0, create<TagSearchFixture> },
+        { "tgStructure::findNode", "nodes", 0.0, create<FindNodeFixture> },
+        { "tgRigidAutoCompound::execute", "rods", 1.0, create<AutoCompoundFixture> },
+        { "tgRodSensor::getSensorData", "rods", 1.0, create<RodSensorFixture> },
+        { "tgDataLogger2::step", "rods", 1.0, create<DataLoggerFixture> }
+    };
+    const std::size_t numKernels = sizeof(kernels) / sizeof(kernels[0]);
+
+    /**
+     * Time the fixture's run(). The number of runs per timing is doubled
+     * until a timing takes a tenth of minSeconds, then the fastest of
+     * three timings of minSeconds each is kept, as the least disturbed.
+     * @return seconds per run
+     */
+    double timeRuns(Fixture& fixture, double minSeconds)
+    {
+        fixture.run();
+        long runs = 1;
+        for (;;)
+        {
+            const double start = now();
+            for (long i = 0; i < runs; i++)
+            {
+                fixture.run();
+            }
+            if (now() - start >= minSeconds / 10.0)
+            {
+                break;
+            }
+            runs *= 2;
+        }
+
+        double best = 0.0;
+        for (int repetition = 0; repetition < 3; repetition++)
+        {
+            long done = 0;
+            const double start = now();
+            double elapsed = 0.0;
+            while (elapsed < minSeconds)
+            {
+                for (long i = 0; i < runs; i++)
+                {
+                    fixture.run();
+                }
+                done += runs;
+                elapsed = now() - start;
+            }
+            const double perRun = elapsed / done;
+            if (repetition == 0 || perRun < best)
+            {
+                best = perRun;
+            }
+        }
+        return best;
+    }
+
+    /** The least squares slope of log(seconds) against log(size) */
+    double fitExponent(const std::vector<std::size_t>& sizes,
+                       const std::vector<double>& seconds)
+    {
+        const std::size_t n = sizes.size();
+        if (n < 2)
+        {
+            return 0.0;
+        }
+        double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double x = std::log(static_cast<double>(sizes[i]));
+            const double y = std::log(seconds[i]);
+            sumX += x;
+            sumY += y;
+            sumXX += x * x;
+            sumXY += x * y;
+        }
+        const double denominator = n * sumXX - sumX * sumX;
+        return denominator > 0.0 ? (n * sumXY - sumX * sumY) / denominator : 0.0;
+    }
+
+    /**
+     * Time one kernel at every size.
+     * @param[out] json the kernel's JSON object
+     * @return false if it scaled worse than expected
+     */
+    bool runKernel(const Kernel& kernel, const Options& options,
+                   std::ostream& json)
+    {
+        json << "    {\n      \"name\": " << jsonString(kernel.name)
+             << ",\n      \"unit\": " << jsonString(kernel.unit);
+
+        std::vector<std::size_t> sizes;
+        std::vector<double> seconds;
+        try
+        {
+            for (std::size_t n = options.minSize; n <= options.maxSize; n *= 4)
+            {
+                Fixture* const pFixture = kernel.create(n);
+                try
+                {
+                    seconds.push_back(timeRuns(*pFixture, options.minSeconds));
+                }
+                catch (...)
+                {
+                    delete pFixture;
+                    throw;
+                }
+                delete pFixture;
+                sizes.push_back(n);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            json << ",\n      \"error\": " << jsonString(e.what()) << "\n    }";
+            return true;
+        }
+
+        const double exponent = fitExponent(sizes, seconds);
+        const bool scales = exponent <= kernel.expectedExponent + options.tolerance;
+        json << std::setprecision(6) << ",\n      \"sizes\": [";
+        for (std::size_t i = 0; i < sizes.size(); i++)
+        {
+            json << (i ? ", " : "") << "{\"size\": " << sizes[i]
+                 << ", \"nanosecondsPerRun\": " << seconds[i] * 1e9
+                 << ", \"nanosecondsPerItem\": " << seconds[i] * 1e9 / sizes[i]
+                 << "}";
+        }
+        json << "]"
+             << ",\n      \"exponent\": " << exponent
+             << ",\n      \"expectedExponent\": " << kernel.expectedExponent
+             << ",\n      \"scalesAsExpected\": " << (scales ? "true" : "false")
+             << "\n    }";
+        return scales;
+    }
+
+    bool parseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--check")
+            {
+                options.check = true;
+                continue;
+            }
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            const std::string value = argv[++i];
+            if (arg == "--min-size")
+            {
+                options.minSize = std::atol(value.c_str());
+                if (options.minSize < 3)
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--max-size")
+            {
+                options.maxSize = std::atol(value.c_str());
+            }
+            else if (arg == "--min-time")
+            {
+                options.minSeconds = std::atof(value.c_str());
+                if (options.minSeconds <= 0.0)
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--tolerance")
+            {
+                options.tolerance = std::atof(value.c_str());
+                if (options.tolerance < 0.0)
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--kernel")
+            {
+                options.kernels.push_back(value);
+            }
+            else if (arg == "--output")
+            {
+                options.outputPath = value;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.maxSize >= options.minSize;
+    }
+}
+
+/**
+ * The entry point.
+ * @param[in] argc the number of command-line arguments
+ * @param[in] argv argv[0] is the executable name; then any of
+ * --min-size N and --max-size N (the sizes are N, 4N, 16N... up to the
+ * maximum), --min-time seconds (per size and repetition), --kernel name
+ * (repeatable), --tolerance t (how far above the expected exponent a
+ * kernel may scale), --check and --output file.json
+ * @return 0; 1 on a usage error; 2 with --check if a kernel scaled worse
+ * than expected
+ */
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--min-size N] [--max-size N]"
+                  << " [--min-time seconds] [--kernel name]..."
+                  << " [--tolerance t] [--check] [--output file.json]"
+                  << std::endl;
+        return 1;
+    }
+
+    std::ostringstream json;
+    json << "{\n  \"minSeconds\": " << options.minSeconds
+         << ",\n  \"tolerance\": " << options.tolerance
+         << ",\n  \"kernels\": [\n";
+
+    bool first = true;
+    std::vector<std::string> regressions;
+    for (std::size_t k = 0; k < numKernels; k++)
+    {
+        if (!options.kernels.empty() &&
+            std::find(options.kernels.begin(), options.kernels.end(),
+                      kernels[k].name) == options.kernels.end())
+        {
+            continue;
+        }
+        if (!first)
+        {
+            json << ",\n";
+        }
+        first = false;
+        std::cerr << "AppMicroBenchmark: " << kernels[k].name << std::endl;
+        if (!runKernel(kernels[k], options, json))
+        {
+            regressions.push_back(kernels[k].name);
+        }
+    }
+    json << "\n  ]\n}\n";
+
+    if (options.outputPath.empty())
+    {
+        std::cout << json.str();
+    }
+    else
+    {
+        std::ofstream out(options.outputPath.c_str());
+        out << json.str();
+        if (!out)
+        {
+            std::cerr << "Could not write " << options.outputPath << std::endl;
+            return 1;
+        }
+    }
+
+    for (std::size_t i = 0; i < regressions.size(); i++)
+    {
+        std::cerr << "AppMicroBenchmark: " << regressions[i]
+                  << " scales worse than expected" << std::endl;
+    }
+    return options.check && !regressions.empty() ? 2 : 0;
+}
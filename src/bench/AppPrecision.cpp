@@ -0,0 +1,394 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file AppPrecision.cpp
+ * @brief Contains the definition function main() for an application that
+ * records the trajectories and speed of a set of scenes, or compares
+ * them with those recorded by a build of the other precision
+ * $Id$
+ */
+
+// This application
+#include "BenchScenes.h"
+// This library
+#include "core/tgSimView.h"
+#include "core/tgSimulation.h"
+#include "core/tgWorld.h"
+// The Bullet Physics library
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// POSIX
+#include <time.h>
+
+namespace
+{
+    struct Options
+    {
+        Options() :
+            duration(10.0),
+            stepSize(0.001),
+            sampleInterval(0.1),
+            tolerance(0.01)
+        {
+        }
+
+        double duration;
+        double stepSize;
+        double sampleInterval;
+        /** The relative error that counts as diverged */
+        double tolerance;
+        std::vector<std::string> scenes;
+        /** Where to write the trajectories, if recording */
+        std::string recordPath;
+        /** The trajectories to compare with, if comparing */
+        std::string comparePath;
+    };
+
+    /** What one scene did in one build */
+    struct Run
+    {
+        std::string precision;
+        double stepsPerSecond;
+        /** The positions at each sample */
+        std::vector<std::vector<double> > samples;
+    };
+
+    const char* precision()
+    {
+        return sizeof(btScalar) == sizeof(double) ? "double" : "float";
+    }
+
+    double now()
+    {
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return t.tv_sec + t.tv_nsec * 1e-9;
+    }
+
+    Run runScene(const BenchScene& scene, const Options& options)
+    {
+        Run run;
+        run.precision = precision();
+        tgWorld* const pWorld = scene.createWorld();
+        {
+            tgSimView view(*pWorld, options.stepSize);
+            // The simulation deletes the model
+            tgSimulation simulation(view);
+            simulation.addModel(scene.create());
+
+            const int steps =
+                static_cast<int>(options.duration / options.stepSize + 0.5);
+            const int stepsPerSample = std::max(1,
+                static_cast<int>(options.sampleInterval / options.stepSize + 0.5));
+            double seconds = 0.0;
+            for (int i = 0; i < steps; i++)
+            {
+                const double start = now();
+                simulation.step(options.stepSize);
+                seconds += now() - start;
+                if ((i + 1) % stepsPerSample == 0)
+                {
+                    run.samples.push_back(std::vector<double>());
+                    appendPositions(simulation, run.samples.back());
+                }
+            }
+            run.stepsPerSecond = seconds > 0.0 ? steps / seconds : 0.0;
+        }
+        delete pWorld;
+        return run;
+    }
+
+    /**
+     * The file has a line "scene <name> <precision> <steps per second>
+     * <samples> <positions per sample>" for each scene, then a line of
+     * positions for each sample.
+     */
+    void write(std::ostream& os, const std::string& name, const Run& run)
+    {
+        const std::size_t count =
+            run.samples.empty() ? 0 : run.samples[0].size();
+        os << "scene " << name << " " << run.precision << " "
+           << run.stepsPerSecond << " " << run.samples.size() << " "
+           << count << "\n";
+        for (std::size_t i = 0; i < run.samples.size(); i++)
+        {
+            for (std::size_t j = 0; j < run.samples[i].size(); j++)
+            {
+                os << (j == 0 ? "" : " ") << run.samples[i][j];
+            }
+            os << "\n";
+        }
+    }
+
+    std::map<std::string, Run> read(const std::string& path)
+    {
+        std::ifstream is(path.c_str());
+        if (!is)
+        {
+            throw std::runtime_error("Could not read " + path);
+        }
+        std::map<std::string, Run> runs;
+        std::string word;
+        while (is >> word)
+        {
+            std::string name;
+            std::size_t samples = 0;
+            std::size_t count = 0;
+            Run run;
+            if (word != "scene" ||
+                !(is >> name >> run.precision >> run.stepsPerSecond >>
+                  samples >> count))
+            {
+                throw std::runtime_error("Bad scene line in " + path);
+            }
+            run.samples.resize(samples, std::vector<double>(count));
+            for (std::size_t i = 0; i < samples; i++)
+            {
+                for (std::size_t j = 0; j < count; j++)
+                {
+                    if (!(is >> run.samples[i][j]))
+                    {
+                        throw std::runtime_error("Truncated samples in " + path);
+                    }
+                }
+            }
+            runs[name] = run;
+        }
+        return runs;
+    }
+
+    /**
+     * Write how far this run strayed from the reference: the largest and
+     * final distance of a body from its reference position, relative to
+     * the size of the box around all the reference positions, and when
+     * that first exceeded the tolerance.
+     */
+    void compare(const std::string& name, const Run& reference,
+                 const Run& run, const Options& options)
+    {
+        std::cout << std::left << std::setw(20) << name << std::right;
+        if (reference.samples.size() != run.samples.size() ||
+            reference.samples.empty() ||
+            reference.samples[0].size() != run.samples[0].size())
+        {
+            std::cout << "  the runs differ in length or bodies" << std::endl;
+            return;
+        }
+
+        const std::vector<double>& first = reference.samples[0];
+        btVector3 min(first[0], first[1], first[2]);
+        btVector3 max = min;
+        for (std::size_t i = 0; i < reference.samples.size(); i++)
+        {
+            for (std::size_t j = 0; j + 2 < reference.samples[i].size(); j += 3)
+            {
+                const std::vector<double>& s = reference.samples[i];
+                const btVector3 p(s[j], s[j + 1], s[j + 2]);
+                min.setMin(p);
+                max.setMax(p);
+            }
+        }
+        double scale = (max - min).length();
+        if (!(scale > 0.0))
+        {
+            scale = 1.0;
+        }
+
+        double maxError = 0.0;
+        double finalError = 0.0;
+        double divergedAt = -1.0;
+        for (std::size_t i = 0; i < run.samples.size(); i++)
+        {
+            double error = 0.0;
+            for (std::size_t j = 0; j + 2 < run.samples[i].size(); j += 3)
+            {
+                const std::vector<double>& r = reference.samples[i];
+                const std::vector<double>& s = run.samples[i];
+                const double dx = s[j] - r[j];
+                const double dy = s[j + 1] - r[j + 1];
+                const double dz = s[j + 2] - r[j + 2];
+                // NaN counts as diverged
+                const double d = std::sqrt(dx * dx + dy * dy + dz * dz) / scale;
+                error = d == d ? std::max(error, d) : HUGE_VAL;
+            }
+            maxError = std::max(maxError, error);
+            finalError = error;
+            if (divergedAt < 0.0 && error > options.tolerance)
+            {
+                divergedAt = (i + 1) * options.sampleInterval;
+            }
+        }
+
+        std::cout << std::setw(10) << reference.precision
+                  << std::setw(10) << run.precision
+                  << std::scientific << std::setprecision(3)
+                  << std::setw(12) << maxError << std::setw(12) << finalError
+                  << std::fixed << std::setprecision(2);
+        if (divergedAt < 0.0)
+        {
+            std::cout << std::setw(10) << "never";
+        }
+        else
+        {
+            std::cout << std::setw(10) << divergedAt;
+        }
+        std::cout << std::setprecision(0)
+                  << std::setw(12) << reference.stepsPerSecond
+                  << std::setw(12) << run.stepsPerSecond
+                  << std::setprecision(2) << std::setw(9)
+                  << (reference.stepsPerSecond > 0.0 ?
+                      run.stepsPerSecond / reference.stepsPerSecond : 0.0)
+                  << "x" << std::endl;
+    }
+
+    bool parseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            const std::string value = argv[++i];
+            if (arg == "--record")
+            {
+                options.recordPath = value;
+            }
+            else if (arg == "--compare")
+            {
+                options.comparePath = value;
+            }
+            else if (arg == "--scene")
+            {
+                options.scenes.push_back(value);
+            }
+            else if (arg == "--duration")
+            {
+                options.duration = std::atof(value.c_str());
+            }
+            else if (arg == "--tolerance")
+            {
+                options.tolerance = std::atof(value.c_str());
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.duration > 0.0 && options.tolerance > 0.0 &&
+            (options.recordPath.empty() != options.comparePath.empty());
+    }
+}
+
+/**
+ * The entry point. Record with one build, usually double, and compare
+ * with the other.
+ * @param[in] argc the number of command-line arguments
+ * @param[in] argv argv[0] is the executable name; then --record file or
+ * --compare file, and any of --scene name (repeatable), --duration s and
+ * --tolerance fraction
+ * @return 0, or 1 on an error
+ */
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::cerr << "Usage: " << argv[0] << " --record file | --compare file"
+                  << " [--scene name]... [--duration s] [--tolerance fraction]"
+                  << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        std::map<std::string, Run> references;
+        std::ofstream record;
+        if (options.recordPath.empty())
+        {
+            references = read(options.comparePath);
+            std::cout << std::left << std::setw(20) << "scene" << std::right
+                      << std::setw(10) << "reference" << std::setw(10) << "this"
+                      << std::setw(12) << "max error" << std::setw(12) << "final"
+                      << std::setw(10) << "over tol"
+                      << std::setw(12) << "ref steps/s"
+                      << std::setw(12) << "steps/s" << std::setw(10) << "speedup"
+                      << std::endl;
+        }
+        else
+        {
+            record.open(options.recordPath.c_str());
+            record << std::setprecision(17);
+        }
+
+        for (std::size_t s = 0; s < numBenchScenes; s++)
+        {
+            const BenchScene& scene = benchScenes[s];
+            if (!isSelected(scene, options.scenes))
+            {
+                continue;
+            }
+            const Run run = runScene(scene, options);
+            if (options.recordPath.empty())
+            {
+                std::map<std::string, Run>::const_iterator it =
+                    references.find(scene.name);
+                if (it == references.end())
+                {
+                    std::cout << std::left << std::setw(20) << scene.name
+                              << std::right << "  not recorded" << std::endl;
+                }
+                else
+                {
+                    compare(scene.name, it->second, run, options);
+                }
+            }
+            else
+            {
+                write(record, scene.name, run);
+                std::cout << scene.name << ": " << run.precision << ", "
+                          << std::fixed << std::setprecision(0)
+                          << run.stepsPerSecond << " steps/s" << std::endl;
+            }
+        }
+        if (!options.recordPath.empty() && !record)
+        {
+            throw std::runtime_error("Could not write " + options.recordPath);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file AppTimestepFinder.cpp
+ * @brief Contains the definition function main() for an application that
+ * finds the largest step size at which each of a set of scenes still
+ * follows its trajectory at a fine step size
+ * $Id$
+ */
+
+// This application
+#include "BenchScenes.h"
+// This library
+#include "core/tgModel.h"
+#include "core/tgSimView.h"
+#include "core/tgSimulation.h"
+#include "core/tgStopPredicate.h"
+#include "core/tgTimestepFinder.h"
+#include "core/tgWorld.h"
+// The C++ Standard Library
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    bool parseOptions(int argc, char** argv, tgTimestepFinder::Config& config,
+                      std::vector<std::string>& names, bool& compareCcd)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            const std::string value = argv[++i];
+            if (arg == "--scene")
+            {
+                names.push_back(value);
+            }
+            else if (arg == "--reference")
+            {
+                config.referenceStepSize = std::atof(value.c_str());
+            }
+            else if (arg == "--max")
+            {
+                config.maxStepSize = std::atof(value.c_str());
+            }
+            else if (arg == "--duration")
+            {
+                config.duration = std::atof(value.c_str());
+            }
+            else if (arg == "--tolerance")
+            {
+                config.tolerance = std::atof(value.c_str());
+            }
+            else if (arg == "--iterations")
+            {
+                config.iterations = std::atoi(value.c_str());
+            }
+            else if (arg == "--ccd" && (value == "on" || value == "off" ||
+                                        value == "both"))
+            {
+                config.continuousCollision = value != "off";
+                compareCcd = value == "both";
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** @return false if the search failed */
+    bool runScene(const BenchScene& scene, const tgTimestepFinder::Config& config)
+    {
+        std::cout << scene.name
+                  << (config.continuousCollision ? "" : " without ccd")
+                  << std::endl;
+        tgWorld* const pWorld = scene.createWorld();
+        bool found = true;
+        {
+            tgSimView view(*pWorld, config.referenceStepSize);
+            // The simulation deletes the model
+            tgSimulation simulation(view);
+            tgModel* const pModel = scene.create();
+            simulation.addModel(pModel);
+
+            tgDivergenceStopPredicate divergence(*pModel);
+            std::vector<tgStopPredicate*> predicates;
+            predicates.push_back(&divergence);
+            try
+            {
+                tgTimestepFinder finder(simulation, config);
+                tgTimestepFinder::write(std::cout, finder.find(predicates));
+            }
+            catch (const std::runtime_error& e)
+            {
+                std::cout << "failed: " << e.what() << std::endl;
+                found = false;
+            }
+        }
+        std::cout << std::endl;
+        delete pWorld;
+        return found;
+    }
+}
+
+/**
+ * The entry point.
+ * @param[in] argc the number of command-line arguments
+ * @param[in] argv argv[0] is the executable name; then any of
+ * --scene name (repeatable), --reference dt, --max dt, --duration s,
+ * --tolerance fraction, --iterations N and --ccd on|off|both; see
+ * tgTimestepFinder::Config. With --ccd both each scene is searched with
+ * continuous collision detection as the models configure it and again
+ * with it turned off.
+ * @return 0, 1 on a usage error, or 2 if a scene's search failed
+ */
+int main(int argc, char** argv)
+{
+    tgTimestepFinder::Config config;
+    std::vector<std::string> names;
+    bool compareCcd = false;
+    if (!parseOptions(argc, argv, config, names, compareCcd))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--scene name]..."
+                  << " [--reference dt] [--max dt] [--duration s]"
+                  << " [--tolerance fraction] [--iterations N]"
+                  << " [--ccd on|off|both]" << std::endl;
+        return 1;
+    }
+
+    int status = 0;
+    for (std::size_t s = 0; s < numBenchScenes; s++)
+    {
+        if (isSelected(benchScenes[s], names))
+        {
+            try
+            {
+                if (!runScene(benchScenes[s], config))
+                {
+                    status = 2;
+                }
+                if (compareCcd)
+                {
+                    tgTimestepFinder::Config withoutCcd = config;
+                    withoutCcd.continuousCollision = false;
+                    if (!runScene(benchScenes[s], withoutCcd))
+                    {
+                        status = 2;
+                    }
+                }
+            }
+            catch (const std::exception& e)
+            {
+                // An invalid configuration
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        }
+    }
+    return status;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file BenchScenes.cpp
+ * @brief Contains the definitions of the scenes shared by
+ * AppTimestepFinder and AppPrecision
+ * $Id$
+ */
+
+// This module
+#include "BenchScenes.h"
+// The scenes
+#include "examples/3_prism/PrismModel.h"
+#include "examples/SUPERball/T6Model.h"
+#include "examples/learningSpines/TetraSpine/TetraSpineLearningModel.h"
+#include "examples/contactCables/ContactCableDemo.h"
+// This library
+#include "core/terrain/tgBoxGround.h"
+#include "core/terrain/tgEmptyGround.h"
+#include "core/tgBulletUtil.h"
+#include "core/tgModel.h"
+#include "core/tgSimulation.h"
+#include "core/tgWorld.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <algorithm>
+
+namespace
+{
+    tgModel* createPrism()
+    {
+        return new PrismModel();
+    }
+
+    tgModel* createT6()
+    {
+        return new T6Model();
+    }
+
+    tgModel* createTetraSpine()
+    {
+        return new TetraSpineLearningModel(3);
+    }
+
+    tgModel* createContactCables()
+    {
+        return new ContactCableDemo();
+    }
+}
+
+// The gravities are those of the scenes' own applications
+const BenchScene benchScenes[] =
+{
+    { "PrismModel", 981, false, createPrism },
+    { "T6Model", 98.1, false, createT6 },
+    { "TetraSpine", 981, false, createTetraSpine },
+    { "ContactCableDemo", 0.0, true, createContactCables }
+};
+const std::size_t numBenchScenes = sizeof(benchScenes) / sizeof(benchScenes[0]);
+
+tgWorld* BenchScene::createWorld() const
+{
+    const tgWorld::Config config(gravity);
+    tgGround* ground = emptyGround ?
+        static_cast<tgGround*>(new tgEmptyGround()) :
+        static_cast<tgGround*>(new tgBoxGround());
+    try
+    {
+        // The world deletes the ground
+        return new tgWorld(config, ground);
+    }
+    catch (...)
+    {
+        delete ground;
+        throw;
+    }
+}
+
+bool isSelected(const BenchScene& scene, const std::vector<std::string>& names)
+{
+    return names.empty() ||
+        std::find(names.begin(), names.end(), scene.name) != names.end();
+}
+
+void appendPositions(const tgSimulation& simulation,
+                     std::vector<double>& positions)
+{
+    btDynamicsWorld& dynamicsWorld =
+        tgBulletUtil::worldToDynamicsWorld(simulation.getWorld());
+    btCollisionObjectArray& objects = dynamicsWorld.getCollisionObjectArray();
+    for (int i = 0; i < objects.size(); i++)
+    {
+        const btRigidBody* const pBody = btRigidBody::upcast(objects[i]);
+        if (pBody != NULL && pBody->getInvMass() > 0.0)
+        {
+            const btVector3& p = pBody->getCenterOfMassPosition();
+            positions.push_back(p.x());
+            positions.push_back(p.y());
+            positions.push_back(p.z());
+        }
+    }
+}
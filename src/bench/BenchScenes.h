@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef BENCH_SCENES_H
+#define BENCH_SCENES_H
+
+/**
+ * @file BenchScenes.h
+ * @brief Contains the definition of struct BenchScene, the scenes
+ * shared by AppTimestepFinder and AppPrecision
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgModel;
+class tgSimulation;
+class tgWorld;
+
+/** One scene with a single model and no controller */
+struct BenchScene
+{
+    const char* name;
+    /** In the units of the scene's models */
+    double gravity;
+    /** A tgEmptyGround rather than the default tgBoxGround */
+    bool emptyGround;
+    tgModel* (*create)();
+
+    /** A new world with the scene's gravity and ground */
+    tgWorld* createWorld() const;
+};
+
+/** PrismModel, T6Model, the TetraSpine and ContactCableDemo */
+extern const BenchScene benchScenes[];
+extern const std::size_t numBenchScenes;
+
+/**
+ * @param[in] names the scenes to run; all if empty
+ * @return whether scene is one of them
+ */
+bool isSelected(const BenchScene& scene, const std::vector<std::string>& names);
+
+/**
+ * Append the centres of mass of the bodies with mass in the
+ * simulation's world, as x, y and z, in the order of the world's
+ * collision objects.
+ */
+void appendPositions(const tgSimulation& simulation,
+                     std::vector<double>& positions);
+
+#endif  // BENCH_SCENES_H
@@ -0,0 +1,186 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBatchedImpedanceController.cpp
+ * @brief Implementation of the tgBatchedImpedanceController class
+ * $Id$
+ */
+
+#include "tgBatchedImpedanceController.h"
+
+#include "core/tgBasicActuator.h"
+#include "core/tgSpringCable.h"
+
+// The C++ Standard Library
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+#include <cstddef> // NULL keyword
+
+namespace
+{
+    /** The shortest rest length tgTensionController commands */
+    const double kMinRestLength = 0.1;
+
+    void checkGains(double offsetTension, double lengthStiffness, double velStiffness)
+    {
+        if (offsetTension < 0.0)
+        {
+            throw std::invalid_argument("Offset tension is negative.");
+        }
+        else if (lengthStiffness < 0.0)
+        {
+            throw std::invalid_argument("Length stiffness is negative.");
+        }
+        else if (velStiffness < 0.0)
+        {
+            throw std::invalid_argument("Velocity stiffness is negative.");
+        }
+    }
+}
+
+tgBatchedImpedanceController::tgBatchedImpedanceController(const std::vector<tgBasicActuator*>& actuators,
+                                                           double offsetTension,
+                                                           double lengthStiffness,
+                                                           double velStiffness) :
+m_actuators(actuators),
+m_offsetTension(actuators.size(), offsetTension),
+m_lengthStiffness(actuators.size(), lengthStiffness),
+m_velStiffness(actuators.size(), velStiffness),
+m_coefK(actuators.size()),
+m_restLength(actuators.size(), 0.0),
+m_length(actuators.size(), 0.0),
+m_velocity(actuators.size(), 0.0),
+m_tension(actuators.size(), 0.0),
+m_hasFrame(false),
+m_setTension(actuators.size(), 0.0),
+m_command(actuators.size(), 0.0)
+{
+    checkGains(offsetTension, lengthStiffness, velStiffness);
+    for (std::size_t i = 0; i < m_actuators.size(); i++)
+    {
+        if (m_actuators[i] == NULL)
+        {
+            throw std::invalid_argument("Actuator is NULL");
+        }
+        m_coefK[i] = m_actuators[i]->getSpringCable()->getCoefK();
+        assert(m_coefK[i] > 0.0);
+    }
+}
+
+void tgBatchedImpedanceController::setGains(std::size_t i,
+                                            double offsetTension,
+                                            double lengthStiffness,
+                                            double velStiffness)
+{
+    if (i >= size())
+    {
+        throw std::out_of_range("No actuator at that index");
+    }
+    checkGains(offsetTension, lengthStiffness, velStiffness);
+    m_offsetTension[i] = offsetTension;
+    m_lengthStiffness[i] = lengthStiffness;
+    m_velStiffness[i] = velStiffness;
+}
+
+void tgBatchedImpedanceController::sample()
+{
+    for (std::size_t i = 0; i < m_actuators.size(); i++)
+    {
+        const tgBasicActuator& actuator = *m_actuators[i];
+        m_restLength[i] = actuator.getRestLength();
+        m_length[i] = actuator.getCurrentLength();
+        m_velocity[i] = actuator.getVelocity();
+        m_tension[i] = actuator.getTension();
+    }
+    // The lengths were not read from a frame
+    m_hasFrame = false;
+}
+
+void tgBatchedImpedanceController::sample(const double* frame,
+                                          const std::vector<std::size_t>& offsets,
+                                          double dt)
+{
+    if (offsets.size() != size())
+    {
+        throw std::invalid_argument("Need one frame offset per actuator");
+    }
+    else if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+    
+    for (std::size_t i = 0; i < offsets.size(); i++)
+    {
+        const double* const pSensor = frame + offsets[i];
+        const double length = pSensor[1];
+        m_velocity[i] = m_hasFrame ? (length - m_length[i]) / dt : 0.0;
+        m_restLength[i] = pSensor[0];
+        m_length[i] = length;
+        m_tension[i] = pSensor[2];
+    }
+    m_hasFrame = true;
+}
+
+void tgBatchedImpedanceController::control(double dt,
+                                           const double* targetLengths,
+                                           const double* offsetVel)
+{
+    if (dt <= 0.0)
+    {
+        throw std::runtime_error ("Timestep must be positive.");
+    }
+    
+    // determineSetTension in tgImpedanceController.cpp
+    const std::size_t n = size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double vel = offsetVel ? m_velocity[i] - offsetVel[i] : m_velocity[i];
+        m_setTension[i] =
+            std::max(0.0, m_offsetTension[i] +
+                          m_lengthStiffness[i] * (m_length[i] - targetLengths[i]) +
+                          m_velStiffness[i] * vel);
+    }
+    applyTensions(dt);
+}
+
+void tgBatchedImpedanceController::controlTension(double dt, const double* setTensions)
+{
+    if (dt <= 0.0)
+    {
+        throw std::runtime_error ("Timestep must be positive.");
+    }
+    m_setTension.assign(setTensions, setTensions + size());
+    applyTensions(dt);
+}
+
+void tgBatchedImpedanceController::applyTensions(double dt)
+{
+    const std::size_t n = size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double diff = (m_setTension[i] - m_tension[i]) / m_coefK[i];
+        m_command[i] = std::max(kMinRestLength, m_restLength[i] - diff);
+    }
+    
+    for (std::size_t i = 0; i < n; i++)
+    {
+        m_actuators[i]->setControlInput(m_command[i], dt);
+    }
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_BATCHED_IMPEDANCE_CONTROLLER_H
+#define TG_BATCHED_IMPEDANCE_CONTROLLER_H
+
+/**
+ * @file tgBatchedImpedanceController.h
+ * @brief Definition of the tgBatchedImpedanceController class
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <vector>
+#include <cstddef> // NULL keyword
+
+// Forward declarations
+class tgBasicActuator;
+
+/**
+ * The tgImpedanceController and tgTensionController laws over many
+ * tgBasicActuators at once. Gains are kept in contiguous arrays indexed
+ * like the actuators. Each step, sample() gathers lengths, velocities and
+ * tensions into arrays, either through the actuators or from a
+ * tgDataManager numeric frame, then control() computes every command in
+ * one pass and writes them with setControlInput(newLength, dt).
+ */
+class tgBatchedImpedanceController
+{
+public:
+    
+    /**
+     * @param[in] actuators the actuators, which are not owned; none may
+     * be NULL
+     * @param[in] offsetTension the offset tension of every actuator
+     * @param[in] lengthStiffness the length stiffness of every actuator
+     * @param[in] velStiffness the velocity stiffness of every actuator
+     * @throw std::invalid_argument if an actuator is NULL or a gain is
+     * negative
+     */
+    tgBatchedImpedanceController(const std::vector<tgBasicActuator*>& actuators,
+                                 double offsetTension = 0.001,
+                                 double lengthStiffness = 0.0,
+                                 double velStiffness = 0.0);
+    
+    /** The number of actuators */
+    std::size_t size() const
+    {
+        return m_actuators.size();
+    }
+    
+    /**
+     * Replace the gains of one actuator.
+     * @throw std::out_of_range if i is not less than size()
+     * @throw std::invalid_argument if a gain is negative
+     */
+    void setGains(std::size_t i,
+                  double offsetTension,
+                  double lengthStiffness,
+                  double velStiffness);
+    
+    /** Read the state of every actuator through the actuators */
+    void sample();
+    
+    /**
+     * Read the state of every actuator from a tgDataManager frame.
+     * Velocities are the change in current length since the previous
+     * frame, and zero on the first one.
+     * @param[in] frame as filled by tgDataManager::sampleFrameInto
+     * @param[in] offsets for each actuator, the frame offset of its
+     * tgSpringCableActuatorSensor (RestLen, CurrLen, Tension)
+     * @param[in] dt the number of seconds since the previous frame; must
+     * be positive
+     * @throw std::invalid_argument if there is not one offset per
+     * actuator or dt is not positive
+     */
+    void sample(const double* frame,
+                const std::vector<std::size_t>& offsets,
+                double dt);
+    
+    /**
+     * Impedance control of every actuator, as
+     * tgImpedanceController::control(tgBasicActuator&, ...).
+     * @param[in] dt the number of seconds since the last call; must be
+     * positive
+     * @param[in] targetLengths size() target lengths
+     * @param[in] offsetVel size() offset velocities, or NULL for zero
+     * @throw std::runtime_error if dt is not positive
+     */
+    void control(double dt,
+                 const double* targetLengths,
+                 const double* offsetVel = NULL);
+    
+    /**
+     * Tension control of every actuator, as
+     * tgTensionController::control(tgBasicActuator&, dt, setPoint).
+     * @param[in] dt the number of seconds since the last call; must be
+     * positive
+     * @param[in] setTensions size() tension set points
+     * @throw std::runtime_error if dt is not positive
+     */
+    void controlTension(double dt, const double* setTensions);
+    
+    /** The tensions commanded by the last call to control() */
+    const std::vector<double>& getSetTensions() const
+    {
+        return m_setTension;
+    }
+    
+    /** The rest lengths commanded by the last call to control() */
+    const std::vector<double>& getCommands() const
+    {
+        return m_command;
+    }
+    
+private:
+    
+    /** Turn m_setTension into rest lengths and write them */
+    void applyTensions(double dt);
+    
+    std::vector<tgBasicActuator*> m_actuators;
+    
+    std::vector<double> m_offsetTension;
+    std::vector<double> m_lengthStiffness;
+    std::vector<double> m_velStiffness;
+    
+    /** The spring constant of each actuator's cable */
+    std::vector<double> m_coefK;
+    
+    /** The state read by the last sample() */
+    std::vector<double> m_restLength;
+    std::vector<double> m_length;
+    std::vector<double> m_velocity;
+    std::vector<double> m_tension;
+    
+    /** True once a frame has been sampled and m_length can be differenced */
+    bool m_hasFrame;
+    
+    std::vector<double> m_setTension;
+    std::vector<double> m_command;
+};
+
+#endif  // TG_BATCHED_IMPEDANCE_CONTROLLER_H
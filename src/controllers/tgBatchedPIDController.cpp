@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBatchedPIDController.cpp
+ * @brief Implementation of the tgBatchedPIDController class
+ * $Id$
+ */
+
+#include "tgBatchedPIDController.h"
+
+#include "core/tgControllable.h"
+
+// The C++ Standard Library
+#include <stdexcept>
+#include <cstddef> // NULL keyword
+
+tgBatchedPIDController::tgBatchedPIDController(const std::vector<tgControllable*>& controllables,
+                                               const tgPIDController::Config& config) :
+m_controllables(controllables),
+m_kP(controllables.size(), config.kP),
+m_kI(controllables.size(), config.kI),
+m_kD(controllables.size(), config.kD),
+m_setPoint(controllables.size(), config.startingSetPoint),
+m_prevError(controllables.size(), 0.0),
+m_intError(controllables.size(), 0.0),
+m_result(controllables.size(), 0.0)
+{
+    for (std::size_t i = 0; i < m_controllables.size(); i++)
+    {
+        if (m_controllables[i] == NULL)
+        {
+            throw std::invalid_argument("Controllable is NULL");
+        }
+    }
+}
+
+void tgBatchedPIDController::setConfig(std::size_t i, const tgPIDController::Config& config)
+{
+    if (i >= size())
+    {
+        throw std::out_of_range("No controllable at that index");
+    }
+    m_kP[i] = config.kP;
+    m_kI[i] = config.kI;
+    m_kD[i] = config.kD;
+}
+
+void tgBatchedPIDController::control(double dt, const double* setPoints, const double* sensorData)
+{
+    if (dt <= 0.0)
+    {
+        throw std::runtime_error ("Timestep must be positive.");
+    }
+    
+    const std::size_t n = size();
+    if (setPoints != NULL)
+    {
+        m_setPoint.assign(setPoints, setPoints + n);
+    }
+    
+    // The same law as tgPIDController::control, for every controllable
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double error = m_setPoint[i] - sensorData[i];
+        m_intError[i] += (error + m_prevError[i]) / 2.0 * dt;
+        const double dError = (error - m_prevError[i]) / dt;
+        m_result[i] = m_kP[i] * error + m_kI[i] * m_intError[i] +
+                      m_kD[i] * dError;
+        m_prevError[i] = error;
+    }
+    
+    for (std::size_t i = 0; i < n; i++)
+    {
+        m_controllables[i]->setControlInput(m_result[i]);
+    }
+}
+
+void tgBatchedPIDController::reset()
+{
+    m_prevError.assign(size(), 0.0);
+    m_intError.assign(size(), 0.0);
+}
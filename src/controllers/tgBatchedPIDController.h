@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_BATCHED_PID_CONTROLLER_H
+#define TG_BATCHED_PID_CONTROLLER_H
+
+/**
+ * @file tgBatchedPIDController.h
+ * @brief Definition of the tgBatchedPIDController class
+ * $Id$
+ */
+
+#include "tgPIDController.h"
+
+// The C++ Standard Library
+#include <vector>
+
+// Forward declarations
+class tgControllable;
+
+/**
+ * The tgPIDController law over many controllables at once. Gains, errors
+ * and integrals are kept in contiguous arrays indexed like the
+ * controllables, and control() updates all of them in one pass before
+ * writing the results with setControlInput.
+ */
+class tgBatchedPIDController
+{
+public:
+    
+    /**
+     * @param[in] controllables the controllables, which are not owned;
+     * none may be NULL
+     * @param[in] config the gains and starting set point of every
+     * controllable; see setConfig to change one
+     * @throw std::invalid_argument if a controllable is NULL
+     */
+    tgBatchedPIDController(const std::vector<tgControllable*>& controllables,
+                           const tgPIDController::Config& config = tgPIDController::Config());
+    
+    /** The number of controllables */
+    std::size_t size() const
+    {
+        return m_controllables.size();
+    }
+    
+    /**
+     * Replace the gains of one controllable. Its set point is not
+     * changed.
+     * @throw std::out_of_range if i is not less than size()
+     */
+    void setConfig(std::size_t i, const tgPIDController::Config& config);
+    
+    /**
+     * Run one step of every controller.
+     * @param[in] dt the number of seconds since the last call; must be
+     * positive
+     * @param[in] setPoints size() set points, or NULL to keep the current
+     * ones
+     * @param[in] sensorData size() measurements
+     * @throw std::runtime_error if dt is not positive
+     */
+    void control(double dt, const double* setPoints, const double* sensorData);
+    
+    /** Zero the integrated and previous errors */
+    void reset();
+    
+    /** The set points, indexed like the controllables */
+    const std::vector<double>& getSetPoints() const
+    {
+        return m_setPoint;
+    }
+    
+    /** The inputs written by the last call to control() */
+    const std::vector<double>& getControlInputs() const
+    {
+        return m_result;
+    }
+    
+private:
+    
+    std::vector<tgControllable*> m_controllables;
+    
+    /** Gains, already negated for tension control */
+    std::vector<double> m_kP;
+    std::vector<double> m_kI;
+    std::vector<double> m_kD;
+    
+    std::vector<double> m_setPoint;
+    std::vector<double> m_prevError;
+    std::vector<double> m_intError;
+    std::vector<double> m_result;
+};
+
+#endif  // TG_BATCHED_PID_CONTROLLER_H
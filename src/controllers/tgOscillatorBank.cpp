@@ -0,0 +1,143 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgOscillatorBank.cpp
+ * @brief Implementation of the tgOscillatorBank class
+ * $Id$
+ */
+
+#include "tgOscillatorBank.h"
+
+// The C++ Standard Library
+#include <cmath>
+#include <stdexcept>
+
+tgOscillatorBank::tgOscillatorBank() :
+m_rotationDt(0.0),
+m_rotationValid(false),
+m_time(0.0),
+m_advancesSinceResync(0)
+{
+}
+
+std::size_t tgOscillatorBank::add(double amplitude, double frequency,
+                                  double phase, double offset)
+{
+    const double theta = frequency * m_time + phase;
+    m_amplitude.push_back(amplitude);
+    m_frequency.push_back(frequency);
+    m_phase.push_back(phase);
+    m_offset.push_back(offset);
+    m_sin.push_back(std::sin(theta));
+    m_cos.push_back(std::cos(theta));
+    m_rotationCos.push_back(1.0);
+    m_rotationSin.push_back(0.0);
+    m_value.push_back(offset + amplitude * m_sin.back());
+    m_rotationValid = false;
+    return m_value.size() - 1;
+}
+
+void tgOscillatorBank::clear()
+{
+    m_amplitude.clear();
+    m_frequency.clear();
+    m_phase.clear();
+    m_offset.clear();
+    m_sin.clear();
+    m_cos.clear();
+    m_rotationCos.clear();
+    m_rotationSin.clear();
+    m_value.clear();
+    m_rotationValid = false;
+    m_time = 0.0;
+    m_advancesSinceResync = 0;
+}
+
+void tgOscillatorBank::setAmplitude(std::size_t i, double amplitude, double offset)
+{
+    if (i >= size())
+    {
+        throw std::out_of_range("No such oscillator");
+    }
+    m_amplitude[i] = amplitude;
+    m_offset[i] = offset;
+    m_value[i] = offset + amplitude * m_sin[i];
+}
+
+void tgOscillatorBank::setRotation(double dt)
+{
+    const std::size_t n = size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        m_rotationCos[i] = std::cos(m_frequency[i] * dt);
+        m_rotationSin[i] = std::sin(m_frequency[i] * dt);
+    }
+    m_rotationDt = dt;
+    m_rotationValid = true;
+}
+
+void tgOscillatorBank::resync()
+{
+    const std::size_t n = size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double theta = m_frequency[i] * m_time + m_phase[i];
+        m_sin[i] = std::sin(theta);
+        m_cos[i] = std::cos(theta);
+    }
+    m_advancesSinceResync = 0;
+}
+
+void tgOscillatorBank::advance(double dt)
+{
+    m_time += dt;
+
+    const std::size_t n = size();
+    if (++m_advancesSinceResync >= resyncInterval)
+    {
+        resync();
+    }
+    else
+    {
+        // Differences in the last bits of dt, as between successive
+        // differences of an accumulated time, do not need new rotations
+        if (!m_rotationValid ||
+            std::fabs(dt - m_rotationDt) > 1e-12 * std::fabs(dt))
+        {
+            setRotation(dt);
+        }
+
+        // sin(a + b) and cos(a + b)
+        double* const s = n ? &m_sin[0] : NULL;
+        double* const c = n ? &m_cos[0] : NULL;
+        const double* const rc = n ? &m_rotationCos[0] : NULL;
+        const double* const rs = n ? &m_rotationSin[0] : NULL;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double sinA = s[i];
+            s[i] = sinA * rc[i] + c[i] * rs[i];
+            c[i] = c[i] * rc[i] - sinA * rs[i];
+        }
+    }
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        m_value[i] = m_offset[i] + m_amplitude[i] * m_sin[i];
+    }
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_OSCILLATOR_BANK_H
+#define TG_OSCILLATOR_BANK_H
+
+/**
+ * @file tgOscillatorBank.h
+ * @brief Definition of the tgOscillatorBank class
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <vector>
+#include <cstddef>
+
+/**
+ * Many sine wave generators advanced together, for the open loop sine
+ * controllers. Oscillator i gives
+ *
+ *     offset[i] + amplitude[i] * sin(frequency[i] * t + phase[i])
+ *
+ * with frequencies in radians per second. Rather than calling sin for
+ * every oscillator on every step, each keeps its sine and cosine and
+ * advance() rotates them by frequency * dt, a few multiplies each. The
+ * rotations are cached for the last dt, so a fixed timestep calls sin
+ * and cos once per oscillator when the step size changes. Every
+ * resyncInterval advances the phases are recomputed from the time, so
+ * rounding in the rotations does not accumulate.
+ *
+ * Oscillators are kept in contiguous arrays indexed by the order they
+ * were added.
+ */
+class tgOscillatorBank
+{
+public:
+
+    /** Advances between recomputing the phases from the time */
+    static const std::size_t resyncInterval = 256;
+
+    tgOscillatorBank();
+
+    /**
+     * Add an oscillator at the bank's current time.
+     * @param[in] amplitude of the sine wave
+     * @param[in] frequency in radians per second
+     * @param[in] phase in radians, at time zero
+     * @param[in] offset added to the sine wave
+     * @return its index
+     */
+    std::size_t add(double amplitude, double frequency, double phase,
+                    double offset = 0.0);
+
+    /** The number of oscillators */
+    std::size_t size() const
+    {
+        return m_value.size();
+    }
+
+    /** Drop every oscillator and go back to time zero */
+    void clear();
+
+    /**
+     * Change an oscillator's amplitude and offset, keeping its phase
+     * @throw std::out_of_range if i is not less than size()
+     */
+    void setAmplitude(std::size_t i, double amplitude, double offset);
+
+    /**
+     * Advance every oscillator by dt seconds and update its value.
+     * @param[in] dt may be zero or negative
+     */
+    void advance(double dt);
+
+    /**
+     * Advance to a time, doing nothing if the bank is already there.
+     * For controllers of single actuators sharing one bank: the first
+     * to reach a new time advances every oscillator, the rest read.
+     */
+    void advanceTo(double time)
+    {
+        if (time != m_time)
+        {
+            advance(time - m_time);
+        }
+    }
+
+    double getTime() const
+    {
+        return m_time;
+    }
+
+    /** Oscillator i's offset + amplitude * sine */
+    double value(std::size_t i) const
+    {
+        return m_value[i];
+    }
+
+    /** Oscillator i's sin(frequency * t + phase) */
+    double sine(std::size_t i) const
+    {
+        return m_sin[i];
+    }
+
+    /** Oscillator i's cos(frequency * t + phase) */
+    double cosine(std::size_t i) const
+    {
+        return m_cos[i];
+    }
+
+    /** Every oscillator's value, indexed like add's return */
+    const std::vector<double>& getValues() const
+    {
+        return m_value;
+    }
+
+private:
+
+    /** Set the sines and cosines from the time, with libm */
+    void resync();
+
+    /** Set the cached rotations for a step of dt */
+    void setRotation(double dt);
+
+    std::vector<double> m_amplitude;
+    std::vector<double> m_frequency;
+    std::vector<double> m_phase;
+    std::vector<double> m_offset;
+
+    /** The current sine and cosine of each oscillator's phase */
+    std::vector<double> m_sin;
+    std::vector<double> m_cos;
+
+    /** cos and sin of frequency * m_rotationDt */
+    std::vector<double> m_rotationCos;
+    std::vector<double> m_rotationSin;
+
+    std::vector<double> m_value;
+
+    /** The step m_rotationCos and m_rotationSin are for */
+    double m_rotationDt;
+
+    /** False when oscillators were added since the rotations were set */
+    bool m_rotationValid;
+
+    double m_time;
+
+    std::size_t m_advancesSinceResync;
+};
+
+#endif  // TG_OSCILLATOR_BANK_H
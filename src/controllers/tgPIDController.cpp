@@ -66,7 +66,9 @@ tgPIDController::tgPIDController(tgControllable* controllable, tgPIDController::
 m_sensorData(0.0),
 m_prevError(0.0),
 m_intError(0.0),
-m_config(config),
+m_kP(config.kP),
+m_kI(config.kI),
+m_kD(config.kD),
 tgBasicController(controllable, config.startingSetPoint)
 {
 	assert(controllable != NULL);
@@ -77,6 +79,20 @@ tgPIDController::~tgPIDController()
 	// tgBasicController owns m_controllable
 }
 	
+void tgPIDController::setConfig(const tgPIDController::Config& config)
+{
+	m_kP = config.kP;
+	m_kI = config.kI;
+	m_kD = config.kD;
+}
+
+void tgPIDController::reset()
+{
+	m_sensorData = 0.0;
+	m_prevError = 0.0;
+	m_intError = 0.0;
+}
+	
 void tgPIDController::control(double dt)
 {
 	if (dt <= 0.0)
@@ -89,8 +105,8 @@ void tgPIDController::control(double dt)
 	/// Integrate using trapezoid rule to reduce error in integration over rectangle
 	m_intError += (error + m_prevError) / 2.0 * dt;
 	double dError = (error - m_prevError) / dt;
-	double result = m_config.kP * error + m_config.kI * m_intError +
-					m_config.kD * dError;
+	double result = m_kP * error + m_kI * m_intError +
+					m_kD * dError;
 	
 	m_controllable->setControlInput(result);
 	
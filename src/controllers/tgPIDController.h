@@ -132,6 +132,19 @@ public:
 	 */
 	virtual void setSensorData(double sensorData);
 	
+	/**
+	 * Replace the gains, e.g. between trials, keeping the set point
+	 * and the accumulated errors.
+	 * @param[in] config the new gains, validated by its constructor
+	 */
+	void setConfig(const tgPIDController::Config& config);
+	
+	/**
+	 * Forget the accumulated errors and the sensor data, e.g. between
+	 * trials, keeping the gains and the set point.
+	 */
+	void reset();
+	
 	/// @todo should we have a getSensorData function? Might make code changes simpler later
 	
 private:
@@ -152,9 +165,11 @@ private:
 	double m_intError;
 	
 	/**
-	 * A locally stored config, contains the gains
+	 * The gains, copied from the config so setConfig can replace them
 	 */
-	const tgPIDController::Config m_config;
+	double m_kP;
+	double m_kI;
+	double m_kD;
 };
 
 #endif  // TG_PID_CONTROLLER_H
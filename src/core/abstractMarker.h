@@ -56,6 +56,16 @@ public:
 		return nodeNumber;
 	}
 
+	/** The body the marker moves with */
+	const btRigidBody* getAttachedBody() const {
+		return attachedBody;
+	}
+
+	/** The marker's position in the attached body's frame */
+	const btVector3& getLocalPosition() const {
+		return attachedRelativeOriginalPosition;
+	}
+
 private:
         btVector3 color;
         const btRigidBody *attachedBody;
@@ -34,6 +34,7 @@
 
 // The C++ Standard Library
 #include <cassert>
+#include <cmath>
 #include <iostream>
 
 tgBoxGround::Config::Config( btVector3 eulerAngles,
@@ -70,6 +71,20 @@ m_config(config)
 }
 
 
+bool tgBoxGround::getSurfaceHeight(double x, double z, double& height) const
+{
+    // The box's half extents are m_size
+    const btVector3& origin = m_config.m_origin;
+    const btVector3& size = m_config.m_size;
+    if (!m_config.m_eulerAngles.isZero() ||
+        fabs(x - origin.x()) > size.x() || fabs(z - origin.z()) > size.z())
+    {
+        return false;
+    }
+    height = origin.y() + size.y();
+    return true;
+}
+
 btRigidBody* tgBoxGround::getGroundRigidBody() const
 {
         std::cout << "Box Ground" << std::endl;
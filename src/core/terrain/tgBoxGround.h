@@ -103,6 +103,12 @@ public:
      */
     virtual btRigidBody* getGroundRigidBody() const;
 
+    /**
+     * The top of the box, if it is not rotated. See
+     * tgBulletGround::getSurfaceHeight.
+     */
+    virtual bool getSurfaceHeight(double x, double z, double& height) const;
+
 private:  
     /**
      * Store the configuration data for use later
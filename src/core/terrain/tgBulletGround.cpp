@@ -28,20 +28,33 @@
 
 //Bullet Physics
 #include "BulletCollision/CollisionShapes/btCollisionShape.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btMotionState.h"
 
 // The C++ Standard Library
 #include <cassert>
 
 tgBulletGround::tgBulletGround() :
 tgGround(),
-pGroundShape(NULL)
+pGroundShape(NULL),
+m_pKeptBody(NULL),
+m_keptBodyInUse(false)
 {
+    pthread_mutex_init(&m_bodyMutex, NULL);
     // Supress compiler warning for bullet's unused variable
     (void) btInfinityMask;
 }
 
 tgBulletGround::~tgBulletGround() 
 { 
+    // Worlds must be destroyed before their ground
+    assert(!m_keptBodyInUse);
+    if (m_pKeptBody)
+    {
+        delete m_pKeptBody->getMotionState();
+        delete m_pKeptBody;
+    }
+    pthread_mutex_destroy(&m_bodyMutex);
     delete pGroundShape;
 }
 
@@ -50,3 +63,52 @@ btCollisionShape* const tgBulletGround::getCollisionShape() const
 	assert(pGroundShape);
 	return pGroundShape;
 }
+
+btRigidBody* tgBulletGround::acquireRigidBody()
+{
+    pthread_mutex_lock(&m_bodyMutex);
+    btRigidBody* pBody = NULL;
+    if (!m_keptBodyInUse)
+    {
+        if (m_pKeptBody == NULL)
+        {
+            m_pKeptBody = getGroundRigidBody();
+        }
+        pBody = m_pKeptBody;
+        m_keptBodyInUse = true;
+    }
+    pthread_mutex_unlock(&m_bodyMutex);
+
+    if (pBody == NULL)
+    {
+        // Another world has the kept body
+        pBody = getGroundRigidBody();
+    }
+    assert(pBody);
+    return pBody;
+}
+
+void tgBulletGround::releaseRigidBody(btRigidBody* pBody)
+{
+    assert(pBody);
+    assert(pBody->getBroadphaseHandle() == NULL);
+    pthread_mutex_lock(&m_bodyMutex);
+    const bool kept = (pBody == m_pKeptBody);
+    if (kept)
+    {
+        assert(m_keptBodyInUse);
+        m_keptBodyInUse = false;
+    }
+    pthread_mutex_unlock(&m_bodyMutex);
+
+    if (!kept)
+    {
+        delete pBody->getMotionState();
+        delete pBody;
+    }
+}
+
+bool tgBulletGround::getSurfaceHeight(double x, double z, double& height) const
+{
+    return false;
+}
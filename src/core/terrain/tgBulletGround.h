@@ -28,6 +28,9 @@
 
 #include "tgGround.h"
 
+// The C++ Standard Library
+#include <pthread.h>
+
 // Forward declarations
 class btRigidBody;
 class btCollisionShape;
@@ -59,9 +62,52 @@ public:
 	 */
     btCollisionShape* const getCollisionShape() const;    
 
+    /**
+     * Get a rigid body for a world to insert. The ground keeps one body
+     * from getGroundRigidBody across worlds: a world reset hands it back
+     * through releaseRigidBody and the next world reinserts it, so the
+     * terrain is not rebuilt every episode. A world asking while that
+     * body is in another world gets a body of its own over the same
+     * collision shape, which the worlds only read. Safe to call from
+     * several threads.
+     * @return a static rigid body to be handed back to releaseRigidBody
+     * once it has been removed from its world
+     */
+    btRigidBody* acquireRigidBody();
+
+    /**
+     * Take back a body from acquireRigidBody; it must no longer be in a
+     * world. The kept body is held for the next world and any other is
+     * deleted with its motion state.
+     */
+    void releaseRigidBody(btRigidBody* pBody);
+
+    /**
+     * The height of the surface above or below a point in the plane of
+     * the ground, for grounds that know it without a ray test (e.g.
+     * tgRaycastSensor probes pointing straight down). The default knows
+     * nothing.
+     * @param[in] x the world X coordinate
+     * @param[in] z the world Z coordinate
+     * @param[out] height the world Y coordinate of the top surface;
+     * unchanged if false is returned
+     * @return false if the point is off the ground or the ground cannot
+     * tell, e.g. because it is rotated
+     */
+    virtual bool getSurfaceHeight(double x, double z, double& height) const;
+
 protected:
     // Will take care of deleting this ourselves.
     btCollisionShape* pGroundShape;
+
+private:
+    /** The body kept across worlds; NULL until first acquired */
+    btRigidBody* m_pKeptBody;
+
+    /** True while m_pKeptBody is in a world */
+    bool m_keptBodyInUse;
+
+    pthread_mutex_t m_bodyMutex;
 };
 
 
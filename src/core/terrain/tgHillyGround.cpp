@@ -25,18 +25,80 @@
 
 //This Module
 #include "tgHillyGround.h"
+#include "tgSharedMesh.h"
 
 //Bullet Physics
 #include "BulletCollision/CollisionShapes/btBoxShape.h"
 #include "BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h"
 #include "BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h"
+#include "BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h"
 #include "BulletDynamics/Dynamics/btRigidBody.h"
 #include "LinearMath/btDefaultMotionState.h"
 #include "LinearMath/btTransform.h"
 
 // The C++ Standard Library
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+#include <pthread.h>
+
+namespace
+{
+    /** The parameters that determine the heights of the grid */
+    struct HeightKey
+    {
+        HeightKey(const tgHillyGround::Config& config) :
+            nx(config.m_nx),
+            ny(config.m_ny),
+            waveHeight(config.m_waveHeight),
+            offset(config.m_offset)
+        {
+        }
+
+        bool operator<(const HeightKey& other) const
+        {
+            if (nx != other.nx) return nx < other.nx;
+            if (ny != other.ny) return ny < other.ny;
+            if (waveHeight != other.waveHeight) return waveHeight < other.waveHeight;
+            return offset < other.offset;
+        }
+
+        std::size_t nx;
+        std::size_t ny;
+        double waveHeight;
+        double offset;
+    };
+
+    /**
+     * Heights in btHeightfieldTerrainShape order, kept for the life of the
+     * process since the shapes of live grounds point into them. Entries
+     * are never modified or erased once inserted.
+     */
+    std::map<HeightKey, std::vector<btScalar> > s_heights;
+
+    // Grounds may be built on several tgParallelSimulation threads at once
+    pthread_mutex_t s_heightsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+    // Older heightfields read PHY_FLOAT data as btScalar; later ones read
+    // float and take doubles as PHY_DOUBLE
+#if defined(BT_USE_DOUBLE_PRECISION) && BT_BULLET_VERSION >= 288
+    const PHY_ScalarType kHeightDataType = PHY_DOUBLE;
+#else
+    const PHY_ScalarType kHeightDataType = PHY_FLOAT;
+#endif
+
+    /** The height of grid node (i, j) above the ground's origin */
+    double nodeHeight(const tgHillyGround::Config& config,
+                      std::size_t i, std::size_t j)
+    {
+        return config.m_waveHeight * sin((double)i) * cos((double)j) +
+            config.m_offset;
+    }
+}
 
 tgHillyGround::Config::Config(btVector3 eulerAngles,
         double friction,
@@ -48,7 +110,9 @@ tgHillyGround::Config::Config(btVector3 eulerAngles,
         double margin,
         double triangleSize,
         double waveHeight,
-        double offset) :
+        double offset,
+        bool heightfield,
+        bool shareMemory) :
     m_eulerAngles(eulerAngles),
     m_friction(friction),
     m_restitution(restitution),
@@ -59,7 +123,9 @@ tgHillyGround::Config::Config(btVector3 eulerAngles,
     m_margin(margin),
     m_triangleSize(triangleSize),
     m_waveHeight(waveHeight),
-    m_offset(offset)
+    m_offset(offset),
+    m_heightfield(heightfield),
+    m_shareMemory(shareMemory)
 {
     assert((m_friction >= 0.0) && (m_friction <= 1.0));
     assert((m_restitution >= 0.0) && (m_restitution <= 1.0));
@@ -73,20 +139,37 @@ tgHillyGround::Config::Config(btVector3 eulerAngles,
 }
 
 tgHillyGround::tgHillyGround() :
-    m_config(Config())
+    m_config(Config()),
+    m_pMesh(NULL),
+    m_vertices(NULL),
+    m_pIndices(NULL),
+    m_pShared(NULL),
+    m_shapeOffset(0.0, 0.0, 0.0)
 {
     // @todo make constructor aux to avoid repeated code
     pGroundShape = hillyCollisionShape();
 }
 
 tgHillyGround::tgHillyGround(const tgHillyGround::Config& config) :
-    m_config(config)
+    m_config(config),
+    m_pMesh(NULL),
+    m_vertices(NULL),
+    m_pIndices(NULL),
+    m_pShared(NULL),
+    m_shapeOffset(0.0, 0.0, 0.0)
 {
     pGroundShape = hillyCollisionShape();
 }
 
 tgHillyGround::~tgHillyGround()
 {
+    if (m_pShared)
+    {
+        // The shape points into the shared mesh, so goes first
+        delete pGroundShape;
+        pGroundShape = NULL;
+        delete m_pShared;
+    }
     delete m_pMesh;
     delete[] m_pIndices;
     delete[] m_vertices;
@@ -106,6 +189,7 @@ btRigidBody* tgHillyGround::getGroundRigidBody() const
                          m_config.m_eulerAngles[1], // Pitch
                          m_config.m_eulerAngles[2]); // Roll
     groundTransform.setRotation(orientation);
+    groundTransform.setOrigin(groundTransform(m_shapeOffset));
 
     // Using motionstate is recommended
     // It provides interpolation capabilities, and only synchronizes 'active' objects
@@ -122,13 +206,73 @@ btRigidBody* tgHillyGround::getGroundRigidBody() const
     return pGroundBody;
 }  
 
+bool tgHillyGround::getSurfaceHeight(double x, double z, double& height) const
+{
+    if (!m_config.m_eulerAngles.isZero() || m_config.m_triangleSize <= 0.0 ||
+        m_config.m_nx < 2 || m_config.m_ny < 2)
+    {
+        return false;
+    }
+
+    // Grid coordinates, as in setVertices
+    const double u = (x - m_config.m_origin.x()) / m_config.m_triangleSize +
+        m_config.m_nx * 0.5;
+    const double v = (z - m_config.m_origin.z()) / m_config.m_triangleSize +
+        m_config.m_ny * 0.5;
+    if (u < 0.0 || v < 0.0 ||
+        u > m_config.m_nx - 1.0 || v > m_config.m_ny - 1.0)
+    {
+        return false;
+    }
+
+    // The cell, with the far edges belonging to the last one
+    const std::size_t i = std::min((std::size_t) u, m_config.m_nx - 2);
+    const std::size_t j = std::min((std::size_t) v, m_config.m_ny - 2);
+    const double fu = u - i;
+    const double fv = v - j;
+
+    const double h00 = nodeHeight(m_config, i, j);
+    const double h11 = nodeHeight(m_config, i + 1, j + 1);
+
+    // setIndices splits each cell along (i, j)-(i+1, j+1)
+    double h;
+    if (fu >= fv)
+    {
+        const double h10 = nodeHeight(m_config, i + 1, j);
+        h = h00 + fu * (h10 - h00) + fv * (h11 - h10);
+    }
+    else
+    {
+        const double h01 = nodeHeight(m_config, i, j + 1);
+        h = h00 + fv * (h01 - h00) + fu * (h11 - h01);
+    }
+    height = m_config.m_origin.y() + h;
+    return true;
+}
+
 btCollisionShape* tgHillyGround::hillyCollisionShape() {
     btCollisionShape * pShape = 0;
     // The number of vertices in the mesh
     // Hill Paramenters: Subject to Change
     const std::size_t vertexCount = m_config.m_nx * m_config.m_ny;
 
-    if (vertexCount > 0) {
+    if (m_config.m_heightfield) {
+        pShape = createHeightfieldShape();
+        pShape->setMargin(m_config.m_margin);
+    }
+    else if (vertexCount > 0 && m_config.m_shareMemory) {
+        // Everything setVertices and setIndices depend on
+        std::ostringstream key;
+        key.precision(17);
+        key << "hilly\n" << m_config.m_nx << " " << m_config.m_ny << " "
+            << m_config.m_triangleSize << " " << m_config.m_waveHeight << " "
+            << m_config.m_offset;
+        MeshSource source(*this);
+        m_pShared = new tgSharedMesh(key.str(), source, btVector3(1.0, 1.0, 1.0));
+        pShape = m_pShared->createShape();
+        pShape->setMargin(m_config.m_margin);
+    }
+    else if (vertexCount > 0) {
         // The number of triangles in the mesh
         const std::size_t triangleCount = 2 * (m_config.m_nx - 1) * (m_config.m_ny - 1);
 
@@ -159,6 +303,38 @@ btCollisionShape* tgHillyGround::hillyCollisionShape() {
     return pShape; 
 }
 
+class tgHillyGround::MeshSource : public tgSharedMesh::Source
+{
+    public:
+        explicit MeshSource(tgHillyGround& ground) :
+            m_ground(ground)
+        {
+        }
+
+        virtual void getTriangles(std::vector<btScalar>& vertices,
+                                  std::vector<int>& indices)
+        {
+            const Config& config = m_ground.m_config;
+            std::vector<btVector3> grid(config.m_nx * config.m_ny);
+            m_ground.setVertices(&grid[0]);
+            vertices.resize(3 * grid.size());
+            for (std::size_t i = 0; i < grid.size(); i++)
+            {
+                vertices[3 * i] = grid[i].x();
+                vertices[3 * i + 1] = grid[i].y();
+                vertices[3 * i + 2] = grid[i].z();
+            }
+            indices.resize(6 * (config.m_nx - 1) * (config.m_ny - 1));
+            if (!indices.empty())
+            {
+                m_ground.setIndices(&indices[0]);
+            }
+        }
+
+    private:
+        tgHillyGround& m_ground;
+};
+
 btTriangleIndexVertexArray *tgHillyGround::createMesh(std::size_t triangleCount, int indices[], std::size_t vertexCount, btVector3 vertices[]) {
     const int vertexStride = sizeof(btVector3);
     const int indexStride = 3 * sizeof(int);
@@ -180,14 +356,55 @@ btCollisionShape *tgHillyGround::createShape(btTriangleIndexVertexArray *pMesh)
     return pShape;
 }
 
+btCollisionShape *tgHillyGround::createHeightfieldShape() {
+    const std::size_t nx = m_config.m_nx;
+    const std::size_t ny = m_config.m_ny;
+
+    pthread_mutex_lock(&s_heightsMutex);
+    std::vector<btScalar>& heights = s_heights[HeightKey(m_config)];
+    if (heights.empty()) {
+        // Same heights as setVertices; that layout (i + j * nx) is also
+        // the heightfield's, with x along the width and z along the length
+        heights.resize(nx * ny);
+        for (std::size_t i = 0; i < nx; i++)
+        {
+            for (std::size_t j = 0; j < ny; j++)
+            {
+                heights[i + (j * nx)] = nodeHeight(m_config, i, j);
+            }
+        }
+    }
+    pthread_mutex_unlock(&s_heightsMutex);
+
+    const btScalar minHeight = *std::min_element(heights.begin(), heights.end());
+    const btScalar maxHeight = *std::max_element(heights.begin(), heights.end());
+
+    // Flipping the quad edges splits each cell along (i, j)-(i+1, j+1),
+    // as setIndices does
+    const int upAxis = 1;
+    const bool flipQuadEdges = true;
+    btHeightfieldTerrainShape* const pShape =
+        new btHeightfieldTerrainShape(nx, ny, &heights[0], 1.0,
+                                      minHeight, maxHeight, upAxis,
+                                      kHeightDataType, flipQuadEdges);
+    pShape->setLocalScaling(btVector3(m_config.m_triangleSize, 1.0,
+                                      m_config.m_triangleSize));
+
+    // The mesh's grid runs from -n/2 to n/2 - 1 cells about the origin, but
+    // the heightfield's is centred on it, on the middle of the heights too
+    m_shapeOffset.setValue(-0.5 * m_config.m_triangleSize,
+                           0.5 * (minHeight + maxHeight),
+                           -0.5 * m_config.m_triangleSize);
+    return pShape;
+}
+
 void tgHillyGround::setVertices(btVector3 vertices[]) {
     for (std::size_t i = 0; i < m_config.m_nx; i++)
     {
         for (std::size_t j = 0; j < m_config.m_ny; j++)
         {
             const btScalar x = (i - (m_config.m_nx * 0.5)) * m_config.m_triangleSize;
-            const btScalar y = (m_config.m_waveHeight * sin((double)i) * cos((double)j) +
-                    m_config.m_offset);
+            const btScalar y = nodeHeight(m_config, i, j);
             const btScalar z = (j - (m_config.m_ny * 0.5)) * m_config.m_triangleSize;
             vertices[i + (j * m_config.m_nx)].setValue(x, y, z);
         }
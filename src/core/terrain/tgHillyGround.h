@@ -37,6 +37,7 @@
 // Forward declarations
 class btRigidBody;
 class btTriangleIndexVertexArray;
+class tgSharedMesh;
 
 /**
  * A "hilly" ground, with randomized hills and valleys
@@ -58,7 +59,9 @@ class tgHillyGround : public tgBulletGround
                        double margin = 0.05,
                        double triangleSize = 5.0,
                        double waveHeight = 5.0,
-                       double offset = 0.5);
+                       double offset = 0.5,
+                       bool heightfield = false,
+                       bool shareMemory = false);
 
                 /** Euler angles are specified as yaw pitch and roll */
                 btVector3 m_eulerAngles;
@@ -92,6 +95,21 @@ class tgHillyGround : public tgBulletGround
 
                 /** Translation factor for the Y axis */
                 double m_offset;
+
+                /**
+                 * Use a btHeightfieldTerrainShape over the same grid
+                 * instead of a btBvhTriangleMeshShape. The surface is the
+                 * same, but there is no BVH to build and the narrowphase
+                 * only visits the grid cells under a query's AABB.
+                 */
+                bool m_heightfield;
+
+                /**
+                 * Keep the mesh and its BVH in a tgSharedMesh, built by
+                 * the first process on the node to make this ground and
+                 * mapped by the rest. Not used with m_heightfield.
+                 */
+                bool m_shareMemory;
         };
 
         /**
@@ -106,7 +124,7 @@ class tgHillyGround : public tgBulletGround
          */
         tgHillyGround(const tgHillyGround::Config& config);
 
-        /** Clean up the implementation. Deletes m_pMesh */
+        /** Clean up the implementation. Deletes m_pMesh or m_pShared */
         virtual ~tgHillyGround();
 
         /**
@@ -115,12 +133,22 @@ class tgHillyGround : public tgBulletGround
          */
         virtual btRigidBody* getGroundRigidBody() const;
 
+        /**
+         * Interpolated over the grid's triangles, the same in mesh and
+         * heightfield mode, if the ground is not rotated. See
+         * tgBulletGround::getSurfaceHeight.
+         */
+        virtual bool getSurfaceHeight(double x, double z, double& height) const;
+
         /**
          * Returns the collision shape that forms a hilly ground
          */
         btCollisionShape* hillyCollisionShape();
 
     private:  
+        /** Gives a tgSharedMesh the grid when it has to be built */
+        class MeshSource;
+
         /** Store the configuration data for use later */
         Config m_config;
 
@@ -135,6 +163,14 @@ class tgHillyGround : public tgBulletGround
          */
         btCollisionShape *createShape(btTriangleIndexVertexArray * pMesh);
 
+        /**
+         * Returns a btHeightfieldTerrainShape over the heights of
+         * setVertices, and sets m_shapeOffset. The heights are shared by
+         * every tgHillyGround with the same grid, so grounds recreated
+         * on reset do not regenerate them.
+         */
+        btCollisionShape *createHeightfieldShape();
+
         /**
          * @param[out] A flattened array of vertices in the mesh
          */
@@ -150,6 +186,16 @@ class tgHillyGround : public tgBulletGround
         btVector3 * m_vertices;
         int * m_pIndices;
 
+        /** With m_shareMemory, the mesh instead of the above */
+        tgSharedMesh* m_pShared;
+
+        /**
+         * Where the shape's local origin lies in the mesh's coordinates.
+         * Bullet centres a heightfield on its AABB, so this is non-zero
+         * in heightfield mode.
+         */
+        btVector3 m_shapeOffset;
+
 };
 
 #endif  // TG_HILLY_GROUND_H
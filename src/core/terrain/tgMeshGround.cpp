@@ -0,0 +1,547 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+/**
+ * @file tgMeshGround.cpp
+ * @brief Contains the implementation of class tgMeshGround
+ * $Id$
+ */
+
+//This Module
+#include "tgMeshGround.h"
+#include "tgSharedMesh.h"
+
+//Bullet Physics
+#include "BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h"
+#include "BulletCollision/CollisionShapes/btOptimizedBvh.h"
+#include "BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btAlignedAllocator.h"
+#include "LinearMath/btDefaultMotionState.h"
+#include "LinearMath/btTransform.h"
+
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /** A binary STL file's header and triangle records */
+    const std::size_t kStlHeaderSize = 84;
+    const std::size_t kStlTriangleSize = 50;
+    /** Where a record's first vertex starts, after the normal */
+    const std::size_t kStlVertexOffset = 12;
+
+    /**
+     * A binary file's vertices are 12 bytes apart within a record and the
+     * records are 50 bytes apart, so every vertex starts on a multiple of
+     * 2 bytes from the first. Indexing the file in 2-byte steps lets the
+     * mesh read them in place.
+     */
+    const int kStlVertexStride = 2;
+    const int kStlVerticesPerRecord = kStlTriangleSize / kStlVertexStride;
+    const int kStlVerticesPerVertex = 12 / kStlVertexStride;
+
+    /** Written at the start of a BVH cache; the BVH follows */
+    struct BvhCacheHeader
+    {
+        char magic[8];
+        int bulletVersion;
+        int scalarSize;
+        long long stlSize;
+        long long stlTime;
+        long long triangleCount;
+        btScalar scale[3];
+        btScalar aabbMin[3];
+        btScalar aabbMax[3];
+        long long bvhSize;
+    };
+
+    const char kBvhCacheMagic[8] = { 'N', 'T', 'R', 'T', 'B', 'V', 'H', '1' };
+
+    // Keeps the BVH that follows the header 16-byte aligned, as Bullet
+    // needs it to be
+    const std::size_t kBvhOffset = (sizeof(BvhCacheHeader) + 15) & ~std::size_t(15);
+
+    /**
+     * Map a whole file.
+     * @param[out] size the file's size
+     * @param[in] writable map copy-on-write pages that may be changed,
+     * which are never written back
+     * @return the mapping, or NULL if the file cannot be mapped
+     */
+    void* mapFile(const std::string& path, std::size_t& size, bool writable)
+    {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return NULL;
+        }
+        struct stat info;
+        void* pMap = NULL;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            size = info.st_size;
+            pMap = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                        MAP_PRIVATE, fd, 0);
+            if (pMap == MAP_FAILED)
+            {
+                pMap = NULL;
+            }
+        }
+        close(fd);
+        return pMap;
+    }
+
+    /** Append the coordinates after each "vertex" of ASCII STL */
+    template <typename T>
+    void parseAsciiVertices(const char* p, const char* const pEnd,
+                            std::vector<T>& vertices)
+    {
+        static const char kVertex[] = "vertex";
+        const std::size_t vertexLength = sizeof(kVertex) - 1;
+
+        // strtod stops at the end of a number, and every number is followed
+        // by white space before the end of the file
+        while (p + vertexLength < pEnd)
+        {
+            p = static_cast<const char*>(memchr(p, 'v', pEnd - p));
+            if (p == NULL || p + vertexLength >= pEnd)
+            {
+                break;
+            }
+            if (memcmp(p, kVertex, vertexLength) != 0)
+            {
+                p++;
+                continue;
+            }
+            p += vertexLength;
+            for (int i = 0; i < 3; i++)
+            {
+                char* pNext;
+                vertices.push_back(static_cast<T>(strtod(p, &pNext)));
+                p = pNext;
+            }
+        }
+    }
+
+    /** Reads an STL file's triangles when its tgSharedMesh is built */
+    class StlSource : public tgSharedMesh::Source
+    {
+        public:
+            explicit StlSource(const std::string& stlPath) :
+                m_stlPath(stlPath)
+            {
+            }
+
+            virtual void getTriangles(std::vector<btScalar>& vertices,
+                                      std::vector<int>& indices)
+            {
+                std::size_t size = 0;
+                void* const pMap = mapFile(m_stlPath, size, false);
+                if (pMap == NULL)
+                {
+                    return;
+                }
+                const char* const pData = static_cast<const char*>(pMap);
+                std::size_t count = 0;
+                if (size >= kStlHeaderSize)
+                {
+                    unsigned int declared;
+                    memcpy(&declared, pData + 80, sizeof(declared));
+                    count = declared;
+                }
+                if (size >= kStlHeaderSize &&
+                    size == kStlHeaderSize + count * kStlTriangleSize)
+                {
+                    vertices.resize(9 * count);
+                    for (std::size_t i = 0; i < count; i++)
+                    {
+                        float corners[9];
+                        memcpy(corners, pData + kStlHeaderSize +
+                               i * kStlTriangleSize + kStlVertexOffset,
+                               sizeof(corners));
+                        std::copy(corners, corners + 9, &vertices[9 * i]);
+                    }
+                }
+                else
+                {
+                    parseAsciiVertices(pData, pData + size, vertices);
+                    vertices.resize(vertices.size() / 9 * 9);
+                }
+                munmap(pMap, size);
+
+                // Corners are not shared between triangles, as in the file
+                indices.resize(vertices.size() / 3);
+                for (std::size_t i = 0; i < indices.size(); i++)
+                {
+                    indices[i] = i;
+                }
+            }
+
+        private:
+            const std::string m_stlPath;
+    };
+}
+
+tgMeshGround::Config::Config(btVector3 eulerAngles,
+        double friction,
+        double restitution,
+        btVector3 origin,
+        double margin,
+        btVector3 scale,
+        bool cacheBvh,
+        bool shareMemory) :
+    m_eulerAngles(eulerAngles),
+    m_friction(friction),
+    m_restitution(restitution),
+    m_origin(origin),
+    m_margin(margin),
+    m_scale(scale),
+    m_cacheBvh(cacheBvh),
+    m_shareMemory(shareMemory)
+{
+    assert((m_friction >= 0.0) && (m_friction <= 1.0));
+    assert((m_restitution >= 0.0) && (m_restitution <= 1.0));
+    assert(m_margin >= 0.0);
+}
+
+tgMeshGround::tgMeshGround(const std::string& stlPath,
+                           const tgMeshGround::Config& config) :
+    m_config(config),
+    m_triangleCount(0),
+    m_pStlMap(NULL),
+    m_stlMapSize(0),
+    m_stlSize(0),
+    m_stlTime(0),
+    m_pMesh(NULL),
+    m_pBvhMap(NULL),
+    m_bvhMapSize(0),
+    m_pShared(NULL),
+    m_bvhFromCache(false)
+{
+    if (m_config.m_shareMemory)
+    {
+        createSharedShape(stlPath);
+    }
+    else
+    {
+        loadStl(stlPath);
+        createShape(stlPath);
+    }
+}
+
+tgMeshGround::~tgMeshGround()
+{
+    // The shape may point into the mapped BVH, so goes first
+    delete pGroundShape;
+    pGroundShape = NULL;
+    delete m_pShared;
+    delete m_pMesh;
+    if (m_pBvhMap)
+    {
+        munmap(m_pBvhMap, m_bvhMapSize);
+    }
+    if (m_pStlMap)
+    {
+        munmap(m_pStlMap, m_stlMapSize);
+    }
+}
+
+btRigidBody* tgMeshGround::getGroundRigidBody() const
+{
+    const btScalar mass = 0.0;
+
+    btTransform groundTransform;
+    groundTransform.setIdentity();
+    groundTransform.setOrigin(m_config.m_origin);
+
+    btQuaternion orientation;
+    orientation.setEuler(m_config.m_eulerAngles[0], // Yaw
+                         m_config.m_eulerAngles[1], // Pitch
+                         m_config.m_eulerAngles[2]); // Roll
+    groundTransform.setRotation(orientation);
+
+    // Using motionstate is recommended
+    // It provides interpolation capabilities, and only synchronizes 'active' objects
+    btDefaultMotionState* const pMotionState =
+        new btDefaultMotionState(groundTransform);
+
+    const btVector3 localInertia(0, 0, 0);
+
+    btRigidBody::btRigidBodyConstructionInfo const rbInfo(mass, pMotionState, pGroundShape, localInertia);
+
+    btRigidBody* const pGroundBody = new btRigidBody(rbInfo);
+    pGroundBody->setFriction(m_config.m_friction);
+    pGroundBody->setRestitution(m_config.m_restitution);
+
+    return pGroundBody;
+}
+
+void tgMeshGround::loadStl(const std::string& stlPath)
+{
+    struct stat info;
+    if (stat(stlPath.c_str(), &info) != 0)
+    {
+        throw std::runtime_error("Cannot read STL file " + stlPath);
+    }
+    m_stlSize = info.st_size;
+    m_stlTime = info.st_mtime;
+
+    m_pStlMap = mapFile(stlPath, m_stlMapSize, false);
+    if (m_pStlMap == NULL)
+    {
+        throw std::runtime_error("Cannot map STL file " + stlPath);
+    }
+    const char* const pData = static_cast<const char*>(m_pStlMap);
+
+    btIndexedMesh indexedMesh;
+    indexedMesh.m_vertexType = PHY_FLOAT;
+    indexedMesh.m_triangleIndexStride = 3 * sizeof(int);
+
+    // A binary file is exactly as long as its triangle count says. ASCII
+    // files start with "solid", but so do some binary ones.
+    std::size_t count = 0;
+    if (m_stlMapSize >= kStlHeaderSize)
+    {
+        // STL is little-endian, as are the hosts we run on
+        unsigned int declared;
+        memcpy(&declared, pData + 80, sizeof(declared));
+        count = declared;
+    }
+    if (m_stlMapSize >= kStlHeaderSize &&
+        m_stlMapSize == kStlHeaderSize + count * kStlTriangleSize)
+    {
+        m_triangleCount = count;
+        m_indices.resize(3 * count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const int first = i * kStlVerticesPerRecord;
+            m_indices[3 * i] = first;
+            m_indices[3 * i + 1] = first + kStlVerticesPerVertex;
+            m_indices[3 * i + 2] = first + 2 * kStlVerticesPerVertex;
+        }
+        indexedMesh.m_vertexBase = reinterpret_cast<const unsigned char*>(
+            pData + kStlHeaderSize + kStlVertexOffset);
+        indexedMesh.m_vertexStride = kStlVertexStride;
+        indexedMesh.m_numVertices =
+            count == 0 ? 0 : m_indices[3 * count - 1] + 1;
+    }
+    else
+    {
+        parseAsciiStl();
+        // Nothing more is needed from the file
+        munmap(m_pStlMap, m_stlMapSize);
+        m_pStlMap = NULL;
+
+        indexedMesh.m_vertexBase =
+            reinterpret_cast<const unsigned char*>(m_vertices.empty() ? NULL : &m_vertices[0]);
+        indexedMesh.m_vertexStride = 3 * sizeof(float);
+        indexedMesh.m_numVertices = m_vertices.size() / 3;
+    }
+
+    if (m_triangleCount == 0)
+    {
+        if (m_pStlMap)
+        {
+            munmap(m_pStlMap, m_stlMapSize);
+        }
+        throw std::runtime_error("No triangles in STL file " + stlPath);
+    }
+    indexedMesh.m_numTriangles = m_triangleCount;
+    indexedMesh.m_triangleIndexBase =
+        reinterpret_cast<const unsigned char*>(&m_indices[0]);
+
+    m_pMesh = new btTriangleIndexVertexArray();
+    m_pMesh->addIndexedMesh(indexedMesh, PHY_INTEGER);
+    // Scaled before the BVH is built, so it is built and cached scaled
+    m_pMesh->setScaling(m_config.m_scale);
+}
+
+void tgMeshGround::parseAsciiStl()
+{
+    const char* const p = static_cast<const char*>(m_pStlMap);
+    parseAsciiVertices(p, p + m_stlMapSize, m_vertices);
+
+    m_triangleCount = m_vertices.size() / 9;
+    m_vertices.resize(9 * m_triangleCount);
+    m_indices.resize(3 * m_triangleCount);
+    for (std::size_t i = 0; i < m_indices.size(); i++)
+    {
+        m_indices[i] = i;
+    }
+}
+
+void tgMeshGround::createSharedShape(const std::string& stlPath)
+{
+    struct stat info;
+    if (stat(stlPath.c_str(), &info) != 0)
+    {
+        throw std::runtime_error("Cannot read STL file " + stlPath);
+    }
+    m_stlSize = info.st_size;
+    m_stlTime = info.st_mtime;
+
+    // Everything the triangles and BVH depend on, so that processes share
+    // a segment only if they would have built the same mesh
+    char* const pRealPath = realpath(stlPath.c_str(), NULL);
+    std::ostringstream key;
+    key.precision(17);
+    key << "stl\n" << (pRealPath != NULL ? pRealPath : stlPath.c_str())
+        << "\n" << info.st_dev << " " << info.st_ino << " " << m_stlSize
+        << " " << info.st_mtim.tv_sec << " " << info.st_mtim.tv_nsec
+        << "\n" << m_config.m_scale.x() << " " << m_config.m_scale.y()
+        << " " << m_config.m_scale.z();
+    free(pRealPath);
+
+    StlSource source(stlPath);
+    try
+    {
+        m_pShared = new tgSharedMesh(key.str(), source, m_config.m_scale);
+    }
+    catch (const std::runtime_error& e)
+    {
+        throw std::runtime_error(std::string(e.what()) + " of STL file " + stlPath);
+    }
+    m_triangleCount = m_pShared->getTriangleCount();
+    btBvhTriangleMeshShape* const pShape = m_pShared->createShape();
+    pShape->setMargin(m_config.m_margin);
+    pGroundShape = pShape;
+    m_bvhFromCache = !m_pShared->isBuilder();
+}
+
+void tgMeshGround::createShape(const std::string& stlPath)
+{
+    const bool useQuantizedAabbCompression = true;
+    const btVector3& scale = m_config.m_scale;
+    const std::string cachePath = stlPath + ".bvh";
+
+    if (m_config.m_cacheBvh)
+    {
+        m_pBvhMap = mapFile(cachePath, m_bvhMapSize, true);
+    }
+    if (m_pBvhMap)
+    {
+        const BvhCacheHeader& header = *static_cast<const BvhCacheHeader*>(m_pBvhMap);
+        const bool valid = m_bvhMapSize > kBvhOffset &&
+            memcmp(header.magic, kBvhCacheMagic, sizeof(kBvhCacheMagic)) == 0 &&
+            header.bulletVersion == BT_BULLET_VERSION &&
+            header.scalarSize == sizeof(btScalar) &&
+            header.stlSize == m_stlSize &&
+            header.stlTime == m_stlTime &&
+            header.triangleCount == (long long) m_triangleCount &&
+            header.scale[0] == scale.x() &&
+            header.scale[1] == scale.y() &&
+            header.scale[2] == scale.z() &&
+            header.bvhSize == (long long) (m_bvhMapSize - kBvhOffset);
+        btOptimizedBvh* const pBvh = valid ?
+            static_cast<btOptimizedBvh*>(btOptimizedBvh::deSerializeInPlace(
+                static_cast<char*>(m_pBvhMap) + kBvhOffset,
+                m_bvhMapSize - kBvhOffset, false)) :
+            NULL;
+        if (pBvh)
+        {
+            const btVector3 aabbMin(header.aabbMin[0], header.aabbMin[1], header.aabbMin[2]);
+            const btVector3 aabbMax(header.aabbMax[0], header.aabbMax[1], header.aabbMax[2]);
+            const bool buildBvh = false;
+            btBvhTriangleMeshShape* const pShape =
+                new btBvhTriangleMeshShape(m_pMesh, useQuantizedAabbCompression,
+                                           aabbMin, aabbMax, buildBvh);
+            pShape->setOptimizedBvh(pBvh, scale);
+            pShape->setMargin(m_config.m_margin);
+            pGroundShape = pShape;
+            m_bvhFromCache = true;
+            return;
+        }
+        munmap(m_pBvhMap, m_bvhMapSize);
+        m_pBvhMap = NULL;
+    }
+
+    btBvhTriangleMeshShape* const pShape =
+        new btBvhTriangleMeshShape(m_pMesh, useQuantizedAabbCompression);
+    pShape->setMargin(m_config.m_margin);
+    pGroundShape = pShape;
+
+    if (!m_config.m_cacheBvh)
+    {
+        return;
+    }
+
+    // Write the cache to a temporary file first, so a ground loading it
+    // at the same time never sees it half written. A cache that cannot
+    // be written only costs the next run a rebuild.
+    btOptimizedBvh* const pBvh = pShape->getOptimizedBvh();
+    const unsigned int bvhSize = pBvh->calculateSerializeBufferSize();
+    void* const pBuffer = btAlignedAlloc(bvhSize, 16);
+    if (!pBvh->serializeInPlace(pBuffer, bvhSize, false))
+    {
+        btAlignedFree(pBuffer);
+        return;
+    }
+
+    BvhCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kBvhCacheMagic, sizeof(kBvhCacheMagic));
+    header.bulletVersion = BT_BULLET_VERSION;
+    header.scalarSize = sizeof(btScalar);
+    header.stlSize = m_stlSize;
+    header.stlTime = m_stlTime;
+    header.triangleCount = m_triangleCount;
+    btVector3 aabbMin;
+    btVector3 aabbMax;
+    m_pMesh->calculateAabbBruteForce(aabbMin, aabbMax);
+    for (int i = 0; i < 3; i++)
+    {
+        header.scale[i] = scale[i];
+        header.aabbMin[i] = aabbMin[i];
+        header.aabbMax[i] = aabbMax[i];
+    }
+    header.bvhSize = bvhSize;
+
+    char tempPath[32];
+    snprintf(tempPath, sizeof(tempPath), ".%ld.tmp", (long) getpid());
+    const std::string writePath = cachePath + tempPath;
+    FILE* const pFile = fopen(writePath.c_str(), "wb");
+    if (pFile)
+    {
+        const char padding[16] = { 0 };
+        const std::size_t paddingSize = kBvhOffset - sizeof(header);
+        const bool written =
+            fwrite(&header, sizeof(header), 1, pFile) == 1 &&
+            (paddingSize == 0 || fwrite(padding, paddingSize, 1, pFile) == 1) &&
+            fwrite(pBuffer, bvhSize, 1, pFile) == 1;
+        if (fclose(pFile) == 0 && written)
+        {
+            rename(writePath.c_str(), cachePath.c_str());
+        }
+        else
+        {
+            remove(writePath.c_str());
+        }
+    }
+    btAlignedFree(pBuffer);
+}
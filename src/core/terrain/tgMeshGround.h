@@ -0,0 +1,188 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+#ifndef CORE_TERRAIN_TG_MESH_GROUND_H
+#define CORE_TERRAIN_TG_MESH_GROUND_H
+
+/**
+ * @file tgMeshGround.h
+ * @brief Contains the definition of class tgMeshGround.
+ * $Id$
+ */
+
+#include "tgBulletGround.h"
+
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btVector3.h"
+
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class btTriangleIndexVertexArray;
+class tgSharedMesh;
+
+/**
+ * A ground made from the triangles of an STL file, such as a scanned
+ * lunar surface.
+ *
+ * Binary STL is memory-mapped and its vertices are read where they lie
+ * in the file, without being copied; only the triangle indices are
+ * built. ASCII STL is parsed into memory instead.
+ *
+ * Building the BVH of a large mesh is most of the cost of loading it, so
+ * the built BVH is written next to the STL file and memory-mapped back
+ * on later runs. The cache is rebuilt if the STL file's size or time
+ * stamp, or the Bullet build, no longer match it.
+ *
+ * With Config::m_shareMemory, the triangles and BVH are kept in a
+ * tgSharedMesh instead, one copy for every process on the node.
+ */
+class tgMeshGround : public tgBulletGround
+{
+    public:
+
+        struct Config
+        {
+            public:
+                Config(btVector3 eulerAngles = btVector3(0.0, 0.0, 0.0),
+                       double friction = 0.5,
+                       double restitution = 0.0,
+                       btVector3 origin = btVector3(0.0, 0.0, 0.0),
+                       double margin = 0.05,
+                       btVector3 scale = btVector3(1.0, 1.0, 1.0),
+                       bool cacheBvh = true,
+                       bool shareMemory = false);
+
+                /** Euler angles are specified as yaw pitch and roll */
+                btVector3 m_eulerAngles;
+
+                /** Friction value of the ground, must be between 0 to 1 */
+                btScalar  m_friction;
+
+                /** Restitution coefficient of the ground, must be between 0 to 1 */
+                btScalar  m_restitution;
+
+                /** Origin position of the ground */
+                btVector3 m_origin;
+
+                /** See Bullet documentation on Collision Margin */
+                double m_margin;
+
+                /** Scale of the file's coordinates, e.g. to convert units */
+                btVector3 m_scale;
+
+                /**
+                 * Read the BVH from, and write it to, the STL file's path
+                 * with ".bvh" appended
+                 */
+                bool m_cacheBvh;
+
+                /**
+                 * Keep the mesh and BVH in shared memory, built by the
+                 * first process to load this file and mapped by the rest.
+                 * The BVH is not cached in a file then.
+                 */
+                bool m_shareMemory;
+        };
+
+        /**
+         * Load the mesh of an STL file.
+         * @param[in] stlPath a binary or ASCII STL file
+         * @param[in] config the pose and surface of the ground
+         * @throw std::runtime_error if the file cannot be read or holds
+         * no triangles
+         */
+        tgMeshGround(const std::string& stlPath,
+                     const tgMeshGround::Config& config = Config());
+
+        /** Delete the shape and mesh, and unmap the files or shared mesh */
+        virtual ~tgMeshGround();
+
+        /**
+         * Setup and return a return a rigid body based on the collision
+         * object
+         */
+        virtual btRigidBody* getGroundRigidBody() const;
+
+        /** The number of triangles in the mesh */
+        std::size_t getTriangleCount() const
+        {
+            return m_triangleCount;
+        }
+
+        /**
+         * Whether the BVH was read from the cache, or mapped from another
+         * ground's shared mesh, rather than built
+         */
+        bool isBvhFromCache() const
+        {
+            return m_bvhFromCache;
+        }
+
+    private:
+
+        /** Map the STL file and index a binary one where it lies */
+        void loadStl(const std::string& stlPath);
+
+        /** Parse an ASCII STL file that loadStl has mapped */
+        void parseAsciiStl();
+
+        /** Map, or build, the file's tgSharedMesh and its shape */
+        void createSharedShape(const std::string& stlPath);
+
+        /**
+         * Create pGroundShape over m_pMesh, with the cached BVH if it is
+         * still valid, and otherwise with a new BVH that is then cached
+         */
+        void createShape(const std::string& stlPath);
+
+        /** Store the configuration data for use later */
+        const Config m_config;
+
+        std::size_t m_triangleCount;
+
+        /** The mapped STL file */
+        void* m_pStlMap;
+        std::size_t m_stlMapSize;
+
+        /** The STL file's size and modification time, to check the cache */
+        long long m_stlSize;
+        long long m_stlTime;
+
+        /** Vertices of an ASCII file; a binary one's stay in the map */
+        std::vector<float> m_vertices;
+
+        std::vector<int> m_indices;
+
+        btTriangleIndexVertexArray* m_pMesh;
+
+        /** The mapped BVH cache, which the shape's BVH lives in; or NULL */
+        void* m_pBvhMap;
+        std::size_t m_bvhMapSize;
+
+        /** With m_shareMemory, the mesh and BVH instead of the above */
+        tgSharedMesh* m_pShared;
+
+        bool m_bvhFromCache;
+};
+
+#endif  // CORE_TERRAIN_TG_MESH_GROUND_H
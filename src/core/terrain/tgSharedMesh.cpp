@@ -0,0 +1,370 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSharedMesh.cpp
+ * @brief Contains the implementation of class tgSharedMesh
+ * $Id$
+ */
+
+//This Module
+#include "tgSharedMesh.h"
+
+//Bullet Physics
+#include "BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h"
+#include "BulletCollision/CollisionShapes/btOptimizedBvh.h"
+#include "BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h"
+
+// The C++ Standard Library
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /** At the start of a segment; the key, vertices, indices and BVH follow */
+    struct SegmentHeader
+    {
+        char magic[8];
+        int bulletVersion;
+        int scalarSize;
+        long long keySize;
+        long long triangleCount;
+        long long vertexCount;
+        long long vertexOffset;
+        long long indexOffset;
+        long long bvhOffset;
+        long long bvhSize;
+        long long totalSize;
+        btScalar aabbMin[3];
+        btScalar aabbMax[3];
+        /** Set last, so a builder that died part way is noticed */
+        volatile int complete;
+    };
+
+    const char kSegmentMagic[8] = { 'N', 'T', 'R', 'T', 'M', 'S', 'H', '1' };
+
+    /** Bullet needs the BVH 16-byte aligned; the arrays may as well be */
+    std::size_t align16(std::size_t offset)
+    {
+        return (offset + 15) & ~std::size_t(15);
+    }
+
+    // The segment's record lock belongs to the process, so it does not
+    // keep threads of one process from building the same segment at once
+    pthread_mutex_t s_openMutex = PTHREAD_MUTEX_INITIALIZER;
+
+    class OpenLock
+    {
+        public:
+            OpenLock()
+            {
+                pthread_mutex_lock(&s_openMutex);
+            }
+            ~OpenLock()
+            {
+                pthread_mutex_unlock(&s_openMutex);
+            }
+    };
+
+    /** Excludes other processes from checking or building a segment */
+    class SegmentLock
+    {
+        public:
+            explicit SegmentLock(int fd) :
+                m_fd(fd)
+            {
+                setLock(F_WRLCK);
+            }
+            ~SegmentLock()
+            {
+                setLock(F_UNLCK);
+            }
+        private:
+            void setLock(short type)
+            {
+                struct flock lock;
+                memset(&lock, 0, sizeof(lock));
+                lock.l_type = type;
+                lock.l_whence = SEEK_SET;
+                while (fcntl(m_fd, F_SETLKW, &lock) != 0 && errno == EINTR)
+                {
+                }
+            }
+            const int m_fd;
+    };
+
+    /** FNV-1a */
+    unsigned long long hashKey(const std::string& key)
+    {
+        unsigned long long hash = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < key.size(); i++)
+        {
+            hash ^= static_cast<unsigned char>(key[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+tgSharedMesh::tgSharedMesh(const std::string& key, Source& source,
+                           const btVector3& scaling) :
+    m_scaling(scaling),
+    m_fd(-1),
+    m_pMap(NULL),
+    m_mapSize(0),
+    m_triangleCount(0),
+    m_pMesh(NULL),
+    m_pBvh(NULL),
+    m_aabbMin(0.0, 0.0, 0.0),
+    m_aabbMax(0.0, 0.0, 0.0),
+    m_builder(false)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/ntrt-mesh-%016llx", hashKey(key));
+    m_name = name;
+
+    OpenLock openLock;
+    while (true)
+    {
+        m_fd = shm_open(m_name.c_str(), O_RDWR | O_CREAT, 0600);
+        if (m_fd < 0)
+        {
+            throw std::runtime_error("Cannot open shared mesh " + m_name);
+        }
+        // Held while mapped, so the last process out can tell it is last
+        flock(m_fd, LOCK_SH);
+        struct stat info;
+        if (fstat(m_fd, &info) == 0 && info.st_nlink > 0)
+        {
+            break;
+        }
+        // Removed by its last user after we opened it; make a new one
+        ::close(m_fd);
+    }
+
+    try
+    {
+        {
+            SegmentLock segmentLock(m_fd);
+            if (!isBuilt(key))
+            {
+                build(key, source);
+            }
+        }
+        map();
+    }
+    catch (...)
+    {
+        release();
+        throw;
+    }
+}
+
+tgSharedMesh::~tgSharedMesh()
+{
+    release();
+}
+
+btBvhTriangleMeshShape* tgSharedMesh::createShape() const
+{
+    const bool useQuantizedAabbCompression = true;
+    const bool buildBvh = false;
+    btBvhTriangleMeshShape* const pShape =
+        new btBvhTriangleMeshShape(m_pMesh, useQuantizedAabbCompression,
+                                   m_aabbMin, m_aabbMax, buildBvh);
+    pShape->setOptimizedBvh(m_pBvh, m_scaling);
+    return pShape;
+}
+
+bool tgSharedMesh::isBuilt(const std::string& key) const
+{
+    struct stat info;
+    SegmentHeader header;
+    if (fstat(m_fd, &info) != 0 ||
+        (std::size_t) info.st_size < sizeof(header) + key.size() ||
+        pread(m_fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header))
+    {
+        return false;
+    }
+    if (memcmp(header.magic, kSegmentMagic, sizeof(kSegmentMagic)) != 0 ||
+        header.complete != 1 ||
+        header.bulletVersion != BT_BULLET_VERSION ||
+        header.scalarSize != (int) sizeof(btScalar) ||
+        header.totalSize != (long long) info.st_size ||
+        header.keySize != (long long) key.size())
+    {
+        return false;
+    }
+    std::vector<char> stored(key.size());
+    return key.empty() ||
+        (pread(m_fd, &stored[0], key.size(), sizeof(header)) == (ssize_t) key.size() &&
+         memcmp(&stored[0], key.data(), key.size()) == 0);
+}
+
+void tgSharedMesh::build(const std::string& key, Source& source)
+{
+    std::vector<btScalar> vertices;
+    std::vector<int> indices;
+    source.getTriangles(vertices, indices);
+    if (indices.empty() || indices.size() % 3 != 0 || vertices.size() % 3 != 0)
+    {
+        throw std::runtime_error("No triangles for shared mesh " + m_name);
+    }
+
+    // Build the BVH over the source's arrays, as a ground of our own would
+    btIndexedMesh indexedMesh;
+    indexedMesh.m_numTriangles = indices.size() / 3;
+    indexedMesh.m_triangleIndexBase = reinterpret_cast<const unsigned char*>(&indices[0]);
+    indexedMesh.m_triangleIndexStride = 3 * sizeof(int);
+    indexedMesh.m_numVertices = vertices.size() / 3;
+    indexedMesh.m_vertexBase = reinterpret_cast<const unsigned char*>(&vertices[0]);
+    indexedMesh.m_vertexStride = 3 * sizeof(btScalar);
+    indexedMesh.m_vertexType = sizeof(btScalar) == sizeof(double) ? PHY_DOUBLE : PHY_FLOAT;
+    btTriangleIndexVertexArray mesh;
+    mesh.addIndexedMesh(indexedMesh, PHY_INTEGER);
+    mesh.setScaling(m_scaling);
+    const bool useQuantizedAabbCompression = true;
+    btBvhTriangleMeshShape shape(&mesh, useQuantizedAabbCompression);
+    btOptimizedBvh* const pBvh = shape.getOptimizedBvh();
+    const std::size_t bvhSize = pBvh->calculateSerializeBufferSize();
+    btVector3 aabbMin;
+    btVector3 aabbMax;
+    mesh.calculateAabbBruteForce(aabbMin, aabbMax);
+
+    SegmentHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kSegmentMagic, sizeof(kSegmentMagic));
+    header.bulletVersion = BT_BULLET_VERSION;
+    header.scalarSize = sizeof(btScalar);
+    header.keySize = key.size();
+    header.triangleCount = indices.size() / 3;
+    header.vertexCount = vertices.size() / 3;
+    header.vertexOffset = align16(sizeof(header) + key.size());
+    header.indexOffset = align16(header.vertexOffset + vertices.size() * sizeof(btScalar));
+    header.bvhOffset = align16(header.indexOffset + indices.size() * sizeof(int));
+    header.bvhSize = bvhSize;
+    header.totalSize = header.bvhOffset + bvhSize;
+    for (int i = 0; i < 3; i++)
+    {
+        header.aabbMin[i] = aabbMin[i];
+        header.aabbMax[i] = aabbMax[i];
+    }
+
+    // Whatever was there is unusable; start from zeroes
+    if (ftruncate(m_fd, 0) != 0 || ftruncate(m_fd, header.totalSize) != 0)
+    {
+        throw std::runtime_error("Cannot size shared mesh " + m_name);
+    }
+    void* const pSegment = mmap(NULL, header.totalSize, PROT_READ | PROT_WRITE,
+                                MAP_SHARED, m_fd, 0);
+    if (pSegment == MAP_FAILED)
+    {
+        throw std::runtime_error("Cannot map shared mesh " + m_name);
+    }
+    char* const pBytes = static_cast<char*>(pSegment);
+    memcpy(pBytes + sizeof(header), key.data(), key.size());
+    memcpy(pBytes + header.vertexOffset, &vertices[0], vertices.size() * sizeof(btScalar));
+    memcpy(pBytes + header.indexOffset, &indices[0], indices.size() * sizeof(int));
+    const bool serialized =
+        pBvh->serializeInPlace(pBytes + header.bvhOffset, bvhSize, false);
+    if (serialized)
+    {
+        memcpy(pBytes, &header, sizeof(header));
+        __sync_synchronize();
+        static_cast<SegmentHeader*>(pSegment)->complete = 1;
+    }
+    munmap(pSegment, header.totalSize);
+    if (!serialized)
+    {
+        throw std::runtime_error("Cannot serialize the BVH of shared mesh " + m_name);
+    }
+    m_builder = true;
+}
+
+void tgSharedMesh::map()
+{
+    struct stat info;
+    if (fstat(m_fd, &info) != 0)
+    {
+        throw std::runtime_error("Cannot map shared mesh " + m_name);
+    }
+    // Private, as deserializing the BVH in place writes to its first page
+    m_mapSize = info.st_size;
+    m_pMap = mmap(NULL, m_mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, m_fd, 0);
+    if (m_pMap == MAP_FAILED)
+    {
+        m_pMap = NULL;
+        throw std::runtime_error("Cannot map shared mesh " + m_name);
+    }
+    char* const pBytes = static_cast<char*>(m_pMap);
+    const SegmentHeader& header = *static_cast<const SegmentHeader*>(m_pMap);
+
+    m_triangleCount = header.triangleCount;
+    btIndexedMesh indexedMesh;
+    indexedMesh.m_numTriangles = header.triangleCount;
+    indexedMesh.m_triangleIndexBase =
+        reinterpret_cast<const unsigned char*>(pBytes + header.indexOffset);
+    indexedMesh.m_triangleIndexStride = 3 * sizeof(int);
+    indexedMesh.m_numVertices = header.vertexCount;
+    indexedMesh.m_vertexBase =
+        reinterpret_cast<const unsigned char*>(pBytes + header.vertexOffset);
+    indexedMesh.m_vertexStride = 3 * sizeof(btScalar);
+    indexedMesh.m_vertexType = sizeof(btScalar) == sizeof(double) ? PHY_DOUBLE : PHY_FLOAT;
+    m_pMesh = new btTriangleIndexVertexArray();
+    m_pMesh->addIndexedMesh(indexedMesh, PHY_INTEGER);
+    m_pMesh->setScaling(m_scaling);
+
+    m_pBvh = static_cast<btOptimizedBvh*>(btOptimizedBvh::deSerializeInPlace(
+        pBytes + header.bvhOffset, header.bvhSize, false));
+    if (m_pBvh == NULL)
+    {
+        throw std::runtime_error("Cannot read the BVH of shared mesh " + m_name);
+    }
+    m_aabbMin.setValue(header.aabbMin[0], header.aabbMin[1], header.aabbMin[2]);
+    m_aabbMax.setValue(header.aabbMax[0], header.aabbMax[1], header.aabbMax[2]);
+}
+
+void tgSharedMesh::release()
+{
+    delete m_pMesh;
+    m_pMesh = NULL;
+    m_pBvh = NULL;
+    if (m_pMap != NULL)
+    {
+        munmap(m_pMap, m_mapSize);
+        m_pMap = NULL;
+    }
+    if (m_fd >= 0)
+    {
+        // Taking it exclusively only succeeds if no other mapping holds it
+        if (flock(m_fd, LOCK_EX | LOCK_NB) == 0)
+        {
+            shm_unlink(m_name.c_str());
+        }
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef CORE_TERRAIN_TG_SHARED_MESH_H
+#define CORE_TERRAIN_TG_SHARED_MESH_H
+
+/**
+ * @file tgSharedMesh.h
+ * @brief Contains the definition of class tgSharedMesh.
+ * $Id$
+ */
+
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btVector3.h"
+
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class btBvhTriangleMeshShape;
+class btOptimizedBvh;
+class btTriangleIndexVertexArray;
+
+/**
+ * A terrain's triangles and BVH in a named shared memory segment, so
+ * that processes running on the same node keep one copy of a large
+ * ground between them rather than one each.
+ *
+ * The first process to ask for a mesh builds the segment: it gets the
+ * triangles from its Source, builds the BVH and writes both into the
+ * segment. Later processes, and later grounds in the same process, map
+ * it instead, and their btTriangleIndexVertexArray and BVH point
+ * straight into the segment. The mapping is copy-on-write because
+ * Bullet writes the BVH object itself when deserializing it in place;
+ * only that page is copied, and the vertices, indices and BVH nodes
+ * stay shared.
+ *
+ * Segments are named from a hash of a key that must hold everything the
+ * mesh depends on, such as a file's path, size and time stamp, or a
+ * generated ground's parameters. The last process to unmap a segment
+ * removes it, so a node's memory is given back when its jobs end.
+ */
+class tgSharedMesh
+{
+    public:
+
+        /** Supplies the triangles when a segment has to be built */
+        class Source
+        {
+            public:
+                virtual ~Source() { }
+
+                /**
+                 * @param[out] vertices x, y, z of each vertex
+                 * @param[out] indices three vertex indices per triangle
+                 */
+                virtual void getTriangles(std::vector<btScalar>& vertices,
+                                          std::vector<int>& indices) = 0;
+        };
+
+        /**
+         * Map the mesh for a key, building its segment if no process has
+         * @param[in] key everything the mesh depends on
+         * @param[in] source called only to build the segment
+         * @param[in] scaling of the mesh, which its BVH is built for
+         * @throw std::runtime_error if the segment cannot be opened or
+         * mapped, or the source has no triangles
+         */
+        tgSharedMesh(const std::string& key, Source& source,
+                     const btVector3& scaling);
+
+        /**
+         * Unmap the segment, removing it if no other process has it
+         * mapped. Shapes from createShape must be deleted first.
+         */
+        ~tgSharedMesh();
+
+        /**
+         * A shape over the segment's mesh and BVH, which it does not own.
+         * The caller owns the shape.
+         */
+        btBvhTriangleMeshShape* createShape() const;
+
+        std::size_t getTriangleCount() const
+        {
+            return m_triangleCount;
+        }
+
+        /** Whether this object built the segment */
+        bool isBuilder() const
+        {
+            return m_builder;
+        }
+
+        /** The segment's name, under /dev/shm */
+        const std::string& getName() const
+        {
+            return m_name;
+        }
+
+    private:
+
+        /**
+         * Whether the open segment holds this key's mesh. Called with the
+         * segment locked.
+         */
+        bool isBuilt(const std::string& key) const;
+
+        /** Write the source's mesh into the open segment, locked */
+        void build(const std::string& key, Source& source);
+
+        /** Map the open segment and point the mesh and BVH into it */
+        void map();
+
+        /** Unmap and close, removing the segment if no one else has it */
+        void release();
+
+        /** Not copyable */
+        tgSharedMesh(const tgSharedMesh&);
+        tgSharedMesh& operator=(const tgSharedMesh&);
+
+        const btVector3 m_scaling;
+
+        std::string m_name;
+
+        /** Held with a shared flock while the segment is mapped */
+        int m_fd;
+
+        void* m_pMap;
+        std::size_t m_mapSize;
+
+        std::size_t m_triangleCount;
+
+        btTriangleIndexVertexArray* m_pMesh;
+
+        /** In the mapping */
+        btOptimizedBvh* m_pBvh;
+
+        btVector3 m_aabbMin;
+        btVector3 m_aabbMax;
+
+        bool m_builder;
+};
+
+#endif  // CORE_TERRAIN_TG_SHARED_MESH_H
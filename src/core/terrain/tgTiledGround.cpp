@@ -0,0 +1,313 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+/**
+ * @file tgTiledGround.cpp
+ * @brief Contains the implementation of class tgTiledGround
+ * $Id$
+ */
+
+//This Module
+#include "tgTiledGround.h"
+
+//Bullet Physics
+#include "BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btDefaultMotionState.h"
+#include "LinearMath/btTransform.h"
+#include "LinearMath/btVector3.h"
+
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+    // As in tgHillyGround
+#if defined(BT_USE_DOUBLE_PRECISION) && BT_BULLET_VERSION >= 288
+    const PHY_ScalarType kHeightDataType = PHY_DOUBLE;
+#else
+    const PHY_ScalarType kHeightDataType = PHY_FLOAT;
+#endif
+}
+
+tgTiledGround::Config::Config(double friction,
+        double restitution,
+        double tileSize,
+        std::size_t cellsPerTile,
+        std::size_t tileRadius,
+        std::size_t cachedTiles,
+        double margin,
+        double waveLength,
+        double waveHeight,
+        double offset) :
+    m_friction(friction),
+    m_restitution(restitution),
+    m_tileSize(tileSize),
+    m_cellsPerTile(cellsPerTile),
+    m_tileRadius(tileRadius),
+    m_cachedTiles(cachedTiles),
+    m_margin(margin),
+    m_waveLength(waveLength),
+    m_waveHeight(waveHeight),
+    m_offset(offset)
+{
+    assert((m_friction >= 0.0) && (m_friction <= 1.0));
+    assert((m_restitution >= 0.0) && (m_restitution <= 1.0));
+    assert(m_tileSize > 0.0);
+    assert(m_cellsPerTile > 0);
+    assert(m_margin >= 0.0);
+    assert(m_waveLength > 0.0);
+}
+
+tgTiledGround::tgTiledGround() :
+    m_config(Config()),
+    m_releases(0)
+{
+    pthread_mutex_init(&m_tileMutex, NULL);
+}
+
+tgTiledGround::tgTiledGround(const tgTiledGround::Config& config) :
+    m_config(config),
+    m_releases(0)
+{
+    pthread_mutex_init(&m_tileMutex, NULL);
+}
+
+tgTiledGround::~tgTiledGround()
+{
+    // Worlds must be destroyed before their ground
+    assert(m_worlds.empty());
+    for (std::map<TileKey, Tile*>::iterator it = m_tiles.begin();
+         it != m_tiles.end(); ++it)
+    {
+        delete it->second->pShape;
+        delete it->second;
+    }
+    pthread_mutex_destroy(&m_tileMutex);
+}
+
+btRigidBody* tgTiledGround::getGroundRigidBody() const
+{
+    btRigidBody* const pGroundBody = NULL;
+
+    // This should never be called
+    assert(false);
+
+    return pGroundBody;
+}
+
+bool tgTiledGround::followBodies(btDynamicsWorld& world, const btVector3& centre)
+{
+    const TileKey key(static_cast<long>(std::floor(centre.x() / m_config.m_tileSize)),
+                      static_cast<long>(std::floor(centre.z() / m_config.m_tileSize)));
+    const long radius = static_cast<long>(m_config.m_tileRadius);
+
+    pthread_mutex_lock(&m_tileMutex);
+    WorldTiles& worldTiles = m_worlds[&world];
+    if (!worldTiles.bodies.empty() && worldTiles.centre == key)
+    {
+        pthread_mutex_unlock(&m_tileMutex);
+        return false;
+    }
+    worldTiles.centre = key;
+
+    // Evict the tiles that have fallen behind
+    std::map<TileKey, btRigidBody*>::iterator it = worldTiles.bodies.begin();
+    while (it != worldTiles.bodies.end())
+    {
+        if (std::labs(it->first.first - key.first) > radius ||
+            std::labs(it->first.second - key.second) > radius)
+        {
+            destroyTileBody(world, it->second);
+            releaseTile(it->first);
+            worldTiles.bodies.erase(it++);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // Load the ones ahead
+    for (long i = key.first - radius; i <= key.first + radius; i++)
+    {
+        for (long j = key.second - radius; j <= key.second + radius; j++)
+        {
+            const TileKey tileKey(i, j);
+            if (worldTiles.bodies.find(tileKey) == worldTiles.bodies.end())
+            {
+                btRigidBody* const pBody =
+                    createTileBody(tileKey, *acquireTile(tileKey));
+                world.addRigidBody(pBody);
+                worldTiles.bodies[tileKey] = pBody;
+            }
+        }
+    }
+    pthread_mutex_unlock(&m_tileMutex);
+    return true;
+}
+
+void tgTiledGround::leaveWorld(btDynamicsWorld& world)
+{
+    pthread_mutex_lock(&m_tileMutex);
+    std::map<btDynamicsWorld*, WorldTiles>::iterator found = m_worlds.find(&world);
+    if (found != m_worlds.end())
+    {
+        std::map<TileKey, btRigidBody*>& bodies = found->second.bodies;
+        for (std::map<TileKey, btRigidBody*>::iterator it = bodies.begin();
+             it != bodies.end(); ++it)
+        {
+            destroyTileBody(world, it->second);
+            releaseTile(it->first);
+        }
+        m_worlds.erase(found);
+    }
+    pthread_mutex_unlock(&m_tileMutex);
+}
+
+double tgTiledGround::height(double x, double z) const
+{
+    return m_config.m_waveHeight *
+        sin(x / m_config.m_waveLength) * cos(z / m_config.m_waveLength) +
+        m_config.m_offset;
+}
+
+tgTiledGround::Tile* tgTiledGround::acquireTile(const TileKey& key)
+{
+    Tile*& pTile = m_tiles[key];
+    if (pTile == NULL)
+    {
+        pTile = createTile(key);
+    }
+    pTile->users++;
+    return pTile;
+}
+
+void tgTiledGround::releaseTile(const TileKey& key)
+{
+    std::map<TileKey, Tile*>::iterator found = m_tiles.find(key);
+    assert(found != m_tiles.end());
+    assert(found->second->users > 0);
+    found->second->users--;
+    found->second->lastUse = m_releases++;
+
+    // Keep at most m_cachedTiles that no world is using
+    while (true)
+    {
+        std::size_t unused = 0;
+        std::map<TileKey, Tile*>::iterator oldest = m_tiles.end();
+        for (std::map<TileKey, Tile*>::iterator it = m_tiles.begin();
+             it != m_tiles.end(); ++it)
+        {
+            if (it->second->users == 0)
+            {
+                unused++;
+                if (oldest == m_tiles.end() ||
+                    it->second->lastUse < oldest->second->lastUse)
+                {
+                    oldest = it;
+                }
+            }
+        }
+        if (unused <= m_config.m_cachedTiles)
+        {
+            break;
+        }
+        delete oldest->second->pShape;
+        delete oldest->second;
+        m_tiles.erase(oldest);
+    }
+}
+
+tgTiledGround::Tile* tgTiledGround::createTile(const TileKey& key) const
+{
+    const std::size_t n = m_config.m_cellsPerTile + 1;
+    const double cellSize = m_config.m_tileSize / m_config.m_cellsPerTile;
+    const double x0 = key.first * m_config.m_tileSize;
+    const double z0 = key.second * m_config.m_tileSize;
+
+    // The nodes on a tile's edges are shared with its neighbours, so the
+    // surface has no seams. Layout as in tgHillyGround, i + j * n with x
+    // along the width and z along the length.
+    Tile* const pTile = new Tile();
+    pTile->heights.resize(n * n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = 0; j < n; j++)
+        {
+            pTile->heights[i + (j * n)] = height(x0 + i * cellSize,
+                                                 z0 + j * cellSize);
+        }
+    }
+
+    const btScalar minHeight =
+        *std::min_element(pTile->heights.begin(), pTile->heights.end());
+    const btScalar maxHeight =
+        *std::max_element(pTile->heights.begin(), pTile->heights.end());
+
+    const int upAxis = 1;
+    const bool flipQuadEdges = false;
+    btHeightfieldTerrainShape* const pShape =
+        new btHeightfieldTerrainShape(n, n, &pTile->heights[0], 1.0,
+                                      minHeight, maxHeight, upAxis,
+                                      kHeightDataType, flipQuadEdges);
+    pShape->setLocalScaling(btVector3(cellSize, 1.0, cellSize));
+    pShape->setMargin(m_config.m_margin);
+
+    pTile->pShape = pShape;
+    // Bullet centres a heightfield on its AABB
+    pTile->centreHeight = 0.5 * (minHeight + maxHeight);
+    pTile->users = 0;
+    pTile->lastUse = 0;
+    return pTile;
+}
+
+btRigidBody* tgTiledGround::createTileBody(const TileKey& key, const Tile& tile) const
+{
+    const btScalar mass = 0.0;
+
+    btTransform tileTransform;
+    tileTransform.setIdentity();
+    tileTransform.setOrigin(btVector3((key.first + 0.5) * m_config.m_tileSize,
+                                      tile.centreHeight,
+                                      (key.second + 0.5) * m_config.m_tileSize));
+
+    btDefaultMotionState* const pMotionState =
+        new btDefaultMotionState(tileTransform);
+
+    const btVector3 localInertia(0, 0, 0);
+
+    btRigidBody::btRigidBodyConstructionInfo const rbInfo(mass, pMotionState, tile.pShape, localInertia);
+
+    btRigidBody* const pTileBody = new btRigidBody(rbInfo);
+    pTileBody->setFriction(m_config.m_friction);
+    pTileBody->setRestitution(m_config.m_restitution);
+
+    return pTileBody;
+}
+
+void tgTiledGround::destroyTileBody(btDynamicsWorld& world, btRigidBody* pBody) const
+{
+    world.removeRigidBody(pBody);
+    delete pBody->getMotionState();
+    delete pBody;
+}
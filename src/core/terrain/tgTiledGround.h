@@ -0,0 +1,217 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+#ifndef CORE_TERRAIN_TG_TILED_GROUND_H
+#define CORE_TERRAIN_TG_TILED_GROUND_H
+
+/**
+ * @file tgTiledGround.h
+ * @brief Contains the definition of class tgTiledGround.
+ * $Id$
+ */
+
+#include "tgBulletGround.h"
+
+#include "LinearMath/btScalar.h"
+
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+#include <pthread.h>
+
+// Forward declarations
+class btDynamicsWorld;
+class btRigidBody;
+class btVector3;
+
+/**
+ * A ground of square heightfield tiles that are loaded around the
+ * world's moving bodies as they travel and evicted behind them, so the
+ * terrain of a long run costs no more memory or broadphase time than a
+ * few tiles. tgWorldBulletPhysicsImpl checks for this class with a
+ * tgCast call: it adds no ground body, and calls followBodies before
+ * each step instead.
+ *
+ * The heights come from the virtual height function, by default the
+ * same sine hills as tgHillyGround, continued without end. Subclasses
+ * generate or load their own. The heights of recently used tiles are
+ * cached by the ground, and shared by every world it is in, so a world
+ * reset or a robot coming back does not regenerate them.
+ */
+class tgTiledGround : public tgBulletGround
+{
+    public:
+
+        struct Config
+        {
+            public:
+                Config(double friction = 0.5,
+                       double restitution = 0.0,
+                       double tileSize = 100.0,
+                       std::size_t cellsPerTile = 20,
+                       std::size_t tileRadius = 1,
+                       std::size_t cachedTiles = 64,
+                       double margin = 0.05,
+                       double waveLength = 5.0,
+                       double waveHeight = 5.0,
+                       double offset = 0.5);
+
+                /** Friction value of the ground, must be between 0 to 1 */
+                btScalar  m_friction;
+
+                /** Restitution coefficient of the ground, must be between 0 to 1 */
+                btScalar  m_restitution;
+
+                /** Length of a side of a tile on the X and Z axes; must be positive */
+                double m_tileSize;
+
+                /** Grid cells along a side of a tile; must be positive */
+                std::size_t m_cellsPerTile;
+
+                /**
+                 * Tiles kept on each side of the one under the bodies'
+                 * centre, so (2 * m_tileRadius + 1)^2 are in the world
+                 */
+                std::size_t m_tileRadius;
+
+                /**
+                 * Tiles no world is using whose heights are kept for
+                 * when they are needed again
+                 */
+                std::size_t m_cachedTiles;
+
+                /** See Bullet documentation on Collision Margin */
+                double m_margin;
+
+                /**
+                 * Horizontal scale of the default hills, which repeat
+                 * every 2 pi m_waveLength; must be positive
+                 */
+                double m_waveLength;
+
+                /** Amplitude of the default hills */
+                double m_waveHeight;
+
+                /** Height of the default hills' mid-line */
+                double m_offset;
+        };
+
+        /** Construct with the default configuration */
+        tgTiledGround();
+
+        /** Allows a user to specify their own config */
+        tgTiledGround(const tgTiledGround::Config& config);
+
+        /**
+         * Delete the cached tiles. Worlds must have left the ground
+         * first.
+         */
+        virtual ~tgTiledGround();
+
+        /**
+         * This should never be called, as the ground has no single
+         * body. Will fail an assertion.
+         */
+        virtual btRigidBody* getGroundRigidBody() const;
+
+        /**
+         * Load the tiles around a point into a world and evict those
+         * that are now too far away. Does nothing while the point stays
+         * on the same tile. Safe to call for several worlds from
+         * several threads.
+         * @param[in] world the world to put the tiles in
+         * @param[in] centre the centre of the world's moving bodies
+         * @return true if tiles were added to or removed from the world
+         */
+        bool followBodies(btDynamicsWorld& world, const btVector3& centre);
+
+        /**
+         * Remove this ground's tiles from a world that is about to be
+         * destroyed.
+         */
+        void leaveWorld(btDynamicsWorld& world);
+
+    protected:
+
+        /**
+         * The height of the surface at a point, called for each grid
+         * node of a tile as it is first loaded. Must be deterministic,
+         * since a tile evicted from the cache is regenerated.
+         * @param[in] x the world X coordinate
+         * @param[in] z the world Z coordinate
+         * @return the world Y coordinate of the surface
+         */
+        virtual double height(double x, double z) const;
+
+    private:
+
+        /** A tile's grid index on the X and Z axes */
+        typedef std::pair<long, long> TileKey;
+
+        /** The heights and shape of a tile, shared by the worlds it is in */
+        struct Tile
+        {
+            std::vector<btScalar> heights;
+            btCollisionShape* pShape;
+            /** Where the shape's centre lies in the world */
+            btScalar centreHeight;
+            /** Worlds the tile is in */
+            std::size_t users;
+            /** When the tile was last released, for eviction */
+            std::size_t lastUse;
+        };
+
+        /** A world's loaded tiles */
+        struct WorldTiles
+        {
+            TileKey centre;
+            std::map<TileKey, btRigidBody*> bodies;
+        };
+
+        /** Get a tile from the cache, generating it if needed */
+        Tile* acquireTile(const TileKey& key);
+
+        /** Give back a tile, evicting the least recently used ones */
+        void releaseTile(const TileKey& key);
+
+        /** Generate the heights and shape of a tile */
+        Tile* createTile(const TileKey& key) const;
+
+        /** A static body for a tile at its place in the world */
+        btRigidBody* createTileBody(const TileKey& key, const Tile& tile) const;
+
+        /** Take a tile's body out of a world and delete it */
+        void destroyTileBody(btDynamicsWorld& world, btRigidBody* pBody) const;
+
+        /** Store the configuration data for use later */
+        const Config m_config;
+
+        std::map<TileKey, Tile*> m_tiles;
+
+        std::map<btDynamicsWorld*, WorldTiles> m_worlds;
+
+        /** Counts releases, to order the cached tiles by last use */
+        std::size_t m_releases;
+
+        /** Guards m_tiles and m_worlds */
+        pthread_mutex_t m_tileMutex;
+};
+
+#endif  // CORE_TERRAIN_TG_TILED_GROUND_H
@@ -0,0 +1,148 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgActuatorGroups.cpp
+ * @brief Contains the definitions of members of class tgActuatorGroups
+ * $Id$
+ */
+
+// This module
+#include "tgActuatorGroups.h"
+// This application
+#include "tgSpringCableActuator.h"
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+tgActuatorGroups::tgActuatorGroups()
+{
+}
+
+std::size_t tgActuatorGroups::addGroup(const std::string& name,
+                                       const tgTagSearch& tagSearch)
+{
+    if (hasGroup(name))
+    {
+        throw std::invalid_argument("Actuator group " + name + " already exists");
+    }
+    m_names.push_back(name);
+    m_searches.push_back(tagSearch);
+    m_ranges.push_back(Range());
+    return m_names.size() - 1;
+}
+
+void tgActuatorGroups::build(const std::vector<tgSpringCableActuator*>& actuators)
+{
+    const std::size_t n = actuators.size();
+    const std::size_t groups = m_names.size();
+
+    // The first group each actuator matches; groups for none
+    std::vector<std::size_t> groupOf(n, groups);
+    std::vector<std::size_t> counts(groups + 1, 0);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        assert(actuators[i] != NULL);
+        std::size_t g = 0;
+        while (g < groups && !m_searches[g].matches(*actuators[i]))
+        {
+            g++;
+        }
+        groupOf[i] = g;
+        counts[g]++;
+    }
+
+    std::size_t begin = 0;
+    for (std::size_t g = 0; g < groups; g++)
+    {
+        m_ranges[g].begin = begin;
+        m_ranges[g].end = begin + counts[g];
+        begin = m_ranges[g].end;
+    }
+
+    // A counting sort, which keeps the order within each group
+    std::vector<std::size_t> next(groups + 1, 0);
+    for (std::size_t g = 0; g < groups; g++)
+    {
+        next[g] = m_ranges[g].begin;
+    }
+    next[groups] = begin;
+    m_actuators.resize(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        m_actuators[next[groupOf[i]]++] = actuators[i];
+    }
+}
+
+void tgActuatorGroups::clear()
+{
+    m_names.clear();
+    m_searches.clear();
+    m_ranges.clear();
+    m_actuators.clear();
+}
+
+bool tgActuatorGroups::hasGroup(const std::string& name) const
+{
+    for (std::size_t i = 0; i < m_names.size(); i++)
+    {
+        if (m_names[i] == name)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::size_t tgActuatorGroups::getIndex(const std::string& name) const
+{
+    for (std::size_t i = 0; i < m_names.size(); i++)
+    {
+        if (m_names[i] == name)
+        {
+            return i;
+        }
+    }
+    throw std::invalid_argument("No actuator group " + name);
+}
+
+std::vector<tgSpringCableActuator*> tgActuatorGroups::getActuators(std::size_t group) const
+{
+    const Range& range = m_ranges[group];
+    return std::vector<tgSpringCableActuator*>(m_actuators.begin() + range.begin,
+                                               m_actuators.begin() + range.end);
+}
+
+void tgActuatorGroups::setControlInput(std::size_t group, double input) const
+{
+    const Range& range = m_ranges[group];
+    for (std::size_t i = range.begin; i < range.end; i++)
+    {
+        m_actuators[i]->setControlInput(input);
+    }
+}
+
+void tgActuatorGroups::setControlInput(std::size_t group, const double* inputs,
+                                       double dt) const
+{
+    const Range& range = m_ranges[group];
+    for (std::size_t i = range.begin; i < range.end; i++)
+    {
+        m_actuators[i]->setControlInput(inputs[i - range.begin], dt);
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_ACTUATOR_GROUPS_H
+#define TG_ACTUATOR_GROUPS_H
+
+/**
+ * @file tgActuatorGroups.h
+ * @brief Contains the definition of class tgActuatorGroups
+ * $Id$
+ */
+
+// This application
+#include "tgTagSearch.h"
+// The C++ Standard Library
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgSpringCableActuator;
+
+/**
+ * Named groups of a model's actuators, resolved once when the model is
+ * built instead of by tgModel::find in every controller. The groups
+ * come from tgBuildSpec::addActuatorGroup, and tgStructureInfo fills
+ * them in as it builds into the model, before the model's controllers
+ * are set up.
+ *
+ * The actuators are kept in one array ordered by group, so each group
+ * is a contiguous range of indices that can be handed to the batched
+ * controllers or commanded in one loop. An actuator that matches
+ * several groups is put in the first of them to be added, so more
+ * specific groups should be added first. Actuators in no group follow
+ * the last group.
+ */
+class tgActuatorGroups
+{
+public:
+
+    /** A group's indices into getActuators(), from begin to before end */
+    struct Range
+    {
+        Range() : begin(0), end(0) {}
+
+        std::size_t size() const
+        {
+            return end - begin;
+        }
+
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    tgActuatorGroups();
+
+    /**
+     * Add a group, which is empty until build.
+     * @param[in] name the group's name
+     * @param[in] tagSearch the actuators it holds
+     * @return the group's index
+     * @throw std::invalid_argument if there is already a group of this
+     * name
+     */
+    std::size_t addGroup(const std::string& name, const tgTagSearch& tagSearch);
+
+    /**
+     * Sort the actuators into the groups, replacing any built before.
+     * @param[in] actuators e.g. every tgSpringCableActuator descendant
+     * of the model, in getDescendants() order, which is kept within
+     * each group; none may be NULL
+     */
+    void build(const std::vector<tgSpringCableActuator*>& actuators);
+
+    /** Forget the groups and the actuators */
+    void clear();
+
+    /** The number of groups */
+    std::size_t size() const
+    {
+        return m_names.size();
+    }
+
+    bool hasGroup(const std::string& name) const;
+
+    /**
+     * @return the index of a group, for the other accessors
+     * @throw std::invalid_argument if there is no group of this name
+     */
+    std::size_t getIndex(const std::string& name) const;
+
+    const std::string& getName(std::size_t group) const
+    {
+        return m_names[group];
+    }
+
+    const Range& getRange(std::size_t group) const
+    {
+        return m_ranges[group];
+    }
+
+    /** @throw std::invalid_argument if there is no group of this name */
+    const Range& getRange(const std::string& name) const
+    {
+        return m_ranges[getIndex(name)];
+    }
+
+    /** Every actuator, ordered by group */
+    const std::vector<tgSpringCableActuator*>& getActuators() const
+    {
+        return m_actuators;
+    }
+
+    /** A group's actuators, as a copy */
+    std::vector<tgSpringCableActuator*> getActuators(std::size_t group) const;
+
+    /** Call setControlInput(input) on every actuator of a group */
+    void setControlInput(std::size_t group, double input) const;
+
+    /**
+     * Call setControlInput(inputs[i], dt) on the i-th actuator of a
+     * group
+     * @param[in] inputs getRange(group).size() control inputs
+     */
+    void setControlInput(std::size_t group, const double* inputs, double dt) const;
+
+private:
+
+    std::vector<std::string> m_names;
+
+    std::vector<tgTagSearch> m_searches;
+
+    std::vector<Range> m_ranges;
+
+    std::vector<tgSpringCableActuator*> m_actuators;
+};
+
+#endif  // TG_ACTUATOR_GROUPS_H
@@ -0,0 +1,296 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgAdaptiveStepper.cpp
+ * @brief Contains the definitions of members of class tgAdaptiveStepper
+ * $Id$
+ */
+
+// This module
+#include "tgAdaptiveStepper.h"
+// This application
+#include "tgBulletSpringCableAnchor.h"
+#include "tgContactFrame.h"
+#include "tgSimulation.h"
+#include "tgSpringCable.h"
+#include "tgSpringCableActuator.h"
+#include "tgStopPredicate.h"
+#include "tgWorld.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+tgAdaptiveStepper::Config::Config(double mins, double maxs, double cp,
+                                  double t, double ss, double mg) :
+minStepSize(mins),
+maxStepSize(maxs),
+controlPeriod(cp),
+tolerance(t),
+stabilitySafety(ss),
+maxGrowth(mg)
+{
+}
+
+tgAdaptiveStepper::tgAdaptiveStepper(tgSimulation& simulation,
+                                     const Config& config) :
+m_simulation(simulation),
+m_config(config)
+{
+    if (!(config.minStepSize > 0.0))
+    {
+        throw std::invalid_argument("minStepSize is not positive");
+    }
+    else if (!(config.maxStepSize >= config.minStepSize))
+    {
+        throw std::invalid_argument("maxStepSize is below minStepSize");
+    }
+    else if (!(config.controlPeriod >= config.maxStepSize))
+    {
+        throw std::invalid_argument("controlPeriod is below maxStepSize");
+    }
+    else if (!(config.tolerance > 0.0))
+    {
+        throw std::invalid_argument("tolerance is not positive");
+    }
+    else if (!(config.stabilitySafety > 0.0 && config.stabilitySafety <= 1.0))
+    {
+        throw std::invalid_argument("stabilitySafety is not in (0, 1]");
+    }
+    else if (!(config.maxGrowth >= 1.0))
+    {
+        throw std::invalid_argument("maxGrowth is below 1");
+    }
+    restart();
+}
+
+void tgAdaptiveStepper::restart()
+{
+    m_actuators.clear();
+    m_bodies.clear();
+    m_ends.clear();
+    m_stiffness.clear();
+    m_previousLengths.clear();
+    m_lengths.clear();
+    m_lengthSteps = 0;
+    m_previousStep = 0.0;
+    m_touching.clear();
+    m_contactsKnown = false;
+    m_stepSize = m_config.minStepSize;
+    m_stabilityLimit = m_config.maxStepSize;
+    m_time = 0.0;
+    m_stats.periods = 0;
+    m_stats.steps = 0;
+    m_stats.smallestStep = 0.0;
+    m_stats.largestStep = 0.0;
+    m_stats.contactPeriods = 0;
+    m_stats.stabilityLimitedPeriods = 0;
+}
+
+void tgAdaptiveStepper::updateActuators()
+{
+    m_simulation.collectActuators(m_collected);
+    if (m_collected == m_actuators)
+    {
+        return;
+    }
+    m_actuators.swap(m_collected);
+    m_bodies.clear();
+    m_ends.clear();
+    m_lengthSteps = 0;
+
+    // A contact cable's anchors between its ends come and go, so only
+    // the ends count
+    for (std::size_t i = 0; i < m_actuators.size(); i++)
+    {
+        const std::vector<const tgSpringCableAnchor*> anchors =
+            m_actuators[i]->getSpringCable()->getAnchors();
+        for (int end = 0; end < 2; end++)
+        {
+            const tgBulletSpringCableAnchor* const pAnchor = anchors.empty() ?
+                NULL : dynamic_cast<const tgBulletSpringCableAnchor*>(
+                    end == 0 ? anchors.front() : anchors.back());
+            int index = -1;
+            if (pAnchor != NULL && pAnchor->attachedBody != NULL)
+            {
+                btRigidBody* const pBody = pAnchor->attachedBody;
+                const std::vector<btRigidBody*>::const_iterator it =
+                    std::find(m_bodies.begin(), m_bodies.end(), pBody);
+                index = static_cast<int>(it - m_bodies.begin());
+                if (it == m_bodies.end())
+                {
+                    m_bodies.push_back(pBody);
+                }
+            }
+            m_ends.push_back(index);
+        }
+    }
+    m_stiffness.resize(m_bodies.size());
+    m_previousLengths.resize(m_actuators.size());
+    m_lengths.resize(m_actuators.size());
+}
+
+double tgAdaptiveStepper::stabilityLimit()
+{
+    // Stiffnesses can be changed on live cables, so they are summed again
+    // every period
+    std::fill(m_stiffness.begin(), m_stiffness.end(), 0.0);
+    for (std::size_t i = 0; i < m_actuators.size(); i++)
+    {
+        const double k = m_actuators[i]->getSpringCable()->getCoefK();
+        for (int end = 0; end < 2; end++)
+        {
+            const int index = m_ends[2 * i + end];
+            if (index >= 0)
+            {
+                m_stiffness[index] += k;
+            }
+        }
+    }
+
+    // A body of mass m on springs of total stiffness k oscillates at
+    // sqrt(k / m), which an explicit step of dt follows while
+    // dt * sqrt(k / m) < 2
+    double stiffest = 0.0;
+    for (std::size_t i = 0; i < m_bodies.size(); i++)
+    {
+        stiffest = std::max(stiffest, m_stiffness[i] * m_bodies[i]->getInvMass());
+    }
+    return stiffest > 0.0 ?
+        m_config.stabilitySafety * 2.0 / std::sqrt(stiffest) :
+        std::numeric_limits<double>::infinity();
+}
+
+double tgAdaptiveStepper::measureError(double dt)
+{
+    double error = 0.0;
+    for (std::size_t i = 0; i < m_actuators.size(); i++)
+    {
+        const double length = m_actuators[i]->getCurrentLength();
+        if (m_lengthSteps == 2)
+        {
+            const double predicted = m_lengths[i] +
+                (m_lengths[i] - m_previousLengths[i]) * dt / m_previousStep;
+            error = std::max(error, std::fabs(length - predicted));
+        }
+        m_previousLengths[i] = m_lengths[i];
+        m_lengths[i] = length;
+    }
+    m_lengthSteps = std::min(m_lengthSteps + 1, 2);
+    m_previousStep = dt;
+    return error;
+}
+
+bool tgAdaptiveStepper::contactsChanged()
+{
+    const std::vector<tgContactFrame::ContactSummary>& summaries =
+        m_simulation.getWorld().getContacts().getSummaries();
+    bool changed = m_contactsKnown && summaries.size() != m_touching.size();
+    m_touching.resize(summaries.size());
+    for (std::size_t i = 0; i < summaries.size(); i++)
+    {
+        const char touching = summaries[i].contactCount > 0 ? 1 : 0;
+        changed = changed || (m_contactsKnown && touching != m_touching[i]);
+        m_touching[i] = touching;
+    }
+    m_contactsKnown = true;
+    return changed;
+}
+
+double tgAdaptiveStepper::stepPeriod()
+{
+    updateActuators();
+    m_stabilityLimit = stabilityLimit();
+
+    const double target = std::max(m_config.minStepSize,
+        std::min(m_stepSize, std::min(m_stabilityLimit, m_config.maxStepSize)));
+    const int steps = std::max(1,
+        static_cast<int>(std::ceil(m_config.controlPeriod / target - 1e-9)));
+    const double dt = m_config.controlPeriod / steps;
+
+    double error = 0.0;
+    bool contact = false;
+    for (int i = 0; i < steps; i++)
+    {
+        m_simulation.step(dt);
+        error = std::max(error, measureError(dt));
+        contact = contactsChanged() || contact;
+    }
+    m_time += m_config.controlPeriod;
+
+    m_stats.periods++;
+    m_stats.steps += steps;
+    m_stats.smallestStep = m_stats.periods == 1 ? dt :
+        std::min(m_stats.smallestStep, dt);
+    m_stats.largestStep = std::max(m_stats.largestStep, dt);
+    if (target == m_stabilityLimit)
+    {
+        m_stats.stabilityLimitedPeriods++;
+    }
+
+    // The error of a step goes as its square
+    double growth = m_config.maxGrowth;
+    if (error > 0.0)
+    {
+        growth = std::max(1.0 / m_config.maxGrowth,
+            std::min(m_config.maxGrowth,
+                     0.9 * std::sqrt(m_config.tolerance / error)));
+    }
+    if (contact)
+    {
+        m_stats.contactPeriods++;
+        m_stepSize = m_config.minStepSize;
+    }
+    else
+    {
+        m_stepSize = std::max(m_config.minStepSize,
+            std::min(m_config.maxStepSize, dt * growth));
+    }
+    return dt;
+}
+
+std::string tgAdaptiveStepper::run(double seconds,
+                                   const std::vector<tgStopPredicate*>& predicates)
+{
+    for (std::size_t i = 0; i < predicates.size(); i++)
+    {
+        if (predicates[i] == NULL)
+        {
+            throw std::invalid_argument("Stop predicate is NULL");
+        }
+        predicates[i]->onStart();
+    }
+    const double start = m_time;
+    const double end = m_time + seconds - 1e-9 * m_config.controlPeriod;
+    while (m_time < end)
+    {
+        stepPeriod();
+        for (std::size_t i = 0; i < predicates.size(); i++)
+        {
+            if (predicates[i]->shouldStop(m_time - start))
+            {
+                return predicates[i]->reason();
+            }
+        }
+    }
+    return "";
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_ADAPTIVE_STEPPER_H
+#define TG_ADAPTIVE_STEPPER_H
+
+/**
+ * @file tgAdaptiveStepper.h
+ * @brief Contains the definition of class tgAdaptiveStepper
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class tgSimulation;
+class tgSpringCableActuator;
+class tgStopPredicate;
+
+/**
+ * Steps a simulation with a step size chosen as it goes, instead of one
+ * fixed tgSimulation step size that has to be small enough for the
+ * stiffest moment of the whole run. Time is cut into fixed control
+ * periods, and each period into equal steps, so that controllers wrapped
+ * in a period-based tgDecimatedObserver still run at a fixed rate while
+ * the world takes as many steps between them as it needs.
+ *
+ * The step size of the next period is the smallest of:
+ * - the stability limit of the stiffest cable on the lightest body,
+ *   stabilitySafety * 2 / sqrt(k / m), with k the sum of the stiffnesses
+ *   of the cables anchored to the body;
+ * - the step that keeps the error estimate under the tolerance. Each
+ *   step, every cable's length is compared with the straight line
+ *   through its two previous lengths; the largest difference goes as
+ *   dt squared, so the step is scaled by the square root of the
+ *   tolerance over it, growing at most by maxGrowth a period;
+ * - maxStepSize.
+ * A period in which a body starts or stops touching anything is
+ * followed by one at minStepSize, since contact is where the cable
+ * lengths stop telling the whole story.
+ *
+ * The world's stop predicates are checked at the end of every period.
+ */
+class tgAdaptiveStepper
+{
+public:
+
+    /** The bounds and tolerances. This is Plain Old Data. */
+    struct Config
+    {
+        Config(double mins = 0.0001, double maxs = 0.01, double cp = 0.01,
+               double t = 0.0001, double ss = 0.5, double mg = 2.0);
+
+        /** The smallest step size; must be positive */
+        double minStepSize;
+        /** The largest step size; must not be below minStepSize */
+        double maxStepSize;
+        /**
+         * Simulated seconds in each control period; must not be below
+         * maxStepSize
+         */
+        double controlPeriod;
+        /**
+         * The largest allowed error estimate of a step, in the length
+         * units of the models. Must be positive.
+         */
+        double tolerance;
+        /** The fraction of the stability limit used; in (0, 1] */
+        double stabilitySafety;
+        /** The most the step size grows from one period to the next */
+        double maxGrowth;
+    };
+
+    /** What has been done since the last restart */
+    struct Stats
+    {
+        std::size_t periods;
+        std::size_t steps;
+        double smallestStep;
+        double largestStep;
+        /** Periods in which a body started or stopped touching */
+        std::size_t contactPeriods;
+        /** Periods whose step was set by the stability limit */
+        std::size_t stabilityLimitedPeriods;
+    };
+
+    /**
+     * @param[in] simulation with its models added; must outlive this
+     * @param[in] config the bounds and tolerances
+     * @throw std::invalid_argument if config is not valid
+     */
+    tgAdaptiveStepper(tgSimulation& simulation,
+                      const Config& config = Config());
+
+    /**
+     * Start again from minStepSize and forget the cable lengths, the
+     * contacts and the statistics. Call after resetting the simulation.
+     */
+    void restart();
+
+    /**
+     * Step the simulation over one control period.
+     * @return the step size the period was taken with
+     */
+    double stepPeriod();
+
+    /**
+     * Step control periods until at least seconds have been simulated
+     * or a predicate stops the run. onStart is called on each predicate
+     * first.
+     * @param[in] seconds the simulated time to run for
+     * @param[in] predicates not owned; checked in order after each period
+     * @return the reason of the predicate that stopped the run, or an
+     * empty string if it ran for the whole time
+     * @throw std::invalid_argument if a predicate is NULL
+     */
+    std::string run(double seconds,
+                    const std::vector<tgStopPredicate*>& predicates =
+                    std::vector<tgStopPredicate*>());
+
+    /** The step size the next period will try for */
+    double getStepSize() const
+    {
+        return m_stepSize;
+    }
+
+    /** The step size the stiffest cable allows, as of the last period */
+    double getStabilityLimit() const
+    {
+        return m_stabilityLimit;
+    }
+
+    /** Simulated seconds since the last restart */
+    double getTime() const
+    {
+        return m_time;
+    }
+
+    const Stats& getStats() const
+    {
+        return m_stats;
+    }
+
+    const Config& getConfig() const
+    {
+        return m_config;
+    }
+
+private:
+
+    /**
+     * Collect the actuators and, if they are not the ones of the last
+     * period, find the bodies they are anchored to
+     */
+    void updateActuators();
+
+    /** The stability limit from the cables' current stiffnesses */
+    double stabilityLimit();
+
+    /**
+     * Record the cable lengths after a step of dt
+     * @return the largest difference from the extrapolated lengths
+     */
+    double measureError(double dt);
+
+    /** @return true if a body started or stopped touching anything */
+    bool contactsChanged();
+
+    tgSimulation& m_simulation;
+    const Config m_config;
+
+    std::vector<tgSpringCableActuator*> m_actuators;
+    std::vector<tgSpringCableActuator*> m_collected;
+
+    /** The bodies with a cable on them */
+    std::vector<btRigidBody*> m_bodies;
+    /** Indexes into m_bodies of each actuator's two ends, or -1 */
+    std::vector<int> m_ends;
+    /** The sum of the stiffnesses on each of m_bodies */
+    std::vector<double> m_stiffness;
+
+    /** Each actuator's length two steps ago and one step ago */
+    std::vector<double> m_previousLengths;
+    std::vector<double> m_lengths;
+    /** Steps recorded in m_lengths since the last restart, up to 2 */
+    int m_lengthSteps;
+    /** The step before the last one */
+    double m_previousStep;
+
+    /** Whether each body was touching something at the last step */
+    std::vector<char> m_touching;
+    bool m_contactsKnown;
+
+    double m_stepSize;
+    double m_stabilityLimit;
+    double m_time;
+    Stats m_stats;
+};
+
+#endif  // TG_ADAPTIVE_STEPPER_H
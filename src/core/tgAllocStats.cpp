@@ -0,0 +1,536 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgAllocStats.cpp
+ * @brief Contains the definitions of members of classes tgAllocStats and
+ * tgAllocMonitor, and in the instrumented build the global operator new
+ * and delete
+ * $Id$
+ */
+
+// This module
+#include "tgAllocStats.h"
+// The C++ Standard Library
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+#ifdef NTRT_ALLOC_STATS
+// The GNU C Library
+#include <execinfo.h>
+#include <unistd.h>
+#endif
+
+#ifdef NTRT_ALLOC_STATS
+
+namespace
+{
+    /** Written with atomic adds, since any thread allocates */
+    struct Counters
+    {
+        unsigned long long allocations;
+        unsigned long long frees;
+        unsigned long long bytes;
+        long long liveBytes;
+    };
+
+    Counters counters[tgAllocStats::kTagCount];
+
+    __thread int currentTag = tgAllocStats::eOther;
+
+    int checkMode = tgAllocStats::eCheckOff;
+
+    /** A bit per tag */
+    unsigned long long checkedTags = 1ULL << tgAllocStats::eControllers;
+
+    __thread bool armed = false;
+
+    /** Set while reporting, so the report's own allocations pass */
+    __thread bool reporting = false;
+
+    unsigned long long checkFailures = 0;
+
+    /** The frames of a call site kept for its report */
+    const int kFrames = 24;
+
+    /** Hashes of the call sites reported so far, 0 for none */
+    const std::size_t kSites = 512;
+    unsigned long reportedSites[kSites];
+
+    /** Remember a call site; false if it was already reported */
+    bool addSite(unsigned long hash)
+    {
+        for (std::size_t i = 0; i < kSites; i++)
+        {
+            if (__sync_bool_compare_and_swap(&reportedSites[i], 0UL, hash))
+            {
+                return true;
+            }
+            if (reportedSites[i] == hash)
+            {
+                return false;
+            }
+        }
+        // Full: report, rather than hide, what was not seen before
+        return true;
+    }
+
+    /**
+     * Report an allocation made in a checked tag while armed, with the
+     * stack below operator new. Writes straight to the file descriptor,
+     * which does not allocate.
+     */
+    void check(int tag, std::size_t size)
+    {
+        if (!armed || reporting || checkMode == tgAllocStats::eCheckOff ||
+            (checkedTags & (1ULL << tag)) == 0)
+        {
+            return;
+        }
+        reporting = true;
+        __sync_fetch_and_add(&checkFailures, 1ULL);
+
+        void* frames[kFrames];
+        const int n = backtrace(frames, kFrames);
+        // Skip check, allocate and operator new
+        const int skip = n > 3 ? 3 : 0;
+        unsigned long hash = 5381;
+        for (int i = skip; i < n; i++)
+        {
+            hash = (hash * 33) ^ reinterpret_cast<unsigned long>(frames[i]);
+        }
+        if (addSite(hash != 0 ? hash : 1) ||
+            checkMode == tgAllocStats::eCheckAbort)
+        {
+            char line[160];
+            if (tag >= tgAllocStats::eFirstModel)
+            {
+                std::snprintf(line, sizeof(line),
+                              "tgAllocStats: %lu bytes allocated in model %d"
+                              " after the warmup, at:\n",
+                              static_cast<unsigned long>(size),
+                              tag - tgAllocStats::eFirstModel);
+            }
+            else
+            {
+                // As tagName, without making a string
+                static const char* const names[tgAllocStats::eFirstModel] =
+                    { "other", "world", "obstacles", "data managers",
+                      "controllers" };
+                std::snprintf(line, sizeof(line),
+                              "tgAllocStats: %lu bytes allocated in %s"
+                              " after the warmup, at:\n",
+                              static_cast<unsigned long>(size), names[tag]);
+            }
+            if (write(STDERR_FILENO, line, std::strlen(line)) < 0)
+            {
+                // Nowhere else to say so
+            }
+            backtrace_symbols_fd(frames + skip, n - skip, STDERR_FILENO);
+            if (checkMode == tgAllocStats::eCheckAbort)
+            {
+                std::abort();
+            }
+        }
+        reporting = false;
+    }
+
+    /**
+     * Put in front of every block, so delete knows its size and tag. Two
+     * words keep the block as aligned as malloc's.
+     */
+    union Header
+    {
+        struct
+        {
+            std::size_t size;
+            int tag;
+        } info;
+        long double align;
+    };
+
+    void* allocate(std::size_t size)
+    {
+        Header* const pHeader =
+            static_cast<Header*>(std::malloc(sizeof(Header) + size));
+        if (pHeader == NULL)
+        {
+            return NULL;
+        }
+        const int tag = currentTag;
+        pHeader->info.size = size;
+        pHeader->info.tag = tag;
+        Counters& c = counters[tag];
+        __sync_fetch_and_add(&c.allocations, 1ULL);
+        __sync_fetch_and_add(&c.bytes, static_cast<unsigned long long>(size));
+        __sync_fetch_and_add(&c.liveBytes, static_cast<long long>(size));
+        check(tag, size);
+        return pHeader + 1;
+    }
+
+    void release(void* p)
+    {
+        if (p == NULL)
+        {
+            return;
+        }
+        Header* const pHeader = static_cast<Header*>(p) - 1;
+        Counters& c = counters[pHeader->info.tag];
+        __sync_fetch_and_add(&c.frees, 1ULL);
+        __sync_fetch_and_sub(&c.liveBytes,
+                             static_cast<long long>(pHeader->info.size));
+        std::free(pHeader);
+    }
+}
+
+void* operator new(std::size_t size) throw (std::bad_alloc)
+{
+    void* const p = allocate(size);
+    if (p == NULL)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size) throw (std::bad_alloc)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) throw ()
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) throw ()
+{
+    return allocate(size);
+}
+
+void operator delete(void* p) throw ()
+{
+    release(p);
+}
+
+void operator delete[](void* p) throw ()
+{
+    release(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) throw ()
+{
+    release(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) throw ()
+{
+    release(p);
+}
+
+#endif // NTRT_ALLOC_STATS
+
+bool tgAllocStats::isEnabled()
+{
+#ifdef NTRT_ALLOC_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+tgAllocStats::Counts tgAllocStats::get(int tag)
+{
+    Counts counts;
+#ifdef NTRT_ALLOC_STATS
+    if (tag >= 0 && tag < kTagCount)
+    {
+        // Each field is read whole, though not all at one instant
+        const Counters& c = counters[tag];
+        counts.allocations = __sync_fetch_and_add(
+            const_cast<unsigned long long*>(&c.allocations), 0ULL);
+        counts.frees = __sync_fetch_and_add(
+            const_cast<unsigned long long*>(&c.frees), 0ULL);
+        counts.bytes = __sync_fetch_and_add(
+            const_cast<unsigned long long*>(&c.bytes), 0ULL);
+        counts.liveBytes = __sync_fetch_and_add(
+            const_cast<long long*>(&c.liveBytes), 0LL);
+    }
+#else
+    (void) tag;
+#endif
+    return counts;
+}
+
+tgAllocStats::Counts tgAllocStats::total()
+{
+    Counts sum;
+    for (int tag = 0; tag < kTagCount; tag++)
+    {
+        const Counts counts = get(tag);
+        sum.allocations += counts.allocations;
+        sum.frees += counts.frees;
+        sum.bytes += counts.bytes;
+        sum.liveBytes += counts.liveBytes;
+    }
+    return sum;
+}
+
+std::string tgAllocStats::tagName(int tag)
+{
+    switch (tag)
+    {
+    case eOther:
+        return "other";
+    case eWorld:
+        return "world";
+    case eObstacles:
+        return "obstacles";
+    case eDataManagers:
+        return "data managers";
+    case eControllers:
+        return "controllers";
+    default:
+        {
+            std::ostringstream name;
+            name << "model " << tag - eFirstModel;
+            if (tag == kTagCount - 1)
+            {
+                name << " and after";
+            }
+            return name.str();
+        }
+    }
+}
+
+int tgAllocStats::setCurrentTag(int tag)
+{
+#ifdef NTRT_ALLOC_STATS
+    const int previous = currentTag;
+    currentTag = tag >= 0 && tag < kTagCount ? tag : eOther;
+    return previous;
+#else
+    (void) tag;
+    return eOther;
+#endif
+}
+
+void tgAllocStats::setCheckMode(CheckMode mode)
+{
+#ifdef NTRT_ALLOC_STATS
+    checkMode = mode;
+#else
+    (void) mode;
+#endif
+}
+
+tgAllocStats::CheckMode tgAllocStats::getCheckMode()
+{
+#ifdef NTRT_ALLOC_STATS
+    return static_cast<CheckMode>(checkMode);
+#else
+    return eCheckOff;
+#endif
+}
+
+void tgAllocStats::setChecked(int tag, bool checked)
+{
+#ifdef NTRT_ALLOC_STATS
+    if (tag >= 0 && tag < kTagCount)
+    {
+        if (checked)
+        {
+            checkedTags |= 1ULL << tag;
+        }
+        else
+        {
+            checkedTags &= ~(1ULL << tag);
+        }
+    }
+#else
+    (void) tag;
+    (void) checked;
+#endif
+}
+
+void tgAllocStats::setArmed(bool on)
+{
+#ifdef NTRT_ALLOC_STATS
+    armed = on;
+#else
+    (void) on;
+#endif
+}
+
+unsigned long long tgAllocStats::getCheckFailures()
+{
+#ifdef NTRT_ALLOC_STATS
+    return __sync_fetch_and_add(&checkFailures, 0ULL);
+#else
+    return 0;
+#endif
+}
+
+tgAllocMonitor::tgAllocMonitor(unsigned long warmupSteps,
+                               unsigned long sampleInterval) :
+    m_warmupSteps(warmupSteps),
+    m_sampleInterval(sampleInterval > 0 ? sampleInterval : 1)
+{
+    clear();
+    const char* const check = std::getenv("NTRT_ALLOC_CHECK");
+    if (check != NULL && std::strcmp(check, "report") == 0)
+    {
+        tgAllocStats::setCheckMode(tgAllocStats::eCheckReport);
+    }
+    else if (check != NULL && std::strcmp(check, "abort") == 0)
+    {
+        tgAllocStats::setCheckMode(tgAllocStats::eCheckAbort);
+    }
+}
+
+void tgAllocMonitor::beginStep()
+{
+    if (!tgAllocStats::isEnabled())
+    {
+        return;
+    }
+    for (int tag = 0; tag < tgAllocStats::kTagCount; tag++)
+    {
+        m_before[tag] = tgAllocStats::get(tag).allocations;
+    }
+    // The step about to be counted is past the warmup
+    tgAllocStats::setArmed(m_steps >= m_warmupEnd);
+}
+
+void tgAllocMonitor::endStep()
+{
+    if (!tgAllocStats::isEnabled())
+    {
+        return;
+    }
+    tgAllocStats::setArmed(false);
+    // Read everything before this allocates anything itself
+    unsigned long long during[tgAllocStats::kTagCount];
+    unsigned long long stepAllocations = 0;
+    for (int tag = 0; tag < tgAllocStats::kTagCount; tag++)
+    {
+        during[tag] = tgAllocStats::get(tag).allocations - m_before[tag];
+        stepAllocations += during[tag];
+    }
+    m_steps++;
+
+    for (int tag = 0; tag < tgAllocStats::kTagCount; tag++)
+    {
+        m_inSteps[tag] += during[tag];
+    }
+    if (m_steps > m_warmupEnd && stepAllocations > 0)
+    {
+        if (m_steadySteps == 0)
+        {
+            std::cerr << "tgAllocMonitor: step " << m_steps
+                      << " allocated after the warmup:";
+            for (int tag = 0; tag < tgAllocStats::kTagCount; tag++)
+            {
+                if (during[tag] > 0)
+                {
+                    std::cerr << " " << tgAllocStats::tagName(tag) << " "
+                              << during[tag];
+                }
+            }
+            std::cerr << std::endl;
+        }
+        m_steadyAllocations += stepAllocations;
+        m_steadySteps++;
+    }
+    if (m_steps % m_sampleInterval == 0)
+    {
+        Sample sample;
+        sample.step = m_steps;
+        sample.liveBytes = tgAllocStats::total().liveBytes;
+        m_samples.push_back(sample);
+    }
+}
+
+void tgAllocMonitor::clear()
+{
+    m_steps = 0;
+    m_warmupEnd = m_warmupSteps;
+    for (int tag = 0; tag < tgAllocStats::kTagCount; tag++)
+    {
+        m_before[tag] = 0;
+        m_inSteps[tag] = 0;
+    }
+    m_steadyAllocations = 0;
+    m_steadySteps = 0;
+    m_samples.clear();
+}
+
+void tgAllocMonitor::write(std::ostream& os) const
+{
+    if (!tgAllocStats::isEnabled())
+    {
+        os << "tgAllocMonitor: configure with -DNTRT_ALLOC_STATS=ON to "
+           << "count allocations" << std::endl;
+        return;
+    }
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+
+    os << "tgAllocMonitor: " << m_steps << " steps, "
+       << m_steadyAllocations << " allocations in " << m_steadySteps
+       << " steps after warming up" << std::endl;
+    if (tgAllocStats::getCheckMode() != tgAllocStats::eCheckOff)
+    {
+        os << "  " << tgAllocStats::getCheckFailures()
+           << " allocations in checked tags" << std::endl;
+    }
+    os << "  " << std::left << std::setw(24) << "" << std::right
+       << std::setw(14) << "allocs/step" << std::setw(16) << "live bytes"
+       << std::setw(16) << "bytes" << std::endl;
+    for (int tag = 0; tag < tgAllocStats::kTagCount; tag++)
+    {
+        const tgAllocStats::Counts counts = tgAllocStats::get(tag);
+        if (counts.allocations == 0)
+        {
+            continue;
+        }
+        os << "  " << std::left << std::setw(24) << tgAllocStats::tagName(tag)
+           << std::right << std::setw(14) << std::fixed
+           << std::setprecision(3)
+           << (m_steps > 0 ? double(m_inSteps[tag]) / m_steps : 0.0)
+           << std::setw(16) << counts.liveBytes
+           << std::setw(16) << counts.bytes << std::endl;
+    }
+    if (!m_samples.empty())
+    {
+        os << "  live bytes by step:";
+        for (std::size_t i = 0; i < m_samples.size(); i++)
+        {
+            os << " " << m_samples[i].step << ":" << m_samples[i].liveBytes;
+        }
+        os << std::endl;
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
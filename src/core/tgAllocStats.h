@@ -0,0 +1,262 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_ALLOC_STATS_H
+#define TG_ALLOC_STATS_H
+
+/**
+ * @file tgAllocStats.h
+ * @brief Contains the definitions of classes tgAllocStats and
+ * tgAllocMonitor
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/**
+ * Counts of heap allocations by tag, for finding memory growth and
+ * allocation in the step loop. Only counted in the instrumented build,
+ * configured with -DNTRT_ALLOC_STATS=ON, which replaces the global
+ * operator new and delete in the core library; otherwise the counts stay
+ * at zero and Scope costs nothing.
+ *
+ * Each allocation is charged to the tag of the innermost Scope on its
+ * thread, and its bytes stay live under that tag until freed, wherever
+ * that happens. tgSimulation::step tags the world, each of its models
+ * with its descendants, the obstacles and the data managers, and
+ * tgSubject::notifyStep tags the observers it steps as controllers.
+ *
+ * Allocations can also be checked as they happen: once a tgAllocMonitor
+ * is past its warmup, an allocation charged to a checked tag, by
+ * default only eControllers, is reported on standard error with the
+ * stack of its call site, once per call site, or aborts the program, as
+ * set by setCheckMode or the NTRT_ALLOC_CHECK environment variable
+ * ("report" or "abort"). Link with -rdynamic for function names in the
+ * stacks.
+ */
+class tgAllocStats
+{
+public:
+
+    /** The tags; a model's is modelTag(index) */
+    enum Tag
+    {
+        /** Outside any Scope */
+        eOther,
+        eWorld,
+        eObstacles,
+        eDataManagers,
+        /** tgObserver::onStep, wherever it is called from */
+        eControllers,
+        eFirstModel,
+        /** Models past the last tag share it */
+        kTagCount = 64
+    };
+
+    struct Counts
+    {
+        Counts() : allocations(0), frees(0), bytes(0), liveBytes(0) { }
+
+        unsigned long long allocations;
+        unsigned long long frees;
+        /** Allocated in all */
+        unsigned long long bytes;
+        /** Allocated and not yet freed */
+        long long liveBytes;
+    };
+
+    /** What an allocation in a checked tag does */
+    enum CheckMode
+    {
+        eCheckOff,
+        /** Report each call site once on standard error */
+        eCheckReport,
+        /** Report the call site, then abort */
+        eCheckAbort
+    };
+
+    /** Charges allocations on this thread to a tag while in scope */
+    class Scope
+    {
+    public:
+        explicit Scope(int tag)
+#ifdef NTRT_ALLOC_STATS
+            : m_previous(setCurrentTag(tag))
+#endif
+        {
+            (void) tag;
+        }
+
+        ~Scope()
+        {
+#ifdef NTRT_ALLOC_STATS
+            setCurrentTag(m_previous);
+#endif
+        }
+
+    private:
+#ifdef NTRT_ALLOC_STATS
+        const int m_previous;
+#endif
+    };
+
+    /** Whether this is the instrumented build */
+    static bool isEnabled();
+
+    static int modelTag(std::size_t index)
+    {
+        return index < kTagCount - eFirstModel ?
+            static_cast<int>(eFirstModel + index) : kTagCount - 1;
+    }
+
+    /** The counts of one tag since the program started */
+    static Counts get(int tag);
+
+    /** The counts of all the tags */
+    static Counts total();
+
+    /** The name of a tag, e.g. "world" or "model 2" */
+    static std::string tagName(int tag);
+
+    /**
+     * Make a tag current on this thread.
+     * @return the tag that was current
+     */
+    static int setCurrentTag(int tag);
+
+    static void setCheckMode(CheckMode mode);
+
+    static CheckMode getCheckMode();
+
+    /** Whether allocations charged to a tag are checked */
+    static void setChecked(int tag, bool checked);
+
+    /**
+     * Check allocations on this thread, or stop. tgAllocMonitor arms
+     * the checks for each step after its warmup.
+     */
+    static void setArmed(bool armed);
+
+    /** The allocations the checks have caught since the program started */
+    static unsigned long long getCheckFailures();
+};
+
+/**
+ * Follows tgAllocStats over the steps of a tgSimulation: allocations per
+ * step by tag, and the live bytes every sampleInterval steps. Every
+ * allocation in a step after the warmup is counted as a steady state
+ * allocation, and the first such step is reported on std::cerr. Arms
+ * tgAllocStats' checks for the steps after the warmup. Does nothing
+ * unless tgAllocStats::isEnabled().
+ */
+class tgAllocMonitor
+{
+public:
+
+    /** The live bytes after a step */
+    struct Sample
+    {
+        unsigned long step;
+        long long liveBytes;
+    };
+
+    /**
+     * @param[in] warmupSteps steps in which allocating is expected, as
+     * pools, caches and histories fill
+     * @param[in] sampleInterval steps between live byte samples; must be
+     * positive
+     */
+    tgAllocMonitor(unsigned long warmupSteps = 1000,
+                   unsigned long sampleInterval = 100);
+
+    void setWarmupSteps(unsigned long warmupSteps)
+    {
+        m_warmupSteps = warmupSteps;
+        m_warmupEnd = m_steps + warmupSteps;
+    }
+
+    /** Expect allocation again for a warmup, e.g. after a reset */
+    void restartWarmup()
+    {
+        m_warmupEnd = m_steps + m_warmupSteps;
+    }
+
+    void beginStep();
+
+    void endStep();
+
+    unsigned long getStepCount() const
+    {
+        return m_steps;
+    }
+
+    /** Allocations within steps after the warmup */
+    unsigned long long getSteadyStateAllocations() const
+    {
+        return m_steadyAllocations;
+    }
+
+    /** Steps after the warmup that allocated */
+    unsigned long getSteadyStateSteps() const
+    {
+        return m_steadySteps;
+    }
+
+    const std::vector<Sample>& getLiveBytes() const
+    {
+        return m_samples;
+    }
+
+    /** Forget the steps, e.g. after the simulation was reset */
+    void clear();
+
+    /**
+     * Write the allocations per step and the live bytes by tag, then the
+     * live byte samples.
+     */
+    void write(std::ostream& os) const;
+
+private:
+
+    unsigned long m_warmupSteps;
+
+    unsigned long m_sampleInterval;
+
+    unsigned long m_steps;
+
+    /** The last step of the current warmup */
+    unsigned long m_warmupEnd;
+
+    /** The allocations of each tag when the step began */
+    unsigned long long m_before[tgAllocStats::kTagCount];
+
+    /** Allocations of each tag within steps */
+    unsigned long long m_inSteps[tgAllocStats::kTagCount];
+
+    unsigned long long m_steadyAllocations;
+
+    unsigned long m_steadySteps;
+
+    std::vector<Sample> m_samples;
+};
+
+#endif  // TG_ALLOC_STATS_H
@@ -26,6 +26,7 @@
 // This module
 #include "tgBaseRigid.h"
 #include "tgModelVisitor.h"
+#include "tgRigidStateFrame.h"
 // The Bullet Physics library
 #include "BulletDynamics/Dynamics/btRigidBody.h"
 #include "btBulletDynamicsCommon.h"
@@ -71,8 +72,50 @@ void tgBaseRigid::teardown()
   // This does not preserve the invariant
 }
 
+void tgBaseRigid::setMass(double mass)
+{
+    if (mass <= 0.0) { throw std::range_error("Non-positive mass"); }
+    if (m_mass <= 0.0)
+    {
+        throw std::invalid_argument("Cannot change the mass of a static body");
+    }
+
+    // Scale the inertia with the mass, as a change of density would
+    const btVector3& invInertia = m_pRigidBody->getInvInertiaDiagLocal();
+    const double ratio = mass / m_mass;
+    const btVector3 inertia(
+        invInertia.x() > 0.0 ? ratio / invInertia.x() : 0.0,
+        invInertia.y() > 0.0 ? ratio / invInertia.y() : 0.0,
+        invInertia.z() > 0.0 ? ratio / invInertia.z() : 0.0);
+    m_pRigidBody->setMassProps(mass, inertia);
+    m_pRigidBody->updateInertiaTensor();
+    m_mass = mass;
+
+    // Postcondition
+    assert(invariant());
+}
+
+void tgBaseRigid::setSurface(double friction, double rollFriction, double restitution)
+{
+    if (friction < 0.0)  { throw std::range_error("Negative friction");  }
+    if (rollFriction < 0.0)  { throw std::range_error("Negative roll friction");  }
+    if (restitution < 0.0)  { throw std::range_error("Negative restitution");  }
+    if (restitution > 1.0)  { throw std::range_error("Restitution > 1");  }
+
+    m_pRigidBody->setFriction(friction);
+    m_pRigidBody->setRollingFriction(rollFriction);
+    m_pRigidBody->setRestitution(restitution);
+}
+
 btVector3 tgBaseRigid::centerOfMass() const
 {
+  const tgRigidStateFrame::RigidState* const pState =
+    tgRigidStateFrame::find(m_pRigidBody);
+  if (pState != NULL)
+  {
+    return pState->transform.getOrigin();
+  }
+
   // Precondition
   assert(m_pRigidBody->getMotionState() != NULL);
 
@@ -89,6 +132,13 @@ btVector3 tgBaseRigid::orientation() const
   //Precondition
   assert(invariant());
 
+  const tgRigidStateFrame::RigidState* const pState =
+    tgRigidStateFrame::find(m_pRigidBody);
+  if (pState != NULL)
+  {
+    return pState->eulerYPR;
+  }
+
   // get the orientation of this rod w.r.t. the world's refernce coorinate system
   // oddly enough, there isn't a getEuler method for btQuaternion, which is
   // returned by getOrientation from RigidBody, so convert it
@@ -98,8 +148,21 @@ btVector3 tgBaseRigid::orientation() const
   btScalar pitch = 0.0;
   btScalar roll = 0.0;
   rot.getEulerYPR(yaw, pitch, roll);
-  btVector3 *result = new btVector3(yaw, pitch, roll);
-  return *result;
+  return btVector3(yaw, pitch, roll);
+}
+
+btVector3 tgBaseRigid::linearVelocity() const
+{
+  const tgRigidStateFrame::RigidState* const pState =
+    tgRigidStateFrame::find(m_pRigidBody);
+  return pState != NULL ? pState->linearVelocity : m_pRigidBody->getLinearVelocity();
+}
+
+btVector3 tgBaseRigid::angularVelocity() const
+{
+  const tgRigidStateFrame::RigidState* const pState =
+    tgRigidStateFrame::find(m_pRigidBody);
+  return pState != NULL ? pState->angularVelocity : m_pRigidBody->getAngularVelocity();
 }
 
 bool tgBaseRigid::invariant() const
@@ -65,11 +65,22 @@ public:
     virtual double mass() const { return m_mass; }
     
     /**
-     * Return the center of mass of the rod, a vector in 3-space.
+     * Return the center of mass of the rod, a vector in 3-space. Read
+     * from the world's tgRigidStateFrame once the world has stepped.
      * @return the center of mass of the rod, a vector in 3-space
      */
     virtual btVector3 centerOfMass() const;
 
+    /**
+     * Return the velocity of the center of mass, as for centerOfMass.
+     */
+    btVector3 linearVelocity() const;
+
+    /**
+     * Return the angular velocity, as for centerOfMass.
+     */
+    btVector3 angularVelocity() const;
+
     /**
      * Getter for rigid body
      */
@@ -79,11 +90,30 @@ public:
     }
 
     /**
-     * Return the rod's orientation in Euler angles.
+     * Return the rod's orientation in Euler angles, as for centerOfMass.
      * @return 3-vector of these euler angles
      */
     virtual btVector3 orientation() const;
 
+    /**
+     * Change the mass of the live rigid body, scaling its inertia by
+     * the same factor, without removing it from the world. Meant for
+     * after tgSimulation::restore, between trials. Rigids in one
+     * compound share a body, so this sets the mass of the whole
+     * compound.
+     * @param[in] mass must be positive
+     * @throw std::range_error if mass is not positive
+     * @throw std::invalid_argument if the body is static
+     */
+    void setMass(double mass);
+
+    /**
+     * Change the contact properties of the live rigid body, with the
+     * same limits as tgRod::Config.
+     * @throw std::range_error if a value is out of range
+     */
+    void setSurface(double friction, double rollFriction, double restitution);
+
 protected:
 	// Virtual base class
 	tgBaseRigid(btRigidBody* pRigidBody,
@@ -102,7 +132,7 @@ protected:
     btRigidBody* m_pRigidBody;
     
     /** The rod's mass. The units are application dependent. */
-    const double m_mass;
+    double m_mass;
     
 };
 
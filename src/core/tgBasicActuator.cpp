@@ -26,6 +26,7 @@
 // This Module
 #include "tgBulletSpringCable.h"
 #include "tgBasicActuator.h"
+#include "tgCablePipeline.h"
 #include "tgModelVisitor.h"
 #include "tgWorld.h"
 // The Bullet Physics Library
@@ -39,6 +40,14 @@
 
 using namespace std;
 
+namespace
+{
+    typedef tgCablePipeline<tgLinearTensionLaw, tgRateLimitedMotor,
+                            tgNoHistory> Pipeline;
+    typedef tgCablePipeline<tgLinearTensionLaw, tgRateLimitedMotor,
+                            tgFullHistory> HistoryPipeline;
+}
+
 void tgBasicActuator::constructorAux()
 {
   // Precondition
@@ -95,23 +104,28 @@ void tgBasicActuator::teardown()
     
 void tgBasicActuator::step(double dt) 
 {
-#ifndef BT_NO_PROFILE 
-    BT_PROFILE("tgBasicActuator::step");
-#endif //BT_NO_PROFILE   	
     if (dt <= 0.0)
     {
         throw std::invalid_argument("dt is not positive.");
     }
     else
     {   
-        // Want to update any controls before applying forces
-        notifyStep(dt); 
-        m_springCable->step(dt);
-        logHistory();  
+        stepActuator(dt);
         tgModel::step(dt);
     }
 }
 
+void tgBasicActuator::stepActuator(double dt)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgBasicActuator::step");
+#endif //BT_NO_PROFILE   	
+    // Want to update any controls before applying forces
+    notifyStep(dt); 
+    m_springCable->step(dt);
+    logHistory();  
+}
+
 void tgBasicActuator::onVisit(const tgModelVisitor& r) const
 {
 #ifndef BT_NO_PROFILE 
@@ -122,16 +136,18 @@ void tgBasicActuator::onVisit(const tgModelVisitor& r) const
     
 void tgBasicActuator::logHistory()
 {
-    m_prevVelocity = m_springCable->getVelocity();
+    const tgCableSample sample = Pipeline::sample(*m_springCable);
+    m_prevVelocity = sample.velocity;
 
     if (m_config.hist)
     {
-        m_pHistory->lastLengths.push_back(m_springCable->getActualLength());
-        m_pHistory->lastVelocities.push_back(m_springCable->getVelocity());
-        m_pHistory->dampingHistory.push_back(m_springCable->getDamping());
-        m_pHistory->restLengths.push_back(m_springCable->getRestLength());
-        m_pHistory->tensionHistory.push_back(m_springCable->getTension());
+        HistoryPipeline::log(sample, m_stats, *m_pHistory);
+    }
+    else
+    {
+        Pipeline::log(sample, m_stats, *m_pHistory);
     }
+    raiseEvents();
 }
 
 void tgBasicActuator::setControlInput(double input)
@@ -169,59 +185,55 @@ void tgBasicActuator::setControlInput(double input, double dt)
 
 void tgBasicActuator::moveMotors(double dt)
 {
-    // @todo add functions from muscle2P Bounded
-    
-    
     const double stiffness = m_springCable->getCoefK();
     // @todo: write invariant that checks this;
     assert(stiffness > 0.0);
+
+    m_restLength = Pipeline::move(m_config, stiffness,
+                                  m_springCable->getActualLength(),
+                                  m_restLength, m_preferredLength, dt);
+    m_springCable->setRestLength(m_restLength);
+}
+
+void tgBasicActuator::setParameters(const tgSpringCableActuator::Config& config)
+{
+    tgSpringCableActuator::setParameters(config);
+    m_preferredLength = m_restLength;
     
-    // Reverse the sign if restLength >= preferredLength
-    // Velocity limiter
-    double stepSize = m_config.targetVelocity * dt;
-    const double actualLength = m_springCable->getActualLength(); 
-    
-    // First, change preferred length so we don't go over max tension
-    if ((actualLength - m_preferredLength) * stiffness
-            > m_config.maxTens)
-    {
-        m_preferredLength = actualLength - m_config.maxTens / stiffness;
-    }
-    
-    double diff =  m_preferredLength - m_restLength;
-    const double fabsDiff = abs(diff);
-    
-    /*
-     * actualLength must be greater than minActualLength to shorten
-     * diff > 0 means can always lengthen.
-     */
-    if ((actualLength > m_config.minActualLength) || 
-    (diff > 0))
-    {
-        if (abs(diff) > stepSize)
-        {      
-          m_restLength += (diff/fabsDiff)*stepSize;
-        }
-        else
-        {
-            m_restLength += diff;
-        }
-    }
-    
-     m_restLength =
-      (m_restLength > m_config.minRestLength) ? m_restLength : m_config.minRestLength;
-     #if (0)
-     std::cout << "RL: " << m_restLength << " M2P RL: " << m_springCable->getRestLength() << std::endl;
-     
-     
-     std::cout  << "RL: " << m_restLength
-     << " Vel: " << (m_restLength  -m_springCable->getRestLength()) / dt 
-     << " prev Vel: " << prevVel
-     << " force " << (actualLength - m_restLength)*stiffness << std::endl;
-     prevVel = (m_restLength  -m_springCable->getRestLength()) / dt ;
-     #endif
-     m_springCable->setRestLength(m_restLength);
-    
+    // Postcondition
+    assert(invariant());
+}
+
+void tgBasicActuator::saveState(std::vector<double>& state) const
+{
+    tgSpringCableActuator::saveState(state);
+    state.push_back(prevVel);
+    state.push_back(m_preferredLength);
+}
+
+std::size_t tgBasicActuator::restoreState(const std::vector<double>& state, std::size_t pos)
+{
+    pos = tgSpringCableActuator::restoreState(state, pos);
+    assert(pos + 2 <= state.size());
+    prevVel = state[pos++];
+    m_preferredLength = state[pos++];
+    return pos;
+}
+
+void tgBasicActuator::saveCommand(std::vector<double>& command) const
+{
+    command.push_back(m_preferredLength);
+    command.push_back(m_restLength);
+}
+
+std::size_t tgBasicActuator::restoreCommand(const std::vector<double>& command,
+                                            std::size_t pos)
+{
+    assert(pos + 2 <= command.size());
+    m_preferredLength = command[pos++];
+    m_restLength = command[pos++];
+    m_springCable->setRestLength(m_restLength);
+    return pos;
 }
 
 bool tgBasicActuator::invariant() const
@@ -107,10 +107,50 @@ public:
      * @param[in] dt, time elapsed since last call.
      */
     virtual void moveMotors(double dt);
+    
+    /**
+     * Also moves the preferred length to the new starting rest length,
+     * so the motor holds it.
+     * @see tgSpringCableActuator::setParameters
+     */
+    virtual void setParameters(const tgSpringCableActuator::Config& config);
+    
+    /**
+     * Adds the preferred length to tgSpringCableActuator::saveState
+     * @param[in,out] state the values are appended to this
+     */
+    virtual void saveState(std::vector<double>& state) const;
+    
+    /**
+     * Reads back what saveState wrote
+     * @param[in] state as filled by saveState
+     * @param[in] pos the index of this actuator's first value
+     * @return the index just past this actuator's values
+     */
+    virtual std::size_t restoreState(const std::vector<double>& state, std::size_t pos);
+
+    /**
+     * The preferred length and, since setControlInput(input, dt) moves
+     * the motors at once, the rest length.
+     */
+    virtual void saveCommand(std::vector<double>& command) const;
+
+    /** Set both lengths, the spring cable's rest length too */
+    virtual std::size_t restoreCommand(const std::vector<double>& command,
+                                       std::size_t pos);
 
 
 private:
 
+    /** tgStepPlan calls stepActuator directly */
+    friend class tgStepPlan;
+
+    /**
+     * Everything step does except checking dt and stepping children.
+     * @param[in] dt, must be positive
+     */
+    void stepActuator(double dt);
+
     /**
      * Helper function to perform what is in common to all constructor bodies.
      */
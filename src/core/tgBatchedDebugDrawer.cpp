@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBatchedDebugDrawer.cpp
+ * @brief Contains the definitions of members of class tgBatchedDebugDrawer
+ * $Id$
+ */
+
+// This module
+#include "tgBatchedDebugDrawer.h"
+// Bullet OpenGL_FreeGlut (patched files)
+#include "tgGlutStuff.h"
+
+tgBatchedDebugDrawer::tgBatchedDebugDrawer(btIDebugDraw& target) :
+m_target(target)
+{
+}
+
+void tgBatchedDebugDrawer::flush()
+{
+    if (m_vertices.empty())
+    {
+        return;
+    }
+    
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, &m_vertices[0]);
+    glColorPointer(3, GL_FLOAT, 0, &m_colors[0]);
+    glDrawArrays(GL_LINES, 0, m_vertices.size() / 3);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    
+    // Keep the storage for the next frame
+    m_vertices.clear();
+    m_colors.clear();
+}
+
+void tgBatchedDebugDrawer::drawLine(const btVector3& from,
+                                    const btVector3& to,
+                                    const btVector3& color)
+{
+    addVertex(from, color);
+    addVertex(to, color);
+}
+
+void tgBatchedDebugDrawer::drawLine(const btVector3& from,
+                                    const btVector3& to,
+                                    const btVector3& fromColor,
+                                    const btVector3& toColor)
+{
+    addVertex(from, fromColor);
+    addVertex(to, toColor);
+}
+
+void tgBatchedDebugDrawer::drawContactPoint(const btVector3& pointOnB,
+                                            const btVector3& normalOnB,
+                                            btScalar distance,
+                                            int lifeTime,
+                                            const btVector3& color)
+{
+    m_target.drawContactPoint(pointOnB, normalOnB, distance, lifeTime, color);
+}
+
+void tgBatchedDebugDrawer::reportErrorWarning(const char* warningString)
+{
+    m_target.reportErrorWarning(warningString);
+}
+
+void tgBatchedDebugDrawer::draw3dText(const btVector3& location,
+                                      const char* textString)
+{
+    m_target.draw3dText(location, textString);
+}
+
+void tgBatchedDebugDrawer::setDebugMode(int debugMode)
+{
+    m_target.setDebugMode(debugMode);
+}
+
+int tgBatchedDebugDrawer::getDebugMode() const
+{
+    return m_target.getDebugMode();
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_BATCHED_DEBUG_DRAWER_H
+#define TG_BATCHED_DEBUG_DRAWER_H
+
+/**
+ * @file tgBatchedDebugDrawer.h
+ * @brief Contains the definition of class tgBatchedDebugDrawer
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btIDebugDraw.h"
+// The C++ Standard Library
+#include <vector>
+
+/**
+ * A debug drawer that collects lines into one vertex array and draws
+ * them with a single glDrawArrays, rather than a glBegin/glEnd per line.
+ * Used by tgSimViewGraphics in front of its tgGLDebugDrawer, so that
+ * the cables tgBulletRenderer draws cost one call per frame. Spheres use
+ * btIDebugDraw's wireframe, so they are batched too. Everything other
+ * than lines goes straight to the wrapped drawer.
+ */
+class tgBatchedDebugDrawer : public btIDebugDraw
+{
+public:
+
+    /**
+     * @param[in] target draws what is not batched; not owned
+     */
+    tgBatchedDebugDrawer(btIDebugDraw& target);
+
+    virtual ~tgBatchedDebugDrawer() { }
+
+    /**
+     * Draw and forget the lines collected since the last flush. Needs a
+     * current OpenGL context.
+     */
+    void flush();
+
+    /** The number of lines waiting for flush */
+    std::size_t size() const
+    {
+        return m_vertices.size() / 6;
+    }
+
+    /** @name btIDebugDraw */
+    /** @{ */
+    virtual void drawLine(const btVector3& from,
+                          const btVector3& to,
+                          const btVector3& color);
+
+    virtual void drawLine(const btVector3& from,
+                          const btVector3& to,
+                          const btVector3& fromColor,
+                          const btVector3& toColor);
+
+    virtual void drawContactPoint(const btVector3& pointOnB,
+                                  const btVector3& normalOnB,
+                                  btScalar distance,
+                                  int lifeTime,
+                                  const btVector3& color);
+
+    virtual void reportErrorWarning(const char* warningString);
+
+    virtual void draw3dText(const btVector3& location, const char* textString);
+
+    virtual void setDebugMode(int debugMode);
+
+    virtual int getDebugMode() const;
+    /** @} */
+
+private:
+
+    void addVertex(const btVector3& position, const btVector3& color)
+    {
+        m_vertices.push_back(position.x());
+        m_vertices.push_back(position.y());
+        m_vertices.push_back(position.z());
+        m_colors.push_back(color.x());
+        m_colors.push_back(color.y());
+        m_colors.push_back(color.z());
+    }
+
+    btIDebugDraw& m_target;
+
+    /** x, y, z of each line end */
+    std::vector<float> m_vertices;
+
+    /** r, g, b of each line end */
+    std::vector<float> m_colors;
+};
+
+#endif  // TG_BATCHED_DEBUG_DRAWER_H
@@ -0,0 +1,216 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgBuildProfile.cpp
+ * @brief Contains the definitions of members of class tgBuildProfile
+ * $Id$
+ */
+
+// This module
+#include "tgBuildProfile.h"
+// The C++ Standard Library
+#include <cstdlib>
+#include <cxxabi.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+// POSIX
+#include <pthread.h>
+#include <time.h>
+
+namespace
+{
+    struct Entry
+    {
+        const char* phase;
+        std::string key;
+        unsigned long calls;
+        double seconds;
+    };
+
+    /**
+     * The times, and the report at exit. Models may be built on several
+     * threads, e.g. by tgParallelSimulation, so it has a lock.
+     */
+    class Profile
+    {
+    public:
+        Profile() : enabled(-1)
+        {
+            pthread_mutex_init(&mutex, NULL);
+        }
+
+        ~Profile()
+        {
+            if (enabled == 1 && !entries.empty())
+            {
+                const char* const target = std::getenv("NTRT_BUILD_PROFILE");
+                if (target == NULL || std::string(target) == "1")
+                {
+                    tgBuildProfile::write(std::cerr);
+                }
+                else
+                {
+                    std::ofstream file(target);
+                    tgBuildProfile::write(file);
+                }
+            }
+            pthread_mutex_destroy(&mutex);
+        }
+
+        /** -1 until decided */
+        int enabled;
+        std::vector<Entry> entries;
+        pthread_mutex_t mutex;
+    };
+
+    Profile& profile()
+    {
+        static Profile instance;
+        return instance;
+    }
+}
+
+tgBuildProfile::Scope::Scope(const char* phase) :
+    m_phase(phase),
+    m_pType(NULL),
+    m_start(isEnabled() ? now() : 0.0)
+{
+}
+
+tgBuildProfile::Scope::Scope(const char* phase, const std::string& key) :
+    m_phase(phase),
+    m_pType(NULL),
+    m_key(key),
+    m_start(isEnabled() ? now() : 0.0)
+{
+}
+
+tgBuildProfile::Scope::Scope(const char* phase, const std::type_info& type) :
+    m_phase(phase),
+    m_pType(&type),
+    m_start(isEnabled() ? now() : 0.0)
+{
+}
+
+tgBuildProfile::Scope::~Scope()
+{
+    if (m_start > 0.0)
+    {
+        const double seconds = now() - m_start;
+        add(m_phase, m_pType != NULL ? typeName(*m_pType) : m_key, seconds);
+    }
+}
+
+bool tgBuildProfile::isEnabled()
+{
+    Profile& p = profile();
+    if (p.enabled < 0)
+    {
+        const char* const value = std::getenv("NTRT_BUILD_PROFILE");
+        p.enabled = value != NULL && *value != '\0' &&
+            std::string(value) != "0" ? 1 : 0;
+    }
+    return p.enabled == 1;
+}
+
+void tgBuildProfile::setEnabled(bool enabled)
+{
+    profile().enabled = enabled ? 1 : 0;
+}
+
+void tgBuildProfile::add(const char* phase, const std::string& key,
+                         double seconds)
+{
+    Profile& p = profile();
+    pthread_mutex_lock(&p.mutex);
+    std::size_t i = 0;
+    while (i < p.entries.size() &&
+           !(p.entries[i].key == key &&
+             std::string(p.entries[i].phase) == phase))
+    {
+        i++;
+    }
+    if (i == p.entries.size())
+    {
+        Entry entry;
+        entry.phase = phase;
+        entry.key = key;
+        entry.calls = 0;
+        entry.seconds = 0.0;
+        p.entries.push_back(entry);
+    }
+    p.entries[i].calls++;
+    p.entries[i].seconds += seconds;
+    pthread_mutex_unlock(&p.mutex);
+}
+
+void tgBuildProfile::write(std::ostream& os)
+{
+    Profile& p = profile();
+    pthread_mutex_lock(&p.mutex);
+    const std::vector<Entry> entries = p.entries;
+    pthread_mutex_unlock(&p.mutex);
+
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << "tgBuildProfile" << std::endl;
+    os << "  " << std::left << std::setw(56) << "phase / key" << std::right
+       << std::setw(8) << "calls" << std::setw(14) << "total ms"
+       << std::setw(12) << "mean ms" << std::endl;
+    for (std::size_t i = 0; i < entries.size(); i++)
+    {
+        const Entry& e = entries[i];
+        const std::string name = e.key.empty() ?
+            std::string(e.phase) : std::string(e.phase) + " / " + e.key;
+        os << "  " << std::left << std::setw(56) << name << std::right
+           << std::setw(8) << e.calls << std::fixed << std::setprecision(3)
+           << std::setw(14) << e.seconds * 1e3
+           << std::setw(12) << e.seconds * 1e3 / e.calls << std::endl;
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+void tgBuildProfile::clear()
+{
+    Profile& p = profile();
+    pthread_mutex_lock(&p.mutex);
+    p.entries.clear();
+    pthread_mutex_unlock(&p.mutex);
+}
+
+std::string tgBuildProfile::typeName(const std::type_info& type)
+{
+    int status = 0;
+    char* const demangled =
+        abi::__cxa_demangle(type.name(), NULL, NULL, &status);
+    const std::string name = status == 0 ? demangled : type.name();
+    std::free(demangled);
+    return name;
+}
+
+double tgBuildProfile::now()
+{
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
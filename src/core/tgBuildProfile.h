@@ -0,0 +1,96 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_BUILD_PROFILE_H
+#define TG_BUILD_PROFILE_H
+
+/**
+ * @file tgBuildProfile.h
+ * @brief Contains the definition of class tgBuildProfile
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <iosfwd>
+#include <string>
+#include <typeinfo>
+
+/**
+ * Where the time goes while models are built: the YAML structure, the
+ * tgStructureInfo tree, matching the tgBuildSpec agents, tgRigidAutoCompound,
+ * creating the Bullet bodies and the connectors, creating the models and
+ * tgModel::setup, each broken down by builder where that applies.
+ *
+ * Off unless the environment variable NTRT_BUILD_PROFILE is set when the
+ * first scope is made, or setEnabled(true) is called. The report is then
+ * written when the program exits: to std::cerr if the variable is "1",
+ * otherwise to the file it names. Phases nest, e.g. the tgcreator phases
+ * are inside "model setup", so their times are not to be added up.
+ */
+class tgBuildProfile
+{
+public:
+
+    /** Times a phase, under a key such as a builder, while in scope */
+    class Scope
+    {
+    public:
+        /** @param[in] phase a string literal */
+        explicit Scope(const char* phase);
+
+        Scope(const char* phase, const std::string& key);
+
+        /** The key is the demangled type, looked up only if enabled */
+        Scope(const char* phase, const std::type_info& type);
+
+        ~Scope();
+
+    private:
+        const char* const m_phase;
+        const std::type_info* const m_pType;
+        std::string m_key;
+        /** 0 when not enabled */
+        double m_start;
+    };
+
+    static bool isEnabled();
+
+    static void setEnabled(bool enabled);
+
+    /** Add time to a phase and key */
+    static void add(const char* phase, const std::string& key,
+                    double seconds);
+
+    /**
+     * Write the calls and total and mean milliseconds of every phase and
+     * key, in the order they were first timed.
+     */
+    static void write(std::ostream& os);
+
+    /** Forget the times */
+    static void clear();
+
+    /** The demangled name of a type */
+    static std::string typeName(const std::type_info& type);
+
+    /** Seconds on the monotonic clock */
+    static double now();
+};
+
+#endif  // TG_BUILD_PROFILE_H
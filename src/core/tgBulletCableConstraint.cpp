@@ -0,0 +1,151 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBulletCableConstraint.cpp
+ * @brief Implementation of class tgBulletCableConstraint
+ * $Id$
+ */
+
+// This module
+#include "tgBulletCableConstraint.h"
+#include "tgBulletSpringCableAnchor.h"
+#include "tgSpringCable.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+
+// The type is only a tag; D6 and the others are serialized by type
+tgBulletCableConstraint::tgBulletCableConstraint(const tgSpringCable& cable,
+                            const tgBulletSpringCableAnchor& anchor1,
+                            const tgBulletSpringCableAnchor& anchor2) :
+btTypedConstraint(CONTACT_CONSTRAINT_TYPE, *anchor1.attachedBody,
+                  *anchor2.attachedBody),
+m_cable(cable),
+m_anchor1(anchor1),
+m_anchor2(anchor2),
+m_unitVector(0.0, 0.0, 0.0),
+m_stretch(0.0),
+m_lengthRate(0.0),
+m_invMass(0.0),
+m_timeStep(0.0)
+{
+}
+
+void tgBulletCableConstraint::getInfo1(btConstraintInfo1* info)
+{
+    info->m_numConstraintRows = 0;
+    info->nub = 0;
+
+    const btRigidBody& bodyA = getRigidBodyA();
+    const btRigidBody& bodyB = getRigidBodyB();
+    const btVector3 point1 = m_anchor1.getRelativePosition();
+    const btVector3 point2 = m_anchor2.getRelativePosition();
+    const btVector3 dist =
+      m_anchor2.getWorldPosition() - m_anchor1.getWorldPosition();
+    const double length = dist.length();
+    if (&bodyA == &bodyB || length <= 0.0)
+    {
+        internalSetAppliedImpulse(0.0);
+        return;
+    }
+    m_unitVector = dist / length;
+    m_stretch = length - m_cable.getRestLength();
+    m_lengthRate = m_unitVector.dot(
+      bodyB.getVelocityInLocalPoint(point2) -
+      bodyA.getVelocityInLocalPoint(point1));
+
+    // As tgBulletSpringCable::calculateAndApplyImplicitForce
+    const btVector3 armA = point1.cross(m_unitVector);
+    const btVector3 armB = point2.cross(m_unitVector);
+    m_invMass = bodyA.getInvMass() + bodyB.getInvMass() +
+      armA.dot(bodyA.getInvInertiaTensorWorld() * armA) +
+      armB.dot(bodyB.getInvInertiaTensorWorld() * armB);
+
+    // Slack now and at the end of the step, or between two static bodies.
+    // Before the first solve the step is unknown, so only the stretch counts.
+    if (m_invMass <= 0.0 || m_stretch + m_timeStep * m_lengthRate <= 0.0)
+    {
+        // The solver only records impulses for rows it was given
+        internalSetAppliedImpulse(0.0);
+        return;
+    }
+    info->m_numConstraintRows = 1;
+}
+
+/**
+ * A positive impulse pulls anchor1's body towards anchor2's, so the row's
+ * velocity is the rate of shortening, -v. Bullet 2.82 converges to the
+ * impulse p with p * (1 + cfm) = (err + d * v) / w, where d is the
+ * solver's damping and w the inverse mass along the row. Setting
+ *
+ *     err = k * x / (c + dt * k) - (d - 1) * v
+ *     cfm = 1 / (w * dt * (c + dt * k))
+ *
+ * makes p / dt the implicit force in the header.
+ */
+void tgBulletCableConstraint::getInfo2(btConstraintInfo2* info)
+{
+    m_timeStep = 1.0 / info->fps;
+
+    const btVector3 point1 = m_anchor1.getRelativePosition();
+    const btVector3 point2 = m_anchor2.getRelativePosition();
+    info->m_J1linearAxis[0] = m_unitVector[0];
+    info->m_J1linearAxis[1] = m_unitVector[1];
+    info->m_J1linearAxis[2] = m_unitVector[2];
+    const btVector3 angularA = point1.cross(m_unitVector);
+    info->m_J1angularAxis[0] = angularA[0];
+    info->m_J1angularAxis[1] = angularA[1];
+    info->m_J1angularAxis[2] = angularA[2];
+    info->m_J2linearAxis[0] = -m_unitVector[0];
+    info->m_J2linearAxis[1] = -m_unitVector[1];
+    info->m_J2linearAxis[2] = -m_unitVector[2];
+    const btVector3 angularB = -point2.cross(m_unitVector);
+    info->m_J2angularAxis[0] = angularB[0];
+    info->m_J2angularAxis[1] = angularB[1];
+    info->m_J2angularAxis[2] = angularB[2];
+
+    const double coefK = m_cable.getCoefK();
+    const double effectiveDamping =
+      m_cable.getCoefD() + m_timeStep * coefK;
+    info->m_constraintError[0] = coefK * m_stretch / effectiveDamping -
+      (info->m_damping - 1.0) * m_lengthRate;
+    info->cfm[0] = 1.0 / (m_invMass * m_timeStep * effectiveDamping);
+
+    // A cable can only pull
+    info->m_lowerLimit[0] = 0.0;
+    info->m_upperLimit[0] = SIMD_INFINITY;
+}
+
+void tgBulletCableConstraint::setParam(int num, btScalar value, int axis)
+{
+    (void) num;
+    (void) value;
+    (void) axis;
+}
+
+btScalar tgBulletCableConstraint::getParam(int num, int axis) const
+{
+    (void) num;
+    (void) axis;
+    return 0.0;
+}
+
+double tgBulletCableConstraint::getTension() const
+{
+    return m_timeStep > 0.0 ? m_appliedImpulse / m_timeStep : 0.0;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_CORE_TG_BULLET_CABLE_CONSTRAINT_H_
+#define SRC_CORE_TG_BULLET_CABLE_CONSTRAINT_H_
+
+/**
+ * @file tgBulletCableConstraint.h
+ * @brief Definition of class tgBulletCableConstraint
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "BulletDynamics/ConstraintSolver/btTypedConstraint.h"
+#include "LinearMath/btVector3.h"
+
+// Forward references
+class tgSpringCable;
+class tgBulletSpringCableAnchor;
+
+/**
+ * A tension only distance constraint between the two permanent anchors
+ * of a cable, solved by Bullet together with the contacts rather than
+ * applied as an impulse before them. Its single row is softened so the
+ * impulse it converges to is the implicit spring-damper force of
+ * tgBulletSpringCable::setImplicitForces,
+ *
+ *     T = k * (x + dt * v') + c * v'
+ *
+ * with v' the rate of change of length after the solve, so the
+ * cable's stiffness becomes the constraint's compliance. A row's
+ * constraint force mixing is relative to its effective mass in the
+ * sequential impulse solver of Bullet 2.82, which is what getInfo2
+ * assumes.
+ *
+ * The stiffness, damping and rest length are read from the cable at
+ * each solve, so controllers change them as they would for a force
+ * cable. The row is only added while the cable is predicted to be taut
+ * at the end of the step, and pushes no bodies apart.
+ */
+class tgBulletCableConstraint : public btTypedConstraint
+{
+public:
+
+    /**
+     * @param[in] cable the stiffness, damping and rest length, which
+     * must outlive the constraint
+     * @param[in] anchor1 one end, whose body is body A
+     * @param[in] anchor2 the other end, whose body is body B
+     */
+    tgBulletCableConstraint(const tgSpringCable& cable,
+                            const tgBulletSpringCableAnchor& anchor1,
+                            const tgBulletSpringCableAnchor& anchor2);
+
+    /** The cable's direction and mass along it, and whether it is taut */
+    virtual void getInfo1(btConstraintInfo1* info);
+
+    /** The softened row, with a lower limit of zero */
+    virtual void getInfo2(btConstraintInfo2* info);
+
+    /** No parameters can be set; the cable's are used */
+    virtual void setParam(int num, btScalar value, int axis = -1);
+
+    /** @return zero, since there are no parameters */
+    virtual btScalar getParam(int num, int axis = -1) const;
+
+    /**
+     * The tension of the last solve: the impulse the solver applied
+     * along the cable over its timestep. Zero before the first solve
+     * and while slack.
+     */
+    double getTension() const;
+
+private:
+
+    const tgSpringCable& m_cable;
+
+    const tgBulletSpringCableAnchor& m_anchor1;
+
+    const tgBulletSpringCableAnchor& m_anchor2;
+
+    /** From anchor1 to anchor2, as of the last getInfo1 */
+    btVector3 m_unitVector;
+
+    /** Positive if the cable is longer than its rest length */
+    double m_stretch;
+
+    /** The rate of change of length from the bodies' velocities */
+    double m_lengthRate;
+
+    /** The inverse mass of the pair of bodies along the cable */
+    double m_invMass;
+
+    /** The solver's timestep at the last getInfo2, or zero */
+    double m_timeStep;
+};
+
+#endif  // SRC_CORE_TG_BULLET_CABLE_CONSTRAINT_H_
@@ -0,0 +1,663 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBulletCableForceEngine.cpp
+ * @brief Contains the definitions of members of class tgBulletCableForceEngine
+ * $Id$
+ */
+
+// This module
+#include "tgBulletCableForceEngine.h"
+// This application
+#include "tgBulletCompressionSpring.h"
+#include "tgBulletSpringCable.h"
+#include "tgBulletSpringCableAnchor.h"
+#include "tgBulletUnidirComprSpr.h"
+#include "tgBulletUtil.h"
+#include "tgCablePipeline.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btQuickprof.h"
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btTransform.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+
+tgBulletCableForceEngine::tgBulletCableForceEngine(std::size_t threads) :
+m_wakeImpulse(-1.0),
+m_bodiesDirty(false),
+m_batch(0),
+m_finishedWorkers(0),
+m_dt(0.0),
+m_shutdown(false)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_workReady, NULL);
+    pthread_cond_init(&m_workDone, NULL);
+
+    if (threads > 1)
+    {
+        for (std::size_t i = 0; i < threads; i++)
+        {
+            m_workers.push_back(new Worker(*this, i));
+        }
+        for (std::size_t i = 0; i < m_workers.size(); i++)
+        {
+            if (pthread_create(&m_workers[i]->thread, NULL, workerMain,
+                               m_workers[i]) != 0)
+            {
+                throw std::runtime_error("Could not start a cable thread");
+            }
+        }
+    }
+
+    // Postcondition
+    assert(invariant());
+}
+
+tgBulletCableForceEngine::~tgBulletCableForceEngine()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_shutdown = true;
+    pthread_cond_broadcast(&m_workReady);
+    pthread_mutex_unlock(&m_mutex);
+
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        pthread_join(m_workers[i]->thread, NULL);
+        delete m_workers[i];
+    }
+
+    pthread_cond_destroy(&m_workDone);
+    pthread_cond_destroy(&m_workReady);
+    pthread_mutex_destroy(&m_mutex);
+
+    for (std::size_t i = 0; i < m_cables.size(); i++)
+    {
+        // The cable carries on by itself
+        m_cables[i]->m_pForceEngine = NULL;
+    }
+    for (std::size_t i = 0; i < m_springs.size(); i++)
+    {
+        m_springs[i]->m_pForceEngine = NULL;
+    }
+}
+
+void tgBulletCableForceEngine::addCable(tgBulletSpringCable* pCable)
+{
+    if (pCable == NULL)
+    {
+        throw std::invalid_argument("Cable is NULL");
+    }
+    else if (pCable->m_pForceEngine != NULL)
+    {
+        throw std::invalid_argument("Cable is already registered with a force engine");
+    }
+    else if (pCable->m_anchors.size() != 2 ||
+             !pCable->anchor1->permanent || pCable->anchor1->sliding ||
+             !pCable->anchor2->permanent || pCable->anchor2->sliding)
+    {
+        throw std::invalid_argument("Only cables with two fixed anchors can be batched");
+    }
+    else if (pCable->m_implicitForces)
+    {
+        throw std::invalid_argument("Cables with implicit forces cannot be batched");
+    }
+
+    m_cables.push_back(pCable);
+    m_coefK.push_back(pCable->m_coefK);
+    m_coefD.push_back(pCable->m_dampingCoefficient);
+    m_localA.push_back(pCable->anchor1->attachedRelativeOriginalPosition);
+    m_localB.push_back(pCable->anchor2->attachedRelativeOriginalPosition);
+
+    pCable->m_pForceEngine = this;
+    m_bodiesDirty = true;
+
+    // Postcondition
+    assert(invariant());
+}
+
+void tgBulletCableForceEngine::removeCable(const tgBulletSpringCable* pCable)
+{
+    std::vector<tgBulletSpringCable*>::iterator it =
+        std::find(m_cables.begin(), m_cables.end(), pCable);
+
+    if (it != m_cables.end())
+    {
+        // Swap with the last cable and pop, keeping the buffers packed
+        const std::size_t i = it - m_cables.begin();
+        const std::size_t last = m_cables.size() - 1;
+
+        m_cables[i]->m_pForceEngine = NULL;
+
+        m_cables[i] = m_cables[last];
+        m_coefK[i] = m_coefK[last];
+        m_coefD[i] = m_coefD[last];
+        m_localA[i] = m_localA[last];
+        m_localB[i] = m_localB[last];
+
+        m_cables.pop_back();
+        m_coefK.pop_back();
+        m_coefD.pop_back();
+        m_localA.pop_back();
+        m_localB.pop_back();
+
+        m_bodiesDirty = true;
+    }
+
+    // Postcondition
+    assert(invariant());
+}
+
+void tgBulletCableForceEngine::updateCable(const tgBulletSpringCable* pCable)
+{
+    std::vector<tgBulletSpringCable*>::iterator it =
+        std::find(m_cables.begin(), m_cables.end(), pCable);
+
+    if (it != m_cables.end())
+    {
+        const std::size_t i = it - m_cables.begin();
+        m_coefK[i] = pCable->m_coefK;
+        m_coefD[i] = pCable->m_dampingCoefficient;
+    }
+}
+
+void tgBulletCableForceEngine::addSpring(tgBulletCompressionSpring* pSpring)
+{
+    if (pSpring == NULL)
+    {
+        throw std::invalid_argument("Spring is NULL");
+    }
+    else if (pSpring->m_pForceEngine != NULL)
+    {
+        throw std::invalid_argument("Spring is already registered with a force engine");
+    }
+
+    const tgBulletUnidirComprSpr* const pUnidir =
+        dynamic_cast<const tgBulletUnidirComprSpr*>(pSpring);
+
+    m_springs.push_back(pSpring);
+    m_springK.push_back(pSpring->m_coefK);
+    m_springD.push_back(pSpring->m_coefD);
+    m_springLocalA.push_back(pSpring->anchor1->attachedRelativeOriginalPosition);
+    m_springLocalB.push_back(pSpring->anchor2->attachedRelativeOriginalPosition);
+    m_springFreeEndAttached.push_back(pSpring->m_isFreeEndAttached ? 1 : 0);
+    m_springDirection.push_back(pUnidir != NULL ? *pUnidir->getDirection() :
+                                btVector3(0.0, 0.0, 0.0));
+
+    pSpring->m_pForceEngine = this;
+    m_bodiesDirty = true;
+
+    // Postcondition
+    assert(invariant());
+}
+
+void tgBulletCableForceEngine::removeSpring(const tgBulletCompressionSpring* pSpring)
+{
+    std::vector<tgBulletCompressionSpring*>::iterator it =
+        std::find(m_springs.begin(), m_springs.end(), pSpring);
+
+    if (it != m_springs.end())
+    {
+        // Swap with the last spring and pop, keeping the buffers packed
+        const std::size_t i = it - m_springs.begin();
+        const std::size_t last = m_springs.size() - 1;
+
+        m_springs[i]->m_pForceEngine = NULL;
+
+        m_springs[i] = m_springs[last];
+        m_springK[i] = m_springK[last];
+        m_springD[i] = m_springD[last];
+        m_springLocalA[i] = m_springLocalA[last];
+        m_springLocalB[i] = m_springLocalB[last];
+        m_springFreeEndAttached[i] = m_springFreeEndAttached[last];
+        m_springDirection[i] = m_springDirection[last];
+
+        m_springs.pop_back();
+        m_springK.pop_back();
+        m_springD.pop_back();
+        m_springLocalA.pop_back();
+        m_springLocalB.pop_back();
+        m_springFreeEndAttached.pop_back();
+        m_springDirection.pop_back();
+
+        m_bodiesDirty = true;
+    }
+
+    // Postcondition
+    assert(invariant());
+}
+
+namespace
+{
+    /** How many of two bodies are in a sorted list */
+    int countOn(const std::vector<btRigidBody*>& bodies, btRigidBody* a,
+                btRigidBody* b)
+    {
+        return (std::binary_search(bodies.begin(), bodies.end(), a) ? 1 : 0) +
+            (std::binary_search(bodies.begin(), bodies.end(), b) ? 1 : 0);
+    }
+}
+
+void tgBulletCableForceEngine::transferCables(const std::vector<btRigidBody*>& bodies,
+                                              tgBulletCableForceEngine& destination)
+{
+    if (&destination == this)
+    {
+        throw std::invalid_argument("Cables transferred to their own engine");
+    }
+
+    // Check everything first, so a failure leaves both engines as they were
+    for (std::size_t i = 0; i < m_cables.size(); i++)
+    {
+        if (countOn(bodies, m_cables[i]->anchor1->attachedBody,
+                    m_cables[i]->anchor2->attachedBody) == 1)
+        {
+            throw std::invalid_argument("Cable joins bodies that are not moving together");
+        }
+    }
+    for (std::size_t i = 0; i < m_springs.size(); i++)
+    {
+        if (countOn(bodies, m_springs[i]->anchor1->attachedBody,
+                    m_springs[i]->anchor2->attachedBody) == 1)
+        {
+            throw std::invalid_argument("Spring joins bodies that are not moving together");
+        }
+    }
+
+    // Backwards, since removing swaps the last into place
+    for (std::size_t i = m_cables.size(); i-- > 0; )
+    {
+        tgBulletSpringCable* const pCable = m_cables[i];
+        if (countOn(bodies, pCable->anchor1->attachedBody,
+                    pCable->anchor2->attachedBody) == 2)
+        {
+            removeCable(pCable);
+            destination.addCable(pCable);
+        }
+    }
+    for (std::size_t i = m_springs.size(); i-- > 0; )
+    {
+        tgBulletCompressionSpring* const pSpring = m_springs[i];
+        if (countOn(bodies, pSpring->anchor1->attachedBody,
+                    pSpring->anchor2->attachedBody) == 2)
+        {
+            removeSpring(pSpring);
+            destination.addSpring(pSpring);
+        }
+    }
+}
+
+namespace
+{
+    /** The slot of a body in the engine's table, adding it if it is new */
+    int bodySlot(btRigidBody* pBody,
+                 std::map<btRigidBody*, int>& index,
+                 std::vector<btRigidBody*>& bodies)
+    {
+        std::map<btRigidBody*, int>::const_iterator it = index.find(pBody);
+        if (it != index.end())
+        {
+            return it->second;
+        }
+        const int slot = bodies.size();
+        index[pBody] = slot;
+        bodies.push_back(pBody);
+        return slot;
+    }
+}
+
+void tgBulletCableForceEngine::rebuildBodyTable()
+{
+    const std::size_t n = m_cables.size();
+    const std::size_t nSprings = m_springs.size();
+
+    m_bodies.clear();
+    m_bodyA.resize(n);
+    m_bodyB.resize(n);
+    m_springBodyA.resize(nSprings);
+    m_springBodyB.resize(nSprings);
+
+    std::map<btRigidBody*, int> index;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        m_bodyA[i] = bodySlot(m_cables[i]->anchor1->attachedBody, index, m_bodies);
+        m_bodyB[i] = bodySlot(m_cables[i]->anchor2->attachedBody, index, m_bodies);
+    }
+    for (std::size_t i = 0; i < nSprings; i++)
+    {
+        m_springBodyA[i] = bodySlot(m_springs[i]->anchor1->attachedBody, index, m_bodies);
+        m_springBodyB[i] = bodySlot(m_springs[i]->anchor2->attachedBody, index, m_bodies);
+    }
+
+    m_linearImpulse.resize(m_bodies.size());
+    m_torqueImpulse.resize(m_bodies.size());
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        m_workers[i]->linearImpulse.resize(m_bodies.size());
+        m_workers[i]->torqueImpulse.resize(m_bodies.size());
+    }
+    // Bodies may have changed slots
+    m_appliedLinear.assign(m_bodies.size(), btVector3(0.0, 0.0, 0.0));
+    m_appliedTorque.assign(m_bodies.size(), btVector3(0.0, 0.0, 0.0));
+
+    m_relA.resize(n);
+    m_relB.resize(n);
+    m_dx.resize(n);
+    m_dy.resize(n);
+    m_dz.resize(n);
+    m_restLength.resize(n);
+    m_prevLength.resize(n);
+    m_length.resize(n);
+    m_velocity.resize(n);
+    m_damping.resize(n);
+    m_magnitude.resize(n);
+
+    m_springRelA.resize(nSprings);
+    m_springRelB.resize(nSprings);
+    m_springForce.resize(nSprings);
+    m_springLength.resize(nSprings);
+    m_activeSprings.reserve(nSprings);
+
+    m_bodiesDirty = false;
+}
+
+void tgBulletCableForceEngine::stepSprings(double dt)
+{
+    const std::size_t n = m_springs.size();
+    const double invDt = 1.0 / dt;
+
+    // Same model as tgBulletCompressionSpring::calculateAndApplyForce and
+    // tgBulletUnidirComprSpr::calculateAndApplyForce, with each anchor
+    // transformed once
+    for (std::size_t i = 0; i < n; i++)
+    {
+        tgBulletCompressionSpring* const pSpring = m_springs[i];
+        const btTransform& trA = m_bodies[m_springBodyA[i]]->getWorldTransform();
+        const btTransform& trB = m_bodies[m_springBodyB[i]]->getWorldTransform();
+        m_springRelA[i] = trA.getBasis() * m_springLocalA[i];
+        m_springRelB[i] = trB.getBasis() * m_springLocalB[i];
+        const btVector3 dist =
+            (trB.getOrigin() + m_springRelB[i]) - (trA.getOrigin() + m_springRelA[i]);
+
+        // A positive force pushes the anchors apart
+        const btVector3& direction = m_springDirection[i];
+        double anchorDistance;
+        btVector3 unitVector;
+        if (direction.length2() > 0.0)
+        {
+            anchorDistance = dist.dot(direction);
+            unitVector = -direction;
+        }
+        else
+        {
+            anchorDistance = dist.length();
+            unitVector = -dist / anchorDistance;
+        }
+
+        const double restLength = pSpring->m_restLength;
+        const double currLength =
+            (m_springFreeEndAttached[i] || anchorDistance < restLength) ?
+            anchorDistance : restLength;
+        const double velocity = (currLength - pSpring->m_prevLength) * invDt;
+        const double damping = -m_springD[i] * velocity;
+        const double magnitude = -m_springK[i] * (currLength - restLength) + damping;
+
+        m_springForce[i] = unitVector * magnitude;
+        m_springLength[i] = currLength;
+
+        // Keep the spring's accessors current for logging and sensors
+        pSpring->m_prevLength = currLength;
+        pSpring->m_velocity = velocity;
+        pSpring->m_dampingForce = damping;
+    }
+
+    // Only engaged springs push on their bodies. An idle spring, one whose
+    // free end has lifted off and that was already at its rest length,
+    // has no force at all, and most springs spend long stretches idle.
+    m_activeSprings.clear();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        if (m_springForce[i].x() != 0.0 ||
+            m_springForce[i].y() != 0.0 ||
+            m_springForce[i].z() != 0.0)
+        {
+            m_activeSprings.push_back(i);
+        }
+    }
+
+    for (std::size_t k = 0; k < m_activeSprings.size(); k++)
+    {
+        const std::size_t i = m_activeSprings[k];
+        const btVector3 impulse = m_springForce[i] * dt;
+        const int a = m_springBodyA[i];
+        const int b = m_springBodyB[i];
+        m_linearImpulse[a] += impulse;
+        m_torqueImpulse[a] += m_springRelA[i].cross(impulse * m_bodies[a]->getLinearFactor());
+        m_linearImpulse[b] -= impulse;
+        m_torqueImpulse[b] -= m_springRelB[i].cross(impulse * m_bodies[b]->getLinearFactor());
+    }
+}
+
+void tgBulletCableForceEngine::computeCables(std::size_t begin, std::size_t end,
+                                             double dt,
+                                             btVector3* linearImpulse,
+                                             btVector3* torqueImpulse)
+{
+    // Gather: anchor offsets from each body's center of mass, the rest
+    // lengths the controllers set during the last model step, and the
+    // previous lengths, which a snapshot restore may have changed
+    for (std::size_t i = begin; i < end; i++)
+    {
+        const btTransform& trA = m_bodies[m_bodyA[i]]->getWorldTransform();
+        const btTransform& trB = m_bodies[m_bodyB[i]]->getWorldTransform();
+        m_relA[i] = trA.getBasis() * m_localA[i];
+        m_relB[i] = trB.getBasis() * m_localB[i];
+        const btVector3 dist =
+            (trB.getOrigin() + m_relB[i]) - (trA.getOrigin() + m_relA[i]);
+        m_dx[i] = dist.x();
+        m_dy[i] = dist.y();
+        m_dz[i] = dist.z();
+        m_restLength[i] = m_cables[i]->m_restLength;
+        m_prevLength[i] = m_cables[i]->m_prevLength;
+    }
+
+    // Tensions: the spring law of tgBulletSpringCable over plain arrays
+    const std::size_t count = end - begin;
+    tgLinearTensionLaw::tensions(count, &m_coefK[begin], &m_coefD[begin],
+                                 &m_restLength[begin], &m_dx[begin],
+                                 &m_dy[begin], &m_dz[begin],
+                                 &m_prevLength[begin], 1.0 / dt,
+                                 &m_length[begin], &m_velocity[begin],
+                                 &m_damping[begin], &m_magnitude[begin]);
+
+    // Scatter: accumulate impulses per body
+    for (std::size_t i = begin; i < end; i++)
+    {
+        const double scale = m_magnitude[i] * dt;
+        const btVector3 impulse(m_dx[i] * scale, m_dy[i] * scale, m_dz[i] * scale);
+
+        const int a = m_bodyA[i];
+        const int b = m_bodyB[i];
+        linearImpulse[a] += impulse;
+        torqueImpulse[a] += m_relA[i].cross(impulse * m_bodies[a]->getLinearFactor());
+        linearImpulse[b] -= impulse;
+        torqueImpulse[b] -= m_relB[i].cross(impulse * m_bodies[b]->getLinearFactor());
+
+        // Keep the cable's accessors current for logging and sensors
+        tgBulletSpringCable* const pCable = m_cables[i];
+        pCable->m_prevLength = m_length[i];
+        pCable->m_velocity = m_velocity[i];
+        pCable->m_damping = m_damping[i];
+    }
+}
+
+void tgBulletCableForceEngine::computeRange(Worker& worker)
+{
+    const std::size_t n = m_cables.size();
+    const std::size_t count = m_workers.size();
+    std::fill(worker.linearImpulse.begin(), worker.linearImpulse.end(),
+              btVector3(0.0, 0.0, 0.0));
+    std::fill(worker.torqueImpulse.begin(), worker.torqueImpulse.end(),
+              btVector3(0.0, 0.0, 0.0));
+    // Contiguous ranges keep each worker on its own lines of the buffers
+    const std::size_t begin = n * worker.index / count;
+    const std::size_t end = n * (worker.index + 1) / count;
+    if (begin < end)
+    {
+        computeCables(begin, end, m_dt, &worker.linearImpulse[0],
+                      &worker.torqueImpulse[0]);
+    }
+}
+
+void* tgBulletCableForceEngine::workerMain(void* arg)
+{
+    Worker* const pWorker = static_cast<Worker*>(arg);
+    pWorker->owner.work(*pWorker);
+    return NULL;
+}
+
+void tgBulletCableForceEngine::work(Worker& worker)
+{
+    pthread_mutex_lock(&m_mutex);
+    while (true)
+    {
+        while (!m_shutdown && worker.batch == m_batch)
+        {
+            pthread_cond_wait(&m_workReady, &m_mutex);
+        }
+        if (m_shutdown)
+        {
+            break;
+        }
+        worker.batch = m_batch;
+        pthread_mutex_unlock(&m_mutex);
+
+        computeRange(worker);
+
+        pthread_mutex_lock(&m_mutex);
+        if (++m_finishedWorkers == m_workers.size())
+        {
+            pthread_cond_signal(&m_workDone);
+        }
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void tgBulletCableForceEngine::step(double dt)
+{
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive!");
+    }
+
+#ifndef BT_NO_PROFILE
+    BT_PROFILE("tgBulletCableForceEngine::step");
+#endif //BT_NO_PROFILE
+
+    if (m_bodiesDirty)
+    {
+        rebuildBodyTable();
+    }
+
+    const std::size_t n = m_cables.size();
+    const std::size_t nBodies = m_bodies.size();
+
+    std::fill(m_linearImpulse.begin(), m_linearImpulse.end(), btVector3(0.0, 0.0, 0.0));
+    std::fill(m_torqueImpulse.begin(), m_torqueImpulse.end(), btVector3(0.0, 0.0, 0.0));
+    if (m_workers.empty() || n < minParallelCables)
+    {
+        if (n > 0)
+        {
+            computeCables(0, n, dt, &m_linearImpulse[0], &m_torqueImpulse[0]);
+        }
+    }
+    else
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_dt = dt;
+        m_finishedWorkers = 0;
+        ++m_batch;
+        pthread_cond_broadcast(&m_workReady);
+
+        while (m_finishedWorkers < m_workers.size())
+        {
+            pthread_cond_wait(&m_workDone, &m_mutex);
+        }
+        pthread_mutex_unlock(&m_mutex);
+
+        // Reduce in worker order, so the sums do not depend on timing
+        for (std::size_t w = 0; w < m_workers.size(); w++)
+        {
+            const Worker& worker = *m_workers[w];
+            for (std::size_t j = 0; j < nBodies; j++)
+            {
+                m_linearImpulse[j] += worker.linearImpulse[j];
+                m_torqueImpulse[j] += worker.torqueImpulse[j];
+            }
+        }
+    }
+    stepSprings(dt);
+
+    // Apply: one central and one torque impulse per body, which is what
+    // the individual btRigidBody::applyImpulse calls add up to
+    for (std::size_t j = 0; j < nBodies; j++)
+    {
+        btRigidBody* const pBody = m_bodies[j];
+        const double change =
+            std::max((m_linearImpulse[j] - m_appliedLinear[j]).length(),
+                     (m_torqueImpulse[j] - m_appliedTorque[j]).length());
+        if (!tgBulletUtil::wakeForImpulse(pBody, change, m_wakeImpulse))
+        {
+            continue;
+        }
+        m_appliedLinear[j] = m_linearImpulse[j];
+        m_appliedTorque[j] = m_torqueImpulse[j];
+        if (pBody->getInvMass() != btScalar(0.0))
+        {
+            pBody->applyCentralImpulse(m_linearImpulse[j]);
+            pBody->applyTorqueImpulse(m_torqueImpulse[j]);
+        }
+    }
+
+    // As the springs' own step checks after applying their force
+    for (std::size_t i = 0; i < m_springs.size(); i++)
+    {
+        m_springs[i]->checkLength(m_springLength[i]);
+    }
+}
+
+bool tgBulletCableForceEngine::invariant() const
+{
+    const std::size_t n = m_cables.size();
+    return (m_coefK.size() == n &&
+            m_coefD.size() == n &&
+            m_localA.size() == n &&
+            m_localB.size() == n &&
+            m_springK.size() == m_springs.size() &&
+            m_springD.size() == m_springs.size() &&
+            m_springLocalA.size() == m_springs.size() &&
+            m_springLocalB.size() == m_springs.size() &&
+            m_springFreeEndAttached.size() == m_springs.size() &&
+            m_springDirection.size() == m_springs.size());
+}
@@ -0,0 +1,334 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_CORE_TG_BULLET_CABLE_FORCE_ENGINE_H_
+#define SRC_CORE_TG_BULLET_CABLE_FORCE_ENGINE_H_
+
+/**
+ * @file tgBulletCableForceEngine.h
+ * @brief Contains the definition of class tgBulletCableForceEngine
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <vector>
+// POSIX threads
+#include <pthread.h>
+
+// Forward declarations
+class btRigidBody;
+class tgBulletCompressionSpring;
+class tgBulletSpringCable;
+
+/**
+ * Computes and applies the forces of every registered two-anchor
+ * tgBulletSpringCable in one pass per world step, rather than one
+ * virtual call per cable during the tgModel::step tree walk.
+ *
+ * Cable parameters are kept in structure-of-arrays buffers indexed by
+ * cable, and anchors refer to an index into a table of unique rigid
+ * bodies. A step gathers the anchor positions, computes all tensions in
+ * a single loop over plain arrays, and then accumulates the impulses per
+ * rigid body so each body receives one central and one torque impulse.
+ *
+ * Compression springs, tgBulletCompressionSpring and its unidirectional
+ * subclass, are kept in a second set of buffers sharing the same body
+ * table, so each anchor is transformed once per step and a body touched
+ * by both cables and springs still receives a single pair of impulses.
+ * Springs with no force, usually those whose free end has lifted off,
+ * are left out of the impulse pass.
+ *
+ * The engine is owned by tgWorldBulletPhysicsImpl and is stepped just
+ * before stepSimulation. Since tgSimulation::step advances the world
+ * before the models, this applies the same impulses at the same
+ * positions as the per-cable path, but a cable's velocity and damping
+ * are updated at the start of the following step.
+ *
+ * With worker threads, the cables are split into one contiguous range
+ * per worker. Each worker gathers, computes and scatters its range into
+ * its own impulse accumulators, since many cables share a body, and the
+ * calling thread sums the accumulators per body in worker order. The
+ * sum is the same from step to step for a given number of workers, but
+ * may differ in the last bits from a single thread's. Springs are few
+ * and are computed on the calling thread.
+ */
+class tgBulletCableForceEngine
+{
+public:
+
+    /** Fewer cables than this are computed on the calling thread */
+    static const std::size_t minParallelCables = 256;
+
+    /**
+     * Construct an empty engine.
+     * @param[in] threads the worker threads; 0 or 1 computes every cable
+     * on the calling thread
+     * @throw std::runtime_error if a thread could not be started
+     */
+    tgBulletCableForceEngine(std::size_t threads = 0);
+
+    /**
+     * Detach any cables still registered; they revert to stepping
+     * themselves. Stop the workers.
+     */
+    ~tgBulletCableForceEngine();
+
+    /**
+     * Take over force computation for a cable. Only cables with exactly
+     * two permanent, non-sliding anchors and explicit forces are
+     * accepted.
+     * @param[in] pCable the cable to register; must not be NULL
+     * @throw std::invalid_argument if the cable cannot be batched
+     */
+    void addCable(tgBulletSpringCable* pCable);
+
+    /**
+     * Stop computing forces for a cable. Called from the cable's
+     * destructor; does nothing if the cable is not registered.
+     * @param[in] pCable the cable to remove
+     */
+    void removeCable(const tgBulletSpringCable* pCable);
+
+    /**
+     * Copy a registered cable's coefficients again after they were
+     * changed. Called from tgBulletSpringCable::setCoefficients.
+     * @param[in] pCable the cable; does nothing if it is not registered
+     */
+    void updateCable(const tgBulletSpringCable* pCable);
+
+    /**
+     * Take over force computation for a compression spring.
+     * @param[in] pSpring the spring to register; must not be NULL
+     * @throw std::invalid_argument if the spring is NULL or already
+     * registered
+     */
+    void addSpring(tgBulletCompressionSpring* pSpring);
+
+    /**
+     * Stop computing forces for a spring. Called from the spring's
+     * destructor; does nothing if the spring is not registered.
+     * @param[in] pSpring the spring to remove
+     */
+    void removeSpring(const tgBulletCompressionSpring* pSpring);
+
+    /**
+     * Hand every cable and spring whose anchors are both on the given
+     * bodies over to another engine, as when tgSimulation::moveModel
+     * takes those bodies to another world.
+     * @param[in] bodies sorted, as by std::sort
+     * @param[in,out] destination the engine of the bodies' new world
+     * @throw std::invalid_argument if a cable or spring has only one
+     * anchor on the bodies, or destination is this engine; nothing is
+     * handed over
+     */
+    void transferCables(const std::vector<btRigidBody*>& bodies,
+                        tgBulletCableForceEngine& destination);
+
+    /**
+     * Compute and apply the forces of all registered cables and springs.
+     * @param[in] dt the timestep, must be positive
+     * @throw std::runtime_error if a spring's length check fails, after
+     * every force has been applied
+     */
+    void step(double dt);
+
+    /**
+     * The number of registered cables.
+     */
+    std::size_t size() const
+    {
+        return m_cables.size();
+    }
+
+    /**
+     * Wake sleeping bodies only for large changes in their net impulse;
+     * see tgWorld::Config::cableWakeImpulse.
+     * @param[in] threshold negative to keep every body awake
+     */
+    void setWakeImpulse(double threshold)
+    {
+        m_wakeImpulse = threshold;
+    }
+
+    /**
+     * The number of registered compression springs.
+     */
+    std::size_t springCount() const
+    {
+        return m_springs.size();
+    }
+
+    /**
+     * The number of springs that pushed on their bodies in the last step.
+     */
+    std::size_t activeSpringCount() const
+    {
+        return m_activeSprings.size();
+    }
+
+private:
+
+    /** One worker thread, with its own impulse accumulators */
+    struct Worker
+    {
+        Worker(tgBulletCableForceEngine& o, std::size_t i) :
+        owner(o),
+        index(i),
+        batch(0)
+        {
+        }
+
+        tgBulletCableForceEngine& owner;
+        const std::size_t index;
+        pthread_t thread;
+
+        /** The last batch this worker has run */
+        unsigned long batch;
+
+        /** Indexed like m_bodies */
+        std::vector<btVector3> linearImpulse;
+        std::vector<btVector3> torqueImpulse;
+    };
+
+    /** Rebuild the body table and per-cable and per-spring body indices. */
+    void rebuildBodyTable();
+
+    /**
+     * Compute cables [begin, end) and add their impulses to the
+     * accumulators, which are indexed like m_bodies
+     */
+    void computeCables(std::size_t begin, std::size_t end, double dt,
+                       btVector3* linearImpulse, btVector3* torqueImpulse);
+
+    /** Zero a worker's accumulators and compute its range of cables */
+    void computeRange(Worker& worker);
+
+    /** The worker loop */
+    void work(Worker& worker);
+
+    /** pthread entry point; arg is a Worker */
+    static void* workerMain(void* arg);
+
+    /** Not copyable */
+    tgBulletCableForceEngine(const tgBulletCableForceEngine&);
+    tgBulletCableForceEngine& operator=(const tgBulletCableForceEngine&);
+
+    /** Compute the springs' forces into the impulse accumulators */
+    void stepSprings(double dt);
+
+    /** Integrity predicate */
+    bool invariant() const;
+
+private:
+
+    /** The cables, in the same order as the per-cable buffers below. */
+    std::vector<tgBulletSpringCable*> m_cables;
+
+    /** Per-cable constants, copied at registration */
+    std::vector<double> m_coefK;
+    std::vector<double> m_coefD;
+
+    /** Anchor positions in the attached body's frame */
+    std::vector<btVector3> m_localA;
+    std::vector<btVector3> m_localB;
+
+    /** Indices into m_bodies for each end of each cable */
+    std::vector<int> m_bodyA;
+    std::vector<int> m_bodyB;
+
+    /** Scratch buffers, sized with m_cables */
+    std::vector<btVector3> m_relA;
+    std::vector<btVector3> m_relB;
+    std::vector<double> m_dx;
+    std::vector<double> m_dy;
+    std::vector<double> m_dz;
+    std::vector<double> m_restLength;
+    std::vector<double> m_prevLength;
+    std::vector<double> m_length;
+    std::vector<double> m_velocity;
+    std::vector<double> m_damping;
+    std::vector<double> m_magnitude;
+
+    /** The springs, in the same order as the per-spring buffers below */
+    std::vector<tgBulletCompressionSpring*> m_springs;
+
+    /** Per-spring constants, copied at registration */
+    std::vector<double> m_springK;
+    std::vector<double> m_springD;
+    std::vector<btVector3> m_springLocalA;
+    std::vector<btVector3> m_springLocalB;
+    /** 1 if the spring's free end is attached, else 0 */
+    std::vector<char> m_springFreeEndAttached;
+    /**
+     * The fixed direction of a unidirectional spring, or zero for a
+     * spring along the line between its anchors
+     */
+    std::vector<btVector3> m_springDirection;
+
+    /** Indices into m_bodies for each end of each spring */
+    std::vector<int> m_springBodyA;
+    std::vector<int> m_springBodyB;
+
+    /** Scratch buffers, sized with m_springs */
+    std::vector<btVector3> m_springRelA;
+    std::vector<btVector3> m_springRelB;
+    std::vector<btVector3> m_springForce;
+    std::vector<double> m_springLength;
+
+    /** The springs with a nonzero force in the last step, in order */
+    std::vector<std::size_t> m_activeSprings;
+
+    /** Unique bodies touched by registered cables and springs, with impulse accumulators */
+    std::vector<btRigidBody*> m_bodies;
+    std::vector<btVector3> m_linearImpulse;
+    std::vector<btVector3> m_torqueImpulse;
+
+    /** The impulses each body last took, to compare with when it sleeps */
+    std::vector<btVector3> m_appliedLinear;
+    std::vector<btVector3> m_appliedTorque;
+
+    /** See setWakeImpulse */
+    double m_wakeImpulse;
+
+    /** True when cables have been added or removed since the last rebuild */
+    bool m_bodiesDirty;
+
+    /** We own these */
+    std::vector<Worker*> m_workers;
+
+    /** Guards everything below */
+    pthread_mutex_t m_mutex;
+
+    /** Signalled when a batch starts or the workers should exit */
+    pthread_cond_t m_workReady;
+
+    /** Signalled when the last worker of a batch finishes */
+    pthread_cond_t m_workDone;
+
+    unsigned long m_batch;
+    std::size_t m_finishedWorkers;
+
+    /** The step the current batch is for */
+    double m_dt;
+
+    bool m_shutdown;
+};
+
+#endif  // SRC_CORE_TG_BULLET_CABLE_FORCE_ENGINE_H_
@@ -26,6 +26,7 @@
 
 // This module
 #include "tgBulletCompressionSpring.h"
+#include "tgBulletCableForceEngine.h"
 #include "tgBulletSpringCableAnchor.h"
 #include "tgCast.h"
 // The BulletPhysics library
@@ -50,7 +51,8 @@ m_coefD(coefD),
 m_restLength(restLength),
 m_anchors(anchors),
 anchor1(anchors.front()),
-anchor2(anchors.back())
+anchor2(anchors.back()),
+m_pForceEngine(NULL)
 {
     // There should be two anchors for a compression spring.
     assert(m_anchors.size() == 2);
@@ -90,6 +92,11 @@ tgBulletCompressionSpring::~tgBulletCompressionSpring()
     std::cout << "Destroying tgBulletCompressionSpring" << std::endl;
     #endif
     
+    if (m_pForceEngine != NULL)
+    {
+        m_pForceEngine->removeSpring(this);
+    }
+    
     std::size_t n = m_anchors.size();
     
     // Make absolutely sure these are deleted, in case we have a poorly timed reset
@@ -120,16 +127,25 @@ void tgBulletCompressionSpring::step(double dt)
         throw std::invalid_argument("dt is not positive!");
     }
 
-    calculateAndApplyForce(dt);
+    // A registered spring has its force applied at the next world step,
+    // and its length checked there
+    if (m_pForceEngine == NULL)
+    {
+        calculateAndApplyForce(dt);
+        checkLength(getCurrentSpringLength());
+    }
+    
+    assert(invariant());
+}
 
+void tgBulletCompressionSpring::checkLength(double springLength) const
+{
     // If the spring distance has gone negative, crash the simulator on purpose.
     // TO-DO: find a way to apply a hard stop here instead.
-    if( getCurrentSpringLength() <= 0.0)
+    if( springLength <= 0.0)
     {
       throw std::runtime_error("Compression spring has negative length, simulation stopping. Increase your stiffness coefficient. TO-DO: implement a 'hard stop' inside the step method of tgBulletCompressionSpring instead of crashing the simulator.");
     }
-    
-    assert(invariant());
 }
 
 /**
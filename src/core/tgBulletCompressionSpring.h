@@ -40,6 +40,7 @@
 class btRigidBody;
 class tgSpringCableAnchor;
 class tgBulletSpringCableAnchor;
+class tgBulletCableForceEngine;
 
 /**
  * This class defines the passive dynamics of a compression spring
@@ -48,6 +49,9 @@ class tgBulletSpringCableAnchor;
 class tgBulletCompressionSpring
 {
 public: 
+    // Computes our forces in a batch when we're registered with it
+    friend class tgBulletCableForceEngine;
+
     /**
      * The only constructor. Takes a list of anchors, a coefficient
      * of stiffness, a coefficent of damping, and rest length
@@ -75,7 +79,9 @@ public:
     virtual ~tgBulletCompressionSpring();
 
     /**
-     * Updates this object. Calls calculateAndApplyForce(dt)
+     * Updates this object. Calls calculateAndApplyForce(dt), unless the
+     * spring is registered with a tgBulletCableForceEngine, which then
+     * applies its force at the next world step.
      * @param[in] dt, must be positive
      */
     virtual void step(double dt);
@@ -239,6 +245,18 @@ protected:
      */
     virtual void calculateAndApplyForce(double dt);
 
+    /**
+     * Called with the spring length after its force has been applied.
+     * @throw std::runtime_error if the length is not positive
+     */
+    virtual void checkLength(double springLength) const;
+
+    /**
+     * The engine computing our forces, or NULL if we compute them
+     * ourselves in step()
+     */
+    tgBulletCableForceEngine* m_pForceEngine;
+
 private: 
     /** Ensures integrity of member variables */
     bool invariant(void) const;
@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBulletConstraintSpringCable.cpp
+ * @brief Implementation of class tgBulletConstraintSpringCable
+ * $Id$
+ */
+
+// This module
+#include "tgBulletConstraintSpringCable.h"
+#include "tgBulletCableConstraint.h"
+#include "tgBulletSpringCableAnchor.h"
+#include "tgBulletUtil.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+
+tgBulletConstraintSpringCable::tgBulletConstraintSpringCable(tgWorld& world,
+                const std::vector<tgBulletSpringCableAnchor*>& anchors,
+                double coefK,
+                double dampingCoefficient,
+                double pretension) :
+tgBulletSpringCable(anchors, coefK, dampingCoefficient, pretension),
+m_world(world),
+m_pConstraint(new tgBulletCableConstraint(*this, *anchor1, *anchor2))
+{
+    // The cable does not keep its own bodies from colliding
+    tgBulletUtil::worldToDynamicsWorld(m_world).addConstraint(m_pConstraint);
+}
+
+tgBulletConstraintSpringCable::~tgBulletConstraintSpringCable()
+{
+    tgBulletUtil::worldToDynamicsWorld(m_world).removeConstraint(m_pConstraint);
+    delete m_pConstraint;
+}
+
+void tgBulletConstraintSpringCable::calculateAndApplyForce(double dt)
+{
+    const double currLength = getActualLength();
+    m_velocity = (currLength - m_prevLength) / dt;
+    m_prevLength = currLength;
+    
+    // The part of the solver's tension that is not elastic
+    const double stretch = currLength - m_restLength;
+    const double tension = m_pConstraint->getTension();
+    m_damping = tension > 0.0 ? tension - m_coefK * stretch : 0.0;
+}
+
+const double tgBulletConstraintSpringCable::getTension() const
+{
+    return m_pConstraint->getTension();
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_CORE_TG_BULLET_CONSTRAINT_SPRING_CABLE_H_
+#define SRC_CORE_TG_BULLET_CONSTRAINT_SPRING_CABLE_H_
+
+/**
+ * @file tgBulletConstraintSpringCable.h
+ * @brief Definition of a cable solved as a Bullet constraint
+ * $Id$
+ */
+
+// NTRT
+#include "tgBulletSpringCable.h"
+// The C++ Standard Library
+#include <vector>
+
+// Forward references
+class tgWorld;
+class tgBulletCableConstraint;
+
+/**
+ * A two anchor cable whose force is a tgBulletCableConstraint in the
+ * world's solver instead of an impulse applied before it. The solver
+ * balances the cable against contacts and the other cables in the same
+ * iterations, so stiff or nearly inextensible cables stay stable at
+ * timesteps where a force cable, even an implicit one, would not.
+ *
+ * Controllers set the rest length and coefficients as usual; the
+ * constraint reads them at the next world step. getTension reports the
+ * tension the solver found, including damping, rather than the elastic
+ * part alone. Such cables are not batched by tgBulletCableForceEngine,
+ * and setImplicitForces has no effect on them.
+ */
+class tgBulletConstraintSpringCable : public tgBulletSpringCable
+{
+public:
+
+    /**
+     * Adds the constraint to the world.
+     * @param[in] world the world whose solver handles this cable, which
+     * must outlive it
+     * @param[in] anchors two anchors, on different bodies
+     * @param[in] coefK the stiffness, see tgBulletSpringCable
+     * @param[in] dampingCoefficient see tgBulletSpringCable
+     * @param[in] pretension see tgBulletSpringCable
+     */
+    tgBulletConstraintSpringCable(tgWorld& world,
+                const std::vector<tgBulletSpringCableAnchor*>& anchors,
+                double coefK,
+                double dampingCoefficient,
+                double pretension = 0.0);
+
+    /** Removes the constraint from the world and deletes it */
+    virtual ~tgBulletConstraintSpringCable();
+
+    /** The solver's tension at the last world step */
+    virtual const double getTension() const;
+
+private:
+
+    /**
+     * Only keeps the length history; the world applies the force.
+     */
+    virtual void calculateAndApplyForce(double dt);
+
+    tgWorld& m_world;
+
+    tgBulletCableConstraint* const m_pConstraint;
+};
+
+#endif  // SRC_CORE_TG_BULLET_CONSTRAINT_SPRING_CABLE_H_
@@ -32,6 +32,8 @@
 #include "core/tgBulletSpringCableAnchor.h"
 #include "core/tgCast.h"
 #include "core/tgBulletUtil.h"
+#include "core/tgCableCollision.h"
+#include "core/tgGhostPairFilter.h"
 #include "core/tgWorld.h"
 #include "core/tgWorldBulletPhysicsImpl.h"
 
@@ -66,24 +68,65 @@ tgBulletSpringCable (anchors, coefK, dampingCoefficient, pretension),
 m_ghostObject(ghostObject),
 m_world(world),
 m_thickness(thickness),
-m_resolution(resolution)
+m_resolution(resolution),
+m_pCollision(tgBulletUtil::worldToCableCollision(world)),
+m_collisionId(0)
 {
-
+    if (m_pCollision)
+    {
+        // As with the ghost, the rods we end on are always touching
+        m_collisionId = m_pCollision->addCable(thickness);
+        m_pCollision->exclude(m_collisionId, anchor1->attachedBody);
+        m_pCollision->exclude(m_collisionId, anchor2->attachedBody);
+        cacheAnchorPositions();
+        m_pCollision->setCable(m_collisionId, m_anchorPositions);
+    }
 }
          
 tgBulletContactSpringCable::~tgBulletContactSpringCable()
 {
 	btDynamicsWorld& m_dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(m_world);
 	m_dynamicsWorld.removeCollisionObject(m_ghostObject);
+	tgBulletUtil::worldToGhostPairFilter(m_world).forget(m_ghostObject);
+    if (m_pCollision)
+    {
+        m_pCollision->removeCable(m_collisionId);
+    }
+    
+    // The pool goes before ~tgBulletSpringCable deletes the anchors, so
+    // leave it only the ones it allocated
+    for (std::size_t i = 0; i < m_newAnchors.size(); i++)
+    {
+        m_anchorPool.release(m_newAnchors[i]);
+    }
+    m_newAnchors.clear();
+    std::vector<tgBulletSpringCableAnchor*>::iterator it = m_anchors.begin();
+    while (it != m_anchors.end())
+    {
+        if (m_anchorPool.owns(*it))
+        {
+            m_anchorPool.release(*it);
+            it = m_anchors.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
     
     btCollisionShape* shape = m_ghostObject->getCollisionShape();
     deleteCollisionShape(shape);
     delete m_ghostObject;
+    
+    for (std::size_t i = 0; i < m_segmentPool.size(); i++)
+    {
+        delete m_segmentPool[i];
+    }
 }
 
-const btScalar tgBulletContactSpringCable::getActualLength() const
+const double tgBulletContactSpringCable::getActualLength() const
 {
-    btScalar length = 0;
+    double length = 0.0;
     
     std::size_t n = m_anchors.size() - 1;
     for (std::size_t i = 0; i < n; i++)
@@ -97,6 +140,10 @@ const btScalar tgBulletContactSpringCable::getActualLength() const
 void tgBulletContactSpringCable::step(double dt)
 {    
     updateManifolds();
+    if (m_pCollision)
+    {
+        addCapsuleContacts();
+    }
 #if (0) // Typically causes contacts to be lost
     int numPruned = 1;
     while (numPruned > 0)
@@ -121,6 +168,11 @@ void tgBulletContactSpringCable::step(double dt)
 	
 	// Do this last so the ghost object gets populated with collisions before it is deleted
     updateCollisionObject();
+    if (m_pCollision)
+    {
+        cacheAnchorPositions();
+        m_pCollision->setCable(m_collisionId, m_anchorPositions);
+    }
     
     assert(invariant());
 }
@@ -226,7 +278,8 @@ void tgBulletContactSpringCable::updateManifolds()
     BT_PROFILE("updateManifolds");
 #endif //BT_NO_PROFILE      
     
-    // Copy this vector so we can remove as necessary
+    // Anchors don't move until pruneAnchors, so look their positions up once
+    cacheAnchorPositions();
     
 	btManifoldArray	m_manifoldArray;
 	btVector3 m_touchingNormal;
@@ -308,15 +361,16 @@ void tgBulletContactSpringCable::updateManifolds()
 						// -1 means findNearestPastAnchor failed
 						if (anchorPos >= 0)
 						{
-							// Not permanent, sliding contact
-							tgBulletSpringCableAnchor* const newAnchor = new tgBulletSpringCableAnchor(rb, pos, m_touchingNormal, false, true, manifold);
+							// Not permanent, sliding contact. Most candidates are
+							// rejected, so they only go into the pool once accepted
+							const tgBulletSpringCableAnchor candidate(rb, pos, m_touchingNormal, false, true, manifold);
 						
 							
 							tgBulletSpringCableAnchor* backAnchor = m_anchors[anchorPos];
 							tgBulletSpringCableAnchor* forwardAnchor = m_anchors[anchorPos + 1];
 							
-							btVector3 pos0 = backAnchor->getWorldPosition();
-							btVector3 pos2 = forwardAnchor->getWorldPosition();
+							const btVector3& pos0 = m_anchorPositions[anchorPos];
+							const btVector3& pos2 = m_anchorPositions[anchorPos + 1];
 							
 							btVector3 lineA = (pos2 - pos);
 							btVector3 lineB = (pos0 - pos);
@@ -324,10 +378,10 @@ void tgBulletContactSpringCable::updateManifolds()
 							btScalar lengthA = lineA.length();
 							btScalar lengthB = lineB.length();
 							
-							btScalar mDistB = backAnchor->getManifoldDistance(newAnchor->getManifold()).first;
-							btScalar mDistA = forwardAnchor->getManifoldDistance(newAnchor->getManifold()).first;
+							btScalar mDistB = backAnchor->getManifoldDistance(candidate.getManifold()).first;
+							btScalar mDistA = forwardAnchor->getManifoldDistance(candidate.getManifold()).first;
 							
-							//std::cout << "Update Manifolds " << newAnchor->getManifold() << std::endl;
+							//std::cout << "Update Manifolds " << candidate.getManifold() << std::endl;
 							
 							bool del = false;	
 										
@@ -344,15 +398,10 @@ void tgBulletContactSpringCable::updateManifolds()
 									//std::cout << "UpdateA " << mDistA << std::endl;
 							}
 							
-							if (del)
+							/// @todo further examination of whether the anchors should be deleted here
+							if (!del)
 							{
-								/// @todo further examination of whether the anchors should be deleted here
-								delete newAnchor;
-							}
-							else
-							{
-												
-								m_newAnchors.push_back(newAnchor);
+								m_newAnchors.push_back(m_anchorPool.create(candidate));
 							} // If anchor passes distance tests
 						} // If we could find the anchor's position
 					} // If body is a rigid body
@@ -364,6 +413,64 @@ void tgBulletContactSpringCable::updateManifolds()
 	
 }
 
+void tgBulletContactSpringCable::addCapsuleContacts()
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("addCapsuleContacts");
+#endif //BT_NO_PROFILE      
+    
+    const std::vector<tgCableCollision::Contact>& contacts = m_pCollision->getContacts();
+    std::size_t first = 0;
+    std::size_t last = 0;
+    m_pCollision->getContacts(m_collisionId, first, last);
+    
+    for (std::size_t i = first; i < last; i++)
+    {
+        const tgCableCollision::Contact& contact = contacts[i];
+        
+        // Anchors attach to rigid bodies, so other cables are left alone
+        btRigidBody* const rb = contact.pBody;
+        if (rb == NULL)
+        {
+            continue;
+        }
+        
+        btVector3 pos = contact.position;
+        int anchorPos = findNearestPastAnchor(pos);
+        assert(anchorPos < (int)(m_anchors.size() - 1));
+        
+        // -1 means findNearestPastAnchor failed
+        if (anchorPos >= 0)
+        {
+            // As in updateManifolds, without a manifold
+            const tgBulletSpringCableAnchor candidate(rb, pos, contact.normal, false, true, NULL);
+            
+            tgBulletSpringCableAnchor* backAnchor = m_anchors[anchorPos];
+            tgBulletSpringCableAnchor* forwardAnchor = m_anchors[anchorPos + 1];
+            
+            const btScalar lengthA = (m_anchorPositions[anchorPos + 1] - pos).length();
+            const btScalar lengthB = (m_anchorPositions[anchorPos] - pos).length();
+            
+            // An anchor close by on the same rod takes the contact, if it
+            // is still on the rod's surface
+            bool del = false;
+            if (lengthB <= m_resolution && rb == backAnchor->attachedBody && lengthB < lengthA)
+            {
+                del = backAnchor->updateManifold(NULL);
+            }
+            if (lengthA <= m_resolution && rb == forwardAnchor->attachedBody && (!del || lengthA < lengthB))
+            {
+                del = forwardAnchor->updateManifold(NULL) || del;
+            }
+            
+            if (!del)
+            {
+                m_newAnchors.push_back(m_anchorPool.create(candidate));
+            }
+        }
+    }
+}
+
 void tgBulletContactSpringCable::updateAnchorList()
 {
 #ifndef BT_NO_PROFILE 
@@ -371,13 +478,18 @@ void tgBulletContactSpringCable::updateAnchorList()
 #endif //BT_NO_PROFILE    
 	int numContacts = 2;
     
-    btScalar startLength = getActualLength();
+    assert(m_anchorPositions.size() == m_anchors.size());
+    
+    // Kept up to date as anchors are inserted, rather than summed again
+    btScalar length = getActualLength();
+#ifdef VERBOSE
+    const btScalar startLength = length;
+#endif
     
-	while (m_newAnchors.size() > 0)
+	for (std::size_t k = 0; k < m_newAnchors.size(); k++)
 	{
 		// Not permanent, sliding contact
-		tgBulletSpringCableAnchor* const newAnchor = m_newAnchors[0];
-		m_newAnchors.erase(m_newAnchors.begin());
+		tgBulletSpringCableAnchor* const newAnchor = m_newAnchors[k];
 		
 		btVector3 pos1 = newAnchor->getWorldPosition();
 
@@ -392,8 +504,8 @@ void tgBulletContactSpringCable::updateAnchorList()
 			tgBulletSpringCableAnchor* backAnchor = m_anchors[anchorPos];
 			tgBulletSpringCableAnchor* forwardAnchor = m_anchors[anchorPos + 1];
 			
-			btVector3 pos0 = backAnchor->getWorldPosition();
-			btVector3 pos2 = forwardAnchor->getWorldPosition();
+			const btVector3 pos0 = m_anchorPositions[anchorPos];
+			const btVector3 pos2 = m_anchorPositions[anchorPos + 1];
 				
 			btVector3 lineA = (pos2 - pos1);
 			btVector3 lineB = (pos0 - pos1);
@@ -408,8 +520,12 @@ void tgBulletContactSpringCable::updateAnchorList()
 			
 			bool del = false;	
 			
-			btScalar mDistB = backAnchor->getManifoldDistance(newAnchor->getManifold()).first;
-			btScalar mDistA = forwardAnchor->getManifoldDistance(newAnchor->getManifold()).first;
+			// Contacts from tgCableCollision have no manifold, so compare
+			// the distances to the new anchor itself
+			btScalar mDistB = newAnchor->getManifold() ?
+				backAnchor->getManifoldDistance(newAnchor->getManifold()).first : lengthB;
+			btScalar mDistA = newAnchor->getManifold() ?
+				forwardAnchor->getManifoldDistance(newAnchor->getManifold()).first : lengthA;
             
 			//std::cout << "Update anchor list " << newAnchor->getManifold() << std::endl;
 			
@@ -434,11 +550,11 @@ void tgBulletContactSpringCable::updateAnchorList()
             
 			if (del)
 			{
-				delete newAnchor;
+				m_anchorPool.release(newAnchor);
 			}
 			else if(normalValue1 < 0.0 || normalValue2 < 0.0)
 			{
-				delete newAnchor;
+				m_anchorPool.release(newAnchor);
 			}
 			else if ((backNormal.dot(contactNormal) < 0.0 && newAnchor->attachedBody == backAnchor->attachedBody) || 
                         (forwardNormal.dot(contactNormal) < 0.0 && newAnchor->attachedBody == forwardAnchor->attachedBody))
@@ -447,7 +563,7 @@ void tgBulletContactSpringCable::updateAnchorList()
                 std::cout << "Deleting based on contact normals! " << backNormal.dot(contactNormal);
                 std::cout << " " << forwardNormal.dot(contactNormal) << std::endl;
 #endif
-                delete newAnchor;
+                m_anchorPool.release(newAnchor);
             }
 			else
 			{		
@@ -455,14 +571,21 @@ void tgBulletContactSpringCable::updateAnchorList()
 				m_anchorIt = m_anchors.begin() + anchorPos + 1;
 			    
 				m_anchorIt = m_anchors.insert(m_anchorIt, newAnchor);
+				m_anchorPositions.insert(m_anchorPositions.begin() + anchorPos + 1, pos1);
+				
+				// The new anchor replaces the segment from pos0 to pos2
+				const btScalar lengthChange = lengthA + lengthB - (pos2 - pos0).length();
+				length += lengthChange;
 
 #if (1) // Keeps the energy down very well
-                if (getActualLength() > m_prevLength + 2.0 * m_resolution)
+                if (length > m_prevLength + 2.0 * m_resolution)
                 {
 #ifdef VERBOSE 
                     std::cout << "Deleting anchor on basis of length " << std::endl;
 #endif
                     deleteAnchor(anchorPos + 1);
+                    m_anchorPositions.erase(m_anchorPositions.begin() + anchorPos + 1);
+                    length -= lengthChange;
                 }
                 else
                 {
@@ -473,16 +596,17 @@ void tgBulletContactSpringCable::updateAnchorList()
 #endif
                 
 #ifdef VERBOSE                
-                std::cout << "Prev: " << m_prevLength << " LengthDiff " << startLength << " " << getActualLength();
+                std::cout << "Prev: " << m_prevLength << " LengthDiff " << startLength << " " << length;
                 std::cout << " Anchors " << m_anchors.size() << std::endl;
 #endif
 			}
 		}
 		else
 		{
-			delete newAnchor;
+			m_anchorPool.release(newAnchor);
 		}
 	}
+	m_newAnchors.clear();
    
     //std::cout << "contacts " << numContacts << " unprunedAnchors " << m_anchors.size();
     
@@ -689,9 +813,16 @@ void tgBulletContactSpringCable::updateCollisionObject()
 	btDispatcher* m_dispatcher = tgBulletUtil::worldToDynamicsWorld(m_world).getDispatcher();
 	btBroadphaseInterface* const m_overlappingPairCache = tgBulletUtil::worldToDynamicsWorld(m_world).getBroadphase();
 	
-    // Clear the existing child shapes
     btCompoundShape* m_compoundShape = tgCast::cast<btCollisionShape, btCompoundShape> (m_ghostObject->getCollisionShape());
-    clearCompoundShape(m_compoundShape);
+    
+    // The placeholder child from tgBasicContactCableInfo is replaced by
+    // segment shapes the first time through
+    if (m_segmentShapes.size() != (std::size_t) m_compoundShape->getNumChildShapes())
+    {
+        clearCompoundShape(m_compoundShape);
+        m_segmentShapes.clear();
+        m_segmentAnchors.clear();
+    }
     
     btVector3 maxes(anchor2->getWorldPosition());
     btVector3 mins(anchor1->getWorldPosition());
@@ -715,10 +846,17 @@ void tgBulletContactSpringCable::updateCollisionObject()
     }
     btVector3 center = (maxes + mins)/2.0;
     
-    btVector3 from = anchor1->getWorldPosition();
-	btVector3 to = anchor2->getWorldPosition();
+    // Segments the anchors no longer need go to the pool, from the end
+    // so the others keep their child indices
+    const std::size_t segments = n - 1;
+    while (m_segmentShapes.size() > segments)
+    {
+        m_compoundShape->removeChildShapeByIndex(m_segmentShapes.size() - 1);
+        m_segmentPool.push_back(m_segmentShapes.back());
+        m_segmentShapes.pop_back();
+    }
 	
-    for (std::size_t i = 0; i < n-1; i++)
+    for (std::size_t i = 0; i < segments; i++)
     {
         btVector3 pos1 = m_anchors[i]->getWorldPosition();
         btVector3 pos2 = m_anchors[i+1]->getWorldPosition();
@@ -727,13 +865,36 @@ void tgBulletContactSpringCable::updateCollisionObject()
         btTransform t = tgUtil::getTransform(pos2, pos1);
         t.setOrigin(t.getOrigin() - center);
         
-        btScalar length = (pos2 - pos1).length() / 2.0;
+        // The shapes have a unit half length, so scaling by the half
+        // length is the same as building them at that length. Kept off
+        // zero, since Bullet divides by the old scaling on the next change
+        const btScalar length = btMax(btScalar((pos2 - pos1).length() / 2.0), btScalar(SIMD_EPSILON));
+        const btVector3 scaling(1.0, length, 1.0);
 		
-        /// @todo - seriously examine box vs cylinder shapes
-        btCylinderShape* box = new btCylinderShape(btVector3(m_thickness, length, m_thickness));
-        
-        m_compoundShape->addChildShape(t, box);
+        if (i < m_segmentShapes.size())
+        {
+            m_segmentShapes[i]->setLocalScaling(scaling);
+            m_compoundShape->updateChildTransform(i, t, false);
+        }
+        else
+        {
+            /// @todo - seriously examine box vs cylinder shapes
+            btCylinderShape* box;
+            if (m_segmentPool.empty())
+            {
+                box = new btCylinderShape(btVector3(m_thickness, 1.0, m_thickness));
+            }
+            else
+            {
+                box = m_segmentPool.back();
+                m_segmentPool.pop_back();
+            }
+            box->setLocalScaling(scaling);
+            m_compoundShape->addChildShape(t, box);
+            m_segmentShapes.push_back(box);
+        }
     }
+    m_compoundShape->recalculateLocalAabb();
     // Default margin is 0.04, so larger than default thickness. Behavior is better with larger margin
     //m_compoundShape->setMargin(m_thickness);
     
@@ -741,11 +902,16 @@ void tgBulletContactSpringCable::updateCollisionObject()
     transform.setOrigin(center);
     transform.setRotation(btQuaternion::getIdentity());
     
-    m_ghostObject->setCollisionShape (m_compoundShape);
     m_ghostObject->setWorldTransform(transform);
 	
 	// Delete the existing contacts in bullet to prevent sticking - may exacerbate problems with rotations
-	m_overlappingPairCache->getOverlappingPairCache()->cleanProxyFromPairs(m_ghostObject->getBroadphaseHandle(),m_dispatcher);
+	// Bullet keeps one pair per object, so this is done only when the
+	// segments themselves changed, not every time they move
+	if (m_anchors != m_segmentAnchors)
+	{
+		m_overlappingPairCache->getOverlappingPairCache()->cleanProxyFromPairs(m_ghostObject->getBroadphaseHandle(),m_dispatcher);
+		m_segmentAnchors = m_anchors;
+	}
 }
 
 void tgBulletContactSpringCable::deleteCollisionShape(btCollisionShape* pShape)
@@ -788,6 +954,18 @@ void tgBulletContactSpringCable::clearCompoundShape(btCompoundShape* pShape)
 	
 }
 
+void tgBulletContactSpringCable::destroyAnchor(tgBulletSpringCableAnchor* pAnchor)
+{
+    if (m_anchorPool.owns(pAnchor))
+    {
+        m_anchorPool.release(pAnchor);
+    }
+    else
+    {
+        delete pAnchor;
+    }
+}
+
 bool tgBulletContactSpringCable::deleteAnchor(int i)
 {
 #ifndef BT_NO_PROFILE 
@@ -797,7 +975,7 @@ bool tgBulletContactSpringCable::deleteAnchor(int i)
 	
 	if (m_anchors[i]->permanent != true)
 	{
-		delete m_anchors[i];
+		destroyAnchor(m_anchors[i]);
 		m_anchors.erase(m_anchors.begin() + i);
 		return true;
 	}
@@ -817,13 +995,13 @@ int tgBulletContactSpringCable::findNearestPastAnchor(btVector3& pos)
 	/// @todo Find a way to make this bidirectional. If its actually closer to anchor2 you may want to integrate backwards
 	/// Also deal with the situation that its between anchors 1 and 2 in distance. How do you consider 3D space??
 	// Start by determining the "correct" position
-	btScalar startDist = (pos - m_anchors[i]->getWorldPosition()).length();
+	btScalar startDist = (pos - m_anchorPositions[i]).length();
 	btScalar dist = startDist;
 	
 	while (dist <= startDist && i < n)
 	{
 		i++;
-		btVector3 anchorPos = m_anchors[i]->getWorldPosition();
+		btVector3 anchorPos = m_anchorPositions[i];
 		dist = (pos - anchorPos).length();
 		if (dist < startDist)
 		{
@@ -849,25 +1027,19 @@ int tgBulletContactSpringCable::findNearestPastAnchor(btVector3& pos)
 	else if (n > 1)
 	{
 		// Know we've got 3 anchors, so we need to compare along the line
-		tgBulletSpringCableAnchor* a0 = m_anchors[i - 1];
-		tgBulletSpringCableAnchor* an = m_anchors[i + 1];
-		
-		tgBulletContactSpringCable::anchorCompare m_acTemp(a0, an);
+		const btVector3& p0 = m_anchorPositions[i - 1];
+		const btVector3& pn = m_anchorPositions[i + 1];
 		
-		btVector3 current = m_anchors[i]->getWorldPosition();
+		const btVector3& current = m_anchorPositions[i];
 		
-		m_acTemp.comparePoints(pos, current) ? i-- : i+=0;
+		anchorCompare::comparePoints(p0, pn, pos, current) ? i-- : i+=0;
 		
-		assert((m_anchors[i]->getWorldPosition() - pos).length() <= (a0->getWorldPosition() - pos).length()); 
+		assert((m_anchorPositions[i] - pos).length() <= (p0 - pos).length()); 
 	}
 	
 	// Check to make sure it's actually in this line
-	tgBulletSpringCableAnchor* a0 = m_anchors[i];
-	tgBulletSpringCableAnchor* an = m_anchors[i + 1];
-	
-	btVector3 current = a0->getWorldPosition();
-	tgBulletContactSpringCable::anchorCompare m_acTemp(a0, an);
-	if( m_acTemp.comparePoints(current, pos))
+	const btVector3& current = m_anchorPositions[i];
+	if (anchorCompare::comparePoints(current, m_anchorPositions[i + 1], current, pos))
 	{
 		// Success! do nothing, move on
 	}
@@ -875,7 +1047,7 @@ int tgBulletContactSpringCable::findNearestPastAnchor(btVector3& pos)
 	{
 		//std::cout << "iterating backwards!" << std::endl;
 		// Start over, iterate from the back, see if its better
-		btScalar endDist = (pos - m_anchors[n]->getWorldPosition()).length();
+		btScalar endDist = (pos - m_anchorPositions[n]).length();
 		btScalar dist2 = endDist;
 		
 		int j = n;
@@ -883,7 +1055,7 @@ int tgBulletContactSpringCable::findNearestPastAnchor(btVector3& pos)
 		while (dist2 <= endDist && j > 0)
 		{
 			j--;
-			btVector3 anchorPos = m_anchors[j]->getWorldPosition();
+			btVector3 anchorPos = m_anchorPositions[j];
 			dist2 = (pos - anchorPos).length();
 			if (dist2 < endDist)
 			{
@@ -903,26 +1075,20 @@ int tgBulletContactSpringCable::findNearestPastAnchor(btVector3& pos)
 		else if (n > 1)
 		{
 			// Know we've got 3 anchors, so we need to compare along the line
-			tgBulletSpringCableAnchor* a0 = m_anchors[j - 1];
-			tgBulletSpringCableAnchor* an = m_anchors[j + 1];
-			
-			tgBulletContactSpringCable::anchorCompare m_acTemp(a0, an);
+			const btVector3& p0 = m_anchorPositions[j - 1];
+			const btVector3& pn = m_anchorPositions[j + 1];
 			
-			btVector3 current = m_anchors[j]->getWorldPosition();
+			const btVector3& current = m_anchorPositions[j];
 			
-			m_acTemp.comparePoints(pos, current) ? j-- : j+=0;
+			anchorCompare::comparePoints(p0, pn, pos, current) ? j-- : j+=0;
 			
 			// This assert doesn't work due to iteration order. Is there a comparable assert?
-			//assert((m_anchors[j]->getWorldPosition() - pos).length() <= (a0->getWorldPosition() - pos).length());
+			//assert((m_anchorPositions[j] - pos).length() <= (p0 - pos).length());
 		}
 		
 		// Check to make sure it's actually in this line
-		tgBulletSpringCableAnchor* a0 = m_anchors[j];
-		tgBulletSpringCableAnchor* an = m_anchors[j + 1];
-		
-		btVector3 current = a0->getWorldPosition();
-		tgBulletContactSpringCable::anchorCompare m_acTemp(a0, an);
-		if( m_acTemp.comparePoints(current, pos))
+		const btVector3& current = m_anchorPositions[j];
+		if (anchorCompare::comparePoints(current, m_anchorPositions[j + 1], current, pos))
 		{
 			// Success! Set i to j and return
 			i = j;
@@ -967,14 +1133,28 @@ bool tgBulletContactSpringCable::anchorCompare::operator() (const tgBulletSpring
 bool tgBulletContactSpringCable::anchorCompare::comparePoints(btVector3& pt2, btVector3& pt3) const
 {
 	// @todo make sure these are good anchors. Assert?
-	   btVector3 pt1 = ma1->getWorldPosition();
-	   btVector3 ptN = ma2->getWorldPosition();
-	   
+	return comparePoints(ma1->getWorldPosition(), ma2->getWorldPosition(), pt2, pt3);
+}
+
+bool tgBulletContactSpringCable::anchorCompare::comparePoints(const btVector3& pt1,
+                                                               const btVector3& ptN,
+                                                               const btVector3& pt2,
+                                                               const btVector3& pt3)
+{
 	   btScalar lhDot = (ptN - pt1).dot(pt2);
 	   btScalar rhDot = (ptN - pt1).dot(pt3);
 	   
 	   return lhDot < rhDot;
+}
 
+void tgBulletContactSpringCable::cacheAnchorPositions()
+{
+	const std::size_t n = m_anchors.size();
+	m_anchorPositions.resize(n);
+	for (std::size_t i = 0; i < n; i++)
+	{
+		m_anchorPositions[i] = m_anchors[i]->getWorldPosition();
+	}
 }
 
 bool tgBulletContactSpringCable::invariant(void) const
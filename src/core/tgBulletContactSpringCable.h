@@ -29,19 +29,23 @@
 
 // NTRT
 #include "core/tgBulletSpringCable.h"
+#include "core/tgBulletSpringCableAnchorPool.h"
 // The Bullet Physics library
 #include "LinearMath/btScalar.h"
 #include "LinearMath/btVector3.h"
 // The C++ Standard Library
 
+#include <cstddef>
 #include <vector>
 
 // Forward references
 class tgWorld;
+class tgCableCollision;
 class tgBulletSpringCableAnchor;
 class btRigidBody;
 class btCollisionShape;
 class btCompoundShape;
+class btCylinderShape;
 class btPairCachingGhostObject;
 class btDynamicsWorld;
 
@@ -52,6 +56,11 @@ class btDynamicsWorld;
  * shape of the string. Anchors track their associated btPersistentManifold
  * to determine whether they are still in contact with the rigid object. The string
  * is massless, but collision handling should conserve momentum (see unit tests)
+ *
+ * In a world with tgWorld::Config::cableCollisionCell set, the ghost object
+ * only meets static bodies; the cable's segments are registered with the
+ * world's tgCableCollision, and its sliding anchors on moving rods come from
+ * that instead, tracking the rods' capsules rather than a manifold.
  * 
  * This could eventually be merged with Corde for a massive, low node
  * string. Merging with Corde could also address some of the current
@@ -108,10 +117,10 @@ public:
     virtual void step(double dt);
     
     /**
-     * @return a btScalar of the string's actual length - the sum of the
-     * lengths between the anchors.
+     * @return the string's actual length - the sum of the lengths
+     * between the anchors, added up in double whatever btScalar is.
      */
-    virtual const btScalar getActualLength() const;
+    virtual const double getActualLength() const;
     
 private:
     
@@ -134,6 +143,12 @@ private:
 		 */
         bool comparePoints(btVector3& pt2, btVector3& pt3) const;
         
+        /**
+         * As above, for the line between the positions pt1 and ptN
+         */
+        static bool comparePoints(const btVector3& pt1, const btVector3& ptN,
+                                  const btVector3& pt2, const btVector3& pt3);
+        
         private:
            const tgBulletSpringCableAnchor* const ma1;
            const tgBulletSpringCableAnchor* const ma2;
@@ -154,6 +169,12 @@ private:
      */
     void updateManifolds();
     
+    /**
+     * As updateManifolds, for the contacts tgCableCollision found with
+     * moving rods. New anchors have no manifold.
+     */
+    void addCapsuleContacts();
+    
     /**
      * Iterates through the list of new anchors created by updateManifolds
      * and checks whether new anchors are in the same position as
@@ -179,9 +200,11 @@ private:
     void pruneAnchors();
     
     /**
-     * Uses m_anchors to update the collision shape of the m_ghostObject
-     * Also resets the broadphase's pairCache after collision object
-     * is changed.
+     * Uses m_anchors to update the collision shape of the m_ghostObject.
+     * The segment shapes are resized and moved in place, with shapes
+     * added from or returned to m_segmentPool as the anchor count
+     * changes. Also resets the broadphase's pairCache when the anchors
+     * have changed since the last update.
      */
     void updateCollisionObject();
     
@@ -206,6 +229,13 @@ private:
      */
     bool deleteAnchor(int i);
     
+    /**
+     * Free an anchor from m_anchors, whether it came from m_anchorPool
+     * or was allocated by the builder.
+     * @param[in] pAnchor the anchor to be freed
+     */
+    void destroyAnchor(tgBulletSpringCableAnchor* pAnchor);
+    
     /**
      * Find the anchor closest to this position in space, then return
      * the index of the anchor that would immediately proceed it
@@ -213,11 +243,18 @@ private:
      * and updateAnchorList()
      * @param[in] the position of the contact or anchor in question
      * @return the index of the relevant anchor
+     * Reads m_anchorPositions, so only valid between updateManifolds()
+     * and pruneAnchors()
      * @todo Introduce more flexibility to this function for contacts
      * between the two anchors that are not along a line 
      */
     int findNearestPastAnchor(btVector3& pos);
     
+    /**
+     * Fill m_anchorPositions from m_anchors
+     */
+    void cacheAnchorPositions();
+    
     /**
      * An iterator over a list of tgBulletSpringCableAnchors. Used to insert new
      * anchors during updateAnchorList()
@@ -230,6 +267,21 @@ private:
      */
     std::vector<tgBulletSpringCableAnchor*> m_newAnchors;
     
+    /**
+     * Storage for the sliding anchors, in m_newAnchors and m_anchors.
+     * The permanent anchors are allocated by the builder.
+     */
+    tgBulletSpringCableAnchorPool m_anchorPool;
+    
+    /**
+     * The world positions of m_anchors, in the same order. Anchors don't
+     * move between updateManifolds() and pruneAnchors(), so these are
+     * looked up once at the start of updateManifolds() and kept in step
+     * with m_anchors by updateAnchorList(), rather than recomputed from
+     * the body transforms for every contact
+     */
+    std::vector<btVector3> m_anchorPositions;
+    
     /**
      * A reference to the dynamics world so that we can track the
      * contact points in the broadphase's pairCache and remove
@@ -258,7 +310,26 @@ protected:
 	 */
 	const double m_resolution;
 
-private:    
+private:
+    
+    /**
+     * The ghost object's child shapes, one per pair of neighbouring
+     * anchors, in child order. Owned by the compound shape.
+     */
+    std::vector<btCylinderShape*> m_segmentShapes;
+    
+    /** Segment shapes not in the compound shape. We own these. */
+    std::vector<btCylinderShape*> m_segmentPool;
+    
+    /** m_anchors as of the last reset of the pairCache */
+    std::vector<tgBulletSpringCableAnchor*> m_segmentAnchors;
+    
+    /** The world's capsule collision, or NULL. The world owns this. */
+    tgCableCollision* const m_pCollision;
+    
+    /** Our id in m_pCollision */
+    std::size_t m_collisionId;
+    
     bool invariant() const;
 };
 
@@ -45,13 +45,34 @@
 // The Bullet Physics library
 #include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
 // The C++ Standard Library
+#include <algorithm>
 #include <cassert>
+#include <limits>
+#include <stdexcept>
 
 
-tgBulletRenderer::tgBulletRenderer(const tgWorld& world) : m_world(world)
+tgBulletRenderer::tgBulletRenderer(const tgWorld& world) :
+  m_world(world),
+  m_eye(0.0, 0.0, 0.0),
+  m_detailDistance(std::numeric_limits<double>::max()),
+  m_drawDistance(std::numeric_limits<double>::max())
 {
 }
 
+void tgBulletRenderer::setCableDetail(const btVector3& eye,
+                                      double detailDistance,
+                                      double drawDistance)
+{
+  if (!(drawDistance > 0.0) || !(detailDistance > 0.0) ||
+      detailDistance > drawDistance)
+  {
+    throw std::invalid_argument("Cable detail distances are out of order");
+  }
+  m_eye = eye;
+  m_detailDistance = detailDistance;
+  m_drawDistance = drawDistance;
+}
+
 void tgBulletRenderer::render(const tgRod& rod) const
 {
 #ifndef BT_NO_PROFILE 
@@ -76,23 +97,40 @@ void tgBulletRenderer::render(const tgSpringCableActuator& mSCA) const
     if(pDrawer && pSpringCable)
     {
 		const std::vector<const tgSpringCableAnchor*>& anchors = pSpringCable->getAnchors();
+		// Should this be normalized??
+		const double stretch = 
+		  mSCA.getCurrentLength() - mSCA.getRestLength();
+		const btVector3 color =
+		  (stretch < 0.0) ?
+		  btVector3(0.0, 0.0, 1.0) :
+		  btVector3(0.5 + stretch / 3.0, 
+			    0.5 - stretch / 2.0, 
+			    0.0);
+		btVector3 lineFrom = anchors[0]->getWorldPosition();
 		std::size_t n = anchors.size() - 1;
+		if (m_detailDistance < std::numeric_limits<double>::max())
+		{
+		  const btVector3 end = anchors[n]->getWorldPosition();
+		  const double distance =
+		    std::min(lineFrom.distance(m_eye), end.distance(m_eye));
+		  if (distance > m_drawDistance)
+		  {
+		    return;
+		  }
+		  else if (distance > m_detailDistance)
+		  {
+		    // Too far for the anchors in between to show
+		    pDrawer->drawLine(lineFrom, end, color);
+		    return;
+		  }
+		}
+		// Each anchor ends one segment and starts the next
 		for (std::size_t i = 0; i < n; i++)
 		{
-			const btVector3 lineFrom =
-			anchors[i]->getWorldPosition();
 		  const btVector3 lineTo = 
 			anchors[i+1]->getWorldPosition();
-		   // Should this be normalized??
-		  const double stretch = 
-			mSCA.getCurrentLength() - mSCA.getRestLength();
-		  const btVector3 color =
-			(stretch < 0.0) ?
-			btVector3(0.0, 0.0, 1.0) :
-			btVector3(0.5 + stretch / 3.0, 
-				  0.5 - stretch / 2.0, 
-				  0.0);
 		  pDrawer->drawLine(lineFrom, lineTo, color);
+		  lineFrom = lineTo;
 		}
 	}
 }
@@ -28,6 +28,8 @@
 
 // This application
 #include "tgModelVisitor.h"
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
 
 // Forward declarations
 class tgSpringCableActuator;
@@ -49,6 +51,20 @@ public:
    */
   tgBulletRenderer(const tgWorld& world);
 
+  /**
+   * Draw the spring-cable actuators whose nearer end is further than
+   * detailDistance from eye as one line between their end anchors, and
+   * skip those further than drawDistance. By default every cable is drawn
+   * in full.
+   * @param[in] eye the camera position
+   * @param[in] detailDistance must not be more than drawDistance
+   * @param[in] drawDistance must be positive
+   * @throw std::invalid_argument if the distances are out of order or
+   * not positive
+   */
+  void setCableDetail(const btVector3& eye, double detailDistance,
+                      double drawDistance);
+
   /**
    * Render a tgSpringCableActuator.
    * @param[in] linearString a const reference to a tgSpringCableActuator to render
@@ -79,6 +95,11 @@ private:
    * A reference to the tgWorld being rendered.
    */
   const tgWorld& m_world;
+
+  /** Set by setCableDetail */
+  btVector3 m_eye;
+  double m_detailDistance;
+  double m_drawDistance;
 };
 
 #endif
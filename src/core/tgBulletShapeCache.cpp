@@ -0,0 +1,197 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBulletShapeCache.cpp
+ * @brief Contains the definitions of members of class tgBulletShapeCache
+ * $Id$
+ */
+
+// This module
+#include "tgBulletShapeCache.h"
+// The Bullet Physics library
+#include "BulletCollision/CollisionShapes/btBoxShape.h"
+#include "BulletCollision/CollisionShapes/btCylinderShape.h"
+#include "BulletCollision/CollisionShapes/btSphereShape.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cassert>
+#include <map>
+#include <pthread.h>
+
+namespace
+{
+    enum ShapeType
+    {
+        eCylinder,
+        eBox,
+        eSphere
+    };
+
+    /** A shape's type and the exact arguments it was constructed with */
+    struct ShapeKey
+    {
+        ShapeType type;
+        btScalar dimensions[3];
+
+        bool operator<(const ShapeKey& other) const
+        {
+            if (type != other.type)
+            {
+                return type < other.type;
+            }
+            for (int i = 0; i < 3; ++i)
+            {
+                if (dimensions[i] != other.dimensions[i])
+                {
+                    return dimensions[i] < other.dimensions[i];
+                }
+            }
+            return false;
+        }
+    };
+
+    struct CachedShape
+    {
+        btCollisionShape* pShape;
+        int refs;
+    };
+
+    /**
+     * How many unreferenced shapes are kept before they are all deleted.
+     * Enough for the rigids of several models across a reset.
+     */
+    const int kMaxUnusedShapes = 1024;
+
+    // Worlds may be built on several tgParallelSimulation threads at once
+    pthread_mutex_t s_shapeMutex = PTHREAD_MUTEX_INITIALIZER;
+    std::map<ShapeKey, CachedShape> s_shapes;
+    std::map<btCollisionShape*, ShapeKey> s_keys;
+    int s_unusedShapes = 0;
+
+    btCollisionShape* createShape(const ShapeKey& key)
+    {
+        const btVector3 dimensions(key.dimensions[0], key.dimensions[1],
+                                   key.dimensions[2]);
+        switch (key.type)
+        {
+        case eCylinder:
+            return new btCylinderShape(dimensions);
+        case eBox:
+            return new btBoxShape(dimensions);
+        case eSphere:
+            return new btSphereShape(key.dimensions[0]);
+        }
+        assert(false);
+        return NULL;
+    }
+
+    btCollisionShape* acquire(ShapeType type, const btVector3& dimensions)
+    {
+        ShapeKey key;
+        key.type = type;
+        key.dimensions[0] = dimensions.x();
+        key.dimensions[1] = dimensions.y();
+        key.dimensions[2] = dimensions.z();
+
+        pthread_mutex_lock(&s_shapeMutex);
+        std::map<ShapeKey, CachedShape>::iterator it = s_shapes.find(key);
+        if (it == s_shapes.end())
+        {
+            CachedShape cached;
+            cached.pShape = createShape(key);
+            cached.refs = 0;
+            it = s_shapes.insert(std::make_pair(key, cached)).first;
+            s_keys[cached.pShape] = key;
+        }
+        else if (it->second.refs == 0)
+        {
+            --s_unusedShapes;
+        }
+        ++it->second.refs;
+        btCollisionShape* const pShape = it->second.pShape;
+        pthread_mutex_unlock(&s_shapeMutex);
+        return pShape;
+    }
+
+    /** Delete every shape nobody holds. Call with s_shapeMutex held. */
+    void purgeUnused()
+    {
+        std::map<ShapeKey, CachedShape>::iterator it = s_shapes.begin();
+        while (it != s_shapes.end())
+        {
+            if (it->second.refs == 0)
+            {
+                s_keys.erase(it->second.pShape);
+                delete it->second.pShape;
+                s_shapes.erase(it++);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        s_unusedShapes = 0;
+    }
+
+    /**
+     * Deletes the shapes nobody holds at exit. Defined after s_shapes, so
+     * it is destroyed first.
+     */
+    struct ExitPurge
+    {
+        ~ExitPurge()
+        {
+            pthread_mutex_lock(&s_shapeMutex);
+            purgeUnused();
+            pthread_mutex_unlock(&s_shapeMutex);
+        }
+    } s_exitPurge;
+}
+
+btCollisionShape* tgBulletShapeCache::acquireCylinder(const btVector3& halfExtents)
+{
+    return acquire(eCylinder, halfExtents);
+}
+
+btCollisionShape* tgBulletShapeCache::acquireBox(const btVector3& halfExtents)
+{
+    return acquire(eBox, halfExtents);
+}
+
+btCollisionShape* tgBulletShapeCache::acquireSphere(double radius)
+{
+    return acquire(eSphere, btVector3(radius, 0.0, 0.0));
+}
+
+void tgBulletShapeCache::release(btCollisionShape* pShape)
+{
+    pthread_mutex_lock(&s_shapeMutex);
+    std::map<btCollisionShape*, ShapeKey>::const_iterator key = s_keys.find(pShape);
+    assert(key != s_keys.end());
+    if (key != s_keys.end())
+    {
+        CachedShape& cached = s_shapes[key->second];
+        assert(cached.refs > 0);
+        if (--cached.refs == 0 && ++s_unusedShapes > kMaxUnusedShapes)
+        {
+            purgeUnused();
+        }
+    }
+    pthread_mutex_unlock(&s_shapeMutex);
+}
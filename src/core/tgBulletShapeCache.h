@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_BULLET_SHAPE_CACHE_H
+#define TG_BULLET_SHAPE_CACHE_H
+
+/**
+ * @file tgBulletShapeCache.h
+ * @brief Contains the definition of class tgBulletShapeCache
+ * $Id$
+ */
+
+// Forward declarations
+class btCollisionShape;
+class btVector3;
+
+/**
+ * A process-wide pool of primitive collision shapes, so that rigids of the
+ * same type and dimensions share one btCollisionShape, in one world and
+ * across worlds, including the worlds made by tgWorld::reset and those
+ * stepped by tgParallelSimulation.
+ *
+ * Shapes are reference counted. A shape nobody holds is kept for the next
+ * world to ask for it, until more than a fixed number of such shapes have
+ * piled up, and then all of them are deleted, as they are at exit. Shared
+ * shapes must not be changed, e.g. with setLocalScaling or setMargin. Safe
+ * to call from several threads.
+ *
+ * Use this through tgWorldBulletPhysicsImpl, which gives back its
+ * references when it is destroyed.
+ */
+class tgBulletShapeCache
+{
+public:
+
+    /**
+     * Get a btCylinderShape, taking a reference.
+     * @param[in] halfExtents as for the btCylinderShape constructor
+     */
+    static btCollisionShape* acquireCylinder(const btVector3& halfExtents);
+
+    /**
+     * Get a btBoxShape, taking a reference.
+     * @param[in] halfExtents as for the btBoxShape constructor
+     */
+    static btCollisionShape* acquireBox(const btVector3& halfExtents);
+
+    /**
+     * Get a btSphereShape, taking a reference.
+     * @param[in] radius as for the btSphereShape constructor
+     */
+    static btCollisionShape* acquireSphere(double radius);
+
+    /**
+     * Give back a reference taken by one of the acquire functions.
+     * @param[in] pShape a shape from this cache
+     */
+    static void release(btCollisionShape* pShape);
+};
+
+#endif  // TG_BULLET_SHAPE_CACHE_H
@@ -25,6 +25,9 @@
 // This module
 #include "tgBulletSpringCable.h"
 #include "tgBulletSpringCableAnchor.h"
+#include "tgBulletCableForceEngine.h"
+#include "tgBulletUtil.h"
+#include "tgCablePipeline.h"
 #include "tgCast.h"
 // The BulletPhysics library
 #include "BulletDynamics/Dynamics/btRigidBody.h"
@@ -40,7 +43,13 @@ tgSpringCable(tgCast::filter<tgBulletSpringCableAnchor, tgSpringCableAnchor>(anc
                 coefK, dampingCoefficient, pretension),
 m_anchors(anchors),
 anchor1(anchors.front()),
-anchor2(anchors.back())
+anchor2(anchors.back()),
+m_pForceEngine(NULL),
+m_implicitForces(false),
+m_velocityFromBodies(false),
+m_wakeImpulse(-1.0),
+m_appliedImpulse1(0.0, 0.0, 0.0),
+m_appliedImpulse2(0.0, 0.0, 0.0)
 {
     assert(m_anchors.size() >= 2);
     assert(invariant());
@@ -54,6 +63,11 @@ tgBulletSpringCable::~tgBulletSpringCable()
     std::cout << "Destroying tgBulletSpringCable" << std::endl;
     #endif
     
+    if (m_pForceEngine != NULL)
+    {
+        m_pForceEngine->removeCable(this);
+    }
+    
     std::size_t n = m_anchors.size();
     
     // Make absolutely sure these are deleted, in case we have a poorly timed reset
@@ -83,12 +97,31 @@ void tgBulletSpringCable::step(double dt)
         throw std::invalid_argument("dt is not positive!");
     }
 
-    calculateAndApplyForce(dt);
+    // A registered cable has its force applied at the next world step
+    if (m_pForceEngine == NULL)
+    {
+        calculateAndApplyForce(dt);
+    }
     assert(invariant());
 }
 
+void tgBulletSpringCable::setImplicitForces(bool implicit)
+{
+    if (implicit && m_pForceEngine != NULL)
+    {
+        throw std::logic_error("A batched cable cannot use implicit forces");
+    }
+    m_implicitForces = implicit;
+}
+
 void tgBulletSpringCable::calculateAndApplyForce(double dt)
 {
+    if (m_implicitForces)
+    {
+        calculateAndApplyImplicitForce(dt);
+        return;
+    }
+    
     btVector3 force(0.0, 0.0, 0.0);
     double magnitude = 0.0;
     const btVector3 dist =
@@ -97,30 +130,23 @@ void tgBulletSpringCable::calculateAndApplyForce(double dt)
     // These computations should occur for history regardless of motion
     const double currLength = dist.length();
     const btVector3 unitVector = dist / currLength;
-    const double stretch = currLength - m_restLength;
-    
-    magnitude =  m_coefK * stretch;
-    
-    const double deltaStretch = currLength - m_prevLength;
-    m_velocity = deltaStretch / dt;
     
-    m_damping =  m_dampingCoefficient * m_velocity;
-    
-    if (abs(magnitude) * 1.0 < abs(m_damping))
+    if (m_velocityFromBodies)
     {
-        m_damping =
-          (m_damping > 0.0 ? magnitude * 1.0 : -magnitude * 1.0);
+        m_velocity = lengthRateFromBodies(unitVector);
+    }
+    else
+    {
+        const double deltaStretch = currLength - m_prevLength;
+        m_velocity = deltaStretch / dt;
     }
     
-    magnitude += m_damping;
-    
-    #if (0)
-    std::cout << "Length: " << dist.length() << " rl: " << m_restLength <<std::endl; 
-    #endif
-      
-    if (dist.length() > m_restLength)
-    {   
-        force = unitVector * magnitude; 
+    magnitude = tgLinearTensionLaw::tension(m_coefK, m_dampingCoefficient,
+                                            currLength, m_restLength,
+                                            m_velocity, m_damping);
+    if (magnitude != 0.0)
+    {
+        force = unitVector * magnitude;
     }
     else
     {
@@ -131,13 +157,77 @@ void tgBulletSpringCable::calculateAndApplyForce(double dt)
     m_prevLength = currLength;
 
     //Now Apply it to the connected two bodies
-    btVector3 point1 = this->anchor1->getRelativePosition();
-    this->anchor1->attachedBody->activate();
-    this->anchor1->attachedBody->applyImpulse(force*dt,point1);
+    applyAnchorImpulses(force*dt);
+}
+
+void tgBulletSpringCable::applyAnchorImpulses(const btVector3& impulse)
+{
+    btRigidBody* const bodyA = anchor1->attachedBody;
+    if (tgBulletUtil::wakeForImpulse(bodyA,
+          (impulse - m_appliedImpulse1).length(), m_wakeImpulse))
+    {
+        bodyA->applyImpulse(impulse, anchor1->getRelativePosition());
+        m_appliedImpulse1 = impulse;
+    }
+
+    btRigidBody* const bodyB = anchor2->attachedBody;
+    if (tgBulletUtil::wakeForImpulse(bodyB,
+          (impulse - m_appliedImpulse2).length(), m_wakeImpulse))
+    {
+        bodyB->applyImpulse(-impulse, anchor2->getRelativePosition());
+        m_appliedImpulse2 = impulse;
+    }
+}
 
-    btVector3 point2 = this->anchor2->getRelativePosition();
-    this->anchor2->attachedBody->activate();
-    this->anchor2->attachedBody->applyImpulse(-force*dt,point2);
+void tgBulletSpringCable::calculateAndApplyImplicitForce(double dt)
+{
+    const btVector3 dist =
+      anchor2->getWorldPosition() - anchor1->getWorldPosition();
+    const double currLength = dist.length();
+    const btVector3 unitVector = dist / currLength;
+    const double stretch = currLength - m_restLength;
+    
+    // Kept for history, as in the explicit force
+    m_velocity = (currLength - m_prevLength) / dt;
+    m_prevLength = currLength;
+    
+    if (stretch <= 0.0)
+    {
+        // Slack
+        m_damping = 0.0;
+        return;
+    }
+    
+    btRigidBody* const bodyA = anchor1->attachedBody;
+    btRigidBody* const bodyB = anchor2->attachedBody;
+    const btVector3 point1 = anchor1->getRelativePosition();
+    const btVector3 point2 = anchor2->getRelativePosition();
+    
+    const double lengthRate = lengthRateFromBodies(unitVector);
+    
+    // Inverse mass of the pair along the cable
+    const btVector3 armA = point1.cross(unitVector);
+    const btVector3 armB = point2.cross(unitVector);
+    const double invMass = bodyA->getInvMass() + bodyB->getInvMass() +
+      armA.dot(bodyA->getInvInertiaTensorWorld() * armA) +
+      armB.dot(bodyB->getInvInertiaTensorWorld() * armB);
+    
+    const double effectiveDamping = m_dampingCoefficient + dt * m_coefK;
+    double magnitude = (m_coefK * stretch + effectiveDamping * lengthRate) /
+      (1.0 + invMass * dt * effectiveDamping);
+    
+    // A cable can only pull
+    magnitude = magnitude > 0.0 ? magnitude : 0.0;
+    m_damping = magnitude - m_coefK * stretch;
+    
+    applyAnchorImpulses(unitVector * (magnitude * dt));
+}
+
+double tgBulletSpringCable::lengthRateFromBodies(const btVector3& unitVector) const
+{
+    return unitVector.dot(
+      anchor2->attachedBody->getVelocityInLocalPoint(anchor2->getRelativePosition()) -
+      anchor1->attachedBody->getVelocityInLocalPoint(anchor1->getRelativePosition()));
 }
 
 const double tgBulletSpringCable::getActualLength() const
@@ -147,6 +237,18 @@ const double tgBulletSpringCable::getActualLength() const
     return dist.length();
 }
 
+void tgBulletSpringCable::setCoefficients(double coefK, double dampingCoefficient)
+{
+    tgSpringCable::setCoefficients(coefK, dampingCoefficient);
+    
+    if (m_pForceEngine != NULL)
+    {
+        m_pForceEngine->updateCable(this);
+    }
+    
+    assert(invariant());
+}
+
 const double tgBulletSpringCable::getTension() const
 {
     double tension = (getActualLength() - m_restLength) * m_coefK;
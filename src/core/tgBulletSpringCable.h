@@ -38,6 +38,7 @@
 class btRigidBody;
 class tgSpringCableAnchor;
 class tgBulletSpringCableAnchor;
+class tgBulletCableForceEngine;
 
 /**
  * This class defines the passive dynamics of a spring-cable system
@@ -47,6 +48,9 @@ class tgBulletSpringCableAnchor;
 class tgBulletSpringCable : public tgSpringCable
 {
 public: 
+    // Computes our forces in a batch when we're registered with it
+    friend class tgBulletCableForceEngine;
+
     /**
      * The only constructor. Takes a list of anchors, a coefficient
      * of stiffness, a coefficent of damping, and optionally the amount
@@ -67,7 +71,8 @@ public:
     virtual ~tgBulletSpringCable();
 
     /**
-     * Updates this object. Calls calculateAndApplyForce(dt)
+     * Updates this object. Calls calculateAndApplyForce(dt), unless
+     * a tgBulletCableForceEngine is computing our forces
      * @param[in] dt, must be positive
      */
     virtual void step(double dt);
@@ -85,6 +90,13 @@ public:
      */
     virtual const double getTension() const;
     
+    /**
+     * Also updates the coefficients a tgBulletCableForceEngine copied
+     * when this cable was registered with it.
+     * @see tgSpringCable::setCoefficients
+     */
+    virtual void setCoefficients(double coefK, double dampingCoefficient);
+    
     /**
      * Returns a const vector of const anchors. Currently
      * casts from tgBulletSpringCableAnchors, which makes it impossible
@@ -93,6 +105,50 @@ public:
      */
     virtual const std::vector<const tgSpringCableAnchor*> getAnchors() const;
     
+    /**
+     * Choose between the explicit force, the default, and a linearly
+     * implicit one that solves for the impulse together with the
+     * velocity change it causes along the cable. The implicit force is
+     * stable for much stiffer cables at a given timestep. It only
+     * applies to the two permanent anchors; tgBulletContactSpringCable
+     * ignores it.
+     * @param[in] implicit true for the implicit force
+     * @throw std::logic_error if a tgBulletCableForceEngine computes
+     * this cable's forces
+     */
+    void setImplicitForces(bool implicit);
+    
+    /**
+     * Take the damping velocity of the explicit force from the anchors'
+     * body velocities rather than from the change in length since the
+     * last step. Needed when the cable is stepped more often than the
+     * bodies move, see tgWorld::Config::cableSubsteps. The implicit
+     * force always uses the body velocities.
+     * @param[in] fromBodies true to use the body velocities
+     */
+    void setVelocityFromBodies(bool fromBodies)
+    {
+        m_velocityFromBodies = fromBodies;
+    }
+    
+    /**
+     * Wake sleeping bodies only for large changes in this cable's
+     * impulse on them; see tgWorld::Config::cableWakeImpulse. A
+     * tgBulletCableForceEngine computing our forces uses its own
+     * threshold, and tgBulletContactSpringCable always wakes its bodies.
+     * @param[in] threshold negative to keep the bodies awake
+     */
+    void setWakeImpulse(double threshold)
+    {
+        m_wakeImpulse = threshold;
+    }
+    
+    /** True if the implicit force is used */
+    bool hasImplicitForces() const
+    {
+        return m_implicitForces;
+    }
+    
 protected:
     
     /**
@@ -115,6 +171,25 @@ protected:
      */
     tgBulletSpringCableAnchor * const anchor2;
     
+    /**
+     * The engine that computes our forces, or NULL if we do it ourselves.
+     * Set and cleared by tgBulletCableForceEngine.
+     */
+    tgBulletCableForceEngine* m_pForceEngine;
+    
+    /** See setImplicitForces */
+    bool m_implicitForces;
+    
+    /** See setVelocityFromBodies */
+    bool m_velocityFromBodies;
+    
+    /** See setWakeImpulse */
+    double m_wakeImpulse;
+    
+    /** The impulse anchor1's body last took; anchor2's took its negative */
+    btVector3 m_appliedImpulse1;
+    btVector3 m_appliedImpulse2;
+    
 private:
     
     /**
@@ -124,6 +199,27 @@ private:
      */
     virtual void calculateAndApplyForce(double dt);
 
+    /**
+     * The implicit version of calculateAndApplyForce. Solves
+     * T = k * (x + dt * v') + c * v' with v' = v - w * T * dt, where x is
+     * the stretch, v the rate of change of length from the bodies'
+     * velocities and w the inverse mass of the pair along the cable.
+     */
+    void calculateAndApplyImplicitForce(double dt);
+
+    /**
+     * The rate of change of length from the velocities of the anchors'
+     * bodies at the anchor points.
+     */
+    double lengthRateFromBodies(const btVector3& unitVector) const;
+
+    /**
+     * Apply an impulse to each permanent anchor's body, waking them as
+     * setWakeImpulse allows.
+     * @param[in] impulse on anchor1's body; anchor2's takes -impulse
+     */
+    void applyAnchorImpulses(const btVector3& impulse);
+
 private: 
     /** Ensures integrity of member variables */
     bool invariant(void) const;
@@ -23,6 +23,8 @@
  */
  
 #include "tgBulletSpringCableAnchor.h"
+#include "tgCableCollision.h"
+#include "tgRigidStateFrame.h"
 
 // The BulletPhysics library
 #include "BulletDynamics/Dynamics/btRigidBody.h"
@@ -58,7 +60,8 @@ tgBulletSpringCableAnchor::tgBulletSpringCableAnchor(btRigidBody * body,
 #else
   contactNormal(cn),
 #endif
-  manifold(m)
+  manifold(m),
+  m_cachedStamp(0)
 {
 	assert(body);
 	
@@ -75,15 +78,26 @@ tgBulletSpringCableAnchor::~tgBulletSpringCableAnchor()
 // This returns current position relative to the rigidbody.
 btVector3 tgBulletSpringCableAnchor::getRelativePosition() const
 {
-    const btTransform tr = attachedBody->getWorldTransform();
-    const btVector3 worldPos = tr * attachedRelativeOriginalPosition;
-    return worldPos-this->attachedBody->getCenterOfMassPosition();
+    return getWorldPosition() - this->attachedBody->getCenterOfMassPosition();
 }
 
 btVector3 tgBulletSpringCableAnchor::getWorldPosition() const
 {
-    const btTransform tr = attachedBody->getWorldTransform();
-    return tr * attachedRelativeOriginalPosition;
+    const tgRigidStateFrame::RigidState* const pState =
+        tgRigidStateFrame::find(attachedBody);
+    if (pState == NULL)
+    {
+        const btTransform tr = attachedBody->getWorldTransform();
+        return tr * attachedRelativeOriginalPosition;
+    }
+    else if (pState->stamp != m_cachedStamp)
+    {
+        // The body's own transform, not the motion state's in the frame
+        m_cachedWorldPosition =
+            attachedBody->getWorldTransform() * attachedRelativeOriginalPosition;
+        m_cachedStamp = pState->stamp;
+    }
+    return m_cachedWorldPosition;
 }
 
 bool tgBulletSpringCableAnchor::setWorldPosition(btVector3& newPos)
@@ -91,7 +105,31 @@ bool tgBulletSpringCableAnchor::setWorldPosition(btVector3& newPos)
 	bool ret = false;
 
 	// Only sliding anchors should have their positions changed
-	if (sliding)
+	if (sliding && manifold == NULL)
+	{
+		// Capsule collision: slide along the body's surface
+		btVector3 surface;
+		btVector3 normal;
+		if (tgCableCollision::closestOnBody(*attachedBody, newPos, surface, normal))
+		{
+			const btScalar length = (surface - newPos).length();
+			if (length < 0.1)
+			{
+				attachedRelativeOriginalPosition = attachedBody->getWorldTransform().inverse() *
+						   newPos;
+				m_cachedStamp = 0;
+#ifdef USE_BASIS
+				normal = attachedBody->getWorldTransform().inverse().getBasis() * normal;
+#endif
+				ret = (normal + contactNormal).length() >= 0.5;
+			}
+			else
+			{
+				ret = (getWorldPosition() - surface).length() <= 0.1;
+			}
+		}
+	}
+	else if (sliding)
 	{
 		/// @todo - this is very similar to getManifoldDistance. Is there a good way to combine them??
 		// Figure out which body to use
@@ -159,6 +197,7 @@ bool tgBulletSpringCableAnchor::setWorldPosition(btVector3& newPos)
 					// Just deleting at this stage is better for sliding, but worse for contact with multiple bodies
 					attachedRelativeOriginalPosition = attachedBody->getWorldTransform().inverse() *
 							   newPos;
+					m_cachedStamp = 0;
 					
 					if ((newNormal + contactNormal).length() < 0.5)
 					{
@@ -218,8 +257,15 @@ btVector3 tgBulletSpringCableAnchor::getContactNormal() const
 bool tgBulletSpringCableAnchor::updateManifold(btPersistentManifold* m)
 {
 	bool ret = false;
+	// A contact from tgCableCollision, for an anchor that has none either
+	if (!m && !manifold && sliding && !permanent)
+	{
+		std::pair<btScalar, btVector3> manifoldValues = getManifoldDistance(NULL);
+		ret = manifoldValues.first < 0.1 &&
+			(manifoldValues.second + contactNormal).length() >= 0.5;
+	}
 	// Does the new manifold actually affect the attached body
-	if (m && (m->getBody0() == attachedBody || m->getBody1() == attachedBody ))
+	else if (m && (m->getBody0() == attachedBody || m->getBody1() == attachedBody ))
 	{
 		std::pair<btScalar, btVector3> manifoldValues = getManifoldDistance(m);
 		btScalar newDist = manifoldValues.first;
@@ -277,7 +323,21 @@ std::pair<btScalar, btVector3> tgBulletSpringCableAnchor::getManifoldDistance(bt
 	btScalar length = INFINITY;
 	btVector3 newNormal = contactNormal;
 	
-    if (!permanent)
+    if (!permanent && m == NULL)
+    {
+        btVector3 surface;
+        btVector3 normal;
+        if (tgCableCollision::closestOnBody(*attachedBody, getWorldPosition(), surface, normal))
+        {
+            length = (surface - getWorldPosition()).length();
+            #ifdef USE_BASIS
+            newNormal = attachedBody->getWorldTransform().inverse().getBasis() * normal;
+            #else
+            newNormal = normal;
+            #endif
+        }
+    }
+    else if (!permanent)
     {
         if (m->getBody0() != attachedBody)
         {
@@ -48,7 +48,9 @@ class tgBulletContactSpringCable;
  * and rotates. They can either be 'non-sliding' which typically means
  * a pin jointed anchor (and are typically permanent), or sliding,
  * which means they track a specific contact point within a
- * btPersistentManifold. 
+ * btPersistentManifold. Sliding anchors of cables collided by
+ * tgCableCollision have no manifold, and track the nearest point on
+ * their body's capsules instead.
  */
 class tgBulletSpringCableAnchor : public tgSpringCableAnchor
 {
@@ -83,21 +85,27 @@ public:
     /**
      * Return the current position of the anchor in world coordinates
      * Uses attachedRelativeOriginalPosition and the attachedBody's
-     * btTransform
+     * btTransform. The result is cached until the world publishes the
+     * body's state again (see tgRigidStateFrame), so force computation,
+     * rendering and sensors transform the anchor once per step. As with
+     * the published states, a body moved between steps leaves the
+     * cached position stale until the next step.
      */
     virtual btVector3 getWorldPosition() const;
 	
 	/**
 	 * Update attachedRelativeOriginalPosition based on the sliding
 	 * of the string. This also checks if the new sliding position
-	 * is still on the body.
+	 * is still on the body: on the manifold's contact points, or on the
+	 * body's capsules if there is no manifold.
 	 * @return bool returns if this point is actually on the body. The
 	 * body should be deleted if this returns false
 	 */
 	virtual bool setWorldPosition(btVector3& newPos);
 	
     /**
-     * Get the position of the point in body coordinaates
+     * Get the position of the point relative to the body's center of
+     * mass, in world coordinates, from the cached world position
      * @return a btVector3 in body coordinates
      */
     virtual btVector3 getRelativePosition() const;
@@ -114,7 +122,9 @@ public:
      * Update our manifold pointer. This memory is often reassigned
      * so the new manifold is accepted if our old manifold no longer
      * contains our rigid body. It is also accepted if its contact point
-     * is closer than our manifold's
+     * is closer than our manifold's. A sliding anchor without a
+     * manifold takes a NULL one, a contact found by tgCableCollision,
+     * if it is still on its body's capsules.
      * @return a bool that is true if the new manifold was accepted
      */
     bool updateManifold(btPersistentManifold* m);
@@ -139,8 +149,10 @@ public:
     /**
      * A pair of the distance between the current world position and 
      * this manifolds contact point, as well as the contact normal
-     * of this manifold
-     * @return distance to the contact, contact normal 
+     * of this manifold. If m is NULL, the distance to and normal of the
+     * nearest point on the body's capsules; see tgCableCollision.
+     * @return distance to the contact, contact normal, or INFINITY if
+     * there is none
      */
     std::pair<btScalar, btVector3> getManifoldDistance(btPersistentManifold* m) const;
     
@@ -165,6 +177,13 @@ private:
 	 * Not const, bullet owns this, and we update it as best we can
 	 */
 	btPersistentManifold* manifold;
+
+	/**
+	 * The world position, and the RigidState::stamp of the body's
+	 * published state it was computed for; 0 when there is none
+	 */
+	mutable btVector3 m_cachedWorldPosition;
+	mutable std::size_t m_cachedStamp;
 	
 };
 
@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgBulletSpringCableAnchorPool.cpp
+ * @brief Contains the definitions of members of class tgBulletSpringCableAnchorPool
+ * $Id$
+ */
+
+// This module
+#include "tgBulletSpringCableAnchorPool.h"
+// This application
+#include "tgBulletSpringCableAnchor.h"
+// The C++ Standard Library
+#include <cassert>
+#include <new>
+#include <stdexcept>
+
+tgBulletSpringCableAnchorPool::tgBulletSpringCableAnchorPool(std::size_t chunkSize) :
+    m_chunkSize(chunkSize)
+{
+    if (chunkSize == 0)
+    {
+        throw std::invalid_argument("chunkSize is not positive");
+    }
+}
+
+tgBulletSpringCableAnchorPool::~tgBulletSpringCableAnchorPool()
+{
+    for (std::size_t i = 0; i < m_chunks.size(); i++)
+    {
+        ::operator delete(m_chunks[i]);
+    }
+}
+
+tgBulletSpringCableAnchor*
+tgBulletSpringCableAnchorPool::create(const tgBulletSpringCableAnchor& candidate)
+{
+    if (m_free.empty())
+    {
+        grow();
+    }
+    void* const pSlot = m_free.back();
+    tgBulletSpringCableAnchor* const pAnchor =
+        new (pSlot) tgBulletSpringCableAnchor(candidate);
+    m_free.pop_back();
+    return pAnchor;
+}
+
+void tgBulletSpringCableAnchorPool::release(tgBulletSpringCableAnchor* pAnchor)
+{
+    if (pAnchor)
+    {
+        assert(owns(pAnchor));
+        pAnchor->~tgBulletSpringCableAnchor();
+        m_free.push_back(pAnchor);
+    }
+}
+
+bool tgBulletSpringCableAnchorPool::owns(const tgBulletSpringCableAnchor* pAnchor) const
+{
+    const char* const p = reinterpret_cast<const char*>(pAnchor);
+    const std::size_t chunkBytes = m_chunkSize * sizeof(tgBulletSpringCableAnchor);
+    for (std::size_t i = 0; i < m_chunks.size(); i++)
+    {
+        if (p >= m_chunks[i] && p < m_chunks[i] + chunkBytes)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void tgBulletSpringCableAnchorPool::grow()
+{
+    // ::operator new is aligned for any type, and the anchors are laid
+    // out as an array, so each slot is aligned as well
+    char* const pChunk = static_cast<char*>(
+        ::operator new(m_chunkSize * sizeof(tgBulletSpringCableAnchor)));
+    m_chunks.push_back(pChunk);
+    m_free.reserve(m_free.size() + m_chunkSize);
+    // Hand out the slots in address order
+    for (std::size_t i = m_chunkSize; i > 0; i--)
+    {
+        m_free.push_back(pChunk + (i - 1) * sizeof(tgBulletSpringCableAnchor));
+    }
+}
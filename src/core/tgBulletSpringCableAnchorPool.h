@@ -0,0 +1,99 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_BULLET_SPRING_CABLE_ANCHOR_POOL_H
+#define TG_BULLET_SPRING_CABLE_ANCHOR_POOL_H
+
+/**
+ * @file tgBulletSpringCableAnchorPool.h
+ * @brief Contains the definition of class tgBulletSpringCableAnchorPool
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgBulletSpringCableAnchor;
+
+/**
+ * Storage for the sliding anchors of one tgBulletContactSpringCable,
+ * which come and go with its contacts every step. Anchors are copied in
+ * from candidates built on the stack once they have been accepted, and
+ * their storage goes back on a free list when they are released, so a
+ * cable in steady contact stops allocating. The storage is held in
+ * chunks that are never moved, so an anchor's address stays valid until
+ * it is released.
+ */
+class tgBulletSpringCableAnchorPool
+{
+public:
+
+    /**
+     * @param[in] chunkSize how many anchors to allocate storage for at
+     * a time; must be positive
+     */
+    tgBulletSpringCableAnchorPool(std::size_t chunkSize = 16);
+
+    /**
+     * Free the storage. Anchors still in use are not destroyed, so
+     * release them first.
+     */
+    ~tgBulletSpringCableAnchorPool();
+
+    /**
+     * Copy an anchor into the pool.
+     * @param[in] candidate the anchor to copy
+     * @return the pooled copy, owned by the pool until released
+     */
+    tgBulletSpringCableAnchor* create(const tgBulletSpringCableAnchor& candidate);
+
+    /**
+     * Destroy a pooled anchor and keep its storage for the next create.
+     * @param[in] pAnchor from create on this pool; NULL is ignored
+     */
+    void release(tgBulletSpringCableAnchor* pAnchor);
+
+    /**
+     * Whether an anchor's storage belongs to this pool, so an owner
+     * holding both pooled and heap anchors knows which way to free one.
+     */
+    bool owns(const tgBulletSpringCableAnchor* pAnchor) const;
+
+private:
+
+    /** Not copyable; the anchors refer to storage we own */
+    tgBulletSpringCableAnchorPool(const tgBulletSpringCableAnchorPool&);
+    tgBulletSpringCableAnchorPool& operator=(const tgBulletSpringCableAnchorPool&);
+
+    /** Allocate another chunk and put its slots on the free list */
+    void grow();
+
+    /** Anchors per chunk */
+    const std::size_t m_chunkSize;
+
+    /** The chunks, each with room for m_chunkSize anchors */
+    std::vector<char*> m_chunks;
+
+    /** Slots in the chunks that hold no anchor */
+    std::vector<void*> m_free;
+};
+
+#endif  // TG_BULLET_SPRING_CABLE_ANCHOR_POOL_H
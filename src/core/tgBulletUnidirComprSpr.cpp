@@ -95,27 +95,36 @@ void tgBulletUnidirComprSpr::step(double dt)
         throw std::invalid_argument("dt is not positive!");
     }
 
-    calculateAndApplyForce(dt);
+    // A registered spring has its force applied at the next world step,
+    // and its length checked there
+    if (m_pForceEngine == NULL)
+    {
+        calculateAndApplyForce(dt);
+        checkLength(getCurrentSpringLength());
+    }
+    
+    assert(invariant());
+}
 
+void tgBulletUnidirComprSpr::checkLength(double springLength) const
+{
     // If the spring distance has gone negative, output a scary warning.
     // TO-DO: find a way to apply a hard stop here instead.
-    if( getCurrentSpringLength() < 0.0)
+    if( springLength < 0.0)
     {
       std::cout << "WARNING! UNIDIRECTIONAL COMPRESSION SPRING IS "
 		<< "LESS THAN ZERO LENGTH. YOUR SIMULATION MAY BE INACCURATE FOR "
 		<< "ANY TIMESTEPS WHEN THIS MESSAGE APPEARS. " << std::endl;
-      std::cout << "Current spring length is " << getCurrentSpringLength()
+      std::cout << "Current spring length is " << springLength
 		<< std::endl << std::endl;
 
       /* If we wanted the simulator to completely quit instead:
       std::cout << "Error, unidirectional compression spring length "
-		<< "is negative. Length is: " << getCurrentSpringLength()
+		<< "is negative. Length is: " << springLength
        		<< std::endl;
       throw std::runtime_error("Unidirectional compression spring has negative length, simulation stopping. Increase your stiffness coefficient.");
       */
     }
-    
-    assert(invariant());
 }
 
 /**
@@ -156,6 +156,11 @@ protected:
      */
     virtual void calculateAndApplyForce(double dt);
 
+    /**
+     * Warns, rather than throwing, if the length is negative.
+     */
+    virtual void checkLength(double springLength) const;
+
 private: 
     /** Ensures integrity of member variables */
     bool invariant(void) const;
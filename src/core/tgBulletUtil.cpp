@@ -25,6 +25,7 @@
 // This module
 #include "tgBulletUtil.h"
 // This application
+#include "tgRigidBodyArena.h"
 #include "tgWorld.h"
 #include "tgWorldBulletPhysicsImpl.h"
 // The Bullet Physics library
@@ -39,7 +40,9 @@
 btRigidBody* tgBulletUtil::createRigidBody(btDynamicsWorld* dynamicsWorld, 
                                            float mass, 
                                            const btTransform& startTransform, 
-                                           btCollisionShape* shape)
+                                           btCollisionShape* shape,
+                                           btMotionState* motionState,
+                                           tgRigidBodyArena* arena)
 {
 
     btAssert((!shape || shape->getShapeType() != INVALID_SHAPE_PROXYTYPE));
@@ -55,7 +58,8 @@ btRigidBody* tgBulletUtil::createRigidBody(btDynamicsWorld* dynamicsWorld,
 
 #define USE_MOTIONSTATE 1
 #ifdef USE_MOTIONSTATE
-    btDefaultMotionState* myMotionState = new btDefaultMotionState(startTransform);
+    btMotionState* myMotionState =
+        motionState ? motionState : new btDefaultMotionState(startTransform);
 
     btRigidBody::btRigidBodyConstructionInfo cInfo(mass,myMotionState,shape,localInertia);
 
@@ -63,7 +67,7 @@ btRigidBody* tgBulletUtil::createRigidBody(btDynamicsWorld* dynamicsWorld,
     // double precision, 1e18.f if using single
     double defaultContactProcessingThreshold = 1.0e30;  // @TODO: What should this be? 
 
-    btRigidBody* body = new btRigidBody(cInfo);
+    btRigidBody* body = arena ? arena->create(cInfo) : new btRigidBody(cInfo);
     body->setContactProcessingThreshold(defaultContactProcessingThreshold);
 
 #else
@@ -71,7 +75,11 @@ btRigidBody* tgBulletUtil::createRigidBody(btDynamicsWorld* dynamicsWorld,
     body->setWorldTransform(startTransform);
 #endif//
 
-    dynamicsWorld->addRigidBody(body);
+    // A tgBodyBatch adds it later
+    if (dynamicsWorld != NULL)
+    {
+        dynamicsWorld->addRigidBody(body);
+    }
 
     return body;
 }
@@ -88,3 +96,48 @@ btDynamicsWorld& tgBulletUtil::worldToDynamicsWorld(const tgWorld& world)
   btDynamicsWorld& result = bulletPhysicsImpl.dynamicsWorld();
   return result;
 }
+
+tgBulletCableForceEngine* tgBulletUtil::worldToCableForceEngine(const tgWorld& world)
+{
+  tgWorldBulletPhysicsImpl& bulletPhysicsImpl =
+    static_cast<tgWorldBulletPhysicsImpl&>(world.implementation());
+  return bulletPhysicsImpl.cableForceEngine();
+}
+
+tgRigidStateFrame& tgBulletUtil::worldToRigidStateFrame(const tgWorld& world)
+{
+  tgWorldBulletPhysicsImpl& bulletPhysicsImpl =
+    static_cast<tgWorldBulletPhysicsImpl&>(world.implementation());
+  return bulletPhysicsImpl.rigidStates();
+}
+
+tgRigidBodyArena& tgBulletUtil::worldToBodyArena(const tgWorld& world)
+{
+  tgWorldBulletPhysicsImpl& bulletPhysicsImpl =
+    static_cast<tgWorldBulletPhysicsImpl&>(world.implementation());
+  return bulletPhysicsImpl.bodyArena();
+}
+
+tgCableCollision* tgBulletUtil::worldToCableCollision(const tgWorld& world)
+{
+  tgWorldBulletPhysicsImpl& bulletPhysicsImpl =
+    static_cast<tgWorldBulletPhysicsImpl&>(world.implementation());
+  return bulletPhysicsImpl.cableCollision();
+}
+
+tgGhostPairFilter& tgBulletUtil::worldToGhostPairFilter(const tgWorld& world)
+{
+  tgWorldBulletPhysicsImpl& bulletPhysicsImpl =
+    static_cast<tgWorldBulletPhysicsImpl&>(world.implementation());
+  return bulletPhysicsImpl.ghostPairFilter();
+}
+
+bool tgBulletUtil::wakeForImpulse(btRigidBody* pBody, double change, double threshold)
+{
+  if (threshold < 0.0 || (!pBody->isActive() && change > threshold))
+  {
+    pBody->activate();
+    return true;
+  }
+  return pBody->isActive();
+}
@@ -29,8 +29,14 @@
 // Forward declarations
 class btCollisionShape;
 class btDynamicsWorld;
+class btMotionState;
 class btRigidBody;
 class btTransform;
+class tgBulletCableForceEngine;
+class tgCableCollision;
+class tgGhostPairFilter;
+class tgRigidBodyArena;
+class tgRigidStateFrame;
 class tgWorld;
 
 /**
@@ -42,10 +48,15 @@ public:
 
     // @todo: Move this to the tgRigidInfo => tgModel step
     // NOTE: this is a copy of localCreateRigidBody from the bullet DemoApplication. 
+    // The body is not added to any world if dynamicsWorld is NULL.
+    // Without a motionState, it gets a new btDefaultMotionState. With an
+    // arena, the body is made in it rather than on the heap.
     static btRigidBody* createRigidBody(btDynamicsWorld* dynamicsWorld, 
                                         float mass, 
                                         const btTransform& startTransform, 
-                                        btCollisionShape* shape);
+                                        btCollisionShape* shape,
+                                        btMotionState* motionState = 0,
+                                        tgRigidBodyArena* arena = 0);
     /**
      * Assuming that world has a tgWorldBulletPhysicsImpl, return
      * its dynamics world.
@@ -54,6 +65,62 @@ public:
      * @todo consider implications of casting to include Corde objects
      */
     static btDynamicsWorld& worldToDynamicsWorld(const tgWorld& world);
+
+    /**
+     * Assuming that world has a tgWorldBulletPhysicsImpl, return
+     * its cable force engine.
+     * @param[in] world a tgWorld
+     * @return the engine, or NULL if the world does not batch cable forces
+     */
+    static tgBulletCableForceEngine* worldToCableForceEngine(const tgWorld& world);
+
+    /**
+     * Assuming that world has a tgWorldBulletPhysicsImpl, return
+     * the frame its bodies' states are published in, which makes their
+     * motion states.
+     * @param[in] world a tgWorld
+     * @return the world's tgRigidStateFrame
+     */
+    static tgRigidStateFrame& worldToRigidStateFrame(const tgWorld& world);
+
+    /**
+     * Assuming that world has a tgWorldBulletPhysicsImpl, return
+     * the arena its models' rigid bodies are made in.
+     * @param[in] world a tgWorld
+     * @return the world's tgRigidBodyArena
+     */
+    static tgRigidBodyArena& worldToBodyArena(const tgWorld& world);
+
+    /**
+     * Assuming that world has a tgWorldBulletPhysicsImpl, return
+     * its capsule collision of contact cables.
+     * @param[in] world a tgWorld
+     * @return it, or NULL if tgWorld::Config::cableCollisionCell is zero
+     */
+    static tgCableCollision* worldToCableCollision(const tgWorld& world);
+
+    /**
+     * Assuming that world has a tgWorldBulletPhysicsImpl, return
+     * its broadphase filter for ghost objects.
+     * @param[in] world a tgWorld
+     * @return the world's tgGhostPairFilter
+     */
+    static tgGhostPairFilter& worldToGhostPairFilter(const tgWorld& world);
+
+    /**
+     * Decide whether a cable's impulse should reach a body, waking it if
+     * so; see tgWorld::Config::cableWakeImpulse. With a negative
+     * threshold the body is always woken. Otherwise an awake body takes
+     * the impulse without resetting its deactivation timer, so it can
+     * still fall asleep, and a sleeping body is woken only when the
+     * impulse has changed by more than the threshold since it was last
+     * applied.
+     * @param[in] pBody the body, must not be NULL
+     * @param[in] change the size of the change in impulse
+     * @param[in] threshold tgWorld::Config::cableWakeImpulse
+     * @return true if the impulse should be applied
+     */
+    static bool wakeForImpulse(btRigidBody* pBody, double change, double threshold);
 };
 
 
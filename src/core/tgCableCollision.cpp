@@ -0,0 +1,508 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCableCollision.cpp
+ * @brief Contains the definitions of members of class tgCableCollision
+ * $Id$
+ */
+
+// This module
+#include "tgCableCollision.h"
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btBroadphaseProxy.h"
+#include "BulletCollision/CollisionShapes/btCapsuleShape.h"
+#include "BulletCollision/CollisionShapes/btCompoundShape.h"
+#include "BulletCollision/CollisionShapes/btCylinderShape.h"
+#include "BulletCollision/CollisionShapes/btSphereShape.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btQuickprof.h"
+#include "LinearMath/btTransform.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    /**
+     * Items whose bounds cover more cells than this, such as a long
+     * diagonal cable segment, are paired with every item instead
+     */
+    const long maxCellsPerItem = 512;
+
+    btScalar clamp01(btScalar x)
+    {
+        return x < 0.0 ? btScalar(0.0) : (x > 1.0 ? btScalar(1.0) : x);
+    }
+
+    /**
+     * The capsule of a cylinder, capsule or sphere
+     * @return false for any other shape
+     */
+    bool primitiveCapsule(const btCollisionShape& shape, const btTransform& transform,
+                          tgCableCollision::Capsule& capsule)
+    {
+        btVector3 axis(0.0, 0.0, 0.0);
+        switch (shape.getShapeType())
+        {
+        case CYLINDER_SHAPE_PROXYTYPE:
+            {
+                const btCylinderShape& cylinder = static_cast<const btCylinderShape&>(shape);
+                const btVector3 halfExtents = cylinder.getHalfExtentsWithMargin();
+                const int up = cylinder.getUpAxis();
+                axis[up] = halfExtents[up];
+                capsule.radius = halfExtents[(up + 1) % 3];
+            }
+            break;
+        case CAPSULE_SHAPE_PROXYTYPE:
+            {
+                const btCapsuleShape& capsuleShape = static_cast<const btCapsuleShape&>(shape);
+                axis[capsuleShape.getUpAxis()] = capsuleShape.getHalfHeight();
+                capsule.radius = capsuleShape.getRadius();
+            }
+            break;
+        case SPHERE_SHAPE_PROXYTYPE:
+            capsule.radius = static_cast<const btSphereShape&>(shape).getRadius();
+            break;
+        default:
+            return false;
+        }
+        capsule.a = transform * -axis;
+        capsule.b = transform * axis;
+        return true;
+    }
+
+    /** As closestOnBody, over a shape, keeping the nearest so far */
+    void closestOnShape(const btCollisionShape& shape, const btTransform& transform,
+                        const btVector3& point, btScalar& best,
+                        btVector3& surface, btVector3& normal)
+    {
+        if (shape.getShapeType() == COMPOUND_SHAPE_PROXYTYPE)
+        {
+            const btCompoundShape& compound = static_cast<const btCompoundShape&>(shape);
+            for (int i = 0; i < compound.getNumChildShapes(); i++)
+            {
+                closestOnShape(*compound.getChildShape(i),
+                               transform * compound.getChildTransform(i),
+                               point, best, surface, normal);
+            }
+            return;
+        }
+
+        tgCableCollision::Capsule capsule;
+        if (!primitiveCapsule(shape, transform, capsule))
+        {
+            return;
+        }
+        const btVector3 ab = capsule.b - capsule.a;
+        const btScalar length2 = ab.length2();
+        const btScalar t = length2 > SIMD_EPSILON ?
+            clamp01((point - capsule.a).dot(ab) / length2) : btScalar(0.0);
+        const btVector3 onAxis = capsule.a + ab * t;
+        btVector3 inward = onAxis - point;
+        const btScalar distance = inward.length();
+        if (std::fabs(distance - capsule.radius) >= best)
+        {
+            return;
+        }
+        if (distance > SIMD_EPSILON)
+        {
+            inward /= distance;
+        }
+        else
+        {
+            // On the axis, so any direction out will do
+            btVector3 unused;
+            btPlaneSpace1(length2 > SIMD_EPSILON ? ab : btVector3(0.0, 1.0, 0.0), inward, unused);
+        }
+        best = std::fabs(distance - capsule.radius);
+        normal = inward;
+        surface = onAxis - inward * capsule.radius;
+    }
+
+    /** Orders contacts by cable, then segment */
+    bool contactOrder(const tgCableCollision::Contact& a, const tgCableCollision::Contact& b)
+    {
+        return a.cable < b.cable || (a.cable == b.cable && a.segment < b.segment);
+    }
+
+    long cellOf(btScalar x, btScalar cellSize)
+    {
+        return (long) std::floor(x / cellSize);
+    }
+}
+
+tgCableCollision::tgCableCollision(double cellSize) :
+m_cellSize(cellSize)
+{
+    if (!(cellSize > 0.0))
+    {
+        throw std::invalid_argument("Cable collision cell size is not positive");
+    }
+}
+
+std::size_t tgCableCollision::addCable(double radius)
+{
+    std::size_t cable = 0;
+    while (cable < m_cables.size() && m_cables[cable].used)
+    {
+        cable++;
+    }
+    if (cable == m_cables.size())
+    {
+        m_cables.push_back(Cable());
+    }
+    Cable& entry = m_cables[cable];
+    entry.used = true;
+    entry.radius = radius;
+    entry.points.clear();
+    entry.excluded.clear();
+    return cable;
+}
+
+void tgCableCollision::removeCable(std::size_t cable)
+{
+    assert(cable < m_cables.size() && m_cables[cable].used);
+    m_cables[cable].used = false;
+    m_cables[cable].points.clear();
+    m_cables[cable].excluded.clear();
+}
+
+void tgCableCollision::exclude(std::size_t cable, const btRigidBody* pBody)
+{
+    assert(cable < m_cables.size() && m_cables[cable].used);
+    m_cables[cable].excluded.push_back(pBody);
+}
+
+void tgCableCollision::setCable(std::size_t cable, const std::vector<btVector3>& points)
+{
+    assert(cable < m_cables.size() && m_cables[cable].used);
+    m_cables[cable].points.assign(points.begin(), points.end());
+}
+
+void tgCableCollision::getContacts(std::size_t cable, std::size_t& first,
+                                   std::size_t& last) const
+{
+    Contact key;
+    key.cable = cable;
+    key.segment = 0;
+    first = std::lower_bound(m_contacts.begin(), m_contacts.end(), key, contactOrder) -
+        m_contacts.begin();
+    last = first;
+    while (last < m_contacts.size() && m_contacts[last].cable == cable)
+    {
+        last++;
+    }
+}
+
+void tgCableCollision::shapeCapsules(const btCollisionShape& shape,
+                                     const btTransform& transform,
+                                     std::vector<Capsule>& capsules)
+{
+    if (shape.getShapeType() == COMPOUND_SHAPE_PROXYTYPE)
+    {
+        const btCompoundShape& compound = static_cast<const btCompoundShape&>(shape);
+        for (int i = 0; i < compound.getNumChildShapes(); i++)
+        {
+            shapeCapsules(*compound.getChildShape(i),
+                          transform * compound.getChildTransform(i), capsules);
+        }
+        return;
+    }
+    Capsule capsule;
+    if (primitiveCapsule(shape, transform, capsule))
+    {
+        capsules.push_back(capsule);
+    }
+}
+
+bool tgCableCollision::closestOnBody(const btRigidBody& body, const btVector3& point,
+                                     btVector3& surface, btVector3& normal)
+{
+    btScalar best = SIMD_INFINITY;
+    closestOnShape(*body.getCollisionShape(), body.getWorldTransform(), point,
+                   best, surface, normal);
+    return best != SIMD_INFINITY;
+}
+
+/** Ericson, Real-Time Collision Detection, 5.1.9 */
+btScalar tgCableCollision::closestPoints(const btVector3& p1, const btVector3& q1,
+                                         const btVector3& p2, const btVector3& q2,
+                                         btScalar& s, btScalar& t)
+{
+    const btVector3 d1 = q1 - p1;
+    const btVector3 d2 = q2 - p2;
+    const btVector3 r = p1 - p2;
+    const btScalar a = d1.length2();
+    const btScalar e = d2.length2();
+    const btScalar f = d2.dot(r);
+
+    if (a <= SIMD_EPSILON && e <= SIMD_EPSILON)
+    {
+        s = 0.0;
+        t = 0.0;
+    }
+    else if (a <= SIMD_EPSILON)
+    {
+        s = 0.0;
+        t = clamp01(f / e);
+    }
+    else
+    {
+        const btScalar c = d1.dot(r);
+        if (e <= SIMD_EPSILON)
+        {
+            t = 0.0;
+            s = clamp01(-c / a);
+        }
+        else
+        {
+            const btScalar b = d1.dot(d2);
+            const btScalar denominator = a * e - b * b;
+            // Parallel segments take any s, here the first point
+            s = denominator > SIMD_EPSILON ? clamp01((b * f - c * e) / denominator) :
+                btScalar(0.0);
+            t = (b * s + f) / e;
+            if (t < 0.0)
+            {
+                t = 0.0;
+                s = clamp01(-c / a);
+            }
+            else if (t > 1.0)
+            {
+                t = 1.0;
+                s = clamp01((b - c) / a);
+            }
+        }
+    }
+    return ((p1 + d1 * s) - (p2 + d2 * t)).length2();
+}
+
+void tgCableCollision::update(const btAlignedObjectArray<btCollisionObject*>& objects)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgCableCollision::update");
+#endif //BT_NO_PROFILE
+
+    m_items.clear();
+    m_contacts.clear();
+    for (std::size_t c = 0; c < m_cables.size(); c++)
+    {
+        const Cable& cable = m_cables[c];
+        for (std::size_t i = 0; cable.used && i + 1 < cable.points.size(); i++)
+        {
+            Item item;
+            item.capsule.a = cable.points[i];
+            item.capsule.b = cable.points[i + 1];
+            item.capsule.radius = cable.radius;
+            item.cable = (long) c;
+            item.segment = i;
+            item.pBody = NULL;
+            m_items.push_back(item);
+        }
+    }
+    if (m_items.empty())
+    {
+        return;
+    }
+    for (int i = 0; i < objects.size(); i++)
+    {
+        btRigidBody* const pBody = btRigidBody::upcast(objects[i]);
+        if (pBody == NULL || pBody->isStaticObject())
+        {
+            continue;
+        }
+        m_bodyCapsules.clear();
+        shapeCapsules(*pBody->getCollisionShape(), pBody->getWorldTransform(), m_bodyCapsules);
+        for (std::size_t j = 0; j < m_bodyCapsules.size(); j++)
+        {
+            Item item;
+            item.capsule = m_bodyCapsules[j];
+            item.cable = -1;
+            item.segment = j;
+            item.pBody = pBody;
+            m_items.push_back(item);
+        }
+    }
+
+    // Pairs sharing a cell, with at least one cable
+    m_cells.clear();
+    m_pairs.clear();
+    m_large.clear();
+    for (std::size_t i = 0; i < m_items.size(); i++)
+    {
+        insert(i);
+    }
+    std::sort(m_cells.begin(), m_cells.end());
+    for (std::size_t first = 0; first < m_cells.size(); )
+    {
+        std::size_t last = first + 1;
+        while (last < m_cells.size() && m_cells[last].first == m_cells[first].first)
+        {
+            last++;
+        }
+        for (std::size_t i = first; i < last; i++)
+        {
+            for (std::size_t j = i + 1; j < last; j++)
+            {
+                const std::size_t a = m_cells[i].second;
+                const std::size_t b = m_cells[j].second;
+                if (m_items[a].cable >= 0 || m_items[b].cable >= 0)
+                {
+                    m_pairs.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+                }
+            }
+        }
+        first = last;
+    }
+    for (std::size_t i = 0; i < m_large.size(); i++)
+    {
+        for (std::size_t j = 0; j < m_items.size(); j++)
+        {
+            const std::size_t a = m_large[i];
+            if (j != a && (m_items[a].cable >= 0 || m_items[j].cable >= 0))
+            {
+                m_pairs.push_back(std::make_pair(std::min(a, j), std::max(a, j)));
+            }
+        }
+    }
+    std::sort(m_pairs.begin(), m_pairs.end());
+    m_pairs.erase(std::unique(m_pairs.begin(), m_pairs.end()), m_pairs.end());
+
+    for (std::size_t i = 0; i < m_pairs.size(); i++)
+    {
+        collide(m_items[m_pairs[i].first], m_items[m_pairs[i].second]);
+    }
+    std::sort(m_contacts.begin(), m_contacts.end(), contactOrder);
+}
+
+void tgCableCollision::insert(std::size_t item)
+{
+    const Capsule& capsule = m_items[item].capsule;
+    btVector3 lower = capsule.a;
+    btVector3 upper = capsule.a;
+    lower.setMin(capsule.b);
+    upper.setMax(capsule.b);
+    const btVector3 radius(capsule.radius, capsule.radius, capsule.radius);
+    lower -= radius;
+    upper += radius;
+    long low[3];
+    long high[3];
+    long cells = 1;
+    for (int k = 0; k < 3; k++)
+    {
+        low[k] = cellOf(lower[k], m_cellSize);
+        high[k] = cellOf(upper[k], m_cellSize);
+        cells *= high[k] - low[k] + 1;
+    }
+    if (cells > maxCellsPerItem)
+    {
+        m_large.push_back(item);
+        return;
+    }
+    for (long x = low[0]; x <= high[0]; x++)
+    {
+        for (long y = low[1]; y <= high[1]; y++)
+        {
+            for (long z = low[2]; z <= high[2]; z++)
+            {
+                // Distinct cells may share a key, which only adds pairs
+                // that fail the distance test
+                const unsigned long key =
+                    (unsigned long) (x * 73856093L) ^
+                    (unsigned long) (y * 19349663L) ^
+                    (unsigned long) (z * 83492791L);
+                m_cells.push_back(std::make_pair(key, item));
+            }
+        }
+    }
+}
+
+void tgCableCollision::collide(const Item& first, const Item& second)
+{
+    // A cable does not touch itself, nor the bodies it is excluded from
+    if (first.cable == second.cable)
+    {
+        return;
+    }
+    const Item& cable = first.cable >= 0 ? first : second;
+    const Item& other = first.cable >= 0 ? second : first;
+    if (other.pBody != NULL)
+    {
+        const std::vector<const btRigidBody*>& excluded = m_cables[cable.cable].excluded;
+        if (std::find(excluded.begin(), excluded.end(), other.pBody) != excluded.end())
+        {
+            return;
+        }
+    }
+
+    btScalar s = 0.0;
+    btScalar t = 0.0;
+    const btScalar distance2 = closestPoints(cable.capsule.a, cable.capsule.b,
+                                             other.capsule.a, other.capsule.b, s, t);
+    const btScalar reach = cable.capsule.radius + other.capsule.radius;
+    if (distance2 >= reach * reach)
+    {
+        return;
+    }
+    const btScalar distance = std::sqrt(distance2) - reach;
+    const btVector3 onCable = cable.capsule.a + (cable.capsule.b - cable.capsule.a) * s;
+    const btVector3 onOther = other.capsule.a + (other.capsule.b - other.capsule.a) * t;
+    addContact(cable, other, onCable, onOther, distance);
+    if (other.cable >= 0)
+    {
+        addContact(other, cable, onOther, onCable, distance);
+    }
+}
+
+void tgCableCollision::addContact(const Item& cable, const Item& other,
+                                  const btVector3& onCable, const btVector3& onOther,
+                                  btScalar distance)
+{
+    Contact contact;
+    contact.cable = cable.cable;
+    contact.segment = cable.segment;
+    contact.pBody = other.pBody;
+    contact.otherCable = other.pBody ? 0 : other.cable;
+    contact.otherSegment = other.pBody ? 0 : other.segment;
+    contact.normal = onOther - onCable;
+    const btScalar length = contact.normal.length();
+    if (length > SIMD_EPSILON)
+    {
+        contact.normal /= length;
+    }
+    else
+    {
+        // The axes cross, so push across both
+        contact.normal = (cable.capsule.b - cable.capsule.a).cross(other.capsule.b - other.capsule.a);
+        if (contact.normal.length2() > SIMD_EPSILON)
+        {
+            contact.normal.normalize();
+        }
+        else
+        {
+            btVector3 unused;
+            btPlaneSpace1(cable.capsule.b - cable.capsule.a, contact.normal, unused);
+        }
+    }
+    contact.position = onOther - contact.normal * other.capsule.radius;
+    contact.distance = distance;
+    m_contacts.push_back(contact);
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CABLE_COLLISION_H
+#define TG_CABLE_COLLISION_H
+
+/**
+ * @file tgCableCollision.h
+ * @brief Contains the definition of class tgCableCollision
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btAlignedObjectArray.h"
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Forward declarations
+class btCollisionObject;
+class btCollisionShape;
+class btRigidBody;
+class btTransform;
+
+/**
+ * Collision of contact cables with rods and with each other, without
+ * Bullet's narrowphase. Each cable is a chain of capsules, one per
+ * segment between its anchors, and each rod a capsule from its
+ * btCylinderShape, btCapsuleShape or btSphereShape, including the
+ * children of compounds. The capsules are hashed into a uniform grid
+ * and the pairs sharing a cell are tested with the closed form closest
+ * points of two segments.
+ *
+ * A tgWorld::Config with a positive cableCollisionCell makes one per
+ * world, updated after every world step. tgBulletContactSpringCable
+ * then sets its segments at the end of each step and takes its sliding
+ * anchors on rods straight from getContacts, leaving its ghost object
+ * to the ground and other static bodies.
+ */
+class tgCableCollision
+{
+public:
+
+    /** A segment with a radius */
+    struct Capsule
+    {
+        btVector3 a;
+        btVector3 b;
+        btScalar radius;
+    };
+
+    /** A cable segment overlapping a rod or another cable's segment */
+    struct Contact
+    {
+        /** The cable, as returned by addCable */
+        std::size_t cable;
+        /** The segment, from the cable's point segment to segment + 1 */
+        std::size_t segment;
+        /** The rod, or NULL for another cable */
+        btRigidBody* pBody;
+        /** The other cable and its segment, if pBody is NULL */
+        std::size_t otherCable;
+        std::size_t otherSegment;
+        /** The point on the other capsule's surface nearest the cable */
+        btVector3 position;
+        /** Unit, from the cable into the other capsule */
+        btVector3 normal;
+        /** Between the surfaces; negative when they overlap */
+        btScalar distance;
+    };
+
+    /**
+     * @param[in] cellSize the side of a grid cell, about the length of
+     * a rod
+     * @throw std::invalid_argument if cellSize is not positive
+     */
+    explicit tgCableCollision(double cellSize);
+
+    /**
+     * Start colliding a cable. It has no segments until setCable.
+     * @param[in] radius the cable's thickness
+     * @return the cable's id
+     */
+    std::size_t addCable(double radius);
+
+    /** Stop colliding a cable; its id may be reused */
+    void removeCable(std::size_t cable);
+
+    /**
+     * Keep a cable from touching a body, such as the rods it ends on
+     * @param[in] cable as returned by addCable
+     * @param[in] pBody any rigid body
+     */
+    void exclude(std::size_t cable, const btRigidBody* pBody);
+
+    /**
+     * Set a cable's segments for the next update
+     * @param[in] cable as returned by addCable
+     * @param[in] points the cable's anchors in order, 2 or more
+     */
+    void setCable(std::size_t cable, const std::vector<btVector3>& points);
+
+    /**
+     * Find the contacts of every cable with the rods among objects
+     * that are not static, and with each other.
+     * @param[in] objects the dynamics world's collision objects
+     */
+    void update(const btAlignedObjectArray<btCollisionObject*>& objects);
+
+    /**
+     * The overlapping pairs found by the last update, sorted by cable
+     * and segment. A contact between two cables is listed for each.
+     */
+    const std::vector<Contact>& getContacts() const
+    {
+        return m_contacts;
+    }
+
+    /**
+     * The range of getContacts for one cable
+     * @param[out] first the index of its first contact
+     * @param[out] last one past the index of its last
+     */
+    void getContacts(std::size_t cable, std::size_t& first, std::size_t& last) const;
+
+    /**
+     * Add the capsules of a shape
+     * @param[in] shape a cylinder, capsule, sphere, or a compound of
+     * them; other shapes add nothing
+     * @param[in] transform the shape's world transform
+     * @param[out] capsules appended to
+     */
+    static void shapeCapsules(const btCollisionShape& shape,
+                              const btTransform& transform,
+                              std::vector<Capsule>& capsules);
+
+    /**
+     * The point on a body's capsules nearest a point
+     * @param[in] body any rigid body
+     * @param[in] point in world coordinates
+     * @param[out] surface the nearest point on the capsules' surface
+     * @param[out] normal unit, from point into the body
+     * @return false if the body has no capsules
+     */
+    static bool closestOnBody(const btRigidBody& body, const btVector3& point,
+                              btVector3& surface, btVector3& normal);
+
+    /**
+     * The closest points of the segments p1 q1 and p2 q2, at
+     * p1 + s * (q1 - p1) and p2 + t * (q2 - p2)
+     * @return the squared distance between them
+     */
+    static btScalar closestPoints(const btVector3& p1, const btVector3& q1,
+                                  const btVector3& p2, const btVector3& q2,
+                                  btScalar& s, btScalar& t);
+
+private:
+
+    /** A cable's capsules and the bodies it does not touch */
+    struct Cable
+    {
+        bool used;
+        btScalar radius;
+        std::vector<btVector3> points;
+        std::vector<const btRigidBody*> excluded;
+    };
+
+    /** A capsule in the grid: a cable segment, or a rod if cable is -1 */
+    struct Item
+    {
+        Capsule capsule;
+        long cable;
+        std::size_t segment;
+        btRigidBody* pBody;
+    };
+
+    /** Put an item in every cell its bounds touch */
+    void insert(std::size_t item);
+
+    /** Test a pair of items, adding their contacts */
+    void collide(const Item& first, const Item& second);
+
+    /** Add a contact of a cable item against another item */
+    void addContact(const Item& cable, const Item& other,
+                    const btVector3& onCable, const btVector3& onOther,
+                    btScalar distance);
+
+    const btScalar m_cellSize;
+
+    std::vector<Cable> m_cables;
+
+    /** Kept between updates to avoid allocating */
+    std::vector<Item> m_items;
+    std::vector<Capsule> m_bodyCapsules;
+
+    /** Cell key and item, sorted by cell */
+    std::vector< std::pair<unsigned long, std::size_t> > m_cells;
+
+    /** Items whose bounds cover too many cells, paired with every item */
+    std::vector<std::size_t> m_large;
+
+    /** Pairs of items sharing a cell, lower index first */
+    std::vector< std::pair<std::size_t, std::size_t> > m_pairs;
+
+    std::vector<Contact> m_contacts;
+};
+
+#endif  // TG_CABLE_COLLISION_H
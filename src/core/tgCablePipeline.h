@@ -0,0 +1,233 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_CORE_TG_CABLE_PIPELINE_H
+#define SRC_CORE_TG_CABLE_PIPELINE_H
+
+/**
+ * @file tgCablePipeline.h
+ * @brief Contains the definition of the cable pipeline policies
+ * $Id$
+ */
+
+// This application
+#include "tgSpringCable.h"
+#include "tgSpringCableActuator.h"
+// The C++ Standard Library
+#include <cmath>
+#include <cstddef>
+
+/**
+ * One step's state of a spring cable, read once through its virtual
+ * accessors and then handed to the policies below.
+ */
+struct tgCableSample
+{
+    double restLength;
+    double length;
+    double velocity;
+    double damping;
+    double tension;
+};
+
+/**
+ * The tension-only linear spring of tgBulletSpringCable, F = kx + bv
+ * while the cable is stretched and zero while it is slack, with the
+ * damping force bounded by the spring force.
+ */
+struct tgLinearTensionLaw
+{
+    /**
+     * @param[out] damping the bounded damping force, kept whether or not
+     * the cable is slack
+     * @return the tension along the cable
+     */
+    static double tension(double coefK, double coefD, double length,
+                          double restLength, double velocity,
+                          double& damping)
+    {
+        const double stretch = length - restLength;
+        const double spring = coefK * stretch;
+        damping = coefD * velocity;
+        if (std::fabs(spring) < std::fabs(damping))
+        {
+            damping = (damping > 0.0 ? spring : -spring);
+        }
+        return (stretch > 0.0) ? spring + damping : 0.0;
+    }
+
+    /**
+     * The tension stage of a batch of cables, over plain arrays with one
+     * entry per cable and no branches the compiler cannot turn into
+     * selects, so the loop vectorizes. Everything a cable's tension
+     * needs comes in and goes out through these arrays, which makes
+     * this the unit to hand to another backend: tgBulletCableForceEngine
+     * only gathers anchor separations before it and scatters impulses
+     * after it.
+     * @param[in] dx, dy, dz the separation of each cable's anchors
+     * @param[in] prevLength each cable's length at the last step
+     * @param[out] length the new lengths
+     * @param[out] velocity the rate of change of length
+     * @param[out] damping the bounded damping forces, as tension
+     * @param[out] magnitude the tension per unit of separation, zero
+     * while slack
+     */
+    static void tensions(std::size_t n, const double* coefK,
+                         const double* coefD, const double* restLength,
+                         const double* dx, const double* dy, const double* dz,
+                         const double* prevLength, double invDt,
+                         double* length, double* velocity, double* damping,
+                         double* magnitude)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double currLength =
+                std::sqrt(dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i]);
+            const double v = (currLength - prevLength[i]) * invDt;
+            const double stretch = currLength - restLength[i];
+            const double spring = coefK[i] * stretch;
+            const double d = coefD[i] * v;
+            const double bounded = (d > 0.0) ? spring : -spring;
+            const double clamped =
+                (std::fabs(spring) < std::fabs(d)) ? bounded : d;
+            length[i] = currLength;
+            velocity[i] = v;
+            damping[i] = clamped;
+            magnitude[i] = (stretch > 0.0) ?
+                (spring + clamped) / currLength : 0.0;
+        }
+    }
+
+    /** The spring part alone, as tgBulletSpringCable::getTension */
+    static double staticTension(double coefK, double length, double restLength)
+    {
+        const double tension = (length - restLength) * coefK;
+        return (tension < 0.0) ? 0.0 : tension;
+    }
+};
+
+/**
+ * The motor of tgBasicActuator: the rest length follows the preferred
+ * length at no more than Config::targetVelocity, the preferred length
+ * is pulled in so the tension stays under Config::maxTens, and the
+ * cable only shortens while longer than Config::minActualLength.
+ */
+struct tgRateLimitedMotor
+{
+    /**
+     * @param[in,out] preferredLength lowered if it would exceed maxTens
+     * @return the new rest length, at least Config::minRestLength
+     */
+    static double move(const tgSpringCableActuator::Config& config,
+                       double coefK, double length, double restLength,
+                       double& preferredLength, double dt)
+    {
+        const double stepSize = config.targetVelocity * dt;
+        if ((length - preferredLength) * coefK > config.maxTens)
+        {
+            preferredLength = length - config.maxTens / coefK;
+        }
+        const double diff = preferredLength - restLength;
+        const double fabsDiff = std::fabs(diff);
+        if ((length > config.minActualLength) || (diff > 0))
+        {
+            if (fabsDiff > stepSize)
+            {
+                restLength += (diff / fabsDiff) * stepSize;
+            }
+            else
+            {
+                restLength += diff;
+            }
+        }
+        return (restLength > config.minRestLength) ?
+            restLength : config.minRestLength;
+    }
+};
+
+/** Keeps no history */
+struct tgNoHistory
+{
+    static void record(tgSpringCableActuator::SpringCableActuatorHistory&,
+                       const tgCableSample&)
+    {
+    }
+};
+
+/** Keeps every value of tgSpringCableActuator::SpringCableActuatorHistory */
+struct tgFullHistory
+{
+    static void record(tgSpringCableActuator::SpringCableActuatorHistory& history,
+                       const tgCableSample& sample)
+    {
+        history.lastLengths.push_back(sample.length);
+        history.lastVelocities.push_back(sample.velocity);
+        history.dampingHistory.push_back(sample.damping);
+        history.restLengths.push_back(sample.restLength);
+        history.tensionHistory.push_back(sample.tension);
+    }
+};
+
+/**
+ * A spring cable actuator's per-step work, composed at compile time from
+ * a spring law, a motor model and a history policy, so that each piece
+ * is inlined into the caller rather than reached through virtual calls.
+ * tgBasicActuator steps through one of these and
+ * tgBulletCableForceEngine computes its tensions with the spring law;
+ * the actuator classes stay the interface controllers see.
+ */
+template <class SpringLaw, class Motor, class History>
+struct tgCablePipeline
+{
+    typedef SpringLaw Law;
+    typedef Motor MotorModel;
+    typedef History HistoryPolicy;
+
+    /** Read a cable's state with one call per accessor */
+    static tgCableSample sample(const tgSpringCable& cable)
+    {
+        tgCableSample s;
+        s.restLength = cable.getRestLength();
+        s.length = cable.getActualLength();
+        s.velocity = cable.getVelocity();
+        s.damping = cable.getDamping();
+        s.tension = SpringLaw::staticTension(cable.getCoefK(), s.length,
+                                             s.restLength);
+        return s;
+    }
+
+    /** Move the motor one step; see tgRateLimitedMotor::move */
+    static double move(const tgSpringCableActuator::Config& config,
+                       double coefK, double length, double restLength,
+                       double& preferredLength, double dt)
+    {
+        return Motor::move(config, coefK, length, restLength,
+                           preferredLength, dt);
+    }
+
+    /** Add a sample to the running statistics and the history */
+    static void log(const tgCableSample& sample,
+                    tgSpringCableActuator::SpringCableActuatorStats& stats,
+                    tgSpringCableActuator::SpringCableActuatorHistory& history)
+    {
+        stats.update(sample.restLength, sample.length, sample.tension);
+        History::record(history, sample);
+    }
+};
+
+#endif  // SRC_CORE_TG_CABLE_PIPELINE_H
@@ -0,0 +1,310 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCommandLog.cpp
+ * @brief Contains the definitions of members of classes tgCommandRecorder
+ * and tgCommandPlayer
+ * $Id$
+ */
+
+// This module
+#include "tgCommandLog.h"
+// This application
+#include "tgRandom.h"
+#include "tgSpringCableActuator.h"
+// The C++ Standard Library
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+    const char magic[8] = { 'N', 'T', 'R', 'T', 'C', 'M', 'D', 'S' };
+    const unsigned int version = 1;
+
+    /**
+     * The records after the header. A step's records are followed by
+     * eSteps and a count n, which ends that step and n - 1 more that
+     * had no records.
+     */
+    enum Record
+    {
+        /** The step size, a double, when it changes */
+        eStepSize = 'T',
+        /** An actuator's index, an unsigned int, and its command */
+        eCommand = 'C',
+        /** The count of steps ended, an unsigned int */
+        eSteps = 'S'
+    };
+
+    void write(std::FILE* f, const void* data, std::size_t n, bool& ok)
+    {
+        ok = ok && std::fwrite(data, 1, n, f) == n;
+    }
+
+    void writeByte(std::FILE* f, char c, bool& ok)
+    {
+        write(f, &c, 1, ok);
+    }
+
+    bool read(std::FILE* f, void* data, std::size_t n)
+    {
+        return std::fread(data, 1, n, f) == n;
+    }
+}
+
+tgCommandRecorder::tgCommandRecorder(const std::string& path,
+                                     const std::vector<tgSpringCableActuator*>& actuators) :
+m_file(std::fopen(path.c_str(), "wb")),
+m_path(path),
+m_actuators(actuators),
+m_last(actuators.size()),
+m_dt(0.0),
+m_pendingSteps(0),
+m_steps(0),
+m_ok(true)
+{
+    if (m_file == NULL)
+    {
+        throw std::runtime_error("Could not write " + path);
+    }
+
+    write(m_file, magic, sizeof(magic), m_ok);
+    write(m_file, &version, sizeof(version), m_ok);
+    const unsigned int n = m_actuators.size();
+    write(m_file, &n, sizeof(n), m_ok);
+    for (std::size_t i = 0; i < m_actuators.size(); i++)
+    {
+        m_command.clear();
+        m_actuators[i]->saveCommand(m_command);
+        const unsigned int size = m_command.size();
+        write(m_file, &size, sizeof(size), m_ok);
+    }
+    const std::string random = tgRandom::forThread().getState();
+    const unsigned int length = random.size();
+    write(m_file, &length, sizeof(length), m_ok);
+    write(m_file, random.data(), length, m_ok);
+    if (!m_ok)
+    {
+        std::fclose(m_file);
+        throw std::runtime_error("Could not write " + path);
+    }
+}
+
+tgCommandRecorder::~tgCommandRecorder()
+{
+    flushSteps();
+    if (std::fclose(m_file) != 0 || !m_ok)
+    {
+        // Don't throw from the destructor
+        std::cerr << "Could not write " << m_path << std::endl;
+    }
+}
+
+void tgCommandRecorder::flushSteps()
+{
+    if (m_pendingSteps > 0)
+    {
+        const unsigned int n = m_pendingSteps;
+        writeByte(m_file, eSteps, m_ok);
+        write(m_file, &n, sizeof(n), m_ok);
+        m_pendingSteps = 0;
+    }
+}
+
+void tgCommandRecorder::endStep(double dt)
+{
+    if (dt != m_dt)
+    {
+        flushSteps();
+        writeByte(m_file, eStepSize, m_ok);
+        write(m_file, &dt, sizeof(dt), m_ok);
+        m_dt = dt;
+    }
+    for (std::size_t i = 0; i < m_actuators.size(); i++)
+    {
+        m_command.clear();
+        m_actuators[i]->saveCommand(m_command);
+        if (m_command == m_last[i])
+        {
+            continue;
+        }
+        flushSteps();
+        const unsigned int index = i;
+        writeByte(m_file, eCommand, m_ok);
+        write(m_file, &index, sizeof(index), m_ok);
+        if (!m_command.empty())
+        {
+            write(m_file, &m_command[0], m_command.size() * sizeof(double), m_ok);
+        }
+        m_last[i].swap(m_command);
+    }
+    m_pendingSteps++;
+    m_steps++;
+    if (!m_ok)
+    {
+        throw std::runtime_error("Could not write " + m_path);
+    }
+}
+
+tgCommandPlayer::tgCommandPlayer(const std::string& path,
+                                 const std::vector<tgSpringCableActuator*>& actuators) :
+m_file(std::fopen(path.c_str(), "rb")),
+m_path(path),
+m_actuators(actuators),
+m_dt(0.0),
+m_quietSteps(0),
+m_steps(0),
+m_finished(false)
+{
+    if (m_file == NULL)
+    {
+        throw std::runtime_error("Could not read " + path);
+    }
+
+    try
+    {
+        char fileMagic[sizeof(magic)];
+        unsigned int fileVersion = 0;
+        if (!read(m_file, fileMagic, sizeof(fileMagic)) ||
+            std::memcmp(fileMagic, magic, sizeof(magic)) != 0 ||
+            !read(m_file, &fileVersion, sizeof(fileVersion)) ||
+            fileVersion != version)
+        {
+            fail("is not a command log");
+        }
+
+        unsigned int n = 0;
+        if (!read(m_file, &n, sizeof(n)) || n != m_actuators.size())
+        {
+            fail("was recorded with a different number of actuators");
+        }
+        m_sizes.resize(n);
+        for (std::size_t i = 0; i < m_actuators.size(); i++)
+        {
+            m_command.clear();
+            m_actuators[i]->saveCommand(m_command);
+            if (!read(m_file, &m_sizes[i], sizeof(m_sizes[i])) ||
+                m_sizes[i] != m_command.size())
+            {
+                fail("was recorded with different actuators");
+            }
+        }
+
+        unsigned int length = 0;
+        if (!read(m_file, &length, sizeof(length)))
+        {
+            fail("is truncated");
+        }
+        std::string random(length, '\0');
+        if (length > 0 && !read(m_file, &random[0], length))
+        {
+            fail("is truncated");
+        }
+        tgRandom::forThread().setState(random);
+    }
+    catch (const std::invalid_argument& e)
+    {
+        std::fclose(m_file);
+        throw std::runtime_error(path + ": " + e.what());
+    }
+    catch (...)
+    {
+        std::fclose(m_file);
+        throw;
+    }
+}
+
+tgCommandPlayer::~tgCommandPlayer()
+{
+    std::fclose(m_file);
+}
+
+void tgCommandPlayer::fail(const std::string& what) const
+{
+    throw std::runtime_error(m_path + " " + what);
+}
+
+void tgCommandPlayer::beginStep(double dt)
+{
+    if (m_finished)
+    {
+        return;
+    }
+    if (m_quietSteps > 0)
+    {
+        m_quietSteps--;
+    }
+    else
+    {
+        // The records of this step, up to the count of steps they end
+        bool ended = false;
+        while (!ended)
+        {
+            const int c = std::fgetc(m_file);
+            if (c == EOF)
+            {
+                m_finished = true;
+                return;
+            }
+            else if (c == eStepSize)
+            {
+                if (!read(m_file, &m_dt, sizeof(m_dt)))
+                {
+                    fail("is truncated");
+                }
+            }
+            else if (c == eCommand)
+            {
+                unsigned int index = 0;
+                if (!read(m_file, &index, sizeof(index)) ||
+                    index >= m_actuators.size())
+                {
+                    fail("is damaged");
+                }
+                m_command.resize(m_sizes[index]);
+                if (!m_command.empty() &&
+                    !read(m_file, &m_command[0], m_command.size() * sizeof(double)))
+                {
+                    fail("is truncated");
+                }
+                m_actuators[index]->restoreCommand(m_command, 0);
+            }
+            else if (c == eSteps)
+            {
+                unsigned int n = 0;
+                if (!read(m_file, &n, sizeof(n)) || n == 0)
+                {
+                    fail("is damaged");
+                }
+                m_quietSteps = n - 1;
+                ended = true;
+            }
+            else
+            {
+                fail("is damaged");
+            }
+        }
+    }
+    if (dt != m_dt)
+    {
+        fail("was recorded with another step size");
+    }
+    m_steps++;
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_COMMAND_LOG_H
+#define TG_COMMAND_LOG_H
+
+/**
+ * @file tgCommandLog.h
+ * @brief Contains the definitions of classes tgCommandRecorder and
+ * tgCommandPlayer
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgSpringCableActuator;
+
+/**
+ * Writes the commands controllers give the actuators, step by step, to a
+ * compact binary log. With a deterministic simulation the log and the
+ * initial state reproduce a trial exactly, without the controllers,
+ * where a log of the poses would be orders of magnitude larger.
+ *
+ * After each step every actuator's tgSpringCableActuator::saveCommand is
+ * compared with what was last written for it, and only the actuators
+ * whose commands changed are written. Steps with no changes are counted
+ * rather than written, so a held command costs nothing. The position of
+ * the calling thread's tgRandom stream is kept in the header, for runs
+ * where something other than the controllers draws from it.
+ *
+ * Usually made through tgSimulation::recordCommands.
+ */
+class tgCommandRecorder
+{
+public:
+
+    /**
+     * Start a log.
+     * @param[in] path the file to write
+     * @param[in] actuators in the order tgSimulation finds them; not owned
+     * and must outlive the recorder
+     * @throw std::runtime_error if the file cannot be written
+     */
+    tgCommandRecorder(const std::string& path,
+                      const std::vector<tgSpringCableActuator*>& actuators);
+
+    /** Finish and close the log */
+    ~tgCommandRecorder();
+
+    /**
+     * Log the commands that changed over a step, once the step is done.
+     * @param[in] dt the step size
+     * @throw std::runtime_error if the file cannot be written
+     */
+    void endStep(double dt);
+
+    /** Steps logged so far */
+    unsigned long getSteps() const
+    {
+        return m_steps;
+    }
+
+private:
+
+    /** Write the count of steps since the last one with records */
+    void flushSteps();
+
+    /** Not copyable */
+    tgCommandRecorder(const tgCommandRecorder&);
+    tgCommandRecorder& operator=(const tgCommandRecorder&);
+
+    std::FILE* m_file;
+
+    std::string m_path;
+
+    const std::vector<tgSpringCableActuator*> m_actuators;
+
+    /** Each actuator's last written command */
+    std::vector< std::vector<double> > m_last;
+
+    /** Scratch for the current command */
+    std::vector<double> m_command;
+
+    /** The step size last written; 0 before the first */
+    double m_dt;
+
+    /** Steps ended and not yet written */
+    unsigned long m_pendingSteps;
+
+    unsigned long m_steps;
+
+    /** False once a write fails */
+    bool m_ok;
+};
+
+/**
+ * Gives the actuators the commands a tgCommandRecorder logged, one step
+ * at a time. The simulation must start from the state the recording
+ * started from, with the same actuators, and its models must not have
+ * their controllers, which would overwrite the commands. Commands are
+ * applied after the world steps and before the models do, which is
+ * where controllers notified before their actuators step give them.
+ *
+ * Usually made through tgSimulation::replayCommands.
+ */
+class tgCommandPlayer
+{
+public:
+
+    /**
+     * Open a log and put the calling thread's tgRandom stream where it
+     * was when the recording started.
+     * @param[in] path the file to read
+     * @param[in] actuators in the order tgSimulation finds them; not owned
+     * and must outlive the player
+     * @throw std::runtime_error if the file cannot be read, or was
+     * recorded with other actuators
+     */
+    tgCommandPlayer(const std::string& path,
+                    const std::vector<tgSpringCableActuator*>& actuators);
+
+    ~tgCommandPlayer();
+
+    /**
+     * Apply the commands of the next step. Once the log is finished the
+     * actuators keep their last commands.
+     * @param[in] dt the step size
+     * @throw std::runtime_error if dt is not the recorded step size or
+     * the log is damaged
+     */
+    void beginStep(double dt);
+
+    /** True once every logged step has been played */
+    bool isFinished() const
+    {
+        return m_finished;
+    }
+
+    /** Steps played so far */
+    unsigned long getSteps() const
+    {
+        return m_steps;
+    }
+
+private:
+
+    /** Throw that the log is damaged */
+    void fail(const std::string& what) const;
+
+    /** Not copyable */
+    tgCommandPlayer(const tgCommandPlayer&);
+    tgCommandPlayer& operator=(const tgCommandPlayer&);
+
+    std::FILE* m_file;
+
+    std::string m_path;
+
+    const std::vector<tgSpringCableActuator*> m_actuators;
+
+    /** Each actuator's command size, from the log */
+    std::vector<unsigned int> m_sizes;
+
+    /** Scratch for one actuator's command */
+    std::vector<double> m_command;
+
+    /** The recorded step size */
+    double m_dt;
+
+    /** Steps of the current run still to play without records */
+    unsigned long m_quietSteps;
+
+    unsigned long m_steps;
+
+    bool m_finished;
+};
+
+#endif  // TG_COMMAND_LOG_H
@@ -143,6 +143,12 @@ void tgCompressionSpringActuator::teardown()
     tgModel::teardown();
 }
 
+void tgCompressionSpringActuator::resetEpisode()
+{
+    notifyReset();
+    tgModel::resetEpisode();
+}
+
 /**
  * The step function calls on the tgBulletCompressionSpring to apply forces.
  * Since this class does not currently do any actuation, this function is the
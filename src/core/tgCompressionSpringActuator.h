@@ -164,6 +164,11 @@ public:
    * Notifies observers of teardown, teardown any children
    */
   virtual void teardown();
+
+  /**
+   * Notifies observers of a new episode, resets any children
+   */
+  virtual void resetEpisode();
     
   /**
    * Step dt forward with the simulation.
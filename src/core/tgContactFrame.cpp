@@ -0,0 +1,146 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgContactFrame.cpp
+ * @brief Contains the definitions of members of class tgContactFrame
+ * $Id$
+ */
+
+// This module
+#include "tgContactFrame.h"
+// This application
+#include "tgRigidStateFrame.h"
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btDispatcher.h"
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <cassert>
+
+namespace
+{
+    /** Add a contact point to the summary of a body, if it has one */
+    void addContact(const btCollisionObject* pObject,
+                    const tgRigidStateFrame::RigidState* pFirst,
+                    std::vector<tgContactFrame::ContactSummary>& summaries,
+                    double impulse, const btVector3& point)
+    {
+        const btRigidBody* const pBody = btRigidBody::upcast(pObject);
+        if (pBody == NULL)
+        {
+            return;
+        }
+        const tgRigidStateFrame::RigidState* const pState =
+            tgRigidStateFrame::find(pBody);
+        if (pState == NULL)
+        {
+            return;
+        }
+        assert(pState >= pFirst && pState < pFirst + summaries.size());
+        tgContactFrame::ContactSummary& summary = summaries[pState - pFirst];
+        summary.normalImpulse += impulse;
+        summary.contactCount++;
+        // The sum for now; build divides it
+        summary.centroid += point;
+    }
+}
+
+tgContactFrame::tgContactFrame() :
+m_pStates(NULL),
+m_builtFrameCount(0)
+{
+}
+
+void tgContactFrame::clear()
+{
+    m_summaries.clear();
+    m_pStates = NULL;
+    m_builtFrameCount = 0;
+}
+
+void tgContactFrame::build(btDispatcher& dispatcher,
+                           const tgRigidStateFrame& states)
+{
+    const std::vector<tgRigidStateFrame::RigidState>& rigids =
+        states.getStates();
+    ContactSummary none;
+    none.normalImpulse = 0.0;
+    none.contactCount = 0;
+    none.centroid.setZero();
+    m_summaries.assign(rigids.size(), none);
+    m_pStates = &states;
+    m_builtFrameCount = states.getFrameCount();
+    if (rigids.empty())
+    {
+        return;
+    }
+
+    const int n = dispatcher.getNumManifolds();
+    for (int i = 0; i < n; i++)
+    {
+        const btPersistentManifold* const pManifold =
+            dispatcher.getManifoldByIndexInternal(i);
+        const int m = pManifold->getNumContacts();
+        for (int j = 0; j < m; j++)
+        {
+            const btManifoldPoint& point = pManifold->getContactPoint(j);
+            const double impulse = point.getAppliedImpulse();
+            // Points a little apart are kept in the manifold as well
+            if (point.getDistance() > 0.0 && impulse <= 0.0)
+            {
+                continue;
+            }
+            addContact(pManifold->getBody0(), &rigids[0], m_summaries,
+                       impulse, point.getPositionWorldOnA());
+            addContact(pManifold->getBody1(), &rigids[0], m_summaries,
+                       impulse, point.getPositionWorldOnB());
+        }
+    }
+
+    for (std::size_t i = 0; i < m_summaries.size(); i++)
+    {
+        if (m_summaries[i].contactCount > 0)
+        {
+            m_summaries[i].centroid /= m_summaries[i].contactCount;
+        }
+    }
+}
+
+const tgContactFrame::ContactSummary*
+tgContactFrame::find(const btRigidBody* pBody) const
+{
+    assert(pBody != NULL);
+    const tgRigidStateFrame::RigidState* const pState =
+        tgRigidStateFrame::find(pBody);
+    if (pState == NULL || m_pStates == NULL ||
+        m_summaries.size() != m_pStates->getStates().size() ||
+        m_summaries.empty())
+    {
+        return NULL;
+    }
+    const std::vector<tgRigidStateFrame::RigidState>& rigids =
+        m_pStates->getStates();
+    // Only a body of the frame we were built from
+    if (pState < &rigids[0] || pState >= &rigids[0] + rigids.size())
+    {
+        return NULL;
+    }
+    return &m_summaries[pState - &rigids[0]];
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_CONTACT_FRAME_H
+#define TG_CONTACT_FRAME_H
+
+/**
+ * @file tgContactFrame.h
+ * @brief Contains the definition of class tgContactFrame
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <vector>
+
+// Forward declarations
+class btDispatcher;
+class btRigidBody;
+class tgRigidStateFrame;
+
+/**
+ * A summary of the contacts on every rigid body in a world, made from
+ * Bullet's persistent manifolds in one walk over them. The world makes
+ * it at most once per step, the first time it is asked for after the
+ * step, so contact sensors and controllers share the walk and worlds
+ * nobody asks pay nothing.
+ *
+ * The summaries are parallel to the world's tgRigidStateFrame, whose
+ * user pointers find them.
+ */
+class tgContactFrame
+{
+public:
+
+    /** The contacts on one rigid body */
+    struct ContactSummary
+    {
+        /**
+         * The sum of the normal impulses the solver applied at the
+         * contact points in the last step; divide by the step for a force
+         */
+        double normalImpulse;
+        /** The contact points, touching or pushing */
+        int contactCount;
+        /** The mean of the points on this body; zero if there are none */
+        btVector3 centroid;
+    };
+
+    tgContactFrame();
+
+    /**
+     * Summarize the contacts of the last step.
+     * @param[in] dispatcher the dynamics world's dispatcher
+     * @param[in] states the world's frame, already published for the step
+     */
+    void build(btDispatcher& dispatcher, const tgRigidStateFrame& states);
+
+    /** Forget the summaries, e.g. when the world goes away */
+    void clear();
+
+    /**
+     * The summary of a body.
+     * @param[in] pBody any rigid body
+     * @return NULL if the body was not in the rigid state frame of the
+     * last build
+     */
+    const ContactSummary* find(const btRigidBody* pBody) const;
+
+    /** The summaries, parallel to tgRigidStateFrame::getStates */
+    const std::vector<ContactSummary>& getSummaries() const
+    {
+        return m_summaries;
+    }
+
+    /**
+     * The tgRigidStateFrame::getFrameCount of the last build, so that
+     * the world can tell if it is out of date; 0 before any build.
+     */
+    std::size_t getBuiltFrameCount() const
+    {
+        return m_builtFrameCount;
+    }
+
+private:
+
+    std::vector<ContactSummary> m_summaries;
+
+    /** The frame of the last build, to find the summaries by */
+    const tgRigidStateFrame* m_pStates;
+
+    std::size_t m_builtFrameCount;
+};
+
+#endif  // TG_CONTACT_FRAME_H
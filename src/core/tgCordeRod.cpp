@@ -0,0 +1,647 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCordeRod.cpp
+ * @brief Contains the definitions of members of class tgCordeRod
+ * @author Brian Mirletz
+ * $Id$
+ */
+
+// This module
+#include "tgCordeRod.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+tgCordeRod::Config::Config(std::size_t res,
+                           double r, double d,
+                           double ym, double shm,
+                           double stm, double csc,
+                           double gt, double gr) :
+resolution(res),
+radius(r),
+density(d),
+YoungMod(ym),
+ShearMod(shm),
+StretchMod(stm),
+ConsSpringConst(csc),
+gammaT(gt),
+gammaR(gr)
+{
+    if (res < 2)
+    {
+        throw std::invalid_argument("Corde rod needs at least two mass points.");
+    }
+    else if (r <= 0.0)
+    {
+        throw std::invalid_argument("Corde string radius is not positive.");
+    }
+    else if (d <= 0.0)
+    {
+        throw std::invalid_argument("Corde String density is not positive.");
+    }
+    else if (ym < 0.0)
+    {
+        throw std::invalid_argument("String Young's Modulus is negative.");
+    }
+    else if (shm < 0.0)
+    {
+        throw std::invalid_argument("Shear Modulus is negative.");
+    }
+    else if (stm < 0.0)
+    {
+        throw std::invalid_argument("Stretch Modulus is negative.");
+    }
+    else if (csc < 0.0)
+    {
+        throw std::invalid_argument("Spring Constant is negative.");
+    }
+    else if (gt < 0.0)
+    {
+        throw std::invalid_argument("Damping Constant (position) is negative.");
+    }
+    else if (gr < 0.0)
+    {
+        throw std::invalid_argument("Damping Constant (rotation) is negative.");
+    }
+}
+
+tgCordeRod::tgCordeRod(const btVector3& pos1, const btVector3& pos2,
+                       const btQuaternion& quat1, const btQuaternion& quat2,
+                       const Config& config) :
+m_config(config)
+{
+    const std::size_t n = m_config.resolution;
+    const std::size_t links = n - 1;
+
+    const double pir2 = M_PI * m_config.radius * m_config.radius;
+    m_stiffness[0] = m_config.StretchMod * pir2;
+    m_stiffness[1] = m_config.YoungMod * pir2 / 4.0;
+    m_stiffness[2] = m_config.YoungMod * pir2 / 4.0;
+    m_stiffness[3] = m_config.ShearMod * pir2 / 2.0;
+    // Assuming products of inertia are negligible, as in the paper
+    m_inertia[0] = m_config.density * pir2 / 4.0;
+    m_inertia[1] = m_config.density * pir2 / 4.0;
+    m_inertia[2] = m_config.density * pir2 / 2.0;
+    for (int i = 0; i < 3; i++)
+    {
+        m_inverseInertia[i] = 1.0 / m_inertia[i];
+    }
+
+    const btVector3 unitLength((pos2 - pos1) / (double) links);
+    const double unitMass = m_config.density * pir2 * unitLength.length();
+
+    m_px.resize(n);
+    m_py.resize(n);
+    m_pz.resize(n);
+    m_vx.assign(n, 0.0);
+    m_vy.assign(n, 0.0);
+    m_vz.assign(n, 0.0);
+    m_fx.assign(n, 0.0);
+    m_fy.assign(n, 0.0);
+    m_fz.assign(n, 0.0);
+    m_mass.assign(n, unitMass);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const btVector3 pos = pos1 + unitLength * (double) i;
+        m_px[i] = pos.x();
+        m_py[i] = pos.y();
+        m_pz[i] = pos.z();
+    }
+    m_linkLength.assign(links, unitLength.length());
+
+    // One centerline element per link
+    m_q0.resize(links);
+    m_q1.resize(links);
+    m_q2.resize(links);
+    m_q3.resize(links);
+    for (std::size_t i = 0; i < links; i++)
+    {
+        const btQuaternion q = quat1.slerp(quat2, (double) i / (double) links).normalized();
+        m_q0[i] = q.x();
+        m_q1[i] = q.y();
+        m_q2[i] = q.z();
+        m_q3[i] = q.w();
+    }
+    m_qd0.assign(links, 0.0);
+    m_qd1.assign(links, 0.0);
+    m_qd2.assign(links, 0.0);
+    m_qd3.assign(links, 0.0);
+    m_tp0.assign(links, 0.0);
+    m_tp1.assign(links, 0.0);
+    m_tp2.assign(links, 0.0);
+    m_tp3.assign(links, 0.0);
+    m_wx.assign(links, 0.0);
+    m_wy.assign(links, 0.0);
+    m_wz.assign(links, 0.0);
+    m_quaternionShape.assign(links - 1, unitLength.length());
+
+    m_lfx.resize(links);
+    m_lfy.resize(links);
+    m_lfz.resize(links);
+    m_cax.resize(links);
+    m_cay.resize(links);
+    m_caz.resize(links);
+    m_cbx.resize(links);
+    m_cby.resize(links);
+    m_cbz.resize(links);
+    m_ta0.resize(links - 1);
+    m_ta1.resize(links - 1);
+    m_ta2.resize(links - 1);
+    m_ta3.resize(links - 1);
+    m_tb0.resize(links - 1);
+    m_tb1.resize(links - 1);
+    m_tb2.resize(links - 1);
+    m_tb3.resize(links - 1);
+
+    assert(invariant());
+}
+
+void tgCordeRod::attach(End end, btRigidBody* pBody)
+{
+    Anchor& anchor = m_anchors[end];
+    anchor.pBody = pBody;
+    anchor.impulse.setZero();
+    if (pBody != NULL)
+    {
+        const std::size_t i = (end == eStart) ? 0 : getResolution() - 1;
+        anchor.localPoint =
+            pBody->getCenterOfMassTransform().inverse() * getPosition(i);
+    }
+}
+
+void tgCordeRod::integrate(double dt, std::size_t substeps)
+{
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("Timestep is not positive.");
+    }
+    if (substeps == 0)
+    {
+        throw std::invalid_argument("Substeps is zero.");
+    }
+
+    const double h = dt / substeps;
+    const std::size_t last = getResolution() - 1;
+    for (std::size_t s = 0; s < substeps; s++)
+    {
+        followAnchors();
+        computeInternalForces();
+        if (m_anchors[eStart].pBody)
+        {
+            m_anchors[eStart].impulse += getForce(0) * h;
+        }
+        if (m_anchors[eEnd].pBody)
+        {
+            m_anchors[eEnd].impulse += getForce(last) * h;
+        }
+        unconstrainedMotion(h);
+    }
+    followAnchors();
+
+    assert(invariant());
+}
+
+void tgCordeRod::applyAnchorImpulses()
+{
+    for (int end = eStart; end <= eEnd; end++)
+    {
+        Anchor& anchor = m_anchors[end];
+        if (anchor.pBody != NULL)
+        {
+            const std::size_t i = (end == eStart) ? 0 : getResolution() - 1;
+            const btVector3 relPos =
+                getPosition(i) - anchor.pBody->getCenterOfMassPosition();
+            anchor.pBody->activate();
+            anchor.pBody->applyImpulse(anchor.impulse, relPos);
+            anchor.impulse.setZero();
+        }
+    }
+}
+
+void tgCordeRod::step(double dt, std::size_t substeps)
+{
+    integrate(dt, substeps);
+    applyAnchorImpulses();
+}
+
+double tgCordeRod::getLength() const
+{
+    double length = 0.0;
+    for (std::size_t i = 0; i + 1 < getResolution(); i++)
+    {
+        length += getPosition(i).distance(getPosition(i + 1));
+    }
+    return length;
+}
+
+void tgCordeRod::followAnchors()
+{
+    for (int end = eStart; end <= eEnd; end++)
+    {
+        const Anchor& anchor = m_anchors[end];
+        if (anchor.pBody != NULL)
+        {
+            const std::size_t i = (end == eStart) ? 0 : getResolution() - 1;
+            const btVector3 pos =
+                anchor.pBody->getCenterOfMassTransform() * anchor.localPoint;
+            const btVector3 vel = anchor.pBody->getVelocityInLocalPoint(
+                pos - anchor.pBody->getCenterOfMassPosition());
+            m_px[i] = pos.x();
+            m_py[i] = pos.y();
+            m_pz[i] = pos.z();
+            m_vx[i] = vel.x();
+            m_vy[i] = vel.y();
+            m_vz[i] = vel.z();
+        }
+    }
+}
+
+void tgCordeRod::computeInternalForces()
+{
+    const std::size_t links = m_linkLength.size();
+    const double k0 = m_stiffness[0];
+    const double csc = m_config.ConsSpringConst;
+    const double gammaT = m_config.gammaT;
+
+    const double* const px = &m_px[0];
+    const double* const py = &m_py[0];
+    const double* const pz = &m_pz[0];
+    const double* const vx = &m_vx[0];
+    const double* const vy = &m_vy[0];
+    const double* const vz = &m_vz[0];
+    const double* const q0 = &m_q0[0];
+    const double* const q1 = &m_q1[0];
+    const double* const q2 = &m_q2[0];
+    const double* const q3 = &m_q3[0];
+    const double* const linkLength = &m_linkLength[0];
+
+    double* const lfx = &m_lfx[0];
+    double* const lfy = &m_lfy[0];
+    double* const lfz = &m_lfz[0];
+    double* const cax = &m_cax[0];
+    double* const cay = &m_cay[0];
+    double* const caz = &m_caz[0];
+    double* const cbx = &m_cbx[0];
+    double* const cby = &m_cby[0];
+    double* const cbz = &m_cbz[0];
+    double* const tp0 = &m_tp0[0];
+    double* const tp1 = &m_tp1[0];
+    double* const tp2 = &m_tp2[0];
+    double* const tp3 = &m_tp3[0];
+
+    // Links: stretch, dissipation and quaternion alignment
+    for (std::size_t i = 0; i < links; i++)
+    {
+        const double dx = px[i] - px[i + 1];
+        const double dy = py[i] - py[i + 1];
+        const double dz = pz[i] - pz[i + 1];
+        const double dvx = vx[i] - vx[i + 1];
+        const double dvy = vy[i] - vy[i + 1];
+        const double dvz = vz[i] - vz[i + 1];
+
+        const double q11 = q0[i];
+        const double q12 = q1[i];
+        const double q13 = q2[i];
+        const double q14 = q3[i];
+
+        const double posNorm_2 = dx * dx + dy * dy + dz * dz;
+        const double posNorm = std::sqrt(posNorm_2);
+        const double posNorm_3 = posNorm_2 * posNorm;
+        const double length = linkLength[i];
+        const double length_5 = length * length * length * length * length;
+
+        const double director0 = 2.0 * (q11 * q13 + q12 * q14);
+        const double director1 = 2.0 * (q12 * q13 - q11 * q14);
+        const double director2 = -1.0 * q11 * q11 - q12 * q12 + q13 * q13 + q14 * q14;
+
+        const double spring_common = k0 * (length - posNorm) / (length * posNorm);
+        const double diss_common = gammaT * posNorm_2 *
+            (dx * dvx + dy * dvy + dz * dvz) / length_5;
+        const double common = spring_common + diss_common;
+
+        const double cons_common = csc * length / posNorm_3;
+        const double quat_cons_x = cons_common *
+            (director2 * dx * dz - director0 * (dy * dy + dz * dz) + director1 * dx * dy);
+        const double quat_cons_y = cons_common *
+            (-1.0 * director2 * dy * dz + director1 * (dx * dx + dz * dz) - director0 * dx * dz);
+        const double quat_cons_z = cons_common *
+            (-1.0 * director0 * dy * dz + director2 * (dx * dx + dy * dy) - director1 * dx * dz);
+
+        // On the first point; the second gets the opposite
+        lfx[i] = -1.0 * dx * common;
+        lfy[i] = -1.0 * dy * common;
+        lfz[i] = -1.0 * dz * common;
+
+        cax[i] = quat_cons_x;
+        cay[i] = quat_cons_y;
+        caz[i] = quat_cons_z;
+        cbx[i] = quat_cons_x;
+        cby[i] = quat_cons_y;
+        cbz[i] = quat_cons_z;
+
+        // Torques from the alignment constraint. q.length2() should be
+        // one, but rounding makes it slightly greater, and the
+        // simulation is much more stable if we just assume it is.
+        const double torque_common = 2.0 * csc * length;
+        tp0[i] = torque_common * (q11 + (q13 * dx - q14 * dy - q11 * dz) / posNorm);
+        tp1[i] = torque_common * (q12 + (q14 * dx + q13 * dy - q12 * dz) / posNorm);
+        tp2[i] = torque_common * (q13 + (q11 * dx + q12 * dy + q13 * dz) / posNorm);
+        tp3[i] = torque_common * (q14 + (q12 * dx - q11 * dy + q14 * dz) / posNorm);
+    }
+
+    // Boundary conditions of the constraint: the first link only pushes
+    // its second point, the last only its first
+    cax[0] = 0.0;
+    cay[0] = 0.0;
+    caz[0] = 0.0;
+    if (links > 1)
+    {
+        cbx[links - 1] = 0.0;
+        cby[links - 1] = 0.0;
+        cbz[links - 1] = 0.0;
+    }
+
+    // Gather the link terms onto the points
+    double* const fx = &m_fx[0];
+    double* const fy = &m_fy[0];
+    double* const fz = &m_fz[0];
+    fx[0] = lfx[0] - cax[0];
+    fy[0] = lfy[0] - cay[0];
+    fz[0] = lfz[0] - caz[0];
+    for (std::size_t j = 1; j < links; j++)
+    {
+        fx[j] = lfx[j] - cax[j] - lfx[j - 1] + cbx[j - 1];
+        fy[j] = lfy[j] - cay[j] - lfy[j - 1] + cby[j - 1];
+        fz[j] = lfz[j] - caz[j] - lfz[j - 1] + cbz[j - 1];
+    }
+    fx[links] = -lfx[links - 1] + cbx[links - 1];
+    fy[links] = -lfy[links - 1] + cby[links - 1];
+    fz[links] = -lfz[links - 1] + cbz[links - 1];
+
+    const std::size_t pairs = links - 1;
+    if (pairs == 0)
+    {
+        return;
+    }
+
+    const double* const qd0 = &m_qd0[0];
+    const double* const qd1 = &m_qd1[0];
+    const double* const qd2 = &m_qd2[0];
+    const double* const qd3 = &m_qd3[0];
+    const double* const quaternionShape = &m_quaternionShape[0];
+    double* const ta0 = &m_ta0[0];
+    double* const ta1 = &m_ta1[0];
+    double* const ta2 = &m_ta2[0];
+    double* const ta3 = &m_ta3[0];
+    double* const tb0 = &m_tb0[0];
+    double* const tb1 = &m_tb1[0];
+    double* const tb2 = &m_tb2[0];
+    double* const tb3 = &m_tb3[0];
+
+    const double k1 = m_stiffness[1];
+    const double k2 = m_stiffness[2];
+    const double k3 = m_stiffness[3];
+    const double gammaR = m_config.gammaR;
+
+    // Pairs of centerline elements: bending, torsion and their damping.
+    // The derivatives do not leave many common factors.
+    for (std::size_t i = 0; i < pairs; i++)
+    {
+        const double q11 = q0[i];
+        const double q12 = q1[i];
+        const double q13 = q2[i];
+        const double q14 = q3[i];
+
+        const double q21 = q0[i + 1];
+        const double q22 = q1[i + 1];
+        const double q23 = q2[i + 1];
+        const double q24 = q3[i + 1];
+
+        const double qdot11 = qd0[i];
+        const double qdot12 = qd1[i];
+        const double qdot13 = qd2[i];
+        const double qdot14 = qd3[i];
+
+        const double qdot21 = qd0[i + 1];
+        const double qdot22 = qd1[i + 1];
+        const double qdot23 = qd2[i + 1];
+        const double qdot24 = qd3[i + 1];
+
+        const double shape = quaternionShape[i];
+
+        /* Bending and torsional stiffness */
+        const double stiffness_common = 4.0 / shape * (shape - 1.0) * (shape - 1.0);
+
+        const double q11_stiffness = stiffness_common *
+        (k1 * q24 * (q11 * q24 + q12 * q23 - q13 * q22 - q14 * q21) +
+         k2 * q23 * (q11 * q23 - q12 * q24 - q13 * q21 + q14 * q22) +
+         k3 * q22 * (q11 * q22 - q12 * q21 + q13 * q24 - q14 * q23));
+
+        const double q12_stiffness = stiffness_common *
+        (k1 * q23 * (q12 * q23 + q11 * q24 - q13 * q22 - q14 * q21) +
+         k2 * q24 * (q12 * q24 - q11 * q23 + q13 * q21 - q14 * q22) +
+         k3 * q21 * (q12 * q21 - q11 * q22 - q13 * q24 + q14 * q23));
+
+        const double q13_stiffness = stiffness_common *
+        (k1 * q22 * (q13 * q22 - q11 * q24 - q12 * q23 + q14 * q21) +
+         k2 * q21 * (q13 * q21 - q11 * q23 + q12 * q24 - q14 * q22) +
+         k3 * q24 * (q13 * q24 + q11 * q22 - q12 * q21 - q14 * q23));
+
+        const double q14_stiffness = stiffness_common *
+        (k1 * q21 * (q14 * q21 - q11 * q24 - q12 * q23 + q13 * q22) +
+         k2 * q22 * (q14 * q22 + q11 * q23 - q12 * q24 - q13 * q21) +
+         k3 * q23 * (q14 * q23 - q11 * q22 + q12 * q21 - q13 * q24));
+
+        const double q21_stiffness = stiffness_common *
+        (k1 * q14 * (q14 * q21 - q11 * q24 - q12 * q23 + q13 * q22) +
+         k2 * q13 * (q13 * q21 - q11 * q23 + q12 * q24 - q14 * q22) +
+         k3 * q12 * (q12 * q21 - q11 * q22 + q14 * q23 - q13 * q24));
+
+        const double q22_stiffness = stiffness_common *
+        (k1 * q13 * (q13 * q22 - q11 * q24 - q12 * q23 + q14 * q21) +
+         k2 * q14 * (q14 * q22 + q11 * q23 - q12 * q24 - q13 * q21) +
+         k3 * q11 * (q11 * q22 - q12 * q21 + q13 * q24 - q14 * q23));
+
+        const double q23_stiffness = stiffness_common *
+        (k1 * q12 * (q12 * q23 + q11 * q24 - q13 * q22 - q14 * q21) +
+         k2 * q11 * (q11 * q23 - q13 * q21 - q12 * q24 + q14 * q22) +
+         k3 * q14 * (q14 * q23 - q11 * q22 + q12 * q21 - q13 * q24));
+
+        const double q24_stiffness = stiffness_common *
+        (k1 * q11 * (q11 * q24 + q12 * q23 - q13 * q22 - q14 * q21) +
+         k2 * q12 * (q12 * q24 - q11 * q23 + q13 * q21 - q14 * q22) +
+         k3 * q13 * (q13 * q24 + q11 * q22 - q12 * q21 - q14 * q23));
+
+        /* Torsional Damping */
+        const double damping_common = 4.0 * gammaR / shape;
+
+        const double q11_damping = damping_common *
+        (q12 * (q12 * qdot11 - q11 * qdot12 + q21 * qdot22 - q22 * qdot21 - q23 * qdot24 + q24 * qdot23) +
+         q13 * (q13 * qdot11 - q11 * qdot13 + q21 * qdot23 + q22 * qdot24 - q23 * qdot21 - q24 * qdot22) +
+         q14 * (q14 * qdot11 - q11 * qdot14 + q21 * qdot24 - q22 * qdot23 + q23 * qdot22 - q24 * qdot21));
+
+        const double q12_damping = damping_common *
+        (q11 * (q11 * qdot12 - q12 * qdot11 - q21 * qdot22 + q22 * qdot21 + q23 * qdot24 - q24 * qdot23) +
+         q13 * (q13 * qdot12 - q13 * qdot13 - q21 * qdot24 + q22 * qdot23 - q23 * qdot22 + q24 * qdot21) +
+         q14 * (q14 * qdot12 - q14 * qdot14 + q21 * qdot23 + q22 * qdot24 - q23 * qdot21 - q24 * qdot22));
+
+        const double q13_damping = damping_common *
+        (q11 * (q11 * qdot13 - q13 * qdot11 - q21 * qdot23 - q22 * qdot24 + q23 * qdot21 + q24 * qdot22) +
+         q12 * (q12 * qdot13 - q13 * qdot12 + q21 * qdot24 - q22 * qdot23 + q23 * qdot22 - q24 * qdot21) +
+         q14 * (q14 * qdot13 - q13 * qdot14 - q21 * qdot22 + q22 * qdot21 + q23 * qdot24 - q24 * qdot23));
+
+        const double q14_damping = damping_common *
+        (q11 * (q11 * qdot14 - q14 * qdot11 - q21 * qdot24 + q22 * qdot23 - q23 * qdot22 + q24 * qdot21) +
+         q12 * (q12 * qdot14 - q14 * qdot12 - q21 * qdot23 - q22 * qdot24 + q23 * qdot21 + q24 * qdot22) +
+         q13 * (q13 * qdot14 - q14 * qdot13 + q21 * qdot22 - q22 * qdot21 - q23 * qdot24 + q24 * qdot23));
+
+        const double q21_damping = damping_common *
+        (q22 * (q22 * qdot21 + q11 * qdot12 - q12 * qdot11 - q13 * qdot14 + q14 * qdot13 - q21 * qdot22) +
+         q23 * (q23 * qdot21 + q11 * qdot13 + q12 * qdot14 - q13 * qdot11 - q14 * qdot12 - q21 * qdot23) +
+         q24 * (q24 * qdot21 + q11 * qdot14 - q12 * qdot13 + q13 * qdot12 - q14 * qdot11 - q21 * qdot24));
+
+        const double q22_damping = damping_common *
+        (q21 * (q21 * qdot22 - q11 * qdot12 + q12 * qdot11 + q13 * qdot14 - q14 * qdot13 - q22 * qdot21) +
+         q23 * (q23 * qdot22 - q11 * qdot14 + q12 * qdot13 - q13 * qdot12 + q14 * qdot11 - q22 * qdot23) +
+         q24 * (q24 * qdot22 + q11 * qdot13 + q12 * qdot14 - q13 * qdot11 - q14 * qdot12 - q22 * qdot24));
+
+        const double q23_damping = damping_common *
+        (q21 * (q21 * qdot23 - q11 * qdot13 + q13 * qdot11 - q12 * qdot14 + q14 * qdot12 - q23 * qdot21) +
+         q22 * (q22 * qdot23 + q11 * qdot14 - q12 * qdot13 + q13 * qdot12 - q14 * qdot11 - q22 * qdot22) +
+         q24 * (q24 * qdot23 - q11 * qdot12 + q12 * qdot11 + q13 * qdot14 - q14 * qdot13 - q23 * qdot24));
+
+        const double q24_damping = damping_common *
+        (q21 * (q21 * qdot24 - q11 * qdot14 + q12 * qdot13 - q13 * qdot12 + q14 * qdot11 - q24 * qdot21) +
+         q22 * (q21 * qdot24 - q11 * qdot13 - q12 * qdot14 + q13 * qdot11 + q14 * qdot12 - q24 * qdot22) +
+         q23 * (q23 * qdot24 + q11 * qdot12 - q12 * qdot11 - q13 * qdot14 + q14 * qdot13 - q24 * qdot23));
+
+        ta0[i] = q11_stiffness + q11_damping;
+        ta1[i] = q12_stiffness + q12_damping;
+        ta2[i] = q13_stiffness + q13_damping;
+        ta3[i] = q14_stiffness + q14_damping;
+
+        tb0[i] = q21_stiffness + q21_damping;
+        tb1[i] = q22_stiffness + q22_damping;
+        tb2[i] = q23_stiffness + q23_damping;
+        tb3[i] = q24_stiffness + q24_damping;
+    }
+
+    // Gather the pair terms onto the elements
+    for (std::size_t j = 0; j < pairs; j++)
+    {
+        tp0[j] += ta0[j];
+        tp1[j] += ta1[j];
+        tp2[j] += ta2[j];
+        tp3[j] += ta3[j];
+    }
+    for (std::size_t j = 1; j <= pairs; j++)
+    {
+        tp0[j] += tb0[j - 1];
+        tp1[j] += tb1[j - 1];
+        tp2[j] += tb2[j - 1];
+        tp3[j] += tb3[j - 1];
+    }
+}
+
+void tgCordeRod::unconstrainedMotion(double dt)
+{
+    const std::size_t n = getResolution();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        // Velocity update - semi-implicit Euler
+        const double scale = dt / m_mass[i];
+        m_vx[i] += scale * m_fx[i];
+        m_vy[i] += scale * m_fy[i];
+        m_vz[i] += scale * m_fz[i];
+        // Position update, uses v(t + dt)
+        m_px[i] += dt * m_vx[i];
+        m_py[i] += dt * m_vy[i];
+        m_pz[i] += dt * m_vz[i];
+    }
+
+    const double I0 = m_inertia[0];
+    const double I1 = m_inertia[1];
+    const double I2 = m_inertia[2];
+    const double invI0 = m_inverseInertia[0];
+    const double invI1 = m_inverseInertia[1];
+    const double invI2 = m_inverseInertia[2];
+
+    const std::size_t links = m_q0.size();
+    for (std::size_t i = 0; i < links; i++)
+    {
+        const double q0 = m_q0[i];
+        const double q1 = m_q1[i];
+        const double q2 = m_q2[i];
+        const double q3 = m_q3[i];
+        const double tp0 = m_tp0[i];
+        const double tp1 = m_tp1[i];
+        const double tp2 = m_tp2[i];
+        const double tp3 = m_tp3[i];
+
+        /* Transpose quaternion torques into Euclidean torques */
+        const double tx = 0.5 * (q0 * tp2 - q2 * tp0 - q1 * tp3 + q3 * tp1);
+        const double ty = 0.5 * (q1 * tp0 - q0 * tp1 - q2 * tp3 + q3 * tp2);
+        const double tz = 0.5 * (q0 * tp0 + q1 * tp1 + q2 * tp2 + q3 * tp3);
+
+        // Since I is diagonal, omega x (I omega) is done by components
+        const double wx = m_wx[i];
+        const double wy = m_wy[i];
+        const double wz = m_wz[i];
+        const double nwx = wx + invI0 * (tx - (wy * I2 * wz - wz * I1 * wy)) * dt;
+        const double nwy = wy + invI1 * (ty - (wz * I0 * wx - wx * I2 * wz)) * dt;
+        const double nwz = wz + invI2 * (tz - (wx * I1 * wy - wy * I0 * wx)) * dt;
+        m_wx[i] = nwx;
+        m_wy[i] = nwy;
+        m_wz[i] = nwz;
+
+        const double qd0 = 0.5 * (q0 * nwz + q1 * nwy - q2 * nwx);
+        const double qd1 = 0.5 * (q1 * nwz - q0 * nwy + q3 * nwx);
+        const double qd2 = 0.5 * (q0 * nwx + q2 * nwz + q3 * nwy);
+        const double qd3 = 0.5 * (q3 * nwz - q2 * nwy - q1 * nwx);
+        m_qd0[i] = qd0;
+        m_qd1[i] = qd1;
+        m_qd2[i] = qd2;
+        m_qd3[i] = qd3;
+
+        const double n0 = q0 + qd0 * dt;
+        const double n1 = q1 + qd1 * dt;
+        const double n2 = q2 + qd2 * dt;
+        const double n3 = q3 + qd3 * dt;
+        const double inverseNorm = 1.0 / std::sqrt(n0 * n0 + n1 * n1 + n2 * n2 + n3 * n3);
+        m_q0[i] = n0 * inverseNorm;
+        m_q1[i] = n1 * inverseNorm;
+        m_q2[i] = n2 * inverseNorm;
+        m_q3[i] = n3 * inverseNorm;
+    }
+}
+
+bool tgCordeRod::invariant() const
+{
+    const std::size_t n = m_px.size();
+    return (n >= 2) &&
+        (m_linkLength.size() == n - 1) &&
+        (m_q0.size() == n - 1) &&
+        (m_quaternionShape.size() == n - 2) &&
+        (m_fx.size() == n) &&
+        (m_ta0.size() == n - 2);
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CORDE_ROD_H
+#define TG_CORDE_ROD_H
+
+/**
+ * @file tgCordeRod.h
+ * @brief Contains the definition of class tgCordeRod
+ * @author Brian Mirletz
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btQuaternion.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+
+/**
+ * A string modelled as a CoRdE (Cosserat rod element) rod, after
+ * Spillman and Teschner: a chain of mass points and, between each pair,
+ * a centerline quaternion carrying bending and torsion. Promoted from
+ * dev/btietz/Corde for cable and pulley studies that need many, finely
+ * resolved strings.
+ *
+ * The state is kept in contiguous arrays, one per coordinate, indexed
+ * by mass point or by centerline element. A step first computes every
+ * link's spring, damping and alignment terms and every centerline
+ * pair's bending and torsion terms into per-element arrays, in loops
+ * without dependencies between iterations, then gathers them onto the
+ * points and quaternions. Neither pass chases pointers, so the compiler
+ * can vectorize both.
+ *
+ * Either end can be anchored to a Bullet rigid body. The end point then
+ * follows the body, and the force the rod puts on it is applied to the
+ * body as an impulse by applyAnchorImpulses, which is kept apart from
+ * integrate so that tgCordeSolver can integrate rods on several threads.
+ */
+class tgCordeRod
+{
+public:
+
+    /** The rod's material. This is Plain Old Data. */
+    struct Config
+    {
+        /**
+         * @throw std::invalid_argument if the resolution is less than
+         * 2, the radius or density is not positive, or any other value
+         * is negative
+         */
+        Config(std::size_t res,
+               double r, double d,
+               double ym, double shm,
+               double stm, double csc,
+               double gt, double gr);
+
+        /** The number of mass points */
+        std::size_t resolution;
+        double radius;
+        double density;
+        double YoungMod;
+        double ShearMod;
+        double StretchMod;
+        /** Stiffness of the constraint aligning quaternions and links */
+        double ConsSpringConst;
+        /**
+         * Position and rotation damping. For really short segments
+         * (< .001 length) consider decreasing these further.
+         */
+        double gammaT;
+        double gammaR;
+    };
+
+    /** The ends of the rod, for anchoring */
+    enum End
+    {
+        eStart,
+        eEnd
+    };
+
+    /**
+     * A straight rod at rest, its mass points evenly spaced from pos1 to
+     * pos2 and its centerline rotated from quat1 to quat2. With neither
+     * bending nor torsion, quat1 = quat2 is the rotation taking z onto
+     * the rod's direction.
+     */
+    tgCordeRod(const btVector3& pos1, const btVector3& pos2,
+               const btQuaternion& quat1, const btQuaternion& quat2,
+               const Config& config);
+
+    /**
+     * Pin an end to a rigid body at the end's current position.
+     * @param[in] end which end
+     * @param[in] pBody the body, not owned; NULL releases the end
+     */
+    void attach(End end, btRigidBody* pBody);
+
+    /**
+     * Advance the rod without touching any rigid body: anchored ends
+     * are moved with their bodies, and the impulses of the anchor
+     * forces are added up for applyAnchorImpulses.
+     * @param[in] dt the timestep; must be positive
+     * @param[in] substeps the number of equal steps dt is split into,
+     * since the rod usually needs a much shorter step than the world
+     * @throw std::invalid_argument if dt is not positive or substeps is
+     * zero
+     */
+    void integrate(double dt, std::size_t substeps = 1);
+
+    /** Apply the impulses summed by integrate to the bodies, and clear them */
+    void applyAnchorImpulses();
+
+    /** integrate, then applyAnchorImpulses */
+    void step(double dt, std::size_t substeps = 1);
+
+    /** The number of mass points */
+    std::size_t getResolution() const
+    {
+        return m_px.size();
+    }
+
+    btVector3 getPosition(std::size_t i) const
+    {
+        return btVector3(m_px[i], m_py[i], m_pz[i]);
+    }
+
+    btVector3 getVelocity(std::size_t i) const
+    {
+        return btVector3(m_vx[i], m_vy[i], m_vz[i]);
+    }
+
+    /** The force on mass point i in the last step */
+    btVector3 getForce(std::size_t i) const
+    {
+        return btVector3(m_fx[i], m_fy[i], m_fz[i]);
+    }
+
+    /** The orientation of centerline element i, between points i and i + 1 */
+    btQuaternion getOrientation(std::size_t i) const
+    {
+        return btQuaternion(m_q0[i], m_q1[i], m_q2[i], m_q3[i]);
+    }
+
+    /** The length of the rod along its mass points */
+    double getLength() const;
+
+    const Config& getConfig() const
+    {
+        return m_config;
+    }
+
+private:
+
+    /** A rigid body an end follows */
+    struct Anchor
+    {
+        Anchor() : pBody(NULL), impulse(0.0, 0.0, 0.0) {}
+
+        btRigidBody* pBody;
+
+        /** Where the end is, in the body's frame */
+        btVector3 localPoint;
+
+        /** The impulse of the rod's force on the body since it was applied */
+        btVector3 impulse;
+    };
+
+    /** Move the anchored ends with their bodies */
+    void followAnchors();
+
+    /** Fill m_f* and m_tp* from the current state */
+    void computeInternalForces();
+
+    /** Semi-implicit Euler step of the points and quaternions */
+    void unconstrainedMotion(double dt);
+
+    /** Integrity predicate */
+    bool invariant() const;
+
+    Config m_config;
+
+    /** Mass points */
+    std::vector<double> m_px, m_py, m_pz;
+    std::vector<double> m_vx, m_vy, m_vz;
+    std::vector<double> m_fx, m_fy, m_fz;
+    std::vector<double> m_mass;
+
+    /** Rest length of each link between mass points */
+    std::vector<double> m_linkLength;
+
+    /** Centerline elements: orientation and its derivative */
+    std::vector<double> m_q0, m_q1, m_q2, m_q3;
+    std::vector<double> m_qd0, m_qd1, m_qd2, m_qd3;
+    /** Generalized torques in quaternion coordinates, then in body axes */
+    std::vector<double> m_tp0, m_tp1, m_tp2, m_tp3;
+    std::vector<double> m_wx, m_wy, m_wz;
+
+    /** Rest shape of each pair of centerline elements */
+    std::vector<double> m_quaternionShape;
+
+    /**
+     * Per link terms: the spring and damping force on the link's first
+     * point, and the alignment constraint force on its first and second
+     * points
+     */
+    std::vector<double> m_lfx, m_lfy, m_lfz;
+    std::vector<double> m_cax, m_cay, m_caz;
+    std::vector<double> m_cbx, m_cby, m_cbz;
+
+    /** Per centerline pair terms on the first and second element */
+    std::vector<double> m_ta0, m_ta1, m_ta2, m_ta3;
+    std::vector<double> m_tb0, m_tb1, m_tb2, m_tb3;
+
+    /** Stretch, then bending and torsion stiffness */
+    double m_stiffness[4];
+
+    /** Diagonal inertia of a centerline element, and its inverse */
+    double m_inertia[3];
+    double m_inverseInertia[3];
+
+    Anchor m_anchors[2];
+};
+
+#endif  // TG_CORDE_ROD_H
@@ -0,0 +1,191 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCordeSolver.cpp
+ * @brief Contains the definitions of members of class tgCordeSolver
+ * $Id$
+ */
+
+// This module
+#include "tgCordeSolver.h"
+// This application
+#include "tgCordeRod.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <stdexcept>
+
+tgCordeSolver::tgCordeSolver(std::size_t threads) :
+m_batch(0),
+m_finishedWorkers(0),
+m_dt(0.0),
+m_substeps(0),
+m_shutdown(false)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_workReady, NULL);
+    pthread_cond_init(&m_workDone, NULL);
+
+    if (threads > 1)
+    {
+        for (std::size_t i = 0; i < threads; i++)
+        {
+            m_workers.push_back(new Worker(*this, i));
+        }
+        for (std::size_t i = 0; i < m_workers.size(); i++)
+        {
+            if (pthread_create(&m_workers[i]->thread, NULL, workerMain,
+                               m_workers[i]) != 0)
+            {
+                throw std::runtime_error("Could not start a rod thread");
+            }
+        }
+    }
+}
+
+tgCordeSolver::~tgCordeSolver()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_shutdown = true;
+    pthread_cond_broadcast(&m_workReady);
+    pthread_mutex_unlock(&m_mutex);
+
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        pthread_join(m_workers[i]->thread, NULL);
+        delete m_workers[i];
+    }
+
+    pthread_cond_destroy(&m_workDone);
+    pthread_cond_destroy(&m_workReady);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void tgCordeSolver::addRod(tgCordeRod* pRod)
+{
+    if (pRod == NULL)
+    {
+        throw std::invalid_argument("Rod is NULL");
+    }
+    m_rods.push_back(pRod);
+}
+
+void tgCordeSolver::removeRod(tgCordeRod* pRod)
+{
+    m_rods.erase(std::remove(m_rods.begin(), m_rods.end(), pRod),
+                 m_rods.end());
+}
+
+void tgCordeSolver::step(double dt, std::size_t substeps)
+{
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+    if (substeps == 0)
+    {
+        throw std::invalid_argument("substeps is not positive");
+    }
+
+    m_dt = dt;
+    m_substeps = substeps;
+    if (m_workers.empty() || m_rods.size() < 2)
+    {
+        integrate(0, 1);
+    }
+    else
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_finishedWorkers = 0;
+        m_error.clear();
+        ++m_batch;
+        pthread_cond_broadcast(&m_workReady);
+
+        while (m_finishedWorkers < m_workers.size())
+        {
+            pthread_cond_wait(&m_workDone, &m_mutex);
+        }
+        const std::string error = m_error;
+        pthread_mutex_unlock(&m_mutex);
+
+        if (!error.empty())
+        {
+            throw std::runtime_error(error);
+        }
+    }
+
+    // Bodies may be shared between rods, so only one thread touches them
+    for (std::size_t i = 0; i < m_rods.size(); i++)
+    {
+        m_rods[i]->applyAnchorImpulses();
+    }
+}
+
+void tgCordeSolver::integrate(std::size_t index, std::size_t stride)
+{
+    for (std::size_t i = index; i < m_rods.size(); i += stride)
+    {
+        m_rods[i]->integrate(m_dt, m_substeps);
+    }
+}
+
+void* tgCordeSolver::workerMain(void* arg)
+{
+    Worker* const pWorker = static_cast<Worker*>(arg);
+    pWorker->owner.work(*pWorker);
+    return NULL;
+}
+
+void tgCordeSolver::work(Worker& worker)
+{
+    pthread_mutex_lock(&m_mutex);
+    while (true)
+    {
+        while (!m_shutdown && worker.batch == m_batch)
+        {
+            pthread_cond_wait(&m_workReady, &m_mutex);
+        }
+        if (m_shutdown)
+        {
+            break;
+        }
+        worker.batch = m_batch;
+        pthread_mutex_unlock(&m_mutex);
+
+        std::string error;
+        try
+        {
+            integrate(worker.index, m_workers.size());
+        }
+        catch (std::exception& e)
+        {
+            error = e.what();
+        }
+
+        pthread_mutex_lock(&m_mutex);
+        if (!error.empty() && m_error.empty())
+        {
+            m_error = error;
+        }
+        if (++m_finishedWorkers == m_workers.size())
+        {
+            pthread_cond_signal(&m_workDone);
+        }
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CORDE_SOLVER_H
+#define TG_CORDE_SOLVER_H
+
+/**
+ * @file tgCordeSolver.h
+ * @brief Contains the definition of class tgCordeSolver
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <string>
+#include <vector>
+// POSIX threads
+#include <pthread.h>
+
+// Forward declarations
+class tgCordeRod;
+
+/**
+ * Steps many tgCordeRods together on a pool of worker threads. Rods
+ * only read their anchor bodies while integrating, so each worker
+ * integrates its share of the rods on its own, and the anchor impulses
+ * are applied to the bodies afterwards on the calling thread. Call
+ * step once per world step, before the world steps.
+ */
+class tgCordeSolver
+{
+public:
+
+    /**
+     * @param[in] threads the worker threads; 0 or 1 integrates the rods
+     * on the calling thread
+     * @throw std::runtime_error if a thread could not be started
+     */
+    tgCordeSolver(std::size_t threads = 0);
+
+    /** Stop the workers. The rods are not deleted. */
+    ~tgCordeSolver();
+
+    /**
+     * @param[in] pRod must not be NULL and must outlive its time in the
+     * solver. We do not take ownership.
+     * @throw std::invalid_argument if pRod is NULL
+     */
+    void addRod(tgCordeRod* pRod);
+
+    /** Stop stepping a rod; does nothing if it was not added */
+    void removeRod(tgCordeRod* pRod);
+
+    const std::vector<tgCordeRod*>& getRods() const
+    {
+        return m_rods;
+    }
+
+    /**
+     * Integrate every rod, then apply their anchor impulses. Blocks
+     * until every rod has been integrated.
+     * @param[in] dt the world's timestep; must be positive
+     * @param[in] substeps rod steps per world step; must be positive
+     * @throw std::invalid_argument if dt or substeps is not positive
+     * @throw std::runtime_error if a rod threw; the others still run
+     */
+    void step(double dt, std::size_t substeps = 1);
+
+private:
+
+    /** One worker thread */
+    struct Worker
+    {
+        Worker(tgCordeSolver& o, std::size_t i) :
+        owner(o),
+        index(i),
+        batch(0)
+        {
+        }
+
+        tgCordeSolver& owner;
+        const std::size_t index;
+        pthread_t thread;
+
+        /** The last batch this worker has run */
+        unsigned long batch;
+    };
+
+    /** Integrate rods index, index + stride, ... */
+    void integrate(std::size_t index, std::size_t stride);
+
+    /** The worker loop */
+    void work(Worker& worker);
+
+    /** pthread entry point; arg is a Worker */
+    static void* workerMain(void* arg);
+
+    /** Not copyable */
+    tgCordeSolver(const tgCordeSolver&);
+    tgCordeSolver& operator=(const tgCordeSolver&);
+
+private:
+
+    /** Not owned */
+    std::vector<tgCordeRod*> m_rods;
+
+    /** We own these */
+    std::vector<Worker*> m_workers;
+
+    /** Guards everything below */
+    pthread_mutex_t m_mutex;
+
+    /** Signalled when a batch starts or the workers should exit */
+    pthread_cond_t m_workReady;
+
+    /** Signalled when the last worker of a batch finishes */
+    pthread_cond_t m_workDone;
+
+    unsigned long m_batch;
+    std::size_t m_finishedWorkers;
+    double m_dt;
+    std::size_t m_substeps;
+
+    /** The first error thrown in the current batch */
+    std::string m_error;
+
+    bool m_shutdown;
+};
+
+#endif  // TG_CORDE_SOLVER_H
@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCordeString.cpp
+ * @brief Contains the definitions of members of class tgCordeString
+ * $Id$
+ */
+
+// This module
+#include "tgCordeString.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+tgCordeString::Config::Config(const tgCordeRod::Config& rc, std::size_t ss) :
+rodConfig(rc),
+substeps(ss)
+{
+    if (ss == 0)
+    {
+        throw std::invalid_argument("substeps is zero");
+    }
+}
+
+tgCordeString::tgCordeString(tgCordeRod* pRod,
+                             const tgTags& tags,
+                             const Config& config) :
+tgModel(tags),
+m_pRod(pRod),
+m_config(config)
+{
+    if (pRod == NULL)
+    {
+        throw std::invalid_argument("Rod is NULL");
+    }
+}
+
+tgCordeString::~tgCordeString()
+{
+    delete m_pRod;
+}
+
+void tgCordeString::setup(tgWorld& world)
+{
+    notifySetup();
+    tgModel::setup(world);
+}
+
+void tgCordeString::teardown()
+{
+    tgModel::teardown();
+}
+
+void tgCordeString::step(double dt)
+{
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive.");
+    }
+    else
+    {
+#ifndef BT_NO_PROFILE
+        BT_PROFILE("tgCordeString::step");
+#endif //BT_NO_PROFILE
+        notifyStep(dt);
+        m_pRod->step(dt, m_config.substeps);
+        tgModel::step(dt);
+    }
+}
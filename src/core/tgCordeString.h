@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CORDE_STRING_H
+#define TG_CORDE_STRING_H
+
+/**
+ * @file tgCordeString.h
+ * @brief Contains the definition of class tgCordeString
+ * $Id$
+ */
+
+// This application
+#include "tgCordeRod.h"
+#include "tgModel.h"
+#include "tgSubject.h"
+
+// Forward declarations
+class tgWorld;
+
+/**
+ * A massive string between two rigid bodies, for the strings that
+ * dev/btietz's tgRBString built from a chain of tgRods joined by
+ * springs. The string is one tgCordeRod with its ends anchored to the
+ * bodies, so it adds no bodies or springs to the Bullet world: its
+ * bending and torsion come from the rod's own springs between
+ * centerline elements, and it is integrated with its own substeps,
+ * leaving the world free to take its usual timestep. Built by
+ * tgCordeStringInfo.
+ */
+class tgCordeString : public tgModel, public tgSubject<tgCordeString>
+{
+public:
+
+    /** This is Plain Old Data. */
+    struct Config
+    {
+        /**
+         * @throw std::invalid_argument if substeps is zero
+         */
+        Config(const tgCordeRod::Config& rc, std::size_t ss = 10);
+
+        /** The rod's material and resolution */
+        tgCordeRod::Config rodConfig;
+
+        /** Rod steps per world step */
+        std::size_t substeps;
+    };
+
+    /**
+     * @param[in] pRod the rod, already anchored; we take ownership
+     * @param[in] tags as passed through tgStructure and tgStructureInfo
+     * @param[in] config the substeps to take
+     * @throw std::invalid_argument if pRod is NULL
+     */
+    tgCordeString(tgCordeRod* pRod, const tgTags& tags, const Config& config);
+
+    /** Deletes the rod */
+    virtual ~tgCordeString();
+
+    /** Notifies observers of setup, calls setup on children */
+    virtual void setup(tgWorld& world);
+
+    /** Teardown any children */
+    virtual void teardown();
+
+    /**
+     * Notify observers, then step the rod and apply its forces to the
+     * bodies it is anchored to, before the world steps.
+     * @param[in] dt must be positive
+     * @throw std::invalid_argument if dt is not positive
+     */
+    virtual void step(double dt);
+
+    /** The length along the rod's mass points */
+    double getCurrentLength() const
+    {
+        return m_pRod->getLength();
+    }
+
+    const tgCordeRod& getRod() const
+    {
+        return *m_pRod;
+    }
+
+    const Config& getConfig() const
+    {
+        return m_config;
+    }
+
+private:
+
+    /** Not copyable */
+    tgCordeString(const tgCordeString&);
+    tgCordeString& operator=(const tgCordeString&);
+
+    /** We own this */
+    tgCordeRod* const m_pRod;
+
+    const Config m_config;
+};
+
+#endif  // TG_CORDE_STRING_H
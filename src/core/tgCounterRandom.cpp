@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCounterRandom.cpp
+ * @brief Contains the definitions of members of class tgCounterRandom
+ * $Id$
+ */
+
+// This module
+#include "tgCounterRandom.h"
+// The C++ Standard Library
+#include <cmath>
+
+namespace
+{
+    /** splitmix64's finalizer */
+    inline unsigned long long mix(unsigned long long x)
+    {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    /** 53 random bits as a double in [0, 1) */
+    inline double toUnit(unsigned long long bits)
+    {
+        return (bits >> 11) * (1.0 / 9007199254740992.0);
+    }
+}
+
+tgCounterRandom tgCounterRandom::fromStream(tgRandom::Engine& engine)
+{
+    // The engine gives 48 bits per draw
+    const double draw = engine();
+    return tgCounterRandom(mix(static_cast<unsigned long long>(
+                                   draw * 281474976710656.0)));
+}
+
+unsigned long long tgCounterRandom::bits(unsigned long long i) const
+{
+    return mix(m_key ^ mix(i));
+}
+
+double tgCounterRandom::uniform(unsigned long long i) const
+{
+    return toUnit(bits(i));
+}
+
+void tgCounterRandom::fillUniform(double* out, std::size_t n,
+                                  unsigned long long first) const
+{
+    for (std::size_t j = 0; j < n; j++)
+    {
+        out[j] = toUnit(mix(m_key ^ mix(first + j)));
+    }
+}
+
+void tgCounterRandom::fillNormal(double* out, std::size_t n, double stdDev,
+                                 unsigned long long first) const
+{
+    const double twoPi = 6.283185307179586;
+    for (std::size_t j = 0; j < n; j += 2)
+    {
+        // 1 - u is in (0, 1], so the log is finite
+        const double u1 = 1.0 - uniform(first + j);
+        const double u2 = uniform(first + j + 1);
+        const double r = stdDev * std::sqrt(-2.0 * std::log(u1));
+        out[j] = r * std::cos(twoPi * u2);
+        if (j + 1 < n)
+        {
+            out[j + 1] = r * std::sin(twoPi * u2);
+        }
+    }
+}
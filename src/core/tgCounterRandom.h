@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_COUNTER_RANDOM_H
+#define TG_COUNTER_RANDOM_H
+
+/**
+ * @file tgCounterRandom.h
+ * @brief Contains the definition of class tgCounterRandom
+ * $Id$
+ */
+
+// This application
+#include "tgRandom.h"
+// The C++ Standard Library
+#include <cstddef>
+
+/**
+ * A counter-based random stream: draw i is a hash of a key and i, so
+ * draws need no state between them and a whole array is filled by one
+ * loop the compiler can unroll. For bulk draws, such as mutating every
+ * parameter of a member, where a tgRandom would be called once per
+ * value.
+ *
+ * The key is usually taken from a tgRandom with fromStream, so the
+ * draws follow that stream's seed and are restored with its checkpoint
+ * state.
+ */
+class tgCounterRandom
+{
+public:
+
+    explicit tgCounterRandom(unsigned long long key) :
+    m_key(key)
+    {
+    }
+
+    /**
+     * A generator keyed by one draw from a stream
+     * @param[in,out] engine advanced by one draw
+     */
+    static tgCounterRandom fromStream(tgRandom::Engine& engine);
+
+    /** 64 random bits for counter i */
+    unsigned long long bits(unsigned long long i) const;
+
+    /** A uniform sample from [0, 1) for counter i */
+    double uniform(unsigned long long i) const;
+
+    /**
+     * out[j] = uniform(first + j) for j from 0 to n - 1
+     */
+    void fillUniform(double* out, std::size_t n,
+                     unsigned long long first = 0) const;
+
+    /**
+     * n samples from a normal distribution with mean 0, by Box-Muller
+     * over pairs of counters starting at first.
+     */
+    void fillNormal(double* out, std::size_t n, double stdDev,
+                    unsigned long long first = 0) const;
+
+private:
+
+    unsigned long long m_key;
+};
+
+#endif  // TG_COUNTER_RANDOM_H
@@ -0,0 +1,188 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_DECIMATED_OBSERVER_H
+#define TG_DECIMATED_OBSERVER_H
+
+/**
+ * @file tgDecimatedObserver.h
+ * @brief Definition of class tgDecimatedObserver
+ * $Id$
+ */
+
+// This application
+#include "tgObserver.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+/**
+ * Runs another observer, typically a controller, at a lower rate than the
+ * subject is stepped. The wrapped observer's onStep is called on the first
+ * step after setup and then every stepsPerCall steps, with dt the time
+ * accumulated since its previous call. Whatever it commanded is held in
+ * between: a tgKinematicActuator keeps driving its motor towards the last
+ * target, and a tgBasicActuator moved with setControlInput(input, dt)
+ * takes the whole accumulated dt as one move.
+ *
+ * Attach the wrapper to the subject instead of the controller:
+ * @code
+ * MyController controller;
+ * tgDecimatedObserver<MyModel> at100Hz(controller, 10); // 1 kHz world
+ * model->attach(&at100Hz);
+ * @endcode
+ * The wrapper does not own the wrapped observer, which must outlive it.
+ *
+ * When the step size varies, as under a tgAdaptiveStepper, construct it
+ * with a period in seconds instead: the wrapped observer is called on the
+ * first step and then on the first step that brings the accumulated time
+ * up to the period.
+ */
+template <class Subject>
+class tgDecimatedObserver : public tgObserver<Subject>
+{
+public:
+
+    /**
+     * @param[in] observer the observer to call
+     * @param[in] stepsPerCall how many subject steps make one call; 1
+     * calls on every step
+     * @throw std::invalid_argument if stepsPerCall is less than 1
+     */
+    tgDecimatedObserver(tgObserver<Subject>& observer, int stepsPerCall) :
+    m_observer(observer),
+    m_stepsPerCall(stepsPerCall),
+    m_period(0.0),
+    m_stepsSinceCall(0),
+    m_elapsed(0.0)
+    {
+        if (stepsPerCall < 1)
+        {
+            throw std::invalid_argument("stepsPerCall is less than 1");
+        }
+    }
+
+    /**
+     * @param[in] observer the observer to call
+     * @param[in] period simulated seconds between calls
+     * @throw std::invalid_argument if period is not positive
+     */
+    tgDecimatedObserver(tgObserver<Subject>& observer, double period) :
+    m_observer(observer),
+    m_stepsPerCall(0),
+    m_period(period),
+    m_stepsSinceCall(0),
+    m_elapsed(0.0)
+    {
+        if (!(period > 0.0))
+        {
+            throw std::invalid_argument("period is not positive");
+        }
+    }
+
+    /** The wrapped observer is not deleted. */
+    virtual ~tgDecimatedObserver() { }
+
+    virtual void onAttach(Subject& subject)
+    {
+        m_observer.onAttach(subject);
+    }
+
+    virtual void onSetup(Subject& subject)
+    {
+        restart();
+        m_observer.onSetup(subject);
+    }
+
+    virtual void onTeardown(Subject& subject)
+    {
+        m_observer.onTeardown(subject);
+        restart();
+    }
+
+    /**
+     * Accumulate dt, and call the wrapped observer if it is due.
+     * @param[in,out] subject the subject being observed
+     * @param[in] dt the number of seconds since the previous step
+     */
+    virtual void onStep(Subject& subject, double dt)
+    {
+        m_elapsed += dt;
+        if (m_stepsPerCall == 0)
+        {
+            // Rounding in the sum of the steps must not put a call off
+            if (m_stepsSinceCall == 0 ||
+                m_elapsed >= m_period * (1.0 - 1e-9))
+            {
+                const double elapsed = m_elapsed;
+                m_elapsed = 0.0;
+                m_stepsSinceCall = 1;
+                m_observer.onStep(subject, elapsed);
+            }
+            return;
+        }
+        if (m_stepsSinceCall == 0)
+        {
+            const double elapsed = m_elapsed;
+            m_elapsed = 0.0;
+            m_observer.onStep(subject, elapsed);
+        }
+        if (++m_stepsSinceCall == m_stepsPerCall)
+        {
+            m_stepsSinceCall = 0;
+        }
+    }
+
+    /** How many subject steps make one call; 0 if calls are by period */
+    int getStepsPerCall() const
+    {
+        return m_stepsPerCall;
+    }
+
+    /** Seconds between calls; 0 if calls are by step count */
+    double getPeriod() const
+    {
+        return m_period;
+    }
+
+private:
+
+    /** Call on the next step with only that step's dt */
+    void restart()
+    {
+        m_stepsSinceCall = 0;
+        m_elapsed = 0.0;
+    }
+
+    tgObserver<Subject>& m_observer;
+
+    const int m_stepsPerCall;
+
+    /** Seconds between calls, if m_stepsPerCall is 0 */
+    const double m_period;
+
+    /**
+     * Steps taken since the last call, in [0, m_stepsPerCall); by period,
+     * 0 until the first call and then 1
+     */
+    int m_stepsSinceCall;
+
+    /** Seconds since the last call, including the current step */
+    double m_elapsed;
+};
+
+#endif  // TG_DECIMATED_OBSERVER_H
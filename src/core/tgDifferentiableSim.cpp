@@ -0,0 +1,421 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgDifferentiableSim.cpp
+ * @brief Contains the definitions of members of class tgDifferentiableSim
+ * $Id$
+ */
+
+// This module
+#include "tgDifferentiableSim.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    double sigmoid(double z)
+    {
+        return 1.0 / (1.0 + std::exp(-z));
+    }
+
+    /** log(1 + e^z), without overflowing for large z */
+    double softplus(double z)
+    {
+        return (z > 0.0) ? z + std::log(1.0 + std::exp(-z)) :
+            std::log(1.0 + std::exp(z));
+    }
+
+    double dot(const double* a, const double* b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+}
+
+tgDifferentiableSim::Config::Config(double ss, double g, bool gr, double gs,
+                                    double gd, double gf, double sm) :
+stepSize(ss),
+gravity(g),
+ground(gr),
+groundStiffness(gs),
+groundDamping(gd),
+groundFriction(gf),
+smoothing(sm)
+{
+    if (ss <= 0.0)
+    {
+        throw std::invalid_argument("stepSize is not positive");
+    }
+    else if (sm <= 0.0)
+    {
+        throw std::invalid_argument("smoothing is not positive");
+    }
+}
+
+tgDifferentiableSim::tgDifferentiableSim(const Config& config) :
+m_config(config),
+m_steps(0)
+{
+}
+
+std::size_t tgDifferentiableSim::addNode(double x, double y, double z,
+                                         double mass)
+{
+    m_start.push_back(x);
+    m_start.push_back(y);
+    m_start.push_back(z);
+    m_mass.push_back(mass);
+    return m_mass.size() - 1;
+}
+
+void tgDifferentiableSim::checkNode(std::size_t node) const
+{
+    if (node >= m_mass.size())
+    {
+        throw std::out_of_range("No such node");
+    }
+}
+
+void tgDifferentiableSim::addRod(std::size_t from, std::size_t to,
+                                 double stiffness, double damping)
+{
+    checkNode(from);
+    checkNode(to);
+    if (stiffness <= 0.0)
+    {
+        throw std::invalid_argument("Rod stiffness is not positive");
+    }
+    const double* const a = &m_start[3 * from];
+    const double* const b = &m_start[3 * to];
+    const double d[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    Element rod;
+    rod.from = from;
+    rod.to = to;
+    rod.stiffness = stiffness;
+    rod.damping = damping;
+    rod.restLength = std::sqrt(dot(d, d));
+    m_rods.push_back(rod);
+}
+
+std::size_t tgDifferentiableSim::addCable(std::size_t from, std::size_t to,
+                                          double stiffness, double damping)
+{
+    checkNode(from);
+    checkNode(to);
+    if (stiffness <= 0.0)
+    {
+        throw std::invalid_argument("Cable stiffness is not positive");
+    }
+    Element cable;
+    cable.from = from;
+    cable.to = to;
+    cable.stiffness = stiffness;
+    cable.damping = damping;
+    cable.restLength = 0.0;
+    m_cables.push_back(cable);
+    return m_cables.size() - 1;
+}
+
+tgDifferentiableSim::Tension
+tgDifferentiableSim::cableTension(const Element& cable, double length,
+                                  double restLength, double velocity) const
+{
+    // As tgLinearTensionLaw::tension, with the damping's bound and the
+    // slack cutoff smoothed over m_config.smoothing
+    const double k = cable.stiffness;
+    const double c = cable.damping;
+    const double stretch = length - restLength;
+    const double spring = k * stretch;
+    const double bound = std::sqrt(spring * spring +
+        k * k * m_config.smoothing * m_config.smoothing);
+    const double y = c * velocity / bound;
+    const double th = std::tanh(y);
+    const double sech2 = 1.0 - th * th;
+    const double damping = bound * th;
+    const double gate = sigmoid(stretch / m_config.smoothing);
+
+    Tension result;
+    result.tension = gate * (spring + damping);
+    const double dDampingdSpring = (spring / bound) * (th - y * sech2);
+    result.dLength = gate * (1.0 - gate) / m_config.smoothing * (spring + damping) +
+        gate * k * (1.0 + dDampingdSpring);
+    result.dVelocity = gate * c * sech2;
+    return result;
+}
+
+void tgDifferentiableSim::computeForces(std::size_t step,
+                                        const double* restLengths,
+                                        double* forces) const
+{
+    const std::size_t n = nodeCount();
+    const double* const x = &m_positions[step * 3 * n];
+    const double* const v = &m_velocities[step * 3 * n];
+    std::fill(forces, forces + 3 * n, 0.0);
+
+    for (std::size_t e = 0; e < m_rods.size() + m_cables.size(); e++)
+    {
+        const bool isRod = e < m_rods.size();
+        const Element& element = isRod ? m_rods[e] : m_cables[e - m_rods.size()];
+        const std::size_t i = element.from;
+        const std::size_t j = element.to;
+        const double d[3] = { x[3*j] - x[3*i], x[3*j+1] - x[3*i+1], x[3*j+2] - x[3*i+2] };
+        const double length = std::sqrt(dot(d, d));
+        if (length == 0.0)
+        {
+            continue;
+        }
+        const double u[3] = { d[0] / length, d[1] / length, d[2] / length };
+        const double dv[3] = { v[3*j] - v[3*i], v[3*j+1] - v[3*i+1], v[3*j+2] - v[3*i+2] };
+        const double s = dot(dv, u);
+        double tension;
+        if (isRod)
+        {
+            tension = element.stiffness * (length - element.restLength) +
+                element.damping * s;
+        }
+        else
+        {
+            tension = cableTension(element, length,
+                                   restLengths[e - m_rods.size()], s).tension;
+        }
+        for (int k = 0; k < 3; k++)
+        {
+            forces[3*i + k] += tension * u[k];
+            forces[3*j + k] -= tension * u[k];
+        }
+    }
+
+    if (m_config.ground)
+    {
+        const double beta = 1.0 / m_config.smoothing;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double contact = sigmoid(-beta * x[3*i + 1]);
+            forces[3*i + 1] += m_config.groundStiffness * softplus(-beta * x[3*i + 1]) / beta -
+                m_config.groundDamping * contact * v[3*i + 1];
+            forces[3*i] -= m_config.groundFriction * contact * v[3*i];
+            forces[3*i + 2] -= m_config.groundFriction * contact * v[3*i + 2];
+        }
+    }
+}
+
+void tgDifferentiableSim::addForceAdjoint(std::size_t step,
+                                          const double* restLengths,
+                                          const double* adjoint,
+                                          double* dPositions,
+                                          double* dVelocities,
+                                          double* dRestLengths) const
+{
+    const std::size_t n = nodeCount();
+    const double* const x = &m_positions[step * 3 * n];
+    const double* const v = &m_velocities[step * 3 * n];
+
+    for (std::size_t e = 0; e < m_rods.size() + m_cables.size(); e++)
+    {
+        const bool isRod = e < m_rods.size();
+        const Element& element = isRod ? m_rods[e] : m_cables[e - m_rods.size()];
+        const std::size_t i = element.from;
+        const std::size_t j = element.to;
+        const double d[3] = { x[3*j] - x[3*i], x[3*j+1] - x[3*i+1], x[3*j+2] - x[3*i+2] };
+        const double length = std::sqrt(dot(d, d));
+        if (length == 0.0)
+        {
+            continue;
+        }
+        const double u[3] = { d[0] / length, d[1] / length, d[2] / length };
+        const double dv[3] = { v[3*j] - v[3*i], v[3*j+1] - v[3*i+1], v[3*j+2] - v[3*i+2] };
+        const double s = dot(dv, u);
+        Tension t;
+        if (isRod)
+        {
+            t.tension = element.stiffness * (length - element.restLength) +
+                element.damping * s;
+            t.dLength = element.stiffness;
+            t.dVelocity = element.damping;
+        }
+        else
+        {
+            t = cableTension(element, length, restLengths[e - m_rods.size()], s);
+            // The tension depends on length - restLength
+            dRestLengths[e - m_rods.size()] -= dot(u, &adjoint[3*i]) * t.dLength -
+                dot(u, &adjoint[3*j]) * t.dLength;
+        }
+
+        // The forces' contribution is tension * u . (adjoint_i - adjoint_j)
+        const double w[3] = { adjoint[3*i] - adjoint[3*j],
+                              adjoint[3*i+1] - adjoint[3*j+1],
+                              adjoint[3*i+2] - adjoint[3*j+2] };
+        const double q = dot(u, w);
+        for (int k = 0; k < 3; k++)
+        {
+            // d/dd of length, of u . dv and of u . w
+            const double gd = u[k] * q * t.dLength +
+                (dv[k] - u[k] * s) * q * t.dVelocity / length +
+                (w[k] - u[k] * q) * t.tension / length;
+            const double gdv = u[k] * q * t.dVelocity;
+            dPositions[3*j + k] += gd;
+            dPositions[3*i + k] -= gd;
+            dVelocities[3*j + k] += gdv;
+            dVelocities[3*i + k] -= gdv;
+        }
+    }
+
+    if (m_config.ground)
+    {
+        const double beta = 1.0 / m_config.smoothing;
+        const double kg = m_config.groundStiffness;
+        const double cg = m_config.groundDamping;
+        const double mu = m_config.groundFriction;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double* const a = &adjoint[3*i];
+            const double contact = sigmoid(-beta * x[3*i + 1]);
+            const double dContact = -beta * contact * (1.0 - contact);
+            dPositions[3*i + 1] += a[1] * (-kg * contact - cg * dContact * v[3*i + 1]) -
+                mu * dContact * (a[0] * v[3*i] + a[2] * v[3*i + 2]);
+            dVelocities[3*i] -= a[0] * mu * contact;
+            dVelocities[3*i + 1] -= a[1] * cg * contact;
+            dVelocities[3*i + 2] -= a[2] * mu * contact;
+        }
+    }
+}
+
+double tgDifferentiableSim::rollout(std::size_t steps,
+                                    const Controller& controller,
+                                    const std::vector<double>& params,
+                                    const Loss& loss)
+{
+    if (steps == 0)
+    {
+        throw std::invalid_argument("steps is zero");
+    }
+    const std::size_t n = nodeCount();
+    const std::size_t cables = cableCount();
+    const double h = m_config.stepSize;
+    m_steps = steps;
+    m_positions.resize((steps + 1) * 3 * n);
+    m_velocities.resize((steps + 1) * 3 * n);
+    m_restLengths.resize(std::max<std::size_t>(steps * cables, 1));
+    std::copy(m_start.begin(), m_start.end(), m_positions.begin());
+    std::fill(m_velocities.begin(), m_velocities.begin() + 3 * n, 0.0);
+
+    std::vector<double> forces(3 * n);
+    std::vector<double> dPositions(3 * n);
+    std::vector<double> dVelocities(3 * n);
+    double total = 0.0;
+    for (std::size_t t = 0; t < steps; t++)
+    {
+        double* const restLengths = &m_restLengths[t * cables];
+        controller.restLengths(t, t * h, params, restLengths);
+        computeForces(t, restLengths, n ? &forces[0] : NULL);
+
+        // Semi-implicit Euler: the new velocity moves the node
+        const double* const x0 = &m_positions[t * 3 * n];
+        const double* const v0 = &m_velocities[t * 3 * n];
+        double* const x1 = &m_positions[(t + 1) * 3 * n];
+        double* const v1 = &m_velocities[(t + 1) * 3 * n];
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double invMass = (m_mass[i] > 0.0) ? 1.0 / m_mass[i] : 0.0;
+            for (int k = 0; k < 3; k++)
+            {
+                v1[3*i + k] = v0[3*i + k] + h * invMass * forces[3*i + k];
+            }
+            if (invMass > 0.0)
+            {
+                v1[3*i + 1] -= h * m_config.gravity;
+            }
+            for (int k = 0; k < 3; k++)
+            {
+                x1[3*i + k] = x0[3*i + k] + h * v1[3*i + k];
+            }
+        }
+
+        std::fill(dPositions.begin(), dPositions.end(), 0.0);
+        std::fill(dVelocities.begin(), dVelocities.end(), 0.0);
+        total += loss.stateLoss(t + 1, x1, v1, n ? &dPositions[0] : NULL,
+                                n ? &dVelocities[0] : NULL);
+    }
+    return total;
+}
+
+double tgDifferentiableSim::gradient(std::size_t steps,
+                                     const Controller& controller,
+                                     const std::vector<double>& params,
+                                     const Loss& loss,
+                                     std::vector<double>& gradient,
+                                     std::vector<double>* restLengthGradient)
+{
+    const double total = rollout(steps, controller, params, loss);
+
+    const std::size_t n = nodeCount();
+    const std::size_t cables = cableCount();
+    const double h = m_config.stepSize;
+    gradient.assign(params.size(), 0.0);
+    if (restLengthGradient != NULL)
+    {
+        restLengthGradient->assign(steps * cables, 0.0);
+    }
+
+    // The adjoints of the positions and velocities after step t
+    std::vector<double> gx(3 * n, 0.0);
+    std::vector<double> gv(3 * n, 0.0);
+    std::vector<double> lx(3 * n);
+    std::vector<double> lv(3 * n);
+    std::vector<double> adjoint(3 * n);
+    std::vector<double> gr(std::max<std::size_t>(cables, 1));
+    for (std::size_t t = steps; t-- > 0; )
+    {
+        // This state's own term of the loss
+        std::fill(lx.begin(), lx.end(), 0.0);
+        std::fill(lv.begin(), lv.end(), 0.0);
+        loss.stateLoss(t + 1, getPositions(t + 1), getVelocities(t + 1),
+                       n ? &lx[0] : NULL, n ? &lv[0] : NULL);
+        for (std::size_t k = 0; k < 3 * n; k++)
+        {
+            gx[k] += lx[k];
+            gv[k] += lv[k];
+            // x1 = x0 + h v1, so v1 also moves x1
+            gv[k] += h * gx[k];
+        }
+
+        // v1 = v0 + h F / m: the adjoint of the forces
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double invMass = (m_mass[i] > 0.0) ? 1.0 / m_mass[i] : 0.0;
+            for (int k = 0; k < 3; k++)
+            {
+                adjoint[3*i + k] = h * invMass * gv[3*i + k];
+            }
+        }
+        std::fill(gr.begin(), gr.end(), 0.0);
+        const double* const restLengths = &m_restLengths[t * cables];
+        addForceAdjoint(t, restLengths, n ? &adjoint[0] : NULL,
+                        n ? &gx[0] : NULL, n ? &gv[0] : NULL, &gr[0]);
+
+        controller.addGradient(t, t * h, params, &gr[0], gradient);
+        if (restLengthGradient != NULL)
+        {
+            std::copy(gr.begin(), gr.begin() + cables,
+                      restLengthGradient->begin() + t * cables);
+        }
+    }
+    return total;
+}
@@ -0,0 +1,272 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_DIFFERENTIABLE_SIM_H
+#define TG_DIFFERENTIABLE_SIM_H
+
+/**
+ * @file tgDifferentiableSim.h
+ * @brief Contains the definition of class tgDifferentiableSim
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+/**
+ * A smooth stand-in for a cable-driven tensegrity's dynamics, with
+ * exact gradients of a trajectory's loss by the adjoint method, so
+ * controllers can be tuned by gradient descent rather than by the
+ * thousands of rollouts an AnnealEvolution trial takes.
+ *
+ * Each rod is two point masses at its ends joined by a stiff axial
+ * spring, rather than a Bullet rigid body. Each cable follows
+ * tgLinearTensionLaw with its kinks smoothed over smoothing length
+ * units: the tension fades in with a sigmoid of the stretch, and the
+ * damping is bounded by the spring force with a tanh rather than a
+ * clamp. The ground, if any, is a soft plane at y = 0 that pushes with
+ * a softplus of the penetration and has viscous friction. Nodes are
+ * stepped with semi-implicit Euler, as Bullet steps bodies.
+ *
+ * The gradients are those of this model, not of the Bullet world:
+ * parameters found here are a starting point to refine with the full
+ * simulation. The rods' stiffness sets the stable step size, about
+ * 0.2 * sqrt(mass / stiffness).
+ */
+class tgDifferentiableSim
+{
+public:
+
+    /**
+     * This is Plain Old Data.
+     */
+    struct Config
+    {
+        /**
+         * @param[in] ss the timestep, in seconds. Must be positive.
+         * @param[in] g gravitational acceleration, along -y
+         * @param[in] gr true for a ground plane at y = 0
+         * @param[in] gs the ground's stiffness per unit of penetration
+         * @param[in] gd the ground's damping of normal velocity
+         * @param[in] gf the ground's viscous friction coefficient
+         * @param[in] sm the length over which the cables' and the
+         * ground's kinks are smoothed. Must be positive.
+         */
+        Config(double ss = 1.0/1000.0, double g = 9.81, bool gr = true,
+               double gs = 1.0e5, double gd = 1.0e2, double gf = 1.0e2,
+               double sm = 1.0e-3);
+
+        double stepSize;
+
+        double gravity;
+
+        bool ground;
+
+        double groundStiffness;
+
+        double groundDamping;
+
+        double groundFriction;
+
+        double smoothing;
+    };
+
+    /**
+     * Sets the cables' rest lengths at each step of a rollout.
+     * Only the dependence on the parameters is differentiated, so the
+     * rest lengths should not depend on the state, as for an open loop
+     * controller such as a CPG.
+     */
+    class Controller
+    {
+    public:
+
+        virtual ~Controller() { }
+
+        /**
+         * @param[in] step counting from 0
+         * @param[in] time step * Config::stepSize
+         * @param[in] params the parameters being tuned
+         * @param[out] restLengths one per cable, in the order added
+         */
+        virtual void restLengths(std::size_t step, double time,
+                                 const std::vector<double>& params,
+                                 double* restLengths) const = 0;
+
+        /**
+         * Add dLoss / dRestLengths * dRestLengths / dParams to
+         * gradient.
+         * @param[in] dRestLengths dLoss / dRestLengths, one per cable
+         * @param[in,out] gradient one per parameter
+         */
+        virtual void addGradient(std::size_t step, double time,
+                                 const std::vector<double>& params,
+                                 const double* dRestLengths,
+                                 std::vector<double>& gradient) const = 0;
+    };
+
+    /**
+     * A loss summed over the states of a rollout, after each step.
+     */
+    class Loss
+    {
+    public:
+
+        virtual ~Loss() { }
+
+        /**
+         * @param[in] step the state after this many steps, from 1
+         * @param[in] positions x, y and z of every node
+         * @param[in] velocities likewise
+         * @param[out] dPositions dLoss / dPositions, zeroed beforehand
+         * @param[out] dVelocities likewise
+         * @return this state's term of the loss
+         */
+        virtual double stateLoss(std::size_t step, const double* positions,
+                                 const double* velocities,
+                                 double* dPositions,
+                                 double* dVelocities) const = 0;
+    };
+
+    explicit tgDifferentiableSim(const Config& config = Config());
+
+    /**
+     * @param[in] mass zero or less for a node that does not move
+     * @return the node's index
+     */
+    std::size_t addNode(double x, double y, double z, double mass);
+
+    /**
+     * Join two nodes by a rod, at their present distance.
+     * @throw std::out_of_range if there is no such node
+     */
+    void addRod(std::size_t from, std::size_t to, double stiffness,
+                double damping);
+
+    /**
+     * Join two nodes by a cable. Its rest length comes from the
+     * Controller during rollouts.
+     * @return the cable's index
+     * @throw std::out_of_range if there is no such node
+     */
+    std::size_t addCable(std::size_t from, std::size_t to,
+                         double stiffness, double damping);
+
+    std::size_t nodeCount() const
+    {
+        return m_mass.size();
+    }
+
+    std::size_t cableCount() const
+    {
+        return m_cables.size();
+    }
+
+    /**
+     * Step from the nodes as added, at rest.
+     * @return the loss summed over the steps' states
+     * @throw std::invalid_argument if steps is zero
+     */
+    double rollout(std::size_t steps, const Controller& controller,
+                   const std::vector<double>& params, const Loss& loss);
+
+    /**
+     * Roll out, then run the adjoint back through the steps.
+     * @param[out] gradient dLoss / dParams, resized to params
+     * @param[out] restLengthGradient if not NULL, dLoss / dRestLengths
+     * for every step and cable, a row per step
+     * @return the loss, as rollout
+     */
+    double gradient(std::size_t steps, const Controller& controller,
+                    const std::vector<double>& params, const Loss& loss,
+                    std::vector<double>& gradient,
+                    std::vector<double>* restLengthGradient = NULL);
+
+    /** The positions after a step of the last rollout, 3 per node */
+    const double* getPositions(std::size_t step) const
+    {
+        return &m_positions[step * 3 * nodeCount()];
+    }
+
+    /** The velocities after a step of the last rollout */
+    const double* getVelocities(std::size_t step) const
+    {
+        return &m_velocities[step * 3 * nodeCount()];
+    }
+
+private:
+
+    /** A rod or cable */
+    struct Element
+    {
+        std::size_t from;
+        std::size_t to;
+        double stiffness;
+        double damping;
+        /** Fixed for a rod */
+        double restLength;
+    };
+
+    /**
+     * An element's tension and its derivatives with respect to length,
+     * rest length and stretching velocity
+     */
+    struct Tension
+    {
+        double tension;
+        double dLength;
+        double dVelocity;
+    };
+
+    /** tgLinearTensionLaw with its kinks smoothed */
+    Tension cableTension(const Element& cable, double length,
+                         double restLength, double velocity) const;
+
+    /** The forces of the state after step, with rest lengths for it */
+    void computeForces(std::size_t step, const double* restLengths,
+                       double* forces) const;
+
+    /**
+     * Add the adjoint of computeForces for the state after step,
+     * given adjoint, the loss's gradient with respect to the forces
+     */
+    void addForceAdjoint(std::size_t step, const double* restLengths,
+                         const double* adjoint, double* dPositions,
+                         double* dVelocities, double* dRestLengths) const;
+
+    void checkNode(std::size_t node) const;
+
+    const Config m_config;
+
+    std::vector<double> m_start;
+    std::vector<double> m_mass;
+    std::vector<Element> m_rods;
+    std::vector<Element> m_cables;
+
+    /** The trajectory of the last rollout, a row per state */
+    std::vector<double> m_positions;
+    std::vector<double> m_velocities;
+
+    /** The rest lengths of the last rollout, a row per step */
+    std::vector<double> m_restLengths;
+
+    std::size_t m_steps;
+};
+
+#endif  // TG_DIFFERENTIABLE_SIM_H
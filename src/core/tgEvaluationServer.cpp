@@ -0,0 +1,224 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgEvaluationServer.cpp
+ * @brief Contains the definitions of members of class tgEvaluationServer
+ * $Id$
+ */
+
+// This module
+#include "tgEvaluationServer.h"
+// This application
+#include "tgSimulation.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+// POSIX sockets
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    /** Write all of a string to a socket, false if the peer has gone */
+    bool sendAll(int fd, const std::string& s)
+    {
+        std::size_t sent = 0;
+        while (sent < s.size())
+        {
+            const ssize_t n = send(fd, s.data() + sent, s.size() - sent, 0);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                return false;
+            }
+            sent += n;
+        }
+        return true;
+    }
+}
+
+tgEvaluationServer::tgEvaluationServer(Evaluation& evaluation,
+                                       bool restoreSnapshots) :
+m_evaluation(evaluation),
+m_restoreSnapshots(restoreSnapshots),
+m_pSnapshotSimulation(NULL),
+m_stopped(false)
+{
+}
+
+std::string tgEvaluationServer::handleRequest(const std::string& request)
+{
+    std::istringstream tokens(request);
+    std::string first;
+    if (!(tokens >> first))
+    {
+        return "";
+    }
+    if (first == "quit")
+    {
+        m_stopped = true;
+        return "";
+    }
+
+    char* end = NULL;
+    const long steps = std::strtol(first.c_str(), &end, 10);
+    if (*end != '\0' || steps <= 0)
+    {
+        return "error the number of steps must be a positive integer";
+    }
+    std::vector<std::string> args;
+    std::string arg;
+    while (tokens >> arg)
+    {
+        args.push_back(arg);
+    }
+
+    try
+    {
+        tgSimulation& simulation = m_evaluation.beginTrial(args);
+        if (m_restoreSnapshots && &simulation != m_pSnapshotSimulation)
+        {
+            simulation.snapshot(m_snapshot);
+            m_pSnapshotSimulation = &simulation;
+        }
+
+        bool completed = true;
+        try
+        {
+            simulation.run(steps);
+        }
+        catch (std::runtime_error&)
+        {
+            // The controllers score this as a failed trial
+            completed = false;
+        }
+
+        const std::string reply = m_evaluation.endTrial(simulation, completed);
+        assert(reply.find('\n') == std::string::npos);
+
+        if (&simulation == m_pSnapshotSimulation)
+        {
+            simulation.restore(m_snapshot);
+        }
+        return reply.empty() ? "ok" : "ok " + reply;
+    }
+    catch (std::exception& e)
+    {
+        // Whatever state the simulation was left in, record a new snapshot
+        m_pSnapshotSimulation = NULL;
+        std::string message(e.what());
+        std::replace(message.begin(), message.end(), '\n', ' ');
+        return "error " + message;
+    }
+}
+
+void tgEvaluationServer::serve(std::istream& in, std::ostream& out)
+{
+    std::string line;
+    while (!m_stopped && std::getline(in, line))
+    {
+        const std::string reply = handleRequest(line);
+        if (!reply.empty())
+        {
+            out << reply << std::endl;
+        }
+    }
+}
+
+void tgEvaluationServer::serve(const std::string& socketPath)
+{
+    sockaddr_un address;
+    if (socketPath.size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error("Socket path too long: " + socketPath);
+    }
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, socketPath.c_str());
+
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        throw std::runtime_error("Could not create a socket");
+    }
+    unlink(socketPath.c_str());
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, 1) != 0)
+    {
+        close(listener);
+        throw std::runtime_error("Could not listen on " + socketPath);
+    }
+
+    while (!m_stopped)
+    {
+        const int connection = accept(listener, NULL, NULL);
+        if (connection < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        std::string pending;
+        char buffer[4096];
+        bool open = true;
+        while (open && !m_stopped)
+        {
+            const ssize_t n = recv(connection, buffer, sizeof(buffer), 0);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                break;
+            }
+            pending.append(buffer, n);
+
+            std::size_t newline;
+            while (open && !m_stopped &&
+                   (newline = pending.find('\n')) != std::string::npos)
+            {
+                const std::string reply =
+                  handleRequest(pending.substr(0, newline));
+                pending.erase(0, newline + 1);
+                if (!reply.empty())
+                {
+                    open = sendAll(connection, reply + "\n");
+                }
+            }
+        }
+        close(connection);
+    }
+
+    close(listener);
+    unlink(socketPath.c_str());
+}
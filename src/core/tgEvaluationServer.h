@@ -0,0 +1,141 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_EVALUATION_SERVER_H
+#define TG_EVALUATION_SERVER_H
+
+/**
+ * @file tgEvaluationServer.h
+ * @brief Contains the definition of class tgEvaluationServer
+ * $Id$
+ */
+
+// This application
+#include "tgWorldSnapshot.h"
+// The C++ Standard Library
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgSimulation;
+
+/**
+ * Runs trials on request in a long-lived process, so a learning script
+ * can keep a pool of warm workers instead of starting the application
+ * once per trial.
+ *
+ * Requests and replies are single lines. A request is the number of
+ * steps to run followed by the trial's arguments, separated by
+ * whitespace, in whatever form the application takes them on its
+ * command line. The reply is "ok" followed by the text returned by
+ * Evaluation::endTrial, or "error" followed by the message of whatever
+ * was thrown. The request "quit" stops the server.
+ */
+class tgEvaluationServer
+{
+public:
+
+    /**
+     * The application side of the server.
+     */
+    class Evaluation
+    {
+    public:
+
+        virtual ~Evaluation() { }
+
+        /**
+         * Get ready for a trial, typically by passing the arguments to
+         * the controllers.
+         * @param[in] args the request's arguments after the step count
+         * @return the simulation to run the trial in; it must stay valid
+         * until the matching endTrial returns
+         */
+        virtual tgSimulation& beginTrial(const std::vector<std::string>& args) = 0;
+
+        /**
+         * Called after every trial that was begun, including ones
+         * stopped by a std::runtime_error, as the learning apps treat
+         * those as a failed trial rather than an error.
+         * @param[in] simulation the one returned by beginTrial
+         * @param[in] completed false if the trial threw
+         * @return the rest of the reply; must not contain a newline
+         */
+        virtual std::string endTrial(tgSimulation& simulation,
+                                     bool completed) = 0;
+    };
+
+    /**
+     * @param[in] evaluation runs the trials. We do not take ownership.
+     * @param[in] restoreSnapshots if true, the state of a simulation just
+     * after its first beginTrial is put back after each of its trials,
+     * so later trials start from there without a teardown. As
+     * tgSimulation::restore does not set the models up again,
+     * beginTrial must then restart the controllers itself.
+     */
+    tgEvaluationServer(Evaluation& evaluation, bool restoreSnapshots = false);
+
+    /**
+     * Run one request.
+     * @param[in] request one line, without its newline
+     * @return the reply, without a newline; empty for "quit" and for
+     * blank lines
+     */
+    std::string handleRequest(const std::string& request);
+
+    /**
+     * Answer requests from a stream until it ends or "quit" is read.
+     * Anything the application prints to the same stream will be mixed
+     * with the replies, so prefer a socket when using std::cout.
+     * @param[in,out] in the requests
+     * @param[in,out] out the replies, flushed after each one
+     */
+    void serve(std::istream& in, std::ostream& out);
+
+    /**
+     * Listen on a Unix domain socket, answering one connection at a time,
+     * until "quit" is read. The socket file is replaced if it exists and
+     * removed on return.
+     * @param[in] socketPath the file name of the socket
+     * @throw std::runtime_error if the socket cannot be set up
+     */
+    void serve(const std::string& socketPath);
+
+    /** True once "quit" has been read */
+    bool isStopped() const
+    {
+        return m_stopped;
+    }
+
+private:
+
+    Evaluation& m_evaluation;
+
+    const bool m_restoreSnapshots;
+
+    /** Taken from m_pSnapshotSimulation after its first beginTrial */
+    tgWorldSnapshot m_snapshot;
+
+    /** The simulation m_snapshot belongs to, or NULL */
+    tgSimulation* m_pSnapshotSimulation;
+
+    bool m_stopped;
+};
+
+#endif  // TG_EVALUATION_SERVER_H
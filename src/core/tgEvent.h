@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_EVENT_H
+#define TG_EVENT_H
+
+/**
+ * @file tgEvent.h
+ * @brief Definition of tgEvent class
+ * $Id$
+ */
+
+/**
+ * A sparse event raised by a tgSubject, delivered through
+ * tgObserver::onEvent to the observers subscribed to its type, rather
+ * than polled for in every onStep.
+ */
+struct tgEvent
+{
+    enum Type
+    {
+        /** A contact cable started wrapping around a body */
+        eContactBegan,
+        /** A contact cable stopped wrapping around a body */
+        eContactEnded,
+        /** An actuator's tension rose above its maximum */
+        eTensionLimit,
+        /** An actuator's length fell to its minimum */
+        eMinLength,
+        /** A timer set with tgSubject::subscribeTimer has fired */
+        eTimer,
+        /** The number of types, not a type */
+        eTypeCount
+    };
+
+    tgEvent(Type t, double v) :
+        type(t),
+        value(v)
+    {
+    }
+
+    Type type;
+
+    /**
+     * For contacts, the number of contacts after the change; for the
+     * tension and length limits, the tension or length; for a timer,
+     * the seconds since it last fired.
+     */
+    double value;
+};
+
+#endif  // TG_EVENT_H
@@ -0,0 +1,269 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgForkPool.cpp
+ * @brief Contains the definitions of members of class tgForkPool
+ * $Id$
+ */
+
+// This module
+#include "tgForkPool.h"
+// This application
+#include "tgSimulation.h"
+#include "tgSimView.h"
+#include "tgWorld.h"
+#include "terrain/tgBoxGround.h"
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+/**
+ * Everything belonging to one branch. The view, simulation and world
+ * are created and destroyed by the slot's own thread.
+ */
+class tgForkPool::Slot
+{
+public:
+    Slot(tgForkPool& o, Branch& b, std::size_t i) :
+        owner(o),
+        branch(b),
+        index(i),
+        pWorld(NULL),
+        pView(NULL),
+        pSimulation(NULL),
+        batch(0)
+    {
+    }
+
+    void create(const Config& config)
+    {
+        pWorld = new tgWorld(config.worldConfig, branch.createGround());
+        pView = new tgSimView(*pWorld, config.stepSize, config.stepSize);
+        pSimulation = new tgSimulation(*pView);
+        branch.setup(*pSimulation);
+    }
+
+    void destroy()
+    {
+        // The simulation tears down and deletes the models
+        delete pSimulation;
+        delete pView;
+        delete pWorld;
+        pSimulation = NULL;
+        pView = NULL;
+        pWorld = NULL;
+    }
+
+    tgForkPool& owner;
+    Branch& branch;
+    const std::size_t index;
+    tgWorld* pWorld;
+    tgSimView* pView;
+    tgSimulation* pSimulation;
+    pthread_t thread;
+
+    /** The last batch this slot has run */
+    unsigned long batch;
+};
+
+tgGround* tgForkPool::Branch::createGround()
+{
+    return new tgBoxGround();
+}
+
+tgForkPool::Config::Config(const tgWorld::Config& wc, double ss) :
+worldConfig(wc),
+stepSize(ss)
+{
+    if (ss <= 0.0)
+    {
+        throw std::invalid_argument("stepSize is not positive");
+    }
+}
+
+tgForkPool::tgForkPool(const Config& config,
+                       const std::vector<Branch*>& branches) :
+m_config(config),
+m_batch(0),
+m_finishedSlots(0),
+m_steps(0),
+m_shutdown(false)
+{
+    if (branches.empty())
+    {
+        throw std::invalid_argument("No branches");
+    }
+
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_workReady, NULL);
+    pthread_cond_init(&m_workDone, NULL);
+
+    for (std::size_t i = 0; i < branches.size(); i++)
+    {
+        if (branches[i] == NULL)
+        {
+            throw std::invalid_argument("Branch is NULL");
+        }
+        m_slots.push_back(new Slot(*this, *branches[i], i));
+    }
+
+    for (std::size_t i = 0; i < m_slots.size(); i++)
+    {
+        if (pthread_create(&m_slots[i]->thread, NULL, workerMain, m_slots[i]) != 0)
+        {
+            throw std::runtime_error("Could not start a branch thread");
+        }
+    }
+
+    // The first batch builds the branches, each on its own thread
+    runBatch();
+
+    // Postcondition
+    assert(invariant());
+}
+
+tgForkPool::~tgForkPool()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_shutdown = true;
+    pthread_cond_broadcast(&m_workReady);
+    pthread_mutex_unlock(&m_mutex);
+
+    for (std::size_t i = 0; i < m_slots.size(); i++)
+    {
+        pthread_join(m_slots[i]->thread, NULL);
+        delete m_slots[i];
+    }
+
+    pthread_cond_destroy(&m_workDone);
+    pthread_cond_destroy(&m_workReady);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void tgForkPool::fork(const tgSimulation& source, int steps)
+{
+    if (steps <= 0)
+    {
+        throw std::invalid_argument("steps is not positive");
+    }
+
+    // Taken once; each branch maps it onto its own bodies
+    source.snapshot(m_source);
+    m_steps = steps;
+    runBatch();
+
+    // Postcondition
+    assert(invariant());
+}
+
+tgSimulation& tgForkPool::getSimulation(std::size_t branch) const
+{
+    tgSimulation* const pSimulation = m_slots.at(branch)->pSimulation;
+    if (pSimulation == NULL)
+    {
+        throw std::runtime_error("Branch was not built");
+    }
+    return *pSimulation;
+}
+
+void tgForkPool::runBatch()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_finishedSlots = 0;
+    m_error.clear();
+    ++m_batch;
+    pthread_cond_broadcast(&m_workReady);
+
+    while (m_finishedSlots < m_slots.size())
+    {
+        pthread_cond_wait(&m_workDone, &m_mutex);
+    }
+    const std::string error = m_error;
+    pthread_mutex_unlock(&m_mutex);
+
+    if (!error.empty())
+    {
+        throw std::runtime_error(error);
+    }
+}
+
+void* tgForkPool::workerMain(void* arg)
+{
+    Slot* const pSlot = static_cast<Slot*>(arg);
+    pSlot->owner.work(*pSlot);
+    return NULL;
+}
+
+void tgForkPool::work(Slot& slot)
+{
+    pthread_mutex_lock(&m_mutex);
+    while (true)
+    {
+        while (!m_shutdown && slot.batch == m_batch)
+        {
+            pthread_cond_wait(&m_workReady, &m_mutex);
+        }
+        if (m_shutdown)
+        {
+            break;
+        }
+        slot.batch = m_batch;
+        const int steps = m_steps;
+        pthread_mutex_unlock(&m_mutex);
+
+        std::string error;
+        try
+        {
+            if (slot.pSimulation == NULL)
+            {
+                slot.create(m_config);
+            }
+            else
+            {
+                slot.pSimulation->restoreFrom(m_source);
+                slot.branch.onFork(slot.index);
+                slot.pSimulation->run(steps);
+                slot.branch.endRollout(slot.index);
+            }
+        }
+        catch (std::exception& e)
+        {
+            error = e.what();
+        }
+
+        pthread_mutex_lock(&m_mutex);
+        if (!error.empty() && m_error.empty())
+        {
+            m_error = error;
+        }
+        if (++m_finishedSlots == m_slots.size())
+        {
+            pthread_cond_signal(&m_workDone);
+        }
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    slot.destroy();
+}
+
+bool tgForkPool::invariant() const
+{
+    return !m_slots.empty() && m_config.stepSize > 0.0;
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_FORK_POOL_H
+#define TG_FORK_POOL_H
+
+/**
+ * @file tgForkPool.h
+ * @brief Contains the definition of class tgForkPool
+ * $Id$
+ */
+
+// This application
+#include "tgWorld.h"
+#include "tgWorldSnapshot.h"
+// The C++ Standard Library
+#include <string>
+#include <vector>
+// POSIX threads
+#include <pthread.h>
+
+// Forward declarations
+class tgGround;
+class tgSimulation;
+
+/**
+ * A pool of branch worlds for rollouts forked from a running
+ * simulation, as for model-predictive control or finite-difference
+ * gradients. The branches are built once, with the same models as the
+ * source, and each fork only copies the source's state into them with
+ * tgSimulation::fork, so forking every control step costs a few
+ * restores rather than rebuilds. A tgModelTemplate keeps building the
+ * branches cheap too.
+ *
+ * Each branch has its own world and worker thread, so the rollouts of
+ * a fork run in parallel. As with tgParallelSimulation, build Bullet
+ * and NTRT with -DBT_NO_PROFILE.
+ */
+class tgForkPool
+{
+public:
+
+    /**
+     * The application side of one branch. Branches are called from the
+     * worker thread that owns their world.
+     */
+    class Branch
+    {
+    public:
+
+        virtual ~Branch() { }
+
+        /**
+         * Create the ground for this branch's world. The world takes
+         * ownership. The default is a tgBoxGround, which must match the
+         * source's for the rollouts to agree with it.
+         */
+        virtual tgGround* createGround();
+
+        /**
+         * Create the same models as the source simulation, in the same
+         * order, and add them to the branch's simulation. Called once.
+         * @param[in,out] simulation the simulation for this branch
+         */
+        virtual void setup(tgSimulation& simulation) = 0;
+
+        /**
+         * Called after the source's state has been copied in, before
+         * the rollout. Copy the source's controller state here, and
+         * apply this branch's perturbation.
+         * @param[in] branch the index of this branch in the pool
+         */
+        virtual void onFork(std::size_t branch) = 0;
+
+        /**
+         * Called after the rollout, e.g. to score it.
+         * @param[in] branch the index of this branch in the pool
+         */
+        virtual void endRollout(std::size_t branch) = 0;
+    };
+
+    /**
+     * Configuration shared by all branches. This is Plain Old Data.
+     */
+    struct Config
+    {
+        Config(const tgWorld::Config& wc = tgWorld::Config(),
+               double ss = 1.0/1000.0);
+
+        /**
+         * The configuration of every branch's world, which must match
+         * the source's
+         */
+        tgWorld::Config worldConfig;
+
+        /** The timestep of the rollouts, in seconds. Must be positive. */
+        double stepSize;
+    };
+
+    /**
+     * Start one worker thread per branch, each of which builds its
+     * branch's world.
+     * @param[in] config the configuration of every branch
+     * @param[in] branches must not be empty and must outlive this
+     * object. We do not take ownership.
+     * @throw std::runtime_error if a branch's setup threw
+     */
+    tgForkPool(const Config& config, const std::vector<Branch*>& branches);
+
+    /** Stop the workers and delete the worlds. */
+    ~tgForkPool();
+
+    /**
+     * Copy the state of a simulation into every branch, then step each
+     * branch independently, blocking until every rollout has finished.
+     * @param[in] source a simulation with the same models as the
+     * branches; it is not stepped
+     * @param[in] steps the number of steps in each rollout; must be
+     * positive
+     * @throw std::invalid_argument if steps is not positive
+     * @throw std::runtime_error if a rollout threw; the others still run
+     */
+    void fork(const tgSimulation& source, int steps);
+
+    /** The number of branches */
+    std::size_t size() const
+    {
+        return m_slots.size();
+    }
+
+    /**
+     * A branch's simulation, to read its models after a fork. Only
+     * while no fork is running.
+     */
+    tgSimulation& getSimulation(std::size_t branch) const;
+
+private:
+
+    /** One branch's world and the thread that steps it */
+    class Slot;
+
+    /** Have every worker run a batch, blocking until all are done */
+    void runBatch();
+
+    /** The worker loop, run for each slot */
+    void work(Slot& slot);
+
+    /** pthread entry point; arg is a Slot */
+    static void* workerMain(void* arg);
+
+    /** Integrity predicate */
+    bool invariant() const;
+
+    /** Not copyable */
+    tgForkPool(const tgForkPool&);
+    tgForkPool& operator=(const tgForkPool&);
+
+private:
+
+    const Config m_config;
+
+    /** We own these */
+    std::vector<Slot*> m_slots;
+
+    /** The state the branches are forked from, taken by fork() */
+    tgWorldSnapshot m_source;
+
+    /** Guards everything below */
+    pthread_mutex_t m_mutex;
+
+    /** Signalled when a batch starts or the workers should exit */
+    pthread_cond_t m_workReady;
+
+    /** Signalled when the last slot of a batch finishes */
+    pthread_cond_t m_workDone;
+
+    /** Incremented for each batch; the first builds the branches */
+    unsigned long m_batch;
+
+    std::size_t m_finishedSlots;
+    int m_steps;
+
+    /** The first error thrown in the current batch */
+    std::string m_error;
+
+    bool m_shutdown;
+};
+
+#endif  // TG_FORK_POOL_H
@@ -0,0 +1,102 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgGhostPairFilter.cpp
+ * @brief Contains the definitions of members of class tgGhostPairFilter
+ * $Id$
+ */
+
+// This module
+#include "tgGhostPairFilter.h"
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btBroadphaseProxy.h"
+#include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+
+tgGhostPairFilter::tgGhostPairFilter() :
+    m_enabled(true)
+{
+}
+
+tgGhostPairFilter::~tgGhostPairFilter()
+{
+}
+
+bool tgGhostPairFilter::needBroadphaseCollision(btBroadphaseProxy* proxy0,
+                                                btBroadphaseProxy* proxy1) const
+{
+    // As Bullet's default when no filter is set
+    const bool collides =
+        (proxy0->m_collisionFilterGroup & proxy1->m_collisionFilterMask) != 0 &&
+        (proxy1->m_collisionFilterGroup & proxy0->m_collisionFilterMask) != 0;
+    if (!collides || !m_enabled || m_excluded.empty())
+    {
+        return collides;
+    }
+
+    const btCollisionObject* const pObject0 =
+        static_cast<const btCollisionObject*>(proxy0->m_clientObject);
+    const btCollisionObject* const pObject1 =
+        static_cast<const btCollisionObject*>(proxy1->m_clientObject);
+    if ((proxy0->m_collisionFilterGroup & btBroadphaseProxy::CharacterFilter) &&
+        excludes(pObject0, pObject1))
+    {
+        return false;
+    }
+    if ((proxy1->m_collisionFilterGroup & btBroadphaseProxy::CharacterFilter) &&
+        excludes(pObject1, pObject0))
+    {
+        return false;
+    }
+    return true;
+}
+
+void tgGhostPairFilter::exclude(const btCollisionObject* pGhost,
+                                const btCollisionObject* pOther)
+{
+    assert(pGhost);
+    if (pOther == NULL || pOther == pGhost)
+    {
+        return;
+    }
+    std::vector<const btCollisionObject*>& others = m_excluded[pGhost];
+    if (std::find(others.begin(), others.end(), pOther) == others.end())
+    {
+        others.push_back(pOther);
+    }
+}
+
+void tgGhostPairFilter::forget(const btCollisionObject* pGhost)
+{
+    m_excluded.erase(pGhost);
+}
+
+bool tgGhostPairFilter::excludes(const btCollisionObject* pGhost,
+                                 const btCollisionObject* pOther) const
+{
+    const ExclusionMap::const_iterator it = m_excluded.find(pGhost);
+    if (it == m_excluded.end())
+    {
+        return false;
+    }
+    const std::vector<const btCollisionObject*>& others = it->second;
+    return std::find(others.begin(), others.end(), pOther) != others.end();
+}
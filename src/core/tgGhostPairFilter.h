@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_CORE_TG_GHOST_PAIR_FILTER_H_
+#define SRC_CORE_TG_GHOST_PAIR_FILTER_H_
+
+/**
+ * @file tgGhostPairFilter.h
+ * @brief Contains the definition of class tgGhostPairFilter
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// Forward declarations
+class btCollisionObject;
+
+/**
+ * The broadphase filter of a tgWorldBulletPhysicsImpl. Pairs pass the
+ * usual collision group and mask test, and in addition a ghost object,
+ * such as the one following a tgBulletContactSpringCable, can name
+ * bodies it should never be paired with. Such pairs are rejected before
+ * they reach the pair cache, so the narrowphase never computes their
+ * contacts and tgBulletContactSpringCable::updateManifolds never sees
+ * them.
+ *
+ * Ghosts are added with the CharacterFilter group and a mask without
+ * it, so ghosts are already never paired with each other. Only pairs
+ * with a CharacterFilter proxy are looked up, so the filter costs
+ * other pairs a mask test, as Bullet's default.
+ *
+ * The filter is applied as pairs are created. Exclusions must be
+ * registered before the ghost is added to the world, and changing them
+ * or disabling the filter does not remove pairs already in the cache.
+ */
+class tgGhostPairFilter : public btOverlapFilterCallback
+{
+public:
+
+    tgGhostPairFilter();
+
+    virtual ~tgGhostPairFilter();
+
+    /** Called by the broadphase for each new pair of proxies */
+    virtual bool needBroadphaseCollision(btBroadphaseProxy* proxy0,
+                                         btBroadphaseProxy* proxy1) const;
+
+    /**
+     * Never pair a ghost with an object, typically a body the ghost's
+     * cable is anchored to. Repeated calls are ignored.
+     * @param[in] pGhost the ghost; must not be NULL
+     * @param[in] pOther the object; may be NULL, which is ignored
+     */
+    void exclude(const btCollisionObject* pGhost,
+                 const btCollisionObject* pOther);
+
+    /** Drop every exclusion of a ghost, when it leaves the world */
+    void forget(const btCollisionObject* pGhost);
+
+    /**
+     * Whether exclusions are applied; true by default. When false, the
+     * filter is Bullet's group and mask test.
+     */
+    void setEnabled(bool enabled)
+    {
+        m_enabled = enabled;
+    }
+
+    bool isEnabled() const
+    {
+        return m_enabled;
+    }
+
+    /** The number of ghosts with exclusions */
+    std::size_t ghostCount() const
+    {
+        return m_excluded.size();
+    }
+
+private:
+
+    /** True if pGhost names pOther as excluded */
+    bool excludes(const btCollisionObject* pGhost,
+                  const btCollisionObject* pOther) const;
+
+    typedef std::map<const btCollisionObject*,
+                     std::vector<const btCollisionObject*> > ExclusionMap;
+
+    /** Each ghost's excluded objects, a handful each */
+    ExclusionMap m_excluded;
+
+    bool m_enabled;
+};
+
+#endif  // SRC_CORE_TG_GHOST_PAIR_FILTER_H_
@@ -0,0 +1,99 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgHistoryBuffer.cpp
+ * @brief Contains the definitions of members of class tgHistoryBuffer
+ * $Id$
+ */
+
+// This module
+#include "tgHistoryBuffer.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+tgHistoryBuffer::tgHistoryBuffer(std::size_t capacity, std::size_t decimation) :
+m_head(0),
+m_capacity(capacity),
+m_decimation(decimation),
+m_phase(0)
+{
+    if (decimation == 0)
+    {
+        throw std::invalid_argument("decimation is zero");
+    }
+    m_data.reserve(capacity);
+
+    // Postcondition
+    assert(invariant());
+}
+
+void tgHistoryBuffer::clear()
+{
+    m_data.clear();
+    m_head = 0;
+    m_phase = 0;
+}
+
+void tgHistoryBuffer::saveState(std::vector<double>& state) const
+{
+    state.push_back(m_data.size());
+    state.push_back(m_phase);
+    if (m_capacity != 0)
+    {
+        for (std::size_t i = 0; i < m_data.size(); i++)
+        {
+            state.push_back((*this)[i]);
+        }
+    }
+}
+
+std::size_t tgHistoryBuffer::restoreState(const std::vector<double>& state,
+                                          std::size_t pos)
+{
+    assert(pos + 2 <= state.size());
+    const std::size_t n = static_cast<std::size_t>(state[pos++]);
+    m_phase = static_cast<std::size_t>(state[pos++]);
+
+    if (m_capacity != 0)
+    {
+        // Within the reserved capacity, so this does not allocate
+        assert(pos + n <= state.size() && n <= m_capacity);
+        m_data.assign(state.begin() + pos, state.begin() + pos + n);
+        m_head = 0;
+        pos += n;
+    }
+    else if (n < m_data.size())
+    {
+        // Everything recorded since the snapshot is still at the end
+        m_data.resize(n);
+    }
+
+    // Postcondition
+    assert(invariant());
+
+    return pos;
+}
+
+bool tgHistoryBuffer::invariant() const
+{
+    return (m_decimation > 0) &&
+           (m_phase < m_decimation) &&
+           (m_capacity == 0 || m_data.size() <= m_capacity) &&
+           (m_head == 0 || m_head < m_data.size());
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_HISTORY_BUFFER_H
+#define TG_HISTORY_BUFFER_H
+
+/**
+ * @file tgHistoryBuffer.h
+ * @brief Contains the definition of class tgHistoryBuffer
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cassert>
+#include <vector>
+
+/**
+ * A sequence of samples in contiguous storage, used for the
+ * tgSpringCableActuator history. With a capacity of zero it grows
+ * without bound, like the std::deque it replaces; otherwise it keeps
+ * the most recent capacity samples in a ring and never allocates after
+ * construction. A decimation of n keeps the first of every n samples
+ * pushed.
+ *
+ * Indexing, front, back and size behave as for a std::deque, with
+ * index 0 being the oldest sample kept.
+ */
+class tgHistoryBuffer
+{
+public:
+
+    /**
+     * @param[in] capacity the number of samples to keep, 0 for all
+     * @param[in] decimation keep one sample in this many; must be
+     * positive
+     * @throw std::invalid_argument if decimation is zero
+     */
+    explicit tgHistoryBuffer(std::size_t capacity = 0,
+                             std::size_t decimation = 1);
+
+    /**
+     * Record a sample, subject to decimation. When a bounded buffer is
+     * full the oldest sample is overwritten.
+     */
+    void push_back(double value)
+    {
+        if (m_phase == 0)
+        {
+            if (m_capacity == 0 || m_data.size() < m_capacity)
+            {
+                m_data.push_back(value);
+            }
+            else
+            {
+                m_data[m_head] = value;
+                m_head = (m_head + 1 == m_capacity) ? 0 : m_head + 1;
+            }
+        }
+        m_phase = (m_phase + 1 == m_decimation) ? 0 : m_phase + 1;
+    }
+
+    /** The i-th oldest sample kept */
+    double operator[](std::size_t i) const
+    {
+        assert(i < m_data.size());
+        std::size_t j = m_head + i;
+        if (j >= m_data.size())
+        {
+            j -= m_data.size();
+        }
+        return m_data[j];
+    }
+
+    double front() const
+    {
+        return (*this)[0];
+    }
+
+    double back() const
+    {
+        return (*this)[m_data.size() - 1];
+    }
+
+    std::size_t size() const
+    {
+        return m_data.size();
+    }
+
+    bool empty() const
+    {
+        return m_data.empty();
+    }
+
+    /** The number of samples kept, 0 if unbounded */
+    std::size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    std::size_t decimation() const
+    {
+        return m_decimation;
+    }
+
+    /** Forget all samples, keeping the storage */
+    void clear();
+
+    /**
+     * Append what restoreState needs to return to the current contents.
+     * An unbounded buffer only records its size, since it can only grow;
+     * a bounded one records its samples.
+     * @param[in,out] state the values are appended to this
+     */
+    void saveState(std::vector<double>& state) const;
+
+    /**
+     * Read back what saveState wrote.
+     * @param[in] state as filled by saveState
+     * @param[in] pos the index of this buffer's first value
+     * @return the index just past this buffer's values
+     */
+    std::size_t restoreState(const std::vector<double>& state, std::size_t pos);
+
+private:
+
+    /** Integrity predicate */
+    bool invariant() const;
+
+    /** The samples; in ring order once a bounded buffer has filled */
+    std::vector<double> m_data;
+
+    /** The index in m_data of the oldest sample */
+    std::size_t m_head;
+
+    std::size_t m_capacity;
+
+    std::size_t m_decimation;
+
+    /** Samples pushed since the last one kept, modulo m_decimation */
+    std::size_t m_phase;
+};
+
+#endif  // TG_HISTORY_BUFFER_H
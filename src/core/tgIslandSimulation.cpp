@@ -0,0 +1,445 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgIslandSimulation.cpp
+ * @brief Contains the definitions of members of class tgIslandSimulation
+ * $Id$
+ */
+
+// This module
+#include "tgIslandSimulation.h"
+// This application
+#include "tgBaseRigid.h"
+#include "tgCast.h"
+#include "tgModel.h"
+#include "tgSimulation.h"
+#include "tgSimView.h"
+#include "terrain/tgBoxGround.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+// POSIX
+#include <unistd.h>
+
+namespace
+{
+    /** Union-find over robot indices */
+    std::size_t findRoot(std::vector<std::size_t>& parent, std::size_t i)
+    {
+        while (parent[i] != i)
+        {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+}
+
+tgGround* tgIslandSimulation::GroundFactory::createGround()
+{
+    return new tgBoxGround();
+}
+
+tgIslandSimulation::Config::Config(const tgWorld::Config& wc, double ss,
+                                   std::size_t is, double m,
+                                   std::size_t ri) :
+worldConfig(wc),
+stepSize(ss),
+islands(is),
+margin(m),
+regroupInterval(ri)
+{
+    if (ss <= 0.0)
+    {
+        throw std::invalid_argument("stepSize is not positive");
+    }
+    else if (m < 0.0)
+    {
+        throw std::invalid_argument("margin is negative");
+    }
+    else if (ri == 0)
+    {
+        throw std::invalid_argument("regroupInterval is zero");
+    }
+}
+
+tgIslandSimulation::tgIslandSimulation(const Config& config,
+                                       GroundFactory* pGrounds) :
+m_config(config),
+m_steps(0),
+m_migrations(0),
+m_batch(0),
+m_finishedIslands(0),
+m_shutdown(false)
+{
+    std::size_t islands = config.islands;
+    if (islands == 0)
+    {
+        islands = (std::size_t) std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+    }
+
+    GroundFactory boxes;
+    GroundFactory& grounds = pGrounds ? *pGrounds : boxes;
+    // Sized once, since the threads hold pointers to the islands
+    m_islands.resize(islands);
+    for (std::size_t i = 0; i < islands; i++)
+    {
+        Island& island = m_islands[i];
+        island.pWorld = new tgWorld(config.worldConfig, grounds.createGround());
+        island.pView = new tgSimView(*island.pWorld, config.stepSize, config.stepSize);
+        island.pSimulation = new tgSimulation(*island.pView);
+        island.models = 0;
+        island.batch = 0;
+        island.pOwner = this;
+    }
+
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_workReady, NULL);
+    pthread_cond_init(&m_workDone, NULL);
+
+    for (std::size_t i = 1; i < islands; i++)
+    {
+        if (pthread_create(&m_islands[i].thread, NULL, workerMain, &m_islands[i]) != 0)
+        {
+            throw std::runtime_error("Could not start an island thread");
+        }
+    }
+}
+
+tgIslandSimulation::~tgIslandSimulation()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_shutdown = true;
+    pthread_cond_broadcast(&m_workReady);
+    pthread_mutex_unlock(&m_mutex);
+
+    for (std::size_t i = 1; i < m_islands.size(); i++)
+    {
+        pthread_join(m_islands[i].thread, NULL);
+    }
+
+    pthread_cond_destroy(&m_workDone);
+    pthread_cond_destroy(&m_workReady);
+    pthread_mutex_destroy(&m_mutex);
+
+    // Every robot is torn down before any world is deleted, since a
+    // robot that changed islands uses shapes its first world made
+    for (std::size_t i = 0; i < m_islands.size(); i++)
+    {
+        delete m_islands[i].pSimulation;
+    }
+    for (std::size_t i = 0; i < m_islands.size(); i++)
+    {
+        delete m_islands[i].pView;
+        delete m_islands[i].pWorld;
+    }
+}
+
+void tgIslandSimulation::addModel(tgModel* pModel)
+{
+    if (pModel == NULL)
+    {
+        throw std::invalid_argument("NULL pointer to tgModel");
+    }
+
+    std::size_t smallest = 0;
+    for (std::size_t i = 1; i < m_islands.size(); i++)
+    {
+        if (m_islands[i].models < m_islands[smallest].models)
+        {
+            smallest = i;
+        }
+    }
+    m_islands[smallest].pSimulation->addModel(pModel);
+    m_islands[smallest].models++;
+    m_models.push_back(pModel);
+    m_islandOf.push_back(smallest);
+
+    regroup();
+}
+
+tgSimulation& tgIslandSimulation::getSimulation(std::size_t island) const
+{
+    return *m_islands.at(island).pSimulation;
+}
+
+void tgIslandSimulation::step()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_finishedIslands = 0;
+    m_error.clear();
+    ++m_batch;
+    pthread_cond_broadcast(&m_workReady);
+    pthread_mutex_unlock(&m_mutex);
+
+    // This thread steps the first island
+    stepIsland(m_islands[0]);
+
+    pthread_mutex_lock(&m_mutex);
+    while (m_finishedIslands < m_islands.size())
+    {
+        pthread_cond_wait(&m_workDone, &m_mutex);
+    }
+    const std::string error = m_error;
+    pthread_mutex_unlock(&m_mutex);
+
+    if (!error.empty())
+    {
+        throw std::runtime_error(error);
+    }
+
+    if (++m_steps % m_config.regroupInterval == 0)
+    {
+        regroup();
+    }
+}
+
+void tgIslandSimulation::run(std::size_t steps)
+{
+    for (std::size_t i = 0; i < steps; i++)
+    {
+        step();
+    }
+}
+
+void tgIslandSimulation::stepIsland(Island& island)
+{
+    std::string error;
+    try
+    {
+        // An island with no robots may still have obstacles
+        island.pSimulation->step(m_config.stepSize);
+    }
+    catch (std::exception& e)
+    {
+        error = e.what();
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    if (!error.empty() && m_error.empty())
+    {
+        m_error = error;
+    }
+    if (++m_finishedIslands == m_islands.size())
+    {
+        pthread_cond_signal(&m_workDone);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void* tgIslandSimulation::workerMain(void* arg)
+{
+    Island* const pIsland = static_cast<Island*>(arg);
+    pIsland->pOwner->work(*pIsland);
+    return NULL;
+}
+
+void tgIslandSimulation::work(Island& island)
+{
+    pthread_mutex_lock(&m_mutex);
+    while (true)
+    {
+        while (!m_shutdown && island.batch == m_batch)
+        {
+            pthread_cond_wait(&m_workReady, &m_mutex);
+        }
+        if (m_shutdown)
+        {
+            break;
+        }
+        island.batch = m_batch;
+        pthread_mutex_unlock(&m_mutex);
+
+        stepIsland(island);
+
+        pthread_mutex_lock(&m_mutex);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool tgIslandSimulation::bounds(const tgModel& model, btVector3& min,
+                                btVector3& max) const
+{
+    std::vector<tgBaseRigid*> rigids = model.getDescendantsOfType<tgBaseRigid>();
+    if (tgBaseRigid* const pRigid =
+        tgCast::cast<tgModel, tgBaseRigid>(const_cast<tgModel*>(&model)))
+    {
+        rigids.push_back(pRigid);
+    }
+    bool found = false;
+    for (std::size_t i = 0; i < rigids.size(); i++)
+    {
+        const btRigidBody* const pBody = rigids[i]->getPRigidBody();
+        if (pBody == NULL)
+        {
+            continue;
+        }
+        btVector3 bodyMin;
+        btVector3 bodyMax;
+        pBody->getAabb(bodyMin, bodyMax);
+        if (found)
+        {
+            min.setMin(bodyMin);
+            max.setMax(bodyMax);
+        }
+        else
+        {
+            min = bodyMin;
+            max = bodyMax;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void tgIslandSimulation::migrate(std::size_t model, std::size_t island)
+{
+    const std::size_t from = m_islandOf[model];
+    if (from == island)
+    {
+        return;
+    }
+    m_islands[from].pSimulation->moveModel(m_models[model],
+                                           *m_islands[island].pSimulation);
+    m_islands[from].models--;
+    m_islands[island].models++;
+    m_islandOf[model] = island;
+    m_migrations++;
+}
+
+void tgIslandSimulation::regroup()
+{
+    const std::size_t n = m_models.size();
+    const std::size_t islands = m_islands.size();
+
+    // Robots whose bounds, grown by half the margin each, overlap
+    std::vector<btVector3> mins(n);
+    std::vector<btVector3> maxes(n);
+    std::vector<bool> placed(n);
+    const btVector3 half(m_config.margin / 2.0, m_config.margin / 2.0,
+                         m_config.margin / 2.0);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        placed[i] = bounds(*m_models[i], mins[i], maxes[i]);
+        mins[i] -= half;
+        maxes[i] += half;
+    }
+    std::vector<std::size_t> parent(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        parent[i] = i;
+    }
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = i + 1; placed[i] && j < n; j++)
+        {
+            if (placed[j] &&
+                mins[i].x() <= maxes[j].x() && mins[j].x() <= maxes[i].x() &&
+                mins[i].y() <= maxes[j].y() && mins[j].y() <= maxes[i].y() &&
+                mins[i].z() <= maxes[j].z() && mins[j].z() <= maxes[i].z())
+            {
+                parent[findRoot(parent, i)] = findRoot(parent, j);
+            }
+        }
+    }
+
+    // Each group, in order of its first robot
+    std::map<std::size_t, std::size_t> groupOfRoot;
+    std::vector< std::vector<std::size_t> > groups;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const std::size_t root = findRoot(parent, i);
+        std::map<std::size_t, std::size_t>::const_iterator it = groupOfRoot.find(root);
+        if (it == groupOfRoot.end())
+        {
+            groupOfRoot[root] = groups.size();
+            groups.push_back(std::vector<std::size_t>(1, i));
+        }
+        else
+        {
+            groups[it->second].push_back(i);
+        }
+    }
+
+    // Merge: a group goes to the island holding most of it, so the
+    // fewest robots move
+    std::vector<std::size_t> islandOfGroup(groups.size());
+    for (std::size_t g = 0; g < groups.size(); g++)
+    {
+        std::vector<std::size_t> count(islands, 0);
+        for (std::size_t k = 0; k < groups[g].size(); k++)
+        {
+            count[m_islandOf[groups[g][k]]]++;
+        }
+        const std::size_t target =
+            std::max_element(count.begin(), count.end()) - count.begin();
+        for (std::size_t k = 0; k < groups[g].size(); k++)
+        {
+            migrate(groups[g][k], target);
+        }
+        islandOfGroup[g] = target;
+    }
+
+    // Split: move the smallest group off the fullest island while that
+    // evens the islands out
+    for (std::size_t moves = 0; moves < groups.size(); moves++)
+    {
+        std::size_t fullest = 0;
+        std::size_t emptiest = 0;
+        for (std::size_t i = 1; i < islands; i++)
+        {
+            if (m_islands[i].models > m_islands[fullest].models)
+            {
+                fullest = i;
+            }
+            if (m_islands[i].models < m_islands[emptiest].models)
+            {
+                emptiest = i;
+            }
+        }
+        std::size_t smallest = groups.size();
+        std::size_t groupsThere = 0;
+        for (std::size_t g = 0; g < groups.size(); g++)
+        {
+            if (islandOfGroup[g] == fullest)
+            {
+                groupsThere++;
+                if (smallest == groups.size() ||
+                    groups[g].size() < groups[smallest].size())
+                {
+                    smallest = g;
+                }
+            }
+        }
+        if (groupsThere < 2 ||
+            m_islands[emptiest].models + groups[smallest].size() >=
+            m_islands[fullest].models)
+        {
+            break;
+        }
+        for (std::size_t k = 0; k < groups[smallest].size(); k++)
+        {
+            migrate(groups[smallest][k], emptiest);
+        }
+        islandOfGroup[smallest] = emptiest;
+    }
+}
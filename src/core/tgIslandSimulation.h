@@ -0,0 +1,264 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_ISLAND_SIMULATION_H
+#define TG_ISLAND_SIMULATION_H
+
+/**
+ * @file tgIslandSimulation.h
+ * @brief Contains the definition of class tgIslandSimulation
+ * $Id$
+ */
+
+// This application
+#include "tgWorld.h"
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+// POSIX threads
+#include <pthread.h>
+
+// Forward declarations
+class tgGround;
+class tgModel;
+class tgSimulation;
+class tgSimView;
+
+/**
+ * A scene of many robots, such as a swarm of SUPERballs, split into
+ * spatial islands that step in parallel. Each island is a world of its
+ * own, with its own broadphase, so robots far apart cost nothing to
+ * each other and the steps scale with the cores rather than slowing
+ * with the number of robots.
+ *
+ * Every regroupInterval steps the robots' bounds are compared. Robots
+ * within margin of each other, directly or through others, are put in
+ * one island, so any that might touch collide as in a single world,
+ * and groups are then spread over the islands to even out their
+ * sizes. Robots change islands with tgSimulation::moveModel, keeping
+ * their bodies, velocities and controllers, so a robot that leaves a
+ * group is split off again at the next regrouping.
+ *
+ * Every island has its own ground, from the GroundFactory, which must
+ * make the same ground each time for a robot's surroundings not to
+ * change as it moves. Robots with contact cables or constraints cannot
+ * change islands. As with tgParallelSimulation, build Bullet and NTRT
+ * with -DBT_NO_PROFILE.
+ */
+class tgIslandSimulation
+{
+public:
+
+    /** Makes each island's ground */
+    class GroundFactory
+    {
+    public:
+
+        virtual ~GroundFactory() { }
+
+        /**
+         * Create the ground of one island. The island's world takes
+         * ownership. The default is a tgBoxGround.
+         */
+        virtual tgGround* createGround();
+    };
+
+    /**
+     * This is Plain Old Data.
+     */
+    struct Config
+    {
+        /**
+         * @throw std::invalid_argument if ss is not positive, m is
+         * negative or ri is zero
+         */
+        Config(const tgWorld::Config& wc = tgWorld::Config(),
+               double ss = 1.0/1000.0,
+               std::size_t is = 0,
+               double m = 1.0,
+               std::size_t ri = 100);
+
+        /** The configuration of every island's world */
+        tgWorld::Config worldConfig;
+
+        /** The timestep, in seconds. Must be positive. */
+        double stepSize;
+
+        /** The number of islands; 0 for one per processor */
+        std::size_t islands;
+
+        /**
+         * Robots whose bounds come closer than this share an island. It
+         * should cover how far a robot can travel in regroupInterval
+         * steps.
+         */
+        double margin;
+
+        /** Steps between regroupings. Must be positive. */
+        std::size_t regroupInterval;
+    };
+
+    /**
+     * Build the islands' worlds and start a thread for each island
+     * after the first, which is stepped by the calling thread.
+     * @param[in] config the configuration of every island
+     * @param[in] pGrounds if not NULL, must outlive this object
+     * @throw std::runtime_error if a thread could not be started
+     */
+    tgIslandSimulation(const Config& config, GroundFactory* pGrounds = NULL);
+
+    /**
+     * Stop the threads, and tear down and delete the islands and their
+     * models.
+     */
+    ~tgIslandSimulation();
+
+    /**
+     * Set up a robot in the island with the fewest, then regroup so it
+     * joins any robot it was placed near. We take ownership.
+     * @throw std::invalid_argument if pModel is NULL
+     */
+    void addModel(tgModel* pModel);
+
+    /**
+     * Step every island once, in parallel, regrouping every
+     * regroupInterval steps.
+     * @throw std::runtime_error if an island's step threw; the others
+     * still step
+     */
+    void step();
+
+    /** step() the given number of times */
+    void run(std::size_t steps);
+
+    /**
+     * Put robots near each other in the same island and spread the
+     * groups over the islands. Called by step; call it after moving
+     * robots by hand.
+     */
+    void regroup();
+
+    /** The number of islands */
+    std::size_t size() const
+    {
+        return m_islands.size();
+    }
+
+    /** The number of robots */
+    std::size_t modelCount() const
+    {
+        return m_models.size();
+    }
+
+    /** The robot added i-th */
+    tgModel& getModel(std::size_t i) const
+    {
+        return *m_models.at(i);
+    }
+
+    /** The island a robot is in */
+    std::size_t islandOf(std::size_t model) const
+    {
+        return m_islandOf.at(model);
+    }
+
+    /** An island's simulation, e.g. to render it or add obstacles */
+    tgSimulation& getSimulation(std::size_t island) const;
+
+    /** The times robots have changed islands */
+    std::size_t getMigrations() const
+    {
+        return m_migrations;
+    }
+
+private:
+
+    /** One island's world and the thread that steps it */
+    struct Island
+    {
+        tgWorld* pWorld;
+        tgSimView* pView;
+        tgSimulation* pSimulation;
+        /** The robots in this island */
+        std::size_t models;
+        pthread_t thread;
+        /** The last batch this island has stepped */
+        unsigned long batch;
+        tgIslandSimulation* pOwner;
+    };
+
+    /** Step one island, recording the first error */
+    void stepIsland(Island& island);
+
+    /** The worker loop of an island after the first */
+    void work(Island& island);
+
+    /** pthread entry point; arg is an Island */
+    static void* workerMain(void* arg);
+
+    /** Move a robot and keep the counts */
+    void migrate(std::size_t model, std::size_t island);
+
+    /**
+     * The bounds of a robot's bodies
+     * @return false if it has none
+     */
+    bool bounds(const tgModel& model, btVector3& min, btVector3& max) const;
+
+    /** Not copyable */
+    tgIslandSimulation(const tgIslandSimulation&);
+    tgIslandSimulation& operator=(const tgIslandSimulation&);
+
+private:
+
+    const Config m_config;
+
+    /** We own the worlds, views and simulations */
+    std::vector<Island> m_islands;
+
+    /** The robots, in the order added; the islands' simulations own them */
+    std::vector<tgModel*> m_models;
+
+    /** Indexed like m_models */
+    std::vector<std::size_t> m_islandOf;
+
+    std::size_t m_steps;
+    std::size_t m_migrations;
+
+    /** Guards everything below */
+    pthread_mutex_t m_mutex;
+
+    /** Signalled when a batch starts or the workers should exit */
+    pthread_cond_t m_workReady;
+
+    /** Signalled when the last worker of a batch finishes */
+    pthread_cond_t m_workDone;
+
+    unsigned long m_batch;
+    std::size_t m_finishedIslands;
+
+    /** The first error thrown in the current batch */
+    std::string m_error;
+
+    bool m_shutdown;
+};
+
+#endif  // TG_ISLAND_SIMULATION_H
@@ -27,6 +27,7 @@
 #include "tgKinematicActuator.h"
 // The NTRT Core libary
 #include "core/tgBulletSpringCable.h"
+#include "core/tgKinematicMotorBank.h"
 #include "core/tgModelVisitor.h"
 #include "core/tgWorld.h"
 // The Bullet Physics Library
@@ -103,7 +104,10 @@ tgKinematicActuator::tgKinematicActuator(tgBulletSpringCable* muscle,
                    tgKinematicActuator::Config& config) :
     m_motorVel(0.0),
     m_motorAcc(0.0),
+    m_desiredTorque(0.0),
     m_appliedTorque(0.0),
+    m_pMotorBank(NULL),
+    m_motorIndex(0),
     m_config(config),
     tgSpringCableActuator(muscle, tags, config)
 {
@@ -117,6 +121,50 @@ tgKinematicActuator::~tgKinematicActuator()
 {
     //std::cout << "deleting kinematic spring cable" << std::endl;
     // Should have already torn down.
+    if (m_pMotorBank != NULL)
+    {
+        m_pMotorBank->remove(this);
+    }
+}
+
+double& tgKinematicActuator::motorVel()
+{
+    return m_pMotorBank ? m_pMotorBank->m_motorVel[m_motorIndex] : m_motorVel;
+}
+
+double tgKinematicActuator::motorVel() const
+{
+    return m_pMotorBank ? m_pMotorBank->m_motorVel[m_motorIndex] : m_motorVel;
+}
+
+double& tgKinematicActuator::motorAcc()
+{
+    return m_pMotorBank ? m_pMotorBank->m_motorAcc[m_motorIndex] : m_motorAcc;
+}
+
+double tgKinematicActuator::motorAcc() const
+{
+    return m_pMotorBank ? m_pMotorBank->m_motorAcc[m_motorIndex] : m_motorAcc;
+}
+
+double& tgKinematicActuator::desiredTorque()
+{
+    return m_pMotorBank ? m_pMotorBank->m_desiredTorque[m_motorIndex] : m_desiredTorque;
+}
+
+double tgKinematicActuator::desiredTorque() const
+{
+    return m_pMotorBank ? m_pMotorBank->m_desiredTorque[m_motorIndex] : m_desiredTorque;
+}
+
+double& tgKinematicActuator::appliedTorque()
+{
+    return m_pMotorBank ? m_pMotorBank->m_appliedTorque[m_motorIndex] : m_appliedTorque;
+}
+
+double tgKinematicActuator::appliedTorque() const
+{
+    return m_pMotorBank ? m_pMotorBank->m_appliedTorque[m_motorIndex] : m_appliedTorque;
 }
     
 void tgKinematicActuator::setup(tgWorld& world)
@@ -134,26 +182,31 @@ void tgKinematicActuator::teardown()
     
 void tgKinematicActuator::step(double dt) 
 {
-#ifndef BT_NO_PROFILE 
-    BT_PROFILE("tgKinematicActuator::step");
-#endif //BT_NO_PROFILE   	
     if (dt <= 0.0)
     {
         throw std::invalid_argument("dt is not positive.");
     }
     else
     {   
-        // Want to update any controls before applying forces
-        notifyStep(dt); 
-        // Adjust rest length based on muscle dynamics
-        integrateRestLength(dt);
-        m_springCable->step(dt);
-        logHistory();  
+        stepActuator(dt);
         tgModel::step(dt);
     }
+}
+
+void tgKinematicActuator::stepActuator(double dt)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgKinematicActuator::step");
+#endif //BT_NO_PROFILE   	
+    // Want to update any controls before applying forces
+    notifyStep(dt); 
+    // Adjust rest length based on muscle dynamics
+    integrateRestLength(dt);
+    m_springCable->step(dt);
+    logHistory();  
     
     // Reset and wait for next control input
-    m_desiredTorque = 0.0;
+    desiredTorque() = 0.0;
 }
 
 void tgKinematicActuator::onVisit(const tgModelVisitor& r) const
@@ -168,42 +221,50 @@ void tgKinematicActuator::logHistory()
 {
     m_prevVelocity = getVelocity();
 
+    m_stats.update(m_springCable->getRestLength(),
+                   m_springCable->getActualLength(),
+                   appliedTorque());
+
     if (m_config.hist)
     {
         m_pHistory->lastLengths.push_back(m_springCable->getActualLength());
-        m_pHistory->lastVelocities.push_back(m_motorVel);
+        m_pHistory->lastVelocities.push_back(motorVel());
         m_pHistory->dampingHistory.push_back(m_springCable->getDamping());
         m_pHistory->restLengths.push_back(m_springCable->getRestLength());
-        m_pHistory->tensionHistory.push_back(m_appliedTorque);
+        m_pHistory->tensionHistory.push_back(appliedTorque());
     }
+    raiseEvents();
 }
     
 const double tgKinematicActuator::getVelocity() const
 {
-    return m_motorVel * m_config.radius;
+    return motorVel() * m_config.radius;
 }
 
 void tgKinematicActuator::integrateRestLength(double dt)
 {
 	double tension = getTension();
-	m_appliedTorque = getAppliedTorque(m_desiredTorque);
+	double& motorVel = this->motorVel();
+	double& appliedTorque = this->appliedTorque();
+	double& motorAcc = this->motorAcc();
+	appliedTorque = getAppliedTorque(desiredTorque());
 	// motorVel will always cause opposite acc, but tension can only
 	// cause lengthening (positive Acc)
-	m_motorAcc = (m_appliedTorque - m_config.motorFriction * m_motorVel 
+	motorAcc = (appliedTorque - m_config.motorFriction * motorVel 
 					+ tension * m_config.radius) / m_config.motorInertia;
 	
-	if (!m_config.backdrivable && m_motorAcc * m_appliedTorque <= 0.0)
+	if (!m_config.backdrivable && motorAcc * appliedTorque <= 0.0)
 	{
 		// Stop undesired lengthing if the motor is not backdrivable
-		m_motorVel = m_motorVel + m_motorAcc * dt > 0.0 ? 0.0 : m_motorVel + m_motorAcc * dt;
+		motorVel = motorVel + motorAcc * dt > 0.0 ? 0.0 : motorVel + motorAcc * dt;
 	}
 	else
 	{
-		m_motorVel += m_motorAcc * dt;
+		motorVel += motorAcc * dt;
 	}
 	
 	// semi-implicit Euler integration
-	m_restLength += m_config.radius * m_motorVel * dt; 
+	m_restLength += m_config.radius * motorVel * dt; 
 	
 	/// @todo check min actual length somewhere
 	
@@ -216,7 +277,7 @@ void tgKinematicActuator::integrateRestLength(double dt)
 double tgKinematicActuator::getAppliedTorque(double desiredTorque) const
 { 
 	double maxTorque = m_config.maxTens * m_config.radius * 
-						(1.0 - m_config.radius * abs(m_motorVel) / m_config.targetVelocity);
+						(1.0 - m_config.radius * abs(motorVel()) / m_config.targetVelocity);
 	
 	maxTorque = maxTorque < 0.0 ? 0.0 : maxTorque;
 	
@@ -226,7 +287,7 @@ double tgKinematicActuator::getAppliedTorque(double desiredTorque) const
 
 void tgKinematicActuator::setControlInput(double input)
 {
-	m_desiredTorque = input;
+	desiredTorque() = input;
 }
 
 const tgSpringCableActuator::SpringCableActuatorHistory& tgKinematicActuator::getHistory() const
@@ -234,6 +295,83 @@ const tgSpringCableActuator::SpringCableActuatorHistory& tgKinematicActuator::ge
     return *m_pHistory;
 }
 
+void tgKinematicActuator::setParameters(const tgSpringCableActuator::Config& config)
+{
+    tgKinematicActuator::Config full(m_config);
+    static_cast<tgSpringCableActuator::Config&>(full) = config;
+    setParameters(full);
+}
+
+void tgKinematicActuator::setParameters(const tgKinematicActuator::Config& config)
+{
+    // The same checks as Config's constructor
+    if (config.radius <= 0.0)
+    {
+        throw std::invalid_argument("Radius is non-positive");
+    }
+    else if (config.motorFriction < 0.0)
+    {
+        throw std::invalid_argument("Motor friction is negative.");
+    }
+    else if (config.motorInertia <= 0.0)
+    {
+        throw std::invalid_argument("Motor inertia is non-positive");
+    }
+    
+    // Checks and applies the cable parameters, keeping the ones fixed
+    // at construction
+    tgSpringCableActuator::setParameters(config);
+    
+    static_cast<tgSpringCableActuator::Config&>(m_config) = getConfig();
+    m_config.radius = config.radius;
+    m_config.motorFriction = config.motorFriction;
+    m_config.motorInertia = config.motorInertia;
+    m_config.backdrivable = config.backdrivable;
+    m_config.maxOmega = m_config.targetVelocity / m_config.radius;
+    m_config.maxTorque = m_config.maxTens / m_config.radius;
+    
+    if (m_pMotorBank != NULL)
+    {
+        m_pMotorBank->updateConfig(m_motorIndex);
+    }
+    
+    // Postcondition
+    assert(invariant());
+}
+
+void tgKinematicActuator::saveState(std::vector<double>& state) const
+{
+    tgSpringCableActuator::saveState(state);
+    state.push_back(prevVel);
+    state.push_back(motorVel());
+    state.push_back(motorAcc());
+    state.push_back(appliedTorque());
+}
+
+std::size_t tgKinematicActuator::restoreState(const std::vector<double>& state, std::size_t pos)
+{
+    pos = tgSpringCableActuator::restoreState(state, pos);
+    assert(pos + 4 <= state.size());
+    prevVel = state[pos++];
+    motorVel() = state[pos++];
+    motorAcc() = state[pos++];
+    appliedTorque() = state[pos++];
+    return pos;
+}
+
+void tgKinematicActuator::saveCommand(std::vector<double>& command) const
+{
+    command.push_back(desiredTorque());
+}
+
+std::size_t tgKinematicActuator::restoreCommand(const std::vector<double>& command,
+                                                std::size_t pos)
+{
+    assert(pos + 1 <= command.size());
+    desiredTorque() = command[pos++];
+    return pos;
+}
+
 bool tgKinematicActuator::invariant() const
 {
     return
@@ -33,6 +33,7 @@
 
 // Forward declarations
 class tgBulletSpringCable;
+class tgKinematicMotorBank;
 class tgModelVisitor;
 class tgWorld;
 
@@ -165,12 +166,58 @@ public:
 	 * check it here.
 	 */
 	virtual void setControlInput(double input);
+    
+    /**
+     * Keeps the motor parameters, which the overload below also sets.
+     * @see tgSpringCableActuator::setParameters
+     */
+    virtual void setParameters(const tgSpringCableActuator::Config& config);
+    
+    /**
+     * Apply new cable and motor parameters to the live actuator. The
+     * motor state is kept.
+     * @see tgSpringCableActuator::setParameters
+     * @throw std::invalid_argument if a value is out of range
+     */
+    void setParameters(const tgKinematicActuator::Config& config);
+    
+    /**
+     * Adds the motor state to tgSpringCableActuator::saveState
+     * @param[in,out] state the values are appended to this
+     */
+    virtual void saveState(std::vector<double>& state) const;
+    
+    /**
+     * Reads back what saveState wrote
+     * @param[in] state as filled by saveState
+     * @param[in] pos the index of this actuator's first value
+     * @return the index just past this actuator's values
+     */
+    virtual std::size_t restoreState(const std::vector<double>& state, std::size_t pos);
+
+    /** The desired torque, the one input setControlInput takes */
+    virtual void saveCommand(std::vector<double>& command) const;
+
+    virtual std::size_t restoreCommand(const std::vector<double>& command,
+                                       std::size_t pos);
 	
 protected:
 	
 	virtual void integrateRestLength(double dt);
 private:
 
+    /** tgStepPlan calls stepActuator directly */
+    friend class tgStepPlan;
+
+    /** The bank moves the motor state in and out */
+    friend class tgKinematicMotorBank;
+
+    /**
+     * Everything step does except checking dt and stepping children.
+     * @param[in] dt, must be positive
+     */
+    void stepActuator(double dt);
+
     /**
      * Helper function to perform what is in common to all constructor bodies.
      */
@@ -185,6 +232,19 @@ private:
     /** Integrity predicate. */
     bool invariant() const;
     
+    /**
+     * The motor state, in m_pMotorBank if the actuator is in one and in
+     * the members below otherwise.
+     */
+    double& motorVel();
+    double motorVel() const;
+    double& motorAcc();
+    double motorAcc() const;
+    double& desiredTorque();
+    double desiredTorque() const;
+    double& appliedTorque();
+    double appliedTorque() const;
+    
     /**
      * Hold the previous value so history can be turned off
      */
@@ -207,6 +267,12 @@ private:
     
     double m_appliedTorque;
     
+    /** The bank holding the motor state, or NULL */
+    tgKinematicMotorBank* m_pMotorBank;
+    
+    /** The index of this actuator in m_pMotorBank */
+    std::size_t m_motorIndex;
+    
     /**
      * Override the base config to get the extra parameters
      */
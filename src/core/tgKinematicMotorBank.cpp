@@ -0,0 +1,204 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgKinematicMotorBank.cpp
+ * @brief Contains the definitions of members of class tgKinematicMotorBank
+ * $Id$
+ */
+
+// This module
+#include "tgKinematicMotorBank.h"
+// This application
+#include "tgKinematicActuator.h"
+#include "tgSpringCable.h"
+// The C++ Standard Library
+#include <cassert>
+#include <cmath>
+
+tgKinematicMotorBank::tgKinematicMotorBank()
+{
+}
+
+tgKinematicMotorBank::tgKinematicMotorBank(const tgKinematicMotorBank&)
+{
+}
+
+tgKinematicMotorBank& tgKinematicMotorBank::operator=(const tgKinematicMotorBank& other)
+{
+    if (this != &other)
+    {
+        clear();
+    }
+    return *this;
+}
+
+tgKinematicMotorBank::~tgKinematicMotorBank()
+{
+    clear();
+}
+
+void tgKinematicMotorBank::add(tgKinematicActuator* pActuator)
+{
+    assert(pActuator != NULL);
+    assert(pActuator->m_pMotorBank != this);
+    if (pActuator->m_pMotorBank != NULL)
+    {
+        pActuator->m_pMotorBank->remove(pActuator);
+    }
+
+    const tgKinematicActuator::Config& config = pActuator->m_config;
+    m_actuators.push_back(pActuator);
+    m_radius.push_back(config.radius);
+    m_motorFriction.push_back(config.motorFriction);
+    m_motorInertia.push_back(config.motorInertia);
+    m_maxTens.push_back(config.maxTens);
+    m_targetVelocity.push_back(config.targetVelocity);
+    m_minRestLength.push_back(config.minRestLength);
+    m_backdrivable.push_back(config.backdrivable);
+    m_motorVel.push_back(pActuator->m_motorVel);
+    m_motorAcc.push_back(pActuator->m_motorAcc);
+    m_desiredTorque.push_back(pActuator->m_desiredTorque);
+    m_appliedTorque.push_back(pActuator->m_appliedTorque);
+
+    pActuator->m_pMotorBank = this;
+    pActuator->m_motorIndex = m_actuators.size() - 1;
+}
+
+void tgKinematicMotorBank::updateConfig(std::size_t i)
+{
+    assert(i < m_actuators.size());
+    const tgKinematicActuator::Config& config = m_actuators[i]->m_config;
+    m_radius[i] = config.radius;
+    m_motorFriction[i] = config.motorFriction;
+    m_motorInertia[i] = config.motorInertia;
+    m_maxTens[i] = config.maxTens;
+    m_targetVelocity[i] = config.targetVelocity;
+    m_minRestLength[i] = config.minRestLength;
+    m_backdrivable[i] = config.backdrivable;
+}
+
+void tgKinematicMotorBank::remove(tgKinematicActuator* pActuator)
+{
+    assert(pActuator != NULL);
+    assert(pActuator->m_pMotorBank == this);
+    const std::size_t i = pActuator->m_motorIndex;
+    assert(i < m_actuators.size() && m_actuators[i] == pActuator);
+
+    pActuator->m_motorVel = m_motorVel[i];
+    pActuator->m_motorAcc = m_motorAcc[i];
+    pActuator->m_desiredTorque = m_desiredTorque[i];
+    pActuator->m_appliedTorque = m_appliedTorque[i];
+    pActuator->m_pMotorBank = NULL;
+
+    // Move the last actuator into the hole
+    const std::size_t last = m_actuators.size() - 1;
+    if (i != last)
+    {
+        m_actuators[i] = m_actuators[last];
+        m_radius[i] = m_radius[last];
+        m_motorFriction[i] = m_motorFriction[last];
+        m_motorInertia[i] = m_motorInertia[last];
+        m_maxTens[i] = m_maxTens[last];
+        m_targetVelocity[i] = m_targetVelocity[last];
+        m_minRestLength[i] = m_minRestLength[last];
+        m_backdrivable[i] = m_backdrivable[last];
+        m_motorVel[i] = m_motorVel[last];
+        m_motorAcc[i] = m_motorAcc[last];
+        m_desiredTorque[i] = m_desiredTorque[last];
+        m_appliedTorque[i] = m_appliedTorque[last];
+        m_actuators[i]->m_motorIndex = i;
+    }
+    m_actuators.pop_back();
+    m_radius.pop_back();
+    m_motorFriction.pop_back();
+    m_motorInertia.pop_back();
+    m_maxTens.pop_back();
+    m_targetVelocity.pop_back();
+    m_minRestLength.pop_back();
+    m_backdrivable.pop_back();
+    m_motorVel.pop_back();
+    m_motorAcc.pop_back();
+    m_desiredTorque.pop_back();
+    m_appliedTorque.pop_back();
+}
+
+void tgKinematicMotorBank::clear()
+{
+    while (!m_actuators.empty())
+    {
+        remove(m_actuators.back());
+    }
+}
+
+void tgKinematicMotorBank::integrate(std::size_t begin, std::size_t end, double dt)
+{
+    assert(begin <= end && end <= m_actuators.size());
+    assert(dt > 0.0);
+
+    m_tension.resize(m_actuators.size());
+    m_restLength.resize(m_actuators.size());
+    for (std::size_t i = begin; i != end; i++)
+    {
+        const tgKinematicActuator& actuator = *m_actuators[i];
+        m_tension[i] = actuator.m_springCable->getTension();
+        m_restLength[i] = actuator.m_restLength;
+    }
+
+    for (std::size_t i = begin; i != end; i++)
+    {
+        const double radius = m_radius[i];
+
+        // tgKinematicActuator::getAppliedTorque
+        double maxTorque = m_maxTens[i] * radius *
+            (1.0 - radius * std::abs(m_motorVel[i]) / m_targetVelocity[i]);
+        maxTorque = maxTorque < 0.0 ? 0.0 : maxTorque;
+        const double desired = m_desiredTorque[i];
+        const double applied = std::abs(desired) < maxTorque ? desired :
+            desired / std::abs(desired) * maxTorque;
+        m_appliedTorque[i] = applied;
+
+        // tgKinematicActuator::integrateRestLength
+        const double acc = (applied - m_motorFriction[i] * m_motorVel[i]
+                            + m_tension[i] * radius) / m_motorInertia[i];
+        m_motorAcc[i] = acc;
+        if (!m_backdrivable[i] && acc * applied <= 0.0)
+        {
+            const double vel = m_motorVel[i] + acc * dt;
+            m_motorVel[i] = vel > 0.0 ? 0.0 : vel;
+        }
+        else
+        {
+            m_motorVel[i] += acc * dt;
+        }
+
+        const double restLength = m_restLength[i] + radius * m_motorVel[i] * dt;
+        m_restLength[i] =
+            restLength > m_minRestLength[i] ? restLength : m_minRestLength[i];
+
+        // Wait for the next control input
+        m_desiredTorque[i] = 0.0;
+    }
+
+    for (std::size_t i = begin; i != end; i++)
+    {
+        tgKinematicActuator& actuator = *m_actuators[i];
+        actuator.m_restLength = m_restLength[i];
+        actuator.m_springCable->setRestLength(m_restLength[i]);
+    }
+}
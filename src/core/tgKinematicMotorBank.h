@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_KINEMATIC_MOTOR_BANK_H
+#define TG_KINEMATIC_MOTOR_BANK_H
+
+/**
+ * @file tgKinematicMotorBank.h
+ * @brief Contains the definition of class tgKinematicMotorBank
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <vector>
+
+// Forward declarations
+class tgKinematicActuator;
+
+/**
+ * The motor state of a set of tgKinematicActuators in structure-of-arrays
+ * form, so their rest lengths are integrated in one loop rather than one
+ * virtual integrateRestLength call each.
+ *
+ * While an actuator is in a bank, its motor velocity, acceleration,
+ * desired and applied torque live here and the actuator reads and writes
+ * them through its index, so getVelocity, setControlInput and
+ * saveState see the same values either way. The rest length stays with
+ * the actuator and is gathered on every integrate. Removing an actuator,
+ * including by deleting it, copies its state back.
+ *
+ * tgStepPlan keeps a bank for the kinematic actuators it steps.
+ */
+class tgKinematicMotorBank
+{
+public:
+
+    tgKinematicMotorBank();
+
+    /** A copy starts empty: an actuator belongs to one bank at a time. */
+    tgKinematicMotorBank(const tgKinematicMotorBank&);
+
+    /** Empties this bank; nothing is taken from the other. */
+    tgKinematicMotorBank& operator=(const tgKinematicMotorBank&);
+
+    /** Remove every actuator */
+    ~tgKinematicMotorBank();
+
+    /**
+     * Move an actuator's motor state into this bank, taking it out of
+     * any other bank first. Its index is size() before the call.
+     * @param[in,out] pActuator must not be NULL or already in this bank
+     */
+    void add(tgKinematicActuator* pActuator);
+
+    /**
+     * Move an actuator's motor state back into the actuator. The last
+     * actuator takes its index.
+     * @param[in,out] pActuator must be in this bank
+     */
+    void remove(tgKinematicActuator* pActuator);
+
+    /** Remove every actuator */
+    void clear();
+
+    /** The number of actuators in the bank */
+    std::size_t size() const
+    {
+        return m_actuators.size();
+    }
+
+    /**
+     * Integrate the rest lengths of actuators begin up to end with the
+     * same arithmetic as tgKinematicActuator::integrateRestLength, and
+     * zero their desired torques as stepActuator does.
+     * @param[in] begin the first index
+     * @param[in] end one past the last index, at most size()
+     * @param[in] dt must be positive
+     */
+    void integrate(std::size_t begin, std::size_t end, double dt);
+
+private:
+
+    /** tgKinematicActuator reads and writes its state here */
+    friend class tgKinematicActuator;
+
+    /**
+     * Copy an actuator's motor parameters again after
+     * tgKinematicActuator::setParameters changed them.
+     * @param[in] i the actuator's index
+     */
+    void updateConfig(std::size_t i);
+
+    std::vector<tgKinematicActuator*> m_actuators;
+
+    /** Constants from each actuator's config */
+    std::vector<double> m_radius;
+    std::vector<double> m_motorFriction;
+    std::vector<double> m_motorInertia;
+    std::vector<double> m_maxTens;
+    std::vector<double> m_targetVelocity;
+    std::vector<double> m_minRestLength;
+    std::vector<char> m_backdrivable;
+
+    /** State, in the units of the tgKinematicActuator members */
+    std::vector<double> m_motorVel;
+    std::vector<double> m_motorAcc;
+    std::vector<double> m_desiredTorque;
+    std::vector<double> m_appliedTorque;
+
+    /** Gathered on each integrate */
+    std::vector<double> m_tension;
+    std::vector<double> m_restLength;
+};
+
+#endif  // TG_KINEMATIC_MOTOR_BANK_H
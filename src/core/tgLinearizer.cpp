@@ -0,0 +1,342 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgLinearizer.cpp
+ * @brief Contains the definitions of members of class tgLinearizer
+ * $Id$
+ */
+
+// This module
+#include "tgLinearizer.h"
+// This application
+#include "tgBasicActuator.h"
+#include "tgCast.h"
+#include "tgSimulation.h"
+#include "tgSpringCableActuator.h"
+#include "terrain/tgBoxGround.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btMatrix3x3.h"
+#include "LinearMath/btQuaternion.h"
+// The C++ Standard Library
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    /**
+     * The rotation vector of a rotation matrix. Taken from the
+     * quaternion's vector part rather than its angle, which loses half
+     * the precision of the small rotations the differences are made of.
+     */
+    btVector3 rotationVector(const btMatrix3x3& rotation)
+    {
+        btQuaternion q;
+        rotation.getRotation(q);
+        if (q.getW() < 0.0)
+        {
+            q = -q;
+        }
+        const btVector3 v(q.getX(), q.getY(), q.getZ());
+        const double s = v.length();
+        if (s == 0.0)
+        {
+            return btVector3(0.0, 0.0, 0.0);
+        }
+        return v * (2.0 * std::atan2(s, (double) q.getW()) / s);
+    }
+
+    /** Write a body's 12 values of x into state */
+    void putBody(double* state, const btVector3& position,
+                 const btVector3& rotation, const btVector3& linearVelocity,
+                 const btVector3& angularVelocity)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            state[i] = position[i];
+            state[3 + i] = rotation[i];
+            state[6 + i] = linearVelocity[i];
+            state[9 + i] = angularVelocity[i];
+        }
+    }
+}
+
+/** Hands the pool's calls on to the linearizer */
+class tgLinearizer::Branch : public tgForkPool::Branch
+{
+public:
+    Branch(tgLinearizer& o, Model& m) :
+        owner(o),
+        model(m),
+        pSimulation(NULL)
+    {
+    }
+
+    virtual tgGround* createGround()
+    {
+        return model.createGround();
+    }
+
+    virtual void setup(tgSimulation& simulation)
+    {
+        pSimulation = &simulation;
+        model.setup(simulation);
+    }
+
+    virtual void onFork(std::size_t branch)
+    {
+        owner.onFork(branch);
+    }
+
+    virtual void endRollout(std::size_t branch)
+    {
+        owner.endRollout(branch);
+    }
+
+    tgLinearizer& owner;
+    Model& model;
+
+    /** Set by setup, on the branch's thread */
+    tgSimulation* pSimulation;
+};
+
+tgGround* tgLinearizer::Model::createGround()
+{
+    return new tgBoxGround();
+}
+
+tgLinearizer::Config::Config(const tgWorld::Config& wc, double ss, int st,
+                             std::size_t br, double sd, double id) :
+worldConfig(wc),
+stepSize(ss),
+steps(st),
+branches(br),
+stateDelta(sd),
+inputDelta(id)
+{
+    if (ss <= 0.0)
+    {
+        throw std::invalid_argument("stepSize is not positive");
+    }
+    else if (st <= 0)
+    {
+        throw std::invalid_argument("steps is not positive");
+    }
+    else if (br == 0)
+    {
+        throw std::invalid_argument("branches is not positive");
+    }
+    else if (sd <= 0.0 || id <= 0.0)
+    {
+        throw std::invalid_argument("Perturbation is not positive");
+    }
+}
+
+tgLinearizer::tgLinearizer(const Config& config, Model& model) :
+m_config(config),
+m_pPool(NULL),
+m_perturbed(config.branches),
+m_commands(config.branches),
+m_fork(0),
+m_stateSize(0),
+m_inputSize(0),
+m_bodyCount(0)
+{
+    for (std::size_t i = 0; i < config.branches; i++)
+    {
+        m_branches.push_back(new Branch(*this, model));
+    }
+    const std::vector<tgForkPool::Branch*> branches(m_branches.begin(),
+                                                    m_branches.end());
+    try
+    {
+        m_pPool = new tgForkPool(
+            tgForkPool::Config(config.worldConfig, config.stepSize), branches);
+    }
+    catch (...)
+    {
+        for (std::size_t i = 0; i < m_branches.size(); i++)
+        {
+            delete m_branches[i];
+        }
+        throw;
+    }
+}
+
+tgLinearizer::~tgLinearizer()
+{
+    // The pool's threads call the branches until it is gone
+    delete m_pPool;
+    for (std::size_t i = 0; i < m_branches.size(); i++)
+    {
+        delete m_branches[i];
+    }
+}
+
+void tgLinearizer::linearize(const tgSimulation& source)
+{
+    source.snapshot(m_source);
+    m_bodyCount = m_source.bodies.size();
+    m_stateSize = 12 * m_bodyCount;
+    m_inputs.clear();
+    for (std::size_t i = 0; i < m_source.actuators.size(); i++)
+    {
+        if (tgCast::cast<tgSpringCableActuator, tgBasicActuator>(m_source.actuators[i]))
+        {
+            m_inputs.push_back(i);
+        }
+    }
+    m_inputSize = m_inputs.size();
+
+    const std::size_t columns = 1 + m_stateSize + m_inputSize;
+    m_ends.resize(columns * m_bodyCount);
+    m_A.resize(m_stateSize * m_stateSize);
+    m_B.resize(m_stateSize * m_inputSize);
+    m_nominal.resize(m_stateSize);
+    if (m_bodyCount == 0)
+    {
+        return;
+    }
+
+    const std::size_t forks =
+        (columns + m_branches.size() - 1) / m_branches.size();
+    for (m_fork = 0; m_fork < forks; m_fork++)
+    {
+        m_pPool->fork(source, m_config.steps);
+    }
+
+    const BodyEnd* const nominal = &m_ends[0];
+    for (std::size_t i = 0; i < m_bodyCount; i++)
+    {
+        const BodyEnd& end = nominal[i];
+        putBody(&m_nominal[12 * i], end.transform.getOrigin(),
+                rotationVector(end.transform.getBasis()),
+                end.linearVelocity, end.angularVelocity);
+    }
+
+    // Column c of [A B] is the change in x' of rollout c + 1
+    for (std::size_t c = 0; c + 1 < columns; c++)
+    {
+        const BodyEnd* const perturbed = &m_ends[(c + 1) * m_bodyCount];
+        const bool isState = c < m_stateSize;
+        const double delta = isState ? m_config.stateDelta : m_config.inputDelta;
+        for (std::size_t i = 0; i < m_bodyCount; i++)
+        {
+            const btTransform& t0 = nominal[i].transform;
+            const btTransform& t1 = perturbed[i].transform;
+            double change[12];
+            putBody(change, t1.getOrigin() - t0.getOrigin(),
+                    rotationVector(t1.getBasis() * t0.getBasis().transpose()),
+                    perturbed[i].linearVelocity - nominal[i].linearVelocity,
+                    perturbed[i].angularVelocity - nominal[i].angularVelocity);
+            for (std::size_t k = 0; k < 12; k++)
+            {
+                const std::size_t row = 12 * i + k;
+                if (isState)
+                {
+                    m_A[row * m_stateSize + c] = change[k] / delta;
+                }
+                else
+                {
+                    m_B[row * m_inputSize + c - m_stateSize] = change[k] / delta;
+                }
+            }
+        }
+    }
+}
+
+void tgLinearizer::onFork(std::size_t branch)
+{
+    const std::size_t column = columnOf(branch);
+    if (column > m_stateSize + m_inputSize)
+    {
+        // A spare branch in the last fork
+        return;
+    }
+
+    // The branch's own bodies, to perturb and to read back afterwards
+    tgSimulation& simulation = *m_branches[branch]->pSimulation;
+    tgWorldSnapshot& state = m_perturbed[branch];
+    simulation.snapshot(state);
+    if (column == 0)
+    {
+        return;
+    }
+
+    if (column <= m_stateSize)
+    {
+        const std::size_t value = column - 1;
+        tgWorldSnapshot::BodyState& body = state.bodies[value / 12];
+        const std::size_t part = (value % 12) / 3;
+        btVector3 axis(0.0, 0.0, 0.0);
+        axis[value % 3] = 1.0;
+        const btVector3 change = axis * m_config.stateDelta;
+        switch (part)
+        {
+        case 0:
+            body.worldTransform.getOrigin() += change;
+            break;
+        case 1:
+            body.worldTransform.setBasis(
+                btMatrix3x3(btQuaternion(axis, m_config.stateDelta)) *
+                body.worldTransform.getBasis());
+            break;
+        case 2:
+            body.linearVelocity += change;
+            break;
+        default:
+            body.angularVelocity += change;
+            break;
+        }
+        simulation.restore(state);
+    }
+    else
+    {
+        // Both the target and the current rest length, so the motor
+        // holds the new length rather than moving to it
+        std::vector<double>& command = m_commands[branch];
+        tgBasicActuator* const pActuator =
+            tgCast::cast<tgSpringCableActuator, tgBasicActuator>(
+                state.actuators[m_inputs[column - 1 - m_stateSize]]);
+        command.clear();
+        pActuator->saveCommand(command);
+        command[0] += m_config.inputDelta;
+        command[1] += m_config.inputDelta;
+        pActuator->restoreCommand(command, 0);
+    }
+}
+
+void tgLinearizer::endRollout(std::size_t branch)
+{
+    const std::size_t column = columnOf(branch);
+    if (column > m_stateSize + m_inputSize)
+    {
+        return;
+    }
+    const std::vector<tgWorldSnapshot::BodyState>& bodies =
+        m_perturbed[branch].bodies;
+    BodyEnd* const ends = &m_ends[column * m_bodyCount];
+    for (std::size_t i = 0; i < m_bodyCount; i++)
+    {
+        const btRigidBody& body = *bodies[i].pBody;
+        ends[i].transform = body.getWorldTransform();
+        ends[i].linearVelocity = body.getLinearVelocity();
+        ends[i].angularVelocity = body.getAngularVelocity();
+    }
+}
@@ -0,0 +1,235 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_LINEARIZER_H
+#define TG_LINEARIZER_H
+
+/**
+ * @file tgLinearizer.h
+ * @brief Contains the definition of class tgLinearizer
+ * $Id$
+ */
+
+// This application
+#include "tgForkPool.h"
+#include "tgWorldSnapshot.h"
+// The Bullet Physics library
+#include "LinearMath/btTransform.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgGround;
+class tgSimulation;
+
+/**
+ * Finite-difference linearizations of a running simulation's dynamics,
+ * x' = A x + B u, for model-based controllers such as MPC and LQR.
+ *
+ * The state x is every dynamic rigid body's position, orientation,
+ * linear velocity and angular velocity, 12 values per body in the
+ * order of tgWorldSnapshot::bodies. Orientations are rotation vectors
+ * in the world frame, and differences between them are the rotation
+ * vector of the relative rotation. The input u is the rest length of
+ * every tgBasicActuator, in the order of tgWorldSnapshot::actuators,
+ * held for the rollout. x' is the state Config::steps steps later.
+ *
+ * Each column of A and B is a rollout from the source state with one
+ * value perturbed, and one more rollout is the nominal. They run on a
+ * tgForkPool, so the branches are built once and each linearization
+ * only restores state into them, Config::branches rollouts at a time.
+ * The branches should be built without controllers, so the columns are
+ * the open loop response.
+ */
+class tgLinearizer
+{
+public:
+
+    /**
+     * Builds the branches. setup is called once per branch, from the
+     * branches' own threads, so concurrently.
+     */
+    class Model
+    {
+    public:
+
+        virtual ~Model() { }
+
+        /** As tgForkPool::Branch::createGround */
+        virtual tgGround* createGround();
+
+        /**
+         * Create the same models as the source simulation, in the same
+         * order, and add them to the simulation.
+         */
+        virtual void setup(tgSimulation& simulation) = 0;
+    };
+
+    /**
+     * This is Plain Old Data.
+     */
+    struct Config
+    {
+        Config(const tgWorld::Config& wc = tgWorld::Config(),
+               double ss = 1.0/1000.0,
+               int st = 1,
+               std::size_t br = 4,
+               double sd = 1e-6,
+               double id = 1e-5);
+
+        /** The configuration of every branch's world */
+        tgWorld::Config worldConfig;
+
+        /** The timestep of the rollouts, in seconds. Must be positive. */
+        double stepSize;
+
+        /** The steps from x to x'. Must be positive. */
+        int steps;
+
+        /** The rollouts run at once. Must be positive. */
+        std::size_t branches;
+
+        /** The perturbation of each state value, in SI units */
+        double stateDelta;
+
+        /** The perturbation of each rest length, in length units */
+        double inputDelta;
+    };
+
+    /**
+     * Start the branches' threads and build their worlds.
+     * @param[in] config the configuration of every branch
+     * @param[in] model must outlive this object
+     * @throw std::invalid_argument if a value in config is out of range
+     * @throw std::runtime_error if a branch's setup threw
+     */
+    tgLinearizer(const Config& config, Model& model);
+
+    ~tgLinearizer();
+
+    /**
+     * Linearize around the source's current state. Does not allocate
+     * once the sizes are known.
+     * @param[in] source a simulation with the same models as the
+     * branches; it is not stepped
+     * @throw std::runtime_error if a rollout threw
+     */
+    void linearize(const tgSimulation& source);
+
+    /** The number of values in x, from the last linearize */
+    std::size_t stateSize() const
+    {
+        return m_stateSize;
+    }
+
+    /** The number of values in u, from the last linearize */
+    std::size_t inputSize() const
+    {
+        return m_inputSize;
+    }
+
+    /** A, stateSize() by stateSize(), row major */
+    const std::vector<double>& getA() const
+    {
+        return m_A;
+    }
+
+    /** B, stateSize() by inputSize(), row major */
+    const std::vector<double>& getB() const
+    {
+        return m_B;
+    }
+
+    /** x' of the nominal rollout, with absolute orientations */
+    const std::vector<double>& getNominal() const
+    {
+        return m_nominal;
+    }
+
+private:
+
+    /** The adapter from a tgForkPool::Branch to the model */
+    class Branch;
+
+    /** What is read back from each body after a rollout */
+    struct BodyEnd
+    {
+        btTransform transform;
+        btVector3 linearVelocity;
+        btVector3 angularVelocity;
+    };
+
+    /** Perturb the branch's state or input for its column */
+    void onFork(std::size_t branch);
+
+    /** Record the branch's bodies for its column */
+    void endRollout(std::size_t branch);
+
+    /**
+     * The column a branch rolls out in the current fork; 0 is the
+     * nominal, then the states, then the inputs
+     */
+    std::size_t columnOf(std::size_t branch) const
+    {
+        return m_fork * m_branches.size() + branch;
+    }
+
+    /** Not copyable */
+    tgLinearizer(const tgLinearizer&);
+    tgLinearizer& operator=(const tgLinearizer&);
+
+private:
+
+    const Config m_config;
+
+    /** We own these */
+    std::vector<Branch*> m_branches;
+
+    /** We own this */
+    tgForkPool* m_pPool;
+
+    /** Each branch's own state, perturbed and restored; reused */
+    std::vector<tgWorldSnapshot> m_perturbed;
+
+    /** Each branch's actuator commands; reused */
+    std::vector< std::vector<double> > m_commands;
+
+    /** The index in tgWorldSnapshot::actuators of each input */
+    std::vector<std::size_t> m_inputs;
+
+    /** The fork running, for columnOf */
+    std::size_t m_fork;
+
+    std::size_t m_stateSize;
+    std::size_t m_inputSize;
+    std::size_t m_bodyCount;
+
+    /** Every column's bodies after its rollout, a row per column */
+    std::vector<BodyEnd> m_ends;
+
+    std::vector<double> m_A;
+    std::vector<double> m_B;
+    std::vector<double> m_nominal;
+
+    /** Taken from the source, to find the sizes */
+    tgWorldSnapshot m_source;
+};
+
+#endif  // TG_LINEARIZER_H
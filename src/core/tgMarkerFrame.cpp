@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgMarkerFrame.cpp
+ * @brief Contains the definitions of members of class tgMarkerFrame
+ * $Id$
+ */
+
+// This module
+#include "tgMarkerFrame.h"
+// This application
+#include "abstractMarker.h"
+#include "tgRigidStateFrame.h"
+
+tgMarkerFrame::tgMarkerFrame()
+{
+}
+
+void tgMarkerFrame::update(const std::vector<abstractMarker>& markers)
+{
+    const std::size_t n = markers.size();
+    if (n != m_positions.size())
+    {
+        m_positions.resize(n);
+        m_velocities.resize(n);
+        m_stamps.assign(n, 0);
+    }
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const btRigidBody* const pBody = markers[i].getAttachedBody();
+        const btVector3& local = markers[i].getLocalPosition();
+        const tgRigidStateFrame::RigidState* const pState =
+            tgRigidStateFrame::find(pBody);
+        if (pState != NULL)
+        {
+            // Stamps count from 1, so 0 is never a published state
+            if (pState->stamp == m_stamps[i])
+            {
+                continue;
+            }
+            const btVector3 offset = pState->transform.getBasis() * local;
+            m_positions[i] = pState->transform.getOrigin() + offset;
+            m_velocities[i] = pState->linearVelocity +
+                              pState->angularVelocity.cross(offset);
+            m_stamps[i] = pState->stamp;
+        }
+        else
+        {
+            // Not published yet, e.g. before the first step
+            const btTransform& transform = pBody->getWorldTransform();
+            m_positions[i] = transform * local;
+            m_velocities[i] =
+                pBody->getVelocityInLocalPoint(m_positions[i] -
+                                               pBody->getCenterOfMassPosition());
+            m_stamps[i] = 0;
+        }
+    }
+}
+
+void tgMarkerFrame::clear()
+{
+    m_positions.clear();
+    m_velocities.clear();
+    m_stamps.clear();
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_MARKER_FRAME_H
+#define TG_MARKER_FRAME_H
+
+/**
+ * @file tgMarkerFrame.h
+ * @brief Contains the definition of class tgMarkerFrame
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <vector>
+
+// Forward declarations
+class abstractMarker;
+
+/**
+ * The world positions and velocities of a list of markers, evaluated
+ * together from the bodies' states in the tgRigidStateFrame, so that
+ * logging dozens of markers at a high rate is a pass over contiguous
+ * arrays rather than a transform lookup per marker. A marker whose body
+ * has not moved since the last update is not evaluated again.
+ */
+class tgMarkerFrame
+{
+public:
+
+    tgMarkerFrame();
+
+    /**
+     * Evaluate every marker. Nothing is allocated unless the number of
+     * markers has changed.
+     * @param[in] markers e.g. tgModel::getMarkers(), in the same order
+     * each time
+     */
+    void update(const std::vector<abstractMarker>& markers);
+
+    /** Forget the markers, e.g. when their bodies are deleted */
+    void clear();
+
+    std::size_t size() const
+    {
+        return m_positions.size();
+    }
+
+    /** The markers' world positions, in the order given to update */
+    const std::vector<btVector3>& getPositions() const
+    {
+        return m_positions;
+    }
+
+    /** The velocities of the markers' points on their bodies */
+    const std::vector<btVector3>& getVelocities() const
+    {
+        return m_velocities;
+    }
+
+private:
+
+    std::vector<btVector3> m_positions;
+    std::vector<btVector3> m_velocities;
+
+    /**
+     * The stamp of each marker's body state when it was last evaluated,
+     * or 0 if it was not evaluated from a published state
+     */
+    std::vector<std::size_t> m_stamps;
+};
+
+#endif  // TG_MARKER_FRAME_H
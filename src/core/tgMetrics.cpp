@@ -0,0 +1,416 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgMetrics.cpp
+ * @brief Contains the definitions of members of class tgMetrics
+ * $Id$
+ */
+
+// This module
+#include "tgMetrics.h"
+// The C++ Standard Library
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+// POSIX
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+    /** -1 until decided */
+    int enabled = -1;
+
+    pthread_once_t environmentOnce = PTHREAD_ONCE_INIT;
+
+    /** Guards everything below */
+    pthread_mutex_t valuesMutex = PTHREAD_MUTEX_INITIALIZER;
+
+    double values[tgMetrics::kMetricCount];
+
+    bool hasValue[tgMetrics::kMetricCount];
+
+    /** The steps, simulated and wall seconds when last formatted */
+    double lastSteps = 0.0;
+    double lastSimulated = 0.0;
+    double lastFormatted = 0.0;
+
+    __thread long pendingSteps = 0;
+    __thread double pendingSeconds = 0.0;
+
+    double now()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    bool isCounter(tgMetrics::Metric metric)
+    {
+        return metric != tgMetrics::eBestFitness &&
+            metric != tgMetrics::eLoggerQueueRows;
+    }
+
+    const char* metricHelp(tgMetrics::Metric metric)
+    {
+        static const char* const help[tgMetrics::kMetricCount] =
+        {
+            "Simulation steps taken",
+            "Seconds of simulated time",
+            "Learning episodes whose scores were taken",
+            "Trials stopped early by a pruner",
+            "Highest first score of any episode",
+            "Samples queued by asynchronous loggers",
+            "Samples dropped by asynchronous loggers"
+        };
+        return help[metric];
+    }
+
+    /** Bytes of this process in memory, or 0 if that is not known */
+    double residentBytes()
+    {
+        std::ifstream statm("/proc/self/statm");
+        double pages = 0.0;
+        double resident = 0.0;
+        if (!(statm >> pages >> resident))
+        {
+            return 0.0;
+        }
+        return resident * sysconf(_SC_PAGESIZE);
+    }
+
+    void writeMetric(std::ostream& out, const std::string& name,
+                     const char* type, const char* help, double value)
+    {
+        out << "# HELP " << name << " " << help << "\n"
+            << "# TYPE " << name << " " << type << "\n"
+            << name << " " << value << "\n";
+    }
+
+    /** Write all of a string to a socket, false if the peer has gone */
+    bool sendAll(int fd, const std::string& s)
+    {
+        std::size_t sent = 0;
+        while (sent < s.size())
+        {
+            const ssize_t n = send(fd, s.data() + sent, s.size() - sent,
+                                   MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                return false;
+            }
+            sent += n;
+        }
+        return true;
+    }
+
+    void* serveMain(void* pListener)
+    {
+        const int listener = *static_cast<int*>(pListener);
+        delete static_cast<int*>(pListener);
+        while (true)
+        {
+            const int connection = accept(listener, NULL, NULL);
+            if (connection < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED)
+                {
+                    continue;
+                }
+                break;
+            }
+            // Whatever was asked for, answer with the metrics; don't let
+            // a client that sends nothing hold up the next one
+            timeval timeout;
+            timeout.tv_sec = 1;
+            timeout.tv_usec = 0;
+            setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                       sizeof(timeout));
+            char request[4096];
+            const ssize_t received = recv(connection, request, sizeof(request), 0);
+            (void) received;
+
+            const std::string body = tgMetrics::format();
+            std::ostringstream reply;
+            reply << "HTTP/1.0 200 OK\r\n"
+                  << "Content-Type: text/plain; version=0.0.4\r\n"
+                  << "Content-Length: " << body.size() << "\r\n"
+                  << "Connection: close\r\n\r\n"
+                  << body;
+            sendAll(connection, reply.str());
+            close(connection);
+        }
+        close(listener);
+        return NULL;
+    }
+
+    void* writeMain(void* pPath)
+    {
+        const std::string path = *static_cast<std::string*>(pPath);
+        delete static_cast<std::string*>(pPath);
+        const std::string temporary = path + ".tmp";
+        while (true)
+        {
+            {
+                std::ofstream out(temporary.c_str());
+                out << tgMetrics::format();
+            }
+            std::rename(temporary.c_str(), path.c_str());
+            sleep(tgMetrics::writeInterval);
+        }
+        return NULL;
+    }
+
+    void startThread(void* (*main)(void*), void* arg)
+    {
+        pthread_attr_t attributes;
+        pthread_attr_init(&attributes);
+        pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+        pthread_t thread;
+        const int error = pthread_create(&thread, &attributes, main, arg);
+        pthread_attr_destroy(&attributes);
+        if (error != 0)
+        {
+            throw std::runtime_error("Could not start the metrics thread");
+        }
+    }
+
+    void startFromEnvironment()
+    {
+        const char* const value = std::getenv("NTRT_METRICS");
+        if (value == NULL || *value == '\0')
+        {
+            enabled = 0;
+            return;
+        }
+        const std::string target(value);
+        try
+        {
+            if (target.find_first_not_of("0123456789") == std::string::npos)
+            {
+                tgMetrics::serve(std::atoi(value));
+            }
+            else
+            {
+                tgMetrics::writeFile(target);
+            }
+        }
+        catch (const std::runtime_error& e)
+        {
+            // Keep counting; the job should not fail for want of metrics
+            std::cerr << e.what() << std::endl;
+            enabled = 1;
+        }
+    }
+}
+
+bool tgMetrics::isEnabled()
+{
+    if (enabled < 0)
+    {
+        pthread_once(&environmentOnce, startFromEnvironment);
+    }
+    return enabled == 1;
+}
+
+void tgMetrics::setEnabled(bool on)
+{
+    pthread_mutex_lock(&valuesMutex);
+    if (on && lastFormatted == 0.0)
+    {
+        lastFormatted = now();
+    }
+    pthread_mutex_unlock(&valuesMutex);
+    enabled = on ? 1 : 0;
+}
+
+void tgMetrics::add(Metric metric, double delta)
+{
+    if (isEnabled() && metric < kMetricCount)
+    {
+        pthread_mutex_lock(&valuesMutex);
+        values[metric] += delta;
+        hasValue[metric] = true;
+        pthread_mutex_unlock(&valuesMutex);
+    }
+}
+
+void tgMetrics::raise(Metric metric, double value)
+{
+    if (isEnabled() && metric < kMetricCount)
+    {
+        pthread_mutex_lock(&valuesMutex);
+        if (!hasValue[metric] || value > values[metric])
+        {
+            values[metric] = value;
+            hasValue[metric] = true;
+        }
+        pthread_mutex_unlock(&valuesMutex);
+    }
+}
+
+void tgMetrics::countStep(double dt)
+{
+    if (isEnabled())
+    {
+        pendingSeconds += dt;
+        if (++pendingSteps >= stepBatch)
+        {
+            flushSteps();
+        }
+    }
+}
+
+void tgMetrics::flushSteps()
+{
+    if (pendingSteps > 0)
+    {
+        pthread_mutex_lock(&valuesMutex);
+        values[eSteps] += pendingSteps;
+        values[eSimulatedSeconds] += pendingSeconds;
+        pthread_mutex_unlock(&valuesMutex);
+        pendingSteps = 0;
+        pendingSeconds = 0.0;
+    }
+}
+
+std::string tgMetrics::format()
+{
+    const double resident = residentBytes();
+
+    pthread_mutex_lock(&valuesMutex);
+    const double t = now();
+    const double elapsed = t - lastFormatted;
+    const double steps = values[eSteps] - lastSteps;
+    const double simulated = values[eSimulatedSeconds] - lastSimulated;
+    lastSteps = values[eSteps];
+    lastSimulated = values[eSimulatedSeconds];
+    lastFormatted = t;
+
+    std::ostringstream out;
+    out.precision(12);
+    for (int i = 0; i < kMetricCount; i++)
+    {
+        const Metric metric = Metric(i);
+        // A gauge nothing has set has no value to give
+        if (isCounter(metric) || hasValue[metric])
+        {
+            writeMetric(out, std::string("ntrt_") + metricName(metric),
+                        isCounter(metric) ? "counter" : "gauge",
+                        metricHelp(metric), values[metric]);
+        }
+    }
+    pthread_mutex_unlock(&valuesMutex);
+
+    if (elapsed > 0.0)
+    {
+        writeMetric(out, "ntrt_steps_per_second", "gauge",
+                    "Steps per wall second since the last scrape",
+                    steps / elapsed);
+        writeMetric(out, "ntrt_real_time_factor", "gauge",
+                    "Simulated seconds per wall second since the last scrape",
+                    simulated / elapsed);
+    }
+    writeMetric(out, "process_resident_memory_bytes", "gauge",
+                "Resident memory size in bytes", resident);
+    return out.str();
+}
+
+void tgMetrics::serve(int port)
+{
+    if (port <= 0 || port > 65535)
+    {
+        throw std::runtime_error("No such metrics port");
+    }
+    const int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        throw std::runtime_error("Could not create a socket");
+    }
+    const int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, 4) != 0)
+    {
+        close(listener);
+        std::ostringstream message;
+        message << "Could not serve metrics on port " << port;
+        throw std::runtime_error(message.str());
+    }
+    setEnabled(true);
+    int* const pListener = new int(listener);
+    try
+    {
+        startThread(serveMain, pListener);
+    }
+    catch (...)
+    {
+        delete pListener;
+        close(listener);
+        throw;
+    }
+}
+
+void tgMetrics::writeFile(const std::string& path)
+{
+    setEnabled(true);
+    std::string* const pPath = new std::string(path);
+    try
+    {
+        startThread(writeMain, pPath);
+    }
+    catch (...)
+    {
+        delete pPath;
+        throw;
+    }
+}
+
+const char* tgMetrics::metricName(Metric metric)
+{
+    static const char* const names[kMetricCount] =
+    {
+        "steps_total",
+        "simulated_seconds_total",
+        "episodes_total",
+        "pruned_trials_total",
+        "best_fitness",
+        "logger_queue_rows",
+        "logger_dropped_rows_total"
+    };
+    return metric < kMetricCount ? names[metric] : "unknown";
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_METRICS_H
+#define TG_METRICS_H
+
+/**
+ * @file tgMetrics.h
+ * @brief Contains the definition of class tgMetrics
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <string>
+
+/**
+ * Live counters and gauges of a long-running process, in the Prometheus
+ * text format, so cluster jobs can be watched, autoscaled and their slow
+ * nodes found without waiting on their logs.
+ *
+ * Off unless the environment variable NTRT_METRICS is set when the first
+ * metric is recorded. A port number, e.g. NTRT_METRICS=9464, serves the
+ * metrics over HTTP on that port; anything else names a file that is
+ * rewritten every writeInterval seconds, such as one in a node
+ * exporter's textfile directory or in /dev/shm. serve and writeFile
+ * start the same from a program.
+ *
+ * Steps are counted per thread and added to the totals every
+ * stepBatch steps and by flushSteps, so counting them takes no lock.
+ * Steps per second and the real time factor are worked out over the
+ * time since the metrics were last formatted.
+ */
+class tgMetrics
+{
+public:
+
+    enum Metric
+    {
+        /** Counter: simulation steps */
+        eSteps,
+        /** Counter: simulated seconds */
+        eSimulatedSeconds,
+        /** Counter: learning episodes whose scores were taken */
+        eEpisodes,
+        /** Counter: trials stopped early by a pruner */
+        ePrunedTrials,
+        /** Gauge: the highest first score of any episode */
+        eBestFitness,
+        /** Gauge: samples queued by asynchronous loggers, not yet written */
+        eLoggerQueueRows,
+        /** Counter: samples asynchronous loggers dropped for a full queue */
+        eLoggerDroppedRows,
+        kMetricCount
+    };
+
+    /** Steps a thread counts before adding them to the totals */
+    static const long stepBatch = 1024;
+
+    /** Seconds between rewrites of a metrics file */
+    static const int writeInterval = 5;
+
+    static bool isEnabled();
+
+    /** Set whether metrics are recorded, whatever the environment */
+    static void setEnabled(bool enabled);
+
+    /** Add to a counter, or to a gauge summed over its sources */
+    static void add(Metric metric, double delta);
+
+    /** Raise a gauge to value, if it is lower or was never set */
+    static void raise(Metric metric, double value);
+
+    /** Count a step of dt seconds on this thread */
+    static void countStep(double dt);
+
+    /** Add this thread's counted steps to the totals */
+    static void flushSteps();
+
+    /** The metrics in the Prometheus text exposition format */
+    static std::string format();
+
+    /**
+     * Serve format() over HTTP from a background thread, on every path,
+     * and turn recording on
+     * @throw std::runtime_error if the port cannot be listened on
+     */
+    static void serve(int port);
+
+    /**
+     * Rewrite a file with format() every writeInterval seconds from a
+     * background thread, and turn recording on. Each version is renamed
+     * into place, so readers never see part of one.
+     */
+    static void writeFile(const std::string& path);
+
+    /** A metric's name, without the ntrt_ prefix */
+    static const char* metricName(Metric metric);
+};
+
+#endif  // TG_METRICS_H
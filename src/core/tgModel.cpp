@@ -27,17 +27,25 @@
 // This application
 #include "tgModelVisitor.h"
 #include "abstractMarker.h"
+#include "tgBaseRigid.h"
+#include "tgSpringCableActuator.h"
 // The C++ Standard Library
 #include <stdexcept>
 
-tgModel::tgModel()
+unsigned long tgModel::s_treeGeneration = 1;
+
+tgModel::tgModel() :
+  m_descendantsGeneration(0),
+  m_static(false)
 {
   // Postcondition
   assert(invariant());
 }
 
 tgModel::tgModel(const tgTags& tags) :
-        tgTaggable(tags)
+        tgTaggable(tags),
+        m_descendantsGeneration(0),
+        m_static(false)
 {
   assert(invariant());
 }
@@ -61,10 +69,20 @@ void tgModel::setup(tgWorld& world)
     m_children[i]->setup(world);
   }
 
+  // The children are complete now, so flatten them for step and index
+  // them for find
+  m_stepPlan.compile(m_children);
+  m_tagIndex.build(getDescendants());
+  m_typeIndex.clear();
+
   // Postcondition
   assert(invariant());
 }
 
+void tgModel::prepare()
+{
+}
+
 void tgModel::teardown()
 {
   for (std::size_t i = 0; i < m_children.size(); i++)
@@ -73,14 +91,29 @@ void tgModel::teardown()
     delete m_children[i];
   }
   m_children.clear();
+  m_stepPlan.clear();
+  m_tagIndex.clear();
+  m_typeIndex.clear();
+  m_actuatorGroups.clear();
+  m_static = false;
+  __sync_add_and_fetch(&s_treeGeneration, 1);
   //Clear the markers
   this->m_markers.clear();
+  m_markerFrame.clear();
 
   // Postcondition
   assert(invariant());
   assert(m_children.empty());
 }
 
+void tgModel::resetEpisode()
+{
+  for (std::size_t i = 0; i < m_children.size(); i++)
+  {
+    m_children[i]->resetEpisode();
+  }
+}
+
 void tgModel::step(double dt) 
 {
   if (dt <= 0.0)
@@ -91,13 +124,13 @@ void tgModel::step(double dt)
   {
     // Note: You can adjust whether to step children before notifying 
     // controllers or the other way around in your model
-    const size_t n = m_children.size();
-    for (std::size_t i = 0; i < n; i++)
+    // The plan steps the whole subtree without checking dt again. It is
+    // normally compiled by setup, but children may be added afterwards.
+    if (!m_stepPlan.isCompiled())
     {
-      tgModel* const pChild = m_children[i];
-      assert(pChild != NULL);
-      pChild->step(dt);
+      m_stepPlan.compile(m_children);
     }
+    m_stepPlan.step(dt);
   }
 
   // Postcondition
@@ -132,7 +165,7 @@ void tgModel::addChild(tgModel* pChild)
   } 
   else 
   {
-    const std::vector<tgModel*> descendants = getDescendants();
+    const std::vector<tgModel*>& descendants = getDescendants();
     if (std::find(descendants.begin(), descendants.end(), pChild) !=
     descendants.end())
     {
@@ -141,6 +174,11 @@ void tgModel::addChild(tgModel* pChild)
   }
 
   m_children.push_back(pChild);
+  m_stepPlan.clear();
+  m_tagIndex.clear();
+  m_typeIndex.clear();
+  m_actuatorGroups.clear();
+  __sync_add_and_fetch(&s_treeGeneration, 1);
 
   // Postcondition
   assert(invariant());
@@ -163,26 +201,48 @@ std::string tgModel::toString(std::string prefix) const
   return os.str();
 }
 
-/**
- * @todo Unnecessary copying can be avoided by pasing the result
- * collection in the recursive step.
- */
-std::vector<tgModel*> tgModel::getDescendants() const
+std::vector<tgModel*> tgModel::findTagged(const tgTagSearch& tagSearch)
 {
-  std::vector<tgModel*> result;
-  const size_t n = m_children.size();
-  for (std::size_t i = 0; i < n; i++)
+  if (!m_tagIndex.isBuilt())
   {
-    tgModel* const pChild = m_children[i];
-    assert(pChild != NULL);
-    result.push_back(pChild);
-    // Recursion
-    const std::vector<tgModel*> cd = pChild->getDescendants();
-    result.insert(result.end(), cd.begin(), cd.end());
+    m_tagIndex.build(getDescendants());
   }
+  std::vector<tgModel*> result;
+  m_tagIndex.find(tagSearch, result);
   return result;
 }
 
+const std::vector<tgSpringCableActuator*>& tgModel::getActuators() const
+{
+  return getDescendantsOfType<tgSpringCableActuator>();
+}
+
+const std::vector<tgBaseRigid*>& tgModel::getRigids() const
+{
+  return getDescendantsOfType<tgBaseRigid>();
+}
+
+const std::vector<tgModel*>& tgModel::getDescendants() const
+{
+  const unsigned long generation = __sync_add_and_fetch(&s_treeGeneration, 0);
+  if (m_descendantsGeneration != generation)
+  {
+    m_descendants.clear();
+    const size_t n = m_children.size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+      tgModel* const pChild = m_children[i];
+      assert(pChild != NULL);
+      m_descendants.push_back(pChild);
+      // Recursion, through the child's own list
+      const std::vector<tgModel*>& cd = pChild->getDescendants();
+      m_descendants.insert(m_descendants.end(), cd.begin(), cd.end());
+    }
+    m_descendantsGeneration = generation;
+  }
+  return m_descendants;
+}
+
 /**
  * For tgSenseable: just return the results of getDescendants here.
  * This should be OK, since a vector of tgModel* is also a vector of
@@ -190,20 +250,21 @@ std::vector<tgModel*> tgModel::getDescendants() const
  */
 std::vector<tgSenseable*> tgModel::getSenseableDescendants() const
 {
-  // TO-DO: why can't we just return the results of getDescendants?
-  // There seems to be some polymorphism issue here...
-  std::vector<tgModel*> myDescendants = getDescendants();
-  std::vector<tgSenseable*> mySenseableDescendants;
-  for (size_t i=0; i < myDescendants.size(); i++) {
-    mySenseableDescendants.push_back(myDescendants[i]);
-  }
-  return mySenseableDescendants;
+  // A vector of tgModel* can't be returned as one of tgSenseable*, but
+  // converting the cached list avoids walking the tree again
+  const std::vector<tgModel*>& myDescendants = getDescendants();
+  return std::vector<tgSenseable*>(myDescendants.begin(), myDescendants.end());
 }
 
 const std::vector<abstractMarker>& tgModel::getMarkers() const {
     return m_markers;
 }
 
+const tgMarkerFrame& tgModel::getMarkerFrame() const {
+    m_markerFrame.update(m_markers);
+    return m_markerFrame;
+}
+
 void tgModel::addMarker(abstractMarker a){
     m_markers.push_back(a);
 }
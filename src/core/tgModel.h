@@ -27,10 +27,15 @@
  */
 
 // This application
+#include "tgActuatorGroups.h"
 #include "tgCast.h"
+#include "tgMarkerFrame.h"
 #include "tgTaggable.h"
 #include "tgTagSearch.h"
 #include "tgSenseable.h"
+#include "tgStepPlan.h"
+#include "tgTagIndex.h"
+#include "tgTypeIndex.h"
 // The C++ Standard Library
 #include <iostream>
 #include <vector>
@@ -39,6 +44,8 @@
 class tgModelVisitor;
 class tgWorld;
 class abstractMarker;
+class tgBaseRigid;
+class tgSpringCableActuator;
 
 /**
  * A root-level model is a Tensegrity. It can contain sub-models.
@@ -77,21 +84,53 @@ public:
      * @param[in] world - the tgWorld the models will exist in.
      */
     virtual void setup(tgWorld& world);
+
+    /**
+     * Do the part of setup that needs no world, such as building and
+     * resolving a tgModelTemplate, so that setup only has to put the
+     * result into the world. tgSimulation calls this on every model
+     * being set up together, on separate threads, before calling their
+     * setup one at a time. It must therefore not touch the world, Bullet
+     * or any other model, and setup must still work without it. May be
+     * called again before each setup. Does nothing by default.
+     */
+    virtual void prepare();
     
     /**
      * Deletes the children (undoes setup)
      */
     virtual void teardown();
 
+    /**
+     * Start a new episode without a teardown, after the world has been
+     * put back to its initial state. Calls resetEpisode on the children.
+     * Models that are subjects override this to call notifyReset before
+     * passing it on to their children.
+     */
+    virtual void resetEpisode();
+
     /**
     * Advance the simulation.
     * @param[in] dt the number of seconds since the previous call;
     * std::invalid_argument is thrown if dt is not positive
     * @throw std::invalid_argument if dt is not positive
     * @note This is not necessarily const for every child.
+    * @note The descendants are stepped through a tgStepPlan, so dt is
+    * checked here once rather than at every level of the tree.
     */
     virtual void step(double dt);
 
+    /**
+     * True if the model has declared, during setup, that stepping it
+     * does nothing. A static model and its descendants are left out of
+     * tgSimulation's and every tgStepPlan's step lists, but stay in the
+     * world for collision, rendering and sensing. Reset by teardown.
+     */
+    bool isStatic() const
+    {
+        return m_static;
+    }
+
     /**
     * Call tgModelVisitor::render() on self and all descendants.
     * @param[in,out] r a reference to a tgModelVisitor
@@ -127,7 +166,7 @@ public:
     template <typename T>
     std::vector<T*> find(const tgTagSearch& tagSearch)
     {
-        return tgCast::find<tgModel, T>(tagSearch, getDescendants());
+        return tgCast::filter<tgModel, T>(findTagged(tagSearch));
     }
 	
 	/**
@@ -140,19 +179,89 @@ public:
     template <typename T>
     std::vector<T*> find(const std::string& tagSearch)
     {
-        return tgCast::find<tgModel, T>(tgTagSearch(tagSearch), getDescendants());
+        return tgCast::filter<tgModel, T>(findTagged(tgTagSearch(tagSearch)));
+    }
+
+    /**
+     * The descendants whose tags match a search, in getDescendants()
+     * order, looked up in an index of the descendants by tag.
+     * The index is built by setup, and again on the first search after
+     * this model's children change.
+     * @param[in] tagSearch the search
+     * @return the matching descendants
+     */
+    std::vector<tgModel*> findTagged(const tgTagSearch& tagSearch);
+
+    /**
+     * The descendants of type T, in getDescendants() order, as
+     * tgCast::filter<tgModel, T>(getDescendants()) but kept from one call
+     * to the next. The first call for each type after setup or after
+     * this model's children change walks the tree; later calls just
+     * look the type up.
+     * @return valid until the next setup, teardown or addChild
+     */
+    template <typename T>
+    const std::vector<T*>& getDescendantsOfType() const
+    {
+        const std::vector<T*>* pFound = m_typeIndex.find<T>();
+        if (pFound == NULL)
+        {
+            pFound = &m_typeIndex.insert(
+                tgCast::filter<tgModel, T>(getDescendants()));
+        }
+        return *pFound;
     }
 
+    /**
+     * Every actuator below this model, as
+     * getDescendantsOfType<tgSpringCableActuator>(). Controllers that
+     * look up their actuators on every step should use this, a group of
+     * getActuatorGroups(), or a reference to a list they kept in onSetup:
+     * none of these allocate after the first call, while find and a copy
+     * of a list both do.
+     * @return valid until the next setup, teardown or addChild
+     */
+    const std::vector<tgSpringCableActuator*>& getActuators() const;
+
+    /** Every rigid body below this model, as getActuators */
+    const std::vector<tgBaseRigid*>& getRigids() const;
+
     /**
      * Return a std::vector of const pointers to all sub-models.
+     * The list is kept between calls and built again only after a model
+     * anywhere has gained or lost children.
      * @todo examine whether this should be public, and perhaps create
      * a read only version
-     * @return a std::vector of const pointers all sub-models.
+     * @return a std::vector of const pointers all sub-models, valid until
+     * the next addChild or teardown
      */
-    std::vector<tgModel*> getDescendants() const;
+    const std::vector<tgModel*>& getDescendants() const;
+
+    /**
+     * The named actuator groups of the build spec this model was built
+     * from, filled by tgStructureInfo::buildInto and emptied by
+     * teardown. Empty if the spec has none.
+     */
+    const tgActuatorGroups& getActuatorGroups() const
+    {
+        return m_actuatorGroups;
+    }
+
+    tgActuatorGroups& getActuatorGroups()
+    {
+        return m_actuatorGroups;
+    }
 
     const std::vector<abstractMarker>& getMarkers() const;
 
+    /**
+     * The world positions and velocities of getMarkers(), evaluated
+     * together from the last published tgRigidStateFrame. Only the
+     * markers whose bodies have moved since the last call are evaluated
+     * again.
+     */
+    const tgMarkerFrame& getMarkerFrame() const;
+
     void addMarker(abstractMarker a);
 
     /**
@@ -163,8 +272,24 @@ public:
      */
     virtual std::vector<tgSenseable*> getSenseableDescendants() const;
 
+protected:
+
+    /**
+     * Declare the model static, see isStatic. Call from setup before
+     * tgModel::setup, for geometry such as obstacles whose step would
+     * only step bodies with nothing to integrate. The model's step is
+     * then never called, so neither are its observers.
+     */
+    void setStatic(bool staticModel)
+    {
+        m_static = staticModel;
+    }
+
 private:
 
+    /** tgStepPlan reads m_children when flattening the tree */
+    friend class tgStepPlan;
+
     /** Integrity predicate. */
     bool invariant() const;
 
@@ -179,6 +304,39 @@ private:
 
     std::vector<abstractMarker> m_markers;
 
+    /** Filled from m_markers by getMarkerFrame */
+    mutable tgMarkerFrame m_markerFrame;
+
+    /**
+     * The flattened children, compiled by setup and cleared whenever
+     * the children change.
+     */
+    tgStepPlan m_stepPlan;
+
+    /** The descendants by tag, for findTagged */
+    tgTagIndex m_tagIndex;
+
+    tgActuatorGroups m_actuatorGroups;
+
+    /** The descendants by type, filled as getDescendantsOfType asks */
+    mutable tgTypeIndex m_typeIndex;
+
+    /** The last list returned by getDescendants */
+    mutable std::vector<tgModel*> m_descendants;
+
+    /** The s_treeGeneration m_descendants was built at; 0 for never */
+    mutable unsigned long m_descendantsGeneration;
+
+    /** Set by setStatic */
+    bool m_static;
+
+    /**
+     * Counts addChild and teardown calls on every model, so that a
+     * model's descendant list goes stale when a grandchild changes too.
+     * Updated atomically, since worlds may be built on several threads.
+     */
+    static unsigned long s_treeGeneration;
+
 };
 
 /**
@@ -27,6 +27,9 @@
  * $Id$
  */
 
+// This application
+#include "tgEvent.h"
+
 /**
  * A mixin class which makes its derived class the Subject in the Obsever
  * design pattern. These are typically controllers.
@@ -65,6 +68,26 @@ public:
      * @param[in,out] subject the subject being observed
      */    
     virtual void onTeardown(Subject& subject) { }
+
+    /**
+     * Notify the observers that a new episode is starting on the same
+     * subject, e.g. after tgSimulation::restart. An observer that can
+     * put its own state back in place returns true. The default returns
+     * false, and the subject falls back to onTeardown then onSetup, so
+     * observers that attach to or create other objects in onSetup need
+     * to override this.
+     * @param[in,out] subject the subject being observed
+     * @return true if the observer has reset itself
+     */
+    virtual bool onReset(Subject& subject) { return false; }
+
+    /**
+     * Notify the observer of an event it subscribed to with
+     * tgSubject::subscribe or tgSubject::subscribeTimer.
+     * @param[in,out] subject the subject raising the event
+     * @param[in] event the event
+     */
+    virtual void onEvent(Subject& subject, const tgEvent& event) { }
     
 };
    
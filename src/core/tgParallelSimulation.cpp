@@ -0,0 +1,615 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgParallelSimulation.cpp
+ * @brief Contains the definitions of members of class tgParallelSimulation
+ * $Id$
+ */
+
+// This module
+#include "tgParallelSimulation.h"
+// This application
+#include "tgMetrics.h"
+#include "tgRandom.h"
+#include "tgSimulation.h"
+#include "tgSimView.h"
+#include "tgStopPredicate.h"
+#include "tgTraceRecorder.h"
+#include "tgWorld.h"
+#include "tgWorldSnapshot.h"
+#include "terrain/tgBoxGround.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+// POSIX
+#include <time.h>
+#ifdef __linux__
+#include <dirent.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+    double monotonicSeconds()
+    {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return now.tv_sec + now.tv_nsec * 1e-9;
+    }
+
+#ifdef __linux__
+    /** The NUMA node of a CPU, from sysfs; 0 without NUMA */
+    int nodeOfCpu(int cpu)
+    {
+        std::ostringstream path;
+        path << "/sys/devices/system/cpu/cpu" << cpu;
+        int node = 0;
+        DIR* const pDir = opendir(path.str().c_str());
+        if (pDir != NULL)
+        {
+            for (dirent* pEntry = readdir(pDir); pEntry != NULL; pEntry = readdir(pDir))
+            {
+                if (std::strncmp(pEntry->d_name, "node", 4) == 0 &&
+                    std::isdigit(static_cast<unsigned char>(pEntry->d_name[4])))
+                {
+                    node = std::atoi(pEntry->d_name + 4);
+                    break;
+                }
+            }
+            closedir(pDir);
+        }
+        return node;
+    }
+
+    /**
+     * The CPUs this process may run on and their nodes, ordered to
+     * take the first CPU of each node, then the second, and so on
+     */
+    std::vector<std::pair<int, int> > spreadCpus()
+    {
+        std::vector<std::pair<int, int> > spread;
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        {
+            return spread;
+        }
+
+        std::map<int, std::vector<int> > byNode;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+            {
+                byNode[nodeOfCpu(cpu)].push_back(cpu);
+            }
+        }
+        for (std::size_t k = 0; spread.size() < static_cast<std::size_t>(CPU_COUNT(&allowed)); k++)
+        {
+            for (std::map<int, std::vector<int> >::const_iterator it = byNode.begin();
+                 it != byNode.end(); ++it)
+            {
+                if (k < it->second.size())
+                {
+                    spread.push_back(std::make_pair(it->second[k], it->first));
+                }
+            }
+        }
+        return spread;
+    }
+#endif
+}
+
+/**
+ * Everything belonging to one world. The world is created by the
+ * worker that runs its first trial, and deleted with the slot.
+ */
+class tgParallelSimulation::Slot
+{
+public:
+    Slot(Episode& e) :
+        episode(e),
+        pWorld(NULL),
+        pView(NULL),
+        pSimulation(NULL),
+        pHome(NULL),
+        inTrial(false),
+        trial(0),
+        stepsDone(0),
+        time(0.0)
+    {
+    }
+
+    ~Slot()
+    {
+        // The simulation tears down and deletes the models
+        delete pSimulation;
+        delete pView;
+        delete pWorld;
+    }
+
+    void create(const Config& config)
+    {
+        pWorld = new tgWorld(config.worldConfig, episode.createGround());
+        pView = new tgSimView(*pWorld, config.stepSize, config.stepSize);
+        pSimulation = new tgSimulation(*pView);
+        episode.setup(*pSimulation);
+    }
+
+    Episode& episode;
+    tgWorld* pWorld;
+    tgSimView* pView;
+    tgSimulation* pSimulation;
+
+    /** The worker whose queue the slot returns to */
+    Worker* pHome;
+
+    /** Whether a trial has been taken and not finished */
+    bool inTrial;
+    std::size_t trial;
+    int stepsDone;
+
+    /** The simulated seconds since the trial started */
+    double time;
+
+    std::vector<tgStopPredicate*> predicates;
+
+    /** The tgRandom::forThread() state between chunks */
+    std::string randomState;
+
+    /** Taken after setup, with Config::restoreSnapshot */
+    tgWorldSnapshot initialState;
+};
+
+/** A worker thread, the queue of its home slots and its throughput */
+class tgParallelSimulation::Worker
+{
+public:
+    Worker(tgParallelSimulation& o, std::size_t i) :
+        owner(o),
+        index(i),
+        cpu(-1),
+        node(-1),
+        trials(0),
+        steps(0),
+        seconds(0.0)
+    {
+    }
+
+    /** Pin the calling thread to cpu, if there is one */
+    void pin() const
+    {
+#ifdef __linux__
+        if (cpu >= 0)
+        {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu, &cpus);
+            // Best effort: an unpinned worker still runs
+            pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        }
+#endif
+    }
+
+    tgParallelSimulation& owner;
+    const std::size_t index;
+    pthread_t thread;
+
+    /** Home slots waiting for a chunk, guarded by the owner's mutex */
+    std::deque<Slot*> queue;
+
+    /** The CPU and node the thread is pinned to, or -1 */
+    int cpu;
+    int node;
+
+    /** Throughput, written by the worker's thread during runs */
+    std::size_t trials;
+    unsigned long steps;
+    double seconds;
+};
+
+tgGround* tgParallelSimulation::Episode::createGround()
+{
+    return new tgBoxGround();
+}
+
+tgParallelSimulation::Config::Config(const tgWorld::Config& wc, double ss,
+                                     unsigned long rs, bool pt, int nt,
+                                     int cs, int ci, bool rsn) :
+worldConfig(wc),
+stepSize(ss),
+randomSeed(rs),
+pinThreads(pt),
+numThreads(nt),
+chunkSteps(cs),
+checkInterval(ci),
+restoreSnapshot(rsn)
+{
+    if (ss <= 0.0)
+    {
+        throw std::invalid_argument("stepSize is not positive");
+    }
+    if (nt < 0)
+    {
+        throw std::invalid_argument("numThreads is negative");
+    }
+    if (cs < 0)
+    {
+        throw std::invalid_argument("chunkSteps is negative");
+    }
+    if (ci <= 0)
+    {
+        throw std::invalid_argument("checkInterval is not positive");
+    }
+}
+
+tgParallelSimulation::tgParallelSimulation(const Config& config,
+                                           const std::vector<Episode*>& episodes) :
+m_config(config),
+m_numTrials(0),
+m_nextTrial(0),
+m_finishedTrials(0),
+m_steps(0),
+m_shutdown(false)
+{
+    if (episodes.empty())
+    {
+        throw std::invalid_argument("No episodes");
+    }
+
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_workReady, NULL);
+    pthread_cond_init(&m_workDone, NULL);
+
+    for (std::size_t i = 0; i < episodes.size(); i++)
+    {
+        if (episodes[i] == NULL)
+        {
+            throw std::invalid_argument("Episode is NULL");
+        }
+        m_slots.push_back(new Slot(*episodes[i]));
+    }
+
+    const std::size_t numThreads = (m_config.numThreads == 0) ? m_slots.size() :
+        std::min(m_slots.size(), static_cast<std::size_t>(m_config.numThreads));
+    for (std::size_t i = 0; i < numThreads; i++)
+    {
+        m_workers.push_back(new Worker(*this, i));
+    }
+    for (std::size_t i = 0; i < m_slots.size(); i++)
+    {
+        m_slots[i]->pHome = m_workers[i % numThreads];
+    }
+
+#ifdef __linux__
+    if (m_config.pinThreads)
+    {
+        const std::vector<std::pair<int, int> > cpus = spreadCpus();
+        for (std::size_t i = 0; i < m_workers.size() && !cpus.empty(); i++)
+        {
+            m_workers[i]->cpu = cpus[i % cpus.size()].first;
+            m_workers[i]->node = cpus[i % cpus.size()].second;
+        }
+    }
+#endif
+
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        if (pthread_create(&m_workers[i]->thread, NULL, workerMain, m_workers[i]) != 0)
+        {
+            throw std::runtime_error("Could not start a simulation thread");
+        }
+    }
+
+    // Postcondition
+    assert(invariant());
+}
+
+tgParallelSimulation::~tgParallelSimulation()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_shutdown = true;
+    pthread_cond_broadcast(&m_workReady);
+    pthread_mutex_unlock(&m_mutex);
+
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        pthread_join(m_workers[i]->thread, NULL);
+        delete m_workers[i];
+    }
+    for (std::size_t i = 0; i < m_slots.size(); i++)
+    {
+        delete m_slots[i];
+    }
+
+    pthread_cond_destroy(&m_workDone);
+    pthread_cond_destroy(&m_workReady);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void tgParallelSimulation::run(std::size_t trials, int steps)
+{
+    if (steps <= 0)
+    {
+        throw std::invalid_argument("steps is not positive");
+    }
+    else if (trials == 0)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    m_numTrials = trials;
+    m_nextTrial = 0;
+    m_finishedTrials = 0;
+    m_steps = steps;
+    m_error.clear();
+    for (std::size_t i = 0; i < m_slots.size(); i++)
+    {
+        m_slots[i]->pHome->queue.push_back(m_slots[i]);
+    }
+    pthread_cond_broadcast(&m_workReady);
+
+    tgTraceRecorder::Scope trace("parallel run", static_cast<long>(trials));
+    while (m_finishedTrials < m_numTrials)
+    {
+        pthread_cond_wait(&m_workDone, &m_mutex);
+    }
+    const std::string error = m_error;
+    pthread_mutex_unlock(&m_mutex);
+
+    if (!error.empty())
+    {
+        throw std::runtime_error(error);
+    }
+
+    // Postcondition
+    assert(invariant());
+}
+
+void* tgParallelSimulation::workerMain(void* arg)
+{
+    Worker* const pWorker = static_cast<Worker*>(arg);
+    pWorker->owner.work(*pWorker);
+    return NULL;
+}
+
+std::vector<tgParallelSimulation::NodeStats> tgParallelSimulation::getNodeStats() const
+{
+    std::map<int, NodeStats> byNode;
+    pthread_mutex_lock(&m_mutex);
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        const Worker& worker = *m_workers[i];
+        std::map<int, NodeStats>::iterator found = byNode.find(worker.node);
+        if (found == byNode.end())
+        {
+            NodeStats stats;
+            stats.node = worker.node;
+            stats.workers = 0;
+            stats.trials = 0;
+            stats.steps = 0;
+            stats.seconds = 0.0;
+            found = byNode.insert(std::make_pair(worker.node, stats)).first;
+        }
+        found->second.workers++;
+        found->second.trials += worker.trials;
+        found->second.steps += worker.steps;
+        found->second.seconds += worker.seconds;
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    std::vector<NodeStats> result;
+    for (std::map<int, NodeStats>::const_iterator it = byNode.begin();
+         it != byNode.end(); ++it)
+    {
+        result.push_back(it->second);
+    }
+    return result;
+}
+
+tgParallelSimulation::Slot* tgParallelSimulation::takeWork(Worker& worker)
+{
+    // Own queue first, oldest first; then steal the newest of another's
+    for (std::size_t k = 0; k < m_workers.size(); k++)
+    {
+        const std::size_t victim = (worker.index + k) % m_workers.size();
+        std::deque<Slot*>& queue = m_workers[victim]->queue;
+        while (!queue.empty())
+        {
+            Slot* const pSlot = (k == 0) ? queue.front() : queue.back();
+            if (k == 0)
+            {
+                queue.pop_front();
+            }
+            else
+            {
+                queue.pop_back();
+            }
+
+            if (pSlot->inTrial)
+            {
+                return pSlot;
+            }
+            else if (m_nextTrial < m_numTrials)
+            {
+                pSlot->inTrial = true;
+                pSlot->trial = m_nextTrial++;
+                pSlot->stepsDone = 0;
+                return pSlot;
+            }
+            // No trials left for this world; it stays out of the queues
+        }
+    }
+    return NULL;
+}
+
+bool tgParallelSimulation::runChunk(Worker& worker, Slot& slot, std::string& error)
+{
+    const int steps = m_steps;
+    tgRandom& random = tgRandom::forThread();
+    try
+    {
+        if (slot.stepsDone == 0)
+        {
+            tgTraceRecorder::Scope trace("trial setup", slot.trial);
+            random.seed(tgRandom::deriveSeed(m_config.randomSeed, slot.trial));
+            slot.episode.beginTrial(slot.trial);
+            if (slot.pSimulation == NULL)
+            {
+                slot.create(m_config);
+                if (m_config.restoreSnapshot)
+                {
+                    slot.pSimulation->snapshot(slot.initialState);
+                }
+            }
+            else if (m_config.restoreSnapshot)
+            {
+                slot.pSimulation->restore(slot.initialState);
+            }
+            else
+            {
+                slot.pSimulation->reset();
+            }
+            slot.episode.prepareTrial(*slot.pSimulation, slot.trial);
+            slot.predicates = slot.episode.getStopPredicates();
+            for (std::size_t i = 0; i < slot.predicates.size(); i++)
+            {
+                if (slot.predicates[i] == NULL)
+                {
+                    throw std::invalid_argument("Stop predicate is NULL");
+                }
+                slot.predicates[i]->onStart();
+            }
+            slot.time = 0.0;
+        }
+        else
+        {
+            random.setState(slot.randomState);
+        }
+
+        const int end = (m_config.chunkSteps == 0) ? steps :
+            std::min(steps, slot.stepsDone + m_config.chunkSteps);
+        bool stopped = false;
+        const int first = slot.stepsDone;
+        {
+            tgTraceRecorder::Scope trace("steps", slot.trial);
+            const double start = monotonicSeconds();
+            while (slot.stepsDone < end && !stopped)
+            {
+                slot.pSimulation->step(m_config.stepSize);
+                slot.time += m_config.stepSize;
+                slot.stepsDone++;
+                if (!slot.predicates.empty() &&
+                    (slot.stepsDone % m_config.checkInterval == 0 || slot.stepsDone == steps))
+                {
+                    for (std::size_t i = 0; i < slot.predicates.size() && !stopped; i++)
+                    {
+                        stopped = slot.predicates[i]->shouldStop(slot.time);
+                    }
+                }
+            }
+            worker.seconds += monotonicSeconds() - start;
+        }
+        // Another worker may take the world's next chunk
+        tgMetrics::flushSteps();
+        worker.steps += slot.stepsDone - first;
+
+        if (stopped || slot.stepsDone == steps)
+        {
+            tgTraceRecorder::Scope trace("trial end", slot.trial);
+            slot.episode.endTrial(slot.trial);
+            worker.trials++;
+            return true;
+        }
+        slot.randomState = random.getState();
+        return false;
+    }
+    catch (std::exception& e)
+    {
+        error = e.what();
+        return true;
+    }
+}
+
+void tgParallelSimulation::work(Worker& worker)
+{
+    // Before any world is created, so its memory is on this node
+    worker.pin();
+    if (tgTraceRecorder::isEnabled())
+    {
+        std::ostringstream name;
+        name << "worker " << worker.index;
+        tgTraceRecorder::setThreadName(name.str());
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    while (!m_shutdown)
+    {
+        Slot* const pSlot = takeWork(worker);
+        if (pSlot == NULL)
+        {
+            tgTraceRecorder::Scope trace("idle");
+            pthread_cond_wait(&m_workReady, &m_mutex);
+            continue;
+        }
+        pthread_mutex_unlock(&m_mutex);
+
+        std::string error;
+        bool finished;
+        {
+            // Chunks of a world run by another worker are stolen
+            tgTraceRecorder::Scope trace(pSlot->pHome == &worker ?
+                                         "chunk" : "stolen chunk", pSlot->trial);
+            finished = runChunk(worker, *pSlot, error);
+        }
+
+        pthread_mutex_lock(&m_mutex);
+        if (!error.empty() && m_error.empty())
+        {
+            m_error = error;
+        }
+        if (finished)
+        {
+            pSlot->inTrial = false;
+            if (++m_finishedTrials == m_numTrials)
+            {
+                pthread_cond_signal(&m_workDone);
+            }
+        }
+        if (!finished || m_nextTrial < m_numTrials)
+        {
+            pSlot->pHome->queue.push_back(pSlot);
+            pthread_cond_broadcast(&m_workReady);
+        }
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool tgParallelSimulation::invariant() const
+{
+    return !m_slots.empty() && !m_workers.empty() && m_config.stepSize > 0.0;
+}
@@ -0,0 +1,329 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_PARALLEL_SIMULATION_H
+#define TG_PARALLEL_SIMULATION_H
+
+/**
+ * @file tgParallelSimulation.h
+ * @brief Contains the definition of class tgParallelSimulation
+ * $Id$
+ */
+
+// This application
+#include "tgWorld.h"
+// The C++ Standard Library
+#include <deque>
+#include <string>
+#include <vector>
+// POSIX threads
+#include <pthread.h>
+
+// Forward declarations
+class tgGround;
+class tgSimulation;
+class tgStopPredicate;
+
+/**
+ * Runs trials in several independent worlds at once, one world per
+ * tgParallelSimulation::Episode, on a pool of worker threads. Each
+ * world keeps its models between trials and is reset between them,
+ * just as a learning app's serial run()/reset() loop would, or with
+ * Config::restoreSnapshot restored to its state after setup.
+ *
+ * Trials are handed out as worlds come free, and stop predicates from
+ * Episode::getStopPredicates end them early, so trial lengths vary.
+ * With Config::chunkSteps, trials run a chunk of steps at a time: each
+ * world is queued on its home worker between chunks, and a worker with
+ * an empty queue steals a world from another's. Given more episodes
+ * than threads, long trials then progress alongside short ones rather
+ * than starting last, and a batch takes about its total work divided
+ * by the threads.
+ *
+ * With Config::pinThreads, each worker is pinned to a core, spread
+ * evenly over the NUMA nodes. Worlds are usually created by their home
+ * worker, so the kernel's first-touch policy then puts the world's
+ * bodies, shapes, sensor frames and logs on that worker's node; a
+ * stolen chunk trades this locality for an idle core. getNodeStats
+ * reports the throughput of each node.
+ *
+ * When tgTraceRecorder is on, each worker records its chunks, stolen
+ * chunks and idle waits, so a trace shows where the pool ran short of
+ * work.
+ *
+ * Each world is stepped by one thread only, but Bullet's built-in
+ * profiler is a global object. Build Bullet and NTRT with
+ * -DBT_NO_PROFILE when running more than one world at a time.
+ */
+class tgParallelSimulation
+{
+public:
+
+    /**
+     * The application side of one world. An Episode is called from one
+     * worker thread at a time, and trials are handed out in increasing
+     * order, so an Episode only needs to be thread safe with respect to
+     * whatever it shares with other Episodes.
+     */
+    class Episode
+    {
+    public:
+
+        virtual ~Episode() { }
+
+        /**
+         * Create the ground for this episode's world. The world takes
+         * ownership. The default is a tgBoxGround.
+         */
+        virtual tgGround* createGround();
+
+        /**
+         * Create this episode's models and add them to the simulation.
+         * Called once, just before the world's first trial.
+         * @param[in,out] simulation the simulation for this world
+         */
+        virtual void setup(tgSimulation& simulation) = 0;
+
+        /**
+         * Called before a trial is set up, so controllers can pick up
+         * their parameters in onSetup.
+         * @param[in] trial the index of the trial within the call to run()
+         */
+        virtual void beginTrial(std::size_t trial) = 0;
+
+        /**
+         * Called once the world is set up, reset or restored for a
+         * trial, before getStopPredicates, e.g. to patch parameters of
+         * the live models. The default does nothing.
+         * @param[in,out] simulation the simulation for this world
+         * @param[in] trial the index of the trial within the call to run()
+         */
+        virtual void prepareTrial(tgSimulation& simulation, std::size_t trial) { }
+
+        /**
+         * The predicates that may end the coming trial early, checked
+         * every Config::checkInterval steps. Called after the world is
+         * set up or reset. The default is none.
+         * @return predicates that must outlive the trial; not owned
+         */
+        virtual std::vector<tgStopPredicate*> getStopPredicates()
+        {
+            return std::vector<tgStopPredicate*>();
+        }
+
+        /**
+         * Called after a trial has run, before the world is reset.
+         * @param[in] trial the index of the trial within the call to run()
+         */
+        virtual void endTrial(std::size_t trial) = 0;
+    };
+
+    /**
+     * Configuration shared by all worlds. This is Plain Old Data.
+     */
+    struct Config
+    {
+        Config(const tgWorld::Config& wc = tgWorld::Config(),
+               double ss = 1.0/1000.0, unsigned long rs = 0,
+               bool pt = false, int nt = 0, int cs = 0, int ci = 1,
+               bool rsn = false);
+
+        /** The configuration of every world */
+        tgWorld::Config worldConfig;
+
+        /** The timestep of every world, in seconds. Must be positive. */
+        double stepSize;
+
+        /**
+         * Before beginTrial, the worker's tgRandom::forThread() stream
+         * is seeded with tgRandom::deriveSeed(randomSeed, trial), so a
+         * trial's noise does not depend on which world runs it. The
+         * stream follows a trial from chunk to chunk.
+         */
+        unsigned long randomSeed;
+
+        /**
+         * Pin each worker thread to its own core, spread over the NUMA
+         * nodes, before it creates its world. Only done on Linux, and
+         * workers share cores once there are more workers than cores.
+         */
+        bool pinThreads;
+
+        /**
+         * The worker threads; 0 for one per episode. Must not be
+         * negative.
+         */
+        int numThreads;
+
+        /**
+         * Steps a world runs before it is queued again, so an idle
+         * worker can take it; 0 runs each trial in one go. Must not be
+         * negative.
+         */
+        int chunkSteps;
+
+        /** Steps between checks of the stop predicates. Must be positive. */
+        int checkInterval;
+
+        /**
+         * Between trials, restore each world to a snapshot taken right
+         * after Episode::setup rather than reset it, so the models are
+         * not torn down and rebuilt. Controllers that keep their own
+         * state must then be reset in prepareTrial.
+         */
+        bool restoreSnapshot;
+    };
+
+    /** The throughput of the workers on one NUMA node */
+    struct NodeStats
+    {
+        /** The node, or -1 for workers that are not pinned */
+        int node;
+
+        /** The workers on this node */
+        std::size_t workers;
+
+        /** The trials they have run */
+        std::size_t trials;
+
+        /** The steps they have run */
+        unsigned long steps;
+
+        /** The wall-clock seconds they spent running trials, summed */
+        double seconds;
+
+        /** steps / seconds, per worker */
+        double stepsPerSecond() const
+        {
+            return seconds > 0.0 ? steps / seconds : 0.0;
+        }
+    };
+
+    /**
+     * Start the worker threads. The worlds are created by the workers
+     * when their first trials are run.
+     * @param[in] config the configuration of every world
+     * @param[in] episodes one per world; must not be empty and must
+     * outlive this object. We do not take ownership.
+     */
+    tgParallelSimulation(const Config& config,
+                         const std::vector<Episode*>& episodes);
+
+    /** Stop the workers and delete the worlds. */
+    ~tgParallelSimulation();
+
+    /**
+     * Run trials 0 to trials - 1 across the worlds, blocking until
+     * every one of them has finished.
+     * @param[in] trials the number of trials
+     * @param[in] steps the number of steps in each trial, must be positive
+     * @throw std::runtime_error if a trial threw; the remaining trials
+     * still run
+     */
+    void run(std::size_t trials, int steps);
+
+    /**
+     * The number of worlds trials are spread across.
+     */
+    std::size_t size() const
+    {
+        return m_slots.size();
+    }
+
+    /**
+     * The throughput of each NUMA node's workers over every run so far,
+     * in increasing order of node. Only call between runs.
+     */
+    std::vector<NodeStats> getNodeStats() const;
+
+    /** The number of worker threads */
+    std::size_t getNumThreads() const
+    {
+        return m_workers.size();
+    }
+
+private:
+
+    /** One world and the trial it is running */
+    class Slot;
+
+    /** A worker thread and the queue of its home worlds */
+    class Worker;
+
+    /**
+     * The next world for a worker: its own queue's front, or else
+     * another's back. Takes a new trial for a world between trials.
+     * Called with m_mutex held.
+     * @return NULL if there is no work
+     */
+    Slot* takeWork(Worker& worker);
+
+    /**
+     * Run a chunk of a world's trial, starting the trial if it is new.
+     * Called without m_mutex.
+     * @return true if the trial finished
+     */
+    bool runChunk(Worker& worker, Slot& slot, std::string& error);
+
+    /** The worker loop */
+    void work(Worker& worker);
+
+    /** pthread entry point; arg is a Worker */
+    static void* workerMain(void* arg);
+
+    /** Integrity predicate */
+    bool invariant() const;
+
+    /** Not copyable */
+    tgParallelSimulation(const tgParallelSimulation&);
+    tgParallelSimulation& operator=(const tgParallelSimulation&);
+
+private:
+
+    const Config m_config;
+
+    /** We own these */
+    std::vector<Slot*> m_slots;
+
+    /** We own these */
+    std::vector<Worker*> m_workers;
+
+    /** Guards everything below, and the queues of the workers */
+    mutable pthread_mutex_t m_mutex;
+
+    /**
+     * Signalled when a batch starts, a world is queued or the workers
+     * should exit
+     */
+    pthread_cond_t m_workReady;
+
+    /** Signalled when the last trial of a batch finishes */
+    pthread_cond_t m_workDone;
+
+    std::size_t m_numTrials;
+    std::size_t m_nextTrial;
+    std::size_t m_finishedTrials;
+    int m_steps;
+
+    /** The first error thrown by a trial in the current batch */
+    std::string m_error;
+
+    bool m_shutdown;
+};
+
+#endif  // TG_PARALLEL_SIMULATION_H
@@ -0,0 +1,153 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgPipelineWorker.cpp
+ * @brief Contains the definitions of members of class tgPipelineWorker
+ * $Id$
+ */
+
+// This module
+#include "tgPipelineWorker.h"
+// The C++ Standard Library
+#include <exception>
+#include <stdexcept>
+
+tgPipelineWorker::tgPipelineWorker() :
+m_pTask(NULL),
+m_stopping(false),
+m_failed(false)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_taskStarted, NULL);
+    pthread_cond_init(&m_taskDone, NULL);
+
+    if (pthread_create(&m_thread, NULL, workerMain, this) != 0)
+    {
+        pthread_cond_destroy(&m_taskDone);
+        pthread_cond_destroy(&m_taskStarted);
+        pthread_mutex_destroy(&m_mutex);
+        throw std::runtime_error("Could not start the pipeline thread");
+    }
+}
+
+tgPipelineWorker::~tgPipelineWorker()
+{
+    pthread_mutex_lock(&m_mutex);
+    while (m_pTask != NULL)
+    {
+        pthread_cond_wait(&m_taskDone, &m_mutex);
+    }
+    m_stopping = true;
+    pthread_cond_signal(&m_taskStarted);
+    pthread_mutex_unlock(&m_mutex);
+
+    pthread_join(m_thread, NULL);
+    pthread_cond_destroy(&m_taskDone);
+    pthread_cond_destroy(&m_taskStarted);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void tgPipelineWorker::start(Task& task)
+{
+    pthread_mutex_lock(&m_mutex);
+    if (m_pTask != NULL)
+    {
+        pthread_mutex_unlock(&m_mutex);
+        throw std::logic_error("A pipeline task is already running");
+    }
+    m_pTask = &task;
+    pthread_cond_signal(&m_taskStarted);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void tgPipelineWorker::wait()
+{
+    pthread_mutex_lock(&m_mutex);
+    while (m_pTask != NULL)
+    {
+        pthread_cond_wait(&m_taskDone, &m_mutex);
+    }
+    const bool failed = m_failed;
+    const std::string error = m_error;
+    m_failed = false;
+    m_error.clear();
+    pthread_mutex_unlock(&m_mutex);
+
+    if (failed)
+    {
+        throw std::runtime_error("Pipeline task failed: " + error);
+    }
+}
+
+bool tgPipelineWorker::isBusy() const
+{
+    pthread_mutex_lock(&m_mutex);
+    const bool busy = m_pTask != NULL;
+    pthread_mutex_unlock(&m_mutex);
+    return busy;
+}
+
+void tgPipelineWorker::work()
+{
+    pthread_mutex_lock(&m_mutex);
+    while (true)
+    {
+        while (m_pTask == NULL && !m_stopping)
+        {
+            pthread_cond_wait(&m_taskStarted, &m_mutex);
+        }
+        if (m_pTask == NULL)
+        {
+            break;
+        }
+        Task* const pTask = m_pTask;
+        pthread_mutex_unlock(&m_mutex);
+
+        bool failed = false;
+        std::string error;
+        try
+        {
+            pTask->run();
+        }
+        catch (const std::exception& e)
+        {
+            failed = true;
+            error = e.what();
+        }
+        catch (...)
+        {
+            failed = true;
+            error = "unknown exception";
+        }
+
+        pthread_mutex_lock(&m_mutex);
+        m_failed = failed;
+        m_error = error;
+        m_pTask = NULL;
+        pthread_cond_signal(&m_taskDone);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void* tgPipelineWorker::workerMain(void* arg)
+{
+    static_cast<tgPipelineWorker*>(arg)->work();
+    return NULL;
+}
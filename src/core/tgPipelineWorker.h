@@ -0,0 +1,114 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_PIPELINE_WORKER_H
+#define TG_PIPELINE_WORKER_H
+
+/**
+ * @file tgPipelineWorker.h
+ * @brief Contains the definition of class tgPipelineWorker
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <string>
+// POSIX threads
+#include <pthread.h>
+
+/**
+ * One background thread that runs one task at a time, for work that
+ * overlaps the simulation thread until the owner waits for it. Used by
+ * tgPipelinedObserver to compute control commands while the world
+ * steps.
+ *
+ * An exception thrown by a task is caught on the worker thread and
+ * thrown again, as a std::runtime_error, from the next wait.
+ */
+class tgPipelineWorker
+{
+public:
+
+    /** Something to run on the worker thread */
+    class Task
+    {
+    public:
+        virtual ~Task() { }
+
+        virtual void run() = 0;
+    };
+
+    /**
+     * Start the thread, which sleeps until a task is started.
+     * @throw std::runtime_error if the thread cannot be started
+     */
+    tgPipelineWorker();
+
+    /** Waits for any running task, ignoring its errors, and stops */
+    ~tgPipelineWorker();
+
+    /**
+     * Run a task on the worker thread and return without waiting for it.
+     * @param[in] task must outlive the matching wait
+     * @throw std::logic_error if a task is already running
+     */
+    void start(Task& task);
+
+    /**
+     * Wait until the running task, if any, has returned.
+     * @throw std::runtime_error if the task threw
+     */
+    void wait();
+
+    /** True from start until the task returns */
+    bool isBusy() const;
+
+private:
+
+    /** The worker loop */
+    void work();
+
+    /** pthread entry point; arg is the worker */
+    static void* workerMain(void* arg);
+
+    /** Not copyable */
+    tgPipelineWorker(const tgPipelineWorker&);
+    tgPipelineWorker& operator=(const tgPipelineWorker&);
+
+    pthread_t m_thread;
+
+    /** Guards everything below */
+    mutable pthread_mutex_t m_mutex;
+
+    /** Signalled when a task is started or the worker should exit */
+    pthread_cond_t m_taskStarted;
+
+    /** Signalled when a task has returned */
+    pthread_cond_t m_taskDone;
+
+    /** The running task, or NULL */
+    Task* m_pTask;
+
+    bool m_stopping;
+
+    /** Set if the last task threw, with what it said */
+    bool m_failed;
+    std::string m_error;
+};
+
+#endif  // TG_PIPELINE_WORKER_H
@@ -0,0 +1,196 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_PIPELINED_OBSERVER_H
+#define TG_PIPELINED_OBSERVER_H
+
+/**
+ * @file tgPipelinedObserver.h
+ * @brief Definition of class tgPipelinedObserver
+ * $Id$
+ */
+
+// This application
+#include "tgObserver.h"
+#include "tgPipelineWorker.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <stdexcept>
+
+/**
+ * A controller split into three parts, so that its computation can
+ * overlap the physics. On each step sense() copies what the controller
+ * needs out of the subject, compute() works out commands from that copy
+ * alone, and apply() gives the commands to the subject's actuators.
+ *
+ * Pipelined, compute() runs on a worker thread while the simulation
+ * thread carries on with the rest of the step and the next world step.
+ * The commands computed from the state of step n are applied at the
+ * start of the controller's step n + 1, before it senses again, so
+ * everything it commands lags by one control period, as on the
+ * hardware. Nothing is applied on the first step after setup. Not
+ * pipelined, the three run in order on every step with no lag, so the
+ * same controller can be run either way and the two compared.
+ *
+ * compute() must not touch the subject, or anything else the
+ * simulation thread uses, since it runs while the world steps; sense()
+ * and apply() run on the simulation thread. To compute at a lower rate
+ * than the world steps, and so have a whole control period to overlap,
+ * wrap the controller in a tgDecimatedObserver.
+ *
+ * Derived classes that override onSetup or onTeardown should call these
+ * versions, and a derived destructor should call finish() while its
+ * members are still there for a running compute().
+ */
+template <class Subject>
+class tgPipelinedObserver : public tgObserver<Subject>,
+                            private tgPipelineWorker::Task
+{
+public:
+
+    /**
+     * @param[in] pipelined true to compute on a worker thread with a one
+     * step lag, false to compute in step
+     * @throw std::runtime_error if the worker thread cannot be started
+     */
+    explicit tgPipelinedObserver(bool pipelined = true) :
+    m_pWorker(pipelined ? new tgPipelineWorker() : NULL),
+    m_pending(false),
+    m_dt(0.0)
+    {
+    }
+
+    /** Waits for a running compute() */
+    virtual ~tgPipelinedObserver()
+    {
+        delete m_pWorker;
+    }
+
+    virtual void onSetup(Subject& subject)
+    {
+        finish();
+    }
+
+    /** Commands not yet applied are dropped */
+    virtual void onTeardown(Subject& subject)
+    {
+        finish();
+    }
+
+    /**
+     * Apply the commands computed on the previous step, if any, then
+     * sense and start computing the next.
+     * @param[in,out] subject the subject being observed
+     * @param[in] dt the number of seconds since the previous step
+     * @throw std::runtime_error if the previous compute() threw
+     */
+    virtual void onStep(Subject& subject, double dt)
+    {
+        if (m_pWorker == NULL)
+        {
+            sense(subject, dt);
+            compute(dt);
+            apply(subject);
+            return;
+        }
+
+        if (m_pending)
+        {
+            m_pending = false;
+            m_pWorker->wait();
+            apply(subject);
+        }
+        sense(subject, dt);
+        m_dt = dt;
+        m_pWorker->start(*this);
+        m_pending = true;
+    }
+
+    bool isPipelined() const
+    {
+        return m_pWorker != NULL;
+    }
+
+protected:
+
+    /**
+     * Copy what compute() needs out of the subject. On the simulation
+     * thread, with no compute() running.
+     * @param[in] subject the subject being observed
+     * @param[in] dt the number of seconds since the previous step
+     */
+    virtual void sense(Subject& subject, double dt) = 0;
+
+    /**
+     * Work out commands from what sense() copied. Pipelined, on the
+     * worker thread.
+     * @param[in] dt as given to the matching sense()
+     */
+    virtual void compute(double dt) = 0;
+
+    /**
+     * Give the commands from the last compute() to the subject. On the
+     * simulation thread, with no compute() running.
+     * @param[in,out] subject the subject being observed
+     */
+    virtual void apply(Subject& subject) = 0;
+
+    /**
+     * Wait for a running compute() and drop its commands, ignoring what
+     * it threw. The next step applies nothing.
+     */
+    void finish()
+    {
+        if (m_pending)
+        {
+            m_pending = false;
+            try
+            {
+                m_pWorker->wait();
+            }
+            catch (const std::runtime_error&)
+            {
+                // The commands are being dropped anyway
+            }
+        }
+    }
+
+private:
+
+    /** Run on the worker thread */
+    virtual void run()
+    {
+        compute(m_dt);
+    }
+
+    /** Not copyable */
+    tgPipelinedObserver(const tgPipelinedObserver&);
+    tgPipelinedObserver& operator=(const tgPipelinedObserver&);
+
+    /** Owned; NULL when not pipelined */
+    tgPipelineWorker* const m_pWorker;
+
+    /** True while a compute() has been started and not applied */
+    bool m_pending;
+
+    /** The dt for the running compute() */
+    double m_dt;
+};
+
+#endif  // TG_PIPELINED_OBSERVER_H
@@ -0,0 +1,212 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgProfileReport.cpp
+ * @brief Contains the definitions of members of class tgProfileReport
+ * $Id$
+ */
+
+// This module
+#include "tgProfileReport.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+
+namespace
+{
+
+    /** The child of a scope with a name, added if there isn't one */
+    tgProfileReport::Scope& child(tgProfileReport::Scope& parent,
+                                  const std::string& name)
+    {
+        for (std::size_t i = 0; i < parent.children.size(); i++)
+        {
+            if (parent.children[i].name == name)
+            {
+                return parent.children[i];
+            }
+        }
+        parent.children.push_back(tgProfileReport::Scope(name));
+        return parent.children.back();
+    }
+
+#ifndef BT_NO_PROFILE
+    /** Add the children of the iterator's current node to scope */
+    void accumulate(CProfileIterator& it, tgProfileReport::Scope& scope)
+    {
+        std::vector<int> entered;
+        int index = 0;
+        for (it.First(); !it.Is_Done(); it.Next(), index++)
+        {
+            if (it.Get_Current_Total_Calls() > 0)
+            {
+                entered.push_back(index);
+            }
+        }
+        for (std::size_t i = 0; i < entered.size(); i++)
+        {
+            // Enter_Child counts from the first child
+            it.Enter_Child(entered[i]);
+            tgProfileReport::Scope& c =
+                child(scope, it.Get_Current_Parent_Name());
+            c.calls += it.Get_Current_Parent_Total_Calls();
+            c.totalMilliseconds += it.Get_Current_Parent_Total_Time();
+            accumulate(it, c);
+            it.Enter_Parent();
+        }
+    }
+#endif // BT_NO_PROFILE
+
+    std::string jsonString(const std::string& s)
+    {
+        std::string quoted = "\"";
+        for (std::size_t i = 0; i < s.size(); i++)
+        {
+            if (s[i] == '"' || s[i] == '\\')
+            {
+                quoted += '\\';
+            }
+            quoted += s[i];
+        }
+        return quoted + "\"";
+    }
+
+    std::string csvString(const std::string& s)
+    {
+        std::string quoted = "\"";
+        for (std::size_t i = 0; i < s.size(); i++)
+        {
+            if (s[i] == '"')
+            {
+                quoted += '"';
+            }
+            quoted += s[i];
+        }
+        return quoted + "\"";
+    }
+
+    void writeJSON(std::ostream& os, const tgProfileReport::Scope& scope,
+                   const std::string& indent)
+    {
+        os << indent << "{\"name\": " << jsonString(scope.name)
+           << ", \"calls\": " << scope.calls
+           << ", \"totalMilliseconds\": " << scope.totalMilliseconds
+           << ", \"selfMilliseconds\": " << scope.selfMilliseconds()
+           << ", \"children\": [";
+        for (std::size_t i = 0; i < scope.children.size(); i++)
+        {
+            os << (i == 0 ? "\n" : ",\n");
+            writeJSON(os, scope.children[i], indent + "  ");
+        }
+        if (!scope.children.empty())
+        {
+            os << "\n" << indent;
+        }
+        os << "]}";
+    }
+
+    void writeCSV(std::ostream& os, const tgProfileReport::Scope& scope,
+                  const std::string& path)
+    {
+        for (std::size_t i = 0; i < scope.children.size(); i++)
+        {
+            const tgProfileReport::Scope& c = scope.children[i];
+            const std::string p = path.empty() ? c.name : path + "/" + c.name;
+            os << csvString(p) << "," << c.calls << ","
+               << c.totalMilliseconds << "," << c.selfMilliseconds() << "\n";
+            writeCSV(os, c, p);
+        }
+    }
+
+} // namespace
+
+tgProfileReport::Scope::Scope(const std::string& n) :
+    name(n),
+    calls(0),
+    totalMilliseconds(0.0)
+{
+}
+
+double tgProfileReport::Scope::selfMilliseconds() const
+{
+    double self = totalMilliseconds;
+    for (std::size_t i = 0; i < children.size(); i++)
+    {
+        self -= children[i].totalMilliseconds;
+    }
+    // The children are timed separately, so allow for rounding
+    return self > 0.0 ? self : 0.0;
+}
+
+tgProfileReport::tgProfileReport() :
+    m_root("root")
+{
+}
+
+void tgProfileReport::harvest()
+{
+#ifndef BT_NO_PROFILE
+    CProfileIterator* const pIterator = CProfileManager::Get_Iterator();
+    accumulate(*pIterator, m_root);
+    CProfileManager::Release_Iterator(pIterator);
+    CProfileManager::Reset();
+#endif // BT_NO_PROFILE
+}
+
+void tgProfileReport::clear()
+{
+    m_root = Scope("root");
+}
+
+void tgProfileReport::write(std::ostream& os, Format format) const
+{
+    // The root's time is that of its children
+    Scope root = m_root;
+    root.totalMilliseconds = 0.0;
+    for (std::size_t i = 0; i < root.children.size(); i++)
+    {
+        root.totalMilliseconds += root.children[i].totalMilliseconds;
+    }
+
+    if (format == eJSON)
+    {
+        writeJSON(os, root, "");
+        os << std::endl;
+    }
+    else
+    {
+        os << "scope,calls,totalMilliseconds,selfMilliseconds\n";
+        writeCSV(os, root, "");
+        os.flush();
+    }
+}
+
+void tgProfileReport::write(const std::string& fileName, Format format) const
+{
+    std::ofstream file(fileName.c_str());
+    write(file, format);
+    if (!file)
+    {
+        throw std::runtime_error("Could not write the profile to " + fileName);
+    }
+}
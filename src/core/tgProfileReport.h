@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_PROFILE_REPORT_H
+#define TG_PROFILE_REPORT_H
+
+/**
+ * @file tgProfileReport.h
+ * @brief Contains the definition of class tgProfileReport
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/**
+ * Totals of Bullet's hierarchical profiler (the BT_PROFILE scopes and
+ * CProfileManager) over a whole run. Bullet resets its tree at the start
+ * of every world step, so tgSimulation harvests it around each step: the
+ * calls and times since the last harvest are added to the scope with the
+ * same path here, and Bullet's tree is reset.
+ *
+ * Without the profiler, i.e. with BT_NO_PROFILE defined, harvest does
+ * nothing and the report stays empty.
+ */
+class tgProfileReport
+{
+public:
+
+    /** How write formats the report */
+    enum Format
+    {
+        /** Nested objects, one per scope */
+        eJSON,
+        /** One row per scope, the scope given by its path */
+        eCSV
+    };
+
+    /** A profiled scope and the scopes entered from it */
+    struct Scope
+    {
+        Scope(const std::string& n = "");
+
+        /** The name given to BT_PROFILE */
+        std::string name;
+        unsigned long calls;
+        /** Including the time in children */
+        double totalMilliseconds;
+        std::vector<Scope> children;
+
+        /** totalMilliseconds less that of the children */
+        double selfMilliseconds() const;
+    };
+
+    tgProfileReport();
+
+    /** Add Bullet's tree to the totals, then reset it */
+    void harvest();
+
+    /** Forget the totals */
+    void clear();
+
+    /** The scopes entered outside any other, as children of a root */
+    const Scope& getRoot() const
+    {
+        return m_root;
+    }
+
+    /**
+     * Write the totals.
+     * @param[out] os written to in the given format
+     * @param[in] format eJSON or eCSV
+     */
+    void write(std::ostream& os, Format format) const;
+
+    /**
+     * Write the totals to a file.
+     * @param[in] fileName overwritten
+     * @param[in] format eJSON or eCSV
+     * @throw std::runtime_error if the file can't be written
+     */
+    void write(const std::string& fileName, Format format) const;
+
+private:
+
+    Scope m_root;
+};
+
+#endif  // TG_PROFILE_REPORT_H
@@ -0,0 +1,206 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRandom.cpp
+ * @brief Contains the definitions of members of class tgRandom
+ * $Id$
+ */
+
+// This module
+#include "tgRandom.h"
+// The C++ Standard Library
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <pthread.h>
+#ifdef _WIN32
+#include <intrin.h>
+#endif
+
+namespace
+{
+    unsigned long long cycleCount()
+    {
+#ifdef _WIN32
+        return __rdtsc();
+#else
+        unsigned int lo, hi;
+        __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+        return ((unsigned long long)hi << 32) | lo;
+#endif
+    }
+
+    /** splitmix64's finalizer */
+    unsigned long long mix(unsigned long long x)
+    {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    pthread_key_t threadKey;
+    pthread_once_t threadKeyOnce = PTHREAD_ONCE_INIT;
+
+    void deleteThreadStream(void* pStream)
+    {
+        delete static_cast<tgRandom*>(pStream);
+    }
+
+    void createThreadKey()
+    {
+        pthread_key_create(&threadKey, deleteThreadStream);
+    }
+}
+
+tgRandom::tgRandom(unsigned long seed) :
+m_seed(seed)
+{
+    m_engine.seed(seed);
+}
+
+void tgRandom::seed(unsigned long seed)
+{
+    m_seed = seed;
+    m_engine.seed(seed);
+}
+
+double tgRandom::uniform()
+{
+    std::tr1::uniform_real<double> unif(0, 1);
+    return unif(m_engine);
+}
+
+double tgRandom::uniform(double min, double max)
+{
+    return min + (max - min) * uniform();
+}
+
+double tgRandom::normal(double mean, double stdDev)
+{
+    std::tr1::normal_distribution<double> dist(mean, stdDev);
+    return dist(m_engine);
+}
+
+std::size_t tgRandom::index(std::size_t n)
+{
+    if (n == 0)
+    {
+        throw std::invalid_argument("Cannot pick an index from nothing");
+    }
+    const std::size_t i = static_cast<std::size_t>(uniform() * n);
+    // Guard against rounding up to n
+    return i < n ? i : n - 1;
+}
+
+std::string tgRandom::getState() const
+{
+    // libstdc++ writes the engine's lags but not its position within
+    // them, so write them rotated to start at the position instead. The
+    // recurrence only depends on the lags relative to the position.
+    std::ostringstream raw;
+    raw << m_engine;
+    std::istringstream in(raw.str());
+    std::vector<unsigned long> words;
+    unsigned long word;
+    while (in >> word)
+    {
+        words.push_back(word);
+    }
+    const unsigned long carry = words.back();
+    words.pop_back();
+    const std::size_t lags = Engine::long_lag;
+    const std::size_t perLag = words.size() / lags;
+
+    // Find the rotation that continues the same sequence
+    Engine ahead(m_engine);
+    double expected[4];
+    for (std::size_t i = 0; i < 4; i++)
+    {
+        expected[i] = ahead();
+    }
+    for (std::size_t k = 0; k < lags; k++)
+    {
+        std::ostringstream rotated;
+        for (std::size_t i = 0; i < lags; i++)
+        {
+            const std::size_t lag = (k + i) % lags;
+            for (std::size_t j = 0; j < perLag; j++)
+            {
+                rotated << words[lag * perLag + j] << " ";
+            }
+        }
+        rotated << carry;
+
+        Engine candidate;
+        std::istringstream cs(rotated.str());
+        cs >> candidate;
+        bool same = true;
+        for (std::size_t i = 0; i < 4 && same; i++)
+        {
+            same = candidate() == expected[i];
+        }
+        if (same)
+        {
+            std::ostringstream os;
+            os << m_seed << " " << rotated.str();
+            return os.str();
+        }
+    }
+    throw std::logic_error("Could not find the position of the engine");
+}
+
+void tgRandom::setState(const std::string& state)
+{
+    std::istringstream is(state);
+    unsigned long seed;
+    Engine engine;
+    is >> seed >> engine;
+    if (is.fail())
+    {
+        throw std::invalid_argument("Not a tgRandom state");
+    }
+    m_seed = seed;
+    m_engine = engine;
+}
+
+unsigned long tgRandom::deriveSeed(unsigned long seed, unsigned long index)
+{
+    return static_cast<unsigned long>(mix(mix(seed) ^ index));
+}
+
+unsigned long tgRandom::entropySeed()
+{
+    // Two calls within the same cycle count must still differ
+    static unsigned long calls = 0;
+    return deriveSeed(static_cast<unsigned long>(cycleCount()),
+                      __sync_fetch_and_add(&calls, 1));
+}
+
+tgRandom& tgRandom::forThread()
+{
+    pthread_once(&threadKeyOnce, createThreadKey);
+    tgRandom* pStream = static_cast<tgRandom*>(pthread_getspecific(threadKey));
+    if (pStream == NULL)
+    {
+        pStream = new tgRandom(entropySeed());
+        pthread_setspecific(threadKey, pStream);
+    }
+    return *pStream;
+}
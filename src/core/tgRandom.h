@@ -0,0 +1,132 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_RANDOM_H
+#define TG_RANDOM_H
+
+/**
+ * @file tgRandom.h
+ * @brief Contains the definition of class tgRandom
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <tr1/random>
+
+/**
+ * An explicitly seeded random number stream. Unlike rand(), each stream
+ * has its own state, so worlds or learning runs on different threads do
+ * not race on it and a run can be repeated from its seed.
+ *
+ * Streams that must be independent but reproducible, such as one per
+ * trial or per world, should be seeded with deriveSeed(seed, index).
+ * Code that has no stream passed to it, such as controller noise, can
+ * use forThread(), which tgParallelSimulation reseeds before each trial.
+ *
+ * The engine is the one the learning libraries have always used, so it
+ * can still be handed to the neural network's mutate functions.
+ */
+class tgRandom
+{
+public:
+
+    /** The underlying generator */
+    typedef std::tr1::ranlux64_base_01 Engine;
+
+    /**
+     * Start a stream.
+     * @param[in] seed the same seed always gives the same sequence
+     */
+    explicit tgRandom(unsigned long seed);
+
+    /**
+     * Restart the stream as if it had just been constructed.
+     * @param[in] seed the new seed
+     */
+    void seed(unsigned long seed);
+
+    /** The seed of the stream, for logging a run so it can be repeated */
+    unsigned long getSeed() const
+    {
+        return m_seed;
+    }
+
+    /** A uniform sample from [0, 1) */
+    double uniform();
+
+    /** A uniform sample from [min, max) */
+    double uniform(double min, double max);
+
+    /** A sample from a normal distribution */
+    double normal(double mean, double stdDev);
+
+    /**
+     * A uniform index from 0 to n - 1, the replacement for rand() % n.
+     * @throw std::invalid_argument if n is 0
+     */
+    std::size_t index(std::size_t n);
+
+    /**
+     * The seed and the exact position in the stream, for checkpoints.
+     * @return text that setState accepts
+     */
+    std::string getState() const;
+
+    /**
+     * Continue from a position saved by getState.
+     * @throw std::invalid_argument if state was not made by getState
+     */
+    void setState(const std::string& state);
+
+    /** The generator, for the tr1 distributions */
+    Engine& engine()
+    {
+        return m_engine;
+    }
+
+    /**
+     * Mix a seed and a stream index into a new seed, so that nearby
+     * indices give unrelated streams.
+     * @param[in] seed the seed of the whole run
+     * @param[in] index the stream, such as a trial or world number
+     */
+    static unsigned long deriveSeed(unsigned long seed, unsigned long index);
+
+    /**
+     * A seed that differs between calls and between runs, for runs that
+     * are not meant to be repeated. This is what the learning libraries
+     * used to pass to srand.
+     */
+    static unsigned long entropySeed();
+
+    /**
+     * The calling thread's stream. It is created on first use with an
+     * entropySeed() unless the thread has seeded it.
+     */
+    static tgRandom& forThread();
+
+private:
+
+    Engine m_engine;
+
+    unsigned long m_seed;
+};
+
+#endif  // TG_RANDOM_H
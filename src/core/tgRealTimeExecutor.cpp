@@ -0,0 +1,168 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgRealTimeExecutor.cpp
+ * @brief Contains the definitions of members of class tgRealTimeExecutor
+ * $Id$
+ */
+
+// This module
+#include "tgRealTimeExecutor.h"
+// This application
+#include "tgSimulation.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <stdexcept>
+// POSIX clocks
+#include <time.h>
+
+namespace
+{
+    const long kNanosecondsPerSecond = 1000000000L;
+
+    /** Nanoseconds on the monotonic clock */
+    long long now()
+    {
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return (long long) t.tv_sec * kNanosecondsPerSecond + t.tv_nsec;
+    }
+
+    /** Sleep until an absolute time on the monotonic clock */
+    void sleepUntil(long long deadline)
+    {
+        timespec t;
+        t.tv_sec = deadline / kNanosecondsPerSecond;
+        t.tv_nsec = deadline % kNanosecondsPerSecond;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR)
+        {
+        }
+    }
+}
+
+tgRealTimeExecutor::Config::Config(double ss, int mc) :
+stepSize(ss),
+maxCatchUpSteps(mc)
+{
+}
+
+tgRealTimeExecutor::JitterStats::JitterStats() :
+steps(0),
+meanLateness(0.0),
+maxLateness(0.0),
+stdDevLateness(0.0),
+maxStepTime(0.0),
+overruns(0),
+resyncs(0)
+{
+}
+
+tgRealTimeExecutor::tgRealTimeExecutor(tgSimulation& simulation,
+                                       const Config& config) :
+m_simulation(simulation),
+m_config(config),
+m_stopRequested(false),
+m_time(0.0),
+m_sumLateness(0.0),
+m_sumLateness2(0.0)
+{
+    if (!(m_config.stepSize > 0.0))
+    {
+        throw std::invalid_argument("stepSize is not positive");
+    }
+    if (m_config.maxCatchUpSteps < 0)
+    {
+        throw std::invalid_argument("maxCatchUpSteps is negative");
+    }
+}
+
+void tgRealTimeExecutor::addHook(Hook* pHook)
+{
+    if (pHook == NULL)
+    {
+        throw std::invalid_argument("Hook is NULL");
+    }
+    m_hooks.push_back(pHook);
+}
+
+void tgRealTimeExecutor::resetStats()
+{
+    m_stats = JitterStats();
+    m_sumLateness = 0.0;
+    m_sumLateness2 = 0.0;
+}
+
+void tgRealTimeExecutor::run(int steps)
+{
+    m_stopRequested = false;
+    const long long period =
+        (long long) (m_config.stepSize * kNanosecondsPerSecond + 0.5);
+    long long deadline = now();
+    int lateSteps = 0;
+
+    for (int k = 0; (steps <= 0 || k < steps) && !m_stopRequested; k++)
+    {
+        sleepUntil(deadline);
+        const long long start = now();
+
+        for (std::size_t i = 0; i < m_hooks.size(); i++)
+        {
+            m_hooks[i]->beforeStep(m_time);
+        }
+        m_simulation.step(m_config.stepSize);
+        m_time += m_config.stepSize;
+        for (std::size_t i = 0; i < m_hooks.size(); i++)
+        {
+            m_hooks[i]->afterStep(m_time);
+        }
+
+        const long long end = now();
+        const double lateness = (double) (start - deadline) / kNanosecondsPerSecond;
+        const double stepTime = (double) (end - start) / kNanosecondsPerSecond;
+        m_stats.steps++;
+        m_sumLateness += lateness;
+        m_sumLateness2 += lateness * lateness;
+        m_stats.meanLateness = m_sumLateness / m_stats.steps;
+        m_stats.stdDevLateness =
+            std::sqrt(std::max(0.0, m_sumLateness2 / m_stats.steps -
+                               m_stats.meanLateness * m_stats.meanLateness));
+        m_stats.maxLateness = std::max(m_stats.maxLateness, lateness);
+        m_stats.maxStepTime = std::max(m_stats.maxStepTime, stepTime);
+
+        deadline += period;
+        if (end > deadline)
+        {
+            m_stats.overruns++;
+            if (++lateSteps > m_config.maxCatchUpSteps)
+            {
+                // Too far behind to catch up; keep time from here
+                deadline = end;
+                lateSteps = 0;
+                m_stats.resyncs++;
+            }
+        }
+        else
+        {
+            lateSteps = 0;
+        }
+    }
+}
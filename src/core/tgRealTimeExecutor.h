@@ -0,0 +1,174 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_REAL_TIME_EXECUTOR_H
+#define TG_REAL_TIME_EXECUTOR_H
+
+/**
+ * @file tgRealTimeExecutor.h
+ * @brief Contains the definition of class tgRealTimeExecutor
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgSimulation;
+
+/**
+ * Steps a tgSimulation in lock-step with wall-clock time, for
+ * hardware-in-the-loop runs where the controllers exchange commands and
+ * measurements with a robot (see tgUdpLink). Step k starts at the
+ * absolute deadline start + k * stepSize on the monotonic clock, so
+ * sleeping late once does not shift every later step.
+ *
+ * When a step runs past its successor's deadline, the late steps run
+ * back to back to catch up, up to Config::maxCatchUpSteps of them; after
+ * that the schedule starts again from the current time rather than
+ * racing to make up for a long stall.
+ */
+class tgRealTimeExecutor
+{
+public:
+
+    /**
+     * Called around every step from the executor's thread, e.g. to read
+     * the latest commands before the controllers run and to send the
+     * sensor frame after.
+     */
+    class Hook
+    {
+    public:
+        virtual ~Hook() { }
+
+        /**
+         * Called at the step's deadline, before the simulation steps.
+         * @param[in] time the simulated time the step starts at
+         */
+        virtual void beforeStep(double time) { }
+
+        /**
+         * Called after the simulation has stepped.
+         * @param[in] time the simulated time the step ended at
+         */
+        virtual void afterStep(double time) { }
+    };
+
+    /** This is Plain Old Data. */
+    struct Config
+    {
+        Config(double ss = 1.0/1000.0, int mc = 10);
+
+        /** Seconds of both simulated and wall-clock time per step */
+        double stepSize;
+        /**
+         * The most late steps run back to back before the schedule is
+         * started again from the current time. Must not be negative.
+         */
+        int maxCatchUpSteps;
+    };
+
+    /**
+     * How closely the steps kept to their deadlines, in seconds.
+     */
+    struct JitterStats
+    {
+        JitterStats();
+
+        /** The steps run */
+        std::size_t steps;
+        /** How late the steps started, from their deadlines */
+        double meanLateness;
+        double maxLateness;
+        double stdDevLateness;
+        /** The longest hooks plus simulation step */
+        double maxStepTime;
+        /** Steps that ended after the next step's deadline */
+        std::size_t overruns;
+        /** Times the schedule was started again */
+        std::size_t resyncs;
+    };
+
+    /**
+     * @param[in] simulation the simulation to step; not owned.
+     * @param[in] config the step size and catch-up limit
+     * @throw std::invalid_argument if config is out of range
+     */
+    tgRealTimeExecutor(tgSimulation& simulation,
+                       const Config& config = Config());
+
+    /**
+     * Add a hook, called in the order added.
+     * @param[in] pHook not owned; must outlive the runs
+     * @throw std::invalid_argument if pHook is NULL
+     */
+    void addHook(Hook* pHook);
+
+    /**
+     * Run on the current thread.
+     * @param[in] steps the number of steps; 0 or less to run until stop
+     * is called
+     */
+    void run(int steps);
+
+    /**
+     * Make run return after the step in progress. Safe to call from a
+     * hook, another thread or a signal handler.
+     */
+    void stop()
+    {
+        m_stopRequested = true;
+    }
+
+    /** The simulated time since construction */
+    double getTime() const
+    {
+        return m_time;
+    }
+
+    /** The statistics since construction or the last resetStats */
+    const JitterStats& getStats() const
+    {
+        return m_stats;
+    }
+
+    void resetStats();
+
+private:
+
+    tgSimulation& m_simulation;
+
+    const Config m_config;
+
+    std::vector<Hook*> m_hooks;
+
+    volatile bool m_stopRequested;
+
+    double m_time;
+
+    JitterStats m_stats;
+
+    /** Sums of the latenesses and their squares, for m_stats */
+    double m_sumLateness;
+    double m_sumLateness2;
+};
+
+#endif  // TG_REAL_TIME_EXECUTOR_H
@@ -0,0 +1,151 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRenderFrame.cpp
+ * @brief Contains the definitions of members of class tgRenderFrame
+ * $Id$
+ */
+
+// This module
+#include "tgRenderFrame.h"
+// The Bullet Physics library
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <cassert>
+#include <iostream>
+
+tgRenderFrame::tgRenderFrame() :
+m_time(0.0),
+m_debugMode(0)
+{
+}
+
+void tgRenderFrame::clear()
+{
+    m_lines.clear();
+    m_spheres.clear();
+    m_bodies.clear();
+    m_time = 0.0;
+}
+
+void tgRenderFrame::captureBodies(const btCollisionWorld& world)
+{
+    const btCollisionObjectArray& objects = world.getCollisionObjectArray();
+    for (int i = 0; i < objects.size(); i++)
+    {
+        const btCollisionObject* const pObject = objects[i];
+        if (btRigidBody::upcast(pObject) == NULL)
+        {
+            continue;
+        }
+        
+        // The same colours as DemoApplication::renderscene
+        btVector3 color = (i & 1) ? btVector3(0.0, 0.0, 1.0) : btVector3(1.0, 1.0, 0.5);
+        if (pObject->getActivationState() == ACTIVE_TAG)
+        {
+            color += (i & 1) ? btVector3(1.0, 0.0, 0.0) : btVector3(0.5, 0.0, 0.0);
+        }
+        else if (pObject->getActivationState() == ISLAND_SLEEPING)
+        {
+            color += (i & 1) ? btVector3(0.0, 1.0, 0.0) : btVector3(0.0, 0.5, 0.0);
+        }
+        
+        Body body;
+        body.pShape = pObject->getCollisionShape();
+        body.transform = pObject->getWorldTransform();
+        body.color = color;
+        m_bodies.push_back(body);
+    }
+}
+
+void tgRenderFrame::replay(btIDebugDraw& drawer,
+                           const tgRenderFrame& previous,
+                           double alpha) const
+{
+    const bool lerpLines = previous.m_lines.size() == m_lines.size();
+    for (std::size_t i = 0; i < m_lines.size(); i++)
+    {
+        const Line& line = m_lines[i];
+        if (lerpLines)
+        {
+            const Line& from = previous.m_lines[i];
+            drawer.drawLine(from.from.lerp(line.from, alpha),
+                            from.to.lerp(line.to, alpha),
+                            line.color);
+        }
+        else
+        {
+            drawer.drawLine(line.from, line.to, line.color);
+        }
+    }
+    
+    const bool lerpSpheres = previous.m_spheres.size() == m_spheres.size();
+    for (std::size_t i = 0; i < m_spheres.size(); i++)
+    {
+        const Sphere& sphere = m_spheres[i];
+        const btVector3 position = lerpSpheres ?
+            previous.m_spheres[i].position.lerp(sphere.position, alpha) :
+            sphere.position;
+        drawer.drawSphere(position, sphere.radius, sphere.color);
+    }
+}
+
+btTransform tgRenderFrame::bodyTransform(std::size_t i,
+                                         const tgRenderFrame& previous,
+                                         double alpha) const
+{
+    assert(i < m_bodies.size());
+    const btTransform& to = m_bodies[i].transform;
+    if (previous.m_bodies.size() != m_bodies.size() ||
+        previous.m_bodies[i].pShape != m_bodies[i].pShape)
+    {
+        return to;
+    }
+    const btTransform& from = previous.m_bodies[i].transform;
+    return btTransform(from.getRotation().slerp(to.getRotation(), alpha),
+                       from.getOrigin().lerp(to.getOrigin(), alpha));
+}
+
+void tgRenderFrame::drawLine(const btVector3& from,
+                             const btVector3& to,
+                             const btVector3& color)
+{
+    Line line;
+    line.from = from;
+    line.to = to;
+    line.color = color;
+    m_lines.push_back(line);
+}
+
+void tgRenderFrame::drawSphere(const btVector3& p,
+                               btScalar radius,
+                               const btVector3& color)
+{
+    Sphere sphere;
+    sphere.position = p;
+    sphere.radius = radius;
+    sphere.color = color;
+    m_spheres.push_back(sphere);
+}
+
+void tgRenderFrame::reportErrorWarning(const char* warningString)
+{
+    std::cerr << warningString << std::endl;
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_RENDER_FRAME_H
+#define TG_RENDER_FRAME_H
+
+/**
+ * @file tgRenderFrame.h
+ * @brief Contains the definition of class tgRenderFrame
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btIDebugDraw.h"
+#include "LinearMath/btTransform.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <vector>
+
+// Forward declarations
+class btCollisionShape;
+class btCollisionWorld;
+
+/**
+ * What one rendering of a world drew, kept so that it can be drawn again
+ * on another thread while the world carries on stepping. It is filled by
+ * using it as the debug drawer of a tgBulletRenderer pass, which records
+ * the cable lines and marker spheres, and by captureBodies, which records
+ * the rigid body transforms.
+ *
+ * The collision shapes are not copied, so a frame must not be drawn after
+ * the world it was captured from has been reset.
+ */
+class tgRenderFrame : public btIDebugDraw
+{
+public:
+
+    /** A rigid body as rendered */
+    struct Body
+    {
+        const btCollisionShape* pShape;
+        btTransform transform;
+        btVector3 color;
+    };
+
+    tgRenderFrame();
+
+    virtual ~tgRenderFrame() { }
+
+    /** Forget everything recorded, keeping the storage */
+    void clear();
+
+    /**
+     * Record the shape, transform and colour of every rigid body in a
+     * world, coloured by activation state as Bullet's demos do. Ghost
+     * objects are skipped, since contact cables rebuild their shapes
+     * every step.
+     * @param[in] world the world to capture
+     */
+    void captureBodies(const btCollisionWorld& world);
+
+    /** When the frame was published, in seconds on any steady clock */
+    double getTime() const
+    {
+        return m_time;
+    }
+
+    void setTime(double time)
+    {
+        m_time = time;
+    }
+
+    /**
+     * Draw the recorded lines and spheres again. When previous recorded
+     * as many, each is interpolated from its position there.
+     * @param[in,out] drawer the debug drawer to draw with
+     * @param[in] previous the frame before this one
+     * @param[in] alpha 0 to draw previous, 1 to draw this frame
+     */
+    void replay(btIDebugDraw& drawer,
+                const tgRenderFrame& previous,
+                double alpha) const;
+
+    const std::vector<Body>& getBodies() const
+    {
+        return m_bodies;
+    }
+
+    /**
+     * The i-th body's transform, interpolated from previous when previous
+     * recorded the same bodies.
+     * @param[in] i an index into getBodies()
+     * @param[in] previous the frame before this one
+     * @param[in] alpha 0 for previous, 1 for this frame
+     */
+    btTransform bodyTransform(std::size_t i,
+                              const tgRenderFrame& previous,
+                              double alpha) const;
+
+    /** @name btIDebugDraw */
+    /** @{ */
+    virtual void drawLine(const btVector3& from,
+                          const btVector3& to,
+                          const btVector3& color);
+
+    virtual void drawSphere(const btVector3& p,
+                            btScalar radius,
+                            const btVector3& color);
+
+    virtual void drawContactPoint(const btVector3& pointOnB,
+                                  const btVector3& normalOnB,
+                                  btScalar distance,
+                                  int lifeTime,
+                                  const btVector3& color) { }
+
+    virtual void reportErrorWarning(const char* warningString);
+
+    virtual void draw3dText(const btVector3& location,
+                            const char* textString) { }
+
+    virtual void setDebugMode(int debugMode)
+    {
+        m_debugMode = debugMode;
+    }
+
+    virtual int getDebugMode() const
+    {
+        return m_debugMode;
+    }
+    /** @} */
+
+private:
+
+    struct Line
+    {
+        btVector3 from;
+        btVector3 to;
+        btVector3 color;
+    };
+
+    struct Sphere
+    {
+        btVector3 position;
+        btScalar radius;
+        btVector3 color;
+    };
+
+    std::vector<Line> m_lines;
+
+    std::vector<Sphere> m_spheres;
+
+    std::vector<Body> m_bodies;
+
+    double m_time;
+
+    int m_debugMode;
+};
+
+#endif  // TG_RENDER_FRAME_H
@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRenderFrameBuffer.cpp
+ * @brief Contains the definitions of members of class tgRenderFrameBuffer
+ * $Id$
+ */
+
+// This module
+#include "tgRenderFrameBuffer.h"
+// The C++ Standard Library
+#include <algorithm>
+
+tgRenderFrameBuffer::tgRenderFrameBuffer() :
+m_pBack(&m_frames[0]),
+m_pPending(&m_frames[1]),
+m_pCurrent(&m_frames[2]),
+m_pPrevious(&m_frames[3]),
+m_fresh(false)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+}
+
+tgRenderFrameBuffer::~tgRenderFrameBuffer()
+{
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void tgRenderFrameBuffer::publish()
+{
+    pthread_mutex_lock(&m_mutex);
+    std::swap(m_pBack, m_pPending);
+    m_fresh = true;
+    pthread_mutex_unlock(&m_mutex);
+    
+    m_pBack->clear();
+}
+
+bool tgRenderFrameBuffer::acquire()
+{
+    pthread_mutex_lock(&m_mutex);
+    const bool fresh = m_fresh;
+    if (fresh)
+    {
+        // The old previous frame becomes the physics thread's next pending one
+        std::swap(m_pPrevious, m_pCurrent);
+        std::swap(m_pCurrent, m_pPending);
+        m_fresh = false;
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return fresh;
+}
+
+void tgRenderFrameBuffer::clear()
+{
+    for (std::size_t i = 0; i < 4; i++)
+    {
+        m_frames[i].clear();
+    }
+    m_fresh = false;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_RENDER_FRAME_BUFFER_H
+#define TG_RENDER_FRAME_BUFFER_H
+
+/**
+ * @file tgRenderFrameBuffer.h
+ * @brief Contains the definition of class tgRenderFrameBuffer
+ * $Id$
+ */
+
+// This application
+#include "tgRenderFrame.h"
+// The C++ Standard Library
+#include <pthread.h>
+
+/**
+ * Passes tgRenderFrames from a physics thread to a render thread without
+ * either waiting for the other. The physics thread fills back() and
+ * publishes it; the render thread acquires the most recently published
+ * frame and keeps the one before it for interpolation. Frames published
+ * while the render thread is busy are dropped. The lock is only held to
+ * swap pointers.
+ */
+class tgRenderFrameBuffer
+{
+public:
+
+    tgRenderFrameBuffer();
+
+    ~tgRenderFrameBuffer();
+
+    /** The frame the physics thread is filling */
+    tgRenderFrame& back()
+    {
+        return *m_pBack;
+    }
+
+    /**
+     * Physics thread: make back() the latest frame, and start a new
+     * back() with the storage of an unread one.
+     */
+    void publish();
+
+    /**
+     * Render thread: move on to the latest published frame, if there is
+     * one newer than current().
+     * @return true if current() changed
+     */
+    bool acquire();
+
+    /** The render thread's latest frame */
+    const tgRenderFrame& current() const
+    {
+        return *m_pCurrent;
+    }
+
+    /** The render thread's frame before current() */
+    const tgRenderFrame& previous() const
+    {
+        return *m_pPrevious;
+    }
+
+    /** Empty every frame. Neither thread may be using the buffer. */
+    void clear();
+
+private:
+
+    /** Not copyable */
+    tgRenderFrameBuffer(const tgRenderFrameBuffer&);
+    tgRenderFrameBuffer& operator=(const tgRenderFrameBuffer&);
+
+    tgRenderFrame m_frames[4];
+
+    tgRenderFrame* m_pBack;
+
+    /** Published and not yet acquired, if m_fresh */
+    tgRenderFrame* m_pPending;
+
+    tgRenderFrame* m_pCurrent;
+
+    tgRenderFrame* m_pPrevious;
+
+    bool m_fresh;
+
+    pthread_mutex_t m_mutex;
+};
+
+#endif  // TG_RENDER_FRAME_BUFFER_H
@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRigidBodyArena.cpp
+ * @brief Contains the definitions of members of class tgRigidBodyArena
+ * $Id$
+ */
+
+// This module
+#include "tgRigidBodyArena.h"
+// The Bullet Physics library
+#include "LinearMath/btAlignedAllocator.h"
+// The C++ Standard Library
+#include <cassert>
+#include <new>
+
+namespace
+{
+    /** Bullet's alignment for its objects */
+    const std::size_t alignment = 16;
+
+    std::size_t aligned(std::size_t size)
+    {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+}
+
+/**
+ * Each slot starts with a pointer to its arena, padded to the
+ * alignment, so that a body can be given back from operator delete,
+ * which only has the body's address.
+ */
+class tgRigidBodyArena::Body : public btRigidBody
+{
+public:
+
+    explicit Body(const btRigidBodyConstructionInfo& info) :
+    btRigidBody(info)
+    {
+    }
+
+    static std::size_t headerSize()
+    {
+        return aligned(sizeof(tgRigidBodyArena*));
+    }
+
+    static std::size_t slotSize()
+    {
+        return headerSize() + aligned(sizeof(Body));
+    }
+
+    static tgRigidBodyArena*& arenaOf(void* pBody)
+    {
+        return *reinterpret_cast<tgRigidBodyArena**>(
+            static_cast<char*>(pBody) - headerSize());
+    }
+
+    static void* operator new(std::size_t size, tgRigidBodyArena& arena)
+    {
+        assert(size <= sizeof(Body));
+        return arena.allocate();
+    }
+
+    /** If the constructor throws */
+    static void operator delete(void* pBody, tgRigidBodyArena& arena)
+    {
+        arena.deallocate(pBody);
+    }
+
+    static void operator delete(void* pBody)
+    {
+        if (pBody != NULL)
+        {
+            arenaOf(pBody)->deallocate(pBody);
+        }
+    }
+};
+
+tgRigidBodyArena::tgRigidBodyArena() :
+m_lastBlockUsed(blockSize),
+m_bodies(0),
+m_released(false)
+{
+}
+
+tgRigidBodyArena::~tgRigidBodyArena()
+{
+    assert(m_bodies == 0);
+    for (std::size_t i = 0; i < m_blocks.size(); i++)
+    {
+        btAlignedFree(m_blocks[i]);
+    }
+}
+
+btRigidBody* tgRigidBodyArena::create(const btRigidBody::btRigidBodyConstructionInfo& info)
+{
+    return new (*this) Body(info);
+}
+
+void tgRigidBodyArena::release()
+{
+    m_released = true;
+    if (m_bodies == 0)
+    {
+        delete this;
+    }
+}
+
+void* tgRigidBodyArena::allocate()
+{
+    char* pSlot = NULL;
+    if (!m_free.empty())
+    {
+        pSlot = static_cast<char*>(m_free.back());
+        m_free.pop_back();
+    }
+    else
+    {
+        if (m_lastBlockUsed == blockSize)
+        {
+            void* const pBlock = btAlignedAlloc(blockSize * Body::slotSize(), alignment);
+            if (pBlock == NULL)
+            {
+                throw std::bad_alloc();
+            }
+            m_blocks.push_back(static_cast<char*>(pBlock));
+            m_lastBlockUsed = 0;
+        }
+        pSlot = m_blocks.back() + m_lastBlockUsed++ * Body::slotSize();
+    }
+    void* const pBody = pSlot + Body::headerSize();
+    Body::arenaOf(pBody) = this;
+    m_bodies++;
+    return pBody;
+}
+
+void tgRigidBodyArena::deallocate(void* pBody)
+{
+    assert(m_bodies > 0);
+    m_free.push_back(static_cast<char*>(pBody) - Body::headerSize());
+    if (--m_bodies == 0 && m_released)
+    {
+        delete this;
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_RIGID_BODY_ARENA_H
+#define TG_RIGID_BODY_ARENA_H
+
+/**
+ * @file tgRigidBodyArena.h
+ * @brief Contains the definition of class tgRigidBodyArena
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+/**
+ * Contiguous storage for a world's rigid bodies. Bodies are laid out in
+ * the order they are created, which is the order tgStructureInfo builds
+ * them, so the bodies of one robot and of each of its compounds sit
+ * next to each other rather than wherever the heap put them, and
+ * Bullet's island and solver loops and the cable force engine walk
+ * through a few blocks instead of across pages.
+ *
+ * Bodies are deleted as usual, by whatever world they end up in: their
+ * class returns them to the arena. The world that owns the arena
+ * calls release() when it is destroyed, and the arena goes when its
+ * last body does, so a body moved to another world by
+ * tgSimulation::moveModel may outlive the world that made it. An arena
+ * and its bodies must be used from one thread at a time.
+ */
+class tgRigidBodyArena
+{
+public:
+
+    tgRigidBodyArena();
+
+    /**
+     * Create a body in the next free slot. It is not added to any world.
+     * @param[in] info as for the btRigidBody constructor
+     */
+    btRigidBody* create(const btRigidBody::btRigidBodyConstructionInfo& info);
+
+    /**
+     * Let go of the arena. It is deleted now if it has no bodies, or
+     * else with its last.
+     */
+    void release();
+
+    /** The number of bodies in the arena */
+    std::size_t size() const
+    {
+        return m_bodies;
+    }
+
+private:
+
+    /** The bodies, which return their slots as they are deleted */
+    class Body;
+
+    /** Only through release */
+    ~tgRigidBodyArena();
+
+    /** Not copyable */
+    tgRigidBodyArena(const tgRigidBodyArena&);
+    tgRigidBodyArena& operator=(const tgRigidBodyArena&);
+
+    /** A slot for a body, allocating a block if none are free */
+    void* allocate();
+
+    /** Take back a body's slot */
+    void deallocate(void* pBody);
+
+    /** Slots per block */
+    static const std::size_t blockSize = 64;
+
+    /** Every block, allocated with btAlignedAlloc */
+    std::vector<char*> m_blocks;
+
+    /** Slots handed out from the last block */
+    std::size_t m_lastBlockUsed;
+
+    /** Slots given back, to be used again last in first out */
+    std::vector<void*> m_free;
+
+    std::size_t m_bodies;
+
+    bool m_released;
+};
+
+#endif  // TG_RIGID_BODY_ARENA_H
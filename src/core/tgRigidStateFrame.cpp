@@ -0,0 +1,198 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRigidStateFrame.cpp
+ * @brief Contains the definitions of members of class tgRigidStateFrame
+ * $Id$
+ */
+
+// This module
+#include "tgRigidStateFrame.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btMatrix3x3.h"
+// The C++ Standard Library
+#include <cassert>
+
+tgRigidStateFrame::tgRigidStateFrame() :
+m_lastBlockUsed(motionStateBlockSize),
+m_frameCount(0),
+m_stamp(0)
+{
+}
+
+tgRigidStateFrame::~tgRigidStateFrame()
+{
+    clear();
+    for (std::size_t i = 0; i < m_motionStateBlocks.size(); i++)
+    {
+        delete[] m_motionStateBlocks[i];
+    }
+}
+
+tgRigidStateFrame::PoseMotionState*
+tgRigidStateFrame::createMotionState(const btTransform& startTransform)
+{
+    PoseMotionState* pState = NULL;
+    if (!m_freeMotionStates.empty())
+    {
+        pState = m_freeMotionStates.back();
+        m_freeMotionStates.pop_back();
+    }
+    else
+    {
+        if (m_lastBlockUsed == motionStateBlockSize)
+        {
+            m_motionStateBlocks.push_back(new PoseMotionState[motionStateBlockSize]);
+            m_lastBlockUsed = 0;
+        }
+        pState = &m_motionStateBlocks.back()[m_lastBlockUsed++];
+    }
+    pState->m_pose = startTransform;
+    pState->m_pPose = &pState->m_pose;
+    return pState;
+}
+
+void tgRigidStateFrame::releaseMotionState(PoseMotionState* pState)
+{
+    assert(pState != NULL);
+    for (std::size_t i = 0; i < m_poseStates.size(); i++)
+    {
+        // The body, if still published, is copied from now on
+        if (m_poseStates[i] == pState)
+        {
+            pState->detach();
+            m_poseStates[i] = NULL;
+        }
+    }
+    m_freeMotionStates.push_back(pState);
+}
+
+void tgRigidStateFrame::detachMotionStates()
+{
+    for (std::size_t i = 0; i < m_poseStates.size(); i++)
+    {
+        if (m_poseStates[i] != NULL)
+        {
+            m_poseStates[i]->detach();
+        }
+    }
+    m_poseStates.clear();
+}
+
+void tgRigidStateFrame::clear()
+{
+    detachMotionStates();
+    for (std::size_t i = 0; i < m_states.size(); i++)
+    {
+        if (m_states[i].pBody->getUserPointer() == &m_states[i])
+        {
+            m_states[i].pBody->setUserPointer(NULL);
+        }
+    }
+    m_states.clear();
+    m_frameCount = 0;
+}
+
+/**
+ * The bodies are matched to last frame's in order. Only if that fails,
+ * because bodies were added or removed, is the array rebuilt and every
+ * user pointer set again.
+ */
+void tgRigidStateFrame::publish(btAlignedObjectArray<btCollisionObject*>& objects)
+{
+    const int n = objects.size();
+    std::size_t k = 0;
+    bool same = true;
+    for (int i = 0; i < n && same; i++)
+    {
+        btRigidBody* const pBody = btRigidBody::upcast(objects[i]);
+        if (pBody)
+        {
+            same = k < m_states.size() && m_states[k].pBody == pBody;
+            k++;
+        }
+    }
+    if (!same || k != m_states.size())
+    {
+        detachMotionStates();
+        m_states.clear();
+        for (int i = 0; i < n; i++)
+        {
+            btRigidBody* const pBody = btRigidBody::upcast(objects[i]);
+            if (pBody)
+            {
+                RigidState state;
+                state.pBody = pBody;
+                m_states.push_back(state);
+            }
+        }
+        // Only now that the array won't move again
+        m_poseStates.resize(m_states.size());
+        for (std::size_t i = 0; i < m_states.size(); i++)
+        {
+            btRigidBody* const pBody = m_states[i].pBody;
+            pBody->setUserPointer(&m_states[i]);
+            // Rebuilds are rare enough for a dynamic_cast
+            m_poseStates[i] = dynamic_cast<PoseMotionState*>(pBody->getMotionState());
+            if (m_poseStates[i] != NULL)
+            {
+                m_poseStates[i]->attach(&m_states[i].transform);
+            }
+        }
+    }
+
+    ++m_stamp;
+    for (std::size_t i = 0; i < m_states.size(); i++)
+    {
+        RigidState& state = m_states[i];
+        const btRigidBody* const pBody = state.pBody;
+        state.stamp = m_stamp;
+        if (m_poseStates[i] != NULL)
+        {
+            // Already written by the motion state
+        }
+        else if (pBody->getMotionState() != NULL)
+        {
+            pBody->getMotionState()->getWorldTransform(state.transform);
+        }
+        else
+        {
+            state.transform = pBody->getWorldTransform();
+        }
+        state.linearVelocity = pBody->getLinearVelocity();
+        state.angularVelocity = pBody->getAngularVelocity();
+
+        btScalar yaw = 0.0;
+        btScalar pitch = 0.0;
+        btScalar roll = 0.0;
+        btMatrix3x3(pBody->getOrientation()).getEulerYPR(yaw, pitch, roll);
+        state.eulerYPR.setValue(yaw, pitch, roll);
+    }
+    m_frameCount++;
+}
+
+const tgRigidStateFrame::RigidState* tgRigidStateFrame::find(const btRigidBody* pBody)
+{
+    assert(pBody != NULL);
+    const RigidState* const pState =
+        static_cast<const RigidState*>(pBody->getUserPointer());
+    // The user pointer belongs to the frame once the body is published
+    return (pState != NULL && pState->pBody == pBody) ? pState : NULL;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_RIGID_STATE_FRAME_H
+#define TG_RIGID_STATE_FRAME_H
+
+/**
+ * @file tgRigidStateFrame.h
+ * @brief Contains the definition of class tgRigidStateFrame
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btAlignedObjectArray.h"
+#include "LinearMath/btMotionState.h"
+#include "LinearMath/btTransform.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <vector>
+
+// Forward declarations
+class btCollisionObject;
+class btRigidBody;
+
+/**
+ * The pose and velocities of every rigid body in a world, published by
+ * the world once per step, so that sensors and controllers read one
+ * contiguous array instead of asking Bullet body by body and working out
+ * the Euler angles again each time.
+ *
+ * Each published body's user pointer is set to its state, so find is a
+ * pointer check. The frame is republished after every tgWorld::step and
+ * tgWorld::restore; if a body is moved in between, it is stale until the
+ * next step. Nothing is allocated unless bodies were added or removed.
+ *
+ * The frame also hands out the bodies' motion states, from blocks it
+ * owns. Once a body is published, its PoseMotionState writes straight
+ * into the body's RigidState::transform as Bullet synchronizes the
+ * motion states, so publish does not copy the poses of those bodies.
+ */
+class tgRigidStateFrame
+{
+public:
+
+    /** What is published for one rigid body */
+    struct RigidState
+    {
+        btRigidBody* pBody;
+        /**
+         * The motion state's world transform, as tgBaseRigid::centerOfMass
+         * reads it, or the body's if it has no motion state
+         */
+        btTransform transform;
+        btVector3 linearVelocity;
+        btVector3 angularVelocity;
+        /** Yaw, pitch and roll of the body, as tgBaseRigid::orientation */
+        btVector3 eulerYPR;
+        /**
+         * Which publish this state is from, counting every publish of
+         * its frame and never reset, so that values derived from a body
+         * can be cached against it and recomputed once it changes
+         */
+        std::size_t stamp;
+    };
+
+    /**
+     * A motion state that keeps the pose in the body's published state,
+     * or in itself until the body is published. Made by
+     * createMotionState; never deleted except by its frame.
+     */
+    class PoseMotionState : public btMotionState
+    {
+    public:
+
+        BT_DECLARE_ALIGNED_ALLOCATOR();
+
+        PoseMotionState() :
+        m_pPose(&m_pose)
+        {
+        }
+
+        virtual void getWorldTransform(btTransform& worldTrans) const
+        {
+            worldTrans = *m_pPose;
+        }
+
+        virtual void setWorldTransform(const btTransform& worldTrans)
+        {
+            *m_pPose = worldTrans;
+        }
+
+    private:
+
+        friend class tgRigidStateFrame;
+
+        /** Not copyable, since m_pPose may point at m_pose */
+        PoseMotionState(const PoseMotionState&);
+        PoseMotionState& operator=(const PoseMotionState&);
+
+        /** Write the pose to a RigidState from now on */
+        void attach(btTransform* pSlot)
+        {
+            *pSlot = *m_pPose;
+            m_pPose = pSlot;
+        }
+
+        /** Keep the pose here again, before the RigidState goes */
+        void detach()
+        {
+            m_pose = *m_pPose;
+            m_pPose = &m_pose;
+        }
+
+        btTransform m_pose;
+
+        /** &m_pose, or the published RigidState::transform */
+        btTransform* m_pPose;
+    };
+
+    tgRigidStateFrame();
+
+    /**
+     * Clears the user pointers of the bodies still published and
+     * deletes the motion states. Their bodies must be deleted first.
+     */
+    ~tgRigidStateFrame();
+
+    /**
+     * A motion state for a new body of this frame's world, instead of a
+     * btDefaultMotionState. It is reused after releaseMotionState and
+     * deleted with the frame.
+     * @param[in] startTransform the body's initial pose
+     */
+    PoseMotionState* createMotionState(const btTransform& startTransform);
+
+    /**
+     * Take back a motion state that its body no longer uses, e.g. as
+     * the body goes to another world.
+     * @param[in] pState made by this frame's createMotionState
+     */
+    void releaseMotionState(PoseMotionState* pState);
+
+    /**
+     * Record every rigid body in a collision object array.
+     * @param[in] objects the dynamics world's collision objects
+     */
+    void publish(btAlignedObjectArray<btCollisionObject*>& objects);
+
+    /**
+     * Forget the bodies and clear their user pointers, e.g. before they
+     * are deleted.
+     */
+    void clear();
+
+    /**
+     * The published state of a body.
+     * @param[in] pBody any rigid body
+     * @return NULL if the body is not in the last frame published by its
+     * world
+     */
+    static const RigidState* find(const btRigidBody* pBody);
+
+    /** The rigid bodies, in the order of the collision object array */
+    const std::vector<RigidState>& getStates() const
+    {
+        return m_states;
+    }
+
+    /** Frames published since construction or the last clear */
+    std::size_t getFrameCount() const
+    {
+        return m_frameCount;
+    }
+
+private:
+
+    /** Not copyable, since the bodies point at m_states */
+    tgRigidStateFrame(const tgRigidStateFrame&);
+    tgRigidStateFrame& operator=(const tgRigidStateFrame&);
+
+    /** Detach every published PoseMotionState from m_states */
+    void detachMotionStates();
+
+    /** Motion states per block of m_motionStateBlocks */
+    static const std::size_t motionStateBlockSize = 256;
+
+    std::vector<RigidState> m_states;
+
+    /**
+     * Indexed like m_states: each body's motion state if it writes to
+     * its RigidState, otherwise NULL
+     */
+    std::vector<PoseMotionState*> m_poseStates;
+
+    /** Every motion state made, in blocks allocated with new[] */
+    std::vector<PoseMotionState*> m_motionStateBlocks;
+
+    /** Motion states handed out from the last block */
+    std::size_t m_lastBlockUsed;
+
+    /** Released motion states, to be handed out again */
+    std::vector<PoseMotionState*> m_freeMotionStates;
+
+    std::size_t m_frameCount;
+
+    /** Publishes since construction, for RigidState::stamp */
+    std::size_t m_stamp;
+};
+
+#endif  // TG_RIGID_STATE_FRAME_H
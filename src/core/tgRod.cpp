@@ -36,12 +36,15 @@
 #include <iostream> //for strings.
 
 tgRod::Config::Config(double r, double d,
-                        double f, double rf, double res) :
+                        double f, double rf, double res,
+                        double ccdt, double ccds) :
   radius(r),
   density(d),
   friction(f),
   rollFriction(rf),
-  restitution(res)
+  restitution(res),
+  ccdMotionThreshold(ccdt),
+  ccdSweptSphereRadius(ccds)
 {
         if (density < 0.0) { throw std::range_error("Negative density"); }
         if (radius < 0.0)  { throw std::range_error("Negative radius");  }
@@ -57,6 +60,16 @@ tgRod::Config::Config(double r, double d,
     assert((restitution >= 0.0) && (restitution <= 1.0));
 }
 
+double tgRod::Config::getCcdMotionThreshold() const
+{
+    return ccdMotionThreshold < 0.0 ? radius : ccdMotionThreshold;
+}
+
+double tgRod::Config::getCcdSweptSphereRadius() const
+{
+    return ccdSweptSphereRadius < 0.0 ? 0.8 * radius : ccdSweptSphereRadius;
+}
+
 tgRod::tgRod(btRigidBody* pRigidBody, 
                 const tgTags& tags,
                 const double length) : 
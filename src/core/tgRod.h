@@ -55,12 +55,31 @@ public:
          * Initialize with radius and density, which may default.
          * @param[in] radius the rod's radius; must be non-negative
          * @param[in] density the rod's density; must be non-negative
+         * @param[in] ccdt the continuous collision motion threshold;
+         * negative for automatic, zero to turn continuous collision off
+         * @param[in] ccds the continuous collision swept sphere radius;
+         * negative for automatic
          */
             Config(double r = 0.5,
                     double d = 1.0,
                     double f = 1.0,
                     double rf = 0.0,
-                    double res = 0.2);
+                    double res = 0.2,
+                    double ccdt = -1.0,
+                    double ccds = -1.0);
+
+            /**
+             * The motion threshold to give Bullet: ccdMotionThreshold,
+             * or the radius if it is automatic.
+             */
+            double getCcdMotionThreshold() const;
+
+            /**
+             * The swept sphere radius to give Bullet: ccdSweptSphereRadius,
+             * or 0.8 of the radius if it is automatic, so the sphere stays
+             * inside the rod.
+             */
+            double getCcdSweptSphereRadius() const;
 
 
 
@@ -82,6 +101,21 @@ public:
             /** The rod's coefficient of restitution; 
              * must be between 0 and 1 (inclusive). */
             const double restitution;
+
+            /**
+             * How far the rod must move in one step, in length units,
+             * for Bullet to sweep it against other bodies rather than
+             * test where it ends up. Thin rods at large step sizes
+             * otherwise pass through the ground and obstacles.
+             * Negative for automatic; zero turns the sweep off.
+             */
+            const double ccdMotionThreshold;
+
+            /**
+             * The radius of the sphere swept along the rod's motion;
+             * should be no more than the radius. Negative for automatic.
+             */
+            const double ccdSweptSphereRadius;
     };
     
         tgRod(btRigidBody* pRigidBody,
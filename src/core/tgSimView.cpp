@@ -28,6 +28,7 @@
 // This application
 #include "tgModelVisitor.h"
 #include "tgSimView.h"
+#include "tgStopPredicate.h"
 // The C++ Standard Library
 #include <cassert>  
 #include <iostream>
@@ -137,10 +138,23 @@ void tgSimView::run()
 
 void tgSimView::run(int steps) 
 {
+    run(steps, std::vector<tgStopPredicate*>(), 1);
+}
+
+std::string tgSimView::run(int steps,
+                           const std::vector<tgStopPredicate*>& predicates,
+                           int checkInterval)
+{
+    if (checkInterval < 1)
+    {
+        throw std::invalid_argument("checkInterval is not positive");
+    }
     if (m_pSimulation != NULL)
     {
             // The tgSimView has been passed to a tgSimulation
+        #if (0)
         std::cout << "SimView::run("<<steps<<")" << std::endl;
+        #endif
         // This would normally run forever, but this is just for testing
         m_renderTime = 0;
         double totalTime = 0.0;
@@ -154,8 +168,21 @@ void tgSimView::run(int steps)
                 //std::cout << totalTime << std::endl;
                 m_renderTime = 0;
             }
+
+            if (!predicates.empty() &&
+                ((i + 1) % checkInterval == 0 || i + 1 == steps))
+            {
+                for (std::size_t j = 0; j < predicates.size(); j++)
+                {
+                    if (predicates[j]->shouldStop(totalTime))
+                    {
+                        return predicates[j]->reason();
+                    }
+                }
+            }
         }
     }
+    return "";
 }
 
 void tgSimView::render() const
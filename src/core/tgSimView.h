@@ -26,9 +26,14 @@
  * $Id$
  */
 
+// The C++ Standard Library
+#include <string>
+#include <vector>
+
 // Forward declarations
 class tgModelVisitor;
 class tgSimulation;
+class tgStopPredicate;
 class tgWorld;
 
 class tgSimView
@@ -85,6 +90,21 @@ public:
 	 * Run for a specific number of steps
 	 */
     virtual void run(int steps);
+
+    /**
+     * Run for up to a number of steps, stopping early as soon as one
+     * of the predicates asks to.
+     * @param[in] steps the most steps to run
+     * @param[in] predicates checked in order every checkInterval steps
+     * and after the last step; their onStart has already been called
+     * @param[in] checkInterval must be positive
+     * @return the reason given by the predicate that stopped the run, or
+     * an empty string if every step ran
+     * @throw std::invalid_argument if checkInterval is not positive
+     */
+    virtual std::string run(int steps,
+                            const std::vector<tgStopPredicate*>& predicates,
+                            int checkInterval);
     
     /**
      * Send the tgModelVisitor to the simulation
@@ -26,26 +26,83 @@
 // This module
 #include "tgSimViewGraphics.h"
 // This application
+#include "tgBatchedDebugDrawer.h"
 #include "tgBulletUtil.h"
 #include "tgSimulation.h"
+#include "tgVideoEncoder.h"
 // Bullet OpenGL_FreeGlut (patched files)
 #include "tgGLDebugDrawer.h"
 // The Bullet Physics library
 #include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <sys/time.h>
+
+namespace
+{
+    /** Seconds since the epoch, for spacing out frames */
+    double wallTime()
+    {
+        timeval tv;
+        gettimeofday(&tv, NULL);
+        return tv.tv_sec + tv.tv_usec * 1.0e-6;
+    }
+
+    /**
+     * The most wall-clock time one tick steps for when interpolating, so
+     * a simulation slower than real time does not fall ever further
+     * behind
+     */
+    const double kMaxTickTime = 0.25;
+}
 
 tgSimViewGraphics::tgSimViewGraphics(tgWorld& world,
                      double stepSize,
-                     double renderRate) : 
-  tgSimView(world, stepSize, renderRate)
+                     double renderRate,
+                     bool physicsThread,
+                     bool interpolate) : 
+  tgSimView(world, stepSize,
+            (physicsThread || interpolate) ?
+            std::max(stepSize, renderRate) : renderRate),
+  m_usePhysicsThread(physicsThread),
+  m_interpolate(interpolate),
+  m_accumulator(0.0),
+  m_lastTick(0.0),
+  m_physicsRunning(false),
+  m_stopPhysics(false),
+  m_alpha(1.0),
+  m_pEncoder(NULL),
+  m_frameTime(0.0),
+  m_detailed(false),
+  m_frustumCulling(false),
+  m_detailDistance(0.0),
+  m_drawDistance(0.0),
+  m_pRenderer(NULL)
 {
     /// @todo figure out a good time to delete this
     gDebugDrawer = new tgGLDebugDrawer();
+    m_pBatchedDrawer = new tgBatchedDebugDrawer(*gDebugDrawer);
     // Supress compiler warning for bullet's unused variable
     (void) btInfinityMask;
+    pthread_mutex_init(&m_stopMutex, NULL);
+    
+    if (m_usePhysicsThread)
+    {
+        // The profile overlay reads Bullet's profiler, which the physics
+        // thread is writing
+        m_debugMode |= btIDebugDraw::DBG_NoHelpText;
+    }
 }
 
 tgSimViewGraphics::~tgSimViewGraphics()
 {
+    stopPhysicsThread();
+    // Finishes the video, if one is still being recorded
+    delete m_pEncoder;
+    pthread_mutex_destroy(&m_stopMutex);
+    delete m_pBatchedDrawer;
 #ifndef BT_NO_PROFILE
     CProfileManager::Release_Iterator(m_profileIterator);
 #endif //BT_NO_PROFILE
@@ -68,10 +125,11 @@ void tgSimViewGraphics::setup()
         m_dynamicsWorld = &dynamicsWorld;
 
         // Give the pointer to demoapplication for rendering
-        dynamicsWorld.setDebugDrawer(gDebugDrawer);
+        dynamicsWorld.setDebugDrawer(m_pBatchedDrawer);
         
         // @todo Valgrind thinks this is a leak. Perhaps its a GLUT issue?
-        m_pModelVisitor = new tgBulletRenderer(world);
+        m_pRenderer = new tgBulletRenderer(world);
+        m_pModelVisitor = m_pRenderer;
         std::cout << "setup graphics" << std::endl;
 }
 
@@ -79,6 +137,9 @@ void tgSimViewGraphics::teardown()
 {
     //tgWorld owns this pointer, so we shouldn't delete it
     m_dynamicsWorld = 0;
+    // The world's shapes are about to go
+    m_liveFrame.clear();
+    clearBoundingBoxLists();
     tgSimView::teardown();
 }
 
@@ -91,7 +152,13 @@ void tgSimViewGraphics::render()
             GL_DEPTH_BUFFER_BIT |
             GL_STENCIL_BUFFER_BIT);
         
+        if (m_detailed && m_pRenderer)
+        {
+            m_pRenderer->setCableDetail(m_cameraPosition, m_detailDistance,
+                                        m_drawDistance);
+        }
         m_pSimulation->onVisit(*m_pModelVisitor);
+        m_pBatchedDrawer->flush();
 
         //Freeglut code
 #if (0)
@@ -106,6 +173,8 @@ void tgSimViewGraphics::run(int steps)
     if (isInitialzed())
     {
         tgglutmain(1024, 600, "Tensegrity Demo", this);
+        
+        startPhysicsThread();
 
         glutMainLoop();
         
@@ -128,6 +197,14 @@ void tgSimViewGraphics::run(int steps)
     }
 }
 
+std::string tgSimViewGraphics::run(int steps,
+                                   const std::vector<tgStopPredicate*>& predicates,
+                                   int checkInterval)
+{
+    run(steps);
+    return "";
+}
+
 // tgSimulation handles calling teardown and setup on this,
 // since it knows when the new world is available
 void tgSimViewGraphics::reset() 
@@ -137,16 +214,108 @@ void tgSimViewGraphics::reset()
     assert(isInitialzed());
 }
 
+void tgSimViewGraphics::startRecording(const std::string& command,
+                                       double frameRate,
+                                       std::size_t queueLength)
+{
+    if (!(frameRate > 0.0))
+    {
+        throw std::invalid_argument("frameRate is not positive");
+    }
+    if (m_usePhysicsThread)
+    {
+        throw std::logic_error("Cannot record with a physics thread");
+    }
+    stopRecording();
+    m_pEncoder = new tgVideoEncoder(command, queueLength);
+    m_frameTime = 1.0 / frameRate;
+    m_accumulator = 0.0;
+}
+
+void tgSimViewGraphics::stopRecording()
+{
+    tgVideoEncoder* const pEncoder = m_pEncoder;
+    m_pEncoder = NULL;
+    // Interpolation starts again from the current state
+    m_accumulator = 0.0;
+    m_lastTick = 0.0;
+    if (pEncoder != NULL)
+    {
+        try
+        {
+            pEncoder->finish();
+        }
+        catch (...)
+        {
+            delete pEncoder;
+            throw;
+        }
+        delete pEncoder;
+    }
+}
+
+void tgSimViewGraphics::setRenderDetail(bool frustumCulling,
+                                        double detailDistance,
+                                        double drawDistance)
+{
+    if (!(detailDistance > 0.0) || drawDistance < detailDistance)
+    {
+        throw std::invalid_argument("Render detail distances are out of order");
+    }
+    m_detailed = true;
+    m_frustumCulling = frustumCulling;
+    m_detailDistance = detailDistance;
+    m_drawDistance = drawDistance;
+}
+
+void tgSimViewGraphics::clearRenderDetail()
+{
+    m_detailed = false;
+    m_frustumCulling = false;
+    if (m_pRenderer)
+    {
+        const double everywhere = std::numeric_limits<double>::max();
+        m_pRenderer->setCableDetail(m_cameraPosition, everywhere, everywhere);
+    }
+}
+
 void tgSimViewGraphics::clientMoveAndDisplay()
 {
+    if (m_pEncoder != NULL)
+    {
+        if (isInitialzed())
+        {
+            recordFrame();
+        }
+        return;
+    }
+    if (m_usePhysicsThread)
+    {
+        if (isInitialzed())
+        {
+            m_frames.acquire();
+            followPublishedFrames();
+            drawFrame();
+        }
+        return;
+    }
+    if (m_interpolate)
+    {
+        if (isInitialzed())
+        {
+            stepToWallClock();
+            drawFrame();
+        }
+        return;
+    }
     if (isInitialzed()){
-        m_pSimulation->step(m_stepSize);    
-        m_renderTime += m_stepSize; 
+        advance();
         if (m_renderTime >= m_renderRate)
         {
             render();
             // Doesn't appear to do anything yet...
             m_dynamicsWorld->debugDrawWorld();
+            m_pBatchedDrawer->flush();
             renderme();     
             // Camera is updated in renderme
             glFlush();
@@ -156,8 +325,56 @@ void tgSimViewGraphics::clientMoveAndDisplay()
     }
 }
 
+void tgSimViewGraphics::recordFrame()
+{
+    // Steps that do not divide the frame time are carried over, so the
+    // video keeps to the frame rate on average
+    m_accumulator += m_frameTime;
+    while (m_accumulator > 0.5 * m_stepSize)
+    {
+        advance();
+        m_accumulator -= m_stepSize;
+    }
+    m_renderTime = 0;
+
+    render();
+    m_dynamicsWorld->debugDrawWorld();
+    m_pBatchedDrawer->flush();
+    renderme();
+    glFlush();
+
+    // Read the back buffer before it is swapped
+    const int width = m_glutScreenWidth;
+    const int height = m_glutScreenHeight;
+    unsigned char* const pixels = m_pEncoder->acquire(width, height);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadBuffer(GL_BACK);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+    m_pEncoder->submit();
+
+    swapBuffers();
+}
+
+void tgSimViewGraphics::advance()
+{
+    m_pSimulation->step(m_stepSize);    
+    m_renderTime += m_stepSize; 
+}
+
 void tgSimViewGraphics::displayCallback()
 {
+    if (drawsFrames())
+    {
+        if (isInitialzed())
+        {
+            if (m_usePhysicsThread)
+            {
+                followPublishedFrames();
+            }
+            drawFrame();
+        }
+        return;
+    }
     if (isInitialzed())
     {
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); 
@@ -166,6 +383,7 @@ void tgSimViewGraphics::displayCallback()
         if (m_dynamicsWorld)
         {
             m_dynamicsWorld->debugDrawWorld();
+            m_pBatchedDrawer->flush();
         }
         glFlush();
         swapBuffers();
@@ -174,9 +392,380 @@ void tgSimViewGraphics::displayCallback()
 
 void tgSimViewGraphics::clientResetScene()
 {
+    // The frames refer to shapes the reset deletes
+    const bool restart = m_physicsRunning;
+    stopPhysicsThread();
+    m_frames.clear();
+    // The next tick captures the reset world before stepping
+    m_accumulator = 0.0;
+    m_lastTick = 0.0;
+    
     reset();
     assert(isInitialzed());
 
     tgWorld& world = m_pSimulation->getWorld();
-    tgBulletUtil::worldToDynamicsWorld(world).setDebugDrawer(gDebugDrawer);
+    tgBulletUtil::worldToDynamicsWorld(world).setDebugDrawer(m_pBatchedDrawer);
+    
+    if (restart)
+    {
+        startPhysicsThread();
+    }
+}
+
+void tgSimViewGraphics::renderscene(int pass)
+{
+    if (drawsFrames())
+    {
+        renderBodies(pass, m_frames.current(), m_frames.previous());
+    }
+    else if (m_detailed)
+    {
+        // renderme always draws pass 0 first
+        if (pass == 0 && m_dynamicsWorld)
+        {
+            m_liveFrame.clear();
+            m_liveFrame.captureBodies(*m_dynamicsWorld);
+        }
+        renderBodies(pass, m_liveFrame, m_liveFrame);
+    }
+    else
+    {
+        PlatformDemoApplication::renderscene(pass);
+    }
+}
+
+void tgSimViewGraphics::renderBodies(int pass,
+                                     const tgRenderFrame& current,
+                                     const tgRenderFrame& previous)
+{
+    // As DemoApplication::renderscene, from the frame
+    const std::vector<tgRenderFrame::Body>& bodies = current.getBodies();
+    
+    btVector3 aabbMin(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+    btVector3 aabbMax(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+    if (getDebugMode() & btIDebugDraw::DBG_DrawWireframe)
+    {
+        return;
+    }
+    if (m_detailed)
+    {
+        // Terrain meshes draw only their triangles within these bounds
+        const btVector3 reach(m_detailDistance, m_detailDistance, m_detailDistance);
+        aabbMin = m_cameraPosition - reach;
+        aabbMax = m_cameraPosition + reach;
+        if (pass == 0 && m_frustumCulling)
+        {
+            updateFrustum();
+        }
+    }
+    
+    btScalar m[16];
+    for (std::size_t i = 0; i < bodies.size(); i++)
+    {
+        const btTransform transform = current.bodyTransform(i, previous, m_alpha);
+        const btCollisionShape* const pShape = bodies[i].pShape;
+        const btVector3& color = bodies[i].color;
+        
+        bool far = false;
+        if (m_detailed)
+        {
+            btVector3 bodyMin;
+            btVector3 bodyMax;
+            pShape->getAabb(transform, bodyMin, bodyMax);
+            if (m_frustumCulling && !inFrustum(bodyMin, bodyMax))
+            {
+                continue;
+            }
+            // The nearest point of the body's box to the camera
+            btVector3 nearest = m_cameraPosition;
+            nearest.setMax(bodyMin);
+            nearest.setMin(bodyMax);
+            const double distance = nearest.distance(m_cameraPosition);
+            if (distance > m_drawDistance)
+            {
+                continue;
+            }
+            far = distance > m_detailDistance && pShape->isConvex();
+        }
+        
+        transform.getOpenGLMatrix(m);
+        if (far)
+        {
+            // No shadow, and one display list per shape for the box
+            if (pass != 1)
+            {
+                const btVector3 shade = (pass == 2) ? color * btScalar(0.3) : color;
+                glPushMatrix();
+                btglMultMatrix(m);
+                glColor3f(shade.x(), shade.y(), shade.z());
+                glCallList(boundingBoxList(pShape));
+                glPopMatrix();
+            }
+            continue;
+        }
+        
+        const btMatrix3x3 rot = transform.getBasis();
+        switch (pass)
+        {
+        case 0:
+            m_shapeDrawer->drawOpenGL(m, pShape, color, getDebugMode(), aabbMin, aabbMax);
+            break;
+        case 1:
+            m_shapeDrawer->drawShadow(m, m_sundirection * rot, pShape, aabbMin, aabbMax);
+            break;
+        case 2:
+            m_shapeDrawer->drawOpenGL(m, pShape, color * btScalar(0.3), 0, aabbMin, aabbMax);
+            break;
+        }
+    }
+}
+
+void tgSimViewGraphics::updateFrustum()
+{
+    GLdouble projection[16];
+    GLdouble modelView[16];
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelView);
+    
+    // clip = projection * modelView, both column major
+    double clip[16];
+    for (int c = 0; c < 4; c++)
+    {
+        for (int r = 0; r < 4; r++)
+        {
+            clip[c * 4 + r] = 0.0;
+            for (int k = 0; k < 4; k++)
+            {
+                clip[c * 4 + r] += projection[k * 4 + r] * modelView[c * 4 + k];
+            }
+        }
+    }
+    
+    // Left, right, bottom, top, near and far: the last row plus or
+    // minus each of the others
+    for (int p = 0; p < 6; p++)
+    {
+        const int row = p / 2;
+        const double sign = (p % 2 == 0) ? 1.0 : -1.0;
+        for (int j = 0; j < 4; j++)
+        {
+            m_frustum[p][j] = clip[j * 4 + 3] + sign * clip[j * 4 + row];
+        }
+    }
+}
+
+bool tgSimViewGraphics::inFrustum(const btVector3& aabbMin,
+                                  const btVector3& aabbMax) const
+{
+    for (int p = 0; p < 6; p++)
+    {
+        const double* const plane = m_frustum[p];
+        // The corner furthest along the plane's normal
+        const double x = (plane[0] > 0.0) ? aabbMax.x() : aabbMin.x();
+        const double y = (plane[1] > 0.0) ? aabbMax.y() : aabbMin.y();
+        const double z = (plane[2] > 0.0) ? aabbMax.z() : aabbMin.z();
+        if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+unsigned int tgSimViewGraphics::boundingBoxList(const btCollisionShape* pShape)
+{
+    const std::map<const btCollisionShape*, unsigned int>::const_iterator it =
+        m_boundingBoxLists.find(pShape);
+    if (it != m_boundingBoxLists.end())
+    {
+        return it->second;
+    }
+    
+    btVector3 lo;
+    btVector3 hi;
+    pShape->getAabb(btTransform::getIdentity(), lo, hi);
+    
+    const GLuint list = glGenLists(1);
+    glNewList(list, GL_COMPILE);
+    glBegin(GL_QUADS);
+    // -x, +x, -y, +y, -z, +z faces, counter-clockwise from outside
+    glNormal3f(-1, 0, 0);
+    glVertex3f(lo.x(), lo.y(), lo.z()); glVertex3f(lo.x(), lo.y(), hi.z());
+    glVertex3f(lo.x(), hi.y(), hi.z()); glVertex3f(lo.x(), hi.y(), lo.z());
+    glNormal3f(1, 0, 0);
+    glVertex3f(hi.x(), lo.y(), lo.z()); glVertex3f(hi.x(), hi.y(), lo.z());
+    glVertex3f(hi.x(), hi.y(), hi.z()); glVertex3f(hi.x(), lo.y(), hi.z());
+    glNormal3f(0, -1, 0);
+    glVertex3f(lo.x(), lo.y(), lo.z()); glVertex3f(hi.x(), lo.y(), lo.z());
+    glVertex3f(hi.x(), lo.y(), hi.z()); glVertex3f(lo.x(), lo.y(), hi.z());
+    glNormal3f(0, 1, 0);
+    glVertex3f(lo.x(), hi.y(), lo.z()); glVertex3f(lo.x(), hi.y(), hi.z());
+    glVertex3f(hi.x(), hi.y(), hi.z()); glVertex3f(hi.x(), hi.y(), lo.z());
+    glNormal3f(0, 0, -1);
+    glVertex3f(lo.x(), lo.y(), lo.z()); glVertex3f(lo.x(), hi.y(), lo.z());
+    glVertex3f(hi.x(), hi.y(), lo.z()); glVertex3f(hi.x(), lo.y(), lo.z());
+    glNormal3f(0, 0, 1);
+    glVertex3f(lo.x(), lo.y(), hi.z()); glVertex3f(hi.x(), lo.y(), hi.z());
+    glVertex3f(hi.x(), hi.y(), hi.z()); glVertex3f(lo.x(), hi.y(), hi.z());
+    glEnd();
+    glEndList();
+    
+    m_boundingBoxLists[pShape] = list;
+    return list;
+}
+
+void tgSimViewGraphics::clearBoundingBoxLists()
+{
+    for (std::map<const btCollisionShape*, unsigned int>::const_iterator it =
+             m_boundingBoxLists.begin(); it != m_boundingBoxLists.end(); ++it)
+    {
+        glDeleteLists(it->second, 1);
+    }
+    m_boundingBoxLists.clear();
+}
+
+void tgSimViewGraphics::startPhysicsThread()
+{
+    if (!m_usePhysicsThread || m_physicsRunning)
+    {
+        return;
+    }
+    
+    pthread_mutex_lock(&m_stopMutex);
+    m_stopPhysics = false;
+    pthread_mutex_unlock(&m_stopMutex);
+    
+    if (pthread_create(&m_physicsThread, NULL, physicsThreadMain, this) != 0)
+    {
+        throw std::runtime_error("Could not start the physics thread");
+    }
+    m_physicsRunning = true;
+}
+
+void tgSimViewGraphics::stopPhysicsThread()
+{
+    if (!m_physicsRunning)
+    {
+        return;
+    }
+    
+    pthread_mutex_lock(&m_stopMutex);
+    m_stopPhysics = true;
+    pthread_mutex_unlock(&m_stopMutex);
+    
+    pthread_join(m_physicsThread, NULL);
+    m_physicsRunning = false;
+}
+
+void* tgSimViewGraphics::physicsThreadMain(void* pView)
+{
+    static_cast<tgSimViewGraphics*>(pView)->physicsLoop();
+    return NULL;
+}
+
+bool tgSimViewGraphics::stopRequested()
+{
+    pthread_mutex_lock(&m_stopMutex);
+    const bool stop = m_stopPhysics;
+    pthread_mutex_unlock(&m_stopMutex);
+    return stop;
+}
+
+void tgSimViewGraphics::physicsLoop()
+{
+    double renderTime = 0.0;
+    while (!stopRequested())
+    {
+        m_pSimulation->step(m_stepSize);
+        renderTime += m_stepSize; 
+        if (renderTime >= m_renderRate)
+        {
+            captureFrame();
+            renderTime = 0.0;
+        }
+    }
+}
+
+void tgSimViewGraphics::captureFrame()
+{
+    tgRenderFrame& frame = m_frames.back();
+    
+    // tgBulletRenderer draws with the world's debug drawer
+    btDynamicsWorld& dynamicsWorld =
+        tgBulletUtil::worldToDynamicsWorld(m_pSimulation->getWorld());
+    dynamicsWorld.setDebugDrawer(&frame);
+    if (m_detailed && !m_usePhysicsThread)
+    {
+        // The camera belongs to the GLUT thread
+        m_pRenderer->setCableDetail(m_cameraPosition, m_detailDistance,
+                                    m_drawDistance);
+    }
+    m_pSimulation->onVisit(*m_pModelVisitor);
+    
+    frame.captureBodies(dynamicsWorld);
+    frame.setTime(wallTime());
+    m_frames.publish();
+
+    if (!m_usePhysicsThread)
+    {
+        // Picking and the GLUT loop's own drawing use the live world
+        dynamicsWorld.setDebugDrawer(m_pBatchedDrawer);
+    }
+}
+
+void tgSimViewGraphics::stepToWallClock()
+{
+    const double now = wallTime();
+    if (m_lastTick == 0.0)
+    {
+        // Something to draw before the first step
+        captureFrame();
+        m_frames.acquire();
+        m_lastTick = now;
+    }
+    m_accumulator += std::min(now - m_lastTick, kMaxTickTime);
+    m_lastTick = now;
+
+    while (m_accumulator >= m_stepSize)
+    {
+        advance();
+        m_accumulator -= m_stepSize;
+        // Only the last two steps are drawn between. Acquiring each one
+        // keeps the step before as previous()
+        if (m_accumulator < 2.0 * m_stepSize)
+        {
+            captureFrame();
+            m_frames.acquire();
+        }
+    }
+    m_renderTime = 0.0;
+    m_alpha = m_accumulator / m_stepSize;
+}
+
+void tgSimViewGraphics::followPublishedFrames()
+{
+    const tgRenderFrame& current = m_frames.current();
+    const tgRenderFrame& previous = m_frames.previous();
+    
+    // Draw one frame behind, moving towards the latest at the rate
+    // frames arrive
+    const double interval = current.getTime() - previous.getTime();
+    m_alpha = (interval > 0.0) ?
+        std::min(1.0, std::max(0.0, (wallTime() - current.getTime()) / interval)) :
+        1.0;
+}
+
+void tgSimViewGraphics::drawFrame()
+{
+    const tgRenderFrame& current = m_frames.current();
+    const tgRenderFrame& previous = m_frames.previous();
+    
+    glClear(GL_COLOR_BUFFER_BIT |
+        GL_DEPTH_BUFFER_BIT |
+        GL_STENCIL_BUFFER_BIT);
+    current.replay(*m_pBatchedDrawer, previous, m_alpha);
+    m_pBatchedDrawer->flush();
+    renderme();
+    glFlush();
+    swapBuffers();
 }
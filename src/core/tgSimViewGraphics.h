@@ -29,6 +29,7 @@
 // This application
 #include "tgSimView.h"
 #include "tgBulletRenderer.h"
+#include "tgRenderFrameBuffer.h"
 // Bullet OpenGL_FreeGlut (patched files)
 #include "tgGlutStuff.h"
 // The Bullet Physics library
@@ -43,13 +44,46 @@
 #include "LinearMath/btAlignedObjectArray.h"
 // The C++ Standard library
 #include <iostream>
+#include <map>
+#include <pthread.h>
 
 // Forward declarations
+class btCollisionShape;
+class tgBatchedDebugDrawer;
 class tgGLDebugDrawer;
+class tgVideoEncoder;
 
 
-// @todo: Provide ability to make render rate and simulation step rate independent
-
+/**
+ * Runs a simulation with GLUT graphics.
+ *
+ * By default the GLUT loop steps the simulation and draws it every
+ * renderRate seconds of simulated time, so drawing caps the step rate.
+ * With a separate physics thread the simulation steps as fast as it can,
+ * publishing a tgRenderFrame every renderRate seconds of simulated time,
+ * and the GLUT loop draws the latest frame, interpolated from the one
+ * before. The physics thread never waits for drawing. Picking and
+ * shooting boxes still act on the live world, so avoid them in this mode.
+ *
+ * With interpolation and no physics thread, the GLUT loop draws on every
+ * tick, at the display's refresh, and steps the simulation by as many
+ * stepSizes as the wall-clock time since the last tick covers. The
+ * bodies and cables are drawn between the last two steps, by how far
+ * the clock has got into the next one, so a large stepSize does not make
+ * the motion choppy and a small one does not draw frames no one sees.
+ *
+ * While recording, the GLUT loop ignores the wall clock: each tick steps
+ * one video frame of simulated time, draws it, and reads it back for a
+ * tgVideoEncoder, which encodes on its own thread. A recording runs as
+ * fast as drawing and encoding allow, faster than real time if they
+ * can. On a machine without a display, run under a virtual X server.
+ *
+ * For large scenes, setRenderDetail trades detail for frame rate: bodies
+ * outside the view are not drawn, bodies beyond a detail distance are
+ * drawn as their bounding boxes from display lists shared by bodies of
+ * the same shape, and neither they nor cables beyond it are drawn in
+ * full.
+ */
 class tgSimViewGraphics :  public tgSimView, public PlatformDemoApplication
 {
 public:
@@ -60,13 +94,22 @@ public:
      * @param[in] stepSize the time interval for advancing the simulation;
      * std::invalid_argument is thrown if not positive
      * @param[in] renderRate the time interval for updating the graphics;
-     * std::invalid_argument is thrown if less than stepSize
+     * std::invalid_argument is thrown if less than stepSize, unless the
+     * frames are interpolated. With a physics thread, frames are published
+     * at the later of every renderRate and every step; with interpolation
+     * alone it is not used.
+     * @param[in] physicsThread step the simulation on its own thread
+     * rather than from the GLUT loop
+     * @param[in] interpolate without a physics thread, draw on every GLUT
+     * tick between the last two steps, stepping in real time
      * @throw std::invalid_argument if stepSize is not positive or renderRate is
-     * less than stepSize
+     * less than stepSize without a physics thread or interpolation
      */
     tgSimViewGraphics(tgWorld& world,
               double stepSize = 1.0/120.0,
-              double renderRate = 1.0/60.0);
+              double renderRate = 1.0/60.0,
+              bool physicsThread = false,
+              bool interpolate = false);
     
     //Exit physics should have already been called
         //exitPhysics();
@@ -104,7 +147,65 @@ public:
      * is implemented
      */
     virtual void run(int steps);
+
+    /**
+     * The window is interactive, so the predicates are not checked and
+     * this is the same as run(steps).
+     * @return an empty string
+     */
+    virtual std::string run(int steps,
+                            const std::vector<tgStopPredicate*>& predicates,
+                            int checkInterval);
     
+    /**
+     * Start recording a video. Frames are drawn every 1 / frameRate
+     * seconds of simulated time and written to the standard input of
+     * command, as tgVideoEncoder describes. Any recording in progress
+     * is stopped first.
+     * @param[in] command the encoder, e.g. an ffmpeg reading image2pipe
+     * @param[in] frameRate video frames per simulated second; must be
+     * positive
+     * @param[in] queueLength the most frames waiting to be encoded
+     * @throw std::invalid_argument if frameRate is not positive
+     * @throw std::logic_error with a physics thread, which draws frames
+     * as they are published rather than at a fixed rate
+     * @throw std::runtime_error if the encoder cannot be started
+     */
+    void startRecording(const std::string& command, double frameRate,
+                        std::size_t queueLength = 8);
+
+    /**
+     * Finish the video and go back to drawing in real time. Does
+     * nothing if not recording. Called by exitPhysics, so the video is
+     * complete when the window is closed.
+     * @throw std::runtime_error if the encoder failed
+     */
+    void stopRecording();
+
+    bool isRecording() const
+    {
+        return m_pEncoder != NULL;
+    }
+
+    /**
+     * Draw less of what is far away or out of sight. Bodies beyond
+     * detailDistance from the camera are drawn as bounding boxes without
+     * shadows, terrain triangles beyond it are not drawn, and cables
+     * beyond it are drawn as one line between their ends. Nothing beyond
+     * drawDistance is drawn. Cables keep full detail with a physics
+     * thread, which captures them away from the camera.
+     * @param[in] frustumCulling skip bodies outside the view
+     * @param[in] detailDistance must be positive
+     * @param[in] drawDistance must not be less than detailDistance
+     * @throw std::invalid_argument if the distances are out of order or
+     * not positive
+     */
+    void setRenderDetail(bool frustumCulling, double detailDistance,
+                         double drawDistance);
+
+    /** Draw everything in full again, the default */
+    void clearRenderDetail();
+
     /**
      * Resets the simulation using simulation->reset()
      * the simulation will call setup and teardown on this as appropreate
@@ -122,6 +223,8 @@ public:
     //Required by tgDemoApplication
     void exitPhysics(){
         std::cout << "exiting physics" << std::endl;
+        stopPhysicsThread();
+        stopRecording();
         teardown();
     }
     
@@ -140,9 +243,147 @@ public:
      * then updates the pointers to the world and glDebugDrawer
      */
     virtual void clientResetScene();
+    
+    /**
+     * Draws the rigid bodies. With a physics thread or interpolation they
+     * come from the latest tgRenderFrames rather than the live world.
+     */
+    virtual void renderscene(int pass);
+
+protected:
+
+    /**
+     * Called by clientMoveAndDisplay once per GLUT tick, without a
+     * physics thread, to move the scene on by one step before it is
+     * drawn: steps the simulation and adds m_stepSize to m_renderTime.
+     * The scene is drawn when m_renderTime reaches m_renderRate.
+     * tgReplayView moves the bodies from a log here instead.
+     */
+    virtual void advance();
 
 private:    
+    
+    /** Start stepping on the physics thread, if one is used */
+    void startPhysicsThread();
+    
+    /** Stop the physics thread and wait for it, if it is running */
+    void stopPhysicsThread();
+    
+    /** The physics thread's entry point */
+    static void* physicsThreadMain(void* pView);
+    
+    /** Step until stopPhysicsThread, publishing frames */
+    void physicsLoop();
+    
+    /** Has stopPhysicsThread been called? */
+    bool stopRequested();
+    
+    /** Record the world into m_frames.back() and publish it */
+    void captureFrame();
+    
+    /** Is the scene drawn from m_frames rather than the live world? */
+    bool drawsFrames() const
+    {
+        return m_usePhysicsThread || m_interpolate;
+    }
+
+    /**
+     * Without a physics thread: step for the wall-clock time since the
+     * last tick, capturing the last two steps, and set m_alpha to how
+     * far the clock is into the next step
+     */
+    void stepToWallClock();
+
+    /**
+     * With a physics thread: set m_alpha from when the latest two frames
+     * were published, so drawing moves towards the latest at the rate
+     * frames arrive
+     */
+    void followPublishedFrames();
+
+    /** Draw the latest frame from m_frames, at m_alpha from the one before */
+    void drawFrame();
+
+    /**
+     * As DemoApplication::renderscene, drawing the bodies of a frame at
+     * m_alpha from the one before with the render detail settings
+     */
+    void renderBodies(int pass, const tgRenderFrame& current,
+                      const tgRenderFrame& previous);
+
+    /** Read the view frustum from OpenGL's current matrices */
+    void updateFrustum();
+
+    /** Is any of a world-space box inside m_frustum? */
+    bool inFrustum(const btVector3& aabbMin, const btVector3& aabbMax) const;
+
+    /** A display list of a shape's bounding box, made when first asked */
+    unsigned int boundingBoxList(const btCollisionShape* pShape);
+
+    /** Delete the display lists, whose shapes a reset deletes */
+    void clearBoundingBoxLists();
+
+    /**
+     * While recording: step one video frame of simulated time, draw the
+     * live world and hand it to m_pEncoder
+     */
+    void recordFrame();
+    
     tgGLDebugDrawer*    gDebugDrawer;   
+    
+    /**
+     * Given to the dynamics world as its debug drawer, in front of
+     * gDebugDrawer, so that lines are drawn in one batch
+     */
+    tgBatchedDebugDrawer* m_pBatchedDrawer;
+    
+    const bool m_usePhysicsThread;
+
+    const bool m_interpolate;
+
+    /** Simulated time owed to the wall clock, less than one step after a tick */
+    double m_accumulator;
+
+    /** When stepToWallClock last ran, or 0 before the first tick */
+    double m_lastTick;
+    
+    bool m_physicsRunning;
+    
+    /** Guarded by m_stopMutex */
+    bool m_stopPhysics;
+    
+    pthread_mutex_t m_stopMutex;
+    
+    pthread_t m_physicsThread;
+    
+    tgRenderFrameBuffer m_frames;
+    
+    /** How far drawFrame is from m_frames.previous() to m_frames.current() */
+    double m_alpha;
+
+    /** Encodes the frames while recording, else NULL. We own this. */
+    tgVideoEncoder* m_pEncoder;
+
+    /** Simulated seconds per video frame while recording */
+    double m_frameTime;
+
+    /** Set by setRenderDetail */
+    bool m_detailed;
+    bool m_frustumCulling;
+    double m_detailDistance;
+    double m_drawDistance;
+
+    /** The planes a, b, c, d with ax + by + cz + d >= 0 inside the view */
+    double m_frustum[6][4];
+
+    /** The live world's bodies, when drawn with render detail */
+    tgRenderFrame m_liveFrame;
+
+    /** Bounding box display lists by shape */
+    std::map<const btCollisionShape*, unsigned int> m_boundingBoxLists;
+
+    /** The renderer setup made, for its cable detail; m_pModelVisitor owns it */
+    tgBulletRenderer* m_pRenderer;
 };
 
 
@@ -26,23 +26,138 @@
 // This module
 #include "tgSimulation.h"
 // This application
+#include "tgBaseRigid.h"
+#include "tgBuildProfile.h"
+#include "tgBulletCableForceEngine.h"
+#include "tgBulletContactSpringCable.h"
+#include "tgBulletUtil.h"
+#include "tgCast.h"
+#include "tgCommandLog.h"
+#include "tgMetrics.h"
 #include "tgModel.h"
+#include "tgRigidStateFrame.h"
 #include "tgSimView.h"
+#include "tgSpringCableActuator.h"
 #include "tgSimViewGraphics.h"
+#include "tgStopPredicate.h"
+#include "tgTeardownQueue.h"
+#include "tgTraceRecorder.h"
+#include "tgTrialTiming.h"
 #include "tgWorld.h"
+#include "tgWorldSnapshot.h"
 #include "sensors/tgDataManager.h" //for loggers etc.
 // The Bullet Physics Library
+#include "BulletDynamics/ConstraintSolver/btTypedConstraint.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
 #include "LinearMath/btQuickprof.h"
 
 // The C++ Standard Library
+#include <algorithm>
+#include <map>
 #include <stdexcept>
+#include <string>
+#include <typeinfo>
+// POSIX
+#include <pthread.h>
+#include <unistd.h>
+
+namespace
+{
+    /** The models shared by the threads of tgSimulation::prepareModels */
+    struct PrepareWork
+    {
+        const std::vector<tgModel*>* pModels;
+        /** The next model to take */
+        volatile std::size_t next;
+        /** Each model's error message, empty if its prepare succeeded */
+        std::vector<std::string> errors;
+    };
+
+    void* prepareWorker(void* arg)
+    {
+        PrepareWork& work = *static_cast<PrepareWork*>(arg);
+        const std::vector<tgModel*>& models = *work.pModels;
+        for (std::size_t i = __sync_fetch_and_add(&work.next, 1);
+             i < models.size();
+             i = __sync_fetch_and_add(&work.next, 1))
+        {
+            try
+            {
+                tgBuildProfile::Scope scope("model prepare", typeid(*models[i]));
+                models[i]->prepare();
+            }
+            catch (const std::exception& e)
+            {
+                work.errors[i] = e.what();
+                if (work.errors[i].empty())
+                {
+                    work.errors[i] = "Model prepare failed";
+                }
+            }
+            catch (...)
+            {
+                work.errors[i] = "Model prepare failed";
+            }
+        }
+        return NULL;
+    }
+
+    /** A model's bodies, once each, as compounds share them */
+    void collectBodies(tgModel& model, std::vector<btRigidBody*>& bodies)
+    {
+        std::vector<tgBaseRigid*> rigids = model.getDescendantsOfType<tgBaseRigid>();
+        if (tgBaseRigid* const pRigid = tgCast::cast<tgModel, tgBaseRigid>(&model))
+        {
+            rigids.push_back(pRigid);
+        }
+        bodies.clear();
+        for (std::size_t i = 0; i < rigids.size(); i++)
+        {
+            if (rigids[i]->getPRigidBody() != NULL)
+            {
+                bodies.push_back(rigids[i]->getPRigidBody());
+            }
+        }
+        std::sort(bodies.begin(), bodies.end());
+        bodies.erase(std::unique(bodies.begin(), bodies.end()), bodies.end());
+    }
+
+    /** True if any of a model's actuators is a contact cable */
+    bool hasContactCables(tgModel& model)
+    {
+        std::vector<tgSpringCableActuator*> actuators =
+            model.getDescendantsOfType<tgSpringCableActuator>();
+        if (tgSpringCableActuator* const pActuator =
+            tgCast::cast<tgModel, tgSpringCableActuator>(&model))
+        {
+            actuators.push_back(pActuator);
+        }
+        for (std::size_t i = 0; i < actuators.size(); i++)
+        {
+            if (dynamic_cast<const tgBulletContactSpringCable*>(actuators[i]->getSpringCable()))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
 
 tgSimulation::tgSimulation(tgSimView& view) :
-  m_view(view)
+  m_view(view),
+  m_pProfile(NULL),
+  m_profileFormat(tgProfileReport::eJSON),
+  m_pRecorder(NULL),
+  m_pPlayer(NULL)
 {
         m_view.bindToSimulation(*this);
 
-    m_view.setup();
+    tgTrialTiming::beginTrial();
+    {
+        tgTraceRecorder::Scope trace("setup");
+        m_view.setup();
+    }
 
     // Postcondition
     assert(invariant());
@@ -51,6 +166,8 @@ tgSimulation::tgSimulation(tgSimView& view) :
 tgSimulation::~tgSimulation()
 {
     teardown();
+    // What the controllers left for after teardown may use their owners
+    tgTeardownQueue::waitIdle();
     m_view.releaseFromSimulation();
     for (std::size_t i = 0; i < m_models.size(); i++)
     {
@@ -60,6 +177,7 @@ tgSimulation::~tgSimulation()
     for (std::size_t i=0; i < m_dataManagers.size(); i++) {
       delete m_dataManagers[i];
     }
+    delete m_pProfile;
 }
 
 void tgSimulation::addModel(tgModel* pModel)
@@ -72,6 +190,7 @@ void tgSimulation::addModel(tgModel* pModel)
     else
     {
 
+        tgBuildProfile::Scope scope("model setup", typeid(*pModel));
         pModel->setup(m_view.world());
         m_models.push_back(pModel);
     }
@@ -93,6 +212,10 @@ void tgSimulation::addObstacle(tgModel* pObstacle)
 
         pObstacle->setup(m_view.world());
         m_obstacles.push_back(pObstacle);
+        if (!pObstacle->isStatic())
+        {
+            m_steppedObstacles.push_back(pObstacle);
+        }
     }
 
     // Postcondition
@@ -100,6 +223,227 @@ void tgSimulation::addObstacle(tgModel* pObstacle)
     assert(!m_obstacles.empty());
 }
 
+void tgSimulation::addModels(const std::vector<tgModel*>& models)
+{
+    if (std::find(models.begin(), models.end(), (tgModel*) NULL) != models.end())
+    {
+        throw std::invalid_argument("NULL pointer to tgModel");
+    }
+    prepareModels(models);
+    for (std::size_t i = 0; i < models.size(); i++)
+    {
+        addModel(models[i]);
+    }
+}
+
+void tgSimulation::addObstacles(const std::vector<tgModel*>& obstacles)
+{
+    if (std::find(obstacles.begin(), obstacles.end(), (tgModel*) NULL) != obstacles.end())
+    {
+        throw std::invalid_argument("NULL pointer to tgModel");
+    }
+    prepareModels(obstacles);
+    for (std::size_t i = 0; i < obstacles.size(); i++)
+    {
+        addObstacle(obstacles[i]);
+    }
+}
+
+void tgSimulation::addInstances(const std::vector<tgModel*>& models)
+{
+    if (std::find(models.begin(), models.end(), (tgModel*) NULL) != models.end())
+    {
+        throw std::invalid_argument("NULL pointer to tgModel");
+    }
+    else if (m_instances.size() + models.size() > maxInstances)
+    {
+        throw std::invalid_argument("Too many instances for one world");
+    }
+    prepareModels(models);
+    for (std::size_t i = 0; i < models.size(); i++)
+    {
+        addModel(models[i]);
+        const int instance = m_instances.size();
+        isolateInstance(*models[i], instance);
+        m_instances[models[i]] = instance;
+    }
+}
+
+void tgSimulation::isolateInstance(tgModel& model, int instance) const
+{
+    if (hasContactCables(model))
+    {
+        // Their ghosts would still find the other instances' rods
+        throw std::invalid_argument("Instances cannot have contact cables");
+    }
+
+    // One of the bits from 64 up, which Bullet leaves to applications
+    const int group = 64 << instance;
+    const int bulletGroups = 63;
+
+    btDynamicsWorld& dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(m_view.world());
+    std::vector<btRigidBody*> bodies;
+    collectBodies(model, bodies);
+    for (std::size_t i = 0; i < bodies.size(); i++)
+    {
+        btRigidBody* const pBody = bodies[i];
+        const btBroadphaseProxy* const pProxy = pBody->getBroadphaseHandle();
+        if (pProxy == NULL)
+        {
+            continue;
+        }
+        // Seen by whatever sees Bullet's groups, such as the ground, and
+        // seeing them and its own instance only
+        const int mask = (pProxy->m_collisionFilterMask & bulletGroups) | group;
+        // The broadphase only reads the filter as a body is added
+        dynamicsWorld.removeRigidBody(pBody);
+        dynamicsWorld.addRigidBody(pBody, group, mask);
+    }
+}
+
+void tgSimulation::moveModel(tgModel* pModel, tgSimulation& destination)
+{
+    std::vector<tgModel*>::iterator it =
+        std::find(m_models.begin(), m_models.end(), pModel);
+    if (it == m_models.end())
+    {
+        throw std::invalid_argument("Moving a model that is not in the simulation");
+    }
+    else if (&destination == this)
+    {
+        throw std::invalid_argument("Moving a model to its own simulation");
+    }
+    else if (m_instances.count(pModel) != 0)
+    {
+        // Its collision group means nothing to the other world
+        throw std::invalid_argument("Instances cannot change worlds");
+    }
+
+    std::vector<btRigidBody*> bodies;
+    collectBodies(*pModel, bodies);
+    if (hasContactCables(*pModel))
+    {
+        throw std::invalid_argument("Models with contact cables cannot change worlds");
+    }
+
+    btDynamicsWorld& from = tgBulletUtil::worldToDynamicsWorld(m_view.world());
+    btDynamicsWorld& to = tgBulletUtil::worldToDynamicsWorld(destination.m_view.world());
+    for (int i = 0; i < from.getNumConstraints(); i++)
+    {
+        const btTypedConstraint* const pConstraint = from.getConstraint(i);
+        if (std::binary_search(bodies.begin(), bodies.end(), &pConstraint->getRigidBodyA()) ||
+            std::binary_search(bodies.begin(), bodies.end(), &pConstraint->getRigidBodyB()))
+        {
+            // The world that made it deletes it, whichever world it is in
+            throw std::invalid_argument("Models with constraints cannot change worlds");
+        }
+    }
+
+    tgBulletCableForceEngine* const pFromEngine =
+        tgBulletUtil::worldToCableForceEngine(m_view.world());
+    tgBulletCableForceEngine* const pToEngine =
+        tgBulletUtil::worldToCableForceEngine(destination.m_view.world());
+    if (pFromEngine != NULL)
+    {
+        if (pToEngine == NULL)
+        {
+            throw std::invalid_argument("Moving batched cables to a world that does not batch them");
+        }
+        pFromEngine->transferCables(bodies, *pToEngine);
+    }
+
+    tgRigidStateFrame& fromFrame = tgBulletUtil::worldToRigidStateFrame(m_view.world());
+    tgRigidStateFrame& toFrame =
+        tgBulletUtil::worldToRigidStateFrame(destination.m_view.world());
+    for (std::size_t i = 0; i < bodies.size(); i++)
+    {
+        btRigidBody* const pBody = bodies[i];
+
+        // A motion state must come from the frame of the body's world,
+        // which outlives it
+        tgRigidStateFrame::PoseMotionState* const pPose =
+            dynamic_cast<tgRigidStateFrame::PoseMotionState*>(pBody->getMotionState());
+        if (pPose != NULL)
+        {
+            btTransform pose;
+            pPose->getWorldTransform(pose);
+            // setMotionState takes the body's transform from the new state
+            const btTransform worldTransform = pBody->getWorldTransform();
+            pBody->setMotionState(toFrame.createMotionState(pose));
+            pBody->setWorldTransform(worldTransform);
+            fromFrame.releaseMotionState(pPose);
+        }
+
+        const btBroadphaseProxy* const pProxy = pBody->getBroadphaseHandle();
+        const int group = pProxy ? pProxy->m_collisionFilterGroup :
+            int(btBroadphaseProxy::DefaultFilter);
+        const int mask = pProxy ? pProxy->m_collisionFilterMask :
+            int(btBroadphaseProxy::AllFilter);
+        from.removeRigidBody(pBody);
+        to.addRigidBody(pBody, group, mask);
+        pBody->activate(true);
+    }
+
+    m_models.erase(it);
+    destination.m_models.push_back(pModel);
+
+    // Postcondition
+    assert(invariant());
+    assert(destination.invariant());
+}
+
+void tgSimulation::prepareModels(const std::vector<tgModel*>& models)
+{
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    const std::size_t threads =
+        std::min(models.size(), (std::size_t) std::max(1L, processors));
+
+    PrepareWork work;
+    work.pModels = &models;
+    work.next = 0;
+    work.errors.resize(models.size());
+
+    // This thread is one of the workers
+    std::vector<pthread_t> started;
+    for (std::size_t i = 1; i < threads; i++)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, prepareWorker, &work) == 0)
+        {
+            started.push_back(thread);
+        }
+    }
+    prepareWorker(&work);
+    for (std::size_t i = 0; i < started.size(); i++)
+    {
+        pthread_join(started[i], NULL);
+    }
+
+    for (std::size_t i = 0; i < models.size(); i++)
+    {
+        if (!work.errors[i].empty())
+        {
+            throw std::runtime_error(work.errors[i]);
+        }
+    }
+}
+
+void tgSimulation::setupModels()
+{
+    prepareModels(m_models);
+    for (std::size_t i = 0; i != m_models.size(); i++)
+    {
+        tgBuildProfile::Scope scope("model setup", typeid(*m_models[i]));
+        m_models[i]->setup(m_view.world());
+        const std::map<const tgModel*, int>::const_iterator instance =
+            m_instances.find(m_models[i]);
+        if (instance != m_instances.end())
+        {
+            isolateInstance(*m_models[i], instance->second);
+        }
+    }
+}
+
 // Similar to models and obstacles, add a data manager.
 void tgSimulation::addDataManager(tgDataManager* pDataManager)
 {
@@ -135,15 +479,16 @@ void tgSimulation::onVisit(const tgModelVisitor& r) const
 
 void tgSimulation::reset()
 {
-
+    tgTraceRecorder::Scope trace("reset");
+    // The last episode's deferred work has had this one to run in
+    tgTeardownQueue::drain();
     teardown();
+    // Setting up again fills the pools and caches anew
+    m_allocMonitor.restartWarmup();
+    tgTrialTiming::beginTrial();
 
     m_view.setup();
-    for (std::size_t i = 0; i != m_models.size(); i++)
-    {
-        
-        m_models[i]->setup(m_view.world());
-    }
+    setupModels();
     // Also, need to set up the data managers again.
     // Note that this MUST occur after calling setup on the models,
     // otherwise the data manager will not create any sensors
@@ -158,18 +503,17 @@ void tgSimulation::reset()
 
 void tgSimulation::reset(tgGround* newGround)
 {
-
+    tgTraceRecorder::Scope trace("reset");
+    tgTeardownQueue::drain();
     teardown();
+    m_allocMonitor.restartWarmup();
+    tgTrialTiming::beginTrial();
     
     // This will reset the world twice (once in teardown, once here), but that shouldn't hurt anything
     m_view.world().reset(newGround);
     
     m_view.setup();
-    for (std::size_t i = 0; i != m_models.size(); i++)
-    {
-        
-        m_models[i]->setup(m_view.world());
-    }
+    setupModels();
     // Also, need to set up the data managers again.
     // Note that this MUST occur after calling setup on the models,
     // otherwise the data manager will not create any sensors
@@ -182,6 +526,138 @@ void tgSimulation::reset(tgGround* newGround)
     // Don't need to set up obstacles since they were just added
 }
 
+void tgSimulation::swapGround(tgGround* newGround, const tgWorldSnapshot& initialState)
+{
+    m_view.world().swapGround(newGround);
+    restore(initialState);
+}
+
+void tgSimulation::collectActuators(std::vector<tgSpringCableActuator*>& actuators) const
+{
+    actuators.clear();
+    const std::vector<tgModel*>* const lists[] = { &m_models, &m_obstacles };
+    for (std::size_t list = 0; list < 2; list++)
+    {
+        const std::vector<tgModel*>& models = *lists[list];
+        for (std::size_t i = 0; i < models.size(); i++)
+        {
+            tgSpringCableActuator* const pActuator =
+                tgCast::cast<tgModel, tgSpringCableActuator>(models[i]);
+            if (pActuator != NULL)
+            {
+                actuators.push_back(pActuator);
+            }
+            const std::vector<tgSpringCableActuator*>& descendants =
+                models[i]->getDescendantsOfType<tgSpringCableActuator>();
+            actuators.insert(actuators.end(), descendants.begin(), descendants.end());
+        }
+    }
+}
+
+void tgSimulation::snapshot(tgWorldSnapshot& snapshot) const
+{
+    m_view.world().snapshot(snapshot);
+
+    collectActuators(snapshot.actuators);
+    snapshot.actuatorState.clear();
+    for (std::size_t i = 0; i < snapshot.actuators.size(); i++)
+    {
+        snapshot.actuators[i]->saveState(snapshot.actuatorState);
+    }
+}
+
+void tgSimulation::restore(const tgWorldSnapshot& snapshot) const
+{
+    m_view.world().restore(snapshot);
+
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < snapshot.actuators.size(); i++)
+    {
+        pos = snapshot.actuators[i]->restoreState(snapshot.actuatorState, pos);
+    }
+    assert(pos == snapshot.actuatorState.size());
+    invalidateChannels();
+}
+
+void tgSimulation::invalidateChannels() const
+{
+    for (std::size_t i = 0; i < m_dataManagers.size(); i++)
+    {
+        m_dataManagers[i]->invalidateChannels();
+    }
+}
+
+void tgSimulation::restart(const tgWorldSnapshot& initialState)
+{
+    restore(initialState);
+
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        m_models[i]->resetEpisode();
+    }
+    for (std::size_t i = 0; i < m_obstacles.size(); i++)
+    {
+        m_obstacles[i]->resetEpisode();
+    }
+}
+
+void tgSimulation::restoreFrom(const tgWorldSnapshot& snapshot) const
+{
+    // Our own bodies and actuators, to stand in for the other's
+    tgWorldSnapshot layout;
+    this->snapshot(layout);
+    if (layout.bodies.size() != snapshot.bodies.size() ||
+        layout.numCollisionObjects != snapshot.numCollisionObjects ||
+        layout.actuators.size() != snapshot.actuators.size() ||
+        layout.actuatorState.size() != snapshot.actuatorState.size())
+    {
+        throw std::invalid_argument("Snapshot was taken from a different structure");
+    }
+    for (std::size_t i = 0; i < layout.actuators.size(); i++)
+    {
+        if (typeid(*layout.actuators[i]) != typeid(*snapshot.actuators[i]))
+        {
+            throw std::invalid_argument("Snapshot was taken from a different structure");
+        }
+    }
+
+    for (std::size_t i = 0; i < layout.bodies.size(); i++)
+    {
+        btRigidBody* const pBody = layout.bodies[i].pBody;
+        layout.bodies[i] = snapshot.bodies[i];
+        layout.bodies[i].pBody = pBody;
+    }
+    layout.actuatorState = snapshot.actuatorState;
+    layout.solverIterations = snapshot.solverIterations;
+
+    // Contacts name their objects by index too, which only correspond
+    // while the two worlds have the same static bodies
+    if (snapshot.staticBodyChanges == layout.staticBodyChanges)
+    {
+        layout.manifolds = snapshot.manifolds;
+        layout.contactPoints = snapshot.contactPoints;
+        layout.stepsSinceCollisionDetection = snapshot.stepsSinceCollisionDetection;
+        layout.solverSeed = snapshot.solverSeed;
+    }
+    else
+    {
+        layout.manifolds.clear();
+        layout.contactPoints.clear();
+    }
+    restore(layout);
+}
+
+void tgSimulation::fork(tgSimulation& branch) const
+{
+    if (&branch == this)
+    {
+        throw std::invalid_argument("Cannot fork a simulation into itself");
+    }
+    tgWorldSnapshot state;
+    snapshot(state);
+    branch.restoreFrom(state);
+}
+
 /**
  * @note This is not inlined because it depends on the definition of tgSimView.
  */
@@ -190,6 +666,11 @@ tgWorld& tgSimulation::getWorld() const
     return m_view.world();
 }
 
+double tgSimulation::getStepSize() const
+{
+    return m_view.getStepSize();
+}
+
 void tgSimulation::step(double dt) const
 {
 // Trying to profile here creates trouble for tgLinearString -  this is outside of the profile loop	
@@ -200,32 +681,126 @@ void tgSimulation::step(double dt) const
     }
     else
     {
+        // Bullet resets its profiler when the world steps, so collect
+        // what was profiled since the last step first
+        if (m_pProfile != NULL)
+        {
+            m_pProfile->harvest();
+        }
+
+        // Only some steps are timed; the rest just count
+        const bool timed = m_stepTimer.beginStep();
+        tgTrialTiming::countStep();
+        tgMetrics::countStep(dt);
+        const tgStepTimer::Ticks stepStart = timed ? tgStepTimer::now() : 0;
+        m_allocMonitor.beginStep();
+
         // Step the world.
         // This can be done before or after stepping the models.
-        m_view.world().step(dt);
+        {
+            tgAllocStats::Scope tag(tgAllocStats::eWorld);
+            m_view.world().step(dt);
+        }
 
-        // Step the models
-        for (std::size_t i = 0; i < m_models.size(); i++)
+        tgStepTimer::Ticks mark = timed ? tgStepTimer::now() : 0;
+        if (timed)
         {
-            m_models[i]->step(dt);
+            m_stepTimer.addPhase(tgStepTimer::eWorld, mark - stepStart);
         }
-        
-        // Step the obstacles
-        /// @todo determine if this is necessary
-        for (std::size_t i = 0; i < m_obstacles.size(); i++)
+        tgStepTimer::Ticks modelTicks = 0;
+        tgStepTimer::Ticks obstacleTicks = 0;
+
+        // Where controllers notified before their actuators give commands
+        if (m_pPlayer != NULL)
         {
-            m_obstacles[i]->step(dt);
+            m_pPlayer->beginStep(dt);
         }
 
+        // The cables and actuators may run at a finer rate than the bodies
+        const int substeps = m_view.world().getConfig().cableSubsteps;
+        const double substep = dt / substeps;
+        for (int k = 0; k < substeps; k++)
+        {
+            // The bodies moved, or the previous substep's cables did
+            invalidateChannels();
+
+            // Step the models
+            for (std::size_t i = 0; i < m_models.size(); i++)
+            {
+                if (m_models[i]->isStatic())
+                {
+                    continue;
+                }
+                {
+                    tgAllocStats::Scope tag(tgAllocStats::modelTag(i));
+                    m_models[i]->step(substep);
+                }
+                if (timed)
+                {
+                    const tgStepTimer::Ticks t = tgStepTimer::now();
+                    m_stepTimer.addModel(i, typeid(*m_models[i]), t - mark);
+                    modelTicks += t - mark;
+                    mark = t;
+                }
+            }
+            
+            // Step the obstacles that are not static
+            {
+                tgAllocStats::Scope tag(tgAllocStats::eObstacles);
+                for (std::size_t i = 0; i < m_steppedObstacles.size(); i++)
+                {
+                    m_steppedObstacles[i]->step(substep);
+                }
+            }
+            if (timed)
+            {
+                const tgStepTimer::Ticks t = tgStepTimer::now();
+                obstacleTicks += t - mark;
+                mark = t;
+            }
+        }
+
+        if (m_pRecorder != NULL)
+        {
+            m_pRecorder->endStep(dt);
+        }
+        invalidateChannels();
+
 	// Step the data managers
-	for (std::size_t i = 0; i < m_dataManagers.size(); i++) {
-	  m_dataManagers[i]->step(dt);
+	{
+	  tgAllocStats::Scope tag(tgAllocStats::eDataManagers);
+	  for (std::size_t i = 0; i < m_dataManagers.size(); i++) {
+	    m_dataManagers[i]->step(dt);
+	  }
 	}
+	m_allocMonitor.endStep();
+
+        if (timed)
+        {
+            const tgStepTimer::Ticks t = tgStepTimer::now();
+            m_stepTimer.addPhase(tgStepTimer::eModels, modelTicks);
+            m_stepTimer.addPhase(tgStepTimer::eObstacles, obstacleTicks);
+            m_stepTimer.addPhase(tgStepTimer::eDataManagers, t - mark);
+            m_stepTimer.endStep(t - stepStart);
+        }
+
+        if (m_pProfile != NULL)
+        {
+            m_pProfile->harvest();
+        }
     }
 }
   
 void tgSimulation::teardown()
 {
+    // The trial is over once this is done
+    tgTrialTiming::enter(tgTrialTiming::eTeardown);
+    tgTraceRecorder::Scope trace("teardown");
+    tgMetrics::flushSteps();
+
+    // The actuators are about to go
+    stopCommandLog();
+
     const size_t n = m_models.size();
     for (std::size_t i = 0; i < n; i++)
     {
@@ -247,6 +822,7 @@ void tgSimulation::teardown()
         m_obstacles.pop_back();
     }
     assert(m_obstacles.empty());
+    m_steppedObstacles.clear();
 
     // Similar to the models and obstacles, tear down the data managers.
     const size_t num_DM = m_dataManagers.size(); //why not in the loop gaurd?...
@@ -260,20 +836,117 @@ void tgSimulation::teardown()
     // Reset the world after the models - models need world info for
     // their onTeardown() functions
     m_view.world().reset();
+
+    {
+        tgTrialTiming::Scope timing(tgTrialTiming::eLogIO);
+        tgTraceRecorder::Scope trace("write profile");
+        writeProfile();
+    }
+    tgTrialTiming::endTrial();
     // Postcondition
     assert(invariant());
 }
 
+void tgSimulation::enableProfiling(const std::string& fileName,
+                                   tgProfileReport::Format format)
+{
+    if (m_pProfile == NULL)
+    {
+        m_pProfile = new tgProfileReport();
+    }
+    // Drop what Bullet has gathered so far
+    m_pProfile->harvest();
+    m_pProfile->clear();
+    m_profileFileName = fileName;
+    m_profileFormat = format;
+}
+
+void tgSimulation::disableProfiling()
+{
+    delete m_pProfile;
+    m_pProfile = NULL;
+    m_profileFileName.clear();
+}
+
+void tgSimulation::recordCommands(const std::string& fileName)
+{
+    stopCommandLog();
+    std::vector<tgSpringCableActuator*> actuators;
+    collectActuators(actuators);
+    m_pRecorder = new tgCommandRecorder(fileName, actuators);
+}
+
+void tgSimulation::replayCommands(const std::string& fileName)
+{
+    stopCommandLog();
+    std::vector<tgSpringCableActuator*> actuators;
+    collectActuators(actuators);
+    m_pPlayer = new tgCommandPlayer(fileName, actuators);
+}
+
+void tgSimulation::stopCommandLog()
+{
+    delete m_pRecorder;
+    m_pRecorder = NULL;
+    delete m_pPlayer;
+    m_pPlayer = NULL;
+}
+
+bool tgSimulation::isReplaying() const
+{
+    return m_pPlayer != NULL && !m_pPlayer->isFinished();
+}
+
+void tgSimulation::writeProfile() const
+{
+    if (m_pProfile == NULL || m_profileFileName.empty())
+    {
+        return;
+    }
+    // Also called when destroyed, so don't throw
+    try
+    {
+        m_pProfile->harvest();
+        m_pProfile->write(m_profileFileName, m_profileFormat);
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
 void tgSimulation::run() const
 {
+    tgTraceRecorder::Scope trace("run");
     m_view.run();
 }
 
 void tgSimulation::run(int steps) const
-{    
+{
+    tgTraceRecorder::Scope trace("run", steps);
     m_view.run(steps);
 }
 
+std::string tgSimulation::run(int steps,
+                              const std::vector<tgStopPredicate*>& predicates,
+                              int checkInterval) const
+{
+    if (checkInterval < 1)
+    {
+        throw std::invalid_argument("checkInterval is not positive");
+    }
+    for (std::size_t i = 0; i < predicates.size(); i++)
+    {
+        if (predicates[i] == NULL)
+        {
+            throw std::invalid_argument("Stop predicate is NULL");
+        }
+        predicates[i]->onStart();
+    }
+    tgTraceRecorder::Scope trace("run", steps);
+    return m_view.run(steps, predicates, checkInterval);
+}
+
 bool tgSimulation::invariant() const
 {
   return true;
@@ -26,17 +26,28 @@
  * $Id$
  */
 
+// This application
+#include "tgAllocStats.h"
+#include "tgProfileReport.h"
+#include "tgStepTimer.h"
 // The C++ Standard Library
 #include <iostream>
+#include <map>
+#include <string>
 #include <vector>
 
 // Forward declarations
 class tgModel;
 class tgModelVisitor;
 class tgSimView;
+class tgStopPredicate;
 class tgWorld;
 class tgGround;
 class tgDataManager;
+class tgWorldSnapshot;
+class tgCommandRecorder;
+class tgCommandPlayer;
+class tgSpringCableActuator;
 
 /**
  * Holds objects necessary for simulation, a world, a view
@@ -55,7 +66,10 @@ public:
     ~tgSimulation();
 
     /**
-     * Advance the simulation.
+     * Advance the simulation. The world is stepped once over dt, then the
+     * models tgWorld::Config::cableSubsteps times over equal shares of dt.
+     * Everything runs on the calling thread except the compute() of a
+     * pipelined tgPipelinedObserver, which runs on into the next step.
      * @param[in] dt the number of seconds since the previous call;
      * throw an exception if not positive
      * @throw std::invalid_argument if dt is not positive
@@ -74,6 +88,22 @@ public:
      */
     void run(int steps) const;
 
+    /**
+     * Run for up to a number of steps, stopping as soon as one of the
+     * predicates asks to, so that a learning trial can end early instead
+     * of throwing from a controller. onStart is called on each predicate
+     * first. Calls tgSimView.run(steps, predicates, checkInterval)
+     * @param[in] steps the most steps to run
+     * @param[in] predicates not owned; checked in order
+     * @param[in] checkInterval check every this many steps
+     * @return the reason of the predicate that stopped the run, or an
+     * empty string if every step ran
+     * @throw std::invalid_argument if checkInterval is not positive
+     */
+    std::string run(int steps,
+                    const std::vector<tgStopPredicate*>& predicates,
+                    int checkInterval = 1) const;
+
     /**
      * Add a Tensegrity to the simulation.
      * @param[in] pModel a pointer to a tgModel representing a Tensegrity;
@@ -91,6 +121,75 @@ public:
      */
     void addObstacle(tgModel* pObstacle);
 
+    /**
+     * Add several Tensegrities at once. Their tgModel::prepare runs in
+     * parallel, one thread per model up to the number of processors,
+     * then their setup runs in order on this thread, so only putting
+     * them into the world is serialized.
+     * @param[in] models as for addModel
+     * @throw std::invalid_argument if any pointer is NULL; none are added
+     * @throw std::runtime_error with the first message if a prepare
+     * threw; none are added
+     */
+    void addModels(const std::vector<tgModel*>& models);
+
+    /**
+     * Add several obstacles at once, prepared in parallel as addModels.
+     * @param[in] obstacles as for addObstacle
+     * @throw std::invalid_argument if any pointer is NULL; none are added
+     * @throw std::runtime_error if a prepare threw; none are added
+     */
+    void addObstacles(const std::vector<tgModel*>& obstacles);
+
+    /**
+     * Add copies of a small Tensegrity, each with its own controllers,
+     * to be evaluated side by side in this one world instead of one
+     * world each. Every instance gets a collision group of its own: its
+     * bodies collide with each other, the ground and obstacles, but
+     * never with another instance's, so all can be built in the same
+     * place, and the solver handles each as separate islands in one
+     * step. Scores and sensors stay per instance, as each model keeps
+     * its own controllers and senseables. The groups are applied again
+     * whenever the models are set up after a reset.
+     *
+     * The groups are Bullet's bits from 64 up, which replace any group
+     * a model's own tgBuildSpec collision filters gave it there; the
+     * masks keep only Bullet's groups below 64. Prepared in parallel as
+     * addModels.
+     * @param[in] models as for addModel
+     * @throw std::invalid_argument if any pointer is NULL, the
+     * simulation would have more than maxInstances, or a model has
+     * contact cables, whose ghosts do not respect the groups; such a
+     * model is left as if added by addModel, after the instances before
+     * it
+     * @throw std::runtime_error if a prepare threw; none are added
+     */
+    void addInstances(const std::vector<tgModel*>& models);
+
+    /**
+     * The most instances one simulation holds, one per collision group
+     * bit from 64 up in Bullet 2.82's 16 bit groups
+     */
+    static const std::size_t maxInstances = 9;
+
+    /**
+     * Move a built Tensegrity into another simulation, taking its rigid
+     * bodies out of this world and putting them in the other's as they
+     * are, with their velocities, and handing its batched cables to the
+     * other world's tgBulletCableForceEngine. Nothing is rebuilt, so its
+     * controllers carry on. The bodies keep their collision shapes,
+     * which may belong to this world: reset both simulations together.
+     * Snapshots of either world taken before the move cannot be
+     * restored after it.
+     * @param[in] pModel one of this simulation's models
+     * @param[in,out] destination built with the same tgWorld::Config
+     * @throw std::invalid_argument if pModel is not one of the models,
+     * destination is this simulation, or the model cannot be moved: it
+     * is an instance from addInstances, it has contact cables, whose ghosts cannot change worlds, or
+     * constraints or cables joining it to bodies of other models
+     */
+    void moveModel(tgModel* pModel, tgSimulation& destination);
+
     /**
      * Add a data manager to the simulation.
      * For example, add a data logger.
@@ -120,14 +219,182 @@ public:
      * ground will be deleted
      */
     void reset(tgGround* newGround);
+
+    /**
+     * Change the terrain between episodes without a teardown: the
+     * world's ground is swapped, then the world and actuators are
+     * restored from initialState. The models, obstacles, data managers
+     * and their bodies, shapes and controllers are kept; see restart to
+     * reset the controllers too.
+     * @param[in] newGround the new ground; the previous one is deleted
+     * @param[in] initialState from snapshot, e.g. right after setup
+     * @throw std::invalid_argument if the models have changed since
+     * initialState was taken
+     */
+    void swapGround(tgGround* newGround, const tgWorldSnapshot& initialState);
+    
+    /**
+     * Record the state of the world and of every actuator in the models
+     * and obstacles, so restore or restart can begin an episode again
+     * without a teardown.
+     * @param[out] snapshot overwritten with the current state
+     */
+    void snapshot(tgWorldSnapshot& snapshot) const;
+
+    /**
+     * Put the world and the actuators back to a recorded state without
+     * reallocating anything.
+     * @param[in] snapshot taken since the last reset
+     * @throw std::invalid_argument if the world has changed since
+     */
+    void restore(const tgWorldSnapshot& snapshot) const;
+
+    /**
+     * Start a new episode without a teardown: restore initialState, then
+     * call resetEpisode on the models and obstacles, so their
+     * controllers can put their own state back in place. Controllers
+     * that cannot are torn down and set up again by their subjects.
+     * @param[in] initialState from snapshot, e.g. right after setup
+     * @throw std::invalid_argument if the world has changed since
+     */
+    void restart(const tgWorldSnapshot& initialState);
+
+    /**
+     * Put the world and the actuators in the state recorded from
+     * another simulation, whose models were built the same way in the
+     * same order, e.g. from one tgModelTemplate. Bodies, actuators and
+     * contact manifolds are matched by their order in the snapshots.
+     * @param[in] snapshot taken from the other simulation
+     * @throw std::invalid_argument if the bodies or actuators do not
+     * correspond
+     */
+    void restoreFrom(const tgWorldSnapshot& snapshot) const;
+
+    /**
+     * Copy the state of the world and actuators into a branch: another
+     * simulation built with the same models, which then runs on
+     * independently of this one. Branches are meant to be reused for
+     * many forks; see tgForkPool. Controllers that keep their own state
+     * are copied by the application.
+     * @param[in,out] branch the simulation to copy into
+     * @throw std::invalid_argument if branch is this simulation or its
+     * models do not correspond
+     */
+    void fork(tgSimulation& branch) const;
     
     /**
      * Returns a reference to the world
      */
     tgWorld& getWorld() const;
 
+    /**
+     * The timestep of each step, from the view
+     */
+    double getStepSize() const;
+
+    /**
+     * Every actuator of the models and obstacles, in a fixed order
+     * @param[out] actuators overwritten; does not allocate once it has
+     * held them all
+     */
+    void collectActuators(std::vector<tgSpringCableActuator*>& actuators) const;
+
+    /**
+     * Start adding up Bullet's profiler (the BT_PROFILE scopes) over every
+     * step from now on, for runs without the GLUT overlay. Restarts the
+     * totals if profiling was already enabled. Does nothing useful if
+     * Bullet was built with BT_NO_PROFILE.
+     * @param[in] fileName if not empty, the totals so far are written
+     * here on every reset and when the simulation is destroyed
+     * @param[in] format eJSON or eCSV
+     */
+    void enableProfiling(const std::string& fileName = "",
+                         tgProfileReport::Format format = tgProfileReport::eJSON);
+
+    /** Stop profiling and forget the totals; nothing more is written. */
+    void disableProfiling();
+
+    /**
+     * Log the actuators' commands after every step from now on, with a
+     * tgCommandRecorder, until stopCommandLog or a reset. Start from a
+     * state the replay can start from too, such as just after the models
+     * were added or a reset. With cableSubsteps above 1 only the
+     * commands at the end of each step are logged.
+     * @param[in] fileName the log to write
+     * @throw std::runtime_error if it cannot be written
+     */
+    void recordCommands(const std::string& fileName);
+
+    /**
+     * Give the actuators the commands of a log on every step from now
+     * on, with a tgCommandPlayer, until the log ends, stopCommandLog or
+     * a reset. The models should have been built without their
+     * controllers.
+     * @param[in] fileName a log from recordCommands
+     * @throw std::runtime_error if it cannot be read or was recorded
+     * with other actuators
+     */
+    void replayCommands(const std::string& fileName);
+
+    /** Finish a recording or stop a replay */
+    void stopCommandLog();
+
+    /** True while a replay has steps left */
+    bool isReplaying() const;
+
+    /**
+     * The totals since enableProfiling.
+     * @return NULL if profiling is not enabled
+     */
+    const tgProfileReport* getProfileReport() const
+    {
+        return m_pProfile;
+    }
+
+    /**
+     * How the sampled steps split between the world, each model, the
+     * obstacles, the data managers and the observers notified by the
+     * models. Always on; see tgStepTimer::setSampleInterval and
+     * tgStepTimer::setDumpInterval to change how often steps are timed
+     * and to have the summary written as the run goes.
+     */
+    tgStepTimer& getStepTimer() const
+    {
+        return m_stepTimer;
+    }
+
+    /**
+     * Allocations per step by phase and model, live bytes over the run,
+     * and allocations in the steps after a warmup, which a model in a
+     * steady state should not need. Only counts in a build configured
+     * with -DNTRT_ALLOC_STATS=ON.
+     */
+    tgAllocMonitor& getAllocMonitor() const
+    {
+        return m_allocMonitor;
+    }
+
  private:
     
+    /** Write the profile totals, if a file was given */
+    void writeProfile() const;
+
+    /**
+     * Call tgModel::prepare on every model, on as many threads as there
+     * are processors
+     * @throw std::runtime_error if any prepare threw
+     */
+    static void prepareModels(const std::vector<tgModel*>& models);
+
+    /** Prepare m_models together, then set them up in order */
+    void setupModels();
+
+    /** Put a set up instance's bodies in its collision group */
+    void isolateInstance(tgModel& model, int instance) const;
+
+    /** Make the data managers' channels sample again when next read */
+    void invalidateChannels() const;
+
     /**
      * Calls teardown on all of the models and reset on the world
      */
@@ -147,6 +414,9 @@ private:
      * @todo Should this be std::set?
      */
     std::vector<tgModel*> m_models;
+
+    /** The models added by addInstances, with their instance numbers */
+    std::map<const tgModel*, int> m_instances;
     
     /**
      * Obstacles are models that are deleted after one simulation
@@ -156,6 +426,28 @@ private:
      */
     std::vector<tgModel*> m_obstacles;
 
+    /** The obstacles that are not static, in m_obstacles order */
+    std::vector<tgModel*> m_steppedObstacles;
+
+    /** The profiler totals; NULL unless profiling is enabled */
+    tgProfileReport* m_pProfile;
+
+    std::string m_profileFileName;
+
+    tgProfileReport::Format m_profileFormat;
+
+    /** NULL unless recording commands */
+    tgCommandRecorder* m_pRecorder;
+
+    /** NULL unless replaying commands */
+    tgCommandPlayer* m_pPlayer;
+
+    /** Counts every step, so it changes in the const step */
+    mutable tgStepTimer m_stepTimer;
+
+    /** Also changes in the const step */
+    mutable tgAllocMonitor m_allocMonitor;
+
     /**
      * All the data managers for this simulation.
      * Similar structure to the models and obstacles.
@@ -0,0 +1,292 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSpatialQuery.cpp
+ * @brief Contains the definitions of members of class tgSpatialQuery
+ * $Id$
+ */
+
+// This module
+#include "tgSpatialQuery.h"
+// This application
+#include "tgBulletUtil.h"
+#include "tgWorld.h"
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btBroadphaseInterface.h"
+#include "BulletCollision/BroadphaseCollision/btBroadphaseProxy.h"
+#include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+#include "BulletCollision/CollisionShapes/btCompoundShape.h"
+#include "BulletCollision/CollisionShapes/btConvexShape.h"
+#include "BulletCollision/CollisionShapes/btSphereShape.h"
+#include "BulletCollision/NarrowPhaseCollision/btGjkEpaPenetrationDepthSolver.h"
+#include "BulletCollision/NarrowPhaseCollision/btGjkPairDetector.h"
+#include "BulletCollision/NarrowPhaseCollision/btPointCollector.h"
+#include "BulletCollision/NarrowPhaseCollision/btVoronoiSimplexSolver.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "LinearMath/btAabbUtil2.h"
+#include "LinearMath/btTransform.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+namespace
+{
+    /** Gathers the objects in the mask whose bounds overlap a box */
+    class AabbCollector : public btBroadphaseAabbCallback
+    {
+    public:
+        AabbCollector(const btVector3& aabbMin, const btVector3& aabbMax,
+                      int mask,
+                      std::vector<const btCollisionObject*>& objects) :
+        m_aabbMin(aabbMin),
+        m_aabbMax(aabbMax),
+        m_mask(mask),
+        m_objects(objects)
+        {
+        }
+
+        virtual bool process(const btBroadphaseProxy* pProxy)
+        {
+            if ((pProxy->m_collisionFilterGroup & m_mask) == 0)
+            {
+                return true;
+            }
+            const btCollisionObject* const pObject =
+                static_cast<const btCollisionObject*>(pProxy->m_clientObject);
+            // The broadphase's bounds are padded; check the shape's own
+            btVector3 objectMin;
+            btVector3 objectMax;
+            pObject->getCollisionShape()->getAabb(pObject->getWorldTransform(),
+                                                  objectMin, objectMax);
+            if (TestAabbAgainstAabb2(m_aabbMin, m_aabbMax, objectMin, objectMax))
+            {
+                m_objects.push_back(pObject);
+            }
+            return true;
+        }
+
+    private:
+        const btVector3 m_aabbMin;
+        const btVector3 m_aabbMax;
+        const int m_mask;
+        std::vector<const btCollisionObject*>& m_objects;
+    };
+
+    /** The distance from a point to a box, and the nearest point in it */
+    double distanceToAabb(const btVector3& point, const btVector3& aabbMin,
+                          const btVector3& aabbMax, btVector3& nearestPoint)
+    {
+        nearestPoint = point;
+        nearestPoint.setMax(aabbMin);
+        nearestPoint.setMin(aabbMax);
+        return nearestPoint.distance(point);
+    }
+} // namespace
+
+tgSpatialQuery::Hit::Hit() :
+pObject(NULL),
+point(0.0, 0.0, 0.0),
+normal(0.0, 0.0, 0.0),
+fraction(1.0)
+{
+}
+
+tgSpatialQuery::Nearest::Nearest() :
+pObject(NULL),
+distance(0.0),
+point(0.0, 0.0, 0.0)
+{
+}
+
+tgSpatialQuery::tgSpatialQuery(const tgWorld& world) :
+m_world(world)
+{
+}
+
+const std::vector<const btCollisionObject*>&
+tgSpatialQuery::overlapAabb(const btVector3& aabbMin, const btVector3& aabbMax,
+                            int mask)
+{
+    m_overlaps.clear();
+    AabbCollector collector(aabbMin, aabbMax, mask, m_overlaps);
+    btDynamicsWorld& dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(m_world);
+    dynamicsWorld.getBroadphase()->aabbTest(aabbMin, aabbMax, collector);
+    return m_overlaps;
+}
+
+bool tgSpatialQuery::distanceTo(const btVector3& point,
+                                const btCollisionShape& shape,
+                                const btTransform& transform, double bound,
+                                double& distance, btVector3& nearestPoint)
+{
+    btVector3 aabbMin;
+    btVector3 aabbMax;
+    shape.getAabb(transform, aabbMin, aabbMax);
+    btVector3 boxPoint;
+    const double boxDistance = distanceToAabb(point, aabbMin, aabbMax, boxPoint);
+    // No shape is nearer than its bounding box
+    if (boxDistance > bound)
+    {
+        return false;
+    }
+
+    if (shape.isCompound())
+    {
+        const btCompoundShape& compound =
+            static_cast<const btCompoundShape&>(shape);
+        bool found = false;
+        for (int i = 0; i < compound.getNumChildShapes(); i++)
+        {
+            double childDistance;
+            btVector3 childPoint;
+            if (distanceTo(point, *compound.getChildShape(i),
+                           transform * compound.getChildTransform(i), bound,
+                           childDistance, childPoint))
+            {
+                bound = childDistance;
+                distance = childDistance;
+                nearestPoint = childPoint;
+                found = true;
+            }
+        }
+        return found;
+    }
+    else if (shape.isConvex())
+    {
+        // A sphere of no radius is the point
+        const btSphereShape pointShape(0.0);
+        btVoronoiSimplexSolver simplexSolver;
+        btGjkEpaPenetrationDepthSolver penetrationSolver;
+        btGjkPairDetector detector(&pointShape,
+                                   static_cast<const btConvexShape*>(&shape),
+                                   &simplexSolver, &penetrationSolver);
+        btGjkPairDetector::ClosestPointInput input;
+        input.m_transformA = btTransform(btQuaternion::getIdentity(), point);
+        input.m_transformB = transform;
+        btPointCollector output;
+        detector.getClosestPoints(input, output, NULL);
+        if (!output.m_hasResult || output.m_distance > bound)
+        {
+            return false;
+        }
+        distance = output.m_distance;
+        nearestPoint = output.m_pointInWorld;
+        return true;
+    }
+    else
+    {
+        distance = boxDistance;
+        nearestPoint = boxPoint;
+        return true;
+    }
+}
+
+bool tgSpatialQuery::nearest(const btVector3& point, double maxDistance,
+                             Nearest& result, int mask)
+{
+    if (maxDistance <= 0.0)
+    {
+        throw std::invalid_argument("Spatial query distance is not positive");
+    }
+    result = Nearest();
+
+    const btVector3 reach(maxDistance, maxDistance, maxDistance);
+    const std::vector<const btCollisionObject*>& candidates =
+        overlapAabb(point - reach, point + reach, mask);
+
+    double bound = maxDistance;
+    for (std::size_t i = 0; i < candidates.size(); i++)
+    {
+        const btCollisionObject* const pObject = candidates[i];
+        double distance;
+        btVector3 nearestPoint;
+        if (distanceTo(point, *pObject->getCollisionShape(),
+                       pObject->getWorldTransform(), bound,
+                       distance, nearestPoint))
+        {
+            bound = distance;
+            result.pObject = pObject;
+            result.distance = distance;
+            result.point = nearestPoint;
+        }
+    }
+    return result.pObject != NULL;
+}
+
+bool tgSpatialQuery::sweepSphere(const btVector3& from, const btVector3& to,
+                                 double radius, Hit& hit, int mask)
+{
+    if (radius <= 0.0)
+    {
+        throw std::invalid_argument("Spatial query radius is not positive");
+    }
+    hit = Hit();
+
+    const btSphereShape sphere(radius);
+    btCollisionWorld::ClosestConvexResultCallback callback(from, to);
+    // Only the objects' groups are checked against the mask
+    callback.m_collisionFilterGroup = btBroadphaseProxy::AllFilter;
+    callback.m_collisionFilterMask = mask;
+    btDynamicsWorld& dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(m_world);
+    dynamicsWorld.convexSweepTest(&sphere,
+                                  btTransform(btQuaternion::getIdentity(), from),
+                                  btTransform(btQuaternion::getIdentity(), to),
+                                  callback);
+    if (!callback.hasHit())
+    {
+        return false;
+    }
+    hit.pObject = callback.m_hitCollisionObject;
+    hit.point = callback.m_hitPointWorld;
+    hit.normal = callback.m_hitNormalWorld;
+    hit.fraction = callback.m_closestHitFraction;
+    return true;
+}
+
+bool tgSpatialQuery::castRay(const btVector3& from, const btVector3& to,
+                             Hit& hit, int mask)
+{
+    hit = Hit();
+
+    btCollisionWorld::ClosestRayResultCallback callback(from, to);
+    callback.m_collisionFilterGroup = btBroadphaseProxy::AllFilter;
+    callback.m_collisionFilterMask = mask;
+    btDynamicsWorld& dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(m_world);
+    dynamicsWorld.rayTest(from, to, callback);
+    if (!callback.hasHit())
+    {
+        return false;
+    }
+    hit.pObject = callback.m_collisionObject;
+    hit.point = callback.m_hitPointWorld;
+    hit.normal = callback.m_hitNormalWorld;
+    hit.fraction = callback.m_closestHitFraction;
+    return true;
+}
+
+const std::vector<tgSpatialQuery::Hit>&
+tgSpatialQuery::castRays(const std::vector<Ray>& rays, int mask)
+{
+    m_hits.resize(rays.size());
+    for (std::size_t i = 0; i < rays.size(); i++)
+    {
+        castRay(rays[i].from, rays[i].to, m_hits[i], mask);
+    }
+    return m_hits;
+}
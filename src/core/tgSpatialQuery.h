@@ -0,0 +1,195 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SPATIAL_QUERY_H
+#define TG_SPATIAL_QUERY_H
+
+/**
+ * @file tgSpatialQuery.h
+ * @brief Contains the definition of class tgSpatialQuery
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <vector>
+
+// Forward declarations
+class btCollisionObject;
+class btCollisionShape;
+class btTransform;
+class tgWorld;
+
+/**
+ * Geometric questions about a world, answered through its broadphase so
+ * that only the objects whose bounds are near the question are looked
+ * at: what overlaps a box, what is nearest a point, where a sphere
+ * moving along a line first hits, and where each of a batch of rays
+ * hits. For goal seeking and obstacle avoiding controllers that would
+ * otherwise walk their models' pieces or ray test the world themselves.
+ *
+ * Every query takes a mask of Bullet collision groups, and only objects
+ * whose group is in the mask are found. Groups are given to a model's
+ * rigids by tag with tgBuildSpec::addCollisionFilter, so e.g. a model
+ * whose rods are in group 64 finds the obstacles around it, and not
+ * itself, with defaultMask & ~64. The ground and other static bodies
+ * are in btBroadphaseProxy::StaticFilter (2).
+ *
+ * Results are kept in buffers that are reused, so queries do not
+ * allocate once the buffers are big enough, and a result is valid until
+ * the next query of the same kind. A tgWorld has one for everybody (see
+ * tgWorld::getSpatialQuery); a controller that keeps results across
+ * other queries can make its own. Only the world's current state is
+ * queried, so ask between steps.
+ */
+class tgSpatialQuery
+{
+public:
+
+    /** Every group but the ghost objects of contact cables (32) */
+    static const int defaultMask = ~32;
+
+    /** Where a ray or sweep first hit */
+    struct Hit
+    {
+        Hit();
+
+        /** What was hit; NULL if nothing was */
+        const btCollisionObject* pObject;
+        /** The point of contact, in world coordinates */
+        btVector3 point;
+        /** The surface normal of the object hit, at point */
+        btVector3 normal;
+        /** How far along from start to end the hit is, in [0, 1] */
+        double fraction;
+    };
+
+    /** A ray from one point to another, for castRays */
+    struct Ray
+    {
+        Ray(const btVector3& f = btVector3(0.0, 0.0, 0.0),
+            const btVector3& t = btVector3(0.0, 0.0, 0.0)) :
+        from(f),
+        to(t)
+        {
+        }
+
+        btVector3 from;
+        btVector3 to;
+    };
+
+    /** The object nearest a point */
+    struct Nearest
+    {
+        Nearest();
+
+        /** The nearest object; NULL if none was in range */
+        const btCollisionObject* pObject;
+        /**
+         * The distance from the point to the object's surface; negative
+         * inside a convex shape. For concave shapes, such as triangle
+         * meshes, the distance to their bounding box.
+         */
+        double distance;
+        /** The nearest point on the object, in world coordinates */
+        btVector3 point;
+    };
+
+    /**
+     * @param[in] world the world to query, which must outlive this.
+     * Resetting the world is fine.
+     */
+    explicit tgSpatialQuery(const tgWorld& world);
+
+    /**
+     * The objects whose bounding boxes overlap a box.
+     * @param[in] aabbMin the box's least corner
+     * @param[in] aabbMax the box's greatest corner
+     * @param[in] mask the collision groups to look for
+     * @return the objects, in no particular order, valid until the next
+     * overlapAabb or nearest
+     */
+    const std::vector<const btCollisionObject*>&
+    overlapAabb(const btVector3& aabbMin, const btVector3& aabbMax,
+                int mask = defaultMask);
+
+    /**
+     * The object nearest a point, within a distance.
+     * @param[in] point in world coordinates
+     * @param[in] maxDistance how far to look; must be positive
+     * @param[out] result the nearest object, or a NULL pObject
+     * @param[in] mask the collision groups to look for
+     * @return true if an object was in range
+     * @throw std::invalid_argument if maxDistance is not positive
+     */
+    bool nearest(const btVector3& point, double maxDistance,
+                 Nearest& result, int mask = defaultMask);
+
+    /**
+     * Move a sphere along a line, and find where it first touches an
+     * object. A sphere that starts out touching does not count them.
+     * @param[in] from the sphere's centre at the start
+     * @param[in] to the sphere's centre at the end
+     * @param[in] radius of the sphere; must be positive
+     * @param[out] hit the first contact, or a NULL pObject
+     * @param[in] mask the collision groups to look for
+     * @return true if the sphere hit something
+     * @throw std::invalid_argument if radius is not positive
+     */
+    bool sweepSphere(const btVector3& from, const btVector3& to,
+                     double radius, Hit& hit, int mask = defaultMask);
+
+    /**
+     * Where one ray first hits.
+     * @param[out] hit the first hit, or a NULL pObject
+     * @return true if the ray hit something
+     */
+    bool castRay(const btVector3& from, const btVector3& to, Hit& hit,
+                 int mask = defaultMask);
+
+    /**
+     * Where each of many rays first hits.
+     * @param[in] rays the rays
+     * @param[in] mask the collision groups to look for
+     * @return a hit per ray, in order, with a NULL pObject for those
+     * that missed; valid until the next castRays
+     */
+    const std::vector<Hit>& castRays(const std::vector<Ray>& rays,
+                                     int mask = defaultMask);
+
+private:
+
+    /**
+     * The distance from a point to a shape, and the nearest point on it,
+     * going into compound shapes.
+     * @param[in] bound give up on children further than this
+     * @return true if the shape is within bound
+     */
+    static bool distanceTo(const btVector3& point, const btCollisionShape& shape,
+                           const btTransform& transform, double bound,
+                           double& distance, btVector3& nearestPoint);
+
+    const tgWorld& m_world;
+
+    std::vector<const btCollisionObject*> m_overlaps;
+
+    std::vector<Hit> m_hits;
+};
+
+#endif  // TG_SPATIAL_QUERY_H
@@ -76,3 +76,38 @@ void tgSpringCable::setRestLength( const double newRestLength)
     
     m_restLength = newRestLength;
 }
+
+void tgSpringCable::setCoefficients(double coefK, double dampingCoefficient)
+{
+    if (coefK <= 0.0)
+    {
+        throw std::invalid_argument("Stiffness is not positive.");
+    }
+    else if (dampingCoefficient < 0.0)
+    {
+        throw std::invalid_argument("Damping is negative.");
+    }
+    
+    m_coefK = coefK;
+    m_dampingCoefficient = dampingCoefficient;
+}
+
+void tgSpringCable::saveState(std::vector<double>& state) const
+{
+    state.push_back(m_restLength);
+    state.push_back(m_prevLength);
+    state.push_back(m_velocity);
+    state.push_back(m_damping);
+}
+
+std::size_t tgSpringCable::restoreState(const std::vector<double>& state, std::size_t pos)
+{
+    assert(pos + 4 <= state.size());
+    
+    m_restLength = state[pos++];
+    m_prevLength = state[pos++];
+    m_velocity = state[pos++];
+    m_damping = state[pos++];
+    
+    return pos;
+}
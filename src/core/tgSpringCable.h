@@ -78,6 +78,15 @@ public:
      */
     virtual void setRestLength( const double newRestLength); 
     
+    /**
+     * Replace the stiffness and damping coefficients of a live cable,
+     * e.g. between trials that restore a snapshot, without rebuilding it.
+     * @param[in] coefK - the stiffness of the spring. Must be positive
+     * @param[in] dampingCoefficient - the damping in the spring. Must be non-negative
+     * @throw std::invalid_argument if a coefficient is out of range
+     */
+    virtual void setCoefficients(double coefK, double dampingCoefficient);
+    
     /**
      * Pure virtual funciton, returns the actual length of the spring
      * cable
@@ -126,6 +135,21 @@ public:
      * always define a way to return a vector of base anchors
      */
     virtual const std::vector<const tgSpringCableAnchor*> getAnchors() const = 0;
+    
+    /**
+     * Append the values that change while stepping (rest length,
+     * previous length, velocity and damping) for a tgWorldSnapshot
+     * @param[in,out] state the values are appended to this
+     */
+    virtual void saveState(std::vector<double>& state) const;
+    
+    /**
+     * Read back what saveState wrote
+     * @param[in] state as filled by saveState
+     * @param[in] pos the index of this cable's first value
+     * @return the index just past this cable's values
+     */
+    virtual std::size_t restoreState(const std::vector<double>& state, std::size_t pos);
 
 protected:
  
@@ -146,14 +170,14 @@ protected:
      * Units of mass / sec ^2
      * Must be positive
      */
-    const double m_coefK;
+    double m_coefK;
 
     /**
      * The damping coefficient.
      * Units of mass / sec. 
      * Must be non-negative
      */
-    const double m_dampingCoefficient;
+    double m_dampingCoefficient;
     
     
         /**
@@ -28,6 +28,7 @@
 #include "tgSpringCable.h"
 #include "tgWorld.h"
 // The C++ Standard Library
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <stdexcept>
@@ -44,18 +45,26 @@ tgSpringCableActuator::Config::Config(double s,
                    double mnRL,
 		   double rot,
    	           bool moveCPA,
-		   bool moveCPB) :
+		   bool moveCPB,
+		   std::size_t hCap,
+		   std::size_t hDec,
+		   bool impl,
+		   bool constr) :
   stiffness(s),
   damping(d),
   pretension(p),
   hist(h),
+  histCapacity(hCap),
+  histDecimation(hDec),
   maxTens(mf),
   targetVelocity(tVel),
   minActualLength(mnAL),
   minRestLength(mnRL),
   rotation(rot),
   moveCablePointAToEdge(moveCPA),
-  moveCablePointBToEdge(moveCPB)
+  moveCablePointBToEdge(moveCPB),
+  implicitForces(impl),
+  solverConstraint(constr)
 {
     ///@todo is this the right place for this, or the constructor of this class?
     if (s < 0.0)
@@ -69,6 +78,10 @@ tgSpringCableActuator::Config::Config(double s,
     /* Pretension is checked in Muscle2P, and can be any value
      * i.e. starting with a slack string
      */
+    else if (hDec == 0)
+    {
+        throw std::invalid_argument("history decimation is zero.");
+    }
     else if (mf < 0.0)
     {
         throw std::invalid_argument("max tension is negative.");
@@ -98,6 +111,53 @@ void tgSpringCableActuator::Config::scale (double sf)
 
 
 
+void tgSpringCableActuator::SpringCableActuatorStats::reset()
+{
+    samples = 0;
+    work = 0.0;
+    shorteningWork = 0.0;
+    energy = 0.0;
+    peakTension = 0.0;
+    sumTension = 0.0;
+    minLength = 0.0;
+    maxLength = 0.0;
+    minRestLength = 0.0;
+    maxRestLength = 0.0;
+    lastTension = 0.0;
+    lastRestLength = 0.0;
+}
+
+void tgSpringCableActuator::SpringCableActuatorStats::update(double restLength,
+                                                             double actualLength,
+                                                             double tension)
+{
+    if (samples == 0)
+    {
+        peakTension = tension;
+        minLength = maxLength = actualLength;
+        minRestLength = maxRestLength = restLength;
+    }
+    else
+    {
+        const double stepWork = lastTension * (restLength - lastRestLength);
+        work += stepWork;
+        if (restLength < lastRestLength)
+        {
+            shorteningWork += stepWork;
+        }
+        energy += std::fabs(stepWork);
+        peakTension = std::max(peakTension, tension);
+        minLength = std::min(minLength, actualLength);
+        maxLength = std::max(maxLength, actualLength);
+        minRestLength = std::min(minRestLength, restLength);
+        maxRestLength = std::max(maxRestLength, restLength);
+    }
+    samples++;
+    sumTension += tension;
+    lastTension = tension;
+    lastRestLength = restLength;
+}
+
 void tgSpringCableActuator::constructorAux()
 {
     if (m_config.targetVelocity < 0.0)
@@ -119,10 +179,14 @@ tgSpringCableActuator::tgSpringCableActuator(tgSpringCable* springCable,
     tgModel(tags),
     m_springCable(springCable),
     m_config(config),
-    m_pHistory(new SpringCableActuatorHistory()),
+    m_pHistory(new SpringCableActuatorHistory(config.histCapacity,
+                                              config.histDecimation)),
     m_restLength(springCable->getRestLength()),
     m_startLength(springCable->getActualLength()),
-    m_prevVelocity(0.0)
+    m_prevVelocity(0.0),
+    m_aboveMaxTension(false),
+    m_atMinLength(false),
+    m_anchorCount(2)
 {
     constructorAux();
 
@@ -146,6 +210,15 @@ void tgSpringCableActuator::teardown()
 {
     tgModel::teardown();
 }
+
+void tgSpringCableActuator::resetEpisode()
+{
+    m_aboveMaxTension = false;
+    m_atMinLength = false;
+    m_anchorCount = 2;
+    notifyReset();
+    tgModel::resetEpisode();
+}
     
 void tgSpringCableActuator::step(double dt) 
 {
@@ -189,6 +262,151 @@ const tgSpringCableActuator::SpringCableActuatorHistory& tgSpringCableActuator::
     return *m_pHistory;
 }
 
+void tgSpringCableActuator::setParameters(const Config& config)
+{
+    // The same checks as Config's and our own constructors
+    const Config checked(config.stiffness, config.damping, config.pretension,
+                         m_config.hist, config.maxTens, config.targetVelocity,
+                         config.minActualLength, config.minRestLength,
+                         m_config.rotation, m_config.moveCablePointAToEdge,
+                         m_config.moveCablePointBToEdge,
+                         m_config.histCapacity, m_config.histDecimation,
+                         m_config.implicitForces, m_config.solverConstraint);
+    if (checked.stiffness <= 0.0)
+    {
+        throw std::invalid_argument("Stiffness is not positive.");
+    }
+    else if (checked.targetVelocity < 0.0)
+    {
+        throw std::invalid_argument("Target velocity is negative.");
+    }
+    else if (checked.minActualLength < 0.0)
+    {
+        throw std::invalid_argument("Minimum length is negative.");
+    }
+    
+    const double restLength =
+        m_startLength - checked.pretension / checked.stiffness;
+    if (restLength <= 0.0)
+    {
+        throw std::invalid_argument("Pretension causes string to shorten past rest length!");
+    }
+    
+    m_springCable->setCoefficients(checked.stiffness, checked.damping);
+    m_springCable->setRestLength(restLength);
+    m_restLength = restLength;
+    m_config = checked;
+    
+    // Postcondition
+    assert(invariant());
+}
+
+void tgSpringCableActuator::resetStats()
+{
+    m_stats.reset();
+}
+
+void tgSpringCableActuator::raiseEvents()
+{
+    if (hasSubscribers(tgEvent::eTensionLimit))
+    {
+        const double tension = getTension();
+        const bool above = tension > m_config.maxTens;
+        if (above && !m_aboveMaxTension)
+        {
+            notifyEvent(tgEvent(tgEvent::eTensionLimit, tension));
+        }
+        m_aboveMaxTension = above;
+    }
+    if (hasSubscribers(tgEvent::eMinLength))
+    {
+        const double length = m_springCable->getActualLength();
+        const bool atMin = length <= m_config.minActualLength;
+        if (atMin && !m_atMinLength)
+        {
+            notifyEvent(tgEvent(tgEvent::eMinLength, length));
+        }
+        m_atMinLength = atMin;
+    }
+    if (hasSubscribers(tgEvent::eContactBegan) ||
+        hasSubscribers(tgEvent::eContactEnded))
+    {
+        // Only a contact cable has more than its two end anchors
+        const std::size_t anchors = m_springCable->getAnchors().size();
+        if (anchors != m_anchorCount)
+        {
+            const double contacts = anchors > 2 ? anchors - 2 : 0;
+            notifyEvent(tgEvent(anchors > m_anchorCount ?
+                                tgEvent::eContactBegan : tgEvent::eContactEnded,
+                                contacts));
+            m_anchorCount = anchors;
+        }
+    }
+}
+
+void tgSpringCableActuator::saveState(std::vector<double>& state) const
+{
+    state.push_back(m_restLength);
+    state.push_back(m_prevVelocity);
+    state.push_back(m_stats.samples);
+    state.push_back(m_stats.work);
+    state.push_back(m_stats.shorteningWork);
+    state.push_back(m_stats.energy);
+    state.push_back(m_stats.peakTension);
+    state.push_back(m_stats.sumTension);
+    state.push_back(m_stats.minLength);
+    state.push_back(m_stats.maxLength);
+    state.push_back(m_stats.minRestLength);
+    state.push_back(m_stats.maxRestLength);
+    state.push_back(m_stats.lastTension);
+    state.push_back(m_stats.lastRestLength);
+    m_springCable->saveState(state);
+    m_pHistory->lastLengths.saveState(state);
+    m_pHistory->restLengths.saveState(state);
+    m_pHistory->dampingHistory.saveState(state);
+    m_pHistory->lastVelocities.saveState(state);
+    m_pHistory->tensionHistory.saveState(state);
+}
+
+std::size_t tgSpringCableActuator::restoreState(const std::vector<double>& state,
+                                                std::size_t pos)
+{
+    assert(pos + 14 <= state.size());
+    m_restLength = state[pos++];
+    m_prevVelocity = state[pos++];
+    m_stats.samples = static_cast<std::size_t>(state[pos++]);
+    m_stats.work = state[pos++];
+    m_stats.shorteningWork = state[pos++];
+    m_stats.energy = state[pos++];
+    m_stats.peakTension = state[pos++];
+    m_stats.sumTension = state[pos++];
+    m_stats.minLength = state[pos++];
+    m_stats.maxLength = state[pos++];
+    m_stats.minRestLength = state[pos++];
+    m_stats.maxRestLength = state[pos++];
+    m_stats.lastTension = state[pos++];
+    m_stats.lastRestLength = state[pos++];
+    pos = m_springCable->restoreState(state, pos);
+    
+    pos = m_pHistory->lastLengths.restoreState(state, pos);
+    pos = m_pHistory->restLengths.restoreState(state, pos);
+    pos = m_pHistory->dampingHistory.restoreState(state, pos);
+    pos = m_pHistory->lastVelocities.restoreState(state, pos);
+    pos = m_pHistory->tensionHistory.restoreState(state, pos);
+    
+    return pos;
+}
+
+void tgSpringCableActuator::saveCommand(std::vector<double>& command) const
+{
+}
+
+std::size_t tgSpringCableActuator::restoreCommand(const std::vector<double>& command,
+                                                  std::size_t pos)
+{
+    return pos;
+}
+
 bool tgSpringCableActuator::invariant() const
 {
     return
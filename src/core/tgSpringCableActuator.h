@@ -31,8 +31,9 @@
 #include "tgModel.h"
 #include "tgControllable.h"
 #include "tgSubject.h"
+#include "tgHistoryBuffer.h" // For history
 
-#include <deque> // For history
+#include <vector>
 // Forward declarations
 class tgWorld;
 class tgSpringCable;
@@ -66,7 +67,11 @@ public:
         double mnRL = 0.1,
 	double rot = 0,
 	bool moveCPA = true,
-	bool moveCPB = true);
+	bool moveCPB = true,
+	std::size_t hCap = 0,
+	std::size_t hDec = 1,
+	bool impl = false,
+	bool constr = false);
       
       /**
        * Scale parameters that depend on the length of the simulation.
@@ -102,9 +107,20 @@ public:
       // History Parameters
       /**
        * Specifies whether data such as length and tension will be stored
-       * in deque objects. Useful for computing the energy of a trial.
+       * in tgHistoryBuffer objects. Useful for computing the energy of a trial.
        */
       bool hist;
+      
+      /**
+       * The number of samples each history sequence keeps, the most
+       * recent ones. 0 keeps the whole episode.
+       */
+      std::size_t histCapacity;
+      
+      /**
+       * Keep one history sample every histDecimation steps. Must be positive.
+       */
+      std::size_t histDecimation;
               
       // Motor model parameters
       /**
@@ -176,25 +192,123 @@ public:
       bool moveCablePointAToEdge;
       bool moveCablePointBToEdge;
       
+      /**
+       * Apply the spring-damper force of a two anchor cable implicitly,
+       * accounting for how the impulse changes the bodies' velocities
+       * within the step, so stiff cables stay stable at larger
+       * timesteps. Off by default, which keeps the explicit force.
+       * Implicit cables are not batched by tgBulletCableForceEngine.
+       */
+      bool implicitForces;
+      
+      /**
+       * Make a two anchor cable a tension only constraint in the world's
+       * solver, see tgBulletConstraintSpringCable, so nearly
+       * inextensible cables can run at larger timesteps still. Takes
+       * precedence over implicitForces. Off by default.
+       */
+      bool solverConstraint;
+      
     };
     
     /** Encapsulate the history members. */
     struct SpringCableActuatorHistory
     {
+        /**
+         * @param[in] capacity see Config::histCapacity
+         * @param[in] decimation see Config::histDecimation
+         */
+        SpringCableActuatorHistory(std::size_t capacity = 0,
+                                   std::size_t decimation = 1) :
+        lastLengths(capacity, decimation),
+        restLengths(capacity, decimation),
+        dampingHistory(capacity, decimation),
+        lastVelocities(capacity, decimation),
+        tensionHistory(capacity, decimation)
+        { }
+        
         /** Length history. */
-        std::deque<double> lastLengths;
+        tgHistoryBuffer lastLengths;
         
         /** Rest length history. */
-        std::deque<double> restLengths;
+        tgHistoryBuffer restLengths;
 
         /** Damping history. */
-        std::deque<double> dampingHistory;
+        tgHistoryBuffer dampingHistory;
 
         /** Velocity history. */
-        std::deque<double> lastVelocities;
+        tgHistoryBuffer lastVelocities;
         
         /** Tension history. */
-        std::deque<double> tensionHistory;
+        tgHistoryBuffer tensionHistory;
+    };
+
+    /**
+     * Running statistics of an episode, updated in constant time each
+     * step whether or not history is kept, so learning runs can score
+     * energy without storing and copying the whole history. A step's
+     * tension and rest length are those tensionHistory and restLengths
+     * would record, so with the default history settings these match
+     * the sums the controllers used to take over the history.
+     */
+    struct SpringCableActuatorStats
+    {
+        SpringCableActuatorStats()
+        {
+            reset();
+        }
+        
+        /** Forget every sample */
+        void reset();
+        
+        /** Add the sample of a step */
+        void update(double restLength, double actualLength, double tension);
+        
+        /** The mean of the tension samples, or 0 without samples */
+        double meanTension() const
+        {
+            return samples > 0 ? sumTension / samples : 0.0;
+        }
+        
+        /** The range of the actual length, or 0 without samples */
+        double lengthExcursion() const
+        {
+            return samples > 0 ? maxLength - minLength : 0.0;
+        }
+        
+        /** The number of steps sampled, including the first */
+        std::size_t samples;
+        
+        /**
+         * Sum over steps of the previous tension times the change in
+         * rest length: the work the cable did on the motor.
+         */
+        double work;
+        
+        /**
+         * The same, over only the steps that shortened the rest length,
+         * so zero or negative: the energy the learning controllers
+         * score a gait by.
+         */
+        double shorteningWork;
+        
+        /** Sum of the magnitude of each step's work */
+        double energy;
+        
+        double peakTension;
+        double sumTension;
+        
+        /** The extremes of the actual length */
+        double minLength;
+        double maxLength;
+        
+        /** The extremes of the rest length */
+        double minRestLength;
+        double maxRestLength;
+        
+        /** The last sample, for the next step's work */
+        double lastTension;
+        double lastRestLength;
     };
 
     /** Deletes history and spring cable instantiation */
@@ -205,6 +319,9 @@ public:
     
     /** Just calls tgModel::teardown(world) - sets up any children */
     virtual void teardown();
+
+    /** Notifies observers of the new episode, then resets any children */
+    virtual void resetEpisode();
     
     /** Just calls tgModel::step(dt) - steps any children */
     virtual void step(double dt);
@@ -247,6 +364,67 @@ public:
      */
     virtual const tgSpringCableActuator::SpringCableActuatorHistory& getHistory() const;
     
+    /**
+     * Return the statistics of the steps since construction, the last
+     * resetStats or the state a restore put back.
+     */
+    const tgSpringCableActuator::SpringCableActuatorStats& getStats() const
+    {
+        return m_stats;
+    }
+    
+    /** Start the statistics over from the next step */
+    void resetStats();
+    
+    /**
+     * Append everything that changes while stepping, including the
+     * spring cable's state and each history sequence, so
+     * tgSimulation::restore can put it back. Child classes with their
+     * own motor state extend this.
+     * @param[in,out] state the values are appended to this
+     */
+    virtual void saveState(std::vector<double>& state) const;
+    
+    /**
+     * Read back what saveState wrote, including the history.
+     * @param[in] state as filled by saveState
+     * @param[in] pos the index of this actuator's first value
+     * @return the index just past this actuator's values
+     */
+    virtual std::size_t restoreState(const std::vector<double>& state, std::size_t pos);
+
+    /**
+     * Append what controllers set, rather than what the actuator
+     * computes from it, so a tgCommandRecorder can log it and a
+     * tgCommandPlayer give it back without the controllers. The base
+     * class takes no commands; child classes that do extend this.
+     * @param[in,out] command the values are appended to this
+     */
+    virtual void saveCommand(std::vector<double>& command) const;
+
+    /**
+     * Apply what saveCommand wrote.
+     * @param[in] command as filled by saveCommand
+     * @param[in] pos the index of this actuator's first value
+     * @return the index just past this actuator's values
+     */
+    virtual std::size_t restoreCommand(const std::vector<double>& command,
+                                       std::size_t pos);
+    
+    /**
+     * Apply new cable and motor parameters to the live actuator, without
+     * rebuilding the model or touching Bullet. Meant for after
+     * tgSimulation::restore, between trials that only differ in these
+     * parameters. The stiffness, damping, pretension and motor limits are
+     * taken from config; the history, rotation, anchor and implicit force
+     * settings are fixed at construction and kept. The rest length is set
+     * from the start length and the new pretension, as at construction.
+     * @param[in] config validated by its constructor
+     * @throw std::invalid_argument if a value is out of range, or the
+     * pretension leaves no rest length
+     */
+    virtual void setParameters(const Config& config);
+    
     /**
      * Returns a pointer the string's tgBulletSpringCable. Used for rendering in
      * tgBulletRenderer
@@ -275,6 +453,16 @@ protected:
 			const tgTags& tags,
            tgSpringCableActuator::Config& config);
            
+    /**
+     * Raise the events observers have subscribed to: tgEvent::eTensionLimit
+     * when the tension rises above maxTens, tgEvent::eMinLength when the
+     * length falls to minActualLength, and tgEvent::eContactBegan and
+     * eContactEnded when a contact cable gains or loses anchors. Each is
+     * raised once as the condition starts, not every step it holds.
+     * Called by the child classes' logHistory.
+     */
+    void raiseEvents();
+
 protected:
     /** The tgSpringCable system this actuator acts upon */
     tgSpringCable* m_springCable;
@@ -287,6 +475,9 @@ protected:
     
     /** All history sequences. */
     SpringCableActuatorHistory * const m_pHistory;
+    
+    /** Updated by the child classes' logHistory */
+    SpringCableActuatorStats m_stats;
 
     
      /**
@@ -314,6 +505,13 @@ protected:
     double m_prevVelocity;
 private:
 
+    /** Whether the limits held at the last raiseEvents */
+    bool m_aboveMaxTension;
+    bool m_atMinLength;
+
+    /** The contact cable's anchors at the last raiseEvents */
+    std::size_t m_anchorCount;
+
     /**
      * Helper function to perform what is in common to all constructor bodies.
      */
@@ -0,0 +1,205 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgStepPlan.cpp
+ * @brief Contains the definitions of members of class tgStepPlan
+ * $Id$
+ */
+
+// This module
+#include "tgStepPlan.h"
+// This application
+#include "tgModel.h"
+#include "tgBasicActuator.h"
+#include "tgKinematicActuator.h"
+#include "tgBaseRigid.h"
+#include "tgRod.h"
+#include "tgBox.h"
+#include "tgBoxMoreAnchors.h"
+#include "tgSphere.h"
+#include "tgSpringCable.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <cassert>
+#include <typeinfo>
+
+tgStepPlan::tgStepPlan() :
+m_kinematicCount(0),
+m_compiled(false)
+{
+}
+
+void tgStepPlan::clear()
+{
+    m_kinds.clear();
+    m_models.clear();
+    m_runLengths.clear();
+    m_kinematicCount = 0;
+    m_motorBank.clear();
+    m_compiled = false;
+}
+
+void tgStepPlan::compile(const std::vector<tgModel*>& children)
+{
+    clear();
+    for (std::size_t i = 0; i < children.size(); i++)
+    {
+        compileChild(children[i]);
+    }
+
+    // Group consecutive kinematic actuators
+    m_runLengths.assign(m_kinds.size(), 0);
+    std::size_t first = 0;
+    for (std::size_t i = 0; i < m_kinds.size(); i++)
+    {
+        if (m_kinds[i] != eKinematicActuator)
+        {
+            continue;
+        }
+        if (i == 0 || m_kinds[i - 1] != eKinematicActuator)
+        {
+            first = i;
+        }
+        m_runLengths[first]++;
+        m_kinematicCount++;
+    }
+    m_compiled = true;
+}
+
+void tgStepPlan::compileChild(tgModel* pChild)
+{
+    assert(pChild != NULL);
+
+    // Nothing below it to step
+    if (pChild->isStatic())
+    {
+        return;
+    }
+
+    // Compare exact types, so a subclass that overrides step keeps it
+    const std::type_info& type = typeid(*pChild);
+    if (type == typeid(tgBasicActuator))
+    {
+        m_kinds.push_back(eBasicActuator);
+        m_models.push_back(pChild);
+    }
+    else if (type == typeid(tgKinematicActuator))
+    {
+        m_kinds.push_back(eKinematicActuator);
+        m_models.push_back(pChild);
+    }
+    else if (type == typeid(tgModel) ||
+             type == typeid(tgBaseRigid) ||
+             type == typeid(tgRod) ||
+             type == typeid(tgBox) ||
+             type == typeid(tgBoxMoreAnchors) ||
+             type == typeid(tgSphere))
+    {
+        // Nothing of its own to step
+    }
+    else
+    {
+        // Steps itself, children included
+        m_kinds.push_back(eVirtual);
+        m_models.push_back(pChild);
+        return;
+    }
+
+    // The actuators step their children after themselves, as do we
+    const std::vector<tgModel*>& grandchildren = pChild->m_children;
+    for (std::size_t i = 0; i < grandchildren.size(); i++)
+    {
+        compileChild(grandchildren[i]);
+    }
+}
+
+void tgStepPlan::step(double dt) const
+{
+    assert(m_compiled);
+    assert(dt > 0.0);
+
+    // Actuators leave the bank when deleted or taken by another plan
+    if (m_motorBank.size() != m_kinematicCount)
+    {
+        bindMotors();
+    }
+
+    const std::size_t n = m_models.size();
+    std::size_t bankIndex = 0;
+    std::size_t i = 0;
+    while (i < n)
+    {
+        tgModel* const pModel = m_models[i];
+        switch (m_kinds[i])
+        {
+        case eBasicActuator:
+            static_cast<tgBasicActuator*>(pModel)->stepActuator(dt);
+            i++;
+            break;
+        case eKinematicActuator:
+            stepKinematicRun(i, bankIndex, dt);
+            bankIndex += m_runLengths[i];
+            i += m_runLengths[i];
+            break;
+        default:
+            pModel->step(dt);
+            i++;
+            break;
+        }
+    }
+}
+
+void tgStepPlan::stepKinematicRun(std::size_t first,
+                                  std::size_t bankIndex,
+                                  double dt) const
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgStepPlan::stepKinematicRun");
+#endif //BT_NO_PROFILE
+    const std::size_t count = m_runLengths[first];
+    assert(count > 0);
+
+    // tgKinematicActuator::stepActuator, one phase at a time
+    for (std::size_t k = 0; k < count; k++)
+    {
+        static_cast<tgKinematicActuator*>(m_models[first + k])->notifyStep(dt);
+    }
+    m_motorBank.integrate(bankIndex, bankIndex + count, dt);
+    for (std::size_t k = 0; k < count; k++)
+    {
+        tgKinematicActuator* const pActuator =
+            static_cast<tgKinematicActuator*>(m_models[first + k]);
+        pActuator->m_springCable->step(dt);
+        pActuator->logHistory();
+    }
+}
+
+void tgStepPlan::bindMotors() const
+{
+    m_motorBank.clear();
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        if (m_kinds[i] == eKinematicActuator)
+        {
+            m_motorBank.add(static_cast<tgKinematicActuator*>(m_models[i]));
+        }
+    }
+    assert(m_motorBank.size() == m_kinematicCount);
+}
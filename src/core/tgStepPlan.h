@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_STEP_PLAN_H
+#define TG_STEP_PLAN_H
+
+/**
+ * @file tgStepPlan.h
+ * @brief Contains the definition of class tgStepPlan
+ * $Id$
+ */
+
+// This application
+#include "tgKinematicMotorBank.h"
+// The C++ Standard Library
+#include <vector>
+
+// Forward declarations
+class tgModel;
+
+/**
+ * The children of a tgModel, flattened into one array in the order the
+ * recursive tgModel::step would have visited them.
+ *
+ * Library types whose step is known are not descended into virtually:
+ * rigid bodies and plain tgModels have nothing to step and only
+ * contribute their children, and tgBasicActuator and tgKinematicActuator
+ * are stepped through a non-virtual call that skips the dt check. Any
+ * other type, including every application model and its subclasses of
+ * the above, keeps its own virtual step and is not descended into.
+ *
+ * Consecutive tgKinematicActuators are stepped as a group: all of their
+ * observers are notified, their motors are integrated together in a
+ * tgKinematicMotorBank, and then their cables are stepped. An observer
+ * of one of them therefore sees the others' cables as they were before
+ * the step. The actuators join the plan's bank the first time the plan
+ * steps them.
+ *
+ * Static models (see tgModel::isStatic) are left out with their
+ * subtrees.
+ *
+ * The caller is responsible for checking dt; tgModel::step does so once
+ * for the whole array.
+ */
+class tgStepPlan
+{
+public:
+
+    tgStepPlan();
+
+    /**
+     * Flatten the subtrees below children. Called from tgModel::setup,
+     * after the children have been set up.
+     * @param[in] children the direct children of the owning model
+     */
+    void compile(const std::vector<tgModel*>& children);
+
+    /** Forget the plan, e.g. when the children change. */
+    void clear();
+
+    /** True after compile and until the next clear. */
+    bool isCompiled() const
+    {
+        return m_compiled;
+    }
+
+    /**
+     * Step everything in the plan.
+     * @param[in] dt must be positive; this is not checked
+     */
+    void step(double dt) const;
+
+private:
+
+    /** How to step an entry */
+    enum Kind
+    {
+        eVirtual,
+        eBasicActuator,
+        eKinematicActuator
+    };
+
+    void compileChild(tgModel* pChild);
+
+    /** Step m_models[first] and the kinematic actuators following it */
+    void stepKinematicRun(std::size_t first, std::size_t bankIndex, double dt) const;
+
+    /** Put every kinematic actuator of the plan in m_motorBank, in order */
+    void bindMotors() const;
+
+    /** Parallel arrays, in tree order */
+    std::vector<Kind> m_kinds;
+    std::vector<tgModel*> m_models;
+
+    /**
+     * For the first of consecutive eKinematicActuator entries, how many
+     * there are; 0 for every other entry
+     */
+    std::vector<std::size_t> m_runLengths;
+
+    /** The number of eKinematicActuator entries */
+    std::size_t m_kinematicCount;
+
+    /**
+     * The motors of the kinematic actuators, in plan order once bound.
+     * Filled on the first step, since only the plan that steps an
+     * actuator should hold its motor.
+     */
+    mutable tgKinematicMotorBank m_motorBank;
+
+    bool m_compiled;
+};
+
+#endif  // TG_STEP_PLAN_H
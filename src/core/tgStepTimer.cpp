@@ -0,0 +1,238 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgStepTimer.cpp
+ * @brief Contains the definitions of members of class tgStepTimer
+ * $Id$
+ */
+
+// This module
+#include "tgStepTimer.h"
+// The C++ Standard Library
+#include <cstdlib>
+#include <cxxabi.h>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <time.h>
+
+namespace
+{
+    /** The timer being sampled on this thread, see tgStepTimer::current */
+    __thread tgStepTimer* pCurrentTimer = NULL;
+
+    std::string typeName(const std::type_info& type)
+    {
+        int status = 0;
+        char* const demangled =
+            abi::__cxa_demangle(type.name(), NULL, NULL, &status);
+        const std::string name = status == 0 ? demangled : type.name();
+        std::free(demangled);
+        return name;
+    }
+
+    void add(std::vector<tgStepTimer::Counter>& counters, std::size_t index,
+             const std::type_info& type, tgStepTimer::Ticks ticks)
+    {
+        if (index >= counters.size())
+        {
+            counters.resize(index + 1);
+        }
+        tgStepTimer::Counter& counter = counters[index];
+        counter.type = &type;
+        counter.calls++;
+        counter.ticks += ticks;
+    }
+
+    void writeLine(std::ostream& os, const std::string& name,
+                   tgStepTimer::Ticks ticks, unsigned long calls,
+                   double perStep, double stepTicks)
+    {
+        os << "  " << std::left << std::setw(40) << name << std::right
+           << std::setw(12) << std::fixed << std::setprecision(2)
+           << ticks * perStep
+           << std::setw(8) << std::setprecision(1)
+           << (stepTicks > 0.0 ? 100.0 * ticks / stepTicks : 0.0) << "%"
+           << std::setw(12) << calls << std::endl;
+    }
+}
+
+tgStepTimer::Counter::Counter(const std::type_info* t) :
+    type(t),
+    calls(0),
+    ticks(0)
+{
+}
+
+tgStepTimer::tgStepTimer(int sampleInterval) :
+    m_sampleInterval(1),
+    m_steps(0),
+    m_dumpInterval(0),
+    m_pDump(NULL)
+{
+    setSampleInterval(sampleInterval);
+    clear();
+}
+
+tgStepTimer::~tgStepTimer()
+{
+    if (pCurrentTimer == this)
+    {
+        pCurrentTimer = NULL;
+    }
+}
+
+void tgStepTimer::setSampleInterval(int sampleInterval)
+{
+    if (sampleInterval < 1)
+    {
+        throw std::invalid_argument("sampleInterval is not positive");
+    }
+    m_sampleInterval = sampleInterval;
+}
+
+void tgStepTimer::setDumpInterval(unsigned long steps, std::ostream* pOut)
+{
+    m_dumpInterval = pOut != NULL ? steps : 0;
+    m_pDump = pOut;
+    m_lastDump = m_steps;
+}
+
+bool tgStepTimer::beginStep()
+{
+    const bool sampled = m_steps % m_sampleInterval == 0;
+    m_steps++;
+    // Also forgets a step that ended in an exception
+    pCurrentTimer = sampled ? this : NULL;
+    return sampled;
+}
+
+void tgStepTimer::endStep(Ticks stepTicks)
+{
+    pCurrentTimer = NULL;
+    addPhase(eStep, stepTicks);
+    if (m_dumpInterval > 0 && m_steps - m_lastDump >= m_dumpInterval)
+    {
+        write(*m_pDump);
+        m_lastDump = m_steps;
+    }
+}
+
+void tgStepTimer::addModel(std::size_t index, const std::type_info& type,
+                           Ticks ticks)
+{
+    add(m_models, index, type, ticks);
+}
+
+void tgStepTimer::addObserver(const std::type_info& type, Ticks ticks)
+{
+    // There are only ever a few types
+    std::size_t i = 0;
+    while (i < m_observers.size() && *m_observers[i].type != type)
+    {
+        i++;
+    }
+    add(m_observers, i, type, ticks);
+}
+
+double tgStepTimer::getTickRate() const
+{
+#if defined(__i386__) || defined(__x86_64__)
+    const double seconds =
+        (monotonicNanoseconds() - m_startNanoseconds) * 1e-9;
+    const Ticks ticks = now() - m_startTicks;
+    // Too soon to tell
+    return seconds > 1e-3 ? ticks / seconds : 0.0;
+#else
+    return 1e9;
+#endif
+}
+
+void tgStepTimer::clear()
+{
+    m_steps = 0;
+    m_lastDump = 0;
+    for (int i = 0; i < kPhaseCount; i++)
+    {
+        m_phases[i] = Counter();
+    }
+    m_models.clear();
+    m_observers.clear();
+    m_startTicks = now();
+    m_startNanoseconds = monotonicNanoseconds();
+}
+
+void tgStepTimer::write(std::ostream& os) const
+{
+    static const char* const phaseNames[kPhaseCount] =
+        { "world", "models", "obstacles", "data managers", "step" };
+
+    const unsigned long sampled = getSampledStepCount();
+    const double rate = getTickRate();
+    // Microseconds per sampled step for each tick
+    const double perStep = sampled > 0 && rate > 0.0 ?
+        1e6 / (rate * sampled) : 0.0;
+    const double stepTicks = m_phases[eStep].ticks;
+
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << "tgStepTimer: " << m_steps << " steps, " << sampled
+       << " timed (every " << m_sampleInterval << ")" << std::endl;
+    os << "  " << std::left << std::setw(40) << "" << std::right
+       << std::setw(12) << "us/step" << std::setw(9) << "share"
+       << std::setw(12) << "calls" << std::endl;
+    for (int i = 0; i < kPhaseCount; i++)
+    {
+        writeLine(os, phaseNames[i], m_phases[i].ticks, m_phases[i].calls,
+                  perStep, stepTicks);
+    }
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        if (m_models[i].type != NULL)
+        {
+            std::ostringstream name;
+            name << "model " << i << " " << typeName(*m_models[i].type);
+            writeLine(os, name.str(), m_models[i].ticks, m_models[i].calls,
+                      perStep, stepTicks);
+        }
+    }
+    for (std::size_t i = 0; i < m_observers.size(); i++)
+    {
+        writeLine(os, "observer " + typeName(*m_observers[i].type),
+                  m_observers[i].ticks, m_observers[i].calls,
+                  perStep, stepTicks);
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+tgStepTimer* tgStepTimer::current()
+{
+    return pCurrentTimer;
+}
+
+tgStepTimer::Ticks tgStepTimer::monotonicNanoseconds()
+{
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return static_cast<Ticks>(t.tv_sec) * 1000000000ULL + t.tv_nsec;
+}
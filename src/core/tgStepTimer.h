@@ -0,0 +1,208 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_STEP_TIMER_H
+#define TG_STEP_TIMER_H
+
+/**
+ * @file tgStepTimer.h
+ * @brief Contains the definition of class tgStepTimer
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <iosfwd>
+#include <typeinfo>
+#include <vector>
+
+/**
+ * Where the time of tgSimulation::step goes: the world, each model, the
+ * obstacles, the data managers, and the controllers and other observers
+ * notified from inside the models' steps, by type. Every tgSimulation
+ * keeps one. Only every sampleInterval-th step is timed, with the time
+ * stamp counter where there is one, so the cost on the other steps is a
+ * counter and a branch.
+ *
+ * The observers' times are also part of the times of the models that
+ * notify them.
+ */
+class tgStepTimer
+{
+public:
+
+    /** Time stamp counter ticks, or nanoseconds where there is no TSC */
+    typedef unsigned long long Ticks;
+
+    /** The parts of tgSimulation::step */
+    enum Phase
+    {
+        eWorld,
+        eModels,
+        eObstacles,
+        eDataManagers,
+        /** All of the step */
+        eStep,
+        kPhaseCount
+    };
+
+    /** Ticks spent by one thing over the sampled steps */
+    struct Counter
+    {
+        Counter(const std::type_info* t = NULL);
+
+        /** The type of the model or observer; NULL for a phase */
+        const std::type_info* type;
+        /** How many times it was timed */
+        unsigned long calls;
+        Ticks ticks;
+    };
+
+    /**
+     * @param[in] sampleInterval time one step in this many; must be
+     * positive
+     * @throw std::invalid_argument if sampleInterval is not positive
+     */
+    tgStepTimer(int sampleInterval = 16);
+
+    ~tgStepTimer();
+
+    /** @throw std::invalid_argument if sampleInterval is not positive */
+    void setSampleInterval(int sampleInterval);
+
+    int getSampleInterval() const
+    {
+        return m_sampleInterval;
+    }
+
+    /**
+     * Also write the summary every so many steps.
+     * @param[in] steps 0 to stop
+     * @param[in] pOut where to write it; not owned
+     */
+    void setDumpInterval(unsigned long steps, std::ostream* pOut);
+
+    /**
+     * Count a step.
+     * @return true if it should be timed; it is then current on this
+     * thread until endStep
+     */
+    bool beginStep();
+
+    /** End a timed step, dumping the summary if one is due */
+    void endStep(Ticks stepTicks);
+
+    void addPhase(Phase phase, Ticks ticks)
+    {
+        m_phases[phase].calls++;
+        m_phases[phase].ticks += ticks;
+    }
+
+    /**
+     * @param[in] index the model's position in tgSimulation's list
+     * @param[in] type the model's dynamic type
+     */
+    void addModel(std::size_t index, const std::type_info& type, Ticks ticks);
+
+    /** @param[in] type the observer's dynamic type */
+    void addObserver(const std::type_info& type, Ticks ticks);
+
+    /** The steps counted and timed since construction or clear */
+    unsigned long getStepCount() const
+    {
+        return m_steps;
+    }
+
+    unsigned long getSampledStepCount() const
+    {
+        return m_phases[eStep].calls;
+    }
+
+    const Counter& getPhase(Phase phase) const
+    {
+        return m_phases[phase];
+    }
+
+    const std::vector<Counter>& getModels() const
+    {
+        return m_models;
+    }
+
+    const std::vector<Counter>& getObservers() const
+    {
+        return m_observers;
+    }
+
+    /** Ticks per second, measured against the monotonic clock */
+    double getTickRate() const;
+
+    /** Forget the counts */
+    void clear();
+
+    /**
+     * Write the mean time per step of each phase, model and observer
+     * type, in microseconds, and their shares of the step.
+     */
+    void write(std::ostream& os) const;
+
+    /** The current time stamp */
+    static Ticks now()
+    {
+#if defined(__i386__) || defined(__x86_64__)
+        unsigned int lo;
+        unsigned int hi;
+        __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+        return (static_cast<Ticks>(hi) << 32) | lo;
+#else
+        return monotonicNanoseconds();
+#endif
+    }
+
+    /**
+     * The timer of the step being timed on this thread.
+     * @return NULL if none is
+     */
+    static tgStepTimer* current();
+
+private:
+
+    static Ticks monotonicNanoseconds();
+
+    int m_sampleInterval;
+
+    unsigned long m_steps;
+
+    Counter m_phases[kPhaseCount];
+
+    std::vector<Counter> m_models;
+
+    std::vector<Counter> m_observers;
+
+    unsigned long m_dumpInterval;
+
+    std::ostream* m_pDump;
+
+    /** m_steps when the summary was last dumped */
+    unsigned long m_lastDump;
+
+    /** For getTickRate */
+    Ticks m_startTicks;
+    Ticks m_startNanoseconds;
+};
+
+#endif  // TG_STEP_TIMER_H
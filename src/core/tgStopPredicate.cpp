@@ -0,0 +1,181 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgStopPredicate.cpp
+ * @brief Contains the definitions of members of the tgStopPredicate
+ * subclasses
+ * $Id$
+ */
+
+// This module
+#include "tgStopPredicate.h"
+// This application
+#include "tgBaseRigid.h"
+#include "tgModel.h"
+#include "tgSpringCableActuator.h"
+// The C++ Standard Library
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+// POSIX
+#include <sys/time.h>
+
+namespace
+{
+    bool isFinite(const btVector3& v)
+    {
+        // Also false for NaN, which compares false with everything
+        const double limit = 1e300;
+        return std::fabs(v.x()) < limit && std::fabs(v.y()) < limit &&
+               std::fabs(v.z()) < limit;
+    }
+
+    double wallClock()
+    {
+        timeval now;
+        gettimeofday(&now, NULL);
+        return now.tv_sec + now.tv_usec * 1e-6;
+    }
+
+    /** The rigids of a model and of all of its descendants */
+    std::vector<tgBaseRigid*> findRigids(const tgModel& model)
+    {
+        return model.getDescendantsOfType<tgBaseRigid>();
+    }
+}
+
+tgRegionStopPredicate::tgRegionStopPredicate(const tgModel& model,
+                                             const btVector3& min,
+                                             const btVector3& max) :
+m_model(model),
+m_min(min),
+m_max(max),
+m_totalMass(0.0)
+{
+    if (min.x() > max.x() || min.y() > max.y() || min.z() > max.z())
+    {
+        throw std::invalid_argument("min is above max");
+    }
+}
+
+void tgRegionStopPredicate::onStart()
+{
+    m_rigids = findRigids(m_model);
+    m_totalMass = 0.0;
+    for (std::size_t i = 0; i < m_rigids.size(); i++)
+    {
+        m_totalMass += m_rigids[i]->mass();
+    }
+}
+
+bool tgRegionStopPredicate::shouldStop(double time)
+{
+    if (m_totalMass <= 0.0)
+    {
+        return false;
+    }
+    btVector3 com(0.0, 0.0, 0.0);
+    for (std::size_t i = 0; i < m_rigids.size(); i++)
+    {
+        com += m_rigids[i]->centerOfMass() * m_rigids[i]->mass();
+    }
+    com /= m_totalMass;
+    return !(com.x() >= m_min.x() && com.y() >= m_min.y() && com.z() >= m_min.z() &&
+             com.x() <= m_max.x() && com.y() <= m_max.y() && com.z() <= m_max.z());
+}
+
+std::string tgRegionStopPredicate::reason() const
+{
+    return "center of mass left its region";
+}
+
+tgDivergenceStopPredicate::tgDivergenceStopPredicate(const tgModel& model,
+                                                     double tensionFactor) :
+m_model(model),
+m_tensionFactor(tensionFactor),
+m_tensionExceeded(false)
+{
+    if (tensionFactor <= 0.0)
+    {
+        throw std::invalid_argument("tensionFactor is not positive");
+    }
+}
+
+void tgDivergenceStopPredicate::onStart()
+{
+    m_rigids = m_model.getDescendantsOfType<tgBaseRigid>();
+    m_actuators = m_model.getDescendantsOfType<tgSpringCableActuator>();
+    m_tensionExceeded = false;
+}
+
+bool tgDivergenceStopPredicate::shouldStop(double time)
+{
+    for (std::size_t i = 0; i < m_rigids.size(); i++)
+    {
+        if (!isFinite(m_rigids[i]->centerOfMass()))
+        {
+            m_tensionExceeded = false;
+            return true;
+        }
+    }
+    for (std::size_t i = 0; i < m_actuators.size(); i++)
+    {
+        const double tension = m_actuators[i]->getTension();
+        // Catches NaN tensions as well
+        if (!(tension <= m_tensionFactor * m_actuators[i]->getConfig().maxTens))
+        {
+            m_tensionExceeded = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string tgDivergenceStopPredicate::reason() const
+{
+    return m_tensionExceeded ? "tension above maxTens" :
+                               "rigid body position is not finite";
+}
+
+tgWallClockStopPredicate::tgWallClockStopPredicate(double seconds) :
+m_budget(seconds),
+m_start(0.0)
+{
+    if (seconds <= 0.0)
+    {
+        throw std::invalid_argument("Wall clock budget is not positive");
+    }
+}
+
+void tgWallClockStopPredicate::onStart()
+{
+    m_start = wallClock();
+}
+
+bool tgWallClockStopPredicate::shouldStop(double time)
+{
+    return wallClock() - m_start > m_budget;
+}
+
+std::string tgWallClockStopPredicate::reason() const
+{
+    std::ostringstream os;
+    os << "wall-clock budget of " << m_budget << " s exhausted";
+    return os.str();
+}
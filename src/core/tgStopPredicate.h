@@ -0,0 +1,153 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_STOP_PREDICATE_H
+#define TG_STOP_PREDICATE_H
+
+/**
+ * @file tgStopPredicate.h
+ * @brief Contains the definitions of tgStopPredicate and its common
+ * subclasses
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgBaseRigid;
+class tgModel;
+class tgSpringCableActuator;
+
+/**
+ * A cheap test that ends tgSimulation::run early, for episodes that
+ * have diverged or are already decided. Predicates are checked every
+ * few steps, so keep them to simple reads of the model's state.
+ */
+class tgStopPredicate
+{
+public:
+
+    virtual ~tgStopPredicate() { }
+
+    /**
+     * Called at the start of each run, after the models are set up.
+     * Gather whatever will be watched here.
+     */
+    virtual void onStart() { }
+
+    /**
+     * @param[in] time the simulated seconds since the run started
+     * @return true to stop the run
+     */
+    virtual bool shouldStop(double time) = 0;
+
+    /** Why the run was stopped, returned by tgSimulation::run */
+    virtual std::string reason() const = 0;
+};
+
+/**
+ * Stops when the center of mass of a model's rigid bodies leaves an
+ * axis-aligned box. A box whose lower y is the lowest allowed height
+ * also catches a robot that has fallen over.
+ */
+class tgRegionStopPredicate : public tgStopPredicate
+{
+public:
+
+    /**
+     * @param[in] model the model to watch; must outlive this
+     * @param[in] min the lower corner of the box
+     * @param[in] max the upper corner of the box
+     */
+    tgRegionStopPredicate(const tgModel& model, const btVector3& min,
+                          const btVector3& max);
+
+    virtual void onStart();
+
+    virtual bool shouldStop(double time);
+
+    virtual std::string reason() const;
+
+private:
+
+    const tgModel& m_model;
+    const btVector3 m_min;
+    const btVector3 m_max;
+    std::vector<tgBaseRigid*> m_rigids;
+    double m_totalMass;
+};
+
+/**
+ * Stops when the model has blown up numerically: a rigid body's
+ * position is not finite, or a cable's tension is above its maxTens.
+ */
+class tgDivergenceStopPredicate : public tgStopPredicate
+{
+public:
+
+    /**
+     * @param[in] model the model to watch; must outlive this
+     * @param[in] tensionFactor stop when a tension exceeds
+     * tensionFactor * maxTens, so actuators that briefly overshoot
+     * can be allowed; must be positive
+     */
+    tgDivergenceStopPredicate(const tgModel& model,
+                              double tensionFactor = 1.0);
+
+    virtual void onStart();
+
+    virtual bool shouldStop(double time);
+
+    virtual std::string reason() const;
+
+private:
+
+    const tgModel& m_model;
+    const double m_tensionFactor;
+    std::vector<tgBaseRigid*> m_rigids;
+    std::vector<tgSpringCableActuator*> m_actuators;
+    bool m_tensionExceeded;
+};
+
+/** Stops once a run has taken a given amount of wall-clock time */
+class tgWallClockStopPredicate : public tgStopPredicate
+{
+public:
+
+    /**
+     * @param[in] seconds the budget for each run; must be positive
+     */
+    tgWallClockStopPredicate(double seconds);
+
+    virtual void onStart();
+
+    virtual bool shouldStop(double time);
+
+    virtual std::string reason() const;
+
+private:
+
+    const double m_budget;
+    double m_start;
+};
+
+#endif  // TG_STOP_PREDICATE_H
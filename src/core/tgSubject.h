@@ -28,8 +28,14 @@
  */
 
 // This application
+#include "tgAllocStats.h"
 #include "tgObserver.h"
+#include "tgStepTimer.h"
+#include "tgEvent.h"
 // The C++ standard library
+#include <algorithm>
+#include <stdexcept>
+#include <typeinfo>
 #include <vector>
 
 /**
@@ -39,6 +45,11 @@
  * of tensegrity structures, a structure that needs to be controlled
  * will be a child of this class. This can either be the main model
  * or submodels such as a tgLinearString
+ *
+ * Observers that only act on sparse events subscribe to them instead of
+ * being attached, and are then not called every step. Subscribing does
+ * not attach: an observer that also needs onStep or the setup and
+ * teardown calls is attached as well.
  */
 template <typename T>
 class tgSubject
@@ -57,10 +68,56 @@ public:
      * do nothing if the pointer is NULL
      */
     void attach(tgObserver<T>* pObserver);
+
+    /**
+     * Detach an observer, e.g. before its owner deletes it between
+     * episodes. Must not be called while notifying the observers.
+     * @param[in] pObserver a pointer to an attached observer; do nothing
+     * if it is not attached
+     */
+    void detach(tgObserver<T>* pObserver);
+
+    /**
+     * Have tgObserver<T>::onEvent() called for every event of a type the
+     * subject raises. Repeated calls are ignored.
+     * @param[in,out] pObserver do nothing if NULL
+     * @param[in] type the event type, other than tgEvent::eTimer
+     * @throw std::invalid_argument if type is eTimer or eTypeCount
+     */
+    void subscribe(tgObserver<T>* pObserver, tgEvent::Type type);
+
+    /**
+     * Raise a tgEvent::eTimer event for an observer every period seconds
+     * of notifyStep. A step longer than the period fires it once.
+     * Timers start over on notifyReset.
+     * @param[in,out] pObserver do nothing if NULL
+     * @param[in] period in seconds
+     * @throw std::invalid_argument if period is not positive
+     */
+    void subscribeTimer(tgObserver<T>* pObserver, double period);
+
+    /**
+     * Drop every subscription and timer of an observer. Called by
+     * detach. Must not be called while raising events.
+     */
+    void unsubscribe(tgObserver<T>* pObserver);
+
+    /** True if any observer is subscribed to events of a type */
+    bool hasSubscribers(tgEvent::Type type) const
+    {
+        return !m_subscribers[type].empty();
+    }
+
+    /**
+     * Call tgObserver<T>::onEvent() on the observers subscribed to the
+     * event's type, in the order they subscribed.
+     */
+    void notifyEvent(const tgEvent& event);
     
     /**
      * Call tgObserver<T>::onStep() on all observers in the order in which they
-     * were attached.
+     * were attached. Their allocations are charged to
+     * tgAllocStats::eControllers.
      * @param[in] dt the number of seconds since the previous call; do nothing
      * if not positive
      */
@@ -77,6 +134,19 @@ public:
      * were attached.
      */
     void notifyTeardown();
+
+    /**
+     * Call tgObserver<T>::onReset() on all observers in the order in which
+     * they were attached. Observers that do not reset themselves get
+     * onTeardown() then onSetup() instead.
+     */
+    void notifyReset();
+
+    /** True if any observer is attached */
+    bool hasObservers() const
+    {
+        return !m_observers.empty();
+    }
     
 private:
 
@@ -85,6 +155,19 @@ private:
      * The subject does not own the observers and must not deallocate them.
      */
      std::vector<tgObserver<T> * > m_observers;
+
+    /** The observers subscribed to each event type */
+    std::vector<tgObserver<T> * > m_subscribers[tgEvent::eTypeCount];
+
+    struct Timer
+    {
+        tgObserver<T>* pObserver;
+        double period;
+        /** Seconds since the timer last fired */
+        double elapsed;
+    };
+
+    std::vector<Timer> m_timers;
 };
 
 template <typename Subject>
@@ -94,17 +177,117 @@ void tgSubject<Subject>::attach(tgObserver<Subject>* pObserver)
         pObserver->onAttach(static_cast<Subject&>(*this));}
 }
 
+template <typename Subject>
+void tgSubject<Subject>::detach(tgObserver<Subject>* pObserver)
+{
+    typename std::vector<tgObserver<Subject> * >::iterator it =
+        std::find(m_observers.begin(), m_observers.end(), pObserver);
+    if (it != m_observers.end()) { m_observers.erase(it); }
+    unsubscribe(pObserver);
+}
+
+template <typename Subject>
+void tgSubject<Subject>::subscribe(tgObserver<Subject>* pObserver,
+                                   tgEvent::Type type)
+{
+    if (type == tgEvent::eTimer || type == tgEvent::eTypeCount)
+    {
+        throw std::invalid_argument("Not an event type to subscribe to");
+    }
+    if (pObserver == NULL) { return; }
+    std::vector<tgObserver<Subject> * >& subscribers = m_subscribers[type];
+    if (std::find(subscribers.begin(), subscribers.end(), pObserver) ==
+        subscribers.end())
+    {
+        subscribers.push_back(pObserver);
+    }
+}
+
+template <typename Subject>
+void tgSubject<Subject>::subscribeTimer(tgObserver<Subject>* pObserver,
+                                        double period)
+{
+    if (!(period > 0.0))
+    {
+        throw std::invalid_argument("Timer period is not positive");
+    }
+    if (pObserver == NULL) { return; }
+    Timer timer;
+    timer.pObserver = pObserver;
+    timer.period = period;
+    timer.elapsed = 0.0;
+    m_timers.push_back(timer);
+    m_subscribers[tgEvent::eTimer].push_back(pObserver);
+}
+
+template <typename Subject>
+void tgSubject<Subject>::unsubscribe(tgObserver<Subject>* pObserver)
+{
+    for (int type = 0; type < tgEvent::eTypeCount; ++type)
+    {
+        std::vector<tgObserver<Subject> * >& subscribers = m_subscribers[type];
+        subscribers.erase(std::remove(subscribers.begin(), subscribers.end(),
+                                      pObserver),
+                          subscribers.end());
+    }
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < m_timers.size(); ++i)
+    {
+        if (m_timers[i].pObserver != pObserver) { m_timers[kept++] = m_timers[i]; }
+    }
+    m_timers.resize(kept);
+}
+
+template <typename Subject>
+void tgSubject<Subject>::notifyEvent(const tgEvent& event)
+{
+    const std::vector<tgObserver<Subject> * >& subscribers =
+        m_subscribers[event.type];
+    const std::size_t n = subscribers.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        subscribers[i]->onEvent(static_cast<Subject&>(*this), event);
+    }
+}
+
 template <typename Subject>
 void tgSubject<Subject>::notifyStep(double dt)
 {
     if (dt > 0)
     {
+        // Set while tgSimulation is timing this step
+        tgStepTimer* const pTimer = tgStepTimer::current();
+        // Charged apart from the model, for tgAllocStats' checks
+        tgAllocStats::Scope tag(tgAllocStats::eControllers);
         const std::size_t n = m_observers.size();
     for (std::size_t i = 0; i < n; ++i) 
     {
         tgObserver<Subject>* const pObserver = m_observers[i];
-        if (pObserver) { pObserver->onStep(static_cast<Subject&>(*this), dt); }
+        if (pObserver == NULL) { continue; }
+        if (pTimer == NULL)
+        {
+            pObserver->onStep(static_cast<Subject&>(*this), dt);
+        }
+        else
+        {
+            const tgStepTimer::Ticks start = tgStepTimer::now();
+            pObserver->onStep(static_cast<Subject&>(*this), dt);
+            pTimer->addObserver(typeid(*pObserver), tgStepTimer::now() - start);
+        }
     }
+        const std::size_t nTimers = m_timers.size();
+        for (std::size_t i = 0; i < nTimers; ++i)
+        {
+            Timer& timer = m_timers[i];
+            timer.elapsed += dt;
+            if (timer.elapsed >= timer.period)
+            {
+                const tgEvent event(tgEvent::eTimer, timer.elapsed);
+                timer.elapsed -= timer.period;
+                if (timer.elapsed >= timer.period) { timer.elapsed = 0.0; }
+                timer.pObserver->onEvent(static_cast<Subject&>(*this), event);
+            }
+        }
     }
 }
 
@@ -129,5 +312,24 @@ void tgSubject<Subject>::notifyTeardown()
         if (pObserver) { pObserver->onTeardown(static_cast<Subject&>(*this)); }
     }
 }
+
+template <typename Subject> 
+void tgSubject<Subject>::notifyReset()
+{
+    for (std::size_t i = 0; i < m_timers.size(); ++i)
+    {
+        m_timers[i].elapsed = 0.0;
+    }
+        const std::size_t n = m_observers.size();
+    for (std::size_t i = 0; i < n; ++i) 
+    {
+        tgObserver<Subject>* const pObserver = m_observers[i];
+        if (pObserver && !pObserver->onReset(static_cast<Subject&>(*this)))
+        {
+            pObserver->onTeardown(static_cast<Subject&>(*this));
+            pObserver->onSetup(static_cast<Subject&>(*this));
+        }
+    }
+}
 #endif  // TG_SUBJECT_H
 
@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTagIndex.cpp
+ * @brief Contains the definitions of members of class tgTagIndex
+ * $Id$
+ */
+
+// This module
+#include "tgTagIndex.h"
+// This application
+#include "tgModel.h"
+#include "tgTagSearch.h"
+// The C++ Standard Library
+#include <cassert>
+
+tgTagIndex::tgTagIndex() :
+m_built(false)
+{
+}
+
+void tgTagIndex::clear()
+{
+    m_models.clear();
+    m_postings.clear();
+    m_built = false;
+}
+
+void tgTagIndex::build(const std::vector<tgModel*>& descendants)
+{
+    clear();
+    m_models = descendants;
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        assert(m_models[i] != NULL);
+        const std::vector<int>& ids = m_models[i]->getTags().ids();
+        for (std::size_t j = 0; j < ids.size(); j++)
+        {
+            const std::size_t id = ids[j];
+            if (id >= m_postings.size())
+            {
+                m_postings.resize(id + 1);
+            }
+            m_postings[id].push_back(i);
+        }
+    }
+    m_built = true;
+}
+
+void tgTagIndex::find(const tgTagSearch& tagSearch,
+                      std::vector<tgModel*>& result) const
+{
+    assert(m_built);
+
+    const std::vector<int>& ids = tagSearch.getSearchTags().ids();
+    if (ids.empty())
+    {
+        // Only exclusions and alternatives, so look at everything
+        for (std::size_t i = 0; i < m_models.size(); i++)
+        {
+            if (tagSearch.matches(m_models[i]->getTags()))
+            {
+                result.push_back(m_models[i]);
+            }
+        }
+        return;
+    }
+
+    // Start from the rarest tag in the search
+    const std::vector<std::size_t>* pRarest = NULL;
+    for (std::size_t i = 0; i < ids.size(); i++)
+    {
+        const std::size_t id = ids[i];
+        if (id >= m_postings.size() || m_postings[id].empty())
+        {
+            // Nobody carries this tag
+            return;
+        }
+        if (pRarest == NULL || m_postings[id].size() < pRarest->size())
+        {
+            pRarest = &m_postings[id];
+        }
+    }
+
+    for (std::size_t i = 0; i < pRarest->size(); i++)
+    {
+        tgModel* const pModel = m_models[(*pRarest)[i]];
+        if (tagSearch.matches(pModel->getTags()))
+        {
+            result.push_back(pModel);
+        }
+    }
+}
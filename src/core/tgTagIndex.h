@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_TAG_INDEX_H
+#define TG_TAG_INDEX_H
+
+/**
+ * @file tgTagIndex.h
+ * @brief Contains the definition of class tgTagIndex
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <vector>
+
+// Forward declarations
+class tgModel;
+class tgTagSearch;
+
+/**
+ * The descendants of a tgModel, indexed by interned tag ID, so that
+ * tgModel::find only looks at the models carrying the rarest required tag
+ * of the search instead of walking the whole tree.
+ *
+ * Results are in getDescendants() order. The index is a snapshot: it is
+ * rebuilt by tgModel::setup and whenever the model's own children
+ * change, but not when tags or grandchildren change afterwards.
+ */
+class tgTagIndex
+{
+public:
+
+    tgTagIndex();
+
+    /**
+     * Index a list of models.
+     * @param[in] descendants as returned by tgModel::getDescendants
+     */
+    void build(const std::vector<tgModel*>& descendants);
+
+    /** Forget the index */
+    void clear();
+
+    /** True after build and until the next clear */
+    bool isBuilt() const
+    {
+        return m_built;
+    }
+
+    /** The models that were indexed */
+    const std::vector<tgModel*>& getModels() const
+    {
+        return m_models;
+    }
+
+    /**
+     * Find the indexed models whose tags match a search.
+     * @param[in] tagSearch the search
+     * @param[out] result the matches are appended to this
+     */
+    void find(const tgTagSearch& tagSearch, std::vector<tgModel*>& result) const;
+
+private:
+
+    std::vector<tgModel*> m_models;
+
+    /** For each tag ID, the indices into m_models that carry it, ascending */
+    std::vector< std::vector<std::size_t> > m_postings;
+
+    bool m_built;
+};
+
+#endif  // TG_TAG_INDEX_H
@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTagSearch.cpp
+ * @brief Contains the search parser of class tgTagSearch
+ * $Id$
+ */
+
+// This module
+#include "tgTagSearch.h"
+
+tgTagSearch::tgTagSearch(std::string search_string) : m_impossible(false)
+{
+    const std::deque<std::string> terms = tgTags::splitTags(search_string);
+    for (std::size_t i = 0; i < terms.size(); i++) {
+        const std::string& term = terms[i];
+        if (term[0] == '-') {
+            if (term.size() == 1 || term.find('|') != std::string::npos) {
+                throw tgTagException("Invalid search term '" + term + "' - expected '-tag'.");
+            }
+            // tgTags checks the tag is valid
+            const tgTags excluded(term.substr(1));
+            m_excluded.set(excluded.ids()[0]);
+        }
+        else if (term.find('|') != std::string::npos) {
+            const std::deque<std::string> alternatives = tgTags::splitTags(term, '|');
+            if (alternatives.size() < 2 || term[0] == '|' ||
+                term[term.size() - 1] == '|' || term.find("||") != std::string::npos) {
+                throw tgTagException("Invalid search term '" + term + "' - expected 'tag|tag'.");
+            }
+            tgTagBitset anyOf;
+            for (std::size_t j = 0; j < alternatives.size(); j++) {
+                // tgTags checks the tag is valid
+                const tgTags alternative(alternatives[j]);
+                anyOf.set(alternative.ids()[0]);
+            }
+            m_anyOf.push_back(anyOf);
+        }
+        else {
+            m_required.append(term);
+        }
+    }
+}
+
+void tgTagSearch::remove(const tgTags& tags)
+{
+    m_required.remove(tags);
+
+    const tgTagBitset& bits = tags.bits();
+    if (bits.intersects(m_excluded)) {
+        m_impossible = true;
+    }
+    std::vector<tgTagBitset> anyOf;
+    for (std::size_t i = 0; i < m_anyOf.size(); i++) {
+        if (!bits.intersects(m_anyOf[i])) {
+            anyOf.push_back(m_anyOf[i]);
+        }
+    }
+    m_anyOf.swap(anyOf);
+}
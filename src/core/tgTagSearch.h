@@ -26,33 +26,37 @@
 #ifndef TG_TAG_SEARCH_H
 #define TG_TAG_SEARCH_H
 
+// The C++ Standard Library
 #include <string>
+#include <vector>
 
 #include "tgTags.h"
 #include "tgTaggable.h"
 
-/*  @todo: Implement more advanced search capability
-
-    Currently, tag searches just matches all tags, so something like
-    tgTagSearch("a b").matches(tgTags("a b c")) is true. 
-
-    Plans: search operators like 'or' and 'not', for instance
-    - tgTagSearch("a -b") would match tgTags("a c") but not tgTags("a b")
-    - tgTagSearch("a b|c") would match tgTags("a b") and tgTags("a c") 
-      but not tgTags("a d")
-*/
-
 /**
  * Represents a search to be performed on a tgTaggable
+ *
+ * A search is a space separated list of terms, all of which must hold:
+ * - "a" requires the tag a
+ * - "-a" requires that the tag a is absent
+ * - "a|b|c" requires at least one of a, b and c
+ *
+ * so tgTagSearch("a -b c|d") matches tgTags("a c") and tgTags("a d e") but
+ * not tgTags("a b c") or tgTags("a e"). The string is parsed once, at
+ * construction, into bitsets over interned tag IDs (see tgTags::intern), so
+ * matches is a few word operations per term.
  */
 class tgTagSearch
 {
 public:
     
-    tgTagSearch() {}
+    tgTagSearch() : m_impossible(false) {}
 
-    tgTagSearch(std::string search_string) : m_search(search_string)
-    {}
+    /**
+     * @throw tgTagException if the search is malformed, e.g. "-", "a|" or
+     * a term naming an invalid tag
+     */
+    tgTagSearch(std::string search_string);
     
     virtual ~tgTagSearch() {}
 
@@ -61,9 +65,16 @@ public:
      */
     const bool matches(const tgTags& tags) const
     {
-        // Simple for now, just check that the tags contain the tags in the 
-        // search
-        return tags.contains(m_search);
+        if (m_impossible)
+            return false;
+        const tgTagBitset& bits = tags.bits();
+        if (!bits.containsAll(m_required.bits()) || bits.intersects(m_excluded))
+            return false;
+        for (std::size_t i = 0; i < m_anyOf.size(); i++) {
+            if (!bits.intersects(m_anyOf[i]))
+                return false;
+        }
+        return true;
     }
 
     const bool matches(const tgTaggable& taggable) const
@@ -77,25 +88,43 @@ public:
      */
     bool matches(const tgTags& parentTags, const tgTags& tags)
     {
-        // @todo: make sure this works correctly...
         tgTags s(parentTags);
         s.append(tags);
         return matches(s);
     }
     
     /**
-     * Remove the given tags from the search
+     * The tags a match must carry; that is, the plain terms of the search.
+     * Any match carries all of these, but not everything carrying them
+     * matches.
      */
-    void remove(const tgTags& tags)
+    const tgTags& getSearchTags() const
     {
-        tgTags s(tags);
-        m_search.remove(tags);
+        return m_required;
     }
     
+    /**
+     * Specialize the search for children of something carrying the given
+     * tags, so that matches(tags) is then the same as matching the
+     * children with the given tags added: required tags in the given tags
+     * are dropped, as are alternatives they satisfy, and a search
+     * excluding one of them can no longer match.
+     */
+    void remove(const tgTags& tags);
+    
 private:
     
-    // @todo: change this to a parsed representation of the and/or/not setup
-    tgTags m_search;
+    /** The plain terms */
+    tgTags m_required;
+
+    /** The tags of the "-a" terms */
+    tgTagBitset m_excluded;
+
+    /** One bitset per "a|b" term */
+    std::vector<tgTagBitset> m_anyOf;
+
+    /** Set by remove when an excluded tag was removed */
+    bool m_impossible;
 
 };
 
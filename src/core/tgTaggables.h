@@ -28,6 +28,8 @@
 
 #include <iostream> // Testing only
 #include <algorithm>
+#include <deque>
+#include <functional> // std::less
 #include <vector>
 #include <stdexcept>
 #include "tgTaggable.h"
@@ -59,13 +61,22 @@ public:
     
     /**
      * Return a vector of pointers to Ts that have all of
-     * the specified tags.
+     * the specified tags. The tags are interned once, so each element
+     * costs a comparison of its tag bitset rather than a parse of tags.
      */
     std::vector<T*> find(std::string tags) 
     {
+        const std::deque<std::string> wanted = tgTags::splitTags(tags);
+        tgTagBitset wantedBits;
+        for(std::size_t i = 0; i < wanted.size(); i++) {
+            wantedBits.set(tgTags::intern(wanted[i]));
+        }
+
         std::vector<T*> result;
-        for(int i = 0; i < m_elements.size(); i++) {
-            if(_taggable(&m_elements[i])->hasAllTags(tags)) {
+        for(std::size_t i = 0; i < m_elements.size(); i++) {
+            // The const tags keep their interned bits
+            const tgTaggable* t = _taggable(&m_elements[i]);
+            if(t->getTags().bits().containsAll(wantedBits)) {
                 result.push_back(&(m_elements[i]));
             }
         }
@@ -105,12 +116,7 @@ public:
 
     bool contains(const T& needle) const
     {
-        //return std::find(m_elements.begin(), m_elements.end(), needle) != m_elements.end(); // generates errors??
-        for(typename std::vector<T>::const_iterator it = m_elements.begin(); it != m_elements.end(); it++) {
-            if(&(*it) == &needle)
-                return true;
-        }
-        return false;
+        return elementExists(needle);
     }
     
     
@@ -168,6 +174,7 @@ protected:
 
     void addElements(std::vector<T*> elements) 
     {
+        m_elements.reserve(m_elements.size() + elements.size());
         for(int i = 0; i < elements.size(); i++) {
             this->addElement(elements[i]);
         }
@@ -231,18 +238,19 @@ protected:
         return (0 <= key) && (key < m_elements.size());
     }        
     
-    // @todo: FIX THIS -- segfaults, etc. -- what's going on? 
+    /**
+     * Is this the very element stored here, rather than an equal one?
+     * Constant time, since m_elements is contiguous.
+     */
     bool elementExists(const T& element) const
-    {        
-        //return std::find(m_elements.begin(), m_elements.end(), element) != m_elements.end(); // segfault?
-        for(int i = 0; i < m_elements.size(); i++) {
-            // This is a little strange to me, but at least it doesn't cause a segfault...
-            const T* elem =& m_elements[i];
-            if (elem == &element) {
-                return true;
-            }
+    {
+        if(m_elements.empty()) {
+            return false;
         }
-        return false;
+        const T* const first = &m_elements[0];
+        const std::less<const T*> before;
+        return !before(&element, first) &&
+            before(&element, first + m_elements.size());
     }
     
     void assertKeyExists(int key, std::string message = "Element at index does not exist") const
@@ -278,6 +286,16 @@ protected:
     tgTaggable* _taggable(T* obj) {
         return static_cast<tgTaggable*>(obj);
     }
+
+    const tgTaggable* _taggable(const T* obj) const {
+        return static_cast<const tgTaggable*>(obj);
+    }
+
+    /** Make room for more elements, e.g. before adding them one by one */
+    void reserveElements(std::size_t n)
+    {
+        m_elements.reserve(n);
+    }
     
 private:
     std::vector<T> m_elements;
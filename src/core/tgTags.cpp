@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTags.cpp
+ * @brief Contains the tag intern table used by class tgTags
+ * $Id$
+ */
+
+// This module
+#include "tgTags.h"
+// The C++ Standard Library
+#include <map>
+#include <pthread.h>
+
+namespace
+{
+    // Models may be built on several tgParallelSimulation threads at once
+    pthread_mutex_t s_internMutex = PTHREAD_MUTEX_INITIALIZER;
+}
+
+int tgTags::intern(const std::string& tag)
+{
+    pthread_mutex_lock(&s_internMutex);
+    // Constructed on first use, under the lock
+    static std::map<std::string, int> table;
+    std::map<std::string, int>::const_iterator it = table.find(tag);
+    int id;
+    if (it == table.end())
+    {
+        id = table.size();
+        table[tag] = id;
+    }
+    else
+    {
+        id = it->second;
+    }
+    pthread_mutex_unlock(&s_internMutex);
+    return id;
+}
+
+void tgTags::internAll() const
+{
+    m_ids.clear();
+    m_bits.clear();
+    for (std::size_t i = 0; i < m_tags.size(); i++)
+    {
+        const int id = intern(m_tags[i]);
+        m_ids.push_back(id);
+        m_bits.set(id);
+    }
+    m_interned = true;
+}
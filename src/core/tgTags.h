@@ -28,6 +28,7 @@
 
 #include <deque>
 #include <set>
+#include <vector>
 #include <string>
 #include <algorithm>
 #include <iostream>
@@ -41,14 +42,108 @@ struct tgTagException : public tgException
    tgTagException(std::string ss) : tgException(ss) {}
 };
 
+/**
+ * A set of interned tag IDs (see tgTags::intern), one bit per ID, so that
+ * checking one set of tags against another is a few word comparisons.
+ */
+class tgTagBitset
+{
+public:
+    void set(int id)
+    {
+        const std::size_t word = id / kBits;
+        if (word >= m_words.size()) {
+            m_words.resize(word + 1, 0);
+        }
+        m_words[word] |= 1UL << (id % kBits);
+    }
+
+    bool test(int id) const
+    {
+        const std::size_t word = id / kBits;
+        return word < m_words.size() && (m_words[word] & (1UL << (id % kBits)));
+    }
+
+    /** Is every bit of other also set here? */
+    bool containsAll(const tgTagBitset& other) const
+    {
+        for (std::size_t i = 0; i < other.m_words.size(); i++) {
+            const unsigned long mine = (i < m_words.size()) ? m_words[i] : 0;
+            if ((other.m_words[i] & ~mine) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    /** Is any bit of other also set here? */
+    bool intersects(const tgTagBitset& other) const
+    {
+        const std::size_t n = std::min(m_words.size(), other.m_words.size());
+        for (std::size_t i = 0; i < n; i++) {
+            if ((m_words[i] & other.m_words[i]) != 0)
+                return true;
+        }
+        return false;
+    }
+
+    bool empty() const
+    {
+        for (std::size_t i = 0; i < m_words.size(); i++) {
+            if (m_words[i] != 0)
+                return false;
+        }
+        return true;
+    }
+
+    void clear()
+    {
+        m_words.clear();
+    }
+
+private:
+    static const std::size_t kBits = sizeof(unsigned long) * 8;
+
+    std::vector<unsigned long> m_words;
+};
+
 class tgTags
 {
 public:
-    tgTags() {}
-    tgTags(const std::string& space_separated_tags)
+    tgTags() : m_interned(false) {}
+    tgTags(const std::string& space_separated_tags) : m_interned(false)
     {
         append(space_separated_tags);
     }
+
+    /**
+     * Get the process-wide integer ID of a tag, assigning the next one if
+     * the tag has not been seen before. IDs are small and dense, so they
+     * can index arrays and bitsets. Safe to call from several threads.
+     */
+    static int intern(const std::string& tag);
+
+    /**
+     * The interned IDs of these tags, in order. Computed when first asked
+     * for after a change.
+     * @note Changes made through a reference kept from the non-const
+     * getTags() or operator[] after this call are not seen.
+     */
+    const std::vector<int>& ids() const
+    {
+        if (!m_interned) {
+            internAll();
+        }
+        return m_ids;
+    }
+
+    /** The interned IDs of these tags, as a bitset */
+    const tgTagBitset& bits() const
+    {
+        if (!m_interned) {
+            internAll();
+        }
+        return m_bits;
+    }
     
     bool contains(const std::string& space_separated_tags) const
     {
@@ -58,7 +153,7 @@ public:
 
     bool contains(const tgTags& tags) const
     {
-        return contains(tags.getTags());
+        return bits().containsAll(tags.bits());
     }
         
     bool containsAny(const std::string& space_separated_tags)
@@ -189,6 +284,7 @@ public:
 
     std::deque<std::string>& getTags()
     {
+        m_interned = false;
         return m_tags;
     }
 
@@ -212,6 +308,7 @@ public:
      * @reeturn a const reference to the tag that is indexed by key
      */
     std::string& operator[](int key) { 
+        m_interned = false;
         return m_tags[key]; 
     }
     
@@ -231,10 +328,14 @@ public:
     {
         const std::deque<std::string>& other = rhs.getTags();
         m_tags.insert(m_tags.end(), other.begin(), other.end());
+        m_interned = false;
         return *this;
     }
 
 private:
+
+    /** Fill in m_ids and m_bits from m_tags */
+    void internAll() const;
         
     /**
      * Add a tag that is known to be valid (e.g. doesn't contain illegal chars,
@@ -246,6 +347,7 @@ private:
         }
         if(!containsOne(tag)) {
             m_tags.push_back(tag);
+            m_interned = false;
         }
     }
     
@@ -259,6 +361,7 @@ private:
     void prependOne(std::string tag) {
         if(isValid(tag) && !containsOne(tag)) {
             m_tags.push_front(tag);
+            m_interned = false;
         }
     }
 
@@ -294,6 +397,7 @@ private:
     
     void removeOne(std::string tag) {
         m_tags.erase(std::remove(m_tags.begin(), m_tags.end(), tag), m_tags.end());
+        m_interned = false;
     }
     
     void remove(std::deque<std::string> tags) {
@@ -303,6 +407,11 @@ private:
     }
     
     std::deque<std::string> m_tags;
+
+    /** Cached by ids() and bits(), valid while m_interned is true */
+    mutable std::vector<int> m_ids;
+    mutable tgTagBitset m_bits;
+    mutable bool m_interned;
 };
 
 /**
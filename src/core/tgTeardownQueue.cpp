@@ -0,0 +1,218 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTeardownQueue.cpp
+ * @brief Contains the definitions of members of class tgTeardownQueue
+ * $Id$
+ */
+
+// This module
+#include "tgTeardownQueue.h"
+// The C++ Standard Library
+#include <deque>
+#include <exception>
+#include <stdexcept>
+#include <string>
+// POSIX threads
+#include <pthread.h>
+
+namespace
+{
+    /** Guards everything below */
+    pthread_mutex_t queueMutex = PTHREAD_MUTEX_INITIALIZER;
+
+    /** Signalled when a task is posted or the worker should exit */
+    pthread_cond_t taskPosted = PTHREAD_COND_INITIALIZER;
+
+    /** Signalled when the queue has run dry */
+    pthread_cond_t queueIdle = PTHREAD_COND_INITIALIZER;
+
+    pthread_t worker;
+
+    bool running = false;
+
+    bool stopping = false;
+
+    std::deque<tgTeardownQueue::Task*> tasks;
+
+    /** True while the worker runs a task it has taken off the queue */
+    bool busy = false;
+
+    /** Set if a task threw since the last drain, with what it said */
+    bool failed = false;
+    std::string error;
+
+    void runTask(tgTeardownQueue::Task* pTask)
+    {
+        std::string what;
+        bool threw = false;
+        try
+        {
+            pTask->run();
+        }
+        catch (const std::exception& e)
+        {
+            threw = true;
+            what = e.what();
+        }
+        catch (...)
+        {
+            threw = true;
+            what = "unknown exception";
+        }
+        delete pTask;
+
+        pthread_mutex_lock(&queueMutex);
+        if (threw && !failed)
+        {
+            failed = true;
+            error = what;
+        }
+        pthread_mutex_unlock(&queueMutex);
+    }
+
+    void* workerMain(void*)
+    {
+        pthread_mutex_lock(&queueMutex);
+        while (true)
+        {
+            while (tasks.empty() && !stopping)
+            {
+                pthread_cond_wait(&taskPosted, &queueMutex);
+            }
+            if (tasks.empty())
+            {
+                break;
+            }
+            tgTeardownQueue::Task* const pTask = tasks.front();
+            tasks.pop_front();
+            busy = true;
+            pthread_mutex_unlock(&queueMutex);
+
+            runTask(pTask);
+
+            pthread_mutex_lock(&queueMutex);
+            busy = false;
+            if (tasks.empty())
+            {
+                pthread_cond_broadcast(&queueIdle);
+            }
+        }
+        pthread_mutex_unlock(&queueMutex);
+        return NULL;
+    }
+
+    /** With queueMutex held */
+    void waitForTasks()
+    {
+        while (!tasks.empty() || busy)
+        {
+            pthread_cond_wait(&queueIdle, &queueMutex);
+        }
+    }
+}
+
+bool tgTeardownQueue::isEnabled()
+{
+    pthread_mutex_lock(&queueMutex);
+    const bool enabled = running;
+    pthread_mutex_unlock(&queueMutex);
+    return enabled;
+}
+
+void tgTeardownQueue::setEnabled(bool enabled)
+{
+    pthread_mutex_lock(&queueMutex);
+    if (enabled == running)
+    {
+        pthread_mutex_unlock(&queueMutex);
+        return;
+    }
+    if (enabled)
+    {
+        stopping = false;
+        if (pthread_create(&worker, NULL, workerMain, NULL) != 0)
+        {
+            pthread_mutex_unlock(&queueMutex);
+            throw std::runtime_error("Could not start the teardown thread");
+        }
+        running = true;
+        pthread_mutex_unlock(&queueMutex);
+        return;
+    }
+
+    // The worker empties the queue before it sees that it is stopping
+    stopping = true;
+    running = false;
+    pthread_cond_signal(&taskPosted);
+    pthread_mutex_unlock(&queueMutex);
+    pthread_join(worker, NULL);
+}
+
+void tgTeardownQueue::post(Task* pTask)
+{
+    if (pTask == NULL)
+    {
+        throw std::invalid_argument("NULL teardown task");
+    }
+    pthread_mutex_lock(&queueMutex);
+    if (running)
+    {
+        tasks.push_back(pTask);
+        pthread_cond_signal(&taskPosted);
+        pthread_mutex_unlock(&queueMutex);
+        return;
+    }
+    pthread_mutex_unlock(&queueMutex);
+
+    // Not enabled, so the poster sees the task's errors straight away
+    try
+    {
+        pTask->run();
+    }
+    catch (...)
+    {
+        delete pTask;
+        throw;
+    }
+    delete pTask;
+}
+
+void tgTeardownQueue::drain()
+{
+    pthread_mutex_lock(&queueMutex);
+    waitForTasks();
+    const bool threw = failed;
+    const std::string what = error;
+    failed = false;
+    error.clear();
+    pthread_mutex_unlock(&queueMutex);
+
+    if (threw)
+    {
+        throw std::runtime_error("Teardown task failed: " + what);
+    }
+}
+
+void tgTeardownQueue::waitIdle()
+{
+    pthread_mutex_lock(&queueMutex);
+    waitForTasks();
+    pthread_mutex_unlock(&queueMutex);
+}
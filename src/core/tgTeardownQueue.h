@@ -0,0 +1,144 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_TEARDOWN_QUEUE_H
+#define TG_TEARDOWN_QUEUE_H
+
+/**
+ * @file tgTeardownQueue.h
+ * @brief Contains the definition of class tgTeardownQueue
+ * $Id$
+ */
+
+// This application
+#include "tgPipelineWorker.h"
+// The C++ Standard Library
+#include <vector>
+
+/**
+ * Work left over from the end of an episode that the next episode does
+ * not need, such as learner score updates and their logs, or deleting
+ * objects that no longer refer to the world. Posted tasks run in order
+ * on one background thread, overlapping the next episode's setup and
+ * simulation. tgSimulation::reset drains the queue before tearing down,
+ * so at most one episode's tasks are ever outstanding, and anything that
+ * reads their results, such as an adapter choosing its next controllers,
+ * drains it first.
+ *
+ * Off unless setEnabled, in which case post runs each task at once, so
+ * code that posts behaves the same either way. Tasks must not touch the
+ * world, models or data managers, which the next episode is using.
+ *
+ * There is one queue per process. An exception thrown by a task is
+ * caught on the worker thread and thrown again, as a
+ * std::runtime_error, from the next drain on any thread.
+ */
+class tgTeardownQueue
+{
+public:
+
+    /** Something to run after teardown; the queue deletes it */
+    typedef tgPipelineWorker::Task Task;
+
+    static bool isEnabled();
+
+    /**
+     * Start or stop the background thread. Stopping waits for the tasks
+     * already posted, keeping their errors for the next drain.
+     * @throw std::runtime_error if the thread cannot be started
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * Run a task after the ones already posted, and delete it.
+     * @param[in] pTask owned by the queue from here on, even if posting
+     * throws
+     * @throw std::invalid_argument if pTask is NULL
+     * @throw anything the task throws, if the queue is not enabled
+     */
+    static void post(Task* pTask);
+
+    /**
+     * Delete an object on the background thread.
+     * @param[in] pObject may be NULL
+     */
+    template <class T>
+    static void postDelete(T* pObject)
+    {
+        if (pObject != NULL)
+        {
+            post(new DeleteTask<T>(pObject));
+        }
+    }
+
+    /**
+     * Delete a list of objects on the background thread, leaving the
+     * list empty.
+     */
+    template <class T>
+    static void postDeleteAll(std::vector<T*>& objects)
+    {
+        DeleteAllTask<T>* const pTask = new DeleteAllTask<T>();
+        pTask->objects.swap(objects);
+        post(pTask);
+    }
+
+    /**
+     * Wait until every task posted so far has run.
+     * @throw std::runtime_error if any of them threw since the last drain
+     */
+    static void drain();
+
+    /** As drain, keeping any error for the next drain, so never throws */
+    static void waitIdle();
+
+private:
+
+    template <class T>
+    class DeleteTask : public Task
+    {
+    public:
+        explicit DeleteTask(T* pObject) : m_pObject(pObject) { }
+
+        virtual void run()
+        {
+            delete m_pObject;
+        }
+
+    private:
+        T* const m_pObject;
+    };
+
+    template <class T>
+    class DeleteAllTask : public Task
+    {
+    public:
+        virtual void run()
+        {
+            for (std::size_t i = 0; i < objects.size(); i++)
+            {
+                delete objects[i];
+            }
+            objects.clear();
+        }
+
+        std::vector<T*> objects;
+    };
+};
+
+#endif  // TG_TEARDOWN_QUEUE_H
@@ -0,0 +1,345 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgTimestepFinder.cpp
+ * @brief Contains the definitions of members of class tgTimestepFinder
+ * $Id$
+ */
+
+// This module
+#include "tgTimestepFinder.h"
+// This application
+#include "tgBulletUtil.h"
+#include "tgSimulation.h"
+#include "tgStopPredicate.h"
+#include "tgWorld.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+// POSIX
+#include <time.h>
+
+namespace
+{
+    double now()
+    {
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return t.tv_sec + t.tv_nsec * 1e-9;
+    }
+
+    bool isFinite(double x)
+    {
+        return x == x && std::fabs(x) <= std::numeric_limits<double>::max();
+    }
+}
+
+tgTimestepFinder::Config::Config(double rs, double ms, double d, double si,
+                                 double t, int i, bool cc) :
+referenceStepSize(rs),
+maxStepSize(ms),
+duration(d),
+sampleInterval(si),
+tolerance(t),
+iterations(i),
+continuousCollision(cc)
+{
+}
+
+tgTimestepFinder::tgTimestepFinder(tgSimulation& simulation,
+                                   const Config& config) :
+m_simulation(simulation),
+m_config(config),
+m_scale(0.0)
+{
+    if (!(config.referenceStepSize > 0.0))
+    {
+        throw std::invalid_argument("referenceStepSize is not positive");
+    }
+    else if (!(config.maxStepSize > config.referenceStepSize))
+    {
+        throw std::invalid_argument("maxStepSize is not above referenceStepSize");
+    }
+    else if (!(config.duration > 0.0))
+    {
+        throw std::invalid_argument("duration is not positive");
+    }
+    else if (!(config.sampleInterval > 0.0))
+    {
+        throw std::invalid_argument("sampleInterval is not positive");
+    }
+    else if (!(config.tolerance > 0.0))
+    {
+        throw std::invalid_argument("tolerance is not positive");
+    }
+    else if (config.iterations < 1)
+    {
+        throw std::invalid_argument("iterations is not positive");
+    }
+}
+
+tgTimestepFinder::Result
+tgTimestepFinder::find(const std::vector<tgStopPredicate*>& predicates)
+{
+    for (std::size_t i = 0; i < predicates.size(); i++)
+    {
+        if (predicates[i] == NULL)
+        {
+            throw std::invalid_argument("Stop predicate is NULL");
+        }
+    }
+
+    Result result;
+    result.referenceStepSize = m_config.referenceStepSize;
+
+    Trial reference;
+    reference.stepSize = m_config.referenceStepSize;
+    reference.error = 0.0;
+    const double start = now();
+    reference.reason = record(reference.stepSize, predicates, m_reference);
+    reference.wallSeconds = now() - start;
+    if (!reference.reason.empty())
+    {
+        throw std::runtime_error("The reference trial stopped: " +
+                                 reference.reason);
+    }
+    if (m_reference.empty())
+    {
+        throw std::runtime_error("No moving rigid bodies to follow");
+    }
+    btVector3 min(m_reference[0], m_reference[1], m_reference[2]);
+    btVector3 max = min;
+    for (std::size_t i = 0; i < m_reference.size(); i += 3)
+    {
+        const btVector3 p(m_reference[i], m_reference[i + 1],
+                          m_reference[i + 2]);
+        if (!isFinite(p.x()) || !isFinite(p.y()) || !isFinite(p.z()))
+        {
+            throw std::runtime_error("The reference trial diverged");
+        }
+        min.setMin(p);
+        max.setMax(p);
+    }
+    // A lone body that doesn't move is compared in the model's units
+    m_scale = (max - min).length();
+    if (m_scale <= 0.0)
+    {
+        m_scale = 1.0;
+    }
+    reference.passed = true;
+    result.trials.push_back(reference);
+
+    Trial best = reference;
+    const Trial largest = compare(m_config.maxStepSize, predicates);
+    result.trials.push_back(largest);
+    if (largest.passed)
+    {
+        best = largest;
+    }
+    else
+    {
+        double lower = m_config.referenceStepSize;
+        double upper = m_config.maxStepSize;
+        for (int i = 0; i < m_config.iterations; i++)
+        {
+            const Trial trial = compare(std::sqrt(lower * upper), predicates);
+            result.trials.push_back(trial);
+            if (trial.passed)
+            {
+                lower = trial.stepSize;
+                best = trial;
+            }
+            else
+            {
+                upper = trial.stepSize;
+            }
+        }
+    }
+    m_simulation.reset();
+
+    result.stepSize = best.stepSize;
+    result.error = best.error;
+    result.stepSpeedup = best.stepSize / reference.stepSize;
+    result.wallSpeedup = best.wallSeconds > 0.0 ?
+        reference.wallSeconds / best.wallSeconds : 0.0;
+    return result;
+}
+
+void tgTimestepFinder::write(std::ostream& os, const Result& result)
+{
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::setw(14) << "step size" << std::setw(14) << "error"
+       << std::setw(12) << "wall s" << "  result" << std::endl;
+    for (std::size_t i = 0; i < result.trials.size(); i++)
+    {
+        const Trial& trial = result.trials[i];
+        os << std::scientific << std::setprecision(4)
+           << std::setw(14) << trial.stepSize
+           << std::setw(14) << trial.error
+           << std::fixed << std::setprecision(3)
+           << std::setw(12) << trial.wallSeconds << "  "
+           << (i == 0 ? "reference" :
+               trial.passed ? "pass" : "fail: " + trial.reason) << std::endl;
+    }
+    os << std::scientific << std::setprecision(4)
+       << "largest safe step size " << result.stepSize
+       << " (error " << result.error << ")" << std::endl
+       << std::fixed << std::setprecision(2)
+       << "speedup " << result.stepSpeedup << "x in steps, "
+       << result.wallSpeedup << "x in wall clock time" << std::endl;
+    os.flags(flags);
+    os.precision(precision);
+}
+
+std::string
+tgTimestepFinder::record(double stepSize,
+                         const std::vector<tgStopPredicate*>& predicates,
+                         Trajectory& trajectory) const
+{
+    m_simulation.reset();
+    if (!m_config.continuousCollision)
+    {
+        disableContinuousCollision();
+    }
+    for (std::size_t i = 0; i < predicates.size(); i++)
+    {
+        predicates[i]->onStart();
+    }
+
+    trajectory.clear();
+    Trajectory previous;
+    Trajectory current;
+    appendPositions(previous);
+
+    const int samples =
+        static_cast<int>(m_config.duration / m_config.sampleInterval + 1e-9);
+    const int steps =
+        static_cast<int>(std::ceil(m_config.duration / stepSize - 1e-9));
+    int next = 1;
+    for (int i = 0; i < steps && next <= samples; i++)
+    {
+        m_simulation.step(stepSize);
+        const double time = (i + 1) * stepSize;
+        for (std::size_t j = 0; j < predicates.size(); j++)
+        {
+            if (predicates[j]->shouldStop(time))
+            {
+                return predicates[j]->reason();
+            }
+        }
+
+        current.clear();
+        appendPositions(current);
+        if (current.size() != previous.size())
+        {
+            return "rigid bodies were added or removed";
+        }
+        // Each sample is interpolated between the steps on either side
+        while (next <= samples &&
+               next * m_config.sampleInterval <= time + 1e-9 * stepSize)
+        {
+            const double fraction = std::min(1.0,
+                (next * m_config.sampleInterval - (time - stepSize)) / stepSize);
+            for (std::size_t j = 0; j < current.size(); j++)
+            {
+                trajectory.push_back(previous[j] +
+                                     (current[j] - previous[j]) * fraction);
+            }
+            next++;
+        }
+        previous.swap(current);
+    }
+    return "";
+}
+
+tgTimestepFinder::Trial
+tgTimestepFinder::compare(double stepSize,
+                          const std::vector<tgStopPredicate*>& predicates) const
+{
+    Trial trial;
+    trial.stepSize = stepSize;
+    trial.error = 0.0;
+    Trajectory trajectory;
+    const double start = now();
+    trial.reason = record(stepSize, predicates, trajectory);
+    trial.wallSeconds = now() - start;
+
+    if (trial.reason.empty() && trajectory.size() != m_reference.size())
+    {
+        trial.reason = "the rigid bodies differ from the reference";
+    }
+    for (std::size_t i = 0; trial.reason.empty() && i < trajectory.size();
+         i += 3)
+    {
+        const btVector3 p(trajectory[i], trajectory[i + 1], trajectory[i + 2]);
+        const btVector3 r(m_reference[i], m_reference[i + 1],
+                          m_reference[i + 2]);
+        const double error = (p - r).length() / m_scale;
+        if (!isFinite(error))
+        {
+            trial.reason = "rigid body position is not finite";
+        }
+        trial.error = std::max(trial.error, error);
+    }
+    if (trial.reason.empty() && trial.error > m_config.tolerance)
+    {
+        trial.reason = "trajectory diverged from the reference";
+    }
+    trial.passed = trial.reason.empty();
+    return trial;
+}
+
+void tgTimestepFinder::disableContinuousCollision() const
+{
+    btDynamicsWorld& dynamicsWorld =
+        tgBulletUtil::worldToDynamicsWorld(m_simulation.getWorld());
+    btCollisionObjectArray& objects = dynamicsWorld.getCollisionObjectArray();
+    for (int i = 0; i < objects.size(); i++)
+    {
+        objects[i]->setCcdMotionThreshold(0.0);
+    }
+}
+
+void tgTimestepFinder::appendPositions(Trajectory& positions) const
+{
+    btDynamicsWorld& dynamicsWorld =
+        tgBulletUtil::worldToDynamicsWorld(m_simulation.getWorld());
+    btCollisionObjectArray& objects = dynamicsWorld.getCollisionObjectArray();
+    for (int i = 0; i < objects.size(); i++)
+    {
+        const btRigidBody* const pBody = btRigidBody::upcast(objects[i]);
+        if (pBody != NULL && pBody->getInvMass() > 0.0)
+        {
+            const btVector3& p = pBody->getCenterOfMassPosition();
+            positions.push_back(p.x());
+            positions.push_back(p.y());
+            positions.push_back(p.z());
+        }
+    }
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_TIMESTEP_FINDER_H
+#define TG_TIMESTEP_FINDER_H
+
+/**
+ * @file tgTimestepFinder.h
+ * @brief Contains the definition of class tgTimestepFinder
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgSimulation;
+class tgStopPredicate;
+
+/**
+ * Finds the largest step size at which a simulation's models and
+ * controllers still follow the trajectory they follow at a fine
+ * reference step size. Each trial resets the simulation and steps it
+ * for the same simulated time, recording where the rigid bodies are at
+ * fixed sample times, so the models and their controllers must behave
+ * the same after every reset. The step size is bisected on a log scale
+ * between the reference and a most allowed step size.
+ *
+ * A trial fails if its trajectory is further than the tolerance from
+ * the reference at any sample, if a body's position is not finite, or
+ * if one of the stop predicates, such as a tgDivergenceStopPredicate,
+ * stops it. Bisection assumes that a step size that fails has no
+ * larger step size that passes.
+ */
+class tgTimestepFinder
+{
+public:
+
+    /** How the search is run. This is Plain Old Data. */
+    struct Config
+    {
+        Config(double rs = 0.0001, double ms = 0.01, double d = 5.0,
+               double si = 0.1, double t = 0.01, int i = 8,
+               bool cc = true);
+
+        /** The step size of the reference trajectory; must be positive */
+        double referenceStepSize;
+        /** The largest step size tried; must be above referenceStepSize */
+        double maxStepSize;
+        /** Simulated seconds in each trial; must be positive */
+        double duration;
+        /** Simulated seconds between samples; must be positive */
+        double sampleInterval;
+        /**
+         * The largest allowed distance of a body from its reference
+         * position, as a fraction of the diagonal of the box around all
+         * the reference positions. Must be positive.
+         */
+        double tolerance;
+        /** Bisection steps after maxStepSize fails; must be positive */
+        int iterations;
+        /**
+         * If false, continuous collision detection is turned off on
+         * every body after each reset, to see how much of the step size
+         * it buys, such as for thin rods that tunnel through the ground
+         */
+        bool continuousCollision;
+    };
+
+    /** One step size that was tried */
+    struct Trial
+    {
+        double stepSize;
+        /** The largest relative distance from the reference */
+        double error;
+        bool passed;
+        /** Why it failed; empty if it passed */
+        std::string reason;
+        double wallSeconds;
+    };
+
+    struct Result
+    {
+        double referenceStepSize;
+        /** The largest step size that passed */
+        double stepSize;
+        /** The error at stepSize */
+        double error;
+        /** stepSize / referenceStepSize: how many fewer steps */
+        double stepSpeedup;
+        /** The reference trial's wall clock time over stepSize's */
+        double wallSpeedup;
+        /** In the order they were run, the reference first */
+        std::vector<Trial> trials;
+    };
+
+    /**
+     * @param[in] simulation with its models added; must outlive this
+     * @param[in] config the search
+     * @throw std::invalid_argument if config is not valid
+     */
+    tgTimestepFinder(tgSimulation& simulation, const Config& config = Config());
+
+    /**
+     * Run the search. The simulation is left reset.
+     * @param[in] predicates checked every step of every trial; not owned
+     * @throw std::runtime_error if the reference itself stops or has no
+     * moving rigid bodies
+     */
+    Result find(const std::vector<tgStopPredicate*>& predicates =
+                std::vector<tgStopPredicate*>());
+
+    /** Write the trials and the result as a table */
+    static void write(std::ostream& os, const Result& result);
+
+private:
+
+    /** Positions of the moving rigid bodies at each sample, flattened */
+    typedef std::vector<double> Trajectory;
+
+    /**
+     * Reset and step the simulation at stepSize.
+     * @param[out] trajectory where the bodies were at the samples
+     * @return an empty string, or why a predicate stopped the trial
+     */
+    std::string record(double stepSize,
+                       const std::vector<tgStopPredicate*>& predicates,
+                       Trajectory& trajectory) const;
+
+    /** The error of a trial, or the reason it failed */
+    Trial compare(double stepSize,
+                  const std::vector<tgStopPredicate*>& predicates) const;
+
+    /** Turn off continuous collision detection on every body */
+    void disableContinuousCollision() const;
+
+    /** Append the positions of the moving bodies */
+    void appendPositions(Trajectory& positions) const;
+
+    tgSimulation& m_simulation;
+    const Config m_config;
+    Trajectory m_reference;
+    /** The diagonal of the box around the reference positions */
+    double m_scale;
+};
+
+#endif  // TG_TIMESTEP_FINDER_H
@@ -0,0 +1,316 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTraceRecorder.cpp
+ * @brief Contains the definitions of members of class tgTraceRecorder
+ * $Id$
+ */
+
+// This module
+#include "tgTraceRecorder.h"
+// The C++ Standard Library
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+// POSIX
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+    struct Event
+    {
+        const char* name;
+        /** Since the origin */
+        double micros;
+        long index;
+        /** 'B' or 'E', as in the trace format */
+        char phase;
+    };
+
+    const std::size_t kBlockEvents = 4096;
+
+    struct Block
+    {
+        Event events[kBlockEvents];
+        /** Events in use; only the owning thread adds to it */
+        volatile std::size_t count;
+        Block* volatile pNext;
+    };
+
+    /** One thread's events; kept after the thread exits */
+    struct Buffer
+    {
+        Block* pFirst;
+        /** The block being filled, touched only by the owning thread */
+        Block* pLast;
+        int tid;
+        /** Guarded by registryMutex */
+        std::string name;
+        Buffer* pNext;
+    };
+
+    /** -1 until decided */
+    int enabled = -1;
+
+    /** Guards the list of buffers and the thread names */
+    pthread_mutex_t registryMutex = PTHREAD_MUTEX_INITIALIZER;
+
+    Buffer* pBuffers = NULL;
+
+    int bufferCount = 0;
+
+    /** Monotonic seconds at the time recording was enabled */
+    double origin = 0.0;
+
+    __thread Buffer* pThreadBuffer = NULL;
+
+    double now()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    Block* newBlock()
+    {
+        Block* const pBlock = new Block();
+        pBlock->count = 0;
+        pBlock->pNext = NULL;
+        return pBlock;
+    }
+
+    Buffer& threadBuffer()
+    {
+        if (pThreadBuffer == NULL)
+        {
+            Buffer* const pBuffer = new Buffer();
+            pBuffer->pFirst = newBlock();
+            pBuffer->pLast = pBuffer->pFirst;
+            pthread_mutex_lock(&registryMutex);
+            pBuffer->tid = ++bufferCount;
+            pBuffer->pNext = pBuffers;
+            pBuffers = pBuffer;
+            pthread_mutex_unlock(&registryMutex);
+            pThreadBuffer = pBuffer;
+        }
+        return *pThreadBuffer;
+    }
+
+    void record(const char* name, char phase, long index)
+    {
+        Buffer& buffer = threadBuffer();
+        Block* pBlock = buffer.pLast;
+        if (pBlock->count == kBlockEvents)
+        {
+            Block* const pFull = pBlock;
+            pBlock = newBlock();
+            // The block is complete before a reader can reach it
+            __sync_synchronize();
+            pFull->pNext = pBlock;
+            buffer.pLast = pBlock;
+        }
+        Event& event = pBlock->events[pBlock->count];
+        event.name = name;
+        event.micros = (now() - origin) * 1e6;
+        event.index = index;
+        event.phase = phase;
+        // The event is complete before a reader counts it
+        __sync_synchronize();
+        pBlock->count = pBlock->count + 1;
+    }
+
+    void writeString(std::ostream& out, const std::string& text)
+    {
+        out << '"';
+        for (std::size_t i = 0; i < text.size(); i++)
+        {
+            const char c = text[i];
+            if (c == '"' || c == '\\')
+            {
+                out << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) >= 0x20)
+            {
+                out << c;
+            }
+        }
+        out << '"';
+    }
+
+    void writeAtExit()
+    {
+        const char* const path = std::getenv("NTRT_TRACE");
+        if (path != NULL && *path != '\0')
+        {
+            tgTraceRecorder::write(std::string(path));
+        }
+    }
+}
+
+tgTraceRecorder::Scope::Scope(const char* name, long index) :
+    m_name(name),
+    m_recorded(isEnabled())
+{
+    if (m_recorded)
+    {
+        record(m_name, 'B', index);
+    }
+}
+
+tgTraceRecorder::Scope::~Scope()
+{
+    // Even if recording was turned off inside the scope, so the
+    // timeline's begin and end events pair up
+    if (m_recorded)
+    {
+        record(m_name, 'E', -1);
+    }
+}
+
+bool tgTraceRecorder::isEnabled()
+{
+    if (enabled < 0)
+    {
+        const char* const path = std::getenv("NTRT_TRACE");
+        const bool fromEnvironment = path != NULL && *path != '\0';
+        setEnabled(fromEnvironment);
+        if (fromEnvironment)
+        {
+            std::atexit(writeAtExit);
+        }
+    }
+    return enabled == 1;
+}
+
+void tgTraceRecorder::setEnabled(bool on)
+{
+    if (on && origin == 0.0)
+    {
+        origin = now();
+    }
+    enabled = on ? 1 : 0;
+}
+
+void tgTraceRecorder::begin(const char* name, long index)
+{
+    if (isEnabled())
+    {
+        record(name, 'B', index);
+    }
+}
+
+void tgTraceRecorder::end(const char* name)
+{
+    if (isEnabled())
+    {
+        record(name, 'E', -1);
+    }
+}
+
+void tgTraceRecorder::setThreadName(const std::string& name)
+{
+    if (isEnabled())
+    {
+        Buffer& buffer = threadBuffer();
+        pthread_mutex_lock(&registryMutex);
+        buffer.name = name;
+        pthread_mutex_unlock(&registryMutex);
+    }
+}
+
+void tgTraceRecorder::write(std::ostream& out)
+{
+    const int pid = getpid();
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+
+    pthread_mutex_lock(&registryMutex);
+    for (const Buffer* pBuffer = pBuffers; pBuffer != NULL;
+         pBuffer = pBuffer->pNext)
+    {
+        if (!pBuffer->name.empty())
+        {
+            out << (first ? "\n" : ",\n")
+                << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                << ",\"tid\":" << pBuffer->tid << ",\"args\":{\"name\":";
+            writeString(out, pBuffer->name);
+            out << "}}";
+            first = false;
+        }
+
+        for (const Block* pBlock = pBuffer->pFirst; pBlock != NULL;
+             pBlock = pBlock->pNext)
+        {
+            const std::size_t count = pBlock->count;
+            // Read no event before its count
+            __sync_synchronize();
+            for (std::size_t i = 0; i < count; i++)
+            {
+                const Event& event = pBlock->events[i];
+                out << (first ? "\n" : ",\n") << "{\"name\":";
+                writeString(out, event.name);
+                out << ",\"ph\":\"" << event.phase << "\",\"ts\":"
+                    << std::fixed << std::setprecision(3) << event.micros
+                    << ",\"pid\":" << pid << ",\"tid\":" << pBuffer->tid;
+                if (event.index >= 0)
+                {
+                    out << ",\"args\":{\"index\":" << event.index << "}";
+                }
+                out << "}";
+                first = false;
+            }
+        }
+    }
+    pthread_mutex_unlock(&registryMutex);
+
+    out << "\n]}\n";
+}
+
+bool tgTraceRecorder::write(const std::string& path)
+{
+    std::ofstream out(path.c_str());
+    if (!out)
+    {
+        return false;
+    }
+    write(out);
+    return out.good();
+}
+
+void tgTraceRecorder::clear()
+{
+    pthread_mutex_lock(&registryMutex);
+    for (Buffer* pBuffer = pBuffers; pBuffer != NULL; pBuffer = pBuffer->pNext)
+    {
+        Block* pBlock = pBuffer->pFirst->pNext;
+        while (pBlock != NULL)
+        {
+            Block* const pNext = pBlock->pNext;
+            delete pBlock;
+            pBlock = pNext;
+        }
+        pBuffer->pFirst->pNext = NULL;
+        pBuffer->pFirst->count = 0;
+        pBuffer->pLast = pBuffer->pFirst;
+    }
+    pthread_mutex_unlock(&registryMutex);
+}
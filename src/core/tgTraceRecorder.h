@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_TRACE_RECORDER_H
+#define TG_TRACE_RECORDER_H
+
+/**
+ * @file tgTraceRecorder.h
+ * @brief Contains the definition of class tgTraceRecorder
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <iosfwd>
+#include <string>
+
+/**
+ * A timeline of what each thread was doing, for finding idle workers,
+ * contention and straggler trials in parallel runs, which the summed
+ * times of tgBuildProfile and tgTrialTiming hide. Simulation phases,
+ * trials, chunks of the parallel runner, log writes and learner updates
+ * record begin and end events, and write() exports them in the Chrome
+ * trace event format, which chrome://tracing and ui.perfetto.dev open.
+ *
+ * Each thread records into its own buffer, registered once under a
+ * lock, so recording an event takes no lock and does not allocate but
+ * once per block of events. Event names are not copied: they must be
+ * string literals or otherwise outlive the recorder.
+ *
+ * Off unless the environment variable NTRT_TRACE names a file when the
+ * first event is recorded, in which case the trace is written to it
+ * when the process exits. setEnabled turns recording on for programs
+ * that call write() themselves.
+ *
+ * Events are meant for work that takes at least tens of microseconds;
+ * tracing every simulation step would fill memory on long runs.
+ */
+class tgTraceRecorder
+{
+public:
+
+    /** Records a begin event, and an end event when it goes out of scope */
+    class Scope
+    {
+    public:
+        /**
+         * @param[in] name must outlive the recorder
+         * @param[in] index shown with the event, such as a trial number;
+         * not shown if negative
+         */
+        explicit Scope(const char* name, long index = -1);
+
+        ~Scope();
+
+    private:
+        const char* const m_name;
+
+        /** Whether the begin event was recorded */
+        const bool m_recorded;
+    };
+
+    static bool isEnabled();
+
+    /** Set whether later events are recorded, whatever the environment */
+    static void setEnabled(bool enabled);
+
+    /** Record the start of something on this thread, if enabled */
+    static void begin(const char* name, long index = -1);
+
+    /** Record the end of the last thing begun on this thread, if enabled */
+    static void end(const char* name);
+
+    /** Name this thread in the timeline, e.g. "worker 3" */
+    static void setThreadName(const std::string& name);
+
+    /**
+     * Write every event recorded so far as Chrome trace JSON. Events
+     * being recorded by other threads meanwhile may be left out.
+     */
+    static void write(std::ostream& out);
+
+    /**
+     * Write the trace to a file
+     * @return false if the file could not be written
+     */
+    static bool write(const std::string& path);
+
+    /**
+     * Drop every event recorded so far. No other thread may be
+     * recording while this runs.
+     */
+    static void clear();
+};
+
+#endif  // TG_TRACE_RECORDER_H
@@ -0,0 +1,239 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTrialTiming.cpp
+ * @brief Contains the definitions of members of class tgTrialTiming
+ * $Id$
+ */
+
+// This module
+#include "tgTrialTiming.h"
+// The C++ Standard Library
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+// POSIX
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+    struct Trial
+    {
+        double seconds[tgTrialTiming::kPhaseCount];
+        tgTrialTiming::Phase phase;
+        /** When the current phase was last entered */
+        double since;
+        long steps;
+    };
+
+    /** -1 until decided */
+    int enabled = -1;
+
+    pthread_mutex_t countMutex = PTHREAD_MUTEX_INITIALIZER;
+
+    /** Trials begun in this process */
+    unsigned long trialCount = 0;
+
+    /** This thread's trial; NULL if none is running */
+    __thread Trial* pTrial = NULL;
+
+    /** This thread's trial number in the process */
+    __thread unsigned long trialNumber = 0;
+}
+
+tgTrialTiming::Scope::Scope(Phase phase) :
+    m_previous(pTrial != NULL ? pTrial->phase : kPhaseCount)
+{
+    if (pTrial != NULL)
+    {
+        enter(phase);
+    }
+}
+
+tgTrialTiming::Scope::~Scope()
+{
+    // The trial may have ended inside the scope
+    if (pTrial != NULL && m_previous != kPhaseCount)
+    {
+        enter(m_previous);
+    }
+}
+
+bool tgTrialTiming::isEnabled()
+{
+    if (enabled < 0)
+    {
+        const char* const value = std::getenv("NTRT_TRIAL_TIMING");
+        enabled = value != NULL && *value != '\0' &&
+            std::string(value) != "0" ? 1 : 0;
+    }
+    return enabled == 1;
+}
+
+void tgTrialTiming::setEnabled(bool on)
+{
+    enabled = on ? 1 : 0;
+}
+
+void tgTrialTiming::beginTrial()
+{
+    endTrial();
+    if (!isEnabled())
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&countMutex);
+    const bool first = trialCount == 0;
+    trialNumber = trialCount++;
+    pthread_mutex_unlock(&countMutex);
+
+    pTrial = new Trial();
+    for (int i = 0; i < kPhaseCount; i++)
+    {
+        pTrial->seconds[i] = 0.0;
+    }
+    pTrial->seconds[eSpawn] = first ? processAge() : 0.0;
+    pTrial->phase = eBuild;
+    pTrial->since = now();
+    pTrial->steps = 0;
+}
+
+void tgTrialTiming::enter(Phase phase)
+{
+    if (pTrial != NULL && phase != pTrial->phase)
+    {
+        const double t = now();
+        pTrial->seconds[pTrial->phase] += t - pTrial->since;
+        pTrial->phase = phase;
+        pTrial->since = t;
+    }
+}
+
+void tgTrialTiming::countStep()
+{
+    if (pTrial != NULL)
+    {
+        if (pTrial->phase == eBuild)
+        {
+            enter(eSettle);
+        }
+        pTrial->steps++;
+    }
+}
+
+void tgTrialTiming::endTrial()
+{
+    if (pTrial == NULL)
+    {
+        return;
+    }
+    Trial* const pEnded = pTrial;
+    // Writing the line is not part of the trial
+    pEnded->seconds[pEnded->phase] += now() - pEnded->since;
+    pTrial = NULL;
+
+    const char* const path = std::getenv("NTRT_TRIAL_TIMING");
+    if (pEnded->steps > 0 && path != NULL && *path != '\0' &&
+        std::string(path) != "0")
+    {
+        std::ostringstream line;
+        line << "{\"pid\":" << getpid()
+             << ",\"trial\":" << trialNumber
+             << ",\"steps\":" << pEnded->steps;
+        double total = 0.0;
+        for (int i = 0; i < kPhaseCount; i++)
+        {
+            line << ",\"" << phaseName(Phase(i)) << "\":" << pEnded->seconds[i];
+            total += pEnded->seconds[i];
+        }
+        line << ",\"total\":" << total << "}\n";
+
+        // One write of the whole line, so lines from other processes
+        // appending to the same file do not interleave
+        const std::string text = line.str();
+        const std::string target = std::string(path) == "1" ?
+            std::string("trialTiming.jsonl") : std::string(path);
+        const int fd = open(target.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd >= 0)
+        {
+            const ssize_t written = write(fd, text.data(), text.size());
+            (void) written;
+            close(fd);
+        }
+    }
+    delete pEnded;
+}
+
+const char* tgTrialTiming::phaseName(Phase phase)
+{
+    static const char* const names[kPhaseCount] =
+    {
+        "spawn",
+        "config",
+        "build",
+        "settle",
+        "control",
+        "teardown",
+        "logIO"
+    };
+    return phase < kPhaseCount ? names[phase] : "unknown";
+}
+
+double tgTrialTiming::now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+double tgTrialTiming::processAge()
+{
+    // Field 22 of /proc/self/stat is the start time in clock ticks since
+    // boot, and the first number in /proc/uptime the seconds since boot
+    std::ifstream stat("/proc/self/stat");
+    std::string text;
+    std::getline(stat, text);
+    // The command name may hold spaces, so count fields after its ')'
+    const std::string::size_type close = text.rfind(')');
+    std::ifstream uptimeFile("/proc/uptime");
+    double uptime = 0.0;
+    if (close == std::string::npos || !(uptimeFile >> uptime))
+    {
+        return 0.0;
+    }
+    std::istringstream fields(text.substr(close + 1));
+    std::string field;
+    // Fields 3 to 21, then the start time
+    for (int i = 3; i <= 21 && (fields >> field); i++)
+    {
+    }
+    unsigned long long startTicks = 0;
+    if (!(fields >> startTicks))
+    {
+        return 0.0;
+    }
+    const double age = uptime - double(startTicks) / sysconf(_SC_CLK_TCK);
+    return age > 0.0 ? age : 0.0;
+}
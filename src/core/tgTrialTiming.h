@@ -0,0 +1,121 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_TRIAL_TIMING_H
+#define TG_TRIAL_TIMING_H
+
+/**
+ * @file tgTrialTiming.h
+ * @brief Contains the definition of class tgTrialTiming
+ * $Id$
+ */
+
+/**
+ * Where the wall time of each learning trial goes: starting the process,
+ * parsing configuration and parameter files, building the models,
+ * settling, the controlled simulation, tearing down and writing logs.
+ * Meant for deciding which of the caching and parallel options pays for
+ * an experiment.
+ *
+ * A trial runs on one thread from the construction or reset of a
+ * tgSimulation to its teardown. Time always goes to exactly one phase:
+ * the trial starts in eBuild, its first step moves it to eSettle, and
+ * the learning adapters move it to eControl the first time they are
+ * stepped, so trials without an adapter count all of their simulation
+ * as settling. Scopes such as reading a configuration file
+ * take the time from whichever phase they interrupt. eSpawn is the time
+ * from the start of the process to its first trial, and is zero for the
+ * later trials of a process, such as those of an evaluation server.
+ *
+ * Off unless the environment variable NTRT_TRIAL_TIMING names a file
+ * when the first trial begins, or is "1" for trialTiming.jsonl in the
+ * working directory. Each trial that ran then appends one line of JSON
+ * to it, e.g.
+ *
+ *     {"pid":1234,"trial":0,"steps":60000,"spawn":0.21,"config":0.002,...}
+ *
+ * with the phases in seconds. Lines are appended whole, so processes can
+ * share the file; scripts/learning/src/evolution's job master sets the
+ * variable and sums the lines per generation.
+ */
+class tgTrialTiming
+{
+public:
+
+    enum Phase
+    {
+        eSpawn,
+        eConfig,
+        eBuild,
+        eSettle,
+        eControl,
+        eTeardown,
+        eLogIO,
+        kPhaseCount
+    };
+
+    /** Moves the time of this thread's trial to a phase while in scope */
+    class Scope
+    {
+    public:
+        explicit Scope(Phase phase);
+
+        ~Scope();
+
+    private:
+        /** The phase to go back to; kPhaseCount if no trial is running */
+        Phase m_previous;
+    };
+
+    static bool isEnabled();
+
+    /** Set whether later trials are timed, whatever the environment */
+    static void setEnabled(bool enabled);
+
+    /**
+     * Start timing a trial on this thread, in eBuild. A trial already
+     * running is ended first. Does nothing unless enabled.
+     */
+    static void beginTrial();
+
+    /** Count the time so far to the current phase, then move to another */
+    static void enter(Phase phase);
+
+    /**
+     * Count a step of this thread's trial. The first moves it from
+     * eBuild to eSettle.
+     */
+    static void countStep();
+
+    /**
+     * Finish this thread's trial and append its line, if it ran any
+     * steps. Does nothing if no trial is running.
+     */
+    static void endTrial();
+
+    /** The phase's name in the JSON lines */
+    static const char* phaseName(Phase phase);
+
+    /** Seconds on the monotonic clock */
+    static double now();
+
+    /** Seconds since this process started, or 0 if that is not known */
+    static double processAge();
+};
+
+#endif  // TG_TRIAL_TIMING_H
@@ -0,0 +1,58 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgTypeIndex.cpp
+ * @brief Contains the definitions of members of class tgTypeIndex
+ * $Id$
+ */
+
+// This module
+#include "tgTypeIndex.h"
+
+tgTypeIndex::tgTypeIndex()
+{
+}
+
+tgTypeIndex::tgTypeIndex(const tgTypeIndex&)
+{
+}
+
+tgTypeIndex& tgTypeIndex::operator=(const tgTypeIndex& other)
+{
+    if (&other != this)
+    {
+        clear();
+    }
+    return *this;
+}
+
+tgTypeIndex::~tgTypeIndex()
+{
+    clear();
+}
+
+void tgTypeIndex::clear()
+{
+    for (Entries::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+        delete it->second;
+    }
+    m_entries.clear();
+}
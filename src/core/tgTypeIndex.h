@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_TYPE_INDEX_H
+#define TG_TYPE_INDEX_H
+
+/**
+ * @file tgTypeIndex.h
+ * @brief Contains the definition of class tgTypeIndex
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <typeinfo>
+#include <vector>
+
+/**
+ * The descendants of a tgModel by type, for
+ * tgModel::getDescendantsOfType. Each type is filtered with dynamic_cast
+ * the first time it is asked for and kept until the index is cleared, so
+ * the next lookups are a map search.
+ *
+ * Like tgTagIndex, the index is a snapshot: tgModel clears it in setup
+ * and whenever the model's own children change, but not when
+ * grandchildren change afterwards. Copies start empty.
+ */
+class tgTypeIndex
+{
+public:
+
+    tgTypeIndex();
+
+    tgTypeIndex(const tgTypeIndex&);
+
+    tgTypeIndex& operator=(const tgTypeIndex&);
+
+    ~tgTypeIndex();
+
+    /**
+     * @return the indexed descendants of type T, or NULL if T has not
+     * been indexed since the last clear
+     */
+    template <typename T>
+    const std::vector<T*>* find() const
+    {
+        const Entries::const_iterator it = m_entries.find(&typeid(T));
+        return it == m_entries.end() ? NULL :
+            &static_cast<const TypedEntry<T>*>(it->second)->items;
+    }
+
+    /**
+     * Index the descendants of type T.
+     * @param[in] items in tgModel::getDescendants order
+     * @return the indexed copy
+     */
+    template <typename T>
+    const std::vector<T*>& insert(const std::vector<T*>& items)
+    {
+        TypedEntry<T>* const pEntry = new TypedEntry<T>();
+        pEntry->items = items;
+        Entry*& pSlot = m_entries[&typeid(T)];
+        delete pSlot;
+        pSlot = pEntry;
+        return pEntry->items;
+    }
+
+    /** Forget every type */
+    void clear();
+
+private:
+
+    struct Entry
+    {
+        virtual ~Entry() { }
+    };
+
+    template <typename T>
+    struct TypedEntry : public Entry
+    {
+        std::vector<T*> items;
+    };
+
+    /** type_info objects of one type need not be the same object */
+    struct TypeLess
+    {
+        bool operator()(const std::type_info* a, const std::type_info* b) const
+        {
+            return a->before(*b) != 0;
+        }
+    };
+
+    typedef std::map<const std::type_info*, Entry*, TypeLess> Entries;
+
+    Entries m_entries;
+};
+
+#endif  // TG_TYPE_INDEX_H
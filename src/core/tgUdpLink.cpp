@@ -0,0 +1,188 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgUdpLink.cpp
+ * @brief Contains the definitions of members of class tgUdpLink
+ * $Id$
+ */
+
+// This module
+#include "tgUdpLink.h"
+// The C++ Standard Library
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+// POSIX sockets
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+    const char kMagic[4] = {'N', 'T', 'R', 'T'};
+
+    /** The header, as laid out at the start of a message */
+    struct Header
+    {
+        char magic[4];
+        uint32_t kind;
+        uint32_t sequence;
+        uint32_t count;
+        double time;
+    };
+}
+
+tgUdpLink::tgUdpLink(int localPort, const std::string& remoteHost,
+                     int remotePort, std::size_t maxValues) :
+m_socket(-1),
+m_remoteAddress(sizeof(sockaddr_in)),
+m_maxValues(maxValues),
+m_sendBuffer(kHeaderDoubles + maxValues),
+m_receiveBuffer(kHeaderDoubles + maxValues),
+m_sendSequence(0),
+m_commands(maxValues + 1),
+m_commandCount(0),
+m_commandTime(0.0),
+m_commandSequence(0),
+m_haveCommand(false),
+m_dropped(0)
+{
+    // Header must fit where frameBuffer starts
+    typedef char headerFits[sizeof(Header) <= kHeaderDoubles * sizeof(double) ? 1 : -1];
+    (void) sizeof(headerFits);
+
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    std::ostringstream port;
+    port << remotePort;
+    addrinfo* pResult = NULL;
+    if (getaddrinfo(remoteHost.c_str(), port.str().c_str(), &hints, &pResult) != 0 ||
+        pResult == NULL)
+    {
+        throw std::runtime_error("Could not resolve " + remoteHost);
+    }
+    std::memcpy(&m_remoteAddress[0], pResult->ai_addr, sizeof(sockaddr_in));
+    freeaddrinfo(pResult);
+
+    m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_socket < 0)
+    {
+        throw std::runtime_error("Could not create a socket");
+    }
+    sockaddr_in local;
+    std::memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(localPort);
+    if (bind(m_socket, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0)
+    {
+        close(m_socket);
+        std::ostringstream os;
+        os << "Could not bind UDP port " << localPort;
+        throw std::runtime_error(os.str());
+    }
+}
+
+tgUdpLink::~tgUdpLink()
+{
+    close(m_socket);
+}
+
+bool tgUdpLink::receiveCommands()
+{
+    bool received = false;
+    const std::size_t capacity = m_receiveBuffer.size() * sizeof(double);
+    for (;;)
+    {
+        const ssize_t n = recv(m_socket, &m_receiveBuffer[0], capacity,
+                               MSG_DONTWAIT);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            // EAGAIN: nothing more is waiting
+            break;
+        }
+
+        Header header;
+        if ((std::size_t) n < sizeof(Header))
+        {
+            m_dropped++;
+            continue;
+        }
+        std::memcpy(&header, &m_receiveBuffer[0], sizeof(Header));
+        const std::size_t count = header.count;
+        // Later sequence numbers win, allowing for wrap-around
+        const bool newer = !m_haveCommand ||
+            (int32_t) (header.sequence - m_commandSequence) > 0;
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+            header.kind != eCommand || count > m_maxValues ||
+            (std::size_t) n != kHeaderDoubles * sizeof(double) + count * sizeof(double) ||
+            !newer)
+        {
+            m_dropped++;
+            continue;
+        }
+
+        std::memcpy(&m_commands[0], &m_receiveBuffer[kHeaderDoubles],
+                    count * sizeof(double));
+        m_commandCount = count;
+        m_commandTime = header.time;
+        m_commandSequence = header.sequence;
+        m_haveCommand = true;
+        received = true;
+    }
+    return received;
+}
+
+bool tgUdpLink::sendFrame(double time, std::size_t count)
+{
+    if (count > m_maxValues)
+    {
+        throw std::invalid_argument("Frame has more values than the link holds");
+    }
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.kind = eFrame;
+    header.sequence = ++m_sendSequence;
+    header.count = count;
+    header.time = time;
+    std::memset(&m_sendBuffer[0], 0, kHeaderDoubles * sizeof(double));
+    std::memcpy(&m_sendBuffer[0], &header, sizeof(Header));
+
+    const std::size_t bytes = (kHeaderDoubles + count) * sizeof(double);
+    const ssize_t n =
+        sendto(m_socket, &m_sendBuffer[0], bytes, 0,
+               reinterpret_cast<const sockaddr*>(&m_remoteAddress[0]),
+               sizeof(sockaddr_in));
+    return n == (ssize_t) bytes;
+}
+
+void tgUdpLink::beforeStep(double time)
+{
+    receiveCommands();
+}
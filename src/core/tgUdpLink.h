@@ -0,0 +1,154 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_UDP_LINK_H
+#define TG_UDP_LINK_H
+
+/**
+ * @file tgUdpLink.h
+ * @brief Contains the definition of class tgUdpLink
+ * $Id$
+ */
+
+// This application
+#include "tgRealTimeExecutor.h"
+// The C++ Standard Library
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * Exchanges actuator commands and sensor frames with a robot over UDP,
+ * one datagram per message, with every buffer allocated up front so the
+ * step loop never allocates.
+ *
+ * A message is, in native byte order: the 4 characters "NTRT", a uint32
+ * kind (eCommand or eFrame), a uint32 sequence number, a uint32 count,
+ * a double time, then count doubles. Commands are received and frames
+ * are sent; the robot does the opposite.
+ *
+ * As a tgRealTimeExecutor::Hook, the link takes in waiting commands
+ * before each step, so controllers read getCommands in their onStep.
+ */
+class tgUdpLink : public tgRealTimeExecutor::Hook
+{
+public:
+
+    /** What a message holds */
+    enum Kind
+    {
+        /** Actuator commands, from the robot's controller */
+        eCommand = 1,
+        /** A sensor frame, to the robot's controller */
+        eFrame = 2
+    };
+
+    /**
+     * @param[in] localPort the UDP port to receive commands on
+     * @param[in] remoteHost the IPv4 address or name to send frames to
+     * @param[in] remotePort the UDP port to send frames to
+     * @param[in] maxValues the most doubles in any message
+     * @throw std::runtime_error if the socket cannot be set up
+     */
+    tgUdpLink(int localPort, const std::string& remoteHost, int remotePort,
+              std::size_t maxValues);
+
+    /** Closes the socket */
+    virtual ~tgUdpLink();
+
+    /**
+     * Take in every command waiting on the socket without blocking. The
+     * newest by sequence number is kept; messages older than it, of the
+     * wrong kind, or malformed are dropped.
+     * @return true if a newer command arrived
+     */
+    bool receiveCommands();
+
+    /** The newest command's values */
+    const double* getCommands() const
+    {
+        return &m_commands[0];
+    }
+
+    /** The number of values in the newest command; 0 before the first */
+    std::size_t getCommandCount() const
+    {
+        return m_commandCount;
+    }
+
+    /** The time the newest command was stamped with */
+    double getCommandTime() const
+    {
+        return m_commandTime;
+    }
+
+    /** Messages dropped by receiveCommands since construction */
+    std::size_t getDroppedCount() const
+    {
+        return m_dropped;
+    }
+
+    /**
+     * Where to write the next frame's values, e.g. with
+     * tgDataManager::sampleFrameInto; room for maxValues doubles.
+     */
+    double* frameBuffer()
+    {
+        return &m_sendBuffer[kHeaderDoubles];
+    }
+
+    /**
+     * Send the values written to frameBuffer.
+     * @param[in] time the simulated time of the frame
+     * @param[in] count the number of values written
+     * @return false if the datagram could not be sent
+     * @throw std::invalid_argument if count is more than maxValues
+     */
+    bool sendFrame(double time, std::size_t count);
+
+    /** Calls receiveCommands. */
+    virtual void beforeStep(double time);
+
+private:
+
+    /** The header takes the room of this many doubles */
+    static const std::size_t kHeaderDoubles = 3;
+
+    int m_socket;
+
+    /** A sockaddr_in for the robot */
+    std::vector<char> m_remoteAddress;
+
+    const std::size_t m_maxValues;
+
+    std::vector<double> m_sendBuffer;
+    std::vector<double> m_receiveBuffer;
+
+    uint32_t m_sendSequence;
+
+    std::vector<double> m_commands;
+    std::size_t m_commandCount;
+    double m_commandTime;
+    uint32_t m_commandSequence;
+    bool m_haveCommand;
+
+    std::size_t m_dropped;
+};
+
+#endif  // TG_UDP_LINK_H
@@ -0,0 +1,237 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgVideoEncoder.cpp
+ * @brief Contains the definitions of members of class tgVideoEncoder
+ * $Id$
+ */
+
+// This module
+#include "tgVideoEncoder.h"
+// The C++ Standard Library
+#include <stdexcept>
+// POSIX
+#include <signal.h>
+
+tgVideoEncoder::tgVideoEncoder(const std::string& command,
+                               std::size_t queueLength) :
+m_pPipe(NULL),
+m_frames(queueLength),
+m_head(0),
+m_queued(0),
+m_acquired(false),
+m_closing(false),
+m_finished(false),
+m_failed(false),
+m_framesWritten(0)
+{
+    if (queueLength == 0)
+    {
+        throw std::invalid_argument("Video queue length is 0");
+    }
+
+    m_pPipe = popen(command.c_str(), "w");
+    if (m_pPipe == NULL)
+    {
+        throw std::runtime_error("Could not start the video encoder");
+    }
+
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_frameQueued, NULL);
+    pthread_cond_init(&m_frameWritten, NULL);
+
+    if (pthread_create(&m_writer, NULL, writerMain, this) != 0)
+    {
+        pclose(m_pPipe);
+        pthread_cond_destroy(&m_frameWritten);
+        pthread_cond_destroy(&m_frameQueued);
+        pthread_mutex_destroy(&m_mutex);
+        throw std::runtime_error("Could not start the video thread");
+    }
+}
+
+tgVideoEncoder::~tgVideoEncoder()
+{
+    try
+    {
+        finish();
+    }
+    catch (const std::runtime_error&)
+    {
+        // Nothing more to be done about it here
+    }
+    pthread_cond_destroy(&m_frameWritten);
+    pthread_cond_destroy(&m_frameQueued);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+unsigned char* tgVideoEncoder::acquire(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+    {
+        throw std::invalid_argument("Video frame size is not positive");
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    if (m_acquired || m_closing)
+    {
+        pthread_mutex_unlock(&m_mutex);
+        throw std::logic_error("No video frame can be acquired now");
+    }
+    while (m_queued == m_frames.size() && !m_failed)
+    {
+        pthread_cond_wait(&m_frameWritten, &m_mutex);
+    }
+    const bool failed = m_failed;
+    // The writer does not touch the frames outside the queue
+    Frame& frame = m_frames[(m_head + m_queued) % m_frames.size()];
+    m_acquired = !failed;
+    pthread_mutex_unlock(&m_mutex);
+
+    if (failed)
+    {
+        throw std::runtime_error("Could not write a video frame");
+    }
+    frame.width = width;
+    frame.height = height;
+    frame.pixels.resize(3 * (std::size_t) width * height);
+    return &frame.pixels[0];
+}
+
+void tgVideoEncoder::submit()
+{
+    pthread_mutex_lock(&m_mutex);
+    if (!m_acquired)
+    {
+        pthread_mutex_unlock(&m_mutex);
+        throw std::logic_error("No video frame was acquired");
+    }
+    m_acquired = false;
+    m_queued++;
+    pthread_cond_signal(&m_frameQueued);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void tgVideoEncoder::finish()
+{
+    if (m_finished)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    m_closing = true;
+    m_acquired = false;
+    pthread_cond_signal(&m_frameQueued);
+    pthread_mutex_unlock(&m_mutex);
+
+    pthread_join(m_writer, NULL);
+    const int status = pclose(m_pPipe);
+    m_pPipe = NULL;
+    m_finished = true;
+
+    if (m_failed)
+    {
+        throw std::runtime_error("Could not write a video frame");
+    }
+    if (status != 0)
+    {
+        throw std::runtime_error("The video encoder failed");
+    }
+}
+
+std::size_t tgVideoEncoder::getFramesWritten() const
+{
+    pthread_mutex_lock(&m_mutex);
+    const std::size_t written = m_framesWritten;
+    pthread_mutex_unlock(&m_mutex);
+    return written;
+}
+
+bool tgVideoEncoder::write(const Frame& frame)
+{
+    if (std::fprintf(m_pPipe, "P6\n%d %d\n255\n", frame.width, frame.height) < 0)
+    {
+        return false;
+    }
+    // PPM rows run top to bottom
+    const std::size_t rowBytes = 3 * (std::size_t) frame.width;
+    for (int y = frame.height - 1; y >= 0; y--)
+    {
+        if (std::fwrite(&frame.pixels[y * rowBytes], 1, rowBytes, m_pPipe) !=
+            rowBytes)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void tgVideoEncoder::work()
+{
+    pthread_mutex_lock(&m_mutex);
+    while (true)
+    {
+        while (m_queued == 0 && !m_closing)
+        {
+            pthread_cond_wait(&m_frameQueued, &m_mutex);
+        }
+        if (m_queued == 0)
+        {
+            break;
+        }
+        const Frame& frame = m_frames[m_head];
+        const bool failed = m_failed;
+        pthread_mutex_unlock(&m_mutex);
+
+        // After a failure the queue is still drained, so acquire can see it
+        const bool written = !failed && write(frame);
+
+        pthread_mutex_lock(&m_mutex);
+        if (written)
+        {
+            m_framesWritten++;
+        }
+        else
+        {
+            m_failed = true;
+        }
+        m_head = (m_head + 1) % m_frames.size();
+        m_queued--;
+        pthread_cond_signal(&m_frameWritten);
+    }
+    // Here rather than in pclose, on the thread that ignores SIGPIPE
+    if (!m_failed && std::fflush(m_pPipe) != 0)
+    {
+        m_failed = true;
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void* tgVideoEncoder::writerMain(void* arg)
+{
+    // An encoder that exits early fails the write rather than the process
+    sigset_t pipeSignal;
+    sigemptyset(&pipeSignal);
+    sigaddset(&pipeSignal, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipeSignal, NULL);
+
+    static_cast<tgVideoEncoder*>(arg)->work();
+    return NULL;
+}
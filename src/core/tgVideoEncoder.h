@@ -0,0 +1,141 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_VIDEO_ENCODER_H
+#define TG_VIDEO_ENCODER_H
+
+/**
+ * @file tgVideoEncoder.h
+ * @brief Contains the definition of class tgVideoEncoder
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstdio>
+#include <string>
+#include <vector>
+// POSIX threads
+#include <pthread.h>
+
+/**
+ * Writes rendered frames to a video encoder on a background thread, so
+ * the renderer only waits when the encoder falls a whole queue behind.
+ * Frames are RGB rows bottom to top, as glReadPixels gives them, and are
+ * written to the standard input of a shell command as a stream of binary
+ * PPM images, e.g.
+ *
+ *     ffmpeg -y -f image2pipe -vcodec ppm -r 60 -i - video.mp4
+ *
+ * The queue is a fixed ring of frame buffers, filled in place: acquire
+ * a buffer, fill it, then submit it.
+ */
+class tgVideoEncoder
+{
+public:
+
+    /**
+     * Start the command and the writer thread.
+     * @param[in] command run by the shell, reading frames on its stdin
+     * @param[in] queueLength the most frames waiting to be written
+     * @throw std::invalid_argument if queueLength is 0
+     * @throw std::runtime_error if the command or thread cannot be started
+     */
+    tgVideoEncoder(const std::string& command, std::size_t queueLength = 8);
+
+    /** Calls finish, ignoring its errors */
+    ~tgVideoEncoder();
+
+    /**
+     * The buffer for the next frame, waiting while the queue is full.
+     * @param[in] width in pixels; must be positive
+     * @param[in] height in pixels; must be positive
+     * @return width * height * 3 bytes, valid until submit
+     * @throw std::invalid_argument if width or height is not positive
+     * @throw std::logic_error if a frame is already acquired or after
+     * finish
+     * @throw std::runtime_error if an earlier frame could not be written
+     */
+    unsigned char* acquire(int width, int height);
+
+    /**
+     * Queue the acquired frame for writing.
+     * @throw std::logic_error if no frame is acquired
+     */
+    void submit();
+
+    /**
+     * Write every queued frame, close the command's input and wait for
+     * it to exit. Does nothing the second time.
+     * @throw std::runtime_error if a frame could not be written or the
+     * command failed
+     */
+    void finish();
+
+    /** The frames written so far */
+    std::size_t getFramesWritten() const;
+
+private:
+
+    struct Frame
+    {
+        std::vector<unsigned char> pixels;
+        int width;
+        int height;
+    };
+
+    /** Write one frame to m_pPipe; false if it failed */
+    bool write(const Frame& frame);
+
+    /** The writer loop */
+    void work();
+
+    /** pthread entry point; arg is the encoder */
+    static void* writerMain(void* arg);
+
+    /** Not copyable */
+    tgVideoEncoder(const tgVideoEncoder&);
+    tgVideoEncoder& operator=(const tgVideoEncoder&);
+
+    FILE* m_pPipe;
+
+    pthread_t m_writer;
+
+    std::vector<Frame> m_frames;
+
+    /** Guards everything below */
+    mutable pthread_mutex_t m_mutex;
+
+    /** Signalled when a frame is queued or the writer should exit */
+    pthread_cond_t m_frameQueued;
+
+    /** Signalled when a frame has been written */
+    pthread_cond_t m_frameWritten;
+
+    /** The next frame to write, and the number queued after it */
+    std::size_t m_head;
+    std::size_t m_queued;
+
+    bool m_acquired;
+    bool m_closing;
+    bool m_finished;
+    bool m_failed;
+
+    std::size_t m_framesWritten;
+};
+
+#endif  // TG_VIDEO_ENCODER_H
@@ -0,0 +1,410 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgWarmStartCache.cpp
+ * @brief Contains the definitions of members of class tgWarmStartCache
+ * $Id$
+ */
+
+// This module
+#include "tgWarmStartCache.h"
+// This application
+#include "tgBulletUtil.h"
+#include "tgSimulation.h"
+#include "tgSpringCableActuator.h"
+#include "tgWorld.h"
+#include "tgWorldSnapshot.h"
+// The Bullet Physics library
+#include "BulletCollision/CollisionShapes/btCollisionShape.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <typeinfo>
+// POSIX
+#include <unistd.h>
+
+namespace
+{
+    const char magic[8] = { 'N', 'T', 'R', 'T', 'W', 'A', 'R', 'M' };
+    const unsigned int version = 1;
+
+    const unsigned long long fnvOffset = 14695981039346656037ULL;
+    const unsigned long long fnvPrime = 1099511628211ULL;
+
+    /** FNV-1a over raw bytes */
+    unsigned long long hashBytes(unsigned long long h, const void* data,
+                                 std::size_t n)
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            h ^= p[i];
+            h *= fnvPrime;
+        }
+        return h;
+    }
+
+    unsigned long long hashDouble(unsigned long long h, double x)
+    {
+        return hashBytes(h, &x, sizeof(x));
+    }
+
+    unsigned long long hashInt(unsigned long long h, long long x)
+    {
+        return hashBytes(h, &x, sizeof(x));
+    }
+
+    unsigned long long hashString(unsigned long long h, const std::string& s)
+    {
+        h = hashInt(h, s.size());
+        return hashBytes(h, s.data(), s.size());
+    }
+
+    unsigned long long hashVector(unsigned long long h, const btVector3& v)
+    {
+        h = hashDouble(h, v.x());
+        h = hashDouble(h, v.y());
+        return hashDouble(h, v.z());
+    }
+
+    unsigned long long hashTransform(unsigned long long h, const btTransform& t)
+    {
+        for (int r = 0; r < 3; r++)
+        {
+            h = hashVector(h, t.getBasis()[r]);
+        }
+        return hashVector(h, t.getOrigin());
+    }
+
+    /** The shape and bounds of a body, however it is placed */
+    unsigned long long hashShape(unsigned long long h, const btCollisionObject& object)
+    {
+        const btCollisionShape* const pShape = object.getCollisionShape();
+        if (pShape == NULL)
+        {
+            return hashInt(h, -1);
+        }
+        btVector3 aabbMin;
+        btVector3 aabbMax;
+        pShape->getAabb(object.getWorldTransform(), aabbMin, aabbMax);
+        h = hashInt(h, pShape->getShapeType());
+        h = hashVector(h, aabbMin);
+        return hashVector(h, aabbMax);
+    }
+
+    void write(std::FILE* f, const void* data, std::size_t n, bool& ok)
+    {
+        ok = ok && std::fwrite(data, 1, n, f) == n;
+    }
+
+    void writeDouble(std::FILE* f, double x, bool& ok)
+    {
+        write(f, &x, sizeof(x), ok);
+    }
+
+    void writeVector(std::FILE* f, const btVector3& v, bool& ok)
+    {
+        writeDouble(f, v.x(), ok);
+        writeDouble(f, v.y(), ok);
+        writeDouble(f, v.z(), ok);
+    }
+
+    bool read(std::FILE* f, void* data, std::size_t n)
+    {
+        return std::fread(data, 1, n, f) == n;
+    }
+
+    bool readVector(std::FILE* f, btVector3& v)
+    {
+        double xyz[3];
+        if (!read(f, xyz, sizeof(xyz)))
+        {
+            return false;
+        }
+        v.setValue(xyz[0], xyz[1], xyz[2]);
+        return true;
+    }
+
+    /** Closes the file when it goes out of scope */
+    class FileCloser
+    {
+    public:
+        FileCloser(std::FILE* f) : m_f(f) { }
+        ~FileCloser() { if (m_f) std::fclose(m_f); }
+    private:
+        std::FILE* m_f;
+    };
+
+    std::string actuatorType(const tgSpringCableActuator* pActuator)
+    {
+        return typeid(*pActuator).name();
+    }
+}
+
+tgWarmStartCache::tgWarmStartCache(const std::string& directory) :
+m_directory(directory),
+m_hits(0),
+m_misses(0)
+{
+}
+
+std::string tgWarmStartCache::path(const tgSimulation& simulation, int steps,
+                                   const std::string& salt) const
+{
+    unsigned long long h = fnvOffset;
+    h = hashString(h, salt);
+    h = hashInt(h, steps);
+    h = hashDouble(h, simulation.getStepSize());
+
+    const tgWorld::Config& config = simulation.getWorld().getConfig();
+    h = hashDouble(h, config.gravity);
+    h = hashDouble(h, config.worldSize);
+    h = hashInt(h, config.batchCableForces);
+    h = hashInt(h, config.solverType);
+    h = hashInt(h, config.solverIterations);
+    h = hashInt(h, config.broadphaseType);
+    h = hashInt(h, config.maxBroadphaseHandles);
+    h = hashInt(h, config.dynamicsWorldType);
+    h = hashInt(h, config.cableSubsteps);
+    h = hashInt(h, config.collisionInterval);
+    h = hashDouble(h, config.cableWakeImpulse);
+    h = hashDouble(h, config.cableCollisionCell);
+
+    // The moving bodies and actuators as they start
+    tgWorldSnapshot start;
+    simulation.snapshot(start);
+    h = hashInt(h, start.numCollisionObjects);
+    h = hashInt(h, start.bodies.size());
+    for (std::size_t i = 0; i < start.bodies.size(); i++)
+    {
+        const tgWorldSnapshot::BodyState& body = start.bodies[i];
+        h = hashTransform(h, body.worldTransform);
+        h = hashVector(h, body.linearVelocity);
+        h = hashVector(h, body.angularVelocity);
+        h = hashDouble(h, body.pBody->getInvMass());
+        h = hashShape(h, *body.pBody);
+    }
+    h = hashInt(h, start.actuators.size());
+    for (std::size_t i = 0; i < start.actuators.size(); i++)
+    {
+        h = hashString(h, actuatorType(start.actuators[i]));
+    }
+    h = hashInt(h, start.actuatorState.size());
+    for (std::size_t i = 0; i < start.actuatorState.size(); i++)
+    {
+        h = hashDouble(h, start.actuatorState[i]);
+    }
+
+    // The ground and any other static bodies
+    const btCollisionObjectArray& oa =
+        tgBulletUtil::worldToDynamicsWorld(simulation.getWorld()).getCollisionObjectArray();
+    for (int i = 0; i < oa.size(); i++)
+    {
+        if (oa[i]->isStaticObject())
+        {
+            h = hashTransform(h, oa[i]->getWorldTransform());
+            h = hashShape(h, *oa[i]);
+        }
+    }
+
+    char name[32];
+    std::sprintf(name, "warm_%016llx.bin", h);
+    return m_directory + "/" + name;
+}
+
+bool tgWarmStartCache::settle(tgSimulation& simulation, int steps,
+                              tgWorldSnapshot& settled, const std::string& salt)
+{
+    if (steps < 0)
+    {
+        throw std::invalid_argument("Settle steps is negative");
+    }
+    const std::string fileName = path(simulation, steps, salt);
+
+    tgWorldSnapshot layout;
+    simulation.snapshot(layout);
+    if (load(fileName, layout, settled))
+    {
+        simulation.restore(settled);
+        m_hits++;
+        return true;
+    }
+
+    if (steps > 0)
+    {
+        simulation.run(steps);
+    }
+    simulation.snapshot(settled);
+    save(fileName, settled);
+    m_misses++;
+    return false;
+}
+
+bool tgWarmStartCache::load(const std::string& fileName,
+                            const tgWorldSnapshot& layout,
+                            tgWorldSnapshot& settled)
+{
+    std::FILE* const f = std::fopen(fileName.c_str(), "rb");
+    if (f == NULL)
+    {
+        return false;
+    }
+    FileCloser closer(f);
+
+    char fileMagic[sizeof(magic)];
+    unsigned int fileVersion = 0;
+    if (!read(f, fileMagic, sizeof(fileMagic)) ||
+        std::memcmp(fileMagic, magic, sizeof(magic)) != 0 ||
+        !read(f, &fileVersion, sizeof(fileVersion)) || fileVersion != version)
+    {
+        return false;
+    }
+
+    int numCollisionObjects = 0;
+    unsigned long long nBodies = 0;
+    if (!read(f, &numCollisionObjects, sizeof(numCollisionObjects)) ||
+        numCollisionObjects != layout.numCollisionObjects ||
+        !read(f, &nBodies, sizeof(nBodies)) || nBodies != layout.bodies.size())
+    {
+        return false;
+    }
+    settled.numCollisionObjects = numCollisionObjects;
+    settled.bodies.resize(layout.bodies.size());
+    for (std::size_t i = 0; i < settled.bodies.size(); i++)
+    {
+        tgWorldSnapshot::BodyState& body = settled.bodies[i];
+        body.pBody = layout.bodies[i].pBody;
+        btVector3 rows[3];
+        btVector3 origin;
+        btVector3 linear;
+        btVector3 angular;
+        int activationState = 0;
+        double deactivationTime = 0.0;
+        if (!readVector(f, rows[0]) || !readVector(f, rows[1]) ||
+            !readVector(f, rows[2]) || !readVector(f, origin) ||
+            !readVector(f, linear) || !readVector(f, angular) ||
+            !read(f, &activationState, sizeof(activationState)) ||
+            !read(f, &deactivationTime, sizeof(deactivationTime)))
+        {
+            return false;
+        }
+        body.worldTransform.setBasis(btMatrix3x3(rows[0].x(), rows[0].y(), rows[0].z(),
+                                                 rows[1].x(), rows[1].y(), rows[1].z(),
+                                                 rows[2].x(), rows[2].y(), rows[2].z()));
+        body.worldTransform.setOrigin(origin);
+        body.linearVelocity = linear;
+        body.angularVelocity = angular;
+        body.activationState = activationState;
+        body.deactivationTime = deactivationTime;
+    }
+
+    unsigned long long nActuators = 0;
+    if (!read(f, &nActuators, sizeof(nActuators)) ||
+        nActuators != layout.actuators.size())
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < layout.actuators.size(); i++)
+    {
+        unsigned int length = 0;
+        if (!read(f, &length, sizeof(length)) || length > 4096)
+        {
+            return false;
+        }
+        std::string type(length, '\0');
+        if ((length > 0 && !read(f, &type[0], length)) ||
+            type != actuatorType(layout.actuators[i]))
+        {
+            return false;
+        }
+    }
+    settled.actuators = layout.actuators;
+
+    unsigned long long nState = 0;
+    if (!read(f, &nState, sizeof(nState)) ||
+        nState != layout.actuatorState.size())
+    {
+        return false;
+    }
+    settled.actuatorState.resize(layout.actuatorState.size());
+    if (nState > 0 &&
+        !read(f, &settled.actuatorState[0], nState * sizeof(double)))
+    {
+        return false;
+    }
+    return true;
+}
+
+void tgWarmStartCache::save(const std::string& fileName,
+                            const tgWorldSnapshot& settled)
+{
+    std::ostringstream tempName;
+    tempName << fileName << ".tmp" << getpid();
+    std::FILE* const f = std::fopen(tempName.str().c_str(), "wb");
+    if (f == NULL)
+    {
+        throw std::runtime_error("Could not write " + tempName.str());
+    }
+
+    bool ok = true;
+    write(f, magic, sizeof(magic), ok);
+    write(f, &version, sizeof(version), ok);
+    write(f, &settled.numCollisionObjects, sizeof(settled.numCollisionObjects), ok);
+    const unsigned long long nBodies = settled.bodies.size();
+    write(f, &nBodies, sizeof(nBodies), ok);
+    for (std::size_t i = 0; i < settled.bodies.size(); i++)
+    {
+        const tgWorldSnapshot::BodyState& body = settled.bodies[i];
+        for (int r = 0; r < 3; r++)
+        {
+            writeVector(f, body.worldTransform.getBasis()[r], ok);
+        }
+        writeVector(f, body.worldTransform.getOrigin(), ok);
+        writeVector(f, body.linearVelocity, ok);
+        writeVector(f, body.angularVelocity, ok);
+        write(f, &body.activationState, sizeof(body.activationState), ok);
+        writeDouble(f, body.deactivationTime, ok);
+    }
+    const unsigned long long nActuators = settled.actuators.size();
+    write(f, &nActuators, sizeof(nActuators), ok);
+    for (std::size_t i = 0; i < settled.actuators.size(); i++)
+    {
+        const std::string type = actuatorType(settled.actuators[i]);
+        const unsigned int length = type.size();
+        write(f, &length, sizeof(length), ok);
+        write(f, type.data(), length, ok);
+    }
+    const unsigned long long nState = settled.actuatorState.size();
+    write(f, &nState, sizeof(nState), ok);
+    if (nState > 0)
+    {
+        write(f, &settled.actuatorState[0], nState * sizeof(double), ok);
+    }
+
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tempName.str().c_str(), fileName.c_str()) != 0)
+    {
+        std::remove(tempName.str().c_str());
+        throw std::runtime_error("Could not write " + fileName);
+    }
+}
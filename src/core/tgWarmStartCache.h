@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_WARM_START_CACHE_H
+#define TG_WARM_START_CACHE_H
+
+/**
+ * @file tgWarmStartCache.h
+ * @brief Contains the definition of class tgWarmStartCache
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+
+// Forward declarations
+class tgSimulation;
+class tgWorldSnapshot;
+
+/**
+ * Settled initial poses kept on disk. Most apps let a model drop and
+ * settle under its pretension before the controller matters, and for a
+ * given model, world and terrain the settled state is the same every
+ * time. settle() runs those steps once and saves the resulting snapshot
+ * in a directory, keyed by a hash of the state it started from; later
+ * calls, in this process or another, restore the file instead.
+ *
+ * The key covers the world's configuration, the step size, the number
+ * of settle steps, the position, velocity and mass of every moving
+ * body, the type and state of every actuator, and the shape and bounds
+ * of every static body such as the ground. Anything else the settled
+ * state depends on, such as the seed of a random terrain or what the
+ * controllers do while settling, belongs in the salt.
+ *
+ * Files are written to a temporary name and renamed, so processes
+ * settling the same model at once never read a partial file.
+ */
+class tgWarmStartCache
+{
+public:
+
+    /**
+     * @param[in] directory where the files are kept; must exist
+     */
+    tgWarmStartCache(const std::string& directory);
+
+    /**
+     * Bring a simulation whose models were just set up to its settled
+     * state, from the cache if possible.
+     * @param[in,out] simulation set up, and not yet stepped
+     * @param[in] steps the number of steps to settle for
+     * @param[out] settled the settled state, for tgSimulation::restart
+     * at the start of each episode
+     * @param[in] salt anything else the settled state depends on
+     * @return true if the state came from the cache, false if the
+     * steps were run
+     * @throw std::invalid_argument if steps is negative
+     * @throw std::runtime_error if a new file cannot be written
+     */
+    bool settle(tgSimulation& simulation, int steps, tgWorldSnapshot& settled,
+                const std::string& salt = "");
+
+    /**
+     * The file settle would use for a simulation in its current state
+     */
+    std::string path(const tgSimulation& simulation, int steps,
+                     const std::string& salt = "") const;
+
+    /** The number of settles restored from a file */
+    std::size_t getHits() const
+    {
+        return m_hits;
+    }
+
+    /** The number of settles that ran their steps */
+    std::size_t getMisses() const
+    {
+        return m_misses;
+    }
+
+private:
+
+    /**
+     * Fill settled from a file, with the bodies and actuators of layout
+     * @return false if the file is missing or does not match layout
+     */
+    static bool load(const std::string& fileName, const tgWorldSnapshot& layout,
+                     tgWorldSnapshot& settled);
+
+    /** @throw std::runtime_error if the file cannot be written */
+    static void save(const std::string& fileName, const tgWorldSnapshot& settled);
+
+    const std::string m_directory;
+
+    std::size_t m_hits;
+
+    std::size_t m_misses;
+};
+
+#endif  // TG_WARM_START_CACHE_H
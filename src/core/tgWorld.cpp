@@ -26,20 +26,84 @@
 // This module
 #include "tgWorld.h"
 // This application
+#include "tgSpatialQuery.h"
 #include "tgWorldBulletPhysicsImpl.h"
 #include "terrain/tgBoxGround.h"
 // The C++ Standard Library
 #include <cassert>
 #include <stdexcept>
 
-tgWorld::Config::Config(double g, double ws) :
+tgWorld::Config::Config(double g, double ws, bool bcf,
+                        SolverType st, int si,
+                        BroadphaseType bt, int mh,
+                        DynamicsWorldType dw, int nt,
+                        int cs, int ci, double cwi, int msi,
+                        double pt, int ct, double cc) :
 gravity(g),
-worldSize(ws)
+worldSize(ws),
+batchCableForces(bcf),
+solverType(st),
+solverIterations(si),
+broadphaseType(bt),
+maxBroadphaseHandles(mh),
+dynamicsWorldType(dw),
+numThreads(nt),
+cableSubsteps(cs),
+collisionInterval(ci),
+cableWakeImpulse(cwi),
+minSolverIterations(msi),
+penetrationTolerance(pt),
+cableThreads(ct),
+cableCollisionCell(cc)
 {
   if (ws <= 0.0)
   {
     throw std::invalid_argument("worldSize is not postive");
   }
+  if (si < 0)
+  {
+    throw std::invalid_argument("solverIterations is negative");
+  }
+  if (msi < 0)
+  {
+    throw std::invalid_argument("minSolverIterations is negative");
+  }
+  if (si > 0 && msi > si)
+  {
+    throw std::invalid_argument("minSolverIterations is above solverIterations");
+  }
+  if (!(pt > 0.0))
+  {
+    throw std::invalid_argument("penetrationTolerance is not positive");
+  }
+  if (ct < 0)
+  {
+    throw std::invalid_argument("cableThreads is negative");
+  }
+  if (cc < 0.0)
+  {
+    throw std::invalid_argument("cableCollisionCell is negative");
+  }
+  if (mh <= 0)
+  {
+    throw std::invalid_argument("maxBroadphaseHandles is not positive");
+  }
+  if (nt < 0)
+  {
+    throw std::invalid_argument("numThreads is negative");
+  }
+  if (cs <= 0)
+  {
+    throw std::invalid_argument("cableSubsteps is not positive");
+  }
+  if (ci <= 0)
+  {
+    throw std::invalid_argument("collisionInterval is not positive");
+  }
+  if (dw == eRigidMultithreaded && st != eSequentialImpulse)
+  {
+    throw std::invalid_argument("the multithreaded world needs the sequential impulse solver");
+  }
 }
 
 /**
@@ -49,7 +113,8 @@ worldSize(ws)
 tgWorld::tgWorld() :
   m_config(),
   m_pGround(new tgBoxGround()),
-  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround))
+  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround)),
+  m_pSpatialQuery(NULL)
 {
   // Postcondition
   assert(invariant());
@@ -62,7 +127,8 @@ tgWorld::tgWorld() :
 tgWorld::tgWorld(const tgWorld::Config& config) :
   m_config(config),
   m_pGround(new tgBoxGround()),
-  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround))
+  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround)),
+  m_pSpatialQuery(NULL)
 {
   // Postcondition
   assert(invariant());
@@ -75,7 +141,8 @@ tgWorld::tgWorld(const tgWorld::Config& config) :
 tgWorld::tgWorld(const tgWorld::Config& config, tgGround* ground) :
   m_config(config),
   m_pGround(ground),
-  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround))
+  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround)),
+  m_pSpatialQuery(NULL)
 {
   // Postcondition
   assert(invariant());
@@ -83,6 +150,7 @@ tgWorld::tgWorld(const tgWorld::Config& config, tgGround* ground) :
 
 tgWorld::~tgWorld()
 {
+  delete m_pSpatialQuery;
   delete m_pImpl;
   delete m_pGround;
 }
@@ -108,14 +176,36 @@ void tgWorld::reset(const tgWorld::Config& config)
 
 void tgWorld::reset(tgGround * ground)
 {
-    delete m_pGround;
-    
-    m_pGround = ground;
+    // The implementation hands its body back to the old ground, so it
+    // must go first
+    delete m_pImpl;
+    m_pImpl = NULL;
+
+    if (ground != m_pGround)
+    {
+        delete m_pGround;
+        m_pGround = ground;
+    }
     
     // Reset as usual
     reset();
 }
 
+void tgWorld::swapGround(tgGround* ground)
+{
+    if (ground == m_pGround)
+    {
+        return;
+    }
+    // The implementation hands its body back to the old ground first
+    m_pImpl->swapGround(ground);
+    delete m_pGround;
+    m_pGround = ground;
+
+    // Postcondition
+    assert(invariant());
+}
+
 void tgWorld::step(double dt) const
 {
   if (dt <= 0.0)
@@ -129,6 +219,38 @@ void tgWorld::step(double dt) const
   }
 }
 
+void tgWorld::snapshot(tgWorldSnapshot& snapshot) const
+{
+  m_pImpl->snapshot(snapshot);
+}
+
+const tgRigidStateFrame& tgWorld::getRigidStates() const
+{
+  return m_pImpl->rigidStates();
+}
+
+const tgContactFrame& tgWorld::getContacts() const
+{
+  return m_pImpl->contacts();
+}
+
+tgSpatialQuery& tgWorld::getSpatialQuery() const
+{
+  if (m_pSpatialQuery == NULL)
+  {
+    m_pSpatialQuery = new tgSpatialQuery(*this);
+  }
+  return *m_pSpatialQuery;
+}
+
+void tgWorld::restore(const tgWorldSnapshot& snapshot)
+{
+  m_pImpl->restore(snapshot);
+
+  // Postcondition
+  assert(invariant());
+}
+
 // Add a function that returns the amount of gravity in the world.
 // This is useful for calculating the forces applied by rigid bodies
 // inside models (e.g., ForcePlateModel.)
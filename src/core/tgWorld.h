@@ -29,6 +29,10 @@
 // Forward declarations
 class tgWorldImpl;
 class tgGround;
+class tgWorldSnapshot;
+class tgRigidStateFrame;
+class tgContactFrame;
+class tgSpatialQuery;
 
 /**
  * Represents the world in which the Tensegrities operate, including
@@ -44,7 +48,60 @@ public:
    */
   struct Config
   {
-	Config(double g = 9.81, double ws = 1000);
+    /** The Bullet constraint solver */
+    enum SolverType
+    {
+      /** btSequentialImpulseConstraintSolver */
+      eSequentialImpulse,
+      /** btMLCPSolver with btDantzigSolver */
+      eMLCPDantzig,
+      /** btMLCPSolver with btSolveProjectedGaussSeidel */
+      eMLCPProjectedGaussSeidel,
+      /** btNNCGConstraintSolver; needs Bullet 2.83 or later */
+      eNNCG
+    };
+
+    /** The Bullet broadphase */
+    enum BroadphaseType
+    {
+      /** btAxisSweep3, or bt32BitAxisSweep3 above 65535 handles */
+      eAxisSweep,
+      /** btDbvtBroadphase */
+      eDbvt,
+      /**
+       * As eAxisSweep, but the sweep follows the world's moving bodies:
+       * once the centre of their bounds is more than worldSize / 2 from
+       * the sweep's centre on any axis, the broadphase is rebuilt around
+       * it. Long runs can then keep a small worldSize, and so a fine
+       * quantization, however far the model travels. Contacts are
+       * dropped for one step on each rebuild.
+       */
+      eRecenteringAxisSweep
+    };
+
+    /** The Bullet dynamics world */
+    enum DynamicsWorldType
+    {
+      /** btSoftRigidDynamicsWorld */
+      eSoftRigid,
+      /** btDiscreteDynamicsWorld, for models without soft bodies */
+      eRigid,
+      /**
+       * btDiscreteDynamicsWorldMt, which runs the narrowphase and solves
+       * islands on Bullet's task scheduler. Needs Bullet 2.88 or later
+       * built with BT_THREADSAFE, and eSequentialImpulse. The scheduler
+       * is shared by the whole process, so prefer eRigid for worlds
+       * stepped by tgParallelSimulation.
+       */
+      eRigidMultithreaded
+    };
+
+	Config(double g = 9.81, double ws = 1000, bool bcf = false,
+	       SolverType st = eMLCPDantzig, int si = 0,
+	       BroadphaseType bt = eAxisSweep, int mh = 16384,
+	       DynamicsWorldType dw = eSoftRigid, int nt = 0,
+	       int cs = 1, int ci = 1, double cwi = -1.0, int msi = 0,
+	       double pt = 0.01, int ct = 0, double cc = 0.0);
     /**
      * Gravitational acceleration.
      * The units are application depenent.
@@ -56,6 +113,94 @@ public:
      * the length of one side of the detection cube. Must be positive.
      */
     double worldSize;
+    /**
+     * Compute the forces of tgBasicActuator and tgKinematicActuator
+     * cables, and of compression springs, in one batch per world step
+     * (see tgBulletCableForceEngine) rather than once per cable as the
+     * models step.
+     */
+    bool batchCableForces;
+    /** The constraint solver to use */
+    SolverType solverType;
+    /**
+     * Constraint solver iterations per step; 0 keeps Bullet's default.
+     * Must not be negative.
+     */
+    int solverIterations;
+    /** The broadphase to use */
+    BroadphaseType broadphaseType;
+    /**
+     * The most collision objects an eAxisSweep or eRecenteringAxisSweep
+     * broadphase can hold. Must be positive. Ignored by eDbvt, which
+     * grows as needed.
+     */
+    int maxBroadphaseHandles;
+    /** The dynamics world to use */
+    DynamicsWorldType dynamicsWorldType;
+    /**
+     * Threads used by an eRigidMultithreaded world; 0 for as many as the
+     * task scheduler allows. Must not be negative.
+     */
+    int numThreads;
+    /**
+     * How many times tgSimulation::step steps the models, and so the
+     * cables and actuators, per world step, each over an equal share of
+     * dt. The rigid bodies move only on world steps, so an unbatched
+     * cable takes its damping velocity from the bodies' velocities when
+     * this is above 1. Batched cables are stepped with the world.
+     * Must be positive.
+     */
+    int cableSubsteps;
+    /**
+     * Run the narrowphase on every collisionInterval-th world step only.
+     * In between, the existing contact points are moved with their
+     * bodies and pairs the broadphase has just found are still collided,
+     * but new contacts within an existing pair are found up to
+     * collisionInterval - 1 steps late. Must be positive.
+     */
+    int collisionInterval;
+    /**
+     * Negative, the default, for cables to wake the bodies they are
+     * attached to on every step, so those bodies never sleep. Otherwise
+     * cables push an awake body without waking it, and leave a sleeping
+     * body asleep until the impulse on it changes by more than this, so
+     * Bullet can deactivate settled parts of the world. Batched cables
+     * compare each body's net impulse from all cables and springs.
+     */
+    double cableWakeImpulse;
+    /**
+     * Zero, the default, for a fixed number of solver iterations.
+     * Otherwise the iterations are chosen each step between this and
+     * solverIterations, or Bullet's default if that is 0: raised while
+     * the previous step left contacts deeper than penetrationTolerance
+     * and lowered while it left them shallow, so airborne phases run
+     * few iterations and heavy ground contact many. Must not be
+     * negative or above solverIterations. The MLCP solvers only use
+     * the iterations for their fallback.
+     */
+    int minSolverIterations;
+    /**
+     * The deepest penetration, in length units, that adaptive solver
+     * iterations accept without raising the count. Must be positive.
+     */
+    double penetrationTolerance;
+    /**
+     * Worker threads that compute batched cable forces within this
+     * world; 0 or 1 computes them on the stepping thread. Only worth it
+     * for models with many hundreds of cables, and only used when
+     * batchCableForces is set. Must not be negative.
+     */
+    int cableThreads;
+    /**
+     * Zero, the default, for contact cables to find rods through their
+     * ghost objects and Bullet's narrowphase. Otherwise the side of the
+     * grid cells in which tgCableCollision collides the cables, as
+     * chains of capsules, with the cylinders, capsules and spheres of
+     * moving bodies and with each other; about a rod's length works
+     * well. The ghost objects then only meet static bodies. Must not be
+     * negative.
+     */
+    double cableCollisionCell;
   };
 
   /** Construct with the default configuration. */
@@ -78,7 +223,10 @@ public:
   /** Delete the implementation. */
   ~tgWorld();
 
-  /** Replace the implementation. */
+  /**
+   * Replace the implementation. The ground and its rigid body are kept
+   * and reinserted into the new implementation.
+   */
   void reset();
 
   /**
@@ -89,9 +237,19 @@ public:
 
   /**
    * Replace the implementation with a new ground.
-   * @param[in] ground the new ground
+   * @param[in] ground the new ground; the old one is deleted unless it is
+   * the same ground
    */
   void reset(tgGround* ground);
+
+  /**
+   * Replace the ground while keeping the implementation, so the models'
+   * bodies, shapes and constraints stay where they are and snapshots
+   * taken before remain valid. See tgSimulation::swapGround.
+   * @param[in] ground the new ground; the old one is deleted unless it is
+   * the same ground
+   */
+  void swapGround(tgGround* ground);
     
   /**
    * Advance the simulation.
@@ -100,6 +258,44 @@ public:
    */
   void step(double dt) const;
 
+  /**
+   * Record the state of every rigid body, so an episode can be
+   * restarted without rebuilding the world. See tgSimulation::snapshot
+   * to include the actuators as well.
+   * @param[out] snapshot overwritten with the current state
+   */
+  void snapshot(tgWorldSnapshot& snapshot) const;
+
+  /**
+   * Put every rigid body back to a recorded state. Nothing is
+   * reallocated.
+   * @param[in] snapshot taken from this world since it was last reset
+   * @throw std::invalid_argument if bodies were added or removed since
+   */
+  void restore(const tgWorldSnapshot& snapshot);
+
+  /**
+   * The pose and velocities of every rigid body, published once per step
+   * and on restore. tgBaseRigid reads from it, so sensors and controllers
+   * that go through tgBaseRigid use it without asking Bullet.
+   */
+  const tgRigidStateFrame& getRigidStates() const;
+
+  /**
+   * The total normal impulse, number and centroid of the contacts on
+   * every rigid body in the last step, from one walk over Bullet's
+   * manifolds that everyone who asks in the same step shares.
+   */
+  const tgContactFrame& getContacts() const;
+
+  /**
+   * Overlap, nearest object, sphere sweep and ray queries through the
+   * broadphase, shared by everyone who asks; each result is valid until
+   * the next query of its kind. Made the first time it is asked for,
+   * and kept across resets.
+   */
+  tgSpatialQuery& getSpatialQuery() const;
+
   /**
    * Return a pointer to the implementation.
    * @return a pointer to the implementation; may be NULL.
@@ -110,6 +306,12 @@ public:
     return *m_pImpl;
   }
 
+  /** The configuration passed at construction or on the last reset */
+  const Config& getConfig() const
+  {
+    return m_config;
+  }
+
   /**
    * Returns the level of gravity in this world.
    */
@@ -132,6 +334,9 @@ private:
 
   /** The implementation of the tgWorld. */
   tgWorldImpl * m_pImpl;
+
+  /** Made by getSpatialQuery; NULL until then. We own this. */
+  mutable tgSpatialQuery* m_pSpatialQuery;
 };
 
 #endif //TG_BULLET_WORLD_H
@@ -28,23 +28,45 @@
 #include "tgWorldBulletPhysicsImpl.h"
 // This application
 #include "tgWorld.h"
+#include "tgBulletCableForceEngine.h"
+#include "tgCableCollision.h"
+#include "tgBulletShapeCache.h"
 #include "tgCast.h"
+#include "tgGhostPairFilter.h"
+#include "tgRigidBodyArena.h"
+#include "tgWorldSnapshot.h"
 #include "terrain/tgBulletGround.h"
 #include "terrain/tgEmptyGround.h"
+#include "terrain/tgTiledGround.h"
 // The Bullet Physics library
 #include "BulletCollision/BroadphaseCollision/btBroadphaseInterface.h"
 #include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
 #include "BulletCollision/BroadphaseCollision/btAxisSweep3.h" // New broadphase
 #include "BulletCollision/CollisionDispatch/btCollisionDispatcher.h"
 #include "BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h"
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
 #include "BulletCollision/CollisionShapes/btBoxShape.h"
 #include "BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h"
 #include "BulletCollision/CollisionShapes/btCompoundShape.h"
 #include "BulletDynamics/Dynamics/btRigidBody.h"
 #include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h"
 #include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h"
+#include "BulletDynamics/MLCPSolvers/btDantzigSolver.h"
+#include "BulletDynamics/MLCPSolvers/btSolveProjectedGaussSeidel.h"
+#include "BulletDynamics/MLCPSolvers/btMLCPSolver.h"
+#if BT_BULLET_VERSION >= 283
+#include "BulletDynamics/ConstraintSolver/btNNCGConstraintSolver.h"
+#endif
+#if BT_BULLET_VERSION >= 288
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#include "LinearMath/btThreads.h"
+#endif
 #include "BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h"
 #include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
+#include "BulletSoftBody/btSoftBody.h"
 #include "LinearMath/btDefaultMotionState.h"
 #include "LinearMath/btScalar.h"
 #include "LinearMath/btTransform.h"
@@ -55,15 +77,65 @@
 #include "BulletCollision/CollisionDispatch/btGhostObject.h"
 #include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
 
-#define MLCP_SOLVER
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+#include <pthread.h>
 
-#ifdef MLCP_SOLVER
+// Only defined by Bullet 2.88 and later
+class btConstraintSolverPoolMt;
 
-#include "BulletDynamics/MLCPSolvers/btDantzigSolver.h"
-#include "BulletDynamics/MLCPSolvers/btSolveProjectedGaussSeidel.h"
-#include "BulletDynamics/MLCPSolvers/btMLCPSolver.h"
+#if BT_BULLET_VERSION >= 288
+namespace
+{
+    pthread_mutex_t s_taskSchedulerMutex = PTHREAD_MUTEX_INITIALIZER;
 
-#endif //MLCP_SOLVER
+    /**
+     * Bullet's task scheduler is process-wide, so create it for the first
+     * multithreaded world and share it after that.
+     * @param[in] numThreads the threads to use, 0 for as many as allowed
+     * @throw std::runtime_error if Bullet has no task scheduler
+     */
+    void setUpTaskScheduler(int numThreads)
+    {
+        pthread_mutex_lock(&s_taskSchedulerMutex);
+        static btITaskScheduler* pScheduler = NULL;
+        if (pScheduler == NULL)
+        {
+            pScheduler = btCreateDefaultTaskScheduler();
+            if (pScheduler == NULL)
+            {
+                pthread_mutex_unlock(&s_taskSchedulerMutex);
+                throw std::runtime_error("Bullet was built without a task scheduler (BT_THREADSAFE)");
+            }
+            btSetTaskScheduler(pScheduler);
+        }
+        const int maxThreads = pScheduler->getMaxNumThreads();
+        pScheduler->setNumThreads(numThreads > 0 ? std::min(numThreads, maxThreads) : maxThreads);
+        pthread_mutex_unlock(&s_taskSchedulerMutex);
+    }
+}
+#endif
+
+namespace
+{
+    /**
+     * The near callback of world steps that skip collision detection. Pairs
+     * that already have a collision algorithm keep their contact manifolds
+     * as they are; only pairs the broadphase has just found are collided.
+     */
+    void keepContactsNearCallback(btBroadphasePair& collisionPair,
+                                  btCollisionDispatcher& dispatcher,
+                                  const btDispatcherInfo& dispatchInfo)
+    {
+        if (collisionPair.m_algorithm == NULL)
+        {
+            btCollisionDispatcher::defaultNearCallback(collisionPair, dispatcher, dispatchInfo);
+        }
+    }
+}
 
 /**
  * Helper class to bundle objects that have the same life cycle, so they can be
@@ -72,59 +144,194 @@
 class IntermediateBuildProducts
 {
     public:
-        IntermediateBuildProducts(double worldSize) : 
-            corner1 (-worldSize,-worldSize, -worldSize),
-            corner2 (worldSize, worldSize, worldSize),
-            dispatcher(&collisionConfiguration),
+        IntermediateBuildProducts(const tgWorld::Config& config) : 
+            halfExtents(config.worldSize, config.worldSize, config.worldSize),
+            maxBroadphaseHandles(config.maxBroadphaseHandles),
+            broadphaseCentre(0.0, 0.0, 0.0),
+            worldType(config.dynamicsWorldType),
+            broadphaseType(config.broadphaseType),
+            pDispatcher(NULL),
             ghostCallback(),
-#ifndef   MLCP_SOLVER       
-	#if (1) // More acc broadphase - remeber the comma (consider doing ifndef)
-				broadphase(corner1, corner2, 16384)
-	#endif // Broadphase
-#else
-			broadphase(corner1, corner2, 16384),
-			solver(&mlcp)
-#endif //MLCP_SOLVER  
-			
+            ghostFilter(),
+            pBroadphase(createBroadphase(config)),
+            pMLCP(NULL),
+            pSolver(NULL),
+            pSolverPool(NULL)
   {
-	  broadphase.getOverlappingPairCache()->setInternalGhostPairCallback(&ghostCallback);
-  }
-  const btVector3 corner1;
-  const btVector3 corner2;
-  btSoftBodyRigidBodyCollisionConfiguration collisionConfiguration;
-  btCollisionDispatcher dispatcher;
-  btGhostPairCallback ghostCallback;
-#if (0) // Default broadphase
-        btDbvtBroadphase broadphase;
+      if (worldType == tgWorld::Config::eRigidMultithreaded)
+      {
+#if BT_BULLET_VERSION >= 288
+          try
+          {
+              setUpTaskScheduler(config.numThreads);
+          }
+          catch (const std::runtime_error&)
+          {
+              delete pBroadphase;
+              throw;
+          }
+          pDispatcher = new btCollisionDispatcherMt(&collisionConfiguration);
+          // Each island is solved with sequential impulse by a solver from
+          // the pool; the Config constructor has checked solverType
+          pSolver = new btSequentialImpulseConstraintSolverMt();
+          pSolverPool = new btConstraintSolverPoolMt(btGetTaskScheduler()->getNumThreads());
+          pBroadphase->getOverlappingPairCache()->setInternalGhostPairCallback(&ghostCallback);
+          pBroadphase->getOverlappingPairCache()->setOverlapFilterCallback(&ghostFilter);
+          return;
 #else
-        // More accurate broadphase:
-        btAxisSweep3 broadphase;
+          delete pBroadphase;
+          throw std::invalid_argument("The multithreaded world needs Bullet 2.88 or later");
 #endif
-
-#ifdef MLCP_SOLVER
-		btDantzigSolver mlcp;
-        //btSolveProjectedGaussSeidel mlcp;
-		btMLCPSolver solver;
+      }
+      pDispatcher = new btCollisionDispatcher(&collisionConfiguration);
+      
+      switch (config.solverType)
+      {
+      case tgWorld::Config::eSequentialImpulse:
+          pSolver = new btSequentialImpulseConstraintSolver();
+          break;
+      case tgWorld::Config::eMLCPDantzig:
+          pMLCP = new btDantzigSolver();
+          pSolver = new btMLCPSolver(pMLCP);
+          break;
+      case tgWorld::Config::eMLCPProjectedGaussSeidel:
+          pMLCP = new btSolveProjectedGaussSeidel();
+          pSolver = new btMLCPSolver(pMLCP);
+          break;
+      case tgWorld::Config::eNNCG:
+#if BT_BULLET_VERSION >= 283
+          pSolver = new btNNCGConstraintSolver();
+          break;
 #else
-		btSequentialImpulseConstraintSolver solver;
+          delete pDispatcher;
+          delete pBroadphase;
+          throw std::invalid_argument("The NNCG solver needs Bullet 2.83 or later");
 #endif
-	
+      default:
+          delete pDispatcher;
+          delete pBroadphase;
+          throw std::invalid_argument("Unknown solver type");
+      }
+	  pBroadphase->getOverlappingPairCache()->setInternalGhostPairCallback(&ghostCallback);
+	  pBroadphase->getOverlappingPairCache()->setOverlapFilterCallback(&ghostFilter);
+  }
+  
+  ~IntermediateBuildProducts()
+  {
+#if BT_BULLET_VERSION >= 288
+      delete pSolverPool;
+#endif
+      delete pSolver;
+      delete pMLCP;
+      delete pBroadphase;
+      delete pDispatcher;
+  }
+  
+  const btVector3 halfExtents;
+  const int maxBroadphaseHandles;
+  /** Where the sweep is centred; moved by recentering */
+  btVector3 broadphaseCentre;
+  const tgWorld::Config::DynamicsWorldType worldType;
+  const tgWorld::Config::BroadphaseType broadphaseType;
+  btSoftBodyRigidBodyCollisionConfiguration collisionConfiguration;
+  /** A btCollisionDispatcherMt for the multithreaded world */
+  btCollisionDispatcher* pDispatcher;
+  btGhostPairCallback ghostCallback;
+  /** Keeps ghosts from pairing with the bodies their cables are anchored to */
+  tgGhostPairFilter ghostFilter;
+  /** Replaced when an eRecenteringAxisSweep broadphase is rebuilt */
+  btBroadphaseInterface* pBroadphase;
+  /** The inner solver of a btMLCPSolver, otherwise NULL */
+  btMLCPSolverInterface* pMLCP;
+  btConstraintSolver* pSolver;
+  /** The island solvers of the multithreaded world, otherwise NULL */
+  btConstraintSolverPoolMt* pSolverPool;
+  
+        /**
+         * Create a sweep and prune broadphase around broadphaseCentre,
+         * with the same ghost pair callback as the first one.
+         */
+        btBroadphaseInterface* createAxisSweep() const
+        {
+            const btVector3 corner1 = broadphaseCentre - halfExtents;
+            const btVector3 corner2 = broadphaseCentre + halfExtents;
+            // More accurate than the Dbvt broadphase
+            if (maxBroadphaseHandles <= 0xFFFE)
+            {
+                return new btAxisSweep3(corner1, corner2, maxBroadphaseHandles);
+            }
+            else
+            {
+                return new bt32BitAxisSweep3(corner1, corner2, maxBroadphaseHandles);
+            }
+        }
+    
+    private:
+        
+        btBroadphaseInterface* createBroadphase(const tgWorld::Config& config) const
+        {
+            switch (config.broadphaseType)
+            {
+            case tgWorld::Config::eDbvt:
+                return new btDbvtBroadphase();
+            case tgWorld::Config::eAxisSweep:
+            case tgWorld::Config::eRecenteringAxisSweep:
+                return createAxisSweep();
+            default:
+                throw std::invalid_argument("Unknown broadphase type");
+            }
+        }
+        
+        // Not copyable: owns the broadphase and solver
+        IntermediateBuildProducts(const IntermediateBuildProducts&);
+        IntermediateBuildProducts& operator=(const IntermediateBuildProducts&);
 };
 
 tgWorldBulletPhysicsImpl::tgWorldBulletPhysicsImpl(const tgWorld::Config& config,
         tgBulletGround* ground) :
     tgWorldImpl(config, ground),
-    m_pIntermediateBuildProducts(new IntermediateBuildProducts(config.worldSize)),
-    m_pDynamicsWorld(createDynamicsWorld())
+    m_pIntermediateBuildProducts(new IntermediateBuildProducts(config)),
+    m_pDynamicsWorld(createDynamicsWorld()),
+    m_pCableForceEngine(config.batchCableForces ?
+                        new tgBulletCableForceEngine(config.cableThreads) : NULL),
+    m_pCableCollision(config.cableCollisionCell > 0.0 ?
+                      new tgCableCollision(config.cableCollisionCell) : NULL),
+    m_pBodyArena(new tgRigidBodyArena()),
+    m_pGround(ground),
+    m_pGroundBody(NULL),
+    m_pTiledGround(tgCast::cast<tgBulletGround, tgTiledGround>(ground)),
+    m_staticBodyChanges(0),
+    m_collisionInterval(config.collisionInterval),
+    m_stepsSinceCollisionDetection(0),
+    m_recenterBroadphase(config.broadphaseType == tgWorld::Config::eRecenteringAxisSweep),
+    m_minSolverIterations(config.minSolverIterations),
+    m_maxSolverIterations(0),
+    m_penetrationTolerance(config.penetrationTolerance)
 {
 
     // Gravitational acceleration is down on the Y axis
     const btVector3 gravityVector(0, -config.gravity, 0);
     m_pDynamicsWorld->setGravity(gravityVector);
+    
+    if (m_pCableForceEngine)
+    {
+        m_pCableForceEngine->setWakeImpulse(config.cableWakeImpulse);
+    }
+    
+    if (config.solverIterations > 0)
+    {
+        m_pDynamicsWorld->getSolverInfo().m_numIterations = config.solverIterations;
+    }
+    // Adaptive iterations start at the most, for the first contacts
+    m_maxSolverIterations =
+        std::max(m_minSolverIterations, m_pDynamicsWorld->getSolverInfo().m_numIterations);
+    m_pDynamicsWorld->getSolverInfo().m_numIterations = m_maxSolverIterations;
 	
-	if (!tgCast::cast<tgBulletGround, tgEmptyGround>(ground) && ground != NULL)
+	if (!tgCast::cast<tgBulletGround, tgEmptyGround>(ground) && !m_pTiledGround &&
+	    ground != NULL)
 	{
-		m_pDynamicsWorld->addRigidBody(ground->getGroundRigidBody());
+		m_pGroundBody = ground->acquireRigidBody();
+		m_pDynamicsWorld->addRigidBody(m_pGroundBody);
 	}
 	
 	/*
@@ -153,6 +360,28 @@ tgWorldBulletPhysicsImpl::tgWorldBulletPhysicsImpl(const tgWorld::Config& config
 
 tgWorldBulletPhysicsImpl::~tgWorldBulletPhysicsImpl()
 {
+    // Unhook the bodies from the frame while they all still exist
+    m_rigidStates.clear();
+
+    // Any cables still registered go back to stepping themselves
+    delete m_pCableForceEngine;
+
+    // Contact cables are gone with their models
+    delete m_pCableCollision;
+
+    // The ground's body outlives us, so hand it back rather than delete it
+    if (m_pGroundBody)
+    {
+        m_pDynamicsWorld->removeRigidBody(m_pGroundBody);
+        m_pGround->releaseRigidBody(m_pGroundBody);
+    }
+
+    // So are a tiled ground's tiles
+    if (m_pTiledGround)
+    {
+        m_pTiledGround->leaveWorld(*m_pDynamicsWorld);
+    }
+    
     // Delete all the collision objects. The dynamics world must exist.
     // Delete in reverse order of creation.
     const size_t nco = m_pDynamicsWorld->getNumCollisionObjects();
@@ -161,10 +390,12 @@ tgWorldBulletPhysicsImpl::~tgWorldBulletPhysicsImpl()
     {
         btCollisionObject * const pCollisionObject = oa[i];
 
-        // If the collision object is a rigid body, delete its motion state
+        // If the collision object is a rigid body, delete its motion
+        // state, unless a frame's blocks hold it
         const btRigidBody* const pRigidBody =
             btRigidBody::upcast(pCollisionObject);
-        if (pRigidBody)
+        if (pRigidBody &&
+            !dynamic_cast<const tgRigidStateFrame::PoseMotionState*>(pRigidBody->getMotionState()))
         {
             delete pRigidBody->getMotionState();
         }
@@ -182,28 +413,50 @@ tgWorldBulletPhysicsImpl::~tgWorldBulletPhysicsImpl()
     
     for (size_t i = 0; i < ncs; ++i) { delete m_collisionShapes[i]; }
 
+    // Shared shapes may be in use by other worlds
+    for (int i = 0; i < m_sharedShapes.size(); ++i)
+    {
+        tgBulletShapeCache::release(m_sharedShapes[i]);
+    }
+
     delete m_pDynamicsWorld;
 
     // Delete the intermediate build products, which are now orphaned
     delete m_pIntermediateBuildProducts;
+
+    // Any bodies moved to other worlds keep it alive
+    m_pBodyArena->release();
 }
 
 /**
- * Create and return a new instance of a btSoftRigidDynamicsWorld.
- * @return a pointer to a new instance of a btSoftRigidDynamicsWorld
+ * Create and return a new instance of the configured dynamics world.
+ * @return a pointer to a new instance of a btSoftRigidDynamicsWorld,
+ * btDiscreteDynamicsWorld or btDiscreteDynamicsWorldMt
  */
 btDynamicsWorld* tgWorldBulletPhysicsImpl::createDynamicsWorld() const
 {    
-   
-  btSoftRigidDynamicsWorld* const result =
-    new btSoftRigidDynamicsWorld(&m_pIntermediateBuildProducts->dispatcher,
-                 &m_pIntermediateBuildProducts->broadphase,
-                 &m_pIntermediateBuildProducts->solver, 
-                 &m_pIntermediateBuildProducts->collisionConfiguration);
-#ifdef MLCPSOLVER	
-		result ->getSolverInfo().m_minimumSolverBatchSize = 1;//for direct solver it is better to have a small A matrix
-#endif	
-  return result;
+  IntermediateBuildProducts& products = *m_pIntermediateBuildProducts;
+  switch (products.worldType)
+  {
+  case tgWorld::Config::eRigid:
+    return new btDiscreteDynamicsWorld(products.pDispatcher,
+                 products.pBroadphase,
+                 products.pSolver,
+                 &products.collisionConfiguration);
+#if BT_BULLET_VERSION >= 288
+  case tgWorld::Config::eRigidMultithreaded:
+    return new btDiscreteDynamicsWorldMt(products.pDispatcher,
+                 products.pBroadphase,
+                 products.pSolverPool,
+                 products.pSolver,
+                 &products.collisionConfiguration);
+#endif
+  default:
+    return new btSoftRigidDynamicsWorld(products.pDispatcher,
+                 products.pBroadphase,
+                 products.pSolver, 
+                 &products.collisionConfiguration);
+  }
 }
 
 void tgWorldBulletPhysicsImpl::step(double dt)
@@ -214,12 +467,682 @@ void tgWorldBulletPhysicsImpl::step(double dt)
     const btScalar timeStep = dt;
     const int maxSubSteps = 1;
     const btScalar fixedTimeStep = dt;
+    
+    // Tiles around where the bodies are now, before they are collided
+    if (m_pTiledGround)
+    {
+        btVector3 centre(0.0, 0.0, 0.0);
+        movingBodiesCentre(centre);
+        if (m_pTiledGround->followBodies(*m_pDynamicsWorld, centre))
+        {
+            m_staticBodyChanges++;
+        }
+    }
+
+    // Forces from the cables as they were left by the last model step
+    if (m_pCableForceEngine)
+    {
+        m_pCableForceEngine->step(dt);
+    }
+    
+    if (m_collisionInterval > 1)
+    {
+        const bool detect = (m_stepsSinceCollisionDetection == 0);
+        if (++m_stepsSinceCollisionDetection == m_collisionInterval)
+        {
+            m_stepsSinceCollisionDetection = 0;
+        }
+        
+        btCollisionDispatcher* const pDispatcher =
+            m_pIntermediateBuildProducts->pDispatcher;
+        if (detect)
+        {
+            pDispatcher->setNearCallback(btCollisionDispatcher::defaultNearCallback);
+        }
+        else
+        {
+            // Move the existing contact points with their bodies, as the
+            // narrowphase would, and drop those that have separated
+            pDispatcher->setNearCallback(keepContactsNearCallback);
+            const int n = pDispatcher->getNumManifolds();
+            for (int i = 0; i < n; i++)
+            {
+                btPersistentManifold* const pManifold =
+                    pDispatcher->getManifoldByIndexInternal(i);
+                pManifold->refreshContactPoints(pManifold->getBody0()->getWorldTransform(),
+                                                pManifold->getBody1()->getWorldTransform());
+            }
+        }
+    }
+    
     m_pDynamicsWorld->stepSimulation(timeStep, maxSubSteps, fixedTimeStep);
 
+    adaptSolverIterations();
+
+    if (m_recenterBroadphase)
+    {
+        followMovingBodies();
+    }
+
+    m_rigidStates.publish(m_pDynamicsWorld->getCollisionObjectArray());
+
+    // The cables' next step reads the contacts of the bodies' new poses
+    if (m_pCableCollision)
+    {
+        m_pCableCollision->update(m_pDynamicsWorld->getCollisionObjectArray());
+    }
+
     // Postcondition
     assert(invariant());
 }
 
+double tgWorldBulletPhysicsImpl::deepestPenetration() const
+{
+    btDispatcher* const pDispatcher = m_pDynamicsWorld->getDispatcher();
+    const int n = pDispatcher->getNumManifolds();
+    btScalar deepest = 0.0;
+    for (int i = 0; i < n; i++)
+    {
+        const btPersistentManifold* const pManifold =
+            pDispatcher->getManifoldByIndexInternal(i);
+        const int points = pManifold->getNumContacts();
+        for (int j = 0; j < points; j++)
+        {
+            deepest = std::min(deepest, pManifold->getContactPoint(j).getDistance());
+        }
+    }
+    return -deepest;
+}
+
+void tgWorldBulletPhysicsImpl::adaptSolverIterations()
+{
+    btContactSolverInfo& info = m_pDynamicsWorld->getSolverInfo();
+    const int used = info.m_numIterations;
+    const double penetration = deepestPenetration();
+
+    SolverIterationStats& stats = m_solverIterationStats;
+    if (stats.steps == 0 || used < stats.fewestIterations)
+    {
+        stats.fewestIterations = used;
+    }
+    stats.mostIterations = std::max(stats.mostIterations, used);
+    stats.steps++;
+    stats.iterations += used;
+    stats.maxPenetration = std::max(stats.maxPenetration, penetration);
+    stats.totalPenetration += penetration;
+
+    if (m_minSolverIterations > 0)
+    {
+        // Double at once for an impact, come down slowly once it is
+        // resolved, and hold in between
+        if (penetration > m_penetrationTolerance)
+        {
+            info.m_numIterations = std::min(m_maxSolverIterations, 2 * used);
+        }
+        else if (penetration < 0.5 * m_penetrationTolerance)
+        {
+            info.m_numIterations = std::max(m_minSolverIterations, used - 1);
+        }
+    }
+}
+
+bool tgWorldBulletPhysicsImpl::movingBodiesCentre(btVector3& centre) const
+{
+    const btCollisionObjectArray& oa = m_pDynamicsWorld->getCollisionObjectArray();
+    const int n = oa.size();
+
+    // The bounds of everything that moves, as the last step left them in
+    // the broadphase
+    btVector3 aabbMin(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+    btVector3 aabbMax(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+    bool moving = false;
+    for (int i = 0; i < n; i++)
+    {
+        const btCollisionObject* const pObject = oa[i];
+        const btBroadphaseProxy* const pProxy = pObject->getBroadphaseHandle();
+        if (pProxy && !pObject->isStaticObject())
+        {
+            aabbMin.setMin(pProxy->m_aabbMin);
+            aabbMax.setMax(pProxy->m_aabbMax);
+            moving = true;
+        }
+    }
+    if (moving)
+    {
+        centre = (aabbMin + aabbMax) * btScalar(0.5);
+    }
+    return moving;
+}
+
+void tgWorldBulletPhysicsImpl::followMovingBodies()
+{
+    IntermediateBuildProducts& products = *m_pIntermediateBuildProducts;
+
+    // Static bodies such as the ground are clamped to the sweep wherever
+    // it is
+    btVector3 centre;
+    if (!movingBodiesCentre(centre))
+    {
+        return;
+    }
+    const btVector3 drift = (centre - products.broadphaseCentre).absolute();
+    const btVector3 limit = products.halfExtents * btScalar(0.5);
+    if (drift.x() <= limit.x() && drift.y() <= limit.y() && drift.z() <= limit.z())
+    {
+        return;
+    }
+
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgWorldBulletPhysicsImpl::followMovingBodies");
+#endif //BT_NO_PROFILE
+
+    products.broadphaseCentre = centre;
+    rebuildAxisSweep();
+}
+
+void tgWorldBulletPhysicsImpl::rebuildAxisSweep()
+{
+    IntermediateBuildProducts& products = *m_pIntermediateBuildProducts;
+
+    // The object and rigid body arrays keep their order
+    std::vector<FilteredObject> objects;
+    removeCollisionObjects(objects);
+
+    btBroadphaseInterface* const pBroadphase = products.createAxisSweep();
+    pBroadphase->getOverlappingPairCache()->setInternalGhostPairCallback(&products.ghostCallback);
+    pBroadphase->getOverlappingPairCache()->setOverlapFilterCallback(&products.ghostFilter);
+    m_pDynamicsWorld->setBroadphase(pBroadphase);
+    delete products.pBroadphase;
+    products.pBroadphase = pBroadphase;
+
+    addCollisionObjects(objects);
+}
+
+void tgWorldBulletPhysicsImpl::updateRestoredAabbs(int moved)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgWorldBulletPhysicsImpl::updateRestoredAabbs");
+#endif //BT_NO_PROFILE
+
+    btCollisionObjectArray& oa = m_pDynamicsWorld->getCollisionObjectArray();
+    const int n = oa.size();
+
+    // A robot jumping back to its start would have each of its proxies
+    // sorted past every edge on the way, adding and removing pairs as
+    // it went. Beyond a quarter of the proxies, sorting them all again
+    // from scratch is cheaper.
+    if (m_pIntermediateBuildProducts->broadphaseType != tgWorld::Config::eDbvt &&
+        moved > 0 && 4 * moved >= n)
+    {
+        rebuildAxisSweep();
+        return;
+    }
+
+    // Unlike btCollisionWorld::updateAabbs, sleeping bodies and ghosts
+    // are updated too; proxies that have not moved are left alone
+    for (int i = 0; i < n; i++)
+    {
+        btCollisionObject* const pObject = oa[i];
+        if (!pObject->isStaticObject() && pObject->getBroadphaseHandle())
+        {
+            m_pDynamicsWorld->updateSingleAabb(pObject);
+        }
+    }
+}
+
+void tgWorldBulletPhysicsImpl::removeCollisionObjects(std::vector<FilteredObject>& objects)
+{
+    btCollisionObjectArray& oa = m_pDynamicsWorld->getCollisionObjectArray();
+    const int n = oa.size();
+
+    // From the back, since Bullet removes by swapping in the last object
+    objects.resize(n);
+    for (int i = n - 1; i >= 0; i--)
+    {
+        FilteredObject& object = objects[i];
+        object.pObject = oa[i];
+        const btBroadphaseProxy* const pProxy = object.pObject->getBroadphaseHandle();
+        object.group = pProxy ? pProxy->m_collisionFilterGroup : btBroadphaseProxy::DefaultFilter;
+        object.mask = pProxy ? pProxy->m_collisionFilterMask : btBroadphaseProxy::AllFilter;
+        m_pDynamicsWorld->removeCollisionObject(object.pObject);
+    }
+    assert(m_pDynamicsWorld->getNumCollisionObjects() == 0);
+}
+
+void tgWorldBulletPhysicsImpl::addCollisionObjects(const std::vector<FilteredObject>& objects)
+{
+    btSoftRigidDynamicsWorld* const pSoftWorld =
+        m_pIntermediateBuildProducts->worldType == tgWorld::Config::eSoftRigid ?
+        static_cast<btSoftRigidDynamicsWorld*>(m_pDynamicsWorld) : NULL;
+    for (std::size_t i = 0; i < objects.size(); i++)
+    {
+        const FilteredObject& object = objects[i];
+        btRigidBody* const pBody = btRigidBody::upcast(object.pObject);
+        btSoftBody* const pSoftBody = btSoftBody::upcast(object.pObject);
+        if (pBody)
+        {
+            m_pDynamicsWorld->addRigidBody(pBody, object.group, object.mask);
+        }
+        else if (pSoftBody && pSoftWorld)
+        {
+            pSoftWorld->addSoftBody(pSoftBody, object.group, object.mask);
+        }
+        else
+        {
+            m_pDynamicsWorld->addCollisionObject(object.pObject, object.group, object.mask);
+        }
+    }
+}
+
+namespace
+{
+    /** Orders a batch of bodies by the lower bounds of their AABBs along x */
+    struct LowerXOrder
+    {
+        explicit LowerXOrder(const std::vector<btScalar>& lowerX) :
+            m_lowerX(lowerX)
+        {
+        }
+
+        bool operator()(std::size_t a, std::size_t b) const
+        {
+            return m_lowerX[a] < m_lowerX[b];
+        }
+
+        const std::vector<btScalar>& m_lowerX;
+    };
+}
+
+void tgWorldBulletPhysicsImpl::addRigidBodies(const std::vector<FilteredObject>& bodies)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgWorldBulletPhysicsImpl::addRigidBodies");
+#endif //BT_NO_PROFILE
+
+    std::vector<std::size_t> order(bodies.size());
+    for (std::size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    if (m_pIntermediateBuildProducts->broadphaseType != tgWorld::Config::eDbvt)
+    {
+        std::vector<btScalar> lowerX(bodies.size());
+        for (std::size_t i = 0; i < bodies.size(); i++)
+        {
+            const btCollisionObject* const pObject = bodies[i].pObject;
+            btVector3 aabbMin;
+            btVector3 aabbMax;
+            pObject->getCollisionShape()->getAabb(pObject->getWorldTransform(),
+                                                  aabbMin, aabbMax);
+            lowerX[i] = aabbMin.x();
+        }
+        // Stable, so equal bounds keep the build order
+        std::stable_sort(order.begin(), order.end(), LowerXOrder(lowerX));
+    }
+
+    for (std::size_t i = 0; i < order.size(); i++)
+    {
+        const FilteredObject& body = bodies[order[i]];
+        btRigidBody* const pBody = btRigidBody::upcast(body.pObject);
+        assert(pBody != NULL);
+        m_pDynamicsWorld->addRigidBody(pBody, body.group, body.mask);
+    }
+}
+
+void tgWorldBulletPhysicsImpl::swapGround(tgGround* newGround)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgWorldBulletPhysicsImpl::swapGround");
+#endif //BT_NO_PROFILE
+
+    // Everything comes out and goes back in order, the new ground's
+    // body where the old one's was, so the models' bodies keep their
+    // places in the arrays and their snapshots stay valid
+    std::vector<FilteredObject> objects;
+    removeCollisionObjects(objects);
+    if (m_pTiledGround)
+    {
+        // Not in the world's arrays any more, so just let go of them
+        m_pTiledGround->leaveWorld(*m_pDynamicsWorld);
+        m_staticBodyChanges++;
+    }
+
+    std::vector<FilteredObject>::iterator groundSlot = objects.begin();
+    if (m_pGroundBody)
+    {
+        for (groundSlot = objects.begin(); groundSlot != objects.end(); ++groundSlot)
+        {
+            if (groundSlot->pObject == m_pGroundBody)
+            {
+                break;
+            }
+        }
+        assert(groundSlot != objects.end());
+        groundSlot = objects.erase(groundSlot);
+        m_pGround->releaseRigidBody(m_pGroundBody);
+        m_pGroundBody = NULL;
+        m_staticBodyChanges++;
+    }
+
+    tgBulletGround* const ground = static_cast<tgBulletGround*>(newGround);
+    m_pGround = ground;
+    m_pTiledGround = tgCast::cast<tgBulletGround, tgTiledGround>(ground);
+    if (!tgCast::cast<tgBulletGround, tgEmptyGround>(ground) && !m_pTiledGround &&
+        ground != NULL)
+    {
+        m_pGroundBody = ground->acquireRigidBody();
+        FilteredObject groundObject;
+        groundObject.pObject = m_pGroundBody;
+        groundObject.group = btBroadphaseProxy::StaticFilter;
+        groundObject.mask = btBroadphaseProxy::AllFilter ^ btBroadphaseProxy::StaticFilter;
+        objects.insert(groundSlot, groundObject);
+        m_staticBodyChanges++;
+    }
+
+    addCollisionObjects(objects);
+    // A tiled ground loads its tiles on the next step
+
+    // Contacts with the old ground are gone
+    m_pDynamicsWorld->getConstraintSolver()->reset();
+    m_rigidStates.publish(m_pDynamicsWorld->getCollisionObjectArray());
+
+    // Postcondition
+    assert(invariant());
+}
+
+tgGhostPairFilter& tgWorldBulletPhysicsImpl::ghostPairFilter() const
+{
+    return m_pIntermediateBuildProducts->ghostFilter;
+}
+
+const tgContactFrame& tgWorldBulletPhysicsImpl::contacts() const
+{
+    if (m_contacts.getBuiltFrameCount() != m_rigidStates.getFrameCount())
+    {
+        m_contacts.build(*m_pDynamicsWorld->getDispatcher(), m_rigidStates);
+    }
+    return m_contacts;
+}
+
+void tgWorldBulletPhysicsImpl::snapshot(tgWorldSnapshot& snapshot) const
+{
+    const btCollisionObjectArray& oa = m_pDynamicsWorld->getCollisionObjectArray();
+    const int n = oa.size();
+
+    // Static bodies never move, and the ground's may be swapped
+    snapshot.numCollisionObjects = 0;
+    snapshot.bodies.clear();
+    for (int i = 0; i < n; i++)
+    {
+        if (oa[i]->isStaticObject())
+        {
+            continue;
+        }
+        snapshot.numCollisionObjects++;
+        btRigidBody* const pBody = btRigidBody::upcast(oa[i]);
+        if (pBody)
+        {
+            tgWorldSnapshot::BodyState state;
+            state.pBody = pBody;
+            state.worldTransform = pBody->getWorldTransform();
+            state.linearVelocity = pBody->getLinearVelocity();
+            state.angularVelocity = pBody->getAngularVelocity();
+            state.activationState = pBody->getActivationState();
+            state.deactivationTime = pBody->getDeactivationTime();
+            snapshot.bodies.push_back(state);
+        }
+    }
+
+    snapshotContacts(snapshot);
+}
+
+void tgWorldBulletPhysicsImpl::snapshotContacts(tgWorldSnapshot& snapshot) const
+{
+    const btCollisionObjectArray& oa = m_pDynamicsWorld->getCollisionObjectArray();
+    const int n = oa.size();
+    m_objectIndex.resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        m_objectIndex[i] = std::make_pair(static_cast<const btCollisionObject*>(oa[i]), i);
+    }
+    std::sort(m_objectIndex.begin(), m_objectIndex.end());
+
+    btDispatcher* const pDispatcher = m_pDynamicsWorld->getDispatcher();
+    const int nManifolds = pDispatcher->getNumManifolds();
+    snapshot.manifolds.clear();
+    snapshot.contactPoints.clear();
+    for (int i = 0; i < nManifolds; i++)
+    {
+        const btPersistentManifold* const pManifold =
+            pDispatcher->getManifoldByIndexInternal(i);
+        tgWorldSnapshot::ManifoldState state;
+        const btCollisionObject* const objects[2] =
+            { pManifold->getBody0(), pManifold->getBody1() };
+        int indices[2];
+        for (int j = 0; j < 2; j++)
+        {
+            std::vector< std::pair<const btCollisionObject*, int> >::const_iterator it =
+                std::lower_bound(m_objectIndex.begin(), m_objectIndex.end(),
+                                 std::make_pair(objects[j], 0));
+            // Every manifold is between objects in the world
+            assert(it != m_objectIndex.end() && it->first == objects[j]);
+            indices[j] = it->second;
+        }
+        state.object0 = indices[0];
+        state.object1 = indices[1];
+        state.firstPoint = snapshot.contactPoints.size();
+        state.numPoints = pManifold->getNumContacts();
+        for (int j = 0; j < state.numPoints; j++)
+        {
+            btManifoldPoint point = pManifold->getContactPoint(j);
+            point.m_userPersistentData = NULL;
+            snapshot.contactPoints.push_back(point);
+        }
+        snapshot.manifolds.push_back(state);
+    }
+
+    snapshot.staticBodyChanges = m_staticBodyChanges;
+    snapshot.solverIterations = m_pDynamicsWorld->getSolverInfo().m_numIterations;
+    snapshot.stepsSinceCollisionDetection = m_stepsSinceCollisionDetection;
+    // The multithreaded world's island solvers each have their own seed
+    snapshot.solverSeed =
+        m_pIntermediateBuildProducts->worldType == tgWorld::Config::eRigidMultithreaded ? 0 :
+        static_cast<btSequentialImpulseConstraintSolver*>(
+            m_pIntermediateBuildProducts->pSolver)->getRandSeed();
+}
+
+void tgWorldBulletPhysicsImpl::restore(const tgWorldSnapshot& snapshot)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgWorldBulletPhysicsImpl::restore");
+#endif //BT_NO_PROFILE
+
+    btCollisionObjectArray& oa = m_pDynamicsWorld->getCollisionObjectArray();
+    const int n = oa.size();
+
+    std::size_t k = 0;
+    int moving = 0;
+    int moved = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (oa[i]->isStaticObject())
+        {
+            continue;
+        }
+        moving++;
+        btRigidBody* const pBody = btRigidBody::upcast(oa[i]);
+        if (!pBody)
+        {
+            continue;
+        }
+        else if (k == snapshot.bodies.size() || snapshot.bodies[k].pBody != pBody)
+        {
+            throw std::invalid_argument("Snapshot was taken from a different world");
+        }
+
+        const tgWorldSnapshot::BodyState& state = snapshot.bodies[k++];
+        if (!(pBody->getWorldTransform() == state.worldTransform))
+        {
+            moved++;
+        }
+        pBody->setWorldTransform(state.worldTransform);
+        pBody->setInterpolationWorldTransform(state.worldTransform);
+        pBody->setLinearVelocity(state.linearVelocity);
+        pBody->setAngularVelocity(state.angularVelocity);
+        pBody->setInterpolationLinearVelocity(state.linearVelocity);
+        pBody->setInterpolationAngularVelocity(state.angularVelocity);
+        pBody->clearForces();
+        if (pBody->getMotionState())
+        {
+            pBody->getMotionState()->setWorldTransform(state.worldTransform);
+        }
+        pBody->forceActivationState(state.activationState);
+        pBody->setDeactivationTime(state.deactivationTime);
+    }
+    if (k != snapshot.bodies.size() || moving != snapshot.numCollisionObjects)
+    {
+        throw std::invalid_argument("Snapshot was taken from a different world");
+    }
+
+    updateRestoredAabbs(moved);
+    m_pDynamicsWorld->getConstraintSolver()->reset();
+    restoreContacts(snapshot);
+    if (m_minSolverIterations > 0 &&
+        snapshot.solverIterations >= m_minSolverIterations &&
+        snapshot.solverIterations <= m_maxSolverIterations)
+    {
+        m_pDynamicsWorld->getSolverInfo().m_numIterations = snapshot.solverIterations;
+    }
+
+    // Readers would otherwise see the pose from before the restore
+    m_rigidStates.publish(oa);
+
+    // Postcondition
+    assert(invariant());
+}
+
+bool tgWorldBulletPhysicsImpl::ManifoldKey::operator<(const ManifoldKey& other) const
+{
+    if (pObject0 != other.pObject0) return pObject0 < other.pObject0;
+    if (pObject1 != other.pObject1) return pObject1 < other.pObject1;
+    return index < other.index;
+}
+
+void tgWorldBulletPhysicsImpl::restoreContacts(const tgWorldSnapshot& snapshot)
+{
+    btCollisionObjectArray& oa = m_pDynamicsWorld->getCollisionObjectArray();
+    btDispatcher* const pDispatcher = m_pDynamicsWorld->getDispatcher();
+
+    // Tiles may have come and gone, so the indices may name other objects
+    const bool sameObjects = (snapshot.staticBodyChanges == m_staticBodyChanges);
+    if (sameObjects)
+    {
+        for (std::size_t i = 0; i < snapshot.manifolds.size(); i++)
+        {
+            const tgWorldSnapshot::ManifoldState& state = snapshot.manifolds[i];
+            if (state.object0 < 0 || state.object0 >= oa.size() ||
+                state.object1 < 0 || state.object1 >= oa.size() ||
+                state.numPoints < 0 || state.numPoints > MANIFOLD_CACHE_SIZE ||
+                state.firstPoint + state.numPoints > snapshot.contactPoints.size())
+            {
+                throw std::invalid_argument("Snapshot was taken from a different world");
+            }
+        }
+        if (snapshot.stepsSinceCollisionDetection >= 0 &&
+            snapshot.stepsSinceCollisionDetection < m_collisionInterval)
+        {
+            m_stepsSinceCollisionDetection = snapshot.stepsSinceCollisionDetection;
+        }
+        if (m_pIntermediateBuildProducts->worldType != tgWorld::Config::eRigidMultithreaded)
+        {
+            static_cast<btSequentialImpulseConstraintSolver*>(
+                m_pIntermediateBuildProducts->pSolver)->setRandSeed(snapshot.solverSeed);
+        }
+    }
+
+    if (!sameObjects || snapshot.manifolds.empty())
+    {
+        // Contacts from the old pose would push the bodies apart next step
+        for (int i = 0; i < pDispatcher->getNumManifolds(); i++)
+        {
+            pDispatcher->getManifoldByIndexInternal(i)->clearManifold();
+        }
+        return;
+    }
+
+    // Give every pair that overlaps in the restored pose its algorithm
+    // and manifold; their points are replaced below
+    btCollisionDispatcher* const pCollisionDispatcher =
+        m_pIntermediateBuildProducts->pDispatcher;
+    pCollisionDispatcher->setNearCallback(btCollisionDispatcher::defaultNearCallback);
+    m_pDynamicsWorld->performDiscreteCollisionDetection();
+
+    const int n = pDispatcher->getNumManifolds();
+    m_manifoldKeys.resize(n);
+    m_manifoldRestored.assign(n, 0);
+    for (int i = 0; i < n; i++)
+    {
+        const btPersistentManifold* const pManifold =
+            pDispatcher->getManifoldByIndexInternal(i);
+        m_manifoldKeys[i].pObject0 = pManifold->getBody0();
+        m_manifoldKeys[i].pObject1 = pManifold->getBody1();
+        m_manifoldKeys[i].index = i;
+    }
+    std::sort(m_manifoldKeys.begin(), m_manifoldKeys.end());
+
+    // Put the recorded manifolds first, in their recorded order, so the
+    // islands are solved in the same order as before
+    btPersistentManifold** const ppManifolds = pDispatcher->getInternalManifoldPointer();
+    m_manifoldOrder.clear();
+    for (std::size_t i = 0; i < snapshot.manifolds.size(); i++)
+    {
+        const tgWorldSnapshot::ManifoldState& state = snapshot.manifolds[i];
+        ManifoldKey key;
+        key.pObject0 = oa[state.object0];
+        key.pObject1 = oa[state.object1];
+        key.index = -1;
+        // Compounds have a manifold per pair of children; take them in order
+        std::vector<ManifoldKey>::const_iterator it =
+            std::lower_bound(m_manifoldKeys.begin(), m_manifoldKeys.end(), key);
+        while (it != m_manifoldKeys.end() &&
+               it->pObject0 == key.pObject0 && it->pObject1 == key.pObject1 &&
+               m_manifoldRestored[it->index])
+        {
+            ++it;
+        }
+        if (it == m_manifoldKeys.end() ||
+            it->pObject0 != key.pObject0 || it->pObject1 != key.pObject1)
+        {
+            // No longer overlapping; the broadphase will find it again
+            continue;
+        }
+        m_manifoldRestored[it->index] = 1;
+
+        btPersistentManifold* const pManifold = ppManifolds[it->index];
+        pManifold->clearManifold();
+        for (int j = 0; j < state.numPoints; j++)
+        {
+            pManifold->addManifoldPoint(snapshot.contactPoints[state.firstPoint + j]);
+        }
+        m_manifoldOrder.push_back(pManifold);
+    }
+
+    // The rest were not there when the snapshot was taken
+    for (int i = 0; i < n; i++)
+    {
+        if (!m_manifoldRestored[i])
+        {
+            ppManifolds[i]->clearManifold();
+            m_manifoldOrder.push_back(ppManifolds[i]);
+        }
+    }
+    for (int i = 0; i < n; i++)
+    {
+        ppManifolds[i] = m_manifoldOrder[i];
+        ppManifolds[i]->m_index1a = i;
+    }
+}
+
 void tgWorldBulletPhysicsImpl::addCollisionShape(btCollisionShape* pShape)
 {
 #ifndef BT_NO_PROFILE 
@@ -243,6 +1166,12 @@ void tgWorldBulletPhysicsImpl::deleteCollisionShape(btCollisionShape* pShape)
 	
     if (pShape)
     {
+		if (m_sharedShapes.findLinearSearch(pShape) < m_sharedShapes.size())
+		{
+			m_sharedShapes.remove(pShape);
+			tgBulletShapeCache::release(pShape);
+			return;
+		}
 		btCompoundShape* cShape = tgCast::cast<btCollisionShape, btCompoundShape>(pShape);
 		if (cShape)
 		{
@@ -260,6 +1189,27 @@ void tgWorldBulletPhysicsImpl::deleteCollisionShape(btCollisionShape* pShape)
       assert(invariant());
 }
 
+btCollisionShape* tgWorldBulletPhysicsImpl::sharedCylinderShape(const btVector3& halfExtents)
+{
+    btCollisionShape* const pShape = tgBulletShapeCache::acquireCylinder(halfExtents);
+    m_sharedShapes.push_back(pShape);
+    return pShape;
+}
+
+btCollisionShape* tgWorldBulletPhysicsImpl::sharedBoxShape(const btVector3& halfExtents)
+{
+    btCollisionShape* const pShape = tgBulletShapeCache::acquireBox(halfExtents);
+    m_sharedShapes.push_back(pShape);
+    return pShape;
+}
+
+btCollisionShape* tgWorldBulletPhysicsImpl::sharedSphereShape(double radius)
+{
+    btCollisionShape* const pShape = tgBulletShapeCache::acquireSphere(radius);
+    m_sharedShapes.push_back(pShape);
+    return pShape;
+}
+
 bool tgWorldBulletPhysicsImpl::invariant() const
 {
     return (m_pDynamicsWorld != 0);
@@ -30,20 +30,33 @@
 // This application
 #include "tgWorld.h"
 #include "tgWorldImpl.h"
+#include "tgRigidStateFrame.h"
+#include "tgContactFrame.h"
 #include "LinearMath/btAlignedObjectArray.h"
+// The C++ Standard Library
+#include <utility>
+#include <vector>
 
 
 
 // Forward declarations
+class btCollisionObject;
+class btPersistentManifold;
 class btCollisionShape;
 class btTypedConstraint;
 class btDynamicsWorld;
 class btRigidBody;
+class btVector3;
 class IntermediateBuildProducts;
 class btBroadphaseInterface;
 class btDispatcher;
 class tgBulletGround;
+class tgRigidBodyArena;
 class tgHillyGround;
+class tgTiledGround;
+class tgBulletCableForceEngine;
+class tgCableCollision;
+class tgGhostPairFilter;
 
 /**
  * Concrete class derived from tgWorldImpl for Bullet Physics
@@ -72,6 +85,45 @@ class tgWorldBulletPhysicsImpl : public tgWorldImpl
    * must be positive
    */
   virtual void step(double dt);
+  
+  /**
+   * Record the transform, velocities and activation state of every
+   * rigid body in the dynamics world, and the contact manifolds with
+   * their accumulated impulses.
+   * @param[out] snapshot overwritten with the current state
+   */
+  virtual void snapshot(tgWorldSnapshot& snapshot) const;
+  
+  /**
+   * Put every rigid body back to the recorded state, and its contact
+   * manifolds back in the dispatcher's order with the recorded points,
+   * so the solver is warm started as it was. Contacts that were not
+   * recorded are dropped.
+   * @param[in] snapshot taken from this world since it was last reset
+   * @throw std::invalid_argument if bodies were added or removed since
+   */
+  virtual void restore(const tgWorldSnapshot& snapshot);
+
+  /**
+   * The state of every rigid body, published after each step and
+   * restore.
+   */
+  virtual const tgRigidStateFrame& rigidStates() const
+  {
+    return m_rigidStates;
+  }
+
+  /** The frame, to make motion states for this world's bodies */
+  tgRigidStateFrame& rigidStates()
+  {
+    return m_rigidStates;
+  }
+
+  /**
+   * The contacts on every rigid body, summarized the first time they
+   * are asked for after each step.
+   */
+  virtual const tgContactFrame& contacts() const;
 
   /**
    * Return a reference to the dynamics world.
@@ -82,6 +134,135 @@ class tgWorldBulletPhysicsImpl : public tgWorldImpl
     return *m_pDynamicsWorld;
   }
   
+  /**
+   * Put a new ground in place of the current one, leaving every other
+   * collision object where it is in the world, so the models and their
+   * snapshots are untouched. The old ground's body is handed back to it.
+   * @param[in] ground the new ground, a tgBulletGround; may be NULL for
+   * none
+   */
+  virtual void swapGround(tgGround* ground);
+
+  /**
+   * Return the ground this world was built with, or last swapped in.
+   * @return a pointer to the ground; may be NULL
+   */
+  tgBulletGround* ground() const
+  {
+    return m_pGround;
+  }
+
+  /**
+   * Return the ground's body in this world.
+   * @return a pointer to the body, or NULL if the ground has none, e.g.
+   * a tgEmptyGround or tgTiledGround
+   */
+  btRigidBody* groundBody() const
+  {
+    return m_pGroundBody;
+  }
+
+  /**
+   * Count the times static bodies have been added to or removed from
+   * the world since it was built, e.g. as a tgTiledGround streams its
+   * tiles, for readers that cache them.
+   */
+  unsigned long staticBodyChanges() const
+  {
+    return m_staticBodyChanges;
+  }
+
+  /**
+   * Return the engine that batches cable forces.
+   * @return a pointer to the engine, or NULL if
+   * tgWorld::Config::batchCableForces was not set
+   */
+  tgBulletCableForceEngine* cableForceEngine() const
+  {
+    return m_pCableForceEngine;
+  }
+
+  /**
+   * Return the capsule collision of contact cables.
+   * @return a pointer to it, or NULL if
+   * tgWorld::Config::cableCollisionCell was zero
+   */
+  tgCableCollision* cableCollision() const
+  {
+    return m_pCableCollision;
+  }
+
+  /** The arena the models' rigid bodies are made in */
+  tgRigidBodyArena& bodyArena() const
+  {
+    return *m_pBodyArena;
+  }
+
+  /**
+   * Return the broadphase filter, where contact cables register the
+   * bodies their ghosts should not be paired with.
+   * @return the filter, owned by the world
+   */
+  tgGhostPairFilter& ghostPairFilter() const;
+
+  /** A collision object and the filter it is in the world with */
+  struct FilteredObject
+  {
+    btCollisionObject* pObject;
+    int group;
+    int mask;
+  };
+
+  /**
+   * Add newly built rigid bodies in one batch, each with its filter.
+   * With an axis sweep broadphase they go in in order of the lower
+   * bounds of their AABBs along x, so each new proxy lands at the end of
+   * that axis rather than being swapped past the others one at a time.
+   * The bodies therefore join the world's object array in that order.
+   * @param[in] bodies whose pObject are btRigidBody not yet in a world
+   */
+  void addRigidBodies(const std::vector<FilteredObject>& bodies);
+
+  /** The solver iterations used, for telemetry */
+  struct SolverIterationStats
+  {
+    SolverIterationStats() :
+      steps(0),
+      iterations(0),
+      fewestIterations(0),
+      mostIterations(0),
+      maxPenetration(0.0),
+      totalPenetration(0.0)
+    { }
+
+    /** Steps since the world was built or the stats were cleared */
+    unsigned long steps;
+    /** Iterations over all those steps */
+    unsigned long long iterations;
+    int fewestIterations;
+    int mostIterations;
+    /** The deepest contact after any step */
+    double maxPenetration;
+    /** The deepest contact after each step, summed over the steps */
+    double totalPenetration;
+  };
+
+  /**
+   * The solver iterations per step and how deep the contacts were,
+   * whether or not tgWorld::Config::minSolverIterations makes them
+   * adaptive, so a fixed count can be compared with an adaptive one.
+   */
+  const SolverIterationStats& solverIterationStats() const
+  {
+    return m_solverIterationStats;
+  }
+
+  /** Start counting solverIterationStats again */
+  void clearSolverIterationStats()
+  {
+    m_solverIterationStats = SolverIterationStats();
+  }
+  
 	/**
 	 * Add a btCollisionShape the a collection for deletion upon
 	 * destruction.
@@ -91,9 +272,30 @@ class tgWorldBulletPhysicsImpl : public tgWorldImpl
 	
 	/**
 	 * Immediately delete a collision shape to avoid leaking memory during a rial
-	 * @param[in] pShape a pointer to a btCollisionShape; do nothing if NULL
+	 * @param[in] pShape a pointer to a btCollisionShape; do nothing if NULL.
+	 * A shared shape is given back to tgBulletShapeCache instead.
 	 */
 	void deleteCollisionShape(btCollisionShape* pShape);
+
+	/**
+	 * Get a btCylinderShape from tgBulletShapeCache, shared with every
+	 * rigid of the same dimensions in this and other worlds. The reference
+	 * is given back on destruction. The shape must not be changed.
+	 * @param[in] halfExtents as for the btCylinderShape constructor
+	 */
+	btCollisionShape* sharedCylinderShape(const btVector3& halfExtents);
+
+	/**
+	 * Get a shared btBoxShape, as for sharedCylinderShape.
+	 * @param[in] halfExtents as for the btBoxShape constructor
+	 */
+	btCollisionShape* sharedBoxShape(const btVector3& halfExtents);
+
+	/**
+	 * Get a shared btSphereShape, as for sharedCylinderShape.
+	 * @param[in] radius as for the btSphereShape constructor
+	 */
+	btCollisionShape* sharedSphereShape(double radius);
 	
         /**
      * Add a btTypedConstraint to a collection for deletion upon
@@ -118,16 +320,73 @@ private:
         /**
      * Create a new dynamics world. Needs to be in the namespace so we
      * can free the pointers it creates.
-     * @return the newly-created btSoftRigidDynamicsWorld
+     * @return the newly-created dynamics world, of the type chosen by
+     * tgWorld::Config::dynamicsWorldType
      */
         btDynamicsWorld* createDynamicsWorld() const;
+
+    /**
+     * Take every collision object out of the world.
+     * @param[out] objects the objects in the world's order
+     */
+    void removeCollisionObjects(std::vector<FilteredObject>& objects);
+
+    /** Put collision objects into the world in order */
+    void addCollisionObjects(const std::vector<FilteredObject>& objects);
+
+    /**
+     * Find the centre of the bounds of the bodies that are not static.
+     * @param[out] centre unchanged if there are none
+     * @return false if there are none
+     */
+    bool movingBodiesCentre(btVector3& centre) const;
+
+    /**
+     * Rebuild an eRecenteringAxisSweep broadphase around the moving
+     * bodies once they have drifted too far from its centre.
+     */
+    void followMovingBodies();
+
+    /**
+     * Replace an axis sweep broadphase with a new one around
+     * broadphaseCentre, putting every collision object back in order.
+     */
+    void rebuildAxisSweep();
+
+    /**
+     * Bring the broadphase up to date after restore has moved bodies,
+     * sleeping ones included, in one pass over the collision objects.
+     * If a large share of an axis sweep's proxies moved, it is rebuilt
+     * instead of sorting each proxy to its new place.
+     * @param[in] moved the number of bodies whose pose changed
+     */
+    void updateRestoredAabbs(int moved);
+
+    /** The deepest penetration of any contact point, or 0 */
+    double deepestPenetration() const;
+
+    /**
+     * Count the step just taken in m_solverIterationStats and, if the
+     * iterations are adaptive, choose those for the next step
+     */
+    void adaptSolverIterations();
+
+    /** Record the manifolds and solver state, see snapshot */
+    void snapshotContacts(tgWorldSnapshot& snapshot) const;
+
+    /**
+     * Put back the manifolds and solver state, after the bodies
+     * @throw std::invalid_argument if the manifolds name objects or
+     * points that do not exist
+     */
+    void restoreContacts(const tgWorldSnapshot& snapshot);
     
     /** Integrity predicate. */
     bool invariant() const;
 
  private:
     
-    /** Used to build the btSoftRigidDynamicsWorld. */
+    /** Used to build the dynamics world. */
     IntermediateBuildProducts * const m_pIntermediateBuildProducts;
     
 
@@ -136,6 +395,50 @@ private:
      */
    btDynamicsWorld* m_pDynamicsWorld;
     
+    /** Batches the forces of registered cables; NULL if not enabled. We own this. */
+    tgBulletCableForceEngine* m_pCableForceEngine;
+
+    /** Collides contact cables as capsules; NULL if not enabled. We own this. */
+    tgCableCollision* m_pCableCollision;
+
+    /** Where the models' bodies are made; released, not deleted */
+    tgRigidBodyArena* m_pBodyArena;
+
+    /** The ground we were built with or swapped to. We do not own this. */
+    tgBulletGround* m_pGround;
+
+    /**
+     * The ground's body, from tgBulletGround::acquireRigidBody; NULL if
+     * there is no ground. Handed back on destruction.
+     */
+    btRigidBody* m_pGroundBody;
+
+    /** The ground if it is a tgTiledGround, which has tiles instead of a body */
+    tgTiledGround* m_pTiledGround;
+
+    /** See staticBodyChanges */
+    unsigned long m_staticBodyChanges;
+    
+    /** tgWorld::Config::collisionInterval */
+    const int m_collisionInterval;
+    
+    /** World steps since collision detection last ran */
+    int m_stepsSinceCollisionDetection;
+
+    /** Whether the broadphase is an eRecenteringAxisSweep */
+    const bool m_recenterBroadphase;
+
+    /** tgWorld::Config::minSolverIterations; 0 if not adaptive */
+    const int m_minSolverIterations;
+
+    /** The most iterations adaptSolverIterations chooses */
+    int m_maxSolverIterations;
+
+    /** tgWorld::Config::penetrationTolerance */
+    const double m_penetrationTolerance;
+
+    SolverIterationStats m_solverIterationStats;
+    
     /* 
      * A btAlignedObjectArray of collision shapes for easy reference. Does not affect
      * physics or rendering unles the shape is placed into the dynamics
@@ -144,12 +447,45 @@ private:
      */
     btAlignedObjectArray<btCollisionShape*> m_collisionShapes;
 
+    /**
+     * The shapes from tgBulletShapeCache, once per reference we hold. These
+     * are not in m_collisionShapes, since the cache owns them.
+     */
+    btAlignedObjectArray<btCollisionShape*> m_sharedShapes;
+
     /* 
      * A vector of constraints for easy reference. Does not affect
      * physics or rendering unles the constraint is placed into the dynamics
      * world.
      */
     btAlignedObjectArray<btTypedConstraint*> m_constraints;
+
+    /** The rigid bodies as of the last step or restore */
+    tgRigidStateFrame m_rigidStates;
+
+    /** Made from the manifolds on demand, once per m_rigidStates frame */
+    mutable tgContactFrame m_contacts;
+
+    /** Collision objects sorted by address with their indices, for snapshot */
+    mutable std::vector< std::pair<const btCollisionObject*, int> > m_objectIndex;
+
+    /** A manifold by its objects, for restore */
+    struct ManifoldKey
+    {
+        const btCollisionObject* pObject0;
+        const btCollisionObject* pObject1;
+        int index;
+        bool operator<(const ManifoldKey& other) const;
+    };
+
+    /** The dispatcher's manifolds sorted by their objects, for restore */
+    std::vector<ManifoldKey> m_manifoldKeys;
+
+    /** Which of the dispatcher's manifolds have been restored, by index */
+    std::vector<char> m_manifoldRestored;
+
+    /** The dispatcher's manifolds in their restored order */
+    std::vector<btPersistentManifold*> m_manifoldOrder;
 };
 
 #endif  // TG_WORLDBULLETPHYSICSIMPL_H
@@ -31,6 +31,9 @@
 
 // Forward declarations
 class tgGround;
+class tgWorldSnapshot;
+class tgRigidStateFrame;
+class tgContactFrame;
 
 /**
  * Abstract base class to encapsulate the implementation of the tgWorld.
@@ -55,6 +58,34 @@ public:
    * must be positive
    */
   virtual void step(double dt) = 0;
+
+  /**
+   * Record the state of every body in the world.
+   * @param[out] snapshot overwritten with the current state
+   */
+  virtual void snapshot(tgWorldSnapshot& snapshot) const = 0;
+
+  /**
+   * Put every body back to the state recorded by snapshot.
+   * @param[in] snapshot taken from this implementation
+   */
+  virtual void restore(const tgWorldSnapshot& snapshot) = 0;
+
+  /**
+   * Replace the ground without disturbing the other bodies.
+   * @param[in] ground the new ground, which the caller keeps
+   */
+  virtual void swapGround(tgGround* ground) = 0;
+
+  /**
+   * The state of every rigid body as of the last step or restore.
+   */
+  virtual const tgRigidStateFrame& rigidStates() const = 0;
+
+  /**
+   * The contacts on every rigid body as of the last step.
+   */
+  virtual const tgContactFrame& contacts() const = 0;
 };
 
 
@@ -0,0 +1,135 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_WORLD_SNAPSHOT_H
+#define TG_WORLD_SNAPSHOT_H
+
+/**
+ * @file tgWorldSnapshot.h
+ * @brief Contains the definition of class tgWorldSnapshot
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "BulletCollision/NarrowPhaseCollision/btManifoldPoint.h"
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btTransform.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class tgSpringCableActuator;
+
+/**
+ * The state of a world and its actuators at one instant, filled in by
+ * tgWorld::snapshot and tgSimulation::snapshot and put back by the
+ * matching restore. A snapshot refers to the bodies and actuators it
+ * was taken from, so it is only valid until the next tgWorld::reset or
+ * model teardown. Static bodies, such as the ground, are not recorded,
+ * so tgWorld::swapGround leaves it valid. Restoring into the same snapshot repeatedly does not
+ * allocate.
+ *
+ * The contact manifolds are recorded with their points' accumulated
+ * impulses, which warm start the solver, so a restored world steps as
+ * the original would have rather than starting its contacts cold.
+ */
+class tgWorldSnapshot
+{
+public:
+
+    /** Everything Bullet integrates for one rigid body */
+    struct BodyState
+    {
+        btRigidBody* pBody;
+        btTransform worldTransform;
+        btVector3 linearVelocity;
+        btVector3 angularVelocity;
+        int activationState;
+        btScalar deactivationTime;
+    };
+
+    /**
+     * A contact manifold between two collision objects, named by their
+     * indices in the dynamics world's collision object array
+     */
+    struct ManifoldState
+    {
+        int object0;
+        int object1;
+        /** Where its points start in contactPoints */
+        std::size_t firstPoint;
+        int numPoints;
+    };
+
+    tgWorldSnapshot() :
+    numCollisionObjects(0),
+    staticBodyChanges(0),
+    stepsSinceCollisionDetection(0),
+    solverSeed(0),
+    solverIterations(0)
+    { }
+
+    /**
+     * The rigid bodies, in the order of the dynamics world's collision
+     * object array.
+     */
+    std::vector<BodyState> bodies;
+
+    /**
+     * The number of collision objects that are not static in the world
+     * when the snapshot was taken, used to check that restore is given
+     * the same world.
+     */
+    int numCollisionObjects;
+
+    /** The actuators whose state follows, in order */
+    std::vector<tgSpringCableActuator*> actuators;
+
+    /** What each actuator's saveState wrote, concatenated */
+    std::vector<double> actuatorState;
+
+    /** The dispatcher's contact manifolds, in its order */
+    std::vector<ManifoldState> manifolds;
+
+    /** The points of every manifold, without their user data */
+    std::vector<btManifoldPoint> contactPoints;
+
+    /**
+     * The world's staticBodyChanges when the snapshot was taken. The
+     * manifolds are only restored if the static bodies, and so the
+     * indices of the objects, are the same.
+     */
+    unsigned long staticBodyChanges;
+
+    /** Where the world was in its tgWorld::Config::collisionInterval */
+    int stepsSinceCollisionDetection;
+
+    /** The sequential impulse solver's random seed, if it has one */
+    unsigned long solverSeed;
+
+    /**
+     * The solver iterations chosen for the next step, when
+     * tgWorld::Config::minSolverIterations makes them adaptive
+     */
+    int solverIterations;
+};
+
+#endif  // TG_WORLD_SNAPSHOT_H
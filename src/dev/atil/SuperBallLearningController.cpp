@@ -51,7 +51,7 @@ SuperBallPrefLengthController::SuperBallPrefLengthController(const double initia
 void SuperBallPrefLengthController::onSetup(SuperBallModel& subject)
 {
 	m_totalTime=0;
-	const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+	const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
 	for (size_t i = 0; i < muscles.size(); ++i)
 	{
 		tgBasicActuator * const pMuscle = muscles[i];
@@ -100,7 +100,7 @@ void SuperBallPrefLengthController::onStep(SuperBallModel& subject, double dt)
     }
 
     //Move motors for all the muscles
-	const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+	const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
 	for (size_t i = 0; i < muscles.size(); ++i)
 	{
 		tgBasicActuator * const pMuscle = muscles[i];
@@ -24,9 +24,8 @@
  * $Id$
  */
 
-// This application
-#include "CordeModel.h"
 // This library
+#include "core/tgCordeRod.h"
 #include "core/tgModel.h"
 #include "core/tgSimViewGraphics.h"
 #include "core/tgSimulation.h"
@@ -72,10 +71,10 @@ int main(int argc, char** argv)
 	const double springConst = 100.0 * pow(10, 3);
 	const double gammaT = 10.0 * pow(10, -6);
 	const double gammaR = 1.0 * pow(10, -6);
-	CordeModel::Config config(resolution, radius, density, youngMod, shearMod,
+	tgCordeRod::Config config(resolution, radius, density, youngMod, shearMod,
 								stretchMod, springConst, gammaT, gammaR);
 	
-	CordeModel testString(startPos, endPos, startRot, endRot, config);
+	tgCordeRod testString(startPos, endPos, startRot, endRot, config);
 	
 	double t = 0.0;
 	double dt = 0.0001;
@@ -84,6 +83,10 @@ int main(int argc, char** argv)
 		testString.step(dt);
 		t += dt;
 	}
+	for (std::size_t i = 0; i < testString.getResolution(); i++)
+	{
+		std::cout << "Position " << i << " " << testString.getPosition(i) << std::endl;
+	}
 	#ifdef BT_USE_DOUBLE_PRECISION
 		std::cout << "Double precision" << std::endl;
 	#else
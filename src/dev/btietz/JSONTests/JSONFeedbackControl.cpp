@@ -38,6 +38,7 @@
 
 #include "examples/learningSpines/BaseSpineModelLearning.h"
 #include "helpers/FileHelpers.h"
+#include "helpers/tgControllerParams.h"
 
 #include "learning/AnnealEvolution/AnnealEvolution.h"
 #include "learning/Configuration/configuration.h"
@@ -116,17 +117,8 @@ void JSONFeedbackControl::onSetup(BaseSpineModelLearning& subject)
 {
 	m_pCPGSys = new CPGEquationsFB(100);
 
-    Json::Value root; // will contains the root value after parsing.
-    Json::Reader reader;
-
-    bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), root );
-    if ( !parsingSuccessful )
-    {
-        // report to the user the failure and their locations in the document.
-        std::cout << "Failed to parse configuration\n"
-            << reader.getFormattedErrorMessages();
-        throw std::invalid_argument("Bad filename for JSON");
-    }
+    // Parsed once per process
+    const Json::Value& root = tgControllerParams::get(controlFilename).getRoot();
     // Get the value of the member of root named 'encoding', return 'UTF-8' if there is no
     // such member.
     Json::Value nodeVals = root.get("nodeVals", "UTF-8");
@@ -244,55 +236,46 @@ void JSONFeedbackControl::onTeardown(BaseSpineModelLearning& subject)
     /// @todo - return length scale as a parameter
     double totalEnergySpent=0;
     
-    std::vector<tgSpringCableActuator* > tmpStrings = subject.getAllMuscles();
+    const std::vector<tgSpringCableActuator* >& tmpStrings = subject.getAllMuscles();
     
     for(std::size_t i=0; i<tmpStrings.size(); i++)
     {
-        tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[i]->getHistory();
-        
-        for(std::size_t j=1; j<stringHist.tensionHistory.size(); j++)
-        {
-            const double previousTension = stringHist.tensionHistory[j-1];
-            const double previousLength = stringHist.restLengths[j-1];
-            const double currentLength = stringHist.restLengths[j];
-            //TODO: examine this assumption - free spinning motor may require more power
-            double motorSpeed = (currentLength-previousLength);
-            if(motorSpeed > 0) // Vestigial code
-                motorSpeed = 0;
-            const double workDone = previousTension * motorSpeed;
-            totalEnergySpent += workDone;
-        }
+        totalEnergySpent += tmpStrings[i]->getStats().shorteningWork;
     }
     
     scores.push_back(totalEnergySpent);
     
     std::cout << "Dist travelled " << scores[0] << std::endl;
     
-    Json::Value root; // will contains the root value after parsing.
-    Json::Reader reader;
-
-    bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), root );
-    if ( !parsingSuccessful )
+    // A parameter block trial takes its scores in place
+    if (!tgControllerParams::writeScores(controlFilename, scores))
     {
-        // report to the user the failure and their locations in the document.
-        std::cout << "Failed to parse configuration\n"
-            << reader.getFormattedErrorMessages();
-        throw std::invalid_argument("Bad filename for JSON");
-    }
+        Json::Value root; // will contains the root value after parsing.
+        Json::Reader reader;
+
+        bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), root );
+        if ( !parsingSuccessful )
+        {
+            // report to the user the failure and their locations in the document.
+            std::cout << "Failed to parse configuration\n"
+                << reader.getFormattedErrorMessages();
+            throw std::invalid_argument("Bad filename for JSON");
+        }
     
-    Json::Value prevScores = root.get("scores", Json::nullValue);
+        Json::Value prevScores = root.get("scores", Json::nullValue);
     
-    Json::Value subScores;
-    subScores["distance"] = scores[0];
-    subScores["energy"] = totalEnergySpent;
+        Json::Value subScores;
+        subScores["distance"] = scores[0];
+        subScores["energy"] = totalEnergySpent;
     
-    prevScores.append(subScores);
-    root["scores"] = prevScores;
+        prevScores.append(subScores);
+        root["scores"] = prevScores;
     
-    ofstream payloadLog;
-    payloadLog.open(controlFilename.c_str(),ofstream::out);
+        ofstream payloadLog;
+        payloadLog.open(controlFilename.c_str(),ofstream::out);
     
-    payloadLog << root << std::endl;
+        payloadLog << root << std::endl;
+    }
     
     delete m_pCPGSys;
     m_pCPGSys = NULL;
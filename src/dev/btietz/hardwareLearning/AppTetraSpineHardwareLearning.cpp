@@ -82,12 +82,9 @@ int main(int argc, char** argv)
       new LearningSpineJSON(control_config, suffix);
     myModel->attach(myControl);
     
-    tgCPGLogger* const myLogger = 
-      new tgCPGLogger("logs/CPGValues.txt");
-    
-    myControl->attach(myLogger);
-    
     simulation.addModel(myModel);
+    // Trace the CPG nodes; ConvertCPGLog turns the log into text
+    simulation.addDataManager(tgCPGLogger::create(myControl, "logs/CPGValues"));
     
     int i = 0;
     while (i < 1)
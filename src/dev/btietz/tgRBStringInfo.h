@@ -23,7 +23,8 @@
  * @file tgRBStringInfo.h
  * @brief Contains the definition of class tgRBStringInfo. A string with
  * small rigid bodies to create contact dynamics. Depricated as of
- * version 1.1.0
+ * version 1.1.0; see tgcreator/tgCordeStringInfo for
+ * a replacement that adds no rigid bodies to the world
  * @author Brian Tietz
  * @copyright Copyright (C) 2014 NASA Ames Research Center
  * $Id$
@@ -264,7 +264,7 @@ void pidTestRig::teardown()
 {
     notifyTeardown();
     
-    std::vector<tgSpringCableActuator* > tmpStrings = this->getAllMuscles();
+    const std::vector<tgSpringCableActuator* >& tmpStrings = this->getAllMuscles();
     
     tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[0]->getHistory();
         
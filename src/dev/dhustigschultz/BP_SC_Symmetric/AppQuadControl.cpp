@@ -28,6 +28,8 @@
 #include "AppQuadControl.h"
 #include "dev/btietz/JSONTests/tgCPGJSONLogger.h"
 
+#include <cassert>
+
 AppQuadControl::AppQuadControl(int argc, char** argv)
 {
     bSetup = false;
@@ -166,10 +168,8 @@ bool AppQuadControl::setup()
     return bSetup;
 }
 
-void AppQuadControl::handleOptions(int argc, char **argv)
+void AppQuadControl::describeOptions(po::options_description& desc)
 {
-    // Declare the supported options.
-    po::options_description desc("Allowed options");
     desc.add_options()
         ("help,h", "produce help message")
         ("graphics,G", po::value<bool>(&use_graphics), "Test using graphical view")
@@ -189,7 +189,15 @@ void AppQuadControl::handleOptions(int argc, char **argv)
         ("goal_angle,B", po::value<double>(&goalAngle), "Angle of starting rotation for goal box. Degrees. Default = 0")
         ("learning_controller,l", po::value<std::string>(&suffix), "Which learned controller to write to or use. Default = default")
 	("lower_path,P", po::value<std::string>(&lowerPath), "Which resources folder in which you want to store controllers. Default = default")
+        ("server", po::value<std::string>(&serverSocket), "Serve trials on this Unix socket instead of running once. Requests are the number of steps followed by these options.")
     ;
+}
+
+void AppQuadControl::handleOptions(int argc, char **argv)
+{
+    // Declare the supported options.
+    po::options_description desc("Allowed options");
+    describeOptions(desc);
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -201,7 +209,11 @@ void AppQuadControl::handleOptions(int argc, char **argv)
     }
 
     po::notify(vm);
+    applyOptions(vm);
+}
 
+void AppQuadControl::applyOptions(const po::variables_map& vm)
+{
     if (vm.count("phys_time"))
     {
         timestep_physics = 1/vm["phys_time"].as<double>();
@@ -365,6 +377,50 @@ void AppQuadControl::simulate(tgSimulation *simulation)
     }
 }
 
+bool AppQuadControl::serve()
+{
+    if (serverSocket.empty())
+    {
+        return false;
+    }
+    use_graphics = false;
+    
+    tgEvaluationServer server(*this);
+    server.serve(serverSocket);
+    return true;
+}
+
+tgSimulation& AppQuadControl::beginTrial(const std::vector<std::string>& args)
+{
+    po::options_description desc("Allowed options");
+    describeOptions(desc);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(args).options(desc).run(), vm);
+    po::notify(vm);
+    applyOptions(vm);
+    use_graphics = false;
+
+    setup();
+    return *simulation;
+}
+
+std::string AppQuadControl::endTrial(tgSimulation& trialSimulation, bool completed)
+{
+    assert(&trialSimulation == simulation);
+    
+    // The controller scores a trial that threw as -1 on teardown
+    delete simulation;
+    delete view;
+    delete world;
+    simulation = NULL;
+    view = NULL;
+    world = NULL;
+    bSetup = false;
+    
+    return suffix;
+}
+
 /**
  * The entry point.
  * @param[in] argc the number of command-line arguments
@@ -376,6 +432,9 @@ int main(int argc, char** argv)
     std::cout << "AppQuadControl" << std::endl;
     AppQuadControl app (argc, argv);
 
+    if (app.serve())
+        return 0;
+
     if (app.setup())
         app.run();
     
@@ -36,6 +36,7 @@
 #include "models/obstacles/tgBlockField.h"
 
 // This library
+#include "core/tgEvaluationServer.h"
 #include "core/tgModel.h"
 #include "core/tgSubject.h"
 #include "core/tgSimViewGraphics.h"
@@ -50,10 +51,11 @@
 // The C++ Standard Library
 #include <iostream>
 #include <string>
+#include <vector>
 
 namespace po = boost::program_options;
 
-class AppQuadControl
+class AppQuadControl : public tgEvaluationServer::Evaluation
 {
 public:
     AppQuadControl(int argc, char** argv);
@@ -63,10 +65,32 @@ public:
     /** Run the simulation */
     bool run();
 
+    /**
+     * Serve trials on the socket given by --server until told to quit.
+     * @return false if no socket was given
+     */
+    bool serve();
+
+    /**
+     * Parse a trial's options and build the simulation for it. The
+     * controllers read their parameters on setup and cannot be
+     * restarted, so each trial gets a new model in this process.
+     */
+    virtual tgSimulation& beginTrial(const std::vector<std::string>& args);
+
+    /** Tear the trial down, which writes its scores to the controller's file */
+    virtual std::string endTrial(tgSimulation& simulation, bool completed);
+
 private:
+    /** Declare the supported options */
+    void describeOptions(po::options_description& desc);
+
     /** Parse command line options */
     void handleOptions(int argc, char** argv);
 
+    /** Act on the options that need more than storing a value */
+    void applyOptions(const po::variables_map& vm);
+
     const tgHillyGround::Config getHillyConfig();
     
     const tgBoxGround::Config getBoxConfig();
@@ -111,6 +135,7 @@ private:
     
     std::string lowerPath; 
     std::string suffix;
+    std::string serverSocket;
     
     bool bSetup;
 };
@@ -38,9 +38,11 @@
 
 #include "examples/learningSpines/BaseSpineModelLearning.h"
 #include "helpers/FileHelpers.h"
+#include "helpers/tgControllerParams.h"
 
 #include "learning/AnnealEvolution/AnnealEvolution.h"
 #include "learning/Configuration/configuration.h"
+#include "learning/NeuroEvolution/NeuroBatch.h"
 
 #include "util/CPGEquationsFB.h"
 #include "examples/learningSpines/tgCPGCableControl.h"
@@ -105,7 +107,9 @@ JSONQuadFeedbackControl::JSONQuadFeedbackControl(JSONQuadFeedbackControl::Config
                                                 std::string args,
                                                 std::string resourcePath) :
 JSONCPGControl(config, args, resourcePath),
-m_config(config)
+m_config(config),
+nn(NULL),
+m_pFeedbackBatch(NULL)
 {
     // Path and filename handled by base class
     
@@ -114,23 +118,15 @@ m_config(config)
 JSONQuadFeedbackControl::~JSONQuadFeedbackControl()
 {
     delete nn;
+    delete m_pFeedbackBatch;
 }
 
 void JSONQuadFeedbackControl::onSetup(BaseSpineModelLearning& subject)
 {
 	m_pCPGSys = new CPGEquationsFB(100);
 
-    Json::Value root; // will contains the root value after parsing.
-    Json::Reader reader;
-
-    bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), root );
-    if ( !parsingSuccessful )
-    {
-        // report to the user the failure and their locations in the document.
-        std::cout << "Failed to parse configuration\n"
-            << reader.getFormattedErrorMessages();
-        throw std::invalid_argument("Bad filename for JSON");
-    }
+    // Parsed once per process
+    const Json::Value& root = tgControllerParams::get(controlFilename).getRoot();
     // Get the value of the member of root named 'encoding', return 'UTF-8' if there is no
     // such member.
     Json::Value nodeVals = root.get("nodeVals", "UTF-8");
@@ -160,6 +156,11 @@ void JSONQuadFeedbackControl::onSetup(BaseSpineModelLearning& subject)
     
     nn->loadWeights(nnFile.c_str());
     
+    // Evaluates nn over every cable's state at once
+    delete m_pFeedbackBatch;
+    m_pFeedbackBatch = new NeuroBatch(m_config.numStates, m_config.numStates*2, m_config.numActions, 1);
+    m_pFeedbackBatch->load(0, *nn);
+    
     initConditions = subject.getSegmentCOM(m_config.segmentNumber);
     for (int i = 0; i < initConditions.size(); i++)
     {
@@ -183,7 +184,7 @@ void JSONQuadFeedbackControl::onStep(BaseSpineModelLearning& subject, double dt)
     if (m_updateTime >= m_config.controlTime)
     {
 #if (1)
-        std::vector<double> desComs = getFeedback(subject);
+        std::vector<double>& desComs = getFeedback(subject);
 
 #else        
         std::size_t numControllers = subject.getNumberofMuslces() * 3;
@@ -252,51 +253,42 @@ void JSONQuadFeedbackControl::onTeardown(BaseSpineModelLearning& subject)
     
     for(std::size_t i=0; i<tmpStrings.size(); i++)
     {
-        tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[i]->getHistory();
-        
-        for(std::size_t j=1; j<stringHist.tensionHistory.size(); j++)
-        {
-            const double previousTension = stringHist.tensionHistory[j-1];
-            const double previousLength = stringHist.restLengths[j-1];
-            const double currentLength = stringHist.restLengths[j];
-            //TODO: examine this assumption - free spinning motor may require more power
-            double motorSpeed = (currentLength-previousLength);
-            if(motorSpeed > 0) // Vestigial code
-                motorSpeed = 0;
-            const double workDone = previousTension * motorSpeed;
-            totalEnergySpent += workDone;
-        }
+        totalEnergySpent += tmpStrings[i]->getStats().shorteningWork;
     }
     
     scores.push_back(totalEnergySpent);
     
     std::cout << "Dist travelled " << scores[0] << std::endl;
     
-    Json::Value root; // will contains the root value after parsing.
-    Json::Reader reader;
-
-    bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), root );
-    if ( !parsingSuccessful )
+    // A parameter block trial takes its scores in place
+    if (!tgControllerParams::writeScores(controlFilename, scores))
     {
-        // report to the user the failure and their locations in the document.
-        std::cout << "Failed to parse configuration\n"
-            << reader.getFormattedErrorMessages();
-        throw std::invalid_argument("Bad filename for JSON");
-    }
+        Json::Value root; // will contains the root value after parsing.
+        Json::Reader reader;
+
+        bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), root );
+        if ( !parsingSuccessful )
+        {
+            // report to the user the failure and their locations in the document.
+            std::cout << "Failed to parse configuration\n"
+                << reader.getFormattedErrorMessages();
+            throw std::invalid_argument("Bad filename for JSON");
+        }
     
-    Json::Value prevScores = root.get("scores", Json::nullValue);
+        Json::Value prevScores = root.get("scores", Json::nullValue);
     
-    Json::Value subScores;
-    subScores["distance"] = scores[0];
-    subScores["energy"] = totalEnergySpent;
+        Json::Value subScores;
+        subScores["distance"] = scores[0];
+        subScores["energy"] = totalEnergySpent;
     
-    prevScores.append(subScores);
-    root["scores"] = prevScores;
+        prevScores.append(subScores);
+        root["scores"] = prevScores;
     
-    ofstream payloadLog;
-    payloadLog.open(controlFilename.c_str(),ofstream::out);
+        ofstream payloadLog;
+        payloadLog.open(controlFilename.c_str(),ofstream::out);
     
-    payloadLog << root << std::endl;
+        payloadLog << root << std::endl;
+    }
     
     delete m_pCPGSys;
     m_pCPGSys = NULL;
@@ -392,83 +384,52 @@ array_2D JSONQuadFeedbackControl::scaleNodeActions (Json::Value actions)
     return nodeActions;
 }
 
-std::vector<double> JSONQuadFeedbackControl::getFeedback(BaseSpineModelLearning& subject)
+std::vector<double>& JSONQuadFeedbackControl::getFeedback(BaseSpineModelLearning& subject)
 {
-    // Placeholder
-    std::vector<double> feedback;
-    
     const std::vector<tgSpringCableActuator*>& spineCables = subject.find<tgSpringCableActuator> ("spine ");
     
-    double *inputs = new double[m_config.numStates];
-    
-    std::size_t n = spineCables.size();
+    // Every cable's state as one matrix, so the network runs over all of them at once
+    const std::size_t numStates = m_config.numStates;
+    assert(numStates == 2);
+    const std::size_t n = spineCables.size();
+    m_feedbackStates.resize(n * numStates);
     for(std::size_t i = 0; i != n; i++)
     {
-        std::vector< std::vector<double> > actions;
-        
-        const tgSpringCableActuator& cable = *(spineCables[i]);
-        std::vector<double > state = getCableState(cable);
+        double* state = &m_feedbackStates[i * numStates];
+        getCableState(*(spineCables[i]), state);
         
-        // Rescale to 0 to 1 (consider doing this inside getState
-        for (std::size_t i = 0; i < state.size(); i++)
+        // Rescale to 0 to 1
+        for (std::size_t j = 0; j < numStates; j++)
         {
-            inputs[i]=state[i] / 2.0 + 0.5;
+            state[j] = state[j] / 2.0 + 0.5;
         }
-        
-        double *output = nn->feedForwardPattern(inputs);
-        vector<double> tmpAct;
-        for(int j=0;j<m_config.numActions;j++)
-        {
-            tmpAct.push_back(output[j]);
-        }
-        actions.push_back(tmpAct);
-
-        std::vector<double> cableFeedback = transformFeedbackActions(actions);
-        
-        feedback.insert(feedback.end(), cableFeedback.begin(), cableFeedback.end());
     }
     
+    m_feedback.resize(n * m_config.numActions);
+    if (n == 0)
+    {
+        return m_feedback;
+    }
+    m_pFeedbackBatch->feedForward(0, &m_feedbackStates[0], n, &m_feedback[0]);
+    
+    // Scale values back to -1 to +1
+    for (std::size_t i = 0; i < m_feedback.size(); i++)
+    {
+        m_feedback[i] = m_feedback[i] * 2.0 - 1.0;
+    }
     
-    return feedback;
+    return m_feedback;
 }
 
-std::vector<double> JSONQuadFeedbackControl::getCableState(const tgSpringCableActuator& cable)
+void JSONQuadFeedbackControl::getCableState(const tgSpringCableActuator& cable, double* state)
 {
 	// For each string, scale value from -1 to 1 based on initial length or max tension of motor
     
-    std::vector<double> state;
-    
     // Scale length by starting length
     const double startLength = cable.getStartLength();
-    state.push_back((cable.getCurrentLength() - startLength) / startLength);
+    state[0] = (cable.getCurrentLength() - startLength) / startLength;
     
     const double maxTension = cable.getConfig().maxTens;
-    state.push_back((cable.getTension() - maxTension / 2.0) / maxTension);
-    
-	return state;
-}
-
-std::vector<double> JSONQuadFeedbackControl::transformFeedbackActions(std::vector< std::vector<double> >& actions)
-{
-	// Placeholder
-	std::vector<double> feedback;
-    
-    // Leave in place for generalization later
-    const std::size_t numControllers = 1;
-    const std::size_t numActions = m_config.numActions;
-    
-    assert( actions.size() == numControllers);
-    assert( actions[0].size() == numActions);
-    
-    // Scale values back to -1 to +1
-    for( std::size_t i = 0; i < numControllers; i++)
-    {
-        for( std::size_t j = 0; j < numActions; j++)
-        {
-            feedback.push_back(actions[i][j] * 2.0 - 1.0);
-        }
-    }
-    
-	return feedback;
+    state[1] = (cable.getTension() - maxTension / 2.0) / maxTension;
 }
 
@@ -33,6 +33,7 @@
 
 // Forward Declarations
 class neuralNetwork;
+class NeuroBatch;
 class tgSpringCableActuator;
 
 /**
@@ -114,11 +115,14 @@ protected:
     
     virtual array_2D scaleNodeActions (Json::Value actions);
     
-    std::vector<double> getFeedback(BaseSpineModelLearning& subject);
+    /**
+     * The descending commands of every spine cable's feedback network,
+     * numActions per cable, from -1 to 1. The vector is reused on every call.
+     */
+    std::vector<double>& getFeedback(BaseSpineModelLearning& subject);
     
-    std::vector<double> getCableState(const tgSpringCableActuator& cable);
-    
-    std::vector<double> transformFeedbackActions(std::vector< std::vector<double> >& actions);
+    /** Write a cable's two states, each from -1 to 1 */
+    void getCableState(const tgSpringCableActuator& cable, double* state);
     
     JSONQuadFeedbackControl::Config m_config;
 
@@ -127,6 +131,14 @@ protected:
     /// @todo generalize this if we need more than one
     neuralNetwork* nn;
     
+    /** nn, evaluated over every cable's state in one pass */
+    NeuroBatch* m_pFeedbackBatch;
+    
+    /** Each cable's state, a row each, kept between steps */
+    std::vector<double> m_feedbackStates;
+    
+    /** The network's actions, then the commands getFeedback returns */
+    std::vector<double> m_feedback;
 };
 
 #endif // JSON_QUAD_FEEDBACK_CONTROL_H
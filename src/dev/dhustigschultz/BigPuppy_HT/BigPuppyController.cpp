@@ -73,7 +73,7 @@ void BigPuppyController::onTeardown(BigPuppy& subject) {
 
 void BigPuppyController::moveAllMotors(BigPuppy& subject, double dt){
 
-    const std::vector<tgSpringCableActuator*> muscles = subject.getAllMuscles();
+    const std::vector<tgSpringCableActuator*>& muscles = subject.getAllMuscles();
     for (size_t i = 0; i < muscles.size(); ++i) {
         tgBasicActuator * const pMuscle = tgCast::cast<tgSpringCableActuator, tgBasicActuator>(muscles[i]);
         assert(pMuscle != NULL);
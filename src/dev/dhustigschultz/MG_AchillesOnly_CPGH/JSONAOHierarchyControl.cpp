@@ -39,6 +39,7 @@
 
 #include "dev/dhustigschultz/BigPuppy_SpineOnly_Stats/BaseQuadModelLearning.h"
 #include "helpers/FileHelpers.h"
+#include "helpers/tgControllerParams.h"
 
 #include "learning/AnnealEvolution/AnnealEvolution.h"
 #include "learning/Configuration/configuration.h"
@@ -142,17 +143,8 @@ void JSONAOHierarchyControl::onSetup(BaseQuadModelLearning& subject)
 {
     m_pCPGSys = new CPGEquationsFB(500);
 
-    Json::Value root; // will contains the root value after parsing.
-    Json::Reader reader;
-
-    bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), root );
-    if ( !parsingSuccessful )
-    {
-        // report to the user the failure and their locations in the document.
-        std::cout << "Failed to parse configuration\n"
-            << reader.getFormattedErrorMessages();
-        throw std::invalid_argument("Bad filename for JSON");
-    }
+    // Parsed once per process
+    const Json::Value& root = tgControllerParams::get(controlFilename).getRoot();
     // Get the value of the member of root named 'encoding', return 'UTF-8' if there is no
     // such member.
     // Lower level CPG node and edge params:
@@ -226,23 +218,6 @@ void JSONAOHierarchyControl::onSetup(BaseQuadModelLearning& subject)
     {
 	metrics.push_back(structureCOM[i]);
     }
-    
-    //"metrics" is a new section of the controller's JSON file that is 
-    //added in the getNewFile function in evolution_job_master.py 
-    Json::Value prevMetrics = root.get("metrics", Json::nullValue);
-
-    Json::Value subMetrics;
-    subMetrics["initial COM x"] = metrics[0];
-    subMetrics["initial COM y"] = metrics[1];
-    subMetrics["initial COM z"] = metrics[2];
-    
-    prevMetrics.append(subMetrics);
-    root["metrics"] = prevMetrics;
-    
-    ofstream payloadLog;
-    payloadLog.open(controlFilename.c_str(),ofstream::out);
-    
-    payloadLog << root << std::endl;
 
     
 #if(1)
@@ -268,7 +243,6 @@ void JSONAOHierarchyControl::onSetup(BaseQuadModelLearning& subject)
 	P = (PVal.get(j, 0.0)).asDouble();
 	D = (DVal.get(j, 0.0)).asDouble();
 #endif
-
 }
 
 void JSONAOHierarchyControl::onStep(BaseQuadModelLearning& subject, double dt)
@@ -320,6 +294,8 @@ void JSONAOHierarchyControl::onStep(BaseQuadModelLearning& subject, double dt)
 void JSONAOHierarchyControl::onTeardown(BaseQuadModelLearning& subject)
 {
     scores.clear();
+    // The initial metrics from onSetup are written with the final ones
+    const std::vector<double> initialMetrics = metrics;
     metrics.clear();
     // @todo - check to make sure we ran for the right amount of time
     
@@ -350,20 +326,7 @@ void JSONAOHierarchyControl::onTeardown(BaseQuadModelLearning& subject)
     
     for(std::size_t i=0; i<tmpStrings.size(); i++)
     {
-        tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[i]->getHistory();
-        
-        for(std::size_t j=1; j<stringHist.tensionHistory.size(); j++)
-        {
-            const double previousTension = stringHist.tensionHistory[j-1];
-            const double previousLength = stringHist.restLengths[j-1];
-            const double currentLength = stringHist.restLengths[j];
-            //TODO: examine this assumption - free spinning motor may require more power
-            double motorSpeed = (currentLength-previousLength);
-            if(motorSpeed > 0) // Vestigial code
-                motorSpeed = 0;
-            const double workDone = previousTension * motorSpeed;
-            totalEnergySpent += workDone;
-        }
+        totalEnergySpent += tmpStrings[i]->getStats().shorteningWork;
     }
     
     scores.push_back(totalEnergySpent);
@@ -397,6 +360,17 @@ void JSONAOHierarchyControl::onTeardown(BaseQuadModelLearning& subject)
     subScores["distance"] = scores[0];
     subScores["energy"] = scores[1];
 
+    //"metrics" is a new section of the controller's JSON file that is 
+    //added in the getNewFile function in evolution_job_master.py 
+    if (initialMetrics.size() == 3)
+    {
+        Json::Value initialSubMetrics;
+        initialSubMetrics["initial COM x"] = initialMetrics[0];
+        initialSubMetrics["initial COM y"] = initialMetrics[1];
+        initialSubMetrics["initial COM z"] = initialMetrics[2];
+        prevMetrics.append(initialSubMetrics);
+    }
+
     Json::Value subMetrics;
     subMetrics["final COM x"] = metrics[0];
     subMetrics["final COM y"] = metrics[1];
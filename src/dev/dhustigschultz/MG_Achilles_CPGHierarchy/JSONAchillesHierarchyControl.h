@@ -34,6 +34,7 @@
 
 // Forward Declarations
 class neuralNetwork;
+class NeuroBatch;
 class tgSpringCableActuator;
 
 
@@ -147,11 +148,15 @@ protected:
 
     virtual array_4D scaleEdgeActions (Json::Value actions, int segmentSpan, int theirMuscles, int ourMuscles); 
  
-    std::vector<double> getFeedback(BaseQuadModelLearning& subject);
+    /**
+     * The descending commands of every cable's feedback network, then of
+     * every higher level CPG's, numActions each, from -1 to 1. The vector
+     * is reused on every call.
+     */
+    std::vector<double>& getFeedback(BaseQuadModelLearning& subject);
     
-    std::vector<double> getCableState(const tgSpringCableActuator& cable);
-    
-    std::vector<double> transformFeedbackActions(std::vector< std::vector<double> >& actions);
+    /** Write a cable's two states, each from -1 to 1 */
+    void getCableState(const tgSpringCableActuator& cable, double* state);
     
     JSONAchillesHierarchyControl::Config m_config;
 
@@ -180,6 +185,15 @@ protected:
     
     // @todo generalize this if we need more than one
     neuralNetwork* nn;
+    
+    /** nn, evaluated over every cable's state in one pass */
+    NeuroBatch* m_pFeedbackBatch;
+    
+    /** Each cable's state, a row each, kept between steps */
+    std::vector<double> m_feedbackStates;
+    
+    /** The network's actions, then the commands getFeedback returns */
+    std::vector<double> m_feedback;
 
     std::vector< std::vector<double> > m_quadCOM;
 
@@ -39,9 +39,11 @@
 
 #include "dev/dhustigschultz/BigPuppy_SpineOnly_Stats/BaseQuadModelLearning.h"
 #include "helpers/FileHelpers.h"
+#include "helpers/tgControllerParams.h"
 
 #include "learning/AnnealEvolution/AnnealEvolution.h"
 #include "learning/Configuration/configuration.h"
+#include "learning/NeuroEvolution/NeuroBatch.h"
 
 #include "util/CPGEquationsFB.h"
 #include "examples/learningSpines/tgCPGCableControl.h"
@@ -123,7 +125,9 @@ JSONHierarchyFeedbackControl::JSONHierarchyFeedbackControl(JSONHierarchyFeedback
                                                 std::string args,
                                                 std::string resourcePath) :
 JSONQuadCPGControl(config, args, resourcePath),
-m_config(config)
+m_config(config),
+nn(NULL),
+m_pFeedbackBatch(NULL)
 {
     // Path and filename handled by base class
     
@@ -132,23 +136,15 @@ m_config(config)
 JSONHierarchyFeedbackControl::~JSONHierarchyFeedbackControl()
 {
     delete nn;
+    delete m_pFeedbackBatch;
 }
 
 void JSONHierarchyFeedbackControl::onSetup(BaseQuadModelLearning& subject)
 {
     m_pCPGSys = new CPGEquationsFB(100);
 
-    Json::Value root; // will contains the root value after parsing.
-    Json::Reader reader;
-
-    bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), root );
-    if ( !parsingSuccessful )
-    {
-        // report to the user the failure and their locations in the document.
-        std::cout << "Failed to parse configuration\n"
-            << reader.getFormattedErrorMessages();
-        throw std::invalid_argument("Bad filename for JSON");
-    }
+    // Parsed once per process
+    const Json::Value& root = tgControllerParams::get(controlFilename).getRoot();
     // Get the value of the member of root named 'encoding', return 'UTF-8' if there is no
     // such member.
     // Lower level CPG node and edge params:
@@ -211,6 +207,11 @@ void JSONHierarchyFeedbackControl::onSetup(BaseQuadModelLearning& subject)
     
     nn->loadWeights(nnFile.c_str());
     
+    // Evaluates nn over every cable's state at once
+    delete m_pFeedbackBatch;
+    m_pFeedbackBatch = new NeuroBatch(m_config.numStates, m_config.numStates*2, m_config.numActions, 1);
+    m_pFeedbackBatch->load(0, *nn);
+    
     initConditions = subject.getSegmentCOM(m_config.segmentNumber);
     for (int i = 0; i < initConditions.size(); i++)
     {
@@ -237,24 +238,6 @@ void JSONHierarchyFeedbackControl::onSetup(BaseQuadModelLearning& subject)
     {
 	metrics.push_back(structureCOM[i]);
     }
-    
-    //"metrics" is a new section of the controller's JSON file that is 
-    //added in the getNewFile function in evolution_job_master.py 
-    Json::Value prevMetrics = root.get("metrics", Json::nullValue);
-
-    Json::Value subMetrics;
-    subMetrics["initial COM x"] = metrics[0];
-    subMetrics["initial COM y"] = metrics[1];
-    subMetrics["initial COM z"] = metrics[2];
-    
-    prevMetrics.append(subMetrics);
-    root["metrics"] = prevMetrics;
-    
-    ofstream payloadLog;
-    payloadLog.open(controlFilename.c_str(),ofstream::out);
-    
-    payloadLog << root << std::endl;
-
 }
 
 void JSONHierarchyFeedbackControl::onStep(BaseQuadModelLearning& subject, double dt)
@@ -264,7 +247,7 @@ void JSONHierarchyFeedbackControl::onStep(BaseQuadModelLearning& subject, double
     if (m_updateTime >= m_config.controlTime)
     {
 #if (1)
-        std::vector<double> desComs = getFeedback(subject);
+        std::vector<double>& desComs = getFeedback(subject);
 
 #else        
         std::size_t numControllers = subject.getNumberofMuslces() * 3;
@@ -305,6 +288,8 @@ void JSONHierarchyFeedbackControl::onStep(BaseQuadModelLearning& subject, double
 void JSONHierarchyFeedbackControl::onTeardown(BaseQuadModelLearning& subject)
 {
     scores.clear();
+    // The initial metrics from onSetup are written with the final ones
+    const std::vector<double> initialMetrics = metrics;
     metrics.clear();
     // @todo - check to make sure we ran for the right amount of time
     
@@ -335,20 +320,7 @@ void JSONHierarchyFeedbackControl::onTeardown(BaseQuadModelLearning& subject)
     
     for(std::size_t i=0; i<tmpStrings.size(); i++)
     {
-        tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[i]->getHistory();
-        
-        for(std::size_t j=1; j<stringHist.tensionHistory.size(); j++)
-        {
-            const double previousTension = stringHist.tensionHistory[j-1];
-            const double previousLength = stringHist.restLengths[j-1];
-            const double currentLength = stringHist.restLengths[j];
-            //TODO: examine this assumption - free spinning motor may require more power
-            double motorSpeed = (currentLength-previousLength);
-            if(motorSpeed > 0) // Vestigial code
-                motorSpeed = 0;
-            const double workDone = previousTension * motorSpeed;
-            totalEnergySpent += workDone;
-        }
+        totalEnergySpent += tmpStrings[i]->getStats().shorteningWork;
     }
     
     scores.push_back(totalEnergySpent);
@@ -382,6 +354,17 @@ void JSONHierarchyFeedbackControl::onTeardown(BaseQuadModelLearning& subject)
     subScores["distance"] = scores[0];
     subScores["energy"] = scores[1];
 
+    //"metrics" is a new section of the controller's JSON file that is 
+    //added in the getNewFile function in evolution_job_master.py 
+    if (initialMetrics.size() == 3)
+    {
+        Json::Value initialSubMetrics;
+        initialSubMetrics["initial COM x"] = initialMetrics[0];
+        initialSubMetrics["initial COM y"] = initialMetrics[1];
+        initialSubMetrics["initial COM z"] = initialMetrics[2];
+        prevMetrics.append(initialSubMetrics);
+    }
+
     Json::Value subMetrics;
     subMetrics["final COM x"] = metrics[0];
     subMetrics["final COM y"] = metrics[1];
@@ -1174,106 +1157,53 @@ array_4D JSONHierarchyFeedbackControl::scaleEdgeActions
     return actionList;
 }
 
-std::vector<double> JSONHierarchyFeedbackControl::getFeedback(BaseQuadModelLearning& subject)
+std::vector<double>& JSONHierarchyFeedbackControl::getFeedback(BaseQuadModelLearning& subject)
 {
-    // Placeholder
-    std::vector<double> feedback;
-    
     const std::vector<tgSpringCableActuator*>& allCables = subject.find<tgSpringCableActuator> ("all ");
     
-    double *inputs = new double[m_config.numStates];
-    
-    std::size_t n = allCables.size();
+    // Every cable's state as one matrix, so the network runs over all of them at once
+    const std::size_t numStates = m_config.numStates;
+    assert(numStates == 2);
+    const std::size_t n = allCables.size();
+    // inputting 0 for now for the higher level CPGs, a row each after the cables
+    const std::size_t n2 = m_highControllers.size();
+    m_feedbackStates.assign((n + n2) * numStates, 0.0);
     for(std::size_t i = 0; i != n; i++)
     {
-        std::vector< std::vector<double> > actions;
-        
-        const tgSpringCableActuator& cable = *(allCables[i]);
-        std::vector<double > state = getCableState(cable);
-        
-        // Rescale to 0 to 1 (consider doing this inside getState
-        for (std::size_t i = 0; i < state.size(); i++)
-        {
-            inputs[i]=state[i] / 2.0 + 0.5;
-        }
+        double* state = &m_feedbackStates[i * numStates];
+        getCableState(*(allCables[i]), state);
         
-        double *output = nn->feedForwardPattern(inputs);
-        vector<double> tmpAct;
-        for(int j=0;j<m_config.numActions;j++)
+        // Rescale to 0 to 1
+        for (std::size_t j = 0; j < numStates; j++)
         {
-            tmpAct.push_back(output[j]);
+            state[j] = state[j] / 2.0 + 0.5;
         }
-        actions.push_back(tmpAct);
-
-        std::vector<double> cableFeedback = transformFeedbackActions(actions);
-        
-        feedback.insert(feedback.end(), cableFeedback.begin(), cableFeedback.end());
     }
-
-    // inputting 0 for now
-    std::size_t n2 = m_highControllers.size();
-    for (size_t i = 0; i != n2; i++)
+    
+    m_feedback.resize((n + n2) * m_config.numActions);
+    if (n + n2 == 0)
     {
-	std::vector< std::vector<double> > actions;
-		
-	// Rescale to 0 to 1 (consider doing this inside getState)
-	for (std::size_t i = 0; i < m_config.numStates; i++)
-	{
-	    inputs[i] = 0;
-	}
-		
-	double *output = nn->feedForwardPattern(inputs);
-	vector<double> tmpAct;
-	for(int j=0;j<m_config.numActions;j++)
-	{
-	    tmpAct.push_back(output[j]);
-	}
-	actions.push_back(tmpAct);
-
-	std::vector<double> cableFeedback = transformFeedbackActions(actions);
-		
-	feedback.insert(feedback.end(), cableFeedback.begin(), cableFeedback.end());
+        return m_feedback;
+    }
+    m_pFeedbackBatch->feedForward(0, &m_feedbackStates[0], n + n2, &m_feedback[0]);
+    
+    // Scale values back to -1 to +1
+    for (std::size_t i = 0; i < m_feedback.size(); i++)
+    {
+        m_feedback[i] = m_feedback[i] * 2.0 - 1.0;
     }
     
-    return feedback;
+    return m_feedback;
 }
 
-std::vector<double> JSONHierarchyFeedbackControl::getCableState(const tgSpringCableActuator& cable)
+void JSONHierarchyFeedbackControl::getCableState(const tgSpringCableActuator& cable, double* state)
 {
 	// For each string, scale value from -1 to 1 based on initial length or max tension of motor
     
-    std::vector<double> state;
-    
     // Scale length by starting length
     const double startLength = cable.getStartLength();
-    state.push_back((cable.getCurrentLength() - startLength) / startLength);
+    state[0] = (cable.getCurrentLength() - startLength) / startLength;
     
     const double maxTension = cable.getConfig().maxTens;
-    state.push_back((cable.getTension() - maxTension / 2.0) / maxTension);
-    
-	return state;
-}
-
-std::vector<double> JSONHierarchyFeedbackControl::transformFeedbackActions(std::vector< std::vector<double> >& actions)
-{
-	// Placeholder
-	std::vector<double> feedback;
-    
-    // Leave in place for generalization later
-    const std::size_t numControllers = 1;
-    const std::size_t numActions = m_config.numActions;
-    
-    assert( actions.size() == numControllers);
-    assert( actions[0].size() == numActions);
-    
-    // Scale values back to -1 to +1
-    for( std::size_t i = 0; i < numControllers; i++)
-    {
-        for( std::size_t j = 0; j < numActions; j++)
-        {
-            feedback.push_back(actions[i][j] * 2.0 - 1.0);
-        }
-    }
-    
-	return feedback;
+    state[1] = (cable.getTension() - maxTension / 2.0) / maxTension;
 }
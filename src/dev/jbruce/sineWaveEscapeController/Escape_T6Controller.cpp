@@ -64,7 +64,7 @@ void Escape_T6Controller::onSetup(Escape_T6Model& subject)
     double dt = 0.0001;
 
     //Set the initial length of every muscle in the subject
-    const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+    const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
     for (size_t i = 0; i < muscles.size(); ++i) {
         tgBasicActuator * const pMuscle = muscles[i];
         assert(pMuscle != NULL);
@@ -96,7 +96,7 @@ void Escape_T6Controller::onStep(Escape_T6Model& subject, double dt)
     m_totalTime+=dt;
 
     setPreferredMuscleLengths(subject, dt);
-    const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+    const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
     
     //Move motors for all the muscles
     for (size_t i = 0; i < muscles.size(); ++i)
@@ -211,7 +211,7 @@ void Escape_T6Controller::setupAdapter() {
 double Escape_T6Controller::totalEnergySpent(Escape_T6Model& subject) {
     double totalEnergySpent=0;
 
-    vector<tgBasicActuator* > tmpStrings = subject.getAllMuscles();
+    const vector<tgBasicActuator* >& tmpStrings = subject.getAllMuscles();
     for(int i=0; i<tmpStrings.size(); i++)
     {
         tgBaseString::BaseStringHistory stringHist = tmpStrings[i]->getHistory();
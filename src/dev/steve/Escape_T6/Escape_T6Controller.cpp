@@ -73,7 +73,7 @@ void Escape_T6Controller::onSetup(Escape_T6Model& subject)
     double dt = 0.0001;
 
     //Set the initial length of every muscle in the subject
-    const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+    const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
     for (size_t i = 0; i < muscles.size(); ++i) {
         tgBasicActuator * const pMuscle = muscles[i];
         assert(pMuscle != NULL);
@@ -106,7 +106,7 @@ void Escape_T6Controller::onStep(Escape_T6Model& subject, double dt)
     m_totalTime+=dt;
 
     setPreferredMuscleLengths(subject, dt);
-    const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+    const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
     
     //Move motors for all the muscles
     for (size_t i = 0; i < muscles.size(); ++i) {
@@ -236,21 +236,9 @@ void Escape_T6Controller::setupAdapter() {
 double Escape_T6Controller::totalEnergySpent(Escape_T6Model& subject) {
     double totalEnergySpent=0;
 
-    std::vector<tgBasicActuator* > tmpStrings = subject.getAllMuscles();
+    const std::vector<tgBasicActuator* >& tmpStrings = subject.getAllMuscles();
     for(size_t i=0; i<tmpStrings.size(); i++) {
-        tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[i]->getHistory();
-
-        for(size_t j=1; j<stringHist.tensionHistory.size(); j++) {
-            const double previousTension = stringHist.tensionHistory[j-1];
-            const double previousLength = stringHist.restLengths[j-1];
-            const double currentLength = stringHist.restLengths[j];
-            //TODO: examine this assumption - free spinning motor may require more power         
-            double motorSpeed = (currentLength-previousLength);
-            if(motorSpeed > 0) // Vestigial code
-                motorSpeed = 0;
-            const double workDone = previousTension * motorSpeed;
-            totalEnergySpent += workDone;
-        }
+        totalEnergySpent += tmpStrings[i]->getStats().shorteningWork;
     }
     return totalEnergySpent;
 }
@@ -266,7 +254,7 @@ void Escape_T6Controller::setPreferredMuscleLengths(Escape_T6Model& subject, dou
 
     for(int iMuscle=0; iMuscle < nMuscles; iMuscle++) {
 
-        const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+        const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
         tgBasicActuator *const pMuscle = muscles[iMuscle];
 
         assert(pMuscle != NULL);
@@ -391,7 +379,7 @@ void Escape_T6Controller::printCOM(Escape_T6Model& subject) {
 }
 
 void Escape_T6Controller::printMuscleTensions(Escape_T6Model& subject) {
-    const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+    const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
     for(size_t i=0; i<muscles.size(); i++) {
         std::cout << (muscles[i]->getTension())/10 << " ";
     }
@@ -399,7 +387,7 @@ void Escape_T6Controller::printMuscleTensions(Escape_T6Model& subject) {
 }
 
 void Escape_T6Controller::printMuscleLengths(Escape_T6Model& subject) {
-    const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+    const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
     for(size_t i=0; i<muscles.size(); i++) {
         std::cout << (muscles[i]->getCurrentLength())/10 << " ";
     }
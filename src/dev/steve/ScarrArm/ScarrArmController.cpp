@@ -162,7 +162,7 @@ void ScarrArmController::setAnconeusTargetLength(ScarrArmModel& subject, double
 
 //Move motors for all the muscles
 void ScarrArmController::moveAllMotors(ScarrArmModel& subject, double dt) {
-    const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+    const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
     for (size_t i = 0; i < muscles.size(); ++i) {
 		tgBasicActuator * const pMuscle = muscles[i];
 		assert(pMuscle != NULL);
@@ -207,7 +207,7 @@ vector< vector <double> > ScarrArmController::transformActions(vector< vector <d
 void ScarrArmController::applyActions(ScarrArmModel& subject, vector< vector <double> > act)
 {
 	//Get All the muscles of the subject
-	const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+	const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
 	//Check if the number of the actions match the number of the muscles
 	if(act.size() != muscles.size()) {
 		cout<<"Warning: # of muscles: "<< muscles.size() << " != # of actions: "<< act.size()<<endl;
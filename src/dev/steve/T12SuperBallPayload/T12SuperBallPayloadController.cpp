@@ -47,7 +47,7 @@ SuperBallPrefLengthController::SuperBallPrefLengthController(const double initia
 //Fetch all the muscles and set their preferred length
 void SuperBallPrefLengthController::onSetup(T12SuperBallPayload& subject)
 {
-	const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+	const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
 	for (size_t i = 0; i < muscles.size(); ++i)
 	{
 		tgBasicActuator * const pMuscle = muscles[i];
@@ -65,7 +65,7 @@ void SuperBallPrefLengthController::onStep(T12SuperBallPayload& subject, double
     m_totalTime+=dt;
 
     //Move motors for all the muscles
-	const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+	const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
 	for (size_t i = 0; i < muscles.size(); ++i)
 	{
 		tgBasicActuator * const pMuscle = muscles[i];
@@ -120,7 +120,7 @@ vector< vector <double> > SuperBallPrefLengthController::transformActions(vector
 void SuperBallPrefLengthController::applyActions(T12SuperBallPayload& subject, vector< vector <double> > act)
 {
 	//Get All the muscles of the subject
-	const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+	const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
 	//Check if the number of the actions match the number of the muscles
 	if(act.size() != muscles.size())
 	{
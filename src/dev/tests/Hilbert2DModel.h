@@ -45,6 +45,7 @@ end procedure;
 
 #include "tgcreator/tgBuildSpec.h"
 #include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureBatch.h"
 #include "tgcreator/tgStructureInfo.h"
 
 
@@ -65,15 +66,14 @@ public:
 
     virtual void setup(tgWorld& world)
     {
-
-        tgStructure tetra;
+        // The curve goes straight into a batch, rather than a tgNode and
+        // tgPair each, so large orders build without holding them
+        tgStructureBatch batch;
         
-        hilbert(tetra, 0,0,m_xsize,0,0,m_ysize,m_n);
-
-        makePairs(tetra);
+        hilbert(batch, 0,0,m_xsize,0,0,m_ysize,m_n);
         
         // Just get it out of the way of the other structure
-        tetra.move(btVector3(25.0, 0, 0));
+        batch.move(btVector3(25.0, 0, 0));
         
         const double density = 0.9;
         const double radius  = 0.5 / m_n; // divide by the number of iterations to keep the radius in check
@@ -83,34 +83,45 @@ public:
         spec.addBuilder("rod", new tgRodInfo(rodConfig));
         
         // Create your structureInfo
+        tgStructure tetra;
         tgStructureInfo structureInfo(tetra, spec);
 
+        makePairs(batch, structureInfo);
+
         // Use the structureInfo to build ourselves
         structureInfo.buildInto(*this, world);
     }
 
 
-    void hilbert(tgStructure& tetra, double x, double y, double xi, double xj, double yi, double yj, int n) 
+    void hilbert(tgStructureBatch& batch, double x, double y, double xi, double xj, double yi, double yj, int n) 
     {
         std::cout << x << " " << y << " " << xi << " " << xj << " " << yi << " " << yj << std::endl;
         if(n <= 0) {
-            tgNode node(point(x + (xi + yi)/2, y + (xj + yj)/2));
-            tetra.addNode( node ); // what to do here?
+            const btVector3 node(point(x + (xi + yi)/2, y + (xj + yj)/2));
+            batch.addNode(node.x(), node.y(), node.z());
         } else {
-            hilbert(tetra, x,           y,           yi/2, yj/2,  xi/2,  xj/2, n-1);
-            hilbert(tetra, x+xi/2,      y+xj/2 ,     xi/2, xj/2,  yi/2,  yj/2, n-1);
-            hilbert(tetra, x+xi/2+yi/2, y+xj/2+yj/2, xi/2, xj/2,  yi/2,  yj/2, n-1);
-            hilbert(tetra, x+xi/2+yi,   y+xj/2+yj,  -yi/2,-yj/2, -xi/2, -xj/2, n-1);
+            hilbert(batch, x,           y,           yi/2, yj/2,  xi/2,  xj/2, n-1);
+            hilbert(batch, x+xi/2,      y+xj/2 ,     xi/2, xj/2,  yi/2,  yj/2, n-1);
+            hilbert(batch, x+xi/2+yi/2, y+xj/2+yj/2, xi/2, xj/2,  yi/2,  yj/2, n-1);
+            hilbert(batch, x+xi/2+yi,   y+xj/2+yj,  -yi/2,-yj/2, -xi/2, -xj/2, n-1);
         }
     }
     
-     void makePairs(tgStructure& tetra) 
+    /** Stream the rods between consecutive nodes, a block at a time */
+    void makePairs(tgStructureBatch& batch, tgStructureInfo& structureInfo) 
     {   
-        size_t n = tetra.getNodes().size();
+        const std::size_t blockSize = 4096;
+        const int rod = batch.tags("rod");
+        size_t n = batch.nodeCount();
         std::cout << "Nodes size is " << n << std::endl;
-        for(int i = 1; i < n; i++) {
-            tetra.addPair(i-1, i, "rod");
+        for(size_t i = 1; i < n; i++) {
+            batch.addPair(i-1, i, rod);
+            if (batch.pairCount() == blockSize) {
+                structureInfo.stream(batch);
+                batch.clearPairs();
+            }
         }
+        structureInfo.stream(batch);
     }
     
     btVector3 point(double x, double y)
@@ -109,13 +109,13 @@ void VerticalSpineBendingController::onStep(VerticalSpineModel& subject, double
  	  }
 	
          // First, get all muscles (cables)
-         const std::vector<tgSpringCableActuator*> muscles = subject.getAllMuscles();
+         const std::vector<tgSpringCableActuator*>& muscles = subject.getAllMuscles();
         
          // get all vertical muscles
-         const std::vector<tgSpringCableActuator*> v_musclesA = subject.getMuscles("vertical a");
-         const std::vector<tgSpringCableActuator*> v_musclesB = subject.getMuscles("vertical b");
-         const std::vector<tgSpringCableActuator*> v_musclesC = subject.getMuscles("vertical c");
-         const std::vector<tgSpringCableActuator*> v_musclesD = subject.getMuscles("vertical d");
+         const std::vector<tgSpringCableActuator*>& v_musclesA = subject.getMuscles("vertical a");
+         const std::vector<tgSpringCableActuator*>& v_musclesB = subject.getMuscles("vertical b");
+         const std::vector<tgSpringCableActuator*>& v_musclesC = subject.getMuscles("vertical c");
+         const std::vector<tgSpringCableActuator*>& v_musclesD = subject.getMuscles("vertical d");
         
 
          // set string length for vertical muscles
@@ -209,13 +209,13 @@ void VerticalSpineBendingController::onStep(VerticalSpineModel& subject, double
 	  }
 	
         // First, get all muscles (cables)
-        const std::vector<tgSpringCableActuator*> muscles = subject.getAllMuscles();
+        const std::vector<tgSpringCableActuator*>& muscles = subject.getAllMuscles();
         
         // get all vertical muscles
-        const std::vector<tgSpringCableActuator*> v_musclesA = subject.getMuscles("vertical a");
-        const std::vector<tgSpringCableActuator*> v_musclesB = subject.getMuscles("vertical b");
-        const std::vector<tgSpringCableActuator*> v_musclesC = subject.getMuscles("vertical c");
-        const std::vector<tgSpringCableActuator*> v_musclesD = subject.getMuscles("vertical d");
+        const std::vector<tgSpringCableActuator*>& v_musclesA = subject.getMuscles("vertical a");
+        const std::vector<tgSpringCableActuator*>& v_musclesB = subject.getMuscles("vertical b");
+        const std::vector<tgSpringCableActuator*>& v_musclesC = subject.getMuscles("vertical c");
+        const std::vector<tgSpringCableActuator*>& v_musclesD = subject.getMuscles("vertical d");
         
 
         // set string length for vertical muscles
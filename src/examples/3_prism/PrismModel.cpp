@@ -158,7 +158,7 @@ void PrismModel::setup(tgWorld& world)
 
     // We could now use tgCast::filter or similar to pull out the
     // models (e.g. muscles) that we want to control. 
-    allActuators = tgCast::filter<tgModel, tgSpringCableActuator> (getDescendants());
+    allActuators = getDescendantsOfType<tgSpringCableActuator>();
     
     // Notify controllers that setup has finished.
     notifySetup();
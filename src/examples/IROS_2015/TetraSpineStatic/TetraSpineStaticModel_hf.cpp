@@ -348,8 +348,13 @@ std::vector<double> TetraSpineStaticModel_hf::getStringMaxTensions() const
         std::cout << i << " " << m_sca.getTags();
         
         tgSpringCableActuator::SpringCableActuatorHistory stringHist = m_sca.getHistory();
-        std::deque<double>& tensionHist = stringHist.tensionHistory;
-        maxTens.push_back( *(std::max_element(tensionHist.begin(), tensionHist.end())) );
+        const tgHistoryBuffer& tensionHist = stringHist.tensionHistory;
+        double maxTension = tensionHist[0];
+        for (std::size_t j = 1; j < tensionHist.size(); j++)
+        {
+            maxTension = std::max(maxTension, tensionHist[j]);
+        }
+        maxTens.push_back(maxTension);
         
         std::cout <<" "<< tensionHist[5] << " " << maxTens[i] << std::endl;
     }
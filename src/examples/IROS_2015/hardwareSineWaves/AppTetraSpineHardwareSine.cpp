@@ -115,13 +115,11 @@ int main(int argc, char** argv)
     LearningSpineSine* const myControl =
       new LearningSpineSine(control_config, suffix, "ICRA2015/learning/");
     myModel->attach(myControl);
+    simulation.addModel(myModel);
     /*
-    tgCPGLogger* const myLogger = 
-      new tgCPGLogger("logs/CPGValues.txt");
-    
-    myControl->attach(myLogger);
+    // Trace the CPG nodes; ConvertCPGLog turns the log into text
+    simulation.addDataManager(tgCPGLogger::create(myControl, "logs/CPGValues"));
     */
-    simulation.addModel(myModel);
     
     int i = 0;
     while (i < 30000)
@@ -125,24 +125,11 @@ void LearningSpineSine::onTeardown(BaseSpineModelLearning& subject)
     /// @todo - return length scale as a parameter
     double totalEnergySpent=0;
     
-    vector<tgSpringCableActuator* > tmpSCAs = subject.getAllMuscles();
+    const vector<tgSpringCableActuator* >& tmpSCAs = subject.getAllMuscles();
     vector<tgBasicActuator* > tmpStrings = tgCast::filter<tgSpringCableActuator, tgBasicActuator>(tmpSCAs);
     for(std::size_t i=0; i<tmpStrings.size(); i++)
     {
-        tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[i]->getHistory();
-        
-        for(std::size_t j=1; j<stringHist.tensionHistory.size(); j++)
-        {
-            const double previousTension = stringHist.tensionHistory[j-1];
-            const double previousLength = stringHist.restLengths[j-1];
-            const double currentLength = stringHist.restLengths[j];
-            //TODO: examine this assumption - free spinning motor may require more power
-            double motorSpeed = (currentLength-previousLength);
-            if(motorSpeed > 0) // Vestigial code
-                motorSpeed = 0;
-            const double workDone = previousTension * motorSpeed;
-            totalEnergySpent += workDone;
-        }
+        totalEnergySpent += tmpStrings[i]->getStats().shorteningWork;
     }
     
     scores.push_back(totalEnergySpent);
@@ -161,6 +148,9 @@ void LearningSpineSine::onTeardown(BaseSpineModelLearning& subject)
 void LearningSpineSine::setupWaves(BaseSpineModelLearning& subject, array_2D nodeActions, array_2D edgeActions)
 {
 	std::vector <tgSpringCableActuator*> allMuscles = subject.getAllMuscles();
+	
+	// Back to time zero for the new controllers
+	m_sineBank.clear();
     
     double tension;
     double kPosition;
@@ -208,6 +198,7 @@ void LearningSpineSine::setupWaves(BaseSpineModelLearning& subject, array_2D nod
         
         tgSineStringControl* pStringControl = new tgSineStringControl(m_config.controlTime,
 																		p_ipc,
+																		m_sineBank,
 																		nodeActions[0][0],
 																		nodeActions[0][1],
 																		edgeActions[i][0],
@@ -29,6 +29,7 @@
  */
 
 #include "examples/learningSpines/BaseSpineCPGControl.h"
+#include "controllers/tgOscillatorBank.h"
 
 class tgSineStringControl;
 
@@ -67,6 +68,9 @@ protected:
     virtual array_2D scaleNodeActions (std::vector< std::vector <double> > actions);
 	
 	std::vector<tgSineStringControl*> m_sineControllers;
+	
+	/** Every sine controller's wave, advanced together */
+	tgOscillatorBank m_sineBank;
 };
 
 #endif // FLEMONS_SPINE_CPG_CONTROL_H
@@ -24,6 +24,7 @@
 // Forward declarations
 class btRigidBody;
 class tgImpedanceController;
+class tgOscillatorBank;
 
 class tgSineStringControl : public tgObserver<tgSpringCableActuator>
 {
@@ -37,6 +38,21 @@ public:
 							const double offset,
 							const double length);
     
+    /**
+     * As above, with the sine wave generated by a bank shared with the
+     * other actuators' controllers rather than by a cos per control step.
+     * Every controller on the bank must be stepped with the same dt.
+     * @param[in] bank not owned, at time zero
+     */
+    tgSineStringControl(const double controlStep,
+							tgImpedanceController* p_ipc,
+							tgOscillatorBank& bank,
+							const double amplitude,
+							const double frequency,
+							const double phase,
+							const double offset,
+							const double length);
+    
     virtual ~tgSineStringControl();
     
     virtual void onStep(tgSpringCableActuator& subject, double dt);
@@ -89,6 +105,10 @@ private:
     const double  m_controlLength;
     
     tgImpedanceController* m_pMotorControl;
+    
+    /** The shared sine waves, or NULL to compute this one alone */
+    tgOscillatorBank* m_pBank;
+    std::size_t m_oscillator;
 };
 
 
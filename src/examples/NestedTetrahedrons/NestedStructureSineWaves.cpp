@@ -47,7 +47,8 @@ NestedStructureSineWaves::NestedStructureSineWaves() :
     bodyWaves(2.0),
     simTime(0.0),
     cycle(0.0),
-    target(0.0)
+    target(0.0),
+    waveSegments(0)
 {
     phaseOffsets.clear();
     phaseOffsets.push_back(M_PI/2);
@@ -83,8 +84,9 @@ void NestedStructureSineWaves::applyImpedanceControlOutside(const std::vector<tg
 {
     for(std::size_t i = 0; i < stringList.size(); i++)
     {
-        cycle = sin(simTime * cpgFrequency + 2 * bodyWaves * M_PI * i / (segments) + phaseOffsets[phase]);
-        target = offsetSpeed + cycle*cpgAmplitude;
+        const std::size_t wave = waveStart[phase] + i;
+        cycle = waves.sine(wave);
+        target = waves.value(wave);
         
         double setTension = out_controller->control(*(stringList[i]),
                                             dt,
@@ -99,12 +101,47 @@ void NestedStructureSineWaves::applyImpedanceControlOutside(const std::vector<tg
     }    
 }
 
+void NestedStructureSineWaves::setupWaves(NestedStructureTestModel& subject)
+{
+    const char* const groups[] = { "outer top", "outer left", "outer right" };
+    
+    std::vector<std::size_t> counts;
+    for (std::size_t phase = 0; phase < phaseOffsets.size(); phase++)
+    {
+        counts.push_back(subject.getActuators(groups[phase]).size());
+    }
+    if (counts == waveCounts && segments == waveSegments)
+    {
+        return;
+    }
+    
+    // Added at time zero, then brought up to the current time
+    waves.clear();
+    waveStart.clear();
+    for (std::size_t phase = 0; phase < phaseOffsets.size(); phase++)
+    {
+        waveStart.push_back(waves.size());
+        for (std::size_t i = 0; i < counts[phase]; i++)
+        {
+            waves.add(cpgAmplitude,
+                      cpgFrequency,
+                      2 * bodyWaves * M_PI * i / (segments) + phaseOffsets[phase],
+                      offsetSpeed);
+        }
+    }
+    waveCounts = counts;
+    waveSegments = segments;
+}
+
 void NestedStructureSineWaves::onStep(NestedStructureTestModel& subject, double dt)
 {
     simTime += dt;
     
     segments = subject.getSegments();
     
+    setupWaves(subject);
+    waves.advanceTo(simTime);
+    
     applyImpedanceControlInside(subject.getActuators("inner top"), dt);
     applyImpedanceControlInside(subject.getActuators("inner left") , dt);
     applyImpedanceControlInside(subject.getActuators("inner right"), dt);
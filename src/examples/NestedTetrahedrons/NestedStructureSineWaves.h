@@ -29,6 +29,7 @@
 
 // NTRTSim
 #include "core/tgObserver.h"
+#include "controllers/tgOscillatorBank.h"
 
 // The C++ Standard Library
 #include <vector>
@@ -90,6 +91,13 @@ public:
     virtual void onStep(NestedStructureTestModel& subject, double dt);
     
 private:
+    
+    /**
+     * Add an oscillator for every outside string, when first stepped
+     * or when the number of strings or segments changes
+     */
+    void setupWaves(NestedStructureTestModel& subject);
+    
 	/**
 	 * Pointers to impedance controllers 
 	 */
@@ -129,6 +137,16 @@ private:
     double simTime;
     double cycle;
     double target;
+    
+    /** The outside strings' sine waves, advanced together each step */
+    tgOscillatorBank waves;
+    
+    /** The first oscillator of each group of outside strings */
+    std::vector<std::size_t> waveStart;
+    
+    /** The number of strings in each group the waves were set up for */
+    std::vector<std::size_t> waveCounts;
+    std::size_t waveSegments;
 };
 
 #endif // MY_MODEL_CONTROLLER_H
@@ -170,7 +170,7 @@ void NestedStructureTestModel::setup(tgWorld& world)
 
     // We could now use tgCast::filter or similar to pull out the models (e.g. actuators)
     // that we want to control.    
-    allActuators = tgCast::filter<tgModel, tgBasicActuator> (getDescendants());
+    allActuators = getDescendantsOfType<tgBasicActuator>();
     mapActuators(actuatorMap, *this);
 
     trace(structureInfo, *this);
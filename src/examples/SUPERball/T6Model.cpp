@@ -202,7 +202,7 @@ void T6Model::setup(tgWorld& world)
 
     // We could now use tgCast::filter or similar to pull out the
     // models (e.g. muscles) that we want to control. 
-    allActuators = tgCast::filter<tgModel, tgBasicActuator> (getDescendants());
+    allActuators = getDescendantsOfType<tgBasicActuator>();
 
     // call the onSetup methods of all observed things e.g. controllers
     notifySetup();
@@ -55,7 +55,7 @@ T6TensionController::~T6TensionController()
 
 void T6TensionController::onSetup(T6Model& subject)
 {
-    const std::vector<tgBasicActuator*> actuators = subject.getAllActuators();
+    const std::vector<tgBasicActuator*>& actuators = subject.getAllActuators();
     for (size_t i = 0; i < actuators.size(); ++i)
     {
         tgBasicActuator * const pActuator = actuators[i];
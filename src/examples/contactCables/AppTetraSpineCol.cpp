@@ -36,7 +36,6 @@
 #include "core/tgSimulation.h"
 #include "core/tgWorld.h"
 #include "core/terrain/tgHillyGround.h"
-#include "examples/learningSpines/tgCPGLogger.h"
 #include "models/obstacles/tgWall.h"
 // obstacles
 #include "models/obstacles/tgBlockField.h"
@@ -99,12 +98,6 @@ int main(int argc, char** argv)
       new colSpineSine("controlVars.json", "tetraTerrain/");
 
     myModel->attach(myControl);
-    /*
-    tgCPGLogger* const myLogger = 
-      new tgCPGLogger("logs/CPGValues.txt");
-    
-    myControl->attach(myLogger);
-    */
 	
 	// Add obstacles
 	btVector3 wallOrigin(0.0, 0.0, 50.0);
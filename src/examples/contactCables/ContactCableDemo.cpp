@@ -98,8 +98,8 @@ void ContactCableDemo::setup(tgWorld& world)
 	// models (e.g. muscles) that we want to control.
 	allRods.clear();
 	allMuscles.clear();
-	allMuscles = tgCast::filter<tgModel, tgSpringCableActuator> (getDescendants());
-	allRods = tgCast::filter<tgModel, tgBaseRigid> (getDescendants());
+	allMuscles = getDescendantsOfType<tgSpringCableActuator>();
+	allRods = getDescendantsOfType<tgBaseRigid>();
 	
 	btRigidBody* body = allRods[0]->getPRigidBody();
 	btRigidBody* body2 = allRods[1]->getPRigidBody();
@@ -30,6 +30,7 @@
 #include "EscapeModel.h"
 // This library
 #include "core/tgBasicActuator.h"
+#include "core/tgRandom.h"
 // For AnnealEvolution
 #include "learning/Configuration/configuration.h"
 #include "learning/AnnealEvolution/AnnealEvolution.h"
@@ -73,7 +74,7 @@ void EscapeController::onSetup(EscapeModel& subject)
     double dt = 0.0001;
 
     //Set the initial length of every muscle in the subject
-    const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+    const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
     for (size_t i = 0; i < muscles.size(); ++i) {
         tgBasicActuator * const pMuscle = muscles[i];
         assert(pMuscle != NULL);
@@ -105,7 +106,7 @@ void EscapeController::onStep(EscapeModel& subject, double dt)
     m_totalTime+=dt;
 
     setPreferredMuscleLengths(subject, dt);
-    const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
+    const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
     
     //Move motors for all the muscles
     for (size_t i = 0; i < muscles.size(); ++i)
@@ -219,23 +220,10 @@ void EscapeController::setupAdapter() {
 double EscapeController::totalEnergySpent(EscapeModel& subject) {
     double totalEnergySpent=0;
 
-    std::vector<tgBasicActuator* > tmpStrings = subject.getAllMuscles();
+    const std::vector<tgBasicActuator* >& tmpStrings = subject.getAllMuscles();
     for(int i=0; i<tmpStrings.size(); i++)
     {
-        tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[i]->getHistory();
-
-        for(int j=1; j<stringHist.tensionHistory.size(); j++)
-        {
-            const double previousTension = stringHist.tensionHistory[j-1];
-            const double previousLength = stringHist.restLengths[j-1];
-            const double currentLength = stringHist.restLengths[j];
-            //TODO: examine this assumption - free spinning motor may require more power         
-            double motorSpeed = (currentLength-previousLength);
-            if(motorSpeed > 0) // Vestigial code
-                motorSpeed = 0;
-            const double workDone = previousTension * motorSpeed;
-            totalEnergySpent += workDone;
-        }
+        totalEnergySpent += tmpStrings[i]->getStats().shorteningWork;
     }
     return totalEnergySpent;
 }
@@ -249,9 +237,9 @@ void EscapeController::setPreferredMuscleLengths(EscapeModel& subject, double dt
     int oldCluster = 0;
     int cluster = 0;
 
+    const std::vector<tgBasicActuator*>& muscles = subject.getAllMuscles();
     for(int iMuscle=0; iMuscle < nMuscles; iMuscle++) {
 
-        const std::vector<tgBasicActuator*> muscles = subject.getAllMuscles();
         tgBasicActuator *const pMuscle = muscles[iMuscle];
 
         assert(pMuscle != NULL);
@@ -376,7 +364,7 @@ std::vector<double> EscapeController::readManualParams(int lineNumber, std::stri
         // Tweak each read-in parameter by as much as 0.5% (params range: [0,1])
         for (int i=0; i < result.size(); i++) {
             std::cout<<"Entered Cell " << i << ": " << result[i] << "\n";
-            double seed = ((double) (rand() % 100)) / 100;
+            double seed = ((double) tgRandom::forThread().index(100)) / 100;
             result[i] += (0.01 * seed) - 0.005; // Value +/- 0.005 of original
         }
     } else {
@@ -217,7 +217,7 @@ void EscapeModel::setup(tgWorld& world)
 
     // We could now use tgCast::filter or similar to pull out the
     // models (e.g. muscles) that we want to control. 
-    allMuscles = tgCast::filter<tgModel, tgBasicActuator> (getDescendants());
+    allMuscles = getDescendantsOfType<tgBasicActuator>();
 
     // call the onSetup methods of all observed things e.g. controllers
     notifySetup();
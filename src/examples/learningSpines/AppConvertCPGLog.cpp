@@ -0,0 +1,70 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file AppConvertCPGLog.cpp
+ * @brief Turns a CPG log from tgCPGLogger::create into text
+ * $Id$
+ */
+
+// This application
+#include "tgCPGLogger.h"
+// The C++ Standard Library
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+/**
+ * The entry point.
+ * @param[in] argc the number of command-line arguments
+ * @param[in] argv argv[1] is the binary log; argv[2], if supplied, is
+ * the text file to write, otherwise the text goes to standard output
+ * @return 0, or 1 if the log could not be converted
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " log.bin [CPGValues.txt]" << std::endl;
+        return 1;
+    }
+    try
+    {
+        if (argc > 2)
+        {
+            std::ofstream text(argv[2]);
+            if (!text.is_open())
+            {
+                std::cerr << "Could not open " << argv[2] << std::endl;
+                return 1;
+            }
+            tgCPGLogger::convertToText(argv[1], text);
+        }
+        else
+        {
+            tgCPGLogger::convertToText(argv[1], std::cout);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << argv[1] << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -42,6 +42,7 @@
 #include "learning/Configuration/configuration.h"
 
 #include "util/CPGEquations.h"
+#include "util/CPGBatch.h"
 #include "util/CPGNode.h"
 
 //#define LOGGING
@@ -147,6 +148,8 @@ nodeLearning(false),
 edgeLearning(false),
 m_dataObserver("logs/TCData"),
 m_pCPGSys(NULL),
+m_pCPGBatch(NULL),
+m_CPGSlot(0),
 m_updateTime(0.0),
 bogus(false)
 {
@@ -175,7 +178,14 @@ BaseSpineCPGControl::~BaseSpineCPGControl()
 void BaseSpineCPGControl::onSetup(BaseSpineModelLearning& subject)
 {
     // Maximum number of sub-steps allowed by CPG
-	m_pCPGSys = new CPGEquations(200);
+	if (m_pCPGBatch)
+	{
+		m_pCPGSys = &m_pCPGBatch->attach(m_CPGSlot);
+	}
+	else
+	{
+		m_pCPGSys = new CPGEquations(200);
+	}
     //Initialize the Learning Adapters
     nodeAdapter.initialize(&nodeEvolution,
                             nodeLearning,
@@ -260,7 +270,7 @@ void BaseSpineCPGControl::onStep(BaseSpineModelLearning& subject, double dt)
         double descendingCommand = 2.0;
         std::vector<double> desComs (numControllers, descendingCommand);
         
-        m_pCPGSys->update(desComs, m_updateTime);
+        updateCPGs(desComs);
 #ifdef LOGGING // Conditional compile for data logging        
         m_dataObserver.onStep(subject, m_updateTime);
 #endif
@@ -306,24 +316,11 @@ void BaseSpineCPGControl::onTeardown(BaseSpineModelLearning& subject)
     /// @todo - return length scale as a parameter
     double totalEnergySpent=0;
     
-    std::vector<tgSpringCableActuator* > tmpStrings = subject.getAllMuscles();
+    const std::vector<tgSpringCableActuator* >& tmpStrings = subject.getAllMuscles();
     
     for(int i=0; i<tmpStrings.size(); i++)
     {
-        tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[i]->getHistory();
-        
-        for(int j=1; j<stringHist.tensionHistory.size(); j++)
-        {
-            const double previousTension = stringHist.tensionHistory[j-1];
-            const double previousLength = stringHist.restLengths[j-1];
-            const double currentLength = stringHist.restLengths[j];
-            //TODO: examine this assumption - free spinning motor may require more power
-            double motorSpeed = (currentLength-previousLength);
-            if(motorSpeed > 0) // Vestigial code
-                motorSpeed = 0;
-            const double workDone = previousTension * motorSpeed;
-            totalEnergySpent += workDone;
-        }
+        totalEnergySpent += tmpStrings[i]->getStats().shorteningWork;
     }
     
     scores.push_back(totalEnergySpent);
@@ -331,8 +328,7 @@ void BaseSpineCPGControl::onTeardown(BaseSpineModelLearning& subject)
     edgeAdapter.endEpisode(scores);
     nodeAdapter.endEpisode(scores);
     
-    delete m_pCPGSys;
-    m_pCPGSys = NULL;
+    releaseCPGs();
     
     for(size_t i = 0; i < m_allControllers.size(); i++)
     {
@@ -341,12 +337,65 @@ void BaseSpineCPGControl::onTeardown(BaseSpineModelLearning& subject)
 	m_allControllers.clear();
 }
 
+bool BaseSpineCPGControl::onReset(BaseSpineModelLearning& subject)
+{
+    // onTeardown deletes the controllers, which the muscles are kept
+    // through a reset
+    const std::vector<tgSpringCableActuator*>& allMuscles = subject.getAllMuscles();
+    for (std::size_t i = 0; i < allMuscles.size(); i++)
+    {
+        for (std::size_t j = 0; j < m_allControllers.size(); j++)
+        {
+            allMuscles[i]->detach(m_allControllers[j]);
+        }
+    }
+    onTeardown(subject);
+    onSetup(subject);
+    return true;
+}
+
+void BaseSpineCPGControl::setCPGBatch(CPGBatch* pBatch, std::size_t slot)
+{
+    m_pCPGBatch = pBatch;
+    m_CPGSlot = slot;
+}
+
+void BaseSpineCPGControl::updateCPGs(std::vector<double>& desComs)
+{
+    if (m_pCPGBatch)
+    {
+        m_pCPGBatch->stage(m_CPGSlot, desComs, m_updateTime);
+    }
+    else
+    {
+        m_pCPGSys->update(desComs, m_updateTime);
+    }
+}
+
+void BaseSpineCPGControl::releaseCPGs()
+{
+    if (m_pCPGBatch)
+    {
+        m_pCPGBatch->detach(m_CPGSlot);
+    }
+    else
+    {
+        delete m_pCPGSys;
+    }
+    m_pCPGSys = NULL;
+}
+
 const double BaseSpineCPGControl::getCPGValue(std::size_t i) const
 {
 	// Error handling on input done in CPG_Equations
 	return (*m_pCPGSys)[i];
 }
 
+const CPGEquations* BaseSpineCPGControl::getCPGSystem() const
+{
+	return m_pCPGSys;
+}
+
 double BaseSpineCPGControl::getScore() const
 {
 	if (scores.size() == 2)
@@ -33,6 +33,7 @@
 #include "core/tgSubject.h"
 #include "core/tgObserver.h"
 #include "sensors/tgDataObserver.h"
+#include "util/CPGSenseable.h"
 
 #include "learning/Adapters/AnnealAdapter.h"
 
@@ -45,7 +46,7 @@ class AnnealEvolution;
 class configuration;
 class tgCPGActuatorControl;
 class CPGEquations;
-class tgCPGLogger;
+class CPGBatch;
 
 typedef boost::multi_array<double, 2> array_2D;
 typedef boost::multi_array<double, 4> array_4D;
@@ -58,7 +59,8 @@ typedef boost::multi_array<double, 4> array_4D;
  * Due to the number of parameters, the learned parameters are split
  * into one config file for the nodes and another for the CPG's "edges"
  */
-class BaseSpineCPGControl : public tgObserver<BaseSpineModelLearning>, public tgSubject <BaseSpineCPGControl>
+class BaseSpineCPGControl : public tgObserver<BaseSpineModelLearning>, public tgSubject <BaseSpineCPGControl>,
+                            public CPGSenseable
 {
 public:
 
@@ -125,9 +127,33 @@ struct Config
     virtual void onSetup(BaseSpineModelLearning& subject);
     
     virtual void onTeardown(BaseSpineModelLearning& subject);
+    
+    /**
+     * Detach the cable controllers from the muscles, then call
+     * onTeardown and onSetup, which derived classes may override.
+     * Classes that can keep their controllers override this instead.
+     */
+    virtual bool onReset(BaseSpineModelLearning& subject);
 
 	const double getCPGValue(std::size_t i) const;
 	
+	/**
+	 * The system built by the last onSetup, for a tgCPGSensorInfo in a
+	 * data manager this controller was added to, as by tgCPGLogger::create
+	 */
+	virtual const CPGEquations* getCPGSystem() const;
+	
+	/**
+	 * Build the CPGs in a slot of a batch shared with controllers in
+	 * other worlds, from the next onSetup on, instead of allocating a
+	 * system each episode. onStep then stages the commands and the
+	 * batch's owner integrates them with CPGBatch::update.
+	 * @param[in] pBatch the batch, not owned, or NULL for a system of
+	 * this controller's own
+	 * @param[in] slot this controller's slot in the batch
+	 */
+	void setCPGBatch(CPGBatch* pBatch, std::size_t slot);
+	
 	double getScore() const;
 	
 protected:
@@ -141,8 +167,18 @@ protected:
     
     virtual void setupCPGs(BaseSpineModelLearning& subject, array_2D nodeActions, array_4D edgeActions);
 
+    /** Integrate the CPGs over m_updateTime, or stage them in the batch */
+    void updateCPGs(std::vector<double>& desComs);
+    
+    /** Delete m_pCPGSys, or give its slot back to the batch */
+    void releaseCPGs();
+    
     CPGEquations* m_pCPGSys;
     
+    /** NULL unless set by setCPGBatch */
+    CPGBatch* m_pCPGBatch;
+    std::size_t m_CPGSlot;
+    
     std::vector<tgCPGActuatorControl*> m_allControllers;
     
     BaseSpineCPGControl::Config m_config;
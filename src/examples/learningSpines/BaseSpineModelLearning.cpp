@@ -68,6 +68,14 @@ void BaseSpineModelLearning::teardown()
     m_muscleMap.clear();
 }
 
+void BaseSpineModelLearning::resetEpisode()
+{
+    notifyReset();
+    
+    // The controllers have been reset, now the muscles' controllers
+    tgModel::resetEpisode();
+}
+
 void BaseSpineModelLearning::step(double dt)
 {
     /* CPG update occurs in the controller so that we can decouple it
@@ -108,7 +116,7 @@ const std::vector<tgBaseRigid*> BaseSpineModelLearning::getAllRigids() const
 	
 	for (std::size_t i = 0; i < m_allSegments.size(); i++)
 	{
-		std::vector<tgBaseRigid*> temp = tgCast::filter<tgModel, tgBaseRigid> (m_allSegments[i]->getDescendants());
+		std::vector<tgBaseRigid*> temp = m_allSegments[i]->getDescendantsOfType<tgBaseRigid>();
         p_rods.insert(p_rods.end(), temp.begin(), temp.end());
 	}
 	
@@ -148,7 +156,7 @@ btVector3 BaseSpineModelLearning::getSegmentCOMVector(const int n) const
     }
     
     std::vector<tgRod*> p_rods =
-        tgCast::filter<tgModel, tgRod> (m_allSegments[n]->getDescendants());
+        m_allSegments[n]->getDescendantsOfType<tgRod>();
     
     // Ensure our segments are being populated correctly
     assert(!p_rods.empty());
@@ -57,6 +57,8 @@ public:
     virtual void setup(tgWorld& world);
     
     virtual void teardown();
+    
+    virtual void resetEpisode();
         
     virtual void step(double dt);
     
@@ -44,6 +44,7 @@
 #include "learning/Configuration/configuration.h"
 
 #include "util/CPGEquationsFB.h"
+#include "util/CPGBatch.h"
 #include "util/CPGNodeFB.h"
 
 //#define LOGGING
@@ -121,7 +122,14 @@ feedbackLearning(false)
 
 void SpineFeedbackControl::onSetup(BaseSpineModelLearning& subject)
 {
-	m_pCPGSys = new CPGEquationsFB(100);
+	if (m_pCPGBatch)
+	{
+		m_pCPGSys = &m_pCPGBatch->attachFeedback(m_CPGSlot);
+	}
+	else
+	{
+		m_pCPGSys = new CPGEquationsFB(100);
+	}
     //Initialize the Learning Adapters
     nodeAdapter.initialize(&nodeEvolution,
                             nodeLearning,
@@ -162,7 +170,7 @@ void SpineFeedbackControl::onStep(BaseSpineModelLearning& subject, double dt)
     if (m_updateTime >= m_config.controlTime)
     {
 #if (1)
-        std::vector<double> desComs = getFeedback(subject);
+        std::vector<double>& desComs = getFeedback(subject);
 
 #else        
         std::size_t numControllers = subject.getNumberofMuslces() * 3;
@@ -172,7 +180,7 @@ void SpineFeedbackControl::onStep(BaseSpineModelLearning& subject, double dt)
 #endif       
         try
         {
-            m_pCPGSys->update(desComs, m_updateTime);
+            updateCPGs(desComs);
         }
         catch (std::runtime_error& e)
         {
@@ -200,6 +208,60 @@ void SpineFeedbackControl::onStep(BaseSpineModelLearning& subject, double dt)
 }
 
 void SpineFeedbackControl::onTeardown(BaseSpineModelLearning& subject)
+{
+    scoreEpisode(subject);
+    
+    releaseCPGs();
+    
+    for(size_t i = 0; i < m_allControllers.size(); i++)
+    {
+        delete m_allControllers[i];
+    }
+    m_allControllers.clear();    
+}
+
+bool SpineFeedbackControl::onReset(BaseSpineModelLearning& subject)
+{
+    scoreEpisode(subject);
+    
+    if (m_pCPGBatch)
+    {
+        m_pCPGSys = &m_pCPGBatch->attachFeedback(m_CPGSlot);
+    }
+    else
+    {
+        m_pCPGSys->clear();
+    }
+    
+    nodeAdapter.initialize(&nodeEvolution,
+                            nodeLearning,
+                            nodeConfigData);
+    edgeAdapter.initialize(&edgeEvolution,
+                            edgeLearning,
+                            edgeConfigData);
+    feedbackAdapter.initialize(&feedbackEvolution,
+                                feedbackLearning,
+                                feedbackConfigData);
+    std::vector<double> state;
+    double dt = 0;
+    
+    array_4D edgeParams = scaleEdgeActions(edgeAdapter.step(dt, state));
+    array_2D nodeParams = scaleNodeActions(nodeAdapter.step(dt, state));
+    
+    resetCPGs(nodeParams, edgeParams);
+    
+    initConditions = subject.getSegmentCOM(m_config.segmentNumber);
+#ifdef LOGGING // Conditional compile for data logging    
+    m_dataObserver.onSetup(subject);
+#endif    
+    m_updateTime = 0.0;
+    bogus = false;
+    
+    // The cable controllers reset themselves when the muscles do
+    return true;
+}
+
+void SpineFeedbackControl::scoreEpisode(BaseSpineModelLearning& subject)
 {
     scores.clear();
     // @todo - check to make sure we ran for the right amount of time
@@ -227,24 +289,11 @@ void SpineFeedbackControl::onTeardown(BaseSpineModelLearning& subject)
     /// @todo - return length scale as a parameter
     double totalEnergySpent=0;
     
-    std::vector<tgSpringCableActuator* > tmpStrings = subject.getAllMuscles();
+    const std::vector<tgSpringCableActuator* >& tmpStrings = subject.getAllMuscles();
     
     for(int i=0; i<tmpStrings.size(); i++)
     {
-        tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[i]->getHistory();
-        
-        for(int j=1; j<stringHist.tensionHistory.size(); j++)
-        {
-            const double previousTension = stringHist.tensionHistory[j-1];
-            const double previousLength = stringHist.restLengths[j-1];
-            const double currentLength = stringHist.restLengths[j];
-            //TODO: examine this assumption - free spinning motor may require more power
-            double motorSpeed = (currentLength-previousLength);
-            if(motorSpeed > 0) // Vestigial code
-                motorSpeed = 0;
-            const double workDone = previousTension * motorSpeed;
-            totalEnergySpent += workDone;
-        }
+        totalEnergySpent += tmpStrings[i]->getStats().shorteningWork;
     }
     
     scores.push_back(totalEnergySpent);
@@ -252,15 +301,6 @@ void SpineFeedbackControl::onTeardown(BaseSpineModelLearning& subject)
     edgeAdapter.endEpisode(scores);
     nodeAdapter.endEpisode(scores);
     feedbackAdapter.endEpisode(scores);
-    
-    delete m_pCPGSys;
-    m_pCPGSys = NULL;
-    
-    for(size_t i = 0; i < m_allControllers.size(); i++)
-    {
-        delete m_allControllers[i];
-    }
-    m_allControllers.clear();    
 }
 
 void SpineFeedbackControl::setupCPGs(BaseSpineModelLearning& subject, array_2D nodeActions, array_4D edgeActions)
@@ -307,6 +347,27 @@ void SpineFeedbackControl::setupCPGs(BaseSpineModelLearning& subject, array_2D n
 	
 }
 
+void SpineFeedbackControl::resetCPGs(array_2D nodeActions, array_4D edgeActions)
+{
+    CPGEquationsFB& m_CPGFBSys = *(tgCast::cast<CPGEquations, CPGEquationsFB>(m_pCPGSys));
+    
+    for (std::size_t i = 0; i < m_allControllers.size(); i++)
+    {
+        tgCPGCableControl* pStringControl =
+            tgCast::cast<tgCPGActuatorControl, tgCPGCableControl>(m_allControllers[i]);
+        assert(pStringControl != NULL);
+        
+        pStringControl->resetNode();
+        pStringControl->assignNodeNumberFB(m_CPGFBSys, nodeActions);
+    }
+    
+    // The impedance controllers only depend on m_config, so are kept
+    for (std::size_t i = 0; i < m_allControllers.size(); i++)
+    {
+        m_allControllers[i]->setConnectivity(m_allControllers, edgeActions);
+    }
+}
+
 array_2D SpineFeedbackControl::scaleNodeActions  
                             (vector< vector <double> > actions)
 {
@@ -347,74 +408,46 @@ array_2D SpineFeedbackControl::scaleNodeActions
     return nodeActions;
 }
 
-std::vector<double> SpineFeedbackControl::getFeedback(BaseSpineModelLearning& subject)
+std::vector<double>& SpineFeedbackControl::getFeedback(BaseSpineModelLearning& subject)
 {
-    // Placeholder
-    std:vector<double> feedback;
-    // Adapter doesn't use this anyway, so just do zero here for now (will trigger errors if it starts to use it =) )
-    const double dt = 0;
-    
     const std::vector<tgSpringCableActuator*>& allCables = subject.getAllMuscles();
     
-    std::size_t n = allCables.size();
+    // Every cable's state as one matrix, so the network runs over all of them at once
+    const std::size_t numStates = 2;
+    assert(feedbackConfigData.getintvalue("numberOfStates") == numStates);
+    const std::size_t n = allCables.size();
+    m_feedbackStates.resize(n * numStates);
     for(std::size_t i = 0; i != n; i++)
     {
-        const tgSpringCableActuator& cable = *(allCables[i]);
-        std::vector<double > state = getCableState(cable);
-        std::vector< std::vector<double> > actions = feedbackAdapter.step(m_updateTime, state);
-        std::vector<double> cableFeedback = transformFeedbackActions(actions);
-        
-        feedback.insert(feedback.end(), cableFeedback.begin(), cableFeedback.end());
-       
-#if (0)
-        for (std::size_t j = 0; j < cableFeedback.size(); j++)
-        {
-            std::cout << cableFeedback[j] << " ";
-        }
+        getCableState(*(allCables[i]), &m_feedbackStates[i * numStates]);
     }
-    std::cout << std::endl;
-#else
+    
+    const std::size_t numControllers = feedbackConfigData.getintvalue("numberOfControllers");
+    const std::size_t numActions = feedbackConfigData.getintvalue("numberOfActions");
+    m_feedback.resize(n * numControllers * numActions);
+    if (n == 0)
+    {
+        return m_feedback;
+    }
+    feedbackAdapter.step(m_updateTime, &m_feedbackStates[0], n, &m_feedback[0]);
+    
+    // Scale values back to -1 to +1
+    for (std::size_t i = 0; i < m_feedback.size(); i++)
+    {
+        m_feedback[i] = m_feedback[i] * 2.0 - 1.0;
     }
-#endif
     
-    return feedback;
+    return m_feedback;
 }
 
-std::vector<double> SpineFeedbackControl::getCableState(const tgSpringCableActuator& cable)
+void SpineFeedbackControl::getCableState(const tgSpringCableActuator& cable, double* state)
 {
 	// For each string, scale value from -1 to 1 based on initial length or max tension of motor
     
-    std::vector<double> state;
-    
     // Scale length by starting length
     const double startLength = cable.getStartLength();
-    state.push_back((cable.getCurrentLength() - startLength) / startLength);
+    state[0] = (cable.getCurrentLength() - startLength) / startLength;
     
     const double maxTension = cable.getConfig().maxTens;
-    state.push_back((cable.getTension() - maxTension / 2.0) / maxTension);
-    
-	return state;
-}
-
-std::vector<double> SpineFeedbackControl::transformFeedbackActions(std::vector< std::vector<double> >& actions)
-{
-	// Placeholder
-	std:vector<double> feedback;
-    
-    std::size_t numControllers = feedbackConfigData.getintvalue("numberOfControllers");
-    std::size_t numActions = feedbackConfigData.getintvalue("numberOfActions");
-    
-    assert( actions.size() == numControllers);
-    assert( actions[0].size() == numActions);
-    
-    // Scale values back to -1 to +1
-    for( std::size_t i = 0; i < numControllers; i++)
-    {
-        for( std::size_t j = 0; j < numActions; j++)
-        {
-            feedback.push_back(actions[i][j] * 2.0 - 1.0);
-        }
-    }
-    
-	return feedback;
+    state[1] = (cable.getTension() - maxTension / 2.0) / maxTension;
 }
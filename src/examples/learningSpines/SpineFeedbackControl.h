@@ -99,18 +99,33 @@ struct Config : public BaseSpineCPGControl::Config
     virtual void onStep(BaseSpineModelLearning& subject, double dt);
     
     virtual void onTeardown(BaseSpineModelLearning& subject);
+    
+    /**
+     * Score the episode, then build the CPG system again with new
+     * parameters, reusing the system and the cable controllers
+     */
+    virtual bool onReset(BaseSpineModelLearning& subject);
 	
 protected:
 
     virtual void setupCPGs(BaseSpineModelLearning& subject, array_2D nodeActions, array_4D edgeActions);
     
-    virtual array_2D scaleNodeActions (std::vector< std::vector <double> > actions);
+    /** As setupCPGs, for the controllers already attached */
+    void resetCPGs(array_2D nodeActions, array_4D edgeActions);
+    
+    /** Give the episode's scores to the adapters */
+    void scoreEpisode(BaseSpineModelLearning& subject);
     
-    std::vector<double> getFeedback(BaseSpineModelLearning& subject);
+    virtual array_2D scaleNodeActions (std::vector< std::vector <double> > actions);
     
-    std::vector<double> getCableState(const tgSpringCableActuator& cable);
+    /**
+     * The descending commands of every cable's feedback network, three
+     * per cable, from -1 to 1. The vector is reused on every call.
+     */
+    std::vector<double>& getFeedback(BaseSpineModelLearning& subject);
     
-    std::vector<double> transformFeedbackActions(std::vector< std::vector<double> >& actions);
+    /** Write a cable's two states, each from -1 to 1 */
+    void getCableState(const tgSpringCableActuator& cable, double* state);
     
     SpineFeedbackControl::Config m_config;
     
@@ -122,6 +137,12 @@ protected:
     bool feedbackLearning;
     
     configuration feedbackConfigData;
+    
+    /** Each cable's state, a row each, kept between steps */
+    std::vector<double> m_feedbackStates;
+    
+    /** The network's actions, then the commands getFeedback returns */
+    std::vector<double> m_feedback;
 };
 
 #endif // SPINE_FEEDBACK_CONTROL_H
@@ -80,13 +80,11 @@ int main(int argc, char** argv)
     TetraSpineCPGControl* const myControl =
       new TetraSpineCPGControl(control_config, suffix, "learningSpines/TetraSpine/");
     myModel->attach(myControl);
+    simulation.addModel(myModel);
     /*
-    tgCPGLogger* const myLogger = 
-      new tgCPGLogger("logs/CPGValues.txt");
-    
-    myControl->attach(myLogger);
+    // Trace the CPG nodes; ConvertCPGLog turns the log into text
+    simulation.addDataManager(tgCPGLogger::create(myControl, "logs/CPGValues"));
     */
-    simulation.addModel(myModel);
     
     int i = 0;
     while (i < 10000)
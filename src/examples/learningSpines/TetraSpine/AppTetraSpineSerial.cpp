@@ -34,7 +34,6 @@
 #include "core/tgSimViewGraphics.h"
 #include "core/tgSimulation.h"
 #include "core/tgWorld.h"
-#include "examples/learningSpines/tgCPGLogger.h"
 // The C++ Standard Library
 #include <iostream>
 
@@ -73,12 +72,6 @@ int main(int argc, char** argv)
     SerializedSineWaves* const myControl =
       new SerializedSineWaves(suffix);
     myModel->attach(myControl);
-    /*
-    tgCPGLogger* const myLogger = 
-      new tgCPGLogger("logs/CPGValues.txt");
-    
-    myControl->attach(myLogger);
-    */
     simulation.addModel(myModel);
     
     int i = 0;
@@ -112,13 +112,11 @@ int main(int argc, char** argv)
     KinematicSpineCPGControl* const myControl =
       new KinematicSpineCPGControl(control_config, suffix, "learningSpines/TetrahedralComplex/");
     myModel->attach(myControl);
+    simulation.addModel(myModel);
 #if (0)    
-    tgCPGLogger* const myLogger = 
-      new tgCPGLogger("logs/CPGValues.txt");
-    
-    myControl->attach(myLogger);
+    // Trace the CPG nodes; ConvertCPGLog turns the log into text
+    simulation.addDataManager(tgCPGLogger::create(myControl, "logs/CPGValues"));
 #endif    
-    simulation.addModel(myModel);
     
     int i = 0;
     while (i < 1)
@@ -171,7 +171,7 @@ void FlemonsSpineModelLearning::setup(tgWorld& world)
     structureInfo.buildInto(*this, world);
 
     // Setup vectors for control
-    m_allMuscles = tgCast::filter<tgModel, tgSpringCableActuator> (getDescendants());
+    m_allMuscles = getDescendantsOfType<tgSpringCableActuator>();
      
     m_allSegments = this->find<tgModel> ("segment");
     
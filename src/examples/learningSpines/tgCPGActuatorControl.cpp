@@ -76,6 +76,14 @@ void tgCPGActuatorControl::onAttach(tgSpringCableActuator& subject)
 	m_pToBody   = anchors[n - 1]->attachedBody;
 }
 
+bool tgCPGActuatorControl::onReset(tgSpringCableActuator& subject)
+{
+    m_controlTime = 0.0;
+    m_totalTime = 0.0;
+    m_commandedTension = 0.0;
+    return true;
+}
+
 void tgCPGActuatorControl::onStep(tgSpringCableActuator& subject, double dt)
 {
     m_controlTime += dt;
@@ -118,6 +126,12 @@ void tgCPGActuatorControl::assignNodeNumber (CPGEquations& CPGSys, array_2D node
     m_nodeNumber = m_pCPGSystem->addNode(params);
 }
 
+void tgCPGActuatorControl::resetNode()
+{
+    m_pCPGSystem = NULL;
+    m_nodeNumber = -1;
+}
+
 void
 tgCPGActuatorControl::setConnectivity(const std::vector<tgCPGActuatorControl*>& allStrings,
                        array_4D edgeParams) 
@@ -53,6 +53,13 @@ public:
     virtual void onAttach(tgSpringCableActuator& subject);
     
     virtual void onStep(tgSpringCableActuator& subject, double dt);
+    
+    /**
+     * Zero the timers and the commanded tension for a new episode. The
+     * node is kept; the higher level controller rebuilding its CPG
+     * system calls resetNode first.
+     */
+    virtual bool onReset(tgSpringCableActuator& subject);
 	
 	/**
      * Can call these any time, but they'll only have the intended effect
@@ -60,6 +67,13 @@ public:
      */
     
     void assignNodeNumber (CPGEquations& CPGSys, array_2D nodeParams);
+    
+    /**
+     * Forget the node number and system, so the node can be assigned
+     * again once the higher level controller has cleared its CPG
+     * system. The motor control and attachment are kept.
+     */
+    void resetNode();
  
     /**
      * Iterate through all other tgSpringCableActuatorCPGInfos, and determine
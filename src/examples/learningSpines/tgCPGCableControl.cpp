@@ -61,6 +61,20 @@ void tgCPGCableControl::onSetup(tgSpringCableActuator& subject)
     }
 }
 
+bool tgCPGCableControl::onReset(tgSpringCableActuator& subject)
+{
+    tgCPGActuatorControl::onReset(subject);
+    if (m_PID == NULL)
+    {
+        onSetup(subject);
+    }
+    else
+    {
+        m_PID->reset();
+    }
+    return true;
+}
+
 void tgCPGCableControl::onStep(tgSpringCableActuator& subject, double dt)
 {
     assert(&subject == m_PID->getControllable());
@@ -37,6 +37,12 @@ public:
     
     virtual void onStep(tgSpringCableActuator& subject, double dt);
     
+    /**
+     * As tgCPGActuatorControl::onReset, also resetting the PID
+     * controller, or making it if this was attached since setup
+     */
+    virtual bool onReset(tgSpringCableActuator& subject);
+    
     /**
      * Account for the larger number of parameters the nodes have
      * with a feedback CPGSystem
@@ -26,52 +26,69 @@
 #include "tgCPGLogger.h"
 
 #include "BaseSpineCPGControl.h"
+#include "sensors/tgAsyncDataLogger.h"
+#include "sensors/tgCPGSensorInfo.h"
+#include "sensors/tgLogReader.h"
 
-#include <iostream>
-#include <fstream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
-/**
- * Construct our data logger
- */
-tgCPGLogger::tgCPGLogger(std::string fileName) :
-time (0.0),
-m_fileName(fileName)
+namespace
 {
+    bool endsWith(const std::string& s, const std::string& suffix)
+    {
+        return s.size() >= suffix.size() &&
+            s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
 }
 
-/** Virtual base classes must have a virtual destructor. */
-tgCPGLogger::~tgCPGLogger()
-{ }
+tgDataManager* tgCPGLogger::create(BaseSpineCPGControl* pControl,
+                                   const std::string& fileNamePrefix,
+                                   double timeInterval)
+{
+    if (pControl == NULL)
+    {
+        throw std::invalid_argument("pControl is NULL inside tgCPGLogger::create");
+    }
+    tgAsyncDataLogger* const pLogger =
+        new tgAsyncDataLogger(fileNamePrefix, timeInterval);
+    pLogger->addSensorInfo(new tgCPGSensorInfo());
+    pLogger->addSenseable(pControl);
+    return pLogger;
+}
 
-void tgCPGLogger::onStep(BaseSpineCPGControl& subject, double dt)
+void tgCPGLogger::convertToText(const std::string& logFileName, std::ostream& text)
 {
-	time += dt;
-	
-      // Then, open our output stream and render!
-      std::ofstream tgOutput;
-      tgOutput.open(m_fileName.c_str(), std::ios::app);
-	
-	tgOutput << time << ",";
-	
-	bool runLoop = true;
-	std::size_t i = 0;
-	
-	while (runLoop)
-	{
-		// Don't know how many nodes are in CPG, so just try until we fail
-	  try 
-	  {
-        tgOutput << subject.getCPGValue(i) << ",";
-        i++;
-	  }
-	  catch (std::invalid_argument e)
-	  {
-		// Got the error we expected, end the loop
-		tgOutput << std::endl;
-		runLoop = false;
-	  }
-	}
-	
-	tgOutput.close();
+    std::auto_ptr<tgLogReader> reader(tgLogReader::open(logFileName));
+    const std::vector<std::string>& headings = reader->getHeadings();
+    
+    // The node values, in the order the old logger asked for them
+    std::vector<std::size_t> columns;
+    for (std::size_t c = 1; c < headings.size(); c++)
+    {
+        if (headings[c].compare(0, 4, "cpg(") == 0 &&
+            endsWith(headings[c], ".value"))
+        {
+            columns.push_back(c);
+        }
+    }
+    if (columns.empty())
+    {
+        throw std::runtime_error("The log has no CPG nodes.");
+    }
+    
+    const std::size_t rows = reader->getRowCount();
+    for (std::size_t r = 0; r < rows; r++)
+    {
+        text << reader->getTime(r) << ",";
+        for (std::size_t i = 0; i < columns.size(); i++)
+        {
+            text << reader->getValue(r, columns[i]) << ",";
+        }
+        text << "\n";
+    }
+    text.flush();
 }
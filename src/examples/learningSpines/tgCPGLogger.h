@@ -21,40 +21,60 @@
 
 /**
  * @file tgCPGLogger.h
- * @brief Contains the definition of interface class tgCPGLogger
+ * @brief Contains the definition of class tgCPGLogger
  * @author Brian Mirletz
  * $Id$
  */
 
 
-// This library
-#include "core/tgObserver.h"
+#include <iosfwd>
 #include <string>
 
 // Forward declarations
 class BaseSpineCPGControl;
+class tgDataManager;
 
 /**
- * Interface for an observer of the CPG values
+ * Logs the CPG nodes of a BaseSpineCPGControl through the binary logging
+ * pipeline, and turns such a log into the text this class used to write
+ * on every step. The nodes are sampled by a tgCPGSensor into a
+ * tgAsyncDataLogger, so a step costs a copy into its ring instead of
+ * opening, writing and closing a text file.
  */
-class tgCPGLogger : public tgObserver <BaseSpineCPGControl>
+class tgCPGLogger
 {
     
 public:
 
-  /** Constructor
-   * @param[in[ fileName, the filename where the data is logged
+  /**
+   * A logger of the controller's nodes, to pass to
+   * tgSimulation::addDataManager after the controller's model has been
+   * added, so its CPGs are built when the sensors are made.
+   * @param[in] pControl the controller, not owned.
+   * @param[in] fileNamePrefix as for tgBinaryDataLogger.
+   * @param[in] timeInterval the seconds between rows; 0 logs every step.
+   * @return a new tgAsyncDataLogger, owned by the caller until added to
+   * a simulation.
    */
-  tgCPGLogger (std::string fileName);
+  static tgDataManager* create(BaseSpineCPGControl* pControl,
+                               const std::string& fileNamePrefix,
+                               double timeInterval = 0.0);
 
-  /** Virtual base classes must have a virtual destructor. */
-  virtual ~tgCPGLogger ();
+  /**
+   * Write the node values of a log from create as the old text log: a
+   * line per row, the time and then each node's value, each followed by
+   * a comma. Only the "value" columns of tgCPGSensors are written.
+   * @param[in] logFileName the path of the binary log.
+   * @param[out] text where the lines are written.
+   * @throw std::runtime_error if the file can't be read, isn't a log, or
+   * has no CPG nodes.
+   */
+  static void convertToText(const std::string& logFileName, std::ostream& text);
 
-  virtual void onStep(BaseSpineCPGControl& subject, double dt);
-  
 private:
-	double time;
-	std::string m_fileName;
+
+  /** Only static members */
+  tgCPGLogger();
 
 };
 
@@ -19,6 +19,7 @@
 #include "tgSCASineControl.h"
 
 #include "controllers/tgImpedanceController.h"
+#include "controllers/tgOscillatorBank.h"
 
 #include <iostream>
 #include <stdexcept>
@@ -45,7 +46,9 @@ target (0.0),
 m_controlLength(length),
 m_tempConfig(pidConfig),
 m_PIDController(NULL),
-m_pMotorControl(p_ipc)
+m_pMotorControl(p_ipc),
+m_pBank(NULL),
+m_oscillator(0)
 {
     if (m_controlStep < 0.0)
     {
@@ -57,6 +60,41 @@ m_pMotorControl(p_ipc)
     assert(p_ipc);
 }
 
+tgSCASineControl::tgSCASineControl(const double controlStep,
+											tgImpedanceController* p_ipc,
+											tgPIDController::Config pidConfig,
+											tgOscillatorBank& bank,
+											const double amplitude,
+											const double frequency,
+											const double phase,
+											const double offset,
+											const double length) :
+m_controlTime(0.0),
+m_totalTime(0.0),
+m_controlStep(controlStep),
+m_commandedTension(0.0),
+cpgAmplitude(amplitude),
+cpgFrequency(frequency),
+phaseOffset(phase),
+offsetSpeed(offset),
+cycle(0.0),
+target (0.0),
+m_controlLength(length),
+m_tempConfig(pidConfig),
+m_PIDController(NULL),
+m_pMotorControl(p_ipc),
+m_pBank(&bank),
+// cos(x) as sin(x + pi / 2)
+m_oscillator(bank.add(amplitude, 2.0 * M_PI * frequency, phase + M_PI / 2.0, offset))
+{
+    if (m_controlStep < 0.0)
+    {
+        throw std::invalid_argument("Negative control step");
+    }
+    
+    assert(p_ipc);
+}
+
 tgSCASineControl::~tgSCASineControl()
 {
 	delete m_PIDController;
@@ -77,8 +115,17 @@ void tgSCASineControl::onStep(tgSpringCableActuator& subject, double dt)
     if (m_controlTime >= m_controlStep)
     {
 		// Yep, its a misnomer. Had to change it for In Won
-		cycle = cos(m_totalTime  * 2.0 * M_PI * cpgFrequency + phaseOffset);
-        target = cycle*cpgAmplitude + offsetSpeed;
+		if (m_pBank)
+		{
+			m_pBank->advanceTo(m_totalTime);
+			cycle = m_pBank->sine(m_oscillator);
+			target = m_pBank->value(m_oscillator);
+		}
+		else
+		{
+			cycle = cos(m_totalTime  * 2.0 * M_PI * cpgFrequency + phaseOffset);
+			target = cycle*cpgAmplitude + offsetSpeed;
+		}
 
 	    // dt is just passed through to PID controller	
 		m_commandedTension = m_pMotorControl->control(*m_PIDController, dt, m_controlLength, target);
@@ -25,6 +25,7 @@
 // Forward declarations
 class btRigidBody;
 class tgImpedanceController;
+class tgOscillatorBank;
 
 class tgSCASineControl : public tgObserver<tgSpringCableActuator>
 {
@@ -39,6 +40,22 @@ public:
 							const double offset,
 							const double length);
     
+    /**
+     * As above, with the sine wave generated by a bank shared with the
+     * other actuators' controllers rather than by a cos per control step.
+     * Every controller on the bank must be stepped with the same dt.
+     * @param[in] bank not owned, at time zero
+     */
+    tgSCASineControl(const double controlStep,
+							tgImpedanceController* p_ipc,
+							tgPIDController::Config pidConfig,
+							tgOscillatorBank& bank,
+							const double amplitude,
+							const double frequency,
+							const double phase,
+							const double offset,
+							const double length);
+    
     virtual ~tgSCASineControl();
     
     virtual void onAttach(tgSpringCableActuator& subject);
@@ -96,6 +113,10 @@ private:
     tgPIDController* m_PIDController;
     
     tgImpedanceController* m_pMotorControl;
+    
+    /** The shared sine waves, or NULL to compute this one alone */
+    tgOscillatorBank* m_pBank;
+    std::size_t m_oscillator;
 };
 
 
@@ -73,9 +73,11 @@ namespace
   };
 } // namespace
 
-tsTestRig::tsTestRig(bool kinematic) :
+tsTestRig::tsTestRig(bool kinematic, bool implicitCables, double stiffness) :
 tgModel(),
-useKinematic(kinematic)
+useKinematic(kinematic),
+useImplicit(implicitCables),
+cableStiffness(stiffness > 0.0 ? stiffness : c.stiffness)
 {
 }
 
@@ -136,12 +138,14 @@ void tsTestRig::setup(tgWorld& world)
     
     if (useKinematic)
     {
-		const tgKinematicActuator::Config muscleConfig(c.stiffness, c.damping);
+		tgKinematicActuator::Config muscleConfig(cableStiffness, c.damping);
+		muscleConfig.implicitForces = useImplicit;
 		spec.addBuilder("muscle", new tgKinematicActuatorInfo(muscleConfig));
 	}
 	else
 	{
-		const tgBasicActuator::Config muscleConfig(c.stiffness, c.damping);
+		tgBasicActuator::Config muscleConfig(cableStiffness, c.damping);
+		muscleConfig.implicitForces = useImplicit;
 		spec.addBuilder("muscle", new tgBasicActuatorInfo(muscleConfig));
 	}
     
@@ -153,7 +157,7 @@ void tsTestRig::setup(tgWorld& world)
 
     // We could now use tgCast::filter or similar to pull out the
     // models (e.g. muscles) that we want to control. 
-    allMuscles = tgCast::filter<tgModel, tgSpringCableActuator> (getDescendants());
+    allMuscles = getDescendantsOfType<tgSpringCableActuator>();
     
     // Notify controllers that setup has finished.
     notifySetup();
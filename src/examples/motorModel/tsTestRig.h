@@ -51,7 +51,15 @@ public:
      * The only constructor. Configuration parameters are within the
      * .cpp file in this case, not passed in. 
      */
-    tsTestRig(bool kinematic = true);
+    /**
+     * @param[in] kinematic use a tgKinematicActuator rather than a
+     * tgBasicActuator
+     * @param[in] implicitCables see
+     * tgSpringCableActuator::Config::implicitForces
+     * @param[in] stiffness the cable stiffness; 0 for the default
+     */
+    tsTestRig(bool kinematic = true, bool implicitCables = false,
+              double stiffness = 0.0);
     
     /**
      * Destructor. Deletes controllers, if any were added during setup.
@@ -139,6 +147,8 @@ private:
     double totalTime;
     bool reached;
     bool useKinematic;
+    bool useImplicit;
+    double cableStiffness;
 };
 
 #endif  // Prism_MODEL_H
@@ -0,0 +1,185 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file AppSolverBenchmark.cpp
+ * @brief Contains the definition function main() for an application that
+ * times the stock models under each constraint solver and broadphase
+ * available through tgWorld::Config
+ * $Id$
+ */
+
+// This application
+#include "../3_prism/PrismModel.h"
+#include "../SUPERball/T6Model.h"
+#include "../NestedTetrahedrons/NestedStructureTestModel.h"
+// This library
+#include "core/terrain/tgBoxGround.h"
+#include "core/tgBaseRigid.h"
+#include "core/tgModel.h"
+#include "core/tgSimView.h"
+#include "core/tgSimulation.h"
+#include "core/tgWorld.h"
+// Bullet Physics
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <ctime>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Combination
+    {
+        const char* name;
+        tgWorld::Config::SolverType solverType;
+        tgWorld::Config::BroadphaseType broadphaseType;
+    };
+
+    // The first is the default configuration, which the others are
+    // compared with
+    const Combination combinations[] =
+    {
+        { "MLCP-Dantzig AxisSweep", tgWorld::Config::eMLCPDantzig,
+          tgWorld::Config::eAxisSweep },
+        { "MLCP-Dantzig Dbvt", tgWorld::Config::eMLCPDantzig,
+          tgWorld::Config::eDbvt },
+        { "MLCP-PGS AxisSweep", tgWorld::Config::eMLCPProjectedGaussSeidel,
+          tgWorld::Config::eAxisSweep },
+        { "MLCP-PGS Dbvt", tgWorld::Config::eMLCPProjectedGaussSeidel,
+          tgWorld::Config::eDbvt },
+        { "SI AxisSweep", tgWorld::Config::eSequentialImpulse,
+          tgWorld::Config::eAxisSweep },
+        { "SI Dbvt", tgWorld::Config::eSequentialImpulse,
+          tgWorld::Config::eDbvt },
+        { "NNCG AxisSweep", tgWorld::Config::eNNCG,
+          tgWorld::Config::eAxisSweep },
+        { "NNCG Dbvt", tgWorld::Config::eNNCG,
+          tgWorld::Config::eDbvt }
+    };
+    const std::size_t numCombinations =
+        sizeof(combinations) / sizeof(combinations[0]);
+
+    const char* const modelNames[] = { "PrismModel", "T6Model", "NestedStructureTestModel" };
+    const std::size_t numModels = sizeof(modelNames) / sizeof(modelNames[0]);
+
+    tgModel* createModel(std::size_t i)
+    {
+        switch (i)
+        {
+        case 0:
+            return new PrismModel();
+        case 1:
+            return new T6Model();
+        default:
+            return new NestedStructureTestModel(4);
+        }
+    }
+
+    /** The mass-weighted centre of all the model's rigid bodies */
+    btVector3 centerOfMass(tgModel& model)
+    {
+        const std::vector<tgBaseRigid*> rigids = model.find<tgBaseRigid>("");
+        btVector3 sum(0.0, 0.0, 0.0);
+        double mass = 0.0;
+        for (std::size_t i = 0; i < rigids.size(); i++)
+        {
+            sum += rigids[i]->centerOfMass() * rigids[i]->mass();
+            mass += rigids[i]->mass();
+        }
+        return mass > 0.0 ? sum / mass : sum;
+    }
+}
+
+/**
+ * The entry point.
+ * @param[in] argc the number of command-line arguments
+ * @param[in] argv argv[0] is the executable name; argv[1], if supplied, is
+ * the number of steps to run each model for
+ * @return 0
+ */
+int main(int argc, char** argv)
+{
+    const int steps = argc > 1 ? std::atoi(argv[1]) : 10000;
+    const double timestep_physics = 0.001; // seconds
+
+    std::cout << "AppSolverBenchmark: " << steps << " steps of "
+              << timestep_physics << " s" << std::endl;
+    std::cout << "Drift is the distance of the final centre of mass from that"
+              << " of the first combination" << std::endl;
+
+    for (std::size_t m = 0; m < numModels; m++)
+    {
+        std::cout << std::endl << modelNames[m] << std::endl;
+
+        btVector3 reference(0.0, 0.0, 0.0);
+        for (std::size_t c = 0; c < numCombinations; c++)
+        {
+            const Combination& combination = combinations[c];
+            std::cout << "  " << std::left << std::setw(24) << combination.name;
+
+            tgWorld::Config config(981, 1000, false,
+                                   combination.solverType, 0,
+                                   combination.broadphaseType);
+            tgBoxGround* ground = new tgBoxGround();
+            tgWorld* pWorld;
+            try
+            {
+                pWorld = new tgWorld(config, ground);
+            }
+            catch (const std::invalid_argument& e)
+            {
+                delete ground;
+                std::cout << "unavailable: " << e.what() << std::endl;
+                continue;
+            }
+
+            {
+                tgSimView view(*pWorld, timestep_physics);
+                tgSimulation simulation(view);
+                tgModel* const pModel = createModel(m);
+                simulation.addModel(pModel);
+
+                const std::clock_t start = std::clock();
+                simulation.run(steps);
+                const double seconds =
+                    double(std::clock() - start) / CLOCKS_PER_SEC;
+
+                const btVector3 com = centerOfMass(*pModel);
+                if (c == 0)
+                {
+                    reference = com;
+                }
+                std::cout << std::right << std::setw(10) << std::fixed
+                          << std::setprecision(0)
+                          << (seconds > 0.0 ? steps / seconds : 0.0)
+                          << " steps/s  drift " << std::setprecision(4)
+                          << (com - reference).length() << std::endl;
+            }
+            // The simulation has deleted the model; the world deletes the
+            // ground
+            delete pWorld;
+        }
+    }
+
+    return 0;
+}
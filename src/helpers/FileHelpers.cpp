@@ -24,17 +24,208 @@
 
 #include <string>
 #include <fstream>
+#include <map>
 #include <sstream>
 #include "FileHelpers.h"
 #include "resources.h"
 
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 using namespace std;
 
+struct FileHelpers::Resource::Mapping
+{
+    /** NULL for an empty file */
+    void* pMap;
+    std::size_t size;
+
+    /** What the file was when mapped */
+    dev_t device;
+    ino_t inode;
+    time_t mtime;
+    long mtimeNanoseconds;
+
+    /** Resources sharing the mapping, including the cache's */
+    volatile int references;
+};
+
+namespace
+{
+    typedef FileHelpers::Resource Resource;
+
+    /** The latest mapping of each file name */
+    std::map<std::string, Resource> resources;
+
+    /** Guards resources */
+    pthread_mutex_t resourceMutex = PTHREAD_MUTEX_INITIALIZER;
+
+    bool sameFile(const struct stat& info, dev_t device, ino_t inode,
+                  std::size_t size, time_t mtime, long mtimeNanoseconds)
+    {
+        return info.st_dev == device && info.st_ino == inode &&
+            static_cast<std::size_t>(info.st_size) == size &&
+            info.st_mtim.tv_sec == mtime &&
+            info.st_mtim.tv_nsec == mtimeNanoseconds;
+    }
+}
+
+FileHelpers::Resource::Resource() :
+m_pMapping(NULL)
+{
+}
+
+FileHelpers::Resource::Resource(Mapping* pMapping) :
+m_pMapping(pMapping)
+{
+}
+
+FileHelpers::Resource::Resource(const Resource& other) :
+m_pMapping(other.m_pMapping)
+{
+    if (m_pMapping != NULL)
+    {
+        __sync_add_and_fetch(&m_pMapping->references, 1);
+    }
+}
+
+FileHelpers::Resource& FileHelpers::Resource::operator=(const Resource& other)
+{
+    // Take the new reference first, in case both share a mapping
+    Resource copy(other);
+    Mapping* const pOld = m_pMapping;
+    m_pMapping = copy.m_pMapping;
+    copy.m_pMapping = pOld;
+    return *this;
+}
+
+FileHelpers::Resource::~Resource()
+{
+    if (m_pMapping != NULL &&
+        __sync_sub_and_fetch(&m_pMapping->references, 1) == 0)
+    {
+        if (m_pMapping->pMap != NULL)
+        {
+            munmap(m_pMapping->pMap, m_pMapping->size);
+        }
+        delete m_pMapping;
+    }
+}
+
+bool FileHelpers::Resource::isValid() const
+{
+    return m_pMapping != NULL;
+}
+
+const char* FileHelpers::Resource::data() const
+{
+    return m_pMapping != NULL && m_pMapping->pMap != NULL ?
+        static_cast<const char*>(m_pMapping->pMap) : "";
+}
+
+std::size_t FileHelpers::Resource::size() const
+{
+    return m_pMapping != NULL ? m_pMapping->size : 0;
+}
+
+std::string FileHelpers::Resource::str() const
+{
+    return std::string(data(), size());
+}
+
+FileHelpers::ResourceStream::Buffer::Buffer(const char* begin, std::size_t size)
+{
+    // Only ever read
+    char* const pBegin = const_cast<char*>(begin);
+    setg(pBegin, pBegin, pBegin + size);
+}
+
+FileHelpers::ResourceStream::ResourceStream(const Resource& resource) :
+std::istream(NULL),
+m_resource(resource),
+m_buffer(resource.data(), resource.size())
+{
+    rdbuf(&m_buffer);
+}
+
+FileHelpers::Resource FileHelpers::getResource(const std::string& fileName)
+{
+    struct stat info;
+    if (stat(fileName.c_str(), &info) != 0)
+    {
+        return Resource();
+    }
+
+    pthread_mutex_lock(&resourceMutex);
+    std::map<std::string, Resource>::iterator it = resources.find(fileName);
+    if (it != resources.end())
+    {
+        const Resource::Mapping& mapping = *it->second.m_pMapping;
+        if (sameFile(info, mapping.device, mapping.inode, mapping.size,
+                     mapping.mtime, mapping.mtimeNanoseconds))
+        {
+            const Resource found = it->second;
+            pthread_mutex_unlock(&resourceMutex);
+            return found;
+        }
+    }
+
+    // Map under the lock, so each version is only mapped once
+    Resource mapped;
+    const int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd >= 0 && fstat(fd, &info) == 0 && S_ISREG(info.st_mode))
+    {
+        void* pMap = NULL;
+        if (info.st_size > 0)
+        {
+            pMap = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        if (pMap != MAP_FAILED)
+        {
+            Resource::Mapping* const pMapping = new Resource::Mapping();
+            pMapping->pMap = pMap;
+            pMapping->size = info.st_size;
+            pMapping->device = info.st_dev;
+            pMapping->inode = info.st_ino;
+            pMapping->mtime = info.st_mtim.tv_sec;
+            pMapping->mtimeNanoseconds = info.st_mtim.tv_nsec;
+            pMapping->references = 1;
+            mapped = Resource(pMapping);
+            resources[fileName] = mapped;
+        }
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    pthread_mutex_unlock(&resourceMutex);
+    return mapped;
+}
+
+bool FileHelpers::isCurrent(const std::string& fileName, const Resource& resource)
+{
+    struct stat info;
+    if (!resource.isValid() || stat(fileName.c_str(), &info) != 0)
+    {
+        return false;
+    }
+    const Resource::Mapping& mapping = *resource.m_pMapping;
+    return sameFile(info, mapping.device, mapping.inode, mapping.size,
+                    mapping.mtime, mapping.mtimeNanoseconds);
+}
+
+void FileHelpers::clearResources()
+{
+    pthread_mutex_lock(&resourceMutex);
+    resources.clear();
+    pthread_mutex_unlock(&resourceMutex);
+}
+
 std::string FileHelpers::getFileString(std::string fileName) {
-    std::ifstream fileInput(fileName.c_str());
-    stringstream buffer;
-    buffer << fileInput.rdbuf();
-    return buffer.str();
+    return getResource(fileName).str();
 }
 
 std::string FileHelpers::getResourcePath(std::string relPath) {
@@ -27,12 +27,94 @@
 #ifndef FILE_HELPERS_H 
 #define FILE_HELPERS_H 
 
+#include <cstddef>
+#include <istream>
+#include <streambuf>
 #include <string>
 
 class FileHelpers 
 {
 public: 
     
+    /**
+     * A whole file mapped read only by getResource. Copies share the
+     * mapping, which is unmapped when the last copy goes, so a resource
+     * stays readable after the cache has mapped a newer version of its
+     * file. A file truncated in place while it is being read will
+     * fault, as with any mapping; write new versions to a temporary file
+     * and rename them into place instead.
+     */
+    class Resource
+    {
+    public:
+        /** No file */
+        Resource();
+
+        Resource(const Resource& other);
+
+        Resource& operator=(const Resource& other);
+
+        ~Resource();
+
+        /** False if the file could not be opened */
+        bool isValid() const;
+
+        /** The file's bytes; not terminated */
+        const char* data() const;
+
+        std::size_t size() const;
+
+        /** A copy of the file's bytes */
+        std::string str() const;
+
+    private:
+        struct Mapping;
+
+        explicit Resource(Mapping* pMapping);
+
+        Mapping* m_pMapping;
+
+        friend class FileHelpers;
+    };
+
+    /** An input stream over a resource's bytes, read in place */
+    class ResourceStream : public std::istream
+    {
+    public:
+        explicit ResourceStream(const Resource& resource);
+
+    private:
+        class Buffer : public std::streambuf
+        {
+        public:
+            Buffer(const char* begin, std::size_t size);
+        };
+
+        /** Keeps the mapping alive */
+        const Resource m_resource;
+
+        Buffer m_buffer;
+    };
+
+    /**
+     * The contents of a file, mapped once per process. Later calls for
+     * the same name hand out the same mapping for as long as the file
+     * keeps its inode, size and modification time, and map it again
+     * once it changes. Safe to call from several threads.
+     * @return a resource that is not valid if the file cannot be opened
+     */
+    static Resource getResource(const std::string& fileName);
+
+    /**
+     * Whether a resource's file still has the inode, size and
+     * modification time it had when mapped
+     */
+    static bool isCurrent(const std::string& fileName, const Resource& resource);
+
+    /** Drop the cache's mappings; resources still held stay valid */
+    static void clearResources();
+
+    /** The contents of a file, read through getResource; empty if unreadable */
     static std::string getFileString(std::string fileName);
     /**
      * Directs to resources/src
@@ -0,0 +1,307 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgControllerParams.cpp
+ * @brief Contains the definitions of members of class tgControllerParams
+ * $Id$
+ */
+
+#include "tgControllerParams.h"
+#include "tgParameterBlock.h"
+#include "FileHelpers.h"
+#include "core/tgTrialTiming.h"
+
+#include <json/json.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <pthread.h>
+
+namespace
+{
+    /** The current parameters of each file */
+    std::map<std::string, tgControllerParams*> current;
+
+    /** Replaced by reload, kept for the controllers still reading them */
+    std::vector<tgControllerParams*> retired;
+
+    /** The blocks mapped so far, by path */
+    std::map<std::string, tgParameterBlock*> blocks;
+
+    /** Guards current, retired and blocks */
+    pthread_mutex_t storeMutex = PTHREAD_MUTEX_INITIALIZER;
+
+    /** Unlocks the store when leaving a scope, including by a throw */
+    class StoreLock
+    {
+    public:
+        StoreLock()
+        {
+            pthread_mutex_lock(&storeMutex);
+        }
+        ~StoreLock()
+        {
+            pthread_mutex_unlock(&storeMutex);
+        }
+    };
+
+    /** Map a block on first use. Call with the store locked. */
+    tgParameterBlock& getBlock(const std::string& path)
+    {
+        tgParameterBlock*& pBlock = blocks[path];
+        if (pBlock == NULL)
+        {
+            try
+            {
+                pBlock = new tgParameterBlock(path);
+            }
+            catch (...)
+            {
+                blocks.erase(path);
+                throw;
+            }
+        }
+        return *pBlock;
+    }
+}
+
+const tgControllerParams& tgControllerParams::get(const std::string& fileName)
+{
+    StoreLock lock;
+    std::map<std::string, tgControllerParams*>::iterator it =
+        current.find(fileName);
+    if (it != current.end())
+    {
+        std::string path;
+        std::size_t trial;
+        // A block trial is current until the master writes the next
+        // generation, a file until it is written again
+        const bool isCurrent =
+            tgParameterBlock::isReference(fileName, path, trial) ?
+            getBlock(path).getGeneration() == it->second->m_generation :
+            FileHelpers::isCurrent(fileName, it->second->m_source);
+        if (isCurrent)
+        {
+            return *it->second;
+        }
+    }
+    // Parse under the lock, so each file is only parsed once
+    tgControllerParams* const pParams = create(fileName);
+    if (it != current.end())
+    {
+        retired.push_back(it->second);
+        it->second = pParams;
+    }
+    else
+    {
+        current[fileName] = pParams;
+    }
+    return *pParams;
+}
+
+const tgControllerParams& tgControllerParams::reload(const std::string& fileName)
+{
+    StoreLock lock;
+    tgControllerParams* const pParams = create(fileName);
+    tgControllerParams*& pCurrent = current[fileName];
+    if (pCurrent != NULL)
+    {
+        retired.push_back(pCurrent);
+    }
+    pCurrent = pParams;
+    return *pParams;
+}
+
+bool tgControllerParams::writeScores(const std::string& fileName,
+                                     const std::vector<double>& scores)
+{
+    std::string path;
+    std::size_t trial;
+    if (!tgParameterBlock::isReference(fileName, path, trial))
+    {
+        return false;
+    }
+    tgTrialTiming::Scope timing(tgTrialTiming::eLogIO);
+    StoreLock lock;
+    getBlock(path).appendScores(trial, scores);
+    return true;
+}
+
+tgControllerParams* tgControllerParams::create(const std::string& fileName)
+{
+    tgTrialTiming::Scope timing(tgTrialTiming::eConfig);
+    std::string path;
+    std::size_t trial;
+    if (tgParameterBlock::isReference(fileName, path, trial))
+    {
+        return new tgControllerParams(getBlock(path), trial);
+    }
+    return new tgControllerParams(fileName);
+}
+
+tgControllerParams::tgControllerParams(const std::string& fileName) :
+m_generation(0),
+m_source(FileHelpers::getResource(fileName))
+{
+    Json::Reader reader;
+    const bool parsingSuccessful =
+        reader.parse(m_source.data(), m_source.data() + m_source.size(), m_root);
+    if (!parsingSuccessful)
+    {
+        // report to the user the failure and their locations in the document.
+        std::cout << "Failed to parse configuration\n"
+            << reader.getFormattedErrorMessages();
+        throw std::invalid_argument("Bad filename for JSON");
+    }
+
+    if (m_root.isObject())
+    {
+        const Json::Value::Members names = m_root.getMemberNames();
+        for (std::size_t i = 0; i < names.size(); i++)
+        {
+            const Json::Value& member = m_root[names[i]];
+            if (member.isObject() && member.isMember("params"))
+            {
+                addTable(names[i], member["params"]);
+            }
+        }
+    }
+}
+
+tgControllerParams::tgControllerParams(const tgParameterBlock& block,
+                                       std::size_t trial) :
+m_generation(block.getGeneration())
+{
+    const std::string document = block.getDocument();
+    if (!document.empty())
+    {
+        Json::Reader reader;
+        if (!reader.parse(document, m_root))
+        {
+            std::cout << "Failed to parse parameter block document\n"
+                << reader.getFormattedErrorMessages();
+            throw std::invalid_argument("Bad document in parameter block");
+        }
+    }
+    // Members that differ per trial, such as neural network file names
+    if (m_root.isObject() && m_root.isMember("trials"))
+    {
+        const Json::Value trials = m_root["trials"];
+        m_root.removeMember("trials");
+        if (trials.isArray() && trial < trials.size())
+        {
+            const Json::Value& own = trials[static_cast<Json::Value::ArrayIndex>(trial)];
+            const Json::Value::Members names = own.getMemberNames();
+            for (std::size_t i = 0; i < names.size(); i++)
+            {
+                m_root[names[i]] = own[names[i]];
+            }
+        }
+    }
+
+    const double* const params = block.getParams(trial);
+    const std::vector<tgParameterBlock::Section>& sections = block.getSections();
+    for (std::size_t i = 0; i < sections.size(); i++)
+    {
+        const tgParameterBlock::Section& section = sections[i];
+        Table table;
+        table.rows = section.rows;
+        table.columns = section.columns;
+        const double* const first = params + section.offset;
+        table.values.assign(first, first + section.rows * section.columns);
+
+        // The same array a JSON file would hold, for the Json::Value hooks
+        Json::Value array(Json::arrayValue);
+        for (std::size_t r = 0; r < table.rows; r++)
+        {
+            if (table.columns == 1)
+            {
+                array.append(table.at(r, 0));
+                continue;
+            }
+            Json::Value entry(Json::arrayValue);
+            for (std::size_t c = 0; c < table.columns; c++)
+            {
+                entry.append(table.at(r, c));
+            }
+            array.append(entry);
+        }
+        m_root[section.name]["params"] = array;
+
+        m_indices[section.name] = m_tables.size();
+        m_tables.push_back(table);
+    }
+}
+
+void tgControllerParams::addTable(const std::string& name,
+                                  const Json::Value& params)
+{
+    if (!params.isArray() || params.size() == 0)
+    {
+        return;
+    }
+
+    Table table;
+    table.rows = params.size();
+    table.columns = params[0u].isArray() ? params[0u].size() : 1;
+    table.values.reserve(table.rows * table.columns);
+    for (Json::Value::ArrayIndex r = 0; r < params.size(); r++)
+    {
+        const Json::Value& entry = params[r];
+        if (entry.isNumeric())
+        {
+            if (table.columns != 1 || params[0u].isArray())
+            {
+                return;
+            }
+            table.values.push_back(entry.asDouble());
+            continue;
+        }
+        if (!entry.isArray() || entry.size() != table.columns)
+        {
+            return;
+        }
+        for (Json::Value::ArrayIndex c = 0; c < entry.size(); c++)
+        {
+            if (!entry[c].isNumeric())
+            {
+                return;
+            }
+            table.values.push_back(entry[c].asDouble());
+        }
+    }
+
+    m_indices[name] = m_tables.size();
+    m_tables.push_back(table);
+}
+
+bool tgControllerParams::hasTable(const std::string& name) const
+{
+    return m_indices.find(name) != m_indices.end();
+}
+
+std::size_t tgControllerParams::getIndex(const std::string& name) const
+{
+    std::map<std::string, std::size_t>::const_iterator it = m_indices.find(name);
+    if (it == m_indices.end())
+    {
+        throw std::invalid_argument("No params table named " + name);
+    }
+    return it->second;
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CONTROLLER_PARAMS_H
+#define TG_CONTROLLER_PARAMS_H
+
+/**
+ * @file tgControllerParams.h
+ * @brief Contains the definition of class tgControllerParams, the
+ * parameters of a JSON controller file, parsed once per process.
+ * $Id$
+ */
+
+#include "FileHelpers.h"
+
+#include <json/value.h>
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class tgParameterBlock;
+
+/**
+ * The parameters of a JSON control file, such as the controlVars.json
+ * the learning scripts write for JSONCPGControl. Controllers used to
+ * parse their file in every onSetup, so on every reset; get parses each
+ * file once and hands every later caller, in any thread, the same
+ * immutable copy.
+ *
+ * Besides the parsed document, every top level member with a "params"
+ * array of numbers, or of equal length arrays of numbers, is flattened
+ * into a Table: "nodeVals" and "edgeVals" of the CPG controllers,
+ * "feedbackVals" gains and the like. A controller looks up the index of
+ * its tables once and then reads plain doubles.
+ *
+ * Files are read in place through FileHelpers::getResource, and get
+ * parses a file again once it has changed on disk. Learning jobs that
+ * write new parameters too quickly for the file's modification time to
+ * show it call reload. Earlier versions stay alive until the process
+ * ends, so a controller that is still running keeps reading the
+ * parameters it started with.
+ *
+ * A file name of the form "<path>#<trial>" names a trial of a
+ * tgParameterBlock instead, which the job master writes in place of a
+ * JSON file per trial. Its tables come straight from the mapped
+ * parameters, the document is the block's shared JSON with a "params"
+ * array per section, and get builds them again whenever the master has
+ * written a new generation. Scores go back into the block through
+ * writeScores.
+ */
+class tgControllerParams
+{
+public:
+
+    /** A params array, row-major */
+    struct Table
+    {
+        Table() :
+            rows(0),
+            columns(0)
+        {
+        }
+
+        /** The number at row r, column c */
+        double at(std::size_t r, std::size_t c) const
+        {
+            return values[r * columns + c];
+        }
+
+        /** The first number of row r; columns follow */
+        const double* row(std::size_t r) const
+        {
+            return &values[r * columns];
+        }
+
+        /** Entries of the params array */
+        std::size_t rows;
+
+        /** Numbers in each entry; 1 if the entries are plain numbers */
+        std::size_t columns;
+
+        std::vector<double> values;
+    };
+
+    /**
+     * The parameters of a file, parsing it on the first call for that
+     * file name and again once the file has changed. Safe to call from
+     * several threads.
+     * @throw std::invalid_argument if the file cannot be parsed, as
+     * the controllers reported before
+     */
+    static const tgControllerParams& get(const std::string& fileName);
+
+    /**
+     * Parse a file again, for the calls of get that follow, because new
+     * parameters have been written to it.
+     * @throw std::invalid_argument if the file cannot be parsed; the
+     * parameters already loaded are kept
+     */
+    static const tgControllerParams& reload(const std::string& fileName);
+
+    /**
+     * Append a row of scores to the trial a file name refers to, if it
+     * is a parameter block reference.
+     * @return false if the name is a plain file, for the caller to write
+     * its scores there as before
+     * @throw std::runtime_error if the block cannot be mapped
+     * @throw std::out_of_range if the trial's score rows are full
+     */
+    static bool writeScores(const std::string& fileName,
+                            const std::vector<double>& scores);
+
+    /** The whole parsed document, for values other than tables */
+    const Json::Value& getRoot() const
+    {
+        return m_root;
+    }
+
+    /** Whether a top level member has a table */
+    bool hasTable(const std::string& name) const;
+
+    /**
+     * The index of a top level member's table, to bind to once.
+     * @throw std::invalid_argument if the member has no table
+     */
+    std::size_t getIndex(const std::string& name) const;
+
+    const Table& getTable(std::size_t index) const
+    {
+        return m_tables[index];
+    }
+
+    /** The table of a top level member, as getTable(getIndex(name)) */
+    const Table& getTable(const std::string& name) const
+    {
+        return m_tables[getIndex(name)];
+    }
+
+private:
+
+    /** Parse a file and flatten its tables */
+    explicit tgControllerParams(const std::string& fileName);
+
+    /** Build the parameters of a trial of a block */
+    tgControllerParams(const tgParameterBlock& block, std::size_t trial);
+
+    /** Parse a file or read a block trial, whichever the name refers to */
+    static tgControllerParams* create(const std::string& fileName);
+
+    /** Not copyable */
+    tgControllerParams(const tgControllerParams&);
+    tgControllerParams& operator=(const tgControllerParams&);
+
+    /** Add the table of a params array, if it is all numbers */
+    void addTable(const std::string& name, const Json::Value& params);
+
+    /** Of the block read, 0 for a file */
+    const uint64_t m_generation;
+
+    /** The file parsed; not valid for a block trial */
+    FileHelpers::Resource m_source;
+
+    Json::Value m_root;
+
+    std::vector<Table> m_tables;
+
+    std::map<std::string, std::size_t> m_indices;
+};
+
+#endif  // TG_CONTROLLER_PARAMS_H
@@ -0,0 +1,244 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgParameterBlock.cpp
+ * @brief Contains the definitions of members of class tgParameterBlock
+ * $Id$
+ */
+
+#include "tgParameterBlock.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char magic[8] = { 'N', 'T', 'R', 'T', 'B', 'L', 'K', '1' };
+    const uint32_t version = 1;
+
+    // Byte offsets of the header fields
+    const std::size_t versionField = 8;
+    const std::size_t sectionsField = 12;
+    const std::size_t generationField = 16;
+    const std::size_t trialsField = 24;
+    const std::size_t paramsPerTrialField = 32;
+    const std::size_t scoreColumnsField = 40;
+    const std::size_t scoreRowsField = 48;
+    const std::size_t documentOffsetField = 56;
+    const std::size_t documentSizeField = 64;
+    const std::size_t sectionsOffsetField = 72;
+    const std::size_t paramsOffsetField = 80;
+    const std::size_t countsOffsetField = 88;
+    const std::size_t scoresOffsetField = 96;
+    const std::size_t fileSizeField = 104;
+    const std::size_t headerSize = 112;
+
+    const std::size_t sectionNameSize = 32;
+    const std::size_t sectionSize = 48;
+}
+
+tgParameterBlock::tgParameterBlock(const std::string& path) :
+m_path(path),
+m_pData(NULL),
+m_size(0)
+{
+    const int fd = open(path.c_str(), O_RDWR);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Cannot open parameter block " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(headerSize))
+    {
+        close(fd);
+        throw std::runtime_error("Parameter block is too short " + path);
+    }
+    m_size = info.st_size;
+    void* const pMap = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // The mapping keeps the file
+    close(fd);
+    if (pMap == MAP_FAILED)
+    {
+        throw std::runtime_error("Cannot map parameter block " + path);
+    }
+    m_pData = static_cast<char*>(pMap);
+
+    try
+    {
+        uint32_t fileVersion = 0;
+        std::memcpy(&fileVersion, m_pData + versionField, sizeof(fileVersion));
+        if (std::memcmp(m_pData, magic, sizeof(magic)) != 0 ||
+            fileVersion != version || field(fileSizeField) != m_size)
+        {
+            throw std::runtime_error("Not a parameter block " + path);
+        }
+
+        uint32_t sections = 0;
+        std::memcpy(&sections, m_pData + sectionsField, sizeof(sections));
+        const uint64_t trials = field(trialsField);
+        const uint64_t params = field(paramsPerTrialField);
+        const uint64_t scoreValues = field(scoreColumnsField) * field(scoreRowsField);
+        checkRegion(field(documentOffsetField), field(documentSizeField));
+        checkRegion(field(sectionsOffsetField), sections * sectionSize);
+        checkRegion(field(paramsOffsetField), trials * params * sizeof(double));
+        checkRegion(field(countsOffsetField), trials * sizeof(uint64_t));
+        checkRegion(field(scoresOffsetField), trials * scoreValues * sizeof(double));
+
+        const char* pSection = m_pData + field(sectionsOffsetField);
+        for (uint32_t i = 0; i < sections; i++, pSection += sectionSize)
+        {
+            uint32_t shape[3];
+            std::memcpy(shape, pSection + sectionNameSize, sizeof(shape));
+            Section section;
+            section.name.assign(pSection, strnlen(pSection, sectionNameSize));
+            section.offset = shape[0];
+            section.rows = shape[1];
+            section.columns = shape[2];
+            if (section.offset + section.rows * section.columns > params)
+            {
+                throw std::runtime_error("Parameter block section " +
+                                         section.name + " overruns " + path);
+            }
+            m_sections.push_back(section);
+        }
+    }
+    catch (...)
+    {
+        munmap(m_pData, m_size);
+        throw;
+    }
+}
+
+tgParameterBlock::~tgParameterBlock()
+{
+    munmap(m_pData, m_size);
+}
+
+bool tgParameterBlock::isReference(const std::string& name, std::string& path,
+                                   std::size_t& trial)
+{
+    const std::size_t hash = name.rfind('#');
+    if (hash == std::string::npos || hash == 0 || hash + 1 == name.size())
+    {
+        return false;
+    }
+    const std::string number = name.substr(hash + 1);
+    if (number.find_first_not_of("0123456789") != std::string::npos)
+    {
+        return false;
+    }
+    path = name.substr(0, hash);
+    trial = std::strtoul(number.c_str(), NULL, 10);
+    return true;
+}
+
+uint64_t tgParameterBlock::getGeneration() const
+{
+    return field(generationField);
+}
+
+std::size_t tgParameterBlock::getTrials() const
+{
+    return field(trialsField);
+}
+
+std::size_t tgParameterBlock::getParamsPerTrial() const
+{
+    return field(paramsPerTrialField);
+}
+
+std::string tgParameterBlock::getDocument() const
+{
+    // The master may rewrite the document within its space each generation
+    checkRegion(field(documentOffsetField), field(documentSizeField));
+    return std::string(m_pData + field(documentOffsetField),
+                       field(documentSizeField));
+}
+
+const double* tgParameterBlock::getParams(std::size_t trial) const
+{
+    if (trial >= getTrials())
+    {
+        throw std::out_of_range("No such trial in parameter block " + m_path);
+    }
+    return reinterpret_cast<const double*>(m_pData + field(paramsOffsetField)) +
+        trial * getParamsPerTrial();
+}
+
+std::size_t tgParameterBlock::getScoreColumns() const
+{
+    return field(scoreColumnsField);
+}
+
+void tgParameterBlock::appendScores(std::size_t trial,
+                                    const std::vector<double>& scores)
+{
+    if (trial >= getTrials())
+    {
+        throw std::out_of_range("No such trial in parameter block " + m_path);
+    }
+    const std::size_t columns = getScoreColumns();
+    if (scores.size() != columns)
+    {
+        throw std::invalid_argument("Wrong number of scores for parameter block " + m_path);
+    }
+
+    uint64_t* const pCount =
+        reinterpret_cast<uint64_t*>(m_pData + field(countsOffsetField)) + trial;
+    const uint64_t rows = field(scoreRowsField);
+    if (*pCount >= rows)
+    {
+        throw std::out_of_range("Score rows are full in parameter block " + m_path);
+    }
+    double* const pRow = reinterpret_cast<double*>(m_pData + field(scoresOffsetField)) +
+        (trial * rows + *pCount) * columns;
+    std::copy(scores.begin(), scores.end(), pRow);
+    // The count last, so the master never reads a partial row
+    __sync_synchronize();
+    (*pCount)++;
+}
+
+std::size_t tgParameterBlock::getScoreRows(std::size_t trial) const
+{
+    if (trial >= getTrials())
+    {
+        throw std::out_of_range("No such trial in parameter block " + m_path);
+    }
+    return reinterpret_cast<const uint64_t*>(m_pData + field(countsOffsetField))[trial];
+}
+
+uint64_t tgParameterBlock::field(std::size_t offset) const
+{
+    uint64_t value = 0;
+    std::memcpy(&value, m_pData + offset, sizeof(value));
+    return value;
+}
+
+void tgParameterBlock::checkRegion(uint64_t offset, uint64_t size) const
+{
+    if (offset % sizeof(double) != 0 || offset > m_size || size > m_size - offset)
+    {
+        throw std::runtime_error("Parameter block region out of bounds " + m_path);
+    }
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_PARAMETER_BLOCK_H
+#define TG_PARAMETER_BLOCK_H
+
+/**
+ * @file tgParameterBlock.h
+ * @brief Contains the definition of class tgParameterBlock, a memory
+ * mapped file of the parameters and scores of a batch of trials.
+ * $Id$
+ */
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * A batch of trials' parameters and scores in one memory mapped file,
+ * written by the Python job master (scripts/learning/src/param_block.py)
+ * in place of a JSON file per trial. Every process running the batch
+ * maps the same file, reads its trial's parameters where they lie and
+ * writes its scores back beside them.
+ *
+ * The file, in native byte order, is a header:
+ *
+ *     char     magic[8]          "NTRTBLK1"
+ *     uint32   version           1
+ *     uint32   sections
+ *     uint64   generation        changed by the master on each rewrite
+ *     uint64   trials
+ *     uint64   paramsPerTrial
+ *     uint64   scoreColumns
+ *     uint64   scoreRows         capacity per trial
+ *     uint64   documentOffset    JSON text shared by every trial
+ *     uint64   documentSize      in use, up to the space before sections
+ *     uint64   sectionsOffset
+ *     uint64   paramsOffset
+ *     uint64   countsOffset      uint64 score rows written, per trial
+ *     uint64   scoresOffset
+ *     uint64   fileSize
+ *
+ * then the sections, each char name[32] and uint32 offset, rows,
+ * columns and padding, naming a rows x columns slice of every trial's
+ * parameters, then the regions at their offsets. The parameters and
+ * scores are doubles.
+ */
+class tgParameterBlock
+{
+public:
+
+    /** A named slice of each trial's parameters, row-major */
+    struct Section
+    {
+        std::string name;
+        /** In doubles from the start of a trial's parameters */
+        std::size_t offset;
+        std::size_t rows;
+        std::size_t columns;
+    };
+
+    /**
+     * Map a block for reading and writing scores.
+     * @throw std::runtime_error if the file cannot be opened or mapped
+     * or is not a block
+     */
+    explicit tgParameterBlock(const std::string& path);
+
+    /** Unmaps the file */
+    ~tgParameterBlock();
+
+    /**
+     * Whether a name refers to a trial of a block, "<path>#<trial>"
+     * @param[out] path the block's file, if so
+     * @param[out] trial the trial, if so
+     */
+    static bool isReference(const std::string& name, std::string& path,
+                            std::size_t& trial);
+
+    /** Changes each time the master writes new parameters */
+    uint64_t getGeneration() const;
+
+    std::size_t getTrials() const;
+
+    std::size_t getParamsPerTrial() const;
+
+    const std::vector<Section>& getSections() const
+    {
+        return m_sections;
+    }
+
+    /**
+     * The JSON text shared by every trial, possibly empty. Its "trials"
+     * array, if any, holds members that differ per trial.
+     */
+    std::string getDocument() const;
+
+    /**
+     * A trial's parameters, in the mapped file.
+     * @throw std::out_of_range if there is no such trial
+     */
+    const double* getParams(std::size_t trial) const;
+
+    std::size_t getScoreColumns() const;
+
+    /**
+     * Append a row of scores to a trial. Each trial must be run by one
+     * process at a time, as the master's jobs are.
+     * @throw std::out_of_range if there is no such trial or its rows
+     * are full
+     * @throw std::invalid_argument if the row is not scoreColumns long
+     */
+    void appendScores(std::size_t trial, const std::vector<double>& scores);
+
+    /** The rows of scores a trial has written */
+    std::size_t getScoreRows(std::size_t trial) const;
+
+private:
+
+    /** Not copyable */
+    tgParameterBlock(const tgParameterBlock&);
+    tgParameterBlock& operator=(const tgParameterBlock&);
+
+    /** The header field at a byte offset */
+    uint64_t field(std::size_t offset) const;
+
+    /** Check a region lies within the file */
+    void checkRegion(uint64_t offset, uint64_t size) const;
+
+    const std::string m_path;
+
+    char* m_pData;
+
+    std::size_t m_size;
+
+    std::vector<Section> m_sections;
+};
+
+#endif  // TG_PARAMETER_BLOCK_H
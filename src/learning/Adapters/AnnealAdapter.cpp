@@ -30,19 +30,90 @@
 #include <sstream>
 #include <fstream>
 #include "AnnealAdapter.h"
+#include "learning/SPSA/SPSAEvolution.h"
+#include "learning/CMAES/CMAESEvolution.h"
 #include "learning/Configuration/configuration.h"
 #include "helpers/FileHelpers.h"
+#include "core/tgMetrics.h"
+#include "core/tgTeardownQueue.h"
+#include "core/tgTraceRecorder.h"
+#include "core/tgTrialTiming.h"
 
 using namespace std;
 
+namespace
+{
+    /** The learner's side of endEpisode, for tgTeardownQueue */
+    class ScoreUpdate : public tgTeardownQueue::Task
+    {
+    public:
+        ScoreUpdate(AnnealEvolution* annealEvo, SPSAEvolution* spsaEvo,
+                    CMAESEvolution* cmaesEvo,
+                    const vector<AnnealEvoMember*>& controllers,
+                    const vector<double>& scores, int fidelity) :
+        annealEvo(annealEvo),
+        spsaEvo(spsaEvo),
+        cmaesEvo(cmaesEvo),
+        controllers(controllers),
+        scores(scores),
+        fidelity(fidelity)
+        {
+        }
+
+        virtual void run()
+        {
+            // The evolution writes its logs as it takes the scores
+            tgTrialTiming::Scope timing(tgTrialTiming::eLogIO);
+            tgTraceRecorder::Scope trace("learner update");
+            tgMetrics::add(tgMetrics::eEpisodes, 1.0);
+            if(scores.size()==0)
+            {
+                vector< double > tmp(1);
+                tmp[0]=-1;
+                scores=tmp;
+                cout<<"Exploded"<<endl;
+            }
+            else
+            {
+                tgMetrics::raise(tgMetrics::eBestFitness, scores[0]);
+                cout<<"Dist Moved: "<<scores[0]<<" energy: "<<scores[1]<<endl;
+//              double combinedScore=scores[0]*1.0-scores[1]*1.0;
+            }
+            if(spsaEvo != NULL)
+                spsaEvo->updateScores(scores);
+            else if(cmaesEvo != NULL)
+                cmaesEvo->updateScores(scores);
+            else
+                annealEvo->updateScores(controllers, scores, fidelity);
+        }
+
+    private:
+        AnnealEvolution* const annealEvo;
+        SPSAEvolution* const spsaEvo;
+        CMAESEvolution* const cmaesEvo;
+        const vector<AnnealEvoMember*> controllers;
+        vector<double> scores;
+        const int fidelity;
+    };
+}
+
 AnnealAdapter::AnnealAdapter() :
+annealEvo(NULL),
+spsaEvo(NULL),
+cmaesEvo(NULL),
 totalTime(0.0)
 {
 }
-AnnealAdapter::~AnnealAdapter(){};
+AnnealAdapter::~AnnealAdapter()
+{
+    // A score update may still be using the evolution
+    tgTeardownQueue::waitIdle();
+}
 
-void AnnealAdapter::initialize(AnnealEvolution *evo,bool isLearning,configuration configdata)
+void AnnealAdapter::initialize(AnnealEvolution *evo,bool isLearning,const configuration& configdata)
 {
+    // The next controllers depend on the scores of the last ones
+    tgTeardownQueue::drain();
     numberOfActions=configdata.getDoubleValue("numberOfActions");
     numberOfStates=configdata.getDoubleValue("numberOfStates");
     numberOfControllers=configdata.getDoubleValue("numberOfControllers");
@@ -50,6 +121,8 @@ void AnnealAdapter::initialize(AnnealEvolution *evo,bool isLearning,configuratio
 
     //This Function initializes the parameterset from evo.
     this->annealEvo = evo;
+    this->spsaEvo = NULL;
+    this->cmaesEvo = NULL;
     if(isLearning)
     {
         currentControllers = this->annealEvo->nextSetOfControllers();
@@ -66,10 +139,62 @@ void AnnealAdapter::initialize(AnnealEvolution *evo,bool isLearning,configuratio
         }
     }
     errorOfFirstController=0.0;
+    pruningTrial = TrialPruner::Trial();
+}
+
+void AnnealAdapter::initialize(SPSAEvolution *evo,bool isLearning,const configuration& configdata)
+{
+    tgTeardownQueue::drain();
+    numberOfActions=configdata.getDoubleValue("numberOfActions");
+    numberOfStates=configdata.getDoubleValue("numberOfStates");
+    numberOfControllers=configdata.getDoubleValue("numberOfControllers");
+    totalTime=0.0;
+
+    this->annealEvo = NULL;
+    this->spsaEvo = evo;
+    this->cmaesEvo = NULL;
+    currentControllers = this->spsaEvo->nextSetOfControllers();
+    if(!isLearning)
+    {
+        for(int i=0;i<currentControllers.size();i++)
+        {
+            stringstream ss;
+            ss << spsaEvo->resourcePath << "logs/bestParameters-" << this->spsaEvo->suffix << "-" << i << ".nnw";
+            currentControllers[i]->loadFromFile(ss.str().c_str());
+        }
+    }
+    errorOfFirstController=0.0;
+    pruningTrial = TrialPruner::Trial();
+}
+
+void AnnealAdapter::initialize(CMAESEvolution *evo,bool isLearning,const configuration& configdata)
+{
+    tgTeardownQueue::drain();
+    numberOfActions=configdata.getDoubleValue("numberOfActions");
+    numberOfStates=configdata.getDoubleValue("numberOfStates");
+    numberOfControllers=configdata.getDoubleValue("numberOfControllers");
+    totalTime=0.0;
+
+    this->annealEvo = NULL;
+    this->spsaEvo = NULL;
+    this->cmaesEvo = evo;
+    currentControllers = this->cmaesEvo->nextSetOfControllers();
+    if(!isLearning)
+    {
+        for(int i=0;i<currentControllers.size();i++)
+        {
+            stringstream ss;
+            ss << cmaesEvo->resourcePath << "logs/bestParameters-" << this->cmaesEvo->suffix << "-" << i << ".nnw";
+            currentControllers[i]->loadFromFile(ss.str().c_str());
+        }
+    }
+    errorOfFirstController=0.0;
+    pruningTrial = TrialPruner::Trial();
 }
 
 vector<vector<double> > AnnealAdapter::step(double deltaTimeSeconds,vector<double> state)
 {
+    tgTrialTiming::enter(tgTrialTiming::eControl);
     totalTime+=deltaTimeSeconds;
 //  cout<<"NN adapter, state: "<<state[0]<<" "<<state[1]<<" "<<state[2]<<" "<<state[3]<<" "<<state[4]<<" "<<endl;
     vector< vector<double> > actions;
@@ -89,18 +214,28 @@ vector<vector<double> > AnnealAdapter::step(double deltaTimeSeconds,vector<doubl
 
 void AnnealAdapter::endEpisode(vector<double> scores)
 {
-    if(scores.size()==0)
-    {
-        vector< double > tmp(1);
-        tmp[0]=-1;
-        annealEvo->updateScores(tmp);
-        cout<<"Exploded"<<endl;
-    }
-    else
-    {
-        cout<<"Dist Moved: "<<scores[0]<<" energy: "<<scores[1]<<endl;
-//      double combinedScore=scores[0]*1.0-scores[1]*1.0;
-        annealEvo->updateScores(scores);
-    }
-    return;
+    endEpisode(scores, 0);
+}
+
+void AnnealAdapter::endEpisode(vector<double> scores, int fidelity)
+{
+    // Nothing in the next trial needs the scores until initialize
+    tgTeardownQueue::post(new ScoreUpdate(annealEvo, spsaEvo, cmaesEvo,
+                                          currentControllers, scores,
+                                          fidelity));
+}
+
+bool AnnealAdapter::cachedScores(vector<double>& scores)
+{
+    // SPSA perturbations and CMA-ES samples are new every generation
+    if(spsaEvo != NULL || cmaesEvo != NULL)
+        return false;
+    return annealEvo->lookupScores(currentControllers, scores);
+}
+
+bool AnnealAdapter::reportProgress(double progress, double score)
+{
+    TrialPruner& pruner = spsaEvo != NULL ? spsaEvo->getPruner() :
+        cmaesEvo != NULL ? cmaesEvo->getPruner() : annealEvo->getPruner();
+    return pruner.report(pruningTrial, progress, score);
 }
@@ -32,6 +32,9 @@
 #include "learning/AnnealEvolution/AnnealEvolution.h"
 #include "learning/AnnealEvolution/AnnealEvoMember.h"
 
+class SPSAEvolution;
+class CMAESEvolution;
+
 class AnnealAdapter
 {
 public:
@@ -42,19 +45,51 @@ public:
      * For NTRT this means main or simulator needs to own the pointer to
      * AnnealEvolution, we can't create it here
      */
-    void initialize(AnnealEvolution *evo,bool isLearning,configuration config);
+    void initialize(AnnealEvolution *evo,bool isLearning,const configuration& config);
+    /** The same for the perturbations of an SPSAEvolution */
+    void initialize(SPSAEvolution *evo,bool isLearning,const configuration& config);
+    /** The same for the samples of a CMAESEvolution */
+    void initialize(CMAESEvolution *evo,bool isLearning,const configuration& config);
     std::vector<std::vector<double> > step(double deltaTimeSeconds, std::vector<double> state);
     void endEpisode(std::vector<double> state);
+    /**
+     * Score a trial run at a lower fidelity, see
+     * AnnealEvolution::updateScores. SPSA and CMA-ES ignore it.
+     * @param[in] fidelity 0 for the full simulation
+     */
+    void endEpisode(std::vector<double> state, int fidelity);
+    /**
+     * Report the score so far, for the evolution's TrialPruner.
+     * @param[in] progress the fraction of the trial that has run
+     * @param[in] score the score the trial would get if it ended now
+     * @return true if the controller should end the trial, typically by
+     * throwing std::runtime_error
+     */
+    bool reportProgress(double progress, double score);
+    /**
+     * Look the controllers chosen by initialize up in the evolution's
+     * FitnessCache.
+     * @param[out] scores set if found
+     * @return true if the trial need not be simulated; pass the scores
+     * to endEpisode instead
+     */
+    bool cachedScores(std::vector<double>& scores);
 
 private:
     int numberOfActions;
     int numberOfStates;
     int numberOfControllers;
     AnnealEvolution *annealEvo;
+    /// Used instead of annealEvo if not NULL
+    SPSAEvolution *spsaEvo;
+    /// Used instead of annealEvo if not NULL
+    CMAESEvolution *cmaesEvo;
     std::vector< AnnealEvoMember *>currentControllers;
     std::vector<double> initialPosition;
     double errorOfFirstController;
     double totalTime;
+    /** This trial's state in the evolution's TrialPruner */
+    TrialPruner::Trial pruningTrial;
 };
 
 #endif /* ANNEALADAPTER_H_ */
@@ -0,0 +1,444 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file DistributedEvolution.cpp
+ * @brief Implements DistributedEvolutionMaster and
+ * DistributedEvolutionWorker over POSIX TCP sockets.
+ * $Id$
+ */
+
+#include "DistributedEvolution.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+// POSIX sockets
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+#ifdef MSG_NOSIGNAL
+    const int sendFlags = MSG_NOSIGNAL;
+#else
+    const int sendFlags = 0;
+#endif
+
+    /** Message kinds sent by the master */
+    const uint32_t quitMessage = 0;
+    const uint32_t trialMessage = 1;
+
+    bool sendAll(int fd, const void* data, std::size_t size)
+    {
+        const char* p = static_cast<const char*>(data);
+        while (size > 0)
+        {
+            const ssize_t n = ::send(fd, p, size, sendFlags);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                return false;
+            }
+            p += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    bool recvAll(int fd, void* data, std::size_t size)
+    {
+        char* p = static_cast<char*>(data);
+        while (size > 0)
+        {
+            const ssize_t n = ::recv(fd, p, size, 0);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                return false;
+            }
+            p += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    void appendU32(std::string& buffer, uint32_t value)
+    {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void appendDoubles(std::string& buffer, const std::vector<double>& values)
+    {
+        appendU32(buffer, values.size());
+        if (!values.empty())
+        {
+            buffer.append(reinterpret_cast<const char*>(&values[0]),
+                          values.size() * sizeof(double));
+        }
+    }
+
+    bool recvDoubles(int fd, std::vector<double>& values)
+    {
+        uint32_t size;
+        if (!recvAll(fd, &size, sizeof(size)))
+        {
+            return false;
+        }
+        values.resize(size);
+        return size == 0 || recvAll(fd, &values[0], size * sizeof(double));
+    }
+
+    void setNoDelay(int fd)
+    {
+        // Messages are small and each one is waited on
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+}
+
+DistributedEvolutionMaster::DistributedEvolutionMaster(int port,
+                                                       int pipelineDepth) :
+m_listener(-1),
+m_pipelineDepth(pipelineDepth),
+m_nextId(0)
+{
+    if (pipelineDepth < 1)
+    {
+        throw std::invalid_argument("pipelineDepth must be positive");
+    }
+
+    m_listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listener < 0)
+    {
+        throw std::runtime_error("Could not create a socket");
+    }
+    int one = 1;
+    setsockopt(m_listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(m_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(m_listener, 16) != 0)
+    {
+        close(m_listener);
+        std::ostringstream message;
+        message << "Could not listen on port " << port;
+        throw std::runtime_error(message.str());
+    }
+}
+
+DistributedEvolutionMaster::~DistributedEvolutionMaster()
+{
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        sendAll(m_workers[i].fd, &quitMessage, sizeof(quitMessage));
+        close(m_workers[i].fd);
+    }
+    close(m_listener);
+}
+
+void DistributedEvolutionMaster::acceptWorker()
+{
+    const int fd = accept(m_listener, NULL, NULL);
+    if (fd >= 0)
+    {
+        setNoDelay(fd);
+        Worker worker;
+        worker.fd = fd;
+        m_workers.push_back(worker);
+    }
+}
+
+void DistributedEvolutionMaster::waitForWorkers(std::size_t count)
+{
+    while (m_workers.size() < count)
+    {
+        acceptWorker();
+    }
+}
+
+bool DistributedEvolutionMaster::send(Worker& worker, uint32_t id,
+                                      const Trial& trial)
+{
+    std::string buffer;
+    appendU32(buffer, trialMessage);
+    appendU32(buffer, id);
+    appendU32(buffer, trial.size());
+    for (std::size_t i = 0; i < trial.size(); i++)
+    {
+        appendDoubles(buffer, trial[i]);
+    }
+    if (!sendAll(worker.fd, buffer.data(), buffer.size()))
+    {
+        return false;
+    }
+    worker.outstanding.push_back(id);
+    return true;
+}
+
+void DistributedEvolutionMaster::dropWorker(std::size_t index,
+                                            uint32_t base,
+                                            std::deque<std::size_t>& pending,
+                                            std::vector<int>& copies)
+{
+    Worker& worker = m_workers[index];
+    close(worker.fd);
+    for (std::size_t i = 0; i < worker.outstanding.size(); i++)
+    {
+        const uint32_t id = worker.outstanding[i];
+        // Trials left over from an earlier run are not wanted any more
+        if (id >= base && id - base < copies.size())
+        {
+            const std::size_t trial = id - base;
+            copies[trial]--;
+            pending.push_front(trial);
+        }
+    }
+    m_workers.erase(m_workers.begin() + index);
+}
+
+void DistributedEvolutionMaster::run(const std::vector<Trial>& trials,
+                                     std::vector< std::vector<double> >& scores)
+{
+    const std::size_t n = trials.size();
+    scores.assign(n, std::vector<double>());
+
+    // Trial i is sent with id base + i, so late replies to an earlier run
+    // can be told apart
+    const uint32_t base = m_nextId;
+    m_nextId += n;
+
+    std::vector<bool> done(n, false);
+    std::vector<int> copies(n, 0);
+    std::deque<std::size_t> pending;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        pending.push_back(i);
+    }
+    std::size_t remaining = n;
+
+    std::vector<pollfd> fds;
+    std::vector<double> received;
+    while (remaining > 0)
+    {
+        // Keep every worker busy
+        for (std::size_t w = m_workers.size(); w-- > 0; )
+        {
+            Worker& worker = m_workers[w];
+            bool alive = true;
+            while (alive && worker.outstanding.size() < (std::size_t) m_pipelineDepth)
+            {
+                while (!pending.empty() && done[pending.front()])
+                {
+                    pending.pop_front();
+                }
+
+                std::size_t trial = n;
+                if (!pending.empty())
+                {
+                    trial = pending.front();
+                    pending.pop_front();
+                }
+                else
+                {
+                    // Copy a trial still running on only one other worker
+                    for (std::size_t i = 0; i < n && trial == n; i++)
+                    {
+                        if (!done[i] && copies[i] == 1 &&
+                            std::find(worker.outstanding.begin(),
+                                      worker.outstanding.end(),
+                                      base + i) == worker.outstanding.end())
+                        {
+                            trial = i;
+                        }
+                    }
+                }
+                if (trial == n)
+                {
+                    break;
+                }
+
+                if (send(worker, base + trial, trials[trial]))
+                {
+                    copies[trial]++;
+                }
+                else
+                {
+                    pending.push_front(trial);
+                    dropWorker(w, base, pending, copies);
+                    alive = false;
+                }
+            }
+        }
+
+        // Wait for scores, or for a new worker
+        fds.resize(m_workers.size() + 1);
+        fds[0].fd = m_listener;
+        fds[0].events = POLLIN;
+        for (std::size_t w = 0; w < m_workers.size(); w++)
+        {
+            fds[w + 1].fd = m_workers[w].fd;
+            fds[w + 1].events = POLLIN;
+        }
+        if (poll(&fds[0], fds.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::runtime_error("poll failed while waiting for workers");
+        }
+
+        for (std::size_t w = m_workers.size(); w-- > 0; )
+        {
+            if (fds[w + 1].revents == 0)
+            {
+                continue;
+            }
+            Worker& worker = m_workers[w];
+            uint32_t id;
+            if (!recvAll(worker.fd, &id, sizeof(id)) ||
+                !recvDoubles(worker.fd, received))
+            {
+                dropWorker(w, base, pending, copies);
+                continue;
+            }
+
+            std::deque<uint32_t>::iterator it =
+              std::find(worker.outstanding.begin(), worker.outstanding.end(), id);
+            if (it != worker.outstanding.end())
+            {
+                worker.outstanding.erase(it);
+            }
+
+            if (id >= base && id - base < n)
+            {
+                const std::size_t trial = id - base;
+                copies[trial]--;
+                if (!done[trial])
+                {
+                    done[trial] = true;
+                    scores[trial] = received;
+                    remaining--;
+                }
+            }
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            acceptWorker();
+        }
+    }
+}
+
+DistributedEvolutionWorker::DistributedEvolutionWorker(Evaluator& evaluator) :
+m_evaluator(evaluator)
+{
+}
+
+std::size_t DistributedEvolutionWorker::serve(const std::string& host, int port)
+{
+    std::ostringstream service;
+    service << port;
+
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = NULL;
+    if (getaddrinfo(host.c_str(), service.str().c_str(), &hints, &addresses) != 0)
+    {
+        throw std::runtime_error("Could not resolve " + host);
+    }
+
+    int fd = -1;
+    for (addrinfo* a = addresses; a != NULL && fd < 0; a = a->ai_next)
+    {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd >= 0 && connect(fd, a->ai_addr, a->ai_addrlen) != 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Could not connect to " + host + ":" + service.str());
+    }
+    setNoDelay(fd);
+
+    std::size_t count = 0;
+    DistributedEvolutionMaster::Trial parameters;
+    std::string reply;
+    while (true)
+    {
+        uint32_t kind;
+        uint32_t id;
+        uint32_t sets;
+        if (!recvAll(fd, &kind, sizeof(kind)) || kind != trialMessage ||
+            !recvAll(fd, &id, sizeof(id)) ||
+            !recvAll(fd, &sets, sizeof(sets)))
+        {
+            break;
+        }
+        parameters.resize(sets);
+        bool ok = true;
+        for (uint32_t i = 0; i < sets && ok; i++)
+        {
+            ok = recvDoubles(fd, parameters[i]);
+        }
+        if (!ok)
+        {
+            break;
+        }
+
+        const std::vector<double> scores = m_evaluator.evaluate(parameters);
+        count++;
+
+        reply.clear();
+        appendU32(reply, id);
+        appendDoubles(reply, scores);
+        if (!sendAll(fd, reply.data(), reply.size()))
+        {
+            break;
+        }
+    }
+
+    close(fd);
+    return count;
+}
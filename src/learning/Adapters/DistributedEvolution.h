@@ -0,0 +1,179 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef DISTRIBUTED_EVOLUTION_H_
+#define DISTRIBUTED_EVOLUTION_H_
+
+/**
+ * @file DistributedEvolution.h
+ * @brief Defines classes to evaluate a generation of AnnealEvolution or
+ * NeuroEvolution controllers on worker processes spread over several
+ * machines.
+ * $Id$
+ */
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * The master side. Workers connect over TCP, at any time, and each one
+ * is kept up to pipelineDepth trials ahead, so it never waits on the
+ * master between trials. Once every trial has been handed out, idle
+ * workers are given copies of trials still running elsewhere, and
+ * whichever copy finishes first is used, so one slow node does not hold
+ * up the generation. Trials are therefore expected to score the same
+ * wherever they run. A worker that disconnects has its trials handed
+ * out again.
+ *
+ * Parameters are sent as native doubles, so all machines must share
+ * the same byte order.
+ */
+class DistributedEvolutionMaster
+{
+public:
+
+    /**
+     * The parameters of one trial: one vector per population, as the
+     * statelessParameters of the members of one controller set.
+     */
+    typedef std::vector< std::vector<double> > Trial;
+
+    /**
+     * Listen for workers.
+     * @param[in] port the TCP port to listen on
+     * @param[in] pipelineDepth how many trials each worker may have
+     * outstanding; must be positive
+     * @throw std::runtime_error if the port cannot be listened on
+     */
+    DistributedEvolutionMaster(int port, int pipelineDepth = 2);
+
+    /** Tell the workers to quit and close every connection */
+    ~DistributedEvolutionMaster();
+
+    /**
+     * Block until at least this many workers are connected.
+     * @param[in] count the number of workers to wait for
+     */
+    void waitForWorkers(std::size_t count);
+
+    /**
+     * Run every trial on the workers, blocking until each one has a
+     * score. If every worker disconnects, this waits for new ones.
+     * @param[in] trials the parameters of each trial
+     * @param[out] scores resized to trials.size(); the scores of each
+     * trial
+     */
+    void run(const std::vector<Trial>& trials,
+             std::vector< std::vector<double> >& scores);
+
+    /** The number of workers connected */
+    std::size_t workers() const
+    {
+        return m_workers.size();
+    }
+
+private:
+
+    /** One connected worker */
+    struct Worker
+    {
+        int fd;
+        /** The ids of the trials sent and not yet scored by this worker */
+        std::deque<uint32_t> outstanding;
+    };
+
+    /** Accept one pending connection from the listening socket */
+    void acceptWorker();
+
+    /**
+     * Drop a worker, handing its outstanding trials of the current run
+     * out again.
+     */
+    void dropWorker(std::size_t index, uint32_t base,
+                    std::deque<std::size_t>& pending,
+                    std::vector<int>& copies);
+
+    /** Send one trial, false if the worker has gone */
+    bool send(Worker& worker, uint32_t id, const Trial& trial);
+
+    /** Not copyable */
+    DistributedEvolutionMaster(const DistributedEvolutionMaster&);
+    DistributedEvolutionMaster& operator=(const DistributedEvolutionMaster&);
+
+private:
+
+    int m_listener;
+
+    const int m_pipelineDepth;
+
+    std::vector<Worker> m_workers;
+
+    /** The id of the first trial of the next run */
+    uint32_t m_nextId;
+};
+
+/**
+ * The worker side: connects to a DistributedEvolutionMaster and runs
+ * the trials it is sent until the master quits.
+ */
+class DistributedEvolutionWorker
+{
+public:
+
+    /** Runs one trial in the application */
+    class Evaluator
+    {
+    public:
+
+        virtual ~Evaluator() { }
+
+        /**
+         * Run one trial. Copy each vector of parameters into the
+         * statelessParameters of a member built from the same
+         * configuration as the master's, and hand those to the
+         * controllers.
+         * @param[in] parameters one vector per population
+         * @return the scores, as for updateScores; empty if the model
+         * exploded
+         */
+        virtual std::vector<double>
+        evaluate(const DistributedEvolutionMaster::Trial& parameters) = 0;
+    };
+
+    /**
+     * @param[in] evaluator runs the trials. We do not take ownership.
+     */
+    DistributedEvolutionWorker(Evaluator& evaluator);
+
+    /**
+     * Connect and serve trials until the master quits or disconnects.
+     * @param[in] host the master's host name or address
+     * @param[in] port the master's port
+     * @return the number of trials run
+     * @throw std::runtime_error if the master cannot be reached
+     */
+    std::size_t serve(const std::string& host, int port);
+
+private:
+
+    Evaluator& m_evaluator;
+};
+
+#endif  // DISTRIBUTED_EVOLUTION_H_
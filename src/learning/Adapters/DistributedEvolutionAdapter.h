@@ -0,0 +1,125 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef DISTRIBUTED_EVOLUTION_ADAPTER_H_
+#define DISTRIBUTED_EVOLUTION_ADAPTER_H_
+
+/**
+ * @file DistributedEvolutionAdapter.h
+ * @brief Defines a class DistributedEvolutionAdapter to evaluate a
+ * generation of AnnealEvolution or NeuroEvolution controllers on
+ * DistributedEvolutionWorkers.
+ * $Id$
+ */
+
+#include "DistributedEvolution.h"
+
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Pulls every remaining controller set of the current generation from
+ * an evolution object, scatters their parameters to the workers of a
+ * DistributedEvolutionMaster, and reports the scores in the order the
+ * sets were handed out, just as ParallelEvolutionAdapter does for
+ * threads.
+ *
+ * Use it as DistributedEvolutionAdapter<AnnealEvolution, AnnealEvoMember>
+ * or DistributedEvolutionAdapter<NeuroEvolution, NeuroEvoMember>. Only
+ * statelessParameters are sent, so NeuroEvoMembers backed by a neural
+ * network (numberOfStates > 0) are not supported.
+ */
+template <class Evolution, class Member>
+class DistributedEvolutionAdapter
+{
+public:
+
+    /**
+     * @param[in] evolution the source of controllers; must outlive this
+     * @param[in] master the workers to run on; must outlive this
+     */
+    DistributedEvolutionAdapter(Evolution& evolution,
+                                DistributedEvolutionMaster& master) :
+        m_evolution(evolution),
+        m_master(master)
+    {
+    }
+
+    /**
+     * Evaluate every controller set left in the current generation,
+     * or the whole of the next one if the current one is finished.
+     * @return the number of trials run
+     * @throw std::invalid_argument if a member has no statelessParameters
+     */
+    std::size_t runGeneration()
+    {
+        m_controllers.clear();
+        m_controllers.push_back(m_evolution.nextSetOfControllers());
+        const int remaining = m_evolution.episodesLeftInGeneration();
+        for (int i = 0; i < remaining; i++)
+        {
+            m_controllers.push_back(m_evolution.nextSetOfControllers());
+        }
+
+        const std::size_t n = m_controllers.size();
+        m_trials.resize(n);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const std::vector<Member*>& set = m_controllers[i];
+            m_trials[i].resize(set.size());
+            for (std::size_t j = 0; j < set.size(); j++)
+            {
+                if (set[j]->statelessParameters.empty())
+                {
+                    throw std::invalid_argument("Only members with statelessParameters can be distributed");
+                }
+                m_trials[i][j] = set[j]->statelessParameters;
+            }
+        }
+
+        m_master.run(m_trials, m_scores);
+
+        for (std::size_t i = 0; i < n; i++)
+        {
+            // Same convention as AnnealAdapter::endEpisode for an explosion
+            if (m_scores[i].empty())
+            {
+                m_scores[i].push_back(-1.0);
+            }
+            m_evolution.updateScores(m_controllers[i], m_scores[i]);
+        }
+
+        return n;
+    }
+
+private:
+
+    Evolution& m_evolution;
+
+    DistributedEvolutionMaster& m_master;
+
+    /** The controller sets of the current generation, indexed by trial */
+    std::vector< std::vector<Member*> > m_controllers;
+
+    /** Their parameters, as sent to the workers */
+    std::vector<DistributedEvolutionMaster::Trial> m_trials;
+
+    std::vector< std::vector<double> > m_scores;
+};
+
+#endif  // DISTRIBUTED_EVOLUTION_ADAPTER_H_
@@ -27,8 +27,12 @@
 #include "NeuroAdapter.h"
 #include "learning/Configuration/configuration.h"
 #include "helpers/FileHelpers.h"
-#include "neuralNet/Neural Network v2/neuralNetwork.h"
+#include "core/tgMetrics.h"
+#include "core/tgTeardownQueue.h"
+#include "core/tgTraceRecorder.h"
+#include "core/tgTrialTiming.h"
 
+#include <algorithm>
 #include <vector>
 #include <iostream>
 #include <fstream>
@@ -37,14 +41,68 @@
 
 using namespace std;
 
+namespace
+{
+	/** The learner's side of endEpisode, for tgTeardownQueue */
+	class ScoreUpdate : public tgTeardownQueue::Task
+	{
+	public:
+		ScoreUpdate(NeuroEvolution* neuroEvo,
+		            const vector<NeuroEvoMember*>& controllers,
+		            const vector<double>& scores, int fidelity) :
+		neuroEvo(neuroEvo),
+		controllers(controllers),
+		scores(scores),
+		fidelity(fidelity)
+		{
+		}
+
+		virtual void run()
+		{
+			// The evolution writes its logs as it takes the scores
+			tgTrialTiming::Scope timing(tgTrialTiming::eLogIO);
+			tgTraceRecorder::Scope trace("learner update");
+			tgMetrics::add(tgMetrics::eEpisodes, 1.0);
+			if(scores.size()==0)
+			{
+				vector< double > tmp(1);
+				tmp[0]=-1;
+				neuroEvo->updateScores(controllers, tmp, fidelity);
+				cout<<"Exploded"<<endl;
+			}
+			else
+			{
+				tgMetrics::raise(tgMetrics::eBestFitness, scores[0]);
+				cout<<"Dist Moved: "<<scores[0]<<" energy: "<<scores[1]<<endl;
+//				double combinedScore=scores[0]*1.0-scores[1]*1.0;
+				neuroEvo->updateScores(controllers, scores, fidelity);
+			}
+		}
+
+	private:
+		NeuroEvolution* const neuroEvo;
+		const vector<NeuroEvoMember*> controllers;
+		const vector<double> scores;
+		const int fidelity;
+	};
+}
+
 NeuroAdapter::NeuroAdapter() :
+batch(NULL),
 totalTime(0.0)
 {
 }
-NeuroAdapter::~NeuroAdapter(){};
+NeuroAdapter::~NeuroAdapter()
+{
+	// A score update may still be using the evolution
+	tgTeardownQueue::waitIdle();
+	delete batch;
+}
 
-void NeuroAdapter::initialize(NeuroEvolution *evo,bool isLearning,configuration configdata)
+void NeuroAdapter::initialize(NeuroEvolution *evo,bool isLearning,const configuration& configdata)
 {
+	// The next controllers depend on the scores of the last ones
+	tgTeardownQueue::drain();
 	numberOfActions=configdata.getDoubleValue("numberOfActions");
 	numberOfStates=configdata.getDoubleValue("numberOfStates");
 	numberOfControllers=configdata.getDoubleValue("numberOfControllers");
@@ -66,68 +124,128 @@ void NeuroAdapter::initialize(NeuroEvolution *evo,bool isLearning,configuration
 			currentControllers[i]->loadFromFile(ss.str().c_str());
 		}
 	}
+	if(numberOfStates>0 && !currentControllers.empty())
+	{
+		const NeuroEvoMember& first = *currentControllers[0];
+		if(batch == NULL || batch->size() != currentControllers.size() ||
+		   batch->getNumInputs() != numberOfStates ||
+		   batch->getNumHidden() != first.getNumHidden() ||
+		   batch->getNumOutputs() != numberOfActions)
+		{
+			delete batch;
+			batch = NULL;
+			batch = new NeuroBatch(numberOfStates, first.getNumHidden(),
+			                       numberOfActions, currentControllers.size());
+		}
+		for(std::size_t i=0;i<currentControllers.size();i++)
+		{
+			batch->load(i, *currentControllers[i]);
+		}
+	}
 	errorOfFirstController=0.0;
+	pruningTrial = TrialPruner::Trial();
 }
 
 vector<vector<double> > NeuroAdapter::step(double deltaTimeSeconds,vector<double> state)
 {
-	totalTime+=deltaTimeSeconds;
-//	cout<<"NN adapter, state: "<<state[0]<<" "<<state[1]<<" "<<state[2]<<" "<<state[3]<<" "<<state[4]<<" "<<endl;
 	vector< vector<double> > actions;
+	step(deltaTimeSeconds, state, actions);
+	return actions;
+}
+
+void NeuroAdapter::step(double deltaTimeSeconds, const vector<double>& state,
+                        vector<vector<double> >& actions)
+{
+	tgTrialTiming::enter(tgTrialTiming::eControl);
+	totalTime+=deltaTimeSeconds;
 	if(numberOfStates>0)
 	{
-		double *inputs = new double[numberOfStates];
-
+		assert(batch != NULL);
 		//scale inputs to 0-1 from -1 to 1 (unit vector provided from the controller).
 		// Assumes inputs are already scaled -1 to 1
 		assert (state.size() == numberOfStates);
+		double* inputs = batch->getInputs(0);
 		for (int i = 0; i < numberOfStates; i++)
 		{
 			inputs[i]=state[i] / 2.0 + 0.5;
 		}
+		for(std::size_t i=1;i<batch->size();i++)
+		{
+			std::copy(inputs, inputs + numberOfStates, batch->getInputs(i));
+		}
+		batch->feedForward();
+
+		actions.resize(batch->size());
+		for(std::size_t i=0;i<batch->size();i++)
+		{
+			const double* output=batch->getOutputs(i);
+			actions[i].assign(output, output + numberOfActions);
+		}
+	}
+	else
+	{
+		actions.resize(currentControllers.size());
 		for(std::size_t i=0;i<currentControllers.size();i++)
 		{
-			double *output=currentControllers[i]->getNn()->feedForwardPattern(inputs);
-			vector<double> tmpAct;
-			for(int j=0;j<numberOfActions;j++)
+			actions[i] = currentControllers[i]->statelessParameters;
+		}
+	}
+}
+
+void NeuroAdapter::step(double deltaTimeSeconds, const double* states,
+                        std::size_t count, double* actions)
+{
+	tgTrialTiming::enter(tgTrialTiming::eControl);
+	totalTime+=deltaTimeSeconds;
+	const std::size_t rowLength = currentControllers.size() * numberOfActions;
+	if(numberOfStates>0)
+	{
+		assert(batch != NULL);
+		// Scale as the single state step does
+		batchInputs.resize(count * numberOfStates);
+		for (std::size_t i = 0; i < batchInputs.size(); i++)
+		{
+			batchInputs[i] = states[i] / 2.0 + 0.5;
+		}
+		batchOutputs.resize(count * numberOfActions);
+		for(std::size_t c=0;c<batch->size();c++)
+		{
+			batch->feedForward(c, &batchInputs[0], count, &batchOutputs[0]);
+			for(std::size_t r=0;r<count;r++)
 			{
-				tmpAct.push_back(output[j]);
+				std::copy(&batchOutputs[r * numberOfActions],
+				          &batchOutputs[r * numberOfActions] + numberOfActions,
+				          actions + r * rowLength + c * numberOfActions);
 			}
-			actions.push_back(tmpAct);
 		}
-		delete[]inputs;
 	}
 	else
 	{
-		for(std::size_t i=0;i<currentControllers.size();i++)
+		for(std::size_t r=0;r<count;r++)
 		{
-			vector<double> tmpAct;
-			for(std::size_t j=0;j<currentControllers[i]->statelessParameters.size();j++)
+			for(std::size_t c=0;c<currentControllers.size();c++)
 			{
-				tmpAct.push_back(currentControllers[i]->statelessParameters[j]);
+				const vector<double>& params = currentControllers[c]->statelessParameters;
+				std::copy(params.begin(), params.end(),
+				          actions + r * rowLength + c * numberOfActions);
 			}
-			actions.push_back(tmpAct);
 		}
 	}
+}
 
+void NeuroAdapter::endEpisode(vector<double> scores)
+{
+	endEpisode(scores, 0);
+}
 
-    return actions;
+void NeuroAdapter::endEpisode(vector<double> scores, int fidelity)
+{
+	// Nothing in the next trial needs the scores until initialize
+	tgTeardownQueue::post(new ScoreUpdate(neuroEvo, currentControllers,
+	                                      scores, fidelity));
 }
 
-void NeuroAdapter::endEpisode(vector<double> scores)
+bool NeuroAdapter::reportProgress(double progress, double score)
 {
-	if(scores.size()==0)
-	{
-		vector< double > tmp(1);
-		tmp[0]=-1;
-		neuroEvo->updateScores(tmp);
-		cout<<"Exploded"<<endl;
-	}
-	else
-	{
-		cout<<"Dist Moved: "<<scores[0]<<" energy: "<<scores[1]<<endl;
-//		double combinedScore=scores[0]*1.0-scores[1]*1.0;
-		neuroEvo->updateScores(scores);
-	}
-	return;
+	return neuroEvo->getPruner().report(pruningTrial, progress, score);
 }
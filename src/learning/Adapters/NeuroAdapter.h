@@ -30,6 +30,7 @@
 #include <vector>
 #include "../NeuroEvolution/NeuroEvolution.h"
 #include "../NeuroEvolution/NeuroEvoMember.h"
+#include "../NeuroEvolution/NeuroBatch.h"
 
 class NeuroAdapter
 {
@@ -41,9 +42,44 @@ public:
 	 * For NTRT this means main or simulator needs to own the pointer to
 	 * NeuroEvolution, we can't create it here
 	 */
-	void initialize(NeuroEvolution *evo,bool isLearning,configuration config);
+	void initialize(NeuroEvolution *evo,bool isLearning,const configuration& config);
 	std::vector<std::vector<double> > step(double deltaTimeSeconds, std::vector<double> state);
+	/**
+	 * As step(deltaTimeSeconds, state), writing the actions of each
+	 * controller into a caller's vector, which is only resized when its
+	 * shape differs. After the first call of a trial it does not
+	 * allocate, as the networks are evaluated by a NeuroBatch loaded in
+	 * initialize.
+	 * @param[out] actions one row of numberOfActions per controller
+	 */
+	void step(double deltaTimeSeconds, const std::vector<double>& state,
+	          std::vector<std::vector<double> >& actions);
+	/**
+	 * As step(deltaTimeSeconds, state) for many states at once, such as
+	 * one per cable, running each network over all of them in one pass.
+	 * Does not allocate after the first call of a trial.
+	 * @param[in] states count rows of numberOfStates, each from -1 to 1
+	 * @param[in] count the number of states
+	 * @param[out] actions count rows, each of numberOfActions per
+	 * controller in turn
+	 */
+	void step(double deltaTimeSeconds, const double* states, std::size_t count,
+	          double* actions);
 	void endEpisode(std::vector<double> state);
+	/**
+	 * Score a trial run at a lower fidelity, see
+	 * NeuroEvolution::updateScores.
+	 * @param[in] fidelity 0 for the full simulation
+	 */
+	void endEpisode(std::vector<double> state, int fidelity);
+	/**
+	 * Report the score so far, for the evolution's TrialPruner.
+	 * @param[in] progress the fraction of the trial that has run
+	 * @param[in] score the score the trial would get if it ended now
+	 * @return true if the controller should end the trial, typically by
+	 * throwing std::runtime_error
+	 */
+	bool reportProgress(double progress, double score);
 
 private:
 	int numberOfActions;
@@ -51,10 +87,21 @@ private:
 	int numberOfControllers;
 	NeuroEvolution *neuroEvo;
 	std::vector< NeuroEvoMember *>currentControllers;
+	/** The current controllers' networks, NULL without states */
+	NeuroBatch* batch;
+	/** Inputs and one network's outputs for the many state step */
+	std::vector<double> batchInputs;
+	std::vector<double> batchOutputs;
 	std::vector<double> initialPosition;
 	double errorOfFirstController;
     /** Appears unused */
 	double totalTime;
+	/** This trial's state in the evolution's TrialPruner */
+	TrialPruner::Trial pruningTrial;
+
+	/** Not copyable */
+	NeuroAdapter(const NeuroAdapter&);
+	NeuroAdapter& operator=(const NeuroAdapter&);
 };
 
 #endif /* NEUROADAPTER_H_ */
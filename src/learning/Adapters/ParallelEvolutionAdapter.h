@@ -0,0 +1,320 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef PARALLEL_EVOLUTION_ADAPTER_H_
+#define PARALLEL_EVOLUTION_ADAPTER_H_
+
+/**
+ * @file ParallelEvolutionAdapter.h
+ * @brief Defines a class ParallelEvolutionAdapter to evaluate a
+ * generation of AnnealEvolution or NeuroEvolution controllers in
+ * several worlds at once.
+ * $Id$
+ */
+
+#include "core/tgParallelSimulation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * Pulls every remaining controller set of the current generation from
+ * an evolution object, runs them across the worlds of a
+ * tgParallelSimulation, and then reports the scores in the order the
+ * sets were handed out.
+ *
+ * Use it as ParallelEvolutionAdapter<AnnealEvolution, AnnealEvoMember>
+ * or ParallelEvolutionAdapter<NeuroEvolution, NeuroEvoMember>. The
+ * evolution object is only touched from the calling thread.
+ *
+ * Given a second, cheaper set of worlds, a generation is evaluated at
+ * two fidelities: every set is screened in the cheap worlds, which may
+ * use a coarser timestep, fewer solver iterations, a shorter trial or a
+ * model with fewer collision shapes, and only the best are run again in
+ * the full worlds. A screened-out set's first score is capped at the
+ * worst full score, so it cannot outrank a set that was run in full.
+ * AnnealEvolution and NeuroEvolution log the fidelity of each score;
+ * SPSAEvolution and CMAESEvolution should not be screened, since they
+ * mix all the scores of an update.
+ */
+template <class Evolution, class Member>
+class ParallelEvolutionAdapter
+{
+public:
+
+    /**
+     * One world's models and controllers. Applications implement
+     * setup (from tgParallelSimulation::Episode), setControllers and
+     * getScores.
+     */
+    class Episode : public tgParallelSimulation::Episode
+    {
+    public:
+        Episode() : m_pAdapter(NULL) { }
+
+        virtual ~Episode() { }
+
+        virtual void beginTrial(std::size_t trial)
+        {
+            assert(m_pAdapter != NULL);
+            setControllers(m_pAdapter->m_controllers[m_pAdapter->m_batch[trial]]);
+        }
+
+        virtual void endTrial(std::size_t trial)
+        {
+            assert(m_pAdapter != NULL);
+            m_pAdapter->m_scores[m_pAdapter->m_batch[trial]] = getScores();
+        }
+
+    protected:
+
+        /**
+         * Hand the parameters for the coming trial to the controllers.
+         * Called before the world is set up or reset.
+         */
+        virtual void setControllers(const std::vector<Member*>& controllers) = 0;
+
+        /**
+         * The scores of the trial that just finished, as would be
+         * passed to AnnealAdapter::endEpisode. Return an empty vector
+         * if the model exploded.
+         */
+        virtual std::vector<double> getScores() = 0;
+
+    private:
+
+        friend class ParallelEvolutionAdapter;
+
+        ParallelEvolutionAdapter* m_pAdapter;
+    };
+
+    /**
+     * @param[in] evolution the source of controllers; must outlive this
+     * @param[in] config the configuration of every world
+     * @param[in] episodes one per world; must outlive this. We do not
+     * take ownership.
+     */
+    ParallelEvolutionAdapter(Evolution& evolution,
+                             const tgParallelSimulation::Config& config,
+                             const std::vector<Episode*>& episodes) :
+        m_evolution(evolution),
+        m_simulation(config, attach(episodes)),
+        m_pScreening(NULL),
+        m_screeningSteps(0),
+        m_promoteFraction(1.0)
+    {
+    }
+
+    /**
+     * Screen every set at a lower fidelity before the full trials.
+     * @param[in] evolution the source of controllers; must outlive this
+     * @param[in] config the configuration of the full worlds
+     * @param[in] episodes one per full world; must outlive this
+     * @param[in] screeningConfig the configuration of the cheap worlds
+     * @param[in] screeningEpisodes one per cheap world, distinct from
+     * episodes; must outlive this
+     * @param[in] screeningSteps the steps of a screening trial; must be
+     * positive
+     * @param[in] promoteFraction the share of each generation run again
+     * in full, at least one set; must be in (0, 1]
+     * @throw std::invalid_argument if an argument is out of range
+     */
+    ParallelEvolutionAdapter(Evolution& evolution,
+                             const tgParallelSimulation::Config& config,
+                             const std::vector<Episode*>& episodes,
+                             const tgParallelSimulation::Config& screeningConfig,
+                             const std::vector<Episode*>& screeningEpisodes,
+                             int screeningSteps,
+                             double promoteFraction) :
+        m_evolution(evolution),
+        m_simulation(config, attach(episodes)),
+        m_pScreening(NULL),
+        m_screeningSteps(screeningSteps),
+        m_promoteFraction(promoteFraction)
+    {
+        if (screeningSteps <= 0)
+        {
+            throw std::invalid_argument("screeningSteps is not positive");
+        }
+        if (!(promoteFraction > 0.0 && promoteFraction <= 1.0))
+        {
+            throw std::invalid_argument("promoteFraction is not in (0, 1]");
+        }
+        m_pScreening = new tgParallelSimulation(screeningConfig,
+                                                attach(screeningEpisodes));
+    }
+
+    ~ParallelEvolutionAdapter()
+    {
+        delete m_pScreening;
+    }
+
+    /**
+     * Evaluate every controller set left in the current generation,
+     * or the whole of the next one if the current one is finished.
+     * @param[in] steps the number of steps in each full trial
+     * @return the number of trials run
+     */
+    std::size_t runGeneration(int steps)
+    {
+        m_controllers.clear();
+        m_controllers.push_back(m_evolution.nextSetOfControllers());
+        const int remaining = m_evolution.episodesLeftInGeneration();
+        for (int i = 0; i < remaining; i++)
+        {
+            m_controllers.push_back(m_evolution.nextSetOfControllers());
+        }
+
+        const std::size_t n = m_controllers.size();
+        m_scores.assign(n, std::vector<double>());
+        m_fidelities.assign(n, 0);
+        m_batch.resize(n);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            m_batch[i] = i;
+        }
+
+        if (m_pScreening == NULL)
+        {
+            m_simulation.run(n, steps);
+            for (std::size_t i = 0; i < n; i++)
+            {
+                m_evolution.updateScores(m_controllers[i], scoresOf(i));
+            }
+            return n;
+        }
+
+        // Screen everything, then run the best again in full
+        m_pScreening->run(n, m_screeningSteps);
+        std::vector< std::pair<double, std::size_t> > ranking;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            ranking.push_back(std::make_pair(-scoresOf(i)[0], i));
+        }
+        std::sort(ranking.begin(), ranking.end());
+
+        const std::size_t promoted = std::min(n,
+            std::max<std::size_t>(1, static_cast<std::size_t>(
+                std::ceil(m_promoteFraction * n))));
+        std::vector< std::vector<double> > screened(m_scores);
+        m_fidelities.assign(n, 1);
+        m_batch.resize(promoted);
+        for (std::size_t k = 0; k < promoted; k++)
+        {
+            m_batch[k] = ranking[k].second;
+            m_fidelities[m_batch[k]] = 0;
+            m_scores[m_batch[k]].clear();
+        }
+        m_simulation.run(promoted, steps);
+
+        double worstFull = 0.0;
+        for (std::size_t k = 0; k < promoted; k++)
+        {
+            const double first = scoresOf(m_batch[k])[0];
+            worstFull = (k == 0) ? first : std::min(worstFull, first);
+        }
+        for (std::size_t i = 0; i < n; i++)
+        {
+            if (m_fidelities[i] == 0)
+            {
+                m_evolution.updateScores(m_controllers[i], m_scores[i], 0);
+            }
+            else
+            {
+                screened[i][0] = std::min(screened[i][0], worstFull);
+                m_evolution.updateScores(m_controllers[i], screened[i], 1);
+            }
+        }
+
+        return n;
+    }
+
+    /**
+     * The fidelity that produced the score of each set of the last
+     * generation, in the order they were handed out: 0 for a full
+     * trial, 1 for a screening trial only.
+     */
+    const std::vector<int>& getFidelities() const
+    {
+        return m_fidelities;
+    }
+
+private:
+
+    /**
+     * The scores of a set, with the same convention as
+     * AnnealAdapter::endEpisode for an explosion
+     */
+    std::vector<double>& scoresOf(std::size_t i)
+    {
+        if (m_scores[i].empty())
+        {
+            m_scores[i].push_back(-1.0);
+        }
+        return m_scores[i];
+    }
+
+    /** Not copyable */
+    ParallelEvolutionAdapter(const ParallelEvolutionAdapter&);
+    ParallelEvolutionAdapter& operator=(const ParallelEvolutionAdapter&);
+
+    std::vector<tgParallelSimulation::Episode*> attach(const std::vector<Episode*>& episodes)
+    {
+        std::vector<tgParallelSimulation::Episode*> result;
+        for (std::size_t i = 0; i < episodes.size(); i++)
+        {
+            // tgParallelSimulation rejects NULL episodes
+            if (episodes[i] != NULL)
+            {
+                episodes[i]->m_pAdapter = this;
+            }
+            result.push_back(episodes[i]);
+        }
+        return result;
+    }
+
+    Evolution& m_evolution;
+
+    /** The controller sets of the current generation */
+    std::vector< std::vector<Member*> > m_controllers;
+
+    /** Scores written by the episodes, indexed by set */
+    std::vector< std::vector<double> > m_scores;
+
+    /** The fidelity of each set's score, indexed by set */
+    std::vector<int> m_fidelities;
+
+    /** The set each trial of the running batch evaluates */
+    std::vector<std::size_t> m_batch;
+
+    /** Declared after the buffers above so they exist while it runs */
+    tgParallelSimulation m_simulation;
+
+    /** The cheap worlds, or NULL without screening. We own this. */
+    tgParallelSimulation* m_pScreening;
+
+    int m_screeningSteps;
+
+    double m_promoteFraction;
+};
+
+#endif  // PARALLEL_EVOLUTION_ADAPTER_H_
@@ -0,0 +1,303 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef PREFIX_EVOLUTION_ADAPTER_H_
+#define PREFIX_EVOLUTION_ADAPTER_H_
+
+/**
+ * @file PrefixEvolutionAdapter.h
+ * @brief Defines a class PrefixEvolutionAdapter to evaluate controllers
+ * on several realizations of noise or terrain that share the start of
+ * every trial.
+ * $Id$
+ */
+
+#include "core/tgForkPool.h"
+#include "core/tgSimulation.h"
+
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Evaluates each controller set of a generation on K realizations of
+ * sensor noise, actuator noise or terrain, and reports one aggregate
+ * score per set to the evolution object. The K episodes of a set are
+ * the same until the branching time, typically the settle and the first
+ * seconds of the gait, so that prefix is simulated once, in the source
+ * simulation, and the K suffixes are forked from its end and run in
+ * parallel in the branches of a tgForkPool.
+ *
+ * Each branch is one realization for the life of the adapter: its world
+ * is built once, with the terrain of its realization if they differ, and
+ * its onFork applies its noise. Everything that differs between the
+ * realizations must start at or after the branching time, or the
+ * suffixes will not be the episodes they stand for. As in tgForkPool,
+ * the branches must have the same models as the source, and onFork must
+ * copy the source's controller state, since only the world is copied.
+ *
+ * Use it as PrefixEvolutionAdapter<AnnealEvolution, AnnealEvoMember> or
+ * PrefixEvolutionAdapter<NeuroEvolution, NeuroEvoMember>.
+ */
+template <class Evolution, class Member>
+class PrefixEvolutionAdapter
+{
+public:
+
+    /** How the scores of the K realizations make one */
+    enum Aggregate
+    {
+        /** Each score is averaged over the realizations */
+        Mean,
+        /** The scores of the realization whose first score is lowest */
+        Worst
+    };
+
+    /** The application side of the prefix */
+    class Source
+    {
+    public:
+
+        virtual ~Source() { }
+
+        /**
+         * Hand the parameters for the coming trial to the source's
+         * controllers. Called before the source simulation is reset.
+         */
+        virtual void setControllers(const std::vector<Member*>& controllers) = 0;
+    };
+
+    /**
+     * One realization. Applications implement setup (from
+     * tgForkPool::Branch), onFork and getScores; getControllers gives
+     * the set being evaluated.
+     */
+    class Branch : public tgForkPool::Branch
+    {
+    public:
+        Branch() : m_pAdapter(NULL) { }
+
+        virtual ~Branch() { }
+
+        virtual void endRollout(std::size_t branch)
+        {
+            assert(m_pAdapter != NULL);
+            m_pAdapter->m_scores[branch] = getScores();
+        }
+
+    protected:
+
+        /** The controller set being evaluated, for onFork */
+        const std::vector<Member*>& getControllers() const
+        {
+            assert(m_pAdapter != NULL);
+            return *m_pAdapter->m_pControllers;
+        }
+
+        /**
+         * The scores of the suffix that just finished, as would be
+         * passed to AnnealAdapter::endEpisode. Return an empty vector
+         * if the model exploded.
+         */
+        virtual std::vector<double> getScores() = 0;
+
+    private:
+
+        friend class PrefixEvolutionAdapter;
+
+        PrefixEvolutionAdapter* m_pAdapter;
+    };
+
+    /**
+     * Build the branches' worlds.
+     * @param[in] evolution the source of controllers; must outlive this
+     * @param[in] source sets the source simulation's controllers; must
+     * outlive this
+     * @param[in] simulation the source simulation, with its models
+     * added; must outlive this
+     * @param[in] config the configuration of every branch, whose world
+     * and step size must match the source's
+     * @param[in] branches one per realization; must outlive this. We do
+     * not take ownership.
+     * @param[in] aggregate how the realizations' scores are combined
+     * @throw std::runtime_error if a branch's setup threw
+     */
+    PrefixEvolutionAdapter(Evolution& evolution,
+                           Source& source,
+                           tgSimulation& simulation,
+                           const tgForkPool::Config& config,
+                           const std::vector<Branch*>& branches,
+                           Aggregate aggregate = Mean) :
+        m_evolution(evolution),
+        m_source(source),
+        m_simulation(simulation),
+        m_aggregate(aggregate),
+        m_pControllers(NULL),
+        m_scores(branches.size()),
+        m_pool(config, attach(branches))
+    {
+    }
+
+    /**
+     * Evaluate every controller set left in the current generation,
+     * or the whole of the next one if the current one is finished.
+     * @param[in] prefixSteps the steps before the branching time,
+     * simulated once per set; may be 0
+     * @param[in] suffixSteps the steps after it, simulated in every
+     * branch; must be positive
+     * @return the number of controller sets scored
+     * @throw std::invalid_argument if a step count is out of range
+     */
+    std::size_t runGeneration(int prefixSteps, int suffixSteps)
+    {
+        if (prefixSteps < 0)
+        {
+            throw std::invalid_argument("prefixSteps is negative");
+        }
+        if (suffixSteps <= 0)
+        {
+            throw std::invalid_argument("suffixSteps is not positive");
+        }
+
+        std::vector< std::vector<Member*> > controllers;
+        controllers.push_back(m_evolution.nextSetOfControllers());
+        const int remaining = m_evolution.episodesLeftInGeneration();
+        for (int i = 0; i < remaining; i++)
+        {
+            controllers.push_back(m_evolution.nextSetOfControllers());
+        }
+
+        for (std::size_t i = 0; i < controllers.size(); i++)
+        {
+            m_pControllers = &controllers[i];
+            m_scores.assign(m_scores.size(), std::vector<double>());
+            try
+            {
+                m_source.setControllers(controllers[i]);
+                m_simulation.reset();
+                if (prefixSteps > 0)
+                {
+                    m_simulation.run(prefixSteps);
+                }
+                m_pool.fork(m_simulation, suffixSteps);
+            }
+            catch (const std::runtime_error&)
+            {
+                // A prefix that exploded fails every realization; a
+                // suffix that threw fails its own, and left no scores
+            }
+            m_evolution.updateScores(controllers[i], aggregateScores());
+        }
+        m_pControllers = NULL;
+        return controllers.size();
+    }
+
+    /** The number of realizations */
+    std::size_t size() const
+    {
+        return m_pool.size();
+    }
+
+    /**
+     * The scores of each realization of the last set evaluated, empty
+     * where the model exploded
+     */
+    const std::vector< std::vector<double> >& getScores() const
+    {
+        return m_scores;
+    }
+
+private:
+
+    /**
+     * Combine the realizations' scores, a missing one counting as the
+     * explosion score of AnnealAdapter::endEpisode
+     */
+    std::vector<double> aggregateScores() const
+    {
+        std::vector<double> result;
+        std::vector<std::size_t> counts;
+        for (std::size_t k = 0; k < m_scores.size(); k++)
+        {
+            const std::vector<double> exploded(1, -1.0);
+            const std::vector<double>& scores =
+                m_scores[k].empty() ? exploded : m_scores[k];
+            if (m_aggregate == Worst)
+            {
+                if (k == 0 || scores[0] < result[0])
+                {
+                    result = scores;
+                }
+                continue;
+            }
+            if (scores.size() > result.size())
+            {
+                result.resize(scores.size(), 0.0);
+                counts.resize(scores.size(), 0);
+            }
+            for (std::size_t j = 0; j < scores.size(); j++)
+            {
+                result[j] += scores[j];
+                counts[j]++;
+            }
+        }
+        for (std::size_t j = 0; j < counts.size(); j++)
+        {
+            result[j] /= counts[j];
+        }
+        return result;
+    }
+
+    /** Not copyable */
+    PrefixEvolutionAdapter(const PrefixEvolutionAdapter&);
+    PrefixEvolutionAdapter& operator=(const PrefixEvolutionAdapter&);
+
+    std::vector<tgForkPool::Branch*> attach(const std::vector<Branch*>& branches)
+    {
+        std::vector<tgForkPool::Branch*> result;
+        for (std::size_t i = 0; i < branches.size(); i++)
+        {
+            if (branches[i] == NULL)
+            {
+                throw std::invalid_argument("Branch is NULL");
+            }
+            branches[i]->m_pAdapter = this;
+            result.push_back(branches[i]);
+        }
+        return result;
+    }
+
+    Evolution& m_evolution;
+
+    Source& m_source;
+
+    tgSimulation& m_simulation;
+
+    const Aggregate m_aggregate;
+
+    /** The set being evaluated, or NULL between generations */
+    const std::vector<Member*>* m_pControllers;
+
+    /** Scores written by the branches, indexed by branch */
+    std::vector< std::vector<double> > m_scores;
+
+    /** Declared after the buffers above so they exist while it runs */
+    tgForkPool m_pool;
+};
+
+#endif  // PREFIX_EVOLUTION_ADAPTER_H_
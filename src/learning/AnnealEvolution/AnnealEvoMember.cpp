@@ -26,6 +26,9 @@
  */
 
 #include "AnnealEvoMember.h"
+#include "learning/Checkpoint/EvolutionCheckpoint.h"
+#include "core/tgCounterRandom.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <assert.h>
@@ -33,16 +36,17 @@
 
 using namespace std;
 
-AnnealEvoMember::AnnealEvoMember(configuration config)
+AnnealEvoMember::AnnealEvoMember(const configuration& config, std::tr1::ranlux64_base_01 *eng)
 {
     //readConfigFromXML(configFile);
     this->numOutputs=config.getintvalue("numberOfActions");
     this->devBase=config.getDoubleValue("deviation");
     this->monteCarlo=config.getintvalue("MonteCarlo");
     
+    std::tr1::uniform_real<double> unif(0, 1);
     statelessParameters.resize(numOutputs);
     for(int i=0;i<numOutputs;i++)
-        statelessParameters[i]=rand()*1.0/RAND_MAX;
+        statelessParameters[i]=unif(*eng);
 
     maxScore=-1000;
 }
@@ -54,35 +58,31 @@ AnnealEvoMember::~AnnealEvoMember()
 void AnnealEvoMember::mutate(std::tr1::ranlux64_base_01 *eng, double T){
     
     assert (T <= 1.0);
-    std::tr1::uniform_real<double> unif(0, 1);
 
-    //TODO: for each weight of the NN with 0.5 probability mutate it
+    const std::size_t n = statelessParameters.size();
+    if (n == 0)
+    {
+        return;
+    }
 
-    double dev = devBase * T / 100.0; 
-    std::tr1::normal_distribution<double> normal(0, dev);
-    for(std::size_t i=0;i<statelessParameters.size();i++)
+    // One draw from the stream keys every parameter's draw, so the
+    // loops below are plain array passes
+    const tgCounterRandom draws = tgCounterRandom::fromStream(*eng);
+    double* const params = &statelessParameters[0];
+    if (monteCarlo)
     {
-        double newParam;
-        if (monteCarlo)
+        draws.fillUniform(params, n);
+    }
+    else
+    {
+        double dev = devBase * T / 100.0; 
+        std::vector<double> mutAmount(n);
+        draws.fillNormal(&mutAmount[0], n, dev);
+        for(std::size_t i=0;i<n;i++)
         {
-            newParam= unif(*eng);
+            params[i] = std::min(1.0, std::max(0.0, params[i] + mutAmount[i]));
         }
-        else
-        {   
-            double mutAmount = normal(*eng);
-              //std::cout<<"param: "<<i<<" dev: "<<dev<<" rand: "<<mutAmount<<endl;
-            newParam= statelessParameters[i] + mutAmount;
-        }
-
-        if(newParam < 0.0)
-            statelessParameters[i] = 0.0;
-        else if(newParam > 1.0)
-            statelessParameters[i] = 1.0;
-        else
-            statelessParameters[i] =newParam;
     }
-
-
 }
 
 void AnnealEvoMember::copyFrom(AnnealEvoMember* otherMember)
@@ -141,3 +141,23 @@ void AnnealEvoMember::loadFromFile(const char * outputFilename)
     ss.close();
 
 }
+
+void AnnealEvoMember::writeCheckpoint(EvolutionCheckpoint& checkpoint) const
+{
+    checkpoint.writeVector(statelessParameters);
+    checkpoint.writeVector(pastScores);
+    checkpoint.writeDouble(maxScore);
+    checkpoint.writeDouble(maxScore1);
+    checkpoint.writeDouble(maxScore2);
+    checkpoint.writeDouble(averageScore);
+}
+
+void AnnealEvoMember::readCheckpoint(EvolutionCheckpoint& checkpoint)
+{
+    statelessParameters = checkpoint.readVector();
+    pastScores = checkpoint.readVector();
+    maxScore = checkpoint.readDouble();
+    maxScore1 = checkpoint.readDouble();
+    maxScore2 = checkpoint.readDouble();
+    averageScore = checkpoint.readDouble();
+}
@@ -33,17 +33,22 @@
 #include <tr1/random>
 #include "learning/Configuration/configuration.h"
 
+class EvolutionCheckpoint;
+
 
 class AnnealEvoMember
 {
 public:
-    AnnealEvoMember(configuration config);
+    AnnealEvoMember(const configuration& config, std::tr1::ranlux64_base_01 *eng);
     ~AnnealEvoMember();
     void mutate(std::tr1::ranlux64_base_01 *eng, double T);
 
     void copyFrom(AnnealEvoMember *otherMember);
     void saveToFile(const char* outputFilename);
     void loadFromFile(const char* inputFilename);
+    /// Parameters and scores, for AnnealEvolution::saveCheckpoint
+    void writeCheckpoint(EvolutionCheckpoint& checkpoint) const;
+    void readCheckpoint(EvolutionCheckpoint& checkpoint);
 
     std::vector<double> statelessParameters;
     //scores for evaluation
@@ -35,7 +35,7 @@
 
 using namespace std;
 
-AnnealEvoPopulation::AnnealEvoPopulation(int populationSize,configuration config)
+AnnealEvoPopulation::AnnealEvoPopulation(int populationSize,const configuration& config, std::tr1::ranlux64_base_01 *eng)
 {
     compareAverageScores=true;
     clearScoresBetweenGenerations=false;
@@ -45,7 +45,7 @@ AnnealEvoPopulation::AnnealEvoPopulation(int populationSize,configuration config
     for(int i=0;i<populationSize;i++)
     {
         //cout<<"  creating members"<<endl;
-        controllers.push_back(new AnnealEvoMember(config));
+        controllers.push_back(new AnnealEvoMember(config, eng));
     }
 }
 
@@ -61,14 +61,18 @@ void AnnealEvoPopulation::mutate(std::tr1::ranlux64_base_01 *engPntr,std::size_t
 {
     for(std::size_t i=0;i<numMutate;i++)
     {
-        int copyFrom = 0; // Always copy from the best
-        int copyTo = this->controllers.size()-1-i;
-        controllers.at(copyTo)->copyFrom(controllers.at(copyFrom));
-        controllers.at(copyTo)->mutate(engPntr, T);
+        mutateMember(engPntr, this->controllers.size()-1-i, T);
     }
     return;
 }
 
+void AnnealEvoPopulation::mutateMember(std::tr1::ranlux64_base_01 *engPntr,std::size_t copyTo, double T)
+{
+    int copyFrom = 0; // Always copy from the best
+    controllers.at(copyTo)->copyFrom(controllers.at(copyFrom));
+    controllers.at(copyTo)->mutate(engPntr, T);
+}
+
 bool AnnealEvoPopulation::comparisonFuncForAverage(AnnealEvoMember * elm1, AnnealEvoMember * elm2)
 {
         return elm1->averageScore > elm2->averageScore;
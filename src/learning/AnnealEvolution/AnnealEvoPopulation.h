@@ -33,10 +33,12 @@
 
 class AnnealEvoPopulation {
 public:
-    AnnealEvoPopulation(int numControllers,configuration config);
+    AnnealEvoPopulation(int numControllers,const configuration& config, std::tr1::ranlux64_base_01 *eng);
     ~AnnealEvoPopulation();
     std::vector<AnnealEvoMember *> controllers;
     void mutate(std::tr1::ranlux64_base_01 *eng,std::size_t numToMutate, double T);
+    /// Replace one member with a mutation of the best
+    void mutateMember(std::tr1::ranlux64_base_01 *eng,std::size_t copyTo, double T);
     void orderPopulation();
     AnnealEvoMember * selectMemberToEvaluate();
     AnnealEvoMember * getMember(int i){return controllers[i];};
@@ -29,6 +29,7 @@
 #include "learning/Configuration/configuration.h"
 #include "core/tgString.h"
 #include "helpers/FileHelpers.h"
+#include <algorithm>
 #include <iostream>
 #include <numeric>
 #include <string>
@@ -37,24 +38,42 @@
 
 using namespace std;
 
-#ifdef _WIN32
-
-//  Windows
-#define rdtsc  __rdtsc
-
-#else
+namespace
+{
+    vector< vector<double> > parametersOf(const vector <AnnealEvoMember *>& controllers)
+    {
+        vector< vector<double> > parameters;
+        for(std::size_t i=0;i<controllers.size();i++)
+        {
+            parameters.push_back(controllers[i]->statelessParameters);
+        }
+        return parameters;
+    }
 
-//  For everything else
-unsigned long long rdtsc(){
-    unsigned int lo,hi;
-    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
-    return ((unsigned long long)hi << 32) | lo;
+    /** What the evolution, its members and AnnealAdapter read */
+    const configuration::Field annealFields[] =
+    {
+        { "populationSize", configuration::intType },
+        { "numberOfElementsToMutate", configuration::intType },
+        { "numberOfTestsBetweenGenerations", configuration::intType },
+        { "numberOfSubtests", configuration::intType },
+        { "numberOfControllers", configuration::intType },
+        { "leniencyCoef", configuration::doubleType },
+        { "coevolution", configuration::intType },
+        { "startSeed", configuration::intType },
+        { "learning", configuration::intType },
+        { "numberOfActions", configuration::intType },
+        { "numberOfStates", configuration::doubleType },
+        { "deviation", configuration::doubleType },
+        { "MonteCarlo", configuration::intType },
+        { "compareAverageScores", configuration::intType },
+        { "clearScoresBetweenGenerations", configuration::intType }
+    };
 }
 
-#endif
-
 AnnealEvolution::AnnealEvolution(std::string suff, std::string config, std::string path) :
 suffix(suff),
+rng(0),
 Temp(1.0)
 {
     currentTest=0;
@@ -74,6 +93,7 @@ Temp(1.0)
 	
     configuration myconfigdataaa;
     myconfigdataaa.readFile(configPath);
+    myconfigdataaa.validate(annealFields, sizeof(annealFields) / sizeof(annealFields[0]));
     populationSize=myconfigdataaa.getintvalue("populationSize");
     numberOfElementsToMutate=myconfigdataaa.getintvalue("numberOfElementsToMutate");
     numberOfTestsBetweenGenerations=myconfigdataaa.getintvalue("numberOfTestsBetweenGenerations");
@@ -85,12 +105,27 @@ Temp(1.0)
     
     bool learning = myconfigdataaa.getintvalue("learning");
 
-    srand(rdtsc());
-    eng.seed(rdtsc());
+    if (myconfigdataaa.iskey("randomSeed"))
+    {
+        rng.seed(myconfigdataaa.getintvalue("randomSeed"));
+    }
+    else
+    {
+        rng.seed(tgRandom::entropySeed());
+    }
+    std::cout << "Random seed: " << rng.getSeed() << std::endl;
+
+    pruner = new TrialPruner(myconfigdataaa);
+    cache = new FitnessCache(myconfigdataaa);
+    scoreLog = new ScoreLog(resourcePath + "logs/scores", myconfigdataaa);
+    results = new ResultStore(resourcePath + "logs/results", myconfigdataaa);
+    surrogate = new SurrogateScreen(myconfigdataaa);
+    logFidelity = myconfigdataaa.iskey("fidelityLevels") &&
+        myconfigdataaa.getintvalue("fidelityLevels") > 1;
 
     for(int j=0;j<numberOfControllers;j++)
     {
-        populations.push_back(new AnnealEvoPopulation(populationSize,myconfigdataaa));
+        populations.push_back(new AnnealEvoPopulation(populationSize,myconfigdataaa,&rng.engine()));
     }
     
     // Overwrite the random parameters based on data
@@ -104,9 +139,26 @@ Temp(1.0)
             seededPop->loadFromFile(ss.str().c_str());
         }
     }
+    
+    checkpointInterval = 0;
+    if (myconfigdataaa.iskey("checkpointInterval"))
+    {
+        checkpointInterval = myconfigdataaa.getintvalue("checkpointInterval");
+    }
+    checkpointPath = resourcePath + "logs/checkpoint-" + suffix + ".bin";
+    bool resumed = false;
+    if(learning && checkpointInterval > 0)
+    {
+        resumed = loadCheckpoint(checkpointPath);
+        if (resumed)
+        {
+            std::cout << "Resumed from " << checkpointPath << " at generation " << generationNumber << std::endl;
+        }
+    }
+    
     if(learning)
     {
-        evolutionLog.open((resourcePath + "logs/evolution" + suffix + ".csv").c_str(),ios::out);
+        evolutionLog.open((resourcePath + "logs/evolution" + suffix + ".csv").c_str(),resumed ? ios::app : ios::out);
         if (!evolutionLog.is_open())
         {
 			throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
@@ -116,6 +168,11 @@ Temp(1.0)
 
 AnnealEvolution::~AnnealEvolution()
 {
+    delete pruner;
+    delete cache;
+    delete scoreLog;
+    delete results;
+    delete surrogate;
     // @todo - solve the invalid pointer that occurs here
     #if (0)
     for(std::size_t i = 0; i < populations.size(); i++)
@@ -128,9 +185,45 @@ AnnealEvolution::~AnnealEvolution()
 
 void AnnealEvolution::mutateEveryController()
 {
-    for(std::size_t i=0;i<populations.size();i++)
+    if(!surrogate->isReady())
     {
-        populations.at(i)->mutate(&eng,numberOfElementsToMutate, Temp);
+        for(std::size_t i=0;i<populations.size();i++)
+        {
+            populations.at(i)->mutate(&rng.engine(),numberOfElementsToMutate, Temp);
+        }
+        return;
+    }
+
+    // Members at the same index are tested together, so each index gets
+    // several mutations across the populations and keeps the set the
+    // surrogate ranks first. An exploration share keeps its first draw.
+    for(int j=0;j<numberOfElementsToMutate;j++)
+    {
+        const std::size_t copyTo = populationSize-1-j;
+        const std::size_t draws = surrogate->explore(rng) ? 1 : surrogate->getCandidates();
+        vector< vector<double> > best;
+        double bestRank = 0.0;
+        for(std::size_t k=0;k<draws;k++)
+        {
+            vector< vector<double> > candidate;
+            for(std::size_t i=0;i<populations.size();i++)
+            {
+                populations[i]->mutateMember(&rng.engine(), copyTo, Temp);
+                candidate.push_back(populations[i]->controllers[copyTo]->statelessParameters);
+            }
+            if(draws == 1)
+                break;
+            const double rank = surrogate->rank(candidate);
+            if(k == 0 || rank > bestRank)
+            {
+                best.swap(candidate);
+                bestRank = rank;
+            }
+        }
+        for(std::size_t i=0;i<best.size();i++)
+        {
+            populations[i]->controllers[copyTo]->statelessParameters.swap(best[i]);
+        }
     }
 }
 
@@ -154,24 +247,39 @@ void AnnealEvolution::orderAllPopulations()
     aveScore2 /= scoresOfTheGeneration.size();
 
 
+    // Trials that cannot beat the worst member we keep can stop early
+    const int worstKept = populationSize - numberOfElementsToMutate - 1;
+    double threshold = 0.0;
     for(std::size_t i=0;i<populations.size();i++)
     {
         populations.at(i)->orderPopulation();
+        const double score = populations[i]->getMember(std::max(worstKept, 0))->maxScore;
+        threshold = (i == 0) ? score : std::min(threshold, score);
     }
+    pruner->setThreshold(threshold);
     evolutionLog<<generationNumber*numberOfTestsBetweenGenerations<<","<<aveScore1<<","<<aveScore2<<",";
     evolutionLog<<populations.at(0)->getMember(0)->maxScore<<","<<populations.at(0)->getMember(0)->maxScore1<<","<<populations.at(0)->getMember(0)->maxScore2<<endl;
+    scoreLog->flush();
+    results->flush();
     
     
     // what if member at 0 isn't the best of all time for some reason? 
     // This seems biased towards average scores
     // We actually order the populations, so member 0 is the current best according to the assigned fitness
-    ofstream logfileLeader;
+    // Only rewrite the leaders that changed
+    savedLeaders.resize(populations.size());
     for(std::size_t i=0;i<populations.size();i++)
     {
+        const vector<double>& leader = populations[i]->getMember(0)->statelessParameters;
+        if (leader == savedLeaders[i])
+        {
+            continue;
+        }
         stringstream ss;
         ss << resourcePath << "logs/bestParameters-" << suffix << "-" << i << ".nnw";
 
         populations[i]->getMember(0)->saveToFile(ss.str().c_str());
+        savedLeaders[i] = leader;
     }
 }
 
@@ -204,6 +312,11 @@ vector <AnnealEvoMember *> AnnealEvolution::nextSetOfControllers()
             currentTest=0;//Start from 0
         else
             currentTest=populationSize-numberOfElementsToMutate; //start from the mutated ones only (last x)
+        
+        if(checkpointInterval > 0 && generationNumber % checkpointInterval == 0)
+        {
+            saveCheckpoint(checkpointPath);
+        }
     }
 
     selectedControllers.clear();
@@ -211,7 +324,7 @@ vector <AnnealEvoMember *> AnnealEvolution::nextSetOfControllers()
     {
         int selectedOne=0;
         if(coevolution)
-            selectedOne=rand()%populationSize; //select random one from each pool
+            selectedOne=rng.index(populationSize); //select random one from each pool
         else
             selectedOne=currentTest; //select the same from each pool
 
@@ -232,21 +345,42 @@ vector <AnnealEvoMember *> AnnealEvolution::nextSetOfControllers()
 }
 
 void AnnealEvolution::updateScores(vector <double> multiscore)
+{
+    updateScores(selectedControllers, multiscore);
+}
+
+void AnnealEvolution::updateScores(const vector <AnnealEvoMember *>& controllers,
+                                   vector <double> multiscore)
+{
+    updateScores(controllers, multiscore, 0);
+}
+
+void AnnealEvolution::updateScores(const vector <AnnealEvoMember *>& controllers,
+                                   vector <double> multiscore, int fidelity)
 {
     if(multiscore.size()==2)
+    {
         this->scoresOfTheGeneration.push_back(multiscore);
+        // A screening score must not stand in for a full trial
+        if(fidelity == 0)
+            cache->store(parametersOf(controllers), multiscore);
+    }
+    if(fidelity == 0)
+        surrogate->add(parametersOf(controllers), multiscore[0]);
     else
         multiscore.push_back(-1.0);
     double score=1.0* multiscore[0] - 0.0 * multiscore[1];
     
-    //Record it to the file
-    ofstream payloadLog;
-    payloadLog.open((resourcePath + "logs/scores.csv").c_str(),ios::app);
-    payloadLog<<multiscore[0]<<","<<multiscore[1];
+    //Record it to the log
+    vector<double> row;
+    row.push_back(multiscore[0]);
+    row.push_back(multiscore[1]);
+    if(logFidelity)
+        row.push_back(fidelity);
     
-    for(std::size_t oneElem=0;oneElem<selectedControllers.size();oneElem++)
+    for(std::size_t oneElem=0;oneElem<controllers.size();oneElem++)
     {
-        AnnealEvoMember * controllerPointer=selectedControllers.at(oneElem);
+        AnnealEvoMember * controllerPointer=controllers.at(oneElem);
 
         controllerPointer->pastScores.push_back(score);
         double prevScore=controllerPointer->maxScore;
@@ -261,14 +395,82 @@ void AnnealEvolution::updateScores(vector <double> multiscore)
             controllerPointer->maxScore1=multiscore[0];
             controllerPointer->maxScore2=multiscore[1];
         }
-        std::size_t n = controllerPointer->statelessParameters.size();
-        for (std::size_t i = 0; i < n; i++)
+        row.insert(row.end(), controllerPointer->statelessParameters.begin(),
+                   controllerPointer->statelessParameters.end());
+    }
+
+    scoreLog->append(row);
+    results->append(parametersOf(controllers), multiscore, fidelity);
+    return;
+}
+
+bool AnnealEvolution::lookupScores(const vector <AnnealEvoMember *>& controllers,
+                                   vector <double>& scores)
+{
+    return cache->lookup(parametersOf(controllers), scores);
+}
+
+void AnnealEvolution::saveCheckpoint(const std::string& filename)
+{
+    EvolutionCheckpoint checkpoint;
+    checkpoint.writeString("AnnealEvolution");
+    checkpoint.writeInt(populations.size());
+    checkpoint.writeInt(populationSize);
+    checkpoint.writeInt(generationNumber);
+    checkpoint.writeInt(currentTest);
+    checkpoint.writeInt(subTests);
+    checkpoint.writeDouble(Temp);
+    checkpoint.writeString(rng.getState());
+    checkpoint.writeInt(scoresOfTheGeneration.size());
+    for(std::size_t i=0;i<scoresOfTheGeneration.size();i++)
+    {
+        checkpoint.writeVector(scoresOfTheGeneration[i]);
+    }
+    for(std::size_t i=0;i<populations.size();i++)
+    {
+        for(std::size_t j=0;j<populations[i]->controllers.size();j++)
         {
-            payloadLog << "," << controllerPointer->statelessParameters[i];
+            populations[i]->controllers[j]->writeCheckpoint(checkpoint);
         }
     }
+    checkpoint.save(filename);
+}
 
-    payloadLog<<endl;
-    payloadLog.close();
-    return;
+bool AnnealEvolution::loadCheckpoint(const std::string& filename)
+{
+    EvolutionCheckpoint checkpoint;
+    if (!checkpoint.load(filename))
+    {
+        return false;
+    }
+    if (checkpoint.readString() != "AnnealEvolution" ||
+        checkpoint.readInt() != static_cast<int>(populations.size()) ||
+        checkpoint.readInt() != populationSize)
+    {
+        throw std::runtime_error(filename + " does not match this configuration");
+    }
+    generationNumber = checkpoint.readInt();
+    currentTest = checkpoint.readInt();
+    subTests = checkpoint.readInt();
+    Temp = checkpoint.readDouble();
+    rng.setState(checkpoint.readString());
+    scoresOfTheGeneration.resize(checkpoint.readInt());
+    for(std::size_t i=0;i<scoresOfTheGeneration.size();i++)
+    {
+        scoresOfTheGeneration[i] = checkpoint.readVector();
+    }
+    for(std::size_t i=0;i<populations.size();i++)
+    {
+        for(std::size_t j=0;j<populations[i]->controllers.size();j++)
+        {
+            populations[i]->controllers[j]->readCheckpoint(checkpoint);
+        }
+    }
+    return true;
+}
+
+int AnnealEvolution::episodesLeftInGeneration() const
+{
+    const int testsToDo = coevolution ? numberOfTestsBetweenGenerations : populationSize;
+    return (testsToDo - currentTest) * numberOfSubtests - subTests;
 }
@@ -30,6 +30,13 @@
 
 #include "AnnealEvoPopulation.h"
 #include "AnnealEvoMember.h"
+#include "learning/Pruning/TrialPruner.h"
+#include "learning/Checkpoint/EvolutionCheckpoint.h"
+#include "learning/FitnessCache/FitnessCache.h"
+#include "learning/ScoreLog/ScoreLog.h"
+#include "learning/ResultStore/ResultStore.h"
+#include "learning/Surrogate/Surrogate.h"
+#include "core/tgRandom.h"
 #include <fstream>
 #include <boost/iterator/iterator_concepts.hpp>
 
@@ -43,14 +50,125 @@ public:
     void evaluatePopulation();
     std::vector< AnnealEvoMember *> nextSetOfControllers();
     void updateScores(std::vector<double> scores);
+    
+    /**
+     * Score a set of controllers other than the last one returned by
+     * nextSetOfControllers, so several sets can be evaluated at once.
+     * @param[in] controllers a set returned by nextSetOfControllers
+     * during this generation
+     * @param[in] scores as for updateScores(scores)
+     */
+    void updateScores(const std::vector< AnnealEvoMember *>& controllers,
+                      std::vector<double> scores);
+    
+    /**
+     * Score a set of controllers from a trial of a given fidelity, as
+     * for updateScores(controllers, scores). Fidelity 0 is the full
+     * simulation; higher levels are cheaper approximations, such as a
+     * coarser timestep or a shorter trial, used to screen members.
+     * Their scores are not added to the FitnessCache. With the
+     * fidelityLevels key above 1, the score log has the fidelity as a
+     * third column.
+     */
+    void updateScores(const std::vector< AnnealEvoMember *>& controllers,
+                      std::vector<double> scores, int fidelity);
+    
+    /**
+     * How many more times nextSetOfControllers can be called before
+     * it starts the next generation. All of these sets must be scored
+     * before then.
+     */
+    int episodesLeftInGeneration() const;
+
+    /**
+     * Write the members, their scores, the random stream and the
+     * counters to a checkpoint. Done every checkpointInterval
+     * generations when that key is in the config file.
+     * @throw std::runtime_error if the file cannot be written
+     */
+    void saveCheckpoint(const std::string& filename);
+
+    /**
+     * Continue from a checkpoint. The constructor does this itself when
+     * checkpointInterval is set and its checkpoint exists.
+     * @return false if there is no such file
+     * @throw std::runtime_error if it is not a checkpoint of this
+     * configuration
+     */
+    bool loadCheckpoint(const std::string& filename);
+    
+    /**
+     * Decides whether a trial should stop early, from the scores its
+     * controller reports part way through. Configured by the optional
+     * pruning keys of the config file, see TrialPruner. The threshold
+     * is the final score of the worst member kept by the last
+     * generation.
+     */
+    TrialPruner& getPruner()
+    {
+        return *pruner;
+    }
+
+    /**
+     * The scores of parameter sets already tested, enabled by the
+     * fitnessCache key of the config file. updateScores adds to it.
+     */
+    FitnessCache& getCache()
+    {
+        return *cache;
+    }
+
+    /**
+     * Every scored set, indexed, enabled by the resultStore key of the
+     * config file. updateScores adds to it.
+     */
+    ResultStore& getResults()
+    {
+        return *results;
+    }
+
+    /**
+     * Screens the mutations of each generation, enabled by the surrogate
+     * key of the config file. updateScores trains it with full trials.
+     */
+    SurrogateScreen& getSurrogate()
+    {
+        return *surrogate;
+    }
+
+    /**
+     * Look a controller set up in the cache, so a deterministic re-test
+     * can be skipped by passing the scores straight to updateScores.
+     * @param[in] controllers a set returned by nextSetOfControllers
+     * @param[out] scores set if found
+     * @return true if found
+     */
+    bool lookupScores(const std::vector< AnnealEvoMember *>& controllers,
+                      std::vector<double>& scores);
     const std::string suffix;
     /// @todo make this const if we decide to force everyone to put their logs in resources
     std::string resourcePath;
     
 private:
+    TrialPruner* pruner;
+    FitnessCache* cache;
+    /// 0 for none
+    int checkpointInterval;
+    std::string checkpointPath;
+    /// logs/scores, one row per scored set
+    ScoreLog* scoreLog;
+    /// logs/results, one record per scored set
+    ResultStore* results;
+    /// Chooses between candidate mutations once trained
+    SurrogateScreen* surrogate;
+    /// Whether score rows have a fidelity column
+    bool logFidelity;
+    /// What each bestParameters file last had written to it
+    std::vector< std::vector<double> > savedLeaders;
     int populationSize;
     int numberOfControllers;
-    std::tr1::ranlux64_base_01 eng;
+    /// Seeded from randomSeed in the config, if it is there
+    tgRandom rng;
     std::vector< AnnealEvoPopulation *> populations;
     std::vector <AnnealEvoMember *>  selectedControllers;
     std::vector< std::vector< double > > scoresOfTheGeneration;
@@ -0,0 +1,632 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file CMAESEvolution.cpp
+ * @brief Contains the definitions of members of class CMAESEvolution.
+ * $Id$
+ */
+
+#include "CMAESEvolution.h"
+#include "helpers/FileHelpers.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace
+{
+    double clip(double value)
+    {
+        return std::max(0.0, std::min(1.0, value));
+    }
+
+    double optionalDouble(configuration& config, const std::string& key, double value)
+    {
+        return config.iskey(key) ? config.getDoubleValue(key) : value;
+    }
+
+    int optionalInt(configuration& config, const std::string& key, int value)
+    {
+        return config.iskey(key) ? config.getintvalue(key) : value;
+    }
+
+    /** What CMA-ES and its AnnealEvoMembers cannot run without */
+    const configuration::Field cmaesFields[] =
+    {
+        { "numberOfControllers", configuration::intType },
+        { "learning", configuration::intType },
+        { "numberOfActions", configuration::intType },
+        { "deviation", configuration::doubleType },
+        { "MonteCarlo", configuration::intType }
+    };
+
+    /** Orders sample indices by descending score */
+    struct ByScore
+    {
+        ByScore(const vector<double>& s) : scores(s) { }
+        bool operator()(std::size_t a, std::size_t b) const
+        {
+            return scores[a] > scores[b];
+        }
+        const vector<double>& scores;
+    };
+
+    /**
+     * Cyclic Jacobi eigendecomposition of a symmetric matrix.
+     * @param[in,out] A destroyed
+     * @param[out] V the eigenvectors, as columns
+     * @param[out] values the eigenvalues
+     */
+    void jacobi(vector< vector<double> >& A, vector< vector<double> >& V,
+                vector<double>& values)
+    {
+        const std::size_t n = A.size();
+        V.assign(n, vector<double>(n, 0.0));
+        for (std::size_t i = 0; i < n; i++)
+        {
+            V[i][i] = 1.0;
+        }
+
+        for (int sweep = 0; sweep < 50; sweep++)
+        {
+            double off = 0.0;
+            double diag = 0.0;
+            for (std::size_t p = 0; p < n; p++)
+            {
+                diag += A[p][p] * A[p][p];
+                for (std::size_t q = p + 1; q < n; q++)
+                {
+                    off += A[p][q] * A[p][q];
+                }
+            }
+            if (off <= 1e-30 * diag)
+            {
+                break;
+            }
+
+            for (std::size_t p = 0; p < n; p++)
+            {
+                for (std::size_t q = p + 1; q < n; q++)
+                {
+                    if (A[p][q] == 0.0)
+                    {
+                        continue;
+                    }
+                    const double theta = (A[q][q] - A[p][p]) / (2.0 * A[p][q]);
+                    const double t = (theta >= 0.0 ? 1.0 : -1.0) /
+                        (fabs(theta) + sqrt(theta * theta + 1.0));
+                    const double c = 1.0 / sqrt(t * t + 1.0);
+                    const double s = t * c;
+                    for (std::size_t k = 0; k < n; k++)
+                    {
+                        const double akp = A[k][p];
+                        const double akq = A[k][q];
+                        A[k][p] = c * akp - s * akq;
+                        A[k][q] = s * akp + c * akq;
+                    }
+                    for (std::size_t k = 0; k < n; k++)
+                    {
+                        const double apk = A[p][k];
+                        const double aqk = A[q][k];
+                        A[p][k] = c * apk - s * aqk;
+                        A[q][k] = s * apk + c * aqk;
+                    }
+                    for (std::size_t k = 0; k < n; k++)
+                    {
+                        const double vkp = V[k][p];
+                        const double vkq = V[k][q];
+                        V[k][p] = c * vkp - s * vkq;
+                        V[k][q] = s * vkp + c * vkq;
+                    }
+                }
+            }
+        }
+
+        values.resize(n);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            values[i] = A[i][i];
+        }
+    }
+}
+
+CMAESEvolution::CMAESEvolution(std::string suff, std::string configName, std::string path) :
+suffix(suff),
+rng(0),
+restarts(0),
+generation(0),
+nextSample(0),
+numberScored(0),
+bestScore(0.0),
+hasBestScore(false)
+{
+    if (path != "")
+    {
+        resourcePath = FileHelpers::getResourcePath(path);
+    }
+    else
+    {
+        resourcePath = "";
+    }
+
+    std::string configPath = resourcePath + configName;
+
+    config.readFile(configPath);
+    config.validate(cmaesFields, sizeof(cmaesFields) / sizeof(cmaesFields[0]));
+    numberOfControllers=config.getintvalue("numberOfControllers");
+    sigma0 = optionalDouble(config, "cmaesSigma0", 0.3);
+    tolX = optionalDouble(config, "cmaesTolX", 1e-4);
+    tolFun = optionalDouble(config, "cmaesTolFun", 1e-6);
+    maxRestarts = optionalInt(config, "cmaesRestarts", 9);
+    incPopSize = optionalInt(config, "cmaesIncPopSize", 2);
+    bool seeded = config.iskey("startSeed") && config.getintvalue("startSeed");
+    bool learning = config.getintvalue("learning");
+
+    if (sigma0 <= 0.0)
+    {
+        throw std::invalid_argument("cmaesSigma0 is not positive");
+    }
+    if (incPopSize < 1)
+    {
+        throw std::invalid_argument("cmaesIncPopSize is not positive");
+    }
+
+    if (config.iskey("randomSeed"))
+    {
+        rng.seed(config.getintvalue("randomSeed"));
+    }
+    else
+    {
+        rng.seed(tgRandom::entropySeed());
+    }
+    std::cout << "Random seed: " << rng.getSeed() << std::endl;
+
+    pruner = new TrialPruner(config);
+    scoreLog = new ScoreLog(resourcePath + "logs/scores", config);
+    results = new ResultStore(resourcePath + "logs/results", config);
+
+    for(int i=0;i<numberOfControllers;i++)
+    {
+        best.push_back(new AnnealEvoMember(config, &rng.engine()));
+        if(seeded)
+        {
+            stringstream ss;
+            ss<< resourcePath <<"logs/bestParameters-"<<this->suffix<<"-"<<i<<".nnw";
+            best.back()->loadFromFile(ss.str().c_str());
+        }
+    }
+    dimension = flatten(best).size();
+    if (dimension == 0)
+    {
+        throw std::invalid_argument("There are no parameters to optimise");
+    }
+
+    // Start from the seed if there is one, at random otherwise
+    mean = flatten(best);
+    lambda = optionalInt(config, "cmaesLambda",
+                         4 + static_cast<int>(3.0 * log(static_cast<double>(dimension))));
+    if (lambda < 2)
+    {
+        throw std::invalid_argument("cmaesLambda is less than 2");
+    }
+
+    if(learning)
+    {
+        evolutionLog.open((resourcePath + "logs/evolution" + suffix + ".csv").c_str(),ios::out);
+        if (!evolutionLog.is_open())
+        {
+            throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
+        }
+    }
+
+    startRun(false);
+}
+
+CMAESEvolution::~CMAESEvolution()
+{
+    delete pruner;
+    delete scoreLog;
+    delete results;
+    for(std::size_t i=0;i<best.size();i++)
+    {
+        delete best[i];
+    }
+    for(std::size_t j=0;j<samples.size();j++)
+    {
+        for(std::size_t i=0;i<samples[j].size();i++)
+        {
+            delete samples[j][i];
+        }
+    }
+}
+
+vector<double> CMAESEvolution::flatten(const vector< AnnealEvoMember *>& controllers) const
+{
+    vector<double> x;
+    for(std::size_t i=0;i<controllers.size();i++)
+    {
+        x.insert(x.end(), controllers[i]->statelessParameters.begin(),
+                 controllers[i]->statelessParameters.end());
+    }
+    return x;
+}
+
+void CMAESEvolution::unflatten(const vector<double>& x, vector< AnnealEvoMember *>& controllers) const
+{
+    std::size_t n = 0;
+    for(std::size_t i=0;i<controllers.size();i++)
+    {
+        vector<double>& params = controllers[i]->statelessParameters;
+        for(std::size_t k=0;k<params.size();k++)
+        {
+            params[k] = x[n++];
+        }
+    }
+}
+
+void CMAESEvolution::startRun(bool randomMean)
+{
+    const int n = dimension;
+    if (randomMean)
+    {
+        for(int k=0;k<n;k++)
+        {
+            mean[k] = rng.uniform();
+        }
+    }
+
+    // The defaults of Hansen's "The CMA Evolution Strategy: A Tutorial"
+    mu = lambda / 2;
+    weights.resize(mu);
+    double sum = 0.0;
+    for(int i=0;i<mu;i++)
+    {
+        weights[i] = log(mu + 0.5) - log(i + 1.0);
+        sum += weights[i];
+    }
+    double sumSquares = 0.0;
+    for(int i=0;i<mu;i++)
+    {
+        weights[i] /= sum;
+        sumSquares += weights[i] * weights[i];
+    }
+    mueff = 1.0 / sumSquares;
+    cc = (4.0 + mueff / n) / (n + 4.0 + 2.0 * mueff / n);
+    cs = (mueff + 2.0) / (n + mueff + 5.0);
+    c1 = 2.0 / ((n + 1.3) * (n + 1.3) + mueff);
+    cmu = std::min(1.0 - c1, 2.0 * (mueff - 2.0 + 1.0 / mueff) / ((n + 2.0) * (n + 2.0) + mueff));
+    damps = 1.0 + 2.0 * std::max(0.0, sqrt((mueff - 1.0) / (n + 1.0)) - 1.0) + cs;
+    chiN = sqrt(static_cast<double>(n)) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+
+    sigma = sigma0;
+    C.assign(n, vector<double>(n, 0.0));
+    B.assign(n, vector<double>(n, 0.0));
+    for(int k=0;k<n;k++)
+    {
+        C[k][k] = 1.0;
+        B[k][k] = 1.0;
+    }
+    D.assign(n, 1.0);
+    pc.assign(n, 0.0);
+    ps.assign(n, 0.0);
+    runGeneration = 0;
+    eigenGeneration = 0;
+    history.clear();
+    lastRange = 0.0;
+
+    // Keep the members already made when the population grows, since
+    // callers may still hold pointers to them
+    while (static_cast<int>(samples.size()) < lambda)
+    {
+        samples.push_back(vector< AnnealEvoMember *>());
+        for(int i=0;i<numberOfControllers;i++)
+        {
+            samples.back().push_back(new AnnealEvoMember(config, &rng.engine()));
+        }
+    }
+
+    cout << "CMA-ES run " << restarts << ": lambda " << lambda << ", " << n << " parameters" << endl;
+    startGeneration();
+}
+
+void CMAESEvolution::startGeneration()
+{
+    const int n = dimension;
+    generation++;
+    runGeneration++;
+
+    steps.assign(lambda, vector<double>(n));
+    vector<double> z(n);
+    vector<double> x(n);
+    for(int j=0;j<lambda;j++)
+    {
+        for(int k=0;k<n;k++)
+        {
+            z[k] = D[k] * rng.normal(0.0, 1.0);
+        }
+        for(int k=0;k<n;k++)
+        {
+            double y = 0.0;
+            for(int l=0;l<n;l++)
+            {
+                y += B[k][l] * z[l];
+            }
+            // Evaluate inside the bounds and learn from what was evaluated
+            x[k] = clip(mean[k] + sigma * y);
+            steps[j][k] = (x[k] - mean[k]) / sigma;
+        }
+        unflatten(x, samples[j]);
+    }
+
+    scores.assign(lambda, 0.0);
+    scored.assign(lambda, false);
+    nextSample = 0;
+    numberScored = 0;
+}
+
+void CMAESEvolution::decompose()
+{
+    const int n = dimension;
+    vector< vector<double> > A = C;
+    vector<double> values;
+    jacobi(A, B, values);
+    for(int k=0;k<n;k++)
+    {
+        // Rounding can leave tiny negative eigenvalues
+        D[k] = sqrt(std::max(values[k], 1e-20));
+    }
+    eigenGeneration = runGeneration;
+}
+
+void CMAESEvolution::finishGeneration()
+{
+    const int n = dimension;
+
+    vector<std::size_t> order(lambda);
+    double total = 0.0;
+    for(int j=0;j<lambda;j++)
+    {
+        order[j] = j;
+        total += scores[j];
+    }
+    std::sort(order.begin(), order.end(), ByScore(scores));
+    const std::size_t first = order[0];
+
+    if(!hasBestScore || scores[first] > bestScore)
+    {
+        bestScore = scores[first];
+        hasBestScore = true;
+        for(int i=0;i<numberOfControllers;i++)
+        {
+            best[i]->statelessParameters = samples[first][i]->statelessParameters;
+        }
+        for(int i=0;i<numberOfControllers;i++)
+        {
+            stringstream ss;
+            ss << resourcePath << "logs/bestParameters-" << suffix << "-" << i << ".nnw";
+            best[i]->saveToFile(ss.str().c_str());
+        }
+    }
+    history.push_back(scores[first]);
+    lastRange = scores[first] - scores[order[lambda - 1]];
+
+    // Recombination
+    vector<double> ymean(n, 0.0);
+    for(int i=0;i<mu;i++)
+    {
+        for(int k=0;k<n;k++)
+        {
+            ymean[k] += weights[i] * steps[order[i]][k];
+        }
+    }
+    for(int k=0;k<n;k++)
+    {
+        mean[k] += sigma * ymean[k];
+    }
+
+    // Step size path, with C^-1/2 = B D^-1 B^T
+    vector<double> tmp(n, 0.0);
+    for(int l=0;l<n;l++)
+    {
+        for(int k=0;k<n;k++)
+        {
+            tmp[l] += B[k][l] * ymean[k];
+        }
+        tmp[l] /= D[l];
+    }
+    const double csFactor = sqrt(cs * (2.0 - cs) * mueff);
+    double psNorm = 0.0;
+    for(int k=0;k<n;k++)
+    {
+        double v = 0.0;
+        for(int l=0;l<n;l++)
+        {
+            v += B[k][l] * tmp[l];
+        }
+        ps[k] = (1.0 - cs) * ps[k] + csFactor * v;
+        psNorm += ps[k] * ps[k];
+    }
+    psNorm = sqrt(psNorm);
+
+    const bool hsig = psNorm / sqrt(1.0 - pow(1.0 - cs, 2.0 * runGeneration)) / chiN
+        < 1.4 + 2.0 / (n + 1.0);
+    const double ccFactor = sqrt(cc * (2.0 - cc) * mueff);
+    for(int k=0;k<n;k++)
+    {
+        pc[k] = (1.0 - cc) * pc[k] + (hsig ? ccFactor * ymean[k] : 0.0);
+    }
+
+    // Covariance: rank one and rank mu updates
+    const double oldWeight = 1.0 - c1 - cmu + (hsig ? 0.0 : c1 * cc * (2.0 - cc));
+    for(int k=0;k<n;k++)
+    {
+        for(int l=0;l<=k;l++)
+        {
+            double rankMu = 0.0;
+            for(int i=0;i<mu;i++)
+            {
+                rankMu += weights[i] * steps[order[i]][k] * steps[order[i]][l];
+            }
+            C[k][l] = oldWeight * C[k][l] + c1 * pc[k] * pc[l] + cmu * rankMu;
+            C[l][k] = C[k][l];
+        }
+    }
+
+    sigma *= exp((cs / damps) * (psNorm / chiN - 1.0));
+
+    // Decompose often enough to keep the cost below that of the update
+    if ((runGeneration - eigenGeneration) * (c1 + cmu) * n * 10.0 >= 1.0)
+    {
+        decompose();
+    }
+
+    evolutionLog<<generation<<","<<lambda<<","<<total / lambda<<","<<scores[first]<<","<<bestScore<<","<<sigma<<endl;
+    scoreLog->flush();
+    results->flush();
+}
+
+bool CMAESEvolution::shouldRestart() const
+{
+    if (restarts >= maxRestarts)
+    {
+        return false;
+    }
+
+    double spread = 0.0;
+    for(int k=0;k<dimension;k++)
+    {
+        spread = std::max(spread, sigma * sqrt(C[k][k]));
+    }
+    if (spread < tolX)
+    {
+        return true;
+    }
+
+    const std::size_t window = 10 + static_cast<std::size_t>(ceil(30.0 * dimension / lambda));
+    if (history.size() >= window)
+    {
+        const double high = *std::max_element(history.end() - window, history.end());
+        const double low = *std::min_element(history.end() - window, history.end());
+        if (high - low < tolFun && lastRange < tolFun)
+        {
+            return true;
+        }
+    }
+
+    const double dMax = *std::max_element(D.begin(), D.end());
+    const double dMin = *std::min_element(D.begin(), D.end());
+    return dMax > 1e7 * dMin;
+}
+
+vector <AnnealEvoMember *> CMAESEvolution::nextSetOfControllers()
+{
+    if (!evolutionLog.is_open())
+    {
+        // Not learning: always run the best
+        selectedControllers = best;
+        return selectedControllers;
+    }
+
+    if (nextSample == lambda)
+    {
+        if (numberScored != nextSample)
+        {
+            throw std::logic_error("Every sample must be scored before the next generation");
+        }
+        finishGeneration();
+        if (shouldRestart())
+        {
+            restarts++;
+            lambda *= incPopSize;
+            startRun(true);
+        }
+        else
+        {
+            startGeneration();
+        }
+    }
+
+    selectedControllers = samples[nextSample++];
+    return selectedControllers;
+}
+
+void CMAESEvolution::updateScores(vector <double> multiscore)
+{
+    updateScores(selectedControllers, multiscore);
+}
+
+void CMAESEvolution::updateScores(const vector <AnnealEvoMember *>& controllers,
+                                  vector <double> multiscore)
+{
+    // Same convention as AnnealEvolution for an explosion
+    while (multiscore.size() < 2)
+    {
+        multiscore.push_back(-1.0);
+    }
+
+    vector<double> row(multiscore.begin(), multiscore.begin() + 2);
+    const vector<double> x = flatten(controllers);
+    row.insert(row.end(), x.begin(), x.end());
+    scoreLog->append(row);
+    vector< vector<double> > parameters;
+    for(std::size_t i=0;i<controllers.size();i++)
+    {
+        parameters.push_back(controllers[i]->statelessParameters);
+    }
+    results->append(parameters, multiscore);
+
+    if (!evolutionLog.is_open())
+    {
+        return;
+    }
+
+    int j = 0;
+    while (j < nextSample && samples[j] != controllers)
+    {
+        j++;
+    }
+    if (j == nextSample)
+    {
+        throw std::invalid_argument("Controllers are not from this generation");
+    }
+    if (!scored[j])
+    {
+        scored[j] = true;
+        numberScored++;
+    }
+    scores[j] = multiscore[0];
+    for(std::size_t i=0;i<controllers.size();i++)
+    {
+        controllers[i]->maxScore = multiscore[0];
+        controllers[i]->maxScore1 = multiscore[0];
+        controllers[i]->maxScore2 = multiscore[1];
+    }
+}
+
+int CMAESEvolution::episodesLeftInGeneration() const
+{
+    if (!evolutionLog.is_open())
+    {
+        return 0;
+    }
+    return lambda - nextSample;
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef CMAESEVOLUTION_H_
+#define CMAESEVOLUTION_H_
+
+/**
+ * @file CMAESEvolution.h
+ * @brief Contains the definition of class CMAESEvolution.
+ * $Id$
+ */
+
+#include "learning/AnnealEvolution/AnnealEvoMember.h"
+#include "learning/Configuration/configuration.h"
+#include "learning/Pruning/TrialPruner.h"
+#include "learning/ScoreLog/ScoreLog.h"
+#include "learning/ResultStore/ResultStore.h"
+#include "core/tgRandom.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * The covariance matrix adaptation evolution strategy, with restarts
+ * that double the population (IPOP-CMA-ES), over the
+ * statelessParameters of one set of controllers. It maximises the
+ * first score.
+ *
+ * Each generation samples cmaesLambda sets, 4 + 3 ln n by default for
+ * n parameters over all the controllers, from N(m, sigma^2 C) clipped
+ * to [0, 1]. The best half move m and adapt sigma and C. A restart
+ * from a random m is made if sigma has shrunk below cmaesTolX, the
+ * scores have stopped changing by more than cmaesTolFun, or C has
+ * become ill conditioned, up to cmaesRestarts times, each one
+ * multiplying the population by cmaesIncPopSize.
+ *
+ * It hands out and takes scores for sets of AnnealEvoMember in the same
+ * way as AnnealEvolution, so AnnealAdapter can drive it one trial at a
+ * time and ParallelEvolutionAdapter<CMAESEvolution, AnnealEvoMember>
+ * can run a generation in parallel worlds.
+ */
+class CMAESEvolution
+{
+public:
+    CMAESEvolution(std::string suffix, std::string config = "config.ini", std::string path = "");
+    ~CMAESEvolution();
+
+    /**
+     * The next sample of this generation, starting the next generation
+     * once every sample has been scored.
+     * @throw std::logic_error if the next generation is due but some
+     * samples have not been scored
+     */
+    std::vector< AnnealEvoMember *> nextSetOfControllers();
+
+    /** Score the set last returned by nextSetOfControllers */
+    void updateScores(std::vector<double> scores);
+
+    /**
+     * Score any set handed out in this generation. The update is made
+     * when the last one is scored.
+     * @throw std::invalid_argument if controllers is not a set of this
+     * generation
+     */
+    void updateScores(const std::vector< AnnealEvoMember *>& controllers,
+                      std::vector<double> scores);
+
+    /**
+     * The same; the fidelity is ignored, as every sample of an update
+     * must come from the same simulation.
+     */
+    void updateScores(const std::vector< AnnealEvoMember *>& controllers,
+                      std::vector<double> scores, int fidelity)
+    {
+        updateScores(controllers, scores);
+    }
+
+    /** The samples of this generation not handed out yet */
+    int episodesLeftInGeneration() const;
+
+    /** As for AnnealEvolution */
+    TrialPruner& getPruner()
+    {
+        return *pruner;
+    }
+
+    /** The best parameters scored so far, one member per controller */
+    const std::vector< AnnealEvoMember *>& getBest() const
+    {
+        return best;
+    }
+
+    const std::string suffix;
+    std::string resourcePath;
+
+private:
+    void startRun(bool randomMean);
+    void startGeneration();
+    void finishGeneration();
+    bool shouldRestart() const;
+    void decompose();
+
+    std::vector<double> flatten(const std::vector< AnnealEvoMember *>& controllers) const;
+    void unflatten(const std::vector<double>& x, std::vector< AnnealEvoMember *>& controllers) const;
+
+    configuration config;
+    TrialPruner* pruner;
+    ScoreLog* scoreLog;
+    ResultStore* results;
+    tgRandom rng;
+    int numberOfControllers;
+    /// n, the parameters over all the controllers
+    int dimension;
+
+    double sigma0;
+    double tolX;
+    double tolFun;
+    int maxRestarts;
+    int incPopSize;
+
+    /// The strategy parameters of the current run
+    int lambda;
+    int mu;
+    std::vector<double> weights;
+    double mueff;
+    double cc;
+    double cs;
+    double c1;
+    double cmu;
+    double damps;
+    double chiN;
+
+    /// The state of the current run
+    std::vector<double> mean;
+    double sigma;
+    std::vector< std::vector<double> > C;
+    /// C = B diag(D^2) B^T
+    std::vector< std::vector<double> > B;
+    std::vector<double> D;
+    std::vector<double> pc;
+    std::vector<double> ps;
+    int runGeneration;
+    int eigenGeneration;
+    /// Best score of each generation of this run
+    std::vector<double> history;
+    double lastRange;
+
+    int restarts;
+    int generation;
+
+    std::vector< std::vector< AnnealEvoMember *> > samples;
+    /// (x - m) / sigma for each sample, after clipping
+    std::vector< std::vector<double> > steps;
+    std::vector<double> scores;
+    std::vector<bool> scored;
+    int nextSample;
+    int numberScored;
+
+    std::vector< AnnealEvoMember *> best;
+    double bestScore;
+    bool hasBestScore;
+
+    std::vector <AnnealEvoMember *>  selectedControllers;
+    std::ofstream evolutionLog;
+};
+
+#endif /* CMAESEVOLUTION_H_ */
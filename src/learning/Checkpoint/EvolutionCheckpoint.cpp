@@ -0,0 +1,167 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file EvolutionCheckpoint.cpp
+ * @brief Contains the definitions of members of class EvolutionCheckpoint
+ * $Id$
+ */
+
+#include "EvolutionCheckpoint.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <unistd.h>
+
+namespace
+{
+    const char magic[] = "NTRTEVO1";
+    const std::size_t magicSize = sizeof(magic) - 1;
+}
+
+EvolutionCheckpoint::EvolutionCheckpoint() :
+m_data(magic, magicSize),
+m_position(magicSize)
+{
+}
+
+void EvolutionCheckpoint::writeInt(int value)
+{
+    const int32_t v = value;
+    m_data.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void EvolutionCheckpoint::writeDouble(double value)
+{
+    m_data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void EvolutionCheckpoint::writeString(const std::string& value)
+{
+    writeInt(value.size());
+    m_data.append(value);
+}
+
+void EvolutionCheckpoint::writeVector(const std::vector<double>& value)
+{
+    writeInt(value.size());
+    for (std::size_t i = 0; i < value.size(); i++)
+    {
+        writeDouble(value[i]);
+    }
+}
+
+void EvolutionCheckpoint::read(void* data, std::size_t size)
+{
+    if (m_data.size() - m_position < size)
+    {
+        throw std::runtime_error("Checkpoint is truncated");
+    }
+    std::memcpy(data, m_data.data() + m_position, size);
+    m_position += size;
+}
+
+int EvolutionCheckpoint::readInt()
+{
+    int32_t v;
+    read(&v, sizeof(v));
+    return v;
+}
+
+double EvolutionCheckpoint::readDouble()
+{
+    double v;
+    read(&v, sizeof(v));
+    return v;
+}
+
+std::string EvolutionCheckpoint::readString()
+{
+    const int n = readInt();
+    if (n < 0 || m_data.size() - m_position < static_cast<std::size_t>(n))
+    {
+        throw std::runtime_error("Checkpoint is truncated");
+    }
+    const std::string s = m_data.substr(m_position, n);
+    m_position += n;
+    return s;
+}
+
+std::vector<double> EvolutionCheckpoint::readVector()
+{
+    const int n = readInt();
+    if (n < 0)
+    {
+        throw std::runtime_error("Checkpoint is corrupt");
+    }
+    std::vector<double> v(n);
+    for (int i = 0; i < n; i++)
+    {
+        v[i] = readDouble();
+    }
+    return v;
+}
+
+void EvolutionCheckpoint::save(const std::string& filename) const
+{
+    const std::string temp = filename + ".tmp";
+    FILE* f = std::fopen(temp.c_str(), "wb");
+    if (f == NULL)
+    {
+        throw std::runtime_error("Could not open " + temp);
+    }
+    const bool written =
+        std::fwrite(m_data.data(), 1, m_data.size(), f) == m_data.size() &&
+        std::fflush(f) == 0 &&
+        fsync(fileno(f)) == 0;
+    std::fclose(f);
+    if (!written || std::rename(temp.c_str(), filename.c_str()) != 0)
+    {
+        std::remove(temp.c_str());
+        throw std::runtime_error("Could not write " + filename + ": " +
+                                 std::strerror(errno));
+    }
+}
+
+bool EvolutionCheckpoint::load(const std::string& filename)
+{
+    FILE* f = std::fopen(filename.c_str(), "rb");
+    if (f == NULL)
+    {
+        return false;
+    }
+    std::string data;
+    char buffer[65536];
+    std::size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), f)) > 0)
+    {
+        data.append(buffer, n);
+    }
+    std::fclose(f);
+
+    if (data.compare(0, magicSize, magic) != 0)
+    {
+        throw std::runtime_error(filename + " is not an evolution checkpoint");
+    }
+    m_data = data;
+    m_position = magicSize;
+    return true;
+}
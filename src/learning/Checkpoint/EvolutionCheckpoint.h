@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef EVOLUTION_CHECKPOINT_H_
+#define EVOLUTION_CHECKPOINT_H_
+
+/**
+ * @file EvolutionCheckpoint.h
+ * @brief Contains the definition of class EvolutionCheckpoint, a binary
+ * snapshot of a learning run that survives the process being killed.
+ * $Id$
+ */
+
+#include <string>
+#include <vector>
+
+/**
+ * A buffer that an evolution writes its whole state into, field by
+ * field, and reads it back from in the same order. save() writes to a
+ * temporary file, syncs it and renames it over the old checkpoint, so
+ * a process killed at any point leaves either the old or the new
+ * checkpoint, never a partial one.
+ *
+ * Numbers are stored in the machine's own byte order; a checkpoint is
+ * meant to be resumed on the same kind of machine.
+ */
+class EvolutionCheckpoint
+{
+public:
+
+    /** An empty checkpoint for writing */
+    EvolutionCheckpoint();
+
+    void writeInt(int value);
+    void writeDouble(double value);
+    void writeString(const std::string& value);
+    void writeVector(const std::vector<double>& value);
+
+    /** @throw std::runtime_error if the checkpoint is too short */
+    int readInt();
+    double readDouble();
+    std::string readString();
+    std::vector<double> readVector();
+
+    /**
+     * Replace the file with what has been written.
+     * @throw std::runtime_error if the file cannot be written
+     */
+    void save(const std::string& filename) const;
+
+    /**
+     * Read a file saved by save, ready for the read functions.
+     * @return false if there is no such file
+     * @throw std::runtime_error if the file is not a checkpoint
+     */
+    bool load(const std::string& filename);
+
+private:
+
+    void read(void* data, std::size_t size);
+
+    std::string m_data;
+
+    /** Where the next read starts */
+    std::size_t m_position;
+};
+
+#endif  // EVOLUTION_CHECKPOINT_H_
@@ -25,64 +25,183 @@
  * $Id$
  */
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <stdexcept>
+#include <stdint.h>
 #include "configuration.h"
+#include "core/tgTrialTiming.h"
+#include "helpers/FileHelpers.h"
 
 using namespace std;
 
+namespace
+{
+	const char binaryMagic[8] = { 'N', 'T', 'R', 'T', 'C', 'F', 'G', '1' };
+
+	template <class T>
+	void writeRaw(std::ostream& out, const T& value)
+	{
+		out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	template <class T>
+	bool readRaw(std::istream& in, T& value)
+	{
+		return in.read(reinterpret_cast<char*>(&value), sizeof(value)).good();
+	}
+
+	void writeString(std::ostream& out, const std::string& value)
+	{
+		writeRaw(out, static_cast<uint32_t>(value.size()));
+		out.write(value.data(), value.size());
+	}
+
+	bool readString(std::istream& in, std::string& value)
+	{
+		uint32_t size = 0;
+		if (!readRaw(in, size))
+		{
+			return false;
+		}
+		value.resize(size);
+		return size == 0 || in.read(&value[0], size).good();
+	}
+}
+
+configuration::Value::Value() :
+isInt(false),
+intValue(0),
+isDouble(false),
+doubleValue(0.0),
+isString(false)
+{
+}
+
 configuration::configuration(){}
 configuration::~configuration(){}
 
-int configuration::getintvalue( const std::string& key )
+configuration::Value configuration::convert(const std::string& text)
+{
+	Value value;
+	{
+		std::istringstream ss( text );
+		ss >> value.intValue;
+		value.isInt = ss.eof();
+	}
+	{
+		std::istringstream ss( text );
+		ss >> value.doubleValue;
+		value.isDouble = ss.eof();
+	}
+	{
+		std::istringstream ss( text );
+		ss >> value.stringValue;
+		value.isString = ss.eof();
+	}
+	return value;
+}
+
+const configuration::Value& configuration::lookup(const std::string& key, Value& scratch) const
+{
+	std::map <std::string, Value>::const_iterator it = values.find( key );
+	if (it != values.end())
+	{
+		return it->second;
+	}
+	// Written to data directly rather than through set
+	scratch = convert( data.find( key )->second );
+	return scratch;
+}
+
+int configuration::getintvalue( const std::string& key ) const
 {
 	if (!iskey( key )){
 		std::cout<<"Cannot find the key in the config file, Key: "<<key<<endl;
 		throw 0;
 	}
-	std::istringstream ss( this->data.operator [] ( key ) );
-	int result;
-	ss >> result;
-	if (!ss.eof())
+	Value scratch;
+	const Value& value = lookup( key, scratch );
+	if (!value.isInt)
 	{
 		std::cout<<"Problematic key: "<<key<<endl;
 		std::cout<<"Error reading configuration file"<<endl;
 		throw 1;
 	}
-	return result;
+	return value.intValue;
 }
 
 
-double configuration::getDoubleValue(const std::string& key )
+double configuration::getDoubleValue(const std::string& key ) const
 {
 	if (!iskey( key )) throw 0;
-	std::istringstream ss( this->data.operator [] ( key ) );
-	double result;
-	ss >> result;
-	if (!ss.eof()) throw 1;
-	return result;
+	Value scratch;
+	const Value& value = lookup( key, scratch );
+	if (!value.isDouble) throw 1;
+	return value.doubleValue;
 }
 
-std::string configuration::getStringValue(const std::string& key )
+std::string configuration::getStringValue(const std::string& key ) const
 {
 	if (!iskey( key )) throw 0;
-	std::istringstream ss( this->data.operator [] ( key ) );
-	string result;
-	ss >> result;
-	if (!ss.eof()) throw 1;
-	return result;
+	Value scratch;
+	const Value& value = lookup( key, scratch );
+	if (!value.isString) throw 1;
+	return value.stringValue;
+}
+
+void configuration::set(const std::string& key, const std::string& value)
+{
+	this->data[ key ] = value;
+	this->values[ key ] = convert( value );
+}
+
+void configuration::validate(const Field* fields, std::size_t count) const
+{
+	std::string problems;
+	for (std::size_t i = 0; i < count; i++)
+	{
+		const std::string key = fields[i].key;
+		if (!iskey( key ))
+		{
+			problems += " missing " + key;
+			continue;
+		}
+		Value scratch;
+		const Value& value = lookup( key, scratch );
+		const bool ok = (fields[i].type == intType && value.isInt) ||
+			(fields[i].type == doubleType && value.isDouble) ||
+			(fields[i].type == stringType && value.isString);
+		if (!ok)
+		{
+			problems += " malformed " + key;
+		}
+	}
+	if (!problems.empty())
+	{
+		std::cout<<"Error reading configuration file:"<<problems<<endl;
+		throw std::invalid_argument("Bad configuration:" + problems);
+	}
 }
 
 void configuration::readFile(const std::string filename)
 {
+	tgTrialTiming::Scope timing(tgTrialTiming::eConfig);
+	if (readBinary(filename))
+	{
+		return;
+	}
+
 	std::string s, key, value;
-	std::ifstream confFile(&filename[0]);
-	if(!confFile.is_open())
+	const FileHelpers::Resource source = FileHelpers::getResource(filename);
+	if(!source.isValid())
 	{
 		std::cout<<"Warning! Config.ini file not found!"<<std::endl;
 		return;
 	}
+	FileHelpers::ResourceStream confFile(source);
 
 	// For each (key, value) pair in the file
 	while (std::getline( confFile, s ))
@@ -112,9 +231,8 @@ void configuration::readFile(const std::string filename)
 		value = s.substr( begin, end - begin );
 
 		// Insert the properly extracted (key, value) pair into the map
-		this->data[ key ] = value;
+		set( key, value );
 	}
-	confFile.close();
 	return;
 }
 
@@ -127,3 +245,61 @@ void configuration::writeToFile(const std::string filename)
 	confFile.close();
 	return;
 }
+
+void configuration::writeBinary(const std::string& filename) const
+{
+	ofstream out(filename.c_str(), ios::binary);
+	out.write(binaryMagic, sizeof(binaryMagic));
+	writeRaw(out, static_cast<uint32_t>(this->data.size()));
+	for (std::map <std::string, std::string>::const_iterator iter = this->data.begin(); iter != this->data.end(); iter++)
+	{
+		Value scratch;
+		const Value& value = lookup(iter->first, scratch);
+		writeString(out, iter->first);
+		writeString(out, iter->second);
+		const uint8_t flags = (value.isInt ? 1 : 0) | (value.isDouble ? 2 : 0) | (value.isString ? 4 : 0);
+		writeRaw(out, flags);
+		writeRaw(out, static_cast<int32_t>(value.intValue));
+		writeRaw(out, value.doubleValue);
+		writeString(out, value.stringValue);
+	}
+	if (!out.good())
+	{
+		throw std::runtime_error("Cannot write configuration to " + filename);
+	}
+}
+
+bool configuration::readBinary(const std::string& filename)
+{
+	ifstream in(filename.c_str(), ios::binary);
+	char magic[sizeof(binaryMagic)];
+	if (!in.read(magic, sizeof(magic)) ||
+		!std::equal(magic, magic + sizeof(magic), binaryMagic))
+	{
+		return false;
+	}
+
+	uint32_t count = 0;
+	readRaw(in, count);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		std::string key, text;
+		Value value;
+		uint8_t flags = 0;
+		int32_t intValue = 0;
+		if (!readString(in, key) || !readString(in, text) ||
+			!readRaw(in, flags) || !readRaw(in, intValue) ||
+			!readRaw(in, value.doubleValue) || !readString(in, value.stringValue))
+		{
+			std::cout<<"Truncated binary configuration file "<<filename<<endl;
+			throw 1;
+		}
+		value.isInt = (flags & 1) != 0;
+		value.intValue = intValue;
+		value.isDouble = (flags & 2) != 0;
+		value.isString = (flags & 4) != 0;
+		this->data[ key ] = text;
+		this->values[ key ] = value;
+	}
+	return true;
+}
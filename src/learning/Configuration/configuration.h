@@ -27,6 +27,7 @@
  * $Id$
  */
 
+#include <cstddef>
 #include <map>
 #include <string>
 
@@ -47,12 +48,33 @@ class configuration
   //
   // Notice that the configuration file format does not permit values to span
   // more than one line, commentary at the end of a line, or [section]s.
+  //
+  // Each value is converted to int, double and string once, when it is read,
+  // so the getters below only look the key up. readFile also accepts the
+  // binary form written by writeBinary, which workers can load without
+  // parsing text at all.
   */
 
 public:
    configuration();
    ~configuration();
 
+   /** The kinds of value validate can require */
+   enum Type
+   {
+       intType,
+       doubleType,
+       stringType
+   };
+
+   /** A key a learner cannot run without, and the kind of its value */
+   struct Field
+   {
+       const char* key;
+       Type type;
+   };
+
+   /** The text of each value, as read. Change values through set. */
    std::map <std::string, std::string> data;
     // Here is a little convenience method...
     bool iskey( const std::string& s ) const
@@ -62,11 +84,53 @@ public:
     // Gets an integer value from a key. If the key does not exist, or if the value
     // is not an integer, throws an int exception.
     //
-    int getintvalue( const std::string& key );
-    double getDoubleValue(const std::string& key );
-	std::string getStringValue(const std::string& key );
+    int getintvalue( const std::string& key ) const;
+    double getDoubleValue(const std::string& key ) const;
+	std::string getStringValue(const std::string& key ) const;
+    /** Add or replace a value, converting it as readFile does */
+    void set(const std::string& key, const std::string& value);
+    /**
+     * Check, once at load, that every field is present and converts to its
+     * type, so a bad file fails with every problem listed instead of on the
+     * first getter that meets one.
+     * @throw std::invalid_argument naming the keys that are missing or
+     * malformed
+     */
+    void validate(const Field* fields, std::size_t count) const;
     void readFile(const std::string filename);
     void writeToFile(const std::string filename);
+    /**
+     * Write the converted values, for readFile to load without parsing.
+     * @throw std::runtime_error if the file cannot be written
+     */
+    void writeBinary(const std::string& filename) const;
+
+private:
+
+    /** A value in each of the forms the getters return */
+    struct Value
+    {
+        Value();
+
+        /** Whether getintvalue would have accepted the text */
+        bool isInt;
+        int intValue;
+        bool isDouble;
+        double doubleValue;
+        bool isString;
+        std::string stringValue;
+    };
+
+    /** Convert text as the getters always have: one token, nothing left over */
+    static Value convert(const std::string& text);
+
+    /** Load the output of writeBinary, false if the file is not binary */
+    bool readBinary(const std::string& filename);
+
+    /** The converted value of a key in data, converted now if need be */
+    const Value& lookup(const std::string& key, Value& scratch) const;
+
+    std::map <std::string, Value> values;
 };
 
 #endif
@@ -0,0 +1,252 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file FitnessCache.cpp
+ * @brief Contains the definitions of members of class FitnessCache
+ * $Id$
+ */
+
+#include "FitnessCache.h"
+#include "learning/Configuration/configuration.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    const unsigned long long fnvOffset = 14695981039346656037ULL;
+    const unsigned long long fnvPrime = 1099511628211ULL;
+
+    /** FNV-1a over raw bytes */
+    unsigned long long hashBytes(unsigned long long h, const void* data,
+                                 std::size_t n)
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            h ^= p[i];
+            h *= fnvPrime;
+        }
+        return h;
+    }
+
+    unsigned long long hashString(unsigned long long h, const std::string& s)
+    {
+        // Include the length so "ab","c" and "a","bc" differ
+        const std::size_t n = s.size();
+        h = hashBytes(h, &n, sizeof(n));
+        return hashBytes(h, s.data(), n);
+    }
+
+    class Lock
+    {
+    public:
+        Lock(pthread_mutex_t& m) : m_m(m) { pthread_mutex_lock(&m_m); }
+        ~Lock() { pthread_mutex_unlock(&m_m); }
+    private:
+        pthread_mutex_t& m_m;
+    };
+}
+
+FitnessCache::FitnessCache(const std::string& context) :
+m_enabled(true),
+m_context(hashString(fnvOffset, context)),
+m_hits(0),
+m_misses(0)
+{
+    init();
+}
+
+FitnessCache::FitnessCache(configuration& config) :
+m_enabled(false),
+m_context(fnvOffset),
+m_hits(0),
+m_misses(0)
+{
+    init();
+    if (config.iskey("fitnessCache"))
+    {
+        m_enabled = config.getintvalue("fitnessCache");
+    }
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    std::map<std::string, std::string>::const_iterator it;
+    for (it = config.data.begin(); it != config.data.end(); ++it)
+    {
+        m_context = hashString(m_context, it->first);
+        m_context = hashString(m_context, it->second);
+    }
+
+    if (config.iskey("fitnessCacheFile"))
+    {
+        const std::string filename = config.getStringValue("fitnessCacheFile");
+        // A missing file is fine, it is the first run
+        std::ifstream test(filename.c_str());
+        if (test.is_open())
+        {
+            test.close();
+            load(filename);
+        }
+        m_file.open(filename.c_str(), std::ios::app);
+        if (!m_file.is_open())
+        {
+            throw std::runtime_error("Could not open " + filename);
+        }
+    }
+}
+
+FitnessCache::~FitnessCache()
+{
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void FitnessCache::init()
+{
+    pthread_mutex_init(&m_mutex, NULL);
+}
+
+void FitnessCache::addContext(const std::string& context)
+{
+    Lock lock(m_mutex);
+    m_context = hashString(m_context, context);
+}
+
+FitnessCache::Key FitnessCache::key(const std::vector< std::vector<double> >& parameters) const
+{
+    Key h = m_context;
+    const std::size_t n = parameters.size();
+    h = hashBytes(h, &n, sizeof(n));
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const std::size_t m = parameters[i].size();
+        h = hashBytes(h, &m, sizeof(m));
+        // The exact bits: a parameter that differs at all is a new trial
+        if (m > 0)
+        {
+            h = hashBytes(h, &parameters[i][0], m * sizeof(double));
+        }
+    }
+    return h;
+}
+
+bool FitnessCache::lookup(const std::vector< std::vector<double> >& parameters,
+                          std::vector<double>& scores)
+{
+    if (!m_enabled)
+    {
+        return false;
+    }
+    Lock lock(m_mutex);
+    std::map<Key, std::vector<double> >::const_iterator it =
+        m_scores.find(key(parameters));
+    if (it == m_scores.end())
+    {
+        m_misses++;
+        return false;
+    }
+    m_hits++;
+    scores = it->second;
+    return true;
+}
+
+void FitnessCache::store(const std::vector< std::vector<double> >& parameters,
+                         const std::vector<double>& scores)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+    Lock lock(m_mutex);
+    const Key k = key(parameters);
+    std::vector<double>& entry = m_scores[k];
+    if (entry == scores)
+    {
+        return;
+    }
+    entry = scores;
+    if (m_file.is_open())
+    {
+        char hex[17];
+        std::sprintf(hex, "%016llx", k);
+        m_file << hex;
+        m_file.precision(17);
+        for (std::size_t i = 0; i < scores.size(); i++)
+        {
+            m_file << "," << scores[i];
+        }
+        m_file << std::endl;
+    }
+}
+
+void FitnessCache::load(const std::string& filename)
+{
+    std::ifstream in(filename.c_str());
+    if (!in.is_open())
+    {
+        throw std::runtime_error("Could not open " + filename);
+    }
+    Lock lock(m_mutex);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::stringstream ss(line);
+        std::string cell;
+        if (!std::getline(ss, cell, ',') || cell.empty())
+        {
+            continue;
+        }
+        const Key k = std::strtoull(cell.c_str(), NULL, 16);
+        std::vector<double> scores;
+        while (std::getline(ss, cell, ','))
+        {
+            scores.push_back(std::atof(cell.c_str()));
+        }
+        // Later lines win, as they were stored later
+        m_scores[k] = scores;
+    }
+}
+
+void FitnessCache::save(const std::string& filename) const
+{
+    std::ofstream out(filename.c_str());
+    if (!out.is_open())
+    {
+        throw std::runtime_error("Could not open " + filename);
+    }
+    out.precision(17);
+    Lock lock(m_mutex);
+    std::map<Key, std::vector<double> >::const_iterator it;
+    for (it = m_scores.begin(); it != m_scores.end(); ++it)
+    {
+        char hex[17];
+        std::sprintf(hex, "%016llx", it->first);
+        out << hex;
+        for (std::size_t i = 0; i < it->second.size(); i++)
+        {
+            out << "," << it->second[i];
+        }
+        out << std::endl;
+    }
+}
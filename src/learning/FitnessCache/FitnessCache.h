@@ -0,0 +1,155 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef FITNESS_CACHE_H_
+#define FITNESS_CACHE_H_
+
+/**
+ * @file FitnessCache.h
+ * @brief Contains the definition of class FitnessCache, which remembers
+ * the scores of parameter sets that have already been simulated.
+ * $Id$
+ */
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+// POSIX threads
+#include <pthread.h>
+
+class configuration;
+
+/**
+ * Scores of controller parameter sets, keyed by a hash of the
+ * parameters and of a context describing the model and configuration.
+ * With a deterministic simulation a parameter set always gets the same
+ * score, so an evolution re-testing its elite can look the score up
+ * instead of running the trial again. Only enable it when the model,
+ * controllers and terrain add no noise.
+ *
+ * Entries can be saved to a file and loaded by a later run to warm
+ * start it. Entries made under a different context are loaded too, but
+ * never match. Safe to call from several threads.
+ */
+class FitnessCache
+{
+public:
+
+    /**
+     * An enabled cache that is not backed by a file.
+     * @param[in] context anything that identifies the model and
+     * configuration the scores depend on
+     */
+    FitnessCache(const std::string& context = "");
+
+    /**
+     * Read the optional keys fitnessCache (0 or 1, off by default) and
+     * fitnessCacheFile. If the file is given, its entries are loaded
+     * and new entries are appended to it. The context starts from every
+     * key and value of the configuration.
+     * @throw std::runtime_error if the file cannot be opened
+     */
+    FitnessCache(configuration& config);
+
+    ~FitnessCache();
+
+    bool isEnabled() const
+    {
+        return m_enabled;
+    }
+
+    /**
+     * Mix more into the context, such as a description of the model.
+     * Only affects entries looked up or stored afterwards.
+     */
+    void addContext(const std::string& context);
+
+    /**
+     * Find the scores of a parameter set.
+     * @param[in] parameters one vector per controller
+     * @param[out] scores set if found
+     * @return true if found; always false when disabled
+     */
+    bool lookup(const std::vector< std::vector<double> >& parameters,
+                std::vector<double>& scores);
+
+    /**
+     * Remember the scores of a parameter set, replacing earlier ones.
+     * Does nothing when disabled.
+     */
+    void store(const std::vector< std::vector<double> >& parameters,
+               const std::vector<double>& scores);
+
+    /**
+     * Add the entries of a file written by a cache.
+     * @throw std::runtime_error if the file cannot be opened
+     */
+    void load(const std::string& filename);
+
+    /** Write every entry to a file, replacing it */
+    void save(const std::string& filename) const;
+
+    std::size_t size() const
+    {
+        return m_scores.size();
+    }
+
+    /** The number of successful lookups */
+    std::size_t getHits() const
+    {
+        return m_hits;
+    }
+
+    /** The number of failed lookups while enabled */
+    std::size_t getMisses() const
+    {
+        return m_misses;
+    }
+
+private:
+
+    typedef unsigned long long Key;
+
+    Key key(const std::vector< std::vector<double> >& parameters) const;
+
+    void init();
+
+    /** Not copyable */
+    FitnessCache(const FitnessCache&);
+    FitnessCache& operator=(const FitnessCache&);
+
+private:
+
+    bool m_enabled;
+
+    /** The hash of the context */
+    Key m_context;
+
+    std::map<Key, std::vector<double> > m_scores;
+
+    /** New entries are appended here while it is open */
+    std::ofstream m_file;
+
+    std::size_t m_hits;
+    std::size_t m_misses;
+
+    mutable pthread_mutex_t m_mutex;
+};
+
+#endif  // FITNESS_CACHE_H_
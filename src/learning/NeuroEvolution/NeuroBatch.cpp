@@ -0,0 +1,259 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file NeuroBatch.cpp
+ * @brief Contains the definitions of members of class NeuroBatch
+ * $Id$
+ */
+
+#include "NeuroBatch.h"
+#include "NeuroEvoMember.h"
+#include "neuralNet/Neural Network v2/neuralNetwork.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    /** Doubles per SIMD register */
+    const std::size_t lanes = 2;
+
+    std::size_t padded(int n)
+    {
+        return (static_cast<std::size_t>(n) + lanes - 1) / lanes * lanes;
+    }
+
+    /**
+     * sum[j] = x[0] w[0][j] + ... + x[n-1] w[n-1][j] + bias w[n][j], in
+     * that order, as neuralNetwork sums its bias neuron last.
+     * @param[in] w n + 1 rows of width doubles
+     */
+    void weightedSums(const double* x, int n, double bias,
+                      const double* w, std::size_t width, double* sum)
+    {
+#ifdef __SSE2__
+        for (std::size_t j = 0; j < width; j += lanes)
+        {
+            __m128d acc = _mm_setzero_pd();
+            const double* row = w + j;
+            for (int i = 0; i < n; i++, row += width)
+            {
+                acc = _mm_add_pd(acc, _mm_mul_pd(_mm_set1_pd(x[i]), _mm_loadu_pd(row)));
+            }
+            acc = _mm_add_pd(acc, _mm_mul_pd(_mm_set1_pd(bias), _mm_loadu_pd(row)));
+            _mm_storeu_pd(sum + j, acc);
+        }
+#else
+        std::fill(sum, sum + width, 0.0);
+        for (int i = 0; i < n; i++, w += width)
+        {
+            const double xi = x[i];
+            for (std::size_t j = 0; j < width; j++)
+            {
+                sum[j] += xi * w[j];
+            }
+        }
+        for (std::size_t j = 0; j < width; j++)
+        {
+            sum[j] += bias * w[j];
+        }
+#endif
+    }
+
+    /**
+     * Reads what a neuralNetwork keeps to itself. Naming the protected
+     * members through this subclass gives pointers to members of
+     * neuralNetwork, which apply to any network, not only to ones
+     * created as this class.
+     */
+    class NetworkAccess : public neuralNetwork
+    {
+    public:
+        static int inputs(const neuralNetwork& net)
+        {
+            return net.*(&NetworkAccess::nInput);
+        }
+
+        static int hidden(const neuralNetwork& net)
+        {
+            return net.*(&NetworkAccess::nHidden);
+        }
+
+        static int outputs(const neuralNetwork& net)
+        {
+            return net.*(&NetworkAccess::nOutput);
+        }
+
+        /** In NeuroEvoMember::getWeights' order */
+        static void getWeights(const neuralNetwork& net,
+                               std::vector<double>& weights,
+                               double& inputBias, double& hiddenBias)
+        {
+            const int nI = inputs(net);
+            const int nH = hidden(net);
+            const int nO = outputs(net);
+            double** const wIH = net.*(&NetworkAccess::wInputHidden);
+            double** const wHO = net.*(&NetworkAccess::wHiddenOutput);
+            weights.clear();
+            weights.reserve((nI + 1) * nH + (nH + 1) * nO);
+            for (int i = 0; i <= nI; i++)
+            {
+                weights.insert(weights.end(), wIH[i], wIH[i] + nH);
+            }
+            for (int i = 0; i <= nH; i++)
+            {
+                weights.insert(weights.end(), wHO[i], wHO[i] + nO);
+            }
+            inputBias = (net.*(&NetworkAccess::inputNeurons))[nI];
+            hiddenBias = (net.*(&NetworkAccess::hiddenNeurons))[nH];
+        }
+
+    private:
+        // Never made, only named
+        NetworkAccess();
+    };
+
+    /** neuralNetwork's activation function */
+    void sigmoid(double* x, std::size_t n)
+    {
+        for (std::size_t j = 0; j < n; j++)
+        {
+            x[j] = 1.0 / (1.0 + std::exp(-x[j]));
+        }
+    }
+}
+
+NeuroBatch::NeuroBatch(int inputs, int hidden, int outputs, std::size_t networks) :
+m_nInput(inputs),
+m_nHidden(hidden),
+m_nOutput(outputs),
+m_networks(networks),
+m_hiddenWidth(padded(hidden)),
+m_outputWidth(padded(outputs)),
+m_stride((inputs + 1) * padded(hidden) + (hidden + 1) * padded(outputs)),
+m_weights(networks * m_stride, 0.0),
+m_inputBias(networks, -1.0),
+m_hiddenBias(networks, -1.0),
+m_inputs(networks * inputs, 0.0),
+m_hidden(m_hiddenWidth, 0.0),
+m_outputs(networks * m_outputWidth, 0.0),
+m_row(m_outputWidth, 0.0)
+{
+    if (inputs <= 0 || hidden <= 0 || outputs <= 0)
+    {
+        throw std::invalid_argument("NeuroBatch layers must not be empty");
+    }
+}
+
+void NeuroBatch::load(std::size_t i, const NeuroEvoMember& member)
+{
+    assert(i < m_networks);
+    if (member.getNumInputs() != m_nInput ||
+        member.getNumHidden() != m_nHidden ||
+        member.getNumOutputs() != m_nOutput)
+    {
+        throw std::invalid_argument("Member's network is not the batch's shape");
+    }
+
+    member.getWeights(m_loaded, m_inputBias[i], m_hiddenBias[i]);
+    spread(i);
+}
+
+void NeuroBatch::load(std::size_t i, const neuralNetwork& network)
+{
+    assert(i < m_networks);
+    if (NetworkAccess::inputs(network) != m_nInput ||
+        NetworkAccess::hidden(network) != m_nHidden ||
+        NetworkAccess::outputs(network) != m_nOutput)
+    {
+        throw std::invalid_argument("Network is not the batch's shape");
+    }
+
+    NetworkAccess::getWeights(network, m_loaded, m_inputBias[i], m_hiddenBias[i]);
+    spread(i);
+}
+
+void NeuroBatch::spread(std::size_t i)
+{
+    assert(m_loaded.size() == static_cast<std::size_t>(
+        (m_nInput + 1) * m_nHidden + (m_nHidden + 1) * m_nOutput));
+
+    // Spread the rows out to their padded widths
+    const double* from = &m_loaded[0];
+    double* to = &m_weights[i * m_stride];
+    for (int r = 0; r <= m_nInput; r++, from += m_nHidden, to += m_hiddenWidth)
+    {
+        std::copy(from, from + m_nHidden, to);
+    }
+    for (int r = 0; r <= m_nHidden; r++, from += m_nOutput, to += m_outputWidth)
+    {
+        std::copy(from, from + m_nOutput, to);
+    }
+}
+
+void NeuroBatch::setInputs(const double* inputs)
+{
+    for (std::size_t i = 0; i < m_networks; i++)
+    {
+        std::copy(inputs, inputs + m_nInput, getInputs(i));
+    }
+}
+
+void NeuroBatch::feedForward()
+{
+    const std::size_t hiddenBlock = (m_nInput + 1) * m_hiddenWidth;
+    for (std::size_t i = 0; i < m_networks; i++)
+    {
+        const double* const w = &m_weights[i * m_stride];
+        double* const out = &m_outputs[i * m_outputWidth];
+
+        weightedSums(&m_inputs[i * m_nInput], m_nInput, m_inputBias[i],
+                     w, m_hiddenWidth, &m_hidden[0]);
+        sigmoid(&m_hidden[0], m_nHidden);
+
+        weightedSums(&m_hidden[0], m_nHidden, m_hiddenBias[i],
+                     w + hiddenBlock, m_outputWidth, out);
+        sigmoid(out, m_nOutput);
+    }
+}
+
+void NeuroBatch::feedForward(std::size_t i, const double* inputs,
+                             std::size_t count, double* outputs)
+{
+    assert(i < m_networks);
+    const double* const w = &m_weights[i * m_stride];
+    const double* const wOutput = w + (m_nInput + 1) * m_hiddenWidth;
+    for (std::size_t r = 0; r < count; r++, inputs += m_nInput, outputs += m_nOutput)
+    {
+        weightedSums(inputs, m_nInput, m_inputBias[i],
+                     w, m_hiddenWidth, &m_hidden[0]);
+        sigmoid(&m_hidden[0], m_nHidden);
+
+        weightedSums(&m_hidden[0], m_nHidden, m_hiddenBias[i],
+                     wOutput, m_outputWidth, &m_row[0]);
+        sigmoid(&m_row[0], m_nOutput);
+        std::copy(m_row.begin(), m_row.begin() + m_nOutput, outputs);
+    }
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef NEUROBATCH_H_
+#define NEUROBATCH_H_
+
+/**
+ * @file NeuroBatch.h
+ * @brief Evaluates many NeuroEvolution networks of one shape at once
+ * $Id$
+ */
+
+#include <cstddef>
+#include <vector>
+
+class NeuroEvoMember;
+class neuralNetwork;
+
+/**
+ * A batch of one hidden layer perceptrons of the same shape, computing
+ * what neuralNetwork::feedForwardPattern does for each, in the same
+ * order of operations, without allocating.
+ *
+ * Every network's weights sit in one block, a row per input with the
+ * rows padded to whole SIMD registers, so the inner loops run down
+ * contiguous rows of hidden or output units. With SSE2 the rows are
+ * summed two doubles at a time, otherwise by plain loops the compiler
+ * may vectorize.
+ *
+ * A controller that runs one network on many inputs each step, such as
+ * a feedback network per cable, loads it once and passes all the inputs
+ * to feedForward(i, inputs, count, outputs) as one matrix.
+ */
+class NeuroBatch
+{
+public:
+
+    /**
+     * @param[in] inputs per network, must be positive
+     * @param[in] hidden units per network, must be positive
+     * @param[in] outputs per network, must be positive
+     * @param[in] networks in the batch
+     * @throw std::invalid_argument if a layer is empty
+     */
+    NeuroBatch(int inputs, int hidden, int outputs, std::size_t networks);
+
+    /**
+     * Copy a member's weights into the batch. Later changes to the
+     * member need loading again.
+     * @param[in] i the network to overwrite, less than size()
+     * @param[in] member a member with a network of this batch's shape
+     * @throw std::invalid_argument if the shapes differ
+     */
+    void load(std::size_t i, const NeuroEvoMember& member);
+
+    /**
+     * Copy a network's weights into the batch, such as one a controller
+     * read with neuralNetwork::loadWeights.
+     * @param[in] i the network to overwrite, less than size()
+     * @param[in] network a network of this batch's shape
+     * @throw std::invalid_argument if the shapes differ
+     */
+    void load(std::size_t i, const neuralNetwork& network);
+
+    /** Where to write network i's inputs before feedForward */
+    double* getInputs(std::size_t i)
+    {
+        return &m_inputs[i * m_nInput];
+    }
+
+    /** Give every network the same inputs */
+    void setInputs(const double* inputs);
+
+    /** Evaluate every network on its inputs */
+    void feedForward();
+
+    /**
+     * Evaluate network i on many inputs at once, independently of the
+     * inputs and outputs held for feedForward().
+     * @param[in] i the network, less than size()
+     * @param[in] inputs count rows of getNumInputs() values
+     * @param[in] count the number of rows
+     * @param[out] outputs count rows of getNumOutputs() values
+     */
+    void feedForward(std::size_t i, const double* inputs, std::size_t count,
+                     double* outputs);
+
+    /** Network i's outputs from the last feedForward */
+    const double* getOutputs(std::size_t i) const
+    {
+        return &m_outputs[i * m_outputWidth];
+    }
+
+    std::size_t size() const
+    {
+        return m_networks;
+    }
+
+    int getNumInputs() const
+    {
+        return m_nInput;
+    }
+
+    int getNumHidden() const
+    {
+        return m_nHidden;
+    }
+
+    int getNumOutputs() const
+    {
+        return m_nOutput;
+    }
+
+private:
+
+    /** Spread m_loaded out into network i's padded rows */
+    void spread(std::size_t i);
+
+    const int m_nInput;
+    const int m_nHidden;
+    const int m_nOutput;
+    const std::size_t m_networks;
+
+    /** Row lengths, padded to a whole number of SIMD registers */
+    const std::size_t m_hiddenWidth;
+    const std::size_t m_outputWidth;
+
+    /** Doubles of one network's weights */
+    const std::size_t m_stride;
+
+    /**
+     * Per network: (m_nInput + 1) rows of m_hiddenWidth, then
+     * (m_nHidden + 1) rows of m_outputWidth. The padding is zero.
+     */
+    std::vector<double> m_weights;
+
+    /** The bias neurons' constant values, per network */
+    std::vector<double> m_inputBias;
+    std::vector<double> m_hiddenBias;
+
+    /** m_nInput per network */
+    std::vector<double> m_inputs;
+
+    /** One network's hidden layer at a time */
+    std::vector<double> m_hidden;
+
+    /** m_outputWidth per network */
+    std::vector<double> m_outputs;
+
+    /** One row of outputs at a time, for feedForward(i, ...) */
+    std::vector<double> m_row;
+
+    /** Reused by load */
+    std::vector<double> m_loaded;
+};
+
+#endif  // NEUROBATCH_H_
@@ -26,27 +26,65 @@
 
 #include "NeuroEvoMember.h"
 #include "neuralNet/Neural Network v2/neuralNetwork.h"
+#include "learning/Checkpoint/EvolutionCheckpoint.h"
+#include "core/tgCounterRandom.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <assert.h>
 #include <stdexcept>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
 
 using namespace std;
 
-NeuroEvoMember::NeuroEvoMember(configuration config)
+namespace
+{
+	/// Reads the weights the network keeps to itself
+	class WeightedNetwork : public neuralNetwork
+	{
+	public:
+		WeightedNetwork(int nI, int nH, int nO) :
+		neuralNetwork(nI, nH, nO)
+		{
+		}
+
+		void getWeights(std::vector<double>& weights, double& inputBias,
+		                double& hiddenBias) const
+		{
+			weights.clear();
+			weights.reserve((nInput + 1) * nHidden + (nHidden + 1) * nOutput);
+			for (int i = 0; i <= nInput; i++)
+			{
+				weights.insert(weights.end(), wInputHidden[i], wInputHidden[i] + nHidden);
+			}
+			for (int i = 0; i <= nHidden; i++)
+			{
+				weights.insert(weights.end(), wHiddenOutput[i], wHiddenOutput[i] + nOutput);
+			}
+			inputBias = inputNeurons[nInput];
+			hiddenBias = hiddenNeurons[nHidden];
+		}
+	};
+}
+
+NeuroEvoMember::NeuroEvoMember(const configuration& config, std::tr1::ranlux64_base_01 *eng)
 {
 	this->numInputs=config.getintvalue("numberOfStates");
     this->numOutputs=config.getintvalue("numberOfActions");
-	int numHidden = config.getintvalue("numberHidden");
+	this->numHidden=config.getintvalue("numberHidden");
     assert(numOutputs > 0);
 	cout<<"creating NN"<<endl;
 	if(numInputs>0)
-		nn = new neuralNetwork(numInputs, numHidden,numOutputs);
+		nn = new WeightedNetwork(numInputs, numHidden,numOutputs);
 	else
 	{
+		std::tr1::uniform_real<double> unif(0, 1);
 		statelessParameters.resize(numOutputs);
 		for(int i=0;i<numOutputs;i++)
-			statelessParameters[i]=rand()*1.0/RAND_MAX;
+			statelessParameters[i]=unif(*eng);
 	}
 	maxScore=-1000;
 }
@@ -68,25 +106,26 @@ void NeuroEvoMember::mutate(std::tr1::ranlux64_base_01 *eng){
 		this->nn->mutate(eng);
 	else
 	{
+		const std::size_t n = statelessParameters.size();
+		if (n == 0)
+		{
+			return;
+		}
 		double dev = 3.0 / 100.0;   // 10 percent of interval 0-1
-		std::tr1::normal_distribution<double> normal(0, dev);
-		for(std::size_t i=0;i<statelessParameters.size();i++)
+		// One draw from the stream keys every parameter's draws: a coin
+		// for whether to mutate it, then the amount
+		const tgCounterRandom draws = tgCounterRandom::fromStream(*eng);
+		std::vector<double> coin(n);
+		std::vector<double> mutAmount(n);
+		draws.fillUniform(&coin[0], n);
+		draws.fillNormal(&mutAmount[0], n, dev, n);
+		double* const params = &statelessParameters[0];
+		for(std::size_t i=0;i<n;i++)
 		{
-			if(unif(*eng)  > 0.5)
-			{
-				continue;
-			}
-			double mutAmount = normal(*eng);
-//			cout<<"param: "<<i<<" dev: "<<dev<<" rand: "<<mutAmount<<endl;
-			double newParam= statelessParameters[i] + mutAmount;
-			if(newParam < 0.0)
-				statelessParameters[i] = 0.0;
-			else if(newParam > 1.0)
-				statelessParameters[i] = 1.0;
-			else
-				statelessParameters[i] =newParam;
+			const double newParam =
+				std::min(1.0, std::max(0.0, params[i] + mutAmount[i]));
+			params[i] = (coin[i] > 0.5) ? params[i] : newParam;
 		}
-
 	}
 }
 
@@ -114,17 +153,17 @@ void NeuroEvoMember::copyFrom(NeuroEvoMember *otherMember1, NeuroEvoMember *othe
     }
     else
     {
-        std::tr1::uniform_real<double> unif(0, 1);
+        const tgCounterRandom draws = tgCounterRandom::fromStream(*eng);
+        std::vector<double> coin(numOutputs);
+        if (numOutputs > 0)
+        {
+            draws.fillUniform(&coin[0], numOutputs);
+        }
         for (int i = 0; i < numOutputs; i++)
         {
-            if (unif(*eng) > 0.5)
-            {
-                this->statelessParameters[i] = otherMember1->statelessParameters[i];
-            }
-            else
-            {
-                this->statelessParameters[i] = otherMember2->statelessParameters[i];
-            }
+            this->statelessParameters[i] = (coin[i] > 0.5) ?
+                otherMember1->statelessParameters[i] :
+                otherMember2->statelessParameters[i];
         }
     }    
 }
@@ -188,3 +227,67 @@ void NeuroEvoMember::loadFromFile(const char * outputFilename)
 	}
 
 }
+
+void NeuroEvoMember::getWeights(std::vector<double>& weights, double& inputBias,
+                                double& hiddenBias) const
+{
+	assert(numInputs > 0);
+	// Every network was created as one
+	static_cast<const WeightedNetwork*>(nn)->getWeights(weights, inputBias, hiddenBias);
+}
+
+namespace
+{
+	/// The network only saves to files, so go through a temporary one
+	std::string temporaryWeightsFile()
+	{
+		char name[] = "/tmp/ntrtWeightsXXXXXX";
+		const int fd = mkstemp(name);
+		if (fd < 0)
+		{
+			throw std::runtime_error("Could not create a temporary file");
+		}
+		close(fd);
+		return name;
+	}
+}
+
+void NeuroEvoMember::writeCheckpoint(EvolutionCheckpoint& checkpoint)
+{
+	checkpoint.writeVector(statelessParameters);
+	if(numInputs > 0)
+	{
+		const std::string name = temporaryWeightsFile();
+		this->getNn()->saveWeights(name.c_str());
+		ifstream in(name.c_str());
+		stringstream weights;
+		weights << in.rdbuf();
+		in.close();
+		std::remove(name.c_str());
+		checkpoint.writeString(weights.str());
+	}
+	checkpoint.writeVector(pastScores);
+	checkpoint.writeDouble(maxScore);
+	checkpoint.writeDouble(maxScore1);
+	checkpoint.writeDouble(maxScore2);
+	checkpoint.writeDouble(averageScore);
+}
+
+void NeuroEvoMember::readCheckpoint(EvolutionCheckpoint& checkpoint)
+{
+	statelessParameters = checkpoint.readVector();
+	if(numInputs > 0)
+	{
+		const std::string name = temporaryWeightsFile();
+		ofstream out(name.c_str());
+		out << checkpoint.readString();
+		out.close();
+		this->getNn()->loadWeights(name.c_str());
+		std::remove(name.c_str());
+	}
+	pastScores = checkpoint.readVector();
+	maxScore = checkpoint.readDouble();
+	maxScore1 = checkpoint.readDouble();
+	maxScore2 = checkpoint.readDouble();
+	averageScore = checkpoint.readDouble();
+}
@@ -34,11 +34,12 @@
 
 // Forward Declarations
 class neuralNetwork;
+class EvolutionCheckpoint;
 
 class NeuroEvoMember
 {
 public:
-	NeuroEvoMember(configuration config);
+	NeuroEvoMember(const configuration& config, std::tr1::ranlux64_base_01 *eng);
 	~NeuroEvoMember();
 	void mutate(std::tr1::ranlux64_base_01 *eng);
 
@@ -50,6 +51,31 @@ public:
     void copyFrom(NeuroEvoMember *otherMember1, NeuroEvoMember *otherMember2, std::tr1::ranlux64_base_01 *eng);
 	void saveToFile(const char* outputFilename);
 	void loadFromFile(const char* inputFilename);
+	/// Parameters or weights and scores, for NeuroEvolution::saveCheckpoint
+	void writeCheckpoint(EvolutionCheckpoint& checkpoint);
+	void readCheckpoint(EvolutionCheckpoint& checkpoint);
+	/**
+	 * Copy out the network's weights for NeuroBatch: the input to
+	 * hidden weights, one row per input with the bias input's row last,
+	 * then the hidden to output weights laid out likewise.
+	 * @param[out] weights resized to fit
+	 * @param[out] inputBias the constant value of the bias input
+	 * @param[out] hiddenBias the constant value of the bias hidden neuron
+	 */
+	void getWeights(std::vector<double>& weights, double& inputBias,
+	                double& hiddenBias) const;
+	int getNumInputs() const
+	{
+		return numInputs;
+	}
+	int getNumHidden() const
+	{
+		return numHidden;
+	}
+	int getNumOutputs() const
+	{
+		return numOutputs;
+	}
 
 	std::vector<double> statelessParameters;
 	//scores for evaluation
@@ -63,6 +89,7 @@ private:
 	neuralNetwork *nn;
 
 	int numInputs;
+	int numHidden;
 	int numOutputs;
 };
 
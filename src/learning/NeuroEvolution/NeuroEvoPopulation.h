@@ -33,7 +33,7 @@
 
 class NeuroEvoPopulation {
 public:
-	NeuroEvoPopulation(int numControllers, configuration& config);
+	NeuroEvoPopulation(int numControllers, const configuration& config, std::tr1::ranlux64_base_01 *eng);
 	~NeuroEvoPopulation();
 	std::vector<NeuroEvoMember *> controllers;
     void mutate(std::tr1::ranlux64_base_01 *eng,std::size_t numToMutate);
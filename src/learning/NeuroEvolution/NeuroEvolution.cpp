@@ -29,6 +29,7 @@
 #include "core/tgString.h"
 #include "helpers/FileHelpers.h"
 // The C++ Standard Library
+#include <algorithm>
 #include <iostream>
 #include <numeric>
 #include <string>
@@ -37,26 +38,35 @@
 
 using namespace std;
 
-#ifdef _WIN32
-
-//  Windows
-#define rdtsc  __rdtsc
-
-#else
-
-//  For everything else
-unsigned long long rdtsc(){
-    unsigned int lo,hi;
-    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
-    return ((unsigned long long)hi << 32) | lo;
+namespace
+{
+	/** What the evolution, its members and NeuroAdapter read */
+	const configuration::Field neuroFields[] =
+	{
+		{ "populationSize", configuration::intType },
+		{ "numberOfElementsToMutate", configuration::intType },
+		{ "numberOfChildren", configuration::intType },
+		{ "numberOfTestsBetweenGenerations", configuration::intType },
+		{ "numberOfSubtests", configuration::intType },
+		{ "numberOfControllers", configuration::intType },
+		{ "leniencyCoef", configuration::doubleType },
+		{ "coevolution", configuration::intType },
+		{ "startSeed", configuration::intType },
+		{ "learning", configuration::intType },
+		{ "numberOfStates", configuration::intType },
+		{ "numberOfActions", configuration::intType },
+		{ "numberHidden", configuration::intType },
+		{ "compareAverageScores", configuration::intType },
+		{ "clearScoresBetweenGenerations", configuration::intType }
+	};
 }
 
-#endif
-
 NeuroEvolution::NeuroEvolution(std::string suff, std::string config, std::string path) :
-suffix(suff)
+suffix(suff),
+rng(0)
 {
 	currentTest=0;
+	subTests=0;
 	generationNumber=0;
 	if (path != "")
 	{
@@ -71,6 +81,7 @@ suffix(suff)
 
     configuration myconfigdataaa;
 	myconfigdataaa.readFile(configPath);
+	myconfigdataaa.validate(neuroFields, sizeof(neuroFields) / sizeof(neuroFields[0]));
 	populationSize=myconfigdataaa.getintvalue("populationSize");
     numberOfElementsToMutate=myconfigdataaa.getintvalue("numberOfElementsToMutate");
 	numberOfChildren=myconfigdataaa.getintvalue("numberOfChildren");
@@ -88,13 +99,25 @@ suffix(suff)
         throw std::invalid_argument("Population will grow with given parameters");
     }
     
-   srand(rdtsc());
-	eng.seed(rdtsc());
+	if (myconfigdataaa.iskey("randomSeed"))
+	{
+		rng.seed(myconfigdataaa.getintvalue("randomSeed"));
+	}
+	else
+	{
+		rng.seed(tgRandom::entropySeed());
+	}
+	cout<<"Random seed: "<<rng.getSeed()<<endl;
+
+	pruner = new TrialPruner(myconfigdataaa);
+	scoreLog = new ScoreLog(resourcePath + "logs/scores", myconfigdataaa);
+	logFidelity = myconfigdataaa.iskey("fidelityLevels") &&
+		myconfigdataaa.getintvalue("fidelityLevels") > 1;
 
 	for(int j=0;j<numberOfControllers;j++)
 	{
 		cout<<"creating Populations"<<endl;
-		populations.push_back(new NeuroEvoPopulation(populationSize,myconfigdataaa));
+		populations.push_back(new NeuroEvoPopulation(populationSize,myconfigdataaa,&rng.engine()));
 	}
 
     // Overwrite the random parameters based on data
@@ -108,9 +131,26 @@ suffix(suff)
             seededPop->loadFromFile(ss.str().c_str());
         }
     }
+
+	checkpointInterval = 0;
+	if (myconfigdataaa.iskey("checkpointInterval"))
+	{
+		checkpointInterval = myconfigdataaa.getintvalue("checkpointInterval");
+	}
+	checkpointPath = resourcePath + "logs/checkpoint-" + suffix + ".bin";
+	bool resumed = false;
+	if(learning && checkpointInterval > 0)
+	{
+		resumed = loadCheckpoint(checkpointPath);
+		if (resumed)
+		{
+			cout<<"Resumed from "<<checkpointPath<<" at generation "<<generationNumber<<endl;
+		}
+	}
+
     if(learning)
     {
-		evolutionLog.open((resourcePath + "logs/evolution"+suffix+".csv").c_str(),ios::out);
+		evolutionLog.open((resourcePath + "logs/evolution"+suffix+".csv").c_str(),resumed ? ios::app : ios::out);
 		if (!evolutionLog.is_open())
 		{
 			throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
@@ -120,6 +160,8 @@ suffix(suff)
 
 NeuroEvolution::~NeuroEvolution()
 {
+	delete pruner;
+	delete scoreLog;
 	// @todo - solve the invalid pointer that occurs here
 	#if (0)
 	for(std::size_t i = 0; i < populations.size(); i++)
@@ -134,7 +176,7 @@ void NeuroEvolution::mutateEveryController()
 {
 	for(std::size_t i=0;i<populations.size();i++)
 	{
-		populations.at(i)->mutate(&eng,numberOfElementsToMutate);
+		populations.at(i)->mutate(&rng.engine(),numberOfElementsToMutate);
 	}
 }
 
@@ -142,7 +184,7 @@ void NeuroEvolution::combineAndMutate()
 {
     for(std::size_t i=0;i<populations.size();i++)
     {
-        populations.at(i)->combineAndMutate(&eng, numberOfElementsToMutate, numberOfChildren);
+        populations.at(i)->combineAndMutate(&rng.engine(), numberOfElementsToMutate, numberOfChildren);
     }    
 }
 
@@ -164,18 +206,24 @@ void NeuroEvolution::orderAllPopulations()
 	aveScore2 /= scoresOfTheGeneration.size();
 
 
+	// Trials that cannot beat the worst member we keep can stop early
+	const int worstKept = populationSize - numberOfElementsToMutate - numberOfChildren - 1;
+	double threshold = 0.0;
 	for(std::size_t i=0;i<populations.size();i++)
 	{
 		populations.at(i)->orderPopulation();
+		const double score = populations[i]->getMember(std::max(worstKept, 0))->maxScore;
+		threshold = (i == 0) ? score : std::min(threshold, score);
 	}
+	pruner->setThreshold(threshold);
 	/// @todo numberOfTestsBetweenGenerations may not be accurate
 	evolutionLog<<generationNumber*numberOfTestsBetweenGenerations<<","<<aveScore1<<","<<aveScore2<<",";
 	evolutionLog<<populations.at(0)->getMember(0)->maxScore<<","<<populations.at(0)->getMember(0)->maxScore1<<","<<populations.at(0)->getMember(0)->maxScore2<<endl;
+	scoreLog->flush();
 	
 	
 	// what if member at 0 isn't the best of all time for some reason? 
 	// This seems biased towards average scores
-	ofstream logfileLeader;
 	for(std::size_t i=0;i<populations.size();i++)
 	{
 		stringstream ss;
@@ -217,6 +265,11 @@ vector <NeuroEvoMember *> NeuroEvolution::nextSetOfControllers()
 			currentTest=0;//Start from 0
 		else
 			currentTest=populationSize - numberOfElementsToMutate - numberOfChildren; //start from the mutated ones only (last x)
+
+		if(checkpointInterval > 0 && generationNumber % checkpointInterval == 0)
+		{
+			saveCheckpoint(checkpointPath);
+		}
 	}
 
 	selectedControllers.clear();
@@ -224,7 +277,7 @@ vector <NeuroEvoMember *> NeuroEvolution::nextSetOfControllers()
 	{
 		int selectedOne=0;
 		if(coevolution)
-			selectedOne=rand()%populationSize; //select random one from each pool
+			selectedOne=rng.index(populationSize); //select random one from each pool
 		else
 			selectedOne=currentTest; //select the same from each pool
 
@@ -244,15 +297,27 @@ vector <NeuroEvoMember *> NeuroEvolution::nextSetOfControllers()
 }
 
 void NeuroEvolution::updateScores(vector <double> multiscore)
+{
+	updateScores(selectedControllers, multiscore);
+}
+
+void NeuroEvolution::updateScores(const vector <NeuroEvoMember *>& controllers,
+                                  vector <double> multiscore)
+{
+	updateScores(controllers, multiscore, 0);
+}
+
+void NeuroEvolution::updateScores(const vector <NeuroEvoMember *>& controllers,
+                                  vector <double> multiscore, int fidelity)
 {
 	if(multiscore.size()==2)
 		this->scoresOfTheGeneration.push_back(multiscore);
 	else
 		multiscore.push_back(-1.0);
 	double score=1.0* multiscore[0] - 0.0 * multiscore[1];
-	for(std::size_t oneElem=0;oneElem<selectedControllers.size();oneElem++)
+	for(std::size_t oneElem=0;oneElem<controllers.size();oneElem++)
 	{
-		NeuroEvoMember * controllerPointer=selectedControllers.at(oneElem);
+		NeuroEvoMember * controllerPointer=controllers.at(oneElem);
 
 		controllerPointer->pastScores.push_back(score);
 		double prevScore=controllerPointer->maxScore;
@@ -269,10 +334,73 @@ void NeuroEvolution::updateScores(vector <double> multiscore)
 		}
 	}
 
-	//Record it to the file
-	ofstream payloadLog;
-	payloadLog.open((resourcePath + "logs/scores.csv").c_str(),ios::app);
-	payloadLog<<multiscore[0]<<","<<multiscore[1]<<endl;
-	payloadLog.close();
+	//Record it to the log
+	vector<double> row(multiscore.begin(), multiscore.begin() + std::min<std::size_t>(2, multiscore.size()));
+	if(logFidelity)
+		row.push_back(fidelity);
+	scoreLog->append(row);
 	return;
 }
+
+void NeuroEvolution::saveCheckpoint(const std::string& filename)
+{
+	EvolutionCheckpoint checkpoint;
+	checkpoint.writeString("NeuroEvolution");
+	checkpoint.writeInt(populations.size());
+	checkpoint.writeInt(populationSize);
+	checkpoint.writeInt(generationNumber);
+	checkpoint.writeInt(currentTest);
+	checkpoint.writeInt(subTests);
+	checkpoint.writeString(rng.getState());
+	checkpoint.writeInt(scoresOfTheGeneration.size());
+	for(std::size_t i=0;i<scoresOfTheGeneration.size();i++)
+	{
+		checkpoint.writeVector(scoresOfTheGeneration[i]);
+	}
+	for(std::size_t i=0;i<populations.size();i++)
+	{
+		for(std::size_t j=0;j<populations[i]->controllers.size();j++)
+		{
+			populations[i]->controllers[j]->writeCheckpoint(checkpoint);
+		}
+	}
+	checkpoint.save(filename);
+}
+
+bool NeuroEvolution::loadCheckpoint(const std::string& filename)
+{
+	EvolutionCheckpoint checkpoint;
+	if (!checkpoint.load(filename))
+	{
+		return false;
+	}
+	if (checkpoint.readString() != "NeuroEvolution" ||
+		checkpoint.readInt() != static_cast<int>(populations.size()) ||
+		checkpoint.readInt() != populationSize)
+	{
+		throw std::runtime_error(filename + " does not match this configuration");
+	}
+	generationNumber = checkpoint.readInt();
+	currentTest = checkpoint.readInt();
+	subTests = checkpoint.readInt();
+	rng.setState(checkpoint.readString());
+	scoresOfTheGeneration.resize(checkpoint.readInt());
+	for(std::size_t i=0;i<scoresOfTheGeneration.size();i++)
+	{
+		scoresOfTheGeneration[i] = checkpoint.readVector();
+	}
+	for(std::size_t i=0;i<populations.size();i++)
+	{
+		for(std::size_t j=0;j<populations[i]->controllers.size();j++)
+		{
+			populations[i]->controllers[j]->readCheckpoint(checkpoint);
+		}
+	}
+	return true;
+}
+
+int NeuroEvolution::episodesLeftInGeneration() const
+{
+	const int testsToDo = coevolution ? numberOfTestsBetweenGenerations : populationSize;
+	return (testsToDo - currentTest) * numberOfSubtests - subTests;
+}
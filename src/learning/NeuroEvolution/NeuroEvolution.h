@@ -30,6 +30,10 @@
 
 #include "NeuroEvoPopulation.h"
 #include "NeuroEvoMember.h"
+#include "learning/Pruning/TrialPruner.h"
+#include "learning/Checkpoint/EvolutionCheckpoint.h"
+#include "learning/ScoreLog/ScoreLog.h"
+#include "core/tgRandom.h"
 #include <fstream>
 
 class NeuroEvolution
@@ -43,13 +47,79 @@ public:
 	void evaluatePopulation();
 	std::vector< NeuroEvoMember *> nextSetOfControllers();
 	void updateScores(std::vector<double> scores);
+	
+	/**
+	 * Score a set of controllers other than the last one returned by
+	 * nextSetOfControllers, so several sets can be evaluated at once.
+	 * @param[in] controllers a set returned by nextSetOfControllers
+	 * during this generation
+	 * @param[in] scores as for updateScores(scores)
+	 */
+	void updateScores(const std::vector< NeuroEvoMember *>& controllers,
+	                  std::vector<double> scores);
+	
+	/**
+	 * Score a set of controllers from a trial of a given fidelity, as
+	 * for updateScores(controllers, scores). Fidelity 0 is the full
+	 * simulation; higher levels are cheaper approximations, such as a
+	 * coarser timestep or a shorter trial, used to screen members.
+	 * With the fidelityLevels key above 1, the score log has the
+	 * fidelity as a third column.
+	 */
+	void updateScores(const std::vector< NeuroEvoMember *>& controllers,
+	                  std::vector<double> scores, int fidelity);
+	
+	/**
+	 * How many more times nextSetOfControllers can be called before
+	 * it starts the next generation. All of these sets must be scored
+	 * before then.
+	 */
+	int episodesLeftInGeneration() const;
+
+	/**
+	 * Write the members, their scores, the random stream and the
+	 * counters to a checkpoint. Done every checkpointInterval
+	 * generations when that key is in the config file.
+	 * @throw std::runtime_error if the file cannot be written
+	 */
+	void saveCheckpoint(const std::string& filename);
+
+	/**
+	 * Continue from a checkpoint. The constructor does this itself when
+	 * checkpointInterval is set and its checkpoint exists.
+	 * @return false if there is no such file
+	 * @throw std::runtime_error if it is not a checkpoint of this
+	 * configuration
+	 */
+	bool loadCheckpoint(const std::string& filename);
+	
+	/**
+	 * Decides whether a trial should stop early, from the scores its
+	 * controller reports part way through. Configured by the optional
+	 * pruning keys of the config file, see TrialPruner. The threshold
+	 * is the final score of the worst member kept by the last
+	 * generation.
+	 */
+	TrialPruner& getPruner()
+	{
+		return *pruner;
+	}
     const std::string suffix;
     /// @todo make this const if we decide to force everyone to put their logs in resources
     std::string resourcePath;
 private:
+	TrialPruner* pruner;
+	/// 0 for none
+	int checkpointInterval;
+	std::string checkpointPath;
+	/// logs/scores, one row per scored set
+	ScoreLog* scoreLog;
+	/// Whether score rows have a fidelity column
+	bool logFidelity;
 	int populationSize;
 	int numberOfControllers;
-	std::tr1::ranlux64_base_01 eng;
+	/// Seeded from randomSeed in the config, if it is there
+	tgRandom rng;
 	std::vector< NeuroEvoPopulation *> populations;
 	std::vector <NeuroEvoMember *>  selectedControllers;
 	std::vector< std::vector< double > > scoresOfTheGeneration;
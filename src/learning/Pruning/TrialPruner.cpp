@@ -0,0 +1,171 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file TrialPruner.cpp
+ * @brief Contains the definitions of members of class TrialPruner
+ * $Id$
+ */
+
+#include "TrialPruner.h"
+#include "learning/Configuration/configuration.h"
+#include "core/tgMetrics.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+TrialPruner::TrialPruner(Policy policy, double minProgress, int reduction,
+                         int minSamples) :
+m_policy(policy),
+m_minProgress(minProgress),
+m_reduction(reduction),
+m_minSamples(minSamples)
+{
+    init();
+}
+
+TrialPruner::TrialPruner(configuration& config) :
+m_policy(eNone),
+m_minProgress(0.2),
+m_reduction(3),
+m_minSamples(5)
+{
+    if (config.iskey("pruningPolicy"))
+    {
+        const int policy = config.getintvalue("pruningPolicy");
+        if (policy < eNone || policy > eSuccessiveHalving)
+        {
+            throw std::invalid_argument("pruningPolicy must be from 0 to 3");
+        }
+        m_policy = static_cast<Policy>(policy);
+    }
+    if (config.iskey("pruningMinProgress"))
+    {
+        m_minProgress = config.getDoubleValue("pruningMinProgress");
+    }
+    if (config.iskey("pruningReduction"))
+    {
+        m_reduction = config.getintvalue("pruningReduction");
+    }
+    if (config.iskey("pruningMinSamples"))
+    {
+        m_minSamples = config.getintvalue("pruningMinSamples");
+    }
+    init();
+}
+
+void TrialPruner::init()
+{
+    if (m_minProgress <= 0.0 || m_minProgress >= 1.0)
+    {
+        throw std::invalid_argument("minProgress must be between 0 and 1");
+    }
+    if (m_reduction < 2)
+    {
+        throw std::invalid_argument("reduction must be at least 2");
+    }
+    if (m_minSamples < 1)
+    {
+        throw std::invalid_argument("minSamples must be positive");
+    }
+
+    m_hasThreshold = false;
+    m_threshold = 0.0;
+    for (double p = m_minProgress; p < 1.0; p *= m_reduction)
+    {
+        m_rungProgress.push_back(p);
+    }
+    m_rungScores.resize(m_rungProgress.size());
+
+    pthread_mutex_init(&m_mutex, NULL);
+}
+
+TrialPruner::~TrialPruner()
+{
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void TrialPruner::setThreshold(double finalScore)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_threshold = finalScore;
+    m_hasThreshold = true;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool TrialPruner::report(Trial& trial, double progress, double score)
+{
+    if (m_policy == eNone || trial.stopped)
+    {
+        return trial.stopped;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    while (!trial.stopped && trial.nextRung < m_rungProgress.size() &&
+           progress >= m_rungProgress[trial.nextRung])
+    {
+        trial.stopped = decide(trial.nextRung, progress, score);
+        trial.nextRung++;
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    if (trial.stopped)
+    {
+        tgMetrics::add(tgMetrics::ePrunedTrials, 1.0);
+    }
+
+    return trial.stopped;
+}
+
+bool TrialPruner::decide(std::size_t rung, double progress, double score)
+{
+    std::vector<double>& scores = m_rungScores[rung];
+    bool stop = false;
+
+    switch (m_policy)
+    {
+    case eThreshold:
+        stop = m_hasThreshold && score / progress < m_threshold;
+        break;
+    case eMedian:
+        if (scores.size() >= (std::size_t) m_minSamples)
+        {
+            std::vector<double> sorted(scores);
+            const std::size_t mid = sorted.size() / 2;
+            std::nth_element(sorted.begin(), sorted.begin() + mid, sorted.end());
+            stop = score < sorted[mid];
+        }
+        break;
+    case eSuccessiveHalving:
+        if (scores.size() >= (std::size_t) m_minSamples)
+        {
+            // Keep the best 1 / reduction, counting this trial
+            const std::size_t rank = 1 +
+              std::count_if(scores.begin(), scores.end(),
+                            std::bind2nd(std::greater<double>(), score));
+            stop = rank * m_reduction > scores.size() + 1;
+        }
+        break;
+    default:
+        break;
+    }
+
+    scores.push_back(score);
+    return stop;
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TRIAL_PRUNER_H_
+#define TRIAL_PRUNER_H_
+
+/**
+ * @file TrialPruner.h
+ * @brief Contains the definition of class TrialPruner, which stops
+ * learning trials early once they are clearly worse than the rest.
+ * $Id$
+ */
+
+#include <vector>
+// POSIX threads
+#include <pthread.h>
+
+class configuration;
+
+/**
+ * Decides whether a running trial should be stopped, from the scores
+ * its controller reports part way through. Scores are checked at rungs
+ * at minProgress, minProgress * reduction, minProgress * reduction^2
+ * and so on, up to but not including the end of the trial. The rungs
+ * keep the scores of every trial that reached them, across
+ * generations.
+ *
+ * The policies are
+ * - eThreshold: stop if the score, extrapolated linearly to the end of
+ *   the trial, is below the threshold, normally set by the evolution to
+ *   the final score of the worst member it keeps.
+ * - eMedian: stop if the score is below the median of the scores
+ *   earlier trials had at the same rung.
+ * - eSuccessiveHalving: stop unless the score is in the best
+ *   1 / reduction of the scores at the same rung (asynchronous
+ *   successive halving).
+ *
+ * A stopped trial is left to the caller to end, typically by throwing
+ * std::runtime_error from the controller, which the learning apps
+ * already treat as the end of the episode. Safe to call from the
+ * worker threads of tgParallelSimulation.
+ */
+class TrialPruner
+{
+public:
+
+    enum Policy
+    {
+        eNone,
+        eThreshold,
+        eMedian,
+        eSuccessiveHalving
+    };
+
+    /** The state of one running trial */
+    class Trial
+    {
+    public:
+        Trial() : nextRung(0), stopped(false) { }
+    private:
+        friend class TrialPruner;
+        std::size_t nextRung;
+        bool stopped;
+    };
+
+    /**
+     * @param[in] policy how to decide
+     * @param[in] minProgress the fraction of the trial at the first
+     * rung; must be in (0, 1)
+     * @param[in] reduction the ratio between rungs, and for
+     * eSuccessiveHalving the inverse of the fraction kept; must be at
+     * least 2
+     * @param[in] minSamples the number of earlier scores a rung needs
+     * before eMedian or eSuccessiveHalving stops anything
+     */
+    TrialPruner(Policy policy = eNone, double minProgress = 0.2,
+                int reduction = 3, int minSamples = 5);
+
+    /**
+     * Read the optional keys pruningPolicy (0 to 3, as Policy),
+     * pruningMinProgress, pruningReduction and pruningMinSamples.
+     * Without pruningPolicy nothing is pruned.
+     */
+    TrialPruner(configuration& config);
+
+    ~TrialPruner();
+
+    /** Set the bar for eThreshold. Until set, eThreshold stops nothing. */
+    void setThreshold(double finalScore);
+
+    /**
+     * Report a trial's score so far.
+     * @param[in,out] trial a Trial default constructed at the start of
+     * the trial
+     * @param[in] progress the fraction of the trial that has run
+     * @param[in] score the score the trial would get if it ended now;
+     * higher is better
+     * @return true if the trial should be stopped; it stays true for
+     * later reports
+     */
+    bool report(Trial& trial, double progress, double score);
+
+    Policy getPolicy() const
+    {
+        return m_policy;
+    }
+
+private:
+
+    void init();
+
+    /** Decide at rung, recording score there. Called with m_mutex held. */
+    bool decide(std::size_t rung, double progress, double score);
+
+    /** Not copyable */
+    TrialPruner(const TrialPruner&);
+    TrialPruner& operator=(const TrialPruner&);
+
+private:
+
+    Policy m_policy;
+    double m_minProgress;
+    int m_reduction;
+    int m_minSamples;
+
+    bool m_hasThreshold;
+    double m_threshold;
+
+    /** The progress at each rung */
+    std::vector<double> m_rungProgress;
+
+    /** The scores recorded at each rung */
+    std::vector< std::vector<double> > m_rungScores;
+
+    pthread_mutex_t m_mutex;
+};
+
+#endif  // TRIAL_PRUNER_H_
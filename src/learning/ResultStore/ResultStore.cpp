@@ -0,0 +1,423 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file ResultStore.cpp
+ * @brief Contains the definitions of members of class ResultStore
+ * $Id$
+ */
+
+#include "ResultStore.h"
+#include "learning/Configuration/configuration.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <sys/time.h>
+// POSIX files
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char storeMagic[] = "NTRTRES1";
+    const char indexMagic[] = "NTRTRIX1";
+
+    const std::size_t magicSize = sizeof(storeMagic) - 1;
+
+    /** Score count, fidelity, trial, hash and time */
+    const std::size_t headerSize = 4 + 4 + 8 + 8 + 8;
+
+    const uint64_t fnvOffset = 14695981039346656037ULL;
+    const uint64_t fnvPrime = 1099511628211ULL;
+
+    uint64_t hashBytes(uint64_t h, const void* data, std::size_t n)
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            h ^= p[i];
+            h *= fnvPrime;
+        }
+        return h;
+    }
+
+    /** Read exactly n bytes at an offset; false if the file is shorter */
+    bool readAt(int fd, void* data, std::size_t n, uint64_t offset)
+    {
+        char* p = static_cast<char*>(data);
+        while (n > 0)
+        {
+            const ssize_t got = pread(fd, p, n, offset);
+            if (got < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (got <= 0)
+            {
+                return false;
+            }
+            p += got;
+            n -= got;
+            offset += got;
+        }
+        return true;
+    }
+
+    bool writeAll(int fd, const char* data, std::size_t n)
+    {
+        while (n > 0)
+        {
+            const ssize_t put = ::write(fd, data, n);
+            if (put < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (put <= 0)
+            {
+                return false;
+            }
+            data += put;
+            n -= put;
+        }
+        return true;
+    }
+
+    double now()
+    {
+        timeval tv;
+        gettimeofday(&tv, NULL);
+        return tv.tv_sec + tv.tv_usec * 1e-6;
+    }
+
+    class Lock
+    {
+    public:
+        Lock(pthread_mutex_t& m) : m_m(m) { pthread_mutex_lock(&m_m); }
+        ~Lock() { pthread_mutex_unlock(&m_m); }
+    private:
+        pthread_mutex_t& m_m;
+    };
+}
+
+ResultStore::ResultStore(const std::string& path, std::size_t topK) :
+m_topK(topK),
+m_fd(-1),
+m_end(0),
+m_dirty(false)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    open(path);
+}
+
+ResultStore::ResultStore(const std::string& path, configuration& config) :
+m_topK(10),
+m_fd(-1),
+m_end(0),
+m_dirty(false)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    if (config.iskey("resultStoreTopK"))
+    {
+        const int k = config.getintvalue("resultStoreTopK");
+        if (k < 0)
+        {
+            throw std::invalid_argument("resultStoreTopK is negative");
+        }
+        m_topK = k;
+    }
+    if (config.iskey("resultStore") && config.getintvalue("resultStore"))
+    {
+        open(path);
+    }
+}
+
+ResultStore::~ResultStore()
+{
+    if (m_fd >= 0)
+    {
+        flush();
+        ::close(m_fd);
+    }
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void ResultStore::open(const std::string& path)
+{
+    m_filename = path + ".res";
+    m_fd = ::open(m_filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0)
+    {
+        throw std::runtime_error("Could not open " + m_filename);
+    }
+    try
+    {
+        scan();
+    }
+    catch (...)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+        throw;
+    }
+}
+
+void ResultStore::scan()
+{
+    struct stat info;
+    if (fstat(m_fd, &info) != 0)
+    {
+        throw std::runtime_error("Could not read " + m_filename);
+    }
+    const uint64_t size = info.st_size;
+    if (size == 0)
+    {
+        if (!writeAll(m_fd, storeMagic, magicSize))
+        {
+            throw std::runtime_error("Could not write " + m_filename);
+        }
+        m_end = magicSize;
+        m_dirty = true;
+        return;
+    }
+
+    char magic[sizeof(storeMagic) - 1];
+    if (!readAt(m_fd, magic, magicSize, 0) ||
+        std::memcmp(magic, storeMagic, magicSize) != 0)
+    {
+        throw std::runtime_error(m_filename + " is not a result store");
+    }
+
+    uint64_t offset = magicSize;
+    char header[headerSize];
+    while (offset + headerSize <= size)
+    {
+        uint32_t count;
+        int32_t fidelity;
+        readAt(m_fd, header, headerSize, offset);
+        std::memcpy(&count, header, 4);
+        std::memcpy(&fidelity, header + 4, 4);
+        const uint64_t length = headerSize + uint64_t(count) * sizeof(double);
+        if (offset + length > size)
+        {
+            break;
+        }
+        double first = 0.0;
+        if (count > 0)
+        {
+            readAt(m_fd, &first, sizeof(first), offset + headerSize);
+        }
+        m_offsets.push_back(offset);
+        rank(offset, fidelity, count > 0 ? &first : NULL);
+        offset += length;
+    }
+
+    // Drop the end of a record a killed run left behind, so the next
+    // record follows the last whole one
+    if (offset != size && ftruncate(m_fd, offset) != 0)
+    {
+        throw std::runtime_error("Could not truncate " + m_filename);
+    }
+    m_end = offset;
+    m_dirty = true;
+}
+
+void ResultStore::rank(uint64_t offset, int fidelity, const double* firstScore)
+{
+    if (m_topK == 0 || fidelity != 0 || firstScore == NULL ||
+        *firstScore != *firstScore)
+    {
+        return;
+    }
+    if (m_best.size() >= m_topK && *firstScore <= m_best.begin()->first)
+    {
+        return;
+    }
+    m_best.insert(std::make_pair(*firstScore, offset));
+    if (m_best.size() > m_topK)
+    {
+        m_best.erase(m_best.begin());
+    }
+}
+
+uint64_t ResultStore::append(const std::vector< std::vector<double> >& parameters,
+                             const std::vector<double>& scores, int fidelity)
+{
+    if (m_fd < 0)
+    {
+        return 0;
+    }
+    const uint64_t hash = hashParameters(parameters);
+    const double recordedAt = now();
+
+    Lock lock(m_mutex);
+    const uint64_t trial = m_offsets.size();
+    const uint32_t count = scores.size();
+    const int32_t level = fidelity;
+    std::vector<char> record(headerSize + count * sizeof(double));
+    std::memcpy(&record[0], &count, 4);
+    std::memcpy(&record[4], &level, 4);
+    std::memcpy(&record[8], &trial, 8);
+    std::memcpy(&record[16], &hash, 8);
+    std::memcpy(&record[24], &recordedAt, 8);
+    if (count > 0)
+    {
+        std::memcpy(&record[headerSize], &scores[0], count * sizeof(double));
+    }
+    if (lseek(m_fd, m_end, SEEK_SET) < 0 ||
+        !writeAll(m_fd, &record[0], record.size()))
+    {
+        throw std::runtime_error("Could not write " + m_filename);
+    }
+
+    m_offsets.push_back(m_end);
+    rank(m_end, fidelity, count > 0 ? &scores[0] : NULL);
+    m_end += record.size();
+    m_dirty = true;
+    return trial;
+}
+
+void ResultStore::flush()
+{
+    if (m_fd < 0)
+    {
+        return;
+    }
+    Lock lock(m_mutex);
+    if (m_dirty)
+    {
+        writeIndex();
+        m_dirty = false;
+    }
+}
+
+void ResultStore::writeIndex()
+{
+    std::vector<uint64_t> words;
+    words.push_back(m_end);
+    words.push_back(m_offsets.size());
+    words.push_back(m_offsets.empty() ? 0 : m_offsets.back());
+    const uint32_t count = m_best.size();
+    std::multimap<double, uint64_t>::const_reverse_iterator it;
+    for (it = m_best.rbegin(); it != m_best.rend(); ++it)
+    {
+        words.push_back(it->second);
+    }
+
+    // Written aside and renamed, so a reader never sees half an index
+    const std::string name = m_filename.substr(0, m_filename.size() - 4) + ".idx";
+    const std::string temporary = name + ".tmp";
+    std::FILE* f = std::fopen(temporary.c_str(), "wb");
+    if (f == NULL)
+    {
+        throw std::runtime_error("Could not write " + temporary);
+    }
+    bool ok = std::fwrite(indexMagic, 1, magicSize, f) == magicSize;
+    ok = ok && std::fwrite(&words[0], sizeof(uint64_t), 3, f) == 3;
+    ok = ok && std::fwrite(&count, sizeof(count), 1, f) == 1;
+    ok = ok && (count == 0 ||
+                std::fwrite(&words[3], sizeof(uint64_t), count, f) == count);
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(temporary.c_str(), name.c_str()) != 0)
+    {
+        throw std::runtime_error("Could not write " + name);
+    }
+}
+
+std::size_t ResultStore::size() const
+{
+    Lock lock(m_mutex);
+    return m_offsets.size();
+}
+
+ResultStore::Result ResultStore::read(uint64_t offset) const
+{
+    char header[headerSize];
+    Result result;
+    uint32_t count = 0;
+    int32_t fidelity = 0;
+    if (!readAt(m_fd, header, headerSize, offset))
+    {
+        throw std::runtime_error("Could not read " + m_filename);
+    }
+    std::memcpy(&count, header, 4);
+    std::memcpy(&fidelity, header + 4, 4);
+    std::memcpy(&result.trial, header + 8, 8);
+    std::memcpy(&result.parametersHash, header + 16, 8);
+    std::memcpy(&result.recordedAt, header + 24, 8);
+    result.fidelity = fidelity;
+    result.scores.resize(count);
+    if (count > 0 &&
+        !readAt(m_fd, &result.scores[0], count * sizeof(double), offset + headerSize))
+    {
+        throw std::runtime_error("Could not read " + m_filename);
+    }
+    return result;
+}
+
+bool ResultStore::latest(Result& result) const
+{
+    Lock lock(m_mutex);
+    if (m_offsets.empty())
+    {
+        return false;
+    }
+    result = read(m_offsets.back());
+    return true;
+}
+
+ResultStore::Result ResultStore::get(uint64_t trial) const
+{
+    Lock lock(m_mutex);
+    if (trial >= m_offsets.size())
+    {
+        throw std::out_of_range("No such trial in the result store");
+    }
+    return read(m_offsets[trial]);
+}
+
+std::vector<ResultStore::Result> ResultStore::top(std::size_t k) const
+{
+    Lock lock(m_mutex);
+    std::vector<Result> results;
+    std::multimap<double, uint64_t>::const_reverse_iterator it;
+    for (it = m_best.rbegin(); it != m_best.rend() && results.size() < k; ++it)
+    {
+        results.push_back(read(it->second));
+    }
+    return results;
+}
+
+uint64_t ResultStore::hashParameters(const std::vector< std::vector<double> >& parameters)
+{
+    uint64_t h = fnvOffset;
+    const std::size_t n = parameters.size();
+    h = hashBytes(h, &n, sizeof(n));
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const std::size_t m = parameters[i].size();
+        h = hashBytes(h, &m, sizeof(m));
+        if (m > 0)
+        {
+            h = hashBytes(h, &parameters[i][0], m * sizeof(double));
+        }
+    }
+    return h;
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef RESULT_STORE_H_
+#define RESULT_STORE_H_
+
+/**
+ * @file ResultStore.h
+ * @brief Contains the definition of class ResultStore, an indexed
+ * append-only store of trial results.
+ * $Id$
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+// POSIX threads
+#include <pthread.h>
+
+class configuration;
+
+/**
+ * Every trial of a learning campaign, kept so the latest and best can
+ * be found without reading the whole history again. Each record holds
+ * the trial's number, a hash of the parameters tested, the fidelity it
+ * was run at (0 for a full trial), when it was recorded, and its scores.
+ * The store is reopened and appended to by later runs, so trial numbers
+ * go on across runs.
+ *
+ * The file, "<path>.res", starts with the eight bytes "NTRTRES1". Each
+ * record is a uint32 score count, an int32 fidelity, a uint64 trial
+ * number, a uint64 parameter hash, the double recording time in seconds
+ * since the epoch and the double scores, all in native byte order. A
+ * record cut short by a killed run is dropped when the store is next
+ * opened.
+ *
+ * Opening reads each record's header once. After that the latest
+ * record, any record by number, and the best full trials by first
+ * score are found in constant time. The best are also written to
+ * "<path>.idx" on each flush, so that
+ * scripts/learning/src/helpers/resultStore.py can answer the same
+ * questions without a scan. That file holds "NTRTRIX1", the uint64 file
+ * length it describes, the uint64 record count, the uint64 offset of the
+ * latest record, a uint32 count and the uint64 offsets of the best
+ * records, best first. Safe to call from several threads, but only one
+ * process should write a store at a time.
+ */
+class ResultStore
+{
+public:
+
+    /** One trial */
+    struct Result
+    {
+        uint64_t trial;
+        uint64_t parametersHash;
+        int fidelity;
+        double recordedAt;
+        std::vector<double> scores;
+    };
+
+    /**
+     * Open the store, creating it if needed.
+     * @param[in] path the name without extension
+     * @param[in] topK how many of the best full trials are kept at hand
+     * @throw std::runtime_error if the file cannot be opened or is not
+     * a store
+     */
+    ResultStore(const std::string& path, std::size_t topK = 10);
+
+    /**
+     * Read the optional keys resultStore (0 or 1, off by default) and
+     * resultStoreTopK, then open the store if it is on.
+     */
+    ResultStore(const std::string& path, configuration& config);
+
+    /** Flush and close */
+    ~ResultStore();
+
+    bool isEnabled() const
+    {
+        return m_fd >= 0;
+    }
+
+    /**
+     * Record a trial. Does nothing when disabled.
+     * @param[in] parameters one vector per controller, hashed
+     * @param[in] scores the first is the one the best are ranked by
+     * @param[in] fidelity 0 for a full trial; only full trials rank
+     * @return the trial's number, or 0 when disabled
+     * @throw std::runtime_error if the record cannot be written
+     */
+    uint64_t append(const std::vector< std::vector<double> >& parameters,
+                    const std::vector<double>& scores, int fidelity = 0);
+
+    /** Write the index file for the scripts */
+    void flush();
+
+    /** The number of trials recorded, across runs */
+    std::size_t size() const;
+
+    /** @return false if there are no trials */
+    bool latest(Result& result) const;
+
+    /**
+     * @param[in] trial less than size()
+     * @throw std::out_of_range if there is no such trial
+     */
+    Result get(uint64_t trial) const;
+
+    /**
+     * The best full trials by first score, best first; at most the
+     * topK given when the store was opened.
+     */
+    std::vector<Result> top(std::size_t k) const;
+
+    /**
+     * The hash recorded for a parameter set: FNV-1a over the exact bits
+     * and the sizes, as FitnessCache keys them.
+     */
+    static uint64_t hashParameters(const std::vector< std::vector<double> >& parameters);
+
+    const std::string& getFilename() const
+    {
+        return m_filename;
+    }
+
+private:
+
+    void open(const std::string& path);
+
+    /** Read the records already in the file, dropping a cut off one */
+    void scan();
+
+    /** Keep a record among the best if it ranks; m_mutex held */
+    void rank(uint64_t offset, int fidelity, const double* firstScore);
+
+    /** Read the record at an offset; m_mutex held */
+    Result read(uint64_t offset) const;
+
+    /** m_mutex held */
+    void writeIndex();
+
+    /** Not copyable */
+    ResultStore(const ResultStore&);
+    ResultStore& operator=(const ResultStore&);
+
+private:
+
+    std::size_t m_topK;
+
+    std::string m_filename;
+
+    /** The store, or -1 when disabled */
+    int m_fd;
+
+    /** Where each record starts, by trial number */
+    std::vector<uint64_t> m_offsets;
+
+    /** The file's length */
+    uint64_t m_end;
+
+    /** The best full trials' offsets by first score, worst first */
+    std::multimap<double, uint64_t> m_best;
+
+    /** Records appended since the index was written */
+    bool m_dirty;
+
+    mutable pthread_mutex_t m_mutex;
+};
+
+#endif  // RESULT_STORE_H_
@@ -0,0 +1,342 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file SPSAEvolution.cpp
+ * @brief Contains the definitions of members of class SPSAEvolution.
+ * $Id$
+ */
+
+#include "SPSAEvolution.h"
+#include "learning/Configuration/configuration.h"
+#include "helpers/FileHelpers.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace
+{
+    double clip(double value)
+    {
+        return std::max(0.0, std::min(1.0, value));
+    }
+
+    double optionalDouble(configuration& config, const std::string& key, double value)
+    {
+        return config.iskey(key) ? config.getDoubleValue(key) : value;
+    }
+
+    /** What SPSA and its AnnealEvoMembers cannot run without */
+    const configuration::Field spsaFields[] =
+    {
+        { "numberOfControllers", configuration::intType },
+        { "learning", configuration::intType },
+        { "numberOfActions", configuration::intType },
+        { "deviation", configuration::doubleType },
+        { "MonteCarlo", configuration::intType }
+    };
+}
+
+SPSAEvolution::SPSAEvolution(std::string suff, std::string config, std::string path) :
+suffix(suff),
+rng(0),
+nextPerturbation(0),
+numberScored(0),
+iteration(0),
+bestScore(0.0),
+hasBestScore(false),
+ck(0.0)
+{
+    if (path != "")
+    {
+        resourcePath = FileHelpers::getResourcePath(path);
+    }
+    else
+    {
+        resourcePath = "";
+    }
+
+    std::string configPath = resourcePath + config;
+
+    configuration myconfigdataaa;
+    myconfigdataaa.readFile(configPath);
+    myconfigdataaa.validate(spsaFields, sizeof(spsaFields) / sizeof(spsaFields[0]));
+    numberOfControllers=myconfigdataaa.getintvalue("numberOfControllers");
+    // The defaults of scripts/learning/src/SPSA/testSPSASpec.json
+    a0 = optionalDouble(myconfigdataaa, "spsaA0", 0.0625);
+    c0 = optionalDouble(myconfigdataaa, "spsaC0", 0.1);
+    A = optionalDouble(myconfigdataaa, "spsaA", 15.0);
+    bernoulliP = optionalDouble(myconfigdataaa, "spsaBernoulliP", 0.5);
+    maxStep = optionalDouble(myconfigdataaa, "spsaMaxStep", 0.0);
+    numberOfPairs = myconfigdataaa.iskey("spsaPairs") ? myconfigdataaa.getintvalue("spsaPairs") : 1;
+    hillClimbing = myconfigdataaa.iskey("hillClimbing") && myconfigdataaa.getintvalue("hillClimbing");
+    bool seeded = myconfigdataaa.iskey("startSeed") && myconfigdataaa.getintvalue("startSeed");
+    bool learning = myconfigdataaa.getintvalue("learning");
+
+    if (numberOfPairs < 1)
+    {
+        throw std::invalid_argument("spsaPairs is not positive");
+    }
+    if (c0 <= 0.0)
+    {
+        throw std::invalid_argument("spsaC0 is not positive");
+    }
+
+    if (myconfigdataaa.iskey("randomSeed"))
+    {
+        rng.seed(myconfigdataaa.getintvalue("randomSeed"));
+    }
+    else
+    {
+        rng.seed(tgRandom::entropySeed());
+    }
+    std::cout << "Random seed: " << rng.getSeed() << std::endl;
+
+    pruner = new TrialPruner(myconfigdataaa);
+    scoreLog = new ScoreLog(resourcePath + "logs/scores", myconfigdataaa);
+
+    for(int i=0;i<numberOfControllers;i++)
+    {
+        current.push_back(new AnnealEvoMember(myconfigdataaa, &rng.engine()));
+        if(seeded)
+        {
+            stringstream ss;
+            ss<< resourcePath <<"logs/bestParameters-"<<this->suffix<<"-"<<i<<".nnw";
+            current.back()->loadFromFile(ss.str().c_str());
+        }
+    }
+
+    perturbations.resize(2 * numberOfPairs);
+    for(std::size_t j=0;j<perturbations.size();j++)
+    {
+        for(int i=0;i<numberOfControllers;i++)
+        {
+            perturbations[j].push_back(new AnnealEvoMember(myconfigdataaa, &rng.engine()));
+        }
+    }
+    scores.resize(perturbations.size());
+    scored.resize(perturbations.size());
+
+    if(learning)
+    {
+        evolutionLog.open((resourcePath + "logs/evolution" + suffix + ".csv").c_str(),ios::out);
+        if (!evolutionLog.is_open())
+        {
+            throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
+        }
+    }
+
+    startIteration();
+}
+
+SPSAEvolution::~SPSAEvolution()
+{
+    delete pruner;
+    delete scoreLog;
+    for(std::size_t i=0;i<current.size();i++)
+    {
+        delete current[i];
+    }
+    for(std::size_t j=0;j<perturbations.size();j++)
+    {
+        for(std::size_t i=0;i<perturbations[j].size();i++)
+        {
+            delete perturbations[j][i];
+        }
+    }
+}
+
+void SPSAEvolution::startIteration()
+{
+    iteration++;
+    ck = c0 / pow(iteration, 0.166);
+
+    directions.assign(numberOfPairs, vector<double>());
+    for(int p=0;p<numberOfPairs;p++)
+    {
+        for(int i=0;i<numberOfControllers;i++)
+        {
+            const vector<double>& x = current[i]->statelessParameters;
+            vector<double>& plus = perturbations[2 * p][i]->statelessParameters;
+            vector<double>& minus = perturbations[2 * p + 1][i]->statelessParameters;
+            plus.resize(x.size());
+            minus.resize(x.size());
+            for(std::size_t k=0;k<x.size();k++)
+            {
+                const double d = rng.uniform() > bernoulliP ? 1.0 : -1.0;
+                directions[p].push_back(d);
+                plus[k] = clip(x[k] + ck * d);
+                minus[k] = clip(x[k] - ck * d);
+            }
+        }
+    }
+
+    nextPerturbation = 0;
+    numberScored = 0;
+    scored.assign(perturbations.size(), false);
+}
+
+void SPSAEvolution::finishIteration()
+{
+    double total = 0.0;
+    std::size_t best = 0;
+    for(std::size_t j=0;j<scores.size();j++)
+    {
+        total += scores[j][0];
+        if (scores[j][0] > scores[best][0])
+        {
+            best = j;
+        }
+    }
+
+    if(hillClimbing)
+    {
+        if(!hasBestScore || scores[best][0] > bestScore)
+        {
+            for(int i=0;i<numberOfControllers;i++)
+            {
+                current[i]->statelessParameters = perturbations[best][i]->statelessParameters;
+            }
+        }
+    }
+    else
+    {
+        const double ak = a0 / (A + iteration);
+        for(int p=0;p<numberOfPairs;p++)
+        {
+            const double dy = scores[2 * p][0] - scores[2 * p + 1][0];
+            std::size_t n = 0;
+            for(int i=0;i<numberOfControllers;i++)
+            {
+                vector<double>& x = current[i]->statelessParameters;
+                for(std::size_t k=0;k<x.size();k++, n++)
+                {
+                    // Average the gradient over the pairs
+                    double step = ak * dy / (2.0 * ck * directions[p][n]) / numberOfPairs;
+                    if (maxStep > 0.0)
+                    {
+                        step = std::max(-maxStep, std::min(maxStep, step));
+                    }
+                    x[k] = clip(x[k] + step);
+                }
+            }
+        }
+    }
+
+    if(!hasBestScore || scores[best][0] > bestScore)
+    {
+        bestScore = scores[best][0];
+        hasBestScore = true;
+    }
+
+    evolutionLog<<iteration<<","<<total / scores.size()<<","<<scores[best][0]<<","<<bestScore<<endl;
+    scoreLog->flush();
+
+    for(int i=0;i<numberOfControllers;i++)
+    {
+        stringstream ss;
+        ss << resourcePath << "logs/bestParameters-" << suffix << "-" << i << ".nnw";
+        current[i]->saveToFile(ss.str().c_str());
+    }
+}
+
+vector <AnnealEvoMember *> SPSAEvolution::nextSetOfControllers()
+{
+    if (!evolutionLog.is_open())
+    {
+        // Not learning: always run x
+        selectedControllers = current;
+        return selectedControllers;
+    }
+
+    if (nextPerturbation == static_cast<int>(perturbations.size()))
+    {
+        if (numberScored != nextPerturbation)
+        {
+            throw std::logic_error("Every perturbation must be scored before the next iteration");
+        }
+        finishIteration();
+        startIteration();
+    }
+
+    selectedControllers = perturbations[nextPerturbation++];
+    return selectedControllers;
+}
+
+void SPSAEvolution::updateScores(vector <double> multiscore)
+{
+    updateScores(selectedControllers, multiscore);
+}
+
+void SPSAEvolution::updateScores(const vector <AnnealEvoMember *>& controllers,
+                                 vector <double> multiscore)
+{
+    // Same convention as AnnealEvolution for an explosion
+    while (multiscore.size() < 2)
+    {
+        multiscore.push_back(-1.0);
+    }
+
+    vector<double> row(multiscore.begin(), multiscore.begin() + 2);
+    for(std::size_t i=0;i<controllers.size();i++)
+    {
+        row.insert(row.end(), controllers[i]->statelessParameters.begin(),
+                   controllers[i]->statelessParameters.end());
+    }
+    scoreLog->append(row);
+
+    if (!evolutionLog.is_open())
+    {
+        return;
+    }
+
+    std::size_t j = 0;
+    while (j < perturbations.size() && perturbations[j] != controllers)
+    {
+        j++;
+    }
+    if (j == perturbations.size() || static_cast<int>(j) >= nextPerturbation)
+    {
+        throw std::invalid_argument("Controllers are not from this iteration");
+    }
+    if (!scored[j])
+    {
+        scored[j] = true;
+        numberScored++;
+    }
+    scores[j] = multiscore;
+    for(std::size_t i=0;i<controllers.size();i++)
+    {
+        controllers[i]->maxScore = multiscore[0];
+        controllers[i]->maxScore1 = multiscore[0];
+        controllers[i]->maxScore2 = multiscore[1];
+    }
+}
+
+int SPSAEvolution::episodesLeftInGeneration() const
+{
+    if (!evolutionLog.is_open())
+    {
+        return 0;
+    }
+    return perturbations.size() - nextPerturbation;
+}
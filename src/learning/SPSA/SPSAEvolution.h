@@ -0,0 +1,147 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SPSAEVOLUTION_H_
+#define SPSAEVOLUTION_H_
+
+/**
+ * @file SPSAEvolution.h
+ * @brief Contains the definition of class SPSAEvolution.
+ * $Id$
+ */
+
+#include "learning/AnnealEvolution/AnnealEvoMember.h"
+#include "learning/Pruning/TrialPruner.h"
+#include "learning/ScoreLog/ScoreLog.h"
+#include "core/tgRandom.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Simultaneous perturbation stochastic approximation, or hill climbing,
+ * over the statelessParameters of one set of controllers, run in
+ * process instead of by scripts/learning/src/SPSA/SPSATest.py.
+ *
+ * Each iteration k draws spsaPairs Bernoulli directions d and tests
+ * x + c_k d and x - c_k d, with c_k = spsaC0 / k^0.166. SPSA then moves
+ * x by a_k times the averaged gradient estimate, a_k = spsaA0 /
+ * (spsaA + k); hill climbing (hillClimbing = 1) moves x to the best
+ * perturbation if it beat every score so far. Parameters stay in
+ * [0, 1] as for AnnealEvolution.
+ *
+ * It hands out and takes scores for sets of AnnealEvoMember in the same
+ * way as AnnealEvolution, so AnnealAdapter can drive it one trial at a
+ * time and ParallelEvolutionAdapter<SPSAEvolution, AnnealEvoMember>
+ * can run all the perturbations of an iteration in parallel worlds.
+ */
+class SPSAEvolution
+{
+public:
+    SPSAEvolution(std::string suffix, std::string config = "config.ini", std::string path = "");
+    ~SPSAEvolution();
+
+    /**
+     * The next perturbation of this iteration, starting the next
+     * iteration once every perturbation has been scored.
+     * @throw std::logic_error if the next iteration is due but some
+     * perturbations have not been scored
+     */
+    std::vector< AnnealEvoMember *> nextSetOfControllers();
+
+    /** Score the set last returned by nextSetOfControllers */
+    void updateScores(std::vector<double> scores);
+
+    /**
+     * Score any set handed out in this iteration. The update is made
+     * when the last one is scored.
+     * @throw std::invalid_argument if controllers is not a set of this
+     * iteration
+     */
+    void updateScores(const std::vector< AnnealEvoMember *>& controllers,
+                      std::vector<double> scores);
+
+    /**
+     * The same; the fidelity is ignored, as every sample of an update
+     * must come from the same simulation.
+     */
+    void updateScores(const std::vector< AnnealEvoMember *>& controllers,
+                      std::vector<double> scores, int fidelity)
+    {
+        updateScores(controllers, scores);
+    }
+
+    /** The perturbations of this iteration not handed out yet */
+    int episodesLeftInGeneration() const;
+
+    /**
+     * As for AnnealEvolution. Stopping a perturbation early biases the
+     * gradient estimate, so only eThreshold with hill climbing helps.
+     */
+    TrialPruner& getPruner()
+    {
+        return *pruner;
+    }
+
+    /** The parameters being optimised, one member per controller */
+    const std::vector< AnnealEvoMember *>& getCurrent() const
+    {
+        return current;
+    }
+
+    const std::string suffix;
+    std::string resourcePath;
+
+private:
+    void startIteration();
+    void finishIteration();
+
+    TrialPruner* pruner;
+    ScoreLog* scoreLog;
+    tgRandom rng;
+    int numberOfControllers;
+
+    double a0;
+    double c0;
+    double A;
+    double bernoulliP;
+    /// Largest change to one parameter per iteration, 0 for no limit
+    double maxStep;
+    int numberOfPairs;
+    bool hillClimbing;
+
+    /// x, one member per controller
+    std::vector< AnnealEvoMember *> current;
+    /// Perturbation 2i is x + c_k d_i, 2i + 1 is x - c_k d_i
+    std::vector< std::vector< AnnealEvoMember *> > perturbations;
+    /// d_i for every parameter of every controller
+    std::vector< std::vector<double> > directions;
+    std::vector< std::vector<double> > scores;
+    std::vector<bool> scored;
+    int nextPerturbation;
+    int numberScored;
+    int iteration;
+    double bestScore;
+    bool hasBestScore;
+    double ck;
+
+    std::vector <AnnealEvoMember *>  selectedControllers;
+    std::ofstream evolutionLog;
+};
+
+#endif /* SPSAEVOLUTION_H_ */
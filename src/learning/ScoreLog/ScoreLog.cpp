@@ -0,0 +1,205 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file ScoreLog.cpp
+ * @brief Contains the definitions of members of class ScoreLog
+ * $Id$
+ */
+
+#include "ScoreLog.h"
+#include "learning/Configuration/configuration.h"
+#include "core/tgTraceRecorder.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <unistd.h>
+
+namespace
+{
+    const char binaryMagic[] = "NTRTSCR1";
+
+    class Lock
+    {
+    public:
+        Lock(pthread_mutex_t& m) : m_m(m) { pthread_mutex_lock(&m_m); }
+        ~Lock() { pthread_mutex_unlock(&m_m); }
+    private:
+        pthread_mutex_t& m_m;
+    };
+}
+
+ScoreLog::ScoreLog(const std::string& path, Format format,
+                   std::size_t bufferRows, bool shard) :
+m_format(format),
+m_bufferRows(bufferRows)
+{
+    open(path, shard);
+}
+
+ScoreLog::ScoreLog(const std::string& path, configuration& config) :
+m_format(eCsv),
+m_bufferRows(100)
+{
+    bool shard = false;
+    if (config.iskey("scoreLogFormat"))
+    {
+        const int format = config.getintvalue("scoreLogFormat");
+        if (format < eCsv || format > eBinary)
+        {
+            throw std::invalid_argument("scoreLogFormat must be 0 or 1");
+        }
+        m_format = static_cast<Format>(format);
+    }
+    if (config.iskey("scoreLogBuffer"))
+    {
+        const int rows = config.getintvalue("scoreLogBuffer");
+        if (rows < 1)
+        {
+            throw std::invalid_argument("scoreLogBuffer is not positive");
+        }
+        m_bufferRows = rows;
+    }
+    if (config.iskey("scoreLogShards"))
+    {
+        shard = config.getintvalue("scoreLogShards");
+    }
+    open(path, shard);
+}
+
+void ScoreLog::open(const std::string& path, bool shard)
+{
+    if (m_bufferRows < 1)
+    {
+        throw std::invalid_argument("bufferRows is not positive");
+    }
+
+    std::ostringstream name;
+    name << path;
+    if (shard)
+    {
+        char host[256] = "";
+        gethostname(host, sizeof(host) - 1);
+        name << "-" << host << "-" << getpid();
+    }
+    name << (m_format == eCsv ? ".csv" : ".bin");
+    m_filename = name.str();
+
+    std::ios::openmode mode = std::ios::out | std::ios::app;
+    if (m_format == eBinary)
+    {
+        mode |= std::ios::binary;
+    }
+    m_file.open(m_filename.c_str(), mode);
+    if (!m_file.is_open())
+    {
+        throw std::runtime_error("Could not open " + m_filename);
+    }
+    if (m_format == eBinary && m_file.tellp() == 0)
+    {
+        m_file.write(binaryMagic, sizeof(binaryMagic) - 1);
+    }
+    m_rows.reserve(m_bufferRows);
+    pthread_mutex_init(&m_mutex, NULL);
+}
+
+ScoreLog::~ScoreLog()
+{
+    flush();
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void ScoreLog::append(const std::vector<double>& row)
+{
+    Lock lock(m_mutex);
+    m_rows.push_back(row);
+    if (m_rows.size() >= m_bufferRows)
+    {
+        write();
+    }
+}
+
+void ScoreLog::flush()
+{
+    Lock lock(m_mutex);
+    write();
+}
+
+void ScoreLog::write()
+{
+    if (m_rows.empty())
+    {
+        return;
+    }
+    tgTraceRecorder::Scope trace("score log write", static_cast<long>(m_rows.size()));
+
+    if (m_format == eCsv)
+    {
+        std::ostringstream out;
+        for (std::size_t i = 0; i < m_rows.size(); i++)
+        {
+            for (std::size_t j = 0; j < m_rows[i].size(); j++)
+            {
+                if (j > 0)
+                {
+                    out << ",";
+                }
+                out << m_rows[i][j];
+            }
+            out << "\n";
+        }
+        // One write per batch
+        const std::string s = out.str();
+        m_file.write(s.data(), s.size());
+    }
+    else
+    {
+        std::size_t begin = 0;
+        while (begin < m_rows.size())
+        {
+            // A block of rows of the same width
+            const std::size_t cols = m_rows[begin].size();
+            std::size_t end = begin + 1;
+            while (end < m_rows.size() && m_rows[end].size() == cols)
+            {
+                end++;
+            }
+            const uint32_t header[2] = { static_cast<uint32_t>(end - begin),
+                                         static_cast<uint32_t>(cols) };
+            std::vector<double> block;
+            block.reserve((end - begin) * cols);
+            for (std::size_t j = 0; j < cols; j++)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    block.push_back(m_rows[i][j]);
+                }
+            }
+            m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+            if (!block.empty())
+            {
+                m_file.write(reinterpret_cast<const char*>(&block[0]),
+                             block.size() * sizeof(double));
+            }
+            begin = end;
+        }
+    }
+    m_file.flush();
+    m_rows.clear();
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SCORE_LOG_H_
+#define SCORE_LOG_H_
+
+/**
+ * @file ScoreLog.h
+ * @brief Contains the definition of class ScoreLog, a buffered sink for
+ * the per-trial rows of a learning run.
+ * $Id$
+ */
+
+#include <fstream>
+#include <string>
+#include <vector>
+// POSIX threads
+#include <pthread.h>
+
+class configuration;
+
+/**
+ * Collects one row of numbers per trial and writes them in batches to
+ * a file that stays open for the whole run, instead of opening and
+ * closing the log on every trial.
+ *
+ * In eCsv format the file is the scores.csv the analysis scripts have
+ * always read. In eBinary format each batch is a block: the number of
+ * rows and of columns as 32 bit unsigned integers, then the doubles of
+ * each column in turn. A block holds rows of one width only. The file
+ * starts with the eight bytes "NTRTSCR1".
+ *
+ * With sharding on, the process's host name and id are added to the
+ * file name, so workers sharing a log folder over NFS never write to
+ * the same file. scripts/learning/src/helpers/mergeScores.py joins the
+ * shards back into one scores.csv. Safe to call from several threads.
+ */
+class ScoreLog
+{
+public:
+
+    enum Format
+    {
+        eCsv,
+        eBinary
+    };
+
+    /**
+     * Open the log, truncating nothing; rows are appended.
+     * @param[in] path the name without extension; ".csv" or ".bin" is
+     * added
+     * @param[in] format how rows are written
+     * @param[in] bufferRows the rows kept before a write; at least 1
+     * @param[in] shard add the host name and process id to the name
+     * @throw std::runtime_error if the file cannot be opened
+     */
+    ScoreLog(const std::string& path, Format format = eCsv,
+             std::size_t bufferRows = 100, bool shard = false);
+
+    /**
+     * Read the optional keys scoreLogFormat (0 for eCsv, 1 for eBinary),
+     * scoreLogBuffer and scoreLogShards (0 or 1), then open the log.
+     */
+    ScoreLog(const std::string& path, configuration& config);
+
+    /** Write what is left */
+    ~ScoreLog();
+
+    /** Add a row; it is written once the buffer is full */
+    void append(const std::vector<double>& row);
+
+    /** Write the buffered rows out now */
+    void flush();
+
+    /** The name of the file being written */
+    const std::string& getFilename() const
+    {
+        return m_filename;
+    }
+
+private:
+
+    void open(const std::string& path, bool shard);
+
+    /** Called with m_mutex held */
+    void write();
+
+    /** Not copyable */
+    ScoreLog(const ScoreLog&);
+    ScoreLog& operator=(const ScoreLog&);
+
+private:
+
+    Format m_format;
+
+    std::size_t m_bufferRows;
+
+    std::string m_filename;
+
+    std::ofstream m_file;
+
+    std::vector< std::vector<double> > m_rows;
+
+    pthread_mutex_t m_mutex;
+};
+
+#endif  // SCORE_LOG_H_
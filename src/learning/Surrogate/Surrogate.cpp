@@ -0,0 +1,509 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file Surrogate.cpp
+ * @brief Contains the definitions of members of the surrogate models and
+ * of class SurrogateScreen
+ * $Id$
+ */
+
+#include "Surrogate.h"
+#include "learning/Configuration/configuration.h"
+#include "core/tgRandom.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    class Lock
+    {
+    public:
+        Lock(pthread_mutex_t& m) : m_m(m) { pthread_mutex_lock(&m_m); }
+        ~Lock() { pthread_mutex_unlock(&m_m); }
+    private:
+        pthread_mutex_t& m_m;
+    };
+
+    double squaredDistance(const std::vector<double>& a,
+                           const std::vector<double>& b)
+    {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < a.size(); i++)
+        {
+            const double d = a[i] - b[i];
+            sum += d * d;
+        }
+        return sum;
+    }
+
+    /**
+     * Replace the lower triangle of a symmetric positive definite n by n
+     * matrix, row major, with its Cholesky factor.
+     * @return false if the matrix is not positive definite
+     */
+    bool cholesky(std::vector<double>& a, std::size_t n)
+    {
+        for (std::size_t j = 0; j < n; j++)
+        {
+            double diagonal = a[j * n + j];
+            for (std::size_t k = 0; k < j; k++)
+            {
+                diagonal -= a[j * n + k] * a[j * n + k];
+            }
+            if (!(diagonal > 0.0))
+            {
+                return false;
+            }
+            diagonal = std::sqrt(diagonal);
+            a[j * n + j] = diagonal;
+            for (std::size_t i = j + 1; i < n; i++)
+            {
+                double value = a[i * n + j];
+                for (std::size_t k = 0; k < j; k++)
+                {
+                    value -= a[i * n + k] * a[j * n + k];
+                }
+                a[i * n + j] = value / diagonal;
+            }
+        }
+        return true;
+    }
+
+    /** Solve L x = b in place, for a lower Cholesky factor L */
+    void forwardSubstitute(const std::vector<double>& l, std::size_t n,
+                           std::vector<double>& b)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            double value = b[i];
+            for (std::size_t k = 0; k < i; k++)
+            {
+                value -= l[i * n + k] * b[k];
+            }
+            b[i] = value / l[i * n + i];
+        }
+    }
+
+    /** Solve L^T x = b in place, for a lower Cholesky factor L */
+    void backSubstitute(const std::vector<double>& l, std::size_t n,
+                        std::vector<double>& b)
+    {
+        for (std::size_t i = n; i-- > 0; )
+        {
+            double value = b[i];
+            for (std::size_t k = i + 1; k < n; k++)
+            {
+                value -= l[k * n + i] * b[k];
+            }
+            b[i] = value / l[i * n + i];
+        }
+    }
+
+    /**
+     * Factor a, adding jitter to the diagonal until it is positive
+     * definite, as rounding can leave a kernel matrix of close samples
+     * just short of it.
+     */
+    void factorWithJitter(const std::vector<double>& a, std::size_t n,
+                          std::vector<double>& factor)
+    {
+        double jitter = 0.0;
+        for (int attempt = 0; attempt < 10; attempt++)
+        {
+            factor = a;
+            for (std::size_t i = 0; i < n; i++)
+            {
+                factor[i * n + i] += jitter;
+            }
+            if (cholesky(factor, n))
+            {
+                return;
+            }
+            jitter = (jitter == 0.0) ? 1e-10 : jitter * 10.0;
+        }
+        throw std::runtime_error("Surrogate fit is not positive definite");
+    }
+}
+
+SurrogateModel::SurrogateModel(std::size_t capacity) :
+m_capacity(std::max<std::size_t>(capacity, 1)),
+m_dirty(false)
+{
+}
+
+void SurrogateModel::add(const std::vector<double>& parameters, double score)
+{
+    if (!m_parameters.empty() && parameters.size() != m_parameters[0].size())
+    {
+        throw std::invalid_argument("Surrogate sample has a different number of parameters");
+    }
+    if (m_scores.size() == m_capacity)
+    {
+        m_parameters.pop_front();
+        m_scores.pop_front();
+    }
+    m_parameters.push_back(parameters);
+    m_scores.push_back(score);
+    m_dirty = true;
+}
+
+bool SurrogateModel::predict(const std::vector<double>& parameters,
+                             double& mean, double& deviation)
+{
+    if (m_scores.empty())
+    {
+        return false;
+    }
+    if (parameters.size() != m_parameters[0].size())
+    {
+        throw std::invalid_argument("Surrogate query has a different number of parameters");
+    }
+    if (m_dirty)
+    {
+        fit();
+        m_dirty = false;
+    }
+    evaluate(parameters, mean, deviation);
+    return true;
+}
+
+GaussianProcessSurrogate::GaussianProcessSurrogate(std::size_t capacity,
+                                                   double lengthScale,
+                                                   double noise) :
+SurrogateModel(capacity),
+m_lengthScale(lengthScale),
+m_noise(noise),
+m_scale(1.0),
+m_mean(0.0),
+m_deviation(1.0)
+{
+    if (lengthScale < 0.0 || !(noise > 0.0))
+    {
+        throw std::invalid_argument("Gaussian process needs a nonnegative length scale and positive noise");
+    }
+}
+
+double GaussianProcessSurrogate::kernel(const std::vector<double>& a,
+                                        const std::vector<double>& b) const
+{
+    return std::exp(-0.5 * squaredDistance(a, b) / (m_scale * m_scale));
+}
+
+void GaussianProcessSurrogate::fit()
+{
+    const std::size_t n = m_scores.size();
+
+    m_mean = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        m_mean += m_scores[i];
+    }
+    m_mean /= n;
+    double variance = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        variance += (m_scores[i] - m_mean) * (m_scores[i] - m_mean);
+    }
+    variance /= n;
+    m_deviation = variance > 0.0 ? std::sqrt(variance) : 1.0;
+
+    m_scale = m_lengthScale;
+    if (m_scale == 0.0)
+    {
+        // The median distance between samples
+        std::vector<double> distances;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            for (std::size_t j = i + 1; j < n; j++)
+            {
+                distances.push_back(squaredDistance(m_parameters[i], m_parameters[j]));
+            }
+        }
+        if (!distances.empty())
+        {
+            std::nth_element(distances.begin(),
+                             distances.begin() + distances.size() / 2,
+                             distances.end());
+            m_scale = std::sqrt(distances[distances.size() / 2]);
+        }
+        if (!(m_scale > 0.0))
+        {
+            m_scale = 1.0;
+        }
+    }
+
+    std::vector<double> k(n * n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        k[i * n + i] = 1.0 + m_noise;
+        for (std::size_t j = 0; j < i; j++)
+        {
+            k[i * n + j] = k[j * n + i] = kernel(m_parameters[i], m_parameters[j]);
+        }
+    }
+    factorWithJitter(k, n, m_factor);
+
+    m_weights.resize(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        m_weights[i] = (m_scores[i] - m_mean) / m_deviation;
+    }
+    forwardSubstitute(m_factor, n, m_weights);
+    backSubstitute(m_factor, n, m_weights);
+}
+
+void GaussianProcessSurrogate::evaluate(const std::vector<double>& parameters,
+                                        double& mean, double& deviation) const
+{
+    const std::size_t n = m_scores.size();
+    std::vector<double> k(n);
+    double standardized = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        k[i] = kernel(parameters, m_parameters[i]);
+        standardized += k[i] * m_weights[i];
+    }
+    // The variance left after conditioning on the samples
+    forwardSubstitute(m_factor, n, k);
+    double variance = 1.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        variance -= k[i] * k[i];
+    }
+    mean = m_mean + m_deviation * standardized;
+    deviation = m_deviation * std::sqrt(std::max(variance, 0.0));
+}
+
+RidgeSurrogate::RidgeSurrogate(std::size_t capacity, double ridge) :
+SurrogateModel(capacity),
+m_ridge(ridge),
+m_residual(0.0)
+{
+    if (!(ridge > 0.0))
+    {
+        throw std::invalid_argument("Ridge surrogate needs a positive penalty");
+    }
+}
+
+void RidgeSurrogate::fit()
+{
+    const std::size_t n = m_scores.size();
+    const std::size_t m = m_parameters[0].size() + 1;
+
+    // The normal equations, with a leading 1 for the intercept
+    std::vector<double> a(m * m, 0.0);
+    std::vector<double> b(m, 0.0);
+    std::vector<double> x(m);
+    for (std::size_t s = 0; s < n; s++)
+    {
+        x[0] = 1.0;
+        std::copy(m_parameters[s].begin(), m_parameters[s].end(), x.begin() + 1);
+        for (std::size_t i = 0; i < m; i++)
+        {
+            b[i] += x[i] * m_scores[s];
+            for (std::size_t j = 0; j <= i; j++)
+            {
+                a[i * m + j] += x[i] * x[j];
+            }
+        }
+    }
+    for (std::size_t i = 0; i < m; i++)
+    {
+        for (std::size_t j = 0; j < i; j++)
+        {
+            a[j * m + i] = a[i * m + j];
+        }
+        if (i > 0)
+        {
+            a[i * m + i] += m_ridge * n;
+        }
+    }
+
+    std::vector<double> factor;
+    factorWithJitter(a, m, factor);
+    forwardSubstitute(factor, m, b);
+    backSubstitute(factor, m, b);
+    m_coefficients.swap(b);
+
+    double squares = 0.0;
+    for (std::size_t s = 0; s < n; s++)
+    {
+        double mean, deviation;
+        evaluate(m_parameters[s], mean, deviation);
+        squares += (m_scores[s] - mean) * (m_scores[s] - mean);
+    }
+    m_residual = std::sqrt(squares / n);
+}
+
+void RidgeSurrogate::evaluate(const std::vector<double>& parameters,
+                              double& mean, double& deviation) const
+{
+    mean = m_coefficients[0];
+    for (std::size_t i = 0; i < parameters.size(); i++)
+    {
+        mean += m_coefficients[i + 1] * parameters[i];
+    }
+    deviation = m_residual;
+}
+
+SurrogateScreen::SurrogateScreen(SurrogateModel* pModel, std::size_t candidates,
+                                 double exploration, std::size_t minSamples) :
+m_pModel(pModel),
+m_candidates(candidates),
+m_exploration(exploration),
+m_minSamples(minSamples),
+m_screened(0),
+m_explored(0)
+{
+    init();
+    if (candidates < 1 || exploration < 0.0 || exploration > 1.0)
+    {
+        delete m_pModel;
+        pthread_mutex_destroy(&m_mutex);
+        throw std::invalid_argument("Surrogate screen needs a candidate and an exploration fraction from 0 to 1");
+    }
+}
+
+SurrogateScreen::SurrogateScreen(configuration& config) :
+m_pModel(NULL),
+m_candidates(8),
+m_exploration(0.2),
+m_minSamples(10),
+m_screened(0),
+m_explored(0)
+{
+    init();
+    const int type = config.iskey("surrogate") ? config.getintvalue("surrogate") : 0;
+    if (type == 0)
+    {
+        return;
+    }
+    if (config.iskey("surrogateCandidates"))
+    {
+        const int candidates = config.getintvalue("surrogateCandidates");
+        if (candidates < 1)
+        {
+            throw std::invalid_argument("surrogateCandidates must be at least 1");
+        }
+        m_candidates = candidates;
+    }
+    if (config.iskey("surrogateExploration"))
+    {
+        m_exploration = config.getDoubleValue("surrogateExploration");
+        if (m_exploration < 0.0 || m_exploration > 1.0)
+        {
+            throw std::invalid_argument("surrogateExploration must be from 0 to 1");
+        }
+    }
+    if (config.iskey("surrogateMinSamples"))
+    {
+        m_minSamples = std::max(config.getintvalue("surrogateMinSamples"), 1);
+    }
+    std::size_t capacity = 200;
+    if (config.iskey("surrogateCapacity"))
+    {
+        capacity = std::max(config.getintvalue("surrogateCapacity"), 1);
+    }
+
+    if (type == 1)
+    {
+        m_pModel = new GaussianProcessSurrogate(capacity);
+    }
+    else if (type == 2)
+    {
+        m_pModel = new RidgeSurrogate(capacity);
+    }
+    else
+    {
+        throw std::invalid_argument("surrogate must be 0, 1 or 2");
+    }
+}
+
+SurrogateScreen::~SurrogateScreen()
+{
+    delete m_pModel;
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void SurrogateScreen::init()
+{
+    pthread_mutex_init(&m_mutex, NULL);
+}
+
+bool SurrogateScreen::isReady() const
+{
+    if (!m_pModel)
+    {
+        return false;
+    }
+    Lock lock(m_mutex);
+    return m_pModel->size() >= m_minSamples;
+}
+
+void SurrogateScreen::add(const std::vector< std::vector<double> >& parameters,
+                          double score)
+{
+    if (!m_pModel)
+    {
+        return;
+    }
+    Lock lock(m_mutex);
+    m_flat.clear();
+    for (std::size_t i = 0; i < parameters.size(); i++)
+    {
+        m_flat.insert(m_flat.end(), parameters[i].begin(), parameters[i].end());
+    }
+    m_pModel->add(m_flat, score);
+}
+
+bool SurrogateScreen::explore(tgRandom& rng)
+{
+    if (!isReady())
+    {
+        return true;
+    }
+    if (rng.uniform() < m_exploration)
+    {
+        Lock lock(m_mutex);
+        m_explored++;
+        return true;
+    }
+    return false;
+}
+
+double SurrogateScreen::rank(const std::vector< std::vector<double> >& parameters)
+{
+    if (!m_pModel)
+    {
+        throw std::logic_error("Ranking with a disabled surrogate screen");
+    }
+    Lock lock(m_mutex);
+    m_flat.clear();
+    for (std::size_t i = 0; i < parameters.size(); i++)
+    {
+        m_flat.insert(m_flat.end(), parameters[i].begin(), parameters[i].end());
+    }
+    double mean = 0.0;
+    double deviation = 0.0;
+    m_pModel->predict(m_flat, mean, deviation);
+    m_screened++;
+    return mean + deviation;
+}
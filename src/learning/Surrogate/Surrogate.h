@@ -0,0 +1,286 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SURROGATE_H_
+#define SURROGATE_H_
+
+/**
+ * @file Surrogate.h
+ * @brief Contains the definitions of the surrogate models of trial
+ * scores, and of class SurrogateScreen, which uses one to choose between
+ * candidate controllers before they are simulated.
+ * $Id$
+ */
+
+#include <deque>
+#include <vector>
+// POSIX threads
+#include <pthread.h>
+
+class configuration;
+class tgRandom;
+
+/**
+ * A cheap model of the score a trial would give a parameter set,
+ * learned from the trials already run. Keeps the most recent samples,
+ * up to a capacity, and fits them again on the first prediction after
+ * a change. Subclasses give the fit. Not safe to call from several
+ * threads; SurrogateScreen locks around it.
+ */
+class SurrogateModel
+{
+public:
+
+    /** @param[in] capacity the samples kept; older ones are dropped */
+    SurrogateModel(std::size_t capacity = 200);
+
+    virtual ~SurrogateModel() {}
+
+    /**
+     * Learn the score of a parameter set.
+     * @throw std::invalid_argument if it has a different number of
+     * parameters than the samples before it
+     */
+    void add(const std::vector<double>& parameters, double score);
+
+    /**
+     * Predict the score of a parameter set.
+     * @param[out] mean the expected score
+     * @param[out] deviation how uncertain it is, as a standard deviation
+     * @return false if there are no samples
+     */
+    bool predict(const std::vector<double>& parameters, double& mean,
+                 double& deviation);
+
+    std::size_t size() const
+    {
+        return m_scores.size();
+    }
+
+protected:
+
+    /** Fit the samples; called by predict when they have changed */
+    virtual void fit() = 0;
+
+    /** Predict from the last fit */
+    virtual void evaluate(const std::vector<double>& parameters,
+                          double& mean, double& deviation) const = 0;
+
+    /** The samples, oldest first */
+    std::deque< std::vector<double> > m_parameters;
+    std::deque<double> m_scores;
+
+private:
+
+    std::size_t m_capacity;
+
+    /** Samples were added since the last fit */
+    bool m_dirty;
+};
+
+/**
+ * A Gaussian process with a squared exponential kernel over the
+ * parameters, and a noise term, since a noisy simulation does not give
+ * a parameter set the same score twice. The scores are standardized
+ * before the fit. With no length scale given, it is the median distance
+ * between samples. Fitting is cubic in the samples kept, so keep the
+ * capacity to a few hundred.
+ */
+class GaussianProcessSurrogate : public SurrogateModel
+{
+public:
+
+    /**
+     * @param[in] capacity the samples kept
+     * @param[in] lengthScale of the kernel, in parameter units; 0 to
+     * choose it from the samples on each fit
+     * @param[in] noise the variance of the scores' noise, relative to the
+     * variance of the scores
+     */
+    GaussianProcessSurrogate(std::size_t capacity = 200,
+                             double lengthScale = 0.0, double noise = 0.01);
+
+protected:
+
+    virtual void fit();
+
+    virtual void evaluate(const std::vector<double>& parameters,
+                          double& mean, double& deviation) const;
+
+private:
+
+    double kernel(const std::vector<double>& a,
+                  const std::vector<double>& b) const;
+
+    const double m_lengthScale;
+    const double m_noise;
+
+    /** The length scale of the last fit */
+    double m_scale;
+
+    /** The mean and standard deviation the scores were standardized by */
+    double m_mean;
+    double m_deviation;
+
+    /** The lower Cholesky factor of the kernel matrix, row major */
+    std::vector<double> m_factor;
+
+    /** The kernel matrix's inverse times the standardized scores */
+    std::vector<double> m_weights;
+};
+
+/**
+ * A linear model of the score, fit by ridge regression. Far cheaper to
+ * fit than a Gaussian process but only finds which way each parameter
+ * helps. The deviation is the root mean square of the fit's residuals,
+ * the same everywhere.
+ */
+class RidgeSurrogate : public SurrogateModel
+{
+public:
+
+    /**
+     * @param[in] capacity the samples kept
+     * @param[in] ridge the penalty on the coefficients, not the intercept
+     */
+    RidgeSurrogate(std::size_t capacity = 200, double ridge = 1e-3);
+
+protected:
+
+    virtual void fit();
+
+    virtual void evaluate(const std::vector<double>& parameters,
+                          double& mean, double& deviation) const;
+
+private:
+
+    const double m_ridge;
+
+    /** The intercept, then a coefficient per parameter */
+    std::vector<double> m_coefficients;
+
+    double m_residual;
+};
+
+/**
+ * Prescreens mutated controllers with a SurrogateModel trained on the
+ * full trials scored so far. Rather than simulate one mutation of a
+ * member, a learner draws getCandidates() of them and simulates only
+ * the one rank() puts first: the predicted score plus its deviation, so
+ * that parameter sets the model knows little about still get a chance.
+ * A share of the members, the exploration fraction, are simulated as
+ * drawn, so the model keeps seeing what the mutations really give.
+ * Screening starts once the model has the minimum number of samples.
+ * Safe to call from several threads.
+ */
+class SurrogateScreen
+{
+public:
+
+    /**
+     * @param[in] pModel deleted by the screen; NULL for a disabled screen
+     * @param[in] candidates the mutations drawn per member; at least 1
+     * @param[in] exploration the share of members not screened, 0 to 1
+     * @param[in] minSamples the trials to learn from before screening
+     */
+    SurrogateScreen(SurrogateModel* pModel, std::size_t candidates = 8,
+                    double exploration = 0.2, std::size_t minSamples = 10);
+
+    /**
+     * Read the optional keys surrogate (0 for off, the default, 1 for a
+     * GaussianProcessSurrogate, 2 for a RidgeSurrogate),
+     * surrogateCandidates, surrogateExploration, surrogateMinSamples and
+     * surrogateCapacity.
+     * @throw std::invalid_argument if a value is out of range
+     */
+    SurrogateScreen(configuration& config);
+
+    ~SurrogateScreen();
+
+    bool isEnabled() const
+    {
+        return m_pModel != NULL;
+    }
+
+    /** Enabled, with enough samples to screen */
+    bool isReady() const;
+
+    std::size_t getCandidates() const
+    {
+        return m_candidates;
+    }
+
+    /**
+     * Learn from a full trial. Does nothing when disabled.
+     * @param[in] parameters one vector per controller
+     * @param[in] score the score the learner ranks by
+     */
+    void add(const std::vector< std::vector<double> >& parameters,
+             double score);
+
+    /**
+     * Draw whether the next member is simulated without screening.
+     * @return true with the exploration fraction's probability, and
+     * always when not ready
+     */
+    bool explore(tgRandom& rng);
+
+    /**
+     * How promising a candidate is: the predicted score plus its
+     * deviation. Counts the candidate as screened.
+     */
+    double rank(const std::vector< std::vector<double> >& parameters);
+
+    /** The candidates ranked */
+    std::size_t getScreened() const
+    {
+        return m_screened;
+    }
+
+    /** The members simulated as drawn while ready */
+    std::size_t getExplored() const
+    {
+        return m_explored;
+    }
+
+private:
+
+    void init();
+
+    /** Not copyable */
+    SurrogateScreen(const SurrogateScreen&);
+    SurrogateScreen& operator=(const SurrogateScreen&);
+
+private:
+
+    SurrogateModel* m_pModel;
+
+    std::size_t m_candidates;
+    double m_exploration;
+    std::size_t m_minSamples;
+
+    std::size_t m_screened;
+    std::size_t m_explored;
+
+    /** The parameters of a candidate, all controllers in turn */
+    std::vector<double> m_flat;
+
+    mutable pthread_mutex_t m_mutex;
+};
+
+#endif  // SURROGATE_H_
@@ -0,0 +1,385 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file ParameterSweep.cpp
+ * @brief Contains the definitions of members of class ParameterSweep
+ * $Id$
+ */
+
+#include "ParameterSweep.h"
+#include "core/tgRandom.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    /** The value a fraction t of the way through a dimension's range */
+    double valueAt(const ParameterSweep::Dimension& d, double t)
+    {
+        if (d.logScale)
+        {
+            return std::exp(std::log(d.min) + t * (std::log(d.max) - std::log(d.min)));
+        }
+        return d.min + t * (d.max - d.min);
+    }
+}
+
+/**
+ * Forwards a Study's calls, and writes its results into the table row
+ * of the trial.
+ */
+class ParameterSweep::StudyEpisode : public tgParallelSimulation::Episode
+{
+public:
+    StudyEpisode(ParameterSweep& o, Study& s) :
+        owner(o),
+        study(s)
+    {
+    }
+
+    virtual tgGround* createGround()
+    {
+        tgGround* const pGround = study.createGround();
+        return (pGround != NULL) ? pGround : Episode::createGround();
+    }
+
+    virtual void setup(tgSimulation& simulation)
+    {
+        study.setup(simulation);
+    }
+
+    virtual void beginTrial(std::size_t trial)
+    {
+    }
+
+    virtual void prepareTrial(tgSimulation& simulation, std::size_t trial)
+    {
+        study.apply(owner.m_points[trial]);
+    }
+
+    virtual std::vector<tgStopPredicate*> getStopPredicates()
+    {
+        return study.getStopPredicates();
+    }
+
+    virtual void endTrial(std::size_t trial)
+    {
+        const std::size_t first = owner.m_points[trial].size();
+        results.clear();
+        study.measure(results);
+        if (first + results.size() != owner.m_columns.size())
+        {
+            throw std::runtime_error("Study measured the wrong number of results");
+        }
+        for (std::size_t i = 0; i < results.size(); i++)
+        {
+            owner.m_columns[first + i][trial] = results[i];
+        }
+    }
+
+    ParameterSweep& owner;
+    Study& study;
+
+    /** Reused between trials */
+    std::vector<double> results;
+};
+
+ParameterSweep::Dimension::Dimension(const std::string& n, double lo, double hi,
+                                     std::size_t l, bool lg) :
+name(n),
+min(lo),
+max(hi),
+levels(l),
+logScale(lg)
+{
+    if (hi < lo)
+    {
+        throw std::invalid_argument("Dimension max is below its min");
+    }
+    if (l == 0)
+    {
+        throw std::invalid_argument("Dimension has no levels");
+    }
+    if (lg && lo <= 0.0)
+    {
+        throw std::invalid_argument("Log scale dimension is not positive");
+    }
+}
+
+ParameterSweep::Spec::Spec(Sampling s, std::size_t n, unsigned long sd) :
+sampling(s),
+samples(n),
+seed(sd)
+{
+}
+
+ParameterSweep::Spec ParameterSweep::Spec::readFile(const std::string& path)
+{
+    std::ifstream file(path.c_str());
+    if (!file)
+    {
+        throw std::runtime_error("Cannot read sweep spec " + path);
+    }
+
+    Spec spec;
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        std::istringstream words(line);
+        std::string first;
+        if (!(words >> first) || first[0] == '#')
+        {
+            continue;
+        }
+
+        std::ostringstream where;
+        where << path << ":" << lineNumber << ": ";
+        if (first == "sampling")
+        {
+            std::string kind;
+            words >> kind;
+            if (kind == "grid")
+            {
+                spec.sampling = eGrid;
+            }
+            else if (kind == "latin" && (words >> spec.samples))
+            {
+                spec.sampling = eLatinHypercube;
+                if (!(words >> spec.seed))
+                {
+                    spec.seed = 0;
+                }
+            }
+            else
+            {
+                throw std::runtime_error(where.str() + "bad sampling");
+            }
+            continue;
+        }
+
+        double lo = 0.0;
+        double hi = 0.0;
+        if (!(words >> lo >> hi))
+        {
+            throw std::runtime_error(where.str() + "expected a name, min and max");
+        }
+        std::size_t levels = 2;
+        bool logScale = false;
+        std::string word;
+        while (words >> word)
+        {
+            std::istringstream number(word);
+            if (word == "log")
+            {
+                logScale = true;
+            }
+            else if (!(number >> levels))
+            {
+                throw std::runtime_error(where.str() + "unexpected " + word);
+            }
+        }
+        try
+        {
+            spec.dimensions.push_back(Dimension(first, lo, hi, levels, logScale));
+        }
+        catch (std::invalid_argument& e)
+        {
+            throw std::runtime_error(where.str() + e.what());
+        }
+    }
+    return spec;
+}
+
+ParameterSweep::ParameterSweep(const Spec& spec,
+                               const std::vector<std::string>& resultNames,
+                               const tgParallelSimulation::Config& config,
+                               const std::vector<Study*>& studies) :
+m_points(points(spec)),
+m_pSimulation(NULL)
+{
+    if (studies.empty())
+    {
+        throw std::invalid_argument("No studies");
+    }
+
+    for (std::size_t i = 0; i < spec.dimensions.size(); i++)
+    {
+        m_columnNames.push_back(spec.dimensions[i].name);
+    }
+    m_columnNames.insert(m_columnNames.end(), resultNames.begin(), resultNames.end());
+    m_columns.resize(m_columnNames.size(),
+                     std::vector<double>(m_points.size(), 0.0));
+
+    for (std::size_t i = 0; i < studies.size(); i++)
+    {
+        if (studies[i] == NULL)
+        {
+            throw std::invalid_argument("Study is NULL");
+        }
+    }
+
+    std::vector<tgParallelSimulation::Episode*> episodes;
+    for (std::size_t i = 0; i < studies.size(); i++)
+    {
+        m_episodes.push_back(new StudyEpisode(*this, *studies[i]));
+        episodes.push_back(m_episodes.back());
+    }
+
+    tgParallelSimulation::Config restoring(config);
+    restoring.restoreSnapshot = true;
+    m_pSimulation = new tgParallelSimulation(restoring, episodes);
+}
+
+ParameterSweep::~ParameterSweep()
+{
+    // Stops the workers before the episodes go
+    delete m_pSimulation;
+    for (std::size_t i = 0; i < m_episodes.size(); i++)
+    {
+        delete m_episodes[i];
+    }
+}
+
+void ParameterSweep::run(int steps)
+{
+    const std::size_t dimensions = m_points[0].size();
+    for (std::size_t j = 0; j < m_points.size(); j++)
+    {
+        for (std::size_t i = 0; i < dimensions; i++)
+        {
+            m_columns[i][j] = m_points[j][i];
+        }
+        for (std::size_t i = dimensions; i < m_columns.size(); i++)
+        {
+            m_columns[i][j] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    m_pSimulation->run(m_points.size(), steps);
+}
+
+std::vector< std::vector<double> > ParameterSweep::points(const Spec& spec)
+{
+    const std::vector<Dimension>& dims = spec.dimensions;
+    const std::size_t n = dims.size();
+    if (n == 0)
+    {
+        throw std::invalid_argument("Spec has no dimensions");
+    }
+
+    std::vector< std::vector<double> > result;
+    if (spec.sampling == eGrid)
+    {
+        std::size_t total = 1;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            total *= dims[i].levels;
+        }
+
+        // The last dimension varies fastest
+        result.resize(total, std::vector<double>(n));
+        for (std::size_t k = 0; k < total; k++)
+        {
+            std::size_t rest = k;
+            for (std::size_t i = n; i-- > 0; )
+            {
+                const std::size_t level = rest % dims[i].levels;
+                rest /= dims[i].levels;
+                const double t = (dims[i].levels > 1) ?
+                    static_cast<double>(level) / (dims[i].levels - 1) : 0.0;
+                result[k][i] = valueAt(dims[i], t);
+            }
+        }
+    }
+    else
+    {
+        const std::size_t total = spec.samples;
+        if (total == 0)
+        {
+            throw std::invalid_argument("Latin hypercube has no samples");
+        }
+
+        // Each dimension visits its strata in a random order, at a
+        // random place within each
+        tgRandom random(spec.seed);
+        result.resize(total, std::vector<double>(n));
+        std::vector<std::size_t> strata(total);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            for (std::size_t k = 0; k < total; k++)
+            {
+                strata[k] = k;
+            }
+            for (std::size_t k = total - 1; k > 0; k--)
+            {
+                std::swap(strata[k], strata[random.index(k + 1)]);
+            }
+            for (std::size_t k = 0; k < total; k++)
+            {
+                const double t = (strata[k] + random.uniform()) / total;
+                result[k][i] = valueAt(dims[i], t);
+            }
+        }
+    }
+    return result;
+}
+
+const std::vector<double>& ParameterSweep::getColumn(std::size_t i) const
+{
+    if (i >= m_columns.size())
+    {
+        throw std::out_of_range("No column at that index");
+    }
+    return m_columns[i];
+}
+
+void ParameterSweep::writeCsv(const std::string& path) const
+{
+    std::ofstream file(path.c_str());
+    if (!file)
+    {
+        throw std::runtime_error("Cannot write sweep results " + path);
+    }
+
+    file.precision(std::numeric_limits<double>::digits10 + 2);
+    for (std::size_t i = 0; i < m_columnNames.size(); i++)
+    {
+        file << (i == 0 ? "" : ",") << m_columnNames[i];
+    }
+    file << std::endl;
+    for (std::size_t j = 0; j < m_points.size(); j++)
+    {
+        for (std::size_t i = 0; i < m_columns.size(); i++)
+        {
+            file << (i == 0 ? "" : ",") << m_columns[i][j];
+        }
+        file << std::endl;
+    }
+    if (!file)
+    {
+        throw std::runtime_error("Cannot write sweep results " + path);
+    }
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef PARAMETER_SWEEP_H_
+#define PARAMETER_SWEEP_H_
+
+/**
+ * @file ParameterSweep.h
+ * @brief Contains the definition of class ParameterSweep, which runs a
+ * sensitivity study over a grid or Latin hypercube in one process.
+ * $Id$
+ */
+
+#include "core/tgParallelSimulation.h"
+
+#include <string>
+#include <vector>
+
+class tgGround;
+class tgSimulation;
+class tgStopPredicate;
+
+/**
+ * Runs one trial per point of a parameter space in parallel worlds and
+ * collects the parameters and results in one table, in place of an app
+ * launched per point with its own JSON file.
+ *
+ * Each world is built once by its Study, typically from a
+ * tgModelTemplate, and restored to its state after setup before every
+ * trial (tgParallelSimulation::Config::restoreSnapshot). The Study then
+ * applies the point to the live models, for example through
+ * tgSpringCableActuator::setParameters and the controllers' setters,
+ * so nothing is rebuilt between points.
+ *
+ * The table has a column for each dimension, then one for each result,
+ * and a row for each point, in the order of getPoints. Rows of trials
+ * that threw are left NaN.
+ */
+class ParameterSweep
+{
+public:
+
+    enum Sampling
+    {
+        /** Every combination of the dimensions' levels */
+        eGrid,
+        /** Spec::samples points, one in each stratum of every dimension */
+        eLatinHypercube
+    };
+
+    /** One swept parameter */
+    struct Dimension
+    {
+        /**
+         * @throw std::invalid_argument if max is below min, levels is
+         * zero, or a log scale range is not positive
+         */
+        Dimension(const std::string& n, double lo, double hi,
+                  std::size_t l = 2, bool lg = false);
+
+        /** The column name, e.g. "stiffness" */
+        std::string name;
+
+        double min;
+        double max;
+
+        /**
+         * Evenly spaced values from min to max on a grid; a single
+         * level is min. Ignored by eLatinHypercube.
+         */
+        std::size_t levels;
+
+        /** Space the values evenly in log(value) */
+        bool logScale;
+    };
+
+    /** What to sweep. This is Plain Old Data. */
+    struct Spec
+    {
+        Spec(Sampling s = eGrid, std::size_t n = 0, unsigned long sd = 0);
+
+        /**
+         * Read a spec from a text file. Blank lines and lines starting
+         * with # are skipped. A line "sampling grid" or
+         * "sampling latin <samples> [<seed>]" sets the sampling, and
+         * every other line is a dimension:
+         * "<name> <min> <max> [<levels>] [log]".
+         * @throw std::runtime_error if the file cannot be read or a line
+         * cannot be parsed
+         */
+        static Spec readFile(const std::string& path);
+
+        std::vector<Dimension> dimensions;
+
+        Sampling sampling;
+
+        /** The points of eLatinHypercube */
+        std::size_t samples;
+
+        /** Seeds the strata permutations of eLatinHypercube */
+        unsigned long seed;
+    };
+
+    /**
+     * The application side of one world. Called from one worker thread
+     * at a time, as a tgParallelSimulation::Episode is.
+     */
+    class Study
+    {
+    public:
+
+        virtual ~Study() { }
+
+        /**
+         * Create the ground of this study's world, which takes
+         * ownership. The default, NULL, gives a tgBoxGround.
+         */
+        virtual tgGround* createGround()
+        {
+            return NULL;
+        }
+
+        /**
+         * Create the models and add them to the simulation. Called once,
+         * before the world's first point.
+         */
+        virtual void setup(tgSimulation& simulation) = 0;
+
+        /**
+         * Apply a point to the live models, which have just been
+         * restored to their state after setup.
+         * @param[in] point a value for each dimension, in order
+         */
+        virtual void apply(const std::vector<double>& point) = 0;
+
+        /**
+         * The predicates that may end the coming trial early. The
+         * default is none.
+         */
+        virtual std::vector<tgStopPredicate*> getStopPredicates()
+        {
+            return std::vector<tgStopPredicate*>();
+        }
+
+        /**
+         * Measure the trial that has just run.
+         * @param[out] results one value for each result name, in order
+         */
+        virtual void measure(std::vector<double>& results) = 0;
+    };
+
+    /**
+     * Start the worlds' threads. The worlds are built on the first run.
+     * @param[in] spec the parameter space; must have a dimension
+     * @param[in] resultNames the column names of Study::measure's values
+     * @param[in] config of the worlds; restoreSnapshot is turned on
+     * @param[in] studies one per world; must not be empty and must
+     * outlive this object. We do not take ownership.
+     * @throw std::invalid_argument if spec has no dimension or no
+     * points, or there are no studies
+     */
+    ParameterSweep(const Spec& spec,
+                   const std::vector<std::string>& resultNames,
+                   const tgParallelSimulation::Config& config,
+                   const std::vector<Study*>& studies);
+
+    ~ParameterSweep();
+
+    /**
+     * Run every point, blocking until they have finished. Running again
+     * overwrites the table.
+     * @param[in] steps the steps of each trial, must be positive
+     * @throw std::runtime_error if a trial threw; the other points still
+     * run
+     */
+    void run(int steps);
+
+    /** The points of a spec, one value per dimension, in table order */
+    static std::vector< std::vector<double> > points(const Spec& spec);
+
+    const std::vector< std::vector<double> >& getPoints() const
+    {
+        return m_points;
+    }
+
+    /** The dimension names, then the result names */
+    const std::vector<std::string>& getColumnNames() const
+    {
+        return m_columnNames;
+    }
+
+    /** A column of the table, one value per point */
+    const std::vector<double>& getColumn(std::size_t i) const;
+
+    /**
+     * Write the table as CSV, with a header line of column names.
+     * @throw std::runtime_error if the file cannot be written
+     */
+    void writeCsv(const std::string& path) const;
+
+private:
+
+    /** Adapts a Study to tgParallelSimulation */
+    class StudyEpisode;
+
+    /** Not copyable */
+    ParameterSweep(const ParameterSweep&);
+    ParameterSweep& operator=(const ParameterSweep&);
+
+private:
+
+    const std::vector< std::vector<double> > m_points;
+
+    std::vector<std::string> m_columnNames;
+
+    /** Each trial writes its own row, so no lock is needed */
+    std::vector< std::vector<double> > m_columns;
+
+    /** We own these */
+    std::vector<StudyEpisode*> m_episodes;
+
+    tgParallelSimulation* m_pSimulation;
+};
+
+#endif  // PARAMETER_SWEEP_H_
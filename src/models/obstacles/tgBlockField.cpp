@@ -26,18 +26,98 @@
 #include "tgBlockField.h"
 // This library
 #include "core/tgBox.h"
+#include "core/tgRandom.h"
 #include "tgcreator/tgBuildSpec.h"
 #include "tgcreator/tgBoxInfo.h"
+#include "tgcreator/tgModelTemplate.h"
 #include "tgcreator/tgStructure.h"
-#include "tgcreator/tgStructureInfo.h"
 #include "tgcreator/tgNode.h"
 #include "tgcreator/tgUtil.h"
 // The Bullet Physics library
 #include "LinearMath/btVector3.h"
 // The C++ Standard Library
+#include <map>
 #include <stdexcept>
 #include <vector>
-#include <numeric> // RAND_MAX
+// POSIX
+#include <pthread.h>
+
+namespace
+{
+    /** What the block positions depend on */
+    struct FieldKey
+    {
+        FieldKey(const tgBlockField::Config& config) :
+            minPos(config.m_minPos),
+            maxPos(config.m_maxPos),
+            nBlocks(config.m_nBlocks),
+            seed(config.m_seed)
+        {
+        }
+
+        bool operator<(const FieldKey& other) const
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                if (minPos[i] != other.minPos[i])
+                {
+                    return minPos[i] < other.minPos[i];
+                }
+                if (maxPos[i] != other.maxPos[i])
+                {
+                    return maxPos[i] < other.maxPos[i];
+                }
+            }
+            if (nBlocks != other.nBlocks)
+            {
+                return nBlocks < other.nBlocks;
+            }
+            return seed < other.seed;
+        }
+
+        btVector3 minPos;
+        btVector3 maxPos;
+        size_t nBlocks;
+        unsigned long seed;
+    };
+
+    typedef std::map<FieldKey, std::vector<btVector3> > FieldCache;
+
+    /** Fields are set up by tgParallelSimulation threads at once */
+    pthread_mutex_t s_fieldMutex = PTHREAD_MUTEX_INITIALIZER;
+
+    /**
+     * The corner of each block, before the field is moved to its origin.
+     * Entries are never removed, so the reference stays valid.
+     */
+    const std::vector<btVector3>& blockPositions(const tgBlockField::Config& config)
+    {
+        static FieldCache fields;
+
+        const FieldKey key(config);
+        pthread_mutex_lock(&s_fieldMutex);
+        FieldCache::iterator it = fields.find(key);
+        if (it == fields.end())
+        {
+            std::vector<btVector3> positions;
+            positions.reserve(config.m_nBlocks);
+            
+            tgRandom random(config.m_seed);
+            const btVector3 fieldSize = config.m_maxPos - config.m_minPos;
+            for (size_t i = 0; i < config.m_nBlocks; i++)
+            {
+                double xOffset = fieldSize.getX() * random.uniform();
+                double yOffset = fieldSize.getY() * random.uniform();
+                double zOffset = fieldSize.getZ() * random.uniform();
+                
+                positions.push_back(config.m_minPos + btVector3(xOffset, yOffset, zOffset));
+            }
+            it = fields.insert(std::make_pair(key, positions)).first;
+        }
+        pthread_mutex_unlock(&s_fieldMutex);
+        return it->second;
+    }
+}
 
 tgBlockField::Config::Config(btVector3 origin,
                              btScalar friction, 
@@ -47,7 +127,9 @@ tgBlockField::Config::Config(btVector3 origin,
                              size_t nBlocks, 
                              double blockLength, 
                              double blockWidth, 
-                             double blockHeight) :
+                             double blockHeight,
+                             bool merged,
+                             unsigned long seed) :
 m_origin(origin),
 m_friction(friction),
 m_restitution(restitution),
@@ -56,7 +138,9 @@ m_maxPos(maxPos),
 m_nBlocks(nBlocks),
 m_length(blockLength),
 m_width(blockWidth),
-m_height(blockHeight)
+m_height(blockHeight),
+m_merged(merged),
+m_seed(seed)
 {
     assert(m_friction >= 0.0);
     assert(m_restitution >= 0.0);
@@ -68,41 +152,57 @@ m_height(blockHeight)
 
 tgBlockField::tgBlockField() : 
 tgModel(),
-m_config()
+m_config(),
+m_pStructure(NULL),
+m_pSpec(NULL),
+m_pTemplate(NULL)
 {
-    // Seed the random number generator
-    /// @todo assess if doing this multiple times in a trial (here and evolution) causes problems
-    tgUtil::seedRandom(1);
 }
 
 tgBlockField::tgBlockField(tgBlockField::Config& config) :
 tgModel(),
-m_config(config)
+m_config(config),
+m_pStructure(NULL),
+m_pSpec(NULL),
+m_pTemplate(NULL)
 {
-    // Seed the random number generator
-    /// @todo assess if doing this multiple times in a trial (here and evolution) causes problems
-    tgUtil::seedRandom(1);
 }
 
-tgBlockField::~tgBlockField() {}
+tgBlockField::~tgBlockField() {
+    delete m_pTemplate;
+    delete m_pSpec;
+    delete m_pStructure;
+}
                      
-void tgBlockField::setup(tgWorld& world) {
+void tgBlockField::prepare() {
+    if (m_pTemplate != NULL) {
+        return;
+    }
+
     // Density and roll friction are set to zero (respectively)
     const tgBox::Config boxConfig(m_config.m_width / 2.0, m_config.m_height / 2.0, 0.0, m_config.m_friction, 0.0, m_config.m_restitution);
 
     // Start creating the structure
-    tgStructure s;
-    addNodes(s);
+    m_pStructure = new tgStructure();
+    addNodes(*m_pStructure);
 
     // Create the build spec that uses tags to turn the structure into a real model
-    tgBuildSpec spec;
-    spec.addBuilder("box", new tgBoxInfo(boxConfig));
+    m_pSpec = new tgBuildSpec();
+    m_pSpec->addBuilder("box", new tgBoxInfo(boxConfig));
+
+    // Resolve it once, without a world
+    m_pTemplate = new tgModelTemplate(*m_pStructure, *m_pSpec, m_config.m_merged);
+}
 
-    // Create your structureInfo
-    tgStructureInfo structureInfo(s, spec);
+void tgBlockField::setup(tgWorld& world) {
+    // Does nothing if tgSimulation has already prepared us
+    prepare();
 
-    // Use the structureInfo to build ourselves
-    structureInfo.buildInto(*this, world);
+    // Use the template to build ourselves
+    m_pTemplate->instantiate(*this, world);
+
+    // Boxes, with nothing to step
+    setStatic(true);
 
     // Actually setup the children
     tgModel::setup(world);
@@ -129,21 +229,15 @@ void tgBlockField::teardown() {
 // Nodes: center points of opposing faces of rectangles
 void tgBlockField::addNodes(tgStructure& s) {
     
-    btVector3 fieldSize = m_config.m_maxPos - m_config.m_minPos;
+    const std::vector<btVector3>& positions = blockPositions(m_config);
     
-    for(size_t i = 0; i < 2 * m_config.m_nBlocks; i += 2) {
-        double xOffset = fieldSize.getX() * rand() / RAND_MAX;
-        double yOffset = fieldSize.getY() * rand() / RAND_MAX;
-        double zOffset = fieldSize.getZ() * rand() / RAND_MAX;
-        
-        btVector3 offset(xOffset, yOffset, zOffset);
-        
-        tgNode position = m_config.m_minPos + offset;
+    for(size_t i = 0; i < positions.size(); i++) {
+        tgNode position = positions[i];
         s.addNode(position);
         position += btVector3(0.0, 0.0, m_config.m_length);
         s.addNode(position);
         
-        s.addPair(i, i+1, "box");
+        s.addPair(2 * i, 2 * i + 1, "box");
     }
 
     s.move(m_config.m_origin); // Set center of field to desired origin position
@@ -37,11 +37,16 @@
 
 // Forward declarations
 class tgModelVisitor;
+class tgBuildSpec;
+class tgModelTemplate;
 class tgStructure;
 class tgWorld;
 
 /**
- * Class that creates a number of boxes strewn about an area
+ * Class that creates a number of boxes strewn about an area. The block
+ * positions are generated once per seed and placement parameters and
+ * kept for the rest of the process, so resets and parallel worlds reuse
+ * them rather than drawing them again.
  * @todo Add parameters to vary the size and rotation of the boxes
  */
 class tgBlockField : public tgModel
@@ -59,7 +64,9 @@ public:
                     size_t nBlocks = 500,
                     double blockLength = 5.0,
                     double blockWidth = 5.0,
-                    double blockHeight = 5.0);
+                    double blockHeight = 5.0,
+                    bool merged = false,
+                    unsigned long seed = 1);
 
             /** Origin position of the block field */
             btVector3 m_origin;
@@ -87,6 +94,18 @@ public:
             
             /** Height of the blocks */
             double m_height;
+            
+            /**
+             * Build the blocks as one static compound body, so a large
+             * field is a single broadphase proxy
+             */
+            bool m_merged;
+            
+            /**
+             * Places the blocks. The same seed and placement parameters
+             * give the same field on every setup, in every world
+             */
+            unsigned long m_seed;
     };
     
    /**
@@ -112,6 +131,12 @@ public:
         */
     virtual void setup(tgWorld& world);
 
+    /**
+        * Build and resolve the boxes, once; every setup after builds
+        * them from the same template.
+        */
+    virtual void prepare();
+
     /**
         * Step the model, its children. Notifies controllers of step.
         * @param[in] dt, the timestep. Must be positive.
@@ -145,6 +170,11 @@ private:
     
     tgBlockField::Config m_config;
 
+    /** Made by prepare and kept for every later setup */
+    tgStructure* m_pStructure;
+    tgBuildSpec* m_pSpec;
+    tgModelTemplate* m_pTemplate;
+
 };
 
 #endif // TETRA_COLLISIONS_WALL
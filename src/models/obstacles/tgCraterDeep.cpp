@@ -59,12 +59,12 @@ namespace
     };
 } // namespace
 
-tgCraterDeep::tgCraterDeep() : tgModel() 
+tgCraterDeep::tgCraterDeep() : tgModel(), m_merged(false) 
 {
     origin = btVector3(0,0,0);
 }
 
-tgCraterDeep::tgCraterDeep(btVector3 center) : tgModel() 
+tgCraterDeep::tgCraterDeep(btVector3 center, bool merged) : tgModel(), m_merged(merged) 
 {
     origin = btVector3(center.getX(), center.getY(), center.getZ());
 }
@@ -87,6 +87,7 @@ void tgCraterDeep::setup(tgWorld& world) {
 
     // Create your structureInfo
     tgStructureInfo structureInfo(s, spec);
+    structureInfo.setMergeRigids(m_merged);
 
     // Use the structureInfo to build ourselves
     structureInfo.buildInto(*this, world);
@@ -94,6 +95,9 @@ void tgCraterDeep::setup(tgWorld& world) {
     // call the onSetup methods of all observed things e.g. controllers
     notifySetup();
 
+    // Bullet moves the boxes, so only observers need stepping
+    setStatic(!hasObservers());
+
     // Actually setup the children
     tgModel::setup(world);
 }
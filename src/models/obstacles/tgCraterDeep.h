@@ -56,8 +56,10 @@ class tgCraterDeep : public tgSubject<tgCraterDeep>, public tgModel
         /**
          * Origin constructor. Sets center point to input param 'origin'.
          * @param[in] origin - the center point of the tgCraterDeep object
+         * @param[in] merged - build the boxes as one static compound body
+         * rather than a body each
          */
-        tgCraterDeep(btVector3 origin);
+        tgCraterDeep(btVector3 origin, bool merged = false);
 
         /**
          * Destructor. Deletes controllers, if any were added during setup.
@@ -110,5 +112,6 @@ class tgCraterDeep : public tgSubject<tgCraterDeep>, public tgModel
 
         std::vector <tgNode> nodes;
         btVector3 origin;
+        bool m_merged;
 };
 
@@ -60,11 +60,11 @@ namespace
     };
 } // namespace
 
-tgCraterShallow::tgCraterShallow() : tgModel() {
+tgCraterShallow::tgCraterShallow() : tgModel(), m_merged(false) {
     origin = btVector3(0,0,0);
 }
 
-tgCraterShallow::tgCraterShallow(btVector3 center) : tgModel() {
+tgCraterShallow::tgCraterShallow(btVector3 center, bool merged) : tgModel(), m_merged(merged) {
     origin = btVector3(center.getX(), center.getY(), center.getZ());
 }
 
@@ -83,6 +83,7 @@ void tgCraterShallow::setup(tgWorld& world) {
 
     // Create your structureInfo
     tgStructureInfo structureInfo(s, spec);
+    structureInfo.setMergeRigids(m_merged);
 
     // Use the structureInfo to build ourselves
     structureInfo.buildInto(*this, world);
@@ -90,6 +91,9 @@ void tgCraterShallow::setup(tgWorld& world) {
     // call the onSetup methods of all observed things e.g. controllers
     notifySetup();
 
+    // Bullet moves the boxes, so only observers need stepping
+    setStatic(!hasObservers());
+
     // Actually setup the children
     tgModel::setup(world);
 }
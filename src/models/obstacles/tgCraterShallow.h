@@ -54,8 +54,10 @@ class tgCraterShallow : public tgSubject<tgCraterShallow>, public tgModel
         /**
          * Origin constructor. Sets center point to input param 'origin'.
          * @param[in] origin - the center point of the tgCraterShallow object
+         * @param[in] merged - build the boxes as one static compound body
+         * rather than a body each
          */
-        tgCraterShallow(btVector3 origin);
+        tgCraterShallow(btVector3 origin, bool merged = false);
 
         /**
          * Destructor. Deletes controllers, if any were added during setup.
@@ -108,5 +110,6 @@ class tgCraterShallow : public tgSubject<tgCraterShallow>, public tgModel
 
         std::vector <tgNode> nodes;
         btVector3 origin;
+        bool m_merged;
 };
 
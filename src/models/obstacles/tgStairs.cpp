@@ -28,8 +28,8 @@
 #include "core/tgBox.h"
 #include "tgcreator/tgBuildSpec.h"
 #include "tgcreator/tgBoxInfo.h"
+#include "tgcreator/tgModelTemplate.h"
 #include "tgcreator/tgStructure.h"
-#include "tgcreator/tgStructureInfo.h"
 #include "tgcreator/tgNode.h"
 // The Bullet Physics library
 #include "LinearMath/btVector3.h"
@@ -45,7 +45,8 @@ tgStairs::Config::Config(btVector3 origin,
                              double stairWidth, 
                              double stepWidth, 
                              double stepHeight,
-                             double angle) :
+                             double angle,
+                             bool merged) :
 m_origin(origin),
 m_friction(friction),
 m_restitution(restitution),
@@ -53,7 +54,8 @@ m_nBlocks(nBlocks),
 m_length(stairWidth),
 m_width(stepWidth),
 m_height(stepHeight),
-m_angle(angle)
+m_angle(angle),
+m_merged(merged)
 {
     assert(m_friction >= 0.0);
     assert(m_restitution >= 0.0);
@@ -65,35 +67,57 @@ m_angle(angle)
 
 tgStairs::tgStairs() : 
 tgModel(),
-m_config()
+m_config(),
+m_pStructure(NULL),
+m_pSpec(NULL),
+m_pTemplate(NULL)
 {
 }
 
 tgStairs::tgStairs(tgStairs::Config& config) :
 tgModel(),
-m_config(config)
+m_config(config),
+m_pStructure(NULL),
+m_pSpec(NULL),
+m_pTemplate(NULL)
 {
 }
 
-tgStairs::~tgStairs() {}
+tgStairs::~tgStairs() {
+    delete m_pTemplate;
+    delete m_pSpec;
+    delete m_pStructure;
+}
                      
-void tgStairs::setup(tgWorld& world) {
+void tgStairs::prepare() {
+    if (m_pTemplate != NULL) {
+        return;
+    }
+
     // Density and roll friction are set to zero (respectively)
     const tgBox::Config boxConfig(m_config.m_width / 2.0, m_config.m_height / 2.0, 0.0, m_config.m_friction, 0.0, m_config.m_restitution);
 
     // Start creating the structure
-    tgStructure s;
-    addNodes(s);
+    m_pStructure = new tgStructure();
+    addNodes(*m_pStructure);
 
     // Create the build spec that uses tags to turn the structure into a real model
-    tgBuildSpec spec;
-    spec.addBuilder("box", new tgBoxInfo(boxConfig));
+    m_pSpec = new tgBuildSpec();
+    m_pSpec->addBuilder("box", new tgBoxInfo(boxConfig));
+
+    // Resolve it once, without a world
+    m_pTemplate = new tgModelTemplate(*m_pStructure, *m_pSpec, m_config.m_merged);
+}
+
+void tgStairs::setup(tgWorld& world) {
+    // Does nothing if tgSimulation has already prepared us
+    prepare();
 
-    // Create your structureInfo
-    tgStructureInfo structureInfo(s, spec);
+    // Use the template to build ourselves
+    m_pTemplate->instantiate(*this, world);
 
-    // Use the structureInfo to build ourselves
-    structureInfo.buildInto(*this, world);
+    // Boxes, with nothing to step
+    setStatic(true);
 
     // Actually setup the children
     tgModel::setup(world);
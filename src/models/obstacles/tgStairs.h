@@ -37,6 +37,8 @@
 
 // Forward declarations
 class tgModelVisitor;
+class tgBuildSpec;
+class tgModelTemplate;
 class tgStructure;
 class tgWorld;
 
@@ -58,7 +60,8 @@ public:
                     double stairWidth = 20.0,
                     double stepWidth = 5.0,
                     double stepHeight = 1.0,
-                    double angle = 0.0);
+                    double angle = 0.0,
+                    bool merged = false);
 
             /** Origin position of the block field */
             btVector3 m_origin;
@@ -83,6 +86,9 @@ public:
             
             /** Angle of the stairs in the xz plane. Default has the stairs ascending along the +z direction */
             double m_angle;
+            
+            /** Build the steps as one static compound body */
+            bool m_merged;
     };
     
    /**
@@ -108,6 +114,12 @@ public:
         */
     virtual void setup(tgWorld& world);
 
+    /**
+        * Build and resolve the boxes, once; every setup after builds
+        * them from the same template.
+        */
+    virtual void prepare();
+
     /**
         * Step the model, its children. Notifies controllers of step.
         * @param[in] dt, the timestep. Must be positive.
@@ -141,6 +153,11 @@ private:
     
     tgStairs::Config m_config;
 
+    /** Made by prepare and kept for every later setup */
+    tgStructure* m_pStructure;
+    tgBuildSpec* m_pSpec;
+    tgModelTemplate* m_pTemplate;
+
 };
 
 #endif // TETRA_COLLISIONS_WALL
@@ -59,11 +59,11 @@ namespace
     };
 } // namespace
 
-Wall::Wall() : tgModel() {
+Wall::Wall() : tgModel(), m_merged(false) {
     origin = btVector3(0,0,0);
 }
 
-Wall::Wall(btVector3 center) : tgModel() {
+Wall::Wall(btVector3 center, bool merged) : tgModel(), m_merged(merged) {
     origin = btVector3(center.getX(), center.getY(), center.getZ());
 }
 
@@ -82,6 +82,7 @@ void Wall::setup(tgWorld& world) {
 
     // Create your structureInfo
     tgStructureInfo structureInfo(s, spec);
+    structureInfo.setMergeRigids(m_merged);
 
     // Use the structureInfo to build ourselves
     structureInfo.buildInto(*this, world);
@@ -89,6 +90,9 @@ void Wall::setup(tgWorld& world) {
     // call the onSetup methods of all observed things e.g. controllers
     notifySetup();
 
+    // Bullet moves the boxes, so only observers need stepping
+    setStatic(!hasObservers());
+
     // Actually setup the children
     tgModel::setup(world);
 }
@@ -54,8 +54,10 @@ class Wall : public tgSubject<Wall>, public tgModel
         /**
          * Origin constructor. Sets center point to input param 'origin'.
          * @param[in] origin - the center point of the Wall object
+         * @param[in] merged - build the boxes as one static compound body
+         * rather than a body each
          */
-        Wall(btVector3 origin);
+        Wall(btVector3 origin, bool merged = false);
 
         /**
          * Destructor. Deletes controllers, if any were added during setup.
@@ -108,6 +110,7 @@ class Wall : public tgSubject<Wall>, public tgModel
 
         std::vector <tgNode> nodes;
         btVector3 origin;
+        bool m_merged;
 };
 
 #endif // TETRA_COLLISIONS_WALL
@@ -0,0 +1,307 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file ntrtModule.cpp
+ * @brief The pybind11 bindings of the ntrt Python module
+ * $Id$
+ */
+
+// This library
+#include "tgEnv.h"
+#include "tgVecEnv.h"
+// This application
+#include "core/tgSimulation.h"
+#include "core/tgSpringCableActuator.h"
+#include "core/tgWorld.h"
+// pybind11
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+// The C++ Standard Library
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace
+{
+    /**
+     * A NumPy view over memory owned by an object, which the view keeps
+     * alive. Read-only views fail on assignment rather than silently
+     * writing into the simulator's buffers.
+     * @param[in] shape the row-major shape of the data
+     */
+    template <typename T>
+    py::array_t<T> viewOf(const py::object& owner, const T* data,
+                          const std::vector<py::ssize_t>& shape, bool writeable)
+    {
+        std::vector<py::ssize_t> strides(shape.size(), sizeof(T));
+        for (std::size_t i = shape.size(); i > 1; i--)
+        {
+            strides[i - 2] = strides[i - 1] * shape[i - 1];
+        }
+        py::array_t<T> view(shape, strides, data, owner);
+        if (!writeable)
+        {
+            view.attr("flags").attr("writeable") = false;
+        }
+        return view;
+    }
+
+    template <typename T>
+    py::array_t<T> viewOf(const py::object& owner, const T* data,
+                          std::size_t size, bool writeable)
+    {
+        return viewOf(owner, data,
+                      std::vector<py::ssize_t>(1, static_cast<py::ssize_t>(size)),
+                      writeable);
+    }
+
+    /** A C-contiguous array of doubles of a given size, or an exception */
+    py::array_t<double, py::array::c_style | py::array::forcecast>
+    actionsOf(const py::object& actions, std::size_t size)
+    {
+        py::array_t<double, py::array::c_style | py::array::forcecast> a =
+            py::array_t<double, py::array::c_style | py::array::forcecast>::ensure(actions);
+        if (!a || static_cast<std::size_t>(a.size()) != size)
+        {
+            throw std::invalid_argument("Expected one action per actuator");
+        }
+        return a;
+    }
+
+    py::array_t<double> observationOf(const py::object& self)
+    {
+        const tgEnv& env = self.cast<const tgEnv&>();
+        return viewOf(self, env.getObservation(), env.getObservationSize(), false);
+    }
+
+    py::array_t<double> reset(const py::object& self)
+    {
+        {
+            tgEnv& env = self.cast<tgEnv&>();
+            py::gil_scoped_release release;
+            env.reset();
+        }
+        return observationOf(self);
+    }
+
+    py::array_t<double> step(const py::object& self, const py::object& actions)
+    {
+        tgEnv& env = self.cast<tgEnv&>();
+        // Copied into the command buffer unless they are that buffer,
+        // as given by the commands property
+        if (!actions.is_none())
+        {
+            py::array_t<double, py::array::c_style | py::array::forcecast> a =
+                actionsOf(actions, env.getNumActuators());
+            const double* const data = a.data();
+            py::gil_scoped_release release;
+            env.step(data);
+        }
+        else
+        {
+            py::gil_scoped_release release;
+            env.step();
+        }
+        return observationOf(self);
+    }
+
+    std::vector<py::ssize_t> shapeOf(std::size_t rows, std::size_t cols)
+    {
+        std::vector<py::ssize_t> shape;
+        shape.push_back(static_cast<py::ssize_t>(rows));
+        shape.push_back(static_cast<py::ssize_t>(cols));
+        return shape;
+    }
+
+    py::array_t<double> observationsOf(const py::object& self)
+    {
+        const tgVecEnv& vecEnv = self.cast<const tgVecEnv&>();
+        return viewOf(self, vecEnv.getObservations(),
+                      shapeOf(vecEnv.size(), vecEnv.getObservationSize()), false);
+    }
+
+    /** (observations, terminated, truncated), as views */
+    py::tuple stepResultOf(const py::object& self)
+    {
+        const tgVecEnv& vecEnv = self.cast<const tgVecEnv&>();
+        return py::make_tuple(
+            observationsOf(self),
+            viewOf(self, vecEnv.getTerminated(), vecEnv.size(), false),
+            viewOf(self, vecEnv.getTruncated(), vecEnv.size(), false));
+    }
+
+    py::array_t<double> resetVec(const py::object& self)
+    {
+        {
+            tgVecEnv& vecEnv = self.cast<tgVecEnv&>();
+            py::gil_scoped_release release;
+            vecEnv.reset();
+        }
+        return observationsOf(self);
+    }
+
+    py::tuple stepVec(const py::object& self, const py::object& actions)
+    {
+        tgVecEnv& vecEnv = self.cast<tgVecEnv&>();
+        if (!actions.is_none())
+        {
+            py::array_t<double, py::array::c_style | py::array::forcecast> a =
+                actionsOf(actions, vecEnv.size() * vecEnv.getNumActuators());
+            const double* const data = a.data();
+            py::gil_scoped_release release;
+            vecEnv.step(data);
+        }
+        else
+        {
+            py::gil_scoped_release release;
+            vecEnv.step();
+        }
+        return stepResultOf(self);
+    }
+}
+
+PYBIND11_MODULE(ntrt, m)
+{
+    m.doc() = "Headless NTRT simulation for reinforcement learning";
+
+    py::class_<tgWorld::Config>(m, "WorldConfig")
+        .def(py::init<>())
+        .def_readwrite("gravity", &tgWorld::Config::gravity)
+        .def_readwrite("worldSize", &tgWorld::Config::worldSize)
+        .def_readwrite("batchCableForces", &tgWorld::Config::batchCableForces)
+        .def_readwrite("solverIterations", &tgWorld::Config::solverIterations)
+        .def_readwrite("maxBroadphaseHandles", &tgWorld::Config::maxBroadphaseHandles)
+        .def_readwrite("numThreads", &tgWorld::Config::numThreads)
+        .def_readwrite("cableSubsteps", &tgWorld::Config::cableSubsteps)
+        .def_readwrite("collisionInterval", &tgWorld::Config::collisionInterval)
+        .def_readwrite("cableWakeImpulse", &tgWorld::Config::cableWakeImpulse)
+        .def_readwrite("minSolverIterations", &tgWorld::Config::minSolverIterations)
+        .def_readwrite("penetrationTolerance", &tgWorld::Config::penetrationTolerance)
+        .def_readwrite("cableThreads", &tgWorld::Config::cableThreads)
+        .def_readwrite("cableCollisionCell", &tgWorld::Config::cableCollisionCell);
+
+    py::class_<tgEnv::Config>(m, "EnvConfig")
+        .def(py::init<const tgWorld::Config&, double, int, bool, bool>(),
+             py::arg("worldConfig") = tgWorld::Config(),
+             py::arg("stepSize") = 1.0/1000.0,
+             py::arg("stepsPerAction") = 1,
+             py::arg("senseRods") = true,
+             py::arg("senseActuators") = true)
+        .def_readonly("worldConfig", &tgEnv::Config::worldConfig)
+        .def_readonly("stepSize", &tgEnv::Config::stepSize)
+        .def_readonly("stepsPerAction", &tgEnv::Config::stepsPerAction)
+        .def_readonly("senseRods", &tgEnv::Config::senseRods)
+        .def_readonly("senseActuators", &tgEnv::Config::senseActuators);
+
+    py::class_<tgWorld>(m, "World")
+        .def("getConfig", &tgWorld::getConfig, py::return_value_policy::reference_internal)
+        .def("getWorldGravity", &tgWorld::getWorldGravity);
+
+    py::class_<tgSimulation>(m, "Simulation")
+        .def("step", &tgSimulation::step, py::arg("dt"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("run", static_cast<void (tgSimulation::*)(int) const>(&tgSimulation::run),
+             py::arg("steps"), py::call_guard<py::gil_scoped_release>())
+        .def("getWorld", &tgSimulation::getWorld, py::return_value_policy::reference_internal)
+        .def("recordCommands", &tgSimulation::recordCommands, py::arg("fileName"))
+        .def("replayCommands", &tgSimulation::replayCommands, py::arg("fileName"))
+        .def("stopCommandLog", &tgSimulation::stopCommandLog)
+        .def("isReplaying", &tgSimulation::isReplaying);
+
+    py::class_<tgSpringCableActuator>(m, "SpringCableActuator")
+        .def("getTags", [](const tgSpringCableActuator& a) {
+            const std::deque<std::string>& tags = a.getTags().getTags();
+            return std::vector<std::string>(tags.begin(), tags.end());
+        })
+        .def("getRestLength", &tgSpringCableActuator::getRestLength)
+        .def("getCurrentLength", &tgSpringCableActuator::getCurrentLength)
+        .def("getTension", &tgSpringCableActuator::getTension)
+        .def("getVelocity", &tgSpringCableActuator::getVelocity)
+        .def("setControlInput", [](tgSpringCableActuator& a, double input) {
+            a.setControlInput(input);
+        });
+
+    py::class_<tgEnv>(m, "Env")
+        .def(py::init<const std::string&, const tgEnv::Config&>(),
+             py::arg("structurePath"), py::arg("config") = tgEnv::Config())
+        .def("reset", &reset)
+        .def("step", &step, py::arg("actions") = py::none())
+        .def_property_readonly("observation", &observationOf)
+        .def_property_readonly("commands", [](const py::object& self) {
+            tgEnv& env = self.cast<tgEnv&>();
+            return viewOf(self, env.getCommands(), env.getNumActuators(), true);
+        })
+        .def_property_readonly("numActuators", &tgEnv::getNumActuators)
+        .def_property_readonly("observationSize", &tgEnv::getObservationSize)
+        .def_property_readonly("observationHeadings", &tgEnv::getObservationHeadings)
+        .def_property_readonly("actuators", &tgEnv::getActuators,
+                               py::return_value_policy::reference_internal)
+        .def_property_readonly("time", &tgEnv::getTime)
+        .def_property_readonly("steps", &tgEnv::getSteps)
+        .def_property_readonly("config", &tgEnv::getConfig,
+                               py::return_value_policy::reference_internal)
+        .def_property_readonly("simulation", &tgEnv::getSimulation,
+                               py::return_value_policy::reference_internal);
+
+    py::class_<tgVecEnv::Config>(m, "VecEnvConfig")
+        .def(py::init<const tgEnv::Config&, std::size_t, bool, int>(),
+             py::arg("envConfig") = tgEnv::Config(),
+             py::arg("maxEpisodeSteps") = 0,
+             py::arg("stopOnDivergence") = true,
+             py::arg("numThreads") = 0)
+        .def_readonly("envConfig", &tgVecEnv::Config::envConfig)
+        .def_readonly("maxEpisodeSteps", &tgVecEnv::Config::maxEpisodeSteps)
+        .def_readonly("stopOnDivergence", &tgVecEnv::Config::stopOnDivergence)
+        .def_readonly("numThreads", &tgVecEnv::Config::numThreads);
+
+    py::class_<tgVecEnv>(m, "VecEnv")
+        .def(py::init<const std::string&, std::size_t, const tgVecEnv::Config&>(),
+             py::arg("structurePath"), py::arg("numEnvs"),
+             py::arg("config") = tgVecEnv::Config())
+        .def("reset", &resetVec)
+        .def("step", &stepVec, py::arg("actions") = py::none())
+        .def("__len__", &tgVecEnv::size)
+        .def_property_readonly("observations", &observationsOf)
+        .def_property_readonly("finalObservations", [](const py::object& self) {
+            const tgVecEnv& vecEnv = self.cast<const tgVecEnv&>();
+            return viewOf(self, vecEnv.getFinalObservations(),
+                          shapeOf(vecEnv.size(), vecEnv.getObservationSize()), false);
+        })
+        .def_property_readonly("commands", [](const py::object& self) {
+            tgVecEnv& vecEnv = self.cast<tgVecEnv&>();
+            return viewOf(self, static_cast<const double*>(vecEnv.getCommands()),
+                          shapeOf(vecEnv.size(), vecEnv.getNumActuators()), true);
+        })
+        .def_property_readonly("episodeSteps", [](const py::object& self) {
+            const tgVecEnv& vecEnv = self.cast<const tgVecEnv&>();
+            return viewOf(self, vecEnv.getEpisodeSteps(), vecEnv.size(), false);
+        })
+        .def_property_readonly("numActuators", &tgVecEnv::getNumActuators)
+        .def_property_readonly("observationSize", &tgVecEnv::getObservationSize)
+        .def_property_readonly("observationHeadings", [](const tgVecEnv& vecEnv) {
+            return vecEnv.getEnv(0).getObservationHeadings();
+        })
+        .def_property_readonly("config", &tgVecEnv::getConfig,
+                               py::return_value_policy::reference_internal);
+}
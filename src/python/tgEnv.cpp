@@ -0,0 +1,176 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgEnv.cpp
+ * @brief Contains the definitions of members of class tgEnv
+ * $Id$
+ */
+
+// This module
+#include "tgEnv.h"
+// This application
+#include "core/tgBasicActuator.h"
+#include "core/tgCast.h"
+#include "core/tgSimulation.h"
+#include "core/tgSimView.h"
+#include "core/tgSpringCableActuator.h"
+#include "sensors/tgDataManager.h"
+#include "sensors/tgRodSensorInfo.h"
+#include "sensors/tgSpringCableActuatorSensorInfo.h"
+#include "yamlbuilder/TensegrityModel.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+tgEnv::Config::Config(const tgWorld::Config& wc, double ss, int spa,
+                      bool sr, bool sa) :
+worldConfig(wc),
+stepSize(ss),
+stepsPerAction(spa),
+senseRods(sr),
+senseActuators(sa)
+{
+    if (ss <= 0.0)
+    {
+        throw std::invalid_argument("stepSize is not positive");
+    }
+    if (spa <= 0)
+    {
+        throw std::invalid_argument("stepsPerAction is not positive");
+    }
+}
+
+tgEnv::tgEnv(const std::string& structurePath, const Config& config) :
+m_config(config),
+m_pWorld(new tgWorld(config.worldConfig)),
+m_pView(new tgSimView(*m_pWorld, config.stepSize, config.stepSize)),
+m_pSimulation(new tgSimulation(*m_pView)),
+m_pModel(new TensegrityModel(structurePath)),
+m_pDataManager(new tgDataManager()),
+m_time(0.0),
+m_steps(0)
+{
+    // The simulation deletes the model and data manager
+    m_pSimulation->addModel(m_pModel);
+
+    if (m_config.senseRods)
+    {
+        m_pDataManager->addSensorInfo(new tgRodSensorInfo());
+    }
+    if (m_config.senseActuators)
+    {
+        m_pDataManager->addSensorInfo(new tgSpringCableActuatorSensorInfo());
+    }
+    m_pDataManager->addSenseable(m_pModel);
+    // Creates the sensors, now that the model is built
+    m_pSimulation->addDataManager(m_pDataManager);
+
+    m_actuators = m_pModel->getAllActuators();
+    for (std::size_t i = 0; i < m_actuators.size(); i++)
+    {
+        m_movesMotors.push_back(
+            tgCast::cast<tgSpringCableActuator, tgBasicActuator>(m_actuators[i]) != NULL);
+    }
+    m_commands.assign(m_actuators.size(), 0.0);
+    m_observation.assign(m_pDataManager->getFrameSize(), 0.0);
+
+    m_pSimulation->snapshot(m_initialState);
+    reset();
+
+    // Postcondition
+    assert(invariant());
+}
+
+tgEnv::~tgEnv()
+{
+    // The simulation tears down and deletes the model
+    delete m_pSimulation;
+    delete m_pView;
+    delete m_pWorld;
+}
+
+const double* tgEnv::reset()
+{
+    m_pSimulation->restore(m_initialState);
+    std::fill(m_commands.begin(), m_commands.end(), 0.0);
+    m_time = 0.0;
+    m_steps = 0;
+    if (!m_observation.empty())
+    {
+        m_pDataManager->sampleFrameInto(&m_observation[0]);
+    }
+    return getObservation();
+}
+
+const double* tgEnv::step()
+{
+    for (int i = 0; i < m_config.stepsPerAction; i++)
+    {
+        applyCommands();
+        m_pSimulation->step(m_config.stepSize);
+    }
+    m_time += m_config.stepSize * m_config.stepsPerAction;
+    m_steps++;
+    if (!m_observation.empty())
+    {
+        m_pDataManager->sampleFrameInto(&m_observation[0]);
+    }
+    return getObservation();
+}
+
+const double* tgEnv::step(const double* actions)
+{
+    if (actions != getCommands())
+    {
+        std::copy(actions, actions + m_commands.size(), m_commands.begin());
+    }
+    return step();
+}
+
+std::vector<std::string> tgEnv::getObservationHeadings() const
+{
+    return m_pDataManager->getFrameHeadings();
+}
+
+void tgEnv::applyCommands()
+{
+    for (std::size_t i = 0; i < m_actuators.size(); i++)
+    {
+        // A tgBasicActuator only moves its motors toward the target
+        // when given the time to do it in
+        if (m_movesMotors[i])
+        {
+            m_actuators[i]->setControlInput(m_commands[i], m_config.stepSize);
+        }
+        else
+        {
+            m_actuators[i]->setControlInput(m_commands[i]);
+        }
+    }
+}
+
+bool tgEnv::invariant() const
+{
+    return (m_commands.size() == m_actuators.size()) &&
+           (m_movesMotors.size() == m_actuators.size()) &&
+           (m_observation.size() == m_pDataManager->getFrameSize()) &&
+           (m_time >= 0.0);
+}
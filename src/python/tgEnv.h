@@ -0,0 +1,231 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_ENV_H
+#define TG_ENV_H
+
+/**
+ * @file tgEnv.h
+ * @brief Contains the definition of class tgEnv
+ * $Id$
+ */
+
+// This application
+#include "core/tgWorld.h"
+#include "core/tgWorldSnapshot.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class TensegrityModel;
+class tgDataManager;
+class tgSimView;
+class tgSimulation;
+class tgSpringCableActuator;
+
+/**
+ * A YAML model in a headless world, stepped an action at a time for
+ * reinforcement learning. The actuators are commanded from one buffer
+ * of doubles and the sensors are read into another, both owned here
+ * and at fixed addresses for the life of the environment, so the
+ * Python bindings can hand them out as NumPy arrays without copying.
+ *
+ * reset() restores a snapshot taken just after the model was built,
+ * so it costs no rebuild. Nothing here takes the GIL or touches global
+ * state beyond Bullet's profiler (see tgParallelSimulation), so
+ * environments in different threads can step at the same time.
+ */
+class tgEnv
+{
+public:
+
+    /**
+     * Configuration of an environment. This is Plain Old Data.
+     */
+    struct Config
+    {
+        /**
+         * @throw std::invalid_argument if ss or spa is not positive
+         */
+        Config(const tgWorld::Config& wc = tgWorld::Config(),
+               double ss = 1.0/1000.0, int spa = 1,
+               bool sr = true, bool sa = true);
+
+        /** The configuration of the world */
+        tgWorld::Config worldConfig;
+
+        /** The timestep of the world, in seconds. Must be positive. */
+        double stepSize;
+
+        /**
+         * World steps per call to step(), with the commands held. Must
+         * be positive.
+         */
+        int stepsPerAction;
+
+        /** Whether the observation holds a tgRodSensor per rod */
+        bool senseRods;
+
+        /**
+         * Whether the observation holds a tgSpringCableActuatorSensor
+         * per actuator
+         */
+        bool senseActuators;
+    };
+
+    /**
+     * Build a model in a new world and take the snapshot reset()
+     * returns to.
+     * @param[in] structurePath the YAML file of a TensegrityModel
+     * @param[in] config the world and stepping configuration
+     */
+    tgEnv(const std::string& structurePath, const Config& config = Config());
+
+    /** Delete the simulation, model and world */
+    ~tgEnv();
+
+    /**
+     * Return to the state just after the model was built, zero the
+     * commands and sample the observation.
+     * @return the observation buffer
+     */
+    const double* reset();
+
+    /**
+     * Apply the commands, step the world stepsPerAction times and
+     * sample the observation.
+     * @return the observation buffer
+     */
+    const double* step();
+
+    /**
+     * Copy actions into the command buffer, then step().
+     * @param[in] actions getNumActuators() commands
+     */
+    const double* step(const double* actions);
+
+    /**
+     * The number of actuators, and of commands. Each command is the
+     * target rest length of a tgBasicActuator, or the torque of a
+     * tgKinematicActuator's motor, as their setControlInput takes.
+     */
+    std::size_t getNumActuators() const
+    {
+        return m_actuators.size();
+    }
+
+    /** The command buffer, getNumActuators() long */
+    double* getCommands()
+    {
+        return m_commands.empty() ? NULL : &m_commands[0];
+    }
+
+    /** The actuators, in the order of the commands */
+    const std::vector<tgSpringCableActuator*>& getActuators() const
+    {
+        return m_actuators;
+    }
+
+    /** The number of doubles in an observation */
+    std::size_t getObservationSize() const
+    {
+        return m_observation.size();
+    }
+
+    /** The observation buffer, as tgDataManager::sampleFrameInto fills it */
+    const double* getObservation() const
+    {
+        return m_observation.empty() ? NULL : &m_observation[0];
+    }
+
+    /** A heading per observation field, as tgDataManager::getFrameHeadings */
+    std::vector<std::string> getObservationHeadings() const;
+
+    /** The simulated seconds since the last reset */
+    double getTime() const
+    {
+        return m_time;
+    }
+
+    /** The number of step() calls since the last reset */
+    std::size_t getSteps() const
+    {
+        return m_steps;
+    }
+
+    const Config& getConfig() const
+    {
+        return m_config;
+    }
+
+    tgSimulation& getSimulation() const
+    {
+        return *m_pSimulation;
+    }
+
+    /** The model, e.g. for a tgStopPredicate to watch */
+    const TensegrityModel& getModel() const
+    {
+        return *m_pModel;
+    }
+
+private:
+
+    /** Give each actuator its command */
+    void applyCommands();
+
+    /** Integrity predicate */
+    bool invariant() const;
+
+    /** Not copyable */
+    tgEnv(const tgEnv&);
+    tgEnv& operator=(const tgEnv&);
+
+private:
+
+    const Config m_config;
+
+    /** We own these */
+    tgWorld* m_pWorld;
+    tgSimView* m_pView;
+    tgSimulation* m_pSimulation;
+
+    /** The simulation owns these */
+    TensegrityModel* m_pModel;
+    tgDataManager* m_pDataManager;
+
+    std::vector<tgSpringCableActuator*> m_actuators;
+
+    /** Whether each actuator is a tgBasicActuator, which moves its motors */
+    std::vector<bool> m_movesMotors;
+
+    std::vector<double> m_commands;
+
+    std::vector<double> m_observation;
+
+    tgWorldSnapshot m_initialState;
+
+    double m_time;
+
+    std::size_t m_steps;
+};
+
+#endif  // TG_ENV_H
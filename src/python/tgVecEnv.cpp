@@ -0,0 +1,282 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgVecEnv.cpp
+ * @brief Contains the definitions of members of class tgVecEnv
+ * $Id$
+ */
+
+// This module
+#include "tgVecEnv.h"
+// This application
+#include "core/tgStopPredicate.h"
+#include "yamlbuilder/TensegrityModel.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <stdexcept>
+
+tgVecEnv::Config::Config(const tgEnv::Config& ec, std::size_t mes,
+                         bool sod, int nt) :
+envConfig(ec),
+maxEpisodeSteps(mes),
+stopOnDivergence(sod),
+numThreads(nt)
+{
+    if (nt < 0)
+    {
+        throw std::invalid_argument("numThreads is negative");
+    }
+}
+
+tgVecEnv::tgVecEnv(const std::string& structurePath, std::size_t numEnvs,
+                   const Config& config) :
+m_config(config),
+m_numActuators(0),
+m_observationSize(0),
+m_batch(0),
+m_task(eReset),
+m_nextEnv(0),
+m_finishedEnvs(0),
+m_shutdown(false)
+{
+    if (numEnvs == 0)
+    {
+        throw std::invalid_argument("numEnvs is zero");
+    }
+
+    // Built one at a time: the YAML parsing and factories are not
+    // thread safe
+    for (std::size_t i = 0; i < numEnvs; i++)
+    {
+        tgEnv* const pEnv = new tgEnv(structurePath, m_config.envConfig);
+        m_envs.push_back(pEnv);
+        m_predicates.push_back(m_config.stopOnDivergence ?
+                               new tgDivergenceStopPredicate(pEnv->getModel()) :
+                               NULL);
+    }
+    m_numActuators = m_envs[0]->getNumActuators();
+    m_observationSize = m_envs[0]->getObservationSize();
+
+    m_commands.assign(numEnvs * m_numActuators, 0.0);
+    m_observations.assign(numEnvs * m_observationSize, 0.0);
+    m_finalObservations.assign(numEnvs * m_observationSize, 0.0);
+    m_terminated.assign(numEnvs, 0);
+    m_truncated.assign(numEnvs, 0);
+    m_episodeSteps.assign(numEnvs, 0);
+
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_workReady, NULL);
+    pthread_cond_init(&m_workDone, NULL);
+
+    const std::size_t numThreads = (m_config.numThreads == 0) ? numEnvs :
+        std::min(numEnvs, static_cast<std::size_t>(m_config.numThreads));
+    for (std::size_t i = 0; i < numThreads; i++)
+    {
+        Worker* const pWorker = new Worker(*this);
+        if (pthread_create(&pWorker->thread, NULL, workerMain, pWorker) != 0)
+        {
+            delete pWorker;
+            throw std::runtime_error("Could not start an environment thread");
+        }
+        m_workers.push_back(pWorker);
+    }
+
+    reset();
+
+    // Postcondition
+    assert(invariant());
+}
+
+tgVecEnv::~tgVecEnv()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_shutdown = true;
+    pthread_cond_broadcast(&m_workReady);
+    pthread_mutex_unlock(&m_mutex);
+
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        pthread_join(m_workers[i]->thread, NULL);
+        delete m_workers[i];
+    }
+
+    pthread_cond_destroy(&m_workDone);
+    pthread_cond_destroy(&m_workReady);
+    pthread_mutex_destroy(&m_mutex);
+
+    for (std::size_t i = 0; i < m_envs.size(); i++)
+    {
+        delete m_predicates[i];
+        delete m_envs[i];
+    }
+}
+
+const double* tgVecEnv::reset()
+{
+    std::fill(m_commands.begin(), m_commands.end(), 0.0);
+    runBatch(eReset);
+    return getObservations();
+}
+
+const double* tgVecEnv::step()
+{
+    runBatch(eStep);
+    return getObservations();
+}
+
+const double* tgVecEnv::step(const double* actions)
+{
+    if (actions != getCommands())
+    {
+        std::copy(actions, actions + m_commands.size(), m_commands.begin());
+    }
+    return step();
+}
+
+void tgVecEnv::runBatch(Task task)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_task = task;
+    m_nextEnv = 0;
+    m_finishedEnvs = 0;
+    m_error.clear();
+    ++m_batch;
+    pthread_cond_broadcast(&m_workReady);
+
+    while (m_finishedEnvs < m_envs.size())
+    {
+        pthread_cond_wait(&m_workDone, &m_mutex);
+    }
+    const std::string error = m_error;
+    pthread_mutex_unlock(&m_mutex);
+
+    if (!error.empty())
+    {
+        throw std::runtime_error(error);
+    }
+}
+
+void tgVecEnv::resetEnv(std::size_t i)
+{
+    tgEnv& env = *m_envs[i];
+    const double* const observation = env.reset();
+    std::copy(observation, observation + m_observationSize,
+              m_observations.begin() + i * m_observationSize);
+    if (m_predicates[i] != NULL)
+    {
+        m_predicates[i]->onStart();
+    }
+    m_episodeSteps[i] = 0;
+}
+
+void tgVecEnv::stepEnv(std::size_t i)
+{
+    tgEnv& env = *m_envs[i];
+    const double* const observation =
+        env.step(m_commands.empty() ? NULL : &m_commands[i * m_numActuators]);
+    m_episodeSteps[i]++;
+
+    m_terminated[i] = (m_predicates[i] != NULL) &&
+                      m_predicates[i]->shouldStop(env.getTime());
+    m_truncated[i] = !m_terminated[i] && (m_config.maxEpisodeSteps != 0) &&
+                     (m_episodeSteps[i] >= m_config.maxEpisodeSteps);
+
+    if (m_terminated[i] || m_truncated[i])
+    {
+        std::copy(observation, observation + m_observationSize,
+                  m_finalObservations.begin() + i * m_observationSize);
+        resetEnv(i);
+    }
+    else
+    {
+        std::copy(observation, observation + m_observationSize,
+                  m_observations.begin() + i * m_observationSize);
+    }
+}
+
+void* tgVecEnv::workerMain(void* arg)
+{
+    Worker* const pWorker = static_cast<Worker*>(arg);
+    pWorker->owner.work(*pWorker);
+    return NULL;
+}
+
+void tgVecEnv::work(Worker& worker)
+{
+    pthread_mutex_lock(&m_mutex);
+    while (true)
+    {
+        while (!m_shutdown && worker.batch == m_batch)
+        {
+            pthread_cond_wait(&m_workReady, &m_mutex);
+        }
+        if (m_shutdown)
+        {
+            break;
+        }
+        worker.batch = m_batch;
+
+        while (m_nextEnv < m_envs.size())
+        {
+            const std::size_t i = m_nextEnv++;
+            const Task task = m_task;
+            pthread_mutex_unlock(&m_mutex);
+
+            std::string error;
+            try
+            {
+                if (task == eReset)
+                {
+                    resetEnv(i);
+                }
+                else
+                {
+                    stepEnv(i);
+                }
+            }
+            catch (std::exception& e)
+            {
+                error = e.what();
+            }
+
+            pthread_mutex_lock(&m_mutex);
+            if (!error.empty() && m_error.empty())
+            {
+                m_error = error;
+            }
+            if (++m_finishedEnvs == m_envs.size())
+            {
+                pthread_cond_signal(&m_workDone);
+            }
+        }
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool tgVecEnv::invariant() const
+{
+    return !m_envs.empty() &&
+           (m_predicates.size() == m_envs.size()) &&
+           (m_commands.size() == m_envs.size() * m_numActuators) &&
+           (m_observations.size() == m_envs.size() * m_observationSize) &&
+           !m_workers.empty();
+}
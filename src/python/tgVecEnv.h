@@ -0,0 +1,280 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_VEC_ENV_H
+#define TG_VEC_ENV_H
+
+/**
+ * @file tgVecEnv.h
+ * @brief Contains the definition of class tgVecEnv
+ * $Id$
+ */
+
+// This library
+#include "tgEnv.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+// POSIX threads
+#include <pthread.h>
+
+// Forward declarations
+class tgStopPredicate;
+
+/**
+ * N copies of a tgEnv stepped in lock-step by a pool of worker threads,
+ * so a trainer makes one call per step for all of them. The commands
+ * of every environment are one [N x getNumActuators()] row-major array
+ * and the observations one [N x getObservationSize()] array, both owned
+ * here at fixed addresses.
+ *
+ * An environment whose episode ends is reset within the same step, and
+ * its row of the observations is then the first observation of the
+ * next episode; the last observation of the one that ended is in its
+ * row of getFinalObservations(). An episode is terminated when the
+ * model diverges and truncated after maxEpisodeSteps.
+ *
+ * As with tgParallelSimulation, Bullet's built-in profiler is a global
+ * object: build Bullet and NTRT with -DBT_NO_PROFILE.
+ */
+class tgVecEnv
+{
+public:
+
+    /**
+     * Configuration of the environments. This is Plain Old Data.
+     */
+    struct Config
+    {
+        /**
+         * @throw std::invalid_argument if nt is negative
+         */
+        Config(const tgEnv::Config& ec = tgEnv::Config(),
+               std::size_t mes = 0, bool sod = true, int nt = 0);
+
+        /** The configuration of every environment */
+        tgEnv::Config envConfig;
+
+        /** Steps after which an episode is truncated; 0 for no limit */
+        std::size_t maxEpisodeSteps;
+
+        /**
+         * Terminate an episode when a tgDivergenceStopPredicate on its
+         * model stops
+         */
+        bool stopOnDivergence;
+
+        /**
+         * Worker threads; 0 for one per environment. Must not be
+         * negative.
+         */
+        int numThreads;
+    };
+
+    /**
+     * Build the environments, reset them and start the workers.
+     * @param[in] structurePath the YAML file of a TensegrityModel
+     * @param[in] numEnvs the number of environments; must be positive
+     * @param[in] config the configuration of every environment
+     * @throw std::invalid_argument if numEnvs is zero
+     */
+    tgVecEnv(const std::string& structurePath, std::size_t numEnvs,
+             const Config& config = Config());
+
+    /** Stop the workers and delete the environments */
+    ~tgVecEnv();
+
+    /**
+     * Reset every environment and zero the commands.
+     * @return the observations
+     * @throw std::runtime_error if an environment threw
+     */
+    const double* reset();
+
+    /**
+     * Step every environment with its row of the commands, and reset
+     * those whose episodes end.
+     * @return the observations
+     * @throw std::runtime_error if an environment threw; the others
+     * still step
+     */
+    const double* step();
+
+    /**
+     * Copy actions into the commands, then step().
+     * @param[in] actions an [N x getNumActuators()] row-major array
+     */
+    const double* step(const double* actions);
+
+    /** The number of environments, N */
+    std::size_t size() const
+    {
+        return m_envs.size();
+    }
+
+    std::size_t getNumActuators() const
+    {
+        return m_numActuators;
+    }
+
+    std::size_t getObservationSize() const
+    {
+        return m_observationSize;
+    }
+
+    /** The [N x getNumActuators()] commands */
+    double* getCommands()
+    {
+        return m_commands.empty() ? NULL : &m_commands[0];
+    }
+
+    /** The [N x getObservationSize()] observations */
+    const double* getObservations() const
+    {
+        return m_observations.empty() ? NULL : &m_observations[0];
+    }
+
+    /**
+     * The [N x getObservationSize()] last observations of the episodes
+     * that ended on the last step; other rows are stale
+     */
+    const double* getFinalObservations() const
+    {
+        return m_finalObservations.empty() ? NULL : &m_finalObservations[0];
+    }
+
+    /** Per environment, 1 if its episode terminated on the last step */
+    const unsigned char* getTerminated() const
+    {
+        return &m_terminated[0];
+    }
+
+    /** Per environment, 1 if its episode was truncated on the last step */
+    const unsigned char* getTruncated() const
+    {
+        return &m_truncated[0];
+    }
+
+    /** Per environment, the steps taken in its current episode */
+    const std::size_t* getEpisodeSteps() const
+    {
+        return &m_episodeSteps[0];
+    }
+
+    /** One of the environments, e.g. for its observation headings */
+    const tgEnv& getEnv(std::size_t i) const
+    {
+        return *m_envs.at(i);
+    }
+
+    const Config& getConfig() const
+    {
+        return m_config;
+    }
+
+private:
+
+    /** What the workers do to each environment in a batch */
+    enum Task
+    {
+        eReset,
+        eStep
+    };
+
+    /** A worker thread */
+    struct Worker
+    {
+        Worker(tgVecEnv& o) : owner(o), batch(0) { }
+
+        tgVecEnv& owner;
+        pthread_t thread;
+
+        /** The last batch this worker has started on */
+        unsigned long batch;
+    };
+
+    /** Run a task over every environment, blocking until done */
+    void runBatch(Task task);
+
+    /** Reset environment i and copy in its observation */
+    void resetEnv(std::size_t i);
+
+    /** Step environment i, resetting it if its episode ends */
+    void stepEnv(std::size_t i);
+
+    /** The worker loop */
+    void work(Worker& worker);
+
+    /** pthread entry point; arg is a Worker */
+    static void* workerMain(void* arg);
+
+    /** Integrity predicate */
+    bool invariant() const;
+
+    /** Not copyable */
+    tgVecEnv(const tgVecEnv&);
+    tgVecEnv& operator=(const tgVecEnv&);
+
+private:
+
+    const Config m_config;
+
+    /** We own these */
+    std::vector<tgEnv*> m_envs;
+
+    /** Per environment; NULL entries if !stopOnDivergence. We own these. */
+    std::vector<tgStopPredicate*> m_predicates;
+
+    std::size_t m_numActuators;
+    std::size_t m_observationSize;
+
+    std::vector<double> m_commands;
+    std::vector<double> m_observations;
+    std::vector<double> m_finalObservations;
+    std::vector<unsigned char> m_terminated;
+    std::vector<unsigned char> m_truncated;
+    std::vector<std::size_t> m_episodeSteps;
+
+    /** We own these */
+    std::vector<Worker*> m_workers;
+
+    /** Guards everything below */
+    pthread_mutex_t m_mutex;
+
+    /** Signalled when a batch starts or the workers should exit */
+    pthread_cond_t m_workReady;
+
+    /** Signalled when the last environment of a batch finishes */
+    pthread_cond_t m_workDone;
+
+    /** Incremented for each batch */
+    unsigned long m_batch;
+
+    Task m_task;
+    std::size_t m_nextEnv;
+    std::size_t m_finishedEnvs;
+
+    /** The first error thrown in the current batch */
+    std::string m_error;
+
+    bool m_shutdown;
+};
+
+#endif  // TG_VEC_ENV_H
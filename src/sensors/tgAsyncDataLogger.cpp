@@ -0,0 +1,251 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgAsyncDataLogger.cpp
+ * @brief Contains the definitions of members of class tgAsyncDataLogger.
+ * $Id$
+ */
+
+// This module
+#include "tgAsyncDataLogger.h"
+// This application
+#include "tgSampleRing.h"
+#include "core/tgMetrics.h"
+// The C++ Standard Library
+#include <algorithm> // for std::copy
+#include <cassert>
+#include <sstream>
+#include <stdexcept>
+#include <time.h> // for nanosleep
+
+namespace
+{
+  /** How long the writer sleeps on an empty ring, or step on a full one */
+  void nap()
+  {
+    const timespec pause = {0, 200000};
+    nanosleep(&pause, NULL);
+  }
+}
+
+tgAsyncDataLogger::tgAsyncDataLogger(std::string fileNamePrefix,
+				     double timeInterval,
+				     std::size_t ringRows,
+				     OverflowPolicy policy,
+				     std::size_t blockRows) :
+  tgBinaryDataLogger(fileNamePrefix, timeInterval, blockRows),
+  m_policy(policy),
+  m_ringRows(ringRows),
+  m_pRing(NULL),
+  m_writerRunning(false),
+  m_stopping(false),
+  m_droppedRows(0),
+  m_decimatedRows(0),
+  m_decimationCount(0),
+  m_reportedQueue(0)
+{
+  if (m_ringRows == 0) {
+    throw std::invalid_argument("The ring must hold at least one row.");
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+/**
+ * The writer must be stopped before the parent writes the last block and
+ * closes the file.
+ */
+tgAsyncDataLogger::~tgAsyncDataLogger()
+{
+  stopWriter();
+  delete m_pRing;
+}
+
+void tgAsyncDataLogger::setup()
+{
+  // A setup without teardown: finish the previous file first.
+  stopWriter();
+
+  // Opens the file, writes the header and sizes the block buffers.
+  tgBinaryDataLogger::setup();
+
+  delete m_pRing;
+  m_pRing = NULL;
+  m_pRing = new tgSampleRing(m_rowSize, m_ringRows);
+  m_droppedRows = 0;
+  m_decimatedRows = 0;
+  m_decimationCount = 0;
+
+  m_stopping = false;
+  if (pthread_create(&m_writer, NULL, writerMain, this) != 0) {
+    throw std::runtime_error("Could not start the log writer thread.");
+  }
+  m_writerRunning = true;
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgAsyncDataLogger::teardown()
+{
+  stopWriter();
+  if (m_droppedRows > 0 || m_decimatedRows > 0) {
+    std::cout << "tgAsyncDataLogger did not log " << m_droppedRows
+	      << " dropped and " << m_decimatedRows << " decimated samples to "
+	      << m_fileName << std::endl;
+  }
+  tgBinaryDataLogger::teardown();
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgAsyncDataLogger::step(double dt)
+{
+  if (dt <= 0.0)
+  {
+    throw std::invalid_argument("dt is not positive");
+  }
+  else
+  {
+    m_totalTime += dt;
+    m_updateTime += dt;
+    // Nothing to write to before setup or after teardown.
+    if (m_updateTime >= m_timeInterval && m_writerRunning) {
+      m_updateTime = 0.0;
+      if (m_policy == eDecimate && decimate(m_pRing->size())) {
+	++m_decimatedRows;
+	return;
+      }
+      double* row = m_pRing->beginPush();
+      while (row == NULL && m_policy == eBlock) {
+	nap();
+	row = m_pRing->beginPush();
+      }
+      if (row == NULL) {
+	++m_droppedRows;
+	tgMetrics::add(tgMetrics::eLoggerDroppedRows, 1.0);
+	return;
+      }
+      row[0] = m_totalTime;
+      sampleFrameInto(row + 1);
+      m_pRing->commitPush();
+      reportQueue(m_pRing->size());
+    }
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+bool tgAsyncDataLogger::decimate(std::size_t queued)
+{
+  const std::size_t capacity = m_pRing->capacity();
+  std::size_t keepEvery = 1;
+  if (4 * queued > 3 * capacity) {
+    keepEvery = 4;
+  }
+  else if (2 * queued > capacity) {
+    keepEvery = 2;
+  }
+  else {
+    m_decimationCount = 0;
+    return false;
+  }
+  return (m_decimationCount++ % keepEvery) != 0;
+}
+
+void* tgAsyncDataLogger::writerMain(void* pLogger)
+{
+  static_cast<tgAsyncDataLogger*>(pLogger)->drain();
+  return NULL;
+}
+
+/**
+ * Only this thread touches the block buffers and the file while it runs.
+ * Everything queued before m_stopping was seen is written before it
+ * returns.
+ */
+void tgAsyncDataLogger::drain()
+{
+  for (;;) {
+    const bool stopping = m_stopping;
+    __sync_synchronize();
+    const double* row = m_pRing->front();
+    while (row != NULL) {
+      std::copy(row, row + m_rowSize, &m_rows[m_numRows * m_rowSize]);
+      m_pRing->pop();
+      ++m_numRows;
+      if (m_numRows == m_blockRows) {
+	flushBlock();
+      }
+      row = m_pRing->front();
+    }
+    if (stopping) {
+      return;
+    }
+    nap();
+  }
+}
+
+void tgAsyncDataLogger::stopWriter()
+{
+  if (!m_writerRunning) {
+    return;
+  }
+  __sync_synchronize();
+  m_stopping = true;
+  pthread_join(m_writer, NULL);
+  m_writerRunning = false;
+  // The writer emptied the ring
+  reportQueue(0);
+}
+
+void tgAsyncDataLogger::reportQueue(std::size_t queued)
+{
+  if (queued != m_reportedQueue) {
+    tgMetrics::add(tgMetrics::eLoggerQueueRows,
+		   double(queued) - double(m_reportedQueue));
+    m_reportedQueue = queued;
+  }
+}
+
+std::string tgAsyncDataLogger::toString() const
+{
+  std::ostringstream os;
+  os << tgDataManager::toString()
+     << "This tgDataManager is a tgAsyncDataLogger. " << std::endl;
+
+  return os.str();
+}
+
+bool tgAsyncDataLogger::invariant() const
+{
+  return (m_ringRows > 0) &&
+    (!m_writerRunning || m_pRing != NULL) &&
+    (m_timeInterval >= 0.0);
+}
+
+std::ostream&
+operator<<(std::ostream& os, const tgAsyncDataLogger& obj)
+{
+    os << obj.toString() << std::endl;
+    return os;
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_ASYNC_DATA_LOGGER_H
+#define TG_ASYNC_DATA_LOGGER_H
+
+/**
+ * @file tgAsyncDataLogger.h
+ * @brief Contains the definition of class tgAsyncDataLogger.
+ * $Id$
+ */
+
+// Includes from NTRTsim
+#include "tgBinaryDataLogger.h"
+// Includes from the C++ standard library
+#include <string>
+// The POSIX threads library
+#include <pthread.h>
+
+// Forward declarations
+class tgSampleRing;
+
+/**
+ * tgAsyncDataLogger writes the same file as tgBinaryDataLogger, but step
+ * only copies the sample into a preallocated tgSampleRing. A writer
+ * thread started by setup empties the ring into blocks and does all the
+ * file I/O, so a slow disk or NFS doesn't stall the simulation.
+ *
+ * What happens when the writer falls behind and the ring fills is set by
+ * the OverflowPolicy. The rows that were not logged are counted.
+ */
+class tgAsyncDataLogger : public tgBinaryDataLogger
+{
+ public:
+
+  /** What step does when the writer thread falls behind */
+  enum OverflowPolicy
+  {
+    /** Wait for room in the ring; nothing is lost */
+    eBlock,
+    /** Drop the sample if the ring is full */
+    eDrop,
+    /**
+     * Keep every second sample while the ring is over half full, every
+     * fourth while it is over three quarters full, and drop the sample
+     * if it is full
+     */
+    eDecimate
+  };
+
+  /**
+   * @param[in] fileNamePrefix as for tgBinaryDataLogger.
+   * @param[in] timeInterval as for tgBinaryDataLogger.
+   * @param[in] ringRows the samples the ring holds; must be positive.
+   * @param[in] policy what to do when the ring is full.
+   * @param[in] blockRows as for tgBinaryDataLogger.
+   */
+  tgAsyncDataLogger(std::string fileNamePrefix, double timeInterval = 0.0,
+		    std::size_t ringRows = 4096, OverflowPolicy policy = eBlock,
+		    std::size_t blockRows = 1024);
+
+  /**
+   * Stops the writer thread after it has written everything queued.
+   */
+  virtual ~tgAsyncDataLogger();
+
+  /**
+   * As for tgBinaryDataLogger, then starts the writer thread.
+   * @throw std::runtime_error if the thread can't be started.
+   */
+  virtual void setup();
+
+  /**
+   * Waits for the writer thread to write everything queued, then as for
+   * tgBinaryDataLogger.
+   */
+  virtual void teardown();
+
+  /**
+   * Copies the sample into the ring, if m_timeInterval has passed.
+   * @param[in] dt a double, the amount of time since the last step.
+   */
+  virtual void step(double dt);
+
+  /**
+   * Overwrite toString for the superclass to specify that this data manager
+   * is a tgAsyncDataLogger.
+   */
+  virtual std::string toString() const;
+
+  /** Samples lost to a full ring since setup */
+  std::size_t getDroppedRows() const
+  {
+    return m_droppedRows;
+  }
+
+  /** Samples skipped by eDecimate since setup */
+  std::size_t getDecimatedRows() const
+  {
+    return m_decimatedRows;
+  }
+
+ private:
+
+  /** The writer thread's loop */
+  void drain();
+
+  static void* writerMain(void* pLogger);
+
+  /** Let the writer empty the ring and join it, if it is running */
+  void stopWriter();
+
+  /** Move this logger's share of tgMetrics::eLoggerQueueRows to queued */
+  void reportQueue(std::size_t queued);
+
+  /** True if the sample should not be queued under eDecimate */
+  bool decimate(std::size_t queued);
+
+  // Integrity predicate.
+  bool invariant() const;
+
+  const OverflowPolicy m_policy;
+
+  const std::size_t m_ringRows;
+
+  /** Made by setup, once the row size is known */
+  tgSampleRing* m_pRing;
+
+  pthread_t m_writer;
+
+  bool m_writerRunning;
+
+  /** Set by the simulation thread to end the writer thread */
+  volatile bool m_stopping;
+
+  std::size_t m_droppedRows;
+
+  std::size_t m_decimatedRows;
+
+  /** Samples offered to decimate since the ring went over half full */
+  std::size_t m_decimationCount;
+
+  /** The ring's size when last given to tgMetrics */
+  std::size_t m_reportedQueue;
+
+};
+
+/**
+ * Overload operator<<() to handle tgAsyncDataLogger
+ * @param[in,out] os an ostream
+ * @param[in] obj a tgAsyncDataLogger
+ * @return os
+ */
+std::ostream&
+operator<<(std::ostream& os, const tgAsyncDataLogger& obj);
+
+#endif // TG_ASYNC_DATA_LOGGER_H
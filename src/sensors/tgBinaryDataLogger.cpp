@@ -0,0 +1,320 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBinaryDataLogger.cpp
+ * @brief Contains the definitions of members of class tgBinaryDataLogger.
+ * $Id$
+ */
+
+// This module
+#include "tgBinaryDataLogger.h"
+// This application
+#include "tgSensor.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <cassert>
+#include <algorithm> // for std::equal
+#include <sstream>
+#include <time.h> // for the file name of the log file
+#include <cstdlib> // for getenv, converting ~ to $HOME.
+#include <stdint.h> // for the fixed-width counts in the file
+
+namespace
+{
+  const char kMagic[8] = {'N', 'T', 'R', 'T', 'B', 'I', 'N', '1'};
+
+  void writeCount(std::ostream& os, std::size_t n)
+  {
+    const uint32_t count = n;
+    os.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  }
+
+  void writeString(std::ostream& os, const std::string& s)
+  {
+    writeCount(os, s.size());
+    os.write(s.data(), s.size());
+  }
+
+  /** Returns false at the end of the file. */
+  bool readCount(std::istream& is, std::size_t& n)
+  {
+    uint32_t count = 0;
+    is.read(reinterpret_cast<char*>(&count), sizeof(count));
+    n = count;
+    return is.gcount() == sizeof(count);
+  }
+
+  std::string readString(std::istream& is)
+  {
+    std::size_t n = 0;
+    if (!readCount(is, n)) {
+      throw std::runtime_error("Binary log header is truncated.");
+    }
+    std::string s(n, '\0');
+    if (n > 0) {
+      is.read(&s[0], n);
+    }
+    if (!is) {
+      throw std::runtime_error("Binary log header is truncated.");
+    }
+    return s;
+  }
+}
+
+/**
+ * As with tgDataLogger2, only the prefix is stored here. Each setup opens
+ * a new file.
+ */
+tgBinaryDataLogger::tgBinaryDataLogger(std::string fileNamePrefix,
+				       double timeInterval,
+				       std::size_t blockRows) :
+  tgDataManager(),
+  m_fileNamePrefix(fileNamePrefix),
+  m_rowSize(1),
+  m_numRows(0),
+  m_blockRows(blockRows),
+  m_totalTime(0.0),
+  m_timeInterval(timeInterval),
+  m_updateTime(0.0)
+{
+  if (m_fileNamePrefix == "") {
+    throw std::invalid_argument("File name cannot be the empty string. Please pass in a path to a file that can be opened.");
+  }
+  if (m_timeInterval < 0.0 ) {
+    throw std::invalid_argument("Time interval must be nonnegative. Negative time intervals do not make sense.");
+  }
+  if (m_blockRows == 0) {
+    throw std::invalid_argument("A block must hold at least one row.");
+  }
+
+  // Expand a leading "~" to the user's home directory.
+  if (m_fileNamePrefix.at(0) == '~') {
+    std::string home = std::getenv("HOME");
+    m_fileNamePrefix.erase(0,1);
+    m_fileNamePrefix = home + m_fileNamePrefix;
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+/**
+ * Don't lose the last rows if the simulation was deleted without a teardown.
+ * The parent class deletes the sensors and sensor infos.
+ */
+tgBinaryDataLogger::~tgBinaryDataLogger()
+{
+  if (m_output.is_open()) {
+    flushBlock();
+    m_output.close();
+  }
+}
+
+/**
+ * Setup creates the sensors and the frame layout, sizes the buffers once,
+ * and writes the header.
+ */
+void tgBinaryDataLogger::setup()
+{
+  // Call the parent's setup method, which creates the sensors.
+  tgDataManager::setup();
+
+  // A setup without teardown: finish the previous file.
+  if (m_output.is_open()) {
+    flushBlock();
+    m_output.close();
+  }
+
+  // Name the file by the current time, as tgDataLogger2 does.
+  time_t rawtime;
+  tm* currentTime;
+  const int fileTimeSize = 64;
+  char fileTime [fileTimeSize];
+
+  time (&rawtime);
+  currentTime = localtime(&rawtime);
+  strftime(fileTime, fileTimeSize, "%m%d%Y_%H%M%S", currentTime);
+  m_fileName = m_fileNamePrefix + "_" + fileTime + ".bin";
+
+  std::cout << "tgBinaryDataLogger will be saving data to the file: " << std::endl
+	    << m_fileName << std::endl;
+
+  m_output.open(m_fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_output.is_open()) {
+    throw std::runtime_error("Log file could not be opened. Usually, this is because the directory you specified does not exist. Check for spelling errors.");
+  }
+
+  // A row is the time, then the parent's numeric frame.
+  std::vector<std::string> columns = getFrameHeadings();
+  columns.insert(columns.begin(), "time");
+  m_rowSize = 1 + getFrameSize();
+
+  std::ostringstream description;
+  description << "tgBinaryDataLogger started logging at time " << fileTime << ", with "
+	      << m_sensors.size() << " sensors on " << m_senseables.size()
+	      << " senseable objects.";
+
+  m_output.write(kMagic, sizeof(kMagic));
+  writeString(m_output, description.str());
+  writeCount(m_output, columns.size());
+  for (std::size_t i=0; i < columns.size(); i++) {
+    writeString(m_output, columns[i]);
+  }
+
+  // All the allocation happens here, none during step.
+  m_rows.assign(m_rowSize * m_blockRows, 0.0);
+  m_columns.assign(m_rowSize * m_blockRows, 0.0);
+  m_numRows = 0;
+
+  m_totalTime = 0.0;
+  m_updateTime = 0.0;
+
+  // Postcondition
+  assert(invariant());
+}
+
+/**
+ * Write out what's left and close the file before the parent deletes the sensors.
+ */
+void tgBinaryDataLogger::teardown()
+{
+  if (m_output.is_open()) {
+    flushBlock();
+    m_output.close();
+  }
+  tgDataManager::teardown();
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgBinaryDataLogger::step(double dt)
+{
+  if (dt <= 0.0)
+  {
+    throw std::invalid_argument("dt is not positive");
+  }
+  else
+  {
+    m_totalTime += dt;
+    m_updateTime += dt;
+    // Nothing to write to before setup or after teardown.
+    if (m_updateTime >= m_timeInterval && m_output.is_open()) {
+      double* const row = &m_rows[m_numRows * m_rowSize];
+      row[0] = m_totalTime;
+      sampleFrameInto(row + 1);
+      ++m_numRows;
+      if (m_numRows == m_blockRows) {
+	flushBlock();
+      }
+      m_updateTime = 0.0;
+    }
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+/**
+ * Transpose the buffered rows so each column is contiguous, and write them
+ * out behind the row count.
+ */
+void tgBinaryDataLogger::flushBlock()
+{
+  if (m_numRows == 0) {
+    return;
+  }
+  for (std::size_t r=0; r < m_numRows; r++) {
+    for (std::size_t c=0; c < m_rowSize; c++) {
+      m_columns[c * m_numRows + r] = m_rows[r * m_rowSize + c];
+    }
+  }
+  writeCount(m_output, m_numRows);
+  m_output.write(reinterpret_cast<const char*>(&m_columns[0]),
+		 m_numRows * m_rowSize * sizeof(double));
+  m_numRows = 0;
+}
+
+void tgBinaryDataLogger::convertToCSV(const std::string& binFileName, std::ostream& csv)
+{
+  std::ifstream input(binFileName.c_str(), std::ios::in | std::ios::binary);
+  if (!input.is_open()) {
+    throw std::runtime_error("Binary log file could not be opened.");
+  }
+
+  char magic[sizeof(kMagic)];
+  input.read(magic, sizeof(magic));
+  if (!input || !std::equal(magic, magic + sizeof(magic), kMagic)) {
+    throw std::runtime_error("Not a tgBinaryDataLogger file.");
+  }
+
+  csv << readString(input) << std::endl;
+
+  std::size_t numColumns = 0;
+  if (!readCount(input, numColumns) || numColumns == 0) {
+    throw std::runtime_error("Binary log header is truncated.");
+  }
+  for (std::size_t c=0; c < numColumns; c++) {
+    csv << readString(input) << ",";
+  }
+  csv << std::endl;
+
+  std::vector<double> block;
+  std::size_t numRows = 0;
+  while (readCount(input, numRows)) {
+    if (numRows == 0) {
+      continue;
+    }
+    block.resize(numRows * numColumns);
+    input.read(reinterpret_cast<char*>(&block[0]),
+	       block.size() * sizeof(double));
+    if (input.gcount() != static_cast<std::streamsize>(block.size() * sizeof(double))) {
+      throw std::runtime_error("Binary log ends in the middle of a block.");
+    }
+    for (std::size_t r=0; r < numRows; r++) {
+      for (std::size_t c=0; c < numColumns; c++) {
+	csv << block[c * numRows + r] << ",";
+      }
+      csv << std::endl;
+    }
+  }
+}
+
+std::string tgBinaryDataLogger::toString() const
+{
+  std::ostringstream os;
+  os << tgDataManager::toString()
+     << "This tgDataManager is a tgBinaryDataLogger. " << std::endl;
+
+  return os.str();
+}
+
+bool tgBinaryDataLogger::invariant() const
+{
+  return (m_blockRows > 0) &&
+    (m_numRows <= m_blockRows) &&
+    (m_timeInterval >= 0.0);
+}
+
+std::ostream&
+operator<<(std::ostream& os, const tgBinaryDataLogger& obj)
+{
+    os << obj.toString() << std::endl;
+    return os;
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_BINARY_DATA_LOGGER_H
+#define TG_BINARY_DATA_LOGGER_H
+
+/**
+ * @file tgBinaryDataLogger.h
+ * @brief Contains the definition of class tgBinaryDataLogger.
+ * $Id$
+ */
+
+// Includes from NTRTsim
+#include "tgDataManager.h"
+// Includes from the C++ standard library
+#include <fstream> // for writing to a file
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * tgBinaryDataLogger is a tgDataManager that records the same data as
+ * tgDataLogger2, but for long or high-rate runs. The log file stays open
+ * between setup and teardown, sensors write doubles straight into a
+ * preallocated row buffer through tgDataManager::sampleFrameInto, and rows
+ * are written out in blocks.
+ *
+ * The file holds, in native byte order:
+ *   the 8 characters "NTRTBIN1",
+ *   a uint32 string length and the description line,
+ *   a uint32 column count, then for each column a uint32 length and the
+ *   heading (the first is "time", the rest as tgDataLogger2 writes them),
+ *   then any number of blocks, each a uint32 row count followed by each
+ *   column's doubles for those rows in turn.
+ *
+ * Use convertToCSV to get the same text file tgDataLogger2 would have
+ * written.
+ */
+class tgBinaryDataLogger : public tgDataManager
+{
+ public:
+
+  /**
+   * @param[in] fileNamePrefix a string that specifies the path to the log file that
+   * will be written. The current time and ".bin" will be appended to this prefix.
+   * @param[in] timeInterval the time interval for querying sensors. Note that an updateTime
+   * of 0 means that sensors will be queried at each call of step().
+   * @param[in] blockRows the number of rows buffered before a block is written.
+   */
+  tgBinaryDataLogger(std::string fileNamePrefix, double timeInterval = 0.0,
+		     std::size_t blockRows = 1024);
+
+  /**
+   * The destructor writes out any buffered rows if teardown was not called.
+   */
+  virtual ~tgBinaryDataLogger();
+
+  /**
+   * Creates the sensors, opens a new log file, and writes the header.
+   */
+  virtual void setup();
+
+  /**
+   * Writes out any buffered rows and closes the log file.
+   */
+  virtual void teardown();
+
+  /**
+   * Samples every sensor into the row buffer, if m_timeInterval has passed.
+   * @param[in] dt a double, the amount of time since the last step.
+   */
+  virtual void step(double dt);
+
+  /**
+   * Overwrite toString for the superclass to specify that this data manager
+   * is a tgBinaryDataLogger.
+   */
+  virtual std::string toString() const;
+
+  /**
+   * Translate a file written by this class into tgDataLogger2's
+   * comma-separated-value format.
+   * @param[in] binFileName the path of the binary log.
+   * @param[out] csv where the text is written.
+   * @throw std::runtime_error if the file can't be read or isn't a binary log.
+   */
+  static void convertToCSV(const std::string& binFileName, std::ostream& csv);
+
+ protected:
+
+  /**
+   * Write the buffered rows to the file as one block.
+   */
+  void flushBlock();
+
+  // Integrity predicate.
+  bool invariant() const;
+
+  /**
+   * The full name of the current log file, created in setup.
+   */
+  std::string m_fileName;
+
+  /**
+   * The prefix passed in to the constructor, with "~" expanded.
+   */
+  std::string m_fileNamePrefix;
+
+  /**
+   * The log file, open from setup until teardown.
+   */
+  std::ofstream m_output;
+
+  /**
+   * The number of doubles in a row, including the time.
+   */
+  std::size_t m_rowSize;
+
+  /**
+   * The rows sampled since the last block was written, one after the other.
+   */
+  std::vector<double> m_rows;
+
+  /**
+   * Scratch space to transpose m_rows into columns.
+   */
+  std::vector<double> m_columns;
+
+  /**
+   * The number of rows in m_rows.
+   */
+  std::size_t m_numRows;
+
+  /**
+   * The capacity of m_rows, in rows.
+   */
+  std::size_t m_blockRows;
+
+  /**
+   * Time bookkeeping, as in tgDataLogger2.
+   */
+  double m_totalTime;
+  double m_timeInterval;
+  double m_updateTime;
+
+};
+
+/**
+ * Overload operator<<() to handle tgBinaryDataLogger
+ * @param[in,out] os an ostream
+ * @param[in] obj a tgBinaryDataLogger
+ * @return os
+ */
+std::ostream&
+operator<<(std::ostream& os, const tgBinaryDataLogger& obj);
+
+#endif // TG_BINARY_DATA_LOGGER_H
@@ -0,0 +1,163 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBinaryLogReader.cpp
+ * @brief Contains the definitions of members of class tgBinaryLogReader.
+ * $Id$
+ */
+
+// This module
+#include "tgBinaryLogReader.h"
+// The C++ Standard Library
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+// POSIX memory mapping
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+  // As written by tgBinaryDataLogger
+  const char kMagic[8] = {'N', 'T', 'R', 'T', 'B', 'I', 'N', '1'};
+
+  /** Read a count at pos, moving pos past it; false if out of bytes */
+  bool readCount(const char* pBytes, std::size_t size, std::size_t& pos,
+		 std::size_t& n)
+  {
+    uint32_t count = 0;
+    if (size - pos < sizeof(count)) {
+      return false;
+    }
+    std::memcpy(&count, pBytes + pos, sizeof(count));
+    pos += sizeof(count);
+    n = count;
+    return true;
+  }
+
+  std::string readString(const char* pBytes, std::size_t size,
+			 std::size_t& pos)
+  {
+    std::size_t n = 0;
+    if (!readCount(pBytes, size, pos, n) || size - pos < n) {
+      throw std::runtime_error("Binary log header is truncated.");
+    }
+    const std::string s(pBytes + pos, n);
+    pos += n;
+    return s;
+  }
+}
+
+tgBinaryLogReader::tgBinaryLogReader(const std::string& fileName) :
+  m_pMapping(NULL),
+  m_size(0),
+  m_rowCount(0)
+{
+  const int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Binary log file could not be opened.");
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(kMagic)) {
+    ::close(fd);
+    throw std::runtime_error("Not a tgBinaryDataLogger file.");
+  }
+  m_size = info.st_size;
+  void* const pMapping = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (pMapping == MAP_FAILED) {
+    throw std::runtime_error("Binary log file could not be mapped.");
+  }
+  m_pMapping = pMapping;
+
+  const char* const pBytes = static_cast<const char*>(m_pMapping);
+  try {
+    if (std::memcmp(pBytes, kMagic, sizeof(kMagic)) != 0) {
+      throw std::runtime_error("Not a tgBinaryDataLogger file.");
+    }
+    std::size_t pos = sizeof(kMagic);
+    m_description = readString(pBytes, m_size, pos);
+    std::size_t numColumns = 0;
+    if (!readCount(pBytes, m_size, pos, numColumns) || numColumns == 0) {
+      throw std::runtime_error("Binary log header is truncated.");
+    }
+    for (std::size_t c = 0; c < numColumns; c++) {
+      m_headings.push_back(readString(pBytes, m_size, pos));
+    }
+
+    std::size_t numRows = 0;
+    while (readCount(pBytes, m_size, pos, numRows)) {
+      const std::size_t bytes = numRows * numColumns * sizeof(double);
+      if (m_size - pos < bytes) {
+	// The logger stopped in the middle of this block
+	break;
+      }
+      if (numRows > 0) {
+	Block block;
+	block.firstRow = m_rowCount;
+	block.rowCount = numRows;
+	block.offset = pos;
+	m_blocks.push_back(block);
+	m_rowCount += numRows;
+      }
+      pos += bytes;
+    }
+  }
+  catch (...) {
+    munmap(m_pMapping, m_size);
+    throw;
+  }
+}
+
+tgBinaryLogReader::~tgBinaryLogReader()
+{
+  munmap(m_pMapping, m_size);
+}
+
+double tgBinaryLogReader::getValue(std::size_t row, std::size_t column) const
+{
+  assert(row < m_rowCount);
+  assert(column < m_headings.size());
+
+  // The block holding the row, by bisection on the first rows
+  std::size_t lo = 0;
+  std::size_t hi = m_blocks.size();
+  while (hi - lo > 1) {
+    const std::size_t mid = (lo + hi) / 2;
+    if (m_blocks[mid].firstRow <= row) {
+      lo = mid;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  const Block& block = m_blocks[lo];
+
+  // Each column's doubles are contiguous within a block. They need not
+  // be aligned in the file, so they are copied out.
+  const std::size_t offset = block.offset +
+    (column * block.rowCount + (row - block.firstRow)) * sizeof(double);
+  double value;
+  std::memcpy(&value, static_cast<const char*>(m_pMapping) + offset,
+	      sizeof(value));
+  return value;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_BINARY_LOG_READER_H
+#define TG_BINARY_LOG_READER_H
+
+/**
+ * @file tgBinaryLogReader.h
+ * @brief Contains the definition of class tgBinaryLogReader.
+ * $Id$
+ */
+
+// This module
+#include "tgLogReader.h"
+// Includes from the C++ standard library
+#include <string>
+#include <vector>
+
+/**
+ * Random access to a file written by tgBinaryDataLogger (or
+ * tgAsyncDataLogger) without reading it in: the file is memory-mapped and
+ * only the block headers are visited when it is opened, so any row can
+ * then be read in constant time wherever it is, e.g. by tgReplayView
+ * scrubbing back and forth.
+ */
+class tgBinaryLogReader : public tgLogReader
+{
+ public:
+
+  /**
+   * Map a log and index its blocks.
+   * @param[in] fileName the path of the binary log.
+   * @throw std::runtime_error if the file can't be mapped or isn't a
+   * binary log. A log cut short in its last block, e.g. by a crash, is
+   * read up to its last whole block.
+   */
+  tgBinaryLogReader(const std::string& fileName);
+
+  /** Unmaps the file. */
+  virtual ~tgBinaryLogReader();
+
+  virtual const std::string& getDescription() const
+  {
+    return m_description;
+  }
+
+  virtual const std::vector<std::string>& getHeadings() const
+  {
+    return m_headings;
+  }
+
+  virtual std::size_t getRowCount() const
+  {
+    return m_rowCount;
+  }
+
+  virtual double getValue(std::size_t row, std::size_t column) const;
+
+ private:
+
+  /** Not copyable; the mapping belongs to one reader. */
+  tgBinaryLogReader(const tgBinaryLogReader&);
+  tgBinaryLogReader& operator=(const tgBinaryLogReader&);
+
+  /** Where a block of rows starts in the mapping */
+  struct Block
+  {
+    std::size_t firstRow;
+    std::size_t rowCount;
+    std::size_t offset;
+  };
+
+  void* m_pMapping;
+  std::size_t m_size;
+
+  std::string m_description;
+  std::vector<std::string> m_headings;
+  std::vector<Block> m_blocks;
+  std::size_t m_rowCount;
+};
+
+#endif // TG_BINARY_LOG_READER_H
@@ -0,0 +1,111 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgCPGSensor.cpp
+ * @brief Contains the definitions of members of class tgCPGSensor.
+ * $Id$
+ */
+
+// This module
+#include "tgCPGSensor.h"
+// Includes from NTRT:
+#include "util/CPGEquations.h"
+#include "util/CPGSenseable.h"
+// Includes from the C++ standard library:
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+  std::size_t countNodes(CPGSenseable* pSenseable)
+  {
+    if (pSenseable == NULL) {
+      throw std::invalid_argument("Pointer to pSenseable is NULL inside tgCPGSensor.");
+    }
+    const CPGEquations* const pSystem = pSenseable->getCPGSystem();
+    return pSystem == NULL ? 0 : pSystem->size();
+  }
+}
+
+tgCPGSensor::tgCPGSensor(CPGSenseable* pSenseable) :
+  tgSensor(pSenseable),
+  m_pCPG(pSenseable),
+  m_nodeCount(countNodes(pSenseable))
+{
+}
+
+tgCPGSensor::~tgCPGSensor()
+{
+}
+
+std::vector<std::string> tgCPGSensor::getSensorDataHeadings()
+{
+  // As for the other sensors, the type, then the label, then the field,
+  // here with the node's index first
+  const std::string prefix = "cpg(" + m_pCPG->getCPGLabel() + ").";
+  std::vector<std::string> headings;
+  for (std::size_t i = 0; i < m_nodeCount; i++) {
+    std::stringstream node;
+    node << prefix << i << ".";
+    headings.push_back(node.str() + "value");
+    headings.push_back(node.str() + "phi");
+    headings.push_back(node.str() + "r");
+    headings.push_back(node.str() + "rDot");
+  }
+  return headings;
+}
+
+std::vector<std::string> tgCPGSensor::getSensorData()
+{
+  std::vector<double> data(getSensorDataSize());
+  if (!data.empty()) {
+    sampleInto(&data[0]);
+  }
+  std::vector<std::string> sensordata;
+  for (std::size_t i = 0; i < data.size(); i++) {
+    std::stringstream value;
+    value << data[i];
+    sensordata.push_back(value.str());
+  }
+  return sensordata;
+}
+
+std::size_t tgCPGSensor::getSensorDataSize()
+{
+  return nodeFields * m_nodeCount;
+}
+
+void tgCPGSensor::sampleInto(double* out)
+{
+  const CPGEquations* const pSystem = m_pCPG->getCPGSystem();
+  const std::size_t n = pSystem == NULL ? 0 : pSystem->size();
+  if (n > m_nodeCount) {
+    // Only the first m_nodeCount nodes have columns
+    m_scratch.resize(nodeFields * n);
+    pSystem->sampleNodesInto(&m_scratch[0]);
+    std::copy(m_scratch.begin(), m_scratch.begin() + nodeFields * m_nodeCount, out);
+    return;
+  }
+  if (n > 0) {
+    pSystem->sampleNodesInto(out);
+  }
+  std::fill(out + nodeFields * n, out + nodeFields * m_nodeCount, 0.0);
+}
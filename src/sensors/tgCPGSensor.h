@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef TG_CPG_SENSOR_H
+#define TG_CPG_SENSOR_H
+
+/**
+ * @file tgCPGSensor.h
+ * @brief Contains the definition of class tgCPGSensor.
+ * $Id$
+ */
+
+// Includes from the sensors directory:
+#include "tgSensor.h"
+
+// Forward declarations
+class CPGSenseable;
+
+/**
+ * This class extends tgSensor to sense the nodes of a CPG system: for
+ * each node, its value, phase, radius and radius rate.
+ *
+ * The values are written straight from the nodes by
+ * CPGEquations::sampleNodesInto, so a tgAsyncDataLogger can trace every
+ * node of a large hierarchy at the control rate. The number of nodes is
+ * fixed when the sensor is created.
+ */
+class tgCPGSensor : public tgSensor
+{
+public:
+
+  /** The values per node */
+  static const std::size_t nodeFields = 4;
+
+  /**
+   * @param[in] pSenseable whose system is sensed; the system must have
+   * been built, as it is by the time a tgDataManager is set up.
+   * @throw std::invalid_argument if pSenseable is NULL.
+   */
+  tgCPGSensor(CPGSenseable* pSenseable);
+
+  virtual ~tgCPGSensor();
+
+  virtual std::vector<std::string> getSensorDataHeadings();
+  virtual std::vector<std::string> getSensorData();
+
+  /**
+   * Numeric versions of the above, see tgSensor. Nodes added since the
+   * sensor was created are left out, and missing ones read as 0, as do
+   * all of them while the senseable has no system.
+   */
+  virtual std::size_t getSensorDataSize();
+  virtual void sampleInto(double* out);
+
+private:
+
+  /** The same pointer as m_pSens, cast once */
+  CPGSenseable* const m_pCPG;
+
+  /** The number of nodes when the sensor was created */
+  const std::size_t m_nodeCount;
+
+  /** For systems that grew since, to sample without allocating */
+  std::vector<double> m_scratch;
+};
+
+#endif // TG_CPG_SENSOR_H
@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgCPGSensorInfo.cpp
+ * @brief Contains the definitions of members of class tgCPGSensorInfo.
+ * $Id$
+ */
+
+// This module
+#include "tgCPGSensorInfo.h"
+// Other includes from NTRTsim
+#include "tgCPGSensor.h"
+#include "core/tgCast.h"
+#include "core/tgSenseable.h"
+#include "util/CPGSenseable.h"
+// Other includes from the C++ standard library
+#include <stdexcept>
+
+tgCPGSensorInfo::tgCPGSensorInfo()
+{
+}
+
+tgCPGSensorInfo::~tgCPGSensorInfo()
+{
+}
+
+bool tgCPGSensorInfo::isThisMySenseable(tgSenseable* pSenseable)
+{
+  return tgCast::cast<tgSenseable, CPGSenseable>(pSenseable) != 0;
+}
+
+std::vector<tgSensor*>
+tgCPGSensorInfo::createSensorsIfAppropriate(tgSenseable* pSenseable)
+{
+  if (!isThisMySenseable(pSenseable)) {
+    throw std::invalid_argument("pSenseable is NOT a CPGSenseable, inside tgCPGSensorInfo.");
+  }
+  std::vector<tgSensor*> newSensors;
+  newSensors.push_back(new tgCPGSensor(
+    tgCast::cast<tgSenseable, CPGSenseable>(pSenseable)));
+  return newSensors;
+}
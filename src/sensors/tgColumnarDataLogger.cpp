@@ -0,0 +1,350 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgColumnarDataLogger.cpp
+ * @brief Contains the definitions of members of class tgColumnarDataLogger.
+ * $Id$
+ */
+
+// This module
+#include "tgColumnarDataLogger.h"
+// This application
+#include "tgSensor.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <time.h> // for the name of the directory
+#include <cstdlib> // for getenv, converting ~ to $HOME.
+#include <stdint.h>
+// POSIX, for mkdir
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+
+namespace
+{
+  /** The .npy header is padded to this many bytes, so it can be rewritten */
+  const std::size_t kHeaderSize = 128;
+
+  void makeDirectory(const std::string& path)
+  {
+    if (mkdir(path.c_str(), 0777) != 0 && errno != EEXIST) {
+      throw std::runtime_error("Could not make the directory " + path + ". Usually, this is because the parent directory does not exist.");
+    }
+  }
+
+  /** Keep letters, digits, '.', '-' and '_'; anything else becomes '_' */
+  std::string fileNameOf(const std::string& s)
+  {
+    std::string name = s;
+    for (std::size_t i = 0; i < name.size(); i++) {
+      const char c = name[i];
+      const bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+	(c >= '0' && c <= '9') || c == '.' || c == '-' || c == '_';
+      if (!ok) {
+	name[i] = '_';
+      }
+    }
+    return name.empty() ? "sensor" : name;
+  }
+
+  bool isLittleEndian()
+  {
+    const uint16_t one = 1;
+    return *reinterpret_cast<const unsigned char*>(&one) == 1;
+  }
+}
+
+tgColumnarDataLogger::tgColumnarDataLogger(std::string fileNamePrefix,
+					   double timeInterval,
+					   std::size_t blockRows,
+					   bool singlePrecision) :
+  tgDataManager(),
+  m_fileNamePrefix(fileNamePrefix),
+  m_open(false),
+  m_singlePrecision(singlePrecision),
+  m_rowSize(1),
+  m_numRows(0),
+  m_blockRows(blockRows),
+  m_totalRows(0),
+  m_totalTime(0.0),
+  m_timeInterval(timeInterval),
+  m_updateTime(0.0)
+{
+  if (m_fileNamePrefix == "") {
+    throw std::invalid_argument("File name cannot be the empty string. Please pass in a path to a directory that can be made.");
+  }
+  if (m_timeInterval < 0.0 ) {
+    throw std::invalid_argument("Time interval must be nonnegative. Negative time intervals do not make sense.");
+  }
+  if (m_blockRows == 0) {
+    throw std::invalid_argument("A block must hold at least one row.");
+  }
+
+  // Expand a leading "~" to the user's home directory.
+  if (m_fileNamePrefix.at(0) == '~') {
+    std::string home = std::getenv("HOME");
+    m_fileNamePrefix.erase(0,1);
+    m_fileNamePrefix = home + m_fileNamePrefix;
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+/**
+ * Don't lose the last rows if the simulation was deleted without a teardown.
+ * The parent class deletes the sensors and sensor infos.
+ */
+tgColumnarDataLogger::~tgColumnarDataLogger()
+{
+  if (m_open) {
+    finish();
+  }
+}
+
+void tgColumnarDataLogger::setup()
+{
+  // Call the parent's setup method, which creates the sensors.
+  tgDataManager::setup();
+
+  // A setup without teardown: finish the previous directory.
+  if (m_open) {
+    finish();
+  }
+
+  time_t rawtime;
+  tm* currentTime;
+  const int fileTimeSize = 64;
+  char fileTime [fileTimeSize];
+
+  time (&rawtime);
+  currentTime = localtime(&rawtime);
+  strftime(fileTime, fileTimeSize, "%m%d%Y_%H%M%S", currentTime);
+  m_directoryName = m_fileNamePrefix + "_" + fileTime;
+
+  std::cout << "tgColumnarDataLogger will be saving data to the directory: " << std::endl
+	    << m_directoryName << std::endl;
+
+  makeDirectory(m_directoryName);
+
+  // Name a file for each heading, and list them in columns.csv.
+  const std::string indexName = m_directoryName + "/columns.csv";
+  std::ofstream index(indexName.c_str());
+  if (!index.is_open()) {
+    throw std::runtime_error("Could not write " + indexName);
+  }
+  index << "file,heading" << std::endl;
+
+  m_columnPaths.clear();
+  m_columnPaths.push_back("time.npy");
+  index << "time.npy,time" << std::endl;
+
+  std::set<std::string> types;
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    const std::vector<std::string> headings = m_sensors[i]->getSensorDataHeadings();
+    for (std::size_t j=0; j < headings.size(); j++) {
+      // "rod(tags).X" is field X of a sensor of type rod.
+      const std::string& heading = headings[j];
+      const std::size_t open = heading.find('(');
+      const std::size_t close = heading.rfind(").");
+      const std::string type = fileNameOf(heading.substr(0, open));
+      const std::string field = close == std::string::npos ?
+	heading : heading.substr(close + 2);
+      if (types.insert(type).second) {
+	makeDirectory(m_directoryName + "/" + type);
+      }
+
+      std::ostringstream path;
+      path << type << "/" << i << "_" << fileNameOf(field) << ".npy";
+      m_columnPaths.push_back(path.str());
+      index << path.str() << "," << i << "_" << heading << std::endl;
+    }
+  }
+
+  m_rowSize = 1 + getFrameSize();
+  assert(m_columnPaths.size() == m_rowSize);
+  for (std::size_t c=0; c < m_columnPaths.size(); c++) {
+    writeHeader(m_columnPaths[c], 0, true);
+  }
+
+  // All the allocation happens here, none during step.
+  m_rows.assign(m_rowSize * m_blockRows, 0.0);
+  m_column.assign(m_blockRows * sizeof(double), 0);
+  m_numRows = 0;
+  m_totalRows = 0;
+  m_open = true;
+
+  m_totalTime = 0.0;
+  m_updateTime = 0.0;
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgColumnarDataLogger::teardown()
+{
+  if (m_open) {
+    finish();
+  }
+  tgDataManager::teardown();
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgColumnarDataLogger::step(double dt)
+{
+  if (dt <= 0.0)
+  {
+    throw std::invalid_argument("dt is not positive");
+  }
+  else
+  {
+    m_totalTime += dt;
+    m_updateTime += dt;
+    // Nothing to write to before setup or after teardown.
+    if (m_updateTime >= m_timeInterval && m_open) {
+      double* const row = &m_rows[m_numRows * m_rowSize];
+      row[0] = m_totalTime;
+      sampleFrameInto(row + 1);
+      ++m_numRows;
+      if (m_numRows == m_blockRows) {
+	flushBlock();
+      }
+      m_updateTime = 0.0;
+    }
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+/**
+ * Each column is appended with one write. Files are only open while they
+ * are written, so there's no limit from open file descriptors.
+ */
+void tgColumnarDataLogger::flushBlock()
+{
+  if (m_numRows == 0) {
+    return;
+  }
+  const std::size_t itemSize = m_singlePrecision ? sizeof(float) : sizeof(double);
+  for (std::size_t c=0; c < m_rowSize; c++) {
+    if (m_singlePrecision) {
+      float* const out = reinterpret_cast<float*>(&m_column[0]);
+      for (std::size_t r=0; r < m_numRows; r++) {
+	out[r] = static_cast<float>(m_rows[r * m_rowSize + c]);
+      }
+    }
+    else {
+      double* const out = reinterpret_cast<double*>(&m_column[0]);
+      for (std::size_t r=0; r < m_numRows; r++) {
+	out[r] = m_rows[r * m_rowSize + c];
+      }
+    }
+
+    const std::string path = m_directoryName + "/" + m_columnPaths[c];
+    std::FILE* const file = std::fopen(path.c_str(), "ab");
+    if (file == NULL ||
+	std::fwrite(&m_column[0], itemSize, m_numRows, file) != m_numRows) {
+      if (file != NULL) {
+	std::fclose(file);
+      }
+      throw std::runtime_error("Could not append to " + path);
+    }
+    std::fclose(file);
+  }
+  m_totalRows += m_numRows;
+  m_numRows = 0;
+}
+
+void tgColumnarDataLogger::finish()
+{
+  flushBlock();
+  for (std::size_t c=0; c < m_columnPaths.size(); c++) {
+    writeHeader(m_columnPaths[c], m_totalRows, false);
+  }
+  m_open = false;
+}
+
+/**
+ * Version 1.0 of the format: the magic string, the version, a
+ * little-endian uint16 header length and a Python dict literal, padded
+ * with spaces and ending in a newline.
+ */
+void tgColumnarDataLogger::writeHeader(const std::string& column,
+				       std::size_t rows, bool truncate) const
+{
+  std::ostringstream dict;
+  dict << "{'descr': '" << (isLittleEndian() ? '<' : '>')
+       << (m_singlePrecision ? "f4" : "f8")
+       << "', 'fortran_order': False, 'shape': (" << rows << ",), }";
+  std::string header = dict.str();
+  const std::size_t headerLength = kHeaderSize - 10;
+  if (header.size() + 1 > headerLength) {
+    throw std::runtime_error("The .npy header does not fit.");
+  }
+  header.resize(headerLength - 1, ' ');
+  header += '\n';
+
+  char preamble[10] = {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0, 0, 0};
+  preamble[8] = static_cast<char>(headerLength & 0xff);
+  preamble[9] = static_cast<char>(headerLength >> 8);
+
+  const std::string path = m_directoryName + "/" + column;
+  std::FILE* const file = std::fopen(path.c_str(), truncate ? "wb" : "r+b");
+  if (file == NULL) {
+    throw std::runtime_error("Could not write " + path);
+  }
+  const bool ok = std::fwrite(preamble, 1, sizeof(preamble), file) == sizeof(preamble) &&
+    std::fwrite(header.data(), 1, header.size(), file) == header.size();
+  std::fclose(file);
+  if (!ok) {
+    throw std::runtime_error("Could not write " + path);
+  }
+}
+
+std::string tgColumnarDataLogger::toString() const
+{
+  std::ostringstream os;
+  os << tgDataManager::toString()
+     << "This tgDataManager is a tgColumnarDataLogger. " << std::endl;
+
+  return os.str();
+}
+
+bool tgColumnarDataLogger::invariant() const
+{
+  return (m_blockRows > 0) &&
+    (m_numRows <= m_blockRows) &&
+    (m_timeInterval >= 0.0);
+}
+
+std::ostream&
+operator<<(std::ostream& os, const tgColumnarDataLogger& obj)
+{
+    os << obj.toString() << std::endl;
+    return os;
+}
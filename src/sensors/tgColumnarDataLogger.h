@@ -0,0 +1,166 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_COLUMNAR_DATA_LOGGER_H
+#define TG_COLUMNAR_DATA_LOGGER_H
+
+/**
+ * @file tgColumnarDataLogger.h
+ * @brief Contains the definition of class tgColumnarDataLogger.
+ * $Id$
+ */
+
+// Includes from NTRTsim
+#include "tgDataManager.h"
+// Includes from the C++ standard library
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * tgColumnarDataLogger records the same data as tgDataLogger2, but as one
+ * NumPy .npy file per column, so analysis scripts can memory-map just the
+ * columns they need with numpy.load(path, mmap_mode='r') instead of
+ * parsing text.
+ *
+ * setup makes a directory named by the prefix and the current time. It
+ * holds time.npy, a subdirectory per sensor type (the part of a heading
+ * before "(", e.g. "rod") with a file "<sensor>_<field>.npy" for each
+ * heading, and columns.csv, which maps each file to its heading as
+ * tgDataLogger2 writes it. Rows are buffered and appended to the files a
+ * block at a time; the array shapes are written by teardown.
+ */
+class tgColumnarDataLogger : public tgDataManager
+{
+ public:
+
+  /**
+   * @param[in] fileNamePrefix a string that specifies the path of the
+   * directory that will be written. The current time will be appended to
+   * this prefix.
+   * @param[in] timeInterval the time interval for querying sensors. Note
+   * that an updateTime of 0 means that sensors will be queried at each
+   * call of step().
+   * @param[in] blockRows the number of rows buffered before a block is
+   * written.
+   * @param[in] singlePrecision store floats instead of doubles, halving the
+   * files.
+   */
+  tgColumnarDataLogger(std::string fileNamePrefix, double timeInterval = 0.0,
+		       std::size_t blockRows = 4096, bool singlePrecision = false);
+
+  /**
+   * The destructor finishes the files if teardown was not called.
+   */
+  virtual ~tgColumnarDataLogger();
+
+  /**
+   * Creates the sensors, the directory and the column files.
+   * @throw std::runtime_error if the directory or files can't be made.
+   */
+  virtual void setup();
+
+  /**
+   * Writes out any buffered rows and the array shapes.
+   */
+  virtual void teardown();
+
+  /**
+   * Samples every sensor into the row buffer, if m_timeInterval has passed.
+   * @param[in] dt a double, the amount of time since the last step.
+   */
+  virtual void step(double dt);
+
+  /**
+   * Overwrite toString for the superclass to specify that this data manager
+   * is a tgColumnarDataLogger.
+   */
+  virtual std::string toString() const;
+
+  /** The directory made by the last setup */
+  const std::string& getDirectoryName() const
+  {
+    return m_directoryName;
+  }
+
+ private:
+
+  /** Append the buffered rows to the column files */
+  void flushBlock();
+
+  /** Flush, and write the final shapes into the .npy headers */
+  void finish();
+
+  /**
+   * Write an .npy header for a one dimensional array.
+   * @param[in] path the column file.
+   * @param[in] rows the length of the array.
+   * @param[in] truncate start a new file, rather than rewrite the header.
+   */
+  void writeHeader(const std::string& path, std::size_t rows, bool truncate) const;
+
+  // Integrity predicate.
+  bool invariant() const;
+
+  std::string m_fileNamePrefix;
+
+  std::string m_directoryName;
+
+  /** The file of each column, the time first */
+  std::vector<std::string> m_columnPaths;
+
+  /** True from setup until the files are finished */
+  bool m_open;
+
+  bool m_singlePrecision;
+
+  /** The number of doubles in a row, including the time */
+  std::size_t m_rowSize;
+
+  /** The rows sampled since the last block was written, one after the other */
+  std::vector<double> m_rows;
+
+  /** Scratch space for one column of a block */
+  std::vector<char> m_column;
+
+  std::size_t m_numRows;
+
+  std::size_t m_blockRows;
+
+  /** The rows written to the files so far */
+  std::size_t m_totalRows;
+
+  /**
+   * Time bookkeeping, as in tgDataLogger2.
+   */
+  double m_totalTime;
+  double m_timeInterval;
+  double m_updateTime;
+
+};
+
+/**
+ * Overload operator<<() to handle tgColumnarDataLogger
+ * @param[in,out] os an ostream
+ * @param[in] obj a tgColumnarDataLogger
+ * @return os
+ */
+std::ostream&
+operator<<(std::ostream& os, const tgColumnarDataLogger& obj);
+
+#endif // TG_COLUMNAR_DATA_LOGGER_H
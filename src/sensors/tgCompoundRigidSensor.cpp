@@ -32,6 +32,7 @@
 #include "core/tgCast.h"
 #include "core/tgTags.h"
 #include "core/tgBaseRigid.h"
+#include "core/tgRigidStateFrame.h"
 
 // Includes from the c++ standard library:
 //#include <iostream>
@@ -68,7 +69,10 @@ tgCompoundRigidSensor::tgCompoundRigidSensor(tgModel* pModel) : tgSensor(pModel)
  */
 tgCompoundRigidSensor::tgCompoundRigidSensor(tgModel* pModel, std::string tag) :
   tgSensor(pModel),
-  m_tag(tag)
+  m_tag(tag),
+  m_mass(0.0),
+  m_com(0.0, 0.0, 0.0),
+  m_orient(0.0, 0.0, 0.0)
 {
   // Note that this pointer may be 0 (equivalent to NULL) if the cast in
   // the calling function from tgSenseable to tgModel fails.
@@ -96,6 +100,16 @@ tgCompoundRigidSensor::tgCompoundRigidSensor(tgModel* pModel, std::string tag) :
   // (3) have Bullet calculate the inverse quaternion.
   //     That's what will be used below.
   origOrientQuatInv = origOrientQuat.inverse();
+
+  // The mass and the weights don't change with time, so add them up once.
+  for( size_t i=0; i < m_rigids.size(); i++){
+    m_bodies.push_back(m_rigids[i]->getPRigidBody());
+    m_mass += m_rigids[i]->mass();
+  }
+  for( size_t i=0; i < m_rigids.size(); i++){
+    m_weights.push_back(m_mass > 0.0 ? m_rigids[i]->mass() / m_mass :
+			1.0 / m_rigids.size());
+  }
 }
 
 /** 
@@ -113,39 +127,46 @@ tgCompoundRigidSensor::~tgCompoundRigidSensor()
   // TO-DO: implement this.
 }
 
-// Three data collection methods. They should all
-// return zeroes if m_rigids is empty.
-// NEED TO DO ASAP: this is INCORRECT, we need to average / integrate
-//   over all the volume of the rigids, not just avg their individual COMs.
-btVector3 tgCompoundRigidSensor::getCenterOfMass()
+/**
+ * One pass over the bodies, reading the world's published states where
+ * there are any. The center of mass is weighted by each body's mass.
+ * The orientation is the rotation of the first body since construction:
+ * to get the "difference" between wherever it was and where it is now,
+ * multiply Q_curr * inv(Q_0).
+ */
+void tgCompoundRigidSensor::update(bool com, bool orientation)
 {
-  // This method takes the average of all the centers of mass.
-  // It should be sufficient to just add then divide each component
-  // of the 3D vector.
-  // The resulting vector:
-  btVector3* pCom = new btVector3(0.0, 0.0, 0.0);
-  // Iterate and add all the centers of mass of the components.
-  for( size_t i=0; i < m_rigids.size(); i++){
-    *pCom += m_rigids[i]->centerOfMass();
+  if (com) {
+    btVector3 sum(0.0, 0.0, 0.0);
+    for( size_t i=0; i < m_bodies.size(); i++){
+      const tgRigidStateFrame::RigidState* const pState =
+	tgRigidStateFrame::find(m_bodies[i]);
+      btTransform transform;
+      if (pState != NULL) {
+	transform = pState->transform;
+      }
+      else {
+	// As tgBaseRigid::centerOfMass
+	m_bodies[i]->getMotionState()->getWorldTransform(transform);
+      }
+      sum += m_weights[i] * transform.getOrigin();
+    }
+    m_com = sum;
+  }
+  if (!orientation) {
+    return;
   }
-  // Average the components:
-  *pCom /= m_rigids.size();
 
-  return *pCom;
-}
+  btQuaternion currentOrientQuat = origOrientQuat;
+  if (!m_bodies.empty()) {
+    const tgRigidStateFrame::RigidState* const pState =
+      tgRigidStateFrame::find(m_bodies[0]);
+    currentOrientQuat = (pState != NULL) ? pState->transform.getRotation() :
+      m_bodies[0]->getOrientation();
+  }
 
-btVector3 tgCompoundRigidSensor::getOrientation()
-{
-  // For now, it will be easier to poke around at the underlying Bullet Physics
-  // objects.
-  // TO-DO: encapsulate this functionality inside tgBaseRigid.
-  // To get the "difference" between wherever the first rigid body was,
-  // and where it is now, multiply Q_curr * inv(Q_0).
-  // First, get the orientation of the underlying Bullet rigid body:
-  btQuaternion currentOrientQuat = m_rigids[0]->getPRigidBody()->getOrientation();
-  // The "difference" is then
-  btQuaternion diffOrientQuat = currentOrientQuat * origOrientQuatInv;
   // Convert to roll/pitch/yaw just like inside tgBaseRigid::orientation().
+  btQuaternion diffOrientQuat = currentOrientQuat * origOrientQuatInv;
   btMatrix3x3 rotMat = btMatrix3x3( diffOrientQuat );
   btScalar yaw = 0.0;
   btScalar pitch = 0.0;
@@ -153,28 +174,7 @@ btVector3 tgCompoundRigidSensor::getOrientation()
   rotMat.getEulerYPR(yaw, pitch, roll);
   // Convert from radians to degrees, since that's what most people
   // will care about when parsing this data.
-  yaw = 180/M_PI * yaw;
-  pitch = 180/M_PI * pitch;
-  roll = 180/M_PI * roll;  
-
-  // The final result:
-  btVector3 orient = btVector3(yaw, pitch, roll);
-  return orient;
-  
-  // The resulting vector:
-  //btVector3* orient = new btVector3(0.0, 0.0, 0.0);
-
-  //return *orient;
-}
-
-double tgCompoundRigidSensor::getMass()
-{
-  // Add the mass of all the rigid bodies.
-  double mass = 0;
-  for( size_t i=0; i < m_rigids.size(); i++){
-    mass += m_rigids[i]->mass();
-  }
-  return mass;
+  m_orient = btVector3(180/M_PI * yaw, 180/M_PI * pitch, 180/M_PI * roll);
 }
 
 /**
@@ -237,9 +237,9 @@ std::vector<std::string> tgCompoundRigidSensor::getSensorData() {
   std::vector<std::string> sensordata;
 
   // Get the position and orientation of this compound body.
-  // Call the helper functions
-  btVector3 com = getCenterOfMass();
-  btVector3 orient = getOrientation();
+  update();
+  const btVector3& com = m_com;
+  const btVector3& orient = m_orient;
   
   // com[0]
   ss << com[0];
@@ -276,11 +276,49 @@ std::vector<std::string> tgCompoundRigidSensor::getSensorData() {
   //sensordata.push_back( "" );
 
   // mass
-  ss << getMass();
+  ss << m_mass;
   sensordata.push_back( ss.str() );
   ss.str("");
   
   return sensordata;
 }
 
+/**
+ * The numeric version of getSensorData, for loggers and controllers.
+ * Same fields, same order, no strings.
+ */
+std::size_t tgCompoundRigidSensor::getSensorDataSize() {
+  return 7;
+}
+
+void tgCompoundRigidSensor::sampleInto(double* out) {
+  update();
+  const btVector3& com = m_com;
+  const btVector3& orient = m_orient;
+  out[0] = com[0];
+  out[1] = com[1];
+  out[2] = com[2];
+  out[3] = orient[0];
+  out[4] = orient[1];
+  out[5] = orient[2];
+  out[6] = m_mass;
+}
+
+void tgCompoundRigidSensor::sampleWantedInto(double* out, const char* wanted) {
+  const bool com = wanted[0] || wanted[1] || wanted[2];
+  const bool orientation = wanted[3] || wanted[4] || wanted[5];
+  update(com, orientation);
+  if (com) {
+    out[0] = m_com[0];
+    out[1] = m_com[1];
+    out[2] = m_com[2];
+  }
+  if (orientation) {
+    out[3] = m_orient[0];
+    out[4] = m_orient[1];
+    out[5] = m_orient[2];
+  }
+  out[6] = m_mass;
+}
+
 //end.
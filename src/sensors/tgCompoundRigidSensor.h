@@ -84,15 +84,27 @@ public:
   virtual std::vector<std::string> getSensorDataHeadings();
   virtual std::vector<std::string> getSensorData();
 
+  /**
+   * Numeric versions of the above, see tgSensor.
+   */
+  virtual std::size_t getSensorDataSize();
+  virtual void sampleInto(double* out);
+
+  /**
+   * Skips the orientation unless one of its angles is wanted, and the
+   * center of mass unless one of its coordinates is.
+   */
+  virtual void sampleWantedInto(double* out, const char* wanted);
+
  private:
 
   /**
-   * Three methods that calculate the sensor information from the pool of
-   * rigid bodies.
+   * Compute the center of mass and orientation in one pass over the
+   * bodies' published states, into m_com and m_orient.
+   * @param[in] com false to leave m_com as it was.
+   * @param[in] orientation false to leave m_orient as it was.
    */
-  btVector3 getCenterOfMass();
-  btVector3 getOrientation();
-  double getMass();
+  void update(bool com = true, bool orientation = true);
 
   /**
    * This sensor keeps track of the compound tag that it will be sensing.
@@ -105,6 +117,22 @@ public:
    */
   std::vector<tgBaseRigid*> m_rigids;
 
+  /**
+   * The Bullet bodies of m_rigids, and each one's share of the total
+   * mass, fixed at construction since mass doesn't change with time.
+   * If every body is static, each gets an equal share.
+   */
+  std::vector<btRigidBody*> m_bodies;
+  std::vector<double> m_weights;
+  double m_mass;
+
+  /**
+   * The result of the last update: the mass-weighted center of mass,
+   * and the yaw, pitch and roll in degrees.
+   */
+  btVector3 m_com;
+  btVector3 m_orient;
+
   /**
    * Store the original orientation of the compound rigid,
    * for comparison later to get the current orientation.
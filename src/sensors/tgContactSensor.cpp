@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgContactSensor.cpp
+ * @brief Contains the definitions of members of class tgContactSensor.
+ * $Id$
+ */
+
+// This module
+#include "tgContactSensor.h"
+// Includes from NTRT:
+#include "core/tgBaseRigid.h"
+#include "core/tgCast.h"
+#include "core/tgContactFrame.h"
+#include "core/tgSenseable.h"
+#include "core/tgTags.h"
+#include "core/tgWorld.h"
+// Includes from the C++ standard library:
+#include <cassert>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+  /** The summary of a rigid, or NULL if its world has none for it yet */
+  const tgContactFrame::ContactSummary*
+  findSummary(tgSenseable* pSens, const tgWorld& world)
+  {
+    tgBaseRigid* const pRigid = tgCast::cast<tgSenseable, tgBaseRigid>(pSens);
+    assert(pRigid != 0);
+    const btRigidBody* const pBody = pRigid->getPRigidBody();
+    if (pBody == NULL) {
+      return NULL;
+    }
+    return world.getContacts().find(pBody);
+  }
+}
+
+tgContactSensor::tgContactSensor(tgBaseRigid* pRigid, tgWorld& world) :
+  tgSensor(pRigid),
+  m_world(world)
+{
+  if (pRigid == NULL) {
+    throw std::invalid_argument("Pointer to pRigid is NULL inside tgContactSensor.");
+  }
+}
+
+tgContactSensor::~tgContactSensor()
+{
+}
+
+double tgContactSensor::getNormalImpulse() const
+{
+  const tgContactFrame::ContactSummary* const pSummary =
+    findSummary(m_pSens, m_world);
+  return pSummary == NULL ? 0.0 : pSummary->normalImpulse;
+}
+
+int tgContactSensor::getContactCount() const
+{
+  const tgContactFrame::ContactSummary* const pSummary =
+    findSummary(m_pSens, m_world);
+  return pSummary == NULL ? 0 : pSummary->contactCount;
+}
+
+std::vector<std::string> tgContactSensor::getSensorDataHeadings()
+{
+  tgBaseRigid* const pRigid = tgCast::cast<tgSenseable, tgBaseRigid>(m_pSens);
+  assert(pRigid != 0);
+  // As for the other sensors, the type, then the tags, then the field
+  const std::string prefix = "contact(" + pRigid->getTags() + ").";
+  std::vector<std::string> headings;
+  headings.push_back(prefix + "normalImpulse");
+  headings.push_back(prefix + "count");
+  headings.push_back(prefix + "X");
+  headings.push_back(prefix + "Y");
+  headings.push_back(prefix + "Z");
+  return headings;
+}
+
+std::vector<std::string> tgContactSensor::getSensorData()
+{
+  double data[5];
+  sampleInto(data);
+  std::vector<std::string> sensordata;
+  for (std::size_t i = 0; i < 5; i++) {
+    std::stringstream value;
+    value << data[i];
+    sensordata.push_back(value.str());
+  }
+  return sensordata;
+}
+
+std::size_t tgContactSensor::getSensorDataSize()
+{
+  return 5;
+}
+
+void tgContactSensor::sampleInto(double* out)
+{
+  const tgContactFrame::ContactSummary* const pSummary =
+    findSummary(m_pSens, m_world);
+  if (pSummary == NULL) {
+    for (std::size_t i = 0; i < 5; i++) {
+      out[i] = 0.0;
+    }
+    return;
+  }
+  out[0] = pSummary->normalImpulse;
+  out[1] = pSummary->contactCount;
+  out[2] = pSummary->centroid.x();
+  out[3] = pSummary->centroid.y();
+  out[4] = pSummary->centroid.z();
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CONTACT_SENSOR_H
+#define TG_CONTACT_SENSOR_H
+
+/**
+ * @file tgContactSensor.h
+ * @brief Contains the definition of class tgContactSensor.
+ * $Id$
+ */
+
+// Includes from the sensors directory:
+#include "tgSensor.h"
+
+// Forward declarations
+class tgBaseRigid;
+class tgWorld;
+
+/**
+ * This class extends tgSensor to sense the contacts on a rigid body: the
+ * total normal impulse, the number of contact points and their centroid
+ * over the last step, in that order.
+ *
+ * The values come from tgWorld::getContacts, which walks the contact
+ * manifolds once per step for every contact sensor and controller, so
+ * there is no need to walk the dispatcher's manifolds in controllers.
+ */
+class tgContactSensor : public tgSensor
+{
+public:
+
+  /**
+   * @param[in] pRigid the rigid to sense.
+   * @param[in] world the world it is in, which must outlive the sensor.
+   * @throw std::invalid_argument if pRigid is NULL.
+   */
+  tgContactSensor(tgBaseRigid* pRigid, tgWorld& world);
+
+  virtual ~tgContactSensor();
+
+  /** The sum of the normal impulses on the rigid in the last step. */
+  double getNormalImpulse() const;
+
+  /** The number of contact points on the rigid. */
+  int getContactCount() const;
+
+  virtual std::vector<std::string> getSensorDataHeadings();
+  virtual std::vector<std::string> getSensorData();
+
+  /**
+   * Numeric versions of the above, see tgSensor.
+   */
+  virtual std::size_t getSensorDataSize();
+  virtual void sampleInto(double* out);
+
+private:
+
+  tgWorld& m_world;
+};
+
+#endif // TG_CONTACT_SENSOR_H
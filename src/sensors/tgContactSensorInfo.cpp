@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgContactSensorInfo.cpp
+ * @brief Contains the definitions of members of class tgContactSensorInfo.
+ * $Id$
+ */
+
+// This module
+#include "tgContactSensorInfo.h"
+// Other includes from NTRTsim
+#include "tgContactSensor.h"
+#include "core/tgBaseRigid.h"
+#include "core/tgCast.h"
+#include "core/tgSenseable.h"
+#include "core/tgTagSearch.h"
+// Other includes from the C++ standard library
+#include <stdexcept>
+
+tgContactSensorInfo::tgContactSensorInfo(tgWorld& world,
+					 const std::string& tagSearch) :
+  m_world(world),
+  m_tagSearch(tagSearch)
+{
+}
+
+tgContactSensorInfo::~tgContactSensorInfo()
+{
+}
+
+bool tgContactSensorInfo::isThisMySenseable(tgSenseable* pSenseable)
+{
+  tgBaseRigid* pRigid = tgCast::cast<tgSenseable, tgBaseRigid>(pSenseable);
+  if (pRigid == 0) {
+    return 0;
+  }
+  return m_tagSearch.empty() ||
+    tgTagSearch(m_tagSearch).matches(pRigid->getTags());
+}
+
+bool tgContactSensorInfo::findSenseables(tgModel* pModel,
+					 std::vector<tgSenseable*>& senseables)
+{
+  std::vector<tgSenseable*> rigids;
+  appendOfType<tgBaseRigid>(pModel, rigids);
+  if (m_tagSearch.empty()) {
+    senseables.insert(senseables.end(), rigids.begin(), rigids.end());
+    return true;
+  }
+  const tgTagSearch search(m_tagSearch);
+  for (size_t i = 0; i < rigids.size(); i++) {
+    tgBaseRigid* pRigid = tgCast::cast<tgSenseable, tgBaseRigid>(rigids[i]);
+    if (search.matches(pRigid->getTags())) {
+      senseables.push_back(rigids[i]);
+    }
+  }
+  return true;
+}
+
+std::vector<tgSensor*>
+tgContactSensorInfo::createSensorsIfAppropriate(tgSenseable* pSenseable)
+{
+  if (!isThisMySenseable(pSenseable)) {
+    throw std::invalid_argument("pSenseable is NOT a matching tgBaseRigid, inside tgContactSensorInfo.");
+  }
+  std::vector<tgSensor*> newSensors;
+  newSensors.push_back(new tgContactSensor(
+    tgCast::cast<tgSenseable, tgBaseRigid>(pSenseable), m_world));
+  return newSensors;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CONTACT_SENSOR_INFO_H
+#define TG_CONTACT_SENSOR_INFO_H
+
+/**
+ * @file tgContactSensorInfo.h
+ * @brief Contains the definition of class tgContactSensorInfo.
+ * $Id$
+ */
+
+// This module
+#include "tgSensorInfo.h"
+// Other includes from the C++ standard library
+#include <string>
+
+// Forward references
+class tgSenseable;
+class tgSensor;
+class tgWorld;
+
+/**
+ * tgContactSensorInfo is a sensor info class that creates a
+ * tgContactSensor for each tgBaseRigid whose tags match a search, e.g.
+ * the feet of a robot.
+ */
+class tgContactSensorInfo : public tgSensorInfo
+{
+ public:
+
+  /**
+   * @param[in] world the world the rigids are in.
+   * @param[in] tagSearch the tags of the rigids to sense, as for
+   * tgTagSearch; empty for every rigid.
+   */
+  tgContactSensorInfo(tgWorld& world, const std::string& tagSearch = "");
+
+  ~tgContactSensorInfo();
+
+  /**
+   * True if pSenseable is a tgBaseRigid that matches the search.
+   */
+  virtual bool isThisMySenseable(tgSenseable* pSenseable);
+
+  /**
+   * Create a contact sensor for a matching tgBaseRigid. Returns a list
+   * of size 1.
+   * @throws invalid_argument if pSenseable is not a matching tgBaseRigid.
+   */
+  virtual std::vector<tgSensor*> createSensorsIfAppropriate(tgSenseable* pSenseable);
+
+  /**
+   * The model's matching tgBaseRigids, from its index by type.
+   * @return true
+   */
+  virtual bool findSenseables(tgModel* pModel,
+			      std::vector<tgSenseable*>& senseables);
+
+ private:
+
+  tgWorld& m_world;
+
+  std::string m_tagSearch;
+};
+
+#endif // TG_CONTACT_SENSOR_INFO_H
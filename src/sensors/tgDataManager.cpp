@@ -29,16 +29,22 @@
 #include "tgSensor.h"
 #include "core/tgSenseable.h"
 #include "tgSensorInfo.h"
+#include "tgSamplingPolicy.h"
+#include "core/tgCast.h"
+#include "core/tgModel.h"
 // The C++ Standard Library
 //#include <stdio.h> // for sprintf
 #include <iostream>
+#include <algorithm>
 #include <stdexcept>
 #include <cassert>
 
 /**
  * Nothing to do, in this abstract base class.
  */
-tgDataManager::tgDataManager()
+tgDataManager::tgDataManager() :
+  m_frameSize(0),
+  m_channelStamp(1)
 {
   // Postcondition
   assert(invariant());
@@ -81,6 +87,16 @@ tgDataManager::~tgDataManager()
     m_sensorInfos[i] = NULL;
   }
 
+  // And the sampling policies.
+  for (size_t i = 0; i < m_policies.size(); ++i)
+  {
+    delete m_policies[i];
+  }
+  for (size_t i = 0; i < m_infoPolicies.size(); ++i)
+  {
+    delete m_infoPolicies[i];
+  }
+
   // Note that the creation and deletion of the senseable objects, e.g.
   // the tgModels, is handled externally.
   // tgDataManagers should NOT destroy the objects they are sensing.
@@ -96,17 +112,77 @@ void tgDataManager::addSensorsHelper(tgSenseable* pSenseable)
   for (size_t i=0; i < m_sensorInfos.size(); i++){
     // If this particular sensor info is appropriate for the pSenseable,
     if( m_sensorInfos[i]->isThisMySenseable(pSenseable) ) {
-      // Possibly create sensors (usually, this returns a list of size 1.
-      std::vector<tgSensor*> newSensors =
-	m_sensorInfos[i]->createSensorsIfAppropriate(pSenseable);
-      // Add everything in the list to m_sensors.
-      // If an empty list has been returned, no sensors will be added.
-      // Also, need to check if any of the pointers are NULL.
-      for( size_t i=0; i < newSensors.size(); i++ ){
-	// If this sensor pointer is not null...
-	if( newSensors[i] != NULL) {
-	  m_sensors.push_back(newSensors[i]);
-	}
+      createSensorsHelper(i, pSenseable);
+    }
+  }
+}
+
+/**
+ * Helper for setup, once sensor info i has accepted pSenseable.
+ */
+void tgDataManager::createSensorsHelper(size_t i, tgSenseable* pSenseable)
+{
+  // Possibly create sensors (usually, this returns a list of size 1.
+  std::vector<tgSensor*> newSensors =
+    m_sensorInfos[i]->createSensorsIfAppropriate(pSenseable);
+  // Add everything in the list to m_sensors.
+  // If an empty list has been returned, no sensors will be added.
+  // Also, need to check if any of the pointers are NULL.
+  for( size_t j=0; j < newSensors.size(); j++ ){
+    // If this sensor pointer is not null...
+    if( newSensors[j] != NULL) {
+      m_sensors.push_back(newSensors[j]);
+      // Each sensor gets its own copy of its info's policy, if any.
+      m_policies.push_back(m_infoPolicies[i] == NULL ?
+			   NULL : m_infoPolicies[i]->clone());
+    }
+  }
+}
+
+/**
+ * Helper for setup, for a senseable that is a tgModel.
+ * Infos that can search the model's index by type do so once, instead of
+ * being asked about every descendant. The sensors are still created in
+ * the same order as addSensorsHelper over the model and its descendants
+ * would, so the columns of a log do not move, and the other infos are
+ * asked in the same interleaving, as some keep state between calls.
+ */
+void tgDataManager::addModelSensorsHelper(tgModel* pModel)
+{
+  std::vector<tgSenseable*> items(1, pModel);
+  const std::vector<tgModel*>& descendants = pModel->getDescendants();
+  items.insert(items.end(), descendants.begin(), descendants.end());
+
+  // For each info, whether it searched by type, and what it found,
+  // marked against items.
+  const size_t nInfos = m_sensorInfos.size();
+  std::vector<bool> typed(nInfos, false);
+  std::vector< std::vector<bool> > hits(nInfos);
+  std::vector<tgSenseable*> found;
+  for (size_t i=0; i < nInfos; i++) {
+    found.clear();
+    if (!m_sensorInfos[i]->findSenseables(pModel, found)) {
+      continue;
+    }
+    typed[i] = true;
+    hits[i].assign(items.size(), false);
+    // Both lists are in getDescendants() order, so one pass matches them.
+    size_t f = 0;
+    for (size_t k=0; k < items.size() && f < found.size(); k++) {
+      if (items[k] == found[f]) {
+	hits[i][k] = true;
+	++f;
+      }
+    }
+    if (f != found.size()) {
+      throw std::logic_error("A sensor info found senseables that are not in the model, or out of order.");
+    }
+  }
+
+  for (size_t k=0; k < items.size(); k++) {
+    for (size_t i=0; i < nInfos; i++) {
+      if (typed[i] ? hits[i][k] : m_sensorInfos[i]->isThisMySenseable(items[k])) {
+	createSensorsHelper(i, items[k]);
       }
     }
   }
@@ -124,7 +200,14 @@ void tgDataManager::setup()
   // if appropriate.
   for (size_t j=0; j < m_senseables.size(); j++){
     // For each senseable object, create sensors for it and its descendants.
-    // First, the senseable itself:
+    // Models can be searched by type.
+    tgModel* const pModel =
+      tgCast::cast<tgSenseable, tgModel>(m_senseables[j]);
+    if (pModel != NULL) {
+      addModelSensorsHelper(pModel);
+      continue;
+    }
+    // Otherwise, first the senseable itself:
     addSensorsHelper(m_senseables[j]);
     // Then, for all its descendants:
     std::vector<tgSenseable*> descendants =
@@ -134,6 +217,35 @@ void tgDataManager::setup()
       addSensorsHelper(descendants[k]);
     }
   }
+
+  // Lay out the numeric frame, now that the list of sensors is final.
+  m_frameOffsets.clear();
+  m_frameSize = 0;
+  for (size_t i=0; i < m_sensors.size(); i++) {
+    const std::size_t n = m_sensors[i]->getSensorDataSize();
+    if (n != m_sensors[i]->getSensorDataHeadings().size()) {
+      throw std::runtime_error("A sensor's data size does not match its number of headings.");
+    }
+    m_frameOffsets.push_back(m_frameSize);
+    m_frameSize += n;
+    if (m_policies[i] != NULL) {
+      m_policies[i]->reset(n);
+    }
+  }
+  m_frame.assign(m_frameSize, 0.0);
+
+  // Nothing has been read through a channel yet.
+  m_channelSensors.resize(m_frameSize);
+  for (size_t i=0; i < m_sensors.size(); i++) {
+    const std::size_t end = (i + 1 < m_sensors.size() ?
+			     m_frameOffsets[i + 1] : m_frameSize);
+    std::fill(m_channelSensors.begin() + m_frameOffsets[i],
+	      m_channelSensors.begin() + end, i);
+  }
+  m_channelWanted.assign(m_frameSize, 0);
+  m_channelStamps.assign(m_frameSize, 0);
+  m_channelValues.assign(m_frameSize, 0.0);
+  m_channelStamp = 1;
   
   // Postcondition
   assert(invariant());
@@ -156,10 +268,19 @@ void tgDataManager::teardown()
     // The delete method will call their destructors.
     delete m_sensors[i];
     m_sensors[i] = NULL;
+    delete m_policies[i];
   }
   // Clear the list so that the destructor for this class doesn't have to
   // do anything.
   m_sensors.clear();
+  m_policies.clear();
+  m_frameOffsets.clear();
+  m_frameSize = 0;
+  m_frame.clear();
+  m_channelSensors.clear();
+  m_channelWanted.clear();
+  m_channelStamps.clear();
+  m_channelValues.clear();
 
   // Don't touch the list of senseable objects.
   // These tgModels are not re-created when teardown is called (I think?),
@@ -210,12 +331,24 @@ void tgDataManager::addSensorInfo(tgSensorInfo* pSensorInfo)
   } 
 
   m_sensorInfos.push_back(pSensorInfo);
+  m_infoPolicies.push_back(NULL);
 
   // Postcondition
   assert(invariant());
   assert(!m_sensorInfos.empty());
 }
 
+/**
+ * The policy is kept in the slot that addSensorInfo made for the info.
+ */
+void tgDataManager::addSensorInfo(tgSensorInfo* pSensorInfo,
+				  const tgSamplingPolicy& policy)
+{
+  addSensorInfo(pSensorInfo);
+  assert(m_infoPolicies.size() == m_sensorInfos.size());
+  m_infoPolicies.back() = policy.clone();
+}
+
 /**
  * This method adds sense-able objects to this data manager.
  * It takes in a pointer to a sense-able object and pushes it to the
@@ -254,13 +387,157 @@ std::string tgDataManager::toString() const
   return os.str();
 }
 
+std::size_t tgDataManager::getFrameSize() const
+{
+  return m_frameSize;
+}
+
+std::size_t tgDataManager::getFrameOffset(std::size_t sensorIndex) const
+{
+  if (sensorIndex >= m_frameOffsets.size())
+  {
+    throw std::out_of_range("sensorIndex is out of range in tgDataManager::getFrameOffset");
+  }
+  return m_frameOffsets[sensorIndex];
+}
+
+std::vector<std::string> tgDataManager::getFrameHeadings() const
+{
+  std::vector<std::string> frameHeadings;
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    std::vector<std::string> headings = m_sensors[i]->getSensorDataHeadings();
+    for (std::size_t j=0; j < headings.size(); j++) {
+      std::ostringstream os;
+      os << i << "_" << headings[j];
+      frameHeadings.push_back(os.str());
+    }
+  }
+  return frameHeadings;
+}
+
+/**
+ * The sensors write straight into the caller's buffer.
+ */
+void tgDataManager::sampleFrameInto(double* out) const
+{
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    m_sensors[i]->sampleInto(out + m_frameOffsets[i]);
+  }
+}
+
+const std::vector<double>& tgDataManager::sampleFrame()
+{
+  if (!m_frame.empty()) {
+    sampleFrameInto(&m_frame[0]);
+  }
+  return m_frame;
+}
+
+/**
+ * Each sensor is read into its own part of m_frame.
+ */
+void tgDataManager::sampleByPolicy(double time, tgSampleSink& sink)
+{
+  if (m_frame.empty()) {
+    return;
+  }
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    tgSamplingPolicy* const pPolicy = m_policies[i];
+    if (pPolicy != NULL && !pPolicy->isDue(time)) {
+      continue;
+    }
+    double* const values = &m_frame[0] + m_frameOffsets[i];
+    const std::size_t n = (i + 1 < m_sensors.size() ?
+			   m_frameOffsets[i + 1] : m_frameSize) - m_frameOffsets[i];
+    m_sensors[i]->sampleInto(values);
+    if (pPolicy != NULL) {
+      pPolicy->offer(i, time, values, sink);
+    }
+    else {
+      sink.write(i, time, values, n);
+    }
+  }
+}
+
+bool tgDataManager::hasSamplingPolicies() const
+{
+  for (std::size_t i=0; i < m_infoPolicies.size(); i++) {
+    if (m_infoPolicies[i] != NULL) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * A frame heading is tried first, then the sensors' own headings.
+ */
+std::size_t tgDataManager::findChannel(const std::string& heading) const
+{
+  const std::vector<std::string> frameHeadings = getFrameHeadings();
+  for (std::size_t i=0; i < frameHeadings.size(); i++) {
+    if (frameHeadings[i] == heading) {
+      return i;
+    }
+  }
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    const std::vector<std::string> headings =
+      m_sensors[i]->getSensorDataHeadings();
+    for (std::size_t j=0; j < headings.size(); j++) {
+      if (headings[j] == heading) {
+	return m_frameOffsets[i] + j;
+      }
+    }
+  }
+  throw std::out_of_range("No channel with heading " + heading +
+			  " in tgDataManager::findChannel");
+}
+
+/**
+ * A stale read samples the channel's sensor once, for all of its wanted
+ * fields, and stamps them so reads of its other fields in the same step
+ * are free.
+ */
+double tgDataManager::readChannel(std::size_t channel)
+{
+  if (channel >= m_frameSize) {
+    throw std::out_of_range("channel is out of range in tgDataManager::readChannel");
+  }
+  if (m_channelStamps[channel] != m_channelStamp) {
+    m_channelWanted[channel] = 1;
+    const std::size_t i = m_channelSensors[channel];
+    const std::size_t begin = m_frameOffsets[i];
+    const std::size_t end = (i + 1 < m_sensors.size() ?
+			     m_frameOffsets[i + 1] : m_frameSize);
+    m_sensors[i]->sampleWantedInto(&m_channelValues[begin],
+				   &m_channelWanted[begin]);
+    for (std::size_t j = begin; j < end; j++) {
+      if (m_channelWanted[j]) {
+	m_channelStamps[j] = m_channelStamp;
+      }
+    }
+  }
+  return m_channelValues[channel];
+}
+
+void tgDataManager::invalidateChannels()
+{
+  // Skip 0 on wrapping, so that fields never read are never current.
+  if (++m_channelStamp == 0) {
+    m_channelStamp = 1;
+    std::fill(m_channelStamps.begin(), m_channelStamps.end(), 0UL);
+  }
+}
 
 bool tgDataManager::invariant() const
 {
   // TO-DO:
   // m_sensors and m_sensorInfos are sane, check somehow...?
   // For example, check if any of the pointers in m_sensors are NULL.
-  return true;
+  // The frame layout is either empty, or matches the sensors.
+  return (m_frameOffsets.empty() || m_frameOffsets.size() == m_sensors.size()) &&
+    (m_policies.size() == m_sensors.size()) &&
+    (m_infoPolicies.size() == m_sensorInfos.size());
 }
 
 std::ostream&
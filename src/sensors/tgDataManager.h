@@ -37,6 +37,9 @@
 // Forward declarations
 class tgSensor;
 class tgSensorInfo;
+class tgSamplingPolicy;
+class tgSampleSink;
+class tgModel;
 
 /**
  * Abstract class for objects that will manage data within NTRTsim.
@@ -94,6 +97,15 @@ public:
      * @param[in] pSensorInfo a pointer to a tgSensorInfo.
      */
     virtual void addSensorInfo(tgSensorInfo* pSensorInfo);
+
+    /**
+     * Add a sensor info whose sensors are sampled by their own copy of a
+     * sampling policy, for sampleByPolicy.
+     * @param[in] pSensorInfo a pointer to a tgSensorInfo.
+     * @param[in] policy copied with tgSamplingPolicy::clone.
+     */
+    void addSensorInfo(tgSensorInfo* pSensorInfo,
+                       const tgSamplingPolicy& policy);
 	
     /**
      * Returns some basic information about this tgDataManager,
@@ -103,6 +115,82 @@ public:
      */
     virtual std::string toString() const;
 
+    /**
+     * The numeric frame: every sensor's data, one after the other, as
+     * doubles. The layout is fixed in setup and stays the same until
+     * teardown, so loggers, controllers and learners can all look up
+     * fields by offset once and then sample without allocating.
+     * @return the number of doubles in a frame.
+     */
+    std::size_t getFrameSize() const;
+
+    /**
+     * Where the data of a sensor starts within a frame.
+     * @param[in] sensorIndex the index of the sensor, in setup order.
+     * @return the offset of the sensor's first field.
+     * @throw std::out_of_range if there is no such sensor.
+     */
+    std::size_t getFrameOffset(std::size_t sensorIndex) const;
+
+    /**
+     * A heading for each field of the frame. Each is the sensor's own
+     * heading, prefixed with the sensor index and an underscore, the same
+     * as in a tgDataLogger2 log file.
+     */
+    std::vector<std::string> getFrameHeadings() const;
+
+    /**
+     * Sample every sensor into a buffer owned by the caller.
+     * @param[out] out a buffer with room for getFrameSize() doubles.
+     */
+    void sampleFrameInto(double* out) const;
+
+    /**
+     * Sample every sensor into this data manager's own frame buffer.
+     * @return the frame, valid until the next call or teardown.
+     */
+    const std::vector<double>& sampleFrame();
+
+    /**
+     * Read the sensors whose policies are due, or that have none, and
+     * let the policies pass the samples they keep to a sink. Nothing is
+     * allocated.
+     * @param[in] time the simulation time of this step.
+     * @param[in,out] sink where the samples go.
+     */
+    void sampleByPolicy(double time, tgSampleSink& sink);
+
+    /** True if any sensor has a sampling policy */
+    bool hasSamplingPolicies() const;
+
+    /**
+     * Look up a field of the frame for readChannel. Channels are frame
+     * indices, fixed from setup until teardown.
+     * @param[in] heading a frame heading such as "0_rod(t1).X", or a
+     * sensor's own heading such as "rod(t1).X", which names the first
+     * sensor that has it.
+     * @return the field's index in the frame.
+     * @throw std::out_of_range if no field has that heading.
+     */
+    std::size_t findChannel(const std::string& heading) const;
+
+    /**
+     * Read one field, sampling its sensor only if the field has not been
+     * read since the last invalidateChannels(). The sensor is asked for
+     * every field that has ever been read, and no others, so a
+     * controller that reads a rod's position never pays for the rod's
+     * orientation. Nothing is allocated.
+     * @param[in] channel an index from findChannel.
+     * @throw std::out_of_range if there is no such channel.
+     */
+    double readChannel(std::size_t channel);
+
+    /**
+     * Mark every channel stale, so the next readChannel samples again.
+     * tgSimulation calls this at the start of each step.
+     */
+    void invalidateChannels();
+
  private:
 
     /**
@@ -112,6 +200,19 @@ public:
      */
     void addSensorsHelper(tgSenseable* pSenseable);
 
+    /**
+     * As addSensorsHelper over a model and all its descendants, letting
+     * the sensor infos that can search by type do so.
+     * @param[in] pModel one of this object's senseables.
+     */
+    void addModelSensorsHelper(tgModel* pModel);
+
+    /**
+     * Create the sensors for a senseable that sensor info i accepted,
+     * with copies of the info's sampling policy.
+     */
+    void createSensorsHelper(size_t i, tgSenseable* pSenseable);
+
 protected:
 
     // Integrity predicate.
@@ -130,12 +231,52 @@ protected:
      */
     std::vector<tgSensorInfo*> m_sensorInfos;
 
+    /**
+     * The sampling policy to copy for each sensor info's sensors, or
+     * NULL, parallel to m_sensorInfos.
+     */
+    std::vector<tgSamplingPolicy*> m_infoPolicies;
+
+    /**
+     * Each sensor's sampling policy, or NULL, parallel to m_sensors.
+     */
+    std::vector<tgSamplingPolicy*> m_policies;
+
     /**
      * A data manager will also have a list of tgSenseable objects 
      * (really, just tgModels most of the time) that it will collect data from.
      */
     std::vector<tgSenseable*> m_senseables;
 
+    /**
+     * The start of each sensor's data within a frame, parallel to m_sensors.
+     */
+    std::vector<std::size_t> m_frameOffsets;
+
+    /**
+     * The total size of a frame.
+     */
+    std::size_t m_frameSize;
+
+    /**
+     * The buffer that sampleFrame fills.
+     */
+    std::vector<double> m_frame;
+
+    /**
+     * For readChannel, parallel to m_frame: the sensor each field belongs
+     * to, whether it has been read since setup, the m_channelStamp it was
+     * last sampled at, and that sample. The values are kept apart from
+     * m_frame, which sampleByPolicy overwrites.
+     */
+    std::vector<std::size_t> m_channelSensors;
+    std::vector<char> m_channelWanted;
+    std::vector<unsigned long> m_channelStamps;
+    std::vector<double> m_channelValues;
+
+    /** Advanced by invalidateChannels; never 0 between setup and teardown */
+    unsigned long m_channelStamp;
+
 };
 
 /**
@@ -26,25 +26,80 @@
 
 #include "tgDataObserver.h"
 
-#include "tgDataLogger.h"
+#include "tgAsyncDataLogger.h"
+#include "tgBinaryDataLogger.h"
+#include "tgDataManager.h"
+#include "tgMarkerSensorInfo.h"
+#include "tgRodSensor.h"
+#include "tgRodSensorInfo.h"
+#include "tgSpringCableActuatorSensor.h"
+#include "tgSpringCableActuatorSensorInfo.h"
 
-#include "core/tgCast.h"
 #include "core/tgModel.h"
-#include "core/tgRod.h"
-#include "core/tgString.h"
 #include "core/abstractMarker.h"
 
-#include "core/tgSpringCableActuator.h"
+#include "LinearMath/btVector3.h"
 
+#include <cstdlib>
 #include <iostream>
 #include <sstream>  
 #include <time.h>
 #include <stdexcept>
 
+namespace
+{
+    /** Lets tgDataObserver see which sensor each part of the frame is from */
+    class tgObserverFrame : public tgDataManager
+    {
+    public:
+        const std::vector<tgSensor*>& getSensors() const
+        {
+            return m_sensors;
+        }
+    };
+
+    tgDataObserver::Format formatFromEnvironment()
+    {
+        const char* name = std::getenv("NTRT_DATA_OBSERVER_FORMAT");
+        const std::string format = name == NULL ? "" : name;
+        if (format == "binary")
+        {
+            return tgDataObserver::eBinary;
+        }
+        else if (format == "async")
+        {
+            return tgDataObserver::eAsync;
+        }
+        return tgDataObserver::eText;
+    }
+
+    /** The model's tags, as the original tgDataObserver named columns */
+    std::string tagsOf(const tgSensor& sensor)
+    {
+        std::stringstream tags;
+        const tgModel* pModel = dynamic_cast<const tgModel*>(sensor.getSenseable());
+        if (pModel != NULL)
+        {
+            tags << pModel->getTags();
+        }
+        return tags.str();
+    }
+}
+
 tgDataObserver::tgDataObserver(std::string filePrefix) :
+m_filePrefix(filePrefix),
+m_format(formatFromEnvironment()),
 m_totalTime(0.0),
-m_dataLogger(NULL),
-m_filePrefix(filePrefix)
+m_pDataManager(NULL)
+{
+
+}
+
+tgDataObserver::tgDataObserver(std::string filePrefix, Format format) :
+m_filePrefix(filePrefix),
+m_format(format),
+m_totalTime(0.0),
+m_pDataManager(NULL)
 {
 
 }
@@ -52,20 +107,66 @@ m_filePrefix(filePrefix)
 /** A class with virtual member functions must have a virtual destructor. */
 tgDataObserver::~tgDataObserver()
 { 
-    delete m_dataLogger;
-    tgOutput.close();
+    finish();
+}
+
+void tgDataObserver::finish()
+{
+    if (m_pDataManager != NULL)
+    {
+        // Lets a logger write out its last rows before the sensors go
+        m_pDataManager->teardown();
+        delete m_pDataManager;
+        m_pDataManager = NULL;
+    }
+    if (tgOutput.is_open())
+    {
+        tgOutput.close();
+    }
 }
 
 /**@todo move functions to constructor when possible */
 void tgDataObserver::onSetup(tgModel& model)
 {
+    // prevent leaks on loop behavior (better than teardown?)
+    finish();
+    m_totalTime = 0.0;
+
+    if (m_format == eBinary)
+    {
+        m_pDataManager = new tgBinaryDataLogger(m_filePrefix);
+    }
+    else if (m_format == eAsync)
+    {
+        m_pDataManager = new tgAsyncDataLogger(m_filePrefix);
+    }
+    else
+    {
+        m_pDataManager = new tgObserverFrame();
+    }
+    m_pDataManager->addSenseable(&model);
+    m_pDataManager->addSensorInfo(new tgRodSensorInfo());
+    m_pDataManager->addSensorInfo(new tgSpringCableActuatorSensorInfo());
+    if (m_format != eText)
+    {
+        // The text format writes the markers itself
+        m_pDataManager->addSensorInfo(new tgMarkerSensorInfo());
+    }
+    // The loggers open their own files here
+    m_pDataManager->setup();
+
+    if (m_format != eText)
+    {
+        return;
+    }
+
 	/*
 	 * Adapted from: http://www.cplusplus.com/reference/clibrary/ctime/localtime/
 	 * Also http://www.cplusplus.com/forum/unices/2259/
 	*/
     time_t rawtime;
     tm* currentTime;
-    int fileTimeSize = 64;
+    const int fileTimeSize = 64;
     char fileTime [fileTimeSize];
     
     time (&rawtime);
@@ -74,17 +175,7 @@ void tgDataObserver::onSetup(tgModel& model)
     m_fileName = m_filePrefix + fileTime;
     std::cout << m_fileName << std::endl;
     
-    if (m_dataLogger != NULL)
-    {
-        // prevent leaks on loop behavior (better than teardown?)
-        delete m_dataLogger;
-    }
-    
-    m_dataLogger = new tgDataLogger(m_fileName);
-    
-    m_totalTime = 0.0;
-    
-    // First time opening this, so nothing to append to
+    // Kept open until the next setup or destruction
     tgOutput.open(m_fileName.c_str());
     
 	if (!tgOutput.is_open())
@@ -92,8 +183,6 @@ void tgDataObserver::onSetup(tgModel& model)
 		throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
 	}
     
-    std::vector<tgModel*> children = model.getDescendants();
-    
     /*
      * Numbers to ensure uniqueness of variable names in log
      * May be redundant with tag
@@ -106,9 +195,6 @@ void tgDataObserver::onSetup(tgModel& model)
     // Markers are written first
     const std::vector<abstractMarker>& markers = model.getMarkers();
     
-    const std::size_t n = 0;
-
-    
     for (std::size_t i = 0; i < markers.size(); i++)
     {
         std::stringstream name;
@@ -119,53 +205,84 @@ void tgDataObserver::onSetup(tgModel& model)
             << name.str() << "_Z" << ",";
     }
     
-    for (std::size_t i = 0; i < children.size(); i++)
+    // The sensors are in getDescendants() order, as the models were
+    const tgObserverFrame& frame = static_cast<const tgObserverFrame&>(*m_pDataManager);
+    const std::vector<tgSensor*>& sensors = frame.getSensors();
+    m_columns.clear();
+    for (std::size_t i = 0; i < sensors.size(); i++)
     {
-        /* If its a type we'll be logging, record its name and the 
-         * variable types we'll be logging later
-         */
         std::stringstream name;
+        const std::size_t offset = frame.getFrameOffset(i);
         
-        if(tgCast::cast<tgModel, tgSpringCableActuator>(children[i]) != 0) 
+        if (dynamic_cast<tgSpringCableActuatorSensor*>(sensors[i]) != NULL)
         {
-            name << children[i]->getTags() <<  " " << stringNum;
+            // Rest length, current length and tension
+            name << tagsOf(*sensors[i]) <<  " " << stringNum;
             tgOutput <<  name.str() << "_RL" << ","
             <<  name.str() << "_AL" << ","
             <<  name.str() << "_Ten" << ",";
+            m_columns.push_back(offset);
+            m_columns.push_back(offset + 1);
+            m_columns.push_back(offset + 2);
             stringNum++;
         }
-        else if(tgCast::cast<tgModel, tgRod>(children[i]) != 0)
+        else if (dynamic_cast<tgRodSensor*>(sensors[i]) != NULL)
         {
-            name << children[i]->getTags() <<  " " << rodNum;
+            // The center of mass and the mass, without the Euler angles
+            name << tagsOf(*sensors[i]) <<  " " << rodNum;
             tgOutput << name.str() << "_X" << ","
             << name.str() << "_Y" << ","
             << name.str() << "_Z" << ","
             << name.str() << "_mass" << ",";
+            m_columns.push_back(offset);
+            m_columns.push_back(offset + 1);
+            m_columns.push_back(offset + 2);
+            m_columns.push_back(offset + 6);
             rodNum++;
         }
-        // Else do nothing since tgDataLogger won't touch it
     }
     
     tgOutput << std::endl;
-    
-    tgOutput.close();
 }
 
 /**
- * Dispatch the visitors to the given model and log data
+ * Sample the sensors and log the data
  * @param[in] the number of seconds since the previous call; must be
  * positive
  */
 void tgDataObserver::onStep(tgModel& model, double dt)
 {  
+    if (m_pDataManager == NULL)
+    {
+        throw std::logic_error("tgDataObserver::onStep called before onSetup");
+    }
+
+    if (m_format != eText)
+    {
+        m_pDataManager->step(dt);
+        return;
+    }
+
     m_totalTime += dt;
-    tgOutput.open(m_fileName.c_str(), std::ios::app);
     tgOutput << m_totalTime << ",";
-    tgOutput.close();
 
-    model.onVisit(*m_dataLogger);
-    
-    tgOutput.open(m_fileName.c_str(), std::ios::app);
-    tgOutput << std::endl;
-    tgOutput.close();
+    // Evaluated together from the published body states
+    const std::vector<btVector3>& markers =
+        model.getMarkerFrame().getPositions();
+    for (std::size_t i = 0; i < markers.size(); i++)
+    {
+        const btVector3& worldPos = markers[i];
+        tgOutput << worldPos[0] << ","
+        << worldPos[1] << ","
+        << worldPos[2] << ",";
+    }
+
+    const std::vector<double>& frame = m_pDataManager->sampleFrame();
+    for (std::size_t i = 0; i < m_columns.size(); i++)
+    {
+        tgOutput << frame[m_columns[i]] << ",";
+    }
+
+    // No flush: the stream writes whole buffers
+    tgOutput << '\n';
 }
@@ -29,29 +29,55 @@
 
 #include <fstream>
 #include <string>
+#include <vector>
 
 class tgModel;
-class tgDataLogger;
+class tgDataManager;
 
 /**
- * A class that dispatches data loggers. Should be included by observers,
- * since they will know when to step this, and we don't have any model
- * specific information here.
+ * Logs the rods and spring cable actuators of a model, for the apps that
+ * predate tgDataManager. It is a thin adapter over the tgDataManager
+ * numeric frame: onSetup makes tgRodSensors and
+ * tgSpringCableActuatorSensors for the model, and onStep samples them.
+ *
+ * eText writes the same text file as before, with the file kept open.
+ * eBinary and eAsync hand the sensors to a tgBinaryDataLogger or a
+ * tgAsyncDataLogger instead, which log every sensor field. Apps that use
+ * the one argument constructor can pick the format without code changes
+ * by setting the environment variable NTRT_DATA_OBSERVER_FORMAT to
+ * "binary" or "async".
  */
 
 class tgDataObserver
 {
 public:
+    /** How the data is written */
+    enum Format
+    {
+        /** The original comma separated text file */
+        eText,
+        /** A tgBinaryDataLogger file */
+        eBinary,
+        /** A tgBinaryDataLogger file written by a tgAsyncDataLogger */
+        eAsync
+    };
+
+    /** Uses the format named by NTRT_DATA_OBSERVER_FORMAT, eText if unset */
     tgDataObserver(std::string filePrefix);
+
+    tgDataObserver(std::string filePrefix, Format format);
     
     /** A class with virtual member functions must have a virtual destructor. */
     virtual ~tgDataObserver();
     
-    /**@todo move functions to constructor when possible */
+    /**
+     * Make the sensors and start a new file, finishing any previous one.
+     * @todo move functions to constructor when possible
+     */
     virtual void onSetup(tgModel& model);
     
     /**
-     * Dispatch the visitors to the given model and log data
+     * Sample the sensors and log the data
      * @param[in] the number of seconds since the previous call; must be
      * positive
      */
@@ -60,6 +86,9 @@ public:
     /** @todo add reset method so we can start a new file when
      * the simulation resets */
 private:
+
+    /** Write out and delete the previous data manager, if any */
+    void finish();
     
     std::ofstream tgOutput;
     
@@ -67,10 +96,16 @@ private:
     
     ///@todo find a way to move things to the constructor and remove this
     std::string m_filePrefix;
+
+    Format m_format;
     
     double m_totalTime;
     
-    tgDataLogger * m_dataLogger;
+    /** The sensors; a tgBinaryDataLogger unless the format is eText */
+    tgDataManager* m_pDataManager;
+
+    /** For eText, the fields of the frame written, in order */
+    std::vector<std::size_t> m_columns;
 };
    
 #endif
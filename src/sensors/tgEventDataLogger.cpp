@@ -0,0 +1,167 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgEventDataLogger.cpp
+ * @brief Contains the definitions of members of class tgEventDataLogger.
+ * $Id$
+ */
+
+// This module
+#include "tgEventDataLogger.h"
+// This application
+#include "tgSensor.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <cassert>
+#include <sstream>
+#include <vector>
+#include <time.h> // for the file name of the log file
+#include <cstdlib> // for getenv, converting ~ to $HOME.
+
+tgEventDataLogger::tgEventDataLogger(std::string fileNamePrefix) :
+  tgDataManager(),
+  m_fileNamePrefix(fileNamePrefix),
+  m_totalTime(0.0)
+{
+  if (m_fileNamePrefix == "") {
+    throw std::invalid_argument("File name cannot be the empty string. Please pass in a path to a file that can be opened.");
+  }
+
+  // Expand a leading "~" to the user's home directory.
+  if (m_fileNamePrefix.at(0) == '~') {
+    std::string home = std::getenv("HOME");
+    m_fileNamePrefix.erase(0,1);
+    m_fileNamePrefix = home + m_fileNamePrefix;
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+tgEventDataLogger::~tgEventDataLogger()
+{
+  if (m_output.is_open()) {
+    m_output.close();
+  }
+}
+
+void tgEventDataLogger::setup()
+{
+  // Call the parent's setup method, which creates the sensors and resets
+  // their policies.
+  tgDataManager::setup();
+
+  // A setup without teardown: finish the previous file.
+  if (m_output.is_open()) {
+    m_output.close();
+  }
+
+  // Name the file by the current time, as tgDataLogger2 does.
+  time_t rawtime;
+  tm* currentTime;
+  const int fileTimeSize = 64;
+  char fileTime [fileTimeSize];
+
+  time (&rawtime);
+  currentTime = localtime(&rawtime);
+  strftime(fileTime, fileTimeSize, "%m%d%Y_%H%M%S", currentTime);
+  m_fileName = m_fileNamePrefix + "_" + fileTime + ".txt";
+
+  std::cout << "tgEventDataLogger will be saving data to the file: " << std::endl
+	    << m_fileName << std::endl;
+
+  m_output.open(m_fileName.c_str());
+  if (!m_output.is_open()) {
+    throw std::runtime_error("Log file could not be opened. Usually, this is because the directory you specified does not exist. Check for spelling errors.");
+  }
+
+  m_output << "tgEventDataLogger started logging at time " << fileTime << ", with "
+	   << m_sensors.size() << " sensors on " << m_senseables.size()
+	   << " senseable objects." << std::endl;
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    std::vector<std::string> headings = m_sensors[i]->getSensorDataHeadings();
+    m_output << "#" << i << ",";
+    for (std::size_t j=0; j < headings.size(); j++) {
+      m_output << i << "_" << headings[j] << ",";
+    }
+    m_output << std::endl;
+  }
+  m_output << "time,sensor,values" << std::endl;
+
+  m_totalTime = 0.0;
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgEventDataLogger::teardown()
+{
+  if (m_output.is_open()) {
+    m_output.close();
+  }
+  tgDataManager::teardown();
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgEventDataLogger::step(double dt)
+{
+  if (dt <= 0.0)
+  {
+    throw std::invalid_argument("dt is not positive");
+  }
+  else
+  {
+    m_totalTime += dt;
+    // Nothing to write to before setup or after teardown.
+    if (m_output.is_open()) {
+      sampleByPolicy(m_totalTime, *this);
+    }
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgEventDataLogger::write(std::size_t sensorIndex, double time,
+			      const double* values, std::size_t count)
+{
+  m_output << time << "," << sensorIndex << ",";
+  for (std::size_t i=0; i < count; i++) {
+    m_output << values[i] << ",";
+  }
+  m_output << '\n';
+}
+
+std::string tgEventDataLogger::toString() const
+{
+  std::ostringstream os;
+  os << tgDataManager::toString()
+     << "This tgDataManager is a tgEventDataLogger. " << std::endl;
+
+  return os.str();
+}
+
+std::ostream&
+operator<<(std::ostream& os, const tgEventDataLogger& obj)
+{
+    os << obj.toString() << std::endl;
+    return os;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_EVENT_DATA_LOGGER_H
+#define TG_EVENT_DATA_LOGGER_H
+
+/**
+ * @file tgEventDataLogger.h
+ * @brief Contains the definition of class tgEventDataLogger.
+ * $Id$
+ */
+
+// Includes from NTRTsim
+#include "tgDataManager.h"
+#include "tgSamplingPolicy.h"
+// Includes from the C++ standard library
+#include <fstream> // for writing to a file
+#include <iostream>
+#include <string>
+
+/**
+ * tgEventDataLogger logs each sensor on its own schedule, as set by the
+ * tgSamplingPolicy passed with its sensor info: e.g. a rod's position at
+ * a low fixed rate, and cable tensions at every step around contact
+ * events only. Sensor infos added without a policy are logged on every
+ * step.
+ *
+ * Since sensors are not sampled together, each line of the text file
+ * holds one sample of one sensor, "time,sensor,values...". The file
+ * starts with a description line, a line for each sensor,
+ * "#sensor,headings...", with the headings as tgDataLogger2 writes them,
+ * and a "time,sensor,values" line.
+ */
+class tgEventDataLogger : public tgDataManager, private tgSampleSink
+{
+ public:
+
+  /**
+   * @param[in] fileNamePrefix a string that specifies the path to the log
+   * file that will be written. The current time and ".txt" will be
+   * appended to this prefix.
+   */
+  tgEventDataLogger(std::string fileNamePrefix);
+
+  /**
+   * The destructor closes the file if teardown was not called.
+   */
+  virtual ~tgEventDataLogger();
+
+  /**
+   * Creates the sensors, opens a new log file, and writes the header.
+   */
+  virtual void setup();
+
+  /**
+   * Closes the log file.
+   */
+  virtual void teardown();
+
+  /**
+   * Passes the sensors to their policies.
+   * @param[in] dt a double, the amount of time since the last step.
+   */
+  virtual void step(double dt);
+
+  /**
+   * Overwrite toString for the superclass to specify that this data manager
+   * is a tgEventDataLogger.
+   */
+  virtual std::string toString() const;
+
+ private:
+
+  virtual void write(std::size_t sensorIndex, double time,
+		     const double* values, std::size_t count);
+
+  /**
+   * The full name of the current log file, created in setup.
+   */
+  std::string m_fileName;
+
+  /**
+   * The prefix passed in to the constructor, with "~" expanded.
+   */
+  std::string m_fileNamePrefix;
+
+  /**
+   * The log file, open from setup until teardown.
+   */
+  std::ofstream m_output;
+
+  double m_totalTime;
+
+};
+
+/**
+ * Overload operator<<() to handle tgEventDataLogger
+ * @param[in,out] os an ostream
+ * @param[in] obj a tgEventDataLogger
+ * @return os
+ */
+std::ostream&
+operator<<(std::ostream& os, const tgEventDataLogger& obj);
+
+#endif // TG_EVENT_DATA_LOGGER_H
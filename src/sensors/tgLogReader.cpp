@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgLogReader.cpp
+ * @brief Contains the definitions of members of class tgLogReader.
+ * $Id$
+ */
+
+// This module
+#include "tgLogReader.h"
+#include "tgBinaryLogReader.h"
+#include "tgPoseStreamReader.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+tgLogReader* tgLogReader::open(const std::string& fileName)
+{
+  std::ifstream input(fileName.c_str(), std::ios::in | std::ios::binary);
+  if (!input.is_open()) {
+    throw std::runtime_error("Log file could not be opened.");
+  }
+  char magic[8] = {0};
+  input.read(magic, sizeof(magic));
+  input.close();
+
+  const char kPoseStream[8] = {'N', 'T', 'R', 'T', 'P', 'O', 'S', '1'};
+  if (std::equal(magic, magic + sizeof(magic), kPoseStream)) {
+    return new tgPoseStreamReader(fileName);
+  }
+  // tgBinaryLogReader checks its own magic
+  return new tgBinaryLogReader(fileName);
+}
+
+std::size_t tgLogReader::findColumn(const std::string& heading) const
+{
+  const std::vector<std::string>& headings = getHeadings();
+  for (std::size_t c = 0; c < headings.size(); c++) {
+    if (headings[c] == heading) {
+      return c;
+    }
+  }
+  return headings.size();
+}
+
+std::size_t tgLogReader::findRow(double time) const
+{
+  const std::size_t rowCount = getRowCount();
+  if (rowCount == 0) {
+    throw std::out_of_range("The log has no rows.");
+  }
+  // The last row whose time is not after the one asked for
+  std::size_t lo = 0;
+  std::size_t hi = rowCount;
+  while (hi - lo > 1) {
+    const std::size_t mid = (lo + hi) / 2;
+    if (getTime(mid) <= time) {
+      lo = mid;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_LOG_READER_H
+#define TG_LOG_READER_H
+
+/**
+ * @file tgLogReader.h
+ * @brief Contains the definition of interface class tgLogReader.
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <string>
+#include <vector>
+
+/**
+ * Random access to the rows of a log written by one of the binary loggers,
+ * for tgReplayView and other tools that scrub back and forth through a
+ * run. Use open to get the right reader for a file.
+ */
+class tgLogReader
+{
+ public:
+
+  virtual ~tgLogReader() { }
+
+  /**
+   * Open a tgBinaryDataLogger, tgAsyncDataLogger or tgPoseStreamLogger
+   * log, whichever the file is.
+   * @param[in] fileName the path of the log.
+   * @return a new reader, owned by the caller.
+   * @throw std::runtime_error if the file can't be read or is none of these.
+   */
+  static tgLogReader* open(const std::string& fileName);
+
+  /** The description line the logger wrote. */
+  virtual const std::string& getDescription() const = 0;
+
+  /** The headings, the first being "time". */
+  virtual const std::vector<std::string>& getHeadings() const = 0;
+
+  /**
+   * The index of a heading.
+   * @return the column, or getHeadings().size() if there is none.
+   */
+  std::size_t findColumn(const std::string& heading) const;
+
+  virtual std::size_t getRowCount() const = 0;
+
+  /**
+   * One value.
+   * @param[in] row less than getRowCount().
+   * @param[in] column less than getHeadings().size().
+   */
+  virtual double getValue(std::size_t row, std::size_t column) const = 0;
+
+  /** The time of a row, i.e. getValue(row, 0). */
+  virtual double getTime(std::size_t row) const
+  {
+    return getValue(row, 0);
+  }
+
+  /**
+   * The last row logged at or before a time, found by bisection.
+   * @return 0 if time is before the first row.
+   * @throw std::out_of_range if the log has no rows.
+   */
+  std::size_t findRow(double time) const;
+};
+
+#endif // TG_LOG_READER_H
@@ -0,0 +1,123 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgMarkerSensor.cpp
+ * @brief Contains the definitions of members of class tgMarkerSensor.
+ * $Id$
+ */
+
+// This module
+#include "tgMarkerSensor.h"
+// Includes from NTRT:
+#include "core/tgCast.h"
+#include "core/tgMarkerFrame.h"
+#include "core/tgModel.h"
+#include "core/tgSenseable.h"
+#include "core/tgTags.h"
+// Includes from the C++ standard library:
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+  /** The values per marker: the position, then the velocity */
+  const std::size_t kFields = 6;
+
+  std::size_t countMarkers(tgModel* pModel)
+  {
+    if (pModel == NULL) {
+      throw std::invalid_argument("Pointer to pModel is NULL inside tgMarkerSensor.");
+    }
+    return pModel->getMarkers().size();
+  }
+}
+
+tgMarkerSensor::tgMarkerSensor(tgModel* pModel) :
+  tgSensor(pModel),
+  m_markerCount(countMarkers(pModel))
+{
+}
+
+tgMarkerSensor::~tgMarkerSensor()
+{
+}
+
+std::vector<std::string> tgMarkerSensor::getSensorDataHeadings()
+{
+  tgModel* const pModel = tgCast::cast<tgSenseable, tgModel>(m_pSens);
+  assert(pModel != 0);
+  // As for the other sensors, the type, then the tags, then the field,
+  // here with the marker's index first
+  const std::string prefix = "marker(" + pModel->getTags() + ").";
+  std::vector<std::string> headings;
+  for (std::size_t i = 0; i < m_markerCount; i++) {
+    std::stringstream marker;
+    marker << prefix << i << ".";
+    headings.push_back(marker.str() + "X");
+    headings.push_back(marker.str() + "Y");
+    headings.push_back(marker.str() + "Z");
+    headings.push_back(marker.str() + "VX");
+    headings.push_back(marker.str() + "VY");
+    headings.push_back(marker.str() + "VZ");
+  }
+  return headings;
+}
+
+std::vector<std::string> tgMarkerSensor::getSensorData()
+{
+  std::vector<double> data(getSensorDataSize());
+  if (!data.empty()) {
+    sampleInto(&data[0]);
+  }
+  std::vector<std::string> sensordata;
+  for (std::size_t i = 0; i < data.size(); i++) {
+    std::stringstream value;
+    value << data[i];
+    sensordata.push_back(value.str());
+  }
+  return sensordata;
+}
+
+std::size_t tgMarkerSensor::getSensorDataSize()
+{
+  return kFields * m_markerCount;
+}
+
+void tgMarkerSensor::sampleInto(double* out)
+{
+  tgModel* const pModel = tgCast::cast<tgSenseable, tgModel>(m_pSens);
+  assert(pModel != 0);
+  const tgMarkerFrame& frame = pModel->getMarkerFrame();
+  const std::vector<btVector3>& positions = frame.getPositions();
+  const std::vector<btVector3>& velocities = frame.getVelocities();
+
+  const std::size_t n = std::min(m_markerCount, frame.size());
+  for (std::size_t i = 0; i < n; i++) {
+    double* const row = out + kFields * i;
+    row[0] = positions[i].x();
+    row[1] = positions[i].y();
+    row[2] = positions[i].z();
+    row[3] = velocities[i].x();
+    row[4] = velocities[i].y();
+    row[5] = velocities[i].z();
+  }
+  std::fill(out + kFields * n, out + kFields * m_markerCount, 0.0);
+}
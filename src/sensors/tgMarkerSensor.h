@@ -0,0 +1,73 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_MARKER_SENSOR_H
+#define TG_MARKER_SENSOR_H
+
+/**
+ * @file tgMarkerSensor.h
+ * @brief Contains the definition of class tgMarkerSensor.
+ * $Id$
+ */
+
+// Includes from the sensors directory:
+#include "tgSensor.h"
+
+// Forward declarations
+class tgModel;
+
+/**
+ * This class extends tgSensor to sense the markers of a tgModel, as a
+ * motion capture system would: for each marker, its world position then
+ * the velocity of its point, X, Y and Z each.
+ *
+ * The values come from tgModel::getMarkerFrame, which evaluates all of
+ * the markers in one pass over the published body states, so logging
+ * many markers at every step with a tgBinaryDataLogger stays cheap. The
+ * number of markers is fixed when the sensor is created.
+ */
+class tgMarkerSensor : public tgSensor
+{
+public:
+
+  /**
+   * @param[in] pModel the model whose own markers are sensed; the
+   * markers of its descendants have sensors of their own.
+   * @throw std::invalid_argument if pModel is NULL.
+   */
+  tgMarkerSensor(tgModel* pModel);
+
+  virtual ~tgMarkerSensor();
+
+  virtual std::vector<std::string> getSensorDataHeadings();
+  virtual std::vector<std::string> getSensorData();
+
+  /**
+   * Numeric versions of the above, see tgSensor. Markers added since
+   * the sensor was created are left out, and removed ones read as 0.
+   */
+  virtual std::size_t getSensorDataSize();
+  virtual void sampleInto(double* out);
+
+private:
+
+  /** The number of markers when the sensor was created */
+  const std::size_t m_markerCount;
+};
+
+#endif // TG_MARKER_SENSOR_H
@@ -0,0 +1,60 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgMarkerSensorInfo.cpp
+ * @brief Contains the definitions of members of class tgMarkerSensorInfo.
+ * $Id$
+ */
+
+// This module
+#include "tgMarkerSensorInfo.h"
+// Other includes from NTRTsim
+#include "tgMarkerSensor.h"
+#include "core/abstractMarker.h"
+#include "core/tgCast.h"
+#include "core/tgModel.h"
+#include "core/tgSenseable.h"
+// Other includes from the C++ standard library
+#include <stdexcept>
+
+tgMarkerSensorInfo::tgMarkerSensorInfo()
+{
+}
+
+tgMarkerSensorInfo::~tgMarkerSensorInfo()
+{
+}
+
+bool tgMarkerSensorInfo::isThisMySenseable(tgSenseable* pSenseable)
+{
+  tgModel* pModel = tgCast::cast<tgSenseable, tgModel>(pSenseable);
+  return pModel != 0 && !pModel->getMarkers().empty();
+}
+
+std::vector<tgSensor*>
+tgMarkerSensorInfo::createSensorsIfAppropriate(tgSenseable* pSenseable)
+{
+  if (!isThisMySenseable(pSenseable)) {
+    throw std::invalid_argument("pSenseable is NOT a tgModel with markers, inside tgMarkerSensorInfo.");
+  }
+  std::vector<tgSensor*> newSensors;
+  newSensors.push_back(new tgMarkerSensor(
+    tgCast::cast<tgSenseable, tgModel>(pSenseable)));
+  return newSensors;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_MARKER_SENSOR_INFO_H
+#define TG_MARKER_SENSOR_INFO_H
+
+/**
+ * @file tgMarkerSensorInfo.h
+ * @brief Contains the definition of class tgMarkerSensorInfo.
+ * $Id$
+ */
+
+// This module
+#include "tgSensorInfo.h"
+
+// Forward references
+class tgSenseable;
+class tgSensor;
+
+/**
+ * Creates a tgMarkerSensor for every tgModel that has markers of its
+ * own, for motion capture style logging.
+ */
+class tgMarkerSensorInfo : public tgSensorInfo
+{
+ public:
+
+  tgMarkerSensorInfo();
+
+  ~tgMarkerSensorInfo();
+
+  /**
+   * True if pSenseable is a tgModel with at least one marker.
+   */
+  virtual bool isThisMySenseable(tgSenseable* pSenseable);
+
+  /**
+   * Create a marker sensor for a tgModel with markers. Returns a list
+   * of size 1.
+   * @throws invalid_argument if pSenseable is not a tgModel with markers.
+   */
+  virtual std::vector<tgSensor*> createSensorsIfAppropriate(tgSenseable* pSenseable);
+};
+
+#endif // TG_MARKER_SENSOR_INFO_H
@@ -0,0 +1,217 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgPoseStreamCodec.cpp
+ * @brief Contains the definitions of members of class tgPoseStreamCodec.
+ * $Id$
+ */
+
+// This module
+#include "tgPoseStreamCodec.h"
+// The C++ Standard Library
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+  /** The quantized value of a smallest-three component of 1/sqrt(2) */
+  const double kRotationScale = 32767.0 * 1.41421356237309505;
+
+  void writeVarint(std::vector<unsigned char>& out, uint64_t v)
+  {
+    while (v >= 0x80) {
+      out.push_back(static_cast<unsigned char>(v | 0x80));
+      v >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(v));
+  }
+
+  /** Small magnitudes of either sign to small unsigned numbers */
+  void writeSigned(std::vector<unsigned char>& out, int64_t v)
+  {
+    writeVarint(out, (static_cast<uint64_t>(v) << 1) ^
+		static_cast<uint64_t>(v >> 63));
+  }
+
+  uint64_t readVarint(const unsigned char*& p, const unsigned char* pEnd)
+  {
+    uint64_t v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      if (p == pEnd) {
+	throw std::runtime_error("Pose stream frame is truncated.");
+      }
+      const unsigned char byte = *p++;
+      v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+	return v;
+      }
+    }
+    throw std::runtime_error("Pose stream frame is corrupt.");
+  }
+
+  int64_t readSigned(const unsigned char*& p, const unsigned char* pEnd)
+  {
+    const uint64_t v = readVarint(p, pEnd);
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+  }
+}
+
+tgPoseStreamCodec::tgPoseStreamCodec(std::size_t poses,
+				     double positionResolution,
+				     std::size_t keyframeInterval) :
+  m_quantized(poses),
+  m_positionResolution(positionResolution),
+  m_keyframeInterval(keyframeInterval),
+  m_sinceKeyframe(0),
+  m_started(false)
+{
+  if (!(positionResolution > 0.0)) {
+    throw std::invalid_argument("Pose stream position resolution must be positive.");
+  }
+  if (keyframeInterval == 0) {
+    throw std::invalid_argument("Pose stream keyframe interval must be at least one.");
+  }
+  reset();
+}
+
+void tgPoseStreamCodec::reset()
+{
+  const Quantized zero = {{0, 0, 0}, {0, 0, 0}, 0};
+  m_quantized.assign(m_quantized.size(), zero);
+  m_sinceKeyframe = 0;
+  m_started = false;
+}
+
+void tgPoseStreamCodec::quantize(const Pose& pose, Quantized& q) const
+{
+  for (int i = 0; i < 3; i++) {
+    q.position[i] =
+      static_cast<int64_t>(std::floor(pose.position[i] / m_positionResolution + 0.5));
+  }
+
+  static const double identity[4] = {0.0, 0.0, 0.0, 1.0};
+  const double* r = pose.rotation;
+  double norm = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3]);
+  if (!(norm > 0.0)) {
+    // Not a rotation; store the identity
+    r = identity;
+    norm = 1.0;
+  }
+  int largest = 0;
+  for (int i = 1; i < 4; i++) {
+    if (std::fabs(r[i]) > std::fabs(r[largest])) {
+      largest = i;
+    }
+  }
+  // q and -q are the same rotation; make the dropped one positive
+  const double scale = (r[largest] < 0.0 ? -kRotationScale : kRotationScale) / norm;
+  q.largest = largest;
+  for (int i = 0, k = 0; i < 4; i++) {
+    if (i != largest) {
+      double v = std::floor(r[i] * scale + 0.5);
+      v = v > 32767.0 ? 32767.0 : (v < -32767.0 ? -32767.0 : v);
+      q.rotation[k++] = static_cast<int32_t>(v);
+    }
+  }
+}
+
+void tgPoseStreamCodec::dequantize(const Quantized& q, Pose& pose) const
+{
+  for (int i = 0; i < 3; i++) {
+    pose.position[i] = q.position[i] * m_positionResolution;
+  }
+  double sum = 0.0;
+  for (int i = 0, k = 0; i < 4; i++) {
+    if (i != q.largest) {
+      const double v = q.rotation[k++] / kRotationScale;
+      pose.rotation[i] = v;
+      sum += v * v;
+    }
+  }
+  pose.rotation[q.largest] = sum < 1.0 ? std::sqrt(1.0 - sum) : 0.0;
+}
+
+bool tgPoseStreamCodec::encode(const Pose* poses, std::vector<unsigned char>& out)
+{
+  const bool keyframe = !m_started || m_sinceKeyframe >= m_keyframeInterval;
+  if (keyframe) {
+    reset();
+  }
+  out.push_back(keyframe ? 'K' : 'D');
+
+  Quantized q;
+  for (std::size_t p = 0; p < m_quantized.size(); p++) {
+    Quantized& previous = m_quantized[p];
+    quantize(poses[p], q);
+    for (int i = 0; i < 3; i++) {
+      writeSigned(out, q.position[i] - previous.position[i]);
+    }
+    // The dropped component's index rides in the low bits of the first
+    // difference
+    const int64_t first = q.rotation[0] - previous.rotation[0];
+    writeVarint(out, ((static_cast<uint64_t>(first) << 1) ^
+		      static_cast<uint64_t>(first >> 63)) << 2 | q.largest);
+    writeSigned(out, q.rotation[1] - previous.rotation[1]);
+    writeSigned(out, q.rotation[2] - previous.rotation[2]);
+    previous = q;
+  }
+
+  m_started = true;
+  m_sinceKeyframe++;
+  return keyframe;
+}
+
+const unsigned char* tgPoseStreamCodec::decode(const unsigned char* pBegin,
+					       const unsigned char* pEnd,
+					       Pose* poses)
+{
+  const unsigned char* p = pBegin;
+  if (p == pEnd) {
+    throw std::runtime_error("Pose stream frame is truncated.");
+  }
+  const unsigned char kind = *p++;
+  if (kind == 'K') {
+    reset();
+  }
+  else if (kind != 'D') {
+    throw std::runtime_error("Pose stream frame is corrupt.");
+  }
+  else if (!m_started) {
+    throw std::runtime_error("Pose stream delta frame has no frame before it.");
+  }
+
+  for (std::size_t i = 0; i < m_quantized.size(); i++) {
+    Quantized& q = m_quantized[i];
+    for (int k = 0; k < 3; k++) {
+      q.position[k] += readSigned(p, pEnd);
+    }
+    const uint64_t first = readVarint(p, pEnd);
+    q.largest = static_cast<int32_t>(first & 3);
+    const uint64_t zigzag = first >> 2;
+    q.rotation[0] += static_cast<int32_t>(static_cast<int64_t>(zigzag >> 1) ^
+					  -static_cast<int64_t>(zigzag & 1));
+    q.rotation[1] += static_cast<int32_t>(readSigned(p, pEnd));
+    q.rotation[2] += static_cast<int32_t>(readSigned(p, pEnd));
+    dequantize(q, poses[i]);
+  }
+
+  m_started = true;
+  m_sinceKeyframe = kind == 'K' ? 1 : m_sinceKeyframe + 1;
+  return p;
+}
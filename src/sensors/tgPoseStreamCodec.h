@@ -0,0 +1,150 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_POSE_STREAM_CODEC_H
+#define TG_POSE_STREAM_CODEC_H
+
+/**
+ * @file tgPoseStreamCodec.h
+ * @brief Contains the definition of class tgPoseStreamCodec.
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * Encodes and decodes frames of rigid body poses compactly, for
+ * tgPoseStreamLogger and tgPoseStreamReader. Positions are quantized to a
+ * fixed resolution. Rotations are quantized with the smallest-three
+ * encoding: the largest component of the unit quaternion is dropped,
+ * after flipping the sign so it is positive, and the other three, each
+ * within +-1/sqrt(2), are kept to 16 bits along with the dropped
+ * component's index.
+ *
+ * Each frame is either a keyframe, holding the quantized values, or a
+ * delta frame, holding their differences from the previous frame. The
+ * numbers are zigzag varints, so a body that barely moved costs a byte
+ * per value. Every keyframeInterval frames is a keyframe, so a reader can
+ * start decoding at any keyframe. The quantization is done once, on the
+ * encoding side, and the differences are of integers, so decoding a delta
+ * frame gives exactly what decoding the same frame as a keyframe would.
+ *
+ * A frame starts with 'K' for a keyframe or 'D' for a delta frame. The
+ * same class decodes, keeping the previous frame in the same way; an
+ * instance should only do one or the other.
+ */
+class tgPoseStreamCodec
+{
+ public:
+
+  /** A position and a unit quaternion, x, y, z then w */
+  struct Pose
+  {
+    double position[3];
+    double rotation[4];
+  };
+
+  /**
+   * @param[in] poses the number of poses in a frame.
+   * @param[in] positionResolution the quantization step of positions.
+   * @param[in] keyframeInterval the frames from one keyframe to the next.
+   * @throw std::invalid_argument if the resolution is not positive or
+   * the interval is zero.
+   */
+  tgPoseStreamCodec(std::size_t poses, double positionResolution,
+		    std::size_t keyframeInterval);
+
+  std::size_t getPoseCount() const
+  {
+    return m_quantized.size();
+  }
+
+  double getPositionResolution() const
+  {
+    return m_positionResolution;
+  }
+
+  std::size_t getKeyframeInterval() const
+  {
+    return m_keyframeInterval;
+  }
+
+  /** Make the next frame encoded a keyframe, and forget the previous one. */
+  void reset();
+
+  /**
+   * Append a frame.
+   * @param[in] poses getPoseCount() poses; rotations need not be
+   * normalized.
+   * @param[in,out] out the frame is appended to it.
+   * @return true if the frame is a keyframe.
+   */
+  bool encode(const Pose* poses, std::vector<unsigned char>& out);
+
+  /**
+   * Decode a frame.
+   * @param[in] pBegin the frame's first byte.
+   * @param[in] pEnd where the bytes available end.
+   * @param[out] poses getPoseCount() poses.
+   * @return the byte after the frame.
+   * @throw std::runtime_error if the frame is cut short, or is a delta
+   * frame with no frame before it.
+   */
+  const unsigned char* decode(const unsigned char* pBegin,
+			      const unsigned char* pEnd,
+			      Pose* poses);
+
+  /** Whether the frame at pBegin is a keyframe */
+  static bool isKeyframe(const unsigned char* pBegin)
+  {
+    return *pBegin == 'K';
+  }
+
+ private:
+
+  /** A quantized pose */
+  struct Quantized
+  {
+    int64_t position[3];
+    int32_t rotation[3];
+    /** The index of the dropped component */
+    int32_t largest;
+  };
+
+  void quantize(const Pose& pose, Quantized& q) const;
+
+  void dequantize(const Quantized& q, Pose& pose) const;
+
+  /** The previous frame, or zeros before a keyframe */
+  std::vector<Quantized> m_quantized;
+
+  double m_positionResolution;
+
+  std::size_t m_keyframeInterval;
+
+  /** Frames since the last keyframe; keyframeInterval forces one */
+  std::size_t m_sinceKeyframe;
+
+  /** False until a frame has been encoded or decoded since a reset */
+  bool m_started;
+};
+
+#endif // TG_POSE_STREAM_CODEC_H
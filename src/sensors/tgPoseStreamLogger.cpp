@@ -0,0 +1,321 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgPoseStreamLogger.cpp
+ * @brief Contains the definitions of members of class tgPoseStreamLogger.
+ * $Id$
+ */
+
+// This module
+#include "tgPoseStreamLogger.h"
+// This application
+#include "tgSensor.h"
+// The Bullet Physics library
+#include "LinearMath/btMatrix3x3.h"
+#include "LinearMath/btQuaternion.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <cassert>
+#include <map>
+#include <sstream>
+#include <time.h> // for the file name of the log file
+#include <cstdlib> // for getenv, converting ~ to $HOME.
+#include <stdint.h> // for the fixed-width counts in the file
+
+namespace
+{
+  const char kMagic[8] = {'N', 'T', 'R', 'T', 'P', 'O', 'S', '1'};
+
+  // tgRodSensor's pose fields, after the ".", in header order
+  const char* const kFields[6] =
+    {"X", "Y", "Z", "Euler1", "Euler2", "Euler3"};
+
+  void writeCount(std::ostream& os, std::size_t n)
+  {
+    const uint32_t count = n;
+    os.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  }
+
+  void writeString(std::ostream& os, const std::string& s)
+  {
+    writeCount(os, s.size());
+    os.write(s.data(), s.size());
+  }
+
+  void appendDouble(std::vector<unsigned char>& out, double value)
+  {
+    const unsigned char* const pBytes =
+      reinterpret_cast<const unsigned char*>(&value);
+    out.insert(out.end(), pBytes, pBytes + sizeof(value));
+  }
+}
+
+/**
+ * As with tgDataLogger2, only the prefix is stored here. Each setup opens
+ * a new file.
+ */
+tgPoseStreamLogger::tgPoseStreamLogger(std::string fileNamePrefix,
+				       double timeInterval,
+				       double positionResolution,
+				       std::size_t keyframeInterval) :
+  tgDataManager(),
+  m_fileNamePrefix(fileNamePrefix),
+  m_positionResolution(positionResolution),
+  m_keyframeInterval(keyframeInterval),
+  // Checks the resolution and interval
+  m_codec(0, positionResolution, keyframeInterval),
+  m_totalTime(0.0),
+  m_timeInterval(timeInterval),
+  m_updateTime(0.0)
+{
+  if (m_fileNamePrefix == "") {
+    throw std::invalid_argument("File name cannot be the empty string. Please pass in a path to a file that can be opened.");
+  }
+  if (m_timeInterval < 0.0 ) {
+    throw std::invalid_argument("Time interval must be nonnegative. Negative time intervals do not make sense.");
+  }
+
+  // Expand a leading "~" to the user's home directory.
+  if (m_fileNamePrefix.at(0) == '~') {
+    std::string home = std::getenv("HOME");
+    m_fileNamePrefix.erase(0,1);
+    m_fileNamePrefix = home + m_fileNamePrefix;
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+/**
+ * The parent class deletes the sensors and sensor infos.
+ */
+tgPoseStreamLogger::~tgPoseStreamLogger()
+{
+  if (m_output.is_open()) {
+    m_output.close();
+  }
+}
+
+/**
+ * Setup creates the sensors and the frame layout, finds the poses in it,
+ * sizes the buffers once, and writes the header.
+ */
+void tgPoseStreamLogger::setup()
+{
+  // Call the parent's setup method, which creates the sensors.
+  tgDataManager::setup();
+
+  // A setup without teardown: finish the previous file.
+  if (m_output.is_open()) {
+    m_output.close();
+  }
+
+  // Name the file by the current time, as tgDataLogger2 does.
+  time_t rawtime;
+  tm* currentTime;
+  const int fileTimeSize = 64;
+  char fileTime [fileTimeSize];
+
+  time (&rawtime);
+  currentTime = localtime(&rawtime);
+  strftime(fileTime, fileTimeSize, "%m%d%Y_%H%M%S", currentTime);
+  m_fileName = m_fileNamePrefix + "_" + fileTime + ".poses";
+
+  std::cout << "tgPoseStreamLogger will be saving data to the file: " << std::endl
+	    << m_fileName << std::endl;
+
+  m_output.open(m_fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_output.is_open()) {
+    throw std::runtime_error("Log file could not be opened. Usually, this is because the directory you specified does not exist. Check for spelling errors.");
+  }
+
+  // Group the pose columns by their prefix, e.g. "3_rod(tags)."
+  const std::vector<std::string> headings = getFrameHeadings();
+  std::map<std::string, std::size_t> byHeading;
+  for (std::size_t i=0; i < headings.size(); i++) {
+    byHeading[headings[i]] = i;
+  }
+  std::vector<bool> inPose(headings.size(), false);
+  m_poseColumns.clear();
+  for (std::size_t i=0; i < headings.size(); i++) {
+    const std::string& heading = headings[i];
+    if (heading.size() < 2 || heading.compare(heading.size() - 2, 2, ".X") != 0) {
+      continue;
+    }
+    const std::string prefix = heading.substr(0, heading.size() - 1);
+    std::size_t columns[6];
+    bool complete = true;
+    for (std::size_t f=0; f < 6 && complete; f++) {
+      const std::map<std::string, std::size_t>::const_iterator it =
+	byHeading.find(prefix + kFields[f]);
+      complete = it != byHeading.end() && !inPose[it->second];
+      if (complete) {
+	columns[f] = it->second;
+      }
+    }
+    if (complete) {
+      for (std::size_t f=0; f < 6; f++) {
+	m_poseColumns.push_back(columns[f]);
+	inPose[columns[f]] = true;
+      }
+    }
+  }
+  m_otherColumns.clear();
+  for (std::size_t i=0; i < headings.size(); i++) {
+    if (!inPose[i]) {
+      m_otherColumns.push_back(i);
+    }
+  }
+
+  std::ostringstream description;
+  description << "tgPoseStreamLogger started logging at time " << fileTime << ", with "
+	      << m_sensors.size() << " sensors on " << m_senseables.size()
+	      << " senseable objects.";
+
+  // The file's columns are the frame's behind the time
+  m_output.write(kMagic, sizeof(kMagic));
+  writeString(m_output, description.str());
+  writeCount(m_output, headings.size() + 1);
+  writeString(m_output, "time");
+  for (std::size_t i=0; i < headings.size(); i++) {
+    writeString(m_output, headings[i]);
+  }
+  writeCount(m_output, getPoseCount());
+  for (std::size_t i=0; i < m_poseColumns.size(); i++) {
+    writeCount(m_output, m_poseColumns[i] + 1);
+  }
+  m_output.write(reinterpret_cast<const char*>(&m_positionResolution),
+		 sizeof(m_positionResolution));
+  writeCount(m_output, m_keyframeInterval);
+
+  // All the allocation happens here, none during step.
+  m_codec = tgPoseStreamCodec(getPoseCount(), m_positionResolution,
+			      m_keyframeInterval);
+  m_frame.assign(headings.size(), 0.0);
+  m_poses.resize(getPoseCount());
+  m_previousOthers.assign(m_otherColumns.size(), 0.0);
+  m_payload.clear();
+  m_payload.reserve(sizeof(double) * (1 + headings.size()) +
+		    1 + 40 * getPoseCount() + m_otherColumns.size() / 8 + 1);
+
+  m_totalTime = 0.0;
+  m_updateTime = 0.0;
+
+  // Postcondition
+  assert(invariant());
+}
+
+/**
+ * Close the file before the parent deletes the sensors.
+ */
+void tgPoseStreamLogger::teardown()
+{
+  if (m_output.is_open()) {
+    m_output.close();
+  }
+  tgDataManager::teardown();
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgPoseStreamLogger::step(double dt)
+{
+  if (dt <= 0.0)
+  {
+    throw std::invalid_argument("dt is not positive");
+  }
+  else
+  {
+    m_totalTime += dt;
+    m_updateTime += dt;
+    // Nothing to write to before setup or after teardown.
+    if (m_updateTime >= m_timeInterval && m_output.is_open()) {
+      if (!m_frame.empty()) {
+	sampleFrameInto(&m_frame[0]);
+      }
+
+      // The Euler angles are tgBaseRigid::orientation's, so this is the
+      // body's own rotation up to rounding
+      for (std::size_t p=0; p < m_poses.size(); p++) {
+	const std::size_t* const columns = &m_poseColumns[6 * p];
+	tgPoseStreamCodec::Pose& pose = m_poses[p];
+	for (std::size_t i=0; i < 3; i++) {
+	  pose.position[i] = m_frame[columns[i]];
+	}
+	btMatrix3x3 basis;
+	basis.setEulerYPR(m_frame[columns[3]], m_frame[columns[4]],
+			  m_frame[columns[5]]);
+	btQuaternion rotation;
+	basis.getRotation(rotation);
+	pose.rotation[0] = rotation.x();
+	pose.rotation[1] = rotation.y();
+	pose.rotation[2] = rotation.z();
+	pose.rotation[3] = rotation.w();
+      }
+
+      m_payload.clear();
+      appendDouble(m_payload, m_totalTime);
+      const bool keyframe =
+	m_codec.encode(m_poses.empty() ? NULL : &m_poses[0], m_payload);
+
+      // The bitmap of changed columns, then their values
+      const std::size_t bitmapAt = m_payload.size();
+      m_payload.resize(bitmapAt + (m_otherColumns.size() + 7) / 8, 0);
+      for (std::size_t i=0; i < m_otherColumns.size(); i++) {
+	const double value = m_frame[m_otherColumns[i]];
+	if (keyframe || value != m_previousOthers[i]) {
+	  m_payload[bitmapAt + i / 8] |= static_cast<unsigned char>(1 << (i % 8));
+	  appendDouble(m_payload, value);
+	  m_previousOthers[i] = value;
+	}
+      }
+
+      writeCount(m_output, m_payload.size());
+      m_output.write(reinterpret_cast<const char*>(&m_payload[0]),
+		     m_payload.size());
+      m_updateTime = 0.0;
+    }
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+std::string tgPoseStreamLogger::toString() const
+{
+  std::ostringstream os;
+  os << tgDataManager::toString()
+     << "This tgDataManager is a tgPoseStreamLogger. " << std::endl;
+
+  return os.str();
+}
+
+bool tgPoseStreamLogger::invariant() const
+{
+  return (m_poseColumns.size() % 6 == 0) &&
+    (m_timeInterval >= 0.0);
+}
+
+std::ostream&
+operator<<(std::ostream& os, const tgPoseStreamLogger& obj)
+{
+    os << obj.toString() << std::endl;
+    return os;
+}
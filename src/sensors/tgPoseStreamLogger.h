@@ -0,0 +1,182 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_POSE_STREAM_LOGGER_H
+#define TG_POSE_STREAM_LOGGER_H
+
+/**
+ * @file tgPoseStreamLogger.h
+ * @brief Contains the definition of class tgPoseStreamLogger.
+ * $Id$
+ */
+
+// This module
+#include "tgDataManager.h"
+#include "tgPoseStreamCodec.h"
+// The C++ Standard Library
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * tgPoseStreamLogger is a tgDataManager that records the same frame as
+ * tgBinaryDataLogger, but compresses the rigid body poses, which are most
+ * of a long run's log. Every group of X, Y, Z, Euler1, Euler2 and Euler3
+ * columns a tgRodSensor writes is stored as a pose through
+ * tgPoseStreamCodec: quantized, delta coded against the previous sample,
+ * with a keyframe every keyframeInterval samples. The other columns are
+ * stored as doubles, but only when they change, so a rod's mass costs a
+ * bit per sample.
+ *
+ * The file holds, in native byte order:
+ *   the 8 characters "NTRTPOS1",
+ *   a uint32 string length and the description line,
+ *   a uint32 column count, then for each column a uint32 length and the
+ *   heading, the first being "time",
+ *   a uint32 pose count, then for each pose the uint32 columns of its
+ *   X, Y, Z, Euler1, Euler2 and Euler3,
+ *   the double position resolution and the uint32 keyframe interval,
+ *   then a frame per sample: a uint32 byte count, the double time, the
+ *   tgPoseStreamCodec frame, a bitmap of which other columns changed
+ *   (every one on a keyframe), and their doubles in column order.
+ *
+ * Read it with tgPoseStreamReader, or tgLogReader::open, e.g. in
+ * tgReplayView.
+ */
+class tgPoseStreamLogger : public tgDataManager
+{
+ public:
+
+  /**
+   * @param[in] fileNamePrefix a string that specifies the path to the log file that
+   * will be written. The current time and ".poses" will be appended to this prefix.
+   * @param[in] timeInterval the time interval for querying sensors. Note that an updateTime
+   * of 0 means that sensors will be queried at each call of step().
+   * @param[in] positionResolution the quantization step of positions, in
+   * the world's length units.
+   * @param[in] keyframeInterval the samples from one keyframe to the next.
+   */
+  tgPoseStreamLogger(std::string fileNamePrefix, double timeInterval = 0.0,
+		     double positionResolution = 1e-4,
+		     std::size_t keyframeInterval = 64);
+
+  /**
+   * The destructor closes the log file if teardown was not called.
+   */
+  virtual ~tgPoseStreamLogger();
+
+  /**
+   * Creates the sensors, finds the poses in the frame, opens a new log
+   * file, and writes the header.
+   */
+  virtual void setup();
+
+  /**
+   * Closes the log file.
+   */
+  virtual void teardown();
+
+  /**
+   * Samples every sensor and writes a frame, if m_timeInterval has passed.
+   * @param[in] dt a double, the amount of time since the last step.
+   */
+  virtual void step(double dt);
+
+  /**
+   * Overwrite toString for the superclass to specify that this data manager
+   * is a tgPoseStreamLogger.
+   */
+  virtual std::string toString() const;
+
+  /** The number of poses found in the frame at setup. */
+  std::size_t getPoseCount() const
+  {
+    return m_poseColumns.size() / 6;
+  }
+
+ protected:
+
+  // Integrity predicate.
+  bool invariant() const;
+
+  /**
+   * The full name of the current log file, created in setup.
+   */
+  std::string m_fileName;
+
+  /**
+   * The prefix passed in to the constructor, with "~" expanded.
+   */
+  std::string m_fileNamePrefix;
+
+  /**
+   * The log file, open from setup until teardown.
+   */
+  std::ofstream m_output;
+
+  const double m_positionResolution;
+
+  const std::size_t m_keyframeInterval;
+
+  /**
+   * The encoder, sized at setup.
+   */
+  tgPoseStreamCodec m_codec;
+
+  /**
+   * Six frame offsets per pose, in the order of the header.
+   */
+  std::vector<std::size_t> m_poseColumns;
+
+  /**
+   * The frame offsets of the columns that are not part of a pose.
+   */
+  std::vector<std::size_t> m_otherColumns;
+
+  /**
+   * The values of m_otherColumns last written.
+   */
+  std::vector<double> m_previousOthers;
+
+  /**
+   * Buffers reused from sample to sample.
+   */
+  std::vector<double> m_frame;
+  std::vector<tgPoseStreamCodec::Pose> m_poses;
+  std::vector<unsigned char> m_payload;
+
+  /**
+   * Time bookkeeping, as in tgDataLogger2.
+   */
+  double m_totalTime;
+  double m_timeInterval;
+  double m_updateTime;
+
+};
+
+/**
+ * Overload operator<<() to handle tgPoseStreamLogger
+ * @param[in,out] os an ostream
+ * @param[in] obj a tgPoseStreamLogger
+ * @return os
+ */
+std::ostream&
+operator<<(std::ostream& os, const tgPoseStreamLogger& obj);
+
+#endif // TG_POSE_STREAM_LOGGER_H
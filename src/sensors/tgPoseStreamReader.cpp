@@ -0,0 +1,276 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgPoseStreamReader.cpp
+ * @brief Contains the definitions of members of class tgPoseStreamReader.
+ * $Id$
+ */
+
+// This module
+#include "tgPoseStreamReader.h"
+// The Bullet Physics library
+#include "LinearMath/btMatrix3x3.h"
+#include "LinearMath/btQuaternion.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+// POSIX memory mapping
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+  // As written by tgPoseStreamLogger
+  const char kMagic[8] = {'N', 'T', 'R', 'T', 'P', 'O', 'S', '1'};
+
+  /** Read a count at pos, moving pos past it; false if out of bytes */
+  bool readCount(const char* pBytes, std::size_t size, std::size_t& pos,
+		 std::size_t& n)
+  {
+    uint32_t count = 0;
+    if (size - pos < sizeof(count)) {
+      return false;
+    }
+    std::memcpy(&count, pBytes + pos, sizeof(count));
+    pos += sizeof(count);
+    n = count;
+    return true;
+  }
+
+  std::size_t readHeaderCount(const char* pBytes, std::size_t size,
+			      std::size_t& pos)
+  {
+    std::size_t n = 0;
+    if (!readCount(pBytes, size, pos, n)) {
+      throw std::runtime_error("Pose stream header is truncated.");
+    }
+    return n;
+  }
+
+  std::string readString(const char* pBytes, std::size_t size,
+			 std::size_t& pos)
+  {
+    const std::size_t n = readHeaderCount(pBytes, size, pos);
+    if (size - pos < n) {
+      throw std::runtime_error("Pose stream header is truncated.");
+    }
+    const std::string s(pBytes + pos, n);
+    pos += n;
+    return s;
+  }
+}
+
+tgPoseStreamReader::tgPoseStreamReader(const std::string& fileName) :
+  m_pMapping(NULL),
+  m_size(0),
+  m_codec(0, 1.0, 1),
+  m_decodedRow(0)
+{
+  const int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Pose stream file could not be opened.");
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(kMagic)) {
+    ::close(fd);
+    throw std::runtime_error("Not a tgPoseStreamLogger file.");
+  }
+  m_size = info.st_size;
+  void* const pMapping = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (pMapping == MAP_FAILED) {
+    throw std::runtime_error("Pose stream file could not be mapped.");
+  }
+  m_pMapping = pMapping;
+
+  const char* const pBytes = static_cast<const char*>(m_pMapping);
+  try {
+    if (std::memcmp(pBytes, kMagic, sizeof(kMagic)) != 0) {
+      throw std::runtime_error("Not a tgPoseStreamLogger file.");
+    }
+    std::size_t pos = sizeof(kMagic);
+    m_description = readString(pBytes, m_size, pos);
+    const std::size_t numColumns = readHeaderCount(pBytes, m_size, pos);
+    if (numColumns == 0) {
+      throw std::runtime_error("Pose stream header is truncated.");
+    }
+    for (std::size_t c = 0; c < numColumns; c++) {
+      m_headings.push_back(readString(pBytes, m_size, pos));
+    }
+
+    const std::size_t numPoses = readHeaderCount(pBytes, m_size, pos);
+    std::vector<bool> inPose(numColumns, false);
+    inPose[0] = true;
+    for (std::size_t i = 0; i < 6 * numPoses; i++) {
+      const std::size_t column = readHeaderCount(pBytes, m_size, pos);
+      if (column >= numColumns || inPose[column]) {
+	throw std::runtime_error("Pose stream header is corrupt.");
+      }
+      inPose[column] = true;
+      m_poseColumns.push_back(column);
+    }
+    for (std::size_t c = 0; c < numColumns; c++) {
+      if (!inPose[c]) {
+	m_otherColumns.push_back(c);
+      }
+    }
+
+    double resolution = 0.0;
+    if (m_size - pos < sizeof(resolution)) {
+      throw std::runtime_error("Pose stream header is truncated.");
+    }
+    std::memcpy(&resolution, pBytes + pos, sizeof(resolution));
+    pos += sizeof(resolution);
+    const std::size_t keyframeInterval = readHeaderCount(pBytes, m_size, pos);
+    m_codec = tgPoseStreamCodec(numPoses, resolution, keyframeInterval);
+    m_poses.resize(numPoses);
+    m_row.assign(numColumns, 0.0);
+
+    // A frame holds at least its time and the codec's kind
+    std::size_t frameSize = 0;
+    while (readCount(pBytes, m_size, pos, frameSize)) {
+      if (m_size - pos < frameSize || frameSize <= sizeof(double)) {
+	// The logger stopped in the middle of this frame
+	break;
+      }
+      Frame frame;
+      frame.offset = pos;
+      frame.size = frameSize;
+      const unsigned char* const pKind =
+	reinterpret_cast<const unsigned char*>(pBytes + pos + sizeof(double));
+      if (tgPoseStreamCodec::isKeyframe(pKind)) {
+	m_keyframes.push_back(m_frames.size());
+      }
+      else if (m_keyframes.empty()) {
+	throw std::runtime_error("Pose stream does not start with a keyframe.");
+      }
+      m_frames.push_back(frame);
+      pos += frameSize;
+    }
+  }
+  catch (...) {
+    munmap(m_pMapping, m_size);
+    throw;
+  }
+  m_decodedRow = m_frames.size();
+}
+
+tgPoseStreamReader::~tgPoseStreamReader()
+{
+  munmap(m_pMapping, m_size);
+}
+
+double tgPoseStreamReader::getTime(std::size_t row) const
+{
+  assert(row < m_frames.size());
+  double time;
+  std::memcpy(&time, static_cast<const char*>(m_pMapping) + m_frames[row].offset,
+	      sizeof(time));
+  return time;
+}
+
+double tgPoseStreamReader::getValue(std::size_t row, std::size_t column) const
+{
+  assert(column < m_headings.size());
+  if (column == 0) {
+    return getTime(row);
+  }
+  decode(row);
+  return m_row[column];
+}
+
+const tgPoseStreamCodec::Pose&
+tgPoseStreamReader::getPose(std::size_t row, std::size_t pose) const
+{
+  assert(pose < m_poses.size());
+  decode(row);
+  return m_poses[pose];
+}
+
+void tgPoseStreamReader::decode(std::size_t row) const
+{
+  assert(row < m_frames.size());
+  if (row == m_decodedRow) {
+    return;
+  }
+
+  // Start at the keyframe before the row, unless the row decoded last is
+  // between the two
+  const std::size_t keyframe =
+    *(std::upper_bound(m_keyframes.begin(), m_keyframes.end(), row) - 1);
+  std::size_t next = keyframe;
+  if (m_decodedRow < m_frames.size() && m_decodedRow >= keyframe &&
+      m_decodedRow < row) {
+    next = m_decodedRow + 1;
+  }
+
+  const char* const pBytes = static_cast<const char*>(m_pMapping);
+  tgPoseStreamCodec::Pose* const poses = m_poses.empty() ? NULL : &m_poses[0];
+  for (; next <= row; next++) {
+    const Frame& frame = m_frames[next];
+    const unsigned char* p =
+      reinterpret_cast<const unsigned char*>(pBytes + frame.offset + sizeof(double));
+    const unsigned char* const pEnd =
+      reinterpret_cast<const unsigned char*>(pBytes + frame.offset + frame.size);
+    // Forget the row being replaced if this frame is bad
+    m_decodedRow = m_frames.size();
+    p = m_codec.decode(p, pEnd, poses);
+
+    const std::size_t bitmapSize = (m_otherColumns.size() + 7) / 8;
+    if (static_cast<std::size_t>(pEnd - p) < bitmapSize) {
+      throw std::runtime_error("Pose stream frame is truncated.");
+    }
+    const unsigned char* const pBitmap = p;
+    p += bitmapSize;
+    for (std::size_t i = 0; i < m_otherColumns.size(); i++) {
+      if (pBitmap[i / 8] & (1 << (i % 8))) {
+	if (static_cast<std::size_t>(pEnd - p) < sizeof(double)) {
+	  throw std::runtime_error("Pose stream frame is truncated.");
+	}
+	std::memcpy(&m_row[m_otherColumns[i]], p, sizeof(double));
+	p += sizeof(double);
+      }
+    }
+  }
+
+  // Back to the columns tgRodSensor wrote
+  for (std::size_t i = 0; i < m_poses.size(); i++) {
+    const tgPoseStreamCodec::Pose& pose = m_poses[i];
+    const std::size_t* const columns = &m_poseColumns[6 * i];
+    for (std::size_t k = 0; k < 3; k++) {
+      m_row[columns[k]] = pose.position[k];
+    }
+    const btMatrix3x3 basis(btQuaternion(pose.rotation[0], pose.rotation[1],
+					 pose.rotation[2], pose.rotation[3]));
+    btScalar yaw = 0.0;
+    btScalar pitch = 0.0;
+    btScalar roll = 0.0;
+    basis.getEulerYPR(yaw, pitch, roll);
+    m_row[columns[3]] = yaw;
+    m_row[columns[4]] = pitch;
+    m_row[columns[5]] = roll;
+  }
+  m_row[0] = getTime(row);
+  m_decodedRow = row;
+}
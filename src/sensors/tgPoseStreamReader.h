@@ -0,0 +1,143 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_POSE_STREAM_READER_H
+#define TG_POSE_STREAM_READER_H
+
+/**
+ * @file tgPoseStreamReader.h
+ * @brief Contains the definition of class tgPoseStreamReader.
+ * $Id$
+ */
+
+// This module
+#include "tgLogReader.h"
+#include "tgPoseStreamCodec.h"
+// The C++ Standard Library
+#include <string>
+#include <vector>
+
+/**
+ * Random access to a file written by tgPoseStreamLogger. The file is
+ * memory-mapped and only the frame lengths are visited when it is opened.
+ * A row is decoded from the keyframe before it, or onward from the row
+ * last decoded when that is closer, so playing forward decodes each frame
+ * once and a seek decodes at most a keyframe interval of frames. The row
+ * times are read without decoding.
+ *
+ * The pose columns read back as tgRodSensor wrote them, to the
+ * logger's resolution. Since the decoded row is cached, a reader must not
+ * be shared between threads.
+ */
+class tgPoseStreamReader : public tgLogReader
+{
+ public:
+
+  /**
+   * Map a log and index its frames.
+   * @param[in] fileName the path of the pose stream.
+   * @throw std::runtime_error if the file can't be mapped or isn't a
+   * pose stream. A log cut short in its last frame is read up to its last
+   * whole frame.
+   */
+  tgPoseStreamReader(const std::string& fileName);
+
+  /** Unmaps the file. */
+  virtual ~tgPoseStreamReader();
+
+  virtual const std::string& getDescription() const
+  {
+    return m_description;
+  }
+
+  virtual const std::vector<std::string>& getHeadings() const
+  {
+    return m_headings;
+  }
+
+  virtual std::size_t getRowCount() const
+  {
+    return m_frames.size();
+  }
+
+  virtual double getValue(std::size_t row, std::size_t column) const;
+
+  virtual double getTime(std::size_t row) const;
+
+  /** The number of poses in a row */
+  std::size_t getPoseCount() const
+  {
+    return m_poseColumns.size() / 6;
+  }
+
+  /**
+   * A pose as stored, without the round trip through Euler angles.
+   * @param[in] row less than getRowCount().
+   * @param[in] pose less than getPoseCount().
+   */
+  const tgPoseStreamCodec::Pose& getPose(std::size_t row, std::size_t pose) const;
+
+  /**
+   * The first of the six columns of a pose, its X.
+   * @param[in] pose less than getPoseCount().
+   */
+  std::size_t getPoseColumn(std::size_t pose) const
+  {
+    return m_poseColumns[6 * pose];
+  }
+
+ private:
+
+  /** Not copyable; the mapping belongs to one reader. */
+  tgPoseStreamReader(const tgPoseStreamReader&);
+  tgPoseStreamReader& operator=(const tgPoseStreamReader&);
+
+  /** Decode a row into m_row and m_poses, if it is not there already */
+  void decode(std::size_t row) const;
+
+  /** Where a frame is in the mapping */
+  struct Frame
+  {
+    std::size_t offset;
+    std::size_t size;
+  };
+
+  void* m_pMapping;
+  std::size_t m_size;
+
+  std::string m_description;
+  std::vector<std::string> m_headings;
+  std::vector<Frame> m_frames;
+
+  /** The rows of the keyframes, in order */
+  std::vector<std::size_t> m_keyframes;
+
+  /** Six columns per pose */
+  std::vector<std::size_t> m_poseColumns;
+
+  /** The columns stored as doubles, apart from the time */
+  std::vector<std::size_t> m_otherColumns;
+
+  /** The decoding state, for m_decodedRow */
+  mutable tgPoseStreamCodec m_codec;
+  mutable std::vector<tgPoseStreamCodec::Pose> m_poses;
+  mutable std::vector<double> m_row;
+  mutable std::size_t m_decodedRow;
+};
+
+#endif // TG_POSE_STREAM_READER_H
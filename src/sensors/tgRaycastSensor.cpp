@@ -0,0 +1,262 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRaycastSensor.cpp
+ * @brief Contains the definitions of members of class tgRaycastSensor.
+ * $Id$
+ */
+
+// This module
+#include "tgRaycastSensor.h"
+// Includes from NTRT:
+#include "core/tgBaseRigid.h"
+#include "core/tgRigidStateFrame.h"
+#include "core/tgWorld.h"
+#include "core/tgWorldBulletPhysicsImpl.h"
+#include "core/terrain/tgBulletGround.h"
+// Includes from Bullet Physics:
+#include "btBulletDynamicsCommon.h"
+#include "LinearMath/btAabbUtil2.h"
+// Includes from the C++ standard library:
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+tgRaycastSensor::Config::Config(double maxDistance,
+				const btVector3& direction,
+				bool useGroundHeight) :
+  maxDistance(maxDistance),
+  direction(direction),
+  useGroundHeight(useGroundHeight)
+{
+}
+
+tgRaycastSensor::tgRaycastSensor(tgSenseable* pSens, tgWorld& world,
+				 const Config& config) :
+  tgSensor(pSens),
+  m_config(config),
+  m_world(world),
+  m_pAskedGroundBody(NULL),
+  m_pObstacleImpl(NULL),
+  m_obstacleCount(-1),
+  m_obstacleChanges(0),
+  m_pUpdateFrame(NULL),
+  m_updateFrameCount(0),
+  m_updated(false)
+{
+  if (!(m_config.maxDistance > 0.0)) {
+    throw std::invalid_argument("maxDistance is not positive, inside tgRaycastSensor.");
+  }
+  if (m_config.direction.length2() == 0.0) {
+    throw std::invalid_argument("direction is zero, inside tgRaycastSensor.");
+  }
+  m_config.direction.normalize();
+}
+
+tgRaycastSensor::~tgRaycastSensor()
+{
+}
+
+std::size_t tgRaycastSensor::addProbe(tgBaseRigid* pRigid,
+				      const btVector3& localOffset)
+{
+  if (pRigid == NULL) {
+    throw std::invalid_argument("pRigid is NULL inside tgRaycastSensor.");
+  }
+  Probe probe;
+  probe.pRigid = pRigid;
+  probe.localOffset = localOffset;
+  m_probes.push_back(probe);
+  m_distances.push_back(-1.0);
+  m_updated = false;
+  return m_probes.size() - 1;
+}
+
+void tgRaycastSensor::updateObstacles()
+{
+  tgWorldBulletPhysicsImpl& impl =
+    static_cast<tgWorldBulletPhysicsImpl&>(m_world.implementation());
+  btCollisionObjectArray& objects =
+    impl.dynamicsWorld().getCollisionObjectArray();
+  if (&impl == m_pObstacleImpl && objects.size() == m_obstacleCount &&
+      impl.staticBodyChanges() == m_obstacleChanges) {
+    return;
+  }
+
+  // A ground can only be asked about heights straight below
+  const bool down = m_config.direction.y() < 0.0 &&
+    btFabs(m_config.direction.x()) < SIMD_EPSILON &&
+    btFabs(m_config.direction.z()) < SIMD_EPSILON;
+  m_pAskedGroundBody = NULL;
+  if (m_config.useGroundHeight && down && impl.ground() != NULL) {
+    m_pAskedGroundBody = impl.groundBody();
+  }
+
+  m_obstacles.clear();
+  for (int i = 0; i < objects.size(); i++) {
+    btCollisionObject* const pObject = objects[i];
+    // The ground still gets a ray test where it cannot tell its height
+    if (pObject->isStaticObject()) {
+      Obstacle obstacle;
+      obstacle.pObject = pObject;
+      pObject->getCollisionShape()->getAabb(pObject->getWorldTransform(),
+					    obstacle.aabbMin,
+					    obstacle.aabbMax);
+      m_obstacles.push_back(obstacle);
+    }
+  }
+  m_pObstacleImpl = &impl;
+  m_obstacleCount = objects.size();
+  m_obstacleChanges = impl.staticBodyChanges();
+}
+
+double tgRaycastSensor::castProbe(const btVector3& origin) const
+{
+  double best = m_config.maxDistance;
+  bool hit = false;
+
+  bool groundAnswered = false;
+  if (m_pAskedGroundBody != NULL) {
+    const tgBulletGround* const pGround =
+      static_cast<tgWorldBulletPhysicsImpl&>(m_world.implementation()).ground();
+    double height;
+    if (pGround->getSurfaceHeight(origin.x(), origin.z(), height)) {
+      groundAnswered = true;
+      // A probe at or under the surface touches it
+      const double d = std::max(0.0, (origin.y() - height) /
+				-m_config.direction.y());
+      if (d <= best) {
+	best = d;
+	hit = true;
+      }
+    }
+  }
+
+  btTransform from;
+  from.setIdentity();
+  from.setOrigin(origin);
+  btTransform to;
+  to.setIdentity();
+  for (std::size_t i = 0; i < m_obstacles.size(); i++) {
+    const Obstacle& obstacle = m_obstacles[i];
+    if (groundAnswered && obstacle.pObject == m_pAskedGroundBody) {
+      continue;
+    }
+    // Only as far as the closest hit so far
+    const btVector3 end = origin + m_config.direction * best;
+    btVector3 rayMin = origin;
+    rayMin.setMin(end);
+    btVector3 rayMax = origin;
+    rayMax.setMax(end);
+    if (!TestAabbAgainstAabb2(rayMin, rayMax,
+			      obstacle.aabbMin, obstacle.aabbMax)) {
+      continue;
+    }
+    to.setOrigin(end);
+    btCollisionWorld::ClosestRayResultCallback callback(origin, end);
+    btCollisionWorld::rayTestSingle(from, to, obstacle.pObject,
+				    obstacle.pObject->getCollisionShape(),
+				    obstacle.pObject->getWorldTransform(),
+				    callback);
+    if (callback.hasHit()) {
+      best *= callback.m_closestHitFraction;
+      hit = true;
+    }
+  }
+  return hit ? best : -1.0;
+}
+
+void tgRaycastSensor::update()
+{
+  const tgRigidStateFrame& frame = m_world.getRigidStates();
+  if (m_updated && &frame == m_pUpdateFrame &&
+      frame.getFrameCount() == m_updateFrameCount) {
+    return;
+  }
+
+  updateObstacles();
+  for (std::size_t i = 0; i < m_probes.size(); i++) {
+    const Probe& probe = m_probes[i];
+    btRigidBody* const pBody = probe.pRigid->getPRigidBody();
+    assert(pBody != NULL);
+    const tgRigidStateFrame::RigidState* const pState =
+      tgRigidStateFrame::find(pBody);
+    const btTransform& transform =
+      (pState != NULL) ? pState->transform : pBody->getWorldTransform();
+    m_distances[i] = castProbe(transform(probe.localOffset));
+  }
+
+  m_pUpdateFrame = &frame;
+  m_updateFrameCount = frame.getFrameCount();
+  m_updated = true;
+}
+
+double tgRaycastSensor::getDistance(std::size_t i)
+{
+  if (i >= m_probes.size()) {
+    throw std::out_of_range("No such probe, inside tgRaycastSensor.");
+  }
+  update();
+  return m_distances[i];
+}
+
+const std::vector<double>& tgRaycastSensor::getDistances()
+{
+  update();
+  return m_distances;
+}
+
+std::vector<std::string> tgRaycastSensor::getSensorDataHeadings()
+{
+  std::vector<std::string> headings;
+  for (std::size_t i = 0; i < m_probes.size(); i++) {
+    // Bodies may share tags, so the probe index keeps the headings apart
+    std::stringstream heading;
+    heading << "raycast(" << m_probes[i].pRigid->getTags() << ").D" << i;
+    headings.push_back(heading.str());
+  }
+  return headings;
+}
+
+std::vector<std::string> tgRaycastSensor::getSensorData()
+{
+  update();
+  std::vector<std::string> sensordata;
+  for (std::size_t i = 0; i < m_distances.size(); i++) {
+    std::stringstream value;
+    value << m_distances[i];
+    sensordata.push_back(value.str());
+  }
+  return sensordata;
+}
+
+std::size_t tgRaycastSensor::getSensorDataSize()
+{
+  return m_probes.size();
+}
+
+void tgRaycastSensor::sampleInto(double* out)
+{
+  update();
+  for (std::size_t i = 0; i < m_distances.size(); i++) {
+    out[i] = m_distances[i];
+  }
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_RAYCAST_SENSOR_H
+#define TG_RAYCAST_SENSOR_H
+
+/**
+ * @file tgRaycastSensor.h
+ * @brief Contains the definition of class tgRaycastSensor.
+ * $Id$
+ */
+
+// Includes from the sensors directory:
+#include "tgSensor.h"
+// Includes from Bullet Physics:
+#include "LinearMath/btVector3.h"
+// Includes from the C++ standard library:
+#include <string>
+#include <vector>
+
+// Forward declarations
+class btCollisionObject;
+class tgBaseRigid;
+class tgRigidStateFrame;
+class tgWorld;
+class tgWorldImpl;
+
+/**
+ * A bank of ray probes, each fixed to a rigid body, that measure the
+ * distance along a common direction (straight down by default) to the
+ * terrain. This replaces one btCollisionWorld::rayTest per probe against
+ * the whole world (as in dev/atil's heightSensor) with one pass per step:
+ * only the world's static objects are tested, each ray only against the
+ * objects whose bounding boxes it crosses, and a downward probe over a
+ * ground that knows its own height (see
+ * tgBulletGround::getSurfaceHeight) does not ray test the ground at all.
+ *
+ * The distances are worked out at most once per world step, the first
+ * time they are asked for, so a controller and a data manager reading the
+ * same bank share the work. A probe that hits nothing within the maximum
+ * distance reads -1, as heightSensor did.
+ *
+ * Banks for a data manager are made by a tgRaycastSensorInfo; a
+ * controller can also make its own with a NULL senseable.
+ */
+class tgRaycastSensor : public tgSensor
+{
+public:
+
+  /** Settings shared by every probe of a bank. */
+  struct Config
+  {
+    /**
+     * @param[in] maxDistance how far each ray reaches; must be positive.
+     * @param[in] direction the world direction of the rays; must not be
+     * zero, and is normalized.
+     * @param[in] useGroundHeight ask the ground for its height instead of
+     * ray testing it, when the rays point straight down.
+     */
+    Config(double maxDistance = 5000.0,
+	   const btVector3& direction = btVector3(0.0, -1.0, 0.0),
+	   bool useGroundHeight = true);
+
+    double maxDistance;
+    btVector3 direction;
+    bool useGroundHeight;
+  };
+
+  /**
+   * @param[in] pSens the senseable the bank is reported under in
+   * headings, usually the model carrying the probes; may be NULL.
+   * @param[in] world the world the probes are in, which must outlive
+   * the bank. Resetting the world is fine.
+   * @param[in] config the settings for every probe.
+   * @throw std::invalid_argument if config is out of range.
+   */
+  tgRaycastSensor(tgSenseable* pSens, tgWorld& world,
+		  const Config& config = Config());
+
+  virtual ~tgRaycastSensor();
+
+  /**
+   * Add a probe.
+   * @param[in] pRigid the body the probe moves with; must outlive the
+   * bank.
+   * @param[in] localOffset where the ray starts in the body's frame.
+   * @return the index of the probe.
+   * @throw std::invalid_argument if pRigid is NULL.
+   */
+  std::size_t addProbe(tgBaseRigid* pRigid,
+		       const btVector3& localOffset = btVector3(0.0, 0.0, 0.0));
+
+  /** The number of probes. */
+  std::size_t getProbeCount() const
+  {
+    return m_probes.size();
+  }
+
+  /**
+   * Cast every probe, unless the world has not stepped since the last
+   * time. Called by the accessors below.
+   */
+  void update();
+
+  /**
+   * The distance from one probe to the terrain.
+   * @param[in] i the index of the probe.
+   * @return the distance, or -1 if nothing is in range.
+   * @throw std::out_of_range if there is no such probe.
+   */
+  double getDistance(std::size_t i);
+
+  /** Every probe's distance, in probe order. */
+  const std::vector<double>& getDistances();
+
+  /**
+   * One heading and one value per probe, see tgSensor.
+   */
+  virtual std::vector<std::string> getSensorDataHeadings();
+  virtual std::vector<std::string> getSensorData();
+  virtual std::size_t getSensorDataSize();
+  virtual void sampleInto(double* out);
+
+private:
+
+  /** A ray fixed to a body */
+  struct Probe
+  {
+    tgBaseRigid* pRigid;
+    btVector3 localOffset;
+  };
+
+  /** A static object, and its bounds when the list was made */
+  struct Obstacle
+  {
+    btCollisionObject* pObject;
+    btVector3 aabbMin;
+    btVector3 aabbMax;
+  };
+
+  /**
+   * Remake m_obstacles, if the world was reset or objects were added or
+   * removed since.
+   */
+  void updateObstacles();
+
+  /** Cast one probe, given where its ray starts. */
+  double castProbe(const btVector3& origin) const;
+
+  Config m_config;
+
+  tgWorld& m_world;
+
+  std::vector<Probe> m_probes;
+
+  /** The world's static objects, other than a ground that is asked */
+  std::vector<Obstacle> m_obstacles;
+
+  /** The ground's body while it is asked rather than ray tested */
+  btCollisionObject* m_pAskedGroundBody;
+
+  /**
+   * The implementation, object count and static body changes (e.g.
+   * tgTiledGround tiles) m_obstacles was made for
+   */
+  const tgWorldImpl* m_pObstacleImpl;
+  int m_obstacleCount;
+  unsigned long m_obstacleChanges;
+
+  /** The frame m_distances was worked out for */
+  const tgRigidStateFrame* m_pUpdateFrame;
+  std::size_t m_updateFrameCount;
+  bool m_updated;
+
+  std::vector<double> m_distances;
+};
+
+#endif // TG_RAYCAST_SENSOR_H
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRaycastSensorInfo.cpp
+ * @brief Contains the definitions of members of class tgRaycastSensorInfo.
+ * $Id$
+ */
+
+// This module
+#include "tgRaycastSensorInfo.h"
+// Other includes from NTRTsim
+#include "core/tgBaseRigid.h"
+#include "core/tgCast.h"
+#include "core/tgModel.h"
+#include "core/tgSenseable.h"
+#include "core/tgTagSearch.h"
+// Other includes from the C++ standard library
+#include <algorithm>
+#include <stdexcept>
+
+tgRaycastSensorInfo::tgRaycastSensorInfo(tgWorld& world,
+					 const std::string& tagSearch,
+					 const tgRaycastSensor::Config& config,
+					 const btVector3& localOffset) :
+  m_world(world),
+  m_tagSearch(tagSearch),
+  m_config(config),
+  m_localOffset(localOffset),
+  m_pOwner(NULL)
+{
+}
+
+tgRaycastSensorInfo::~tgRaycastSensorInfo()
+{
+}
+
+std::vector<tgBaseRigid*>
+tgRaycastSensorInfo::getUnclaimedRigids(tgModel* pModel) const
+{
+  std::vector<tgBaseRigid*> rigids = pModel->find<tgBaseRigid>(m_tagSearch);
+  // A rigid passed in by itself has no matching descendants
+  tgBaseRigid* const pSelf = tgCast::cast<tgModel, tgBaseRigid>(pModel);
+  if (pSelf != 0 && tgTagSearch(m_tagSearch).matches(pSelf->getTags()) &&
+      std::find(rigids.begin(), rigids.end(), pSelf) == rigids.end()) {
+    rigids.push_back(pSelf);
+  }
+
+  std::vector<tgBaseRigid*> result;
+  for (std::size_t i = 0; i < rigids.size(); i++) {
+    if (std::find(m_claimed.begin(), m_claimed.end(), rigids[i]) ==
+	m_claimed.end()) {
+      result.push_back(rigids[i]);
+    }
+  }
+  return result;
+}
+
+bool tgRaycastSensorInfo::isThisMySenseable(tgSenseable* pSenseable)
+{
+  if (pSenseable == NULL) {
+    throw std::invalid_argument("pSenseable was NULL inside tgRaycastSensorInfo.");
+  }
+  tgModel* pModel = tgCast::cast<tgSenseable, tgModel>(pSenseable);
+  if (pModel == 0) {
+    return 0;
+  }
+  if (pSenseable == m_pOwner) {
+    // A new setup: the rigids claimed last time are gone
+    m_claimed.clear();
+  }
+  return !getUnclaimedRigids(pModel).empty();
+}
+
+std::vector<tgSensor*>
+tgRaycastSensorInfo::createSensorsIfAppropriate(tgSenseable* pSenseable)
+{
+  if (!isThisMySenseable(pSenseable)) {
+    throw std::invalid_argument("pSenseable is NOT a tgModel with unprobed matching rigids, inside tgRaycastSensorInfo.");
+  }
+  tgModel* pModel = tgCast::cast<tgSenseable, tgModel>(pSenseable);
+  if (m_pOwner == NULL) {
+    m_pOwner = pSenseable;
+  }
+
+  tgRaycastSensor* const pBank =
+    new tgRaycastSensor(pSenseable, m_world, m_config);
+  const std::vector<tgBaseRigid*> rigids = getUnclaimedRigids(pModel);
+  for (std::size_t i = 0; i < rigids.size(); i++) {
+    pBank->addProbe(rigids[i], m_localOffset);
+    m_claimed.push_back(rigids[i]);
+  }
+
+  std::vector<tgSensor*> newSensors;
+  newSensors.push_back(pBank);
+  return newSensors;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_RAYCAST_SENSOR_INFO_H
+#define TG_RAYCAST_SENSOR_INFO_H
+
+/**
+ * @file tgRaycastSensorInfo.h
+ * @brief Contains the definition of class tgRaycastSensorInfo.
+ * $Id$
+ */
+
+// This module
+#include "tgSensorInfo.h"
+// Other includes from NTRTsim
+#include "tgRaycastSensor.h"
+// Other includes from the C++ standard library
+#include <string>
+#include <vector>
+
+// Forward references
+class tgBaseRigid;
+class tgModel;
+class tgWorld;
+
+/**
+ * tgRaycastSensorInfo creates one tgRaycastSensor bank per model, with a
+ * probe on every rigid of the model whose tags match a search (e.g.
+ * "foot"), so that all the probes are cast together.
+ *
+ * The first senseable with matching rigids takes all of them, so when a
+ * model and its descendants are passed in, the model gets the bank and
+ * the descendants get nothing.
+ */
+class tgRaycastSensorInfo : public tgSensorInfo
+{
+public:
+
+  /**
+   * @param[in] world the world the models are in.
+   * @param[in] tagSearch the tags of the rigids to probe, as for
+   * tgModel::find.
+   * @param[in] config the settings of every bank.
+   * @param[in] localOffset where each ray starts in its rigid's frame.
+   */
+  tgRaycastSensorInfo(tgWorld& world, const std::string& tagSearch,
+		      const tgRaycastSensor::Config& config =
+		      tgRaycastSensor::Config(),
+		      const btVector3& localOffset = btVector3(0.0, 0.0, 0.0));
+
+  ~tgRaycastSensorInfo();
+
+  /**
+   * True if pSenseable is a tgModel with matching rigids, in itself or
+   * its descendants, that no bank has yet.
+   */
+  virtual bool isThisMySenseable(tgSenseable* pSenseable);
+
+  /**
+   * Create a bank with a probe on each matching rigid that has none yet.
+   * Returns a list of size 1.
+   */
+  virtual std::vector<tgSensor*> createSensorsIfAppropriate(tgSenseable* pSenseable);
+
+private:
+
+  /** The matching rigids of a model that no bank has yet. */
+  std::vector<tgBaseRigid*> getUnclaimedRigids(tgModel* pModel) const;
+
+  tgWorld& m_world;
+
+  std::string m_tagSearch;
+
+  tgRaycastSensor::Config m_config;
+
+  btVector3 m_localOffset;
+
+  /**
+   * The senseable the first bank was made for. The models are rebuilt
+   * between setups but it is not, so seeing it again starts over.
+   */
+  tgSenseable* m_pOwner;
+
+  /** The rigids given probes since the owner was last seen */
+  std::vector<tgBaseRigid*> m_claimed;
+};
+
+#endif // TG_RAYCAST_SENSOR_INFO_H
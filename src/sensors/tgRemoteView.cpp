@@ -0,0 +1,236 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRemoteView.cpp
+ * @brief Contains the definitions of members of class tgRemoteView.
+ * $Id$
+ */
+
+// This module
+#include "tgRemoteView.h"
+#include "tgWebSocket.h"
+// This application
+#include "core/tgModelVisitor.h"
+#include "core/tgRod.h"
+#include "core/tgSimulation.h"
+#include "core/tgTags.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btMotionState.h"
+#include "LinearMath/btQuaternion.h"
+#include "LinearMath/btTransform.h"
+// The C++ Standard Library
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+  /** Collects the rods of the models */
+  class RodCollector : public tgModelVisitor
+  {
+  public:
+    RodCollector(std::vector<const tgRod*>& rods) : m_rods(rods) { }
+
+    virtual void render(const tgRod& rod) const
+    {
+      m_rods.push_back(&rod);
+    }
+
+  private:
+    std::vector<const tgRod*>& m_rods;
+  };
+}
+
+tgRemoteView::tgRemoteView(tgWorld& world, const std::string& host, int port,
+			   double frameRate, double renderRate) :
+  tgSimViewGraphics(world, renderRate, renderRate),
+  m_pServer(tgWebSocket::connect(host, port)),
+  m_pCodec(NULL),
+  m_runTime(0.0),
+  m_haveFrame(false),
+  m_matched(false)
+{
+  std::ostringstream request;
+  request << "rate " << frameRate;
+  m_pServer->send(request.str());
+}
+
+tgRemoteView::~tgRemoteView()
+{
+  delete m_pCodec;
+  delete m_pServer;
+}
+
+void tgRemoteView::teardown()
+{
+  m_bodies.clear();
+  m_matched = false;
+  tgSimViewGraphics::teardown();
+}
+
+bool tgRemoteView::isConnected() const
+{
+  return m_pServer->isOpen();
+}
+
+void tgRemoteView::advance()
+{
+  const bool wasConnected = m_pServer->isOpen();
+  tgWebSocket::Opcode opcode;
+  while (m_pServer->receive(opcode, m_message)) {
+    if (opcode == tgWebSocket::Text) {
+      readScene(m_message);
+    }
+    else if (m_pCodec != NULL) {
+      m_haveFrame = readFrame(m_message) || m_haveFrame;
+    }
+  }
+  if (wasConnected && !m_pServer->isOpen()) {
+    std::cerr << "tgRemoteView: the server closed the connection."
+	      << std::endl;
+  }
+
+  if (!m_matched && m_pCodec != NULL) {
+    matchRods();
+  }
+  if (m_matched && m_haveFrame) {
+    pose();
+  }
+
+  // Draw on every tick; the rate is set by the GLUT loop
+  m_renderTime = m_renderRate;
+}
+
+void tgRemoteView::readScene(const std::vector<unsigned char>& message)
+{
+  std::istringstream scene(std::string(message.begin(), message.end()));
+  std::string line;
+  if (!std::getline(scene, line) || line != "NTRTRV1") {
+    std::cerr << "tgRemoteView: ignoring a scene of an unknown kind."
+	      << std::endl;
+    return;
+  }
+  double resolution = 1e-3;
+  m_rigidTags.clear();
+  m_cableTags.clear();
+  while (std::getline(scene, line)) {
+    if (line.compare(0, 11, "resolution ") == 0) {
+      std::istringstream(line.substr(11)) >> resolution;
+    }
+    else if (line.compare(0, 6, "rigid ") == 0) {
+      m_rigidTags.push_back(line.substr(6));
+    }
+    else if (line.compare(0, 6, "cable ") == 0) {
+      m_cableTags.push_back(line.substr(6));
+    }
+  }
+
+  delete m_pCodec;
+  m_pCodec = NULL;
+  // The keyframe interval is the encoder's business
+  m_pCodec = new tgPoseStreamCodec(m_rigidTags.size(), resolution, 1);
+  m_poses.resize(m_rigidTags.size());
+  m_tensions.assign(m_cableTags.size(), 0.0f);
+  m_haveFrame = false;
+  m_matched = false;
+}
+
+bool tgRemoteView::readFrame(const std::vector<unsigned char>& message)
+{
+  if (message.size() < sizeof(double) + 1) {
+    return false;
+  }
+  const unsigned char* const pBegin = &message[0];
+  const unsigned char* const pEnd = pBegin + message.size();
+  const unsigned char* p = pBegin + sizeof(double);
+  try {
+    p = m_pCodec->decode(p, pEnd, m_poses.empty() ? NULL : &m_poses[0]);
+  }
+  catch (const std::runtime_error&) {
+    // A delta frame before the scene's first keyframe
+    return false;
+  }
+  if (static_cast<std::size_t>(pEnd - p) != m_tensions.size() * sizeof(float)) {
+    return false;
+  }
+  std::memcpy(&m_runTime, pBegin, sizeof(double));
+  if (!m_tensions.empty()) {
+    std::memcpy(&m_tensions[0], p, m_tensions.size() * sizeof(float));
+  }
+  return true;
+}
+
+void tgRemoteView::matchRods()
+{
+  m_matched = true;
+  m_bodies.assign(m_rigidTags.size(), NULL);
+
+  std::map<std::string, std::vector<std::size_t> > rigids;
+  for (std::size_t i = 0; i < m_rigidTags.size(); i++) {
+    rigids[m_rigidTags[i]].push_back(i);
+  }
+
+  std::vector<const tgRod*> rods;
+  m_pSimulation->onVisit(RodCollector(rods));
+
+  std::map<std::string, std::size_t> used;
+  std::size_t unmatched = 0;
+  for (std::size_t i = 0; i < rods.size(); i++) {
+    std::ostringstream tags;
+    tags << rods[i]->getTags();
+    const std::vector<std::size_t>& candidates = rigids[tags.str()];
+    std::size_t& k = used[tags.str()];
+    if (k >= candidates.size()) {
+      unmatched++;
+      continue;
+    }
+    // getPRigidBody is only non-const because it hands out the body
+    m_bodies[candidates[k++]] = const_cast<tgRod*>(rods[i])->getPRigidBody();
+  }
+  if (unmatched > 0) {
+    std::cerr << "tgRemoteView: " << unmatched << " of " << rods.size()
+	      << " rods are not in the served scene and will not move."
+	      << std::endl;
+  }
+}
+
+void tgRemoteView::pose()
+{
+  for (std::size_t i = 0; i < m_bodies.size(); i++) {
+    btRigidBody* const pBody = m_bodies[i];
+    if (pBody == NULL) {
+      continue;
+    }
+    const tgPoseStreamCodec::Pose& p = m_poses[i];
+    const btTransform transform(
+      btQuaternion(p.rotation[0], p.rotation[1], p.rotation[2], p.rotation[3]),
+      btVector3(p.position[0], p.position[1], p.position[2]));
+
+    // The renderer draws from the motion state, the cable anchors from
+    // the body
+    pBody->setWorldTransform(transform);
+    pBody->setInterpolationWorldTransform(transform);
+    if (pBody->getMotionState() != NULL) {
+      pBody->getMotionState()->setWorldTransform(transform);
+    }
+  }
+}
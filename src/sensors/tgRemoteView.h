@@ -0,0 +1,140 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_REMOTE_VIEW_H
+#define TG_REMOTE_VIEW_H
+
+/**
+ * @file tgRemoteView.h
+ * @brief Contains the definition of class tgRemoteView.
+ * $Id$
+ */
+
+// This module
+#include "tgPoseStreamCodec.h"
+// This application
+#include "core/tgSimViewGraphics.h"
+// The C++ Standard Library
+#include <string>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class tgWebSocket;
+class tgWorld;
+
+/**
+ * A graphical view of a run on another machine, served by a
+ * tgRemoteViewDataManager. As with tgReplayView, the model is built
+ * locally as it was for the run and added to the tgSimulation, but the
+ * world is never stepped: every GLUT tick the rods are put where the
+ * latest frame has them, and the cables follow their anchors' rods.
+ *
+ * The k-th rod of the model with given tags is driven by the k-th rigid
+ * of the served scene with the same tags. Frames that arrive between
+ * ticks are decoded but only the latest is shown. If the connection
+ * drops, the last frame stays on screen.
+ */
+class tgRemoteView : public tgSimViewGraphics
+{
+ public:
+
+  /**
+   * Connect to the server and ask for frames.
+   * @param[in] world the world the model is built in.
+   * @param[in] host where the tgRemoteViewDataManager runs.
+   * @param[in] port the port it listens on.
+   * @param[in] frameRate the frames per simulated second to ask for.
+   * @param[in] renderRate the wall-clock time between frames drawn.
+   * @throw std::runtime_error if the server can't be reached.
+   */
+  tgRemoteView(tgWorld& world, const std::string& host, int port,
+	       double frameRate = 30.0, double renderRate = 1.0/60.0);
+
+  /** Disconnects. */
+  virtual ~tgRemoteView();
+
+  /** Forget the rods, since they are rebuilt after a reset. */
+  virtual void teardown();
+
+  bool isConnected() const;
+
+  /** The run's time in the latest frame, since its last setup */
+  double getRunTime() const
+  {
+    return m_runTime;
+  }
+
+  /** The tags of each cable of the served scene */
+  const std::vector<std::string>& getCableTags() const
+  {
+    return m_cableTags;
+  }
+
+  /** Each cable's tension in the latest frame, as getCableTags */
+  const std::vector<float>& getTensions() const
+  {
+    return m_tensions;
+  }
+
+ protected:
+
+  /** Take in what the server sent and pose the rods */
+  virtual void advance();
+
+ private:
+
+  /** Replace the scene with the one in a text message */
+  void readScene(const std::vector<unsigned char>& message);
+
+  /** Decode a frame; false if it can't be, e.g. a delta after a gap */
+  bool readFrame(const std::vector<unsigned char>& message);
+
+  /** Pair the model's rods with the scene's rigids */
+  void matchRods();
+
+  /** Put the rods where the latest frame has them */
+  void pose();
+
+  tgWebSocket* m_pServer;
+
+  /** Made from each scene; NULL before the first */
+  tgPoseStreamCodec* m_pCodec;
+
+  /** The tags of each rigid of the scene, in pose order */
+  std::vector<std::string> m_rigidTags;
+
+  std::vector<std::string> m_cableTags;
+
+  /** The latest frame */
+  std::vector<tgPoseStreamCodec::Pose> m_poses;
+  std::vector<float> m_tensions;
+  double m_runTime;
+  bool m_haveFrame;
+
+  /** For each rigid of the scene, the model's body, or NULL */
+  std::vector<btRigidBody*> m_bodies;
+
+  /** False until the rods are matched to the scene */
+  bool m_matched;
+
+  /** A message, reused */
+  std::vector<unsigned char> m_message;
+};
+
+#endif // TG_REMOTE_VIEW_H
@@ -0,0 +1,419 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRemoteViewDataManager.cpp
+ * @brief Contains the definitions of members of class tgRemoteViewDataManager.
+ * $Id$
+ */
+
+// This module
+#include "tgRemoteViewDataManager.h"
+#include "tgWebSocket.h"
+// This application
+#include "core/tgBaseRigid.h"
+#include "core/tgCast.h"
+#include "core/tgSenseable.h"
+#include "core/tgSpringCableActuator.h"
+#include "core/tgTags.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btQuaternion.h"
+#include "LinearMath/btTransform.h"
+// The C++ Standard Library
+#include <cassert>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+// POSIX sockets
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace
+{
+  /** How often the server thread looks up from waiting, in ms */
+  const int kPollMs = 50;
+
+  void addSenseable(tgSenseable* pSenseable, std::vector<tgBaseRigid*>& rigids,
+		    std::vector<tgSpringCableActuator*>& cables)
+  {
+    tgBaseRigid* const pRigid =
+      tgCast::cast<tgSenseable, tgBaseRigid>(pSenseable);
+    if (pRigid != 0) {
+      rigids.push_back(pRigid);
+    }
+    tgSpringCableActuator* const pCable =
+      tgCast::cast<tgSenseable, tgSpringCableActuator>(pSenseable);
+    if (pCable != 0) {
+      cables.push_back(pCable);
+    }
+  }
+
+  /** The absolute time kPollMs from now, for pthread_cond_timedwait */
+  timespec pollDeadline()
+  {
+    timeval now;
+    gettimeofday(&now, NULL);
+    timespec deadline;
+    deadline.tv_sec = now.tv_sec;
+    deadline.tv_nsec = now.tv_usec * 1000 + kPollMs * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+    return deadline;
+  }
+}
+
+tgRemoteViewDataManager::tgRemoteViewDataManager(int port, double maxRate,
+						 double positionResolution,
+						 std::size_t keyframeInterval) :
+  tgDataManager(),
+  m_maxRate(maxRate),
+  m_positionResolution(positionResolution),
+  m_keyframeInterval(keyframeInterval),
+  m_listener(-1),
+  m_port(port),
+  m_sceneVersion(0),
+  m_hasPending(false),
+  m_rate(0.0),
+  m_keyframeWanted(true),
+  m_stopping(false),
+  m_codec(0, positionResolution, keyframeInterval),
+  m_active(false),
+  m_interval(0.0),
+  m_totalTime(0.0),
+  m_sinceFrame(0.0),
+  m_framesQueued(0),
+  m_framesDropped(0)
+{
+  if (!(maxRate > 0.0)) {
+    throw std::invalid_argument("The maximum frame rate must be positive.");
+  }
+  m_interval = 1.0 / m_maxRate;
+
+  m_listener = socket(AF_INET, SOCK_STREAM, 0);
+  if (m_listener < 0) {
+    throw std::runtime_error("Could not make the remote view socket.");
+  }
+  int one = 1;
+  setsockopt(m_listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(static_cast<unsigned short>(port));
+  socklen_t length = sizeof(address);
+  if (bind(m_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      listen(m_listener, 1) != 0 ||
+      getsockname(m_listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+    ::close(m_listener);
+    std::ostringstream message;
+    message << "Could not listen for remote viewers on port " << port << ".";
+    throw std::runtime_error(message.str());
+  }
+  m_port = ntohs(address.sin_port);
+
+  pthread_mutex_init(&m_mutex, NULL);
+  pthread_cond_init(&m_queued, NULL);
+  if (pthread_create(&m_server, NULL, serverMain, this) != 0) {
+    ::close(m_listener);
+    pthread_cond_destroy(&m_queued);
+    pthread_mutex_destroy(&m_mutex);
+    throw std::runtime_error("Could not start the remote view thread.");
+  }
+
+  std::cout << "tgRemoteViewDataManager is serving viewers on port "
+	    << m_port << std::endl;
+
+  // Postcondition
+  assert(invariant());
+}
+
+tgRemoteViewDataManager::~tgRemoteViewDataManager()
+{
+  pthread_mutex_lock(&m_mutex);
+  m_stopping = true;
+  pthread_cond_signal(&m_queued);
+  pthread_mutex_unlock(&m_mutex);
+  pthread_join(m_server, NULL);
+
+  ::close(m_listener);
+  pthread_cond_destroy(&m_queued);
+  pthread_mutex_destroy(&m_mutex);
+}
+
+void tgRemoteViewDataManager::setup()
+{
+  // Call the parent's setup method, which creates the sensors.
+  tgDataManager::setup();
+
+  m_rigids.clear();
+  m_cables.clear();
+  for (std::size_t i = 0; i < m_senseables.size(); i++) {
+    addSenseable(m_senseables[i], m_rigids, m_cables);
+    const std::vector<tgSenseable*> descendants =
+      m_senseables[i]->getSenseableDescendants();
+    for (std::size_t j = 0; j < descendants.size(); j++) {
+      addSenseable(descendants[j], m_rigids, m_cables);
+    }
+  }
+  m_codec = tgPoseStreamCodec(m_rigids.size(), m_positionResolution,
+			      m_keyframeInterval);
+  m_poses.resize(m_rigids.size());
+
+  std::ostringstream scene;
+  scene << "NTRTRV1\n" << "resolution " << m_positionResolution << '\n';
+  for (std::size_t i = 0; i < m_rigids.size(); i++) {
+    scene << "rigid " << m_rigids[i]->getTags() << '\n';
+  }
+  for (std::size_t i = 0; i < m_cables.size(); i++) {
+    scene << "cable " << m_cables[i]->getTags() << '\n';
+  }
+
+  pthread_mutex_lock(&m_mutex);
+  m_scene = scene.str();
+  m_sceneVersion++;
+  // A frame of the old scene is no use to the viewer
+  m_hasPending = false;
+  m_keyframeWanted = true;
+  pthread_cond_signal(&m_queued);
+  pthread_mutex_unlock(&m_mutex);
+
+  m_active = true;
+  m_totalTime = 0.0;
+  // The first step sends a frame
+  m_sinceFrame = m_interval;
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgRemoteViewDataManager::teardown()
+{
+  m_active = false;
+  m_rigids.clear();
+  m_cables.clear();
+  tgDataManager::teardown();
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgRemoteViewDataManager::step(double dt)
+{
+  if (dt <= 0.0)
+  {
+    throw std::invalid_argument("dt is not positive");
+  }
+  m_totalTime += dt;
+  m_sinceFrame += dt;
+  // Nothing to send before setup or after teardown
+  if (!m_active || m_sinceFrame < m_interval) {
+    return;
+  }
+  m_sinceFrame = 0.0;
+
+  pthread_mutex_lock(&m_mutex);
+  const double rate = m_rate;
+  const bool busy = m_hasPending;
+  const bool keyframe = m_keyframeWanted;
+  pthread_mutex_unlock(&m_mutex);
+
+  // Without a viewer, look again at the most frequent rate
+  m_interval = 1.0 / (rate > 0.0 ? rate : m_maxRate);
+  if (!(rate > 0.0)) {
+    return;
+  }
+  if (busy) {
+    m_framesDropped++;
+    return;
+  }
+  if (keyframe) {
+    m_codec.reset();
+  }
+  encodeFrame();
+
+  // The slot is still free, as only this thread fills it, but a viewer
+  // that connected meanwhile must start from a keyframe
+  pthread_mutex_lock(&m_mutex);
+  const bool queue = keyframe || !m_keyframeWanted;
+  if (queue) {
+    m_keyframeWanted = false;
+    m_pending.swap(m_building);
+    m_hasPending = true;
+    pthread_cond_signal(&m_queued);
+  }
+  pthread_mutex_unlock(&m_mutex);
+  if (queue) {
+    m_framesQueued++;
+  }
+  else {
+    m_framesDropped++;
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgRemoteViewDataManager::encodeFrame()
+{
+  for (std::size_t i = 0; i < m_rigids.size(); i++) {
+    btRigidBody* const pBody = m_rigids[i]->getPRigidBody();
+    const btTransform transform =
+      pBody != NULL ? pBody->getWorldTransform() : btTransform::getIdentity();
+    const btVector3& origin = transform.getOrigin();
+    const btQuaternion rotation = transform.getRotation();
+    tgPoseStreamCodec::Pose& pose = m_poses[i];
+    pose.position[0] = origin.x();
+    pose.position[1] = origin.y();
+    pose.position[2] = origin.z();
+    pose.rotation[0] = rotation.x();
+    pose.rotation[1] = rotation.y();
+    pose.rotation[2] = rotation.z();
+    pose.rotation[3] = rotation.w();
+  }
+
+  m_building.resize(sizeof(double));
+  std::memcpy(&m_building[0], &m_totalTime, sizeof(double));
+  m_codec.encode(m_poses.empty() ? NULL : &m_poses[0], m_building);
+  const std::size_t start = m_building.size();
+  m_building.resize(start + m_cables.size() * sizeof(float));
+  for (std::size_t i = 0; i < m_cables.size(); i++) {
+    const float tension = static_cast<float>(m_cables[i]->getTension());
+    std::memcpy(&m_building[start + i * sizeof(float)], &tension, sizeof(float));
+  }
+}
+
+void* tgRemoteViewDataManager::serverMain(void* arg)
+{
+  static_cast<tgRemoteViewDataManager*>(arg)->serve();
+  return NULL;
+}
+
+void tgRemoteViewDataManager::serve()
+{
+  pthread_mutex_lock(&m_mutex);
+  while (!m_stopping) {
+    pthread_mutex_unlock(&m_mutex);
+
+    pollfd listener;
+    listener.fd = m_listener;
+    listener.events = POLLIN;
+    listener.revents = 0;
+    tgWebSocket* pViewer = NULL;
+    if (poll(&listener, 1, kPollMs) > 0) {
+      const int fd = accept(m_listener, NULL, NULL);
+      if (fd >= 0) {
+	try {
+	  pViewer = tgWebSocket::accept(fd);
+	}
+	catch (const std::runtime_error& e) {
+	  std::cerr << "tgRemoteViewDataManager: " << e.what() << std::endl;
+	}
+      }
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    if (pViewer != NULL) {
+      serveViewer(*pViewer);
+      delete pViewer;
+    }
+  }
+  pthread_mutex_unlock(&m_mutex);
+}
+
+void tgRemoteViewDataManager::serveViewer(tgWebSocket& viewer)
+{
+  m_rate = m_maxRate;
+  m_keyframeWanted = true;
+  m_hasPending = false;
+  // Nothing has been sent yet, so the scene is due if there is one
+  std::size_t sentVersion = m_sceneVersion == 0 ? 0 : m_sceneVersion - 1;
+  std::vector<unsigned char> sending;
+  std::vector<unsigned char> request;
+
+  while (!m_stopping && viewer.isOpen()) {
+    if (sentVersion != m_sceneVersion) {
+      const std::string scene = m_scene;
+      sentVersion = m_sceneVersion;
+      pthread_mutex_unlock(&m_mutex);
+      viewer.send(scene);
+      pthread_mutex_lock(&m_mutex);
+    }
+    else if (m_hasPending) {
+      sending.swap(m_pending);
+      m_hasPending = false;
+      pthread_mutex_unlock(&m_mutex);
+      viewer.send(tgWebSocket::Binary, &sending[0], sending.size());
+      pthread_mutex_lock(&m_mutex);
+    }
+    else {
+      const timespec deadline = pollDeadline();
+      pthread_cond_timedwait(&m_queued, &m_mutex, &deadline);
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+    tgWebSocket::Opcode opcode;
+    while (viewer.receive(opcode, request)) {
+      if (opcode == tgWebSocket::Text) {
+	pthread_mutex_lock(&m_mutex);
+	handleRequest(request);
+	pthread_mutex_unlock(&m_mutex);
+      }
+    }
+    pthread_mutex_lock(&m_mutex);
+  }
+  m_rate = 0.0;
+  m_hasPending = false;
+}
+
+void tgRemoteViewDataManager::handleRequest(const std::vector<unsigned char>& message)
+{
+  std::istringstream request(std::string(message.begin(), message.end()));
+  std::string command;
+  double rate = 0.0;
+  if (request >> command >> rate && command == "rate" && rate > 0.0) {
+    m_rate = rate < m_maxRate ? rate : m_maxRate;
+  }
+}
+
+std::string tgRemoteViewDataManager::toString() const
+{
+  std::ostringstream os;
+  os << tgDataManager::toString()
+     << "This tgDataManager is a tgRemoteViewDataManager. " << std::endl;
+
+  return os.str();
+}
+
+bool tgRemoteViewDataManager::invariant() const
+{
+  return (m_maxRate > 0.0) && (m_listener >= 0) &&
+    (m_active || m_rigids.empty());
+}
+
+std::ostream&
+operator<<(std::ostream& os, const tgRemoteViewDataManager& obj)
+{
+    os << obj.toString() << std::endl;
+    return os;
+}
@@ -0,0 +1,224 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_REMOTE_VIEW_DATA_MANAGER_H
+#define TG_REMOTE_VIEW_DATA_MANAGER_H
+
+/**
+ * @file tgRemoteViewDataManager.h
+ * @brief Contains the definition of class tgRemoteViewDataManager.
+ * $Id$
+ */
+
+// This module
+#include "tgDataManager.h"
+#include "tgPoseStreamCodec.h"
+// The C++ Standard Library
+#include <iostream>
+#include <string>
+#include <vector>
+// POSIX threads
+#include <pthread.h>
+
+// Forward declarations
+class tgBaseRigid;
+class tgSpringCableActuator;
+class tgWebSocket;
+
+/**
+ * tgRemoteViewDataManager serves the poses of the rigids and the
+ * tensions of the cables of its senseables over a WebSocket, so a
+ * headless run can be watched from another machine, e.g. with
+ * tgRemoteView, instead of forwarding GLUT. One viewer at a time is
+ * served; it sends the text message "rate <hz>" for the frames per
+ * simulated second it wants, up to the maximum given here.
+ *
+ * Nothing the viewer does can hold up the step. A frame that is due
+ * while the previous one is still being sent is dropped, not queued;
+ * the sending and the handshake happen on a thread of the manager's own,
+ * and the step only hands it a buffer under a short lock.
+ *
+ * After each setup, and on connecting, the viewer is sent the scene as
+ * a text message of lines:
+ *   "NTRTRV1",
+ *   "resolution <position resolution>",
+ *   "rigid <tags>" for each rigid, in pose order,
+ *   "cable <tags>" for each cable, in tension order.
+ * Then each frame is a binary message of, in native byte order, the
+ * double time since setup, a tgPoseStreamCodec frame of the rigids'
+ * poses, and a float tension per cable. The first frame after a scene
+ * is a keyframe.
+ */
+class tgRemoteViewDataManager : public tgDataManager
+{
+ public:
+
+  /**
+   * Starts listening.
+   * @param[in] port the TCP port to listen on; 0 for any free one, as
+   * getPort then tells.
+   * @param[in] maxRate the most frames per simulated second, and the
+   * rate until the viewer asks for another.
+   * @param[in] positionResolution the quantization step of positions.
+   * @param[in] keyframeInterval the frames from one keyframe to the next.
+   * @throw std::invalid_argument if maxRate is not positive.
+   * @throw std::runtime_error if the port can't be listened on.
+   */
+  tgRemoteViewDataManager(int port, double maxRate = 30.0,
+			  double positionResolution = 1e-3,
+			  std::size_t keyframeInterval = 64);
+
+  /** Disconnects the viewer and stops listening. */
+  virtual ~tgRemoteViewDataManager();
+
+  /**
+   * Creates the sensors, finds the rigids and cables, and queues the
+   * scene for the viewer.
+   */
+  virtual void setup();
+
+  /**
+   * Stops sending frames until the next setup, then deletes the sensors.
+   */
+  virtual void teardown();
+
+  /**
+   * Hands a frame to the sending thread, if one is due and a viewer is
+   * connected.
+   * @param[in] dt a double, the amount of time since the last step.
+   */
+  virtual void step(double dt);
+
+  /**
+   * Overwrite toString for the superclass to specify that this data manager
+   * is a tgRemoteViewDataManager.
+   */
+  virtual std::string toString() const;
+
+  /** The port being listened on. */
+  int getPort() const
+  {
+    return m_port;
+  }
+
+  /** Frames handed to the sending thread. */
+  std::size_t getFramesQueued() const
+  {
+    return m_framesQueued;
+  }
+
+  /** Frames that were due while the previous one was being sent. */
+  std::size_t getFramesDropped() const
+  {
+    return m_framesDropped;
+  }
+
+ protected:
+
+  // Integrity predicate.
+  bool invariant() const;
+
+ private:
+
+  /** Accept viewers and send them the scene and frames, until stopped. */
+  void serve();
+
+  /**
+   * Serve one connected viewer until it goes away or the manager stops.
+   * Called and returns with m_mutex held.
+   */
+  void serveViewer(tgWebSocket& viewer);
+
+  /** Act on a message from the viewer. Called with m_mutex held. */
+  void handleRequest(const std::vector<unsigned char>& message);
+
+  /** pthread entry point; arg is the manager */
+  static void* serverMain(void* arg);
+
+  /** Put the poses and tensions after the time in m_building */
+  void encodeFrame();
+
+  const double m_maxRate;
+
+  const double m_positionResolution;
+
+  const std::size_t m_keyframeInterval;
+
+  /** The listening socket */
+  int m_listener;
+
+  int m_port;
+
+  pthread_t m_server;
+
+  /** Guards everything below it that is shared with m_server */
+  mutable pthread_mutex_t m_mutex;
+
+  /** Signalled when a frame or scene is queued, or when stopping */
+  pthread_cond_t m_queued;
+
+  /** The scene text, and a count of setups so a new one is noticed */
+  std::string m_scene;
+  std::size_t m_sceneVersion;
+
+  /** The frame waiting to be sent */
+  std::vector<unsigned char> m_pending;
+  bool m_hasPending;
+
+  /** The rate the viewer asked for; 0 without a viewer */
+  double m_rate;
+
+  /** Set when the next frame must be a keyframe */
+  bool m_keyframeWanted;
+
+  bool m_stopping;
+
+  /** The rest belongs to the stepping thread */
+
+  std::vector<tgBaseRigid*> m_rigids;
+  std::vector<tgSpringCableActuator*> m_cables;
+
+  tgPoseStreamCodec m_codec;
+
+  /** Buffers reused from frame to frame */
+  std::vector<tgPoseStreamCodec::Pose> m_poses;
+  std::vector<unsigned char> m_building;
+
+  /** True from setup to teardown */
+  bool m_active;
+
+  /** Seconds between frames, as of the last look at m_rate */
+  double m_interval;
+
+  double m_totalTime;
+  double m_sinceFrame;
+
+  std::size_t m_framesQueued;
+  std::size_t m_framesDropped;
+};
+
+/**
+ * Overload operator<<() to handle tgRemoteViewDataManager
+ * @param[in,out] os an ostream
+ * @param[in] obj a tgRemoteViewDataManager
+ * @return os
+ */
+std::ostream&
+operator<<(std::ostream& os, const tgRemoteViewDataManager& obj);
+
+#endif // TG_REMOTE_VIEW_DATA_MANAGER_H
@@ -0,0 +1,292 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgReplayView.cpp
+ * @brief Contains the definitions of members of class tgReplayView.
+ * $Id$
+ */
+
+// This module
+#include "tgReplayView.h"
+// This application
+#include "core/tgModelVisitor.h"
+#include "core/tgRod.h"
+#include "core/tgSimulation.h"
+#include "core/tgTags.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btMatrix3x3.h"
+#include "LinearMath/btMotionState.h"
+#include "LinearMath/btQuaternion.h"
+#include "LinearMath/btTransform.h"
+// The C++ Standard Library
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <time.h>
+
+namespace
+{
+  // tgRodSensor's pose fields, in Track::columns order
+  const char* const kFields[6] =
+    {".X", ".Y", ".Z", ".Euler1", ".Euler2", ".Euler3"};
+
+  /** Collects the rods of the models in the order the sensors see them */
+  class RodCollector : public tgModelVisitor
+  {
+  public:
+    RodCollector(std::vector<const tgRod*>& rods) : m_rods(rods) { }
+
+    virtual void render(const tgRod& rod) const
+    {
+      m_rods.push_back(&rod);
+    }
+
+  private:
+    std::vector<const tgRod*>& m_rods;
+  };
+
+  double wallClock()
+  {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+  }
+
+  btQuaternion eulerToQuaternion(double yaw, double pitch, double roll)
+  {
+    // The inverse of the getEulerYPR in tgBaseRigid::orientation
+    btMatrix3x3 basis;
+    basis.setEulerYPR(yaw, pitch, roll);
+    btQuaternion rotation;
+    basis.getRotation(rotation);
+    return rotation;
+  }
+}
+
+tgReplayView::tgReplayView(tgWorld& world,
+			   const std::string& fileName,
+			   double renderRate) :
+  tgSimViewGraphics(world, renderRate, renderRate),
+  m_pLog(tgLogReader::open(fileName)),
+  m_matched(false),
+  m_playbackTime(0.0),
+  m_speed(1.0),
+  m_paused(false),
+  m_lastTick(0.0)
+{
+  if (m_pLog->getRowCount() == 0) {
+    delete m_pLog;
+    throw std::runtime_error("The log has no rows inside tgReplayView.");
+  }
+  m_playbackTime = m_pLog->getTime(0);
+}
+
+tgReplayView::~tgReplayView()
+{
+  delete m_pLog;
+}
+
+void tgReplayView::teardown()
+{
+  m_tracks.clear();
+  m_matched = false;
+  tgSimViewGraphics::teardown();
+}
+
+void tgReplayView::clientResetScene()
+{
+  seek(m_pLog->getTime(0));
+}
+
+void tgReplayView::keyboardCallback(unsigned char key, int x, int y)
+{
+  switch (key) {
+  case 'k':
+    m_paused = !m_paused;
+    break;
+  case '[':
+    stepRow(false);
+    break;
+  case ']':
+    stepRow(true);
+    break;
+  case '{':
+    m_speed /= 2.0;
+    break;
+  case '}':
+    m_speed *= 2.0;
+    break;
+  case '\\':
+    m_speed = -m_speed;
+    break;
+  default:
+    tgSimViewGraphics::keyboardCallback(key, x, y);
+  }
+}
+
+void tgReplayView::seek(double time)
+{
+  const double first = m_pLog->getTime(0);
+  const double last = m_pLog->getTime(m_pLog->getRowCount() - 1);
+  m_playbackTime = time < first ? first : (time > last ? last : time);
+}
+
+void tgReplayView::stepRow(bool forward)
+{
+  m_paused = true;
+  std::size_t row = m_pLog->findRow(m_playbackTime);
+  if (forward) {
+    if (row + 1 < m_pLog->getRowCount()) {
+      row++;
+    }
+  }
+  else if (row > 0 && m_pLog->getTime(row) >= m_playbackTime) {
+    row--;
+  }
+  m_playbackTime = m_pLog->getTime(row);
+}
+
+void tgReplayView::advance()
+{
+  if (!m_matched) {
+    matchRods();
+    m_lastTick = wallClock();
+  }
+
+  const double now = wallClock();
+  if (!m_paused) {
+    const double before = m_playbackTime;
+    seek(m_playbackTime + (now - m_lastTick) * m_speed);
+    if (m_playbackTime == before && m_speed != 0.0) {
+      // Reached an end of the log
+      m_paused = true;
+    }
+  }
+  m_lastTick = now;
+
+  pose();
+
+  // Draw on every tick; the rate is set by the GLUT loop
+  m_renderTime = m_renderRate;
+}
+
+void tgReplayView::matchRods()
+{
+  m_tracks.clear();
+  m_matched = true;
+
+  // The rod sensors' X columns, in order, by tags. Frame headings look
+  // like "<sensor index>_rod(<tags>).X".
+  std::map<std::string, std::vector<std::size_t> > xColumns;
+  const std::vector<std::string>& headings = m_pLog->getHeadings();
+  for (std::size_t c = 0; c < headings.size(); c++) {
+    const std::string& heading = headings[c];
+    const std::size_t open = heading.find("_rod(");
+    const std::size_t close = heading.rfind(").X");
+    if (open != std::string::npos && close != std::string::npos &&
+	close > open && close + 3 == heading.size()) {
+      xColumns[heading.substr(open + 5, close - open - 5)].push_back(c);
+    }
+  }
+
+  std::vector<const tgRod*> rods;
+  m_pSimulation->onVisit(RodCollector(rods));
+
+  std::map<std::string, std::size_t> used;
+  std::size_t unmatched = 0;
+  for (std::size_t i = 0; i < rods.size(); i++) {
+    std::ostringstream tags;
+    tags << rods[i]->getTags();
+    const std::vector<std::size_t>& candidates = xColumns[tags.str()];
+    std::size_t& k = used[tags.str()];
+    if (k >= candidates.size()) {
+      unmatched++;
+      continue;
+    }
+    const std::string& heading = headings[candidates[k++]];
+    const std::string prefix = heading.substr(0, heading.size() - 2);
+
+    Track track;
+    // getPRigidBody is only non-const because it hands out the body
+    track.pBody = const_cast<tgRod*>(rods[i])->getPRigidBody();
+    bool complete = track.pBody != NULL;
+    for (std::size_t f = 0; f < 6 && complete; f++) {
+      track.columns[f] = m_pLog->findColumn(prefix + kFields[f]);
+      complete = track.columns[f] < headings.size();
+    }
+    if (complete) {
+      m_tracks.push_back(track);
+    }
+    else {
+      unmatched++;
+    }
+  }
+  if (unmatched > 0) {
+    std::cerr << "tgReplayView: " << unmatched << " of " << rods.size()
+	      << " rods are not in the log and will not move." << std::endl;
+  }
+}
+
+void tgReplayView::pose()
+{
+  const std::size_t row = m_pLog->findRow(m_playbackTime);
+  const std::size_t next =
+    row + 1 < m_pLog->getRowCount() ? row + 1 : row;
+  const double t0 = m_pLog->getTime(row);
+  const double t1 = m_pLog->getTime(next);
+  double alpha = t1 > t0 ? (m_playbackTime - t0) / (t1 - t0) : 0.0;
+  alpha = alpha < 0.0 ? 0.0 : (alpha > 1.0 ? 1.0 : alpha);
+
+  // One row at a time, since a pose stream decodes whole rows
+  m_poseValues.resize(12 * m_tracks.size());
+  for (std::size_t i = 0; i < m_tracks.size(); i++) {
+    for (std::size_t f = 0; f < 6; f++) {
+      m_poseValues[12 * i + f] = m_pLog->getValue(row, m_tracks[i].columns[f]);
+    }
+  }
+  for (std::size_t i = 0; i < m_tracks.size(); i++) {
+    for (std::size_t f = 0; f < 6; f++) {
+      m_poseValues[12 * i + 6 + f] = m_pLog->getValue(next, m_tracks[i].columns[f]);
+    }
+  }
+
+  for (std::size_t i = 0; i < m_tracks.size(); i++) {
+    const Track& track = m_tracks[i];
+    const double* const a = &m_poseValues[12 * i];
+    const double* const b = a + 6;
+    const btVector3 position =
+      btVector3(a[0], a[1], a[2]).lerp(btVector3(b[0], b[1], b[2]), alpha);
+    const btQuaternion rotation =
+      eulerToQuaternion(a[3], a[4], a[5]).slerp(
+        eulerToQuaternion(b[3], b[4], b[5]), alpha);
+    const btTransform transform(rotation, position);
+
+    // The renderer draws from the motion state, the cable anchors from
+    // the body
+    btRigidBody* const pBody = track.pBody;
+    pBody->setWorldTransform(transform);
+    pBody->setInterpolationWorldTransform(transform);
+    if (pBody->getMotionState() != NULL) {
+      pBody->getMotionState()->setWorldTransform(transform);
+    }
+  }
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_REPLAY_VIEW_H
+#define TG_REPLAY_VIEW_H
+
+/**
+ * @file tgReplayView.h
+ * @brief Contains the definition of class tgReplayView.
+ * $Id$
+ */
+
+// This module
+#include "tgLogReader.h"
+// This application
+#include "core/tgSimViewGraphics.h"
+// The C++ Standard Library
+#include <string>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class tgWorld;
+
+/**
+ * A graphical view that plays back a run from a tgBinaryDataLogger,
+ * tgAsyncDataLogger or tgPoseStreamLogger log of tgRodSensor data instead of simulating it. The
+ * model is built as usual and added to the tgSimulation, but the world is
+ * never stepped: every GLUT tick the rods are put where the log says,
+ * interpolated between rows, and the scene is drawn by tgBulletRenderer
+ * as before. The cables follow their anchors' rods.
+ *
+ * The k-th rod of the model, in the order the sensors visit them, with
+ * given tags is driven by the k-th rod sensor in the log with the same
+ * tags, so the model must be built as it was for the run. Rods with
+ * nothing in the log stay where they were built.
+ *
+ * Keys: 'k' pauses and resumes, '[' and ']' step one row back and forward
+ * while paused, '{' and '}' halve and double the speed, '\' reverses and
+ * the space bar goes back to the start. The other keys are as in
+ * tgSimViewGraphics.
+ */
+class tgReplayView : public tgSimViewGraphics
+{
+ public:
+
+  /**
+   * Map the log.
+   * @param[in] world the world the model is built in.
+   * @param[in] fileName the binary log to play.
+   * @param[in] renderRate the wall-clock time between frames.
+   * @throw std::runtime_error if the log can't be read or has no rows.
+   */
+  tgReplayView(tgWorld& world,
+	       const std::string& fileName,
+	       double renderRate = 1.0/60.0);
+
+  /** Unmaps the log. */
+  virtual ~tgReplayView();
+
+  /** Forget the rods, since they are rebuilt after a reset. */
+  virtual void teardown();
+
+  /** Go back to the start of the log rather than resetting. */
+  virtual void clientResetScene();
+
+  virtual void keyboardCallback(unsigned char key, int x, int y);
+
+  /** The log time being shown */
+  double getPlaybackTime() const
+  {
+    return m_playbackTime;
+  }
+
+  /**
+   * Show a time.
+   * @param[in] time clamped to the times in the log.
+   */
+  void seek(double time);
+
+  /**
+   * How fast the log plays relative to the wall clock; negative to play
+   * backward.
+   */
+  double getSpeed() const
+  {
+    return m_speed;
+  }
+
+  void setSpeed(double speed)
+  {
+    m_speed = speed;
+  }
+
+  bool isPaused() const
+  {
+    return m_paused;
+  }
+
+  void setPaused(bool paused)
+  {
+    m_paused = paused;
+  }
+
+ protected:
+
+  /** Move the playback time on by the wall-clock time since the last tick */
+  virtual void advance();
+
+ private:
+
+  /** A rod and the columns of its pose in the log */
+  struct Track
+  {
+    btRigidBody* pBody;
+    /** X, Y, Z, Euler1, Euler2, Euler3 */
+    std::size_t columns[6];
+  };
+
+  /** Pair the model's rods with the log's rod sensors */
+  void matchRods();
+
+  /** Put the rods where the log has them at m_playbackTime */
+  void pose();
+
+  /** Step to the row before or after the one shown and pause */
+  void stepRow(bool forward);
+
+  /** Opened with tgLogReader::open; owned */
+  tgLogReader* m_pLog;
+
+  std::vector<Track> m_tracks;
+
+  /** Each track's pose in the row shown and the next, reused */
+  std::vector<double> m_poseValues;
+
+  /** False until the rods are matched, and again after a teardown */
+  bool m_matched;
+
+  double m_playbackTime;
+
+  double m_speed;
+
+  bool m_paused;
+
+  /** The wall-clock time of the last tick, in seconds */
+  double m_lastTick;
+};
+
+#endif // TG_REPLAY_VIEW_H
@@ -183,4 +183,49 @@ std::vector<std::string> tgRodSensor::getSensorData() {
   return sensordata;
 }
 
+/**
+ * The numeric version of getSensorData, for the binary logger and for
+ * controllers. Same fields, same order, no strings.
+ */
+std::size_t tgRodSensor::getSensorDataSize() {
+  return 7;
+}
+
+void tgRodSensor::sampleInto(double* out) {
+  tgRod* m_pRod = tgCast::cast<tgSenseable, tgRod>(m_pSens);
+  assert( m_pRod != 0);
+  btVector3 com = m_pRod->centerOfMass();
+  btVector3 orient = m_pRod->orientation();
+  out[0] = com[0];
+  out[1] = com[1];
+  out[2] = com[2];
+  out[3] = orient[0];
+  out[4] = orient[1];
+  out[5] = orient[2];
+  out[6] = m_pRod->mass();
+}
+
+/**
+ * The orientation is the costly part: a quaternion to Euler conversion.
+ */
+void tgRodSensor::sampleWantedInto(double* out, const char* wanted) {
+  tgRod* m_pRod = tgCast::cast<tgSenseable, tgRod>(m_pSens);
+  assert( m_pRod != 0);
+  if (wanted[0] || wanted[1] || wanted[2]) {
+    const btVector3 com = m_pRod->centerOfMass();
+    out[0] = com[0];
+    out[1] = com[1];
+    out[2] = com[2];
+  }
+  if (wanted[3] || wanted[4] || wanted[5]) {
+    const btVector3 orient = m_pRod->orientation();
+    out[3] = orient[0];
+    out[4] = orient[1];
+    out[5] = orient[2];
+  }
+  if (wanted[6]) {
+    out[6] = m_pRod->mass();
+  }
+}
+
 //end.
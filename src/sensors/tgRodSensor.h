@@ -57,6 +57,17 @@ public:
   virtual std::vector<std::string> getSensorDataHeadings();
   virtual std::vector<std::string> getSensorData();
 
+  /**
+   * Numeric versions of the above, see tgSensor.
+   */
+  virtual std::size_t getSensorDataSize();
+  virtual void sampleInto(double* out);
+
+  /**
+   * Skips the Euler angles unless one of them is wanted.
+   */
+  virtual void sampleWantedInto(double* out, const char* wanted);
+
 };
 
 #endif //TG_ROD_SENSOR_H
@@ -78,3 +78,10 @@ std::vector<tgSensor*> tgRodSensorInfo::createSensorsIfAppropriate(tgSenseable*
   newSensors.push_back( new tgRodSensor( tgCast::cast<tgSenseable, tgRod>(pSenseable) ));
   return newSensors;
 }
+
+bool tgRodSensorInfo::findSenseables(tgModel* pModel,
+				  std::vector<tgSenseable*>& senseables)
+{
+  appendOfType<tgRod>(pModel, senseables);
+  return true;
+}
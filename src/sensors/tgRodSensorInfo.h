@@ -82,6 +82,13 @@ class tgRodSensorInfo : public tgSensorInfo
    */
   virtual std::vector<tgSensor*> createSensorsIfAppropriate(tgSenseable* pSenseable);
 
+  /**
+   * Every tgRod in the model, from its index by type.
+   * @return true
+   */
+  virtual bool findSenseables(tgModel* pModel,
+			      std::vector<tgSenseable*>& senseables);
+
 };
 
 #endif // TG_ROD_SENSOR_INFO_H
@@ -0,0 +1,81 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSampleRing.cpp
+ * @brief Contains the definitions of members of class tgSampleRing.
+ * $Id$
+ */
+
+// This module
+#include "tgSampleRing.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+tgSampleRing::tgSampleRing(std::size_t rowSize, std::size_t capacity) :
+  m_rows(rowSize * capacity, 0.0),
+  m_rowSize(rowSize),
+  m_capacity(capacity),
+  m_popped(0),
+  m_pushed(0)
+{
+  if (rowSize == 0 || capacity == 0) {
+    throw std::invalid_argument("A sample ring must hold at least one row of one double.");
+  }
+}
+
+/**
+ * The counters only grow, so their difference is right even after they
+ * wrap around.
+ */
+std::size_t tgSampleRing::size() const
+{
+  return m_pushed - m_popped;
+}
+
+double* tgSampleRing::beginPush()
+{
+  if (m_pushed - m_popped == m_capacity) {
+    return NULL;
+  }
+  return &m_rows[(m_pushed % m_capacity) * m_rowSize];
+}
+
+void tgSampleRing::commitPush()
+{
+  // The row must be visible before the count that publishes it.
+  __sync_synchronize();
+  m_pushed = m_pushed + 1;
+}
+
+const double* tgSampleRing::front() const
+{
+  if (m_pushed == m_popped) {
+    return NULL;
+  }
+  // Don't read the row before the count that published it.
+  __sync_synchronize();
+  return &m_rows[(m_popped % m_capacity) * m_rowSize];
+}
+
+void tgSampleRing::pop()
+{
+  // Finish reading the row before the producer may overwrite it.
+  __sync_synchronize();
+  m_popped = m_popped + 1;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SAMPLE_RING_H
+#define TG_SAMPLE_RING_H
+
+/**
+ * @file tgSampleRing.h
+ * @brief Contains the definition of class tgSampleRing.
+ * $Id$
+ */
+
+// Includes from the C++ standard library
+#include <vector>
+
+/**
+ * A fixed-size queue of rows of doubles between exactly one producer
+ * thread and one consumer thread. Neither side locks or allocates: each
+ * index is written by one side only, and memory barriers order the row
+ * data before the index that publishes it.
+ */
+class tgSampleRing
+{
+ public:
+
+  /**
+   * Allocates all the rows.
+   * @param[in] rowSize the doubles in a row; must be positive.
+   * @param[in] capacity the rows held at once; must be positive.
+   */
+  tgSampleRing(std::size_t rowSize, std::size_t capacity);
+
+  /** The doubles in a row */
+  std::size_t rowSize() const
+  {
+    return m_rowSize;
+  }
+
+  /** The rows held at once */
+  std::size_t capacity() const
+  {
+    return m_capacity;
+  }
+
+  /**
+   * The rows queued. Exact on the consumer side; on the producer side it
+   * may overstate, never understate, what the consumer has left.
+   */
+  std::size_t size() const;
+
+  /**
+   * Producer only: the row to fill next.
+   * @return NULL if the ring is full.
+   */
+  double* beginPush();
+
+  /** Producer only: publish the row returned by beginPush. */
+  void commitPush();
+
+  /**
+   * Consumer only: the oldest row.
+   * @return NULL if the ring is empty.
+   */
+  const double* front() const;
+
+  /** Consumer only: release the row returned by front. */
+  void pop();
+
+ private:
+
+  std::vector<double> m_rows;
+
+  const std::size_t m_rowSize;
+
+  const std::size_t m_capacity;
+
+  /** Rows ever popped; written by the consumer only. */
+  volatile std::size_t m_popped;
+
+  /** Rows ever pushed; written by the producer only. */
+  volatile std::size_t m_pushed;
+
+};
+
+#endif // TG_SAMPLE_RING_H
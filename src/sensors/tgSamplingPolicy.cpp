@@ -0,0 +1,240 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSamplingPolicy.cpp
+ * @brief Contains the definitions of members of tgSamplingPolicy and its
+ * subclasses.
+ * $Id$
+ */
+
+// This module
+#include "tgSamplingPolicy.h"
+// The C++ Standard Library
+#include <algorithm> // for std::copy
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+tgSampleSink::~tgSampleSink()
+{
+}
+
+tgSamplingPolicy::tgSamplingPolicy() :
+  m_count(0)
+{
+}
+
+tgSamplingPolicy::~tgSamplingPolicy()
+{
+}
+
+void tgSamplingPolicy::reset(std::size_t count)
+{
+  m_count = count;
+}
+
+void tgSamplingPolicy::offer(std::size_t sensorIndex, double time,
+			     const double* values, tgSampleSink& sink)
+{
+  sink.write(sensorIndex, time, values, m_count);
+}
+
+tgFixedRatePolicy::tgFixedRatePolicy(double interval) :
+  m_interval(interval),
+  m_lastTime(0.0),
+  m_sampled(false)
+{
+  if (m_interval < 0.0) {
+    throw std::invalid_argument("Time interval must be nonnegative.");
+  }
+}
+
+tgSamplingPolicy* tgFixedRatePolicy::clone() const
+{
+  return new tgFixedRatePolicy(m_interval);
+}
+
+void tgFixedRatePolicy::reset(std::size_t count)
+{
+  tgSamplingPolicy::reset(count);
+  m_lastTime = 0.0;
+  m_sampled = false;
+}
+
+bool tgFixedRatePolicy::isDue(double time)
+{
+  if (m_sampled && time - m_lastTime < m_interval) {
+    return false;
+  }
+  m_lastTime = time;
+  m_sampled = true;
+  return true;
+}
+
+tgDecimationPolicy::tgDecimationPolicy(std::size_t factor) :
+  m_factor(factor),
+  m_steps(0)
+{
+  if (m_factor == 0) {
+    throw std::invalid_argument("Decimation factor must be positive.");
+  }
+}
+
+tgSamplingPolicy* tgDecimationPolicy::clone() const
+{
+  return new tgDecimationPolicy(m_factor);
+}
+
+void tgDecimationPolicy::reset(std::size_t count)
+{
+  tgSamplingPolicy::reset(count);
+  m_steps = 0;
+}
+
+bool tgDecimationPolicy::isDue(double time)
+{
+  return (m_steps++ % m_factor) == 0;
+}
+
+tgTriggerPolicy::tgTriggerPolicy(std::size_t field, Condition condition,
+				 double threshold, std::size_t preTriggerRows,
+				 double postTriggerTime, double idleInterval) :
+  m_field(field),
+  m_condition(condition),
+  m_threshold(threshold),
+  m_preTriggerRows(preTriggerRows),
+  m_postTriggerTime(postTriggerTime),
+  m_idleInterval(idleInterval),
+  m_buffered(0),
+  m_next(0),
+  m_windowEnd(0.0),
+  m_inWindow(false),
+  m_lastIdleTime(0.0),
+  m_idleSampled(false),
+  m_lastValue(0.0),
+  m_lastTime(0.0),
+  m_hasLast(false),
+  m_triggers(0)
+{
+  if (m_postTriggerTime < 0.0) {
+    throw std::invalid_argument("Post-trigger time must be nonnegative.");
+  }
+}
+
+tgSamplingPolicy* tgTriggerPolicy::clone() const
+{
+  return new tgTriggerPolicy(m_field, m_condition, m_threshold,
+			     m_preTriggerRows, m_postTriggerTime, m_idleInterval);
+}
+
+/**
+ * All the allocation happens here, none during offer.
+ */
+void tgTriggerPolicy::reset(std::size_t count)
+{
+  if (m_field >= count) {
+    throw std::out_of_range("The trigger field is not one of the sensor's values.");
+  }
+  tgSamplingPolicy::reset(count);
+  m_buffer.assign(m_preTriggerRows * (count + 1), 0.0);
+  m_buffered = 0;
+  m_next = 0;
+  m_windowEnd = 0.0;
+  m_inWindow = false;
+  m_lastIdleTime = 0.0;
+  m_idleSampled = false;
+  m_hasLast = false;
+  m_triggers = 0;
+}
+
+bool tgTriggerPolicy::isDue(double time)
+{
+  return true;
+}
+
+bool tgTriggerPolicy::triggers(double time, const double* values) const
+{
+  const double value = values[m_field];
+  switch (m_condition) {
+  case eAbove:
+    return value > m_threshold;
+  case eBelow:
+    return value < m_threshold;
+  case eRateAbove:
+    return m_hasLast && time > m_lastTime &&
+      std::fabs(value - m_lastValue) / (time - m_lastTime) > m_threshold;
+  }
+  return false;
+}
+
+void tgTriggerPolicy::release(std::size_t sensorIndex, tgSampleSink& sink)
+{
+  const std::size_t rowSize = m_count + 1;
+  // The oldest row is m_buffered behind the next one to be written.
+  std::size_t row = (m_next + m_preTriggerRows - m_buffered) % std::max<std::size_t>(m_preTriggerRows, 1);
+  for (std::size_t i = 0; i < m_buffered; i++) {
+    const double* const pRow = &m_buffer[row * rowSize];
+    sink.write(sensorIndex, pRow[0], pRow + 1, m_count);
+    row = (row + 1) % m_preTriggerRows;
+  }
+  m_buffered = 0;
+  m_next = 0;
+}
+
+void tgTriggerPolicy::offer(std::size_t sensorIndex, double time,
+			    const double* values, tgSampleSink& sink)
+{
+  if (triggers(time, values)) {
+    ++m_triggers;
+    release(sensorIndex, sink);
+    sink.write(sensorIndex, time, values, m_count);
+    m_inWindow = true;
+    m_windowEnd = time + m_postTriggerTime;
+    // The idle trace restarts from the last sample written.
+    m_lastIdleTime = time;
+    m_idleSampled = true;
+  }
+  else if (m_inWindow && time <= m_windowEnd) {
+    sink.write(sensorIndex, time, values, m_count);
+    m_lastIdleTime = time;
+  }
+  else {
+    m_inWindow = false;
+    if (m_idleInterval > 0.0 &&
+	(!m_idleSampled || time - m_lastIdleTime >= m_idleInterval)) {
+      // Anything buffered is older than this, so it can't be written later.
+      m_buffered = 0;
+      m_next = 0;
+      sink.write(sensorIndex, time, values, m_count);
+      m_lastIdleTime = time;
+      m_idleSampled = true;
+    }
+    else if (m_preTriggerRows > 0) {
+      double* const pRow = &m_buffer[m_next * (m_count + 1)];
+      pRow[0] = time;
+      std::copy(values, values + m_count, pRow + 1);
+      m_next = (m_next + 1) % m_preTriggerRows;
+      m_buffered = std::min(m_buffered + 1, m_preTriggerRows);
+    }
+  }
+
+  m_lastValue = values[m_field];
+  m_lastTime = time;
+  m_hasLast = true;
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SAMPLING_POLICY_H
+#define TG_SAMPLING_POLICY_H
+
+/**
+ * @file tgSamplingPolicy.h
+ * @brief Contains the definitions of tgSamplingPolicy and its subclasses.
+ * $Id$
+ */
+
+// Includes from the C++ standard library
+#include <vector>
+
+/**
+ * Where tgDataManager::sampleByPolicy sends the samples that the sampling
+ * policies keep, e.g. a tgEventDataLogger.
+ */
+class tgSampleSink
+{
+ public:
+
+  virtual ~tgSampleSink();
+
+  /**
+   * Take one sample of one sensor. Samples of a sensor arrive in time
+   * order, but those released from a pre-trigger buffer may be older than
+   * samples of other sensors written before them.
+   * @param[in] sensorIndex the index of the sensor, in setup order.
+   * @param[in] time the simulation time of the sample.
+   * @param[in] values the sensor's data, valid during the call only.
+   * @param[in] count the number of values.
+   */
+  virtual void write(std::size_t sensorIndex, double time,
+		     const double* values, std::size_t count) = 0;
+};
+
+/**
+ * Decides, sensor by sensor, which steps are logged. Give one to
+ * tgDataManager::addSensorInfo, and every sensor made from that info gets
+ * its own copy. Sensors without a policy are sampled on every step.
+ */
+class tgSamplingPolicy
+{
+ public:
+
+  virtual ~tgSamplingPolicy();
+
+  /** A new policy with the same settings, in its reset state */
+  virtual tgSamplingPolicy* clone() const = 0;
+
+  /**
+   * Forget the past and size any buffers, before the first sample.
+   * @param[in] count the number of values the sensor gives.
+   */
+  virtual void reset(std::size_t count);
+
+  /**
+   * Whether the sensor must be read at this time. The sensor is only read,
+   * and offer called, if this returns true.
+   * @param[in] time the simulation time.
+   */
+  virtual bool isDue(double time) = 0;
+
+  /**
+   * Look at a reading and write any samples to keep.
+   * @param[in] sensorIndex passed through to the sink.
+   * @param[in] time the simulation time.
+   * @param[in] values the reading of reset's count values.
+   * @param[in,out] sink where the samples go.
+   */
+  virtual void offer(std::size_t sensorIndex, double time,
+		     const double* values, tgSampleSink& sink);
+
+ protected:
+
+  tgSamplingPolicy();
+
+  /** The count passed to reset */
+  std::size_t m_count;
+};
+
+/**
+ * Keep a sample whenever interval seconds have passed since the last one.
+ * An interval of 0 keeps every step.
+ */
+class tgFixedRatePolicy : public tgSamplingPolicy
+{
+ public:
+
+  /**
+   * @param[in] interval seconds between samples; must not be negative.
+   */
+  explicit tgFixedRatePolicy(double interval);
+
+  virtual tgSamplingPolicy* clone() const;
+
+  virtual void reset(std::size_t count);
+
+  virtual bool isDue(double time);
+
+ private:
+
+  double m_interval;
+  double m_lastTime;
+  bool m_sampled;
+};
+
+/**
+ * Keep every factor-th step, starting with the first.
+ */
+class tgDecimationPolicy : public tgSamplingPolicy
+{
+ public:
+
+  /**
+   * @param[in] factor must be positive.
+   */
+  explicit tgDecimationPolicy(std::size_t factor);
+
+  virtual tgSamplingPolicy* clone() const;
+
+  virtual void reset(std::size_t count);
+
+  virtual bool isDue(double time);
+
+ private:
+
+  std::size_t m_factor;
+  std::size_t m_steps;
+};
+
+/**
+ * Keep every step from a trigger until postTriggerTime after the last
+ * trigger, as well as the preTriggerRows steps before it. A step triggers
+ * when one field of the sensor, or how fast it is changing, crosses a
+ * threshold, e.g. a cable tension above 100 or a rod moving faster than
+ * 2 along Y. Outside these windows a sample may also be kept every
+ * idleInterval seconds, for a low-rate trace.
+ * Such an idle sample empties the pre-trigger buffer, so that the
+ * samples of a sensor are always in time order.
+ *
+ * The sensor is read on every step so that triggers aren't missed.
+ */
+class tgTriggerPolicy : public tgSamplingPolicy
+{
+ public:
+
+  /** What about the field is compared to the threshold */
+  enum Condition
+  {
+    /** The value is above the threshold */
+    eAbove,
+    /** The value is below the threshold */
+    eBelow,
+    /** The value changes faster than the threshold, either way, per second */
+    eRateAbove
+  };
+
+  /**
+   * @param[in] field the index of the value within the sensor's data.
+   * @param[in] condition how the field triggers.
+   * @param[in] threshold what the field is compared to.
+   * @param[in] preTriggerRows the steps before a trigger to keep.
+   * @param[in] postTriggerTime seconds to keep every step after a
+   * trigger; must not be negative.
+   * @param[in] idleInterval seconds between samples outside the windows;
+   * 0 or less to keep none.
+   */
+  tgTriggerPolicy(std::size_t field, Condition condition, double threshold,
+		  std::size_t preTriggerRows = 0, double postTriggerTime = 0.0,
+		  double idleInterval = 0.0);
+
+  virtual tgSamplingPolicy* clone() const;
+
+  /**
+   * @throw std::out_of_range if the field is not one of the count values.
+   */
+  virtual void reset(std::size_t count);
+
+  virtual bool isDue(double time);
+
+  virtual void offer(std::size_t sensorIndex, double time,
+		     const double* values, tgSampleSink& sink);
+
+  /** The steps that triggered since reset */
+  std::size_t getTriggerCount() const
+  {
+    return m_triggers;
+  }
+
+ private:
+
+  bool triggers(double time, const double* values) const;
+
+  /** Send the pre-trigger rows, oldest first, and empty the buffer */
+  void release(std::size_t sensorIndex, tgSampleSink& sink);
+
+  std::size_t m_field;
+  Condition m_condition;
+  double m_threshold;
+  std::size_t m_preTriggerRows;
+  double m_postTriggerTime;
+  double m_idleInterval;
+
+  /** The time and values of the pre-trigger rows, as a ring */
+  std::vector<double> m_buffer;
+  std::size_t m_buffered;
+  std::size_t m_next;
+
+  double m_windowEnd;
+  bool m_inWindow;
+  double m_lastIdleTime;
+  bool m_idleSampled;
+  double m_lastValue;
+  double m_lastTime;
+  bool m_hasLast;
+  std::size_t m_triggers;
+};
+
+#endif // TG_SAMPLING_POLICY_H
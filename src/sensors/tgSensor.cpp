@@ -30,6 +30,7 @@
 
 // Includes from the c++ standard library:
 #include <stdexcept>
+#include <cstdlib> // for strtod
 
 /**
  * This cpp file only implements the constructor for tgSensor.
@@ -54,4 +55,33 @@ tgSensor::~tgSensor()
   // likely a tgModel, which is handled by other classes.
 }
 
+/**
+ * The fallback for sensors that don't know their own size.
+ */
+std::size_t tgSensor::getSensorDataSize()
+{
+  return getSensorDataHeadings().size();
+}
+
+/**
+ * The fallback for sensors that only produce strings: parse them back.
+ * Anything that doesn't parse as a number becomes zero.
+ */
+void tgSensor::sampleInto(double* out)
+{
+  std::vector<std::string> sensordata = getSensorData();
+  for (std::size_t i=0; i < sensordata.size(); i++) {
+    out[i] = std::strtod(sensordata[i].c_str(), NULL);
+  }
+}
+
+/**
+ * Sensors whose fields all cost the same gain nothing from skipping some.
+ */
+void tgSensor::sampleWantedInto(double* out, const char* wanted)
+{
+  (void) wanted;
+  sampleInto(out);
+}
+
 //end.
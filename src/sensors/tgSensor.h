@@ -33,6 +33,7 @@ class tgSenseable;
 // From the C++ standard library:
 #include <iostream> //for strings
 #include <vector> // for returning lists of strings
+#include <cstddef> // for std::size_t
 
 /**
  * This class defines methods for use with sensors.
@@ -89,6 +90,45 @@ public:
    */
   virtual std::vector<std::string> getSensorData() = 0;
 
+  /**
+   * The number of doubles that sampleInto writes. This is the same as
+   * the number of headings. The default asks getSensorDataHeadings, so
+   * sensors that are sampled often should override it.
+   * @return the number of data fields this sensor returns.
+   */
+  virtual std::size_t getSensorDataSize();
+
+  /**
+   * Write the data from this sensor as doubles, in the same order as
+   * the headings, into a buffer owned by the caller (e.g., a
+   * tgBinaryDataLogger.) The default parses the strings from
+   * getSensorData, so sensors that are sampled often should override it
+   * and write their values directly.
+   * @param[out] out a buffer with room for getSensorDataSize() doubles.
+   */
+  virtual void sampleInto(double* out);
+
+  /**
+   * As sampleInto, but only the fields marked in wanted have to be
+   * written; the rest may be left as they were. This is how a data
+   * manager's channels are pulled, so a sensor with fields that cost
+   * more than the rest, such as Euler angles, should override it to
+   * skip them when no one reads them. The default writes every field.
+   * @param[out] out a buffer with room for getSensorDataSize() doubles.
+   * @param[in] wanted getSensorDataSize() flags, non-zero for each field
+   * to write.
+   */
+  virtual void sampleWantedInto(double* out, const char* wanted);
+
+  /**
+   * The object this sensor reads, for a data manager that labels or
+   * filters the data itself (e.g., tgDataObserver.)
+   */
+  tgSenseable* getSenseable() const
+  {
+    return m_pSens;
+  }
+
   // TO-DO: should any of this be const?
 
 protected:
@@ -32,7 +32,8 @@
 #include <iostream> // for the to-string overloaded method
 #include <vector> // for returning lists of sensors
 // This library
-// ...
+#include "core/tgCast.h"
+#include "core/tgModel.h"
 // Bullet Physics
 // ...
 
@@ -87,6 +88,43 @@ public:
    */
   virtual std::vector<tgSensor*> createSensorsIfAppropriate(tgSenseable* pSenseable) = 0;
 
+  /**
+   * Find everything in a model, the model included, that this info would
+   * accept with isThisMySenseable, through the model's index of its
+   * descendants by type rather than by asking about each one. Infos that
+   * only accept one type of senseable override this, usually with
+   * appendOfType; tgDataManager then skips isThisMySenseable for them.
+   * Infos whose answers depend on the sensors they have already created
+   * keep the default.
+   * @param[in] pModel the model to search; must not be NULL
+   * @param[out] senseables appended to, the model first if it matches,
+   * then its descendants in getDescendants() order
+   * @return false if this info cannot search by type, leaving senseables
+   * alone
+   */
+  virtual bool findSenseables(tgModel* pModel,
+			      std::vector<tgSenseable*>& senseables)
+  {
+    return false;
+  }
+
+protected:
+
+  /**
+   * For findSenseables: append the model, if it is a T, and then its
+   * descendants of type T.
+   */
+  template <class T>
+  static void appendOfType(tgModel* pModel,
+			   std::vector<tgSenseable*>& senseables)
+  {
+    if (tgCast::cast<tgModel, T>(pModel) != 0) {
+      senseables.push_back(pModel);
+    }
+    const std::vector<T*>& found = pModel->getDescendantsOfType<T>();
+    senseables.insert(senseables.end(), found.begin(), found.end());
+  }
+
 };
 
 
@@ -0,0 +1,336 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSharedMemoryDataManager.cpp
+ * @brief Contains the definitions of members of class tgSharedMemoryDataManager.
+ * $Id$
+ */
+
+// This module
+#include "tgSharedMemoryDataManager.h"
+// This application
+#include "core/tgBaseRigid.h"
+#include "core/tgCast.h"
+#include "core/tgSenseable.h"
+#include "core/tgTags.h"
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <cassert>
+#include <cstring> // for memcpy
+#include <sstream>
+// POSIX shared memory
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h> // for sched_yield
+
+namespace
+{
+  const char kMagic[8] = {'N', 'T', 'R', 'T', 'S', 'H', 'M', '1'};
+
+  /** Round up to a whole number of doubles */
+  std::size_t alignToDouble(std::size_t n)
+  {
+    return (n + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+  }
+
+  void addRigid(tgSenseable* pSenseable, std::vector<tgBaseRigid*>& rigids)
+  {
+    tgBaseRigid* const pRigid =
+      tgCast::cast<tgSenseable, tgBaseRigid>(pSenseable);
+    if (pRigid != 0) {
+      rigids.push_back(pRigid);
+    }
+  }
+}
+
+tgSharedMemoryDataManager::tgSharedMemoryDataManager(const std::string& name,
+						     double timeInterval) :
+  tgDataManager(),
+  m_name(name),
+  m_pRegion(NULL),
+  m_regionSize(0),
+  m_totalTime(0.0),
+  m_timeInterval(timeInterval),
+  m_updateTime(0.0)
+{
+  if (m_name.size() < 2 || m_name[0] != '/') {
+    throw std::invalid_argument("Shared memory names must start with '/', e.g. \"/ntrt_telemetry\".");
+  }
+  if (m_timeInterval < 0.0 ) {
+    throw std::invalid_argument("Time interval must be nonnegative. Negative time intervals do not make sense.");
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+tgSharedMemoryDataManager::~tgSharedMemoryDataManager()
+{
+  close();
+}
+
+void tgSharedMemoryDataManager::setup()
+{
+  // Call the parent's setup method, which creates the sensors.
+  tgDataManager::setup();
+
+  // A setup without teardown: the layout may have changed.
+  close();
+
+  m_rigids.clear();
+  for (std::size_t i = 0; i < m_senseables.size(); i++) {
+    addRigid(m_senseables[i], m_rigids);
+    const std::vector<tgSenseable*> descendants =
+      m_senseables[i]->getSenseableDescendants();
+    for (std::size_t j = 0; j < descendants.size(); j++) {
+      addRigid(descendants[j], m_rigids);
+    }
+  }
+
+  // The headings, in value order
+  std::ostringstream headings;
+  headings << "time\n";
+  const std::vector<std::string> frameHeadings = getFrameHeadings();
+  for (std::size_t i = 0; i < frameHeadings.size(); i++) {
+    headings << frameHeadings[i] << '\n';
+  }
+  for (std::size_t i = 0; i < m_rigids.size(); i++) {
+    const std::string prefix = "rigid(" + m_rigids[i]->getTags() + ").";
+    headings << prefix << "X\n" << prefix << "Y\n" << prefix << "Z\n"
+	     << prefix << "Euler1\n" << prefix << "Euler2\n"
+	     << prefix << "Euler3\n";
+  }
+  const std::string headingText = headings.str();
+
+  m_values.assign(1 + getFrameSize() + 6 * m_rigids.size(), 0.0);
+  const std::size_t valuesOffset =
+    alignToDouble(sizeof(Header) + headingText.size());
+  m_regionSize = valuesOffset + m_values.size() * sizeof(double);
+
+  // A region left behind by a run that crashed goes first
+  shm_unlink(m_name.c_str());
+  const int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Shared memory object " + m_name + " could not be created.");
+  }
+  if (ftruncate(fd, m_regionSize) != 0) {
+    ::close(fd);
+    shm_unlink(m_name.c_str());
+    throw std::runtime_error("Shared memory object " + m_name + " could not be sized.");
+  }
+  void* const pRegion = mmap(NULL, m_regionSize, PROT_READ | PROT_WRITE,
+			     MAP_SHARED, fd, 0);
+  // The mapping stays valid without the descriptor
+  ::close(fd);
+  if (pRegion == MAP_FAILED) {
+    shm_unlink(m_name.c_str());
+    throw std::runtime_error("Shared memory object " + m_name + " could not be mapped.");
+  }
+  m_pRegion = pRegion;
+
+  std::cout << "tgSharedMemoryDataManager will be publishing data to "
+	    << "the shared memory object: " << std::endl
+	    << m_name << std::endl;
+
+  // ftruncate zeroed the region, so the sequence starts even
+  char* const pBytes = static_cast<char*>(m_pRegion);
+  std::memcpy(pBytes + sizeof(Header), headingText.data(), headingText.size());
+  Header* const pHeader = static_cast<Header*>(m_pRegion);
+  pHeader->valuesOffset = valuesOffset;
+  pHeader->headingBytes = headingText.size();
+  pHeader->valueCount = m_values.size();
+  pHeader->closed = 0;
+  pHeader->sequence = 0;
+  // Readers check the magic last
+  __sync_synchronize();
+  std::memcpy(pHeader->magic, kMagic, sizeof(kMagic));
+
+  m_totalTime = 0.0;
+  m_updateTime = 0.0;
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgSharedMemoryDataManager::teardown()
+{
+  close();
+  m_rigids.clear();
+  tgDataManager::teardown();
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgSharedMemoryDataManager::close()
+{
+  if (m_pRegion == NULL) {
+    return;
+  }
+  Header* const pHeader = static_cast<Header*>(m_pRegion);
+  pHeader->closed = 1;
+  __sync_synchronize();
+  munmap(m_pRegion, m_regionSize);
+  shm_unlink(m_name.c_str());
+  m_pRegion = NULL;
+  m_regionSize = 0;
+}
+
+void tgSharedMemoryDataManager::step(double dt)
+{
+  if (dt <= 0.0)
+  {
+    throw std::invalid_argument("dt is not positive");
+  }
+  else
+  {
+    m_totalTime += dt;
+    m_updateTime += dt;
+    // Nothing to publish to before setup or after teardown.
+    if (m_updateTime >= m_timeInterval && m_pRegion != NULL) {
+      publish();
+      m_updateTime = 0.0;
+    }
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+/**
+ * The sensors are sampled outside the lock, so readers only ever wait
+ * for the copy.
+ */
+void tgSharedMemoryDataManager::publish()
+{
+  m_values[0] = m_totalTime;
+  sampleFrameInto(&m_values[1]);
+  double* pPose = &m_values[1 + getFrameSize()];
+  for (std::size_t i = 0; i < m_rigids.size(); i++) {
+    const btVector3 com = m_rigids[i]->centerOfMass();
+    const btVector3 orient = m_rigids[i]->orientation();
+    pPose[0] = com[0];
+    pPose[1] = com[1];
+    pPose[2] = com[2];
+    pPose[3] = orient[0];
+    pPose[4] = orient[1];
+    pPose[5] = orient[2];
+    pPose += 6;
+  }
+
+  Header* const pHeader = static_cast<Header*>(m_pRegion);
+  char* const pValues = static_cast<char*>(m_pRegion) + pHeader->valuesOffset;
+  // Odd while the values are being written
+  pHeader->sequence = pHeader->sequence + 1;
+  __sync_synchronize();
+  std::memcpy(pValues, &m_values[0], m_values.size() * sizeof(double));
+  __sync_synchronize();
+  pHeader->sequence = pHeader->sequence + 1;
+}
+
+bool tgSharedMemoryDataManager::readLatest(const std::string& name,
+					   std::vector<std::string>& headings,
+					   std::vector<double>& values)
+{
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 ||
+      static_cast<std::size_t>(info.st_size) < sizeof(Header)) {
+    ::close(fd);
+    return false;
+  }
+  const std::size_t size = info.st_size;
+  void* const pRegion = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (pRegion == MAP_FAILED) {
+    return false;
+  }
+
+  const Header* const pHeader = static_cast<const Header*>(pRegion);
+  const char* const pBytes = static_cast<const char*>(pRegion);
+  bool ok = std::memcmp(pHeader->magic, kMagic, sizeof(kMagic)) == 0;
+  __sync_synchronize();
+  ok = ok && !pHeader->closed &&
+    sizeof(Header) + pHeader->headingBytes <= pHeader->valuesOffset &&
+    pHeader->valuesOffset + pHeader->valueCount * sizeof(double) <= size;
+  if (ok) {
+    headings.clear();
+    std::istringstream text(std::string(pBytes + sizeof(Header),
+					pHeader->headingBytes));
+    std::string heading;
+    while (std::getline(text, heading)) {
+      headings.push_back(heading);
+    }
+
+    values.resize(pHeader->valueCount);
+    // A writer that died mid-copy would leave the sequence odd for good
+    const int maxTries = 10000;
+    int tries = 0;
+    for (;;) {
+      const uint64_t before = pHeader->sequence;
+      __sync_synchronize();
+      if (before % 2 == 0) {
+	if (!values.empty()) {
+	  std::memcpy(&values[0], pBytes + pHeader->valuesOffset,
+		      values.size() * sizeof(double));
+	}
+	__sync_synchronize();
+	if (pHeader->sequence == before) {
+	  break;
+	}
+      }
+      if (pHeader->closed || ++tries == maxTries) {
+	ok = false;
+	break;
+      }
+      sched_yield();
+    }
+  }
+  munmap(pRegion, size);
+  return ok;
+}
+
+std::string tgSharedMemoryDataManager::toString() const
+{
+  std::ostringstream os;
+  os << tgDataManager::toString()
+     << "This tgDataManager is a tgSharedMemoryDataManager. " << std::endl;
+
+  return os.str();
+}
+
+bool tgSharedMemoryDataManager::invariant() const
+{
+  return (m_timeInterval >= 0.0) &&
+    ((m_pRegion == NULL) == (m_regionSize == 0));
+}
+
+std::ostream&
+operator<<(std::ostream& os, const tgSharedMemoryDataManager& obj)
+{
+    os << obj.toString() << std::endl;
+    return os;
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SHARED_MEMORY_DATA_MANAGER_H
+#define TG_SHARED_MEMORY_DATA_MANAGER_H
+
+/**
+ * @file tgSharedMemoryDataManager.h
+ * @brief Contains the definition of class tgSharedMemoryDataManager.
+ * $Id$
+ */
+
+// Includes from NTRTsim
+#include "tgDataManager.h"
+// Includes from the C++ standard library
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdint.h> // for the fixed-width header fields
+
+// Forward declarations
+class tgBaseRigid;
+
+/**
+ * tgSharedMemoryDataManager publishes the latest numeric frame, and the
+ * pose of every rigid of its senseables, in a POSIX shared memory object,
+ * so that a dashboard or viewer can watch a headless run at its own rate.
+ * Nothing is written to disk and nothing waits on the readers: each
+ * sample is one copy into the region under a sequence lock.
+ *
+ * The object, named as for shm_open (e.g. "/ntrt_telemetry"), is made in
+ * setup and unlinked in teardown. It holds, in native byte order:
+ *   a Header (see below),
+ *   headingBytes of text, one heading per value, each ending in '\\n':
+ *   "time", then the frame headings, then "rigid(<tags>).X", ".Y", ".Z",
+ *   ".Euler1", ".Euler2", ".Euler3" for each rigid,
+ *   then valueCount doubles in the same order.
+ *
+ * The writer makes sequence odd, copies the values, then makes it even
+ * again. A reader copies the values between two reads of an even,
+ * unchanged sequence, as readLatest does. The layout is fixed until
+ * closed becomes non-zero, after which the reader should attach again.
+ */
+class tgSharedMemoryDataManager : public tgDataManager
+{
+ public:
+
+  /** The start of the shared memory object */
+  struct Header
+  {
+    /** "NTRTSHM1" */
+    char magic[8];
+    /** Bytes from the start of the object to the values */
+    uint32_t valuesOffset;
+    /** Bytes of heading text, right after this header */
+    uint32_t headingBytes;
+    /** Doubles in the values */
+    uint32_t valueCount;
+    /** Set once the writer has let go of the object */
+    volatile uint32_t closed;
+    /** Even when the values are whole; counts up with each write */
+    volatile uint64_t sequence;
+  };
+
+  /**
+   * @param[in] name the name of the shared memory object, as for
+   * shm_open; it must start with "/".
+   * @param[in] timeInterval the time between samples; 0 for every step.
+   */
+  tgSharedMemoryDataManager(const std::string& name,
+			    double timeInterval = 0.0);
+
+  /** Lets go of the object if teardown was not called. */
+  virtual ~tgSharedMemoryDataManager();
+
+  /**
+   * Creates the sensors, then creates and lays out the shared memory.
+   * @throw std::runtime_error if the object can't be made.
+   */
+  virtual void setup();
+
+  /**
+   * Marks the object closed, unmaps and unlinks it, then deletes the
+   * sensors.
+   */
+  virtual void teardown();
+
+  /**
+   * Publishes a sample, if m_timeInterval has passed.
+   * @param[in] dt a double, the amount of time since the last step.
+   */
+  virtual void step(double dt);
+
+  /**
+   * Overwrite toString for the superclass to specify that this data manager
+   * is a tgSharedMemoryDataManager.
+   */
+  virtual std::string toString() const;
+
+  /**
+   * Read the latest sample from another process (or this one), as a
+   * viewer would.
+   * @param[in] name the name given to the writer.
+   * @param[out] headings one per value.
+   * @param[out] values the latest sample.
+   * @return false if there is no such object, or it is closed.
+   */
+  static bool readLatest(const std::string& name,
+			 std::vector<std::string>& headings,
+			 std::vector<double>& values);
+
+ protected:
+
+  /** Publish one sample. */
+  void publish();
+
+  /** Unmap and unlink the object, if there is one. */
+  void close();
+
+  // Integrity predicate.
+  bool invariant() const;
+
+  /** The name of the shared memory object */
+  std::string m_name;
+
+  /** The mapping, or NULL between teardown and setup */
+  void* m_pRegion;
+
+  /** The size of m_pRegion in bytes */
+  std::size_t m_regionSize;
+
+  /** The rigids whose poses follow the frame */
+  std::vector<tgBaseRigid*> m_rigids;
+
+  /** Where a sample is put together before it is copied in */
+  std::vector<double> m_values;
+
+  /**
+   * Time bookkeeping, as in tgDataLogger2.
+   */
+  double m_totalTime;
+  double m_timeInterval;
+  double m_updateTime;
+};
+
+/**
+ * Overload operator<<() to handle tgSharedMemoryDataManager
+ * @param[in,out] os an ostream
+ * @param[in] obj a tgSharedMemoryDataManager
+ * @return os
+ */
+std::ostream&
+operator<<(std::ostream& os, const tgSharedMemoryDataManager& obj);
+
+#endif // TG_SHARED_MEMORY_DATA_MANAGER_H
@@ -147,4 +147,37 @@ std::vector<std::string> tgSpringCableActuatorSensor::getSensorData() {
   return sensordata;
 }
 
+/**
+ * The numeric version of getSensorData, for the binary logger and for
+ * controllers. Same fields, same order, no strings.
+ */
+std::size_t tgSpringCableActuatorSensor::getSensorDataSize() {
+  return 3;
+}
+
+void tgSpringCableActuatorSensor::sampleInto(double* out) {
+  tgSpringCableActuator* m_pSCA =
+    tgCast::cast<tgSenseable, tgSpringCableActuator>(m_pSens);
+  assert( m_pSCA != 0);
+  out[0] = m_pSCA->getRestLength();
+  out[1] = m_pSCA->getCurrentLength();
+  out[2] = m_pSCA->getTension();
+}
+
+void tgSpringCableActuatorSensor::sampleWantedInto(double* out,
+						   const char* wanted) {
+  tgSpringCableActuator* m_pSCA =
+    tgCast::cast<tgSenseable, tgSpringCableActuator>(m_pSens);
+  assert( m_pSCA != 0);
+  if (wanted[0]) {
+    out[0] = m_pSCA->getRestLength();
+  }
+  if (wanted[1]) {
+    out[1] = m_pSCA->getCurrentLength();
+  }
+  if (wanted[2]) {
+    out[2] = m_pSCA->getTension();
+  }
+}
+
 //end.
@@ -57,6 +57,17 @@ public:
   virtual std::vector<std::string> getSensorDataHeadings();
   virtual std::vector<std::string> getSensorData();
 
+  /**
+   * Numeric versions of the above, see tgSensor.
+   */
+  virtual std::size_t getSensorDataSize();
+  virtual void sampleInto(double* out);
+
+  /**
+   * Reads only the wanted lengths and tension from the actuator.
+   */
+  virtual void sampleWantedInto(double* out, const char* wanted);
+
 };
 
 #endif //TG_SPRING_CABLE_ACTUATOR_SENSOR_H
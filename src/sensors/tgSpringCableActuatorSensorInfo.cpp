@@ -81,3 +81,10 @@ std::vector<tgSensor*> tgSpringCableActuatorSensorInfo::createSensorsIfAppropria
   newSensors.push_back( new tgSpringCableActuatorSensor( tgCast::cast<tgSenseable, tgSpringCableActuator>(pSenseable) ));
   return newSensors;
 }
+
+bool tgSpringCableActuatorSensorInfo::findSenseables(tgModel* pModel,
+				  std::vector<tgSenseable*>& senseables)
+{
+  appendOfType<tgSpringCableActuator>(pModel, senseables);
+  return true;
+}
@@ -82,6 +82,13 @@ class tgSpringCableActuatorSensorInfo : public tgSensorInfo
    */
   virtual std::vector<tgSensor*> createSensorsIfAppropriate(tgSenseable* pSenseable);
 
+  /**
+   * Every tgSpringCableActuator in the model, from its index by type.
+   * @return true
+   */
+  virtual bool findSenseables(tgModel* pModel,
+			      std::vector<tgSenseable*>& senseables);
+
 };
 
 #endif // TG_SPRING_CABLE_ACTUATOR_SENSOR_INFO_H
@@ -0,0 +1,504 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgWebSocket.cpp
+ * @brief Contains the definitions of members of class tgWebSocket.
+ * $Id$
+ */
+
+// This module
+#include "tgWebSocket.h"
+// The C++ Standard Library
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+// POSIX sockets
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+  const char kGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+  /** The longest handshake read before giving up on it */
+  const std::size_t kMaxHandshake = 8192;
+
+  /** Messages longer than this close the connection */
+  const uint64_t kMaxMessage = 16 * 1024 * 1024;
+
+  uint32_t rotateLeft(uint32_t v, int bits)
+  {
+    return (v << bits) | (v >> (32 - bits));
+  }
+
+  /** SHA-1, as FIPS 180-4; only the handshake needs it */
+  std::string sha1(const std::string& text)
+  {
+    uint32_t h[5] =
+      {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::string message = text;
+    const uint64_t bits = static_cast<uint64_t>(text.size()) * 8;
+    message += static_cast<char>(0x80);
+    while (message.size() % 64 != 56) {
+      message += static_cast<char>(0);
+    }
+    for (int i = 7; i >= 0; i--) {
+      message += static_cast<char>((bits >> (8 * i)) & 0xff);
+    }
+
+    for (std::size_t block = 0; block < message.size(); block += 64) {
+      uint32_t w[80];
+      for (int i = 0; i < 16; i++) {
+	const unsigned char* const p =
+	  reinterpret_cast<const unsigned char*>(message.data()) + block + 4 * i;
+	w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+	  (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+      }
+      for (int i = 16; i < 80; i++) {
+	w[i] = rotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+      }
+      uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+      for (int i = 0; i < 80; i++) {
+	uint32_t f, k;
+	if (i < 20) {
+	  f = (b & c) | (~b & d);
+	  k = 0x5A827999;
+	}
+	else if (i < 40) {
+	  f = b ^ c ^ d;
+	  k = 0x6ED9EBA1;
+	}
+	else if (i < 60) {
+	  f = (b & c) | (b & d) | (c & d);
+	  k = 0x8F1BBCDC;
+	}
+	else {
+	  f = b ^ c ^ d;
+	  k = 0xCA62C1D6;
+	}
+	const uint32_t t = rotateLeft(a, 5) + f + e + k + w[i];
+	e = d;
+	d = c;
+	c = rotateLeft(b, 30);
+	b = a;
+	a = t;
+      }
+      h[0] += a;
+      h[1] += b;
+      h[2] += c;
+      h[3] += d;
+      h[4] += e;
+    }
+
+    std::string digest;
+    for (int i = 0; i < 5; i++) {
+      for (int j = 3; j >= 0; j--) {
+	digest += static_cast<char>((h[i] >> (8 * j)) & 0xff);
+      }
+    }
+    return digest;
+  }
+
+  std::string base64(const std::string& bytes)
+  {
+    static const char kAlphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (std::size_t i = 0; i < bytes.size(); i += 3) {
+      uint32_t v = uint32_t(static_cast<unsigned char>(bytes[i])) << 16;
+      if (i + 1 < bytes.size()) {
+	v |= uint32_t(static_cast<unsigned char>(bytes[i + 1])) << 8;
+      }
+      if (i + 2 < bytes.size()) {
+	v |= uint32_t(static_cast<unsigned char>(bytes[i + 2]));
+      }
+      out += kAlphabet[(v >> 18) & 63];
+      out += kAlphabet[(v >> 12) & 63];
+      out += i + 1 < bytes.size() ? kAlphabet[(v >> 6) & 63] : '=';
+      out += i + 2 < bytes.size() ? kAlphabet[v & 63] : '=';
+    }
+    return out;
+  }
+
+  bool writeAll(int fd, const void* pData, std::size_t size)
+  {
+    const char* p = static_cast<const char*>(pData);
+    while (size > 0) {
+      const ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR) {
+	continue;
+      }
+      if (n <= 0) {
+	return false;
+      }
+      p += n;
+      size -= n;
+    }
+    return true;
+  }
+
+  /**
+   * Read an HTTP head, up to and including its blank line.
+   * @param[out] rest whatever came after it.
+   */
+  std::string readHead(int fd, int timeoutMs, std::string& rest)
+  {
+    std::string head;
+    char buffer[1024];
+    while (head.find("\r\n\r\n") == std::string::npos) {
+      pollfd p;
+      p.fd = fd;
+      p.events = POLLIN;
+      p.revents = 0;
+      if (head.size() > kMaxHandshake || poll(&p, 1, timeoutMs) <= 0) {
+	throw std::runtime_error("WebSocket handshake timed out.");
+      }
+      const ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+      if (n <= 0) {
+	throw std::runtime_error("WebSocket handshake was cut off.");
+      }
+      head.append(buffer, n);
+    }
+    const std::size_t end = head.find("\r\n\r\n") + 4;
+    rest = head.substr(end);
+    head.resize(end);
+    return head;
+  }
+
+  /** The value of a header, matched without case; empty if missing */
+  std::string headerValue(const std::string& head, const std::string& name)
+  {
+    std::istringstream lines(head);
+    std::string line;
+    while (std::getline(lines, line)) {
+      const std::size_t colon = line.find(':');
+      if (colon != name.size() ||
+	  strncasecmp(line.c_str(), name.c_str(), name.size()) != 0) {
+	continue;
+      }
+      std::size_t begin = colon + 1;
+      std::size_t end = line.size();
+      while (begin < end && (line[begin] == ' ' || line[begin] == '\t')) {
+	begin++;
+      }
+      while (end > begin && (line[end - 1] == '\r' || line[end - 1] == ' ')) {
+	end--;
+      }
+      return line.substr(begin, end - begin);
+    }
+    return "";
+  }
+}
+
+std::string tgWebSocket::acceptKey(const std::string& key)
+{
+  return base64(sha1(key + kGuid));
+}
+
+tgWebSocket::tgWebSocket(int fd, bool masked) :
+  m_fd(fd),
+  m_masked(masked),
+  m_messageOpcode(0)
+{
+  // Small frames go out as they are sent
+  int one = 1;
+  setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+tgWebSocket::~tgWebSocket()
+{
+  close();
+}
+
+void tgWebSocket::close()
+{
+  if (m_fd >= 0) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
+
+tgWebSocket* tgWebSocket::accept(int fd, int timeoutMs)
+{
+  std::string rest;
+  std::string key;
+  try {
+    const std::string head = readHead(fd, timeoutMs, rest);
+    key = headerValue(head, "Sec-WebSocket-Key");
+    if (head.compare(0, 4, "GET ") != 0 || key.empty()) {
+      const char refusal[] = "HTTP/1.1 400 Bad Request\r\n\r\n";
+      writeAll(fd, refusal, sizeof(refusal) - 1);
+      throw std::runtime_error("Not a WebSocket upgrade request.");
+    }
+  }
+  catch (const std::runtime_error&) {
+    ::close(fd);
+    throw;
+  }
+
+  const std::string reply =
+    "HTTP/1.1 101 Switching Protocols\r\n"
+    "Upgrade: websocket\r\n"
+    "Connection: Upgrade\r\n"
+    "Sec-WebSocket-Accept: " + acceptKey(key) + "\r\n\r\n";
+  if (!writeAll(fd, reply.data(), reply.size())) {
+    ::close(fd);
+    throw std::runtime_error("WebSocket handshake could not be sent.");
+  }
+  tgWebSocket* const pSocket = new tgWebSocket(fd, false);
+  pSocket->m_input.assign(rest.begin(), rest.end());
+  return pSocket;
+}
+
+tgWebSocket* tgWebSocket::connect(const std::string& host, int port)
+{
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  std::ostringstream service;
+  service << port;
+  addrinfo* pResult = NULL;
+  if (getaddrinfo(host.c_str(), service.str().c_str(), &hints, &pResult) != 0) {
+    throw std::runtime_error("Could not resolve " + host + ".");
+  }
+  int fd = -1;
+  for (addrinfo* p = pResult; p != NULL && fd < 0; p = p->ai_next) {
+    fd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+    if (fd >= 0 && ::connect(fd, p->ai_addr, p->ai_addrlen) != 0) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(pResult);
+  if (fd < 0) {
+    throw std::runtime_error("Could not connect to " + host + ":" +
+			     service.str() + ".");
+  }
+
+  // The key only has to differ between connections
+  std::string nonce;
+  std::srand(static_cast<unsigned>(time(NULL)) ^ static_cast<unsigned>(getpid()));
+  for (int i = 0; i < 16; i++) {
+    nonce += static_cast<char>(std::rand() & 0xff);
+  }
+  const std::string key = base64(nonce);
+  const std::string request =
+    "GET / HTTP/1.1\r\n"
+    "Host: " + host + ":" + service.str() + "\r\n"
+    "Upgrade: websocket\r\n"
+    "Connection: Upgrade\r\n"
+    "Sec-WebSocket-Key: " + key + "\r\n"
+    "Sec-WebSocket-Version: 13\r\n\r\n";
+
+  std::string rest;
+  try {
+    if (!writeAll(fd, request.data(), request.size())) {
+      throw std::runtime_error("WebSocket handshake could not be sent.");
+    }
+    const std::string head = readHead(fd, 5000, rest);
+    if (head.compare(0, 12, "HTTP/1.1 101") != 0 ||
+	headerValue(head, "Sec-WebSocket-Accept") != acceptKey(key)) {
+      throw std::runtime_error("The server refused the WebSocket upgrade.");
+    }
+  }
+  catch (const std::runtime_error&) {
+    ::close(fd);
+    throw;
+  }
+  tgWebSocket* const pSocket = new tgWebSocket(fd, true);
+  pSocket->m_input.assign(rest.begin(), rest.end());
+  return pSocket;
+}
+
+bool tgWebSocket::send(Opcode opcode, const void* pData, std::size_t size)
+{
+  return sendFrame(opcode, pData, size);
+}
+
+bool tgWebSocket::sendFrame(int opcode, const void* pData, std::size_t size)
+{
+  if (m_fd < 0) {
+    return false;
+  }
+  m_frame.clear();
+  m_frame.push_back(static_cast<unsigned char>(0x80 | opcode));
+  const unsigned char maskBit = m_masked ? 0x80 : 0;
+  if (size < 126) {
+    m_frame.push_back(static_cast<unsigned char>(maskBit | size));
+  }
+  else if (size <= 0xffff) {
+    m_frame.push_back(static_cast<unsigned char>(maskBit | 126));
+    m_frame.push_back(static_cast<unsigned char>(size >> 8));
+    m_frame.push_back(static_cast<unsigned char>(size));
+  }
+  else {
+    m_frame.push_back(static_cast<unsigned char>(maskBit | 127));
+    for (int i = 7; i >= 0; i--) {
+      m_frame.push_back(static_cast<unsigned char>(
+	(static_cast<uint64_t>(size) >> (8 * i)) & 0xff));
+    }
+  }
+
+  const unsigned char* const pBytes = static_cast<const unsigned char*>(pData);
+  bool sent;
+  if (m_masked) {
+    unsigned char mask[4];
+    for (int i = 0; i < 4; i++) {
+      mask[i] = static_cast<unsigned char>(std::rand() & 0xff);
+      m_frame.push_back(mask[i]);
+    }
+    const std::size_t start = m_frame.size();
+    m_frame.insert(m_frame.end(), pBytes, pBytes + size);
+    for (std::size_t i = 0; i < size; i++) {
+      m_frame[start + i] ^= mask[i % 4];
+    }
+    sent = writeAll(m_fd, &m_frame[0], m_frame.size());
+  }
+  else {
+    // The payload goes straight from the caller's buffer
+    sent = writeAll(m_fd, &m_frame[0], m_frame.size()) &&
+      (size == 0 || writeAll(m_fd, pBytes, size));
+  }
+  if (!sent) {
+    close();
+  }
+  return sent;
+}
+
+bool tgWebSocket::receive(Opcode& opcode, std::vector<unsigned char>& payload)
+{
+  if (m_fd < 0) {
+    return false;
+  }
+
+  unsigned char buffer[4096];
+  for (;;) {
+    const ssize_t n = ::recv(m_fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (n > 0) {
+      m_input.insert(m_input.end(), buffer, buffer + n);
+    }
+    else if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+    else {
+      close();
+      return false;
+    }
+  }
+
+  std::size_t used = 0;
+  bool received = false;
+  while (!received && m_fd >= 0) {
+    const unsigned char* const p = m_input.empty() ? NULL : &m_input[used];
+    const std::size_t available = m_input.size() - used;
+    if (available < 2) {
+      break;
+    }
+    const bool fin = (p[0] & 0x80) != 0;
+    const int frameOpcode = p[0] & 0x0f;
+    const bool masked = (p[1] & 0x80) != 0;
+    std::size_t header = 2;
+    uint64_t length = p[1] & 0x7f;
+    if (length == 126) {
+      if (available < 4) {
+	break;
+      }
+      length = (uint64_t(p[2]) << 8) | p[3];
+      header = 4;
+    }
+    else if (length == 127) {
+      if (available < 10) {
+	break;
+      }
+      length = 0;
+      for (int i = 0; i < 8; i++) {
+	length = (length << 8) | p[2 + i];
+      }
+      header = 10;
+    }
+    if (length > kMaxMessage ||
+	m_message.size() + length > kMaxMessage) {
+      close();
+      return false;
+    }
+    const std::size_t maskStart = header;
+    if (masked) {
+      header += 4;
+    }
+    if (available < header + length) {
+      break;
+    }
+
+    const unsigned char* const pPayload = p + header;
+    std::vector<unsigned char>& target =
+      frameOpcode == 0 || !fin ? m_message : payload;
+    if (frameOpcode != 0 && frameOpcode < 8) {
+      target.clear();
+      m_messageOpcode = frameOpcode;
+    }
+    if (frameOpcode < 8) {
+      const std::size_t start = target.size();
+      target.insert(target.end(), pPayload, pPayload + length);
+      if (masked) {
+	for (std::size_t i = 0; i < length; i++) {
+	  target[start + i] ^= p[maskStart + i % 4];
+	}
+      }
+      if (fin) {
+	if (&target == &m_message) {
+	  payload.swap(m_message);
+	  m_message.clear();
+	}
+	opcode = static_cast<Opcode>(m_messageOpcode);
+	received = true;
+      }
+    }
+    else if (frameOpcode == 0x9) {
+      // Pong with the ping's payload, unmasked
+      std::vector<unsigned char> data(pPayload, pPayload + length);
+      if (masked) {
+	for (std::size_t i = 0; i < data.size(); i++) {
+	  data[i] ^= p[maskStart + i % 4];
+	}
+      }
+      sendFrame(0xA, data.empty() ? NULL : &data[0], data.size());
+    }
+    else if (frameOpcode == 0x8) {
+      sendFrame(0x8, NULL, 0);
+      close();
+    }
+    used += header + length;
+  }
+  if (m_fd >= 0) {
+    m_input.erase(m_input.begin(), m_input.begin() + used);
+  }
+  return received;
+}
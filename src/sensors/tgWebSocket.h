@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_WEB_SOCKET_H
+#define TG_WEB_SOCKET_H
+
+/**
+ * @file tgWebSocket.h
+ * @brief Contains the definition of class tgWebSocket.
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * The little of RFC 6455 that tgRemoteViewDataManager and tgRemoteView
+ * need: the opening handshake on either side of a TCP connection, and
+ * whole text and binary messages. Pings are answered, and a close from
+ * the peer closes the connection. There are no extensions, so messages
+ * are not compressed by the protocol; tgRemoteViewDataManager compresses
+ * its own frames.
+ *
+ * Sends block until the message is handed to the kernel. Receives never
+ * block: receive takes what has arrived and returns a message once all
+ * of it has.
+ */
+class tgWebSocket
+{
+ public:
+
+  /** The message types, as in the frame opcodes */
+  enum Opcode
+  {
+    Text = 0x1,
+    Binary = 0x2
+  };
+
+  /**
+   * Take a connection accepted on a listening socket through the server
+   * side of the handshake.
+   * @param[in] fd the accepted socket; closed if the handshake fails.
+   * @param[in] timeoutMs how long to wait for the request.
+   * @throw std::runtime_error if the request is not a WebSocket upgrade.
+   */
+  static tgWebSocket* accept(int fd, int timeoutMs = 2000);
+
+  /**
+   * Connect to a server.
+   * @param[in] host a name or address.
+   * @param[in] port the TCP port.
+   * @throw std::runtime_error if it can't connect or the server refuses.
+   */
+  static tgWebSocket* connect(const std::string& host, int port);
+
+  /** Closes the connection. */
+  ~tgWebSocket();
+
+  bool isOpen() const
+  {
+    return m_fd >= 0;
+  }
+
+  /**
+   * Send one message.
+   * @return false, and close the connection, if it could not be sent.
+   */
+  bool send(Opcode opcode, const void* pData, std::size_t size);
+
+  bool send(const std::string& text)
+  {
+    return send(Text, text.data(), text.size());
+  }
+
+  /**
+   * Take in whatever has arrived, without blocking.
+   * @param[out] opcode the message's type.
+   * @param[out] payload the message.
+   * @return true if a whole message was received; false if none is
+   * complete yet or the connection was closed.
+   */
+  bool receive(Opcode& opcode, std::vector<unsigned char>& payload);
+
+  /**
+   * The Sec-WebSocket-Accept value for a Sec-WebSocket-Key: the base64
+   * of the SHA-1 of the key and the protocol's GUID.
+   */
+  static std::string acceptKey(const std::string& key);
+
+ private:
+
+  /**
+   * @param[in] fd a connected socket, handshake done; owned.
+   * @param[in] masked true on the client side, which must mask.
+   */
+  tgWebSocket(int fd, bool masked);
+
+  /** Not copyable */
+  tgWebSocket(const tgWebSocket&);
+  tgWebSocket& operator=(const tgWebSocket&);
+
+  /** Write a whole frame; false if the connection failed. */
+  bool sendFrame(int opcode, const void* pData, std::size_t size);
+
+  void close();
+
+  int m_fd;
+
+  const bool m_masked;
+
+  /** Bytes read but not yet parsed */
+  std::vector<unsigned char> m_input;
+
+  /** A fragmented message so far, and its opcode */
+  std::vector<unsigned char> m_message;
+  int m_messageOpcode;
+
+  /** A frame, reused */
+  std::vector<unsigned char> m_frame;
+};
+
+#endif // TG_WEB_SOCKET_H
@@ -26,8 +26,11 @@
 
 #include "tgBasicActuatorInfo.h"
 
+#include "core/tgBulletCableForceEngine.h"
+#include "core/tgBulletConstraintSpringCable.h"
 #include "core/tgBulletSpringCable.h"
 #include "core/tgBulletSpringCableAnchor.h"
+#include "core/tgBulletUtil.h"
 
 tgBasicActuatorInfo::tgBasicActuatorInfo(const tgBasicActuator::Config& config) : 
 m_config(config),
@@ -53,7 +56,20 @@ tgConnectorInfo* tgBasicActuatorInfo::createConnectorInfo(const tgPair& pair)
 void tgBasicActuatorInfo::initConnector(tgWorld& world)
 {
     // Note: tgBulletSpringCable holds pointers to things in the world, but it doesn't actually have any in-world representation.
-    m_bulletSpringCable = createTgBulletSpringCable();
+    m_bulletSpringCable = createTgBulletSpringCable(world);
+    m_bulletSpringCable->setImplicitForces(m_config.implicitForces);
+    // The bodies do not move between the substeps of a world step
+    m_bulletSpringCable->setVelocityFromBodies(world.getConfig().cableSubsteps > 1);
+    m_bulletSpringCable->setWakeImpulse(world.getConfig().cableWakeImpulse);
+    
+    // Let the world compute this cable's forces along with all the others.
+    // The engine only computes explicit forces.
+    tgBulletCableForceEngine* pEngine = tgBulletUtil::worldToCableForceEngine(world);
+    if (pEngine != NULL && !m_config.implicitForces &&
+        !m_config.solverConstraint)
+    {
+        pEngine->addCable(m_bulletSpringCable);
+    }
 }
 
 tgModel* tgBasicActuatorInfo::createModel(tgWorld& world)
@@ -74,7 +90,7 @@ double tgBasicActuatorInfo::getMass()
 }
 
 
-tgBulletSpringCable* tgBasicActuatorInfo::createTgBulletSpringCable()
+tgBulletSpringCable* tgBasicActuatorInfo::createTgBulletSpringCable(tgWorld& world)
 {
      
     // @todo: need to check somewhere that the rigid bodies have been set...
@@ -121,6 +137,13 @@ tgBulletSpringCable* tgBasicActuatorInfo::createTgBulletSpringCable()
     tgBulletSpringCableAnchor* anchor2 = new tgBulletSpringCableAnchor(toBody, to);
     anchorList.push_back(anchor2);
 	
+    if (m_config.solverConstraint)
+    {
+        return new tgBulletConstraintSpringCable(world, anchorList,
+                                                 m_config.stiffness,
+                                                 m_config.damping,
+                                                 m_config.pretension);
+    }
     return new tgBulletSpringCable(anchorList, m_config.stiffness, m_config.damping, m_config.pretension);
 }
     
@@ -79,9 +79,14 @@ public:
 
     double getMass();
 
+    virtual double getPretension() const
+    {
+        return m_config.pretension;
+    }
+
 protected:    
     
-    tgBulletSpringCable* createTgBulletSpringCable();
+    tgBulletSpringCable* createTgBulletSpringCable(tgWorld& world);
     tgBulletSpringCable* m_bulletSpringCable;
 private:
     
@@ -29,6 +29,7 @@
 #include "core/tgBulletContactSpringCable.h"
 
 #include "core/tgBulletUtil.h"
+#include "core/tgGhostPairFilter.h"
 #include "core/tgBulletSpringCableAnchor.h"
 
 #include "tgcreator/tgNode.h"
@@ -134,7 +135,17 @@ tgBulletContactSpringCable* tgBasicContactCableInfo::createTgBulletContactSpring
 	// Add ghost object to world
 	// @todo tgBulletContactSpringCable handles deleting from world - should it handle adding too?
 	btDynamicsWorld& m_dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(world);
-	m_dynamicsWorld.addCollisionObject(m_ghostObject,btBroadphaseProxy::CharacterFilter, btBroadphaseProxy::StaticFilter|btBroadphaseProxy::DefaultFilter);
+	// Before adding, so the broadphase never pairs the ghost with the
+	// rods it ends on, which it overlaps from the start
+	tgGhostPairFilter& ghostFilter = tgBulletUtil::worldToGhostPairFilter(world);
+	ghostFilter.exclude(m_ghostObject, fromBody);
+	ghostFilter.exclude(m_ghostObject, toBody);
+	// With capsule collision the cable finds moving bodies through
+	// tgCableCollision, leaving the ghost only the static ones
+	const short mask = tgBulletUtil::worldToCableCollision(world) ?
+		short(btBroadphaseProxy::StaticFilter) :
+		short(btBroadphaseProxy::StaticFilter|btBroadphaseProxy::DefaultFilter);
+	m_dynamicsWorld.addCollisionObject(m_ghostObject,btBroadphaseProxy::CharacterFilter, mask);
 	
     return new tgBulletContactSpringCable(m_ghostObject, world, anchorList, m_config.stiffness, m_config.damping, m_config.pretension);
 }
@@ -79,6 +79,11 @@ public:
 
     double getMass();
 
+    virtual double getPretension() const
+    {
+        return m_config.pretension;
+    }
+
 protected:
     tgBulletContactSpringCable* m_bulletContactSpringCable;
     
@@ -0,0 +1,111 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBodyBatch.cpp
+ * @brief Implementation of class tgBodyBatch
+ * $Id$
+ */
+
+// This module
+#include "tgBodyBatch.h"
+// This library
+#include "core/tgWorld.h"
+#include "core/tgWorldBulletPhysicsImpl.h"
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btBroadphaseProxy.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <cassert>
+
+namespace
+{
+    /** The innermost open batch on each thread */
+    __thread tgBodyBatch* s_pCurrent = NULL;
+}
+
+tgBodyBatch::tgBodyBatch(tgWorld& world) :
+    m_world(world),
+    m_pPrevious(s_pCurrent)
+{
+    s_pCurrent = this;
+}
+
+tgBodyBatch::~tgBodyBatch()
+{
+    // Bodies left out of the world would never be deleted
+    commit();
+    s_pCurrent = m_pPrevious;
+}
+
+tgBodyBatch* tgBodyBatch::current()
+{
+    return s_pCurrent;
+}
+
+void tgBodyBatch::add(btRigidBody* pBody)
+{
+    assert(pBody != NULL);
+    assert(m_index.find(pBody) == m_index.end());
+
+    // As btDiscreteDynamicsWorld::addRigidBody without a filter
+    const bool isStatic = pBody->isStaticOrKinematicObject();
+    Pending pending;
+    pending.pBody = pBody;
+    pending.group = isStatic ?
+        int(btBroadphaseProxy::StaticFilter) : int(btBroadphaseProxy::DefaultFilter);
+    pending.mask = isStatic ?
+        int(btBroadphaseProxy::AllFilter ^ btBroadphaseProxy::StaticFilter) :
+        int(btBroadphaseProxy::AllFilter);
+    m_index[pBody] = m_bodies.size();
+    m_bodies.push_back(pending);
+}
+
+bool tgBodyBatch::setFilter(btRigidBody* pBody, int group, int mask)
+{
+    const std::map<const btRigidBody*, std::size_t>::const_iterator it =
+        m_index.find(pBody);
+    if (it == m_index.end())
+    {
+        return false;
+    }
+    m_bodies[it->second].group = group;
+    m_bodies[it->second].mask = mask;
+    return true;
+}
+
+void tgBodyBatch::commit()
+{
+    if (m_bodies.empty())
+    {
+        return;
+    }
+    std::vector<tgWorldBulletPhysicsImpl::FilteredObject> bodies(m_bodies.size());
+    for (std::size_t i = 0; i < m_bodies.size(); i++)
+    {
+        bodies[i].pObject = m_bodies[i].pBody;
+        bodies[i].group = m_bodies[i].group;
+        bodies[i].mask = m_bodies[i].mask;
+    }
+    m_bodies.clear();
+    m_index.clear();
+
+    tgWorldBulletPhysicsImpl& bulletWorld =
+        static_cast<tgWorldBulletPhysicsImpl&>(m_world.implementation());
+    bulletWorld.addRigidBodies(bodies);
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBodyBatch.h
+ * @brief Definition of class tgBodyBatch
+ * $Id$
+ */
+
+#ifndef TG_BODY_BATCH_H
+#define TG_BODY_BATCH_H
+
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class tgWorld;
+
+/**
+ * Holds the rigid bodies of one build until they are all made, then
+ * adds them to the world together through
+ * tgWorldBulletPhysicsImpl::addRigidBodies. While a batch is open on
+ * this thread, tgRigidInfo::initRigidBody gives it the bodies it creates
+ * for the batch's world instead of adding them one at a time, and a
+ * collision filter only has to be recorded rather than applied by
+ * taking the body out of the world and adding it again.
+ *
+ * tgStructureInfo::instantiate opens a batch around the rigid bodies
+ * and commits it before the connectors, so contact cable ghosts still
+ * find their anchor bodies in the world. Outside of a batch bodies are
+ * added as they are created, as before.
+ */
+class tgBodyBatch
+{
+public:
+
+    /**
+     * Open a batch on this thread until destroyed, restoring the one
+     * open before.
+     * @param[in] world the world the bodies are for
+     */
+    explicit tgBodyBatch(tgWorld& world);
+
+    /** Commits any bodies still held */
+    ~tgBodyBatch();
+
+    /** The innermost open batch on this thread, or NULL */
+    static tgBodyBatch* current();
+
+    tgWorld& world() const
+    {
+        return m_world;
+    }
+
+    /**
+     * Hold a body that is in no world, with Bullet's default filter
+     * for a static or a dynamic body.
+     * @param[in] pBody must not be NULL
+     */
+    void add(btRigidBody* pBody);
+
+    /**
+     * Set the collision filter a held body will be added with.
+     * @return false if the body is not held
+     */
+    bool setFilter(btRigidBody* pBody, int group, int mask);
+
+    /** Add the held bodies to the world and forget them */
+    void commit();
+
+    /** The bodies held */
+    std::size_t size() const
+    {
+        return m_bodies.size();
+    }
+
+private:
+
+    tgBodyBatch(const tgBodyBatch&);
+    tgBodyBatch& operator=(const tgBodyBatch&);
+
+    struct Pending
+    {
+        btRigidBody* pBody;
+        int group;
+        int mask;
+    };
+
+    tgWorld& m_world;
+
+    tgBodyBatch* const m_pPrevious;
+
+    /** In the order they were added */
+    std::vector<Pending> m_bodies;
+
+    /** Index into m_bodies */
+    std::map<const btRigidBody*, std::size_t> m_index;
+};
+
+#endif  // TG_BODY_BATCH_H
@@ -161,6 +161,14 @@ public:
      */
     //    virtual std::set<btVector3> getContainedNodes() const;
 
+    /**
+     * False, since containsNode accepts any point on the surface.
+     */
+    virtual bool containsOnlyListedNodes() const
+    {
+        return false;
+    }
+
 protected:
 
     /**
@@ -0,0 +1,153 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgBuildArena.cpp
+ * @brief Implementation of class tgBuildArena
+ * $Id$
+ */
+
+// This module
+#include "tgBuildArena.h"
+// The C++ Standard Library
+#include <cassert>
+#include <new>
+
+namespace
+{
+    /**
+     * Each allocation is preceded by the arena it came from, NULL for
+     * the heap, padded to keep the object aligned for any type
+     */
+    union Header
+    {
+        tgBuildArena* pArena;
+        long double alignLongDouble;
+        double alignDouble;
+        void* alignPointer;
+    };
+
+    /** Header rounded up to a multiple of 16, the strictest alignment */
+    const std::size_t headerSize = (sizeof(Header) + 15) & ~std::size_t(15);
+
+    /** The innermost open arena on each thread */
+    __thread tgBuildArena* s_pCurrent = NULL;
+}
+
+tgBuildArena::Scope::Scope(tgBuildArena* pArena) :
+    m_pPrevious(s_pCurrent)
+{
+    s_pCurrent = pArena;
+}
+
+tgBuildArena::Scope::~Scope()
+{
+    s_pCurrent = m_pPrevious;
+}
+
+tgBuildArena::tgBuildArena(std::size_t blockSize) :
+    m_blockSize(blockSize),
+    m_next(NULL),
+    m_end(NULL),
+    m_references(1)
+{
+}
+
+tgBuildArena::~tgBuildArena()
+{
+    assert(m_references == 0);
+    for (std::size_t i = 0; i < m_blocks.size(); i++)
+    {
+        ::operator delete(m_blocks[i]);
+    }
+}
+
+void tgBuildArena::retain()
+{
+    m_references++;
+}
+
+void tgBuildArena::release()
+{
+    assert(m_references > 0);
+    if (--m_references == 0)
+    {
+        delete this;
+    }
+}
+
+tgBuildArena* tgBuildArena::current()
+{
+    return s_pCurrent;
+}
+
+void* tgBuildArena::allocate(std::size_t size)
+{
+    const std::size_t total = headerSize + ((size + 15) & ~std::size_t(15));
+    tgBuildArena* const pArena = s_pCurrent;
+    char* const p = pArena ?
+        pArena->bump(total) :
+        static_cast<char*>(::operator new(total));
+    
+    reinterpret_cast<Header*>(p)->pArena = pArena;
+    if (pArena)
+    {
+        pArena->retain();
+    }
+    return p + headerSize;
+}
+
+void tgBuildArena::deallocate(void* p)
+{
+    if (p == NULL)
+    {
+        return;
+    }
+    char* const pBlock = static_cast<char*>(p) - headerSize;
+    tgBuildArena* const pArena = reinterpret_cast<Header*>(pBlock)->pArena;
+    if (pArena)
+    {
+        pArena->release();
+    }
+    else
+    {
+        ::operator delete(pBlock);
+    }
+}
+
+char* tgBuildArena::bump(std::size_t size)
+{
+    if (size > m_blockSize)
+    {
+        // A block of its own, leaving the current one to fill
+        char* const pBlock = static_cast<char*>(::operator new(size));
+        m_blocks.push_back(pBlock);
+        return pBlock;
+    }
+    if (static_cast<std::size_t>(m_end - m_next) < size)
+    {
+        char* const pBlock = static_cast<char*>(::operator new(m_blockSize));
+        m_blocks.push_back(pBlock);
+        m_next = pBlock;
+        m_end = pBlock + m_blockSize;
+    }
+    char* const p = m_next;
+    m_next += size;
+    return p;
+}
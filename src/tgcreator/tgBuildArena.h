@@ -0,0 +1,121 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file tgBuildArena.h
+ * @brief Definition of class tgBuildArena
+ * $Id$
+ */
+
+#ifndef TG_BUILD_ARENA_H
+#define TG_BUILD_ARENA_H
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+/**
+ * Bump allocation for the objects of one build: the tgStructureInfo
+ * tree and the tgRigidInfo and tgConnectorInfo objects the tgBuildSpec
+ * factories create for it. Those classes allocate through allocate(),
+ * which takes from the arena of the Scope open on this thread, or from
+ * the heap when there is none. deallocate() runs no allocator for arena
+ * memory; the blocks are freed together once every object allocated
+ * from the arena has been deleted and every holder has released it.
+ *
+ * A root tgStructureInfo creates the arena and opens a Scope while it
+ * builds its tree and in buildInto, so the factories need no changes.
+ * An arena is used by one thread at a time.
+ */
+class tgBuildArena
+{
+public:
+
+    /**
+     * Opens an arena for allocate() on this thread until destroyed,
+     * restoring the one open before.
+     */
+    class Scope
+    {
+    public:
+        /** @param[in] pArena the arena to use; NULL for the heap */
+        Scope(tgBuildArena* pArena);
+        ~Scope();
+    private:
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+        tgBuildArena* const m_pPrevious;
+    };
+
+    /**
+     * An empty arena held once by the caller, who calls release() when
+     * done with it.
+     * @param[in] blockSize the bytes to allocate from the heap at a time;
+     * larger requests get a block of their own
+     */
+    tgBuildArena(std::size_t blockSize = 64 * 1024);
+
+    /** Hold the arena, so it stays open until the matching release(). */
+    void retain();
+
+    /** Give up a hold; the last one frees the arena and its blocks. */
+    void release();
+
+    /** The arena of the innermost Scope on this thread, or NULL */
+    static tgBuildArena* current();
+
+    /**
+     * Memory for an object, from the current arena if there is one.
+     * @param[in] size the bytes needed
+     * @throw std::bad_alloc if the heap is exhausted
+     */
+    static void* allocate(std::size_t size);
+
+    /**
+     * Give back memory from allocate(), from whichever arena or the heap
+     * it came from. NULL is ignored.
+     */
+    static void deallocate(void* p);
+
+private:
+
+    /** Only release() deletes an arena */
+    ~tgBuildArena();
+
+    tgBuildArena(const tgBuildArena&);
+    tgBuildArena& operator=(const tgBuildArena&);
+
+    /** Carve size bytes, a multiple of the alignment, from the blocks */
+    char* bump(std::size_t size);
+
+    /** The usual block size */
+    const std::size_t m_blockSize;
+
+    /** Every block allocated, freed with the arena */
+    std::vector<char*> m_blocks;
+
+    /** The free part of the newest usual-sized block */
+    char* m_next;
+    char* m_end;
+
+    /** Holders plus objects not yet deallocated */
+    std::size_t m_references;
+};
+
+#endif  // TG_BUILD_ARENA_H
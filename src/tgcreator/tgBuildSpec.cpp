@@ -52,6 +52,12 @@ tgBuildSpec::~tgBuildSpec() {
           m_connectorAgents.pop_back();
           delete agent;
       }
+     for (std::size_t i = 0; i < m_collisionFilters.size(); i++) {
+          delete m_collisionFilters[i];
+      }
+     for (std::size_t i = 0; i < m_actuatorGroups.size(); i++) {
+          delete m_actuatorGroups[i];
+      }
 }
 
 void tgBuildSpec::addBuilder(std::string tag_search, tgRigidInfo* infoFactory)
@@ -72,3 +78,12 @@ void tgBuildSpec::addBuilder(std::string tag_search, tgConnectorInfo* infoFactor
     m_connectorAgents.push_back(new ConnectorAgent(tag_search, infoFactory));
 }
 
+void tgBuildSpec::addCollisionFilter(std::string tag_search, int group, int mask)
+{
+    m_collisionFilters.push_back(new CollisionFilter(tag_search, group, mask));
+}
+
+void tgBuildSpec::addActuatorGroup(std::string name, std::string tag_search)
+{
+    m_actuatorGroups.push_back(new ActuatorGroup(name, tag_search));
+}
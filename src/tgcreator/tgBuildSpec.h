@@ -71,12 +71,70 @@ public:
         tgConnectorInfo* infoFactory;
     };
 
+    /**
+     * Bullet collision filtering for the rigids a search matches. A pair
+     * of bodies is collided only if each one's group is in the other's
+     * mask. Groups and masks are bits as in Bullet's
+     * btBroadphaseProxy::CollisionFilterGroups: DefaultFilter (1) and
+     * AllFilter (-1) for dynamic bodies, StaticFilter (2) for static
+     * ones such as the ground, and CharacterFilter (32) for the ghost
+     * objects of contact cables. Bits from 64 up are free for models.
+     */
+    struct CollisionFilter
+    {
+    public:
+        CollisionFilter(std::string s, int g, int m) :
+            tagSearch(tgTagSearch(s)), group(g), mask(m)
+        {}
+
+        tgTagSearch tagSearch;
+
+        int group;
+
+        int mask;
+    };
+
+    /**
+     * A named group of the actuators a search matches, for
+     * tgModel::getActuatorGroups
+     */
+    struct ActuatorGroup
+    {
+    public:
+        ActuatorGroup(std::string n, std::string s) :
+            name(n), tagSearch(tgTagSearch(s))
+        {}
+
+        std::string name;
+
+        tgTagSearch tagSearch;
+    };
+
     tgBuildSpec() {}
     virtual ~tgBuildSpec();
 
     void addBuilder(std::string tag_search, tgRigidInfo* infoFactory);
     
     void addBuilder(std::string tag_search, tgConnectorInfo* infoFactory);
+
+    /**
+     * Put the bodies of the rigids that match tag_search into the world
+     * with a collision group and mask, e.g. "rod" with group 64 and mask
+     * ~64 so a model's rods collide with everything but each other. When
+     * several filters match a rigid, the one added last is used, as with
+     * builders. Rigids in a compound share one body, so it takes the
+     * filter of the last of them to match.
+     */
+    void addCollisionFilter(std::string tag_search, int group, int mask);
+
+    /**
+     * Name the actuators that match tag_search, e.g. "outer top" for
+     * "outer top muscle", so controllers can take them from the built
+     * model's tgActuatorGroups instead of finding them by tag. An
+     * actuator matching several groups goes in the first added.
+     * @throw std::invalid_argument at build if two groups share a name
+     */
+    void addActuatorGroup(std::string name, std::string tag_search);
     
     std::vector<RigidAgent*> getRigidAgents()
     {
@@ -87,10 +145,22 @@ public:
     {
         return m_connectorAgents;
     }
+
+    const std::vector<CollisionFilter*>& getCollisionFilters() const
+    {
+        return m_collisionFilters;
+    }
+
+    const std::vector<ActuatorGroup*>& getActuatorGroups() const
+    {
+        return m_actuatorGroups;
+    }
     
 private:
     std::vector<RigidAgent*> m_rigidAgents;
     std::vector<ConnectorAgent*> m_connectorAgents;  
+    std::vector<CollisionFilter*> m_collisionFilters;
+    std::vector<ActuatorGroup*> m_actuatorGroups;
 };
 
 #endif
@@ -133,6 +133,15 @@ void tgCompoundRigidInfo::setRigidBody(btRigidBody* const rigidBody)
     }
 }
 
+void tgCompoundRigidInfo::forgetWorld()
+{
+    tgRigidInfo::forgetWorld();
+    m_compoundShape = NULL;
+    for (int ii = 0; ii < m_rigids.size(); ii++) {
+        m_rigids[ii]->forgetWorld();
+    }
+}
+
 void tgCompoundRigidInfo::setCollisionObject(btCollisionObject* collisionObject)
 {
 	m_collisionObject = collisionObject;
@@ -201,3 +210,15 @@ std::set<btVector3> tgCompoundRigidInfo::getContainedNodes() const
     return contained;
 }
 
+bool tgCompoundRigidInfo::containsOnlyListedNodes() const
+{
+    for (int ii = 0; ii < m_rigids.size(); ii++)
+    {
+        if (!m_rigids[ii]->containsOnlyListedNodes())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
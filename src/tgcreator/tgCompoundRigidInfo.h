@@ -123,6 +123,9 @@ class tgCompoundRigidInfo : public tgRigidInfo
      * @param[in,out] a pointer to a btRigidBody
      */
     virtual void setRigidBody(btRigidBody* const rigidBody);
+
+    /** Also forget the compound shape and the components' bodies */
+    virtual void forgetWorld();
     
     /**
      * Return a pointer to the collisionObject without upcasting
@@ -201,6 +204,11 @@ class tgCompoundRigidInfo : public tgRigidInfo
      */
     std::set<btVector3> getContainedNodes() const;
 
+    /**
+     * True if it is true of every rigid in this compound.
+     */
+    virtual bool containsOnlyListedNodes() const;
+
 protected:
 
     /**
@@ -28,8 +28,10 @@
 #include "tgCompressionSpringActuatorInfo.h"
 
 // Other classes from core
+#include "core/tgBulletCableForceEngine.h"
 #include "core/tgBulletCompressionSpring.h"
 #include "core/tgBulletSpringCableAnchor.h"
+#include "core/tgBulletUtil.h"
 
 tgCompressionSpringActuatorInfo::tgCompressionSpringActuatorInfo(const tgCompressionSpringActuator::Config& config) : 
 m_config(config),
@@ -55,6 +57,13 @@ void tgCompressionSpringActuatorInfo::initConnector(tgWorld& world)
 {
     // Note: tgBulletCompressionSpring holds pointers to things in the world, but it doesn't actually have any in-world representation.
     m_bulletCompressionSpring = createTgBulletCompressionSpring();
+
+    // Let the world compute this spring's force along with the cables'
+    tgBulletCableForceEngine* pEngine = tgBulletUtil::worldToCableForceEngine(world);
+    if (pEngine != NULL)
+    {
+        pEngine->addSpring(m_bulletCompressionSpring);
+    }
 }
 
 tgModel* tgCompressionSpringActuatorInfo::createModel(tgWorld& world)
@@ -59,31 +59,35 @@ std::vector<tgConnectorInfo*> tgConnectorInfo::createConnectorInfos(const tgPair
     return result;
 }
 
-void tgConnectorInfo::chooseRigids(std::set<tgRigidInfo*> rigids) 
+void tgConnectorInfo::chooseRigids(const tgRigidNodeIndex& index) 
 {
 
-    // @todo: find and set pointers to appropriate rigids from the set provided. 
     // @todo: should we throw an exception if no appropriate rigid is found? 
     if(getFromRigidInfo() == 0) { // if it hasn't already been set
-        tgRigidInfo* fromRigidInfo = chooseRigid(rigids, getFrom());
-        //std::cout << "  chosen fromRigidInfo is " << fromRigidInfo << std::endl;
-        setFromRigidInfo(fromRigidInfo);
-        //std::cout << "  getFromRigidInfo is " << getFromRigidInfo() << std::endl;
+        setFromRigidInfo(chooseRigid(index, getFrom()));
     }
     
     if(getToRigidInfo() == 0) { // if it hasn't already been set
-        tgRigidInfo* toRigidInfo = chooseRigid(rigids, getTo());
-        //std::cout << "  chosen toRigidInfo is " << toRigidInfo << std::endl;
-        setToRigidInfo(toRigidInfo);
-        //std::cout << "  getToRigidInfo is " << getToRigidInfo() << std::endl;
+        setToRigidInfo(chooseRigid(index, getTo()));
     }
 }
 
-tgRigidInfo* tgConnectorInfo::chooseRigid(std::set<tgRigidInfo*> rigids, const btVector3& v) {
+void tgConnectorInfo::chooseRigids(const std::set<tgRigidInfo*>& rigids) 
+{
+    chooseRigids(tgRigidNodeIndex(std::vector<tgRigidInfo*>(rigids.begin(), rigids.end())));
+}
+
+tgRigidInfo* tgConnectorInfo::chooseRigid(const tgRigidNodeIndex& index, const btVector3& v) {
+    return chooseAmong(index.findRigidsContaining(v), v);
+}
+
+tgRigidInfo* tgConnectorInfo::chooseRigid(const std::set<tgRigidInfo*>& rigids, const btVector3& v) {
+    return chooseAmong(findRigidsContaining(rigids, v), v);
+}
 
-    std::set<tgRigidInfo*> candidateRigids = findRigidsContaining(rigids, v);
+tgRigidInfo* tgConnectorInfo::chooseAmong(const std::set<tgRigidInfo*>& candidateRigids, const btVector3& v) {
     
-    tgRigidInfo* chosenRigid;
+    tgRigidInfo* chosenRigid = NULL;
     if (candidateRigids.size() == 1) {
       // Choose the first element since there's only one
       chosenRigid = *(candidateRigids.begin());  
@@ -160,11 +164,11 @@ btRigidBody* tgConnectorInfo::getFromRigidBody() {
 // Protected:
 
 
-tgRigidInfo* tgConnectorInfo::findClosestCenterOfMass(std::set<tgRigidInfo*> rigids, const btVector3& v) {
+tgRigidInfo* tgConnectorInfo::findClosestCenterOfMass(const std::set<tgRigidInfo*>& rigids, const btVector3& v) {
     if (rigids.size() == 0) {
         return NULL;
     }
-    std::set<tgRigidInfo*>::iterator it;
+    std::set<tgRigidInfo*>::const_iterator it;
     it = rigids.begin();
     tgRigidInfo* closest = *it;  // First member
     it++;
@@ -178,9 +182,9 @@ tgRigidInfo* tgConnectorInfo::findClosestCenterOfMass(std::set<tgRigidInfo*> rig
 }
 
 
-std::set<tgRigidInfo*> tgConnectorInfo::findRigidsContaining(std::set<tgRigidInfo*> rigids, const btVector3& toFind) {
+std::set<tgRigidInfo*> tgConnectorInfo::findRigidsContaining(const std::set<tgRigidInfo*>& rigids, const btVector3& toFind) {
     std::set<tgRigidInfo*> found;
-    std::set<tgRigidInfo*>::iterator it;
+    std::set<tgRigidInfo*>::const_iterator it;
     for(it=rigids.begin(); it != rigids.end(); ++it) {
         if ((*it)->containsNode(toFind)) {
             found.insert(*it);
@@ -190,9 +194,9 @@ std::set<tgRigidInfo*> tgConnectorInfo::findRigidsContaining(std::set<tgRigidInf
 };
 
 // @todo: Remove this? Is it used by anything? It's protected...
-bool tgConnectorInfo::rigidFoundIn(std::set<tgRigidInfo*> rigids, tgRigidInfo* rigid) {
+bool tgConnectorInfo::rigidFoundIn(const std::set<tgRigidInfo*>& rigids, tgRigidInfo* rigid) {
     //return (std::find(rigids.begin(), rigids.end(), rigid) != rigids.end()); // Doesn't work on some compilers (RDA 2014-Jan-28)
-    std::set<tgRigidInfo*>::iterator it;
+    std::set<tgRigidInfo*>::const_iterator it;
     for(it = rigids.begin(); it != rigids.end(); ++it) {
         if(*it == rigid) 
             return true;
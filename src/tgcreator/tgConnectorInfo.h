@@ -27,6 +27,7 @@
  * $Id$
  */
 
+#include "tgBuildArena.h"
 #include "core/tgTaggable.h"
 
 class btVector3;
@@ -41,10 +42,23 @@ class tgWorld;
 
 #include "LinearMath/btVector3.h" // @todo: any way to move this to the .cpp file?
 #include "tgPair.h"
+#include "tgRigidNodeIndex.h"
 
 class tgConnectorInfo : public tgTaggable {
 public:
 
+    /** Allocated from the tgBuildArena of the build, if there is one */
+    static void* operator new(std::size_t size)
+    {
+        return tgBuildArena::allocate(size);
+    }
+
+    static void operator delete(void* p)
+    {
+        tgBuildArena::deallocate(p);
+    }
+
+
     tgConnectorInfo() : 
         tgTaggable(),
         m_fromRigidInfo(0),
@@ -144,31 +158,45 @@ public:
     // @todo: how should we calculate mass? 
     // Note that different connectors will likely use different methods of calculating mass...
     virtual double getMass() = 0;
+
+    /**
+     * The tension the connector is built with, for tgFormFinder. Zero
+     * for connectors that do not pull their ends together.
+     */
+    virtual double getPretension() const
+    {
+        return 0.0;
+    }
     
     
     // Choose the appropriate rigids for the connector and give the connector pointers to them
-    virtual void chooseRigids(std::set<tgRigidInfo*> rigids);
+    virtual void chooseRigids(const tgRigidNodeIndex& index);
+
+    virtual void chooseRigids(const std::set<tgRigidInfo*>& rigids);
 
     // @todo: in the process of switching ti std::vector for these...
-    virtual void chooseRigids(std::vector<tgRigidInfo*> rigids) 
+    virtual void chooseRigids(const std::vector<tgRigidInfo*>& rigids) 
     {
-        std::set<tgRigidInfo*> s;
-        s.insert(rigids.begin(), rigids.end());
-        chooseRigids(s);
+        chooseRigids(tgRigidNodeIndex(rigids));
     }
 
     
-    tgRigidInfo* chooseRigid(std::set<tgRigidInfo*> rigids, const btVector3& v);
+    tgRigidInfo* chooseRigid(const tgRigidNodeIndex& index, const btVector3& v);
+
+    tgRigidInfo* chooseRigid(const std::set<tgRigidInfo*>& rigids, const btVector3& v);
     
     
 protected:
-    tgRigidInfo* findClosestCenterOfMass(std::set<tgRigidInfo*> rigids, const btVector3& v);
+    tgRigidInfo* findClosestCenterOfMass(const std::set<tgRigidInfo*>& rigids, const btVector3& v);
+
+    // Pick one of the rigids containing v, warning if there are none
+    tgRigidInfo* chooseAmong(const std::set<tgRigidInfo*>& candidateRigids, const btVector3& v);
 
     // @todo: should this be protected/private?
-    std::set<tgRigidInfo*> findRigidsContaining(std::set<tgRigidInfo*> rigids, const btVector3& toFind);
+    std::set<tgRigidInfo*> findRigidsContaining(const std::set<tgRigidInfo*>& rigids, const btVector3& toFind);
     
     // @todo: Remove this? Is it used by anything?
-    bool rigidFoundIn(std::set<tgRigidInfo*> rigids, tgRigidInfo* rigid);
+    bool rigidFoundIn(const std::set<tgRigidInfo*>& rigids, tgRigidInfo* rigid);
     
     
     // Step 1: Define the points that we're connecting
@@ -0,0 +1,92 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCordeStringInfo.cpp
+ * @brief Implementation of class tgCordeStringInfo
+ * $Id$
+ */
+
+#include "tgCordeStringInfo.h"
+#include "tgUtil.h"
+
+#include "core/tgCordeRod.h"
+
+// The C++ Standard Library
+#include <cassert>
+#include <cmath>
+
+tgCordeStringInfo::tgCordeStringInfo(const tgCordeString::Config& config) :
+tgConnectorInfo(),
+m_config(config),
+m_pRod(NULL)
+{}
+
+tgCordeStringInfo::tgCordeStringInfo(const tgCordeString::Config& config, tgTags tags) :
+tgConnectorInfo(tags),
+m_config(config),
+m_pRod(NULL)
+{}
+
+tgCordeStringInfo::tgCordeStringInfo(const tgCordeString::Config& config, const tgPair& pair) :
+tgConnectorInfo(pair),
+m_config(config),
+m_pRod(NULL)
+{}
+
+tgCordeStringInfo::~tgCordeStringInfo()
+{
+    delete m_pRod;
+}
+
+tgConnectorInfo* tgCordeStringInfo::createConnectorInfo(const tgPair& pair)
+{
+    return new tgCordeStringInfo(m_config, pair);
+}
+
+void tgCordeStringInfo::initConnector(tgWorld& world)
+{
+    // A rod without bending or torsion: every centerline element takes
+    // z onto the string's direction
+    const btQuaternion rotation =
+        tgUtil::getQuaternionBetween(btVector3(0.0, 0.0, 1.0),
+                                     getTo() - getFrom(),
+                                     btVector3(1.0, 0.0, 0.0));
+
+    delete m_pRod;
+    m_pRod = new tgCordeRod(getFrom(), getTo(), rotation, rotation,
+                            m_config.rodConfig);
+    m_pRod->attach(tgCordeRod::eStart, getFromRigidBody());
+    m_pRod->attach(tgCordeRod::eEnd, getToRigidBody());
+}
+
+tgModel* tgCordeStringInfo::createModel(tgWorld& world)
+{
+    // ensure connector has been initialized
+    assert(m_pRod);
+    tgCordeRod* const pRod = m_pRod;
+    m_pRod = NULL;
+    return new tgCordeString(pRod, getTags(), m_config);
+}
+
+double tgCordeStringInfo::getMass()
+{
+    const tgCordeRod::Config& rc = m_config.rodConfig;
+    return rc.density * M_PI * rc.radius * rc.radius *
+        (getTo() - getFrom()).length();
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCordeStringInfo.h
+ * @brief Definition of class tgCordeStringInfo
+ * $Id$
+ */
+
+#ifndef SRC_TGCREATOR_TG_CORDE_STRING_INFO_H
+#define SRC_TGCREATOR_TG_CORDE_STRING_INFO_H
+
+#include "tgConnectorInfo.h"
+
+#include "core/tgCordeString.h"
+#include "core/tgTags.h"
+
+class tgCordeRod;
+
+/**
+ * Builds a tgCordeString between a pair's rigid bodies. It takes the
+ * place of dev/btietz's tgRBStringInfo, with the same constructors,
+ * and the rod's resolution in place of the number of rigid segments.
+ */
+class tgCordeStringInfo : public tgConnectorInfo
+{
+public:
+
+    /**
+     * Construct a tgCordeStringInfo with just a config. The pair must be
+     * filled in later, or factory methods can be used to create
+     * instances with pairs.
+     */
+    tgCordeStringInfo(const tgCordeString::Config& config);
+
+    /**
+     * Construct a tgCordeStringInfo with just a config and tags.
+     */
+    tgCordeStringInfo(const tgCordeString::Config& config, tgTags tags);
+
+    /**
+     * Construct a tgCordeStringInfo between the ends of a pair.
+     */
+    tgCordeStringInfo(const tgCordeString::Config& config, const tgPair& pair);
+
+    /** Deletes the rod if no model was created */
+    virtual ~tgCordeStringInfo();
+
+    /**
+     * Create a tgConnectorInfo* from a tgPair
+     */
+    virtual tgConnectorInfo* createConnectorInfo(const tgPair& pair);
+
+    /** Creates the rod and anchors its ends to the pair's bodies */
+    virtual void initConnector(tgWorld& world);
+
+    /** The model takes ownership of the rod */
+    virtual tgModel* createModel(tgWorld& world);
+
+    /** The number of centerline elements, as tgRBStringInfo's segments */
+    int getSegments() const
+    {
+        return m_config.rodConfig.resolution - 1;
+    }
+
+    double getMass();
+
+private:
+
+    tgCordeString::Config m_config;
+
+    /** Created by initConnector, owned until createModel */
+    tgCordeRod* m_pRod;
+};
+
+#endif
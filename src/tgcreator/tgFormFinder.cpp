@@ -0,0 +1,622 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgFormFinder.cpp
+ * @brief Implementation of class tgFormFinder
+ * $Id$
+ */
+
+// This module
+#include "tgFormFinder.h"
+// This library
+#include "tgBuildSpec.h"
+#include "tgConnectorInfo.h"
+#include "tgNode.h"
+#include "tgPair.h"
+#include "tgRigidInfo.h"
+#include "tgStructure.h"
+// The NTRT core library
+#include "core/tgTagSearch.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /** Union-find over point indices */
+    std::size_t findRoot(std::vector<std::size_t>& parent, std::size_t i)
+    {
+        while (parent[i] != i)
+        {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    /** The distance from p to the segment from a to b */
+    double segmentDistance(const btVector3& p, const btVector3& a,
+                           const btVector3& b)
+    {
+        const btVector3 ab = b - a;
+        const double length2 = ab.length2();
+        double t = length2 > 0.0 ? (p - a).dot(ab) / length2 : 0.0;
+        t = std::max(0.0, std::min(1.0, t));
+        return (p - (a + ab * t)).length();
+    }
+
+    /** The agents' searches with a structure's own tags removed, as tgStructureInfo::agentSearches */
+    template <class Agent>
+    std::vector<tgTagSearch> levelSearches(const std::vector<Agent*>& agents,
+                                           const tgTags& tags)
+    {
+        std::vector<tgTagSearch> result;
+        for (std::size_t i = 0; i < agents.size(); i++)
+        {
+            tgTagSearch tagSearch(agents[i]->tagSearch);
+            tagSearch.remove(tags);
+            result.push_back(tagSearch);
+        }
+        return result;
+    }
+
+    /** As tgStructureInfo::initRigidInfo: the last factory that makes one */
+    template <class T>
+    tgRigidInfo* createRigid(const T& candidate,
+                             const std::vector<tgBuildSpec::RigidAgent*>& agents,
+                             const std::vector<tgTagSearch>& searches)
+    {
+        for (int i = agents.size() - 1; i >= 0; i--)
+        {
+            tgRigidInfo* const pRigid =
+                agents[i]->infoFactory->createRigidInfo(candidate, searches[i]);
+            if (pRigid != 0)
+            {
+                return pRigid;
+            }
+        }
+        return 0;
+    }
+
+    /** As tgStructureInfo::initConnectorInfo */
+    tgConnectorInfo* createConnector(const tgPair& candidate,
+                                     const std::vector<tgBuildSpec::ConnectorAgent*>& agents,
+                                     const std::vector<tgTagSearch>& searches)
+    {
+        for (int i = agents.size() - 1; i >= 0; i--)
+        {
+            tgConnectorInfo* const pConnector =
+                agents[i]->infoFactory->createConnectorInfo(candidate, searches[i]);
+            if (pConnector != 0)
+            {
+                return pConnector;
+            }
+        }
+        return 0;
+    }
+}
+
+tgFormFinder::Config::Config(double tol, std::size_t iterations,
+                             double step) :
+tolerance(tol),
+maxIterations(iterations),
+stepSize(step)
+{
+}
+
+tgFormFinder::tgFormFinder(const Config& config) :
+m_config(config)
+{
+}
+
+std::size_t tgFormFinder::pointIndex(const btVector3& point)
+{
+    std::map<btVector3, std::size_t, PointLess>::const_iterator it =
+        m_pointIndex.find(point);
+    if (it != m_pointIndex.end())
+    {
+        return it->second;
+    }
+    const std::size_t index = m_points.size();
+    m_points.push_back(point);
+    m_pointIndex[point] = index;
+    return index;
+}
+
+void tgFormFinder::collect(const tgStructure& structure, tgBuildSpec& buildSpec)
+{
+    const std::vector<tgBuildSpec::RigidAgent*> rigidAgents =
+        buildSpec.getRigidAgents();
+    const std::vector<tgBuildSpec::ConnectorAgent*> connectorAgents =
+        buildSpec.getConnectorAgents();
+    const std::vector<tgTagSearch> rigidSearches =
+        levelSearches(rigidAgents, structure.getTags());
+    const std::vector<tgTagSearch> connectorSearches =
+        levelSearches(connectorAgents, structure.getTags());
+
+    const tgNodes& nodes = structure.getNodes();
+    for (int i = 0; i < nodes.size(); i++)
+    {
+        tgRigidInfo* const pRigid =
+            createRigid(nodes[i], rigidAgents, rigidSearches);
+        if (pRigid != 0)
+        {
+            const std::size_t point = pointIndex(nodes[i]);
+            m_rigidFrom.push_back(point);
+            m_rigidTo.push_back(point);
+            m_rigidFixed.push_back(pRigid->getMass() == 0.0);
+            delete pRigid;
+        }
+    }
+
+    const tgPairs& pairs = structure.getPairs();
+    for (int i = 0; i < pairs.size(); i++)
+    {
+        const tgPair& pair = pairs[i];
+        tgRigidInfo* const pRigid = createRigid(pair, rigidAgents, rigidSearches);
+        if (pRigid != 0)
+        {
+            m_rigidFrom.push_back(pointIndex(pair.getFrom()));
+            m_rigidTo.push_back(pointIndex(pair.getTo()));
+            m_rigidFixed.push_back(pRigid->getMass() == 0.0);
+            delete pRigid;
+            continue;
+        }
+        tgConnectorInfo* const pConnector =
+            createConnector(pair, connectorAgents, connectorSearches);
+        if (pConnector != 0)
+        {
+            const double tension = pConnector->getPretension();
+            delete pConnector;
+            if (tension > 0.0)
+            {
+                Cable cable;
+                cable.from = pointIndex(pair.getFrom());
+                cable.to = pointIndex(pair.getTo());
+                cable.tension = tension;
+                m_cables.push_back(cable);
+            }
+        }
+    }
+
+    const std::vector<tgStructure*>& children = structure.getChildren();
+    for (std::size_t i = 0; i < children.size(); i++)
+    {
+        collect(*children[i], buildSpec);
+    }
+}
+
+void tgFormFinder::makeBodies()
+{
+    const std::size_t nPoints = m_points.size();
+    std::vector<std::size_t> parent(nPoints);
+    std::vector<bool> rigidPoint(nPoints, false);
+    for (std::size_t i = 0; i < nPoints; i++)
+    {
+        parent[i] = i;
+    }
+    // Rigids sharing a point become one body
+    for (std::size_t r = 0; r < m_rigidFrom.size(); r++)
+    {
+        rigidPoint[m_rigidFrom[r]] = true;
+        rigidPoint[m_rigidTo[r]] = true;
+        parent[findRoot(parent, m_rigidFrom[r])] = findRoot(parent, m_rigidTo[r]);
+    }
+    // A cable end partway along a rigid is carried by it, as
+    // tgConnectorInfo::chooseRigid would attach it
+    for (std::size_t i = 0; i < nPoints; i++)
+    {
+        if (rigidPoint[i])
+        {
+            continue;
+        }
+        for (std::size_t r = 0; r < m_rigidFrom.size(); r++)
+        {
+            const btVector3& a = m_points[m_rigidFrom[r]];
+            const btVector3& b = m_points[m_rigidTo[r]];
+            if (segmentDistance(m_points[i], a, b) <= 1e-9 * (1.0 + (b - a).length()))
+            {
+                parent[findRoot(parent, i)] = findRoot(parent, m_rigidFrom[r]);
+                break;
+            }
+        }
+    }
+
+    // Number the bodies; points on no rigid are bodies of their own
+    std::map<std::size_t, std::size_t> bodyOfRoot;
+    m_bodyOf.resize(nPoints);
+    m_bodies.clear();
+    for (std::size_t i = 0; i < nPoints; i++)
+    {
+        const std::size_t root = findRoot(parent, i);
+        std::map<std::size_t, std::size_t>::const_iterator it = bodyOfRoot.find(root);
+        std::size_t body;
+        if (it == bodyOfRoot.end())
+        {
+            body = m_bodies.size();
+            bodyOfRoot[root] = body;
+            m_bodies.push_back(Body());
+            m_bodies.back().radius = 0.0;
+            m_bodies.back().tension = 0.0;
+            m_bodies.back().fixed = false;
+        }
+        else
+        {
+            body = it->second;
+        }
+        m_bodyOf[i] = body;
+        m_bodies[body].points.push_back(i);
+    }
+    for (std::size_t r = 0; r < m_rigidFrom.size(); r++)
+    {
+        if (m_rigidFixed[r])
+        {
+            m_bodies[m_bodyOf[m_rigidFrom[r]]].fixed = true;
+        }
+    }
+    for (std::size_t c = 0; c < m_cables.size(); c++)
+    {
+        m_bodies[m_bodyOf[m_cables[c].from]].tension += m_cables[c].tension;
+        m_bodies[m_bodyOf[m_cables[c].to]].tension += m_cables[c].tension;
+    }
+
+    m_position = m_points;
+    m_pointForce.resize(nPoints);
+    m_force.resize(m_bodies.size());
+    m_torque.resize(m_bodies.size());
+    m_centroid.resize(m_bodies.size());
+    for (std::size_t b = 0; b < m_bodies.size(); b++)
+    {
+        Body& body = m_bodies[b];
+        btVector3 centroid(0.0, 0.0, 0.0);
+        for (std::size_t k = 0; k < body.points.size(); k++)
+        {
+            centroid += m_points[body.points[k]];
+        }
+        centroid /= body.points.size();
+        for (std::size_t k = 0; k < body.points.size(); k++)
+        {
+            body.radius = std::max(body.radius,
+                (double) (m_points[body.points[k]] - centroid).length());
+        }
+    }
+}
+
+double tgFormFinder::computeForces(std::vector<double>& residuals)
+{
+    std::fill(m_pointForce.begin(), m_pointForce.end(), btVector3(0.0, 0.0, 0.0));
+    for (std::size_t c = 0; c < m_cables.size(); c++)
+    {
+        const Cable& cable = m_cables[c];
+        const btVector3 span = m_position[cable.to] - m_position[cable.from];
+        const double length = span.length();
+        if (length > 0.0)
+        {
+            const btVector3 pull = span * (cable.tension / length);
+            m_pointForce[cable.from] += pull;
+            m_pointForce[cable.to] -= pull;
+        }
+    }
+
+    for (std::size_t b = 0; b < m_bodies.size(); b++)
+    {
+        const Body& body = m_bodies[b];
+        btVector3 centroid(0.0, 0.0, 0.0);
+        btVector3 force(0.0, 0.0, 0.0);
+        for (std::size_t k = 0; k < body.points.size(); k++)
+        {
+            centroid += m_position[body.points[k]];
+            force += m_pointForce[body.points[k]];
+        }
+        centroid /= body.points.size();
+        btVector3 torque(0.0, 0.0, 0.0);
+        for (std::size_t k = 0; k < body.points.size(); k++)
+        {
+            const std::size_t p = body.points[k];
+            torque += (m_position[p] - centroid).cross(m_pointForce[p]);
+        }
+        m_centroid[b] = centroid;
+        m_force[b] = force;
+        m_torque[b] = torque;
+    }
+
+    residuals.resize(6 * m_movable.size());
+    double largest = 0.0;
+    for (std::size_t m = 0; m < m_movable.size(); m++)
+    {
+        const Body& body = m_bodies[m_movable[m]];
+        const btVector3 force = m_force[m_movable[m]] / body.tension;
+        const btVector3 torque = (body.radius > 0.0) ?
+            m_torque[m_movable[m]] / (body.tension * body.radius) :
+            btVector3(0.0, 0.0, 0.0);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            residuals[6 * m + axis] = force[axis];
+            residuals[6 * m + 3 + axis] = torque[axis];
+        }
+        largest = std::max(largest, (double) force.length());
+        largest = std::max(largest, (double) torque.length());
+    }
+    return largest;
+}
+
+void tgFormFinder::applyMove(const std::vector<double>& move)
+{
+    m_position = m_start;
+    for (std::size_t m = 0; m < m_movable.size(); m++)
+    {
+        const Body& body = m_bodies[m_movable[m]];
+        btVector3 centroid(0.0, 0.0, 0.0);
+        for (std::size_t k = 0; k < body.points.size(); k++)
+        {
+            centroid += m_start[body.points[k]];
+        }
+        centroid /= body.points.size();
+
+        const btVector3 shift =
+            btVector3(move[6 * m], move[6 * m + 1], move[6 * m + 2]) * m_meanLength;
+        const btVector3 rotation(move[6 * m + 3], move[6 * m + 4], move[6 * m + 5]);
+        const double angle = rotation.length();
+        for (std::size_t k = 0; k < body.points.size(); k++)
+        {
+            btVector3& position = m_position[body.points[k]];
+            btVector3 arm = position - centroid;
+            if (angle > 0.0)
+            {
+                arm = arm.rotate(rotation / angle, angle);
+            }
+            position = centroid + arm + shift;
+        }
+    }
+}
+
+namespace
+{
+    /**
+     * Solve a x = b in place for symmetric positive definite a, n by n
+     * and row major, by Cholesky decomposition
+     * @return false if a is not positive definite
+     */
+    bool choleskySolve(std::vector<double>& a, std::vector<double>& b,
+                       std::size_t n)
+    {
+        for (std::size_t j = 0; j < n; j++)
+        {
+            double diagonal = a[j * n + j];
+            for (std::size_t k = 0; k < j; k++)
+            {
+                diagonal -= a[j * n + k] * a[j * n + k];
+            }
+            if (!(diagonal > 0.0))
+            {
+                return false;
+            }
+            diagonal = std::sqrt(diagonal);
+            a[j * n + j] = diagonal;
+            for (std::size_t i = j + 1; i < n; i++)
+            {
+                double sum = a[i * n + j];
+                for (std::size_t k = 0; k < j; k++)
+                {
+                    sum -= a[i * n + k] * a[j * n + k];
+                }
+                a[i * n + j] = sum / diagonal;
+            }
+        }
+        for (std::size_t i = 0; i < n; i++)
+        {
+            for (std::size_t k = 0; k < i; k++)
+            {
+                b[i] -= a[i * n + k] * b[k];
+            }
+            b[i] /= a[i * n + i];
+        }
+        for (std::size_t i = n; i-- > 0; )
+        {
+            for (std::size_t k = i + 1; k < n; k++)
+            {
+                b[i] -= a[k * n + i] * b[k];
+            }
+            b[i] /= a[i * n + i];
+        }
+        return true;
+    }
+
+    double sumOfSquares(const std::vector<double>& v)
+    {
+        double result = 0.0;
+        for (std::size_t i = 0; i < v.size(); i++)
+        {
+            result += v[i] * v[i];
+        }
+        return result;
+    }
+}
+
+tgFormFinder::Result tgFormFinder::solve(tgStructure& structure,
+                                         tgBuildSpec& buildSpec)
+{
+    m_points.clear();
+    m_pointIndex.clear();
+    m_rigidFrom.clear();
+    m_rigidTo.clear();
+    m_rigidFixed.clear();
+    m_cables.clear();
+
+    collect(structure, buildSpec);
+    makeBodies();
+
+    m_movable.clear();
+    for (std::size_t b = 0; b < m_bodies.size(); b++)
+    {
+        if (!m_bodies[b].fixed && m_bodies[b].tension > 0.0)
+        {
+            m_movable.push_back(b);
+        }
+    }
+
+    Result result;
+    if (m_movable.empty())
+    {
+        result.converged = true;
+        return result;
+    }
+
+    m_meanLength = 0.0;
+    for (std::size_t c = 0; c < m_cables.size(); c++)
+    {
+        m_meanLength += (m_points[m_cables[c].to] - m_points[m_cables[c].from]).length();
+    }
+    m_meanLength /= m_cables.size();
+    if (m_meanLength == 0.0)
+    {
+        m_meanLength = 1.0;
+    }
+
+    // Levenberg-Marquardt over the movable bodies' six degrees of freedom
+    const std::size_t n = 6 * m_movable.size();
+    const double delta = 1e-7;
+    std::vector<double> residuals;
+    std::vector<double> trial;
+    std::vector<double> move(n, 0.0);
+    std::vector<double> jacobian(n * n);
+    std::vector<double> normal(n * n);
+    std::vector<double> gradient(n);
+    double damping = 1e-3;
+    for (result.iterations = 0; result.iterations < m_config.maxIterations;
+         result.iterations++)
+    {
+        result.residual = computeForces(residuals);
+        if (result.residual <= m_config.tolerance)
+        {
+            result.converged = true;
+            break;
+        }
+
+        // Column j of the Jacobian is the change in the residuals from
+        // a small move of degree of freedom j
+        m_start = m_position;
+        for (std::size_t j = 0; j < n; j++)
+        {
+            move.assign(n, 0.0);
+            move[j] = delta;
+            applyMove(move);
+            computeForces(trial);
+            for (std::size_t i = 0; i < n; i++)
+            {
+                jacobian[i * n + j] = (trial[i] - residuals[i]) / delta;
+            }
+        }
+
+        const double current = sumOfSquares(residuals);
+        bool improved = false;
+        while (!improved && damping < 1e12)
+        {
+            // (J^T J + damping diag) move = -J^T r
+            for (std::size_t i = 0; i < n; i++)
+            {
+                double g = 0.0;
+                for (std::size_t k = 0; k < n; k++)
+                {
+                    g += jacobian[k * n + i] * residuals[k];
+                }
+                gradient[i] = -g;
+                for (std::size_t j = 0; j <= i; j++)
+                {
+                    double sum = 0.0;
+                    for (std::size_t k = 0; k < n; k++)
+                    {
+                        sum += jacobian[k * n + i] * jacobian[k * n + j];
+                    }
+                    normal[i * n + j] = sum;
+                    normal[j * n + i] = sum;
+                }
+            }
+            for (std::size_t i = 0; i < n; i++)
+            {
+                // The absolute term keeps rigid motions of the whole
+                // structure, which change no force, from running away
+                normal[i * n + i] += damping * (normal[i * n + i] + 1.0);
+            }
+            move = gradient;
+            if (choleskySolve(normal, move, n))
+            {
+                double largest = 0.0;
+                for (std::size_t j = 0; j < n; j++)
+                {
+                    largest = std::max(largest, std::fabs(move[j]));
+                }
+                if (largest > m_config.stepSize)
+                {
+                    for (std::size_t j = 0; j < n; j++)
+                    {
+                        move[j] *= m_config.stepSize / largest;
+                    }
+                }
+                applyMove(move);
+                computeForces(trial);
+                improved = sumOfSquares(trial) < current;
+            }
+            if (improved)
+            {
+                damping = std::max(damping / 3.0, 1e-9);
+            }
+            else
+            {
+                damping *= 4.0;
+            }
+        }
+        if (!improved)
+        {
+            m_position = m_start;
+            result.residual = computeForces(residuals);
+            break;
+        }
+    }
+    // Keep the structure where it was built, if nothing held it there
+    bool anyFixed = false;
+    btVector3 drift(0.0, 0.0, 0.0);
+    for (std::size_t b = 0; b < m_bodies.size(); b++)
+    {
+        anyFixed = anyFixed || m_bodies[b].fixed;
+    }
+    if (!anyFixed)
+    {
+        for (std::size_t i = 0; i < m_points.size(); i++)
+        {
+            drift += m_position[i] - m_points[i];
+        }
+        drift /= m_points.size();
+    }
+
+    std::vector<btVector3> from;
+    std::vector<btVector3> to;
+    for (std::size_t i = 0; i < m_points.size(); i++)
+    {
+        const btVector3 position = m_position[i] - drift;
+        if (position != m_points[i])
+        {
+            from.push_back(m_points[i]);
+            to.push_back(position);
+        }
+    }
+    structure.movePoints(from, to);
+
+    return result;
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgFormFinder.h
+ * @brief Definition of class tgFormFinder
+ * $Id$
+ */
+
+#ifndef TG_FORM_FINDER_H
+#define TG_FORM_FINDER_H
+
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// Forward declarations
+class tgBuildSpec;
+class tgStructure;
+
+/**
+ * Moves a structure to its equilibrium shape before it is built, so a
+ * pretensioned model does not have to settle into it over the first
+ * steps of a trial.
+ *
+ * A cable is built with its Config::pretension at whatever length it is
+ * built at, so the shape wanted is one where those tensions balance.
+ * The pairs a build spec makes rigids of are grouped into bodies as
+ * tgRigidAutoCompound would, by shared nodes, and the connectors with a
+ * pretension pull on them with constant tensions. Each body's net force
+ * and torque are driven to zero by damped Gauss-Newton steps over the
+ * bodies' translations and rotations, with the Jacobian taken by finite
+ * differences. The total cable length is not minimized: with constant
+ * tensions most tensegrity equilibria are saddles of it, and descending
+ * it would fold the rods together. The equilibrium found is the one
+ * nearest the structure as given, so nodes placed roughly where they
+ * belong are only nudged. Bodies with no mass, such as rods of zero
+ * density, stay where they are.
+ *
+ * Gravity, the ground and collisions between rods are not considered:
+ * this finds the self-equilibrium of the tensegrity, not its resting
+ * pose. A structure with nothing to hold it open, such as cables with
+ * no rods between them, has no equilibrium and stops at maxIterations.
+ */
+class tgFormFinder
+{
+public:
+
+    struct Config
+    {
+        /**
+         * @param[in] tolerance the largest net force on a body, as a
+         * fraction of the tension on it, to accept; the torques are
+         * likewise relative to tension times the body's size
+         * @param[in] maxIterations to give up after
+         * @param[in] stepSize the largest move of a body in one step, as
+         * a fraction of the mean cable length or radians
+         */
+        Config(double tolerance = 1e-6,
+               std::size_t maxIterations = 200,
+               double stepSize = 0.1);
+
+        double tolerance;
+
+        std::size_t maxIterations;
+
+        double stepSize;
+    };
+
+    struct Result
+    {
+        Result() :
+        iterations(0),
+        residual(0.0),
+        converged(false)
+        {
+        }
+
+        std::size_t iterations;
+
+        /** The largest relative net force or torque at the end */
+        double residual;
+
+        bool converged;
+    };
+
+    tgFormFinder(const Config& config = Config());
+
+    /**
+     * Move the structure's nodes and pairs, and those of its children,
+     * to equilibrium. Pairs are classified as tgStructureInfo would:
+     * the last matching rigid factory makes a rigid, otherwise the last
+     * matching connector factory a connector.
+     * @param[in,out] structure moved with tgStructure::movePoints
+     * @param[in] buildSpec the spec the structure will be built with
+     * @return how the solve went; the structure is moved either way
+     */
+    Result solve(tgStructure& structure, tgBuildSpec& buildSpec);
+
+private:
+
+    struct Cable
+    {
+        std::size_t from;
+        std::size_t to;
+        double tension;
+    };
+
+    /** Orders points lexicographically, for m_pointIndex */
+    struct PointLess
+    {
+        bool operator()(const btVector3& a, const btVector3& b) const
+        {
+            if (a.x() != b.x()) return a.x() < b.x();
+            if (a.y() != b.y()) return a.y() < b.y();
+            return a.z() < b.z();
+        }
+    };
+
+    struct Body
+    {
+        std::vector<std::size_t> points;
+
+        /** The greatest distance of a point from the centroid */
+        double radius;
+
+        /** The summed tension of the cables attached */
+        double tension;
+
+        bool fixed;
+    };
+
+    /** Classify the pairs of one structure, then its children */
+    void collect(const tgStructure& structure, tgBuildSpec& buildSpec);
+
+    /** The index of a point, adding it if it is new */
+    std::size_t pointIndex(const btVector3& point);
+
+    /** Group the rigids into bodies and attach the cables to them */
+    void makeBodies();
+
+    /**
+     * Every body's net force and torque into m_force and m_torque, and
+     * those of the movable bodies into residuals, relative to their
+     * tension and size
+     * @return the largest relative net force or torque
+     */
+    double computeForces(std::vector<double>& residuals);
+
+    /**
+     * Set m_position to m_start with each movable body translated by
+     * move[6i..6i+2] mean cable lengths and rotated about its centroid
+     * by the rotation vector move[6i+3..6i+5]
+     */
+    void applyMove(const std::vector<double>& move);
+
+    Config m_config;
+
+    std::vector<btVector3> m_points;
+
+    std::map<btVector3, std::size_t, PointLess> m_pointIndex;
+
+    /** Rigid pairs and nodes, as point indices; from == to for a node */
+    std::vector<std::size_t> m_rigidFrom;
+    std::vector<std::size_t> m_rigidTo;
+    std::vector<bool> m_rigidFixed;
+
+    std::vector<Cable> m_cables;
+
+    std::vector<Body> m_bodies;
+
+    /** The bodies that are neither fixed nor free of cables */
+    std::vector<std::size_t> m_movable;
+
+    double m_meanLength;
+
+    /** Indexed like m_points: the body each is in */
+    std::vector<std::size_t> m_bodyOf;
+
+    std::vector<btVector3> m_position;
+    /** The positions at the start of the current step */
+    std::vector<btVector3> m_start;
+    std::vector<btVector3> m_pointForce;
+    std::vector<btVector3> m_force;
+    std::vector<btVector3> m_torque;
+    std::vector<btVector3> m_centroid;
+};
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+
+/**
+ * @file tgModelTemplate.cpp
+ * @brief Implementation of class tgModelTemplate
+ * $Id$
+ */
+
+// This module
+#include "tgModelTemplate.h"
+// This library
+#include "tgStructureInfo.h"
+
+tgModelTemplate::tgModelTemplate(tgStructure& structure, tgBuildSpec& buildSpec,
+                                 bool mergeRigids) :
+    m_pStructureInfo(new tgStructureInfo(structure, buildSpec))
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    m_pStructureInfo->setMergeRigids(mergeRigids);
+    m_pStructureInfo->resolve();
+}
+
+tgModelTemplate::~tgModelTemplate()
+{
+    delete m_pStructureInfo;
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void tgModelTemplate::instantiate(tgModel& model, tgWorld& world)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_pStructureInfo->instantiate(model, world);
+    pthread_mutex_unlock(&m_mutex);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+
+/**
+ * @file tgModelTemplate.h
+ * @brief Definition of class tgModelTemplate
+ * $Id$
+ */
+
+#ifndef TG_MODEL_TEMPLATE_H
+#define TG_MODEL_TEMPLATE_H
+
+// The C++ Standard Library
+#include <pthread.h>
+
+// Forward declarations
+class tgBuildSpec;
+class tgModel;
+class tgStructure;
+class tgStructureInfo;
+class tgWorld;
+
+/**
+ * A structure resolved against a build spec once, to be built into any
+ * number of worlds, such as the worlds of parallel rollouts. The
+ * factory lookups, rigid compounding and connector attachment of
+ * tgStructureInfo::buildInto are done by the constructor; instantiate
+ * then only creates the bodies, connectors and models of one world.
+ *
+ * The collision shapes of rods and spheres are already shared by every
+ * world through tgBulletShapeCache; compound shapes are created per
+ * world. instantiate may be called from several threads, but since the
+ * resolved infos record the world being built, calls are serialized.
+ */
+class tgModelTemplate
+{
+public:
+
+    /**
+     * Resolve a structure. Both must outlive the template.
+     * @param[in] structure the structure to build
+     * @param[in] buildSpec the factories and tag rules to build it with
+     * @param[in] mergeRigids as tgStructureInfo::setMergeRigids
+     */
+    tgModelTemplate(tgStructure& structure, tgBuildSpec& buildSpec,
+                    bool mergeRigids = false);
+
+    ~tgModelTemplate();
+
+    /**
+     * Build the structure into a model in a world, as
+     * tgStructureInfo::buildInto would.
+     * @param[in,out] model the model to add the built models to
+     * @param[in,out] world the world to create the bodies in
+     */
+    void instantiate(tgModel& model, tgWorld& world);
+
+private:
+
+    // Not copyable
+    tgModelTemplate(const tgModelTemplate&);
+    tgModelTemplate& operator=(const tgModelTemplate&);
+
+    tgStructureInfo* m_pStructureInfo;
+
+    /** Guards m_pStructureInfo during instantiate */
+    pthread_mutex_t m_mutex;
+};
+
+#endif
@@ -68,6 +68,7 @@ public:
         assertUniqueElements("All nodes must be unique.");
 
         // @todo: There has to be a better way to do this (maybe initializer lists with upcasting btVector3 => tgNode?) 
+        reserveElements(nodes.size());
         for(std::size_t i = 0; i < nodes.size(); i++) {
             addElement(tgNode(nodes[i]));
         }
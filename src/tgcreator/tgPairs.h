@@ -44,6 +44,7 @@ public:
     // tgPairs(std::vector<tgPair>& pairs) : tgTaggables(pairs) { // @todo: Fix this -- casting is a problem...
     tgPairs(std::vector<tgPair>& pairs) : tgTaggables() {
         // @todo: make sure each pair is unique
+        reserveElements(pairs.size());
         for(std::size_t i = 0; i < pairs.size(); i++) {
             addElement(pairs[i]);
         }
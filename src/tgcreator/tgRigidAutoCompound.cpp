@@ -29,13 +29,12 @@
 // Bullet Physics
 #include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
 #include "tgCompoundRigidInfo.h"
+#include "tgRigidNodeIndex.h"
 // The C++ standard library
-#include <map>
-#include <cstdlib> // for random number generator
+#include <memory>
+#include <set>
 #include <sstream> // for string streams, tags.
-// Boost
-#include <boost/random/random_device.hpp> // used for the random compound tag hash
-#include <boost/random/uniform_int_distribution.hpp> // used for the random compound tag hash
+#include <pthread.h>
 
 // Debugging
 #include <iostream>
@@ -43,14 +42,58 @@
 
 using namespace std;
 
+namespace
+{
+    // Structures may be built on several tgParallelSimulation threads at once
+    pthread_mutex_t s_tagMutex = PTHREAD_MUTEX_INITIALIZER;
+
+    std::size_t findRoot(std::vector<std::size_t>& parent, std::size_t i)
+    {
+        std::size_t root = i;
+        while (parent[root] != root) {
+            root = parent[root];
+        }
+        // Path compression
+        while (parent[i] != root) {
+            const std::size_t next = parent[i];
+            parent[i] = root;
+            i = next;
+        }
+        return root;
+    }
+
+    void unite(std::vector<std::size_t>& parent, std::size_t a, std::size_t b)
+    {
+        const std::size_t ra = findRoot(parent, a);
+        const std::size_t rb = findRoot(parent, b);
+        // Keep the earlier rigid as the root
+        if (ra < rb) {
+            parent[rb] = ra;
+        } else if (rb < ra) {
+            parent[ra] = rb;
+        }
+    }
+}
+
     
 // @todo: we want to start using this and get rid of the set-based constructor, but until we can refactor...
-tgRigidAutoCompound::tgRigidAutoCompound(std::vector<tgRigidInfo*> rigids)
+tgRigidAutoCompound::tgRigidAutoCompound(std::vector<tgRigidInfo*> rigids, bool mergeAll) :
+    m_mergeAll(mergeAll),
+    m_pIndex(NULL)
 {
     m_rigids.insert(m_rigids.end(), rigids.begin(), rigids.end());
 }
 
-tgRigidAutoCompound::tgRigidAutoCompound(std::deque<tgRigidInfo*> rigids) : m_rigids(rigids)
+tgRigidAutoCompound::tgRigidAutoCompound(std::deque<tgRigidInfo*> rigids, bool mergeAll) :
+    m_rigids(rigids),
+    m_mergeAll(mergeAll),
+    m_pIndex(NULL)
+{}
+
+tgRigidAutoCompound::tgRigidAutoCompound(const tgRigidNodeIndex& index, bool mergeAll) :
+    m_rigids(index.getRigids().begin(), index.getRigids().end()),
+    m_mergeAll(mergeAll),
+    m_pIndex(&index)
 {}
     
 std::vector< tgRigidInfo* > tgRigidAutoCompound::execute() {
@@ -87,49 +130,48 @@ void tgRigidAutoCompound::setRigidInfoForGroup(tgRigidInfo* rigidInfo, std::dequ
 
 void tgRigidAutoCompound::groupRigids()
 {
-    std::deque<tgRigidInfo*> ungrouped = std::deque<tgRigidInfo*>(m_rigids); // Copy of m_rigids
+    const std::size_t n = m_rigids.size();
 
-    while(ungrouped.size() > 0) {
-        // go through each ungrouped element and find the groups for it
-        tgRigidInfo* elem = ungrouped[0]; // Note: the 0 element is removed by findGroup, so ungrouped[0] is different each iteration
-
-        // Find all elements linked to the first item in ungrouped
-        // This will also remove the elements in the group from ungrouped
-        std::deque<tgRigidInfo*> group = findGroup(elem, ungrouped);
-
-        // Add the group to the groups list
-        m_groups.push_back(group);            
+    if (m_mergeAll) {
+        if (n > 0) {
+            m_groups.push_back(m_rigids);
+        }
+        return;
     }
-}
 
-// Find all rigids that should be in a group with the given rigid
-// @todo: This may contain an off-by-one error (the last rigid may not be grouped properly...)
-std::deque<tgRigidInfo*> tgRigidAutoCompound::findGroup(tgRigidInfo* rigid, std::deque<tgRigidInfo*>& ungrouped) {
+    // Union-find forest over indices into m_rigids
+    std::vector<std::size_t> parent(n);
+    for (std::size_t i = 0; i < n; i++) {
+        parent[i] = i;
+    }
 
-    std::deque<tgRigidInfo*> group;
+    // Rigids meeting at a node. Positions must match exactly, as in
+    // tgRigidInfo::sharesNodesWith.
+    std::auto_ptr<tgRigidNodeIndex> ownIndex;
+    const tgRigidNodeIndex* pIndex = m_pIndex;
+    if (pIndex == NULL) {
+        ownIndex.reset(new tgRigidNodeIndex(
+            std::vector<tgRigidInfo*>(m_rigids.begin(), m_rigids.end())));
+        pIndex = ownIndex.get();
+    }
+    const std::vector< std::pair<std::size_t, std::size_t> > shared =
+        pIndex->getSharedNodePairs();
+    for (std::size_t i = 0; i < shared.size(); i++) {
+        unite(parent, shared[i].first, shared[i].second);
+    }
 
-    // Add the rigid to the current group
-    group.push_back(rigid);     
-    
-    // Remove the rigid from the ungrouped since it's now in a group
-    ungrouped.erase(std::remove(ungrouped.begin(), ungrouped.end(), rigid), ungrouped.end());
-    
-    // Recursively find linked elements
-    int i = 0;
-    while(i < ungrouped.size()) {
-        tgRigidInfo* other = ungrouped[i];
-        if(rigid->sharesNodesWith(*other)) {
-            std::deque<tgRigidInfo*> links = findGroup(other, ungrouped);
-            group.insert(group.end(), links.begin(), links.end());
-            i = 0;
-        } else {
-            i++;
+    // Collect the groups, numbered in order of their first member
+    std::vector<std::size_t> groupOfRoot(n, n);
+    for (std::size_t i = 0; i < n; i++) {
+        const std::size_t root = findRoot(parent, i);
+        if (groupOfRoot[root] == n) {
+            groupOfRoot[root] = m_groups.size();
+            m_groups.push_back(std::deque<tgRigidInfo*>());
         }
+        m_groups[groupOfRoot[root]].push_back(m_rigids[i]);
     }
+}
 
-    return group;
-};
-    
 void tgRigidAutoCompound::createCompounds() {
     for(int i=0; i < m_groups.size(); i++) {
         std::deque<tgRigidInfo*>& group = m_groups[i];
@@ -143,12 +185,12 @@ void tgRigidAutoCompound::createCompounds() {
     }
 }
 
-tgRigidInfo* tgRigidAutoCompound::createCompound(std::deque<tgRigidInfo*> rigids) {
+tgRigidInfo* tgRigidAutoCompound::createCompound(const std::deque<tgRigidInfo*>& rigids) {
     tgCompoundRigidInfo* c = new tgCompoundRigidInfo();
     // Add an additional tag to this compound rigid info.
-    // This is of the form "compound_3qhA8L" for example.
+    // This is of the form "compound_00002A" for example.
     std::stringstream newtag;
-    newtag << "compound_" << random_tag_hash();
+    newtag << "compound_" << compound_tag_hash();
     for(int i = 0; i < rigids.size(); i++) {
       rigids[i]->addTags(newtag.str());
       c->addRigid(*rigids[i]);
@@ -156,7 +198,7 @@ tgRigidInfo* tgRigidAutoCompound::createCompound(std::deque<tgRigidInfo*> rigids
     return (tgRigidInfo*)c;
 }
 
-bool tgRigidAutoCompound::rigidBelongsIn(tgRigidInfo* rigid, std::deque<tgRigidInfo*> group) {
+bool tgRigidAutoCompound::rigidBelongsIn(tgRigidInfo* rigid, const std::deque<tgRigidInfo*>& group) {
     for(int i = 0; i < group.size(); i++) {
         tgRigidInfo* other = group[i];
         if(rigid->sharesNodesWith(*other))
@@ -165,43 +207,31 @@ bool tgRigidAutoCompound::rigidBelongsIn(tgRigidInfo* rigid, std::deque<tgRigidI
     return false;
 };
 
-std::string tgRigidAutoCompound::random_tag_hash() {
-  /**
-   * Many thanks to StackOverflow users Ates Goral and Mehrdad Afshari
-   * for a framework for this function.
-   * http://stackoverflow.com/questions/440133/how-do-i-create-a-random-alpha-numeric-string-in-c
-   *
-   * This function should generate a random string with a uniform distribution
-   * over the characters in the 'alphanum' char array below.
-   */
-  // Create the string (character array) to put the random characters into
-  size_t length = 6;
-  char s[length];
-
-  // The random number generator to pick characters out of the array
-  boost::random::random_device rng;
+std::string tgRigidAutoCompound::compound_tag_hash() {
+  // The next ID, shared by every build in the process so that compounds
+  // from different structures never share a tag
+  static unsigned long nextId = 0;
+  pthread_mutex_lock(&s_tagMutex);
+  unsigned long id = nextId++;
+  pthread_mutex_unlock(&s_tagMutex);
 
   // A constant variable for the chracters that will be chosen from
   static const char alphanum[] =
     "0123456789"
     "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-    "0123456789"
     "abcdefghijklmnopqrstuvwxyz";
-
-  // A uniform distribution over the indices into the character array
-  boost::random::uniform_int_distribution<> alphanum_dist(0, sizeof(alphanum) - 1);
-
-  // Insert a random one of these characters into the array
-  // Thanks to the Boost library random number generator tutorial,
-  // http://www.boost.org/doc/libs/1_62_0/doc/html/boost_random/tutorial.html
-  for (int i = 0; i < length; ++i) {
-    //s[i] = alphanum[rand() % (sizeof(alphanum) - 1)];
-    s[i] = alphanum[ alphanum_dist(rng) ];
+  const std::size_t base = sizeof(alphanum) - 1;
+
+  // Write the ID in base 62, most significant digit first
+  const std::size_t length = 6;
+  char s[length + 1];
+  for (std::size_t i = length; i > 0; --i) {
+    s[i - 1] = alphanum[id % base];
+    id /= base;
   }
 
   // set the string termination character
   s[length] = 0;
 
-  // Returning a character array is the same as returning a string.
   return s;
 }
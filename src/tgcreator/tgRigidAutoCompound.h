@@ -34,6 +34,7 @@
 
 // Forward declarations for Bullet Physics
 class tgRigidInfo;
+class tgRigidNodeIndex;
 class btCollisionObject;
 class btRigidBody;
 
@@ -47,10 +48,21 @@ class tgRigidAutoCompound {
 public:
 
 public:       
+    /**
+     * @param[in] rigids the rigids to compound
+     * @param[in] mergeAll put every rigid in one compound, whether or not
+     * they share nodes
+     */
     // @todo: we want to start using this and get rid of the set-based constructor, but until we can refactor...
-    tgRigidAutoCompound(std::vector<tgRigidInfo*> rigids);
+    tgRigidAutoCompound(std::vector<tgRigidInfo*> rigids, bool mergeAll = false);
     
-    tgRigidAutoCompound(std::deque<tgRigidInfo*> rigids);
+    tgRigidAutoCompound(std::deque<tgRigidInfo*> rigids, bool mergeAll = false);
+
+    /**
+     * Compound the rigids of an index, using it to find shared nodes.
+     * @param[in] index must outlive execute()
+     */
+    tgRigidAutoCompound(const tgRigidNodeIndex& index, bool mergeAll = false);
     
     ~tgRigidAutoCompound()
     {
@@ -66,36 +78,48 @@ protected:
    
     void setRigidInfoForGroup(tgRigidInfo* rigidInfo, std::deque<tgRigidInfo*>& group);
     
+    /**
+     * Sort m_rigids into m_groups of rigids linked by shared nodes. The
+     * pairs of rigids meeting at a node come from a tgRigidNodeIndex,
+     * m_pIndex or one built here, and are merged with union-find, so
+     * this is near-linear in the number of rigids. Groups are in order of their first rigid in m_rigids, and
+     * rigids within a group keep their m_rigids order. With m_mergeAll
+     * there is one group of every rigid.
+     */
     void groupRigids();
 
-    // Find all rigids that should be in a group with the given rigid
-    // @todo: This may contain an off-by-one error (the last rigid may not be grouped properly...)
-    std::deque<tgRigidInfo*> findGroup(tgRigidInfo* rigid, std::deque<tgRigidInfo*>& ungrouped);
-
     /**
      * Creates tgCompoundRigidInfos for compounded bodies.
      * Also, adds tags to each of the consitutent tgRigidInfos 
      * that designate what compound each of the models will belong to.
-     * These tags are in the form "compound_h8A0k2", where the second part
-     * is a random 6-digit alphanumeric hash via random_tag_hash().
+     * These tags are in the form "compound_00002A", where the second part
+     * is a 6-digit alphanumeric ID from compound_tag_hash().
      */
     void createCompounds();
     
-    tgRigidInfo* createCompound(std::deque<tgRigidInfo*> rigids);
+    tgRigidInfo* createCompound(const std::deque<tgRigidInfo*>& rigids);
     
-    bool rigidBelongsIn(tgRigidInfo* rigid, std::deque<tgRigidInfo*> group);
+    bool rigidBelongsIn(tgRigidInfo* rigid, const std::deque<tgRigidInfo*>& group);
 
     /**
      * For adding tags to compounded rigid bodies.
-     * This function generates a 6-digit alphanumeric hash.
-     * @return a 6-character string of random alphanumberic characters.
+     * This function returns the next of a process-wide sequence of IDs,
+     * so builds are reproducible and do not wait on system entropy.
+     * @return a 6-character string of alphanumberic characters, unique
+     * within the process
      */
-    std::string random_tag_hash();
+    std::string compound_tag_hash();
     
     // Doesn't look like we own these
     std::deque<tgRigidInfo*> m_rigids;
     std::vector< std::deque<tgRigidInfo*> > m_groups;
     std::vector< tgRigidInfo* > m_compounded;  // temporary set of compounded rigids. Same keys as m_groups
+    
+    // Compound everything, as for static scenery
+    const bool m_mergeAll;
+
+    // Built by the caller over m_rigids, or NULL
+    const tgRigidNodeIndex* m_pIndex;
 
 };
 
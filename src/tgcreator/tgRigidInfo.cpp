@@ -26,12 +26,14 @@
 // This module
 #include "tgRigidInfo.h"
 // This application
+#include "tgBodyBatch.h"
 #include "tgNode.h"
 #include "tgNodes.h"
 #include "tgPair.h"
 #include "tgPairs.h"
 // The NTRT Core Libary
 #include "core/tgBulletUtil.h"
+#include "core/tgRigidStateFrame.h"
 #include "core/tgTagSearch.h"
 #include "tgUtil.h"
 #include "core/tgBulletUtil.h"
@@ -42,6 +44,25 @@
 #include "btBulletDynamicsCommon.h"
 #include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
 
+// The C++ Standard Library
+#include <algorithm>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    /** Orders node positions lexicographically */
+    struct NodeLess
+    {
+        bool operator()(const btVector3& a, const btVector3& b) const
+        {
+            if (a.x() != b.x()) return a.x() < b.x();
+            if (a.y() != b.y()) return a.y() < b.y();
+            return a.z() < b.z();
+        }
+    };
+}
+
 tgRigidInfo* tgRigidInfo::createRigidInfo(const tgNode& node, const tgTagSearch& tagSearch)
 {
     // Our subclasses may not be able to create rigidInfos based on nodes. Also, the
@@ -110,17 +131,47 @@ void tgRigidInfo::initRigidBody(tgWorld& world)
                 btTransform transform = rigid->getTransform();
                 btCollisionShape* shape = rigid->getCollisionShape(world);
                 
+                // An open batch for this world adds the body with the rest
+                tgBodyBatch* const pBatch = tgBodyBatch::current();
+                const bool batched = pBatch != NULL && &pBatch->world() == &world;
+                // The motion state writes the pose into the world's frame,
+                // and the body sits next to the last one built
                 btRigidBody* body = 
-          tgBulletUtil::createRigidBody(&tgBulletUtil::worldToDynamicsWorld(world),
+          tgBulletUtil::createRigidBody(batched ? NULL : &tgBulletUtil::worldToDynamicsWorld(world),
                         mass,
                         transform,
-                        shape);
+                        shape,
+                        tgBulletUtil::worldToRigidStateFrame(world).createMotionState(transform),
+                        &tgBulletUtil::worldToBodyArena(world));
                 body->setFlags(BT_ENABLE_GYROPSCOPIC_FORCE);
                 rigid->setRigidBody(body);
+                if (batched)
+                {
+                    pBatch->add(body);
+                }
             }
         }
     }
 
+void tgRigidInfo::setContinuousCollision(double motionThreshold,
+                                         double sweptSphereRadius)
+{
+    btRigidBody* const body = getRigidBody();
+    if (body == NULL || !(motionThreshold > 0.0))
+    {
+        return;
+    }
+    if (body->getCcdMotionThreshold() > 0.0)
+    {
+        motionThreshold = std::min<double>(motionThreshold,
+                                           body->getCcdMotionThreshold());
+        sweptSphereRadius = std::min<double>(sweptSphereRadius,
+                                             body->getCcdSweptSphereRadius());
+    }
+    body->setCcdMotionThreshold(motionThreshold);
+    body->setCcdSweptSphereRadius(sweptSphereRadius);
+}
+
 btRigidBody* tgRigidInfo::getRigidBody() 
 { 
 	btRigidBody* body = tgCast::cast<btCollisionObject, btRigidBody>(m_collisionObject);
@@ -142,23 +193,14 @@ bool tgRigidInfo::sharesNodesWith(const tgRigidInfo& other) const
 {
     const std::set<btVector3> s1 = getContainedNodes();
     const std::set<btVector3> s2 = other.getContainedNodes();
-#if (0)
-    // This would have been preferable, but the compiler barfs
-    std::set<btVector3> intersection;
-    // Ignore the return value
-    std::set_intersection(s1.begin(), s1.end(),
-                          s2.begin(), s2.end(),
-                          intersection.begin());
-    return intersection.empty();
-#else    
+    // std::set<btVector3> orders by address, so look for each of s1's
+    // nodes in a copy of s2 sorted by position
+    std::vector<btVector3> sorted(s2.begin(), s2.end());
+    std::sort(sorted.begin(), sorted.end(), NodeLess());
     std::set<btVector3>::const_iterator ii;
-    std::set<btVector3>::const_iterator ij;
     for (ii = s1.begin(); ii != s1.end(); ++ii) {
-        for (ij = s2.begin(); ij != s2.end(); ++ij) {
-            if (*ii == *ij)
-                return true;                
-        }
+        if (std::binary_search(sorted.begin(), sorted.end(), *ii, NodeLess()))
+            return true;
     }
     return false;
-#endif
 }
@@ -30,6 +30,7 @@
 // The C++ Standard Library
 #include <set>
 // This library
+#include "tgBuildArena.h"
 #include "core/tgTaggable.h"
 #include "core/tgModel.h"
 //Bullet Physics
@@ -74,6 +75,18 @@ class btTransform;
  */ 
 class tgRigidInfo : public tgTaggable {
 public:
+
+    /** Allocated from the tgBuildArena of the build, if there is one */
+    static void* operator new(std::size_t size)
+    {
+        return tgBuildArena::allocate(size);
+    }
+
+    static void operator delete(void* p)
+    {
+        tgBuildArena::deallocate(p);
+    }
+
         
     tgRigidInfo() : 
         tgTaggable(),
@@ -182,7 +195,30 @@ public:
      * @param[in,out] a pointer to a btRigidBody
      */
     virtual void setRigidBody(btRigidBody* rigidBody);
+
+    /**
+     * Turn on Bullet's continuous collision detection for the rigid
+     * body, once it has been initialized. Rigids compounded into one
+     * body each call this, so the body keeps the smallest threshold
+     * and swept sphere asked for.
+     * @param[in] motionThreshold sweep the body when it moves further
+     * than this in one step; zero or less does nothing
+     * @param[in] sweptSphereRadius the radius of the swept sphere
+     */
+    void setContinuousCollision(double motionThreshold,
+                                double sweptSphereRadius);
     
+    /**
+     * Forget the shape and body of the world this was last built into,
+     * so it can be built into another (see tgModelTemplate). They still
+     * belong to that world, which deletes them.
+     */
+    virtual void forgetWorld()
+    {
+        m_collisionShape = NULL;
+        m_collisionObject = NULL;
+    }
+
     /**
      * Return a pointer to the collisionObject without upcasting
      * @return a pointer to the corresponding btCollisionObject
@@ -311,6 +347,16 @@ public:
      */
     virtual std::set<btVector3> getContainedNodes() const = 0;
 
+    /**
+     * Is containsNode true only for the nodes in getContainedNodes()?
+     * tgRigidNodeIndex asks rigids for which this is false about every
+     * point.
+     */
+    virtual bool containsOnlyListedNodes() const
+    {
+        return true;
+    }
+
     /**
      * Does this rigid have any nodes in common with the given tgRigidInfo object?
      * @param]in] other a reference to a tgRigidInfo object
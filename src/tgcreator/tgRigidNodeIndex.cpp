@@ -0,0 +1,149 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRigidNodeIndex.cpp
+ * @brief Implementation of class tgRigidNodeIndex
+ * $Id$
+ */
+
+#include "tgRigidNodeIndex.h"
+#include "tgRigidInfo.h"
+
+const double tgRigidNodeIndex::cellSize = 1e-4;
+
+tgRigidNodeIndex::tgRigidNodeIndex(const std::vector<tgRigidInfo*>& rigids) :
+m_rigids(rigids),
+m_nodes(rigids.size())
+{
+    for (std::size_t i = 0; i < rigids.size(); i++)
+    {
+        tgRigidInfo* const pRigid = rigids[i];
+        if (!pRigid->containsOnlyListedNodes())
+        {
+            m_unlisted.push_back(pRigid);
+        }
+        // Unlisted rigids are indexed too, for getSharedNodePairs
+        const std::set<btVector3> nodes = pRigid->getContainedNodes();
+        m_nodes[i].assign(nodes.begin(), nodes.end());
+        for (std::size_t n = 0; n < m_nodes[i].size(); n++)
+        {
+            Entry e;
+            e.node = m_nodes[i][n];
+            e.rigid = i;
+            m_cells[cellOf(e.node)].push_back(e);
+        }
+    }
+}
+
+std::set<tgRigidInfo*>
+tgRigidNodeIndex::findRigidsContaining(const btVector3& v) const
+{
+    // The cells of v +/- half a cell on each axis. A node within
+    // containsNode's tolerance of v is in one of them.
+    const double h = 0.5 * cellSize;
+    const long xs[2] = { quantize(v.x() - h), quantize(v.x() + h) };
+    const long ys[2] = { quantize(v.y() - h), quantize(v.y() + h) };
+    const long zs[2] = { quantize(v.z() - h), quantize(v.z() + h) };
+
+    std::set<tgRigidInfo*> found;
+    for (int i = 0; i < 2; i++)
+    {
+        if (i == 1 && xs[1] == xs[0]) break;
+        for (int j = 0; j < 2; j++)
+        {
+            if (j == 1 && ys[1] == ys[0]) break;
+            for (int k = 0; k < 2; k++)
+            {
+                if (k == 1 && zs[1] == zs[0]) break;
+                Cell c;
+                c.x = xs[i];
+                c.y = ys[j];
+                c.z = zs[k];
+                const CellMap::const_iterator it = m_cells.find(c);
+                if (it == m_cells.end())
+                {
+                    continue;
+                }
+                const std::vector<Entry>& cell = it->second;
+                for (std::size_t e = 0; e < cell.size(); e++)
+                {
+                    tgRigidInfo* const pRigid = m_rigids[cell[e].rigid];
+                    if (pRigid->containsNode(v))
+                    {
+                        found.insert(pRigid);
+                    }
+                }
+            }
+        }
+    }
+
+    for (std::size_t r = 0; r < m_unlisted.size(); r++)
+    {
+        if (m_unlisted[r]->containsNode(v))
+        {
+            found.insert(m_unlisted[r]);
+        }
+    }
+    return found;
+}
+
+bool tgRigidNodeIndex::sharesNodes(std::size_t a, std::size_t b) const
+{
+    const std::vector<btVector3>& nodes = m_nodes[a];
+    for (std::size_t n = 0; n < nodes.size(); n++)
+    {
+        const CellMap::const_iterator it = m_cells.find(cellOf(nodes[n]));
+        const std::vector<Entry>& cell = it->second;
+        for (std::size_t e = 0; e < cell.size(); e++)
+        {
+            if (cell[e].rigid == b && cell[e].node == nodes[n])
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::vector< std::pair<std::size_t, std::size_t> >
+tgRigidNodeIndex::getSharedNodePairs() const
+{
+    std::vector< std::pair<std::size_t, std::size_t> > pairs;
+    for (CellMap::const_iterator it = m_cells.begin(); it != m_cells.end(); ++it)
+    {
+        const std::vector<Entry>& cell = it->second;
+        // Entries were added in rigid order, so the first at a position
+        // is the lowest rigid there
+        for (std::size_t e = 1; e < cell.size(); e++)
+        {
+            for (std::size_t f = 0; f < e; f++)
+            {
+                if (cell[f].node == cell[e].node)
+                {
+                    if (cell[f].rigid != cell[e].rigid)
+                    {
+                        pairs.push_back(std::make_pair(cell[f].rigid, cell[e].rigid));
+                    }
+                    break;
+                }
+            }
+        }
+    }
+    return pairs;
+}
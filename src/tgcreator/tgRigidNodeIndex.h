@@ -0,0 +1,149 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_RIGID_NODE_INDEX_H
+#define TG_RIGID_NODE_INDEX_H
+
+/**
+ * @file tgRigidNodeIndex.h
+ * @brief Definition of class tgRigidNodeIndex
+ * $Id$
+ */
+
+#include "LinearMath/btVector3.h"
+
+// The C++ Standard Library
+#include <cmath>
+#include <cstddef>
+#include <set>
+#include <utility>
+#include <vector>
+#include <tr1/unordered_map>
+
+class tgRigidInfo;
+
+/**
+ * Finds the rigids containing a point without asking every rigid. Built
+ * once per build from each rigid's getContainedNodes(), the nodes are
+ * hashed by their position quantized to a grid of cellSize. A query
+ * probes the cells within half a cell of the point, at most eight, and
+ * confirms each rigid found there with containsNode(), so the answer is
+ * the one a scan of every rigid would give.
+ *
+ * Rigids that contain points they do not list, like the surface anchors
+ * of a tgBoxMoreAnchorsInfo, are tested on every query.
+ *
+ * The same index finds the rigids that share nodes for
+ * tgRigidAutoCompound, since equal positions always land in one cell.
+ */
+class tgRigidNodeIndex
+{
+public:
+
+    /**
+     * The grid spacing. Much larger than the tolerance of containsNode,
+     * and much smaller than the distance between distinct nodes.
+     */
+    static const double cellSize;
+
+    tgRigidNodeIndex(const std::vector<tgRigidInfo*>& rigids);
+
+    /**
+     * The rigids for which containsNode(v) is true
+     */
+    std::set<tgRigidInfo*> findRigidsContaining(const btVector3& v) const;
+
+    /**
+     * Does one of a's nodes exactly equal one of b's? As
+     * tgRigidInfo::sharesNodesWith, for rigids of this index.
+     */
+    bool sharesNodes(std::size_t a, std::size_t b) const;
+
+    /**
+     * Every (i, j) with i < j such that rigids i and j share a node
+     * position exactly, where the first rigid at the position is i.
+     * Linking each pair links every rigid at a node, in time linear in
+     * the number of nodes.
+     */
+    std::vector< std::pair<std::size_t, std::size_t> > getSharedNodePairs() const;
+
+    const std::vector<tgRigidInfo*>& getRigids() const
+    {
+        return m_rigids;
+    }
+
+private:
+
+    struct Cell
+    {
+        long x;
+        long y;
+        long z;
+
+        bool operator==(const Cell& other) const
+        {
+            return x == other.x && y == other.y && z == other.z;
+        }
+    };
+
+    struct CellHash
+    {
+        std::size_t operator()(const Cell& c) const
+        {
+            return (std::size_t) c.x * 73856093u ^
+                   (std::size_t) c.y * 19349663u ^
+                   (std::size_t) c.z * 83492791u;
+        }
+    };
+
+    /** A node of a rigid, by its index in m_rigids */
+    struct Entry
+    {
+        btVector3 node;
+        std::size_t rigid;
+    };
+
+    typedef std::tr1::unordered_map<Cell, std::vector<Entry>, CellHash>
+        CellMap;
+
+    static Cell cellOf(const btVector3& v)
+    {
+        Cell c;
+        c.x = quantize(v.x());
+        c.y = quantize(v.y());
+        c.z = quantize(v.z());
+        return c;
+    }
+
+    static long quantize(double x)
+    {
+        return (long) std::floor(x / cellSize);
+    }
+
+    std::vector<tgRigidInfo*> m_rigids;
+
+    CellMap m_cells;
+
+    /** The nodes of each rigid, as getContainedNodes() at construction */
+    std::vector< std::vector<btVector3> > m_nodes;
+
+    /** Rigids that must be asked about every point */
+    std::vector<tgRigidInfo*> m_unlisted;
+};
+
+#endif
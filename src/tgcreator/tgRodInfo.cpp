@@ -76,6 +76,8 @@ void tgRodInfo::initRigidBody(tgWorld& world)
     getRigidBody()->setFriction(m_config.friction);
     getRigidBody()->setRollingFriction(m_config.rollFriction);
     getRigidBody()->setRestitution(m_config.restitution);
+    setContinuousCollision(m_config.getCcdMotionThreshold(),
+                           m_config.getCcdSweptSphereRadius());
 }
 
 tgModel* tgRodInfo::createModel(tgWorld& world)
@@ -102,13 +104,12 @@ btCollisionShape* tgRodInfo::getCollisionShape(tgWorld& world) const
     {
         const double radius = m_config.radius;
         const double length = getLength();
-        m_collisionShape =
-            new btCylinderShape(btVector3(radius, length / 2.0, radius));
-    
-        // Add the collision shape to the array so we can delete it later
+        // Rods of the same radius and length share one shape, which the
+        // world gives back when it is destroyed
         tgWorldBulletPhysicsImpl& bulletWorld =
       (tgWorldBulletPhysicsImpl&)world.implementation();
-        bulletWorld.addCollisionShape(m_collisionShape);
+        m_collisionShape =
+            bulletWorld.sharedCylinderShape(btVector3(radius, length / 2.0, radius));
     }
     return m_collisionShape;
 }
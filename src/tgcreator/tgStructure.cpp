@@ -32,8 +32,314 @@
 // The Bullet Physics library
 #include <LinearMath/btQuaternion.h>
 #include <LinearMath/btVector3.h>
+// The C++ Standard Library
+#include <deque>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    /**
+     * Orders positions lexicographically. Positions must match exactly,
+     * as with btVector3::operator==.
+     */
+    struct VectorLess
+    {
+        bool operator()(const btVector3& a, const btVector3& b) const
+        {
+            if (a.x() != b.x()) return a.x() < b.x();
+            if (a.y() != b.y()) return a.y() < b.y();
+            return a.z() < b.z();
+        }
+    };
+
+    /** The (from, to) of a pair */
+    typedef std::pair<btVector3, btVector3> PairKey;
+
+    struct PairKeyLess
+    {
+        bool operator()(const PairKey& a, const PairKey& b) const
+        {
+            VectorLess less;
+            if (less(a.first, b.first)) return true;
+            if (less(b.first, a.first)) return false;
+            return less(a.second, b.second);
+        }
+    };
+
+    /**
+     * The entries for the rarest of the given tags, or NULL if there are
+     * no tags or one of them is not in the table.
+     */
+    template <typename T>
+    const std::vector<T>* rarest(const std::map<std::string, std::vector<T> >& byTag,
+                                 const std::deque<std::string>& tags)
+    {
+        const std::vector<T>* pRarest = NULL;
+        for (std::size_t i = 0; i < tags.size(); ++i)
+        {
+            typename std::map<std::string, std::vector<T> >::const_iterator it =
+                byTag.find(tags[i]);
+            if (it == byTag.end())
+            {
+                return NULL;
+            }
+            if (pRarest == NULL || it->second.size() < pRarest->size())
+            {
+                pRarest = &it->second;
+            }
+        }
+        return pRarest;
+    }
+}
+
+struct tgStructure::Index
+{
+    /**
+     * A node or pair, held as its owner and its index there so that
+     * appending to the owner does not invalidate it.
+     */
+    struct Ref
+    {
+        Ref(tgStructure* s, int i) : pStructure(s), index(i) {}
+        tgStructure* pStructure;
+        int index;
+    };
+
+    Index() : nodesBuilt(false), pairsBuilt(false), childrenBuilt(false) {}
+
+    /** BFS over root and its descendants, as the searches do */
+    void buildNodes(tgStructure& root)
+    {
+        nodesByTag.clear();
+        std::queue<tgStructure*> q;
+        q.push(&root);
+        while (!q.empty()) {
+            tgStructure* structure = q.front();
+            q.pop();
+            structure->materialize();
+            for (int i = 0; i < structure->m_nodes.size(); i++) {
+                addNode(structure, i, nodesByTag);
+            }
+            for (int i = 0; i < structure->m_children.size(); i++) {
+                q.push(structure->m_children[i]);
+            }
+        }
+        nodesBuilt = true;
+    }
+
+    void buildPairs(tgStructure& root)
+    {
+        pairsByEnds.clear();
+        std::queue<tgStructure*> q;
+        q.push(&root);
+        while (!q.empty()) {
+            tgStructure* structure = q.front();
+            q.pop();
+            structure->materialize();
+            for (int i = 0; i < structure->m_pairs.size(); i++) {
+                const tgPair& pair = structure->m_pairs[i];
+                // insert keeps the first, which is the one BFS finds
+                pairsByEnds.insert(std::make_pair(
+                    PairKey(pair.getFrom(), pair.getTo()), Ref(structure, i)));
+                pairsByEnds.insert(std::make_pair(
+                    PairKey(pair.getTo(), pair.getFrom()), Ref(structure, i)));
+            }
+            for (int i = 0; i < structure->m_children.size(); i++) {
+                q.push(structure->m_children[i]);
+            }
+        }
+        pairsBuilt = true;
+    }
+
+    void buildChildren(tgStructure& root)
+    {
+        childrenByTag.clear();
+        std::queue<tgStructure*> q;
+        root.materialize();
+        for (int i = 0; i < root.m_children.size(); i++) {
+            q.push(root.m_children[i]);
+        }
+        while (!q.empty()) {
+            tgStructure* structure = q.front();
+            q.pop();
+            structure->materialize();
+            const std::deque<std::string>& tags = structure->getTags().getTags();
+            for (std::size_t j = 0; j < tags.size(); j++) {
+                childrenByTag[tags[j]].push_back(structure);
+            }
+            for (int i = 0; i < structure->m_children.size(); i++) {
+                q.push(structure->m_children[i]);
+            }
+        }
+        childrenBuilt = true;
+    }
+
+    /**
+     * Account for a node appended to root's own nodes. Those come first
+     * in BFS order, so it goes after the others root owns.
+     */
+    void addOwnNode(tgStructure& root, int i)
+    {
+        if (!nodesBuilt) {
+            return;
+        }
+        const std::deque<std::string>& tags = root.m_nodes[i].getTags().getTags();
+        for (std::size_t j = 0; j < tags.size(); j++) {
+            std::vector<Ref>& refs = nodesByTag[tags[j]];
+            std::vector<Ref>::iterator it = refs.begin();
+            while (it != refs.end() && it->pStructure == &root) {
+                ++it;
+            }
+            refs.insert(it, Ref(&root, i));
+        }
+    }
+
+    /**
+     * Account for a pair appended to root's own pairs. It comes before
+     * any pair of a descendant but after the others root owns.
+     */
+    void addOwnPair(tgStructure& root, int i)
+    {
+        if (!pairsBuilt) {
+            return;
+        }
+        const tgPair& pair = root.m_pairs[i];
+        const PairKey keys[2] = { PairKey(pair.getFrom(), pair.getTo()),
+                                  PairKey(pair.getTo(), pair.getFrom()) };
+        for (int k = 0; k < 2; k++) {
+            std::map<PairKey, Ref, PairKeyLess>::iterator it = pairsByEnds.find(keys[k]);
+            if (it == pairsByEnds.end()) {
+                pairsByEnds.insert(std::make_pair(keys[k], Ref(&root, i)));
+            } else if (it->second.pStructure != &root) {
+                it->second = Ref(&root, i);
+            }
+        }
+    }
+
+    static void addNode(tgStructure* structure, int i,
+                        std::map<std::string, std::vector<Ref> >& byTag)
+    {
+        const std::deque<std::string>& tags =
+            structure->m_nodes[i].getTags().getTags();
+        for (std::size_t j = 0; j < tags.size(); j++) {
+            byTag[tags[j]].push_back(Ref(structure, i));
+        }
+    }
+
+    bool nodesBuilt;
+    /** For each tag, the nodes carrying it in BFS order */
+    std::map<std::string, std::vector<Ref> > nodesByTag;
+
+    bool pairsBuilt;
+    /** The first pair in BFS order with each (from, to), both ways round */
+    std::map<PairKey, Ref, PairKeyLess> pairsByEnds;
+
+    bool childrenBuilt;
+    /** For each tag, the descendants carrying it in BFS order */
+    std::map<std::string, std::vector<tgStructure*> > childrenByTag;
+};
+
+struct tgStructure::Snapshot
+{
+    Snapshot() : refs(1) {}
+
+    ~Snapshot()
+    {
+        for (std::size_t i = 0; i < children.size(); ++i)
+        {
+            delete children[i];
+        }
+    }
+
+    static void release(Snapshot* pSnapshot)
+    {
+        if (pSnapshot != NULL && --pSnapshot->refs == 0)
+        {
+            delete pSnapshot;
+        }
+    }
+
+    tgNodes nodes;
+
+    tgPairs pairs;
+
+    /** Copies of the children, so themselves shared; we own these */
+    std::vector<tgStructure*> children;
+
+    /**
+     * The structure it was taken of, while that has not changed, and
+     * every Deferred made from it. Not thread safe.
+     */
+    int refs;
+
+private:
+    Snapshot(const Snapshot&);
+    Snapshot& operator=(const Snapshot&);
+};
+
+struct tgStructure::Deferred
+{
+    /** A move, addRotation or scale that has not been applied yet */
+    struct Transform
+    {
+        enum Kind
+        {
+            eMove,
+            eRotate,
+            eScale
+        };
+
+        Kind kind;
+
+        /** The offset, fixed point or reference point */
+        btVector3 point;
+
+        btQuaternion rotation;
+
+        double scaleFactor;
+    };
+
+    Deferred(Snapshot* pSnapshot) : pSnapshot(pSnapshot)
+    {
+        ++pSnapshot->refs;
+    }
+
+    Deferred(const Deferred& other) :
+        pSnapshot(other.pSnapshot),
+        transforms(other.transforms)
+    {
+        ++pSnapshot->refs;
+    }
+
+    ~Deferred()
+    {
+        Snapshot::release(pSnapshot);
+    }
+
+    void add(Transform::Kind kind, const btVector3& point,
+             const btQuaternion& rotation, double scaleFactor)
+    {
+        Transform t;
+        t.kind = kind;
+        t.point = point;
+        t.rotation = rotation;
+        t.scaleFactor = scaleFactor;
+        transforms.push_back(t);
+    }
+
+    Snapshot* const pSnapshot;
+
+    /** In the order they were asked for */
+    std::vector<Transform> transforms;
+
+private:
+    Deferred& operator=(const Deferred&);
+};
  
-tgStructure::tgStructure() : tgTaggable() 
+tgStructure::tgStructure() : tgTaggable(),
+        m_pParent(NULL), m_pIndex(new Index()), m_pDeferred(NULL), m_pSnapshot(NULL)
 {
 }
 
@@ -42,20 +348,38 @@ tgStructure::tgStructure() : tgTaggable()
  * Copy constructor
  */
 tgStructure::tgStructure(const tgStructure& orig) : tgTaggable(orig.getTags()), 
-        m_children(orig.m_children.size()), m_nodes(orig.m_nodes), m_pairs(orig.m_pairs)
+        m_pParent(NULL), m_pIndex(new Index()), m_pDeferred(orig.share()), m_pSnapshot(NULL)
 {
-    
-    // Copy children
-    for (std::size_t i = 0; i < orig.m_children.size(); ++i) {
-        m_children[i] = new tgStructure(*orig.m_children[i]);
+    // Nodes, pairs and children are made from the snapshot when needed
+}
+
+tgStructure& tgStructure::operator=(const tgStructure& orig)
+{
+    if (this != &orig) {
+        // orig may be one of our descendants, so take what we need first
+        const tgTags tags = orig.getTags();
+        Deferred* const pDeferred = orig.share();
+        for (std::size_t i = 0; i < m_children.size(); ++i) {
+            delete m_children[i];
+        }
+        m_children.clear();
+        m_nodes = tgNodes();
+        m_pairs = tgPairs();
+        delete m_pDeferred;
+        m_pDeferred = pDeferred;
+        setTags(tags);
+        invalidateIndex(true, true, true);
     }
+    return *this;
 }
 
-tgStructure::tgStructure(const tgTags& tags) : tgTaggable(tags)
+tgStructure::tgStructure(const tgTags& tags) : tgTaggable(tags),
+        m_pParent(NULL), m_pIndex(new Index()), m_pDeferred(NULL), m_pSnapshot(NULL)
 {
 }
 
-tgStructure::tgStructure(const std::string& space_separated_tags) : tgTaggable(space_separated_tags)
+tgStructure::tgStructure(const std::string& space_separated_tags) : tgTaggable(space_separated_tags),
+        m_pParent(NULL), m_pIndex(new Index()), m_pDeferred(NULL), m_pSnapshot(NULL)
 {
 }
 
@@ -65,30 +389,116 @@ tgStructure::~tgStructure()
     {
         delete m_children[i];
     }
+    delete m_pIndex;
+    delete m_pDeferred;
+    Snapshot::release(m_pSnapshot);
+}
+
+tgStructure::Deferred* tgStructure::share() const
+{
+    if (m_pDeferred != NULL)
+    {
+        // A copy of a copy
+        return new Deferred(*m_pDeferred);
+    }
+    if (m_pSnapshot == NULL)
+    {
+        m_pSnapshot = new Snapshot();
+        m_pSnapshot->nodes = m_nodes;
+        m_pSnapshot->pairs = m_pairs;
+        for (std::size_t i = 0; i < m_children.size(); ++i)
+        {
+            m_pSnapshot->children.push_back(new tgStructure(*m_children[i]));
+        }
+    }
+    return new Deferred(m_pSnapshot);
+}
+
+void tgStructure::instantiate()
+{
+    Deferred* const pDeferred = m_pDeferred;
+    assert(pDeferred != NULL);
+    m_pDeferred = NULL;
+
+    const Snapshot& snapshot = *pDeferred->pSnapshot;
+    m_nodes = snapshot.nodes;
+    m_pairs = snapshot.pairs;
+    for (std::size_t i = 0; i < snapshot.children.size(); ++i)
+    {
+        tgStructure* const pChild = new tgStructure(*snapshot.children[i]);
+        pChild->m_pParent = this;
+        m_children.push_back(pChild);
+    }
+
+    // Apply the transforms in order, so the positions come out exactly
+    // as if they had been applied to a deep copy
+    const std::vector<Deferred::Transform>& transforms = pDeferred->transforms;
+    for (std::size_t i = 0; i < transforms.size(); ++i)
+    {
+        const Deferred::Transform& t = transforms[i];
+        switch (t.kind)
+        {
+        case Deferred::Transform::eMove:
+            move(t.point);
+            break;
+        case Deferred::Transform::eRotate:
+            addRotation(t.point, t.rotation);
+            break;
+        case Deferred::Transform::eScale:
+            scale(t.point, t.scaleFactor);
+            break;
+        }
+    }
+    delete pDeferred;
+}
+
+void tgStructure::releaseSnapshot() const
+{
+    for (const tgStructure* p = this; p != NULL; p = p->m_pParent)
+    {
+        Snapshot::release(p->m_pSnapshot);
+        p->m_pSnapshot = NULL;
+    }
 }
 
 void tgStructure::addNode(double x, double y, double z, std::string tags)
 {
-    m_nodes.addNode(x, y, z, tags);
+    materialize();
+    const int i = m_nodes.addNode(x, y, z, tags);
+    m_pIndex->addOwnNode(*this, i);
+    if (m_pParent != NULL) {
+        m_pParent->invalidateIndex(true, false, false);
+    }
 }
 
 void tgStructure::addNode(tgNode& newNode)
 {
-    m_nodes.addNode(newNode);
+    materialize();
+    const int i = m_nodes.addNode(newNode);
+    m_pIndex->addOwnNode(*this, i);
+    if (m_pParent != NULL) {
+        m_pParent->invalidateIndex(true, false, false);
+    }
 }
 
 void tgStructure::addPair(int fromNodeIdx, int toNodeIdx, std::string tags)
 {
+    materialize();
     addPair(m_nodes[fromNodeIdx], m_nodes[toNodeIdx], tags);
 }
 
 void tgStructure::addPair(const btVector3& from, const btVector3& to, std::string tags)
 {
+    materialize();
     // @todo: do we need to pass in tags here? might be able to save some proc time if not...
     tgPair p = tgPair(from, to);
     if (!m_pairs.contains(p))
     {
-        m_pairs.addPair(tgPair(from, to, tags));
+        const int i = m_pairs.addPair(tgPair(from, to, tags));
+        m_pIndex->addOwnPair(*this, i);
+        if (m_pParent != NULL) {
+            m_pParent->invalidateIndex(false, true, false);
+        }
     }
     else
     {
@@ -99,7 +509,9 @@ void tgStructure::addPair(const btVector3& from, const btVector3& to, std::strin
 }
 
 void tgStructure::removePair(const tgPair& pair) {
+    materialize();
     m_pairs.removePair(pair);
+    invalidateIndex(false, true, false);
     for (unsigned int i = 0; i < m_children.size(); i++) {
         m_children[i]->removePair(pair);
     }
@@ -107,8 +519,16 @@ void tgStructure::removePair(const tgPair& pair) {
 
 void tgStructure::move(const btVector3& offset)
 {
+    if (m_pDeferred != NULL)
+    {
+        m_pDeferred->add(Deferred::Transform::eMove, offset,
+                         btQuaternion::getIdentity(), 1.0);
+        invalidateIndex(false, true, false);
+        return;
+    }
     m_nodes.move(offset);
     m_pairs.move(offset);
+    invalidateIndex(false, true, false);
     for (size_t i = 0; i < m_children.size(); ++i)
     {
         tgStructure * const pStructure = m_children[i];
@@ -117,6 +537,60 @@ void tgStructure::move(const btVector3& offset)
     }
 }
 
+void tgStructure::movePoints(const std::vector<btVector3>& from,
+                             const std::vector<btVector3>& to)
+{
+    if (from.size() != to.size())
+    {
+        throw std::invalid_argument("Point lists differ in size");
+    }
+    std::map<btVector3, btVector3, VectorLess> moves;
+    for (std::size_t i = 0; i < from.size(); i++)
+    {
+        moves[from[i]] = to[i];
+    }
+
+    std::deque<tgStructure*> queue(1, this);
+    while (!queue.empty())
+    {
+        tgStructure* const pStructure = queue.front();
+        queue.pop_front();
+        pStructure->materialize();
+
+        std::vector<tgNode>& nodes = pStructure->m_nodes.getNodes();
+        for (std::size_t i = 0; i < nodes.size(); i++)
+        {
+            std::map<btVector3, btVector3, VectorLess>::const_iterator it =
+                moves.find(nodes[i]);
+            if (it != moves.end())
+            {
+                nodes[i].setValue(it->second.x(), it->second.y(),
+                                  it->second.z());
+            }
+        }
+
+        std::vector<tgPair>& pairs = pStructure->m_pairs.getPairs();
+        for (std::size_t i = 0; i < pairs.size(); i++)
+        {
+            std::map<btVector3, btVector3, VectorLess>::const_iterator it =
+                moves.find(pairs[i].getFrom());
+            if (it != moves.end())
+            {
+                pairs[i].setFrom(it->second);
+            }
+            it = moves.find(pairs[i].getTo());
+            if (it != moves.end())
+            {
+                pairs[i].setTo(it->second);
+            }
+        }
+        pStructure->invalidateIndex(false, true, false);
+
+        const std::vector<tgStructure*>& children = pStructure->getChildren();
+        queue.insert(queue.end(), children.begin(), children.end());
+    }
+}
+
 void tgStructure::addRotation(const btVector3& fixedPoint,
                  const btVector3& axis,
                  double angle)
@@ -137,8 +611,16 @@ void tgStructure::addRotation(const btVector3& fixedPoint,
 void tgStructure::addRotation(const btVector3& fixedPoint,
                  const btQuaternion& rotation)
 {
+    if (m_pDeferred != NULL)
+    {
+        m_pDeferred->add(Deferred::Transform::eRotate, fixedPoint,
+                         rotation, 1.0);
+        invalidateIndex(false, true, false);
+        return;
+    }
     m_nodes.addRotation(fixedPoint, rotation);
     m_pairs.addRotation(fixedPoint, rotation);
+    invalidateIndex(false, true, false);
 
     for (std::size_t i = 0; i < m_children.size(); ++i)
     {
@@ -154,8 +636,16 @@ void tgStructure::scale(double scaleFactor) {
 }
 
 void tgStructure::scale(const btVector3& referencePoint, double scaleFactor) {
+    if (m_pDeferred != NULL)
+    {
+        m_pDeferred->add(Deferred::Transform::eScale, referencePoint,
+                         btQuaternion::getIdentity(), scaleFactor);
+        invalidateIndex(false, true, false);
+        return;
+    }
     m_nodes.scale(referencePoint, scaleFactor);
     m_pairs.scale(referencePoint, scaleFactor);
+    invalidateIndex(false, true, false);
 
     for (int i = 0; i < m_children.size(); i++) {
         tgStructure* const childStructure = m_children[i];
@@ -172,14 +662,28 @@ void tgStructure::addChild(tgStructure* pChild)
     /// structure may build the pairs, while another may not depending on its tags.
     if (pChild != NULL)
     {
+        materialize();
         m_children.push_back(pChild);
+        pChild->m_pParent = this;
+        invalidateIndex(true, true, true);
     }
 }
 
 void tgStructure::addChild(const tgStructure& child)
 {
-    m_children.push_back(new tgStructure(child));
-    
+    addChild(new tgStructure(child));
+}
+
+void tgStructure::invalidateIndex(bool nodes, bool pairs, bool children)
+{
+    releaseSnapshot();
+    for (tgStructure* p = this; p != NULL; p = p->m_pParent)
+    {
+        Index& index = *p->m_pIndex;
+        index.nodesBuilt = index.nodesBuilt && !nodes;
+        index.pairsBuilt = index.pairsBuilt && !pairs;
+        index.childrenBuilt = index.childrenBuilt && !children;
+    }
 }
 
 btVector3 tgStructure::getCentroid() const {
@@ -192,6 +696,7 @@ btVector3 tgStructure::getCentroid() const {
     while (!q.empty()) {
         const tgStructure* structure = q.front();
         q.pop();
+        structure->materialize();
         for (int i = 0; i < structure->m_nodes.size(); i++) {
             centroid += structure->m_nodes[i];
             numNodes++;
@@ -204,6 +709,32 @@ btVector3 tgStructure::getCentroid() const {
 }
 
 tgNode& tgStructure::findNode(const std::string& tags) {
+    // What we return can be changed, so copies should not share it
+    releaseSnapshot();
+    Index& index = *m_pIndex;
+    if (!index.nodesBuilt) {
+        index.buildNodes(*this);
+    }
+    const std::vector<Index::Ref>* const pCandidates =
+        rarest(index.nodesByTag, tgTags::splitTags(tags));
+    if (pCandidates != NULL) {
+        for (std::size_t i = 0; i < pCandidates->size(); i++) {
+            const Index::Ref& ref = (*pCandidates)[i];
+            tgNode& node = ref.pStructure->m_nodes[ref.index];
+            if (node.hasAllTags(tags)) {
+                return node;
+            }
+        }
+    }
+    // No tags, or they changed since the index was built
+    tgNode* const pNode = searchNode(tags);
+    if (pNode == NULL) {
+        throw std::invalid_argument("Node not found: " + tags);
+    }
+    return *pNode;
+}
+
+tgNode* tgStructure::searchNode(const std::string& tags) {
     std::queue<tgStructure*> q;
 
     q.push(this);
@@ -211,19 +742,46 @@ tgNode& tgStructure::findNode(const std::string& tags) {
     while (!q.empty()) {
         tgStructure* structure = q.front();
         q.pop();
+        structure->materialize();
         for (int i = 0; i < structure->m_nodes.size(); i++) {
             if (structure->m_nodes[i].hasAllTags(tags)) {
-                return structure->m_nodes[i];
+                return &structure->m_nodes[i];
             }
         }
         for (int i = 0; i < structure->m_children.size(); i++) {
             q.push(structure->m_children[i]);
         }
     }
-    throw std::invalid_argument("Node not found: " + tags);
+    return NULL;
 }
 
 tgPair& tgStructure::findPair(const btVector3& from, const btVector3& to) {
+    // What we return can be changed, so copies should not share it
+    releaseSnapshot();
+    Index& index = *m_pIndex;
+    if (!index.pairsBuilt) {
+        index.buildPairs(*this);
+    }
+    std::map<PairKey, Index::Ref, PairKeyLess>::const_iterator it =
+        index.pairsByEnds.find(PairKey(from, to));
+    if (it != index.pairsByEnds.end()) {
+        tgPair& pair = it->second.pStructure->m_pairs[it->second.index];
+        if ((pair.getFrom() == from && pair.getTo() == to) ||
+            (pair.getFrom() == to && pair.getTo() == from)) {
+            return pair;
+        }
+    }
+    // The pair was moved through a reference since the index was built
+    tgPair* const pPair = searchPair(from, to);
+    if (pPair == NULL) {
+        std::ostringstream pairString;
+        pairString << from << ", " << to;
+        throw std::invalid_argument("Pair not found: " + pairString.str());
+    }
+    return *pPair;
+}
+
+tgPair* tgStructure::searchPair(const btVector3& from, const btVector3& to) {
     std::queue<tgStructure*> q;
 
     q.push(this);
@@ -231,24 +789,49 @@ tgPair& tgStructure::findPair(const btVector3& from, const btVector3& to) {
     while (!q.empty()) {
         tgStructure* structure = q.front();
         q.pop();
+        structure->materialize();
         for (int i = 0; i < structure->m_pairs.size(); i++) {
             if ((structure->m_pairs[i].getFrom() == from && structure->m_pairs[i].getTo() == to) ||
                 (structure->m_pairs[i].getFrom() == to && structure->m_pairs[i].getTo() == from)) {
-                return structure->m_pairs[i];
+                return &structure->m_pairs[i];
             }
         }
         for (int i = 0; i < structure->m_children.size(); i++) {
             q.push(structure->m_children[i]);
         }
     }
-    std::ostringstream pairString;
-    pairString << from << ", " << to;
-    throw std::invalid_argument("Pair not found: " + pairString.str());
+    return NULL;
 }
 
 tgStructure& tgStructure::findChild(const std::string& tags) {
+    // What we return can be changed, so copies should not share it
+    releaseSnapshot();
+    Index& index = *m_pIndex;
+    if (!index.childrenBuilt) {
+        index.buildChildren(*this);
+    }
+    const std::vector<tgStructure*>* const pCandidates =
+        rarest(index.childrenByTag, tgTags::splitTags(tags));
+    if (pCandidates != NULL) {
+        for (std::size_t i = 0; i < pCandidates->size(); i++) {
+            tgStructure* const structure = (*pCandidates)[i];
+            if (structure->hasAllTags(tags)) {
+                return *structure;
+            }
+        }
+    }
+    // No tags, or they changed since the index was built
+    tgStructure* const pChild = searchChild(tags);
+    if (pChild == NULL) {
+        throw std::invalid_argument("Child structure not found: " + tags);
+    }
+    return *pChild;
+}
+
+tgStructure* tgStructure::searchChild(const std::string& tags) {
     std::queue<tgStructure*> q;
 
+    materialize();
     for (int i = 0; i < m_children.size(); i++) {
         q.push(m_children[i]);
     }
@@ -257,13 +840,14 @@ tgStructure& tgStructure::findChild(const std::string& tags) {
         tgStructure* structure = q.front();
         q.pop();
         if (structure->hasAllTags(tags)) {
-            return *structure;
+            return structure;
         }
+        structure->materialize();
         for (int i = 0; i < structure->m_children.size(); i++) {
             q.push(structure->m_children[i]);
         }
     }
-    throw std::invalid_argument("Child structure not found: " + tags);
+    return NULL;
 }
 
 /* Standalone functions */
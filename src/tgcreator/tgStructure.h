@@ -50,6 +50,15 @@ class tgTags;
  * create physical representations of the structures with rods, muscles, etc.
  * Note that tags can be anything you want -- you'll specify the tags that you 
  * want to use to build things like rods or muscles during the build phase.
+ *
+ * Copies are copy-on-write: a copy shares an immutable snapshot of the
+ * original's nodes, pairs and children, and move, addRotation and
+ * scale(referencePoint, scaleFactor) are recorded rather than applied.
+ * The copy makes its own nodes and pairs, replaying the recorded
+ * transforms, the first time they are read or changed, which for most
+ * copies is when tgStructureInfo builds them. Its children are then
+ * copies in turn, so a deep tree of repeated segments is only
+ * materialized a level at a time.
  */
 class tgStructure : public tgTaggable
 {
@@ -59,6 +68,9 @@ public:
 
     tgStructure(const tgStructure& orig);
 
+    /** Copies, sharing as the copy constructor does */
+    tgStructure& operator=(const tgStructure& orig);
+
     tgStructure(const tgTags& tags);
 
     tgStructure(const std::string& space_separated_tags);
@@ -122,6 +134,17 @@ public:
      */
     void scale(const btVector3& referencePoint, double scaleFactor);
 
+    /**
+     * Move every node and pair end, here and in every child, that is
+     * exactly at one of the points in from to the matching point in to.
+     * For moving a structure to a computed shape, as tgFormFinder does.
+     * @param[in] from the points to move
+     * @param[in] to their new positions, indexed like from
+     * @throw std::invalid_argument if the sizes differ
+     */
+    void movePoints(const std::vector<btVector3>& from,
+                    const std::vector<btVector3>& to);
+
     /**
      * Add a child structure. Note that this will be copied rather than
      * being a reference or a pointer.
@@ -137,12 +160,17 @@ public:
      */
     const tgNodes& getNodes() const
     {
+        materialize();
         return m_nodes;
     }
 
     /**
      * Looks through nodes that we own and those that belong to child nodes
      * (using BFS) and returns the first node with a matching name.
+     * Lookups go through an index of the whole tree by tag, kept up to
+     * date by the structure's own mutators; tags changed afterwards on
+     * a returned node or child are only found by a slower search, and a
+     * node with newly added tags may not be the one returned.
      * Throws an error if a node is not a found with a matching name.
      * (added to accommodate structures encoded in YAML)
      * @param[in] name the name of the node to find and return
@@ -164,12 +192,14 @@ public:
      */
     const tgPairs& getPairs() const
     {
+        materialize();
         return m_pairs;
     }
 
     /**
      * Looks through pairs that we own and those that belong to child nodes
      * (using BFS) and returns the first pair with matching endpoint coordinates.
+     * Lookups go through an index by exact endpoint positions.
      * Throws an error if a pair is not a found.
      * (added to accommodate structures encoded in YAML)
      * @param[in] from the vector on one end of the pair to find and return
@@ -179,16 +209,20 @@ public:
     tgPair& findPair(const btVector3& from, const btVector3& to);
 	
     /**
-     * Return our child structures
+     * Return our child structures. Changes made to them through these
+     * pointers are not seen by copies of this structure already made.
      */
     const std::vector<tgStructure*>& getChildren() const
     {
+        materialize();
+        releaseSnapshot();
         return m_children;
     }
 
     /**
      * Looks through children we own and those that belong to our children (using BFS)
-     * and returns the first child with a matching name.
+     * and returns the first child with a matching name. Indexed by tag, as
+     * for findNode.
      * Throws an error if a child is not a found with a matching name.
      * (added to accommodate structures encoded in YAML)
      * @param[in] name the name of the structure to find and return
@@ -198,12 +232,81 @@ public:
 
 private:
 
+    /**
+     * Lookup tables for findNode, findPair and findChild over this
+     * structure and its descendants, built when first needed. Defined in
+     * tgStructure.cpp.
+     */
+    struct Index;
+
+    /** An immutable copy of a structure's contents, shared by its copies */
+    struct Snapshot;
+
+    /** What a copy has yet to make: its snapshot and pending transforms */
+    struct Deferred;
+
+    /** Make our own nodes, pairs and children if we are still a copy */
+    void materialize() const
+    {
+        if (m_pDeferred != NULL)
+        {
+            const_cast<tgStructure*>(this)->instantiate();
+        }
+    }
+
+    /** Replace m_pDeferred with the contents it describes */
+    void instantiate();
+
+    /**
+     * Get a Deferred for a copy of this structure, sharing our snapshot
+     */
+    Deferred* share() const;
+
+    /**
+     * Drop our snapshot and those of our ancestors, since something
+     * they describe may change
+     */
+    void releaseSnapshot() const;
+
+    /** The BFS behind findNode, used when the index has no match */
+    tgNode* searchNode(const std::string& tags);
+
+    /** The BFS behind findPair, used when the index has no match */
+    tgPair* searchPair(const btVector3& from, const btVector3& to);
+
+    /** The BFS behind findChild, used when the index has no match */
+    tgStructure* searchChild(const std::string& tags);
+
+    /**
+     * Forget the parts of the index a change to this structure affects,
+     * here and in every ancestor, and their snapshots.
+     * @param[in] nodes whether nodes were added
+     * @param[in] pairs whether pairs were added, removed or moved
+     * @param[in] children whether a child was added
+     */
+    void invalidateIndex(bool nodes, bool pairs, bool children);
+
     tgNodes m_nodes;
 
     tgPairs m_pairs;
 
     // we own these
     std::vector<tgStructure*> m_children;
+
+    /** The structure we are a child of; NULL at the root. */
+    tgStructure* m_pParent;
+
+    /** We own this; never NULL */
+    Index* m_pIndex;
+
+    /**
+     * Set while we are a copy that has not made its contents yet, in
+     * which case m_nodes, m_pairs and m_children are empty. We own this.
+     */
+    Deferred* m_pDeferred;
+
+    /** Shared with copies made since our last change; may be NULL */
+    mutable Snapshot* m_pSnapshot;
     
 };
 
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgStructureBatch.cpp
+ * @brief Implementation of class tgStructureBatch
+ * $Id$
+ */
+
+// This module
+#include "tgStructureBatch.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+tgStructureBatch::tgStructureBatch() :
+m_tagSets(1),
+m_streamedNodes(0),
+m_streamedPairs(0)
+{
+    m_tagSetIndex[""] = noTags;
+}
+
+int tgStructureBatch::tags(const std::string& space_separated_tags)
+{
+    std::map<std::string, int>::const_iterator it =
+        m_tagSetIndex.find(space_separated_tags);
+    if (it != m_tagSetIndex.end())
+    {
+        return it->second;
+    }
+    const int tagSet = m_tagSets.size();
+    m_tagSets.push_back(tgTags(space_separated_tags));
+    m_tagSetIndex[space_separated_tags] = tagSet;
+    return tagSet;
+}
+
+std::size_t tgStructureBatch::addNode(double x, double y, double z, int tagSet)
+{
+    if (tagSet < 0 || (std::size_t) tagSet >= m_tagSets.size())
+    {
+        throw std::out_of_range("No such tag set");
+    }
+    m_coords.push_back(x);
+    m_coords.push_back(y);
+    m_coords.push_back(z);
+    m_nodeTags.push_back(tagSet);
+    return m_nodeTags.size() - 1;
+}
+
+std::size_t tgStructureBatch::addPair(std::size_t from, std::size_t to, int tagSet)
+{
+    if (from >= nodeCount() || to >= nodeCount())
+    {
+        throw std::out_of_range("No such node");
+    }
+    if (tagSet < 0 || (std::size_t) tagSet >= m_tagSets.size())
+    {
+        throw std::out_of_range("No such tag set");
+    }
+    m_pairEnds.push_back(from);
+    m_pairEnds.push_back(to);
+    m_pairTags.push_back(tagSet);
+    return m_pairTags.size() - 1;
+}
+
+void tgStructureBatch::reserve(std::size_t nodes, std::size_t pairs)
+{
+    m_coords.reserve(3 * nodes);
+    m_nodeTags.reserve(nodes);
+    m_pairEnds.reserve(2 * pairs);
+    m_pairTags.reserve(pairs);
+}
+
+void tgStructureBatch::move(const btVector3& offset)
+{
+    for (std::size_t i = 0; i < nodeCount(); i++)
+    {
+        m_coords[3 * i] += offset.x();
+        m_coords[3 * i + 1] += offset.y();
+        m_coords[3 * i + 2] += offset.z();
+    }
+}
+
+void tgStructureBatch::clearPairs()
+{
+    m_pairEnds.clear();
+    m_pairTags.clear();
+    m_streamedPairs = 0;
+}
+
+void tgStructureBatch::clear()
+{
+    clearPairs();
+    m_coords.clear();
+    m_nodeTags.clear();
+    m_streamedNodes = 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgStructureBatch.h
+ * @brief Definition of class tgStructureBatch
+ * $Id$
+ */
+
+#ifndef TG_STRUCTURE_BATCH_H
+#define TG_STRUCTURE_BATCH_H
+
+// The NTRT Core Library
+#include "core/tgTags.h"
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Nodes and pairs for procedurally generated structures too large to
+ * hold as a tgStructure: a tgNode or tgPair per element, each with its
+ * own tags, for millions of elements. Here a node is three coordinates
+ * and a pair two node indices, each with the index of a tag set that is
+ * parsed once and shared by every element that uses it.
+ *
+ * tgStructureInfo::stream turns the elements added since the last
+ * stream into rigid and connector infos, as the tgBuildSpec's builders
+ * would the same tgStructure's. The pairs can then be cleared, keeping
+ * the nodes for later pairs, so the batch only has to hold a block of
+ * pairs at a time:
+ * @code
+ * tgStructure empty;
+ * tgStructureInfo structureInfo(empty, spec);
+ * tgStructureBatch batch;
+ * const int rod = batch.tags("rod");
+ * // ... batch.addNode for every node
+ * for (std::size_t i = 1; i < batch.nodeCount(); i++)
+ * {
+ *     batch.addPair(i - 1, i, rod);
+ *     if (batch.pairCount() == 10000)
+ *     {
+ *         structureInfo.stream(batch);
+ *         batch.clearPairs();
+ *     }
+ * }
+ * structureInfo.stream(batch);
+ * structureInfo.buildInto(*this, world);
+ * @endcode
+ */
+class tgStructureBatch
+{
+public:
+
+    /** The tag set index of no tags */
+    static const int noTags = 0;
+
+    tgStructureBatch();
+
+    /**
+     * The index of a tag set, added the first time it is asked for. The
+     * same string always gives the same index.
+     * @param[in] space_separated_tags as for tgTags
+     */
+    int tags(const std::string& space_separated_tags);
+
+    /** The tags of a tag set index */
+    const tgTags& getTags(int tagSet) const
+    {
+        return m_tagSets.at(tagSet);
+    }
+
+    /**
+     * Add a node.
+     * @param[in] tagSet from tags()
+     * @return its index, for addPair
+     * @throw std::out_of_range if there is no such tag set
+     */
+    std::size_t addNode(double x, double y, double z, int tagSet = noTags);
+
+    /**
+     * Add a pair between two nodes.
+     * @param[in] tagSet from tags()
+     * @return its index
+     * @throw std::out_of_range if there is no such node or tag set
+     */
+    std::size_t addPair(std::size_t from, std::size_t to, int tagSet = noTags);
+
+    /** Make room for more elements without reallocating as they are added */
+    void reserve(std::size_t nodes, std::size_t pairs);
+
+    std::size_t nodeCount() const
+    {
+        return m_nodeTags.size();
+    }
+
+    std::size_t pairCount() const
+    {
+        return m_pairTags.size();
+    }
+
+    btVector3 getNode(std::size_t i) const
+    {
+        return btVector3(m_coords[3 * i], m_coords[3 * i + 1], m_coords[3 * i + 2]);
+    }
+
+    int getNodeTags(std::size_t i) const
+    {
+        return m_nodeTags[i];
+    }
+
+    std::size_t getPairFrom(std::size_t i) const
+    {
+        return m_pairEnds[2 * i];
+    }
+
+    std::size_t getPairTo(std::size_t i) const
+    {
+        return m_pairEnds[2 * i + 1];
+    }
+
+    int getPairTags(std::size_t i) const
+    {
+        return m_pairTags[i];
+    }
+
+    /**
+     * Move every node, for placing the structure, as tgStructure::move.
+     * Infos already streamed stay where they were made.
+     */
+    void move(const btVector3& offset);
+
+    /** Drop the pairs, keeping the nodes and tag sets */
+    void clearPairs();
+
+    /** Drop everything but the tag sets */
+    void clear();
+
+    /** The nodes not yet streamed start here */
+    std::size_t getStreamedNodes() const
+    {
+        return m_streamedNodes;
+    }
+
+    /** The pairs not yet streamed start here */
+    std::size_t getStreamedPairs() const
+    {
+        return m_streamedPairs;
+    }
+
+    /** Mark every element as streamed; called by tgStructureInfo::stream */
+    void markStreamed()
+    {
+        m_streamedNodes = nodeCount();
+        m_streamedPairs = pairCount();
+    }
+
+private:
+
+    /** x, y and z of each node */
+    std::vector<double> m_coords;
+    std::vector<int> m_nodeTags;
+
+    /** From and to of each pair */
+    std::vector<std::size_t> m_pairEnds;
+    std::vector<int> m_pairTags;
+
+    std::vector<tgTags> m_tagSets;
+    std::map<std::string, int> m_tagSetIndex;
+
+    std::size_t m_streamedNodes;
+    std::size_t m_streamedPairs;
+};
+
+#endif  // TG_STRUCTURE_BATCH_H
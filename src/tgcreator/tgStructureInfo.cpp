@@ -27,19 +27,49 @@
 // This module
 #include "tgStructureInfo.h"
 // This library
+#include "tgBodyBatch.h"
 #include "tgConnectorInfo.h"
 #include "tgRigidAutoCompound.h"
+#include "tgRigidNodeIndex.h"
 #include "tgStructure.h"
+#include "tgStructureBatch.h"
+#include "core/tgBuildProfile.h"
+#include "core/tgBulletUtil.h"
 #include "core/tgWorld.h"
 #include "core/tgModel.h"
+#include "core/tgSpringCableActuator.h"
 // The C++ Standard Library
 #include <stdexcept>
+#include <typeinfo>
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+
+namespace
+{
+    /** A hold on the open arena, or a new one for the root of a tree */
+    tgBuildArena* holdArena()
+    {
+        tgBuildArena* const pArena = tgBuildArena::current();
+        if (pArena == NULL)
+        {
+            return new tgBuildArena();
+        }
+        pArena->retain();
+        return pArena;
+    }
+}
 
 tgStructureInfo::tgStructureInfo(tgStructure& structure, tgBuildSpec& buildSpec) : 
     tgTaggable(),
     m_structure(structure), 
-    m_buildSpec(buildSpec)
+    m_buildSpec(buildSpec),
+    m_pArena(holdArena()),
+    m_mergeRigids(false),
+    m_resolved(false)
 {
+    tgBuildProfile::Scope scope("structure info");
+    tgBuildArena::Scope arenaScope(m_pArena);
     createTree(*this, structure);    
 }
 
@@ -47,8 +77,13 @@ tgStructureInfo::tgStructureInfo(tgStructure& structure, tgBuildSpec& buildSpec,
                  const tgTags& tags) :
     tgTaggable(tags),
     m_structure(structure), 
-    m_buildSpec(buildSpec)
+    m_buildSpec(buildSpec),
+    m_pArena(holdArena()),
+    m_mergeRigids(false),
+    m_resolved(false)
 {
+    tgBuildProfile::Scope scope("structure info");
+    tgBuildArena::Scope arenaScope(m_pArena);
     createTree(*this, structure);    
 }
 
@@ -81,6 +116,9 @@ tgStructureInfo::~tgStructureInfo()
     {
     delete m_children[i];
     }
+    
+    // Frees the blocks if this is the last holder
+    m_pArena->release();
 }
 
 void tgStructureInfo::createTree(tgStructureInfo& structureInfo,
@@ -122,24 +160,27 @@ void tgStructureInfo::addRigidsAndConnectors() {
     const std::vector<tgBuildSpec::RigidAgent*> rigidAgents = m_buildSpec.getRigidAgents();
     const std::vector<tgBuildSpec::ConnectorAgent*> connectorAgents = m_buildSpec.getConnectorAgents();
 
+    const std::vector<tgTagSearch> rigidSearches = agentSearches(rigidAgents);
+    const std::vector<tgTagSearch> connectorSearches = agentSearches(connectorAgents);
+
     const tgNodes& nodes = m_structure.getNodes();
     const tgPairs& pairs = m_structure.getPairs();
 
     // for each node, create a rigidInfo object using a matching rigidAgent
     for (int i = 0; i < nodes.size(); i++) {
-        tgRigidInfo* nodeRigid = initRigidInfo<tgNode>(nodes[i], rigidAgents);
+        tgRigidInfo* nodeRigid = initRigidInfo<tgNode>(nodes[i], rigidAgents, rigidSearches);
         if (nodeRigid) {
             m_rigids.push_back(nodeRigid);
         }
     }
     // for each pair, create a rigidInfo or connectorInfo object using a matching rigidAgent or connectorAgent
     for (int i = 0; i < pairs.size(); i++) {
-        tgRigidInfo* pairRigid = initRigidInfo<tgPair>(pairs[i], rigidAgents);
+        tgRigidInfo* pairRigid = initRigidInfo<tgPair>(pairs[i], rigidAgents, rigidSearches);
         if (pairRigid) {
 	  m_rigids.push_back(pairRigid);
         }
         else {
-            tgConnectorInfo* pairConnector = initConnectorInfo<tgPair>(pairs[i], connectorAgents);
+            tgConnectorInfo* pairConnector = initConnectorInfo<tgPair>(pairs[i], connectorAgents, connectorSearches);
             if (pairConnector) {
                 m_connectors.push_back(pairConnector);
             }
@@ -155,22 +196,91 @@ void tgStructureInfo::addRigidsAndConnectors() {
     }
 }
 
-template <class T>
-tgRigidInfo* tgStructureInfo::initRigidInfo(const T& rigidCandidate, const std::vector<tgBuildSpec::RigidAgent*>& rigidAgents) const {
-    for (int i = rigidAgents.size() - 1; i >= 0; i--) {
-        const tgBuildSpec::RigidAgent* pRigidAgent = rigidAgents[i];
-        assert(pRigidAgent != NULL);
+void tgStructureInfo::stream(tgStructureBatch& batch)
+{
+    if (m_resolved)
+    {
+        throw std::logic_error("Streaming into a structure info that is already resolved");
+    }
+    tgBuildProfile::Scope scope("stream");
+    tgBuildArena::Scope arenaScope(m_pArena);
+
+    const std::vector<tgBuildSpec::RigidAgent*> rigidAgents = m_buildSpec.getRigidAgents();
+    const std::vector<tgBuildSpec::ConnectorAgent*> connectorAgents = m_buildSpec.getConnectorAgents();
+    const std::vector<tgTagSearch> rigidSearches = agentSearches(rigidAgents);
+    const std::vector<tgTagSearch> connectorSearches = agentSearches(connectorAgents);
+
+    // One node and pair reused for every element, with their tags only
+    // copied when the tag set changes
+    tgNode node;
+    int nodeTags = tgStructureBatch::noTags;
+    for (std::size_t i = batch.getStreamedNodes(); i < batch.nodeCount(); i++) {
+        if (batch.getNodeTags(i) != nodeTags) {
+            nodeTags = batch.getNodeTags(i);
+            node.setTags(batch.getTags(nodeTags));
+        }
+        static_cast<btVector3&>(node) = batch.getNode(i);
+        tgRigidInfo* const nodeRigid = initRigidInfo<tgNode>(node, rigidAgents, rigidSearches);
+        if (nodeRigid) {
+            m_rigids.push_back(nodeRigid);
+        }
+    }
+
+    tgPair pair;
+    int pairTags = tgStructureBatch::noTags;
+    for (std::size_t i = batch.getStreamedPairs(); i < batch.pairCount(); i++) {
+        if (batch.getPairTags(i) != pairTags) {
+            pairTags = batch.getPairTags(i);
+            pair.setTags(batch.getTags(pairTags));
+        }
+        pair.setFrom(batch.getNode(batch.getPairFrom(i)));
+        pair.setTo(batch.getNode(batch.getPairTo(i)));
+        tgRigidInfo* const pairRigid = initRigidInfo<tgPair>(pair, rigidAgents, rigidSearches);
+        if (pairRigid) {
+            m_rigids.push_back(pairRigid);
+        }
+        else {
+            tgConnectorInfo* const pairConnector = initConnectorInfo<tgPair>(pair, connectorAgents, connectorSearches);
+            if (pairConnector) {
+                m_connectors.push_back(pairConnector);
+            }
+        }
+    }
+
+    batch.markStreamed();
+}
 
-        tgTagSearch tagSearch = tgTagSearch(pRigidAgent->tagSearch);
+template <class Agent>
+std::vector<tgTagSearch> tgStructureInfo::agentSearches(const std::vector<Agent*>& agents) const {
+    std::vector<tgTagSearch> result;
+    for (std::size_t i = 0; i < agents.size(); i++) {
+        assert(agents[i] != NULL);
+
+        tgTagSearch tagSearch = tgTagSearch(agents[i]->tagSearch);
 
         // Remove our tags so that subcomponents 'inherit' them (because of the
         // way tags work, removing a tag from the search is the same as adding
         // the tag to children to be searched)
         tagSearch.remove(getTags());
 
+        result.push_back(tagSearch);
+    }
+    return result;
+}
+
+template <class T>
+tgRigidInfo* tgStructureInfo::initRigidInfo(const T& rigidCandidate, const std::vector<tgBuildSpec::RigidAgent*>& rigidAgents,
+                                            const std::vector<tgTagSearch>& rigidSearches) const {
+    for (int i = rigidAgents.size() - 1; i >= 0; i--) {
+        const tgBuildSpec::RigidAgent* pRigidAgent = rigidAgents[i];
+        assert(pRigidAgent != NULL);
+
+        const tgTagSearch& tagSearch = rigidSearches[i];
+
         tgRigidInfo* pRigidInfo = pRigidAgent->infoFactory;
         assert(pRigidInfo != NULL);
 
+        tgBuildProfile::Scope scope("match", typeid(*pRigidInfo));
         tgRigidInfo* rigid = pRigidInfo->createRigidInfo(rigidCandidate, tagSearch);
         if (rigid) {// check if a tgRigidInfo was found
 	  return rigid;
@@ -180,21 +290,18 @@ tgRigidInfo* tgStructureInfo::initRigidInfo(const T& rigidCandidate, const std::
 }
 
 template <class T>
-tgConnectorInfo* tgStructureInfo::initConnectorInfo(const T& connectorCandidate, const std::vector<tgBuildSpec::ConnectorAgent*>& connectorAgents) const {
+tgConnectorInfo* tgStructureInfo::initConnectorInfo(const T& connectorCandidate, const std::vector<tgBuildSpec::ConnectorAgent*>& connectorAgents,
+                                                    const std::vector<tgTagSearch>& connectorSearches) const {
     for (int i = connectorAgents.size() - 1; i >= 0; i--) {
         const tgBuildSpec::ConnectorAgent*  pConnectorAgent = connectorAgents[i];
         assert(pConnectorAgent != NULL);
 
-        tgTagSearch tagSearch = tgTagSearch(pConnectorAgent->tagSearch);
-
-        // Remove our tags so that subcomponents 'inherit' them (because of the
-        // way tags work, removing a tag from the search is the same as adding
-        // the tag to children to be searched)
-        tagSearch.remove(getTags());
+        const tgTagSearch& tagSearch = connectorSearches[i];
 
         tgConnectorInfo* pConnectorInfo = pConnectorAgent->infoFactory;
         assert(pConnectorInfo != NULL);
 
+        tgBuildProfile::Scope scope("match", typeid(*pConnectorInfo));
         tgConnectorInfo* connector = pConnectorInfo->createConnectorInfo(connectorCandidate, tagSearch);
         if (connector) // check if a tgConnectorInfo was found
             return connector;
@@ -202,24 +309,19 @@ tgConnectorInfo* tgStructureInfo::initConnectorInfo(const T& connectorCandidate,
     return 0;
 }
 
-void tgStructureInfo::autoCompoundRigids()
+void tgStructureInfo::autoCompoundRigids(const tgRigidNodeIndex& index)
 {
-  tgRigidAutoCompound c(getAllRigids());
+  tgRigidAutoCompound c(index, m_mergeRigids);
   m_compounded = c.execute();
 }
 
-void tgStructureInfo::chooseConnectorRigids()
-{
-    chooseConnectorRigids(getAllRigids());
-}
-
-void tgStructureInfo::chooseConnectorRigids(std::vector<tgRigidInfo*> allRigids)
+void tgStructureInfo::chooseConnectorRigids(const tgRigidNodeIndex& index)
 {
     for (std::size_t i = 0; i < m_connectors.size(); i++)
     {
         tgConnectorInfo * const pConnectorInfo = m_connectors[i];
     assert(pConnectorInfo != NULL);
-        pConnectorInfo->chooseRigids(allRigids);
+        pConnectorInfo->chooseRigids(index);
     }    
 
     // Children
@@ -227,7 +329,7 @@ void tgStructureInfo::chooseConnectorRigids(std::vector<tgRigidInfo*> allRigids)
     {
         tgStructureInfo * const pStructureInfo = m_children[i];
     assert(pStructureInfo != NULL);
-        pStructureInfo->chooseConnectorRigids(allRigids);
+        pStructureInfo->chooseConnectorRigids(index);
     }
 }
 
@@ -238,6 +340,7 @@ void tgStructureInfo::initRigidBodies(tgWorld& world)
     {
         tgRigidInfo * const pRigidInfo = m_rigids[i];
     assert(pRigidInfo != NULL);
+        tgBuildProfile::Scope scope("rigid bodies", typeid(*pRigidInfo));
         pRigidInfo->initRigidBody(world);
     }
     
@@ -250,6 +353,70 @@ void tgStructureInfo::initRigidBodies(tgWorld& world)
     }
 }
 
+void tgStructureInfo::forgetWorld()
+{
+    for (std::size_t i = 0; i < m_rigids.size(); i++)
+    {
+        m_rigids[i]->forgetWorld();
+    }
+    for (std::size_t i = 0; i < m_compounded.size(); i++)
+    {
+        m_compounded[i]->forgetWorld();
+    }
+
+    // Children
+    for (std::size_t i = 0; i < m_children.size(); i++)
+    {
+        tgStructureInfo * const pStructureInfo = m_children[i];
+        assert(pStructureInfo != NULL);
+        pStructureInfo->forgetWorld();
+    }
+}
+
+void tgStructureInfo::applyCollisionFilters(tgWorld& world)
+{
+    const std::vector<tgBuildSpec::CollisionFilter*>& filters = m_buildSpec.getCollisionFilters();
+    if (filters.empty())
+    {
+        return;
+    }
+    const std::vector<tgTagSearch> searches = agentSearches(filters);
+    btDynamicsWorld& dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(world);
+
+    // Rigids
+    for (std::size_t i = 0; i < m_rigids.size(); i++)
+    {
+        tgRigidInfo * const pRigidInfo = m_rigids[i];
+        assert(pRigidInfo != NULL);
+        // Later filters take precedence, as with the agents
+        for (int j = filters.size() - 1; j >= 0; j--)
+        {
+            if (searches[j].matches(*pRigidInfo))
+            {
+                btRigidBody* const pBody = pRigidInfo->getRigidBody();
+                // A body still in the open batch just takes the filter
+                tgBodyBatch* const pBatch = tgBodyBatch::current();
+                if (pBody &&
+                    !(pBatch && pBatch->setFilter(pBody, filters[j]->group, filters[j]->mask)))
+                {
+                    // The broadphase only reads the filter as a body is added
+                    dynamicsWorld.removeRigidBody(pBody);
+                    dynamicsWorld.addRigidBody(pBody, filters[j]->group, filters[j]->mask);
+                }
+                break;
+            }
+        }
+    }
+
+    // Children
+    for (std::size_t i = 0; i < m_children.size(); i++)
+    {
+        tgStructureInfo * const pStructureInfo = m_children[i];
+    assert(pStructureInfo != NULL);
+        pStructureInfo->applyCollisionFilters(world);
+    }
+}
+
 void tgStructureInfo::initConnectors(tgWorld& world) 
 {
     // Connectors
@@ -257,6 +424,7 @@ void tgStructureInfo::initConnectors(tgWorld& world)
     {
         tgConnectorInfo * const pConnectorInfo = m_connectors[i];
     assert(pConnectorInfo != NULL);
+        tgBuildProfile::Scope scope("connectors", typeid(*pConnectorInfo));
         pConnectorInfo->initConnector(world);
     }
     
@@ -277,15 +445,52 @@ void tgStructureInfo::initConnectors(tgWorld& world)
 void tgStructureInfo::buildInto(tgModel& model, tgWorld& world) 
 {
     // These take care of things on a global level
+    tgBuildProfile::Scope scope("buildInto");
+    resolve();
+    instantiate(model, world);
+}
+
+void tgStructureInfo::resolve()
+{
+    if (m_resolved)
+    {
+        return;
+    }
+    // The infos the factories and tgRigidAutoCompound create go in the arena
+    tgBuildArena::Scope arenaScope(m_pArena);
     addRigidsAndConnectors();    
-    autoCompoundRigids();    
-    chooseConnectorRigids();
-    initRigidBodies(world);
+    // One index of every node serves both passes
+    const tgRigidNodeIndex index(getAllRigids());
+    {
+        tgBuildProfile::Scope scope("auto compound");
+        autoCompoundRigids(index);    
+    }
+    {
+        tgBuildProfile::Scope scope("choose connector rigids");
+        chooseConnectorRigids(index);
+    }
+    m_resolved = true;
+}
+
+void tgStructureInfo::instantiate(tgModel& model, tgWorld& world)
+{
+    tgBuildArena::Scope arenaScope(m_pArena);
+    resolve();
+    forgetWorld();
+    {
+        // Every body goes into the world at once, with its filter, before
+        // the connectors look for them there
+        tgBodyBatch batch(world);
+        initRigidBodies(world);
+        applyCollisionFilters(world);
+        batch.commit();
+    }
     // Note: Muscle2Ps won't show up yet -- 
     // they need to be part of a model to have rendering...
     initConnectors(world);
     // Now build into the model
     buildIntoHelper(model, world, *this);
+    buildActuatorGroups(model);
 
     /*
     // DEBUGGING: What are the connector infos and rigid infos that
@@ -310,6 +515,22 @@ void tgStructureInfo::buildInto(tgModel& model, tgWorld& world)
     */
 }
 
+void tgStructureInfo::buildActuatorGroups(tgModel& model) const
+{
+    const std::vector<tgBuildSpec::ActuatorGroup*>& groups = m_buildSpec.getActuatorGroups();
+    if (groups.empty())
+    {
+        return;
+    }
+    tgActuatorGroups& actuatorGroups = model.getActuatorGroups();
+    actuatorGroups.clear();
+    for (std::size_t i = 0; i < groups.size(); i++)
+    {
+        actuatorGroups.addGroup(groups[i]->name, groups[i]->tagSearch);
+    }
+    actuatorGroups.build(tgCast::filter<tgModel, tgSpringCableActuator>(model.getDescendants()));
+}
+
 void tgStructureInfo::buildIntoHelper(tgModel& model, tgWorld& world,
                       tgStructureInfo& structureInfo)
 {
@@ -319,6 +540,7 @@ void tgStructureInfo::buildIntoHelper(tgModel& model, tgWorld& world,
     {
         tgRigidInfo * const pRigidInfo = rigids[i];
     assert(pRigidInfo != NULL);
+        tgBuildProfile::Scope scope("models", typeid(*pRigidInfo));
         tgModel* const pModel = pRigidInfo->createModel(world);
         if (pModel != NULL)
     {
@@ -332,6 +554,7 @@ void tgStructureInfo::buildIntoHelper(tgModel& model, tgWorld& world,
     {
         tgConnectorInfo * const pConnectorInfo = connectors[i];
     assert(pConnectorInfo != NULL);
+        tgBuildProfile::Scope scope("models", typeid(*pConnectorInfo));
         tgModel* const pModel = pConnectorInfo->createModel(world);
         if (pModel != NULL)
     {      
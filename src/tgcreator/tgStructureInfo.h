@@ -28,6 +28,7 @@
 #define TG_STRUCTURE_INFO_H
 
 // This library
+#include "tgBuildArena.h"
 #include "tgBuildSpec.h"
 // NTRT Core library
 #include "core/tgTaggable.h"
@@ -40,7 +41,9 @@ class tgBuildSpec;
 class tgConnectorInfo;
 class tgModel;
 class tgRigidInfo;
+class tgRigidNodeIndex;
 class tgStructure;
+class tgStructureBatch;
 class tgWorld;
 
 /**
@@ -54,6 +57,18 @@ class tgStructureInfo : public tgTaggable
 
 public:
 
+    /** Allocated from the tgBuildArena of the build, if there is one */
+    static void* operator new(std::size_t size)
+    {
+        return tgBuildArena::allocate(size);
+    }
+
+    static void operator delete(void* p)
+    {
+        tgBuildArena::deallocate(p);
+    }
+
+
     tgStructureInfo(tgStructure& structure, tgBuildSpec& buildSpec);
 
     tgStructureInfo(tgStructure& structure, tgBuildSpec& buildSpec, const tgTags& tags);
@@ -71,6 +86,44 @@ public:
     // Build our info into the provided model
     void buildInto(tgModel& model, tgWorld& world);
 
+    /**
+     * Create the rigid and connector infos of the nodes and pairs added
+     * to a batch since it was last streamed, as the build spec would
+     * for the same elements of the structure, and mark them streamed.
+     * They are resolved and built with the structure's own, so elements
+     * may touch or attach to each other across batches and to the
+     * structure's nodes.
+     * @param[in,out] batch the elements to add
+     * @throw std::logic_error if this has been resolved or built
+     */
+    void stream(tgStructureBatch& batch);
+
+    /**
+     * The part of buildInto that needs no world: create the rigid and
+     * connector infos, compound the rigids and choose the connectors'
+     * rigids. Only done the first time.
+     */
+    void resolve();
+
+    /**
+     * The rest of buildInto: give the resolved infos bodies, shapes and
+     * connectors in a world and build them into a model. May be called
+     * again for another world, which gets its own bodies; the infos
+     * only remember the last one.
+     */
+    void instantiate(tgModel& model, tgWorld& world);
+
+    /**
+     * Compound every rigid in the tree into a single body in buildInto,
+     * as if they all shared nodes. Meant for static scenery such as
+     * obstacle fields: one broadphase proxy, with the children found
+     * through the compound's own AABB tree. Off by default.
+     */
+    void setMergeRigids(bool merge)
+    {
+        m_mergeRigids = merge;
+    }
+
 private:
 
     /*
@@ -78,27 +131,54 @@ private:
      */
     void addRigidsAndConnectors();
 
+    /*
+     * The search of each agent, less this structure's tags, so that
+     * subcomponents 'inherit' them. Computed once per structure rather than
+     * once per candidate.
+     */
+    template <class Agent>
+    std::vector<tgTagSearch> agentSearches(const std::vector<Agent*>& agents) const;
+
     /*
      * Create and return a rigidInfo object using a matching rigidAgent
      */
     template <class T>
-    tgRigidInfo* initRigidInfo(const T& rigidCandidate, const std::vector<tgBuildSpec::RigidAgent*>& rigidAgents) const;
+    tgRigidInfo* initRigidInfo(const T& rigidCandidate, const std::vector<tgBuildSpec::RigidAgent*>& rigidAgents,
+                               const std::vector<tgTagSearch>& rigidSearches) const;
 
     /*
      * Create and return a connectorInfo object using a matching connectorAgent
      */
     template <class T>
-    tgConnectorInfo* initConnectorInfo(const T& connectorCandidate, const std::vector<tgBuildSpec::ConnectorAgent*>& connectorAgents) const;
+    tgConnectorInfo* initConnectorInfo(const T& connectorCandidate, const std::vector<tgBuildSpec::ConnectorAgent*>& connectorAgents,
+                                       const std::vector<tgTagSearch>& connectorSearches) const;
 
-    void autoCompoundRigids();
+    void autoCompoundRigids(const tgRigidNodeIndex& index);
     
-    void chooseConnectorRigids();
-
-    void chooseConnectorRigids(std::vector<tgRigidInfo*> allRigids);
+    void chooseConnectorRigids(const tgRigidNodeIndex& index);
     
     void initRigidBodies(tgWorld& world);
+
+    /*
+     * Forget the bodies and shapes of the last world built into, for
+     * this structure and its children
+     */
+    void forgetWorld();
+
+    /*
+     * Re-add the bodies of rigids matching one of the build spec's
+     * collision filters with its group and mask, for this structure and
+     * its children
+     */
+    void applyCollisionFilters(tgWorld& world);
     
     void initConnectors(tgWorld& world);
+
+    /*
+     * Fill the model's tgActuatorGroups from the build spec's actuator
+     * groups, once the actuators are its descendants
+     */
+    void buildActuatorGroups(tgModel& model) const;
     
     const std::vector<tgRigidInfo*>& getRigids() const
     {
@@ -127,6 +207,10 @@ private:
 
     tgBuildSpec& m_buildSpec;
     
+    // Held by every node of the tree. The root creates it, and the rest
+    // join the one open when they are created
+    tgBuildArena* m_pArena;
+    
     // We do own these
     std::vector<tgRigidInfo*> m_rigids;
 
@@ -135,6 +219,10 @@ private:
     std::vector<tgStructureInfo*> m_children;
     
     std::vector<tgRigidInfo*> m_compounded;
+
+    bool m_mergeRigids;
+
+    bool m_resolved;
 };
 
 /**
@@ -29,7 +29,9 @@
 
 // Other classes from core (are these included from the superclass?...)
 //#include "core/tgBulletCompressionSpring.h"
+#include "core/tgBulletCableForceEngine.h"
 #include "core/tgBulletSpringCableAnchor.h"
+#include "core/tgBulletUtil.h"
 #include "core/tgCast.h"
 
 // Include the new type of spring
@@ -89,6 +91,13 @@ void tgUnidirComprSprActuatorInfo::initConnector(tgWorld& world)
     // in the world, but it doesn't actually have any in-world representation.
     // Remember that m_bulletCompressionSpring is held in the superclass.
     m_bulletCompressionSpring = createTgBulletUnidirComprSpr();
+
+    // Let the world compute this spring's force along with the cables'
+    tgBulletCableForceEngine* pEngine = tgBulletUtil::worldToCableForceEngine(world);
+    if (pEngine != NULL)
+    {
+        pEngine->addSpring(m_bulletCompressionSpring);
+    }
 }
 
 tgModel* tgUnidirComprSprActuatorInfo::createModel(tgWorld& world)
@@ -34,6 +34,7 @@
 #include "LinearMath/btQuaternion.h"
 #include "LinearMath/btTransform.h"
 #include "LinearMath/btVector3.h"
+#include "core/tgRandom.h"
 #include <cmath>
 #include <iostream>
 #include <sstream>
@@ -262,8 +263,9 @@ public:
     {
         btVector3 arb;
         v.normalize();
+        tgRandom& rng = tgRandom::forThread();
         do {
-            arb = btVector3(rand()%10, rand()%10, rand()%10).normalize();
+            arb = btVector3(rng.index(10), rng.index(10), rng.index(10)).normalize();
         } while (arb == v || arb == -v);
         return arb;
     }
@@ -358,6 +360,10 @@ public:
         return floor(d * m + 0.5)/m;
     }
     
+    /**
+     * Seed rand() and this thread's tgRandom stream from the clock. New
+     * code should take a tgRandom rather than rely on either.
+     */
     static void seedRandom();
     
     /// @todo is this necessary? If everyone uses the above function we can just change the 
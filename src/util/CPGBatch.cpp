@@ -0,0 +1,214 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file CPGBatch.cpp
+ * @brief Implementation of class CPGBatch
+ * $Id$
+ */
+
+#include "CPGBatch.h"
+#include "CPGEquations.h"
+#include "CPGEquationsFB.h"
+
+// The Bullet Physics Library
+#include "LinearMath/btQuickprof.h"
+
+// The C++ Standard Library
+#include <algorithm>
+#include <math.h>
+#include <stdexcept>
+
+CPGBatch::CPGBatch(std::size_t systems, bool feedback, double stepSize) :
+m_feedback(feedback),
+m_stepSize(stepSize),
+m_attached(systems, false),
+m_staged(systems, false),
+m_commands(systems),
+m_stagedDt(0.0),
+m_width(0)
+{
+	if (!(stepSize > 0.0))
+	{
+		throw std::invalid_argument("CPG batch step size is not positive");
+	}
+	m_systems.reserve(systems);
+	m_active.reserve(systems);
+	for (std::size_t i = 0; i != systems; i++){
+		if (feedback)
+		{
+			m_systems.push_back(new CPGEquationsFB());
+		}
+		else
+		{
+			m_systems.push_back(new CPGEquations());
+		}
+	}
+}
+
+CPGBatch::~CPGBatch()
+{
+	for (std::size_t i = 0; i != m_systems.size(); i++){
+		delete m_systems[i];
+	}
+}
+
+void CPGBatch::checkSlot(std::size_t slot) const
+{
+	if (slot >= m_systems.size())
+	{
+		throw std::out_of_range("No such CPG batch slot");
+	}
+}
+
+CPGEquations& CPGBatch::attach(std::size_t slot)
+{
+	checkSlot(slot);
+	m_systems[slot]->clear();
+	m_attached[slot] = true;
+	m_staged[slot] = false;
+	return *m_systems[slot];
+}
+
+CPGEquationsFB& CPGBatch::attachFeedback(std::size_t slot)
+{
+	if (!m_feedback)
+	{
+		throw std::logic_error("CPG batch does not hold feedback systems");
+	}
+	return static_cast<CPGEquationsFB&>(attach(slot));
+}
+
+void CPGBatch::detach(std::size_t slot)
+{
+	checkSlot(slot);
+	m_systems[slot]->clear();
+	m_attached[slot] = false;
+	m_staged[slot] = false;
+}
+
+void CPGBatch::stage(std::size_t slot, const std::vector<double>& descCom, double dt)
+{
+	checkSlot(slot);
+	if (!m_attached[slot])
+	{
+		throw std::logic_error("Staging commands for a detached CPG batch slot");
+	}
+	if (!(dt > 0.0))
+	{
+		throw std::invalid_argument("CPG batch dt is not positive");
+	}
+	const bool first = std::find(m_staged.begin(), m_staged.end(), true) == m_staged.end();
+	if (!first && dt != m_stagedDt)
+	{
+		throw std::invalid_argument("CPG batch slots staged with different dt");
+	}
+	m_stagedDt = dt;
+	m_commands[slot].assign(descCom.begin(), descCom.end());
+	m_staged[slot] = true;
+}
+
+void CPGBatch::computeDerivatives(const double* x, double* dxdt) const
+{
+	for (std::size_t r = 0; r != m_active.size(); r++){
+		m_systems[m_active[r]]->computeDerivatives(x + r * m_width, dxdt + r * m_width);
+	}
+}
+
+void CPGBatch::update()
+{
+#ifndef BT_NO_PROFILE
+    BT_PROFILE("CPGBatch::update");
+#endif //BT_NO_PROFILE
+	m_active.clear();
+	for (std::size_t i = 0; i != m_systems.size(); i++){
+		if (m_staged[i])
+		{
+			m_active.push_back(i);
+			m_staged[i] = false;
+		}
+	}
+	if (m_active.empty())
+	{
+		return;
+	}
+
+	const CPGEquations& first = *m_systems[m_active[0]];
+	m_width = 3 * first.nodeList.size();
+	for (std::size_t r = 0; r != m_active.size(); r++){
+		CPGEquations& system = *m_systems[m_active[r]];
+		system.prepareDerivatives(m_commands[m_active[r]]);
+		if (system.nodeList.size() != first.nodeList.size() ||
+			!system.m_coupling.samePattern(first.m_coupling))
+		{
+			throw std::invalid_argument("CPG batch slots do not share a topology");
+		}
+	}
+
+	const std::size_t n = m_active.size() * m_width;
+	if (n == 0)
+	{
+		return;
+	}
+	m_x.resize(n);
+	m_k1.resize(n);
+	m_k2.resize(n);
+	m_k3.resize(n);
+	m_k4.resize(n);
+	m_stage.resize(n);
+
+	for (std::size_t r = 0; r != m_active.size(); r++){
+		const std::vector<double>& xVars = m_systems[m_active[r]]->getXVars();
+		std::copy(xVars.begin(), xVars.end(), m_x.begin() + r * m_width);
+	}
+
+	double* const x = &m_x[0];
+	double* const k1 = &m_k1[0];
+	double* const k2 = &m_k2[0];
+	double* const k3 = &m_k3[0];
+	double* const k4 = &m_k4[0];
+	double* const stage = &m_stage[0];
+
+	// As CPGEquations::integrateFixedStep, over every row at once
+	const double dt = m_stagedDt;
+	const int steps = std::max(1, (int) ceil(dt / m_stepSize - 1e-9));
+	const double h = dt / steps;
+	for (int s = 0; s != steps; s++){
+		computeDerivatives(x, k1);
+		for (std::size_t i = 0; i != n; i++){
+			stage[i] = x[i] + 0.5 * h * k1[i];
+		}
+		computeDerivatives(stage, k2);
+		for (std::size_t i = 0; i != n; i++){
+			stage[i] = x[i] + 0.5 * h * k2[i];
+		}
+		computeDerivatives(stage, k3);
+		for (std::size_t i = 0; i != n; i++){
+			stage[i] = x[i] + h * k3[i];
+		}
+		computeDerivatives(stage, k4);
+		for (std::size_t i = 0; i != n; i++){
+			x[i] += h / 6.0 * (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]);
+		}
+	}
+
+	for (std::size_t r = 0; r != m_active.size(); r++){
+		m_row.assign(m_x.begin() + r * m_width, m_x.begin() + (r + 1) * m_width);
+		m_systems[m_active[r]]->updateNodeData(m_row);
+	}
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_UTIL_CPGS_CPGBATCH
+#define SRC_UTIL_CPGS_CPGBATCH
+
+/**
+ * @file CPGBatch.h
+ * @brief Definition of class CPGBatch
+ * $Id$
+ */
+
+#include <vector>
+#include <cstddef>
+
+class CPGEquations;
+class CPGEquationsFB;
+
+/**
+ * A fixed number of CPG systems, one per slot, integrated together. Meant
+ * for a population evaluated in parallel worlds stepped in lock-step,
+ * as by tgVecEnv, where every controller builds the same network with
+ * different parameters.
+ *
+ * The systems are created with the batch and kept for its lifetime. A
+ * controller attaches to a slot at setup, builds the slot's system
+ * through addNode and defineConnections as it would one of its own, and
+ * stages its commands each control step. The owner of the worlds then
+ * calls update() once for all of them: the staged systems' states are
+ * gathered into one contiguous matrix, a row per slot, and advanced
+ * together with fixed fourth order Runge-Kutta steps, as
+ * CPGEquations::setFixedStepSize. Each row's derivatives come from its
+ * own system, so the slots only have to share a topology, not weights
+ * or node parameters.
+ *
+ * Since commands are staged before the batch integrates, a controller
+ * that reads its nodes in the same step as staging sees the state of
+ * the batch's previous update.
+ */
+class CPGBatch
+{
+public:
+
+	/**
+	 * @param[in] systems the number of slots
+	 * @param[in] feedback true for CPGEquationsFB systems, false for
+	 * CPGEquations
+	 * @param[in] stepSize the longest Runge-Kutta step
+	 * @throw std::invalid_argument if stepSize is not positive
+	 */
+	CPGBatch(std::size_t systems, bool feedback, double stepSize = 0.01);
+
+	~CPGBatch();
+
+	std::size_t size() const
+	{
+		return m_systems.size();
+	}
+
+	bool isFeedback() const
+	{
+		return m_feedback;
+	}
+
+	/**
+	 * Attach a controller to a slot. The slot's system is cleared, ready
+	 * to be built again.
+	 * @return the slot's system, a CPGEquationsFB if isFeedback(), owned
+	 * by the batch
+	 * @throw std::out_of_range if there is no such slot
+	 */
+	CPGEquations& attach(std::size_t slot);
+
+	/**
+	 * As attach, for controllers that build a CPGEquationsFB. As addNode
+	 * is not virtual, nodes must be added through this type.
+	 * @throw std::logic_error if the batch is not isFeedback()
+	 */
+	CPGEquationsFB& attachFeedback(std::size_t slot);
+
+	/**
+	 * Release a slot at teardown, dropping any staged commands
+	 * @throw std::out_of_range if there is no such slot
+	 */
+	void detach(std::size_t slot);
+
+	/**
+	 * Stage a slot's commands for the next update(), as for
+	 * CPGEquations::update(descCom, dt)
+	 * @throw std::out_of_range if there is no such slot
+	 * @throw std::logic_error if the slot is not attached
+	 * @throw std::invalid_argument if dt differs from the other slots
+	 * staged for the same update, or is not positive
+	 */
+	void stage(std::size_t slot, const std::vector<double>& descCom, double dt);
+
+	/**
+	 * Integrate every staged slot over the staged dt and push the new
+	 * states back to their nodes. Does nothing if none are staged. Does
+	 * not allocate once the batch has run a network of the same size.
+	 * @throw std::invalid_argument if the staged systems do not share a
+	 * topology
+	 */
+	void update();
+
+private:
+
+	/** Not copyable */
+	CPGBatch(const CPGBatch&);
+	CPGBatch& operator=(const CPGBatch&);
+
+	/** Throw std::out_of_range if there is no such slot */
+	void checkSlot(std::size_t slot) const;
+
+	/** The derivatives of every row of the active slots' states */
+	void computeDerivatives(const double* x, double* dxdt) const;
+
+	std::vector<CPGEquations*> m_systems;
+
+	const bool m_feedback;
+
+	const double m_stepSize;
+
+	std::vector<bool> m_attached;
+	std::vector<bool> m_staged;
+
+	/** Each slot's staged commands, kept to avoid allocating */
+	std::vector< std::vector<double> > m_commands;
+
+	/** The dt of the slots staged since the last update */
+	double m_stagedDt;
+
+	/** The slots being integrated, in row order */
+	std::vector<std::size_t> m_active;
+
+	/** The values in one row of the state, 3 per node */
+	std::size_t m_width;
+
+	/** The state matrix, a row per active slot, and Runge-Kutta stages */
+	std::vector<double> m_x;
+	std::vector<double> m_k1;
+	std::vector<double> m_k2;
+	std::vector<double> m_k3;
+	std::vector<double> m_k4;
+	std::vector<double> m_stage;
+
+	/** One row, to hand back to a system's nodes */
+	std::vector<double> m_row;
+};
+
+#endif // SRC_UTIL_CPGS_CPGBATCH
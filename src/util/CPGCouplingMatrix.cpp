@@ -0,0 +1,92 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file CPGCouplingMatrix.cpp
+ * @brief Implementation of class CPGCouplingMatrix
+ * $Id$
+ */
+
+#include "CPGCouplingMatrix.h"
+
+#include <math.h>
+#include <cassert>
+
+CPGCouplingMatrix::CPGCouplingMatrix()
+{
+	clear();
+}
+
+void CPGCouplingMatrix::clear()
+{
+	m_rowStart.assign(1, 0);
+	m_columns.clear();
+	m_weightCos.clear();
+	m_weightSin.clear();
+}
+
+void CPGCouplingMatrix::addEntry(std::size_t column, double weight, double phaseOffset)
+{
+	m_columns.push_back(column);
+	m_weightCos.push_back(weight * cos(phaseOffset));
+	m_weightSin.push_back(weight * sin(phaseOffset));
+}
+
+void CPGCouplingMatrix::endRow()
+{
+	m_rowStart.push_back(m_columns.size());
+}
+
+void CPGCouplingMatrix::addCoupling(const double* x, double* dxdt, std::size_t count) const
+{
+	const std::size_t n = rows();
+	m_rSin.resize(n);
+	m_rCos.resize(n);
+	m_sin.resize(n);
+	m_cos.resize(n);
+	
+	for (std::size_t s = 0; s != count; s++){
+		const double* state = x + 3 * n * s;
+		double* deriv = dxdt + 3 * n * s;
+		
+		for (std::size_t j = 0; j != n; j++){
+			const double phi = state[3 * j];
+			const double r = state[3 * j + 1];
+			m_sin[j] = sin(phi);
+			m_cos[j] = cos(phi);
+			m_rSin[j] = r * m_sin[j];
+			m_rCos[j] = r * m_cos[j];
+		}
+		
+		// sin(phi_j - phi_i - theta)
+		//   = cos(phi_i) * (sin(phi_j) cos(theta) - cos(phi_j) sin(theta))
+		//   - sin(phi_i) * (cos(phi_j) cos(theta) + sin(phi_j) sin(theta))
+		for (std::size_t i = 0; i != n; i++){
+			double a = 0.0;
+			double b = 0.0;
+			const std::size_t end = m_rowStart[i + 1];
+			for (std::size_t k = m_rowStart[i]; k != end; k++){
+				const std::size_t j = m_columns[k];
+				assert(j < n);
+				a += m_weightCos[k] * m_rSin[j] - m_weightSin[k] * m_rCos[j];
+				b += m_weightCos[k] * m_rCos[j] + m_weightSin[k] * m_rSin[j];
+			}
+			deriv[3 * i] += m_cos[i] * a - m_sin[i] * b;
+		}
+	}
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_UTIL_CPGS_CPGCOUPLINGMATRIX
+#define SRC_UTIL_CPGS_CPGCOUPLINGMATRIX
+
+/**
+ * @file CPGCouplingMatrix.h
+ * @brief Definition of class CPGCouplingMatrix
+ * $Id$
+ */
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * The couplings of a CPG network as a sparse matrix in compressed row
+ * form. Row i holds, for every node j that node i is coupled to, the
+ * weight times the cosine and the sine of the phase offset, so the
+ * coupling term
+ *
+ *   sum_j w_ij * r_j * sin(phi_j - phi_i - theta_ij)
+ *
+ * becomes sin(phi_i) and cos(phi_i) per node plus two sparse
+ * matrix-vector products, instead of one sin per connection.
+ *
+ * States are laid out as CPGEquations::getXVars: (phi, r, third) per
+ * node. The matrix does not depend on the state, so one matrix can be
+ * applied to the states of many identical networks, as in parallel
+ * worlds running the same controller.
+ */
+class CPGCouplingMatrix
+{
+public:
+	
+	CPGCouplingMatrix();
+	
+	/** Drop every row */
+	void clear();
+	
+	/**
+	 * Append an entry to the current row.
+	 * @param[in] column the index of the node being coupled to
+	 * @param[in] weight the coupling weight
+	 * @param[in] phaseOffset the phase offset, in radians
+	 */
+	void addEntry(std::size_t column, double weight, double phaseOffset);
+	
+	/** Close the current row and start the next one */
+	void endRow();
+	
+	/** The number of rows closed by endRow */
+	std::size_t rows() const
+	{
+		return m_rowStart.size() - 1;
+	}
+	
+	/** The number of entries */
+	std::size_t entries() const
+	{
+		return m_columns.size();
+	}
+	
+	/**
+	 * Whether another matrix couples the same nodes, whatever its
+	 * weights and phase offsets
+	 */
+	bool samePattern(const CPGCouplingMatrix& other) const
+	{
+		return m_rowStart == other.m_rowStart && m_columns == other.m_columns;
+	}
+	
+	/**
+	 * Add the coupling terms to the phase derivatives of one state.
+	 * @param[in] x the state, 3 * rows() values
+	 * @param[in,out] dxdt the derivatives; the coupling of node i is added
+	 * to dxdt[3 * i]
+	 */
+	void addCoupling(const double* x, double* dxdt) const
+	{
+		addCoupling(x, dxdt, 1);
+	}
+	
+	/**
+	 * Add the coupling terms for count states stored back to back, each
+	 * 3 * rows() values long.
+	 * Uses scratch space held by the matrix, so one matrix must not be
+	 * applied from several threads at once.
+	 */
+	void addCoupling(const double* x, double* dxdt, std::size_t count) const;
+	
+private:
+	
+	/** Entries of row i are m_rowStart[i] up to m_rowStart[i + 1] */
+	std::vector<std::size_t> m_rowStart;
+	std::vector<std::size_t> m_columns;
+	
+	/** Weight times cos and sin of the phase offset, per entry */
+	std::vector<double> m_weightCos;
+	std::vector<double> m_weightSin;
+	
+	/** r_j * sin(phi_j) and r_j * cos(phi_j) of the current state */
+	mutable std::vector<double> m_rSin;
+	mutable std::vector<double> m_rCos;
+	/** sin(phi_i) and cos(phi_i) of the current state */
+	mutable std::vector<double> m_sin;
+	mutable std::vector<double> m_cos;
+};
+
+#endif // SRC_UTIL_CPGS_CPGCOUPLINGMATRIX
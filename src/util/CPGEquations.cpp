@@ -34,7 +34,9 @@
 
 
 // The C++ Standard Library
+#include <algorithm>
 #include <assert.h>
+#include <map>
 #include <stdexcept>
 
 using namespace boost::numeric::odeint;
@@ -42,25 +44,35 @@ using namespace boost::numeric::odeint;
 typedef std::vector<double > cpgVars_type;
 
 CPGEquations::CPGEquations(int maxSteps) :
+m_connectionsCompiled(false),
 stepSize(0.1),
 numSteps(0),
-m_maxSteps(maxSteps)
+m_maxSteps(maxSteps),
+m_fixedStepSize(0.0)
  {}
 CPGEquations::CPGEquations(std::vector<CPGNode*>& newNodeList, int maxSteps) :
 nodeList(newNodeList),
+m_connectionsCompiled(false),
 stepSize(0.1), //TODO: specify as a parameter somewhere
 numSteps(0),
-m_maxSteps(maxSteps)
+m_maxSteps(maxSteps),
+m_fixedStepSize(0.0)
 {
 }
 
 CPGEquations::~CPGEquations()
+{
+	clear();
+}
+
+void CPGEquations::clear()
 {
 	for (std::size_t i = 0; i < nodeList.size(); i++)
 	{
 		delete nodeList[i];
 	}
 	nodeList.clear();
+	m_connectionsCompiled = false;
 }
 
 // Params needs size 7 to fill all of the params.
@@ -70,6 +82,7 @@ int CPGEquations::addNode(std::vector<double>& newParams)
 	int index = nodeList.size();
 	CPGNode* newNode = new CPGNode(index, newParams);
 	nodeList.push_back(newNode);
+	m_connectionsCompiled = false;
 	
 	return index;
 }
@@ -86,6 +99,7 @@ void CPGEquations::defineConnections (	int nodeIndex,
 	for(int i = 0; i != connections.size(); i++){
 		nodeList[nodeIndex]->addCoupling(nodeList[connections[i]], newWeights[i], newPhaseOffsets[i]); 
 	}
+	m_connectionsCompiled = false;
 }
 
 const double CPGEquations::operator[](const std::size_t i) const
@@ -107,6 +121,17 @@ const double CPGEquations::operator[](const std::size_t i) const
 	return nodeValue;
 }
 
+void CPGEquations::sampleNodesInto(double* out) const
+{
+	for (std::size_t i = 0; i != nodeList.size(); i++){
+		const CPGNode& node = *nodeList[i];
+		out[4 * i] = node.nodeValue;
+		out[4 * i + 1] = node.phiValue;
+		out[4 * i + 2] = node.rValue;
+		out[4 * i + 3] = node.rDotValue;
+	}
+}
+
 std::vector<double>& CPGEquations::getXVars() {
 #ifndef BT_NO_PROFILE 
     BT_PROFILE("CPGEquations::getXVars");
@@ -144,7 +169,7 @@ void CPGEquations::updateNodes(std::vector<double>& descCom)
 	}
 }
 
-void CPGEquations::updateNodeData(std::vector<double> newXVals)
+void CPGEquations::updateNodeData(const std::vector<double>& newXVals)
 {
 #ifndef BT_NO_PROFILE 
     BT_PROFILE("CPGEquations::updateNodeData");
@@ -156,15 +181,131 @@ void CPGEquations::updateNodeData(std::vector<double> newXVals)
 	}
 }
 
+void CPGEquations::compileConnections()
+{
+	if (m_connectionsCompiled)
+	{
+		return;
+	}
+	
+	std::map<const CPGNode*, int> indices;
+	for (std::size_t i = 0; i != nodeList.size(); i++){
+		indices[nodeList[i]] = i;
+	}
+	
+	m_coupling.clear();
+	for (std::size_t i = 0; i != nodeList.size(); i++){
+		const CPGNode& node = *nodeList[i];
+		const std::vector<CPGNode*>& couplings = node.couplingList;
+		for (std::size_t k = 0; k != couplings.size(); k++){
+			std::map<const CPGNode*, int>::const_iterator it = indices.find(couplings[k]);
+			if (it == indices.end())
+			{
+				throw std::invalid_argument("Coupling to a node that is not in this CPG");
+			}
+			m_coupling.addEntry(it->second, node.weightList[k], node.phaseList[k]);
+		}
+		m_coupling.endRow();
+	}
+	m_connectionsCompiled = true;
+}
+
+void CPGEquations::prepareDerivatives(const std::vector<double>& descCom)
+{
+	compileConnections();
+	
+	const std::size_t n = nodeList.size();
+	assert(descCom.size() >= n);
+	m_phiDotBase.resize(n);
+	m_radiusTarget.resize(n);
+	m_rConst.resize(n);
+	for (std::size_t i = 0; i != n; i++){
+		CPGNode& node = *nodeList[i];
+		m_phiDotBase[i] = 2 * M_PI * node.nodeEquation(descCom[i], node.frequencyOffset, node.frequencyScale);
+		m_radiusTarget[i] = node.nodeEquation(descCom[i], node.radiusOffset, node.radiusScale);
+		m_rConst[i] = node.rConst;
+	}
+}
+
+void CPGEquations::computeDerivatives(const double* x, double* dxdt) const
+{
+	// CPGNode::updateDTs, with the coupling added as a sparse product
+	const std::size_t n = nodeList.size();
+	for (std::size_t i = 0; i != n; i++){
+		const double r = x[3 * i + 1];
+		const double rDot = x[3 * i + 2];
+		const double rConst = m_rConst[i];
+		dxdt[3 * i] = m_phiDotBase[i];
+		dxdt[3 * i + 1] = rDot;
+		dxdt[3 * i + 2] = rConst * (rConst / 4 * (m_radiusTarget[i] - r) - rDot);
+	}
+	m_coupling.addCoupling(x, dxdt);
+}
+
+void CPGEquations::setFixedStepSize(double stepSize)
+{
+	if (stepSize < 0.0)
+	{
+		throw std::invalid_argument("Fixed step size is negative");
+	}
+	m_fixedStepSize = stepSize;
+}
+
+void CPGEquations::integrateFixedStep(double dt)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("CPGEquations::integrateFixedStep");
+#endif //BT_NO_PROFILE
+	const std::size_t n = XVars.size();
+	if (n == 0)
+	{
+		return;
+	}
+	m_k1.resize(n);
+	m_k2.resize(n);
+	m_k3.resize(n);
+	m_k4.resize(n);
+	m_stage.resize(n);
+	
+	double* const x = &XVars[0];
+	double* const k1 = &m_k1[0];
+	double* const k2 = &m_k2[0];
+	double* const k3 = &m_k3[0];
+	double* const k4 = &m_k4[0];
+	double* const stage = &m_stage[0];
+	
+	// Allow for dt being a hair over a multiple of the step
+	const int steps = std::max(1, (int) ceil(dt / m_fixedStepSize - 1e-9));
+	const double h = dt / steps;
+	for (int s = 0; s != steps; s++){
+		computeDerivatives(x, k1);
+		for (std::size_t i = 0; i != n; i++){
+			stage[i] = x[i] + 0.5 * h * k1[i];
+		}
+		computeDerivatives(stage, k2);
+		for (std::size_t i = 0; i != n; i++){
+			stage[i] = x[i] + 0.5 * h * k2[i];
+		}
+		computeDerivatives(stage, k3);
+		for (std::size_t i = 0; i != n; i++){
+			stage[i] = x[i] + h * k3[i];
+		}
+		computeDerivatives(stage, k4);
+		for (std::size_t i = 0; i != n; i++){
+			x[i] += h / 6.0 * (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]);
+		}
+		numSteps += 4;
+	}
+}
+
 /**
  * Function object for interfacing with ODE Int
  */
 class integrate_function {
 	public:
 	
-	integrate_function(CPGEquations* pCPGs, std::vector<double> newComs) :
-	theseCPGs(pCPGs),
-	descCom(newComs)
+	integrate_function(CPGEquations* pCPGs) :
+	theseCPGs(pCPGs)
 	{
 		
 	}
@@ -176,19 +317,13 @@ class integrate_function {
 #ifndef BT_NO_PROFILE 
         BT_PROFILE("CPGEquations::integrate_function");
 #endif //BT_NO_PROFILE
-		theseCPGs->updateNodeData(x);
-		theseCPGs->updateNodes(descCom);
-	
 		/**
-		 * Read information from nodes into variables that work for ODEInt
+		 * Computed straight from the state, rather than by pushing it
+		 * through the nodes and reading it back
 		 */
-		std::vector<double> dXVars = theseCPGs->getDXVars();
-		/**
-		 * Values are pre-computed by nodes, so we just have to transfer
-		 * them
-		 */
-		for(std::size_t i = 0; i != x.size(); i++){
-			dxdt[i] = dXVars[i];
+		if (!x.empty())
+		{
+			theseCPGs->computeDerivatives(&x[0], &dxdt[0]);
 		}
 		//std::cout<<"operator call"<<std::endl;
 		
@@ -198,7 +333,6 @@ class integrate_function {
 	
 	private:
 	CPGEquations* theseCPGs;
-	std::vector<double> descCom;
 };
 
 /**
@@ -247,10 +381,19 @@ void CPGEquations::update(std::vector<double>& descCom, double dt)
 	 */
 	std::vector<double>& xVars = getXVars(); 
 	
+	prepareDerivatives(descCom);
+	
+	if (m_fixedStepSize > 0.0)
+	{
+		integrateFixedStep(dt);
+		updateNodeData(xVars);
+		return;
+	}
+	
 	/**
 	 * Run ODEInt. This will change the data in xVars
 	 */
-	integrate(integrate_function(this, descCom), xVars, 0.0, dt, stepSize, output_function(this));
+	integrate(integrate_function(this), xVars, 0.0, dt, stepSize, output_function(this));
 	
     if (numSteps > m_maxSteps)
     {
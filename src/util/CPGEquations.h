@@ -27,10 +27,12 @@
  * $Id$
  */
 
+#include <math.h>
 #include <vector>
 #include <sstream>
 
 #include "CPGNode.h"
+#include "CPGCouplingMatrix.h"
 
 /**
  * The top level class for interfacing with CPGs. Contains the definition
@@ -38,6 +40,11 @@
  */
 class CPGEquations
 {
+	/** The odeint right hand side, in CPGEquations.cpp */
+	friend class integrate_function;
+	/** Integrates many systems' states together */
+	friend class CPGBatch;
+	
  public:
 	
 	CPGEquations(int maxSteps = 200);
@@ -47,6 +54,12 @@ class CPGEquations
 	virtual ~CPGEquations();
 	
 	int addNode(std::vector<double>& newParams);
+	
+	/**
+	 * Delete every node, so the system can be built again by addNode
+	 * and defineConnections without being reallocated
+	 */
+	void clear();
 
 	 void defineConnections (int nodeIndex,
 				 std::vector<int> connections,
@@ -54,6 +67,19 @@ class CPGEquations
 				 std::vector<double> newPhaseOffsets);
 	
 	const double operator[](const std::size_t i) const;
+	
+	/** The number of nodes */
+	std::size_t size() const
+	{
+		return nodeList.size();
+	}
+	
+	/**
+	 * Write each node's value, phase, radius and radius rate, in that
+	 * order, without allocating, for tgCPGSensor
+	 * @param[out] out room for 4 * size() doubles
+	 */
+	void sampleNodesInto(double* out) const;
 
 	virtual std::vector<double>& getXVars();
 	
@@ -61,13 +87,24 @@ class CPGEquations
 	
 	virtual void updateNodes(std::vector<double>& descCom);
 	
-	virtual void updateNodeData(std::vector<double> newXVals);
+	virtual void updateNodeData(const std::vector<double>& newXVals);
 	
 	/**
 	 * Call the integrator a the specified timestep
 	 */
 	void update(std::vector<double>& descCom, double dt);
 	
+	/**
+	 * Integrate with the classic fourth order Runge-Kutta method at a
+	 * fixed step instead of odeint's adaptive stepper, so every update
+	 * costs the same. maxSteps is not checked in this mode.
+	 * @param[in] stepSize the longest step; update(descCom, dt) takes
+	 * ceil(dt / stepSize) equal steps. 0, the default, goes back to the
+	 * adaptive stepper.
+	 * @throw std::invalid_argument if stepSize is negative
+	 */
+	void setFixedStepSize(double stepSize);
+	
 	std::string toString(const std::string& prefix = "") const;
 	
     void countStep()
@@ -77,8 +114,37 @@ class CPGEquations
     
 protected:
 	
+	/**
+	 * The derivatives of a state laid out as getXVars, computed from flat
+	 * arrays rather than through the nodes. Valid after
+	 * prepareDerivatives; does not allocate.
+	 * @param[in] x the state
+	 * @param[out] dxdt the derivatives, the same size as x
+	 */
+	virtual void computeDerivatives(const double* x, double* dxdt) const;
+	
+	/**
+	 * Called once per update, before any computeDerivatives. Compiles the
+	 * connections if they changed and precomputes whatever only depends
+	 * on the commands.
+	 */
+	virtual void prepareDerivatives(const std::vector<double>& descCom);
+	
+	/**
+	 * Rebuild m_coupling from the nodes' coupling lists, if nodes or
+	 * connections were added since the last time. Weights and phase
+	 * offsets changed on the nodes directly are not picked up.
+	 */
+	void compileConnections();
+	
 	std::vector<CPGNode*> nodeList;
 	
+	/** The nodes' couplings, built by compileConnections */
+	CPGCouplingMatrix m_coupling;
+	
+	/** Cleared whenever a node or connection is added */
+	bool m_connectionsCompiled;
+	
     std::vector<double> XVars;
     std::vector<double> DXVars;
     
@@ -87,6 +153,28 @@ protected:
     int m_maxSteps;
     int numSteps;
     
+private:
+	
+	/** Take fixed Runge-Kutta steps over dt, starting from XVars */
+	void integrateFixedStep(double dt);
+	
+	/** 0 for the adaptive stepper */
+	double m_fixedStepSize;
+	
+	/**
+	 * Per node terms of the derivatives that only depend on the
+	 * commands, set by prepareDerivatives
+	 */
+	std::vector<double> m_phiDotBase;
+	std::vector<double> m_radiusTarget;
+	std::vector<double> m_rConst;
+	
+	/** Runge-Kutta stages, kept to avoid allocating on every update */
+	std::vector<double> m_k1;
+	std::vector<double> m_k2;
+	std::vector<double> m_k3;
+	std::vector<double> m_k4;
+	std::vector<double> m_stage;
 };
 
 /**
@@ -36,6 +36,7 @@
 
 // The C++ Standard Library
 #include <assert.h>
+#include <math.h>
 #include <stdexcept>
 #include <iterator> 
 
@@ -61,6 +62,7 @@ int CPGEquationsFB::addNode(std::vector<double>& newParams)
 	int index = nodeList.size();
 	CPGNodeFB* newNode = new CPGNodeFB(index, newParams);
 	nodeList.push_back(newNode);
+	m_connectionsCompiled = false;
 	
 	return index;
 }
@@ -116,7 +118,7 @@ void CPGEquationsFB::updateNodes(std::vector<double>& descCom)
 	}
 }
 
-void CPGEquationsFB::updateNodeData(std::vector<double> newXVals)
+void CPGEquationsFB::updateNodeData(const std::vector<double>& newXVals)
 {
 #ifndef BT_NO_PROFILE 
     BT_PROFILE("CPGEquationsFB::updateNodeData");
@@ -128,3 +130,40 @@ void CPGEquationsFB::updateNodeData(std::vector<double> newXVals)
 		currentNode->updateNodeValues(newXVals[3*i], newXVals[3*i+1], newXVals[3*i+2]);
 	}
 }
+
+void CPGEquationsFB::prepareDerivatives(const std::vector<double>& descCom)
+{
+	compileConnections();
+	
+	const std::size_t n = nodeList.size();
+	assert(descCom.size() == n * 3);
+	m_phaseFeedback.resize(n);
+	m_frequencyFeedback.resize(n);
+	m_radiusTarget.resize(n);
+	m_rConst.resize(n);
+	for (std::size_t i = 0; i != n; i++){
+		CPGNodeFB* currentNode = tgCast::cast<CPGNode, CPGNodeFB>(nodeList[i]);
+		assert(currentNode);
+		const double* const feedback = &descCom[3 * i];
+		m_phaseFeedback[i] = currentNode->kPhase * feedback[2];
+		m_frequencyFeedback[i] = currentNode->kFreq * feedback[0];
+		m_radiusTarget[i] = currentNode->radiusOffset + currentNode->kAmp * feedback[1];
+		m_rConst[i] = currentNode->rConst;
+	}
+}
+
+void CPGEquationsFB::computeDerivatives(const double* x, double* dxdt) const
+{
+	// CPGNodeFB::updateDTs, with the coupling added as a sparse product
+	const std::size_t n = nodeList.size();
+	for (std::size_t i = 0; i != n; i++){
+		const double phi = x[3 * i];
+		const double r = x[3 * i + 1];
+		const double omega = x[3 * i + 2];
+		
+		dxdt[3 * i] = omega + m_phaseFeedback[i];
+		dxdt[3 * i + 1] = m_rConst[i] * (m_radiusTarget[i] - pow(r, 2.0)) * r;
+		dxdt[3 * i + 2] = m_frequencyFeedback[i] * sin(phi);
+	}
+	m_coupling.addCoupling(x, dxdt);
+}
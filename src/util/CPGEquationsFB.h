@@ -59,8 +59,25 @@ class CPGEquationsFB : public CPGEquations
 	
 	void updateNodes(std::vector<double>& descCom);
 	
-	void updateNodeData(std::vector<double> newXVals);
+	void updateNodeData(const std::vector<double>& newXVals);
 
+protected:
+	
+	/** As for CPGNodeFB::updateDTs, which takes three commands per node */
+	void computeDerivatives(const double* x, double* dxdt) const;
+	
+	void prepareDerivatives(const std::vector<double>& descCom);
+	
+private:
+	
+	/**
+	 * Per node terms of the derivatives that only depend on the
+	 * feedback, set by prepareDerivatives
+	 */
+	std::vector<double> m_phaseFeedback;
+	std::vector<double> m_frequencyFeedback;
+	std::vector<double> m_radiusTarget;
+	std::vector<double> m_rConst;
 };
 
 #endif // SIMULATOR_SRC_LIB_MODELS_SNAKE_CPGS_CPGEQUATIONS
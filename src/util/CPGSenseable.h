@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef SRC_UTIL_CPGS_CPGSENSEABLE
+#define SRC_UTIL_CPGS_CPGSENSEABLE
+
+/**
+ * @file CPGSenseable.h
+ * @brief Definition of interface class CPGSenseable
+ * $Id$
+ */
+
+#include "core/tgSenseable.h"
+
+#include <string>
+#include <vector>
+
+class CPGEquations;
+
+/**
+ * Something a tgDataManager can log the CPG state of, through
+ * tgCPGSensorInfo. Usually the controller that owns the CPGEquations:
+ * the controller lasts for the whole run while its system may be
+ * rebuilt every episode, so the sensor asks for the system each time it
+ * samples.
+ */
+class CPGSenseable : public tgSenseable
+{
+public:
+
+	virtual ~CPGSenseable() { }
+
+	/**
+	 * The system to sense
+	 * @return the current system, or NULL if there is none
+	 */
+	virtual const CPGEquations* getCPGSystem() const = 0;
+
+	/** Put between the parentheses of the sensor's headings */
+	virtual std::string getCPGLabel() const
+	{
+		return "";
+	}
+
+	/** A CPGSenseable has no descendants */
+	virtual std::vector<tgSenseable*> getSenseableDescendants() const
+	{
+		return std::vector<tgSenseable*>();
+	}
+};
+
+#endif // SRC_UTIL_CPGS_CPGSENSEABLE
@@ -36,16 +36,38 @@
 #include "LinearMath/btVector3.h"
 // The C++ Standard Library
 #include <iostream>
+#include <string>
 
 /**
  * The entry point.
  * @param[in] argc the number of command-line arguments
  * @param[in] argv argv[0] is the executable name
- * @param[in] argv argv[1] is the path of the YAML encoded structure
- * @return 0
+ * @param[in] argv argv[1] is the path of the YAML encoded structure, or of
+ * one compiled with --compile
+ * @param[in] argv with "--compile <structure.yaml> <model>" as the
+ * arguments, the structure is written to the binary file model instead of
+ * being simulated
+ * @return 0, or 1 on a usage error
  */
 int main(int argc, char** argv)
 {
+    if (argc > 1 && std::string(argv[1]) == "--compile")
+    {
+        if (argc != 4)
+        {
+            std::cerr << "Usage: " << argv[0] << " --compile <structure.yaml> <model>" << std::endl;
+            return 1;
+        }
+        TensegrityModel model(argv[2]);
+        model.compile(argv[3]);
+        return 0;
+    }
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <structure.yaml | model>" << std::endl;
+        return 1;
+    }
+
     // create the ground and world. Specify ground rotation in radians
     const double yaw = 0.0;
     const double pitch = 0.0;
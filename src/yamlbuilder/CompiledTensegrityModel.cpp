@@ -0,0 +1,420 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file CompiledTensegrityModel.cpp
+ * @brief Contains the definition of the members of the class CompiledTensegrityModel.
+ * $Id$
+ */
+
+#include "CompiledTensegrityModel.h"
+// C++ Standard Library
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <stdint.h>
+// NTRT Core and tgCreator Libraries
+#include "tgcreator/tgNode.h"
+#include "tgcreator/tgPair.h"
+#include "tgcreator/tgStructure.h"
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char kMagic[8] = {'N', 'T', 'R', 'T', 'M', 'D', 'L', '\0'};
+
+    /** Bump whenever a record below changes */
+    const uint32_t kVersion = 1;
+
+    /*
+     * The file is a Header followed by the records, one array per type in
+     * the order of the counts in the header, then stringCount + 1 string
+     * offsets and the nul-terminated strings they point into. Every record
+     * is a multiple of 8 bytes, so the doubles are aligned in the mapping.
+     */
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t structureCount;
+        uint32_t nodeCount;
+        uint32_t pairCount;
+        uint32_t builderCount;
+        uint32_t parameterCount;
+        uint32_t stringCount;
+        uint32_t stringBytes;
+    };
+
+    /** Structures are stored depth first, each followed by its children */
+    struct StructureRecord {
+        uint32_t tags;
+        uint32_t firstNode;
+        uint32_t nodeCount;
+        uint32_t firstPair;
+        uint32_t pairCount;
+        uint32_t childCount;
+    };
+
+    struct NodeRecord {
+        double position[3];
+        uint32_t tags;
+        uint32_t padding;
+    };
+
+    struct PairRecord {
+        double from[3];
+        double to[3];
+        uint32_t tags;
+        uint32_t padding;
+    };
+
+    struct BuilderRecord {
+        uint32_t tag;
+        uint32_t builderClass;
+        uint32_t firstParameter;
+        uint32_t parameterCount;
+    };
+
+    struct ParameterRecord {
+        uint32_t name;
+        uint32_t value;
+    };
+
+    /** Collects the records of a structure, sharing repeated strings */
+    class Writer
+    {
+    public:
+        std::vector<StructureRecord> structures;
+        std::vector<NodeRecord> nodes;
+        std::vector<PairRecord> pairs;
+        std::vector<BuilderRecord> builders;
+        std::vector<ParameterRecord> parameters;
+        std::vector<std::string> strings;
+
+        uint32_t intern(const std::string& s) {
+            std::map<std::string, uint32_t>::const_iterator it = m_ids.find(s);
+            if (it != m_ids.end()) return it->second;
+            const uint32_t id = strings.size();
+            strings.push_back(s);
+            m_ids[s] = id;
+            return id;
+        }
+
+        void addStructure(const tgStructure& structure) {
+            const std::vector<tgNode>& structureNodes = structure.getNodes().getNodes();
+            const std::vector<tgPair>& structurePairs = structure.getPairs().getPairs();
+            const std::vector<tgStructure*>& children = structure.getChildren();
+
+            StructureRecord record;
+            record.tags = intern(structure.getTagStr());
+            record.firstNode = nodes.size();
+            record.nodeCount = structureNodes.size();
+            record.firstPair = pairs.size();
+            record.pairCount = structurePairs.size();
+            record.childCount = children.size();
+            structures.push_back(record);
+
+            for (std::size_t i = 0; i < structureNodes.size(); i++) {
+                const tgNode& node = structureNodes[i];
+                NodeRecord n;
+                n.position[0] = node.x();
+                n.position[1] = node.y();
+                n.position[2] = node.z();
+                n.tags = intern(node.getTagStr());
+                n.padding = 0;
+                nodes.push_back(n);
+            }
+            for (std::size_t i = 0; i < structurePairs.size(); i++) {
+                const tgPair& pair = structurePairs[i];
+                PairRecord p;
+                for (int j = 0; j < 3; j++) {
+                    p.from[j] = pair.getFrom()[j];
+                    p.to[j] = pair.getTo()[j];
+                }
+                p.tags = intern(pair.getTagStr());
+                p.padding = 0;
+                pairs.push_back(p);
+            }
+            for (std::size_t i = 0; i < children.size(); i++) {
+                addStructure(*children[i]);
+            }
+        }
+
+        void addBuilders(const YAML::Node& section) {
+            for (YAML::const_iterator builder = section.begin(); builder != section.end(); ++builder) {
+                const std::string tagMatch = builder->first.as<std::string>();
+                if (!builder->second["class"]) throw std::invalid_argument("Builder class not supplied for tag: " + tagMatch);
+                BuilderRecord record;
+                record.tag = intern(tagMatch);
+                record.builderClass = intern(builder->second["class"].as<std::string>());
+                record.firstParameter = parameters.size();
+                const YAML::Node builderParameters = builder->second["parameters"];
+                if (builderParameters && !builderParameters.IsNull()) {
+                    if (!builderParameters.IsMap()) {
+                        throw std::invalid_argument("Builder parameters must be a map for tag: " + tagMatch);
+                    }
+                    for (YAML::const_iterator parameter = builderParameters.begin();
+                         parameter != builderParameters.end(); ++parameter) {
+                        if (!parameter->second.IsScalar()) {
+                            throw std::invalid_argument("Builder parameters must be scalars for tag: " + tagMatch);
+                        }
+                        ParameterRecord p;
+                        p.name = intern(parameter->first.as<std::string>());
+                        p.value = intern(parameter->second.Scalar());
+                        parameters.push_back(p);
+                    }
+                }
+                record.parameterCount = parameters.size() - record.firstParameter;
+                builders.push_back(record);
+            }
+        }
+
+    private:
+        std::map<std::string, uint32_t> m_ids;
+    };
+
+    template <typename T>
+    void writeArray(std::ofstream& out, const std::vector<T>& records) {
+        if (!records.empty()) {
+            out.write(reinterpret_cast<const char*>(&records[0]), records.size() * sizeof(T));
+        }
+    }
+
+    /** A read-only mapping of a whole file, unmapped on destruction */
+    class Mapping
+    {
+    public:
+        explicit Mapping(const std::string& path) : m_pData(NULL), m_size(0) {
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw std::runtime_error("Cannot open compiled model: " + path);
+            struct stat info;
+            if (fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(Header)) {
+                close(fd);
+                throw std::runtime_error("Not a compiled model: " + path);
+            }
+            m_size = info.st_size;
+            void* const p = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (p == MAP_FAILED) throw std::runtime_error("Cannot map compiled model: " + path);
+            m_pData = static_cast<const char*>(p);
+        }
+
+        ~Mapping() {
+            munmap(const_cast<char*>(m_pData), m_size);
+        }
+
+        const char* data() const { return m_pData; }
+        std::size_t size() const { return m_size; }
+
+    private:
+        const char* m_pData;
+        std::size_t m_size;
+
+        Mapping(const Mapping&);
+        Mapping& operator=(const Mapping&);
+    };
+
+    /** Checked access to the arrays of a mapped file */
+    class Reader
+    {
+    public:
+        Reader(const Mapping& mapping, const std::string& path) : m_path(path), m_next(0) {
+            std::memcpy(&m_header, mapping.data(), sizeof(Header));
+            if (std::memcmp(m_header.magic, kMagic, sizeof(kMagic)) != 0) fail("not a compiled model");
+            if (m_header.version != kVersion) fail("compiled by a different version; recompile it");
+
+            // Lay out the sections, and only point into them once the file
+            // is known to be big enough
+            uint64_t offset = sizeof(Header);
+            const uint64_t structures = section<StructureRecord>(m_header.structureCount, offset);
+            const uint64_t nodes = section<NodeRecord>(m_header.nodeCount, offset);
+            const uint64_t pairs = section<PairRecord>(m_header.pairCount, offset);
+            const uint64_t builders = section<BuilderRecord>(m_header.builderCount, offset);
+            const uint64_t parameters = section<ParameterRecord>(m_header.parameterCount, offset);
+            const uint64_t offsets = section<uint32_t>((uint64_t) m_header.stringCount + 1, offset);
+            const uint64_t strings = offset;
+            if (offset + m_header.stringBytes != mapping.size()) fail("truncated or corrupt");
+
+            const char* const p = mapping.data();
+            m_pStructures = reinterpret_cast<const StructureRecord*>(p + structures);
+            m_pNodes = reinterpret_cast<const NodeRecord*>(p + nodes);
+            m_pPairs = reinterpret_cast<const PairRecord*>(p + pairs);
+            m_pBuilders = reinterpret_cast<const BuilderRecord*>(p + builders);
+            m_pParameters = reinterpret_cast<const ParameterRecord*>(p + parameters);
+            m_pOffsets = reinterpret_cast<const uint32_t*>(p + offsets);
+            m_pStrings = p + strings;
+
+            if (m_header.structureCount == 0 || m_pOffsets[0] != 0 ||
+                m_pOffsets[m_header.stringCount] != m_header.stringBytes) {
+                fail("corrupt");
+            }
+            for (uint32_t i = 0; i < m_header.stringCount; i++) {
+                if (m_pOffsets[i + 1] <= m_pOffsets[i] || m_pOffsets[i + 1] > m_header.stringBytes ||
+                    m_pStrings[m_pOffsets[i + 1] - 1] != '\0') {
+                    fail("corrupt string table");
+                }
+            }
+        }
+
+        void readStructure(tgStructure& structure) {
+            if (m_next >= m_header.structureCount) fail("corrupt structure tree");
+            const StructureRecord& record = m_pStructures[m_next++];
+            if ((uint64_t) record.firstNode + record.nodeCount > m_header.nodeCount ||
+                (uint64_t) record.firstPair + record.pairCount > m_header.pairCount) {
+                fail("corrupt structure");
+            }
+            structure.setTags(tgTags(string(record.tags)));
+            for (uint32_t i = 0; i < record.nodeCount; i++) {
+                const NodeRecord& n = m_pNodes[record.firstNode + i];
+                structure.addNode(n.position[0], n.position[1], n.position[2], string(n.tags));
+            }
+            for (uint32_t i = 0; i < record.pairCount; i++) {
+                const PairRecord& p = m_pPairs[record.firstPair + i];
+                structure.addPair(btVector3(p.from[0], p.from[1], p.from[2]),
+                    btVector3(p.to[0], p.to[1], p.to[2]), string(p.tags));
+            }
+            for (uint32_t i = 0; i < record.childCount; i++) {
+                tgStructure* const pChild = new tgStructure();
+                try {
+                    readStructure(*pChild);
+                }
+                catch (...) {
+                    delete pChild;
+                    throw;
+                }
+                structure.addChild(pChild);
+            }
+        }
+
+        void readBuilders(std::vector<YAML::Node>& builders) {
+            for (uint32_t i = 0; i < m_header.builderCount; i++) {
+                const BuilderRecord& record = m_pBuilders[i];
+                if ((uint64_t) record.firstParameter + record.parameterCount > m_header.parameterCount) {
+                    fail("corrupt builder");
+                }
+                YAML::Node builder;
+                builder["class"] = string(record.builderClass);
+                if (record.parameterCount > 0) {
+                    YAML::Node builderParameters;
+                    for (uint32_t j = 0; j < record.parameterCount; j++) {
+                        const ParameterRecord& p = m_pParameters[record.firstParameter + j];
+                        builderParameters[string(p.name)] = string(p.value);
+                    }
+                    builder["parameters"] = builderParameters;
+                }
+                YAML::Node section;
+                section[string(record.tag)] = builder;
+                builders.push_back(section);
+            }
+        }
+
+        bool done() const {
+            return m_next == m_header.structureCount;
+        }
+
+        void fail(const std::string& why) const {
+            throw std::runtime_error("Compiled model " + m_path + ": " + why);
+        }
+
+    private:
+        /** Advance past a section, returning where it starts */
+        template <typename T>
+        static uint64_t section(uint64_t count, uint64_t& offset) {
+            const uint64_t start = offset;
+            offset += count * sizeof(T);
+            return start;
+        }
+
+        std::string string(uint32_t id) const {
+            if (id >= m_header.stringCount) fail("corrupt string reference");
+            return std::string(m_pStrings + m_pOffsets[id]);
+        }
+
+        const std::string m_path;
+        Header m_header;
+        const StructureRecord* m_pStructures;
+        const NodeRecord* m_pNodes;
+        const PairRecord* m_pPairs;
+        const BuilderRecord* m_pBuilders;
+        const ParameterRecord* m_pParameters;
+        const uint32_t* m_pOffsets;
+        const char* m_pStrings;
+        uint32_t m_next;
+    };
+}
+
+bool CompiledTensegrityModel::isCompiled(const std::string& path) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    char magic[sizeof(kMagic)];
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+void CompiledTensegrityModel::write(const std::string& path, const tgStructure& structure,
+    const std::vector<YAML::Node>& builders) {
+    Writer writer;
+    writer.addStructure(structure);
+    for (std::size_t i = 0; i < builders.size(); i++) {
+        writer.addBuilders(builders[i]);
+    }
+
+    std::vector<uint32_t> offsets(1, 0);
+    for (std::size_t i = 0; i < writer.strings.size(); i++) {
+        offsets.push_back(offsets.back() + writer.strings[i].size() + 1);
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.structureCount = writer.structures.size();
+    header.nodeCount = writer.nodes.size();
+    header.pairCount = writer.pairs.size();
+    header.builderCount = writer.builders.size();
+    header.parameterCount = writer.parameters.size();
+    header.stringCount = writer.strings.size();
+    header.stringBytes = offsets.back();
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Cannot write compiled model: " + path);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeArray(out, writer.structures);
+    writeArray(out, writer.nodes);
+    writeArray(out, writer.pairs);
+    writeArray(out, writer.builders);
+    writeArray(out, writer.parameters);
+    writeArray(out, offsets);
+    for (std::size_t i = 0; i < writer.strings.size(); i++) {
+        out.write(writer.strings[i].c_str(), writer.strings[i].size() + 1);
+    }
+    out.close();
+    if (!out) throw std::runtime_error("Cannot write compiled model: " + path);
+}
+
+void CompiledTensegrityModel::read(const std::string& path, tgStructure& structure,
+    std::vector<YAML::Node>& builders) {
+    const Mapping mapping(path);
+    Reader reader(mapping, path);
+    reader.readStructure(structure);
+    if (!reader.done()) reader.fail("corrupt structure tree");
+    reader.readBuilders(builders);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef COMPILED_TENSEGRITY_MODEL_H
+#define COMPILED_TENSEGRITY_MODEL_H
+
+/**
+ * @file CompiledTensegrityModel.h
+ * @brief Contains the definition of class CompiledTensegrityModel.
+ * $Id$
+ */
+
+// C++ Standard Library
+#include <string>
+#include <vector>
+// Helper libraries
+#include <yaml-cpp/yaml.h>
+
+// Forward declarations
+class tgStructure;
+
+/**
+ * Reads and writes the binary form of a YAML-encoded structure, made by
+ * BuildTensegrityModel --compile. The file holds the fully built structure
+ * (children, nodes and pairs with their tags, after all substructures,
+ * transforms and bonds were applied) and the builders in the order they
+ * were added to the spec, so loading it is a few passes over flat arrays
+ * with no YAML parsing.
+ *
+ * The file is in the byte order and floating point format of the machine
+ * that wrote it, and is rejected by builds that expect a different
+ * version of the format. Recompile the YAML when either changes.
+ */
+class CompiledTensegrityModel
+{
+public:
+
+    /**
+     * Does the file start like a compiled model? Cheap enough to call on
+     * every setup.
+     * @param[in] path the file to look at
+     */
+    static bool isCompiled(const std::string& path);
+
+    /**
+     * Write a compiled model.
+     * @param[in] path the file to write
+     * @param[in] structure the built structure
+     * @param[in] builders the "builders" sections of the YAML, in the order
+     * they were added to the spec
+     * @throw std::invalid_argument if a builder parameter is not a scalar
+     * @throw std::runtime_error if the file cannot be written
+     */
+    static void write(const std::string& path, const tgStructure& structure,
+        const std::vector<YAML::Node>& builders);
+
+    /**
+     * Read a compiled model. The file is mapped into memory rather than
+     * read.
+     * @param[in] path the file to read
+     * @param[out] structure must be empty; gets the nodes, pairs, children
+     * and tags from the file
+     * @param[out] builders the builders are appended to this, as one
+     * "builders" section each
+     * @throw std::runtime_error if the file cannot be read or is not a
+     * compiled model of this version
+     */
+    static void read(const std::string& path, tgStructure& structure,
+        std::vector<YAML::Node>& builders);
+};
+
+#endif  // COMPILED_TENSEGRITY_MODEL_H
@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef MODEL_CONTROLLER_REGISTRY_H
+#define MODEL_CONTROLLER_REGISTRY_H
+
+/**
+ * @file ModelControllerRegistry.h
+ * @brief Contains the definition of class ModelControllerRegistry, the
+ * controllers ntrt-run can attach to a TensegrityModel by name
+ * $Id$
+ */
+
+// NTRT Core Library
+#include "core/tgObserver.h"
+// C++ Standard Library
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class TensegrityModel;
+
+/**
+ * The controllers RunTensegrityModel can create by name. A plugin is a
+ * shared library exporting
+ *
+ *     extern "C" void ntrtRegisterControllers(ModelControllerRegistry& registry);
+ *
+ * which adds its factories. Everything here is inline, so a plugin needs
+ * no symbols from the executable.
+ */
+class ModelControllerRegistry
+{
+public:
+
+    /**
+     * Creates a controller.
+     * @param[in] args the --arg values from the command line, in order
+     * @return a new controller, deleted by the caller after teardown
+     */
+    typedef tgObserver<TensegrityModel>* (*Factory)(const std::vector<std::string>& args);
+
+    /** The type of a plugin's ntrtRegisterControllers */
+    typedef void (*RegisterFunction)(ModelControllerRegistry& registry);
+
+    /**
+     * Add a factory, replacing any of the same name, so a plugin can
+     * override a built in controller.
+     */
+    void add(const std::string& name, Factory factory)
+    {
+        m_factories[name] = factory;
+    }
+
+    bool contains(const std::string& name) const
+    {
+        return m_factories.find(name) != m_factories.end();
+    }
+
+    /**
+     * @return a new controller, or NULL for a factory that makes none
+     * @throw std::invalid_argument if no factory has that name
+     */
+    tgObserver<TensegrityModel>* create(const std::string& name,
+                                        const std::vector<std::string>& args) const
+    {
+        const std::map<std::string, Factory>::const_iterator it =
+            m_factories.find(name);
+        if (it == m_factories.end())
+        {
+            throw std::invalid_argument("No controller named " + name);
+        }
+        return it->second(args);
+    }
+
+    /** The registered names, in order */
+    std::vector<std::string> names() const
+    {
+        std::vector<std::string> result;
+        for (std::map<std::string, Factory>::const_iterator it =
+                 m_factories.begin(); it != m_factories.end(); ++it)
+        {
+            result.push_back(it->first);
+        }
+        return result;
+    }
+
+private:
+
+    std::map<std::string, Factory> m_factories;
+};
+
+#endif // MODEL_CONTROLLER_REGISTRY_H
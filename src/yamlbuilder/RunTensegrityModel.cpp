@@ -0,0 +1,515 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file RunTensegrityModel.cpp
+ * @brief Contains the definition function main() for ntrt-run, which
+ * runs episodes of a YAML structure headless and writes their results
+ * in binary
+ * $Id$
+ */
+
+// This application
+#include "ModelControllerRegistry.h"
+#include "TensegrityModel.h"
+// This library
+#include "core/terrain/tgBoxGround.h"
+#include "core/tgBaseRigid.h"
+#include "core/tgObserver.h"
+#include "core/tgSimView.h"
+#include "core/tgSimulation.h"
+#include "core/tgStopPredicate.h"
+#include "core/tgWorld.h"
+#include "core/tgWorldSnapshot.h"
+// Bullet Physics
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <stdint.h> // for the fixed-width counts in the file
+// POSIX
+#include <dlfcn.h>
+#include <sys/time.h>
+
+namespace
+{
+    const char kMagic[8] = {'N', 'T', 'R', 'T', 'R', 'U', 'N', '1'};
+
+    const char* const kUsage =
+        " <structure.yaml | model> [options]\n"
+        "  --controller <name>   controller to attach (default none)\n"
+        "  --plugin <library>    load controllers from a shared library\n"
+        "  --arg <value>         passed to the controller's factory\n"
+        "  --episodes <M>        episodes to run (default 1)\n"
+        "  --steps <N>           most steps per episode\n"
+        "  --seconds <S>         most wall-clock seconds per episode\n"
+        "  --step-size <dt>      physics step in seconds (default 0.001)\n"
+        "  --gravity <g>         (default 98.1, dm/sec^2)\n"
+        "  --region <x0 y0 z0 x1 y1 z1>  stop when the center of mass leaves\n"
+        "  --divergence <factor> stop when a tension exceeds factor * maxTens\n"
+        "  --check-interval <K>  steps between stop checks (default 10)\n"
+        "  --output <file>       binary results (default results.bin)\n"
+        "  --verbose             keep what the model and controller print\n";
+
+    struct Options
+    {
+        Options() :
+        controller("none"),
+        episodes(1),
+        steps(0),
+        seconds(0.0),
+        stepSize(0.001),
+        gravity(98.1),
+        useRegion(false),
+        divergence(0.0),
+        checkInterval(10),
+        output("results.bin"),
+        verbose(false)
+        {
+        }
+
+        std::string structurePath;
+        std::string controller;
+        std::vector<std::string> plugins;
+        std::vector<std::string> args;
+        int episodes;
+        int steps;
+        double seconds;
+        double stepSize;
+        double gravity;
+        bool useRegion;
+        btVector3 regionMin;
+        btVector3 regionMax;
+        double divergence;
+        int checkInterval;
+        std::string output;
+        bool verbose;
+    };
+
+    /** The built in controller that leaves the model alone */
+    tgObserver<TensegrityModel>* createNoController(const std::vector<std::string>&)
+    {
+        return NULL;
+    }
+
+    /**
+     * Counts the steps of an episode, since tgSimulation::run only
+     * reports why it stopped.
+     */
+    class EpisodeClock : public tgObserver<TensegrityModel>
+    {
+    public:
+
+        EpisodeClock() : m_steps(0), m_time(0.0) { }
+
+        virtual void onSetup(TensegrityModel& subject)
+        {
+            m_steps = 0;
+            m_time = 0.0;
+        }
+
+        virtual void onStep(TensegrityModel& subject, double dt)
+        {
+            m_steps++;
+            m_time += dt;
+        }
+
+        virtual bool onReset(TensegrityModel& subject)
+        {
+            onSetup(subject);
+            return true;
+        }
+
+        std::size_t steps() const
+        {
+            return m_steps;
+        }
+
+        double time() const
+        {
+            return m_time;
+        }
+
+    private:
+
+        std::size_t m_steps;
+        double m_time;
+    };
+
+    double wallClock()
+    {
+        timeval now;
+        gettimeofday(&now, NULL);
+        return now.tv_sec + now.tv_usec * 1e-6;
+    }
+
+    /** The mass weighted center of the model's rigid bodies */
+    btVector3 centerOfMass(const tgModel& model)
+    {
+        const std::vector<tgBaseRigid*>& rigids =
+            model.getDescendantsOfType<tgBaseRigid>();
+        btVector3 sum(0.0, 0.0, 0.0);
+        double totalMass = 0.0;
+        for (std::size_t i = 0; i < rigids.size(); i++)
+        {
+            sum += rigids[i]->centerOfMass() * rigids[i]->mass();
+            totalMass += rigids[i]->mass();
+        }
+        return totalMass > 0.0 ? sum / totalMass : sum;
+    }
+
+    void writeCount(std::ostream& os, std::size_t n)
+    {
+        const uint32_t count = n;
+        os.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    }
+
+    void writeDouble(std::ostream& os, double d)
+    {
+        os.write(reinterpret_cast<const char*>(&d), sizeof(d));
+    }
+
+    void writeString(std::ostream& os, const std::string& s)
+    {
+        writeCount(os, s.size());
+        os.write(s.data(), s.size());
+    }
+
+    /** The next argument as a number, or throw */
+    double numberAfter(int& i, int argc, char** argv)
+    {
+        if (i + 1 >= argc)
+        {
+            throw std::invalid_argument(std::string(argv[i]) + " needs a value");
+        }
+        const std::string flag = argv[i];
+        char* end = NULL;
+        const double value = std::strtod(argv[++i], &end);
+        if (end == argv[i] || *end != '\0')
+        {
+            throw std::invalid_argument(flag + " needs a number");
+        }
+        return value;
+    }
+
+    std::string stringAfter(int& i, int argc, char** argv)
+    {
+        if (i + 1 >= argc)
+        {
+            throw std::invalid_argument(std::string(argv[i]) + " needs a value");
+        }
+        return argv[++i];
+    }
+
+    Options parseOptions(int argc, char** argv)
+    {
+        Options options;
+        options.structurePath = argv[1];
+        for (int i = 2; i < argc; i++)
+        {
+            const std::string flag = argv[i];
+            if (flag == "--controller")
+            {
+                options.controller = stringAfter(i, argc, argv);
+            }
+            else if (flag == "--plugin")
+            {
+                options.plugins.push_back(stringAfter(i, argc, argv));
+            }
+            else if (flag == "--arg")
+            {
+                options.args.push_back(stringAfter(i, argc, argv));
+            }
+            else if (flag == "--episodes")
+            {
+                options.episodes = (int) numberAfter(i, argc, argv);
+            }
+            else if (flag == "--steps")
+            {
+                options.steps = (int) numberAfter(i, argc, argv);
+            }
+            else if (flag == "--seconds")
+            {
+                options.seconds = numberAfter(i, argc, argv);
+            }
+            else if (flag == "--step-size")
+            {
+                options.stepSize = numberAfter(i, argc, argv);
+            }
+            else if (flag == "--gravity")
+            {
+                options.gravity = numberAfter(i, argc, argv);
+            }
+            else if (flag == "--region")
+            {
+                double corners[6];
+                for (int j = 0; j < 6; j++)
+                {
+                    corners[j] = numberAfter(i, argc, argv);
+                }
+                options.regionMin = btVector3(corners[0], corners[1], corners[2]);
+                options.regionMax = btVector3(corners[3], corners[4], corners[5]);
+                options.useRegion = true;
+            }
+            else if (flag == "--divergence")
+            {
+                options.divergence = numberAfter(i, argc, argv);
+            }
+            else if (flag == "--check-interval")
+            {
+                options.checkInterval = (int) numberAfter(i, argc, argv);
+            }
+            else if (flag == "--output")
+            {
+                options.output = stringAfter(i, argc, argv);
+            }
+            else if (flag == "--verbose")
+            {
+                options.verbose = true;
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown option " + flag);
+            }
+        }
+
+        if (options.episodes < 1)
+        {
+            throw std::invalid_argument("--episodes is not positive");
+        }
+        if (options.steps < 0 || options.seconds < 0.0)
+        {
+            throw std::invalid_argument("A budget is negative");
+        }
+        if (options.steps == 0 && options.seconds == 0.0)
+        {
+            throw std::invalid_argument("Give --steps, --seconds or both");
+        }
+        if (!(options.stepSize > 0.0))
+        {
+            throw std::invalid_argument("--step-size is not positive");
+        }
+        return options;
+    }
+
+    /** Open each plugin and let it add its controllers */
+    std::vector<void*> loadPlugins(const std::vector<std::string>& plugins,
+                                   ModelControllerRegistry& registry)
+    {
+        std::vector<void*> handles;
+        for (std::size_t i = 0; i < plugins.size(); i++)
+        {
+            void* const handle = dlopen(plugins[i].c_str(), RTLD_NOW | RTLD_LOCAL);
+            if (handle == NULL)
+            {
+                throw std::runtime_error(dlerror());
+            }
+            handles.push_back(handle);
+            ModelControllerRegistry::RegisterFunction registerControllers =
+                reinterpret_cast<ModelControllerRegistry::RegisterFunction>(
+                    dlsym(handle, "ntrtRegisterControllers"));
+            if (registerControllers == NULL)
+            {
+                throw std::runtime_error(plugins[i] +
+                                         " has no ntrtRegisterControllers");
+            }
+            registerControllers(registry);
+        }
+        return handles;
+    }
+
+    /**
+     * Run the episodes, writing a record for each as it ends.
+     * @return the number of episodes a controller stopped by throwing
+     */
+    int runEpisodes(const Options& options,
+                    tgObserver<TensegrityModel>* pController,
+                    std::ostream& results)
+    {
+        // the world will delete this
+        tgBoxGround* const ground =
+            new tgBoxGround(tgBoxGround::Config(btVector3(0.0, 0.0, 0.0)));
+        const tgWorld::Config config(options.gravity);
+        tgWorld world(config, ground);
+        // Nothing to render, so no visitor is ever called
+        tgSimView view(world, options.stepSize, options.stepSize);
+        tgSimulation simulation(view);
+
+        // The simulation tears down and deletes the model
+        TensegrityModel* const pModel =
+            new TensegrityModel(options.structurePath, false);
+        EpisodeClock clock;
+        pModel->attach(&clock);
+        if (pController != NULL)
+        {
+            pModel->attach(pController);
+        }
+        simulation.addModel(pModel);
+
+        tgWorldSnapshot initialState;
+        simulation.snapshot(initialState);
+
+        std::vector<tgStopPredicate*> predicates;
+        if (options.seconds > 0.0)
+        {
+            predicates.push_back(new tgWallClockStopPredicate(options.seconds));
+        }
+        if (options.useRegion)
+        {
+            predicates.push_back(new tgRegionStopPredicate(*pModel,
+                                                           options.regionMin,
+                                                           options.regionMax));
+        }
+        if (options.divergence > 0.0)
+        {
+            predicates.push_back(new tgDivergenceStopPredicate(*pModel,
+                                                               options.divergence));
+        }
+        const int steps = options.steps > 0 ? options.steps : INT_MAX;
+
+        int failed = 0;
+        for (int episode = 0; episode < options.episodes; episode++)
+        {
+            simulation.restart(initialState);
+            const double start = wallClock();
+            std::string reason;
+            bool completed = true;
+            try
+            {
+                reason = simulation.run(steps, predicates, options.checkInterval);
+            }
+            catch (const std::runtime_error& e)
+            {
+                // As the learning apps, a failed trial rather than an error
+                reason = e.what();
+                completed = false;
+                failed++;
+            }
+            const btVector3 com = centerOfMass(*pModel);
+
+            writeCount(results, episode);
+            writeCount(results, completed ? 1 : 0);
+            writeCount(results, clock.steps());
+            writeDouble(results, clock.time());
+            writeDouble(results, wallClock() - start);
+            writeDouble(results, com.x());
+            writeDouble(results, com.y());
+            writeDouble(results, com.z());
+            writeString(results, reason);
+            results.flush();
+        }
+
+        for (std::size_t i = 0; i < predicates.size(); i++)
+        {
+            delete predicates[i];
+        }
+        return failed;
+    }
+}
+
+/**
+ * The entry point of ntrt-run. Runs episodes of a structure with no
+ * graphics and no console output, restarting from the state just after
+ * setup each time, and stops each when its steps or wall-clock budget
+ * is spent or a stop predicate fires.
+ *
+ * The results file holds, in native byte order: the 8 characters
+ * "NTRTRUN1", a uint32 length and the structure path, a uint32 length
+ * and the controller name, the step size as a double, the uint32
+ * episode count, then for each episode: uint32 index, uint32 1 if it
+ * ran to a stop or 0 if the controller threw, uint32 steps, simulated
+ * and wall-clock seconds and the final center of mass x, y, z as
+ * doubles, and a uint32 length and the stop reason: empty if the steps
+ * budget ran out, else the predicate's reason or the exception message.
+ * @param[in] argc the number of command-line arguments
+ * @param[in] argv argv[1] is the path of the YAML encoded structure, or
+ * of one compiled with BuildModel --compile; the options follow
+ * @return 0, 1 on a usage or setup error, or 2 if any episode threw
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << kUsage;
+        return 1;
+    }
+
+    Options options;
+    try
+    {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::invalid_argument& e)
+    {
+        std::cerr << e.what() << std::endl
+                  << "Usage: " << argv[0] << kUsage;
+        return 1;
+    }
+
+    ModelControllerRegistry registry;
+    registry.add("none", createNoController);
+
+    std::vector<void*> handles;
+    tgObserver<TensegrityModel>* pController = NULL;
+    int failed = 0;
+    try
+    {
+        handles = loadPlugins(options.plugins, registry);
+        pController = registry.create(options.controller, options.args);
+
+        std::ofstream results(options.output.c_str(),
+                              std::ios::out | std::ios::binary);
+        if (!results)
+        {
+            throw std::runtime_error("Cannot open " + options.output);
+        }
+        results.write(kMagic, sizeof(kMagic));
+        writeString(results, options.structurePath);
+        writeString(results, options.controller);
+        writeDouble(results, options.stepSize);
+        writeCount(results, options.episodes);
+
+        // Writes to a failed stream are dropped
+        if (!options.verbose)
+        {
+            std::cout.setstate(std::ios::failbit);
+        }
+        failed = runEpisodes(options, pController, results);
+        std::cout.clear();
+    }
+    catch (const std::exception& e)
+    {
+        std::cout.clear();
+        std::cerr << e.what() << std::endl;
+        delete pController;
+        return 1;
+    }
+
+    // After the simulation has torn the controller down
+    delete pController;
+    for (std::size_t i = 0; i < handles.size(); i++)
+    {
+        dlclose(handles[i]);
+    }
+    return failed > 0 ? 2 : 0;
+}
@@ -24,11 +24,14 @@
  */
 
 #include "TensegrityModel.h"
+#include "CompiledTensegrityModel.h"
 // C++ Standard Library
+#include <cassert>
 #include <iostream>
 #include <stdexcept>
 // NTRT Core and tgCreator Libraries
 #include "core/tgBasicActuator.h"
+#include "core/tgBuildProfile.h"
 #include "core/tgKinematicActuator.h"
 #include "core/tgRod.h"
 #include "core/tgBox.h"
@@ -41,6 +44,220 @@
 #include "tgcreator/tgBoxInfo.h"
 #include "tgcreator/tgSphereInfo.h"
 #include "tgcreator/tgStructureInfo.h"
+#include "helpers/FileHelpers.h"
+// POSIX
+#include <pthread.h>
+#include <sys/stat.h>
+
+namespace
+{
+    /**
+     * Identifies a version of a file, so that cache entries can be dropped
+     * when the file is edited.
+     */
+    struct FileStamp {
+        std::string path;
+        time_t mtime;
+        off_t size;
+
+        bool operator==(const FileStamp& other) const {
+            return path == other.path && mtime == other.mtime && size == other.size;
+        }
+    };
+
+    bool stampFile(const std::string& path, FileStamp& stamp) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) return false;
+        stamp.path = path;
+        stamp.mtime = info.st_mtime;
+        stamp.size = info.st_size;
+        return true;
+    }
+
+    bool isCurrent(const std::vector<FileStamp>& files) {
+        for (std::size_t i = 0; i < files.size(); i++) {
+            FileStamp current;
+            if (!stampFile(files[i].path, current) || !(current == files[i])) return false;
+        }
+        return true;
+    }
+
+    struct ParsedFile {
+        FileStamp stamp;
+        // Never handed out; callers get clones, since yaml-cpp nodes are
+        // shared and even reading one with operator[] can change it
+        Yam root;
+    };
+
+    /**
+     * Everything in a parsed structure file that decides its geometry: the
+     * file without its builders section, and whether it had one. Files whose
+     * shapes are equal build the same tgStructure.
+     */
+    std::string shapeOf(const Yam& root) {
+        Yam shape = YAML::Clone(root);
+        const bool hasBuilders = shape.IsMap() && shape.remove("builders");
+        return YAML::Dump(shape) + (hasBuilders ? "\n#builders" : "");
+    }
+
+    struct CachedStructure {
+        CachedStructure() : pTemplate(NULL), version(0) {}
+        std::vector<FileStamp> files;
+        // shapeOf each file, indexed like files
+        std::vector<std::string> shapes;
+        std::vector<Yam> builders;
+        // the file each builders section came from, indexed like builders
+        std::vector<std::string> builderFiles;
+        tgStructure* pTemplate;
+        // tells a template apart from one that replaced it
+        unsigned long version;
+    };
+
+    // Models are set up again on every reset, possibly on several
+    // tgParallelSimulation threads at once. Both caches are process-wide and
+    // guarded by this mutex.
+    pthread_mutex_t s_cacheMutex = PTHREAD_MUTEX_INITIALIZER;
+    std::map<std::string, ParsedFile> s_parsedFiles;
+    std::map<std::string, CachedStructure> s_structures;
+    unsigned long s_structureVersion = 0;
+
+    /**
+     * Parse a structure file, or clone its cached parse if stamp matches it.
+     * A file that could not be stamped is parsed and not cached.
+     */
+    Yam parseStructureFile(const std::string& structurePath, const FileStamp* stamp) {
+        if (stamp) {
+            Yam root;
+            pthread_mutex_lock(&s_cacheMutex);
+            std::map<std::string, ParsedFile>::const_iterator it = s_parsedFiles.find(structurePath);
+            const bool parsed = it != s_parsedFiles.end() && it->second.stamp == *stamp;
+            if (parsed) {
+                root = YAML::Clone(it->second.root);
+            }
+            pthread_mutex_unlock(&s_cacheMutex);
+            if (parsed) return root;
+        }
+
+        /** 
+         * This call to YAML::LoadFile can return the exception YAML::BadFile 
+         * if any of the yaml files or substructure files cannot be found. 
+         * Make this error more explicit through a try and catch.
+         */
+        Yam root;
+        try
+        {
+          // Parsed in place from the process's mapping of the file; LoadFile
+          // reports a file that cannot be read
+          const FileHelpers::Resource source = FileHelpers::getResource(structurePath);
+          if (source.isValid()) {
+            FileHelpers::ResourceStream in(source);
+            root = YAML::Load(in);
+          }
+          else {
+            root = YAML::LoadFile(structurePath);
+          }
+        }
+        catch( YAML::BadFile badfileexception )
+        {
+          // If a BadFile exception is thrown, output a detailed message first:
+          std::cout << std::endl << "The YAML parser threw a BadFile exception when" <<
+            " trying to load one of your YAML files. " << std::endl <<
+            "The path of the structure that the parser attempted to load is: '" <<
+            structurePath << "'. " << std::endl <<
+            "Check to be sure that the file exists, and " <<
+            "that you didn't spell the path name incorrectly." <<
+            std::endl << std::endl;
+          // Then, throw the exception again, so that the program stops.
+          throw badfileexception;
+        }
+
+        if (stamp) {
+            ParsedFile entry;
+            entry.stamp = *stamp;
+            entry.root = YAML::Clone(root);
+            pthread_mutex_lock(&s_cacheMutex);
+            s_parsedFiles[structurePath] = entry;
+            pthread_mutex_unlock(&s_cacheMutex);
+        }
+        return root;
+    }
+
+    /**
+     * Bring a stale cached structure up to date if its files were edited
+     * only in their builders sections, as when a search varies stiffness or
+     * radii. The edited files are parsed again, and their new builders
+     * replace the old. Returns false, leaving entry unusable, if any file is
+     * gone or changed shape; the structure must then be built again.
+     */
+    bool refreshBuilders(CachedStructure& entry) {
+        std::map<std::string, Yam> edited;
+        for (std::size_t i = 0; i < entry.files.size(); i++) {
+            FileStamp current;
+            if (!stampFile(entry.files[i].path, current)) return false;
+            if (current == entry.files[i]) continue;
+            const Yam root = parseStructureFile(current.path, &current);
+            if (shapeOf(root) != entry.shapes[i]) return false;
+            entry.files[i] = current;
+            edited[current.path] = root;
+        }
+        for (std::size_t i = 0; i < entry.builders.size(); i++) {
+            std::map<std::string, Yam>::const_iterator it = edited.find(entry.builderFiles[i]);
+            if (it != edited.end()) {
+                const Yam& root = it->second;
+                entry.builders[i] = YAML::Clone(root["builders"]);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Materialize a copy of a structure all the way down, so that it no
+     * longer shares anything with the structure it was copied from. The
+     * sharing in tgStructure is not thread safe, so cached templates must
+     * only be shared under s_cacheMutex.
+     */
+    void detach(const tgStructure& structure) {
+        const std::vector<tgStructure*>& children = structure.getChildren();
+        for (std::size_t i = 0; i < children.size(); i++) {
+            detach(*children[i]);
+        }
+    }
+}
+
+struct TensegrityModel::BuildRecord {
+    BuildRecord() : cacheable(true) {}
+
+    /** Add the record of a substructure built as part of this one */
+    void merge(const BuildRecord& child) {
+        files.insert(files.end(), child.files.begin(), child.files.end());
+        shapes.insert(shapes.end(), child.shapes.begin(), child.shapes.end());
+        builders.insert(builders.end(), child.builders.begin(), child.builders.end());
+        builderFiles.insert(builderFiles.end(), child.builderFiles.begin(), child.builderFiles.end());
+        cacheable = cacheable && child.cacheable;
+    }
+
+    /** Every file read, so a cached structure can be checked for edits */
+    std::vector<FileStamp> files;
+
+    /**
+     * The shape of each file, indexed like files, so an edit to the builders
+     * alone can be told from one to the geometry
+     */
+    std::vector<std::string> shapes;
+
+    /** The "builders" sections, in the order they were added to the spec */
+    std::vector<Yam> builders;
+
+    /** The file each builders section came from, indexed like builders */
+    std::vector<std::string> builderFiles;
+
+    /**
+     * False if a bond group was applied. Which pairs a bond removes depends on
+     * the rigid builders already in the spec, including ones added outside
+     * this file tree, so the result cannot be reused elsewhere.
+     */
+    bool cacheable;
+};
 
 /**
  * Constructor that only takes the path to the YAML file.
@@ -88,20 +305,20 @@ void TensegrityModel::setup(tgWorld& world) {
 
     // add default builders (rods, strings, boxes) that match the tags (rods, strings, boxes, spheres)
     // (these will be overwritten if a different builder is specified for those tags)
-    Yam emptyYam = Yam();
-    addRodBuilder("tgRodInfo", "rod", emptyYam, spec);
-    addBasicActuatorBuilder("tgBasicActuatorInfo", "string", emptyYam, spec);
-    addBoxBuilder("tgBoxInfo", "box", emptyYam, spec);
-    addSphereBuilder("tgSphereInfo", "sphere", emptyYam, spec);
+    addDefaultBuilders(spec);
 
     tgStructure structure;
-    buildStructure(structure, topLvlStructurePath, spec);
+    std::vector<Yam> builders;
+    {
+        tgBuildProfile::Scope scope("yaml structure", topLvlStructurePath);
+        buildTopLevelStructure(structure, spec, builders);
+    }
 
     tgStructureInfo structureInfo(structure, spec);
     structureInfo.buildInto(*this, world);
 
     // use tgCast::filterto pull out the muscles that we want to control
-    allActuators = tgCast::filter<tgModel, tgSpringCableActuator> (getDescendants());
+    allActuators = getDescendantsOfType<tgSpringCableActuator>();
 
     // DEBUGGING: print out the tgStructure, tgStructureInfo, and tgModel.
     if(debugging_on) {
@@ -115,6 +332,43 @@ void TensegrityModel::setup(tgWorld& world) {
     tgModel::setup(world);
 }
 
+void TensegrityModel::compile(const std::string& compiledPath) {
+    // bonds look at the rigid builders in the spec, so it's needed even
+    // though nothing is built
+    tgBuildSpec spec;
+    addDefaultBuilders(spec);
+
+    tgStructure structure;
+    std::vector<Yam> builders;
+    buildTopLevelStructure(structure, spec, builders);
+    CompiledTensegrityModel::write(compiledPath, structure, builders);
+}
+
+void TensegrityModel::buildTopLevelStructure(tgStructure& structure, tgBuildSpec& spec, std::vector<Yam>& builders) {
+    if (CompiledTensegrityModel::isCompiled(topLvlStructurePath)) {
+        CompiledTensegrityModel::read(topLvlStructurePath, structure, builders);
+        for (std::size_t i = 0; i < builders.size(); i++) {
+            addBuilders(spec, builders[i]);
+        }
+        return;
+    }
+
+    // collect what the whole tree added to the spec
+    BuildRecord record;
+    buildRecords.push_back(&record);
+    try
+    {
+      buildStructure(structure, topLvlStructurePath, spec);
+    }
+    catch (...)
+    {
+      buildRecords.pop_back();
+      throw;
+    }
+    buildRecords.pop_back();
+    builders = record.builders;
+}
+
 void TensegrityModel::addChildren(tgStructure& structure, const std::string& structurePath, tgBuildSpec& spec, const Yam& children) {
     if (!children) return;
     std::string structureAttributeKeys[] = {"path", "rotation", "translation", "scale", "offset"};
@@ -234,40 +488,125 @@ void TensegrityModel::addChildTranslation(tgStructure& childStructure, const Yam
 }
 
 void TensegrityModel::buildStructure(tgStructure& structure, const std::string& structurePath, tgBuildSpec& spec) {
-    /** 
-     * This call to YAML::LoadFile can return the exception YAML::BadFile 
-     * if any of the yaml files or substructure files cannot be found. 
-     * Make this error more explicit through a try and catch.
-     */
-    Yam root;
-    try
-    {
-      root = YAML::LoadFile(structurePath);
+    // Only a structure with nothing in it yet can be replaced by a cached one
+    const bool fresh = structure.getNodes().getNodes().empty() &&
+        structure.getPairs().getPairs().empty() &&
+        structure.getChildren().empty();
+
+    BuildRecord record;
+    bool cached = false;
+    if (fresh) {
+        // A cached structure whose files were edited only in their builders
+        // keeps its geometry; parsing the edited files happens outside the lock
+        CachedStructure stale;
+        pthread_mutex_lock(&s_cacheMutex);
+        std::map<std::string, CachedStructure>::iterator it = s_structures.find(structurePath);
+        if (it != s_structures.end() && !isCurrent(it->second.files)) {
+            stale.files = it->second.files;
+            stale.shapes = it->second.shapes;
+            for (std::size_t i = 0; i < it->second.builders.size(); i++) {
+                stale.builders.push_back(YAML::Clone(it->second.builders[i]));
+            }
+            stale.builderFiles = it->second.builderFiles;
+            stale.version = it->second.version;
+        }
+        pthread_mutex_unlock(&s_cacheMutex);
+
+        const bool refreshed = stale.version != 0 && refreshBuilders(stale);
+
+        pthread_mutex_lock(&s_cacheMutex);
+        it = s_structures.find(structurePath);
+        if (refreshed && it != s_structures.end() && it->second.version == stale.version) {
+            it->second.files = stale.files;
+            it->second.builders = stale.builders;
+        }
+        if (it != s_structures.end() && isCurrent(it->second.files)) {
+            const tgTags tags = structure.getTags();
+            structure = *it->second.pTemplate;
+            detach(structure);
+            structure.setTags(tags);
+            record.files = it->second.files;
+            record.shapes = it->second.shapes;
+            for (std::size_t i = 0; i < it->second.builders.size(); i++) {
+                record.builders.push_back(YAML::Clone(it->second.builders[i]));
+            }
+            record.builderFiles = it->second.builderFiles;
+            cached = true;
+        }
+        pthread_mutex_unlock(&s_cacheMutex);
     }
-    catch( YAML::BadFile badfileexception )
-    {
-      // If a BadFile exception is thrown, output a detailed message first:
-      std::cout << std::endl << "The YAML parser threw a BadFile exception when" <<
-	" trying to load one of your YAML files. " << std::endl <<
-	"The path of the structure that the parser attempted to load is: '" <<
-	structurePath << "'. " << std::endl <<
-	"Check to be sure that the file exists, and " <<
-	"that you didn't spell the path name incorrectly." <<
-	std::endl << std::endl;
-      // Then, throw the exception again, so that the program stops.
-      throw badfileexception;
-    }
-    // Validate YAML
-    std::string rootKeys[] = {"nodes", "pair_groups", "builders", "substructures", "bond_groups"};
-    std::vector<std::string> rootKeysVector(rootKeys, rootKeys + sizeof(rootKeys) / sizeof(std::string));
-    yamlContainsOnly(root, structurePath, rootKeysVector);
-    yamlNoDuplicates(root, structurePath);
-
-    addChildren(structure, structurePath, spec, root["substructures"]);
-    addBuilders(spec, root["builders"]);
-    addNodes(structure, root["nodes"]);
-    addPairGroups(structure, root["pair_groups"]);
-    addBondGroups(structure, root["bond_groups"], spec);
+
+    if (cached) {
+        // the spec is new on every setup, so add the builders the file tree
+        // would have added, in the same order
+        for (std::size_t i = 0; i < record.builders.size(); i++) {
+            addBuilders(spec, record.builders[i]);
+        }
+    }
+    else {
+        buildRecords.push_back(&record);
+        try
+        {
+          Yam root = loadStructureFile(structurePath);
+          // Validate YAML
+          std::string rootKeys[] = {"nodes", "pair_groups", "builders", "substructures", "bond_groups"};
+          std::vector<std::string> rootKeysVector(rootKeys, rootKeys + sizeof(rootKeys) / sizeof(std::string));
+          yamlContainsOnly(root, structurePath, rootKeysVector);
+          yamlNoDuplicates(root, structurePath);
+
+          addChildren(structure, structurePath, spec, root["substructures"]);
+          addBuilders(spec, root["builders"]);
+          if (root["builders"]) {
+              record.builders.push_back(root["builders"]);
+              record.builderFiles.push_back(structurePath);
+          }
+          addNodes(structure, root["nodes"]);
+          addPairGroups(structure, root["pair_groups"]);
+          addBondGroups(structure, root["bond_groups"], spec);
+          if (root["bond_groups"]) record.cacheable = false;
+        }
+        catch (...)
+        {
+          buildRecords.pop_back();
+          throw;
+        }
+        buildRecords.pop_back();
+
+        if (fresh && record.cacheable) {
+            CachedStructure entry;
+            entry.files = record.files;
+            entry.shapes = record.shapes;
+            for (std::size_t i = 0; i < record.builders.size(); i++) {
+                entry.builders.push_back(YAML::Clone(record.builders[i]));
+            }
+            entry.builderFiles = record.builderFiles;
+            entry.pTemplate = new tgStructure(structure);
+            detach(*entry.pTemplate);
+            entry.pTemplate->setTags(tgTags());
+            pthread_mutex_lock(&s_cacheMutex);
+            entry.version = ++s_structureVersion;
+            CachedStructure& slot = s_structures[structurePath];
+            delete slot.pTemplate;
+            slot = entry;
+            pthread_mutex_unlock(&s_cacheMutex);
+        }
+    }
+
+    if (!buildRecords.empty()) {
+        buildRecords.back()->merge(record);
+    }
+}
+
+Yam TensegrityModel::loadStructureFile(const std::string& structurePath) {
+    FileStamp stamp;
+    const bool stamped = stampFile(structurePath, stamp);
+    const Yam root = parseStructureFile(structurePath, stamped ? &stamp : NULL);
+    if (stamped) {
+        assert(!buildRecords.empty());
+        buildRecords.back()->files.push_back(stamp);
+        buildRecords.back()->shapes.push_back(shapeOf(root));
+    }
+    return root;
 }
 
 void TensegrityModel::addNodes(tgStructure& structure, const Yam& nodes) {
@@ -596,6 +935,14 @@ tgStructure& TensegrityModel::getStructure(tgStructure& parentStructure, const s
     }
 }
 
+void TensegrityModel::addDefaultBuilders(tgBuildSpec& spec) {
+    Yam emptyYam = Yam();
+    addRodBuilder("tgRodInfo", "rod", emptyYam, spec);
+    addBasicActuatorBuilder("tgBasicActuatorInfo", "string", emptyYam, spec);
+    addBoxBuilder("tgBoxInfo", "box", emptyYam, spec);
+    addSphereBuilder("tgSphereInfo", "sphere", emptyYam, spec);
+}
+
 void TensegrityModel::addBuilders(tgBuildSpec& spec, const Yam& builders) {
     for (YAML::const_iterator builder = builders.begin(); builder != builders.end(); ++builder) {
         std::string tagMatch = builder->first.as<std::string>();
@@ -633,6 +980,8 @@ void TensegrityModel::addRodBuilder(const std::string& builderClass, const std::
     rp["friction"] = rodFriction;
     rp["roll_friction"] = rodRollFriction;
     rp["restitution"] = rodRestitution;
+    rp["ccd_motion_threshold"] = rodCcdMotionThreshold;
+    rp["ccd_swept_sphere_radius"] = rodCcdSweptSphereRadius;
 
     if (parameters) {
         for (YAML::const_iterator parameter = parameters.begin(); parameter != parameters.end(); ++parameter) {
@@ -646,7 +995,8 @@ void TensegrityModel::addRodBuilder(const std::string& builderClass, const std::
     }
 
     const tgRod::Config rodConfig = tgRod::Config(rp["radius"], rp["density"], rp["friction"],
-        rp["roll_friction"], rp["restitution"]);
+        rp["roll_friction"], rp["restitution"], rp["ccd_motion_threshold"],
+        rp["ccd_swept_sphere_radius"]);
     if (builderClass == "tgRodInfo") {
         // tgBuildSpec takes ownership of the tgRodInfo object
         spec.addBuilder(tagMatch, new tgRodInfo(rodConfig));
@@ -926,3 +1276,8 @@ void TensegrityModel::teardown() {
     notifyTeardown();
     tgModel::teardown();
 }
+
+void TensegrityModel::resetEpisode() {
+    notifyReset();
+    tgModel::resetEpisode();
+}
@@ -83,6 +83,12 @@ public:
      * Default rod restitution.
      */
     const static double rodRestitution = 0.2;
+    /*
+     * Default rod continuous collision motion threshold and swept
+     * sphere radius; negative derives them from the radius.
+     */
+    const static double rodCcdMotionThreshold = -1.0;
+    const static double rodCcdSweptSphereRadius = -1.0;
 
     // Box parameters:
   
@@ -228,12 +234,28 @@ public:
      */
     virtual void setup(tgWorld& world);
 
+    /**
+     * Build the structure without putting it into a world, and write it in
+     * the binary form read by CompiledTensegrityModel. A TensegrityModel
+     * whose structure path names such a file loads it instead of parsing
+     * YAML.
+     * @param[in] compiledPath the file to write
+     */
+    void compile(const std::string& compiledPath);
+
     /**
      * Undoes setup. Deletes child models. Called automatically on
      * reset and end of simulation. Notifies controllers of teardown
      */
     virtual void teardown();
 
+    /**
+     * Lets the controllers put their own state back for a new episode,
+     * as tgSimulation::restart asks. Controllers that do not reset
+     * themselves are torn down and set up again.
+     */
+    virtual void resetEpisode();
+
     /**
      * Step the model, its children. Notifies controllers of step.
      * @param[in] timeStep the timestep, must be positive.
@@ -261,6 +283,17 @@ private:
      */
     std::vector<tgSpringCableActuator*> allActuators;
 
+    /**
+     * What a structure file and its substructures were built from: the files
+     * read and the builders added to the spec. Defined in TensegrityModel.cpp.
+     */
+    struct BuildRecord;
+
+    /**
+     * The records of the buildStructure calls in progress, innermost last.
+     */
+    std::vector<BuildRecord*> buildRecords;
+
     /*
      * Responsible for adding all the children defined in a structure file, and apply their
      * rotation, scale, offset and translation attributes.
@@ -296,9 +329,25 @@ private:
 
     /*
      * Responsible for building a structure. This includes adding children, builders, nodes, pairs and bonds.
+     * Files are parsed once per process and reparsed only when they change. A structure whose file tree
+     * has no bond groups is built once, and later builds copy it and add its builders to the spec again.
+     * Each substructure file is cached on its own, so an edit to a child's transform rebuilds only the files
+     * on the path to it, and an edit to a file's builders section alone keeps the cached geometry and
+     * changes only the builders added to the spec.
      */
     void buildStructure(tgStructure& structure, const std::string& structurePath, tgBuildSpec& spec);
 
+    /*
+     * Responsible for parsing a structure file, or returning a copy of its cached parse.
+     */
+    Yam loadStructureFile(const std::string& structurePath);
+
+    /*
+     * Responsible for building the top level structure, from YAML or from a compiled model,
+     * and returning the builders sections that were added to the spec.
+     */
+    void buildTopLevelStructure(tgStructure& structure, tgBuildSpec& spec, std::vector<Yam>& builders);
+
     /*
      * Responsible for adding nodes to the structure.
      */
@@ -376,6 +425,12 @@ private:
      */
     tgStructure& getStructure(tgStructure& parentStructure, const std::string& structurePath);
 
+    /*
+     * Responsible for adding the builders used for the rod, string, box and sphere tags when a
+     * structure does not supply its own
+     */
+    void addDefaultBuilders(tgBuildSpec& spec);
+
     /*
      * Responsible for adding any builders to the build spec
      */
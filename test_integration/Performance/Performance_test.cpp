@@ -0,0 +1,270 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file Performance_test.cpp
+* @brief Times the scenes of the other integration tests and compares their
+* steps per second and reset times with a stored baseline
+* $Id$
+*/
+
+// This application
+#include "examples/IROS_2015/TetraSpineStatic/TetraSpineStaticModel_hf.h"
+#include "examples/learningSpines/TetrahedralComplex/FlemonsSpineModelLearning.h"
+#include "examples/contactCables/ContactCableDemo.h"
+#include "examples/motorModel/tsTestRig.h"
+// This library
+#include "core/terrain/tgBoxGround.h"
+#include "core/terrain/tgEmptyGround.h"
+#include "core/tgModel.h"
+#include "core/tgSimView.h"
+#include "core/tgSimulation.h"
+#include "core/tgWorld.h"
+#include "core/tgWorldSnapshot.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <time.h>
+// Google Test
+#include "gtest/gtest.h"
+
+#ifndef PERFORMANCE_BASELINE
+#define PERFORMANCE_BASELINE "baseline.txt"
+#endif
+
+using namespace std;
+
+namespace {
+
+	/** Steps timed per episode */
+	const int kSteps = 5000;
+	
+	/** Steps run before timing, so caches and pools are warm */
+	const int kWarmupSteps = 100;
+	
+	/** Episodes per scene; the best of them is compared */
+	const int kEpisodes = 3;
+	
+	const double kStepSize = 1.0 / 1000.0;
+	
+	/**
+	 * Reset times this close to the baseline always pass, since they are
+	 * too short to time reliably
+	 */
+	const double kResetSlack = 1e-3;
+	
+	struct Result
+	{
+		double stepsPerSecond;
+		/** Of tgSimulation::reset */
+		double resetSeconds;
+		/** Of tgSimulation::restore */
+		double restoreSeconds;
+	};
+	
+	double now()
+	{
+		timespec t;
+		clock_gettime(CLOCK_MONOTONIC, &t);
+		return t.tv_sec + t.tv_nsec * 1e-9;
+	}
+	
+	/**
+	 * The fraction by which a result may be worse than the baseline:
+	 * NTRT_PERF_TOLERANCE, or 0.3
+	 */
+	double tolerance()
+	{
+		const char* const value = getenv("NTRT_PERF_TOLERANCE");
+		return value != NULL ? atof(value) : 0.3;
+	}
+	
+	/** Whether to write the results as the new baseline */
+	bool recording()
+	{
+		const char* const value = getenv("NTRT_PERF_RECORD");
+		return value != NULL && string(value) != "0";
+	}
+	
+	/** Lines of "scene stepsPerSecond resetSeconds restoreSeconds" */
+	map<string, Result> readBaseline()
+	{
+		map<string, Result> baseline;
+		ifstream file(PERFORMANCE_BASELINE);
+		string line;
+		while (getline(file, line))
+		{
+			if (line.empty() || line[0] == '#')
+			{
+				continue;
+			}
+			istringstream fields(line);
+			string name;
+			Result result;
+			if (fields >> name >> result.stepsPerSecond
+				>> result.resetSeconds >> result.restoreSeconds)
+			{
+				baseline[name] = result;
+			}
+		}
+		return baseline;
+	}
+	
+	void writeBaseline(const map<string, Result>& baseline)
+	{
+		ofstream file(PERFORMANCE_BASELINE);
+		file << "# scene stepsPerSecond resetSeconds restoreSeconds" << endl
+			 << "# Written by Performance_test with NTRT_PERF_RECORD=1" << endl;
+		for (map<string, Result>::const_iterator it = baseline.begin();
+			 it != baseline.end(); ++it)
+		{
+			file << it->first << " " << it->second.stepsPerSecond << " "
+				 << it->second.resetSeconds << " "
+				 << it->second.restoreSeconds << endl;
+		}
+	}
+	
+	/**
+	 * Run a scene for kEpisodes, each reset and restored from a snapshot
+	 * taken after the warmup.
+	 * @param[in] pModel deleted by the simulation
+	 * @return the best of the episodes
+	 */
+	Result timeScene(double gravity, bool emptyGround, tgModel* pModel)
+	{
+		const tgWorld::Config config(gravity);
+		tgGround* const ground = emptyGround ?
+			static_cast<tgGround*>(new tgEmptyGround()) :
+			static_cast<tgGround*>(new tgBoxGround());
+		tgWorld world(config, ground);
+		tgSimView view(world, kStepSize);
+		tgSimulation simulation(view);
+		simulation.addModel(pModel);
+		
+		Result best;
+		best.stepsPerSecond = 0.0;
+		best.resetSeconds = 1e30;
+		best.restoreSeconds = 1e30;
+		for (int episode = 0; episode < kEpisodes; episode++)
+		{
+			for (int i = 0; i < kWarmupSteps; i++)
+			{
+				simulation.step(kStepSize);
+			}
+			tgWorldSnapshot snapshot;
+			simulation.snapshot(snapshot);
+			
+			const double start = now();
+			for (int i = 0; i < kSteps; i++)
+			{
+				simulation.step(kStepSize);
+			}
+			const double seconds = now() - start;
+			best.stepsPerSecond = max(best.stepsPerSecond, kSteps / seconds);
+			
+			double mark = now();
+			simulation.restore(snapshot);
+			best.restoreSeconds = min(best.restoreSeconds, now() - mark);
+			
+			mark = now();
+			simulation.reset();
+			best.resetSeconds = min(best.resetSeconds, now() - mark);
+		}
+		return best;
+	}
+	
+	/** Compare a scene with its baseline, or record it */
+	void checkScene(const string& name, const Result& result)
+	{
+		cout << setw(24) << left << name << right << fixed
+			 << setprecision(0) << setw(10) << result.stepsPerSecond
+			 << " steps/s  reset " << setprecision(4) << result.resetSeconds
+			 << " s  restore " << result.restoreSeconds << " s" << endl;
+		
+		map<string, Result> baseline = readBaseline();
+		if (recording())
+		{
+			baseline[name] = result;
+			writeBaseline(baseline);
+			return;
+		}
+		const map<string, Result>::const_iterator it = baseline.find(name);
+		if (it == baseline.end())
+		{
+			cout << "  no baseline for " << name
+				 << "; set NTRT_PERF_RECORD=1 to record one" << endl;
+			return;
+		}
+		
+		const Result& expected = it->second;
+		const double slack = tolerance();
+		EXPECT_GE(result.stepsPerSecond, expected.stepsPerSecond * (1.0 - slack))
+			<< name << " steps fewer per second than the baseline";
+		EXPECT_LE(result.resetSeconds,
+				  expected.resetSeconds * (1.0 + slack) + kResetSlack)
+			<< name << " resets slower than the baseline";
+		EXPECT_LE(result.restoreSeconds,
+				  expected.restoreSeconds * (1.0 + slack) + kResetSlack)
+			<< name << " restores slower than the baseline";
+	}
+
+	class PerformanceTest : public ::testing::Test {
+		protected:
+			PerformanceTest() {
+			}
+			
+			virtual ~PerformanceTest() {
+			}
+	};
+
+	// The scene of ICRA2015Tests, without its controller
+	TEST_F(PerformanceTest, ICRA2015) {
+		checkScene("ICRA2015", timeScene(981, false, new TetraSpineStaticModel_hf(3)));
+	}
+
+	// The scene of SpineTests, without its controller
+	TEST_F(PerformanceTest, Spines) {
+		checkScene("Spines", timeScene(981, false, new FlemonsSpineModelLearning(12)));
+	}
+
+	// The scene of MuscleNP
+	TEST_F(PerformanceTest, MuscleNP) {
+		checkScene("MuscleNP", timeScene(0.0, true, new ContactCableDemo()));
+	}
+
+	// The rigs of TimestepIndependence
+	TEST_F(PerformanceTest, KinematicRig) {
+		checkScene("KinematicRig", timeScene(981, false, new tsTestRig(true, false, 1000.0)));
+	}
+
+	TEST_F(PerformanceTest, BasicRig) {
+		checkScene("BasicRig", timeScene(981, false, new tsTestRig(false, false, 1000.0)));
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,175 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file Reentrancy_test.cpp
+* @brief Steps eight worlds on eight threads at once and checks that each
+* ends exactly where the same scene ends when run alone. Build with
+* NTRT_TSAN and NTRT_NO_PROFILE to check the core for data races.
+* $Id$
+*/
+
+// This application
+#include "examples/contactCables/ContactCableDemo.h"
+#include "examples/motorModel/tsTestRig.h"
+// This library
+#include "core/terrain/tgBoxGround.h"
+#include "core/terrain/tgEmptyGround.h"
+#include "core/tgModel.h"
+#include "core/tgParallelSimulation.h"
+#include "core/tgSimulation.h"
+#include "core/tgWorld.h"
+#include "core/tgWorldSnapshot.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+using namespace std;
+
+namespace {
+
+	const std::size_t kWorlds = 8;
+	
+	const int kSteps = 2000;
+	
+	const double kStepSize = 1.0 / 1000.0;
+	
+	/** The same scene in each world, recording where it ends */
+	class SceneEpisode : public tgParallelSimulation::Episode
+	{
+		public:
+			SceneEpisode(bool contactCables) :
+				m_contactCables(contactCables),
+				m_pSimulation(NULL)
+			{
+			}
+			
+			virtual tgGround* createGround()
+			{
+				if (m_contactCables)
+				{
+					return new tgEmptyGround();
+				}
+				return new tgBoxGround();
+			}
+			
+			virtual void setup(tgSimulation& simulation)
+			{
+				m_pSimulation = &simulation;
+				if (m_contactCables)
+				{
+					simulation.addModel(new ContactCableDemo());
+				}
+				else
+				{
+					simulation.addModel(new tsTestRig(true, false, 1000.0));
+				}
+			}
+			
+			virtual void beginTrial(std::size_t trial)
+			{
+			}
+			
+			virtual void endTrial(std::size_t trial)
+			{
+				m_pSimulation->snapshot(m_end);
+			}
+			
+			const tgWorldSnapshot& getEnd() const
+			{
+				return m_end;
+			}
+		
+		private:
+			const bool m_contactCables;
+			tgSimulation* m_pSimulation;
+			tgWorldSnapshot m_end;
+	};
+	
+	/**
+	 * Run a scene alone, then in kWorlds worlds on kWorlds threads, and
+	 * compare every body and actuator
+	 */
+	void checkScene(bool contactCables)
+	{
+		const tgWorld::Config worldConfig(contactCables ? 0.0 : 981);
+		const tgParallelSimulation::Config config(worldConfig, kStepSize);
+		
+		SceneEpisode alone(contactCables);
+		{
+			tgParallelSimulation simulation(config,
+				std::vector<tgParallelSimulation::Episode*>(1, &alone));
+			simulation.run(1, kSteps);
+		}
+		const tgWorldSnapshot& expected = alone.getEnd();
+		
+		std::vector<SceneEpisode*> episodes;
+		for (std::size_t i = 0; i < kWorlds; i++)
+		{
+			episodes.push_back(new SceneEpisode(contactCables));
+		}
+		{
+			tgParallelSimulation simulation(config,
+				std::vector<tgParallelSimulation::Episode*>(episodes.begin(), episodes.end()));
+			simulation.run(kWorlds, kSteps);
+		}
+		
+		for (std::size_t i = 0; i < kWorlds; i++)
+		{
+			const tgWorldSnapshot& actual = episodes[i]->getEnd();
+			ASSERT_EQ(expected.bodies.size(), actual.bodies.size());
+			for (std::size_t j = 0; j < expected.bodies.size(); j++)
+			{
+				const btVector3& a = actual.bodies[j].worldTransform.getOrigin();
+				const btVector3& e = expected.bodies[j].worldTransform.getOrigin();
+				EXPECT_EQ(e.x(), a.x()) << "World " << i << " body " << j;
+				EXPECT_EQ(e.y(), a.y()) << "World " << i << " body " << j;
+				EXPECT_EQ(e.z(), a.z()) << "World " << i << " body " << j;
+			}
+			EXPECT_EQ(expected.actuatorState, actual.actuatorState) << "World " << i;
+			delete episodes[i];
+		}
+	}
+
+	class ReentrancyTest : public ::testing::Test {
+		protected:
+			ReentrancyTest() {
+			}
+			
+			virtual ~ReentrancyTest() {
+			}
+	};
+
+	// Contact cables share the anchor pool and shape cache
+	TEST_F(ReentrancyTest, ContactCables) {
+		checkScene(true);
+	}
+
+	// Kinematic actuators and a box ground
+	TEST_F(ReentrancyTest, KinematicRig) {
+		checkScene(false);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
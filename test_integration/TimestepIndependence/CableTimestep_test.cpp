@@ -0,0 +1,165 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License 197.632for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file CableTimestep_test.cpp
+* @brief Finds the largest stable timestep of explicit and implicit cable
+* forces on the motor test rig, and reports the throughput gained
+* $Id$
+*/
+
+// This application
+#include "examples/motorModel/tsTestRig.h"
+// This library
+#include "core/tgSpringCableActuator.h"
+#include "core/tgModel.h"
+#include "core/tgSimView.h"
+#include "core/tgSimulation.h"
+#include "core/tgWorld.h"
+// The C++ Standard Library
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <ctime>
+#include <limits>
+// Google Test
+#include "gtest/gtest.h"
+
+
+using namespace std;
+
+namespace {
+
+	/** Simulated seconds per trial */
+	const double kTrialTime = 1.0;
+	
+	/** The reference timestep, assumed stable for both modes */
+	const double kReferenceStep = 1.0 / 10000.0;
+	
+	/** Timesteps to try, ascending */
+	const double kSteps[] = {1.0 / 10000.0, 1.0 / 5000.0, 1.0 / 2000.0,
+							 1.0 / 1000.0, 1.0 / 500.0, 1.0 / 200.0,
+							 1.0 / 100.0};
+	const std::size_t kNumSteps = sizeof(kSteps) / sizeof(kSteps[0]);
+	
+	/** How far the final cable length may be from the reference */
+	const double kTolerance = 0.05;
+	
+	struct Trial
+	{
+		double length;
+		double seconds;
+	};
+	
+	/** Run the rig for kTrialTime at dt; the length is NaN if it escaped */
+	Trial runTrial(bool kinematic, bool implicit, double stiffness, double dt)
+	{
+		const tgWorld::Config config(981); // gravity, dm/sec^2
+		tgWorld world(config);
+		tgSimView view(world, dt, 1.0 / 60.0);
+		tgSimulation simulation(view);
+		
+		tsTestRig* const myModel = new tsTestRig(kinematic, implicit, stiffness);
+		simulation.addModel(myModel);
+		
+		const clock_t start = clock();
+		simulation.run(static_cast<int>(kTrialTime / dt + 0.5));
+		Trial trial;
+		trial.seconds = double(clock() - start) / CLOCKS_PER_SEC;
+		
+		const std::vector<tgSpringCableActuator*>& muscles = myModel->getAllMuscles();
+		trial.length = muscles.size() == 1 ? muscles[0]->getCurrentLength() :
+			std::numeric_limits<double>::quiet_NaN();
+		return trial;
+	}
+	
+	/**
+	 * The largest timestep in kSteps at which the trial, and every trial at
+	 * a smaller step, ends within kTolerance of the reference.
+	 * @param[out] seconds the run time of the trial at that step
+	 * @return 0 if even the smallest step fails
+	 */
+	double largestStableStep(bool kinematic, bool implicit, double stiffness,
+							 double& seconds)
+	{
+		const double reference =
+			runTrial(kinematic, false, stiffness, kReferenceStep).length;
+		double largest = 0.0;
+		seconds = 0.0;
+		for (std::size_t i = 0; i < kNumSteps; i++)
+		{
+			const Trial trial = runTrial(kinematic, implicit, stiffness, kSteps[i]);
+			if (!(fabs(trial.length - reference) <= kTolerance * reference))
+			{
+				break;
+			}
+			largest = kSteps[i];
+			seconds = trial.seconds;
+		}
+		return largest;
+	}
+	
+	/** Print one line of the report and check implicit is no worse */
+	void compareModes(const char* name, bool kinematic, double stiffness)
+	{
+		double explicitSeconds;
+		double implicitSeconds;
+		const double explicitStep =
+			largestStableStep(kinematic, false, stiffness, explicitSeconds);
+		const double implicitStep =
+			largestStableStep(kinematic, true, stiffness, implicitSeconds);
+		
+		std::cout << std::setw(24) << std::left << name
+				  << " explicit dt " << std::setw(8) << explicitStep
+				  << " implicit dt " << std::setw(8) << implicitStep;
+		if (explicitSeconds > 0.0 && implicitSeconds > 0.0)
+		{
+			std::cout << " throughput x" << explicitSeconds / implicitSeconds;
+		}
+		std::cout << std::endl;
+		
+		EXPECT_GT(explicitStep, 0.0);
+		EXPECT_GE(implicitStep, explicitStep);
+	}
+
+	class CableTimestepTest : public ::testing::Test {
+		protected:
+			CableTimestepTest() {
+			}
+			
+			virtual ~CableTimestepTest() {
+			}
+	};
+
+	TEST_F(CableTimestepTest, KinematicActuator) {
+		compareModes("kinematic k=1e3", true, 1000.0);
+		compareModes("kinematic k=1e5", true, 100000.0);
+	}
+
+	TEST_F(CableTimestepTest, BasicActuator) {
+		compareModes("basic k=1e3", false, 1000.0);
+		compareModes("basic k=1e5", false, 100000.0);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}